@@ -0,0 +1,51 @@
+#
+# register a benchmark executable - the given data files are copied next to the binary to be loaded by the benchmark
+#
+# Example: engine_add_benchmark(TARGET benchmarks-voxel FILES voxelformat/tests/chr_knight.qb)
+#
+# TARGET: the benchmark executable (see engine_add_executable)
+# FILES:  the data files relative to the data dir
+#
+function(engine_add_benchmark)
+	set(_OPTIONS_ARGS)
+	set(_ONE_VALUE_ARGS TARGET)
+	set(_MULTI_VALUE_ARGS FILES)
+
+	cmake_parse_arguments(_BENCH "${_OPTIONS_ARGS}" "${_ONE_VALUE_ARGS}" "${_MULTI_VALUE_ARGS}" ${ARGN} )
+
+	foreach(datafile ${_BENCH_FILES})
+		get_filename_component(filename ${datafile} NAME)
+		configure_file(${DATA_DIR}/${datafile} ${CMAKE_BINARY_DIR}/${PROJECT_NAME}/${filename} COPYONLY)
+	endforeach()
+	set_property(GLOBAL APPEND PROPERTY ENGINE_BENCHMARKS ${_BENCH_TARGET})
+endfunction()
+
+#
+# adds the benchmarks-report target that executes all registered benchmarks and merges their json output into
+# benchmarks.json in the build directory. Must be called after all benchmarks were registered.
+#
+# Use the BENCHMARK_ARGS cache variable to give additional arguments to the benchmarks - e.g. --benchmark_filter
+#
+function(engine_add_benchmarks_report)
+	get_property(BENCHMARKS GLOBAL PROPERTY ENGINE_BENCHMARKS)
+	if (NOT BENCHMARKS)
+		return()
+	endif()
+	set(BENCHMARK_BINARIES)
+	foreach(benchmark ${BENCHMARKS})
+		list(APPEND BENCHMARK_BINARIES $<TARGET_FILE:${benchmark}>)
+	endforeach()
+	# the list separator would split the argument
+	string(REPLACE ";" "|" BENCHMARK_BINARIES "${BENCHMARK_BINARIES}")
+	set(BENCHMARK_ARGS "" CACHE STRING "Additional arguments for the benchmarks of the benchmarks-report target")
+	add_custom_target(benchmarks-report
+		COMMAND ${CMAKE_COMMAND}
+			"-DBENCHMARKS=${BENCHMARK_BINARIES}"
+			"-DBENCHMARK_ARGS=${BENCHMARK_ARGS}"
+			-DREPORT=${CMAKE_BINARY_DIR}/benchmarks.json
+			-P ${SCRIPTS_CMAKE_DIR}/benchmarkreport.cmake
+		DEPENDS ${BENCHMARKS}
+		USES_TERMINAL
+		COMMENT "Execute all benchmarks and write the report to ${CMAKE_BINARY_DIR}/benchmarks.json"
+	)
+endfunction()
@@ -0,0 +1,80 @@
+#
+# executes the given benchmark binaries and merges their json output into one report - see engine_add_benchmarks_report
+#
+# cmake -DBENCHMARKS=<binary>|<binary> -DREPORT=<file> [-DBENCHMARK_ARGS=<args>] -P benchmarkreport.cmake
+#
+# The report contains the context (cpu, caches, build type) of the first benchmark binary, the names of the executed
+# binaries and the benchmarks of all binaries.
+#
+
+if (NOT BENCHMARKS OR NOT REPORT)
+	message(FATAL_ERROR "BENCHMARKS and REPORT must be given")
+endif()
+
+string(REPLACE "|" ";" BENCHMARKS "${BENCHMARKS}")
+separate_arguments(BENCHMARK_ARGS)
+
+set(CONTEXT "")
+set(EXECUTABLES "")
+set(ENTRIES "")
+set(FAILED 0)
+foreach(binary ${BENCHMARKS})
+	get_filename_component(name ${binary} NAME_WE)
+	get_filename_component(dir ${binary} DIRECTORY)
+	set(output ${dir}/${name}.json)
+	file(REMOVE ${output})
+	message(STATUS "Execute ${name}")
+	# the data files are loaded relative to the binary
+	execute_process(
+		COMMAND ${binary} --benchmark_out=${output} --benchmark_out_format=json ${BENCHMARK_ARGS}
+		WORKING_DIRECTORY ${dir}
+		RESULT_VARIABLE result
+	)
+	if (NOT result EQUAL 0 OR NOT EXISTS ${output})
+		message(WARNING "${name} failed with ${result}")
+		set(FAILED 1)
+		continue()
+	endif()
+	file(READ ${output} json)
+	string(FIND "${json}" "\"benchmarks\": [" start)
+	string(FIND "${json}" "]" end REVERSE)
+	if (start EQUAL -1 OR end EQUAL -1)
+		message(WARNING "${name} didn't write a valid report")
+		set(FAILED 1)
+		continue()
+	endif()
+	if (CONTEXT STREQUAL "")
+		string(FIND "${json}" "\"context\": " contextStart)
+		if (NOT contextStart EQUAL -1)
+			math(EXPR contextStart "${contextStart} + 11")
+			math(EXPR contextLength "${start} - ${contextStart}")
+			string(SUBSTRING "${json}" ${contextStart} ${contextLength} context)
+			string(FIND "${context}" "}" contextEnd REVERSE)
+			math(EXPR contextEnd "${contextEnd} + 1")
+			string(SUBSTRING "${context}" 0 ${contextEnd} CONTEXT)
+		endif()
+	endif()
+	math(EXPR start "${start} + 15")
+	math(EXPR length "${end} - ${start}")
+	string(SUBSTRING "${json}" ${start} ${length} entries)
+	string(STRIP "${entries}" entries)
+	if (NOT entries STREQUAL "")
+		if (NOT ENTRIES STREQUAL "")
+			string(APPEND ENTRIES ",\n    ")
+		endif()
+		string(APPEND ENTRIES "${entries}")
+	endif()
+	if (NOT EXECUTABLES STREQUAL "")
+		string(APPEND EXECUTABLES ", ")
+	endif()
+	string(APPEND EXECUTABLES "\"${name}\"")
+endforeach()
+
+if (CONTEXT STREQUAL "")
+	set(CONTEXT "{}")
+endif()
+file(WRITE ${REPORT} "{\n  \"context\": ${CONTEXT},\n  \"executables\": [${EXECUTABLES}],\n  \"benchmarks\": [\n    ${ENTRIES}\n  ]\n}\n")
+message(STATUS "Wrote ${REPORT}")
+if (FAILED)
+	message(FATAL_ERROR "Not all benchmarks were executed successfully")
+endif()
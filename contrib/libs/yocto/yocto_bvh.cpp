@@ -391,6 +391,29 @@ scene_bvh make_scene_bvh(
   return sbvh;
 }
 
+scene_bvh make_scene_bvh(const scene_data& scene, vector<shape_bvh>&& shapes,
+    bool highquality) {
+  // bvh
+  auto sbvh   = scene_bvh{};
+  sbvh.shapes = std::move(shapes);
+
+  // instance bboxes
+  auto bboxes = vector<bbox3f>(scene.instances.size());
+  for (auto idx : range(bboxes.size())) {
+    auto& instance = scene.instances[idx];
+    bboxes[idx]    = sbvh.shapes[instance.shape].bvh.nodes.empty()
+                         ? invalidb3f
+                         : transform_bbox(instance.frame,
+                               sbvh.shapes[instance.shape].bvh.nodes[0].bbox);
+  }
+
+  // build nodes
+  sbvh.bvh = make_bvh(bboxes, highquality);
+
+  // done
+  return sbvh;
+}
+
 void update_shape_bvh(shape_bvh& sbvh, const shape_data& shape) {
   // build primitives
   auto bboxes = vector<bbox3f>{};
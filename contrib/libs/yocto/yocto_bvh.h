@@ -82,6 +82,10 @@ struct scene_bvh {
 shape_bvh make_shape_bvh(const shape_data& shape, bool highquality = false);
 scene_bvh make_scene_bvh(
     const scene_data& scene, bool highquality = false, bool noparallel = false);
+// Build the scene bvh from already built shape bvhs - only the instance
+// hierarchy is built.
+scene_bvh make_scene_bvh(const scene_data& scene, vector<shape_bvh>&& shapes,
+    bool highquality = false);
 
 // Refit bvh data
 void update_shape_bvh(shape_bvh& bvh, const shape_data& shape);
@@ -621,6 +621,11 @@ namespace yocto {
 
 // Add missing cameras.
 void add_camera(scene_data& scene) {
+  add_camera(scene, compute_bounds(scene));
+}
+
+// Add a camera that frames the given bounds.
+void add_camera(scene_data& scene, const bbox3f& bbox) {
   scene.camera_names.emplace_back("camera");
   auto& camera        = scene.cameras.emplace_back();
   camera.orthographic = false;
@@ -628,7 +633,6 @@ void add_camera(scene_data& scene) {
   camera.aspect       = (float)16 / (float)9;
   camera.aperture     = 0;
   camera.lens         = 0.050f;
-  auto bbox           = compute_bounds(scene);
   auto center         = (bbox.max + bbox.min) / 2;
   auto bbox_radius    = length(bbox.max - bbox.min) / 2;
   auto camera_dir     = vec3f{0, 0, 1};
@@ -342,6 +342,8 @@ bbox3f compute_bounds(const scene_data& scene);
 
 // add missing elements
 void add_camera(scene_data& scene);
+// add a camera that frames the given bounds
+void add_camera(scene_data& scene, const bbox3f& bbox);
 void add_sky(scene_data& scene, float sun_angle = pif / 4);
 
 // get named camera or default if name is empty
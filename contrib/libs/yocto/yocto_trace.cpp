@@ -1487,6 +1487,118 @@ void trace_sample(trace_state& state, const scene_data& scene,
   }
 }
 
+// Naive path tracing with a custom intersection
+static trace_result trace_naive(const scene_data& scene,
+    const trace_intersect_func& intersect, const ray3f& ray_, rng_state& rng,
+    const trace_params& params) {
+  // initialize
+  auto radiance   = vec3f{0, 0, 0};
+  auto weight     = vec3f{1, 1, 1};
+  auto ray        = ray_;
+  auto hit        = false;
+  auto hit_albedo = vec3f{0, 0, 0};
+  auto hit_normal = vec3f{0, 0, 0};
+  auto opbounce   = 0;
+
+  // trace  path
+  for (auto bounce = 0; bounce < params.bounces; bounce++) {
+    // intersect next point
+    auto point = intersect(ray);
+    if (!point.hit) {
+      if (bounce > 0 || !params.envhidden)
+        radiance += weight * eval_environment(scene, ray.d);
+      break;
+    }
+
+    // prepare shading point
+    auto  outgoing = -ray.d;
+    auto  position = point.position;
+    auto  normal   = dot(point.normal, outgoing) >= 0 ? point.normal
+                                                     : -point.normal;
+    auto& material = point.material;
+
+    // handle opacity
+    if (material.opacity < 1 && rand1f(rng) >= material.opacity) {
+      if (opbounce++ > 128) break;
+      ray = {position + ray.d * 1e-2f, ray.d};
+      bounce -= 1;
+      continue;
+    }
+
+    // set hit variables
+    if (bounce == 0) {
+      hit        = true;
+      hit_albedo = material.color;
+      hit_normal = normal;
+    }
+
+    // accumulate emission
+    radiance += weight * eval_emission(material, normal, outgoing);
+
+    // next direction
+    auto incoming = vec3f{0, 0, 0};
+    if (material.roughness != 0) {
+      incoming = sample_bsdfcos(
+          material, normal, outgoing, rand1f(rng), rand2f(rng));
+      if (incoming == vec3f{0, 0, 0}) break;
+      weight *= eval_bsdfcos(material, normal, outgoing, incoming) /
+                sample_bsdfcos_pdf(material, normal, outgoing, incoming);
+    } else {
+      incoming = sample_delta(material, normal, outgoing, rand1f(rng));
+      if (incoming == vec3f{0, 0, 0}) break;
+      weight *= eval_delta(material, normal, outgoing, incoming) /
+                sample_delta_pdf(material, normal, outgoing, incoming);
+    }
+
+    // check weight
+    if (weight == vec3f{0, 0, 0} || !isfinite(weight)) break;
+
+    // russian roulette
+    if (bounce > 3) {
+      auto rr_prob = min((float)0.99, max(weight));
+      if (rand1f(rng) >= rr_prob) break;
+      weight *= 1 / rr_prob;
+    }
+
+    // setup next iteration
+    ray = {position, incoming};
+  }
+
+  return {radiance, hit, hit_albedo, hit_normal};
+}
+
+void trace_sample(trace_state& state, const scene_data& scene,
+    const trace_intersect_func& intersect, int i, int j, int sample,
+    const trace_params& params) {
+  auto& camera = scene.cameras[params.camera];
+  auto  idx    = state.width * j + i;
+  auto  ray    = sample_camera(camera, {i, j}, {state.width, state.height},
+          rand2f(state.rngs[idx]), rand2f(state.rngs[idx]), params.tentfilter);
+  auto [radiance, hit, albedo, normal] = trace_naive(
+      scene, intersect, ray, state.rngs[idx], params);
+  if (!isfinite(radiance)) radiance = {0, 0, 0};
+  if (max(radiance) > params.clamp)
+    radiance = radiance * (params.clamp / max(radiance));
+  auto weight = 1.0f / (sample + 1);
+  if (hit) {
+    state.image[idx] = lerp(
+        state.image[idx], {radiance.x, radiance.y, radiance.z, 1}, weight);
+    state.albedo[idx] = lerp(state.albedo[idx], albedo, weight);
+    state.normal[idx] = lerp(state.normal[idx], normal, weight);
+    state.hits[idx] += 1;
+  } else if (!params.envhidden && !scene.environments.empty()) {
+    state.image[idx] = lerp(
+        state.image[idx], {radiance.x, radiance.y, radiance.z, 1}, weight);
+    state.albedo[idx] = lerp(state.albedo[idx], {1, 1, 1}, weight);
+    state.normal[idx] = lerp(state.normal[idx], -ray.d, weight);
+    state.hits[idx] += 1;
+  } else {
+    state.image[idx]  = lerp(state.image[idx], {0, 0, 0, 0}, weight);
+    state.albedo[idx] = lerp(state.albedo[idx], {0, 0, 0}, weight);
+    state.normal[idx] = lerp(state.normal[idx], -ray.d, weight);
+  }
+}
+
 // Init a sequence of random number generators.
 trace_state make_trace_state(
     const scene_data& scene, const trace_params& params) {
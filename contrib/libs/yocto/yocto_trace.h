@@ -38,6 +38,7 @@
 // -----------------------------------------------------------------------------
 
 #include <atomic>
+#include <functional>
 #include <future>
 #include <memory>
 #include <string>
@@ -175,6 +176,23 @@ void trace_sample(trace_state& state, const scene_data& scene,
     const trace_bvh& bvh, const trace_lights& lights, int i, int j, int sample,
     const trace_params& params);
 
+// Shading point of a custom scene intersection
+struct trace_point {
+  bool           hit      = false;
+  vec3f          position = {0, 0, 0};
+  vec3f          normal   = {0, 0, 0};
+  material_point material = {};
+};
+// Custom scene intersection for scenes that are not made of shapes - e.g.
+// voxel grids. Must be thread safe.
+using trace_intersect_func = std::function<trace_point(const ray3f& ray)>;
+
+// Progressively computes a pixel sample with naive path tracing and a custom
+// intersection. The scene only provides the cameras and the environments.
+void trace_sample(trace_state& state, const scene_data& scene,
+    const trace_intersect_func& intersect, int i, int j, int sample,
+    const trace_params& params);
+
 // Get resulting render, denoised if requested
 image_data get_image(const trace_state& state);
 void       get_image(image_data& image, const trace_state& state);
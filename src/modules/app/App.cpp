@@ -7,10 +7,13 @@
 #include "app/i18n/findlocale.h"
 #include "command/Command.h"
 #include "command/CommandHandler.h"
+#include "core/Allocator.h"
 #include "core/Assert.h"
 #include "core/Common.h"
 #include "core/ConfigVar.h"
 #include "core/Log.h"
+#include "core/MemoryTracker.h"
+#include "core/PerfStats.h"
 #include "core/StringUtil.h"
 #include "core/Tokenizer.h"
 #include "core/Var.h"
@@ -262,6 +265,27 @@ void App::deletePid() {
 	io::Filesystem::sysRemoveFile(_filesystem->homeWritePath("app.pid"));
 }
 
+/**
+ * @brief The percentiles of the histograms and the values of the gauges are sent as metric gauges
+ */
+static void sendPerfMetrics() {
+	for (int i = 0; i < (int)core::PerfStat::Max; ++i) {
+		const core::PerfStat stat = (core::PerfStat)i;
+		const core::PerfStats &stats = core::perfStats(stat);
+		if (stats.count == 0u) {
+			continue;
+		}
+		const core::String &key = core::String::format("perf_%s", core::perfStatName(stat));
+		if (core::perfStatType(stat) == core::PerfStatType::Gauge) {
+			metric::gauge(key, (uint32_t)stats.last);
+			continue;
+		}
+		metric::gauge(key, (uint32_t)stats.p50, {{"percentile", "50"}});
+		metric::gauge(key, (uint32_t)stats.p90, {{"percentile", "90"}});
+		metric::gauge(key, (uint32_t)stats.p99, {{"percentile", "99"}});
+	}
+}
+
 void App::onFrame() {
 	core_trace_begin_frame("Main");
 	if (_nextState != AppState::InvalidAppState && _nextState != _curState) {
@@ -381,6 +405,15 @@ void App::onFrame() {
 				core_trace_scoped(AppOnAfterRunning);
 				onAfterRunning();
 			}
+			// give back the transient allocations of this frame
+			core::FrameAllocator::reset();
+			core::memoryPlot();
+			core::perfRecord(core::PerfStat::Frame, (uint64_t)(_deltaFrameSeconds * 1000000.0));
+			core::perfFrame();
+			if (_nextPerfMetricsSeconds <= now && _metricPerfStats->boolVal()) {
+				_nextPerfMetricsSeconds = now + 60.0;
+				sendPerfMetrics();
+			}
 			const double framesPerSecondsCap = _framesPerSecondsCap->floatVal();
 			if (framesPerSecondsCap >= 1.0) {
 				if (_nextFrameSeconds > now) {
@@ -548,6 +581,10 @@ AppState App::onConstruct() {
 	_framesPerSecondsCap = core::Var::get(cfg::CoreMaxFPS, "1000.0");
 	// is filled by the application itself - can be used to detect new versions - but as default it's just an empty cvar
 	core::Var::get(cfg::AppVersion, "");
+	core::Var::get(cfg::CoreThreads, "0", _("The amount of worker threads - 0 uses the default of the application"),
+				   core::Var::minMaxValidator<0, 1024>);
+	core::Var::get(cfg::CoreThreadAffinity, "-1",
+				   _("Pin the worker threads to the cores starting at this index - -1 disables the pinning"));
 
 	registerArg("--version").setShort("-v").setDescription(_("Print the version and quit"));
 	registerArg("--help").setShort("-h").setDescription(_("Print this help and quit"));
@@ -558,6 +595,8 @@ AppState App::onConstruct() {
 		logVar->setVal(logLevelVal);
 	}
 	core::Var::get(cfg::MetricFlavor, "");
+	_metricPerfStats = core::Var::get(cfg::MetricPerfStats, "false", _("Send the performance statistics as metrics"),
+									  core::Var::boolValidator);
 	Log::init();
 
 	command::Command::registerCommand("set", [](const command::CmdArgs &args) {
@@ -613,7 +652,13 @@ AppState App::onInit() {
 
 	SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS);
 	Log::debug("Initialize the threadpool");
+	const int threads = core::Var::getSafe(cfg::CoreThreads)->intVal();
+	if (threads > 0) {
+		_threadPool->setThreads(threads);
+	}
+	_threadPool->setAffinity(core::Var::getSafe(cfg::CoreThreadAffinity)->intVal());
 	_threadPool->init();
+	Log::debug("Threadpool size: %i", (int)_threadPool->size());
 
 	Log::debug("Initialize the log system");
 	Log::init();
@@ -1111,6 +1156,9 @@ AppState App::onCleanup() {
 		return AppState::Init;
 	}
 
+	if (_metricPerfStats->boolVal()) {
+		sendPerfMetrics();
+	}
 	metric::count("stop");
 
 	metric::shutdown();
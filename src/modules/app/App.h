@@ -106,6 +106,11 @@ protected:
 	 * The frames to cap the application loop at
 	 */
 	core::VarPtr _framesPerSecondsCap;
+	/**
+	 * @brief Send the performance statistics (see @c core::perfStats()) as metrics
+	 */
+	core::VarPtr _metricPerfStats;
+	double _nextPerfMetricsSeconds = 0.0;
 
 	/**
 	 * @brief If the application failed to init or must be closed due to a failure, you
@@ -9,15 +9,96 @@
 #include "io/Filesystem.h"
 
 #include <SDL.h>
+#include <atomic>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
 
 namespace app {
 
+namespace {
+
+std::atomic<uint64_t> s_allocations{0u};
+std::atomic<uint64_t> s_allocatedBytes{0u};
+SDL_malloc_func s_mallocFunc = nullptr;
+SDL_calloc_func s_callocFunc = nullptr;
+SDL_realloc_func s_reallocFunc = nullptr;
+SDL_free_func s_freeFunc = nullptr;
+
+void *countingMalloc(size_t size) {
+	s_allocations.fetch_add(1u, std::memory_order_relaxed);
+	s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	return s_mallocFunc(size);
+}
+
+void *countingCalloc(size_t nmemb, size_t size) {
+	s_allocations.fetch_add(1u, std::memory_order_relaxed);
+	s_allocatedBytes.fetch_add(nmemb * size, std::memory_order_relaxed);
+	return s_callocFunc(nmemb, size);
+}
+
+void *countingRealloc(void *mem, size_t size) {
+	s_allocations.fetch_add(1u, std::memory_order_relaxed);
+	s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	return s_reallocFunc(mem, size);
+}
+
+} // namespace
+
 SDL_AssertState Test_AssertionHandler(const SDL_AssertData* data, void* userdata) {
 	return SDL_ASSERTION_BREAK;
 }
 
+void AbstractBenchmark::resetAllocations() {
+	s_allocations = 0u;
+	s_allocatedBytes = 0u;
+}
+
+uint64_t AbstractBenchmark::allocations() {
+	return s_allocations;
+}
+
+uint64_t AbstractBenchmark::allocatedBytes() {
+	return s_allocatedBytes;
+}
+
+double AbstractBenchmark::peakResidentBytes() {
+#ifndef _WIN32
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0.0;
+	}
+#ifdef __APPLE__
+	return (double)usage.ru_maxrss;
+#else
+	return (double)usage.ru_maxrss * 1024.0;
+#endif
+#else
+	return 0.0;
+#endif
+}
+
+void AbstractBenchmark::addVoxelCounter(benchmark::State &state, int64_t voxels) {
+	state.counters["voxels/s"] = benchmark::Counter((double)voxels, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void AbstractBenchmark::addBytesCounter(benchmark::State &state, int64_t bytes) {
+	state.SetBytesProcessed((int64_t)state.iterations() * bytes);
+}
+
+void AbstractBenchmark::addMemoryCounters(benchmark::State &state) {
+	state.counters["allocs"] = benchmark::Counter((double)allocations(), benchmark::Counter::kAvgIterations);
+	state.counters["bytes"] = benchmark::Counter((double)allocatedBytes(), benchmark::Counter::kAvgIterations,
+												 benchmark::Counter::kIs1024);
+	state.counters["peak_rss"] =
+		benchmark::Counter(peakResidentBytes(), benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+}
+
 void AbstractBenchmark::SetUp(benchmark::State& st) {
 	SDL_SetAssertionHandler(Test_AssertionHandler, nullptr);
+	SDL_GetMemoryFunctions(&s_mallocFunc, &s_callocFunc, &s_reallocFunc, &s_freeFunc);
+	SDL_SetMemoryFunctions(countingMalloc, countingCalloc, countingRealloc, s_freeFunc);
+	resetAllocations();
 	const io::FilesystemPtr filesystem = core::make_shared<io::Filesystem>();
 	const core::TimeProviderPtr timeProvider = core::make_shared<core::TimeProvider>();
 	_benchmarkApp = new BenchmarkApp(filesystem, timeProvider, this);
@@ -28,6 +109,7 @@ void AbstractBenchmark::TearDown(benchmark::State& st) {
 	core::Var::shutdown();
 	delete _benchmarkApp;
 	_benchmarkApp = nullptr;
+	SDL_SetMemoryFunctions(s_mallocFunc, s_callocFunc, s_reallocFunc, s_freeFunc);
 }
 
 AbstractBenchmark::BenchmarkApp::BenchmarkApp(const io::FilesystemPtr& filesystem, const core::TimeProviderPtr& timeProvider, AbstractBenchmark* benchmark) :
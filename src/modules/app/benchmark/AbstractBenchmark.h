@@ -8,9 +8,20 @@
 #include "app/CommandlineApp.h"
 #include "io/Filesystem.h"
 #include "core/TimeProvider.h"
+#include <stdint.h>
 
 namespace app {
 
+/**
+ * @brief Boots a @c CommandlineApp around a google benchmark fixture
+ *
+ * The allocations of the SDL allocator (this is where @c core_malloc() ends up) are counted while the fixture is set
+ * up - see @c addMemoryCounters(). The data files of a benchmark are copied next to the binary by the
+ * @c engine_add_benchmark() cmake function and are loaded via the filesystem of the app.
+ *
+ * All registered benchmarks are executed by the @c benchmarks-report target - it merges the json output of all
+ * benchmark binaries into @c benchmarks.json in the build directory.
+ */
 class AbstractBenchmark : public benchmark::Fixture {
 private:
 	class BenchmarkApp: public app::CommandlineApp {
@@ -36,6 +47,35 @@ protected:
 		return true;
 	}
 
+	/**
+	 * @brief Resets the allocation counters - call this before the benchmark loop
+	 */
+	static void resetAllocations();
+	static uint64_t allocations();
+	static uint64_t allocatedBytes();
+	/**
+	 * @return The high water mark of the resident set size of the process in bytes or @c 0 if this isn't supported
+	 * on the platform. This is a process wide value - run a single benchmark with @c --benchmark_filter to get the
+	 * value of one benchmark.
+	 */
+	static double peakResidentBytes();
+
+	/**
+	 * @brief Reports the processed voxels per second
+	 * @param voxels The amount of voxels that are processed in one iteration
+	 */
+	void addVoxelCounter(benchmark::State &state, int64_t voxels);
+	/**
+	 * @brief Reports the processed bytes per second
+	 * @param bytes The amount of bytes that are processed in one iteration
+	 */
+	void addBytesCounter(benchmark::State &state, int64_t bytes);
+	/**
+	 * @brief Reports the allocations and the allocated bytes per iteration since the last @c resetAllocations() and
+	 * the peak resident set size
+	 */
+	void addMemoryCounters(benchmark::State &state);
+
 public:
 	virtual void SetUp(benchmark::State& st) override;
 
@@ -14,6 +14,7 @@ namespace command {
 
 Command::CommandMap Command::_cmds;
 core_trace_mutex_static(core::Lock, Command, _lock);
+core::AtomicInt Command::_generation{0};
 core::DynamicArray<core::String> Command::_delayedTokens;
 double Command::_delaySeconds = 0.0;
 size_t  Command::_sortedCommandListSize = 0u;
@@ -29,11 +30,13 @@ Command& Command::registerCommand(const core::String &name, FunctionType&& func)
 	const Command c(name, std::forward<FunctionType>(func));
 	core::ScopedLock lock(_lock);
 	_cmds.put(name, c);
+	_generation.increment();
 	return (Command&)_cmds.find(name)->value;
 }
 
 bool Command::unregisterCommand(const core::String &name) {
 	core::ScopedLock lock(_lock);
+	_generation.increment();
 	return _cmds.remove(name);
 }
 
@@ -53,6 +56,7 @@ ActionButtonCommands Command::registerActionButton(const core::String& name, Act
 	});
 	cReleased.setHelp(help);
 	_cmds.put(cReleased.name(), cReleased);
+	_generation.increment();
 	return ActionButtonCommands(COMMAND_PRESSED + name, COMMAND_RELEASED + name);
 }
 
@@ -62,6 +66,7 @@ bool Command::unregisterActionButton(const core::String& name) {
 	const core::String upB(COMMAND_RELEASED + name);
 	int amount = _cmds.remove(downB);
 	amount += _cmds.remove(upB);
+	_generation.increment();
 	return amount == 2;
 }
 
@@ -173,7 +178,7 @@ bool Command::execute(const core::String& command, const CmdArgs& args) {
 		Log::warn("Skip execution of %s - no arguments provided", command.c_str());
 		return false;
 	}
-	Command cmd;
+	FunctionPtr func;
 	{
 		core::ScopedLock scoped(_lock);
 		auto i = _cmds.find(command);
@@ -191,16 +196,17 @@ bool Command::execute(const core::String& command, const CmdArgs& args) {
 			_delayedTokens.push_back(fullCmd);
 			return true;
 		}
-		cmd = i->second;
+		func = i->second._func;
 	}
 	Log::trace("execute %s with %i arguments", command.c_str(), (int)args.size());
-	cmd._func(args);
+	func->operator()(args);
 	return true;
 }
 
 void Command::shutdown() {
 	core::ScopedLock lock(_lock);
 	_cmds.clear();
+	_generation.increment();
 }
 
 Command& Command::setHelp(const core::String &help) {
@@ -224,4 +230,40 @@ Command& Command::setBoolCompleter() {
 	});
 }
 
+bool CommandHandle::resolve() {
+	const int generation = Command::_generation;
+	if (generation == _generation) {
+		return (bool)_func;
+	}
+	core::ScopedLock lock(Command::_lock);
+	auto i = Command::_cmds.find(_name);
+	if (i == Command::_cmds.end()) {
+		_func = Command::FunctionPtr();
+	} else {
+		_func = i->second._func;
+	}
+	_generation = generation;
+	return (bool)_func;
+}
+
+bool CommandHandle::execute(const CmdArgs &args) {
+	if (Command::_delaySeconds > 0.0) {
+		// the delayed commands are buffered by name
+		return Command::execute(_name, args);
+	}
+	if (!_name.empty() && (_name[0] == COMMAND_PRESSED[0] || _name[0] == COMMAND_RELEASED[0]) && args.empty()) {
+		Log::warn("Skip execution of %s - no arguments provided", _name.c_str());
+		return false;
+	}
+	if (!resolve()) {
+		Log::debug("could not find command callback for %s", _name.c_str());
+		return false;
+	}
+	Log::trace("execute %s with %i arguments", _name.c_str(), (int)args.size());
+	// the handle keeps the function alive - even if the command unregisters itself
+	const Command::FunctionPtr func = _func;
+	func->operator()(args);
+	return true;
+}
+
 }
@@ -6,8 +6,10 @@
 
 #include "core/String.h"
 #include "core/Common.h"
+#include "core/SharedPtr.h"
 #include "core/collection/StringMap.h"
 #include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
 #include "core/concurrent/Lock.h"
 #include "command/ActionButton.h"
 #include <functional>
@@ -35,11 +37,17 @@ struct ActionButtonCommands {
  */
 class Command {
 private:
-	typedef core::StringMap<Command> CommandMap;
+	friend class CommandHandle;
+	// the applications register several hundred commands
+	typedef core::StringMap<Command, 256> CommandMap;
 	typedef std::function<void(const CmdArgs&)> FunctionType;
+	// shared to not copy the function for every execution - and to keep it alive if the command unregisters itself
+	typedef core::SharedPtr<FunctionType> FunctionPtr;
 
 	static CommandMap _cmds core_thread_guarded_by(_lock);
 	static core::Lock _lock;
+	// changed whenever a command is registered or unregistered - see CommandHandle
+	static core::AtomicInt _generation;
 	static size_t _sortedCommandListSize;
 	static Command* _sortedCommandList[4096];
 
@@ -48,7 +56,7 @@ private:
 
 	core::String _name;
 	core::String _help;
-	FunctionType _func;
+	FunctionPtr _func;
 	typedef std::function<int(const core::String&, core::DynamicArray<core::String>& matches)> CompleteFunctionType;
 	mutable CompleteFunctionType _completer;
 
@@ -57,7 +65,7 @@ private:
 	}
 
 	Command(const core::String& name, FunctionType&& func) :
-		_name(name), _func(core::move(func)) {
+		_name(name), _func(core::make_shared<FunctionType>(core::move(func))) {
 	}
 
 	static void updateSortedList();
@@ -141,6 +149,35 @@ public:
 	bool operator==(const Command& rhs) const;
 };
 
+/**
+ * @brief Resolves a command by name once - the execution doesn't need the lookup and doesn't tokenize a command line.
+ *
+ * The command is resolved again if any command was registered or unregistered in the meantime. Use this for commands
+ * that are executed frequently - like key repeats or lua script loops.
+ * @note The handle is not thread safe - every thread needs its own handle.
+ */
+class CommandHandle {
+private:
+	core::String _name;
+	Command::FunctionPtr _func;
+	int _generation = -1;
+
+	bool resolve();
+
+public:
+	CommandHandle(const core::String &name = "") : _name(name) {
+	}
+
+	/**
+	 * @return @c false if the command doesn't exist
+	 */
+	bool execute(const CmdArgs &args = {});
+
+	const core::String &name() const {
+		return _name;
+	}
+};
+
 inline bool Command::operator==(const Command& rhs) const {
 	return rhs._name == _name;
 }
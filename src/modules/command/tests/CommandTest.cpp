@@ -77,4 +77,46 @@ TEST_F(CommandTest, textExecuteSemicolonAsParameter) {
 	EXPECT_EQ(";", parameter);
 }
 
+TEST_F(CommandTest, testHandle) {
+	core::String parameter;
+	Command::registerCommand("testhandle", [&] (const command::CmdArgs& args) {
+		parameter = args.empty() ? "empty" : args[0];
+	});
+	CommandHandle handle("testhandle");
+	EXPECT_TRUE(handle.execute({"42"}));
+	EXPECT_EQ("42", parameter);
+	EXPECT_TRUE(handle.execute());
+	EXPECT_EQ("empty", parameter);
+}
+
+TEST_F(CommandTest, testHandleReregister) {
+	int executed = 0;
+	CommandHandle handle("testhandle");
+	EXPECT_FALSE(handle.execute()) << "The command is not yet registered";
+	Command::registerCommand("testhandle", [&] (const command::CmdArgs&) {
+		executed = 1;
+	});
+	EXPECT_TRUE(handle.execute());
+	EXPECT_EQ(1, executed);
+	Command::registerCommand("testhandle", [&] (const command::CmdArgs&) {
+		executed = 2;
+	});
+	EXPECT_TRUE(handle.execute());
+	EXPECT_EQ(2, executed);
+	EXPECT_TRUE(Command::unregisterCommand("testhandle"));
+	EXPECT_FALSE(handle.execute());
+}
+
+TEST_F(CommandTest, testHandleUnregisterItself) {
+	int executed = 0;
+	Command::registerCommand("testhandle", [&] (const command::CmdArgs&) {
+		++executed;
+		Command::unregisterCommand("testhandle");
+	});
+	CommandHandle handle("testhandle");
+	EXPECT_TRUE(handle.execute());
+	EXPECT_FALSE(handle.execute());
+	EXPECT_EQ(1, executed);
+}
+
 }
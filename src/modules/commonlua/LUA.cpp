@@ -5,6 +5,8 @@
 #include "LUA.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/MemoryTracker.h"
+#include "core/StandardLib.h"
 #include "core/StringUtil.h"
 #include "LUAFunctions.h"
 #include "Trace.h"
@@ -32,6 +34,27 @@ int panicCB(lua_State *L) {
 	return 0;
 }
 
+void *allocCB(void *, void *ptr, size_t osize, size_t nsize) {
+	// if ptr is nullptr osize is the type of the object that is allocated - not a size
+	if (ptr != nullptr) {
+		core::memoryTrackFree(core::MemoryTag::Lua, ptr, osize);
+	}
+	if (nsize == 0u) {
+		core_free(ptr);
+		return nullptr;
+	}
+	void *newPtr = core_realloc(ptr, nsize);
+	if (newPtr == nullptr) {
+		if (ptr != nullptr) {
+			// the old block is still valid if the reallocation failed
+			core::memoryTrackAlloc(core::MemoryTag::Lua, ptr, osize);
+		}
+		return nullptr;
+	}
+	core::memoryTrackAlloc(core::MemoryTag::Lua, newPtr, nsize);
+	return newPtr;
+}
+
 void debugHook(lua_State *L, lua_Debug *ar) {
 	if (!lua_getinfo(L, "Sn", ar)) {
 		return;
@@ -79,7 +102,11 @@ static int clua_print(lua_State *L) {
 void LUA::openState() {
 	_error.clear();
 
-	_state = luaL_newstate();
+	_state = lua_newstate(allocCB, nullptr);
+#if LUA_VERSION_NUM >= 504
+	// luaL_newstate() installs a warning function that is off by default - just ignore the warnings
+	lua_setwarnf(_state, nullptr, nullptr);
+#endif
 
 	luaL_openlibs(_state);
 
@@ -4,6 +4,7 @@
 
 #include "LUAFunctions.h"
 #include "app/App.h"
+#include "command/Command.h"
 #include "command/CommandHandler.h"
 #include "core/GLMConst.h"
 #include "core/Log.h"
@@ -228,9 +229,22 @@ static int clua_cmdexecute(lua_State *s) {
 	return 0;
 }
 
+static int clua_cmdrun(lua_State *s) {
+	const char *cmd = luaL_checkstring(s, 1);
+	const int n = lua_gettop(s);
+	command::CmdArgs args;
+	args.reserve(n - 1);
+	for (int i = 2; i <= n; ++i) {
+		args.push_back(luaL_checkstring(s, i));
+	}
+	lua_pushboolean(s, command::Command::execute(cmd, args));
+	return 1;
+}
+
 void clua_cmdregister(lua_State* s) {
 	const luaL_Reg funcs[] = {
 		{"execute", clua_cmdexecute},
+		{"run", clua_cmdrun},
 		{nullptr, nullptr}
 	};
 	clua_registerfuncsglobal(s, funcs, "_metacmd", "g_cmd");
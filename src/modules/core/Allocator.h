@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief The allocator policies for the @c ALLOCATOR template parameter of the collections
+ */
+
+#pragma once
+
+#include "core/ArenaAllocator.h"
+#include "core/StandardLib.h"
+#include <stddef.h>
+
+namespace core {
+
+/**
+ * @brief Uses @c core_malloc and @c core_free
+ */
+struct MallocAllocator {
+	static inline void *allocate(size_t bytes) {
+		return core_malloc(bytes);
+	}
+	static inline void deallocate(void *ptr, size_t) {
+		core_free(ptr);
+	}
+};
+
+/**
+ * @brief Uses @c core_aligned_malloc and @c core_aligned_free
+ */
+struct AlignedAllocator {
+	static inline void *allocate(size_t bytes) {
+		return core_aligned_malloc(bytes);
+	}
+	static inline void deallocate(void *ptr, size_t) {
+		core_aligned_free(ptr);
+	}
+};
+
+/**
+ * @brief Allocates from the @c ArenaAllocator of the calling thread
+ *
+ * The memory is given back when the enclosing @c FrameAllocatorScope ends - or with @c reset() once per frame on
+ * the main thread. Use this for the temporaries of a task (e.g. the quads of the surface extraction) that would
+ * otherwise hit @c core_malloc over and over again.
+ *
+ * @note A collection with this allocator must not outlive the scope and must not be resized on another thread
+ * than the one that created it. Reading from other threads is fine.
+ * @sa FrameAllocatorScope
+ */
+struct FrameAllocator {
+	static ArenaAllocator &arena();
+
+	static inline void *allocate(size_t bytes) {
+		return arena().allocate(bytes);
+	}
+	static inline void deallocate(void *ptr, size_t bytes) {
+		arena().deallocate(ptr, bytes);
+	}
+	/**
+	 * @brief Gives back all the memory of the frame allocator of the calling thread
+	 * @note There must not be any @c FrameAllocatorScope alive on this thread
+	 */
+	static void reset();
+};
+
+/**
+ * @brief Gives back all the memory of the @c FrameAllocator of the calling thread that was allocated during the
+ * lifetime of this object
+ *
+ * Scopes can be nested - e.g. a task that is executed inline while another task waits for it.
+ */
+class FrameAllocatorScope : public core::NonCopyable {
+private:
+	ArenaAllocator::Marker _marker;
+
+public:
+	FrameAllocatorScope() : _marker(FrameAllocator::arena().mark()) {
+	}
+	~FrameAllocatorScope() {
+		FrameAllocator::arena().rewind(_marker);
+	}
+};
+
+} // namespace core
@@ -0,0 +1,138 @@
+/**
+ * @file
+ */
+
+#include "ArenaAllocator.h"
+#include "core/Allocator.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+
+namespace core {
+
+// core_malloc returns memory that is aligned to at least 16 bytes - the header keeps the data aligned
+static constexpr size_t BlockHeaderSize = 64u;
+static_assert(sizeof(void *) * 3 <= BlockHeaderSize, "Block header doesn't fit");
+
+ArenaAllocator::ArenaAllocator(size_t blockSize) : _blockSize(blockSize) {
+}
+
+ArenaAllocator::~ArenaAllocator() {
+	release();
+}
+
+uint8_t *ArenaAllocator::data(Block *block) {
+	return (uint8_t *)block + BlockHeaderSize;
+}
+
+ArenaAllocator::Block *ArenaAllocator::allocateBlock(size_t minSize) {
+	const size_t size = core_max(_blockSize, minSize);
+	Block *block = (Block *)core_malloc(BlockHeaderSize + size);
+	block->prev = _current;
+	block->size = size;
+	block->used = 0u;
+	_capacity += size;
+	_current = block;
+	return block;
+}
+
+void ArenaAllocator::freeBlock(Block *block) {
+	_capacity -= block->size;
+	core_free(block);
+}
+
+void *ArenaAllocator::allocate(size_t bytes, size_t alignment) {
+	core_assert_msg((alignment & (alignment - 1u)) == 0u && alignment <= DefaultAlignment,
+					"Invalid alignment %i", (int)alignment);
+	if (bytes == 0u) {
+		bytes = 1u;
+	}
+	Block *block = _current;
+	size_t offset = 0u;
+	if (block != nullptr) {
+		offset = (block->used + alignment - 1u) & ~(alignment - 1u);
+	}
+	if (block == nullptr || offset + bytes > block->size) {
+		// the rest of the current block is wasted until the next rewind
+		block = allocateBlock(bytes);
+		offset = 0u;
+	}
+	_used += offset - block->used + bytes;
+	block->used = offset + bytes;
+	_peak = core_max(_peak, _used);
+	return data(block) + offset;
+}
+
+void ArenaAllocator::deallocate(void *ptr, size_t bytes) {
+	if (ptr == nullptr || _current == nullptr) {
+		return;
+	}
+	uint8_t *top = data(_current) + _current->used;
+	if ((uint8_t *)ptr + bytes != top) {
+		return;
+	}
+	_current->used -= bytes;
+	_used -= bytes;
+}
+
+ArenaAllocator::Marker ArenaAllocator::mark() const {
+	Marker marker;
+	marker.block = _current;
+	marker.used = _current != nullptr ? _current->used : 0u;
+	marker.totalUsed = _used;
+	return marker;
+}
+
+void ArenaAllocator::rewind(const Marker &marker) {
+	while (_current != marker.block) {
+		core_assert_msg(_current != nullptr, "The marker doesn't belong to this arena");
+		Block *prev = _current->prev;
+		if (prev == nullptr && marker.block == nullptr) {
+			// keep the first block - everything was given back
+			_current->used = 0u;
+			_used = 0u;
+			return;
+		}
+		freeBlock(_current);
+		_current = prev;
+	}
+	if (_current != nullptr) {
+		_current->used = marker.used;
+	}
+	_used = marker.totalUsed;
+}
+
+void ArenaAllocator::reset() {
+	const size_t peak = _peak;
+	if (_current != nullptr && (_current->prev != nullptr || _current->size > MaxRetainedSize)) {
+		// merge the blocks into one that fits the peak usage of this round
+		release();
+		if (peak <= MaxRetainedSize) {
+			allocateBlock(peak);
+		}
+	} else if (_current != nullptr) {
+		_current->used = 0u;
+	}
+	_used = 0u;
+	_peak = 0u;
+}
+
+void ArenaAllocator::release() {
+	while (_current != nullptr) {
+		Block *prev = _current->prev;
+		freeBlock(_current);
+		_current = prev;
+	}
+	_used = 0u;
+}
+
+ArenaAllocator &FrameAllocator::arena() {
+	static thread_local ArenaAllocator arena;
+	return arena;
+}
+
+void FrameAllocator::reset() {
+	arena().reset();
+}
+
+} // namespace core
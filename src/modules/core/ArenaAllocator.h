@@ -0,0 +1,114 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+
+/**
+ * @brief Bump allocator for transient data
+ *
+ * The memory is taken from blocks that are only given back as a whole - either by rewinding to a @c Marker or by
+ * @c reset(). Freeing single allocations is not possible (except for the last allocation), which makes this useful
+ * for the many small temporaries of a task or a frame that all die at the same time.
+ *
+ * After a @c reset() the used blocks are merged into one block that is big enough for the peak usage - so the
+ * next round doesn't have to allocate anything at all.
+ *
+ * @note Not thread safe - see @c FrameAllocator for the thread local instances
+ * @sa FrameAllocator
+ * @sa PoolAllocator
+ */
+class ArenaAllocator : public core::NonCopyable {
+public:
+	static constexpr size_t DefaultAlignment = 16u;
+	static constexpr size_t DefaultBlockSize = 64u * 1024u;
+	// bigger blocks are given back to the system in reset()
+	static constexpr size_t MaxRetainedSize = 64u * 1024u * 1024u;
+
+private:
+	struct Block {
+		Block *prev;
+		size_t size;
+		size_t used;
+	};
+
+	Block *_current = nullptr;
+	size_t _blockSize;
+	size_t _used = 0u;
+	size_t _capacity = 0u;
+	size_t _peak = 0u;
+
+	static uint8_t *data(Block *block);
+	Block *allocateBlock(size_t minSize);
+	void freeBlock(Block *block);
+
+public:
+	/**
+	 * @brief Remembers the allocation state to give back everything that was allocated afterwards
+	 * @sa rewind()
+	 */
+	struct Marker {
+		Block *block = nullptr;
+		size_t used = 0u;
+		size_t totalUsed = 0u;
+	};
+
+	explicit ArenaAllocator(size_t blockSize = DefaultBlockSize);
+	~ArenaAllocator();
+
+	/**
+	 * @note The memory is not initialized
+	 */
+	void *allocate(size_t bytes, size_t alignment = DefaultAlignment);
+	/**
+	 * @brief Only the memory of the last allocation is given back - everything else is a no-op
+	 */
+	void deallocate(void *ptr, size_t bytes);
+
+	Marker mark() const;
+	/**
+	 * @brief Gives back all the memory that was allocated after the marker was taken
+	 */
+	void rewind(const Marker &marker);
+	/**
+	 * @brief Gives back all allocations - the blocks are kept for the next round
+	 */
+	void reset();
+	/**
+	 * @brief Frees all blocks
+	 */
+	void release();
+
+	/**
+	 * @return The amount of bytes of the currently alive allocations
+	 */
+	size_t used() const;
+	/**
+	 * @return The amount of bytes of all blocks
+	 */
+	size_t capacity() const;
+	/**
+	 * @return The highest amount of used bytes since the last @c reset()
+	 */
+	size_t peak() const;
+};
+
+inline size_t ArenaAllocator::used() const {
+	return _used;
+}
+
+inline size_t ArenaAllocator::capacity() const {
+	return _capacity;
+}
+
+inline size_t ArenaAllocator::peak() const {
+	return _peak;
+}
+
+} // namespace core
@@ -6,6 +6,9 @@
 
 #include "core/String.h"
 #include <stdint.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace core {
 
@@ -35,4 +38,60 @@ inline int countSetBits(uint32_t number) {
 	return count;
 }
 
+/**
+ * @return The amount of set bits
+ */
+inline int popCount(uint64_t number) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(number);
+#else
+	number = number - ((number >> 1) & UINT64_C(0x5555555555555555));
+	number = (number & UINT64_C(0x3333333333333333)) + ((number >> 2) & UINT64_C(0x3333333333333333));
+	number = (number + (number >> 4)) & UINT64_C(0x0F0F0F0F0F0F0F0F);
+	return (int)((number * UINT64_C(0x0101010101010101)) >> 56);
+#endif
+}
+
+/**
+ * @return The index of the lowest set bit
+ * @note The result is undefined for @c 0
+ */
+inline int countTrailingZeros(uint64_t number) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(number);
+#elif defined(_MSC_VER) && defined(_WIN64)
+	unsigned long index;
+	_BitScanForward64(&index, number);
+	return (int)index;
+#else
+	int count = 0;
+	while ((number & 1u) == 0u) {
+		number >>= 1;
+		++count;
+	}
+	return count;
+#endif
+}
+
+/**
+ * @return The amount of zero bits above the highest set bit
+ * @note The result is undefined for @c 0
+ */
+inline int countLeadingZeros(uint64_t number) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_clzll(number);
+#elif defined(_MSC_VER) && defined(_WIN64)
+	unsigned long index;
+	_BitScanReverse64(&index, number);
+	return 63 - (int)index;
+#else
+	int count = 0;
+	while ((number & (UINT64_C(1) << 63)) == 0u) {
+		number <<= 1;
+		++count;
+	}
+	return count;
+#endif
+}
+
 } // namespace core
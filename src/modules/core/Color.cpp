@@ -12,6 +12,7 @@
 #include "core/StringUtil.h"
 #include "core/collection/Buffer.h"
 #include "core/collection/DynamicArray.h"
+#include "core/concurrent/Parallel.h"
 #include "math/Octree.h"
 #include <glm/ext/scalar_integer.hpp>
 #include <glm/glm.hpp>
@@ -22,10 +23,10 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #endif
 #include <glm/gtx/color_space.hpp>
+#include <glm/gtx/norm.hpp>
 #include <glm/gtx/type_aligned.hpp>
 
 #include <SDL.h>
-#include <random>
 #include <stdio.h>
 
 namespace core {
@@ -338,63 +339,6 @@ static int quantizeOctree(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA
 	return (int)n;
 }
 
-static inline float getDistance(const glm::vec4 &p1, const glm::vec4 &p2) {
-	return glm::length(p1 - p2);
-}
-
-static int quantizeKMeans(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
-	core::DynamicArray<glm::vec4> centers;
-	centers.resize(maxTargetBufColors);
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<> dis(0, (int)inputBufColors - 1);
-	for (int i = 0; i < (int)maxTargetBufColors; i++) {
-		centers[i] = core::Color::fromRGBA(inputBuf[dis(gen)]);
-	}
-
-	bool changed = true;
-	while (changed) {
-		changed = false;
-		core::DynamicArray<core::DynamicArray<glm::vec4>> clusters(maxTargetBufColors);
-		for (size_t i = 0; i < inputBufColors; ++i) {
-			const glm::vec4 point = core::Color::fromRGBA(inputBuf[i]);
-			int closest = 0;
-			float closestDistance = getDistance(point, centers[0]);
-			for (int n = 1; n < (int)maxTargetBufColors; n++) {
-				float d = getDistance(point, centers[n]);
-				if (d < closestDistance) {
-					closest = n;
-					closestDistance = d;
-				}
-			}
-			clusters[closest].push_back(point);
-		}
-		for (int i = 0; i < (int)maxTargetBufColors; i++) {
-			if (clusters[i].empty()) {
-				continue;
-			}
-			glm::vec4 newCenter(0.0f);
-			for (const glm::vec4 &point : clusters[i]) {
-				newCenter += point;
-			}
-			newCenter /= clusters[i].size();
-			if (getDistance(newCenter, centers[i]) > 0.0001f) {
-				centers[i] = newCenter;
-				changed = true;
-			}
-		}
-	}
-
-	size_t n = 0;
-	for (const glm::vec4 &c : centers) {
-		targetBuf[n++] = core::Color::getRGBA(c);
-	}
-	for (size_t i = n; i < maxTargetBufColors; ++i) {
-		targetBuf[i] = RGBA(0xFFFFFFFFU);
-	}
-	return (int)n;
-}
-
 // Based on NeuQuant algorithm from jo_gif_quantize
 static int quantizeNeuQuant(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
 	const int numColors = (int)maxTargetBufColors;
@@ -541,140 +485,531 @@ static int quantizeNeuQuant(RGBA *targetBuf, size_t maxTargetBufColors, const RG
 	return numColors;
 }
 
-static int quantizeWu(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
-	core::Buffer<RGBA> pixels;
-	pixels.append(inputBuf, inputBufColors);
+/**
+ * @brief Color histogram with 5 bits per channel - the base for the Wu and k-means color reduction
+ *
+ * Index @c 0 of each axis stays empty for the cumulative moments of Wu's algorithm.
+ */
+struct ColorHistogram {
+	static constexpr int Bits = 5;
+	static constexpr int Size = (1 << Bits) + 1;
+	struct Cell {
+		uint64_t weight = 0u;
+		uint64_t r = 0u;
+		uint64_t g = 0u;
+		uint64_t b = 0u;
+		uint64_t sq = 0u;
+	};
+	core::DynamicArray<Cell> cells;
 
-	// Initialize the set of boxes with the full color range
-	core::DynamicArray<ColorBox> boxes;
-	boxes.emplace_back(ColorBox{{0, 0, 0, 255}, {255, 255, 255, 255}, pixels});
+	ColorHistogram() {
+		cells.resize(Size * Size * Size);
+	}
 
-	// Iterate until we reach the desired number of boxes
-	while (boxes.size() < maxTargetBufColors) {
-		// Find the box with the largest volume (i.e., the most pixels)
-		int maxVolume = std::numeric_limits<int>::min();
-		size_t maxVolumeIndex = 0;
-		for (size_t i = 0; i < boxes.size(); ++i) {
-			int volume = (boxes[i].max.r - boxes[i].min.r + 1) * (boxes[i].max.g - boxes[i].min.g + 1) *
-						 (boxes[i].max.b - boxes[i].min.b + 1);
-			if (volume > maxVolume) {
-				maxVolume = volume;
-				maxVolumeIndex = i;
-			}
+	static inline int index(int r, int g, int b) {
+		return (r * Size + g) * Size + b;
+	}
+
+	inline void add(RGBA color) {
+		Cell &cell = cells[index((color.r >> (8 - Bits)) + 1, (color.g >> (8 - Bits)) + 1, (color.b >> (8 - Bits)) + 1)];
+		++cell.weight;
+		cell.r += color.r;
+		cell.g += color.g;
+		cell.b += color.b;
+		cell.sq += color.r * color.r + color.g * color.g + color.b * color.b;
+	}
+
+	void merge(const ColorHistogram &other) {
+		for (size_t i = 0; i < cells.size(); ++i) {
+			const Cell &o = other.cells[i];
+			Cell &cell = cells[i];
+			cell.weight += o.weight;
+			cell.r += o.r;
+			cell.g += o.g;
+			cell.b += o.b;
+			cell.sq += o.sq;
+		}
+	}
+};
+
+/**
+ * @brief Minimum amount of colors per slice - below that the histogram is built on the calling thread
+ */
+static constexpr size_t HistogramSliceColors = 16384;
+/**
+ * @brief Every slice needs its own histogram of ~1.4MB
+ */
+static constexpr int MaxHistogramSlices = 8;
+
+static void buildHistogram(ColorHistogram &histogram, const RGBA *inputBuf, size_t inputBufColors,
+						   core::ThreadPool *threadPool) {
+	const int extent = (int)core_min(inputBufColors / HistogramSliceColors, (size_t)MaxHistogramSlices);
+	const int slices = core_min(core::parallelSliceCount(threadPool, core_max(extent, 1)), MaxHistogramSlices);
+	if (slices <= 1) {
+		for (size_t i = 0; i < inputBufColors; ++i) {
+			histogram.add(inputBuf[i]);
+		}
+		return;
+	}
+	core::DynamicArray<ColorHistogram> partial;
+	partial.resize(slices);
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		const size_t lower = inputBufColors * slice / slices;
+		const size_t upper = inputBufColors * (slice + 1) / slices;
+		for (size_t i = lower; i < upper; ++i) {
+			partial[slice].add(inputBuf[i]);
 		}
+	});
+	// the sums are integers - the result doesn't depend on the amount of slices
+	for (const ColorHistogram &h : partial) {
+		histogram.merge(h);
+	}
+}
 
-		// Split the box with the largest volume into two boxes along its longest dimension
-		const ColorBox &box = boxes[maxVolumeIndex];
-		const size_t pixelCount = box.pixels.size();
-		if (pixelCount <= 0) {
-			boxes.erase(maxVolumeIndex);
-			continue;
+/**
+ * @brief Xiaolin Wu's color quantizer (Graphics Gems II) - the boxes of the histogram are split greedily at the
+ * position that reduces the variance the most
+ */
+class WuQuantizer {
+private:
+	static constexpr int Size = ColorHistogram::Size;
+	enum Axis { Red, Green, Blue };
+	struct Box {
+		int r0, r1;
+		int g0, g1;
+		int b0, b1;
+		int vol;
+	};
+	// cumulative moments
+	core::DynamicArray<int64_t> _wt, _mr, _mg, _mb;
+	core::DynamicArray<double> _m2;
+
+	static inline int index(int r, int g, int b) {
+		return ColorHistogram::index(r, g, b);
+	}
+
+	template<typename T>
+	static T vol(const Box &c, const core::DynamicArray<T> &m) {
+		return m[index(c.r1, c.g1, c.b1)] - m[index(c.r1, c.g1, c.b0)] - m[index(c.r1, c.g0, c.b1)] +
+			   m[index(c.r1, c.g0, c.b0)] - m[index(c.r0, c.g1, c.b1)] + m[index(c.r0, c.g1, c.b0)] +
+			   m[index(c.r0, c.g0, c.b1)] - m[index(c.r0, c.g0, c.b0)];
+	}
+
+	static int64_t bottom(const Box &c, Axis dir, const core::DynamicArray<int64_t> &m) {
+		switch (dir) {
+		case Red:
+			return -m[index(c.r0, c.g1, c.b1)] + m[index(c.r0, c.g1, c.b0)] + m[index(c.r0, c.g0, c.b1)] -
+				   m[index(c.r0, c.g0, c.b0)];
+		case Green:
+			return -m[index(c.r1, c.g0, c.b1)] + m[index(c.r1, c.g0, c.b0)] + m[index(c.r0, c.g0, c.b1)] -
+				   m[index(c.r0, c.g0, c.b0)];
+		case Blue:
+		default:
+			return -m[index(c.r1, c.g1, c.b0)] + m[index(c.r1, c.g0, c.b0)] + m[index(c.r0, c.g1, c.b0)] -
+				   m[index(c.r0, c.g0, c.b0)];
 		}
+	}
 
-		int component = 0;
-		int midpoint = 0;
-		if (box.max.r - box.min.r > box.max.g - box.min.g && box.max.r - box.min.r > box.max.b - box.min.b) {
-			component = 0;
-			midpoint = (box.min.r + box.max.r) / 2;
-		} else if (box.max.g - box.min.g > box.max.b - box.min.b) {
-			component = 1;
-			midpoint = (box.min.g + box.max.g) / 2;
-		} else {
-			component = 2;
-			midpoint = (box.min.b + box.max.b) / 2;
-		}
-
-		ColorBox box1, box2;
-		box1.pixels.reserve(pixelCount / 2);
-		box2.pixels.reserve(pixelCount / 2);
-		switch (component) {
-		case 0:
-			box1.min = box.min;
-			box1.max = RGBA(midpoint, box.max.g, box.max.b, 255);
-			box2.min = RGBA(midpoint + 1, box.min.g, box.min.b, 255);
-			box2.max = box.max;
-			for (const RGBA &pixel : box.pixels) {
-				if (pixel.r <= midpoint) {
-					box1.pixels.push_back(pixel);
-				} else {
-					box2.pixels.push_back(pixel);
-				}
+	static int64_t top(const Box &c, Axis dir, int pos, const core::DynamicArray<int64_t> &m) {
+		switch (dir) {
+		case Red:
+			return m[index(pos, c.g1, c.b1)] - m[index(pos, c.g1, c.b0)] - m[index(pos, c.g0, c.b1)] +
+				   m[index(pos, c.g0, c.b0)];
+		case Green:
+			return m[index(c.r1, pos, c.b1)] - m[index(c.r1, pos, c.b0)] - m[index(c.r0, pos, c.b1)] +
+				   m[index(c.r0, pos, c.b0)];
+		case Blue:
+		default:
+			return m[index(c.r1, c.g1, pos)] - m[index(c.r1, c.g0, pos)] - m[index(c.r0, c.g1, pos)] +
+				   m[index(c.r0, c.g0, pos)];
+		}
+	}
+
+	double variance(const Box &c) const {
+		const double dr = (double)vol(c, _mr);
+		const double dg = (double)vol(c, _mg);
+		const double db = (double)vol(c, _mb);
+		const double xx = vol(c, _m2);
+		return xx - (dr * dr + dg * dg + db * db) / (double)vol(c, _wt);
+	}
+
+	double maximize(const Box &c, Axis dir, int first, int last, int &cut, int64_t wholeR, int64_t wholeG,
+					int64_t wholeB, int64_t wholeW) const {
+		const int64_t baseR = bottom(c, dir, _mr);
+		const int64_t baseG = bottom(c, dir, _mg);
+		const int64_t baseB = bottom(c, dir, _mb);
+		const int64_t baseW = bottom(c, dir, _wt);
+		double max = 0.0;
+		cut = -1;
+		for (int i = first; i < last; ++i) {
+			const int64_t halfW1 = baseW + top(c, dir, i, _wt);
+			if (halfW1 == 0) {
+				continue;
+			}
+			const int64_t halfW2 = wholeW - halfW1;
+			if (halfW2 == 0) {
+				continue;
+			}
+			double halfR = (double)(baseR + top(c, dir, i, _mr));
+			double halfG = (double)(baseG + top(c, dir, i, _mg));
+			double halfB = (double)(baseB + top(c, dir, i, _mb));
+			double temp = (halfR * halfR + halfG * halfG + halfB * halfB) / (double)halfW1;
+			halfR = (double)wholeR - halfR;
+			halfG = (double)wholeG - halfG;
+			halfB = (double)wholeB - halfB;
+			temp += (halfR * halfR + halfG * halfG + halfB * halfB) / (double)halfW2;
+			if (temp > max) {
+				max = temp;
+				cut = i;
 			}
+		}
+		return max;
+	}
+
+	bool cut(Box &set1, Box &set2) const {
+		const int64_t wholeR = vol(set1, _mr);
+		const int64_t wholeG = vol(set1, _mg);
+		const int64_t wholeB = vol(set1, _mb);
+		const int64_t wholeW = vol(set1, _wt);
+		int cutR, cutG, cutB;
+		const double maxR = maximize(set1, Red, set1.r0 + 1, set1.r1, cutR, wholeR, wholeG, wholeB, wholeW);
+		const double maxG = maximize(set1, Green, set1.g0 + 1, set1.g1, cutG, wholeR, wholeG, wholeB, wholeW);
+		const double maxB = maximize(set1, Blue, set1.b0 + 1, set1.b1, cutB, wholeR, wholeG, wholeB, wholeW);
+
+		Axis dir;
+		if (maxR >= maxG && maxR >= maxB) {
+			dir = Red;
+			if (cutR < 0) {
+				// the box can't be split
+				return false;
+			}
+		} else if (maxG >= maxR && maxG >= maxB) {
+			dir = Green;
+		} else {
+			dir = Blue;
+		}
+
+		set2.r1 = set1.r1;
+		set2.g1 = set1.g1;
+		set2.b1 = set1.b1;
+		switch (dir) {
+		case Red:
+			set2.r0 = set1.r1 = cutR;
+			set2.g0 = set1.g0;
+			set2.b0 = set1.b0;
+			break;
+		case Green:
+			set2.g0 = set1.g1 = cutG;
+			set2.r0 = set1.r0;
+			set2.b0 = set1.b0;
 			break;
-		case 1:
-			box1.min = box.min;
-			box1.max = RGBA(box.max.r, midpoint, box.max.b, 255);
-			box2.min = RGBA(box.min.r, midpoint + 1, box.min.b, 255);
-			box2.max = box.max;
-			for (const RGBA &pixel : box.pixels) {
-				if (pixel.g <= midpoint) {
-					box1.pixels.push_back(pixel);
-				} else {
-					box2.pixels.push_back(pixel);
+		case Blue:
+			set2.b0 = set1.b1 = cutB;
+			set2.r0 = set1.r0;
+			set2.g0 = set1.g0;
+			break;
+		}
+		set1.vol = (set1.r1 - set1.r0) * (set1.g1 - set1.g0) * (set1.b1 - set1.b0);
+		set2.vol = (set2.r1 - set2.r0) * (set2.g1 - set2.g0) * (set2.b1 - set2.b0);
+		return true;
+	}
+
+public:
+	WuQuantizer(const ColorHistogram &histogram) {
+		const int n = Size * Size * Size;
+		_wt.resize(n);
+		_mr.resize(n);
+		_mg.resize(n);
+		_mb.resize(n);
+		_m2.resize(n);
+		for (int i = 0; i < n; ++i) {
+			const ColorHistogram::Cell &cell = histogram.cells[i];
+			_wt[i] = (int64_t)cell.weight;
+			_mr[i] = (int64_t)cell.r;
+			_mg[i] = (int64_t)cell.g;
+			_mb[i] = (int64_t)cell.b;
+			_m2[i] = (double)cell.sq;
+		}
+		// compute the cumulative moments
+		for (int r = 1; r < Size; ++r) {
+			int64_t areaW[Size] = {}, areaR[Size] = {}, areaG[Size] = {}, areaB[Size] = {};
+			double area2[Size] = {};
+			for (int g = 1; g < Size; ++g) {
+				int64_t lineW = 0, lineR = 0, lineG = 0, lineB = 0;
+				double line2 = 0.0;
+				for (int b = 1; b < Size; ++b) {
+					const int ind1 = index(r, g, b);
+					lineW += _wt[ind1];
+					lineR += _mr[ind1];
+					lineG += _mg[ind1];
+					lineB += _mb[ind1];
+					line2 += _m2[ind1];
+					areaW[b] += lineW;
+					areaR[b] += lineR;
+					areaG[b] += lineG;
+					areaB[b] += lineB;
+					area2[b] += line2;
+					const int ind2 = index(r - 1, g, b);
+					_wt[ind1] = _wt[ind2] + areaW[b];
+					_mr[ind1] = _mr[ind2] + areaR[b];
+					_mg[ind1] = _mg[ind2] + areaG[b];
+					_mb[ind1] = _mb[ind2] + areaB[b];
+					_m2[ind1] = _m2[ind2] + area2[b];
 				}
 			}
-			break;
-		case 2:
-			box1.min = box.min;
-			box1.max = RGBA(box.max.r, box.max.g, midpoint);
-			box2.min = RGBA(box.min.r, box.min.g, midpoint + 1);
-			box2.max = box.max;
-			for (const RGBA &pixel : box.pixels) {
-				if (pixel.b <= midpoint) {
-					box1.pixels.push_back(pixel);
-				} else {
-					box2.pixels.push_back(pixel);
+		}
+	}
+
+	/**
+	 * @return The amount of colors - might be less than requested if the histogram can't be split any further
+	 */
+	int quantize(RGBA *targetBuf, int maxColors) const {
+		core::DynamicArray<Box> cubes;
+		core::DynamicArray<double> vv;
+		cubes.resize(maxColors);
+		vv.resize(maxColors);
+		cubes[0] = Box{0, Size - 1, 0, Size - 1, 0, Size - 1, 0};
+		int next = 0;
+		int colors = maxColors;
+		for (int i = 1; i < maxColors; ++i) {
+			if (cut(cubes[next], cubes[i])) {
+				vv[next] = cubes[next].vol > 1 ? variance(cubes[next]) : 0.0;
+				vv[i] = cubes[i].vol > 1 ? variance(cubes[i]) : 0.0;
+			} else {
+				vv[next] = 0.0;
+				--i;
+			}
+			next = 0;
+			double temp = vv[0];
+			for (int k = 1; k <= i; ++k) {
+				if (vv[k] > temp) {
+					temp = vv[k];
+					next = k;
 				}
 			}
-			break;
+			if (temp <= 0.0) {
+				colors = i + 1;
+				break;
+			}
+		}
+
+		int n = 0;
+		for (int k = 0; k < colors; ++k) {
+			const int64_t weight = vol(cubes[k], _wt);
+			if (weight <= 0) {
+				continue;
+			}
+			targetBuf[n++] = RGBA((uint8_t)(vol(cubes[k], _mr) / weight), (uint8_t)(vol(cubes[k], _mg) / weight),
+								  (uint8_t)(vol(cubes[k], _mb) / weight), 255);
 		}
+		return n;
+	}
+};
 
-		// Replace the original box with the two split boxes
-		boxes.erase(maxVolumeIndex);
-		boxes.emplace_back(core::move(box1));
-		boxes.emplace_back(core::move(box2));
+static int copyColors(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
+	size_t n;
+	for (n = 0; n < inputBufColors; ++n) {
+		targetBuf[n] = inputBuf[n];
 	}
+	for (size_t i = n; i < maxTargetBufColors; ++i) {
+		targetBuf[i] = RGBA(255, 255, 255, 255);
+	}
+	return (int)n;
+}
 
+/**
+ * @brief Collects the distinct colors of the input - sorted by their value to keep the result deterministic
+ */
+static void distinctColors(const RGBA *inputBuf, size_t inputBufColors, core::DynamicArray<RGBA> &distinct) {
+	distinct.resize(inputBufColors);
+	for (size_t i = 0; i < inputBufColors; ++i) {
+		distinct[i] = inputBuf[i];
+	}
+	core::sort(distinct.begin(), distinct.end(), [](const RGBA &lhs, const RGBA &rhs) { return lhs.rgba < rhs.rgba; });
 	size_t n = 0;
-	for (const ColorBox &box : boxes) {
-		if (box.pixels.empty()) {
-			continue;
+	for (size_t i = 0; i < distinct.size(); ++i) {
+		if (n == 0 || distinct[n - 1] != distinct[i]) {
+			distinct[n++] = distinct[i];
 		}
-		RGBA average(0, 0, 0, 255);
-		for (const RGBA &pixel : box.pixels) {
-			average.r += pixel.r;
-			average.g += pixel.g;
-			average.b += pixel.b;
+	}
+	distinct.resize(n);
+}
+
+/**
+ * @brief The histogram cells limit the amount of colors of Wu's quantizer - the free slots are filled with the input
+ * colors that are the farthest away from the colors that were already picked
+ * @return The new amount of colors
+ */
+static int addFarthestColors(RGBA *targetBuf, int n, int maxColors, const core::DynamicArray<RGBA> &distinct) {
+	if (n >= maxColors || distinct.empty()) {
+		return n;
+	}
+	core::DynamicArray<int> distance;
+	distance.resize(distinct.size());
+	auto distanceTo = [](RGBA a, RGBA b) {
+		const int dr = (int)a.r - (int)b.r;
+		const int dg = (int)a.g - (int)b.g;
+		const int db = (int)a.b - (int)b.b;
+		return dr * dr + dg * dg + db * db;
+	};
+	for (size_t i = 0; i < distinct.size(); ++i) {
+		int closest = INT32_MAX;
+		for (int c = 0; c < n; ++c) {
+			closest = core_min(closest, distanceTo(distinct[i], targetBuf[c]));
 		}
-		average.r /= box.pixels.size();
-		average.g /= box.pixels.size();
-		average.b /= box.pixels.size();
-		targetBuf[n++] = average;
+		distance[i] = closest;
 	}
+	while (n < maxColors) {
+		size_t farthest = 0;
+		for (size_t i = 1; i < distinct.size(); ++i) {
+			if (distance[i] > distance[farthest]) {
+				farthest = i;
+			}
+		}
+		if (distance[farthest] <= 0) {
+			break;
+		}
+		const RGBA color(distinct[farthest].r, distinct[farthest].g, distinct[farthest].b, 255);
+		targetBuf[n++] = color;
+		for (size_t i = 0; i < distinct.size(); ++i) {
+			distance[i] = core_min(distance[i], distanceTo(distinct[i], color));
+		}
+	}
+	return n;
+}
 
+static int quantizeWu(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors,
+					  core::ThreadPool *threadPool) {
+	core::DynamicArray<RGBA> distinct;
+	distinctColors(inputBuf, inputBufColors, distinct);
+	if (distinct.size() <= maxTargetBufColors) {
+		return copyColors(targetBuf, maxTargetBufColors, distinct.data(), distinct.size());
+	}
+	ColorHistogram histogram;
+	buildHistogram(histogram, inputBuf, inputBufColors, threadPool);
+	const WuQuantizer wu(histogram);
+	int n = wu.quantize(targetBuf, (int)maxTargetBufColors);
+	n = addFarthestColors(targetBuf, n, (int)maxTargetBufColors, distinct);
 	for (size_t i = n; i < maxTargetBufColors; ++i) {
 		targetBuf[i] = RGBA(0xFFFFFFFFU);
 	}
-	return (int)n;
+	return n;
 }
 
-int Color::quantize(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors,
-					ColorReductionType type) {
-	if (inputBufColors <= maxTargetBufColors) {
-		size_t n;
-		for (n = 0; n < inputBufColors; ++n) {
-			targetBuf[n] = inputBuf[n];
+/**
+ * @brief Refines the colors of Wu's quantizer with k-means iterations over the occupied histogram cells
+ *
+ * Centers that don't get any histogram cells assigned (e.g. the colors that were added by addFarthestColors()) keep
+ * their color.
+ * The sums are integers - so the result doesn't depend on the amount of threads.
+ */
+static int quantizeKMeans(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors,
+						  core::ThreadPool *threadPool) {
+	core::DynamicArray<RGBA> distinct;
+	distinctColors(inputBuf, inputBufColors, distinct);
+	if (distinct.size() <= maxTargetBufColors) {
+		return copyColors(targetBuf, maxTargetBufColors, distinct.data(), distinct.size());
+	}
+	ColorHistogram histogram;
+	buildHistogram(histogram, inputBuf, inputBufColors, threadPool);
+	int k = WuQuantizer(histogram).quantize(targetBuf, (int)maxTargetBufColors);
+	k = addFarthestColors(targetBuf, k, (int)maxTargetBufColors, distinct);
+	for (size_t i = k; i < maxTargetBufColors; ++i) {
+		targetBuf[i] = RGBA(0xFFFFFFFFU);
+	}
+	if (k <= 1) {
+		return k;
+	}
+
+	core::DynamicArray<const ColorHistogram::Cell *> cells;
+	for (const ColorHistogram::Cell &cell : histogram.cells) {
+		if (cell.weight > 0u) {
+			cells.push_back(&cell);
 		}
-		for (size_t i = n; i < maxTargetBufColors; ++i) {
-			targetBuf[i] = RGBA(255, 255, 255, 255);
+	}
+	core::DynamicArray<glm::vec3> centers;
+	centers.reserve(k);
+	for (int i = 0; i < k; ++i) {
+		centers.push_back(glm::vec3(targetBuf[i].r, targetBuf[i].g, targetBuf[i].b));
+	}
+
+	struct Sum {
+		uint64_t weight = 0u;
+		uint64_t r = 0u;
+		uint64_t g = 0u;
+		uint64_t b = 0u;
+	};
+	const int cellCount = (int)cells.size();
+	const int slices = core::parallelSliceCount(threadPool, cellCount);
+	core::DynamicArray<Sum> sums;
+	const int maxIterations = 8;
+	for (int iteration = 0; iteration < maxIterations; ++iteration) {
+		sums.clear();
+		sums.resize((size_t)slices * k);
+		core::parallelSlices(threadPool, slices, [&](int slice) {
+			Sum *sliceSums = &sums[(size_t)slice * k];
+			const int lower = cellCount * slice / slices;
+			const int upper = cellCount * (slice + 1) / slices;
+			for (int i = lower; i < upper; ++i) {
+				const ColorHistogram::Cell &cell = *cells[i];
+				const glm::vec3 mean = glm::vec3((float)cell.r, (float)cell.g, (float)cell.b) / (float)cell.weight;
+				int closest = 0;
+				float closestDistance = glm::distance2(mean, centers[0]);
+				for (int c = 1; c < k; ++c) {
+					const float d = glm::distance2(mean, centers[c]);
+					if (d < closestDistance) {
+						closestDistance = d;
+						closest = c;
+					}
+				}
+				Sum &sum = sliceSums[closest];
+				sum.weight += cell.weight;
+				sum.r += cell.r;
+				sum.g += cell.g;
+				sum.b += cell.b;
+			}
+		});
+		bool changed = false;
+		for (int c = 0; c < k; ++c) {
+			Sum total;
+			for (int slice = 0; slice < slices; ++slice) {
+				const Sum &sum = sums[(size_t)slice * k + c];
+				total.weight += sum.weight;
+				total.r += sum.r;
+				total.g += sum.g;
+				total.b += sum.b;
+			}
+			if (total.weight == 0u) {
+				continue;
+			}
+			const glm::vec3 center = glm::vec3((float)total.r, (float)total.g, (float)total.b) / (float)total.weight;
+			if (glm::distance2(center, centers[c]) > 0.25f) {
+				changed = true;
+			}
+			centers[c] = center;
 		}
-		return (int)n;
+		if (!changed) {
+			break;
+		}
+	}
+
+	for (int i = 0; i < k; ++i) {
+		const glm::vec3 c = glm::round(centers[i]);
+		targetBuf[i] = RGBA((uint8_t)c.r, (uint8_t)c.g, (uint8_t)c.b, 255);
+	}
+	return k;
+}
+
+int Color::quantize(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors,
+					ColorReductionType type, core::ThreadPool *threadPool) {
+	if (inputBufColors <= maxTargetBufColors) {
+		return copyColors(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
 	}
 	switch (type) {
 	case ColorReductionType::Wu:
-		return quantizeWu(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
+		return quantizeWu(targetBuf, maxTargetBufColors, inputBuf, inputBufColors, threadPool);
 	case ColorReductionType::KMeans:
-		return quantizeKMeans(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
+		return quantizeKMeans(targetBuf, maxTargetBufColors, inputBuf, inputBufColors, threadPool);
 	case ColorReductionType::NeuQuant:
 		return quantizeNeuQuant(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
 	case ColorReductionType::Octree:
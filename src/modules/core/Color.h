@@ -13,6 +13,8 @@
 
 namespace core {
 
+class ThreadPool;
+
 class Color {
 public:
 	static const uint32_t magnitude = 255;
@@ -74,9 +76,11 @@ public:
 	static const char* toColorReductionTypeString(Color::ColorReductionType type);
 
 	/**
+	 * @note Wu and k-means work on a color histogram with 5 bits per channel - the histogram and the k-means
+	 * iterations are computed on the given thread pool (if any)
 	 * @return @c -1 on error or the amount of @code colors <= maxTargetBufColors @endcode
 	 */
-	static int quantize(RGBA* targetBuf, size_t maxTargetBufColors, const RGBA* inputBuf, size_t inputBufColors, ColorReductionType type = ColorReductionType::MedianCut);
+	static int quantize(RGBA* targetBuf, size_t maxTargetBufColors, const RGBA* inputBuf, size_t inputBufColors, ColorReductionType type = ColorReductionType::MedianCut, core::ThreadPool *threadPool = nullptr);
 
 	static inline glm::vec4 fromRGBA(const RGBA rgba) {
 		return fromRGBA(rgba.r, rgba.g, rgba.b, rgba.a);
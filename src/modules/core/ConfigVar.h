@@ -13,10 +13,14 @@ constexpr const char *ClientMultiSampleSamples = "cl_multisamplesamples";
 constexpr const char *ClientMultiSampleBuffers = "cl_multisamplebuffers";
 constexpr const char *ClientShadowMapSize = "cl_shadowmapsize";
 constexpr const char *ClientOpenGLVersion = "cl_openglversion";
+// store the linked shader programs in the home directory and load them instead of compiling the shaders again
+constexpr const char *ClientShaderCache = "cl_shadercache";
 constexpr const char *ClientRenderUI = "cl_renderui";
 constexpr const char *ClientWindowDisplay = "cl_display";
 constexpr const char *ClientWindowHighDPI = "cl_highdpi";
 constexpr const char *UIShowMetrics = "ui_showmetrics";
+// show the gpu times of the render passes in an overlay
+constexpr const char *UIShowGPUTimes = "ui_showgputimes";
 constexpr const char *UIFontSize = "ui_fontsize";
 constexpr const char *UIKeyMap = "ui_keymap";
 constexpr const char *UILastDirectory = "ui_lastdirectory";
@@ -30,9 +34,12 @@ constexpr const char *UIMultiMonitor = "ui_multimonitor";
 constexpr const char *UIBookmarks = "ui_bookmarks";
 
 constexpr const char *AssetPanelLocalDirectory = "ui_assetlocaldirectory";
+constexpr const char *AssetPanelLocalDepth = "ui_assetlocaldepth";
 
 constexpr const char *HttpConnectTimeout = "http_connecttimeout";
 constexpr const char *HttpTimeout = "http_timeout";
+constexpr const char *HttpCacheMaxAge = "http_cachemaxage";
+constexpr const char *HttpCacheSize = "http_cachesize";
 
 constexpr const char *ClientGamma = "cl_gamma";
 constexpr const char *ClientShadowMap = "cl_shadowmap";
@@ -55,10 +62,37 @@ constexpr const char *CoreSysLog = "core_syslog";
 constexpr const char *CorePath = "core_path";
 constexpr const char *CoreColorReduction = "core_colorreduction";
 constexpr const char *CoreLanguage = "core_language";
+// the amount of worker threads of the application thread pool - 0 uses the default of the application
+constexpr const char *CoreThreads = "core_threads";
+// pin the worker threads to the cores starting at the given core index - -1 disables the pinning. Use different
+// values for processes that run in parallel on the same machine to keep them from sharing cores
+constexpr const char *CoreThreadAffinity = "core_threadaffinity";
 
 // The size of the mesh chunk
 constexpr const char *VoxelMeshSize = "voxel_meshsize";
 constexpr const char *VoxelMeshMode = "voxel_meshmode";
+// the amount of worker threads for the mesh extraction - 0 uses half of the cores
+constexpr const char *VoxelMeshThreads = "voxel_meshthreads";
+// extract the cubic meshes for previews and thumbnails with a compute shader if supported
+constexpr const char *VoxelComputeExtraction = "voxel_computeextraction";
+// extract lower resolution meshes of the chunks and render them for distant chunks
+constexpr const char *VoxelMeshLOD = "voxel_meshlod";
+// store the extracted meshes of the chunks in the home directory and load them instead of extracting them again
+constexpr const char *VoxelMeshCache = "voxel_meshcache";
+// the maximum size of the mesh cache in megabytes - the least recently used entries are deleted
+constexpr const char *VoxelMeshCacheSize = "voxel_meshcachesize";
+// the milliseconds per frame that are spent to upload the extracted meshes - 0 uploads all meshes in the same frame
+constexpr const char *VoxelUploadBudget = "voxel_uploadbudget";
+// skip the volumes that are hidden behind other volumes - tested with occlusion queries against the depth of the last
+// frame
+constexpr const char *VoxelOcclusionCulling = "voxel_occlusionculling";
+// render the transparent voxels with weighted blended order independent transparency instead of sorting them on the cpu
+constexpr const char *VoxelOrderIndependentTransparency = "voxel_oit";
+// render the opaque voxels by ray marching a brick map of the volumes in a 3d texture instead of extracting meshes
+constexpr const char *VoxelRayMarch = "voxel_raymarch";
+// compute the ambient occlusion in a 3d texture that is sampled in the fragment shader instead of extracting the meshes
+// with the ambient occlusion of the vertices
+constexpr const char *VoxelAOVolume = "voxel_aovolume";
 
 constexpr const char *AppHomePath = "app_homepath";
 constexpr const char *AppVersion = "app_version";
@@ -68,6 +102,8 @@ constexpr const char *MetricHost = "metric_host";
 constexpr const char *MetricJsonUrl = "metric_json_url";
 constexpr const char *MetricFlavor = "metric_flavor";
 constexpr const char *MetricUUID = "metric_uuid";
+constexpr const char *MetricFlushInterval = "metric_flushinterval";
+constexpr const char *MetricPerfStats = "metric_perfstats";
 
 constexpr const char *VoxelPalette = "palette";
 constexpr const char *NormalPalette = "normalpalette";
@@ -82,6 +118,7 @@ constexpr const char *VoxformatRGBWeightedAverage = "voxformat_rgbweightedaverag
 constexpr const char *VoxformatScale = "voxformat_scale";
 constexpr const char *VoxformatSaveVisibleOnly = "voxformat_savevisibleonly";
 constexpr const char *VoxformatMerge = "voxformat_merge";
+constexpr const char *VoxformatCreateReferences = "voxformat_createreferences";
 constexpr const char *VoxformatEmptyPaletteIndex = "voxformat_emptypaletteindex";
 constexpr const char *VoxformatScaleX = "voxformat_scale_x";
 constexpr const char *VoxformatScaleY = "voxformat_scale_y";
@@ -95,16 +132,21 @@ constexpr const char *VoxformatWithtexcoords = "voxformat_withtexcoords";
 constexpr const char *VoxformatPointCloudSize = "voxformat_pointcloudsize";
 constexpr const char *VoxformatTransform = "voxformat_transform_mesh";
 constexpr const char *VoxformatOptimize = "voxformat_optimize";
+constexpr const char *VoxformatSimplifyError = "voxformat_simplifyerror";
 constexpr const char *VoxformatFillHollow = "voxformat_fillhollow";
 constexpr const char *VoxformatVoxelizeMode = "voxformat_voxelizemode";
+constexpr const char *VoxformatMeshBucketSize = "voxformat_meshbucketsize";
 constexpr const char *VoxformatQBTPaletteMode = "voxformat_qbtpalettemode";
 constexpr const char *VoxformatQBTMergeCompounds = "voxformat_qbtmergecompounds";
 constexpr const char *VoxformatVOXCreateLayers = "voxformat_voxcreatelayers";
 constexpr const char *VoxformatVOXCreateGroups = "voxformat_voxcreategroups";
 constexpr const char *VoxformatQBSaveLeftHanded = "voxformat_qbsavelefthanded";
 constexpr const char *VoxformatQBSaveCompressed = "voxformat_qbsavecompressed";
+constexpr const char *VoxformatVENGICompressionLevel = "voxformat_vengicompressionlevel";
+constexpr const char *VoxformatVENGILazyLoad = "voxformat_vengilazyload";
 constexpr const char *VoxFormatGLTF_KHR_materials_pbrSpecularGlossiness = "voxformat_gltf_khr_materials_pbrspecularglossiness";
 constexpr const char *VoxFormatGLTF_KHR_materials_specular = "voxformat_gltf_khr_materials_specular";
+constexpr const char *VoxFormatGLTF_KHR_mesh_quantization = "voxformat_gltf_khr_mesh_quantization";
 constexpr const char *VoxformatImageVolumeMaxDepth = "voxformat_imagevolumemaxdepth";
 constexpr const char *VoxformatImageHeightmapMinHeight = "voxformat_imageheightmapminheight";
 constexpr const char *VoxformatImageVolumeBothSides = "voxformat_imagevolumebothsides";
@@ -3,7 +3,8 @@
  */
 
 #include "Hash.h"
-#include <random>
+#include "core/StandardLib.h"
+#include "core/UUID.h"
 
 namespace core {
 
@@ -69,29 +70,94 @@ uint32_t hash(const void *key, int len, uint32_t seed) {
 	return h1;
 }
 
-// https://www.ietf.org/rfc/rfc4122.txt
-core::String generateUUID() {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<int> dis(0, 15);
-	const char *hexDigits = "0123456789ABCDEF";
-	core::String uuid(36, ' ');
-	for (size_t i = 0; i < uuid.size(); i++) {
-		if (i == 8 || i == 13 || i == 18 || i == 23) {
-			// separators
-			uuid[i] = '-';
-		} else if (i == 14) {
-			// Version 4 UUID: Random
-			uuid[i] = '4';
-		} else if (i == 19) {
-			// Variant bits: 10b for RFC4122
-			uuid[i] = hexDigits[(dis(gen) & 0x3) | 0x8];
-		} else {
-			uuid[i] = hexDigits[dis(gen)];
-		}
+// xxHash64 by Yann Collet (BSD 2-Clause License)
+// https://github.com/Cyan4973/xxHash
+static constexpr uint64_t XXPrime1 = 11400714785074694791ULL;
+static constexpr uint64_t XXPrime2 = 14029467366897019727ULL;
+static constexpr uint64_t XXPrime3 = 1609587929392839161ULL;
+static constexpr uint64_t XXPrime4 = 9650029242287828579ULL;
+static constexpr uint64_t XXPrime5 = 2870177450012600261ULL;
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const uint8_t *p) {
+	uint64_t v;
+	core_memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t read32(const uint8_t *p) {
+	uint32_t v;
+	core_memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64_t xxRound(uint64_t acc, uint64_t input) {
+	acc += input * XXPrime2;
+	acc = rotl64(acc, 31);
+	return acc * XXPrime1;
+}
+
+static inline uint64_t xxMergeRound(uint64_t acc, uint64_t val) {
+	acc ^= xxRound(0, val);
+	return acc * XXPrime1 + XXPrime4;
+}
+
+uint64_t hash64(const void *data, size_t len, uint64_t seed) {
+	const uint8_t *p = (const uint8_t *)data;
+	const uint8_t *const end = p + len;
+	uint64_t h;
+	if (len >= 32) {
+		const uint8_t *const limit = end - 32;
+		uint64_t v1 = seed + XXPrime1 + XXPrime2;
+		uint64_t v2 = seed + XXPrime2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - XXPrime1;
+		do {
+			v1 = xxRound(v1, read64(p));
+			v2 = xxRound(v2, read64(p + 8));
+			v3 = xxRound(v3, read64(p + 16));
+			v4 = xxRound(v4, read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+		h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+		h = xxMergeRound(h, v1);
+		h = xxMergeRound(h, v2);
+		h = xxMergeRound(h, v3);
+		h = xxMergeRound(h, v4);
+	} else {
+		h = seed + XXPrime5;
 	}
+	h += (uint64_t)len;
 
-	return uuid;
+	while (p + 8 <= end) {
+		h ^= xxRound(0, read64(p));
+		h = rotl64(h, 27) * XXPrime1 + XXPrime4;
+		p += 8;
+	}
+	if (p + 4 <= end) {
+		h ^= (uint64_t)read32(p) * XXPrime1;
+		h = rotl64(h, 23) * XXPrime2 + XXPrime3;
+		p += 4;
+	}
+	while (p < end) {
+		h ^= (uint64_t)(*p) * XXPrime5;
+		h = rotl64(h, 11) * XXPrime1;
+		++p;
+	}
+
+	h ^= h >> 33;
+	h *= XXPrime2;
+	h ^= h >> 29;
+	h *= XXPrime3;
+	h ^= h >> 32;
+	return h;
+}
+
+core::String generateUUID() {
+	return UUID::generate().str();
 }
 
 } // namespace core
@@ -5,12 +5,22 @@
 #pragma once
 
 #include "core/String.h"
+#include <stddef.h>
 #include <stdint.h>
 
 namespace core {
 
 uint32_t hash(const void *key, int len, uint32_t seed = 0u);
 
+/**
+ * @brief Fast 64 bit hash of the given bytes (xxHash64)
+ *
+ * Blocks of data that are not stored next to each other can be hashed by passing the hash of the previous block as
+ * seed.
+ * @note The bytes are read in the native byte order - don't persist the hash across platforms
+ */
+uint64_t hash64(const void *data, size_t len, uint64_t seed = 0u);
+
 // Fowler–Noll–Vo hash function CC0
 // http://www.isthe.com/chongo/tech/comp/fnv/
 // https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
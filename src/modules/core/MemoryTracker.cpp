@@ -0,0 +1,116 @@
+/**
+ * @file
+ */
+
+#include "MemoryTracker.h"
+#include "core/ArrayLength.h"
+#include "core/Common.h"
+#include "core/Enum.h"
+#include "core/Log.h"
+#include "core/StringUtil.h"
+#include "core/Trace.h"
+#include <atomic>
+
+namespace core {
+
+// the names are also the ids of the tracy memory pools and plots - they must stay valid
+static const char *MemoryTagNames[] = {"Volume", "Mesh", "Memento", "Texture", "Format", "Lua"};
+static_assert(lengthof(MemoryTagNames) == (int)MemoryTag::Max, "Array sizes don't match");
+
+#ifdef MEMORY_TRACKING
+namespace {
+
+struct Counter {
+	std::atomic<int64_t> bytes{0};
+	std::atomic<int64_t> peak{0};
+	std::atomic<int64_t> allocations{0};
+};
+
+Counter s_counters[(int)MemoryTag::Max];
+
+void add(MemoryTag tag, int64_t delta) {
+	Counter &counter = s_counters[core::enumVal(tag)];
+	const int64_t bytes = counter.bytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+	int64_t peak = counter.peak.load(std::memory_order_relaxed);
+	while (bytes > peak && !counter.peak.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+	}
+}
+
+} // namespace
+
+void memoryTrackAlloc(MemoryTag tag, const void *ptr, size_t bytes) {
+	add(tag, (int64_t)bytes);
+	s_counters[core::enumVal(tag)].allocations.fetch_add(1, std::memory_order_relaxed);
+#ifdef TRACY_ENABLE
+	TracyAllocN(ptr, bytes, MemoryTagNames[core::enumVal(tag)]);
+#else
+	(void)ptr;
+#endif
+}
+
+void memoryTrackFree(MemoryTag tag, const void *ptr, size_t bytes) {
+	add(tag, -(int64_t)bytes);
+#ifdef TRACY_ENABLE
+	TracyFreeN(ptr, MemoryTagNames[core::enumVal(tag)]);
+#else
+	(void)ptr;
+#endif
+}
+
+void memoryTrackUpdate(MemoryTag tag, size_t &tracked, size_t bytes) {
+	if (tracked == bytes) {
+		return;
+	}
+	add(tag, (int64_t)bytes - (int64_t)tracked);
+	tracked = bytes;
+}
+#endif
+
+const char *memoryTagName(MemoryTag tag) {
+	if (tag >= MemoryTag::Max) {
+		return "Unknown";
+	}
+	return MemoryTagNames[core::enumVal(tag)];
+}
+
+MemoryStats memoryStats(MemoryTag tag) {
+	MemoryStats stats;
+#ifdef MEMORY_TRACKING
+	if (tag < MemoryTag::Max) {
+		const Counter &counter = s_counters[core::enumVal(tag)];
+		stats.bytes = counter.bytes.load(std::memory_order_relaxed);
+		stats.peak = counter.peak.load(std::memory_order_relaxed);
+		stats.allocations = counter.allocations.load(std::memory_order_relaxed);
+	}
+#else
+	(void)tag;
+#endif
+	return stats;
+}
+
+void memoryPlot() {
+#if defined(MEMORY_TRACKING) && defined(TRACY_ENABLE)
+	for (int i = 0; i < (int)MemoryTag::Max; ++i) {
+		TracyPlot(MemoryTagNames[i], s_counters[i].bytes.load(std::memory_order_relaxed));
+	}
+#endif
+}
+
+void memoryLogSummary() {
+#ifdef MEMORY_TRACKING
+	for (int i = 0; i < (int)MemoryTag::Max; ++i) {
+		const MemoryStats &stats = memoryStats((MemoryTag)i);
+		if (stats.peak == 0) {
+			continue;
+		}
+		Log::info("Memory %s: %s (peak %s, %i allocations)", MemoryTagNames[i],
+				  core::string::humanSize((uint64_t)core_max(stats.bytes, (int64_t)0)).c_str(),
+				  core::string::humanSize((uint64_t)stats.peak).c_str(),
+				  (int)stats.allocations);
+	}
+#else
+	Log::debug("Memory tracking is disabled - see USE_MEMORY_TRACKING");
+#endif
+}
+
+} // namespace core
@@ -0,0 +1,118 @@
+/**
+ * @file
+ * @brief Counts the memory of the memory heavy subsystems
+ *
+ * The counters are compiled in with the cmake option @c USE_MEMORY_TRACKING (that defines @c MEMORY_TRACKING).
+ * With tracy enabled the allocations are visible as named memory pools and the live totals as plots.
+ */
+
+#pragma once
+
+#include "core/StandardLib.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+
+enum class MemoryTag : uint8_t {
+	// the voxel data of the volumes
+	Volume,
+	// the vertices, normals and indices of the extracted meshes
+	Mesh,
+	// the undo and redo states
+	Memento,
+	// the textures of the texture pool
+	Texture,
+	// the buffered streams - mostly used by the format loaders and savers
+	Format,
+	// the lua script states
+	Lua,
+
+	Max
+};
+
+struct MemoryStats {
+	// the currently used bytes
+	int64_t bytes = 0;
+	// the highest value of bytes
+	int64_t peak = 0;
+	// the amount of allocations - the gauges don't count allocations - see memoryTrackUpdate()
+	int64_t allocations = 0;
+};
+
+const char *memoryTagName(MemoryTag tag);
+
+#ifdef MEMORY_TRACKING
+void memoryTrackAlloc(MemoryTag tag, const void *ptr, size_t bytes);
+void memoryTrackFree(MemoryTag tag, const void *ptr, size_t bytes);
+/**
+ * @brief For subsystems that already know their memory usage - only the difference to the last reported value is
+ * counted
+ * @param[in,out] tracked The value that was reported before by the caller - this is set to @c bytes
+ */
+void memoryTrackUpdate(MemoryTag tag, size_t &tracked, size_t bytes);
+#else
+inline void memoryTrackAlloc(MemoryTag, const void *, size_t) {
+}
+inline void memoryTrackFree(MemoryTag, const void *, size_t) {
+}
+inline void memoryTrackUpdate(MemoryTag, size_t &, size_t) {
+}
+#endif
+
+MemoryStats memoryStats(MemoryTag tag);
+/**
+ * @brief Sends the live totals to the tracy plots - called once per frame
+ */
+void memoryPlot();
+/**
+ * @brief Logs the live and the peak memory of all tags that were used
+ */
+void memoryLogSummary();
+
+/**
+ * @brief @c core_malloc with tracking
+ */
+inline void *memoryAlloc(MemoryTag tag, size_t bytes) {
+	void *ptr = core_malloc(bytes);
+	if (ptr != nullptr) {
+		memoryTrackAlloc(tag, ptr, bytes);
+	}
+	return ptr;
+}
+
+/**
+ * @param bytes The size that was given to @c memoryAlloc()
+ */
+inline void memoryFree(MemoryTag tag, void *ptr, size_t bytes) {
+	if (ptr == nullptr) {
+		return;
+	}
+	memoryTrackFree(tag, ptr, bytes);
+	core_free(ptr);
+}
+
+/**
+ * @brief Allocator policy for the @c ALLOCATOR template parameter of the collections that counts the memory for
+ * the given tag
+ * @sa AlignedAllocator
+ */
+template<MemoryTag TAG>
+struct TrackedAllocator {
+	static inline void *allocate(size_t bytes) {
+		void *ptr = core_aligned_malloc(bytes);
+		if (ptr != nullptr) {
+			memoryTrackAlloc(TAG, ptr, bytes);
+		}
+		return ptr;
+	}
+	static inline void deallocate(void *ptr, size_t bytes) {
+		if (ptr == nullptr) {
+			return;
+		}
+		memoryTrackFree(TAG, ptr, bytes);
+		core_aligned_free(ptr);
+	}
+};
+
+} // namespace core
@@ -0,0 +1,227 @@
+/**
+ * @file
+ */
+
+#include "PerfStats.h"
+#include "core/ArrayLength.h"
+#include "core/Common.h"
+#include "core/Enum.h"
+#include "core/TimeProvider.h"
+#include "core/Trace.h"
+#include <atomic>
+
+namespace core {
+
+namespace {
+
+struct PerfStatInfo {
+	// also the id of the tracy plot - must stay valid
+	const char *name;
+	PerfStatType type;
+	const char *unit;
+};
+
+const PerfStatInfo PerfStatInfos[] = {
+	{"frame", PerfStatType::Histogram, "us"},
+	{"extraction", PerfStatType::Histogram, "us"},
+	{"extractionQueue", PerfStatType::Gauge, "chunks"},
+	{"uploadBytes", PerfStatType::PerFrame, "bytes"},
+	{"formatLoad", PerfStatType::Histogram, "us"},
+	{"formatDecode", PerfStatType::Histogram, "us"},
+	{"formatPalette", PerfStatType::Histogram, "us"},
+	{"formatValidate", PerfStatType::Histogram, "us"},
+	{"formatSave", PerfStatType::Histogram, "us"},
+	{"mementoSnapshot", PerfStatType::Histogram, "us"},
+};
+static_assert(lengthof(PerfStatInfos) == (int)PerfStat::Max, "Array sizes don't match");
+
+// bucket 0 is for the value 0 - bucket n holds the values in [2^(n-1), 2^n)
+constexpr int PerfBuckets = 65;
+
+struct Counter {
+	std::atomic<uint64_t> count{0u};
+	std::atomic<uint64_t> sum{0u};
+	std::atomic<uint64_t> max{0u};
+	std::atomic<uint64_t> last{0u};
+	// the total of the current frame for the per frame stats
+	std::atomic<uint64_t> frame{0u};
+	std::atomic<uint64_t> buckets[PerfBuckets]{};
+};
+
+Counter s_counters[(int)PerfStat::Max];
+
+int bucket(uint64_t value) {
+	int idx = 0;
+	while (value != 0u) {
+		value >>= 1;
+		++idx;
+	}
+	return idx;
+}
+
+void updateMax(Counter &counter, uint64_t value) {
+	uint64_t max = counter.max.load(std::memory_order_relaxed);
+	while (value > max && !counter.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+	}
+}
+
+void record(Counter &counter, uint64_t value) {
+	counter.count.fetch_add(1u, std::memory_order_relaxed);
+	counter.sum.fetch_add(value, std::memory_order_relaxed);
+	counter.last.store(value, std::memory_order_relaxed);
+	counter.buckets[bucket(value)].fetch_add(1u, std::memory_order_relaxed);
+	updateMax(counter, value);
+}
+
+uint64_t percentile(const uint64_t *buckets, uint64_t count, uint64_t max, double p) {
+	if (count == 0u) {
+		return 0u;
+	}
+	const uint64_t target = core_max((uint64_t)1u, (uint64_t)((double)count * p + 0.5));
+	uint64_t cumulative = 0u;
+	for (int i = 0; i < PerfBuckets; ++i) {
+		if (buckets[i] == 0u) {
+			continue;
+		}
+		if (cumulative + buckets[i] < target) {
+			cumulative += buckets[i];
+			continue;
+		}
+		if (i == 0) {
+			return 0u;
+		}
+		// interpolate inside the bucket
+		const double lo = (double)(1ull << (i - 1));
+		const double hi = i == 64 ? (double)max : (double)(1ull << i) - 1.0;
+		const double fraction = (double)(target - cumulative) / (double)buckets[i];
+		return core_min(max, (uint64_t)(lo + (hi - lo) * fraction));
+	}
+	return max;
+}
+
+} // namespace
+
+const char *perfStatName(PerfStat stat) {
+	if (stat >= PerfStat::Max) {
+		return "unknown";
+	}
+	return PerfStatInfos[core::enumVal(stat)].name;
+}
+
+PerfStatType perfStatType(PerfStat stat) {
+	if (stat >= PerfStat::Max) {
+		return PerfStatType::Gauge;
+	}
+	return PerfStatInfos[core::enumVal(stat)].type;
+}
+
+const char *perfStatUnit(PerfStat stat) {
+	if (stat >= PerfStat::Max) {
+		return "";
+	}
+	return PerfStatInfos[core::enumVal(stat)].unit;
+}
+
+void perfRecord(PerfStat stat, uint64_t value) {
+	record(s_counters[core::enumVal(stat)], value);
+}
+
+void perfGauge(PerfStat stat, uint64_t value) {
+	Counter &counter = s_counters[core::enumVal(stat)];
+	counter.count.fetch_add(1u, std::memory_order_relaxed);
+	counter.last.store(value, std::memory_order_relaxed);
+	updateMax(counter, value);
+}
+
+void perfAdd(PerfStat stat, uint64_t value) {
+	s_counters[core::enumVal(stat)].frame.fetch_add(value, std::memory_order_relaxed);
+}
+
+void perfFrame() {
+	for (int i = 0; i < (int)PerfStat::Max; ++i) {
+		Counter &counter = s_counters[i];
+		if (PerfStatInfos[i].type == PerfStatType::PerFrame) {
+			record(counter, counter.frame.exchange(0u, std::memory_order_relaxed));
+		}
+		core_trace_plot(PerfStatInfos[i].name, (int64_t)counter.last.load(std::memory_order_relaxed));
+	}
+}
+
+PerfStats perfStats(PerfStat stat) {
+	PerfStats stats;
+	if (stat >= PerfStat::Max) {
+		return stats;
+	}
+	const Counter &counter = s_counters[core::enumVal(stat)];
+	stats.count = counter.count.load(std::memory_order_relaxed);
+	stats.sum = counter.sum.load(std::memory_order_relaxed);
+	stats.max = counter.max.load(std::memory_order_relaxed);
+	stats.last = counter.last.load(std::memory_order_relaxed);
+	if (perfStatType(stat) == PerfStatType::Gauge) {
+		return stats;
+	}
+	uint64_t buckets[PerfBuckets];
+	uint64_t count = 0u;
+	for (int i = 0; i < PerfBuckets; ++i) {
+		buckets[i] = counter.buckets[i].load(std::memory_order_relaxed);
+		count += buckets[i];
+	}
+	stats.p50 = percentile(buckets, count, stats.max, 0.5);
+	stats.p90 = percentile(buckets, count, stats.max, 0.9);
+	stats.p99 = percentile(buckets, count, stats.max, 0.99);
+	return stats;
+}
+
+void perfReset() {
+	for (int i = 0; i < (int)PerfStat::Max; ++i) {
+		Counter &counter = s_counters[i];
+		counter.count = 0u;
+		counter.sum = 0u;
+		counter.max = 0u;
+		counter.last = 0u;
+		counter.frame = 0u;
+		for (int b = 0; b < PerfBuckets; ++b) {
+			counter.buckets[b] = 0u;
+		}
+	}
+}
+
+core::String perfStatsJson() {
+	core::String json = "{";
+	bool first = true;
+	for (int i = 0; i < (int)PerfStat::Max; ++i) {
+		const PerfStat stat = (PerfStat)i;
+		const PerfStats &stats = perfStats(stat);
+		if (stats.count == 0u) {
+			continue;
+		}
+		if (!first) {
+			json.append(",");
+		}
+		first = false;
+		const PerfStatInfo &info = PerfStatInfos[i];
+		json.append(core::String::format("\"%s\":{\"unit\":\"%s\",\"count\":%llu,", info.name, info.unit,
+										 (unsigned long long)stats.count));
+		if (info.type == PerfStatType::Gauge) {
+			json.append(core::String::format("\"value\":%llu,\"peak\":%llu}", (unsigned long long)stats.last,
+											 (unsigned long long)stats.max));
+			continue;
+		}
+		json.append(core::String::format("\"mean\":%.1f,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"max\":%llu}",
+										 stats.mean(), (unsigned long long)stats.p50, (unsigned long long)stats.p90,
+										 (unsigned long long)stats.p99, (unsigned long long)stats.max));
+	}
+	json.append("}");
+	return json;
+}
+
+ScopedPerfTimer::ScopedPerfTimer(PerfStat stat) : _stat(stat), _start(core::TimeProvider::highResTime()) {
+}
+
+ScopedPerfTimer::~ScopedPerfTimer() {
+	const uint64_t end = core::TimeProvider::highResTime();
+	const double micros = (double)(end - _start) * 1000000.0 / (double)core::TimeProvider::highResTimeResolution();
+	perfRecord(_stat, (uint64_t)micros);
+}
+
+} // namespace core
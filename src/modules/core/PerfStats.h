@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @brief Always-on performance counters and histograms
+ *
+ * Unlike the tracy zones (@c core_trace_scoped) these don't need a connected profiler. Recording a value is a few
+ * relaxed atomic operations - the values can get recorded from any thread.
+ *
+ * The durations are recorded in microseconds.
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include <stdint.h>
+
+namespace core {
+
+enum class PerfStat : uint8_t {
+	// the duration of a frame
+	Frame,
+	// the time between scheduling the extraction of a chunk and the mesh being available
+	Extraction,
+	// the chunks that are waiting for the extraction or are currently extracted (gauge)
+	ExtractionQueue,
+	// the mesh bytes that were uploaded to the gpu in a frame
+	UploadBytes,
+	// the whole loading of a scene from a file
+	FormatLoad,
+	// the parsing of the file into the scene graph - part of FormatLoad
+	FormatDecode,
+	// the palette creation and remapping - part of FormatDecode
+	FormatPalette,
+	// the validation and fixing of the loaded scene graph - part of FormatLoad
+	FormatValidate,
+	// the whole saving of a scene
+	FormatSave,
+	// the time the caller is blocked by creating an undo state
+	MementoSnapshot,
+
+	Max
+};
+
+enum class PerfStatType : uint8_t {
+	// durations or sizes - the percentiles are calculated from a histogram
+	Histogram,
+	// only the last value and the peak are kept
+	Gauge,
+	// the values are summed up over a frame and the frame total is recorded into a histogram - see perfFrame()
+	PerFrame
+};
+
+struct PerfStats {
+	// the amount of recorded values
+	uint64_t count = 0u;
+	uint64_t sum = 0u;
+	uint64_t max = 0u;
+	// the last recorded value - for a gauge the current value
+	uint64_t last = 0u;
+	// the percentiles are estimated from power of two histogram buckets
+	uint64_t p50 = 0u;
+	uint64_t p90 = 0u;
+	uint64_t p99 = 0u;
+
+	inline double mean() const {
+		return count == 0u ? 0.0 : (double)sum / (double)count;
+	}
+};
+
+const char *perfStatName(PerfStat stat);
+PerfStatType perfStatType(PerfStat stat);
+/**
+ * @return The unit of the recorded values (e.g. @c us or @c bytes)
+ */
+const char *perfStatUnit(PerfStat stat);
+
+/**
+ * @brief Records a value for a histogram stat
+ */
+void perfRecord(PerfStat stat, uint64_t value);
+/**
+ * @brief Sets the value of a gauge
+ */
+void perfGauge(PerfStat stat, uint64_t value);
+/**
+ * @brief Adds the value to the total of the current frame of a @c PerfStatType::PerFrame stat
+ */
+void perfAdd(PerfStat stat, uint64_t value);
+/**
+ * @brief Records the frame totals of the @c PerfStatType::PerFrame stats and sends the last values to the tracy
+ * plots - called once per frame
+ */
+void perfFrame();
+
+PerfStats perfStats(PerfStat stat);
+void perfReset();
+/**
+ * @brief All stats that have values as json object - the stat names are the keys
+ */
+core::String perfStatsJson();
+
+/**
+ * @brief Records the lifetime of the object in microseconds
+ */
+class ScopedPerfTimer {
+private:
+	const PerfStat _stat;
+	const uint64_t _start;
+
+public:
+	ScopedPerfTimer(PerfStat stat);
+	~ScopedPerfTimer();
+};
+
+} // namespace core
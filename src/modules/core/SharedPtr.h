@@ -114,6 +114,13 @@ public:
 		return _refCnt;
 	}
 
+	/**
+	 * @return @c true if this is the only reference to the instance
+	 */
+	bool unique() const {
+		return count() == 1;
+	}
+
 	void release() {
 		if (decrease() == 0) {
 			if (_ptr != nullptr) {
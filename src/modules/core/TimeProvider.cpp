@@ -8,6 +8,7 @@
 #include <iomanip>
 #include <inttypes.h>
 #include <SDL.h>
+#include <chrono>
 
 namespace core {
 
@@ -37,6 +38,11 @@ uint64_t TimeProvider::tickNow() const {
 	return _highResTime / (highResTimeResolution() / SecToMillis);
 }
 
+uint64_t TimeProvider::epochMillis() {
+	const auto now = std::chrono::system_clock::now().time_since_epoch();
+	return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+}
+
 uint64_t TimeProvider::systemMillis() {
 	return highResTime() / (highResTimeResolution() / SecToMillis);
 }
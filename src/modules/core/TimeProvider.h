@@ -44,6 +44,10 @@ public:
 	static core::String toString(unsigned long millis, const char *format = "%d-%m-%Y %H-%M-%S");
 
 	static uint64_t systemMillis();
+	/**
+	 * @brief The wall clock time in milliseconds since the epoch
+	 */
+	static uint64_t epochMillis();
 	static uint64_t highResTime();
 	static uint64_t highResTimeResolution();
 
@@ -0,0 +1,90 @@
+/**
+ * @file
+ */
+
+#include "UUID.h"
+#include "core/Hash.h"
+#include <random>
+
+namespace core {
+
+static int hexValue(char c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+static bool parse(const char *str, uint64_t &data0, uint64_t &data1) {
+	uint64_t data[2]{0u, 0u};
+	int digits = 0;
+	for (const char *c = str; *c != '\0'; ++c) {
+		if (*c == '-') {
+			continue;
+		}
+		const int v = hexValue(*c);
+		if (v < 0 || digits >= 32) {
+			return false;
+		}
+		data[digits / 16] = (data[digits / 16] << 4) | (uint64_t)v;
+		++digits;
+	}
+	if (digits != 32) {
+		return false;
+	}
+	data0 = data[0];
+	data1 = data[1];
+	return true;
+}
+
+UUID::UUID(const char *str) {
+	if (str == nullptr || str[0] == '\0') {
+		return;
+	}
+	if (!parse(str, _data0, _data1)) {
+		_data0 = core::hash(str);
+		_data1 = core::hash(str, _data0);
+	}
+}
+
+UUID::UUID(const core::String &str) : UUID(str.c_str()) {
+}
+
+// https://www.ietf.org/rfc/rfc4122.txt
+UUID UUID::generate() {
+	static thread_local std::mt19937_64 gen(std::random_device{}());
+	uint64_t data0 = gen();
+	uint64_t data1 = gen();
+	// Version 4 UUID: Random
+	data0 = (data0 & ~0xF000ULL) | 0x4000ULL;
+	// Variant bits: 10b for RFC4122
+	data1 = (data1 & ~(0xC000000000000000ULL)) | 0x8000000000000000ULL;
+	return UUID(data0, data1);
+}
+
+core::String UUID::str() const {
+	if (!isValid()) {
+		return "";
+	}
+	const char *hexDigits = "0123456789ABCDEF";
+	core::String uuid(36, '-');
+	const uint64_t data[2]{_data0, _data1};
+	int digit = 0;
+	for (size_t i = 0; i < uuid.size(); ++i) {
+		if (i == 8 || i == 13 || i == 18 || i == 23) {
+			continue;
+		}
+		const int shift = 60 - (digit % 16) * 4;
+		uuid[i] = hexDigits[(data[digit / 16] >> shift) & 0xF];
+		++digit;
+	}
+	return uuid;
+}
+
+} // namespace core
@@ -0,0 +1,80 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include <stdint.h>
+
+namespace core {
+
+/**
+ * @brief 128 bit universally unique identifier
+ *
+ * Stored as two 64 bit values - comparing and hashing doesn't touch any string data. The string representation is
+ * only created for logging or serialization.
+ *
+ * A default constructed uuid is invalid (all bits are zero).
+ */
+class UUID {
+private:
+	uint64_t _data0 = 0u;
+	uint64_t _data1 = 0u;
+
+public:
+	constexpr UUID() = default;
+	constexpr UUID(uint64_t data0, uint64_t data1) : _data0(data0), _data1(data1) {
+	}
+	/**
+	 * @brief Parses the canonical representation (e.g. @c 123e4567-e89b-12d3-a456-426614174000 - the dashes and
+	 * the case are optional).
+	 *
+	 * Any other non-empty string (some formats use their own ids) is hashed into a uuid - the same string always
+	 * results in the same uuid. An empty string gives an invalid uuid.
+	 */
+	UUID(const core::String &str);
+	UUID(const char *str);
+
+	/**
+	 * @brief Generates a random version 4 uuid
+	 */
+	static UUID generate();
+
+	inline bool isValid() const {
+		return _data0 != 0u || _data1 != 0u;
+	}
+
+	inline uint64_t data0() const {
+		return _data0;
+	}
+
+	inline uint64_t data1() const {
+		return _data1;
+	}
+
+	/**
+	 * @return The canonical upper case representation or an empty string for an invalid uuid
+	 */
+	core::String str() const;
+
+	inline bool operator==(const UUID &other) const {
+		return _data0 == other._data0 && _data1 == other._data1;
+	}
+
+	inline bool operator!=(const UUID &other) const {
+		return !(*this == other);
+	}
+
+	inline bool operator<(const UUID &other) const {
+		return _data0 < other._data0 || (_data0 == other._data0 && _data1 < other._data1);
+	}
+};
+
+struct UUIDHash {
+	inline size_t operator()(const UUID &uuid) const {
+		return (size_t)(uuid.data0() ^ (uuid.data1() * 0x9e3779b97f4a7c15ULL));
+	}
+};
+
+} // namespace core
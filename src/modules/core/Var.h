@@ -58,7 +58,8 @@ public:
 	typedef bool (*ValidatorFunc)(const core::String& value);
 protected:
 	friend class SharedPtr<Var>;
-	typedef StringMap<VarPtr, 64> VarMap;
+	// the applications register more than a hundred vars on startup - keep the bucket chains short
+	typedef StringMap<VarPtr, 256> VarMap;
 	static VarMap _vars;
 	static Lock _lock;
 
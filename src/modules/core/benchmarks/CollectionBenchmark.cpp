@@ -1,8 +1,18 @@
 #include "app/benchmark/AbstractBenchmark.h"
+#include "core/collection/ConcurrentPriorityQueue.h"
+#include "core/collection/ConcurrentQueue.h"
+#include "core/collection/ConcurrentRingBuffer.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/DynamicMap.h"
+#include "core/collection/DynamicStringMap.h"
+#include "core/collection/FlatMap.h"
 #include "core/collection/Map.h"
 #include "core/Assert.h"
+#include "core/GLM.h"
+#include "core/String.h"
 #include <unordered_map>
 #include <map>
+#include <thread>
 
 class MapBenchmark: public app::AbstractBenchmark {
 };
@@ -53,8 +63,225 @@ BENCHMARK_DEFINE_F(MapBenchmark, compareToMapCore) (benchmark::State& state) {
 	}
 }
 
+BENCHMARK_DEFINE_F(MapBenchmark, compareToDynamicMapCore) (benchmark::State& state) {
+	for (auto _ : state) {
+		core::DynamicMap<int64_t, int64_t, 1031, std::hash<int64_t>> map;
+		const int64_t n = state.range(0);
+		for (int64_t i = 0; i < n; ++i) {
+			map.put(i, i);
+		}
+		for (int64_t i = 0; i < n; ++i) {
+			int64_t value;
+			const bool found = map.get(i, value);
+			if (!found || value != i) {
+				state.SkipWithError("Failed!");
+				break;
+			}
+		}
+	}
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, compareToFlatMapCore) (benchmark::State& state) {
+	for (auto _ : state) {
+		core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+		const int64_t n = state.range(0);
+		for (int64_t i = 0; i < n; ++i) {
+			map.put(i, i);
+		}
+		for (int64_t i = 0; i < n; ++i) {
+			int64_t value;
+			const bool found = map.get(i, value);
+			if (!found || value != i) {
+				state.SkipWithError("Failed!");
+				break;
+			}
+		}
+	}
+}
+
+// the chunk positions of the mesh state - insert, look up, remove every other chunk and insert them again
+template<class MAP>
+static void chunkChurn(benchmark::State &state) {
+	const int n = (int)state.range(0);
+	int side = 1;
+	while (side * side * side < n) {
+		++side;
+	}
+	core::DynamicArray<glm::ivec3> keys;
+	keys.reserve(n);
+	for (int i = 0; i < n; ++i) {
+		keys.push_back(glm::ivec3(i % side, (i / side) % side, i / (side * side)) * 32);
+	}
+	for (auto _ : state) {
+		MAP map;
+		for (int i = 0; i < n; ++i) {
+			map.put(keys[i], i);
+		}
+		for (int i = 0; i < n; i += 2) {
+			map.remove(keys[i]);
+		}
+		for (int i = 0; i < n; i += 2) {
+			map.put(keys[i], i);
+		}
+		int64_t sum = 0;
+		for (int i = 0; i < n; ++i) {
+			int value = 0;
+			if (!map.get(keys[i], value)) {
+				state.SkipWithError("Failed!");
+				break;
+			}
+			sum += value;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+}
+
+// the uuid index of the scene graph
+template<class MAP>
+static void stringLookup(benchmark::State &state) {
+	const int n = (int)state.range(0);
+	core::DynamicArray<core::String> keys;
+	keys.reserve(n);
+	for (int i = 0; i < n; ++i) {
+		keys.push_back(core::String::format("%08x-0000-4000-8000-%012x", i * 7919, i));
+	}
+	MAP map;
+	for (int i = 0; i < n; ++i) {
+		map.put(keys[i], i);
+	}
+	for (auto _ : state) {
+		for (int i = 0; i < n; ++i) {
+			int value = 0;
+			if (!map.get(keys[i], value) || value != i) {
+				state.SkipWithError("Failed!");
+				break;
+			}
+		}
+	}
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, chunkChurnDynamicMap) (benchmark::State& state) {
+	chunkChurn<core::DynamicMap<glm::ivec3, int, 127, glm::hash<glm::ivec3>>>(state);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, chunkChurnFlatMap) (benchmark::State& state) {
+	chunkChurn<core::FlatMap<glm::ivec3, int, glm::hash<glm::ivec3>>>(state);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, stringLookupDynamicStringMap) (benchmark::State& state) {
+	stringLookup<core::DynamicStringMap<int, 1031>>(state);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, stringLookupFlatMap) (benchmark::State& state) {
+	stringLookup<core::FlatMap<core::String, int, core::StringHash>>(state);
+}
+
+class QueueBenchmark: public app::AbstractBenchmark {
+};
+
+// every benchmark thread pushes and pops on the same queue - run with different thread counts to see the contention
+BENCHMARK_DEFINE_F(QueueBenchmark, contendedConcurrentQueue) (benchmark::State& state) {
+	static core::ConcurrentQueue<int64_t> queue;
+	int64_t value = 0;
+	for (auto _ : state) {
+		queue.push(value);
+		queue.pop(value);
+	}
+	benchmark::DoNotOptimize(value);
+}
+
+BENCHMARK_DEFINE_F(QueueBenchmark, contendedConcurrentPriorityQueue) (benchmark::State& state) {
+	static core::ConcurrentPriorityQueue<int64_t> queue;
+	int64_t value = 0;
+	for (auto _ : state) {
+		queue.push(value);
+		queue.pop(value);
+	}
+	benchmark::DoNotOptimize(value);
+}
+
+BENCHMARK_DEFINE_F(QueueBenchmark, contendedConcurrentRingBuffer) (benchmark::State& state) {
+	static core::ConcurrentRingBuffer<int64_t, 1024> queue;
+	int64_t value = 0;
+	for (auto _ : state) {
+		queue.push(value);
+		queue.pop(value);
+	}
+	benchmark::DoNotOptimize(value);
+}
+
+// one producer thread and the benchmark thread as consumer
+template<class QUEUE>
+static void transfer(benchmark::State& state, QUEUE& queue) {
+	const int64_t n = state.range(0);
+	for (auto _ : state) {
+		std::thread producer([&queue, n] () {
+			for (int64_t i = 0; i < n; ++i) {
+				while (!queue.push(i)) {
+					std::this_thread::yield();
+				}
+			}
+		});
+		int64_t sum = 0;
+		int64_t value;
+		for (int64_t i = 0; i < n; ++i) {
+			while (!queue.pop(value)) {
+				std::this_thread::yield();
+			}
+			sum += value;
+		}
+		producer.join();
+		if (sum != n * (n - 1) / 2) {
+			state.SkipWithError("Failed!");
+			break;
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+namespace {
+// the locked queue can't be full - adapt the push signature to the ring buffers
+struct LockedQueue {
+	core::ConcurrentQueue<int64_t> queue;
+	bool push(int64_t value) {
+		queue.push(value);
+		return true;
+	}
+	bool pop(int64_t& value) {
+		return queue.pop(value);
+	}
+};
+}
+
+BENCHMARK_DEFINE_F(QueueBenchmark, transferConcurrentQueue) (benchmark::State& state) {
+	LockedQueue queue;
+	transfer(state, queue);
+}
+
+BENCHMARK_DEFINE_F(QueueBenchmark, transferConcurrentRingBuffer) (benchmark::State& state) {
+	core::ConcurrentRingBuffer<int64_t, 1024> queue;
+	transfer(state, queue);
+}
+
+BENCHMARK_DEFINE_F(QueueBenchmark, transferSPSCRingBuffer) (benchmark::State& state) {
+	core::SPSCRingBuffer<int64_t, 1024> queue;
+	transfer(state, queue);
+}
+
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapCore)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapStd)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToUnorderedMapStd)->RangeMultiplier(2)->Range(8, 512);
+BENCHMARK_REGISTER_F(MapBenchmark, compareToDynamicMapCore)->RangeMultiplier(8)->Range(512, 262144);
+BENCHMARK_REGISTER_F(MapBenchmark, compareToFlatMapCore)->RangeMultiplier(8)->Range(512, 262144);
+BENCHMARK_REGISTER_F(MapBenchmark, chunkChurnDynamicMap)->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK_REGISTER_F(MapBenchmark, chunkChurnFlatMap)->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK_REGISTER_F(MapBenchmark, stringLookupDynamicStringMap)->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK_REGISTER_F(MapBenchmark, stringLookupFlatMap)->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK_REGISTER_F(QueueBenchmark, contendedConcurrentQueue)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(QueueBenchmark, contendedConcurrentPriorityQueue)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(QueueBenchmark, contendedConcurrentRingBuffer)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(QueueBenchmark, transferConcurrentQueue)->Arg(65536)->UseRealTime();
+BENCHMARK_REGISTER_F(QueueBenchmark, transferConcurrentRingBuffer)->Arg(65536)->UseRealTime();
+BENCHMARK_REGISTER_F(QueueBenchmark, transferSPSCRingBuffer)->Arg(65536)->UseRealTime();
 
 BENCHMARK_MAIN();
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "core/Allocator.h"
 #include "core/Common.h"
 #include "core/Assert.h"
 #include "core/StandardLib.h"
@@ -21,10 +22,11 @@ namespace core {
  *
  * @note Don't use this class for non primitives
  * @note Use a fixed size array to prevent memory allocations - where possible
+ * @note The @c ALLOCATOR can be set to @c FrameAllocator for temporaries
  * @sa DynamicArray
  * @ingroup Collections
  */
-template<class TYPE, size_t INCREASE = 32u>
+template<class TYPE, size_t INCREASE = 32u, class ALLOCATOR = MallocAllocator>
 class Buffer {
 private:
 	TYPE* _buffer = nullptr;
@@ -45,10 +47,11 @@ private:
 
 	void replaceBuffer(size_t newSize) {
 		size_t newCapacity = align(newSize);
-		TYPE* newBuffer = (TYPE*)core_malloc(newCapacity * sizeof(TYPE));
+		TYPE* newBuffer = (TYPE*)ALLOCATOR::allocate(newCapacity * sizeof(TYPE));
 		if (_buffer != nullptr) {
-			core_memcpy(newBuffer, _buffer, _capacity * sizeof(TYPE));
-			core_free(_buffer);
+			// resize() might shrink the buffer
+			core_memcpy(newBuffer, _buffer, core_min(_capacity, newCapacity) * sizeof(TYPE));
+			ALLOCATOR::deallocate(_buffer, _capacity * sizeof(TYPE));
 		}
 		_buffer = newBuffer;
 		_capacity = newCapacity;
@@ -243,7 +246,7 @@ public:
 	}
 
 	void release() {
-		core_free(_buffer);
+		ALLOCATOR::deallocate(_buffer, _capacity * sizeof(TYPE));
 		_capacity = 0u;
 		_size = 0u;
 		_buffer = nullptr;
@@ -0,0 +1,225 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Common.h"
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+
+/**
+ * @brief Bounded lock free multi producer multi consumer queue
+ *
+ * Every slot has a sequence number that tells the producers and consumers whether the slot is free or filled for
+ * the current round - see Dmitry Vyukov's bounded mpmc queue. There are no locks and no allocations after the
+ * construction. If the queue is full, @c push() fails and the caller has to decide what to do with the element.
+ *
+ * @note The elements stay in their moved-from state in the slots until they are overwritten.
+ * @sa ConcurrentQueue for the unbounded locked version
+ * @sa SPSCRingBuffer if there is only one producer and one consumer
+ * @ingroup Collections
+ */
+template<class Data, size_t SIZE = 256u>
+class ConcurrentRingBuffer {
+private:
+	static_assert(SIZE >= 2u && (SIZE & (SIZE - 1u)) == 0u, "SIZE must be a power of two");
+	static constexpr size_t Mask = SIZE - 1u;
+	static constexpr size_t CacheLineSize = 64u;
+
+	struct Cell {
+		std::atomic<size_t> sequence;
+		Data data;
+	};
+
+	Cell _cells[SIZE];
+	// the producers and the consumers should not share a cache line
+	alignas(CacheLineSize) std::atomic<size_t> _enqueuePos{0u};
+	alignas(CacheLineSize) std::atomic<size_t> _dequeuePos{0u};
+
+	/**
+	 * @return The cell to write to or @c nullptr if the queue is full
+	 */
+	Cell *acquireEnqueue(size_t &pos) {
+		pos = _enqueuePos.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell *cell = &_cells[pos & Mask];
+			const size_t seq = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+			if (diff == 0) {
+				if (_enqueuePos.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					return cell;
+				}
+			} else if (diff < 0) {
+				return nullptr;
+			} else {
+				pos = _enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+public:
+	using value_type = Data;
+
+	ConcurrentRingBuffer() {
+		for (size_t i = 0u; i < SIZE; ++i) {
+			_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	ConcurrentRingBuffer(const ConcurrentRingBuffer &) = delete;
+	ConcurrentRingBuffer &operator=(const ConcurrentRingBuffer &) = delete;
+
+	static constexpr size_t capacity() {
+		return SIZE;
+	}
+
+	/**
+	 * @return @c false if the queue is full - @c data is not moved in this case
+	 */
+	bool push(Data &&data) {
+		size_t pos;
+		Cell *cell = acquireEnqueue(pos);
+		if (cell == nullptr) {
+			return false;
+		}
+		cell->data = core::move(data);
+		cell->sequence.store(pos + 1u, std::memory_order_release);
+		return true;
+	}
+
+	bool push(const Data &data) {
+		size_t pos;
+		Cell *cell = acquireEnqueue(pos);
+		if (cell == nullptr) {
+			return false;
+		}
+		cell->data = data;
+		cell->sequence.store(pos + 1u, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(Data &poppedValue) {
+		size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell *cell = &_cells[pos & Mask];
+			const size_t seq = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1u);
+			if (diff == 0) {
+				if (_dequeuePos.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					poppedValue = core::move(cell->data);
+					cell->sequence.store(pos + Mask + 1u, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = _dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	 * @note Only a snapshot if there are concurrent producers or consumers
+	 */
+	size_t size() const {
+		const size_t enqueuePos = _enqueuePos.load(std::memory_order_acquire);
+		const size_t dequeuePos = _dequeuePos.load(std::memory_order_acquire);
+		return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0u;
+	}
+
+	inline bool empty() const {
+		return size() == 0u;
+	}
+
+	/**
+	 * @return The amount of removed elements
+	 */
+	size_t clear() {
+		size_t n = 0u;
+		Data data;
+		while (pop(data)) {
+			++n;
+		}
+		return n;
+	}
+};
+
+/**
+ * @brief Bounded lock free single producer single consumer queue
+ *
+ * Cheaper than @c ConcurrentRingBuffer because the positions are only written by one thread each - but only one
+ * thread may call @c push() and only one (other) thread may call @c pop().
+ *
+ * @ingroup Collections
+ */
+template<class Data, size_t SIZE = 256u>
+class SPSCRingBuffer {
+private:
+	static_assert(SIZE >= 2u && (SIZE & (SIZE - 1u)) == 0u, "SIZE must be a power of two");
+	static constexpr size_t Mask = SIZE - 1u;
+	static constexpr size_t CacheLineSize = 64u;
+
+	Data _buffer[SIZE];
+	alignas(CacheLineSize) std::atomic<size_t> _head{0u};
+	alignas(CacheLineSize) std::atomic<size_t> _tail{0u};
+
+public:
+	using value_type = Data;
+
+	SPSCRingBuffer() = default;
+	SPSCRingBuffer(const SPSCRingBuffer &) = delete;
+	SPSCRingBuffer &operator=(const SPSCRingBuffer &) = delete;
+
+	static constexpr size_t capacity() {
+		return SIZE;
+	}
+
+	/**
+	 * @return @c false if the queue is full - @c data is not moved in this case
+	 */
+	bool push(Data &&data) {
+		const size_t tail = _tail.load(std::memory_order_relaxed);
+		if (tail - _head.load(std::memory_order_acquire) == SIZE) {
+			return false;
+		}
+		_buffer[tail & Mask] = core::move(data);
+		_tail.store(tail + 1u, std::memory_order_release);
+		return true;
+	}
+
+	bool push(const Data &data) {
+		const size_t tail = _tail.load(std::memory_order_relaxed);
+		if (tail - _head.load(std::memory_order_acquire) == SIZE) {
+			return false;
+		}
+		_buffer[tail & Mask] = data;
+		_tail.store(tail + 1u, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(Data &poppedValue) {
+		const size_t head = _head.load(std::memory_order_relaxed);
+		if (head == _tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		poppedValue = core::move(_buffer[head & Mask]);
+		_head.store(head + 1u, std::memory_order_release);
+		return true;
+	}
+
+	size_t size() const {
+		// the head is loaded first - the tail can only grow in the meantime
+		const size_t head = _head.load(std::memory_order_acquire);
+		return _tail.load(std::memory_order_acquire) - head;
+	}
+
+	inline bool empty() const {
+		return size() == 0u;
+	}
+};
+
+} // namespace core
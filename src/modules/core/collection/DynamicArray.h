@@ -5,6 +5,7 @@
 #pragma once
 
 #include "core/Algorithm.h"
+#include "core/Allocator.h"
 #include "core/Common.h"
 #include "core/Assert.h"
 #include "core/StandardLib.h"
@@ -21,10 +22,11 @@ namespace core {
  * allocate new slots given by the @c INCREASE template parameter.
  *
  * @note Use a fixed size array to prevent memory allocations - where possible
+ * @note The @c ALLOCATOR can be set to @c FrameAllocator for temporaries
  * @sa Array
  * @ingroup Collections
  */
-template<class TYPE, size_t INCREASE = 32u>
+template<class TYPE, size_t INCREASE = 32u, class ALLOCATOR = AlignedAllocator>
 class DynamicArray {
 private:
 	TYPE* _buffer = nullptr;
@@ -41,13 +43,14 @@ private:
 		if (_capacity >= newSize) {
 			return;
 		}
+		const size_t oldCapacity = _capacity;
 		_capacity = align(newSize);
-		TYPE* newBuffer = (TYPE*)core_aligned_malloc(_capacity * sizeof(TYPE));
+		TYPE* newBuffer = (TYPE*)ALLOCATOR::allocate(_capacity * sizeof(TYPE));
 		for (size_t i = 0u; i < _size; ++i) {
 			new ((void*)&newBuffer[i]) TYPE(core::move(_buffer[i]));
 			_buffer[i].~TYPE();
 		}
-		core_aligned_free(_buffer);
+		ALLOCATOR::deallocate(_buffer, oldCapacity * sizeof(TYPE));
 		_buffer = newBuffer;
 	}
 public:
@@ -393,7 +396,7 @@ public:
 		for (size_t i = 0u; i < _size; ++i) {
 			_buffer[i].~TYPE();
 		}
-		core_aligned_free(_buffer);
+		ALLOCATOR::deallocate(_buffer, _capacity * sizeof(TYPE));
 		_capacity = 0u;
 		_size = 0u;
 		_buffer = nullptr;
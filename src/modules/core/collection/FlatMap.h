@@ -0,0 +1,373 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Common.h"
+#include "core/collection/DynamicMap.h"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace core {
+
+/**
+ * @brief Open addressing hash map with robin hood hashing and backward shift deletion.
+ *
+ * All entries are stored in one contiguous array - there is no allocation per entry like in @c DynamicMap and the
+ * capacity (always a power of two) grows with the load factor. The probe sequences are kept short by moving the
+ * entries that are closer to their ideal slot on insertion.
+ *
+ * @note Inserting or removing entries invalidates the iterators and the pointers to values.
+ * @note The key and value types must be default constructible.
+ * @sa DynamicMap
+ * @ingroup Collections
+ */
+template<typename KEYTYPE, typename VALUETYPE, typename HASHER = privdynamicmap::DefaultHasher,
+		 typename COMPARE = privdynamicmap::EqualCompare>
+class FlatMap {
+public:
+	using value_type = VALUETYPE;
+	using key_type = KEYTYPE;
+
+	struct KeyValue {
+		KEYTYPE key;
+		VALUETYPE value;
+	};
+
+private:
+	static constexpr size_t MinCapacity = 16u;
+	KeyValue *_slots = nullptr;
+	// 0 means empty - otherwise the distance to the ideal slot plus one
+	uint32_t *_distances = nullptr;
+	size_t _capacity = 0u;
+	size_t _size = 0u;
+	HASHER _hasher;
+
+	inline size_t idealSlot(const KEYTYPE &key) const {
+		// fibonacci hashing to spread weak hashes over the power of two capacity
+		const uint64_t hashValue = (uint64_t)_hasher(key) * UINT64_C(0x9E3779B97F4A7C15);
+		return (size_t)(hashValue >> 32) & (_capacity - 1u);
+	}
+
+	inline bool needsGrow() const {
+		// keep the load factor below 0.8
+		return (_size + 1u) * 5u > _capacity * 4u;
+	}
+
+	void allocate(size_t capacity) {
+		_capacity = capacity;
+		_slots = new KeyValue[_capacity];
+		_distances = new uint32_t[_capacity];
+		for (size_t i = 0u; i < _capacity; ++i) {
+			_distances[i] = 0u;
+		}
+	}
+
+	void release() {
+		delete[] _slots;
+		delete[] _distances;
+		_slots = nullptr;
+		_distances = nullptr;
+		_capacity = 0u;
+		_size = 0u;
+	}
+
+	void rehash(size_t capacity) {
+		KeyValue *oldSlots = _slots;
+		uint32_t *oldDistances = _distances;
+		const size_t oldCapacity = _capacity;
+		allocate(capacity);
+		_size = 0u;
+		for (size_t i = 0u; i < oldCapacity; ++i) {
+			if (oldDistances[i] != 0u) {
+				insert(core::move(oldSlots[i].key), core::move(oldSlots[i].value));
+			}
+		}
+		delete[] oldSlots;
+		delete[] oldDistances;
+	}
+
+	size_t findSlot(const KEYTYPE &key) const {
+		if (_size == 0u) {
+			return _capacity;
+		}
+		return findSlot(key, idealSlot(key));
+	}
+
+	size_t findSlot(const KEYTYPE &key, size_t idx) const {
+		const size_t mask = _capacity - 1u;
+		for (uint32_t distance = 1u;; ++distance) {
+			// robin hood invariant: the key can't be behind an entry that is closer to its ideal slot
+			if (_distances[idx] < distance) {
+				return _capacity;
+			}
+			if (COMPARE()(_slots[idx].key, key)) {
+				return idx;
+			}
+			idx = (idx + 1u) & mask;
+		}
+	}
+
+	// the key must not be part of the map yet
+	inline KeyValue *insert(KEYTYPE &&key, VALUETYPE &&value) {
+		const size_t idx = idealSlot(key);
+		return insert(core::move(key), core::move(value), idx);
+	}
+
+	KeyValue *insert(KEYTYPE &&key, VALUETYPE &&value, size_t idx) {
+		const size_t mask = _capacity - 1u;
+		uint32_t distance = 1u;
+		KeyValue *inserted = nullptr;
+		KeyValue entry{core::move(key), core::move(value)};
+		for (;;) {
+			if (_distances[idx] == 0u) {
+				_slots[idx] = core::move(entry);
+				_distances[idx] = distance;
+				++_size;
+				return inserted != nullptr ? inserted : &_slots[idx];
+			}
+			if (_distances[idx] < distance) {
+				// take the slot of the entry that is closer to its ideal slot and continue with that entry
+				core::exchange(_slots[idx], entry);
+				core::exchange(_distances[idx], distance);
+				if (inserted == nullptr) {
+					inserted = &_slots[idx];
+				}
+			}
+			idx = (idx + 1u) & mask;
+			++distance;
+		}
+	}
+
+	void removeSlot(size_t idx) {
+		const size_t mask = _capacity - 1u;
+		size_t next = (idx + 1u) & mask;
+		// backward shift the following entries - no tombstones are needed
+		while (_distances[next] > 1u) {
+			_slots[idx] = core::move(_slots[next]);
+			_distances[idx] = _distances[next] - 1u;
+			idx = next;
+			next = (next + 1u) & mask;
+		}
+		_slots[idx] = KeyValue();
+		_distances[idx] = 0u;
+		--_size;
+	}
+
+	KeyValue *getOrInsert(const KEYTYPE &key) {
+		if (_capacity == 0u) {
+			rehash(MinCapacity);
+		}
+		// the key is only hashed once - unless the map has to grow
+		size_t ideal = idealSlot(key);
+		if (_size > 0u) {
+			const size_t idx = findSlot(key, ideal);
+			if (idx != _capacity) {
+				return &_slots[idx];
+			}
+		}
+		if (needsGrow()) {
+			rehash(_capacity * 2u);
+			ideal = idealSlot(key);
+		}
+		KEYTYPE k = key;
+		return insert(core::move(k), VALUETYPE(), ideal);
+	}
+
+public:
+	FlatMap() = default;
+
+	FlatMap(const FlatMap &other) {
+		*this = other;
+	}
+
+	FlatMap(FlatMap &&other) noexcept {
+		*this = core::move(other);
+	}
+
+	~FlatMap() {
+		release();
+	}
+
+	FlatMap &operator=(const FlatMap &other) {
+		if (this == &other) {
+			return *this;
+		}
+		release();
+		if (other._capacity == 0u) {
+			return *this;
+		}
+		allocate(other._capacity);
+		for (size_t i = 0u; i < _capacity; ++i) {
+			_slots[i] = other._slots[i];
+			_distances[i] = other._distances[i];
+		}
+		_size = other._size;
+		_hasher = other._hasher;
+		return *this;
+	}
+
+	FlatMap &operator=(FlatMap &&other) noexcept {
+		if (this == &other) {
+			return *this;
+		}
+		release();
+		_slots = other._slots;
+		_distances = other._distances;
+		_capacity = other._capacity;
+		_size = other._size;
+		_hasher = other._hasher;
+		other._slots = nullptr;
+		other._distances = nullptr;
+		other._capacity = 0u;
+		other._size = 0u;
+		return *this;
+	}
+
+	class iterator {
+	private:
+		const FlatMap *_map;
+		size_t _idx;
+
+	public:
+		constexpr iterator() : _map(nullptr), _idx(0u) {
+		}
+
+		iterator(const FlatMap *map, size_t idx) : _map(map), _idx(idx) {
+		}
+
+		inline KeyValue *operator*() const {
+			return &_map->_slots[_idx];
+		}
+
+		iterator &operator++() {
+			for (++_idx; _idx < _map->_capacity; ++_idx) {
+				if (_map->_distances[_idx] != 0u) {
+					return *this;
+				}
+			}
+			_map = nullptr;
+			_idx = 0u;
+			return *this;
+		}
+
+		inline KeyValue *operator->() const {
+			return &_map->_slots[_idx];
+		}
+
+		inline bool operator!=(const iterator &rhs) const {
+			return _map != rhs._map || _idx != rhs._idx;
+		}
+
+		inline bool operator==(const iterator &rhs) const {
+			return _map == rhs._map && _idx == rhs._idx;
+		}
+	};
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	inline size_t capacity() const {
+		return _capacity;
+	}
+
+	/**
+	 * @brief Make sure that the given amount of entries can be stored without rehashing
+	 */
+	void reserve(size_t entries) {
+		size_t capacity = MinCapacity;
+		while (entries * 5u > capacity * 4u) {
+			capacity *= 2u;
+		}
+		if (capacity > _capacity) {
+			rehash(capacity);
+		}
+	}
+
+	bool get(const KEYTYPE &key, VALUETYPE &value) const {
+		const size_t idx = findSlot(key);
+		if (idx == _capacity) {
+			return false;
+		}
+		value = _slots[idx].value;
+		return true;
+	}
+
+	/**
+	 * @return @c nullptr if the key wasn't found
+	 */
+	const VALUETYPE *ptr(const KEYTYPE &key) const {
+		const size_t idx = findSlot(key);
+		if (idx == _capacity) {
+			return nullptr;
+		}
+		return &_slots[idx].value;
+	}
+
+	bool hasKey(const KEYTYPE &key) const {
+		return findSlot(key) != _capacity;
+	}
+
+	iterator find(const KEYTYPE &key) const {
+		const size_t idx = findSlot(key);
+		if (idx == _capacity) {
+			return end();
+		}
+		return iterator(this, idx);
+	}
+
+	void emplace(const KEYTYPE &key, VALUETYPE &&value) {
+		getOrInsert(key)->value = core::forward<VALUETYPE>(value);
+	}
+
+	void put(const KEYTYPE &key, const VALUETYPE &value) {
+		getOrInsert(key)->value = value;
+	}
+
+	iterator begin() const {
+		for (size_t i = 0u; i < _capacity; ++i) {
+			if (_distances[i] != 0u) {
+				return iterator(this, i);
+			}
+		}
+		return end();
+	}
+
+	constexpr iterator end() const {
+		return iterator();
+	}
+
+	/**
+	 * @note Keeps the allocated capacity
+	 */
+	void clear() {
+		for (size_t i = 0u; i < _capacity; ++i) {
+			if (_distances[i] != 0u) {
+				_slots[i] = KeyValue();
+				_distances[i] = 0u;
+			}
+		}
+		_size = 0u;
+	}
+
+	inline void erase(const iterator &iter) {
+		remove(iter->key);
+	}
+
+	bool remove(const KEYTYPE &key) {
+		const size_t idx = findSlot(key);
+		if (idx == _capacity) {
+			return false;
+		}
+		removeSlot(idx);
+		return true;
+	}
+};
+
+} // namespace core
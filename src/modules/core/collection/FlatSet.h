@@ -0,0 +1,44 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/FlatMap.h"
+
+namespace core {
+
+/**
+ * @brief Open addressing hash set - see @c FlatMap for the details
+ * @note Inserting or removing entries invalidates the iterators.
+ * @sa DynamicSet
+ * @ingroup Collections
+ */
+template<class T, typename HASHER = privdynamicmap::DefaultHasher, typename COMPARE = privdynamicmap::EqualCompare>
+class FlatSet : public FlatMap<T, bool, HASHER, COMPARE> {
+private:
+	using Super = FlatMap<T, bool, HASHER, COMPARE>;
+public:
+	/**
+	 * @return @c false if the key was already part of the set
+	 */
+	bool insert(const T &key) {
+		const size_t before = this->size();
+		this->put(key, true);
+		return this->size() != before;
+	}
+
+	template<class ITER>
+	void insert(ITER first, ITER last) {
+		while (first != last) {
+			this->put(*first, true);
+			++first;
+		}
+	}
+
+	inline bool has(const T &key) const {
+		return this->hasKey(key);
+	}
+};
+
+} // namespace core
@@ -0,0 +1,425 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Algorithm.h"
+#include "core/Allocator.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include <cstdint> // intptr_t - not available in stdint.h
+#include <initializer_list>
+#include <new>
+
+namespace core {
+
+/**
+ * @brief Dynamically growing continuous storage with room for @c N elements inside the object itself
+ *
+ * Nothing is allocated as long as the size doesn't exceed @c N - use this for the many arrays that usually only hold
+ * a few elements (e.g. the children of a scene graph node). The api matches the one of @c DynamicArray.
+ *
+ * @note Moving a small vector that uses the inline storage moves the elements - pointers to the elements are not
+ * stable in that case.
+ * @sa DynamicArray
+ * @ingroup Collections
+ */
+template<class TYPE, size_t N, class ALLOCATOR = AlignedAllocator>
+class SmallVector {
+	static_assert(N > 0u, "Use a DynamicArray if there is no inline storage needed");
+private:
+	alignas(TYPE) uint8_t _inline[N * sizeof(TYPE)];
+	TYPE *_buffer = inlineBuffer();
+	size_t _capacity = N;
+	size_t _size = 0u;
+
+	inline TYPE *inlineBuffer() {
+		return (TYPE *)_inline;
+	}
+
+	inline bool isInline() const {
+		return _buffer == (const TYPE *)_inline;
+	}
+
+	void checkBufferSize(size_t newSize) {
+		if (_capacity >= newSize) {
+			return;
+		}
+		const size_t capacity = core_max(newSize, _capacity * 2u);
+		TYPE *newBuffer = (TYPE *)ALLOCATOR::allocate(capacity * sizeof(TYPE));
+		for (size_t i = 0u; i < _size; ++i) {
+			new ((void *)&newBuffer[i]) TYPE(core::move(_buffer[i]));
+			_buffer[i].~TYPE();
+		}
+		if (!isInline()) {
+			ALLOCATOR::deallocate(_buffer, _capacity * sizeof(TYPE));
+		}
+		_buffer = newBuffer;
+		_capacity = capacity;
+	}
+
+	// the own elements must already be released
+	void moveFrom(SmallVector &other) {
+		if (!other.isInline()) {
+			_buffer = other._buffer;
+			_capacity = other._capacity;
+			_size = other._size;
+			other._buffer = other.inlineBuffer();
+			other._capacity = N;
+			other._size = 0u;
+			return;
+		}
+		for (size_t i = 0u; i < other._size; ++i) {
+			new ((void *)&_buffer[i]) TYPE(core::move(other._buffer[i]));
+		}
+		_size = other._size;
+		other.clear();
+	}
+
+public:
+	using value_type = TYPE;
+
+	SmallVector() {
+	}
+
+	SmallVector(std::initializer_list<TYPE> other) {
+		insert(end(), other.begin(), other.end());
+	}
+
+	explicit SmallVector(size_t amount) {
+		resize(amount);
+	}
+
+	SmallVector(const SmallVector &other) {
+		append(other.data(), other.size());
+	}
+
+	SmallVector(SmallVector &&other) noexcept {
+		moveFrom(other);
+	}
+
+	~SmallVector() {
+		release();
+	}
+
+	SmallVector &operator=(const SmallVector &other) {
+		if (&other == this) {
+			return *this;
+		}
+		clear();
+		append(other.data(), other.size());
+		return *this;
+	}
+
+	SmallVector &operator=(SmallVector &&other) noexcept {
+		if (&other == this) {
+			return *this;
+		}
+		release();
+		moveFrom(other);
+		return *this;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	inline size_t bytes() const {
+		return _size * sizeof(TYPE);
+	}
+
+	class iterator {
+	private:
+		TYPE *_ptr;
+
+	public:
+		constexpr iterator() : _ptr(nullptr) {
+		}
+
+		iterator(TYPE *ptr) : _ptr(ptr) {
+		}
+
+		inline const TYPE &operator*() const {
+			return *_ptr;
+		}
+
+		inline TYPE &operator*() {
+			return *_ptr;
+		}
+
+		iterator &operator++() {
+			++_ptr;
+			return *this;
+		}
+
+		iterator operator++(int) {
+			return iterator(_ptr++);
+		}
+
+		iterator operator--(int) {
+			return iterator(_ptr--);
+		}
+
+		int operator-(iterator rhs) const {
+			return (int)(intptr_t)(_ptr - rhs._ptr);
+		}
+
+		iterator &operator+(size_t n) {
+			_ptr += n;
+			return *this;
+		}
+
+		iterator &operator+=(size_t n) {
+			_ptr += n;
+			return *this;
+		}
+
+		iterator &operator--() {
+			--_ptr;
+			return *this;
+		}
+
+		iterator &operator-(size_t n) {
+			_ptr -= n;
+			return *this;
+		}
+
+		iterator &operator-=(size_t n) {
+			_ptr -= n;
+			return *this;
+		}
+
+		inline const TYPE *operator->() const {
+			return _ptr;
+		}
+
+		inline TYPE *operator->() {
+			return _ptr;
+		}
+
+		inline bool operator!=(const iterator &rhs) const {
+			return _ptr != rhs._ptr;
+		}
+
+		inline bool operator==(const iterator &rhs) const {
+			return _ptr == rhs._ptr;
+		}
+	};
+	using const_iterator = iterator;
+
+	template<typename... _Args>
+	void emplace_back(_Args &&...args) {
+		checkBufferSize(_size + 1u);
+		new ((void *)&_buffer[_size++]) TYPE(core::forward<_Args>(args)...);
+	}
+
+	void push_back(const TYPE &val) {
+		checkBufferSize(_size + 1u);
+		new ((void *)&_buffer[_size++]) TYPE(val);
+	}
+
+	void push_front(const TYPE &val) {
+		insert(begin(), val);
+	}
+
+	template<class COLLECTION>
+	void append(const COLLECTION &collection) {
+		const size_t n = collection.size();
+		checkBufferSize(_size + n);
+		for (size_t i = 0u; i < n; ++i) {
+			new ((void *)&_buffer[_size++]) TYPE(collection[i]);
+		}
+	}
+
+	void append(const TYPE *array, size_t n) {
+		checkBufferSize(_size + n);
+		for (size_t i = 0u; i < n; ++i) {
+			new ((void *)&_buffer[_size++]) TYPE(array[i]);
+		}
+	}
+
+	inline void insert(iterator pos, const TYPE &value) {
+		insert(pos, &value, &value + 1);
+	}
+
+	void insert(iterator pos, const TYPE *array, size_t n) {
+		insert(pos, array, array + n);
+	}
+
+	template<typename ITER>
+	void insert(iterator pos, ITER first, ITER last) {
+		if (first == last) {
+			return;
+		}
+		const size_t n = (size_t)core::distance(first, last);
+		const size_t startIdx = index(pos);
+		// the iterator is invalid after the buffer was grown
+		checkBufferSize(_size + n);
+		for (size_t i = _size; i > startIdx; --i) {
+			new ((void *)&_buffer[i - 1u + n]) TYPE(core::move(_buffer[i - 1u]));
+			_buffer[i - 1u].~TYPE();
+		}
+		size_t idx = startIdx;
+		for (ITER i = first; i != last; ++i) {
+			new ((void *)&_buffer[idx++]) TYPE(*i);
+		}
+		_size += n;
+	}
+
+	void pop() {
+		core_assert(_size > 0u);
+		_buffer[--_size].~TYPE();
+	}
+
+	TYPE *data() {
+		return _buffer;
+	}
+
+	const TYPE *data() const {
+		return _buffer;
+	}
+
+	TYPE &front() {
+		core_assert(_size > 0u);
+		return _buffer[0];
+	}
+
+	const TYPE &front() const {
+		core_assert(_size > 0u);
+		return _buffer[0];
+	}
+
+	TYPE &back() {
+		core_assert(_size > 0u);
+		return _buffer[_size - 1u];
+	}
+
+	const TYPE &back() const {
+		core_assert(_size > 0u);
+		return _buffer[_size - 1u];
+	}
+
+	void reserve(size_t size) {
+		checkBufferSize(size);
+	}
+
+	void resize(size_t size) {
+		checkBufferSize(size);
+		while (size > _size) {
+			emplace_back(TYPE{});
+		}
+		while (size < _size) {
+			pop();
+		}
+	}
+
+	void fill(const TYPE &value) {
+		for (size_t i = 0u; i < _size; ++i) {
+			_buffer[i] = value;
+		}
+	}
+
+	/**
+	 * @note Keeps the capacity
+	 */
+	void clear() {
+		for (size_t i = 0u; i < _size; ++i) {
+			_buffer[i].~TYPE();
+		}
+		_size = 0u;
+	}
+
+	/**
+	 * @brief Frees the allocated memory and switches back to the inline storage
+	 */
+	void release() {
+		clear();
+		if (!isInline()) {
+			ALLOCATOR::deallocate(_buffer, _capacity * sizeof(TYPE));
+			_buffer = inlineBuffer();
+			_capacity = N;
+		}
+	}
+
+	bool erase(iterator iter, size_t n = 1) {
+		if (iter == end()) {
+			return false;
+		}
+		erase(index(iter), n);
+		return true;
+	}
+
+	void erase(size_t index, size_t n = 1) {
+		if (n == 0 || index >= _size) {
+			return;
+		}
+		const size_t delta = core_min(_size - index, n);
+		for (size_t s = index + delta; s < _size; ++s) {
+			_buffer[s - delta] = core::move(_buffer[s]);
+		}
+		for (size_t i = _size - delta; i < _size; ++i) {
+			_buffer[i].~TYPE();
+		}
+		_size -= delta;
+	}
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline size_t capacity() const {
+		return _capacity;
+	}
+
+	/**
+	 * @return @c true if the elements are stored inside the object and nothing was allocated
+	 */
+	inline bool isSmall() const {
+		return isInline();
+	}
+
+	inline iterator begin() const {
+		return iterator(_buffer);
+	}
+
+	inline iterator end() const {
+		return iterator(_buffer + _size);
+	}
+
+	inline const TYPE &operator[](size_t idx) const {
+		core_assert_msg(idx < _size, "idx is out of bounds: %i vs %i", (int)idx, (int)_size);
+		return _buffer[idx];
+	}
+
+	inline TYPE &operator[](size_t idx) {
+		core_assert_msg(idx < _size, "idx is out of bounds: %i vs %i", (int)idx, (int)_size);
+		return _buffer[idx];
+	}
+
+	/**
+	 * @brief Insertion sort
+	 * @note stable
+	 * @note @c COMPARATOR must return true on @code lhs > rhs @endcode to sort ascending
+	 */
+	template<typename COMPARATOR>
+	void sort(COMPARATOR comp) {
+		for (int i = 1; i < (int)_size; ++i) {
+			TYPE key = core::move(_buffer[i]);
+			int j = i - 1;
+			while (j >= 0 && comp(_buffer[j], key)) {
+				_buffer[j + 1] = core::move(_buffer[j]);
+				--j;
+			}
+			_buffer[j + 1] = core::move(key);
+		}
+	}
+
+private:
+	inline size_t index(const_iterator iter) const {
+		return (size_t)(iter.operator->() - (const TYPE *)_buffer);
+	}
+};
+
+} // namespace core
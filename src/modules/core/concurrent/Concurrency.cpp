@@ -15,6 +15,7 @@
 #endif
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <sys/syscall.h>
@@ -122,6 +123,28 @@ void setThreadPriority(ThreadPriority prio) {
 #endif
 }
 
+bool setThreadAffinity(uint32_t core) {
+	core = core % cpus();
+#if defined(__LINUX__) && !defined(__ANDROID__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	const int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	if (err != 0) {
+		Log::debug("Can't set the thread affinity to core %u: %i", core, err);
+	}
+	return err == 0;
+#elif defined(__WINDOWS__)
+	if (core >= sizeof(DWORD_PTR) * 8u) {
+		return false;
+	}
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) != 0;
+#else
+	// macOS only supports affinity hints via thread_policy_set - not worth it
+	return false;
+#endif
+}
+
 uint32_t cpus() {
 	return core_max(1, SDL_GetCPUCount());
 }
@@ -95,4 +95,10 @@ enum class ThreadPriority { High, Normal, Low };
 
 extern void setThreadPriority(ThreadPriority prio);
 
+/**
+ * @brief Pins the calling thread to the given core - the index is wrapped by the amount of cores
+ * @return @c false if the platform doesn't support this or the call failed
+ */
+extern bool setThreadAffinity(uint32_t core);
+
 }
@@ -0,0 +1,152 @@
+/**
+ * @file
+ */
+
+#include "Parallel.h"
+#include "core/Common.h"
+#include "core/SharedPtr.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+
+namespace core {
+
+namespace {
+
+/**
+ * @brief The state is shared with the tasks of the thread pool - a task that is started after all slices were taken
+ * by other threads only touches the counter and must not access the function anymore.
+ */
+struct ParallelSlices {
+	std::function<void(int)> func;
+	int slices = 0;
+	core::AtomicInt next{0};
+	core::AtomicInt done{0};
+	core_trace_mutex(core::Lock, lock, "ParallelSlices");
+	core::ConditionVariable finished;
+
+	void run() {
+		for (;;) {
+			const int slice = next.increment();
+			if (slice >= slices) {
+				return;
+			}
+			func(slice);
+			done.increment();
+			{
+				core::ScopedLock scoped(lock);
+			}
+			finished.notify_all();
+		}
+	}
+};
+
+} // namespace
+
+void parallelSlices(ThreadPool *threadPool, int slices, const std::function<void(int)> &func) {
+	if (threadPool == nullptr || slices <= 1) {
+		for (int i = 0; i < slices; ++i) {
+			func(i);
+		}
+		return;
+	}
+	core::SharedPtr<ParallelSlices> state = core::make_shared<ParallelSlices>();
+	state->func = func;
+	state->slices = slices;
+	const int tasks = core_min((int)threadPool->size(), slices - 1);
+	for (int i = 0; i < tasks; ++i) {
+		threadPool->schedule([state]() { state->run(); });
+	}
+	state->run();
+	core::ScopedLock scoped(state->lock);
+	state->finished.wait(state->lock, [&state, slices]() { return (int)state->done == slices; });
+}
+
+int parallelSliceCount(const ThreadPool *threadPool, int extent) {
+	if (threadPool == nullptr) {
+		return 1;
+	}
+	return core_max(1, core_min((int)threadPool->size() + 1, extent));
+}
+
+int parallelGrainSize(const ThreadPool *threadPool, int count) {
+	if (threadPool == nullptr || count <= 0) {
+		return core_max(1, count);
+	}
+	// a few tasks per thread - the threads that finish early take the remaining ranges
+	const int tasks = ((int)threadPool->size() + 1) * 4;
+	return core_max(1, (count + tasks - 1) / tasks);
+}
+
+void parallelFor(ThreadPool *threadPool, int begin, int end, const std::function<void(int from, int to)> &func,
+				 int grain) {
+	if (end <= begin) {
+		return;
+	}
+	const int count = end - begin;
+	if (grain <= 0) {
+		grain = parallelGrainSize(threadPool, count);
+	}
+	const int ranges = (count + grain - 1) / grain;
+	parallelSlices(threadPool, ranges, [&](int range) {
+		const int from = begin + range * grain;
+		func(from, core_min(end, from + grain));
+	});
+}
+
+/**
+ * @brief Shared with the pool tasks - every pool task takes one task of the group. If the group task was already
+ * taken by the waiting thread, the pool task does nothing.
+ */
+struct TaskGroup::State {
+	core_trace_mutex(core::Lock, lock, "TaskGroup");
+	TaskQueue tasks;
+	core::AtomicInt pending{0};
+	core::ConditionVariable finished;
+
+	bool runOne() {
+		Task task;
+		{
+			core::ScopedLock scoped(lock);
+			if (!tasks.popFront(task)) {
+				return false;
+			}
+		}
+		task();
+		pending.decrement();
+		{
+			core::ScopedLock scoped(lock);
+		}
+		finished.notify_all();
+		return true;
+	}
+};
+
+TaskGroup::TaskGroup(ThreadPool *threadPool)
+	: _threadPool(threadPool), _state(core::make_shared<TaskGroup::State>()) {
+}
+
+TaskGroup::~TaskGroup() {
+	wait();
+}
+
+void TaskGroup::push(Task &&task) {
+	_state->pending.increment();
+	{
+		core::ScopedLock scoped(_state->lock);
+		_state->tasks.pushBack(core::move(task));
+	}
+	core::SharedPtr<State> state = _state;
+	_threadPool->schedule([state]() { state->runOne(); });
+}
+
+void TaskGroup::wait() {
+	// the pool might not have started the tasks yet - or doesn't accept new tasks because it's shutting down
+	while (_state->runOne()) {
+	}
+	core::ScopedLock scoped(_state->lock);
+	_state->finished.wait(_state->lock, [this]() { return (int)_state->pending == 0; });
+}
+
+} // namespace core
@@ -0,0 +1,135 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/SharedPtr.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Task.h"
+#include <functional>
+
+namespace core {
+
+class ThreadPool;
+
+/**
+ * @brief Calls the given function for each slice index in @c [0, slices) on the given thread pool
+ *
+ * The calling thread takes part in the work and only waits for the slices that are already in progress - so it's fine
+ * to use the pool the caller is running on. The slices are executed in any order.
+ *
+ * @param threadPool Might be @c nullptr - all slices are executed on the calling thread then
+ */
+void parallelSlices(ThreadPool *threadPool, int slices, const std::function<void(int)> &func);
+
+/**
+ * @return The amount of slices an extent should be split into to keep all threads of the given pool busy - at most
+ * @c extent slices and at least @c 1
+ */
+int parallelSliceCount(const ThreadPool *threadPool, int extent);
+
+/**
+ * @return The amount of indices one task should handle if @c count indices are processed on the given pool - a few
+ * tasks per thread are used to balance uneven work
+ */
+int parallelGrainSize(const ThreadPool *threadPool, int count);
+
+/**
+ * @brief Calls the given function for sub ranges @c [from, to) of @c [begin, end) on the given thread pool
+ *
+ * This is built on @c parallelSlices() - so it's fine to call it from a task of the same pool (nested parallelism).
+ *
+ * @param grain The max amount of indices per call - @c 0 picks a grain size with @c parallelGrainSize()
+ */
+void parallelFor(ThreadPool *threadPool, int begin, int end, const std::function<void(int from, int to)> &func,
+				 int grain = 0);
+
+/**
+ * @brief Maps the sub ranges @c [from, to) of @c [begin, end) to partial results on the given thread pool and reduces
+ * them on the calling thread
+ *
+ * The partial results are reduced in the order of the ranges - the result is deterministic even if the reduce
+ * function is not commutative.
+ *
+ * @param map @c T(int from, int to)
+ * @param reduce @c T(const T &a, const T &b)
+ */
+template<class T, class MAP, class REDUCE>
+T parallelReduce(ThreadPool *threadPool, int begin, int end, const T &identity, MAP &&map, REDUCE &&reduce,
+				 int grain = 0) {
+	if (end <= begin) {
+		return identity;
+	}
+	const int count = end - begin;
+	if (grain <= 0) {
+		grain = parallelGrainSize(threadPool, count);
+	}
+	const int ranges = (count + grain - 1) / grain;
+	core::DynamicArray<T> partials;
+	partials.resize(ranges);
+	parallelSlices(threadPool, ranges, [&](int range) {
+		const int from = begin + range * grain;
+		const int to = from + grain < end ? from + grain : end;
+		partials[range] = map(from, to);
+	});
+	T result = identity;
+	for (const T &partial : partials) {
+		result = reduce(result, partial);
+	}
+	return result;
+}
+
+/**
+ * @brief A group of tasks that can be waited for
+ *
+ * @c wait() executes the tasks of the group that were not yet started by the pool on the calling thread and only
+ * waits for the tasks that are already running. This makes it safe to use a task group from a task of the same pool.
+ *
+ * @code
+ * core::TaskGroup group(threadPool);
+ * for (...) {
+ *   group.run([&]() { ... });
+ * }
+ * group.wait();
+ * @endcode
+ */
+class TaskGroup {
+public:
+	struct State;
+
+private:
+	ThreadPool *_threadPool;
+	core::SharedPtr<State> _state;
+
+	void push(Task &&task);
+
+public:
+	/**
+	 * @param threadPool Might be @c nullptr - the tasks are executed in @c run() then
+	 */
+	explicit TaskGroup(ThreadPool *threadPool);
+	/**
+	 * @brief Waits for the tasks that are still pending
+	 */
+	~TaskGroup();
+
+	TaskGroup(const TaskGroup &) = delete;
+	TaskGroup &operator=(const TaskGroup &) = delete;
+
+	template<class F>
+	void run(F &&f) {
+		if (_threadPool == nullptr) {
+			f();
+			return;
+		}
+		push(Task(core::forward<F>(f)));
+	}
+
+	/**
+	 * @brief Returns once all tasks of the group are finished - the group can be used again afterwards
+	 */
+	void wait();
+};
+
+} // namespace core
@@ -0,0 +1,207 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Common.h"
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+
+namespace core {
+
+/**
+ * @brief Move-only @c void() callable with a small buffer for the functor
+ *
+ * Lambdas with captures of up to @c BufferSize bytes are stored inline - only bigger functors are allocated on the
+ * heap. This is used by the @c ThreadPool to avoid the allocation of a @c std::function for every task.
+ */
+class Task {
+public:
+	static constexpr size_t BufferSize = 64u;
+
+private:
+	struct Ops {
+		void (*invoke)(void *buffer);
+		void (*move)(void *dst, void *src);
+		void (*destroy)(void *buffer);
+	};
+
+	template<class F>
+	struct InlineOps {
+		static void invoke(void *buffer) {
+			(*(F *)buffer)();
+		}
+		static void move(void *dst, void *src) {
+			new (dst) F(core::move(*(F *)src));
+			((F *)src)->~F();
+		}
+		static void destroy(void *buffer) {
+			((F *)buffer)->~F();
+		}
+		static constexpr Ops ops{invoke, move, destroy};
+	};
+
+	template<class F>
+	struct HeapOps {
+		static void invoke(void *buffer) {
+			(**(F **)buffer)();
+		}
+		static void move(void *dst, void *src) {
+			*(F **)dst = *(F **)src;
+		}
+		static void destroy(void *buffer) {
+			delete *(F **)buffer;
+		}
+		static constexpr Ops ops{invoke, move, destroy};
+	};
+
+	alignas(alignof(max_align_t)) unsigned char _buffer[BufferSize];
+	const Ops *_ops = nullptr;
+
+	void reset() {
+		if (_ops != nullptr) {
+			_ops->destroy(_buffer);
+			_ops = nullptr;
+		}
+	}
+
+public:
+	Task() = default;
+
+	template<class F, class FUNC = typename std::decay<F>::type,
+			 class = typename std::enable_if<!std::is_same<FUNC, Task>::value>::type>
+	Task(F &&f) {
+		if constexpr (sizeof(FUNC) <= BufferSize && alignof(FUNC) <= alignof(max_align_t) &&
+					  std::is_nothrow_move_constructible<FUNC>::value) {
+			new (_buffer) FUNC(core::forward<F>(f));
+			_ops = &InlineOps<FUNC>::ops;
+		} else {
+			*(FUNC **)_buffer = new FUNC(core::forward<F>(f));
+			_ops = &HeapOps<FUNC>::ops;
+		}
+	}
+
+	Task(Task &&other) noexcept : _ops(other._ops) {
+		if (_ops != nullptr) {
+			_ops->move(_buffer, other._buffer);
+			other._ops = nullptr;
+		}
+	}
+
+	Task &operator=(Task &&other) noexcept {
+		if (this != &other) {
+			reset();
+			_ops = other._ops;
+			if (_ops != nullptr) {
+				_ops->move(_buffer, other._buffer);
+				other._ops = nullptr;
+			}
+		}
+		return *this;
+	}
+
+	Task(const Task &) = delete;
+	Task &operator=(const Task &) = delete;
+
+	~Task() {
+		reset();
+	}
+
+	inline bool valid() const {
+		return _ops != nullptr;
+	}
+
+	inline void operator()() {
+		_ops->invoke(_buffer);
+	}
+};
+
+/**
+ * @brief Ring buffer of tasks that can be taken from both ends
+ * @note Not thread safe - the users guard it with their own lock
+ */
+class TaskQueue {
+private:
+	Task *_tasks = nullptr;
+	size_t _capacity = 0u;
+	size_t _head = 0u;
+	size_t _count = 0u;
+
+public:
+	TaskQueue() = default;
+	TaskQueue(const TaskQueue &) = delete;
+	TaskQueue &operator=(const TaskQueue &) = delete;
+
+	~TaskQueue() {
+		delete[] _tasks;
+	}
+
+	inline size_t size() const {
+		return _count;
+	}
+
+	inline bool empty() const {
+		return _count == 0u;
+	}
+
+	void reserve(size_t capacity) {
+		if (capacity <= _capacity) {
+			return;
+		}
+		size_t newCapacity = _capacity == 0u ? 32u : _capacity * 2u;
+		while (newCapacity < capacity) {
+			newCapacity *= 2u;
+		}
+		Task *newTasks = new Task[newCapacity];
+		for (size_t i = 0u; i < _count; ++i) {
+			newTasks[i] = core::move(_tasks[(_head + i) & (_capacity - 1u)]);
+		}
+		delete[] _tasks;
+		_tasks = newTasks;
+		_capacity = newCapacity;
+		_head = 0u;
+	}
+
+	void pushBack(Task &&task) {
+		if (_count == _capacity) {
+			reserve(_count + 1u);
+		}
+		_tasks[(_head + _count) & (_capacity - 1u)] = core::move(task);
+		++_count;
+	}
+
+	bool popBack(Task &task) {
+		if (_count == 0u) {
+			return false;
+		}
+		--_count;
+		task = core::move(_tasks[(_head + _count) & (_capacity - 1u)]);
+		return true;
+	}
+
+	bool popFront(Task &task) {
+		if (_count == 0u) {
+			return false;
+		}
+		task = core::move(_tasks[_head]);
+		_head = (_head + 1u) & (_capacity - 1u);
+		--_count;
+		return true;
+	}
+
+	/**
+	 * @return The amount of removed tasks
+	 */
+	size_t clear() {
+		const size_t n = _count;
+		Task task;
+		while (popFront(task)) {
+			task = Task();
+		}
+		return n;
+	}
+};
+
+} // namespace core
@@ -10,20 +10,163 @@
 
 namespace core {
 
-ThreadPool::ThreadPool(size_t threads, const char *name) :
-		_threads(threads), _name(name) {
+namespace priv {
+
+// the pool and the queue index of the current worker thread - used to put the tasks of a worker into its own queue
+static thread_local const ThreadPool *t_pool = nullptr;
+static thread_local int t_worker = -1;
+
+} // namespace priv
+
+struct ThreadPool::WorkerQueue {
+	core_trace_mutex(core::Lock, mutex, "ThreadPoolWorkerQueue");
+	// the owning worker takes the newest task, other workers steal the oldest one
+	TaskQueue tasks;
+};
+
+ThreadPool::ThreadPool(size_t threads, const char *name, ThreadPriority priority) :
+		_threads(threads), _name(name), _priority(priority) {
 	if (_name == nullptr) {
 		_name = "ThreadPool";
 	}
+	const size_t queues = _threads > 0u ? _threads : 1u;
+	_queues.reserve(queues);
+	for (size_t i = 0; i < queues; ++i) {
+		_queues.push_back(new WorkerQueue());
+	}
+}
+
+void ThreadPool::setThreads(size_t threads) {
+	if (!_workers.empty()) {
+		Log::warn("Can't change the size of the running thread pool %s", _name);
+		return;
+	}
+	if (threads == _threads) {
+		return;
+	}
+	const size_t queues = threads > 0u ? threads : 1u;
+	core::DynamicArray<WorkerQueue *> oldQueues = core::move(_queues);
+	_queues.clear();
+	_queues.reserve(queues);
+	for (size_t i = 0; i < queues; ++i) {
+		_queues.push_back(new WorkerQueue());
+	}
+	// distribute the tasks that were queued before the pool was started
+	size_t idx = 0u;
+	for (WorkerQueue *queue : oldQueues) {
+		Task task;
+		while (queue->tasks.popFront(task)) {
+			_queues[idx++ % queues]->tasks.pushBack(core::move(task));
+		}
+		delete queue;
+	}
+	_threads = threads;
+}
+
+void ThreadPool::setPriority(ThreadPriority priority) {
+	_priority = priority;
+}
+
+void ThreadPool::setAffinity(int firstCore) {
+	_firstCore = firstCore;
+}
+
+void ThreadPool::reserve(size_t n) {
+	const size_t perQueue = n / _queues.size() + 1u;
+	for (WorkerQueue *queue : _queues) {
+		core::ScopedLock lock(queue->mutex);
+		queue->tasks.reserve(perQueue);
+	}
 }
 
 void ThreadPool::abort() {
-	core::ScopedLock lock(_queueMutex);
-	while (!_tasks.empty()) {
-		_tasks.pop();
+	for (WorkerQueue *queue : _queues) {
+		core::ScopedLock lock(queue->mutex);
+		_pending.decrement((int)queue->tasks.clear());
 	}
 }
 
+void ThreadPool::push(Task &&task) {
+	int idx;
+	if (priv::t_pool == this) {
+		idx = priv::t_worker;
+	} else {
+		idx = (int)((uint32_t)_nextQueue.increment() % (uint32_t)_queues.size());
+	}
+	// counted before the task is visible to make sure the counter never gets negative
+	_pending.increment();
+	{
+		WorkerQueue *queue = _queues[idx];
+		core::ScopedLock lock(queue->mutex);
+		queue->tasks.pushBack(core::move(task));
+	}
+	if (_sleeping > 0) {
+		core::ScopedLock lock(_sleepMutex);
+		_sleepCondition.notify_one();
+	}
+}
+
+bool ThreadPool::pop(int worker, Task &task) {
+	WorkerQueue *queue = _queues[worker];
+	core::ScopedLock lock(queue->mutex);
+	return queue->tasks.popBack(task);
+}
+
+bool ThreadPool::steal(int worker, Task &task) {
+	const int queues = (int)_queues.size();
+	for (int i = 1; i < queues; ++i) {
+		WorkerQueue *queue = _queues[(worker + i) % queues];
+		core::ScopedLock lock(queue->mutex);
+		if (queue->tasks.popFront(task)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::run(int worker) {
+	priv::t_pool = this;
+	priv::t_worker = worker;
+	const core::String n = core::string::format("%s-%i", _name, worker);
+	if (!setThreadName(n.c_str())) {
+		Log::debug("Failed to set thread name for pool thread %i", worker);
+	}
+	core_trace_thread(n.c_str());
+	if (_priority != ThreadPriority::Normal) {
+		setThreadPriority(_priority);
+	}
+	if (_firstCore >= 0 && !setThreadAffinity((uint32_t)(_firstCore + worker))) {
+		Log::debug("Failed to pin pool thread %i to core %i", worker, _firstCore + worker);
+	}
+	for (;;) {
+		Task task;
+		if (pop(worker, task) || steal(worker, task)) {
+			_pending.decrement();
+			if (_stop && _force) {
+				break;
+			}
+			core_trace_begin_frame(n.c_str());
+			core_trace_scoped(ThreadPoolWorker);
+			Log::trace("Execute task in %i", worker);
+			task();
+			Log::trace("End of task in %i", worker);
+			core_trace_end_frame(n.c_str());
+			continue;
+		}
+		if (_stop && (_force || _pending <= 0)) {
+			break;
+		}
+		core::ScopedLock lock(_sleepMutex);
+		_sleeping.increment();
+		// predicate must return false if the waiting should continue
+		_sleepCondition.wait(_sleepMutex, [this] { return _stop || _pending > 0; });
+		_sleeping.decrement();
+	}
+	Log::debug("Shutdown worker thread for %i", worker);
+	priv::t_pool = nullptr;
+	priv::t_worker = -1;
+}
+
 void ThreadPool::init() {
 #ifdef __EMSCRIPTEN__
 #ifndef __EMSCRIPTEN_PTHREADS__
@@ -35,50 +178,16 @@ void ThreadPool::init() {
 	_stop = false;
 	_workers.reserve(_threads);
 	for (size_t i = 0; i < _threads; ++i) {
-		_workers.emplace_back([this, i] {
-			const core::String n = core::string::format("%s-%i", this->_name, (int)i);
-			if (!setThreadName(n.c_str())) {
-				Log::debug("Failed to set thread name for pool thread %i", (int)i);
-			}
-			core_trace_thread(n.c_str());
-			for (;;) {
-				std::function<void()> task;
-				{
-					core::ScopedLock lock(this->_queueMutex);
-					if (!this->_stop) {
-						this->_queueCondition.wait(this->_queueMutex, [this] {
-							// predicate must return false if the waiting should continue
-							if (this->_stop) {
-								return true;
-							}
-							core::ScopedLock queueLock(this->_queueMutex);
-							if (!this->_tasks.empty()) {
-								return true;
-							}
-							return false;
-						});
-					}
-					if (this->_stop && (this->_force || this->_tasks.empty())) {
-						Log::debug("Shutdown worker thread for %i", (int)i);
-						break;
-					}
-					task = core::move(this->_tasks.front());
-					this->_tasks.pop();
-				}
-
-				core_trace_begin_frame(n.c_str());
-				core_trace_scoped(ThreadPoolWorker);
-				Log::trace("Execute task in %i", (int)i);
-				task();
-				Log::trace("End of task in %i", (int)i);
-				core_trace_end_frame(n.c_str());
-			}
-		});
+		_workers.emplace_back([this, i] { run((int)i); });
 	}
 }
 
 ThreadPool::~ThreadPool() {
 	shutdown();
+	for (WorkerQueue *queue : _queues) {
+		delete queue;
+	}
+	_queues.clear();
 }
 
 void ThreadPool::shutdown(bool wait) {
@@ -87,11 +196,16 @@ void ThreadPool::shutdown(bool wait) {
 	}
 	_force = !wait;
 	_stop = true;
-	_queueCondition.notify_all();
+	{
+		core::ScopedLock lock(_sleepMutex);
+		_sleepCondition.notify_all();
+	}
 	for (std::thread &worker : _workers) {
 		worker.join();
 	}
 	_workers.clear();
+	// the tasks that were not executed
+	abort();
 }
 
 }
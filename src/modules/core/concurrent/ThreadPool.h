@@ -31,26 +31,59 @@
 #include <future>
 #include <functional>
 #include "core/collection/DynamicArray.h"
-#include "core/collection/Queue.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/Concurrency.h"
 #include "core/concurrent/Lock.h"
 #include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Task.h"
 #include "core/Trace.h"
 #include "core/SharedPtr.h"
 
 namespace core {
 
+/**
+ * @brief Work stealing thread pool
+ *
+ * Every worker has its own task queue. Tasks that are added from a worker thread are put into the queue of this
+ * worker and are executed in last-in-first-out order by the worker - idle workers steal the oldest tasks from the
+ * other queues. Tasks from other threads are distributed over the worker queues. This keeps the lock contention low
+ * for a lot of small tasks.
+ *
+ * The amount of threads, the priority and the core affinity can be changed until @c init() was called.
+ */
 class ThreadPool final {
 public:
-	explicit ThreadPool(size_t, const char *name = nullptr);
+	explicit ThreadPool(size_t, const char *name = nullptr, ThreadPriority priority = ThreadPriority::Normal);
 	~ThreadPool();
 
+	/**
+	 * @brief Changes the amount of worker threads - the tasks that were already queued are kept
+	 * @note Only possible before @c init() was called
+	 */
+	void setThreads(size_t threads);
+	/**
+	 * @brief The priority of the worker threads - e.g. lower it for pools that do background work
+	 */
+	void setPriority(ThreadPriority priority);
+	/**
+	 * @brief Pin the worker threads to the cores starting at the given core index - @c -1 disables the pinning
+	 * @sa setThreadAffinity()
+	 */
+	void setAffinity(int firstCore);
+
 	/**
 	 * Enqueue functors or lambdas into the thread pool
 	 */
 	template<class F, class ... Args>
 	auto enqueue(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type>;
 
+	/**
+	 * @brief Enqueue a functor or lambda without a future to wait for - this doesn't allocate if the captures of
+	 * the lambda fit into the @c Task buffer
+	 */
+	template<class F>
+	void schedule(F&& f);
+
 	size_t size() const;
 	void init();
 	/**
@@ -62,24 +95,32 @@ public:
 
 	void reserve(size_t n);
 private:
-	const size_t _threads;
+	struct WorkerQueue;
+
+	size_t _threads;
 	const char *_name;
+	ThreadPriority _priority;
+	int _firstCore = -1;
 	// need to keep track of threads so we can join them
 	core::DynamicArray<std::thread> _workers;
-	// the task queue
-	core::Queue<std::function<void()> > _tasks core_thread_guarded_by(_queueMutex);
-
-	// synchronization
-	core_trace_mutex(core::Lock, _queueMutex, "ThreadPoolQueue");
-	core::ConditionVariable _queueCondition;
+	// one queue per worker - at least one
+	core::DynamicArray<WorkerQueue *> _queues;
+	// the amount of queued and not yet started tasks
+	core::AtomicInt _pending { 0 };
+	core::AtomicInt _sleeping { 0 };
+	core::AtomicInt _nextQueue { 0 };
+
+	// synchronization for the idle workers
+	core_trace_mutex(core::Lock, _sleepMutex, "ThreadPoolSleep");
+	core::ConditionVariable _sleepCondition;
 	core::AtomicBool _stop { false };
 	core::AtomicBool _force { false };
-};
 
-inline void ThreadPool::reserve(size_t n) {
-	core::ScopedLock lock(_queueMutex);
-	_tasks.reserve(n);
-}
+	void push(Task &&task);
+	bool pop(int worker, Task &task);
+	bool steal(int worker, Task &task);
+	void run(int worker);
+};
 
 // add new work item to the pool
 template<class F, class ... Args>
@@ -90,18 +131,18 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
 		return std::future<return_type>();
 	}
 
-	core::SharedPtr<std::packaged_task<return_type()> > task = core::make_shared<std::packaged_task<return_type()> >(std::bind(core::forward<F>(f), core::forward<Args>(args)...));
+	std::packaged_task<return_type()> task(std::bind(core::forward<F>(f), core::forward<Args>(args)...));
+	std::future<return_type> res = task.get_future();
+	push(Task([t = core::move(task)]() mutable { t(); }));
+	return res;
+}
 
-	std::future<return_type> res = task->get_future();
-	{
-		core::ScopedLock lock(_queueMutex);
-		if (_stop) {
-			return std::future<return_type>();
-		}
-		_tasks.emplace([task]() {(*task.get())();});
+template<class F>
+void ThreadPool::schedule(F&& f) {
+	if (_stop) {
+		return;
 	}
-	_queueCondition.notify_one();
-	return res;
+	push(Task(core::forward<F>(f)));
 }
 
 inline size_t ThreadPool::size() const {
@@ -0,0 +1,98 @@
+/**
+ * @file
+ */
+
+#include "core/ArenaAllocator.h"
+#include "core/Allocator.h"
+#include "core/collection/Buffer.h"
+#include "core/collection/DynamicArray.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace core {
+
+TEST(ArenaAllocatorTest, testAllocateAligned) {
+	ArenaAllocator arena(1024u);
+	void *a = arena.allocate(3u);
+	void *b = arena.allocate(5u);
+	ASSERT_NE(nullptr, a);
+	ASSERT_NE(nullptr, b);
+	EXPECT_EQ(0u, (uintptr_t)a % ArenaAllocator::DefaultAlignment);
+	EXPECT_EQ(0u, (uintptr_t)b % ArenaAllocator::DefaultAlignment);
+	EXPECT_EQ((uint8_t *)a + ArenaAllocator::DefaultAlignment, (uint8_t *)b);
+	EXPECT_EQ(1024u, arena.capacity());
+}
+
+TEST(ArenaAllocatorTest, testDeallocateLast) {
+	ArenaAllocator arena(1024u);
+	arena.allocate(16u);
+	void *b = arena.allocate(32u);
+	EXPECT_EQ(48u, arena.used());
+	arena.deallocate(b, 32u);
+	EXPECT_EQ(16u, arena.used());
+	// the same memory is handed out again
+	EXPECT_EQ(b, arena.allocate(32u));
+}
+
+TEST(ArenaAllocatorTest, testRewind) {
+	ArenaAllocator arena(256u);
+	arena.allocate(64u);
+	const ArenaAllocator::Marker marker = arena.mark();
+	for (int i = 0; i < 16; ++i) {
+		arena.allocate(100u);
+	}
+	EXPECT_GT(arena.capacity(), 256u);
+	arena.rewind(marker);
+	EXPECT_EQ(64u, arena.used());
+	EXPECT_EQ(256u, arena.capacity());
+}
+
+TEST(ArenaAllocatorTest, testResetMergesBlocks) {
+	ArenaAllocator arena(256u);
+	for (int i = 0; i < 16; ++i) {
+		arena.allocate(128u);
+	}
+	EXPECT_EQ(16u * 128u, arena.peak());
+	arena.reset();
+	EXPECT_EQ(0u, arena.used());
+	// one block that fits the peak usage
+	EXPECT_EQ(16u * 128u, arena.capacity());
+	for (int i = 0; i < 16; ++i) {
+		arena.allocate(128u);
+	}
+	EXPECT_EQ(16u * 128u, arena.capacity());
+}
+
+TEST(ArenaAllocatorTest, testFrameAllocatorScope) {
+	const size_t before = FrameAllocator::arena().used();
+	{
+		FrameAllocatorScope scope;
+		DynamicArray<int, 32u, FrameAllocator> array;
+		for (int i = 0; i < 1000; ++i) {
+			array.push_back(i);
+		}
+		Buffer<uint8_t, 32u, FrameAllocator> buffer;
+		buffer.resize(100u);
+		buffer.resize(10u);
+		for (int i = 0; i < 1000; ++i) {
+			ASSERT_EQ(i, array[i]);
+		}
+		EXPECT_GT(FrameAllocator::arena().used(), before);
+	}
+	EXPECT_EQ(before, FrameAllocator::arena().used());
+}
+
+TEST(ArenaAllocatorTest, testFrameAllocatorPerThread) {
+	void *mainPtr = FrameAllocator::allocate(16u);
+	void *threadPtr = nullptr;
+	std::thread thread([&threadPtr]() {
+		FrameAllocatorScope scope;
+		threadPtr = FrameAllocator::allocate(16u);
+	});
+	thread.join();
+	EXPECT_NE(mainPtr, threadPtr);
+	FrameAllocator::reset();
+	EXPECT_EQ(0u, FrameAllocator::arena().used());
+}
+
+} // namespace core
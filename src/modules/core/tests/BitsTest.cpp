@@ -22,4 +22,18 @@ TEST(BitsTest, extract1011) {
 	EXPECT_EQ(5u, bits(input, 1, 3));
 }
 
+TEST(BitsTest, popCount) {
+	EXPECT_EQ(0, popCount(0u));
+	EXPECT_EQ(4, popCount(0b1111u));
+	EXPECT_EQ(64, popCount(UINT64_MAX));
+}
+
+TEST(BitsTest, countZeros) {
+	EXPECT_EQ(0, countTrailingZeros(1u));
+	EXPECT_EQ(3, countTrailingZeros(0b1000u));
+	EXPECT_EQ(63, countTrailingZeros(UINT64_C(1) << 63));
+	EXPECT_EQ(63, countLeadingZeros(1u));
+	EXPECT_EQ(0, countLeadingZeros(UINT64_C(1) << 63));
+}
+
 }
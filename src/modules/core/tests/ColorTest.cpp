@@ -9,6 +9,7 @@
 #include "core/StringUtil.h"
 #include "core/collection/BufferView.h"
 #include "core/Endian.h"
+#include "core/concurrent/ThreadPool.h"
 
 namespace core {
 
@@ -110,7 +111,7 @@ TEST(ColorTest, testQuantize) {
 	EXPECT_EQ(256, n) << "Failed with octree.\n" << core::BufferView<RGBA>(targetBuf, n) << "\n" << core::BufferView<RGBA>(buf, lengthof(buf));
 
 	n = core::Color::quantize(targetBuf, lengthof(targetBuf), buf, lengthof(buf), core::Color::ColorReductionType::Wu);
-	EXPECT_EQ(161, n) << "Failed with Wu.\n" << core::BufferView<RGBA>(targetBuf, n) << "\n" << core::BufferView<RGBA>(buf, lengthof(buf));
+	EXPECT_EQ(256, n) << "Failed with Wu.\n" << core::BufferView<RGBA>(targetBuf, n) << "\n" << core::BufferView<RGBA>(buf, lengthof(buf));
 
 	// n = core::Color::quantize(targetBuf, lengthof(targetBuf), buf, lengthof(buf), core::Color::ColorReductionType::MedianCut);
 	// EXPECT_EQ(72, n) << "Failed with median cut.\n" << core::BufferView<RGBA>(targetBuf, n) << "\n" << core::BufferView<RGBA>(buf, lengthof(buf));
@@ -119,6 +120,50 @@ TEST(ColorTest, testQuantize) {
 	EXPECT_EQ(256, n) << "Failed with k-means.\n" << core::BufferView<RGBA>(targetBuf, n) << "\n" << core::BufferView<RGBA>(buf, lengthof(buf));
 }
 
+TEST(ColorTest, testQuantizeExactColors) {
+	// more colors than the target buffer can hold - but less distinct colors
+	RGBA colors[300];
+	for (int i = 0; i < (int)lengthof(colors); ++i) {
+		colors[i] = RGBA((uint8_t)(i % 10) * 20u, 255u - (uint8_t)(i % 10) * 20u, 7u, 255u);
+	}
+	for (Color::ColorReductionType type : {Color::ColorReductionType::Wu, Color::ColorReductionType::KMeans}) {
+		RGBA targetBuf[256];
+		const int n = Color::quantize(targetBuf, lengthof(targetBuf), colors, lengthof(colors), type);
+		ASSERT_EQ(10, n) << Color::toColorReductionTypeString(type);
+		for (int i = 0; i < 10; ++i) {
+			bool found = false;
+			for (int j = 0; j < n; ++j) {
+				found |= targetBuf[j] == colors[i];
+			}
+			EXPECT_TRUE(found) << "color " << i << " of " << Color::toColorReductionTypeString(type);
+		}
+	}
+}
+
+TEST(ColorTest, testQuantizeThreads) {
+	core::DynamicArray<RGBA> colors;
+	colors.resize(200000);
+	uint32_t state = 0x2545f491u;
+	for (RGBA &color : colors) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		color = RGBA(state | 0xff000000u);
+	}
+	core::ThreadPool threadPool(4, "ColorTest");
+	threadPool.init();
+	for (Color::ColorReductionType type : {Color::ColorReductionType::Wu, Color::ColorReductionType::KMeans}) {
+		RGBA serial[256];
+		RGBA parallel[256];
+		const int n = Color::quantize(serial, lengthof(serial), colors.data(), colors.size(), type);
+		EXPECT_EQ(256, n);
+		EXPECT_EQ(n, Color::quantize(parallel, lengthof(parallel), colors.data(), colors.size(), type, &threadPool));
+		for (int i = 0; i < n; ++i) {
+			EXPECT_EQ(serial[i], parallel[i]) << "color " << i << " of " << Color::toColorReductionTypeString(type);
+		}
+	}
+}
+
 TEST(ColorTest, testDistanceMin) {
 	const core::RGBA color1(255, 0, 0, 255);
 	const core::RGBA color2(255, 0, 0, 255);
@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/ConcurrentRingBuffer.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace collection {
+
+class ConcurrentRingBufferTest : public testing::Test {
+};
+
+TEST_F(ConcurrentRingBufferTest, testPushPopFull) {
+	core::ConcurrentRingBuffer<int, 8> queue;
+	for (int round = 0; round < 3; ++round) {
+		for (int i = 0; i < 8; ++i) {
+			ASSERT_TRUE(queue.push(i));
+		}
+		int v = -1;
+		EXPECT_FALSE(queue.push(8));
+		EXPECT_EQ(8u, queue.size());
+		for (int i = 0; i < 8; ++i) {
+			ASSERT_TRUE(queue.pop(v));
+			ASSERT_EQ(i, v);
+		}
+		EXPECT_FALSE(queue.pop(v));
+		EXPECT_TRUE(queue.empty());
+	}
+}
+
+TEST_F(ConcurrentRingBufferTest, testMultipleProducersConsumers) {
+	const int producers = 4;
+	const int consumers = 4;
+	const int n = 10000;
+	core::ConcurrentRingBuffer<int, 64> queue;
+	std::vector<std::thread> threads;
+	std::atomic<int64_t> sum{0};
+	std::atomic<int> popped{0};
+	for (int p = 0; p < producers; ++p) {
+		threads.emplace_back([&queue, p]() {
+			for (int i = 0; i < n; ++i) {
+				const int v = p * n + i;
+				while (!queue.push(v)) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (int c = 0; c < consumers; ++c) {
+		threads.emplace_back([&]() {
+			int v;
+			while (popped.load() < producers * n) {
+				if (queue.pop(v)) {
+					sum += v;
+					++popped;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	const int64_t total = (int64_t)producers * n;
+	EXPECT_EQ(total * (total - 1) / 2, sum.load());
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(ConcurrentRingBufferTest, testSPSCOrder) {
+	const uint32_t n = 100000u;
+	core::SPSCRingBuffer<uint32_t, 32> queue;
+	std::thread producer([&]() {
+		for (uint32_t i = 0u; i < n; ++i) {
+			while (!queue.push(i)) {
+				std::this_thread::yield();
+			}
+		}
+	});
+	for (uint32_t i = 0u; i < n; ++i) {
+		uint32_t v;
+		while (!queue.pop(v)) {
+			std::this_thread::yield();
+		}
+		ASSERT_EQ(i, v);
+	}
+	producer.join();
+	EXPECT_TRUE(queue.empty());
+}
+
+}
@@ -0,0 +1,125 @@
+/**
+ * @file
+ */
+
+#include "core/String.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/FlatMap.h"
+#include "core/collection/FlatSet.h"
+#include <gtest/gtest.h>
+
+namespace core {
+
+TEST(FlatMapTest, testPutGet) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	map.put(1, 1);
+	map.put(1, 2);
+	map.put(2, 1);
+	map.put(3, 1337);
+	EXPECT_EQ(3u, map.size());
+	int64_t value;
+	EXPECT_TRUE(map.get(1, value));
+	EXPECT_EQ(2, value);
+	EXPECT_TRUE(map.get(2, value));
+	EXPECT_EQ(1, value);
+	EXPECT_TRUE(map.get(3, value));
+	EXPECT_EQ(1337, value);
+	EXPECT_FALSE(map.get(4, value));
+}
+
+TEST(FlatMapTest, testGrow) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	for (int64_t i = 0; i < 10000; ++i) {
+		map.put(i, i * 2);
+	}
+	EXPECT_EQ(10000u, map.size());
+	EXPECT_GE(map.capacity(), 10000u);
+	int64_t value = 0;
+	for (int64_t i = 0; i < 10000; ++i) {
+		ASSERT_TRUE(map.get(i, value));
+		EXPECT_EQ(i * 2, value);
+	}
+}
+
+TEST(FlatMapTest, testRemove) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	for (int64_t i = 0; i < 1000; ++i) {
+		map.put(i, i);
+	}
+	for (int64_t i = 0; i < 1000; i += 2) {
+		EXPECT_TRUE(map.remove(i));
+	}
+	EXPECT_FALSE(map.remove(0));
+	EXPECT_EQ(500u, map.size());
+	for (int64_t i = 0; i < 1000; ++i) {
+		EXPECT_EQ(i % 2 == 1, map.hasKey(i)) << i;
+	}
+}
+
+TEST(FlatMapTest, testIterate) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	for (int64_t i = 0; i < 100; ++i) {
+		map.put(i, i);
+	}
+	int64_t sum = 0;
+	int n = 0;
+	for (auto iter = map.begin(); iter != map.end(); ++iter) {
+		EXPECT_EQ(iter->key, iter->value);
+		sum += iter->value;
+		++n;
+	}
+	EXPECT_EQ(100, n);
+	EXPECT_EQ(4950, sum);
+	map.erase(map.find(50));
+	EXPECT_EQ(99u, map.size());
+	EXPECT_EQ(map.end(), map.find(50));
+}
+
+TEST(FlatMapTest, testCopyMoveClear) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	for (int64_t i = 0; i < 16; ++i) {
+		map.put(i, i);
+	}
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> copy(map);
+	EXPECT_EQ(16u, copy.size());
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> moved(core::move(map));
+	EXPECT_EQ(16u, moved.size());
+	EXPECT_TRUE(map.empty());
+	EXPECT_FALSE(map.hasKey(1));
+	moved.clear();
+	EXPECT_TRUE(moved.empty());
+	EXPECT_FALSE(moved.hasKey(1));
+	EXPECT_TRUE(copy.hasKey(15));
+}
+
+TEST(FlatMapTest, testStringKeys) {
+	core::FlatMap<core::String, core::DynamicArray<int>, core::StringHash> map;
+	for (int i = 0; i < 100; ++i) {
+		core::DynamicArray<int> ids;
+		ids.push_back(i);
+		map.emplace(core::String::format("node%i", i), core::move(ids));
+	}
+	auto iter = map.find("node42");
+	ASSERT_NE(map.end(), iter);
+	iter->value.push_back(43);
+	EXPECT_EQ(2u, map.find("node42")->value.size());
+	EXPECT_TRUE(map.remove("node0"));
+	EXPECT_FALSE(map.hasKey("node0"));
+	EXPECT_EQ(99u, map.size());
+}
+
+TEST(FlatMapTest, testSet) {
+	core::FlatSet<int, std::hash<int>> set;
+	EXPECT_TRUE(set.insert(1));
+	EXPECT_FALSE(set.insert(1));
+	EXPECT_TRUE(set.insert(2));
+	const int values[] = {2, 3, 4};
+	set.insert(values, values + 3);
+	EXPECT_EQ(4u, set.size());
+	EXPECT_TRUE(set.has(4));
+	EXPECT_FALSE(set.has(5));
+	EXPECT_TRUE(set.remove(1));
+	EXPECT_FALSE(set.has(1));
+}
+
+} // namespace core
@@ -11,4 +11,14 @@ TEST(HasTest, testUUID) {
 	ASSERT_EQ(36u, generateUUID().size());
 }
 
+TEST(HasTest, testHash64) {
+	// reference values of xxHash64
+	EXPECT_EQ(0xEF46DB3751D8E999ULL, hash64("", 0));
+	EXPECT_EQ(0xD24EC4F1A98C6E5BULL, hash64("a", 1));
+	EXPECT_EQ(0x44BC2CF5AD770999ULL, hash64("abc", 3));
+	const char text[] = "Nobody inspects the spammish repetition";
+	EXPECT_EQ(0xFBCEA83C8A378BF1ULL, hash64(text, sizeof(text) - 1));
+	EXPECT_NE(hash64("abc", 3), hash64("abc", 3, 1u));
+}
+
 } // namespace core
@@ -0,0 +1,61 @@
+/**
+ * @file
+ */
+
+#include "core/MemoryTracker.h"
+#include "core/collection/DynamicArray.h"
+#include <gtest/gtest.h>
+
+namespace core {
+
+#ifdef MEMORY_TRACKING
+
+TEST(MemoryTrackerTest, testAllocFree) {
+	const MemoryStats before = memoryStats(MemoryTag::Volume);
+	void *ptr = memoryAlloc(MemoryTag::Volume, 1024u);
+	ASSERT_NE(nullptr, ptr);
+	MemoryStats stats = memoryStats(MemoryTag::Volume);
+	EXPECT_EQ(before.bytes + 1024, stats.bytes);
+	EXPECT_EQ(before.allocations + 1, stats.allocations);
+	EXPECT_GE(stats.peak, stats.bytes);
+	memoryFree(MemoryTag::Volume, ptr, 1024u);
+	stats = memoryStats(MemoryTag::Volume);
+	EXPECT_EQ(before.bytes, stats.bytes);
+	EXPECT_GE(stats.peak, before.bytes + 1024);
+}
+
+TEST(MemoryTrackerTest, testTrackedAllocator) {
+	const int64_t before = memoryStats(MemoryTag::Mesh).bytes;
+	{
+		DynamicArray<int, 32u, TrackedAllocator<MemoryTag::Mesh>> array;
+		for (int i = 0; i < 100; ++i) {
+			array.push_back(i);
+		}
+		EXPECT_GE(memoryStats(MemoryTag::Mesh).bytes, before + (int64_t)(100 * sizeof(int)));
+		array.release();
+		EXPECT_EQ(before, memoryStats(MemoryTag::Mesh).bytes);
+		array.push_back(1);
+	}
+	EXPECT_EQ(before, memoryStats(MemoryTag::Mesh).bytes);
+}
+
+TEST(MemoryTrackerTest, testUpdate) {
+	const int64_t before = memoryStats(MemoryTag::Memento).bytes;
+	size_t tracked = 0u;
+	memoryTrackUpdate(MemoryTag::Memento, tracked, 100u);
+	EXPECT_EQ(100u, tracked);
+	EXPECT_EQ(before + 100, memoryStats(MemoryTag::Memento).bytes);
+	memoryTrackUpdate(MemoryTag::Memento, tracked, 40u);
+	EXPECT_EQ(before + 40, memoryStats(MemoryTag::Memento).bytes);
+	memoryTrackUpdate(MemoryTag::Memento, tracked, 0u);
+	EXPECT_EQ(before, memoryStats(MemoryTag::Memento).bytes);
+}
+
+#endif
+
+TEST(MemoryTrackerTest, testTagName) {
+	EXPECT_STREQ("Volume", memoryTagName(MemoryTag::Volume));
+	EXPECT_STREQ("Lua", memoryTagName(MemoryTag::Lua));
+}
+
+} // namespace core
@@ -0,0 +1,67 @@
+/**
+ * @file
+ */
+
+#include "core/PerfStats.h"
+#include "core/StringUtil.h"
+#include <gtest/gtest.h>
+
+namespace core {
+
+class PerfStatsTest : public testing::Test {
+protected:
+	void SetUp() override {
+		perfReset();
+	}
+};
+
+TEST_F(PerfStatsTest, testHistogram) {
+	for (uint64_t i = 1u; i <= 100u; ++i) {
+		perfRecord(PerfStat::Extraction, i);
+	}
+	const PerfStats &stats = perfStats(PerfStat::Extraction);
+	EXPECT_EQ(100u, stats.count);
+	EXPECT_EQ(100u, stats.max);
+	EXPECT_EQ(100u, stats.last);
+	EXPECT_DOUBLE_EQ(50.5, stats.mean());
+	// the percentiles are estimated from power of two buckets
+	EXPECT_GE(stats.p50, 32u);
+	EXPECT_LE(stats.p50, 63u);
+	EXPECT_GE(stats.p90, 64u);
+	EXPECT_LE(stats.p99, 100u);
+	EXPECT_LE(stats.p50, stats.p90);
+	EXPECT_LE(stats.p90, stats.p99);
+}
+
+TEST_F(PerfStatsTest, testGauge) {
+	perfGauge(PerfStat::ExtractionQueue, 10u);
+	perfGauge(PerfStat::ExtractionQueue, 3u);
+	const PerfStats &stats = perfStats(PerfStat::ExtractionQueue);
+	EXPECT_EQ(3u, stats.last);
+	EXPECT_EQ(10u, stats.max);
+}
+
+TEST_F(PerfStatsTest, testPerFrame) {
+	perfAdd(PerfStat::UploadBytes, 100u);
+	perfAdd(PerfStat::UploadBytes, 28u);
+	EXPECT_EQ(0u, perfStats(PerfStat::UploadBytes).count);
+	perfFrame();
+	perfFrame();
+	const PerfStats &stats = perfStats(PerfStat::UploadBytes);
+	EXPECT_EQ(2u, stats.count);
+	EXPECT_EQ(128u, stats.max);
+	EXPECT_EQ(0u, stats.last);
+}
+
+TEST_F(PerfStatsTest, testJson) {
+	EXPECT_EQ("{}", perfStatsJson());
+	perfRecord(PerfStat::FormatLoad, 5u);
+	perfGauge(PerfStat::ExtractionQueue, 2u);
+	const core::String &json = perfStatsJson();
+	EXPECT_TRUE(core::string::startsWith(json, "{\"extractionQueue\":{\"unit\":\"chunks\",\"count\":1,\"value\":2"))
+		<< json.c_str();
+	EXPECT_NE(core::String::npos, json.find("\"formatLoad\":{\"unit\":\"us\",\"count\":1,\"mean\":5.0,\"p50\":5"))
+		<< json.c_str();
+}
+
+} // namespace core
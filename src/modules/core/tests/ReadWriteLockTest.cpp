@@ -77,4 +77,17 @@ TEST_F(ReadWriteLockTest, testMoreWritersThanReaders) {
 	EXPECT_EQ(n1, limit);
 }
 
+TEST_F(ReadWriteLockTest, testWriterReentrant) {
+	{
+		core::ScopedWriteLock scoped(_rwLock);
+		core::ScopedWriteLock nested(_rwLock);
+		EXPECT_EQ(1, read(1)) << "The writer must be able to read";
+		++_value;
+	}
+	auto futureWrite = std::async(std::launch::async, [=] { write(1); });
+	ASSERT_EQ(std::future_status::ready, futureWrite.wait_for(std::chrono::seconds(10)))
+		<< "The write lock was not released";
+	EXPECT_EQ(2, _value);
+}
+
 }
@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#include "core/collection/SmallVector.h"
+#include "core/String.h"
+#include <gtest/gtest.h>
+
+namespace core {
+
+TEST(SmallVectorTest, testInline) {
+	SmallVector<int, 4> array;
+	for (int i = 0; i < 4; ++i) {
+		array.push_back(i);
+	}
+	EXPECT_TRUE(array.isSmall());
+	EXPECT_EQ(4u, array.capacity());
+	array.push_back(4);
+	EXPECT_FALSE(array.isSmall());
+	EXPECT_EQ(5u, array.size());
+	for (int i = 0; i < 5; ++i) {
+		EXPECT_EQ(i, array[i]);
+	}
+	array.release();
+	EXPECT_TRUE(array.isSmall());
+	EXPECT_TRUE(array.empty());
+}
+
+TEST(SmallVectorTest, testInsertErase) {
+	SmallVector<core::String, 2> array;
+	array.push_back("a");
+	array.push_back("d");
+	const core::String values[] = {"b", "c"};
+	array.insert(array.begin() + 1, values, 2);
+	ASSERT_EQ(4u, array.size());
+	EXPECT_EQ("a", array[0]);
+	EXPECT_EQ("b", array[1]);
+	EXPECT_EQ("c", array[2]);
+	EXPECT_EQ("d", array[3]);
+	array.erase(0);
+	EXPECT_EQ("b", array.front());
+	array.erase(array.begin() + 1, 2);
+	ASSERT_EQ(1u, array.size());
+	EXPECT_EQ("b", array.back());
+	array.push_front("a");
+	EXPECT_EQ("a", array.front());
+}
+
+TEST(SmallVectorTest, testCopyMove) {
+	SmallVector<core::String, 2> small{"a", "b"};
+	SmallVector<core::String, 2> big{"a", "b", "c"};
+
+	SmallVector<core::String, 2> copy(small);
+	EXPECT_EQ(2u, copy.size());
+	EXPECT_TRUE(copy.isSmall());
+	copy = big;
+	EXPECT_EQ(3u, copy.size());
+	EXPECT_EQ("c", copy.back());
+
+	SmallVector<core::String, 2> moved(core::move(small));
+	EXPECT_TRUE(moved.isSmall());
+	EXPECT_EQ("b", moved[1]);
+	EXPECT_TRUE(small.empty());
+
+	const core::String *data = big.data();
+	moved = core::move(big);
+	EXPECT_FALSE(moved.isSmall());
+	// the heap buffer is taken over
+	EXPECT_EQ(data, moved.data());
+	EXPECT_EQ(3u, moved.size());
+	EXPECT_TRUE(big.empty());
+	EXPECT_TRUE(big.isSmall());
+}
+
+TEST(SmallVectorTest, testSortResize) {
+	SmallVector<int, 8> array{3, 1, 2};
+	array.sort([](int lhs, int rhs) { return lhs > rhs; });
+	EXPECT_EQ(1, array[0]);
+	EXPECT_EQ(2, array[1]);
+	EXPECT_EQ(3, array[2]);
+	array.resize(10);
+	EXPECT_EQ(10u, array.size());
+	EXPECT_EQ(0, array[9]);
+	int sum = 0;
+	for (int v : array) {
+		sum += v;
+	}
+	EXPECT_EQ(6, sum);
+}
+
+} // namespace core
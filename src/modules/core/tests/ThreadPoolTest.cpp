@@ -5,6 +5,9 @@
 #include <gtest/gtest.h>
 #include "core/concurrent/ThreadPool.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/Parallel.h"
+#include "core/collection/DynamicArray.h"
+#include "core/String.h"
 
 namespace core {
 
@@ -42,4 +45,192 @@ TEST_F(ThreadPoolTest, testMultiplePush) {
 	ASSERT_EQ(x, _count) << "Not all threads were executed";
 }
 
+TEST_F(ThreadPoolTest, testSchedule) {
+	const int x = 1000;
+	core::ThreadPool pool(4);
+	pool.init();
+	for (int i = 0; i < x; ++i) {
+		pool.schedule([this] () {
+			++_count;
+		});
+	}
+	pool.shutdown(true);
+	ASSERT_EQ(x, _count) << "Not all tasks were executed";
+}
+
+TEST_F(ThreadPoolTest, testSetThreads) {
+	const int x = 100;
+	core::ThreadPool pool(1);
+	for (int i = 0; i < x; ++i) {
+		pool.schedule([this] () {
+			++_count;
+		});
+	}
+	pool.setThreads(3);
+	pool.setAffinity(0);
+	pool.setPriority(core::ThreadPriority::Low);
+	EXPECT_EQ(3u, pool.size());
+	pool.init();
+	pool.shutdown(true);
+	ASSERT_EQ(x, _count) << "The tasks that were queued before the resize were lost";
+}
+
+TEST_F(ThreadPoolTest, testScheduleFromWorker) {
+	const int x = 100;
+	core::ThreadPool pool(4);
+	pool.init();
+	core::AtomicInt done{0};
+	// the tasks of a worker are put into its own queue - the idle workers steal them
+	auto future = pool.enqueue([&] () {
+		for (int i = 0; i < x; ++i) {
+			pool.schedule([&] () {
+				++_count;
+				++done;
+			});
+		}
+	});
+	future.get();
+	while (done < x) {
+		std::this_thread::yield();
+	}
+	pool.shutdown(true);
+	ASSERT_EQ(x, _count) << "Not all tasks were executed";
+}
+
+TEST_F(ThreadPoolTest, testEnqueueResult) {
+	core::ThreadPool pool(2);
+	pool.init();
+	auto future = pool.enqueue([] (int a, int b) {
+		return a + b;
+	}, 2, 3);
+	ASSERT_EQ(5, future.get());
+	pool.shutdown();
+}
+
+TEST_F(ThreadPoolTest, testTaskBuffer) {
+	int value = 0;
+	core::Task small([&value] () {
+		++value;
+	});
+	// captures that don't fit into the buffer are allocated
+	struct Big {
+		uint8_t data[core::Task::BufferSize * 2];
+	} big{};
+	big.data[0] = 41;
+	core::Task large([&value, big] () {
+		value += big.data[0];
+	});
+	core::Task moved(core::move(large));
+	ASSERT_FALSE(large.valid());
+	ASSERT_TRUE(moved.valid());
+	small();
+	moved();
+	ASSERT_EQ(42, value);
+}
+
+TEST_F(ThreadPoolTest, testParallelSlices) {
+	core::ThreadPool pool(2);
+	pool.init();
+	const int slices = core::parallelSliceCount(&pool, 100);
+	ASSERT_EQ(3, slices);
+	core::AtomicInt sliceSum{0};
+	core::parallelSlices(&pool, slices, [&] (int slice) {
+		sliceSum.increment(slice + 1);
+		++_count;
+	});
+	// all slices are done when the call returns
+	ASSERT_EQ(slices, _count);
+	ASSERT_EQ(6, sliceSum);
+	ASSERT_EQ(1, core::parallelSliceCount(nullptr, 100));
+	core::parallelSlices(nullptr, 2, [&] (int slice) {
+		++_count;
+	});
+	ASSERT_EQ(slices + 2, _count);
+	pool.shutdown();
+}
+
+TEST_F(ThreadPoolTest, testParallelFor) {
+	core::ThreadPool pool(3);
+	pool.init();
+	core::DynamicArray<int> values;
+	values.resize(1000);
+	core::parallelFor(&pool, 0, (int)values.size(), [&] (int from, int to) {
+		for (int i = from; i < to; ++i) {
+			values[i] = i * 2;
+		}
+	});
+	for (int i = 0; i < (int)values.size(); ++i) {
+		ASSERT_EQ(i * 2, values[i]);
+	}
+	// explicit grain size
+	core::parallelFor(&pool, 10, 20, [&] (int from, int to) {
+		EXPECT_LE(to - from, 3);
+		_count.increment(to - from);
+	}, 3);
+	ASSERT_EQ(10, _count);
+	pool.shutdown();
+}
+
+TEST_F(ThreadPoolTest, testParallelReduce) {
+	core::ThreadPool pool(3);
+	pool.init();
+	const int64_t sum = core::parallelReduce<int64_t>(&pool, 1, 10001, 0, [] (int from, int to) {
+		int64_t partial = 0;
+		for (int i = from; i < to; ++i) {
+			partial += i;
+		}
+		return partial;
+	}, [] (int64_t a, int64_t b) {
+		return a + b;
+	});
+	ASSERT_EQ(50005000, sum);
+	// the partial results are reduced in order
+	const core::String str = core::parallelReduce<core::String>(&pool, 0, 10, "", [] (int from, int to) {
+		core::String partial;
+		for (int i = from; i < to; ++i) {
+			partial += core::String::format("%i", i);
+		}
+		return partial;
+	}, [] (const core::String &a, const core::String &b) {
+		return a + b;
+	}, 1);
+	ASSERT_EQ("0123456789", str);
+	pool.shutdown();
+}
+
+TEST_F(ThreadPoolTest, testTaskGroup) {
+	core::ThreadPool pool(2);
+	pool.init();
+	core::TaskGroup group(&pool);
+	for (int i = 0; i < 100; ++i) {
+		group.run([this] () {
+			++_count;
+		});
+	}
+	group.wait();
+	ASSERT_EQ(100, _count);
+	pool.shutdown();
+}
+
+TEST_F(ThreadPoolTest, testTaskGroupNested) {
+	// more nested groups than threads - the waiting tasks execute the tasks of their groups
+	core::ThreadPool pool(1);
+	pool.init();
+	core::TaskGroup outer(&pool);
+	for (int i = 0; i < 4; ++i) {
+		outer.run([this, &pool] () {
+			core::TaskGroup inner(&pool);
+			for (int j = 0; j < 10; ++j) {
+				inner.run([this] () {
+					++_count;
+				});
+			}
+			inner.wait();
+		});
+	}
+	outer.wait();
+	ASSERT_EQ(40, _count);
+	pool.shutdown();
+}
+
 }
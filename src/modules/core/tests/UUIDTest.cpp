@@ -0,0 +1,43 @@
+/**
+ * @file
+ */
+
+#include "core/UUID.h"
+#include <gtest/gtest.h>
+
+namespace core {
+
+TEST(UUIDTest, testParse) {
+	const UUID uuid("123e4567-e89b-12d3-a456-426614174000");
+	EXPECT_TRUE(uuid.isValid());
+	EXPECT_EQ(0x123e4567e89b12d3ULL, uuid.data0());
+	EXPECT_EQ(0xa456426614174000ULL, uuid.data1());
+	EXPECT_EQ("123E4567-E89B-12D3-A456-426614174000", uuid.str());
+	EXPECT_EQ(uuid, UUID("123E4567E89B12D3A456426614174000"));
+}
+
+TEST(UUIDTest, testInvalid) {
+	const UUID uuid("");
+	EXPECT_FALSE(uuid.isValid());
+	EXPECT_EQ(UUID(), uuid);
+	EXPECT_EQ("", uuid.str());
+}
+
+TEST(UUIDTest, testNonCanonical) {
+	const UUID uuid("some-id");
+	EXPECT_TRUE(uuid.isValid());
+	EXPECT_EQ(uuid, UUID("some-id"));
+	EXPECT_NE(uuid, UUID("some-other-id"));
+}
+
+TEST(UUIDTest, testGenerate) {
+	const UUID uuid = UUID::generate();
+	EXPECT_TRUE(uuid.isValid());
+	EXPECT_NE(uuid, UUID::generate());
+	const core::String &str = uuid.str();
+	ASSERT_EQ(36u, str.size());
+	EXPECT_EQ('4', str[14]);
+	EXPECT_EQ(uuid, UUID(str));
+}
+
+} // namespace core
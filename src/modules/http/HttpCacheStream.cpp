@@ -4,51 +4,232 @@
 
 #include "HttpCacheStream.h"
 #include "app/App.h"
+#include "core/ConfigVar.h"
 #include "core/Log.h"
+#include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
+#include "core/TimeProvider.h"
+#include "core/Var.h"
 #include "http/Http.h"
+#include "http/Request.h"
 #include "io/Archive.h"
-#include "io/BufferedReadWriteStream.h"
+#include "io/Filesystem.h"
 #include "io/Stream.h"
+#include <inttypes.h>
 
 namespace http {
 
+namespace {
+
+/**
+ * @brief Opens the cache file on the first write - a response without a body (e.g. 304) doesn't touch the cached file
+ */
+class CacheWriteStream : public io::WriteStream {
+private:
+	const io::ArchivePtr &_archive;
+	const core::String &_file;
+	io::SeekableWriteStream *_stream = nullptr;
+	int64_t _written = 0;
+	bool _failed = false;
+
+public:
+	CacheWriteStream(const io::ArchivePtr &archive, const core::String &file) : _archive(archive), _file(file) {
+	}
+
+	virtual ~CacheWriteStream() {
+		close();
+	}
+
+	int write(const void *buf, size_t size) override {
+		if (_stream == nullptr) {
+			if (_failed) {
+				return -1;
+			}
+			_stream = _archive->writeStream(_file);
+			if (_stream == nullptr) {
+				Log::error("Failed to write %s into http cache", _file.c_str());
+				_failed = true;
+				return -1;
+			}
+		}
+		const int written = _stream->write(buf, size);
+		if (written > 0) {
+			_written += written;
+		}
+		return written;
+	}
+
+	void close() override {
+		delete _stream;
+		_stream = nullptr;
+	}
+
+	int64_t written() const {
+		return _written;
+	}
+};
+
+struct CacheMeta {
+	core::String etag;
+	core::String lastModified;
+	uint64_t size = 0u;
+	// the time of the last download or revalidation in millis since the epoch
+	uint64_t time = 0u;
+};
+
+} // namespace
+
+static bool loadMeta(const io::ArchivePtr &archive, const core::String &file, CacheMeta &meta) {
+	const core::String &metaFile = HttpCacheStream::metaFile(file);
+	if (!archive->exists(metaFile)) {
+		return false;
+	}
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(metaFile));
+	if (!stream) {
+		return false;
+	}
+	core::String content;
+	if (!stream->readString((int)stream->size(), content)) {
+		return false;
+	}
+	core::DynamicArray<core::String> lines;
+	core::string::splitString(content, lines, "\n");
+	for (const core::String &line : lines) {
+		const size_t pos = line.find_first_of(':');
+		if (pos == core::String::npos) {
+			continue;
+		}
+		const core::String &key = line.substr(0, pos).trim();
+		const core::String &value = line.substr(pos + 1).trim();
+		if (key == "etag") {
+			meta.etag = value;
+		} else if (key == "last-modified") {
+			meta.lastModified = value;
+		} else if (key == "size") {
+			meta.size = (uint64_t)core::string::toLong(value);
+		} else if (key == "time") {
+			meta.time = (uint64_t)core::string::toLong(value);
+		}
+	}
+	return true;
+}
+
+static bool saveMeta(const io::ArchivePtr &archive, const core::String &file, const CacheMeta &meta) {
+	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(HttpCacheStream::metaFile(file)));
+	if (!stream) {
+		return false;
+	}
+	return stream->writeStringFormat(false, "etag: %s\nlast-modified: %s\nsize: %" PRIu64 "\ntime: %" PRIu64 "\n",
+									 meta.etag.c_str(), meta.lastModified.c_str(), meta.size, meta.time);
+}
+
+/**
+ * @brief The header names are case insensitive - and http/2 sends them in lower case
+ */
+static core::String findHeader(const core::StringMap<core::String> &headers, const char *name) {
+	for (const auto &e : headers) {
+		if (core::string::iequals(e->first, name)) {
+			return e->second;
+		}
+	}
+	return "";
+}
+
+static bool fetch(const io::ArchivePtr &archive, const core::String &file, const core::String &url,
+				  const CacheMeta *validators, int &statusCode, core::StringMap<core::String> &outheaders,
+				  int64_t &written) {
+	Request request(url, RequestType::GET);
+	request.noCache();
+	if (validators != nullptr) {
+		if (!validators->etag.empty()) {
+			request.addHeader("If-None-Match", validators->etag);
+		}
+		if (!validators->lastModified.empty()) {
+			request.addHeader("If-Modified-Since", validators->lastModified);
+		}
+	}
+	CacheWriteStream stream(archive, file);
+	const bool success = request.execute(stream, &statusCode, &outheaders);
+	written = stream.written();
+	return success;
+}
+
+core::String HttpCacheStream::metaFile(const core::String &file) {
+	return file + ".meta";
+}
+
 HttpCacheStream::HttpCacheStream(const io::ArchivePtr &archive, const core::String &file, const core::String &url) {
 	if (core::string::startsWith(url, "file://")) {
 		_readStream = archive->readStream(url.substr(7));
 		return;
 	}
-	if (archive->exists(file)) {
-		Log::debug("Use cached file at %s for %s", file.c_str(), url.c_str());
+	const uint64_t now = core::TimeProvider::epochMillis();
+	CacheMeta meta;
+	const bool cached = archive->exists(file);
+	const bool hasMeta = cached && loadMeta(archive, file, meta);
+	bool revalidate = false;
+	if (cached) {
 		_readStream = archive->readStream(file);
 		core_assert(_readStream != nullptr);
-		return;
+		// an interrupted download leaves an incomplete file behind
+		const bool complete = !hasMeta || (_readStream != nullptr && _readStream->size() == (int64_t)meta.size);
+		const long maxAgeSeconds = core::Var::get(cfg::HttpCacheMaxAge, "86400")->longVal();
+		const bool fresh = maxAgeSeconds < 0 || (hasMeta && now < meta.time + (uint64_t)maxAgeSeconds * 1000u);
+		if (complete && fresh) {
+			Log::debug("Use cached file at %s for %s", file.c_str(), url.c_str());
+			if (hasMeta) {
+				// the modification time of the meta file is the last access for the lru eviction
+				saveMeta(archive, file, meta);
+			}
+			return;
+		}
+		close();
+		if (!complete) {
+			Log::debug("Cached file %s is incomplete", file.c_str());
+		}
+		// without validators the file is downloaded again
+		revalidate = complete && hasMeta && (!meta.etag.empty() || !meta.lastModified.empty());
 	}
 	Log::debug("try to download %s from %s", file.c_str(), url.c_str());
-	io::BufferedReadWriteStream bufStream(1024 * 1024);
 	int statusCode = 0;
+	int64_t written = 0;
 	core::StringMap<core::String> outheaders;
-	if (http::download(url, bufStream, &statusCode, &outheaders)) {
-		// TODO: HTTP: handle these headers https://www.ietf.org/archive/id/draft-polli-ratelimit-headers-02.html
-		// x-ratelimit-remaining "<number>"
-		// x-ratelimit-limit "<number>"
-		// x-ratelimit-used "<number>"
-		// x-ratelimit-reset "<timestamp utc>"
-		if (http::isValidStatusCode(statusCode)) {
-			write(archive, file, bufStream);
-		} else if (statusCode == 429) {
-			Log::warn("Too many requests, retrying in 5 seconds... %s (%s)", url.c_str(), file.c_str());
-			app::App::getInstance()->wait(5000);
-			if (http::download(url, bufStream, &statusCode)) {
-				if (http::isValidStatusCode(statusCode)) {
-					write(archive, file, bufStream);
-				}
-			}
-		} else {
-			Log::warn("Failed to download %s (%s)", url.c_str(), file.c_str());
+	bool success = fetch(archive, file, url, revalidate ? &meta : nullptr, statusCode, outheaders, written);
+	// TODO: HTTP: handle these headers https://www.ietf.org/archive/id/draft-polli-ratelimit-headers-02.html
+	// x-ratelimit-remaining "<number>"
+	// x-ratelimit-limit "<number>"
+	// x-ratelimit-used "<number>"
+	// x-ratelimit-reset "<timestamp utc>"
+	if (success && statusCode == 429) {
+		Log::warn("Too many requests, retrying in 5 seconds... %s (%s)", url.c_str(), file.c_str());
+		app::App::getInstance()->wait(5000);
+		outheaders.clear();
+		success = fetch(archive, file, url, revalidate ? &meta : nullptr, statusCode, outheaders, written);
+	}
+	if (success && statusCode == 304 && revalidate && written == 0) {
+		Log::debug("Cached file at %s for %s is still valid", file.c_str(), url.c_str());
+		meta.time = now;
+		saveMeta(archive, file, meta);
+		_readStream = archive->readStream(file);
+		return;
+	}
+	if (success && http::isValidStatusCode(statusCode)) {
+		meta.etag = findHeader(outheaders, "etag");
+		meta.lastModified = findHeader(outheaders, "last-modified");
+		meta.size = (uint64_t)written;
+		meta.time = now;
+		if (!saveMeta(archive, file, meta)) {
+			Log::warn("Failed to write the http cache meta data for %s", file.c_str());
 		}
-	} else {
-		Log::warn("Failed to download %s (%s)", url.c_str(), file.c_str());
+		_readStream = archive->readStream(file);
+		_newInCache = _readStream != nullptr;
+		Log::debug("Wrote %s to http cache", file.c_str());
+		return;
+	}
+	Log::warn("Failed to download %s (%s)", url.c_str(), file.c_str());
+	if (cached && written == 0) {
+		// e.g. we are offline - the cached file wasn't touched
+		_readStream = archive->readStream(file);
 	}
 }
 
@@ -71,18 +252,54 @@ void HttpCacheStream::close() {
 	_readStream = nullptr;
 }
 
-void HttpCacheStream::write(const io::ArchivePtr &archive, const core::String &file,
-							io::BufferedReadWriteStream &bufStream) {
-	bufStream.seek(0);
-	if (io::SeekableWriteStream *ws = archive->writeStream(file)) {
-		ws->write(bufStream.getBuffer(), bufStream.size());
-		delete ws;
-		_readStream = archive->readStream(file);
-		_newInCache = true;
-		Log::debug("Wrote %s to http cache", file.c_str());
-	} else {
-		Log::error("Failed to write %s into http cache", file.c_str());
+uint64_t HttpCacheStream::evict(const io::FilesystemPtr &filesystem, const core::String &directory, uint64_t maxBytes) {
+	core::DynamicArray<io::FilesystemEntry> entities;
+	filesystem->list(directory, entities, "", 16);
+	core::StringMap<uint64_t, 4096> sizes;
+	for (const io::FilesystemEntry &entity : entities) {
+		if (entity.isFile()) {
+			sizes.put(entity.fullPath, entity.size);
+		}
+	}
+	struct CacheEntry {
+		core::String file;
+		core::String metaFile;
+		uint64_t size;
+		uint64_t lastAccess;
+	};
+	core::DynamicArray<CacheEntry> cacheEntries;
+	uint64_t total = 0u;
+	for (const io::FilesystemEntry &entity : entities) {
+		if (!entity.isFile() || !core::string::endsWith(entity.fullPath, ".meta")) {
+			continue;
+		}
+		const core::String &file = entity.fullPath.substr(0, entity.fullPath.size() - 5);
+		uint64_t size = 0u;
+		if (!sizes.get(file, size)) {
+			continue;
+		}
+		cacheEntries.push_back(CacheEntry{file, entity.fullPath, size + entity.size, entity.mtime});
+		total += size + entity.size;
+	}
+	if (total <= maxBytes) {
+		return total;
+	}
+	cacheEntries.sort([](const CacheEntry &a, const CacheEntry &b) { return a.lastAccess < b.lastAccess; });
+	int removed = 0;
+	for (const CacheEntry &entry : cacheEntries) {
+		if (total <= maxBytes) {
+			break;
+		}
+		// remove the meta file first - a cache file without meta file is downloaded again
+		if (!io::Filesystem::sysRemoveFile(entry.metaFile)) {
+			continue;
+		}
+		io::Filesystem::sysRemoveFile(entry.file);
+		total -= entry.size;
+		++removed;
 	}
+	Log::info("Removed %i files from the http cache in %s", removed, directory.c_str());
+	return total;
 }
 
 bool HttpCacheStream::valid() const {
@@ -9,16 +9,21 @@
 
 namespace io {
 class FileStream;
-class BufferedReadWriteStream;
 class Archive;
 typedef core::SharedPtr<Archive> ArchivePtr;
+class Filesystem;
+typedef core::SharedPtr<Filesystem> FilesystemPtr;
 } // namespace io
 
 namespace http {
 
 /**
  * @brief Download from the given url and store it in the given file. If the file already exists, it will not get
- * downloaded again.
+ * downloaded again - until it is older than @c http_cachemaxage seconds. Then it is revalidated with a conditional
+ * request (@c If-None-Match and @c If-Modified-Since) and only downloaded again if the server has a newer version.
+ *
+ * The response body is written straight into the cache file. The validators of the response are stored in a
+ * @c .meta file next to the cached file.
  *
  * @ingroup IO
  */
@@ -26,7 +31,6 @@ class HttpCacheStream : public io::SeekableReadStream {
 private:
 	io::SeekableReadStream *_readStream = nullptr;
 	bool _newInCache = false;
-	void write(const io::ArchivePtr &archive, const core::String &file, io::BufferedReadWriteStream &bufStream);
 
 public:
 	/**
@@ -45,6 +49,17 @@ public:
 	bool isNewInCache() const;
 
 	static core::String string(const io::ArchivePtr &archive, const core::String &file, const core::String &url);
+	/**
+	 * @return The name of the file that stores the validators of the given cache file
+	 */
+	static core::String metaFile(const core::String &file);
+	/**
+	 * @brief Removes the least recently used cache files below the given directory until all cache files together
+	 * use less than @c maxBytes
+	 * @note Only files with a @c .meta file are cache files
+	 * @return The amount of bytes that the remaining cache files use
+	 */
+	static uint64_t evict(const io::FilesystemPtr &filesystem, const core::String &directory, uint64_t maxBytes);
 };
 
 inline bool HttpCacheStream::isNewInCache() const {
@@ -37,9 +37,38 @@ static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *use
 	return ((io::WriteStream *)userp)->write(contents, size * nmemb);
 }
 
+namespace {
+
+/**
+ * @brief curl keeps the connections of an easy handle alive. Each thread keeps its handle to reuse the connections
+ * for the following requests to the same host.
+ */
+struct CurlHandle {
+	CURL *curl = nullptr;
+
+	~CurlHandle() {
+		if (curl != nullptr) {
+			curl_easy_cleanup(curl);
+		}
+	}
+
+	CURL *get() {
+		if (curl == nullptr) {
+			curl = curl_easy_init();
+		} else {
+			// resets the options - but keeps the connection cache
+			curl_easy_reset(curl);
+		}
+		return curl;
+	}
+};
+
+} // namespace
+
 bool http_request(io::WriteStream &stream, int *statusCode, core::StringMap<core::String> *outheaders,
 				  RequestContext &ctx) {
-	CURL *curl = curl_easy_init();
+	static thread_local CurlHandle handle;
+	CURL *curl = handle.get();
 	if (curl == nullptr) {
 		return false;
 	}
@@ -60,6 +89,10 @@ bool http_request(io::WriteStream &stream, int *statusCode, core::StringMap<core
 	curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
 	curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
 	curl_easy_setopt(curl, CURLOPT_DEFAULT_PROTOCOL, "https");
+#ifdef CURL_HTTP_VERSION_2TLS
+	// use http/2 for https if the server supports it
+	curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+#endif
 	if (outheaders) {
 		curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, WriteHeaderData);
 		curl_easy_setopt(curl, CURLOPT_HEADERDATA, outheaders);
@@ -87,7 +120,6 @@ bool http_request(io::WriteStream &stream, int *statusCode, core::StringMap<core
 		*statusCode = (int)statusCodeCurl;
 	}
 	curl_slist_free_all(headers);
-	curl_easy_cleanup(curl);
 	return res == CURLE_OK;
 }
 
@@ -40,24 +40,29 @@ static std::string ws2s(const std::wstring &wstr) {
 	return strTo;
 }
 
+// WinHTTP keeps the connections of a session alive - the session is shared by all requests to reuse them
+static HINTERNET sharedSession() {
+	static HINTERNET hSession = []() {
+		HINTERNET session =
+			WinHttpOpen(nullptr, WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+		if (session == nullptr) {
+			printLastError("Failed to create session for http download");
+			return session;
+		}
+#ifdef WINHTTP_OPTION_ENABLE_HTTP_PROTOCOL
+		// use http/2 if the server supports it
+		DWORD protocols = WINHTTP_PROTOCOL_FLAG_HTTP2;
+		WinHttpSetOption(session, WINHTTP_OPTION_ENABLE_HTTP_PROTOCOL, &protocols, sizeof(protocols));
+#endif
+		return session;
+	}();
+	return hSession;
+}
+
 bool http_request(io::WriteStream &stream, int *statusCode, core::StringMap<core::String> *outheaders,
 				  RequestContext &ctx) {
-	// Initialize WinHTTP and create a session
-	HINTERNET hSession =
-		WinHttpOpen(nullptr, WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+	HINTERNET hSession = sharedSession();
 	if (hSession == nullptr) {
-		printLastError("Failed to create session for http download");
-		return false;
-	}
-
-	// Set the connection timeout
-	DWORD dwResolveTimeout = ctx._timeoutSecond * 1000;
-	DWORD dwConnectTimeout = ctx._connectTimeoutSecond * 1000;
-	DWORD dwSendTimeout = dwResolveTimeout;
-	DWORD dwReceiveTimeout = dwResolveTimeout;
-	if (!WinHttpSetTimeouts(hSession, dwResolveTimeout, dwConnectTimeout, dwSendTimeout, dwReceiveTimeout)) {
-		printLastError("Failed to set http timeouts");
-		WinHttpCloseHandle(hSession);
 		return false;
 	}
 
@@ -78,7 +83,6 @@ bool http_request(io::WriteStream &stream, int *statusCode, core::StringMap<core
 	url_components.nPort = INTERNET_DEFAULT_HTTP_PORT;
 	if (!WinHttpCrackUrl(urlw.c_str(), 0, 0, &url_components)) {
 		printLastError("Failed to parse url");
-		WinHttpCloseHandle(hSession);
 		return false;
 	}
 
@@ -86,7 +90,6 @@ bool http_request(io::WriteStream &stream, int *statusCode, core::StringMap<core
 	HINTERNET hConnection = WinHttpConnect(hSession, url_components.lpszHostName, url_components.nPort, 0);
 	if (hConnection == nullptr) {
 		printLastError("Failed to connect");
-		WinHttpCloseHandle(hSession);
 		return false;
 	}
 
@@ -96,7 +99,18 @@ bool http_request(io::WriteStream &stream, int *statusCode, core::StringMap<core
 											url_components.nScheme == INTERNET_SCHEME_HTTPS ? WINHTTP_FLAG_SECURE : 0);
 	if (hRequest == nullptr) {
 		printLastError("Failed to create request");
-		WinHttpCloseHandle(hSession);
+		WinHttpCloseHandle(hConnection);
+		return false;
+	}
+
+	// Set the connection timeout
+	DWORD dwResolveTimeout = ctx._timeoutSecond * 1000;
+	DWORD dwConnectTimeout = ctx._connectTimeoutSecond * 1000;
+	DWORD dwSendTimeout = dwResolveTimeout;
+	DWORD dwReceiveTimeout = dwResolveTimeout;
+	if (!WinHttpSetTimeouts(hRequest, dwResolveTimeout, dwConnectTimeout, dwSendTimeout, dwReceiveTimeout)) {
+		printLastError("Failed to set http timeouts");
+		WinHttpCloseHandle(hRequest);
 		WinHttpCloseHandle(hConnection);
 		return false;
 	}
@@ -212,7 +226,6 @@ bool http_request(io::WriteStream &stream, int *statusCode, core::StringMap<core
 		stream.write(buffer, bytesRead);
 	}
 	WinHttpCloseHandle(hRequest);
-	WinHttpCloseHandle(hSession);
 	WinHttpCloseHandle(hConnection);
 	return true;
 }
@@ -6,6 +6,7 @@
 #include "app/App.h"
 #include "app/tests/AbstractTest.h"
 #include "http/Request.h"
+#include "io/Filesystem.h"
 #include "io/FilesystemArchive.h"
 #include <gtest/gtest.h>
 
@@ -40,4 +41,30 @@ TEST_F(HttpCacheStreamTest, DISABLED_testGetRequest) {
 	}
 }
 
+TEST_F(HttpCacheStreamTest, testEvict) {
+	const io::FilesystemPtr &filesystem = _testApp->filesystem();
+	const core::String dir = filesystem->homeWritePath("httpcacheevicttest");
+	ASSERT_TRUE(io::Filesystem::sysCreateDir(dir + "/sub"));
+	const core::String cached1 = dir + "/file1.json";
+	const core::String cached2 = dir + "/sub/file2.json";
+	const core::String uncached = dir + "/file3.json";
+	for (const core::String &file : {cached1, cached2, uncached}) {
+		ASSERT_TRUE(io::Filesystem::sysWrite(file, "0123456789"));
+	}
+	ASSERT_TRUE(io::Filesystem::sysWrite(HttpCacheStream::metaFile(cached1), "size: 10\n"));
+	ASSERT_TRUE(io::Filesystem::sysWrite(HttpCacheStream::metaFile(cached2), "size: 10\n"));
+
+	// only the files with meta data are part of the cache
+	EXPECT_EQ(38u, HttpCacheStream::evict(filesystem, dir, 1024u));
+	EXPECT_TRUE(io::Filesystem::sysExists(cached1));
+	EXPECT_TRUE(io::Filesystem::sysExists(cached2));
+
+	EXPECT_EQ(0u, HttpCacheStream::evict(filesystem, dir, 0u));
+	EXPECT_FALSE(io::Filesystem::sysExists(cached1));
+	EXPECT_FALSE(io::Filesystem::sysExists(HttpCacheStream::metaFile(cached1)));
+	EXPECT_FALSE(io::Filesystem::sysExists(cached2));
+	EXPECT_TRUE(io::Filesystem::sysExists(uncached));
+	EXPECT_TRUE(io::Filesystem::sysRemoveDir(dir, true));
+}
+
 } // namespace http
@@ -61,4 +61,30 @@ TEST_F(RequestTest, DISABLED_testPostRequest) {
 	EXPECT_EQ("2", jsonResponse["headers"]["Content-Length"].get<std::string>()) << response;
 }
 
+// disabled because it requires network access
+TEST_F(RequestTest, DISABLED_testReuseConnection) {
+	if (!Request::supported()) {
+		GTEST_SKIP() << "No http support available";
+	}
+	{
+		io::BufferedReadWriteStream stream;
+		Request request("https://httpbin.org/post", http::RequestType::POST);
+		request.addHeader("Content-Type", "application/json");
+		request.setBody("{}");
+		ASSERT_TRUE(request.execute(stream));
+	}
+	// the connection is reused - but nothing of the previous request must leak into this one
+	io::BufferedReadWriteStream stream;
+	Request request("https://httpbin.org/get", http::RequestType::GET);
+	int statusCode = 0;
+	ASSERT_TRUE(request.execute(stream, &statusCode));
+	EXPECT_EQ(200, statusCode);
+	stream.seek(0);
+	core::String response;
+	stream.readString((int)stream.size(), response);
+	nlohmann::json jsonResponse = nlohmann::json::parse(response, nullptr, false, true);
+	ASSERT_TRUE(jsonResponse.contains("headers")) << response;
+	ASSERT_FALSE(jsonResponse["headers"].contains("Content-Type")) << response;
+}
+
 } // namespace http
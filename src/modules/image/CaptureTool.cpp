@@ -4,10 +4,11 @@
 
 #include "CaptureTool.h"
 #include "app/App.h"
-#include "app/Async.h"
+#include "core/Common.h"
 #include "core/ConfigVar.h"
 #include "core/Log.h"
 #include "core/Var.h"
+#include "core/concurrent/Concurrency.h"
 #include "external/jo_mpeg.h"
 #include "io/Filesystem.h"
 
@@ -23,36 +24,75 @@ bool CaptureTool::isRecording() const {
 	return true;
 }
 
-void CaptureTool::enqueueFrame(const image::ImagePtr &image) {
+bool CaptureTool::enqueueFrame(const image::ImagePtr &image) {
 	if (!image || !image->isLoaded()) {
-		return;
+		return false;
+	}
+	if (!isRecording()) {
+		return false;
+	}
+	if (_pendingFrames >= MaxPendingFrames) {
+		Log::debug("Drop frame - the encoders can't keep up");
+		return false;
 	}
-	_frameQueue.push(image);
+	_pendingFrames.increment();
+	std::future<EncodedFrame> frame = _encoderPool->enqueue([this, image]() { return encodeFrame(image); });
+	_frameQueue.push(frame.share());
+	return true;
 }
 
 uint32_t CaptureTool::pendingFrames() const {
 	if (_videoWriteStream == nullptr) {
 		return 0u;
 	}
-	return _frameQueue.size();
+	return (uint32_t)(int)_pendingFrames;
+}
+
+CaptureTool::EncodedFrame CaptureTool::encodeFrame(const image::ImagePtr &image) const {
+	const EncodedFrame &encoded = core::make_shared<io::BufferedReadWriteStream>(image->width() * image->height());
+	if (_type == CaptureType::AVI) {
+		// same quality as AVI::writeFrame()
+		if (!image::Image::writeJPEG(*encoded.get(), image->data(), image->width(), image->height(), 4, 90)) {
+			return EncodedFrame();
+		}
+	} else if (!jo_write_mpeg(*encoded.get(), image->data(), image->width(), image->height(), _fps)) {
+		return EncodedFrame();
+	}
+	return encoded;
 }
 
-int CaptureTool::encodeFrame(CaptureTool *inst) {
+int CaptureTool::writeFrames(CaptureTool *inst) {
 	core::SharedPtr<io::FileStream> s = inst->_videoWriteStream;
-	while (!inst->_stop) {
-		image::ImagePtr image;
-		while (inst->_frameQueue.pop(image)) {
-			if (inst->_type == CaptureType::AVI) {
-				inst->_avi.writeFrame(*s.get(), image->data(), image->width(), image->height());
-			} else {
-				jo_write_mpeg(*s.get(), image->data(), image->width(), image->height(), inst->_fps);
+	std::shared_future<EncodedFrame> frame;
+	for (;;) {
+		if (!inst->_frameQueue.waitAndPop(frame)) {
+			// stopRecording() aborts the wait - the frames that are still queued are written
+			if (!inst->_frameQueue.pop(frame)) {
+				if (inst->_stop) {
+					break;
+				}
+				continue;
 			}
 		}
+		const EncodedFrame &encoded = frame.get();
+		if (!encoded) {
+			Log::warn("Failed to encode frame");
+		} else if (inst->_type == CaptureType::AVI) {
+			if (!inst->_avi.writeJPEGFrame(*s.get(), encoded->getBuffer(), (size_t)encoded->size())) {
+				Log::warn("Failed to write frame");
+			}
+		} else if (s->write(encoded->getBuffer(), (size_t)encoded->size()) != (int)encoded->size()) {
+			Log::warn("Failed to write frame");
+		}
+		inst->_pendingFrames.decrement();
 	}
+	inst->_written = true;
 	return 0;
 }
 
 bool CaptureTool::startRecording(const char *filename, int width, int height) {
+	// finish a previous recording that wasn't flushed yet
+	flush();
 	_videoWriteStream = core::make_shared<io::FileStream>(io::filesystem()->open(filename, io::FileMode::SysWrite));
 	if (!_videoWriteStream->valid()) {
 		Log::error("Failed to open filestream for %s", filename);
@@ -68,8 +108,18 @@ bool CaptureTool::startRecording(const char *filename, int width, int height) {
 			return false;
 		}
 	}
-	Log::debug("Starting avirecorder thread");
-	app::async(encodeFrame, this);
+	_stop = false;
+	_written = false;
+	_pendingFrames = 0;
+	_frameQueue.clear();
+	_frameQueue.reset();
+	// one thread writes the frames in order, the others encode them
+	const size_t encoders = core_max(1u, core::halfcpus());
+	// the encoding runs in the background of the rendering
+	_encoderPool = core::make_shared<core::ThreadPool>(encoders + 1, "CaptureTool", core::ThreadPriority::Low);
+	_encoderPool->init();
+	Log::debug("Starting video recorder with %i encoder threads", (int)encoders);
+	_encoderPool->enqueue(writeFrames, this);
 	return true;
 }
 
@@ -78,23 +128,36 @@ bool CaptureTool::stopRecording() {
 		return false;
 	}
 	_stop = true;
+	_frameQueue.abortWait();
 	return true;
 }
 
 bool CaptureTool::hasFinished() const {
-	if (!isRecording()) {
+	if (_videoWriteStream == nullptr) {
 		return false;
 	}
 	if (!_stop) {
 		return false;
 	}
-	return _frameQueue.empty();
+	return _written;
+}
+
+void CaptureTool::shutdownEncoders() {
+	if (!_encoderPool) {
+		return;
+	}
+	_stop = true;
+	_frameQueue.abortWait();
+	// the writer only finishes after all queued frames were encoded and written
+	_encoderPool->shutdown(true);
+	_encoderPool = nullptr;
 }
 
 bool CaptureTool::flush() {
-	if (!isRecording()) {
+	if (_videoWriteStream == nullptr) {
 		return true;
 	}
+	shutdownEncoders();
 	bool closed;
 	if (_type == CaptureType::AVI)
 		closed = _avi.close(*_videoWriteStream.get());
@@ -4,24 +4,42 @@
 
 #include "core/collection/ConcurrentQueue.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
 #include "image/AVI.h"
 #include "image/Image.h"
+#include "io/BufferedReadWriteStream.h"
 #include "io/FileStream.h"
+#include <future>
 
 namespace image {
 
 enum class CaptureType { AVI, MPEG2, Max };
 
+/**
+ * @brief Records the enqueued frames into a video file
+ *
+ * The frames are encoded in parallel on an own thread pool - one thread of the pool writes the encoded frames in the
+ * order they were enqueued.
+ */
 class CaptureTool {
 private:
+	using EncodedFrame = core::SharedPtr<io::BufferedReadWriteStream>;
+	/** frames that were enqueued but are not yet written - further frames are dropped to not let the memory grow */
+	static constexpr int MaxPendingFrames = 64;
+
 	CaptureType _type;
 	int _fps = 30;
 	image::AVI _avi{};
 	core::SharedPtr<io::FileStream> _videoWriteStream = nullptr;
-	core::ConcurrentQueue<image::ImagePtr> _frameQueue;
+	core::SharedPtr<core::ThreadPool> _encoderPool;
+	core::ConcurrentQueue<std::shared_future<EncodedFrame>> _frameQueue;
+	core::AtomicInt _pendingFrames = 0;
 	core::AtomicBool _stop = false;
+	core::AtomicBool _written = false;
 
-	static int encodeFrame(CaptureTool *data);
+	EncodedFrame encodeFrame(const image::ImagePtr &image) const;
+	static int writeFrames(CaptureTool *inst);
+	void shutdownEncoders();
 
 public:
 	CaptureTool(CaptureType type = CaptureType::AVI) : _type(type) {
@@ -36,7 +54,11 @@ public:
 
 	bool isRecording() const;
 	bool startRecording(const char *filename, int width, int height);
-	void enqueueFrame(const image::ImagePtr &image);
+	/**
+	 * @return @c false if the frame was dropped - either because there is no recording or because the encoders can't
+	 * keep up
+	 */
+	bool enqueueFrame(const image::ImagePtr &image);
 	/**
 	 * @brief Returns @c true if all queued frames were encoded and are part of the avi
 	 * @note stopRecording() must have been called before!
@@ -45,7 +67,7 @@ public:
 
 	uint32_t pendingFrames() const;
 	/**
-	 * @brief Stop the jpeg encoding thread and prepare the avi stream to be closed.
+	 * @brief Stop the recording - the frames that are already enqueued are still encoded and written
 	 */
 	bool stopRecording();
 	/**
@@ -10,6 +10,8 @@
 #include "core/StandardLib.h"
 #include "core/StringUtil.h"
 #include "core/collection/BufferView.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Parallel.h"
 #include "io/Base64.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/FileStream.h"
@@ -17,6 +19,8 @@
 #include "io/FormatDescription.h"
 #include "io/MemoryReadStream.h"
 #include "io/Stream.h"
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#include "io/external/miniz.h"
 #include <stb_image_resize2.h>
 
 #include <glm/common.hpp>
@@ -33,6 +37,41 @@
 #define STBIW_REALLOC core_realloc
 #define STBIW_FREE core_free
 
+namespace image {
+namespace priv {
+
+/** the zlib level of the png writes of the current thread - see @c PngCompression */
+static thread_local int s_pngCompressionLevel = MZ_DEFAULT_LEVEL;
+
+static int pngCompressionLevel(PngCompression compression) {
+	if (compression == PngCompression::Fast) {
+		return MZ_BEST_SPEED;
+	}
+	return MZ_DEFAULT_LEVEL;
+}
+
+/**
+ * The deflate of miniz is faster and compresses better than the builtin one of stb_image_write. The level is taken
+ * from the calling thread instead of the global @c stbi_write_png_compression_level to allow parallel writes with
+ * different levels.
+ */
+static unsigned char *zlibCompress(unsigned char *data, int dataLen, int *outLen, int quality) {
+	(void)quality;
+	mz_ulong len = mz_compressBound((mz_ulong)dataLen);
+	unsigned char *out = (unsigned char *)core_malloc(len);
+	if (mz_compress2(out, &len, data, (mz_ulong)dataLen, s_pngCompressionLevel) != MZ_OK) {
+		core_free(out);
+		return nullptr;
+	}
+	*outLen = (int)len;
+	return out;
+}
+
+} // namespace priv
+} // namespace image
+
+#define STBIW_ZLIB_COMPRESS image::priv::zlibCompress
+
 #ifdef USE_LIBJPEG
 #include <jpeglib.h>
 #endif
@@ -124,17 +163,17 @@ core::RGBA Image::colorAt(const glm::vec2 &uv, TextureWrap wrapS, TextureWrap wr
 	return colorAt(pc.x, pc.y);
 }
 
-bool writeImage(const image::Image &image, io::SeekableWriteStream &stream) {
+bool writeImage(const image::Image &image, io::SeekableWriteStream &stream, PngCompression compression) {
 	if (!image.isLoaded()) {
 		return false;
 	}
-	return image.writePng(stream);
+	return image.writePng(stream, compression);
 }
 
-bool writeImage(const image::ImagePtr &image, io::SeekableWriteStream &stream) {
+bool writeImage(const image::ImagePtr &image, io::SeekableWriteStream &stream, PngCompression compression) {
 	if (!image)
 		return false;
-	return writeImage(*image.get(), stream);
+	return writeImage(*image.get(), stream, compression);
 }
 
 bool writeImage(const image::Image &image, const core::String &filename) {
@@ -161,6 +200,19 @@ bool writeImage(const image::ImagePtr &image, const core::String &filename) {
 	return writeImage(*image.get(), filename);
 }
 
+bool writeImages(const core::DynamicArray<ImagePtr> &images, const core::DynamicArray<core::String> &filenames,
+				 core::ThreadPool *threadPool) {
+	core_assert(images.size() == filenames.size());
+	core::AtomicBool success(true);
+	core::parallelSlices(threadPool, (int)images.size(), [&](int i) {
+		if (!writeImage(images[i], filenames[i])) {
+			Log::warn("Failed to write image %s", filenames[i].c_str());
+			success = false;
+		}
+	});
+	return success;
+}
+
 ImagePtr loadImage(const io::FilePtr &file) {
 	const ImagePtr &i = createEmptyImage(file->name());
 	if (!i->load(file)) {
@@ -221,6 +273,14 @@ ImagePtr loadImage(const core::String &filename) {
 	return loadImage(file);
 }
 
+core::DynamicArray<ImagePtr> loadImages(const core::DynamicArray<core::String> &filenames,
+										core::ThreadPool *threadPool) {
+	core::DynamicArray<ImagePtr> images;
+	images.resize(filenames.size());
+	core::parallelSlices(threadPool, (int)filenames.size(), [&](int i) { images[i] = loadImage(filenames[i]); });
+	return images;
+}
+
 bool Image::load(const uint8_t *buffer, int length) {
 	io::MemoryReadStream stream(buffer, length);
 	return load(stream, length);
@@ -442,7 +502,8 @@ bool Image::resize(int w, int h) {
 	return true;
 }
 
-uint8_t *createPng(const void *pixels, int width, int height, int depth, int *pngSize) {
+uint8_t *createPng(const void *pixels, int width, int height, int depth, int *pngSize, PngCompression compression) {
+	priv::s_pngCompressionLevel = priv::pngCompressionLevel(compression);
 	return (uint8_t *)stbi_write_png_to_mem((const unsigned char *)pixels, 0, width, height, depth, pngSize);
 }
 
@@ -454,8 +515,8 @@ static void stream_write_func(void *context, void *data, int size) {
 	}
 }
 
-bool Image::writePng(io::SeekableWriteStream &stream) const {
-	return writePng(stream, _data, _width, _height, _depthOfColor);
+bool Image::writePng(io::SeekableWriteStream &stream, PngCompression compression) const {
+	return writePng(stream, _data, _width, _height, _depthOfColor, compression);
 }
 
 bool Image::writeJPEG(io::SeekableWriteStream &stream, int quality) const {
@@ -510,7 +571,9 @@ bool Image::writeJPEG(io::SeekableWriteStream &stream, const uint8_t *buffer, in
 #endif
 }
 
-bool Image::writePng(io::SeekableWriteStream &stream, const uint8_t *buffer, int width, int height, int depth) {
+bool Image::writePng(io::SeekableWriteStream &stream, const uint8_t *buffer, int width, int height, int depth,
+					 PngCompression compression) {
+	priv::s_pngCompressionLevel = priv::pngCompressionLevel(compression);
 	return stbi_write_png_to_func(stream_write_func, &stream, width, height, depth, (const void *)buffer,
 								  width * depth) != 0;
 }
@@ -9,10 +9,15 @@
 #include "io/IOResource.h"
 #include "io/File.h"
 #include "core/SharedPtr.h"
+#include "core/collection/DynamicArray.h"
 #include "io/Stream.h"
 #include <glm/fwd.hpp>
 #include <glm/vec2.hpp>
 
+namespace core {
+class ThreadPool;
+}
+
 namespace image {
 
 // https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glTexParameter.xhtml
@@ -28,6 +33,15 @@ enum TextureWrap : uint8_t {
 	Max
 };
 
+/**
+ * @brief The zlib compression level of png images
+ */
+enum class PngCompression : uint8_t {
+	/** best speed - for thumbnails and cache files that are written often */
+	Fast,
+	Default
+};
+
 /**
  * @brief Wrapper for image loading
  */
@@ -83,8 +97,9 @@ public:
 	bool resize(int w, int h);
 
 	static void flipVerticalRGBA(uint8_t *pixels, int w, int h);
-	bool writePng(io::SeekableWriteStream &stream) const;
-	static bool writePng(io::SeekableWriteStream &stream, const uint8_t* buffer, int width, int height, int depth);
+	bool writePng(io::SeekableWriteStream &stream, PngCompression compression = PngCompression::Default) const;
+	static bool writePng(io::SeekableWriteStream &stream, const uint8_t *buffer, int width, int height, int depth,
+						 PngCompression compression = PngCompression::Default);
 	/**
 	 * @param[in] quality Ranges from 1 to 100 where higher is better
 	 */
@@ -141,7 +156,8 @@ inline ImagePtr createEmptyImage(const core::String& name) {
 	return core::make_shared<Image>(name);
 }
 
-uint8_t* createPng(const void *pixels, int width, int height, int depth, int *pngSize);
+uint8_t *createPng(const void *pixels, int width, int height, int depth, int *pngSize,
+				   PngCompression compression = PngCompression::Default);
 ImagePtr loadImage(const io::FilePtr& file);
 ImagePtr loadImage(const core::String &name, io::SeekableReadStream &stream, int length = -1);
 ImagePtr loadImage(const core::String &name, io::ReadStream &stream, int length);
@@ -151,11 +167,26 @@ ImagePtr loadRGBAImageFromStream(const core::String &name, io::ReadStream &strea
  * @brief If there is no extension given, all supported extensions are tried
  */
 ImagePtr loadImage(const core::String& filename);
+/**
+ * @brief Decodes the given image files in parallel on the thread pool
+ * @return The images in the same order as the given filenames - an image that failed to load is not
+ * @c Image::isLoaded()
+ */
+core::DynamicArray<ImagePtr> loadImages(const core::DynamicArray<core::String> &filenames,
+										core::ThreadPool *threadPool = nullptr);
 
-bool writeImage(const image::Image &image, io::SeekableWriteStream& stream);
-bool writeImage(const image::ImagePtr &image, io::SeekableWriteStream& stream);
+bool writeImage(const image::Image &image, io::SeekableWriteStream &stream,
+				PngCompression compression = PngCompression::Default);
+bool writeImage(const image::ImagePtr &image, io::SeekableWriteStream &stream,
+				PngCompression compression = PngCompression::Default);
 bool writeImage(const image::Image &image, const core::String& filename);
 bool writeImage(const image::ImagePtr &image, const core::String& filename);
+/**
+ * @brief Encodes the given images in parallel on the thread pool and writes them to the filenames with the same index
+ * @return @c false if any of the images could not get written
+ */
+bool writeImages(const core::DynamicArray<ImagePtr> &images, const core::DynamicArray<core::String> &filenames,
+				 core::ThreadPool *threadPool = nullptr);
 core::String print(const image::ImagePtr &image, bool limited = true);
 
 }
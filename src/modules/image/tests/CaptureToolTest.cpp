@@ -0,0 +1,42 @@
+/**
+ * @file
+ */
+
+#include "image/CaptureTool.h"
+#include "app/tests/AbstractTest.h"
+#include "core/RGBA.h"
+
+namespace image {
+
+class CaptureToolTest : public app::AbstractTest {
+protected:
+	void record(CaptureType type, const char *filename) {
+		CaptureTool captureTool(type);
+		ASSERT_TRUE(captureTool.startRecording(filename, 16, 16));
+		int enqueued = 0;
+		for (int i = 0; i < 32; ++i) {
+			const image::ImagePtr &frame = image::createEmptyImage("frame");
+			ASSERT_TRUE(frame->load(16, 16, [i](int x, int y, core::RGBA &rgba) {
+				rgba = core::RGBA((uint8_t)(x * 16), (uint8_t)(y * 16), (uint8_t)(i * 8), 255);
+			}));
+			if (captureTool.enqueueFrame(frame)) {
+				++enqueued;
+			}
+		}
+		EXPECT_GT(enqueued, 0);
+		EXPECT_TRUE(captureTool.stopRecording());
+		EXPECT_FALSE(captureTool.enqueueFrame(image::createEmptyImage("frame")));
+		EXPECT_TRUE(captureTool.flush());
+		EXPECT_EQ(0u, captureTool.pendingFrames());
+	}
+};
+
+TEST_F(CaptureToolTest, testRecordAVI) {
+	record(CaptureType::AVI, "testcapture.avi");
+}
+
+TEST_F(CaptureToolTest, testRecordMPEG2) {
+	record(CaptureType::MPEG2, "testcapture.mpeg2");
+}
+
+} // namespace image
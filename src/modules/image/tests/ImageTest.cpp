@@ -6,7 +6,9 @@
 #include "image/Image.h"
 #include "math/tests/TestMathHelper.h"
 #include "core/tests/TestColorHelper.h"
+#include "core/StringUtil.h"
 #include "io/BufferedReadWriteStream.h"
+#include "io/Filesystem.h"
 #include <glm/vec2.hpp>
 #ifndef GLM_ENABLE_EXPERIMENTAL
 #define GLM_ENABLE_EXPERIMENTAL
@@ -91,6 +93,47 @@ TEST_F(ImageTest, testWritePng) {
 	ASSERT_TRUE(image::createEmptyImage("image")->load(stream3, (int)stream1.size()));
 }
 
+TEST_F(ImageTest, testWritePngFast) {
+	io::BufferedReadWriteStream stream;
+	ASSERT_TRUE(image::Image::writePng(stream, (const uint8_t *)img3, 6, 6, 4, image::PngCompression::Fast));
+	stream.seek(0);
+	const image::ImagePtr &img = image::createEmptyImage("image");
+	ASSERT_TRUE(img->load(stream, (int)stream.size()));
+	for (int y = 0; y < 6; ++y) {
+		for (int x = 0; x < 6; ++x) {
+			EXPECT_EQ(img3[y * 6 + x], img->colorAt(x, y)) << "at " << x << ":" << y;
+		}
+	}
+}
+
+TEST_F(ImageTest, testWriteAndLoadImages) {
+	const core::RGBA *pixels[] = {img1, img2, img3};
+	core::DynamicArray<image::ImagePtr> images;
+	core::DynamicArray<core::String> filenames;
+	for (int i = 0; i < 3; ++i) {
+		const core::String &filename =
+			core::string::path(_testApp->filesystem()->homePath(), core::string::format("testimages-%i.png", i));
+		const image::ImagePtr &img = image::createEmptyImage(filename);
+		ASSERT_TRUE(img->loadRGBA((const uint8_t *)pixels[i], 6, 6));
+		images.push_back(img);
+		filenames.push_back(filename);
+	}
+	ASSERT_TRUE(image::writeImages(images, filenames, &_testApp->threadPool()));
+	filenames.push_back("does-not-exist.png");
+
+	const core::DynamicArray<image::ImagePtr> &loaded = image::loadImages(filenames, &_testApp->threadPool());
+	ASSERT_EQ(4u, loaded.size());
+	for (int i = 0; i < 3; ++i) {
+		ASSERT_TRUE(loaded[i]->isLoaded()) << filenames[i].c_str();
+		for (int y = 0; y < 6; ++y) {
+			for (int x = 0; x < 6; ++x) {
+				EXPECT_EQ(pixels[i][y * 6 + x], loaded[i]->colorAt(x, y)) << "image " << i << " at " << x << ":" << y;
+			}
+		}
+	}
+	EXPECT_FALSE(loaded[3]->isLoaded());
+}
+
 TEST_F(ImageTest, testGet) {
 	const image::ImagePtr& img = image::loadImage("test-palette-in.png");
 	const core::RGBA rgba = img->colorAt(33, 7);
@@ -55,6 +55,10 @@ bool Archive::write(const core::String &filePath, io::ReadStream &stream) {
 	return wstream->writeStream(stream);
 }
 
+bool Archive::remove(const core::String &filePath) {
+	return false;
+}
+
 bool isZipArchive(const core::String &filename) {
 	const core::String &ext = core::string::extractExtension(filename);
 	return ext == "zip" || ext == "pk3";
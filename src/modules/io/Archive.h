@@ -67,6 +67,12 @@ public:
 	virtual SeekableWriteStream *writeStream(const core::String &filePath);
 
 	virtual bool write(const core::String &filePath, io::ReadStream &stream);
+
+	/**
+	 * @brief Deletes the given file from the archive
+	 * @return @c false if the archive doesn't support the removal of files or the file couldn't get removed
+	 */
+	virtual bool remove(const core::String &filePath);
 };
 
 inline const ArchiveFiles &Archive::files() const {
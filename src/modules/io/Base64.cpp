@@ -5,77 +5,58 @@
 #include "Base64.h"
 #include "core/ArrayLength.h"
 #include "core/Common.h"
-#include "io/MemoryReadStream.h"
+#include "io/Base64Stream.h"
 #include "io/Stream.h"
-#include <ctype.h>
 
 namespace io {
 namespace Base64 {
 namespace _priv {
-/**
- * This array is a LUT specified in RFC 4648
- */
-static const char LUT[] = {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
-						   'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
-						   'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
-						   'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'};
 
-static CORE_FORCE_INLINE void encode0(const uint8_t src[3], uint8_t dst[4], core::String &out, int bytes) {
-	dst[0] = (src[0] & 0xfc) >> 2;
-	dst[1] = ((src[0] & 0x03) << 4) + ((src[1] & 0xf0) >> 4);
-	dst[2] = ((src[1] & 0x0f) << 2) + ((src[2] & 0xc0) >> 6);
-	dst[3] = src[2] & 0x3f;
+// the amount of 3 byte groups that are encoded or decoded at once
+static constexpr size_t BlockGroups = 1024;
 
-	for (int i = 0; i < bytes; ++i) {
-		out += _priv::LUT[dst[i]];
+class Codec : public Base64Stream {
+public:
+	static CORE_FORCE_INLINE uint8_t reverse(uint8_t c) {
+		return REV_LUT.values[c];
 	}
-}
-
-static CORE_FORCE_INLINE bool decode0(uint8_t src[4], io::WriteStream &out, int bytes) {
-	uint8_t dest[3];
-
-	dest[0] = (src[0] << 2) + ((src[1] & 0x30) >> 4);
-	dest[1] = ((src[1] & 0xf) << 4) + ((src[2] & 0x3c) >> 2);
-	dest[2] = ((src[2] & 0x3) << 6) + src[3];
-
-	for (int i = 0; i < bytes; ++i) {
-		if (!out.writeUInt8(dest[i])) {
-			return false;
-		}
-	}
-	return true;
-}
-
-static CORE_FORCE_INLINE bool validbyte(const uint8_t c) {
-	return c == '+' || c == '/' || isalnum(c);
-}
+};
 
 } // namespace _priv
 
 core::String encode(io::ReadStream &stream) {
 	core::String str;
-	uint8_t source[3];
-	uint8_t dest[4];
+	uint8_t source[3 * _priv::BlockGroups];
+	uint8_t dest[4 * _priv::BlockGroups];
 
-	int bytes = 0;
+	// the bytes of an incomplete group are kept at the beginning of the source buffer for the next read
+	size_t bytes = 0;
 	while (!stream.eos()) {
-		uint8_t val = 0;
-		if (stream.readUInt8(val) != 0) {
+		const int n = stream.read(source + bytes, sizeof(source) - bytes);
+		if (n < 0) {
 			return "";
 		}
-		source[bytes++] = val;
-		if (bytes == 3) {
-			_priv::encode0(source, dest, str, lengthof(dest));
-			bytes = 0;
+		if (n == 0) {
+			break;
+		}
+		bytes += (size_t)n;
+		const size_t groups = bytes / 3;
+		Base64Stream::encodeBlock(source, groups, dest);
+		str.append((const char *)dest, groups * 4);
+		const size_t encoded = groups * 3;
+		bytes -= encoded;
+		for (size_t i = 0; i < bytes; ++i) {
+			source[i] = source[encoded + i];
 		}
 	}
 
 	// handle remaining bytes
 	if (bytes) {
-		for (int i = bytes; i < 3; ++i) {
+		for (size_t i = bytes; i < 3; ++i) {
 			source[i] = '\0';
 		}
-		_priv::encode0(source, dest, str, bytes + 1);
+		Base64Stream::encodeBlock(source, 1, dest);
+		str.append((const char *)dest, bytes + 1);
 		while (bytes++ < 3) {
 			str += '=';
 		}
@@ -84,41 +65,52 @@ core::String encode(io::ReadStream &stream) {
 	return str;
 }
 
-static bool decode(io::WriteStream &stream, io::ReadStream &input) {
-	int bytes = 0;
-	uint8_t src[4];
-	int REV_LUT[256];
-	for (int i = 0; i < lengthof(_priv::LUT); ++i) {
-		REV_LUT[(uint8_t)_priv::LUT[i]] = i;
-	}
-
-	while (!input.eos()) {
-		uint8_t val = 0;
-		if (input.readUInt8(val) != 0) {
+bool decode(io::WriteStream &stream, const core::String &input) {
+	const uint8_t *src = (const uint8_t *)input.c_str();
+	const size_t size = input.size();
+	uint8_t dest[3 * _priv::BlockGroups];
+
+	// decode the complete groups in blocks - this stops at the padding or at an invalid character
+	size_t pos = 0;
+	while (size - pos >= 4) {
+		const size_t groups = core_min((size - pos) / 4, _priv::BlockGroups);
+		const size_t decoded = Base64Stream::decodeBlock(src + pos, groups, dest);
+		if (decoded > 0 && stream.write(dest, decoded * 3) == -1) {
 			return false;
 		}
-		if (val == '=') {
+		pos += decoded * 4;
+		if (decoded < groups) {
 			break;
 		}
-		if (!_priv::validbyte(val)) {
+	}
+
+	// the remaining characters until the padding or an invalid character
+	int bytes = 0;
+	uint8_t group[4];
+	while (pos < size) {
+		const uint8_t val = _priv::Codec::reverse(src[pos++]);
+		if (val == 0xff) {
 			break;
 		}
-		src[bytes++] = REV_LUT[val];
+		group[bytes++] = val;
 		if (bytes == 4) {
-			if (!_priv::decode0(src, stream, 3)) {
+			const uint8_t out[3]{(uint8_t)((group[0] << 2) + ((group[1] & 0x30) >> 4)),
+								 (uint8_t)(((group[1] & 0xf) << 4) + ((group[2] & 0x3c) >> 2)),
+								 (uint8_t)(((group[2] & 0x3) << 6) + group[3])};
+			if (stream.write(out, lengthof(out)) == -1) {
 				return false;
 			}
 			bytes = 0;
 		}
 	}
 
-	// handle remaining bytes
-	if (bytes) {
+	if (bytes > 1) {
 		for (int i = bytes; i < 4; i++) {
-			src[i] = REV_LUT[0];
+			group[i] = 0;
 		}
-
-		if (!_priv::decode0(src, stream, bytes - 1)) {
+		const uint8_t out[2]{(uint8_t)((group[0] << 2) + ((group[1] & 0x30) >> 4)),
+							 (uint8_t)(((group[1] & 0xf) << 4) + ((group[2] & 0x3c) >> 2))};
+		if (stream.write(out, bytes - 1) == -1) {
 			return false;
 		}
 	}
@@ -126,10 +118,5 @@ static bool decode(io::WriteStream &stream, io::ReadStream &input) {
 	return true;
 }
 
-bool decode(io::WriteStream &stream, const core::String &input) {
-	io::MemoryReadStream inputStream(input.c_str(), input.size());
-	return decode(stream, inputStream);
-}
-
 } // namespace Base64
 } // namespace util
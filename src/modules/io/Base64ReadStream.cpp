@@ -4,14 +4,20 @@
 
 #include "Base64ReadStream.h"
 #include "core/ArrayLength.h"
+#include "core/Common.h"
 #include "io/Stream.h"
 
 namespace io {
 
 Base64ReadStream::Base64ReadStream(io::ReadStream &stream) : _stream(stream) {
-	for (int i = 0; i < lengthof(LUT); ++i) {
-		_reverseLookupTable[(uint8_t)LUT[i]] = i;
+}
+
+int Base64ReadStream::nextChar(uint8_t &val) {
+	if (_inBufPos < _inBufSize) {
+		val = _inBuf[_inBufPos++];
+		return 0;
 	}
+	return _stream.readUInt8(val);
 }
 
 int Base64ReadStream::read(void *buf, size_t size) {
@@ -24,10 +30,29 @@ int Base64ReadStream::read(void *buf, size_t size) {
 			--_readBufSize;
 			continue;
 		}
-		if (_stream.eos()) {
+		const bool buffered = _inBufPos < _inBufSize;
+		if (!buffered && _stream.eos()) {
 			return bytesWritten;
 		}
 
+		// decode the complete groups directly into the target buffer
+		const size_t groups = core_min((size - bytesWritten) / 3, (size_t)lengthof(_inBuf) / 4);
+		if (!buffered && groups > 0) {
+			const int n = _stream.read(_inBuf, groups * 4);
+			if (n < 0) {
+				return -1;
+			}
+			_inBufSize = n;
+			_inBufPos = 0;
+			const size_t decoded = decodeBlock(_inBuf, (size_t)n / 4, bytesPtr + bytesWritten);
+			bytesWritten += decoded * 3;
+			_inBufPos = (int)(decoded * 4);
+			if (decoded > 0) {
+				continue;
+			}
+			// the first group is incomplete or contains the padding
+		}
+
 		_readBufPos = 0;
 		_readBufSize = 0;
 
@@ -35,19 +60,20 @@ int Base64ReadStream::read(void *buf, size_t size) {
 		uint8_t tmpbuf[4]{'\0', '\0', '\0', '\0'};
 		for (int i = 0; i < 4; ++i) {
 			uint8_t val = 0;
-			if (_stream.readUInt8(val) != 0) {
+			if (nextChar(val) != 0) {
 				return -1;
 			}
 			if (val == '=') {
-				uint8_t endBuf[3];
-				_stream.read(endBuf, 3 - i);
+				for (int j = i + 1; j < 4; ++j) {
+					nextChar(val);
+				}
 				decodedSize = (i * 3) / 4;
 				break;
 			}
 			if (!validbyte(val)) {
 				return -1;
 			}
-			tmpbuf[i] = _reverseLookupTable[val];
+			tmpbuf[i] = REV_LUT.values[val];
 		}
 		if (!decode(tmpbuf, _readBuf)) {
 			return -1;
@@ -60,7 +86,7 @@ int Base64ReadStream::read(void *buf, size_t size) {
 }
 
 bool Base64ReadStream::eos() const {
-	return _stream.eos() && _readBufSize == 0;
+	return _stream.eos() && _readBufSize == 0 && _inBufPos >= _inBufSize;
 }
 
 } // namespace io
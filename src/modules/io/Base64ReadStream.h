@@ -8,6 +8,11 @@
 namespace io {
 
 /**
+ * @brief Decodes the base64 encoded characters of the wrapped stream
+ *
+ * Larger reads are decoded in blocks - but never more characters than needed for the requested amount of bytes are
+ * read from the wrapped stream.
+ *
  * @ingroup IO
  */
 class Base64ReadStream : public io::ReadStream, public Base64Stream {
@@ -16,7 +21,15 @@ protected:
 	int _readBufSize = 0;
 	uint8_t _readBuf[3];
 	int _readBufPos = 0;
-	int _reverseLookupTable[256];
+	// characters that were read from the wrapped stream but not yet decoded
+	uint8_t _inBuf[4 * 256];
+	int _inBufSize = 0;
+	int _inBufPos = 0;
+
+	/**
+	 * @return -1 if the wrapped stream doesn't have any more characters
+	 */
+	int nextChar(uint8_t &val);
 
 	static CORE_FORCE_INLINE bool decode(uint8_t src[4], uint8_t dest[3]) {
 		dest[0] = (src[0] << 2) + ((src[1] & 0x30) >> 4);
@@ -6,10 +6,26 @@
 
 #include "core/Common.h"
 #include <ctype.h>
+#include <stddef.h>
 #include <stdint.h>
 
 namespace io {
 
+/**
+ * Maps the characters of the alphabet to their 6 bit values - any other character maps to @c 0xff
+ */
+struct Base64ReverseLUT {
+	uint8_t values[256];
+	constexpr Base64ReverseLUT(const char *alphabet) : values() {
+		for (int i = 0; i < 256; ++i) {
+			values[i] = 0xff;
+		}
+		for (int i = 0; i < 64; ++i) {
+			values[(uint8_t)alphabet[i]] = (uint8_t)i;
+		}
+	}
+};
+
 /**
  * @ingroup IO
  */
@@ -26,6 +42,46 @@ protected:
 	static CORE_FORCE_INLINE bool validbyte(const uint8_t c) {
 		return c == '+' || c == '/' || isalnum(c);
 	}
+
+	static constexpr Base64ReverseLUT REV_LUT{LUT};
+
+public:
+	/**
+	 * @brief Encodes the given amount of 3 byte groups into 4 characters each
+	 * @param[out] dst Must have room for @c groups * 4 characters
+	 */
+	static void encodeBlock(const uint8_t *src, size_t groups, uint8_t *dst) {
+		for (size_t i = 0; i < groups; ++i, src += 3, dst += 4) {
+			const uint32_t value = ((uint32_t)src[0] << 16) | ((uint32_t)src[1] << 8) | (uint32_t)src[2];
+			dst[0] = LUT[value >> 18];
+			dst[1] = LUT[(value >> 12) & 0x3f];
+			dst[2] = LUT[(value >> 6) & 0x3f];
+			dst[3] = LUT[value & 0x3f];
+		}
+	}
+
+	/**
+	 * @brief Decodes the given amount of 4 character groups into 3 bytes each
+	 * @param[out] dst Must have room for @c groups * 3 bytes
+	 * @return The amount of decoded groups - this stops at the first group with a character that is not part of the
+	 * alphabet (e.g. the padding character)
+	 */
+	static size_t decodeBlock(const uint8_t *src, size_t groups, uint8_t *dst) {
+		for (size_t i = 0; i < groups; ++i, src += 4, dst += 3) {
+			const uint8_t a = REV_LUT.values[src[0]];
+			const uint8_t b = REV_LUT.values[src[1]];
+			const uint8_t c = REV_LUT.values[src[2]];
+			const uint8_t d = REV_LUT.values[src[3]];
+			if ((a | b | c | d) & 0x80) {
+				return i;
+			}
+			const uint32_t value = ((uint32_t)a << 18) | ((uint32_t)b << 12) | ((uint32_t)c << 6) | (uint32_t)d;
+			dst[0] = (uint8_t)(value >> 16);
+			dst[1] = (uint8_t)(value >> 8);
+			dst[2] = (uint8_t)value;
+		}
+		return groups;
+	}
 };
 
 } // namespace io
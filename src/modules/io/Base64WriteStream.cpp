@@ -3,7 +3,7 @@
  */
 
 #include "Base64WriteStream.h"
-#include "core/ArrayLength.h"
+#include "core/Common.h"
 #include "io/Base64.h"
 #include "io/Stream.h"
 
@@ -17,19 +17,39 @@ Base64WriteStream::~Base64WriteStream() {
 }
 
 int Base64WriteStream::write(const void *buf, size_t size) {
-	uint8_t dest[4];
+	uint8_t dest[4 * 1024];
 	int written = 0;
 	const uint8_t *bytesPtr = (const uint8_t *)buf;
-	for (size_t i = 0; i < size; ++i) {
-		uint8_t val = bytesPtr[i];
-		_buf[_bytes++] = val;
-		if (_bytes == 3) {
-			if (!encode(_buf, _stream, lengthof(dest))) {
-				return -1;
-			}
-			written += lengthof(dest);
-			_bytes = 0;
+	size_t remaining = size;
+	// complete the group of the previous write
+	if (_bytes > 0) {
+		while (_bytes < 3 && remaining > 0) {
+			_buf[_bytes++] = *bytesPtr++;
+			--remaining;
+		}
+		if (_bytes < 3) {
+			return size;
 		}
+		if (!encode(_buf, _stream, 4)) {
+			return -1;
+		}
+		written += 4;
+		_bytes = 0;
+	}
+	// encode the complete groups in blocks
+	while (remaining >= 3) {
+		const size_t groups = core_min(remaining / 3, sizeof(dest) / 4);
+		encodeBlock(bytesPtr, groups, dest);
+		if (_stream.write(dest, groups * 4) == -1) {
+			return -1;
+		}
+		written += (int)(groups * 4);
+		bytesPtr += groups * 3;
+		remaining -= groups * 3;
+	}
+	while (remaining > 0) {
+		_buf[_bytes++] = *bytesPtr++;
+		--remaining;
 	}
 
 	if (written == 0) {
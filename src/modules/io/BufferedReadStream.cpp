@@ -0,0 +1,100 @@
+/**
+ * @file
+ */
+
+#include "BufferedReadStream.h"
+#include "core/StandardLib.h"
+
+namespace io {
+
+BufferedReadStream::BufferedReadStream(SeekableReadStream &stream, int bufferedBytes)
+	: _stream(stream), _capacity(bufferedBytes > 0 ? (size_t)bufferedBytes : 1u), _bufferOffset(stream.pos()),
+	  _size(stream.size()) {
+	_buffer = (uint8_t *)core_malloc(_capacity);
+}
+
+BufferedReadStream::~BufferedReadStream() {
+	_stream.seek(pos());
+	core_free(_buffer);
+}
+
+bool BufferedReadStream::fill() {
+	_bufferOffset += (int64_t)_bufferPos;
+	_bufferPos = 0u;
+	_bufferSize = 0u;
+	if (_stream.pos() != _bufferOffset && _stream.seek(_bufferOffset) == -1) {
+		return false;
+	}
+	const int bytes = _stream.read(_buffer, _capacity);
+	if (bytes <= 0) {
+		return false;
+	}
+	_bufferSize = (size_t)bytes;
+	return true;
+}
+
+int BufferedReadStream::read(void *dataPtr, size_t dataSize) {
+	uint8_t *out = (uint8_t *)dataPtr;
+	size_t remaining = dataSize;
+	while (remaining > 0u) {
+		if (_bufferPos >= _bufferSize) {
+			if (remaining >= _capacity) {
+				// large reads bypass the frame
+				_bufferOffset += (int64_t)_bufferPos;
+				_bufferPos = _bufferSize = 0u;
+				if (_stream.pos() != _bufferOffset && _stream.seek(_bufferOffset) == -1) {
+					break;
+				}
+				const int bytes = _stream.read(out, remaining);
+				if (bytes <= 0) {
+					break;
+				}
+				_bufferOffset += bytes;
+				remaining -= (size_t)bytes;
+				break;
+			}
+			if (!fill()) {
+				break;
+			}
+		}
+		const size_t available = core_min(_bufferSize - _bufferPos, remaining);
+		core_memcpy(out, _buffer + _bufferPos, available);
+		_bufferPos += available;
+		out += available;
+		remaining -= available;
+	}
+	if (remaining == dataSize && dataSize > 0u) {
+		return -1;
+	}
+	return (int)(dataSize - remaining);
+}
+
+int64_t BufferedReadStream::seek(int64_t position, int whence) {
+	int64_t newPos;
+	switch (whence) {
+	case SEEK_SET:
+		newPos = position;
+		break;
+	case SEEK_CUR:
+		newPos = pos() + position;
+		break;
+	case SEEK_END:
+		newPos = _size + position;
+		break;
+	default:
+		return -1;
+	}
+	if (newPos < 0 || newPos > _size) {
+		return -1;
+	}
+	// seeks inside of the frame don't touch the wrapped stream
+	if (newPos >= _bufferOffset && newPos <= _bufferOffset + (int64_t)_bufferSize) {
+		_bufferPos = (size_t)(newPos - _bufferOffset);
+		return newPos;
+	}
+	_bufferOffset = newPos;
+	_bufferPos = _bufferSize = 0u;
+	return newPos;
+}
+
+} // namespace io
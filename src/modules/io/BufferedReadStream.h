@@ -0,0 +1,154 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Stream.h"
+
+namespace io {
+
+/**
+ * @brief Reads the wrapped stream in frames of the given size. The primitive reads are served inline from the frame
+ * without the virtual @c read() call of the wrapped stream - this is meant for loaders that read a lot of single
+ * values.
+ *
+ * The primitive read methods of @c ReadStream are hidden by the inline versions of this class - access the stream by
+ * this type (and not by a @c ReadStream reference) to get the fast path.
+ *
+ * @note The position of the wrapped stream is set to the position of this stream on destruction - the read ahead bytes
+ * are given back.
+ * @ingroup IO
+ */
+class BufferedReadStream final : public SeekableReadStream {
+private:
+	SeekableReadStream &_stream;
+	uint8_t *_buffer;
+	const size_t _capacity;
+	// the amount of valid bytes in the frame
+	size_t _bufferSize = 0u;
+	// the read position in the frame
+	size_t _bufferPos = 0u;
+	// the position of the first byte of the frame in the wrapped stream
+	int64_t _bufferOffset;
+	const int64_t _size;
+
+	/**
+	 * @brief Reads the next frame at the current position
+	 * @return @c false if no byte could be read
+	 */
+	bool fill();
+
+	template<typename TYPE, bool BigEndian>
+	inline int readFast(TYPE &val) {
+		if (_bufferSize - _bufferPos >= sizeof(TYPE)) {
+			memcpy(&val, _buffer + _bufferPos, sizeof(TYPE));
+			_bufferPos += sizeof(TYPE);
+			val = priv::swapEndian<TYPE, BigEndian>(val);
+			return 0;
+		}
+		if (read(&val, sizeof(TYPE)) != (int)sizeof(TYPE)) {
+			return -1;
+		}
+		val = priv::swapEndian<TYPE, BigEndian>(val);
+		return 0;
+	}
+
+public:
+	/**
+	 * @param[in] bufferedBytes The size of the frame that is read from the wrapped stream at once
+	 */
+	BufferedReadStream(SeekableReadStream &stream, int bufferedBytes = 64 * 1024);
+	virtual ~BufferedReadStream();
+
+	int read(void *dataPtr, size_t dataSize) override;
+	int64_t seek(int64_t position, int whence = SEEK_SET) override;
+	int64_t size() const override;
+	int64_t pos() const override;
+
+	inline int64_t skip(int64_t delta) {
+		return seek(delta, SEEK_CUR);
+	}
+
+	inline int readUInt8(uint8_t &val) {
+		if (_bufferPos < _bufferSize) {
+			val = _buffer[_bufferPos++];
+			return 0;
+		}
+		return readFast<uint8_t, false>(val);
+	}
+	inline int readInt8(int8_t &val) {
+		return readFast<int8_t, false>(val);
+	}
+	inline int readUInt16(uint16_t &val) {
+		return readFast<uint16_t, false>(val);
+	}
+	inline int readInt16(int16_t &val) {
+		return readFast<int16_t, false>(val);
+	}
+	inline int readUInt32(uint32_t &val) {
+		return readFast<uint32_t, false>(val);
+	}
+	inline int readInt32(int32_t &val) {
+		return readFast<int32_t, false>(val);
+	}
+	inline int readUInt64(uint64_t &val) {
+		return readFast<uint64_t, false>(val);
+	}
+	inline int readInt64(int64_t &val) {
+		return readFast<int64_t, false>(val);
+	}
+	inline int readFloat(float &val) {
+		return readFast<float, false>(val);
+	}
+	inline int readDouble(double &val) {
+		return readFast<double, false>(val);
+	}
+	inline int readUInt16BE(uint16_t &val) {
+		return readFast<uint16_t, true>(val);
+	}
+	inline int readInt16BE(int16_t &val) {
+		return readFast<int16_t, true>(val);
+	}
+	inline int readUInt32BE(uint32_t &val) {
+		return readFast<uint32_t, true>(val);
+	}
+	inline int readInt32BE(int32_t &val) {
+		return readFast<int32_t, true>(val);
+	}
+	inline int readUInt64BE(uint64_t &val) {
+		return readFast<uint64_t, true>(val);
+	}
+	inline int readInt64BE(int64_t &val) {
+		return readFast<int64_t, true>(val);
+	}
+	inline int readFloatBE(float &val) {
+		return readFast<float, true>(val);
+	}
+	inline int readDoubleBE(double &val) {
+		return readFast<double, true>(val);
+	}
+
+	/**
+	 * @note doesn't advance the stream position
+	 * @return -1 on error - 0 on success
+	 */
+	inline int peekUInt32(uint32_t &val) {
+		if (_bufferSize - _bufferPos < sizeof(val)) {
+			return SeekableReadStream::peekUInt32(val);
+		}
+		memcpy(&val, _buffer + _bufferPos, sizeof(val));
+		val = priv::swapEndian<uint32_t, false>(val);
+		return 0;
+	}
+};
+
+inline int64_t BufferedReadStream::size() const {
+	return _size;
+}
+
+inline int64_t BufferedReadStream::pos() const {
+	return _bufferOffset + (int64_t)_bufferPos;
+}
+
+} // namespace io
@@ -3,6 +3,7 @@
  */
 
 #include "BufferedReadWriteStream.h"
+#include "core/MemoryTracker.h"
 #include "core/StandardLib.h"
 
 namespace io {
@@ -31,7 +32,7 @@ BufferedReadWriteStream::BufferedReadWriteStream(int64_t size) {
 }
 
 BufferedReadWriteStream::~BufferedReadWriteStream() {
-	core_free(_buffer);
+	core::memoryFree(core::MemoryTag::Format, _buffer, (size_t)_capacity);
 }
 
 void BufferedReadWriteStream::reset() {
@@ -39,8 +40,28 @@ void BufferedReadWriteStream::reset() {
 	_pos = 0u;
 }
 
+void BufferedReadWriteStream::reserve(int64_t size) {
+	if (size <= 0 || _capacity >= size) {
+		return;
+	}
+	reallocBuffer(align(size));
+}
+
+void BufferedReadWriteStream::reallocBuffer(int64_t capacity) {
+	if (_buffer != nullptr) {
+		core::memoryTrackFree(core::MemoryTag::Format, _buffer, (size_t)_capacity);
+	}
+	_capacity = capacity;
+	_buffer = (uint8_t *)core_realloc(_buffer, _capacity);
+	core::memoryTrackAlloc(core::MemoryTag::Format, _buffer, (size_t)_capacity);
+}
+
 uint8_t* BufferedReadWriteStream::release() {
 	uint8_t *b = _buffer;
+	if (b != nullptr) {
+		// the caller owns the memory now
+		core::memoryTrackFree(core::MemoryTag::Format, b, (size_t)_capacity);
+	}
 	_buffer = nullptr;
 	_size = 0u;
 	_capacity = 0;
@@ -55,12 +76,8 @@ void BufferedReadWriteStream::resizeBuffer(int64_t size) {
 	if (_capacity >= size) {
 		return;
 	}
-	_capacity = align(size);
-	if (!_buffer) {
-		_buffer = (uint8_t*)core_malloc(_capacity);
-	} else {
-		_buffer = (uint8_t*)core_realloc(_buffer, _capacity);
-	}
+	// grow geometrically - growing by the written amount only would copy the whole buffer on nearly every write
+	reallocBuffer(align(core_max(size, _capacity + _capacity / 2)));
 }
 
 int BufferedReadWriteStream::write(const void *buf, size_t size) {
@@ -30,6 +30,7 @@ private:
 	}
 
 	void resizeBuffer(int64_t size);
+	void reallocBuffer(int64_t capacity);
 public:
 	BufferedReadWriteStream(io::ReadStream &stream, int64_t size);
 	BufferedReadWriteStream(io::ReadStream &stream);
@@ -37,6 +38,11 @@ public:
 	virtual ~BufferedReadWriteStream();
 
 	void reset();
+	/**
+	 * @brief Allocates the buffer for the given amount of bytes up front - use this if the size of the data that is
+	 * written is known or can be estimated to avoid reallocations while writing
+	 */
+	void reserve(int64_t size);
 
 	// get the raw data pointer for the buffer
 	const uint8_t* getBuffer() const;
@@ -0,0 +1,69 @@
+/**
+ * @file
+ */
+
+#include "ChunkedWriteStream.h"
+#include "core/StandardLib.h"
+
+namespace io {
+
+ChunkedWriteStream::ChunkedWriteStream(size_t sizeHint, size_t chunkSize)
+	: _chunkSize(chunkSize > 0u ? chunkSize : 1u), _sizeHint(sizeHint) {
+}
+
+ChunkedWriteStream::~ChunkedWriteStream() {
+	reset();
+}
+
+ChunkedWriteStream::Chunk &ChunkedWriteStream::addChunk(size_t capacity) {
+	Chunk chunk;
+	chunk.data = (uint8_t *)core_malloc(capacity);
+	chunk.size = 0u;
+	chunk.capacity = capacity;
+	_chunks.push_back(chunk);
+	return _chunks.back();
+}
+
+void ChunkedWriteStream::reset() {
+	for (Chunk &chunk : _chunks) {
+		core_free(chunk.data);
+	}
+	_chunks.clear();
+	_size = 0;
+}
+
+int ChunkedWriteStream::write(const void *buf, size_t size) {
+	const uint8_t *in = (const uint8_t *)buf;
+	size_t remaining = size;
+	while (remaining > 0u) {
+		if (_chunks.empty() || _chunks.back().size >= _chunks.back().capacity) {
+			if (_chunks.empty() && _sizeHint > 0u) {
+				addChunk(_sizeHint);
+			} else {
+				addChunk(_chunkSize);
+			}
+		}
+		Chunk &chunk = _chunks.back();
+		const size_t bytes = core_min(chunk.capacity - chunk.size, remaining);
+		core_memcpy(chunk.data + chunk.size, in, bytes);
+		chunk.size += bytes;
+		in += bytes;
+		remaining -= bytes;
+	}
+	_size += (int64_t)size;
+	return (int)size;
+}
+
+bool ChunkedWriteStream::writeTo(WriteStream &stream) const {
+	for (const Chunk &chunk : _chunks) {
+		if (chunk.size == 0u) {
+			continue;
+		}
+		if (stream.write(chunk.data, chunk.size) != (int)chunk.size) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace io
@@ -0,0 +1,69 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "io/Stream.h"
+#include "core/collection/DynamicArray.h"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace io {
+
+/**
+ * @brief Write stream that collects the data in a list of fixed size chunks instead of one growing buffer
+ *
+ * The chunks are never reallocated - so writing large outputs doesn't copy the already written data again and doesn't
+ * need the memory for the old and the new buffer at the same time. Use @c writeTo() to write all chunks one after
+ * another into the target stream.
+ *
+ * @see BufferedReadWriteStream if the data must be available in one contiguous buffer
+ * @ingroup IO
+ */
+class ChunkedWriteStream : public WriteStream {
+private:
+	struct Chunk {
+		uint8_t *data;
+		size_t size;
+		size_t capacity;
+	};
+	core::DynamicArray<Chunk> _chunks;
+	const size_t _chunkSize;
+	const size_t _sizeHint;
+	int64_t _size = 0;
+
+	Chunk &addChunk(size_t capacity);
+
+public:
+	/**
+	 * @param[in] sizeHint The expected amount of bytes - the first chunk is allocated with this size
+	 * @param[in] chunkSize The size of the chunks that are allocated if the data doesn't fit into the existing chunks
+	 */
+	ChunkedWriteStream(size_t sizeHint = 0u, size_t chunkSize = 256u * 1024u);
+	virtual ~ChunkedWriteStream();
+
+	int write(const void *buf, size_t size) override;
+	/**
+	 * @brief Writes all chunks in the order they were filled into the given stream
+	 * @return @c false if the target stream failed to write a chunk
+	 */
+	bool writeTo(WriteStream &stream) const;
+	/**
+	 * @brief Frees all chunks
+	 */
+	void reset();
+
+	int64_t size() const;
+	size_t chunks() const;
+};
+
+inline int64_t ChunkedWriteStream::size() const {
+	return _size;
+}
+
+inline size_t ChunkedWriteStream::chunks() const {
+	return _chunks.size();
+}
+
+} // namespace io
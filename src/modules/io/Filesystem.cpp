@@ -8,8 +8,14 @@
 #include "core/Log.h"
 #include "core/Path.h"
 #include "core/StringUtil.h"
+#include "core/SharedPtr.h"
+#include "core/Trace.h"
 #include "core/Var.h"
 #include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
 #include "engine-config.h" // PKGDATADIR
 #include "io/File.h"
 #include "io/FileStream.h"
@@ -226,6 +232,37 @@ bool Filesystem::sysCreateDir(const core::String &dir, bool recursive) {
 	return lastResult;
 }
 
+bool Filesystem::_listEntry(const core::String &directory, FilesystemEntry &entry, const core::String &filter,
+						   bool recurse) {
+	if (entry.type == FilesystemEntry::Type::link) {
+		core::String symlink = fs_readlink(entry.fullPath.c_str());
+		normalizePath(symlink);
+		if (symlink.empty()) {
+			Log::debug("Could not resolve symlink %s", entry.fullPath.c_str());
+			return false;
+		}
+		if (!filter.empty()) {
+			if (!core::string::fileMatchesMultiple(symlink.c_str(), filter.c_str())) {
+				Log::trace("File %s doesn't match filter %s", symlink.c_str(), filter.c_str());
+				return false;
+			}
+		}
+
+		entry.fullPath = sysIsRelativePath(symlink) ? core::string::path(directory, symlink) : symlink;
+	} else if (!recurse) {
+		if (!filter.empty()) {
+			if (!core::string::fileMatchesMultiple(entry.name.c_str(), filter.c_str())) {
+				Log::trace("Entity %s doesn't match filter %s", entry.name.c_str(), filter.c_str());
+				return false;
+			}
+		}
+	}
+	if (!fs_stat(entry.fullPath.c_str(), entry)) {
+		Log::debug("Could not stat file %s", entry.fullPath.c_str());
+	}
+	return true;
+}
+
 bool Filesystem::_list(const core::String &directory, core::DynamicArray<FilesystemEntry> &entities,
 					   const core::String &filter, int depth) {
 	const core::DynamicArray<FilesystemEntry> &entries = fs_scandir(directory.c_str());
@@ -233,33 +270,12 @@ bool Filesystem::_list(const core::String &directory, core::DynamicArray<Filesys
 	for (FilesystemEntry entry : entries) {
 		normalizePath(entry.name);
 		entry.fullPath = core::string::path(directory, entry.name);
-		if (entry.type == FilesystemEntry::Type::link) {
-			core::String symlink = fs_readlink(entry.fullPath.c_str());
-			normalizePath(symlink);
-			if (symlink.empty()) {
-				Log::debug("Could not resolve symlink %s", entry.fullPath.c_str());
-				continue;
-			}
-			if (!filter.empty()) {
-				if (!core::string::fileMatchesMultiple(symlink.c_str(), filter.c_str())) {
-					Log::trace("File %s doesn't match filter %s", symlink.c_str(), filter.c_str());
-					continue;
-				}
-			}
-
-			entry.fullPath = sysIsRelativePath(symlink) ? core::string::path(directory, symlink) : symlink;
-		} else if (entry.type == FilesystemEntry::Type::dir && depth > 0) {
+		const bool recurse = entry.type == FilesystemEntry::Type::dir && depth > 0;
+		if (recurse) {
 			_list(entry.fullPath, entities, filter, depth - 1);
-		} else {
-			if (!filter.empty()) {
-				if (!core::string::fileMatchesMultiple(entry.name.c_str(), filter.c_str())) {
-					Log::trace("Entity %s doesn't match filter %s", entry.name.c_str(), filter.c_str());
-					continue;
-				}
-			}
 		}
-		if (!fs_stat(entry.fullPath.c_str(), entry)) {
-			Log::debug("Could not stat file %s", entry.fullPath.c_str());
+		if (!_listEntry(directory, entry, filter, recurse)) {
+			continue;
 		}
 		entities.push_back(entry);
 	}
@@ -270,8 +286,114 @@ bool Filesystem::_list(const core::String &directory, core::DynamicArray<Filesys
 	return true;
 }
 
+bool Filesystem::_listDirectory(const core::String &directory, core::DynamicArray<FilesystemEntry> &entities,
+							 core::DynamicArray<core::String> &subdirectories, const core::String &filter, bool recurse) {
+	const core::DynamicArray<FilesystemEntry> &entries = fs_scandir(directory.c_str());
+	Log::debug("Found %i entries in %s", (int)entries.size(), directory.c_str());
+	entities.reserve(entries.size());
+	for (FilesystemEntry entry : entries) {
+		normalizePath(entry.name);
+		entry.fullPath = core::string::path(directory, entry.name);
+		const bool recurseDir = recurse && entry.type == FilesystemEntry::Type::dir;
+		if (recurseDir) {
+			subdirectories.push_back(entry.fullPath);
+		}
+		if (!_listEntry(directory, entry, filter, recurseDir)) {
+			continue;
+		}
+		entities.push_back(entry);
+	}
+	return !entries.empty();
+}
+
+namespace {
+
+/**
+ * @brief The directories of one hierarchy level that are scanned in parallel
+ */
+struct DirectoryLevel {
+	using ScanFunc = bool (*)(const core::String &, core::DynamicArray<FilesystemEntry> &,
+							  core::DynamicArray<core::String> &, const core::String &, bool);
+	ScanFunc scan = nullptr;
+	core::String filter;
+	bool recurse = false;
+	core::DynamicArray<core::String> directories;
+	core::DynamicArray<core::DynamicArray<FilesystemEntry>> entities;
+	core::DynamicArray<core::DynamicArray<core::String>> subdirectories;
+	core::DynamicArray<bool> found;
+	core::AtomicInt next{0};
+	core::AtomicInt done{0};
+	core_trace_mutex(core::Lock, lock, "DirectoryLevel");
+	core::ConditionVariable finished;
+
+	void run() {
+		const int n = (int)directories.size();
+		for (;;) {
+			const int i = next.increment();
+			if (i >= n) {
+				return;
+			}
+			found[i] = scan(directories[i], entities[i], subdirectories[i], filter, recurse);
+			done.increment();
+			{
+				core::ScopedLock scoped(lock);
+			}
+			finished.notify_all();
+		}
+	}
+};
+
+} // namespace
+
+bool Filesystem::_listParallel(const core::String &directory, core::DynamicArray<FilesystemEntry> &entities,
+							   const core::String &filter, int depth, core::ThreadPool *threadPool) {
+	bool found = false;
+	core::DynamicArray<core::String> directories;
+	directories.push_back(directory);
+	for (int level = 0; !directories.empty(); ++level) {
+		const int n = (int)directories.size();
+		core::SharedPtr<DirectoryLevel> state = core::make_shared<DirectoryLevel>();
+		state->scan = _listDirectory;
+		state->filter = filter;
+		state->recurse = level < depth;
+		state->directories = core::move(directories);
+		state->entities.resize(n);
+		state->subdirectories.resize(n);
+		state->found.resize(n);
+
+		const int workers = core_min(n - 1, (int)threadPool->size());
+		for (int i = 0; i < workers; ++i) {
+			threadPool->schedule([state]() { state->run(); });
+		}
+		state->run();
+		{
+			core::ScopedLock scoped(state->lock);
+			state->finished.wait(state->lock, [&state, n]() { return (int)state->done == n; });
+		}
+
+		if (level == 0) {
+			found = state->found[0];
+		}
+		directories.clear();
+		for (int i = 0; i < n; ++i) {
+			entities.append(state->entities[i]);
+			directories.append(state->subdirectories[i]);
+		}
+	}
+	if (!found) {
+		Log::debug("No files found in %s", directory.c_str());
+	}
+	return found;
+}
+
 bool Filesystem::list(const core::String &directory, core::DynamicArray<FilesystemEntry> &entities,
-					  const core::String &filter, int depth) const {
+					  const core::String &filter, int depth, core::ThreadPool *threadPool) const {
+	auto listDir = [&](const core::String &dir) {
+		if (threadPool != nullptr && depth > 0) {
+			return _listParallel(dir, entities, filter, depth, threadPool);
+		}
+		return _list(dir, entities, filter, depth);
+	};
 	if (sysIsRelativePath(directory)) {
 		const core::String cwd = sysCurrentDir();
 		for (const core::String &p : _paths) {
@@ -279,13 +401,13 @@ bool Filesystem::list(const core::String &directory, core::DynamicArray<Filesyst
 			if (core::string::isSamePath(fullDir, cwd)) {
 				continue;
 			}
-			_list(fullDir, entities, filter, depth);
+			listDir(fullDir);
 		}
 		if (directory.empty()) {
-			_list(cwd, entities, filter, depth);
+			listDir(cwd);
 		}
 	} else {
-		_list(directory, entities, filter, depth);
+		listDir(directory);
 	}
 	return true;
 }
@@ -15,6 +15,10 @@
 #include "core/collection/StringMap.h"
 #include "io/Stream.h"
 
+namespace core {
+class ThreadPool;
+}
+
 namespace io {
 
 using Paths = core::DynamicArray<core::String>;
@@ -68,7 +72,22 @@ private:
 
 	core::Stack<core::Path, 32> _dirStack;
 
+	/**
+	 * @brief Resolves symlinks, applies the filter and stats the given directory entry
+	 * @return @c false if the entry should be skipped
+	 */
+	static bool _listEntry(const core::String& directory, FilesystemEntry& entry, const core::String& filter, bool recurse);
 	static bool _list(const core::String& directory, core::DynamicArray<FilesystemEntry>& entities, const core::String& filter = "", int depth = 0);
+	/**
+	 * @brief Lists the entries of one directory without descending into sub directories
+	 * @param[out] subdirectories The sub directories that should get scanned next (only filled if @c recurse is @c true)
+	 * @return @c false if the directory has no entries
+	 */
+	static bool _listDirectory(const core::String& directory, core::DynamicArray<FilesystemEntry>& entities, core::DynamicArray<core::String>& subdirectories, const core::String& filter, bool recurse);
+	/**
+	 * @brief Scans all directories of one hierarchy level in parallel
+	 */
+	static bool _listParallel(const core::String& directory, core::DynamicArray<FilesystemEntry>& entities, const core::String& filter, int depth, core::ThreadPool* threadPool);
 
 public:
 	~Filesystem();
@@ -105,9 +124,11 @@ public:
 	 * @param directory The directory to list
 	 * @param entities The list of directory entities that were found
 	 * @param[in] filter Wildcard for filtering the returned entities. Separated by a comma. Example *.vox,*.qb,*.mcr
+	 * @param[in] threadPool If given and @c depth is greater than @c 0 the sub directories are scanned in parallel.
+	 * The entities of a directory are still added in order - but the directories are added level by level.
 	 * @return @c true if the directory could get opened
 	 */
-	bool list(const core::String& directory, core::DynamicArray<FilesystemEntry>& entities, const core::String& filter = "", int depth = 0) const;
+	bool list(const core::String& directory, core::DynamicArray<FilesystemEntry>& entities, const core::String& filter = "", int depth = 0, core::ThreadPool* threadPool = nullptr) const;
 
 	io::FilePtr open(const core::String& filename, FileMode mode = FileMode::Read) const;
 	io::FilePtr open(const core::Path& path, FileMode mode = FileMode::Read) const {
@@ -8,6 +8,8 @@
 #include "io/File.h"
 #include "io/FileStream.h"
 #include "io/Filesystem.h"
+#include "io/MemoryMappedReadStream.h"
+#include "io/ReadAheadStream.h"
 
 namespace io {
 
@@ -19,6 +21,14 @@ FilesystemArchive::~FilesystemArchive() {
 	FilesystemArchive::shutdown();
 }
 
+void FilesystemArchive::setMemoryMappedThreshold(int64_t bytes) {
+	_memoryMappedThreshold = bytes;
+}
+
+void FilesystemArchive::setReadAheadThreshold(int64_t bytes) {
+	_readAheadThreshold = bytes;
+}
+
 bool FilesystemArchive::init(const core::String &path, io::SeekableReadStream *stream) {
 	return add(path);
 }
@@ -61,8 +71,19 @@ SeekableReadStream *FilesystemArchive::readStream(const core::String &filePath)
 		Log::error("Could not open file %s for reading: %s", file->name().c_str(), file->lastError().c_str());
 		return nullptr;
 	}
+	if (_memoryMappedThreshold >= 0 && file->length() >= _memoryMappedThreshold) {
+		io::MemoryMappedReadStream *stream = new io::MemoryMappedReadStream(file->name());
+		if (stream->valid()) {
+			return stream;
+		}
+		// e.g. the file is not on a real filesystem - fall back to the file stream
+		delete stream;
+	}
 	io::FileStream *stream = new io::FileStream(file);
 	core_assert(stream->valid());
+	if (_readAheadThreshold >= 0 && stream->size() >= _readAheadThreshold) {
+		return new io::ReadAheadStream(stream);
+	}
 	return stream;
 }
 
@@ -77,6 +98,18 @@ SeekableWriteStream *FilesystemArchive::writeStream(const core::String &filePath
 	return stream;
 }
 
+bool FilesystemArchive::remove(const core::String &filePath) {
+	if (_sysmode) {
+		return _filesytem->sysRemoveFile(filePath);
+	}
+	// files are only written into the home directory
+	if (!_filesytem->sysIsRelativePath(filePath)) {
+		Log::error("%s can't get removed", filePath.c_str());
+		return false;
+	}
+	return _filesytem->sysRemoveFile(_filesytem->homeWritePath(filePath));
+}
+
 ArchivePtr openFilesystemArchive(const io::FilesystemPtr &fs, const core::String &path, bool sysmode) {
 	core::SharedPtr<FilesystemArchive> fa = core::make_shared<FilesystemArchive>(fs, sysmode);
 	if (!path.empty() && fs->sysIsReadableDir(path)) {
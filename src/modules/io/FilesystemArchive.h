@@ -10,6 +10,9 @@
 namespace io {
 
 /**
+ * @brief Files that are at least @c MemoryMappedThreshold bytes big are handed out as @c MemoryMappedReadStream. Files
+ * that are at least @c ReadAheadThreshold bytes big and are not memory mapped (e.g. on network shares) are read on a
+ * background thread by a @c ReadAheadStream.
  * @ingroup IO
  */
 class FilesystemArchive : public Archive {
@@ -19,8 +22,13 @@ private:
 protected:
 	io::FilesystemPtr _filesytem;
 	bool _sysmode;
+	int64_t _memoryMappedThreshold = MemoryMappedThreshold;
+	int64_t _readAheadThreshold = ReadAheadThreshold;
 
 public:
+	static constexpr int64_t MemoryMappedThreshold = 1024 * 1024;
+	static constexpr int64_t ReadAheadThreshold = 256 * 1024;
+
 	using Archive::list;
 	FilesystemArchive(const io::FilesystemPtr &filesytem, bool sysmode = true);
 	virtual ~FilesystemArchive();
@@ -30,8 +38,19 @@ public:
 	bool exists(const core::Path &file) const override;
 	void list(const core::String &basePath, ArchiveFiles &out, const core::String &filter) const override;
 
+	/**
+	 * @param[in] bytes The minimum size of a file to get memory mapped for reading - @c -1 disables the mapping
+	 */
+	void setMemoryMappedThreshold(int64_t bytes);
+	/**
+	 * @param[in] bytes The minimum size of a file to get read ahead on a background thread - @c -1 disables the read
+	 * ahead
+	 */
+	void setReadAheadThreshold(int64_t bytes);
+
 	SeekableReadStream *readStream(const core::String &filePath) override;
 	SeekableWriteStream *writeStream(const core::String &filePath) override;
+	bool remove(const core::String &filePath) override;
 };
 
 /**
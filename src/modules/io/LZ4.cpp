@@ -0,0 +1,176 @@
+/**
+ * @file
+ */
+
+#include "LZ4.h"
+#include "core/ArrayLength.h"
+#include "core/StandardLib.h"
+
+namespace io {
+namespace LZ4 {
+
+static constexpr int MinMatch = 4;
+// the last bytes of a block are always literals
+static constexpr int LastLiterals = 5;
+// the last match must start before this amount of bytes to the end of the block
+static constexpr int MatchFindLimit = 12;
+static constexpr int MaxOffset = 65535;
+static constexpr int HashLog = 12;
+static constexpr int RunMask = 15;
+
+static inline uint32_t read32(const uint8_t *ptr) {
+	uint32_t val;
+	core_memcpy(&val, ptr, sizeof(val));
+	return val;
+}
+
+static inline uint32_t hash(uint32_t sequence) {
+	return (sequence * 2654435761u) >> (32 - HashLog);
+}
+
+static inline uint8_t *writeLength(uint8_t *op, size_t length) {
+	while (length >= 255) {
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = (uint8_t)length;
+	return op;
+}
+
+static inline uint8_t *writeLiterals(uint8_t *op, uint8_t *token, const uint8_t *literals, size_t length) {
+	if (length >= RunMask) {
+		*token = RunMask << 4;
+		op = writeLength(op, length - RunMask);
+	} else {
+		*token = (uint8_t)(length << 4);
+	}
+	core_memcpy(op, literals, length);
+	return op + length;
+}
+
+int compress(const uint8_t *src, int srcSize, uint8_t *dst, int dstCapacity) {
+	if (srcSize < 0 || dstCapacity < compressBound(srcSize)) {
+		return -1;
+	}
+	const uint8_t *ip = src;
+	const uint8_t *anchor = src;
+	const uint8_t *const iend = src + srcSize;
+	uint8_t *op = dst;
+	if (srcSize > MatchFindLimit) {
+		const uint8_t *const mflimit = iend - MatchFindLimit;
+		const uint8_t *const matchlimit = iend - LastLiterals;
+		int32_t table[1 << HashLog];
+		for (int i = 0; i < lengthof(table); ++i) {
+			table[i] = -1;
+		}
+		while (ip < mflimit) {
+			const uint32_t sequence = read32(ip);
+			const uint32_t h = hash(sequence);
+			const int32_t ref = table[h];
+			const int32_t current = (int32_t)(ip - src);
+			table[h] = current;
+			if (ref < 0 || current - ref > MaxOffset || read32(src + ref) != sequence) {
+				// skip faster over incompressible data
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+			const uint8_t *match = src + ref;
+			while (ip > anchor && match > src && ip[-1] == match[-1]) {
+				--ip;
+				--match;
+			}
+			const uint8_t *matchEnd = ip + MinMatch;
+			const uint8_t *ref2 = match + MinMatch;
+			while (matchEnd < matchlimit && *matchEnd == *ref2) {
+				++matchEnd;
+				++ref2;
+			}
+			uint8_t *token = op++;
+			op = writeLiterals(op, token, anchor, (size_t)(ip - anchor));
+			const uint32_t offset = (uint32_t)(ip - match);
+			*op++ = (uint8_t)(offset & 0xFF);
+			*op++ = (uint8_t)(offset >> 8);
+			const size_t matchLength = (size_t)(matchEnd - ip) - MinMatch;
+			if (matchLength >= RunMask) {
+				*token |= RunMask;
+				op = writeLength(op, matchLength - RunMask);
+			} else {
+				*token |= (uint8_t)matchLength;
+			}
+			ip = matchEnd;
+			anchor = ip;
+			if (ip < mflimit) {
+				table[hash(read32(ip - 2))] = (int32_t)(ip - 2 - src);
+			}
+		}
+	}
+	uint8_t *token = op++;
+	op = writeLiterals(op, token, anchor, (size_t)(iend - anchor));
+	return (int)(op - dst);
+}
+
+static inline bool readLength(const uint8_t *&ip, const uint8_t *iend, size_t &length) {
+	uint8_t b;
+	do {
+		if (ip >= iend) {
+			return false;
+		}
+		b = *ip++;
+		length += b;
+	} while (b == 255);
+	return true;
+}
+
+int decompress(const uint8_t *src, int srcSize, uint8_t *dst, int dstCapacity) {
+	const uint8_t *ip = src;
+	const uint8_t *const iend = src + srcSize;
+	uint8_t *op = dst;
+	uint8_t *const oend = dst + dstCapacity;
+	while (ip < iend) {
+		const uint8_t token = *ip++;
+		size_t literals = token >> 4;
+		if (literals == RunMask && !readLength(ip, iend, literals)) {
+			return -1;
+		}
+		if (literals > (size_t)(iend - ip) || literals > (size_t)(oend - op)) {
+			return -1;
+		}
+		core_memcpy(op, ip, literals);
+		op += literals;
+		ip += literals;
+		if (ip >= iend) {
+			// the last sequence only has literals
+			break;
+		}
+		if (iend - ip < 2) {
+			return -1;
+		}
+		const size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+		ip += 2;
+		if (offset == 0u || offset > (size_t)(op - dst)) {
+			return -1;
+		}
+		size_t matchLength = token & RunMask;
+		if (matchLength == RunMask && !readLength(ip, iend, matchLength)) {
+			return -1;
+		}
+		matchLength += MinMatch;
+		if (matchLength > (size_t)(oend - op)) {
+			return -1;
+		}
+		const uint8_t *match = op - offset;
+		if (offset >= matchLength) {
+			core_memcpy(op, match, matchLength);
+			op += matchLength;
+		} else {
+			// overlapping copy - repeats the last offset bytes
+			for (size_t i = 0; i < matchLength; ++i) {
+				*op++ = *match++;
+			}
+		}
+	}
+	return (int)(op - dst);
+}
+
+} // namespace LZ4
+} // namespace io
@@ -0,0 +1,40 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace io {
+namespace LZ4 {
+
+/**
+ * @brief The maximum amount of uncompressed bytes in a block of the @c LZ4WriteStream
+ */
+static constexpr int BlockSize = 64 * 1024;
+
+/**
+ * @return The size of the buffer that is needed to compress @c srcSize bytes in the worst case
+ */
+constexpr int compressBound(int srcSize) {
+	return srcSize + srcSize / 255 + 16;
+}
+
+/**
+ * @brief Compress a block into the lz4 block format
+ *
+ * @param dstCapacity Must be at least @c compressBound() of the @c srcSize
+ * @return The amount of compressed bytes or @c -1 on error
+ */
+int compress(const uint8_t *src, int srcSize, uint8_t *dst, int dstCapacity);
+/**
+ * @brief Decompress a block in the lz4 block format
+ *
+ * @return The amount of decompressed bytes or @c -1 if the block is corrupted or doesn't fit into the buffer
+ */
+int decompress(const uint8_t *src, int srcSize, uint8_t *dst, int dstCapacity);
+
+} // namespace LZ4
+} // namespace io
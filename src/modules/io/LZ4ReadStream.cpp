@@ -0,0 +1,88 @@
+/**
+ * @file
+ */
+
+#include "LZ4ReadStream.h"
+#include "LZ4WriteStream.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+
+namespace io {
+
+LZ4ReadStream::LZ4ReadStream(io::SeekableReadStream &readStream, int size)
+	: _readStream(readStream), _size(size), _remaining(size) {
+}
+
+bool LZ4ReadStream::eos() const {
+	return _eos && _outPos >= _outSize;
+}
+
+bool LZ4ReadStream::readBlock() {
+	uint32_t header;
+	if (_readStream.readUInt32(header) != 0) {
+		Log::debug("Failed to read the block header");
+		return false;
+	}
+	if (header == 0u) {
+		_eos = true;
+		return true;
+	}
+	const bool stored = (header & LZ4WriteStream::StoredFlag) != 0u;
+	const uint32_t blockSize = header & ~LZ4WriteStream::StoredFlag;
+	if (blockSize > (stored ? (uint32_t)sizeof(_out) : (uint32_t)sizeof(_in))) {
+		Log::debug("Invalid block size %u", blockSize);
+		return false;
+	}
+	if (_size >= 0) {
+		_remaining -= (int)(sizeof(uint32_t) + blockSize);
+		if (_remaining < 0) {
+			Log::debug("Block exceeds the compressed size");
+			return false;
+		}
+	}
+	uint8_t *target = stored ? _out : _in;
+	if (_readStream.read(target, blockSize) != (int)blockSize) {
+		Log::debug("Failed to read the block");
+		return false;
+	}
+	if (stored) {
+		_outSize = (int)blockSize;
+	} else {
+		_outSize = LZ4::decompress(_in, (int)blockSize, _out, sizeof(_out));
+		if (_outSize < 0) {
+			Log::debug("Failed to decompress the block");
+			return false;
+		}
+	}
+	_outPos = 0;
+	return true;
+}
+
+int LZ4ReadStream::read(void *buf, size_t size) {
+	if (_err) {
+		return -1;
+	}
+	uint8_t *targetPtr = (uint8_t *)buf;
+	size_t readCnt = 0;
+	while (size > 0) {
+		if (_outPos >= _outSize) {
+			if (_eos) {
+				break;
+			}
+			if (!readBlock()) {
+				_err = true;
+				return -1;
+			}
+			continue;
+		}
+		const size_t n = core_min(size, (size_t)(_outSize - _outPos));
+		core_memcpy(targetPtr, _out + _outPos, n);
+		_outPos += (int)n;
+		targetPtr += n;
+		readCnt += n;
+		size -= n;
+	}
+	return (int)readCnt;
+}
+
+} // namespace io
@@ -0,0 +1,55 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "LZ4.h"
+#include "Stream.h"
+
+namespace io {
+
+/**
+ * @see LZ4WriteStream
+ * @ingroup IO
+ */
+class LZ4ReadStream : public io::ReadStream {
+private:
+	io::SeekableReadStream &_readStream;
+	uint8_t _in[LZ4::compressBound(LZ4::BlockSize)];
+	uint8_t _out[LZ4::BlockSize];
+	int _outPos = 0;
+	int _outSize = 0;
+	const int _size;
+	int _remaining;
+	bool _eos = false;
+	bool _err = false;
+
+	bool readBlock();
+
+public:
+	/**
+	 * @param size The compressed size - the stream doesn't read beyond the end marker if this is @c -1
+	 */
+	LZ4ReadStream(io::SeekableReadStream &readStream, int size = -1);
+	virtual ~LZ4ReadStream() = default;
+
+	/**
+	 * @brief Read an arbitrary sized amount of bytes from the input stream
+	 *
+	 * @param dataPtr The target data buffer
+	 * @param dataSize The size of the target data buffer
+	 * @return The amount of read bytes or @c -1 on error
+	 */
+	int read(void *dataPtr, size_t dataSize) override;
+	/**
+	 * @return @c true if the end of the compressed stream was found
+	 */
+	bool eos() const override;
+
+	bool err() const {
+		return _err;
+	}
+};
+
+} // namespace io
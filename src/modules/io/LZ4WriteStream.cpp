@@ -0,0 +1,67 @@
+/**
+ * @file
+ */
+
+#include "LZ4WriteStream.h"
+#include "core/StandardLib.h"
+
+namespace io {
+
+LZ4WriteStream::LZ4WriteStream(io::WriteStream &outStream) : _outStream(outStream) {
+}
+
+LZ4WriteStream::~LZ4WriteStream() {
+	LZ4WriteStream::flush();
+}
+
+bool LZ4WriteStream::writeBlock() {
+	const int compressed = LZ4::compress(_in, _inSize, _out, sizeof(_out));
+	const bool stored = compressed < 0 || compressed >= _inSize;
+	const uint32_t blockSize = stored ? (uint32_t)_inSize : (uint32_t)compressed;
+	if (!_outStream.writeUInt32(stored ? (blockSize | StoredFlag) : blockSize)) {
+		return false;
+	}
+	const uint8_t *data = stored ? _in : _out;
+	if (_outStream.write(data, blockSize) != (int)blockSize) {
+		return false;
+	}
+	_pos += sizeof(uint32_t) + blockSize;
+	_inSize = 0;
+	return true;
+}
+
+int LZ4WriteStream::write(const void *buf, size_t size) {
+	if (_finished) {
+		return -1;
+	}
+	const uint8_t *in = (const uint8_t *)buf;
+	const int64_t pos = _pos;
+	while (size > 0) {
+		const size_t n = core_min(size, (size_t)(LZ4::BlockSize - _inSize));
+		core_memcpy(_in + _inSize, in, n);
+		_inSize += (int)n;
+		in += n;
+		size -= n;
+		if (_inSize == LZ4::BlockSize && !writeBlock()) {
+			return -1;
+		}
+	}
+	return (int)(_pos - pos);
+}
+
+bool LZ4WriteStream::flush() {
+	if (_finished) {
+		return true;
+	}
+	_finished = true;
+	if (_inSize > 0 && !writeBlock()) {
+		return false;
+	}
+	if (!_outStream.writeUInt32(0u)) {
+		return false;
+	}
+	_pos += sizeof(uint32_t);
+	return true;
+}
+
+} // namespace io
@@ -0,0 +1,75 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "LZ4.h"
+#include "Stream.h"
+
+namespace io {
+
+/**
+ * @brief Fast compression for data that is only read by us again - like undo states or caches
+ *
+ * The data is split into blocks of @c LZ4::BlockSize bytes that are compressed in the lz4 block format. Each block
+ * starts with a 4 byte size - the highest bit is set if the block is stored uncompressed because it's not
+ * compressible. A size of @c 0 marks the end of the stream.
+ *
+ * @note This is not the lz4 frame format - use zlib (@c ZipWriteStream) for data that is exchanged with other
+ * applications.
+ * @see LZ4ReadStream
+ * @see ZipWriteStream
+ * @ingroup IO
+ */
+class LZ4WriteStream : public io::WriteStream {
+private:
+	io::WriteStream &_outStream;
+	uint8_t _in[LZ4::BlockSize];
+	uint8_t _out[LZ4::compressBound(LZ4::BlockSize)];
+	int _inSize = 0;
+	int64_t _pos = 0;
+	bool _finished = false;
+
+	bool writeBlock();
+
+public:
+	static constexpr uint32_t StoredFlag = 1u << 31u;
+
+	/**
+	 * @param outStream The buffer that receives the writes for the compressed data.
+	 */
+	LZ4WriteStream(io::WriteStream &outStream);
+	virtual ~LZ4WriteStream();
+
+	/**
+	 * @return @c -1 on error - otherwise the amount of bytes that were written to the output stream.
+	 * @note The data is written in blocks - the last block is written by @c flush()
+	 */
+	int write(const void *buf, size_t size) override;
+	/**
+	 * @brief Returns the compressed written bytes that went into the given output stream
+	 */
+	int64_t pos() const;
+	/**
+	 * @brief Returns the compressed written bytes that went into the given output stream
+	 */
+	int64_t size() const;
+
+	/**
+	 * @brief Writes the pending block and the end of the stream - no further writes are possible
+	 *
+	 * @note This method is automatically called in the destructor
+	 */
+	bool flush() override;
+};
+
+inline int64_t LZ4WriteStream::pos() const {
+	return _pos;
+}
+
+inline int64_t LZ4WriteStream::size() const {
+	return _pos;
+}
+
+} // namespace io
@@ -3,30 +3,74 @@
  */
 
 #include "LZFSEReadStream.h"
+#include "core/Common.h"
+#include "core/Log.h"
 #include "core/StandardLib.h"
 #include "io/BufferedReadWriteStream.h"
 #include "lzfse.h"
 
 namespace io {
 
+namespace priv {
+
+/**
+ * The decoder state of lzfse is quite big - it is allocated once per thread instead of once per decoded buffer
+ */
+class LZFSEScratchBuffer {
+private:
+	void *_buf = nullptr;
+
+public:
+	~LZFSEScratchBuffer() {
+		core_free(_buf);
+	}
+
+	void *get() {
+		if (_buf == nullptr) {
+			_buf = core_malloc(lzfse_decode_scratch_size());
+		}
+		return _buf;
+	}
+};
+
+static thread_local LZFSEScratchBuffer lzfseScratchBuffer;
+
+} // namespace priv
+
+int64_t LZFSEReadStream::decompressInto(const void *src, size_t srcSize, void *dst, size_t dstSize) {
+	const size_t extractedSize = lzfse_decode_buffer((uint8_t *)dst, dstSize, (const uint8_t *)src, srcSize,
+													 priv::lzfseScratchBuffer.get());
+	if (extractedSize == 0 && srcSize > 0) {
+		// this is also returned for an empty stream
+		const uint8_t *in = (const uint8_t *)src;
+		if (srcSize >= 4 && in[0] == 'b' && in[1] == 'v' && in[2] == 'x' && in[3] == '$') {
+			return 0;
+		}
+		return -1;
+	}
+	return (int64_t)extractedSize;
+}
+
 LZFSEReadStream::LZFSEReadStream(io::SeekableReadStream &readStream, int size) {
-	// there is no streaming interface in lzfse, so we need to read the whole stream into memory
 	BufferedReadWriteStream s(readStream, size <= 0 ? readStream.remaining() : size);
-	size_t extractedBufferSize = 10 * s.size();
-	void *auxBuffer = core_malloc(lzfse_decode_scratch_size());
+	size_t extractedBufferSize = core_max((size_t)10 * (size_t)s.size(), (size_t)1024);
 	_extractedBuffer = (uint8_t *)core_malloc(extractedBufferSize);
-	size_t extractedSize = 0;
+	int64_t extractedSize = 0;
 	while (1) {
-		extractedSize = lzfse_decode_buffer(_extractedBuffer, extractedBufferSize, s.getBuffer(), s.size(), auxBuffer);
-		if (extractedSize == 0 || extractedSize == extractedBufferSize) {
+		extractedSize = decompressInto(s.getBuffer(), s.size(), _extractedBuffer, extractedBufferSize);
+		if (extractedSize == (int64_t)extractedBufferSize) {
+			// the output was truncated
 			extractedBufferSize <<= 1;
 			_extractedBuffer = (uint8_t *)core_realloc(_extractedBuffer, extractedBufferSize);
 			continue;
 		}
 		break;
 	}
+	if (extractedSize < 0) {
+		Log::error("Failed to decode the lzfse stream");
+		extractedSize = 0;
+	}
 	_readStream = new MemoryReadStream(_extractedBuffer, extractedSize);
-	core_free(auxBuffer);
 }
 
 LZFSEReadStream::~LZFSEReadStream() {
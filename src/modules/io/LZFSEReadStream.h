@@ -10,6 +10,9 @@
 namespace io {
 
 /**
+ * There is no streaming interface in lzfse - the whole stream is decoded into memory in the constructor. The decoder
+ * state is kept in a thread local scratch buffer that is shared by all streams of a thread.
+ *
  * @ingroup IO
  */
 class LZFSEReadStream : public io::SeekableReadStream {
@@ -42,6 +45,20 @@ public:
 	int64_t seek(int64_t position, int whence = SEEK_SET) override;
 	int64_t size() const override;
 	int64_t pos() const override;
+
+	/**
+	 * @brief Decodes the lzfse compressed buffer in one go into the given target buffer
+	 *
+	 * Use this if the uncompressed size is known - the data is decoded directly into the target buffer.
+	 *
+	 * @param[in] src The compressed data
+	 * @param[in] srcSize The size of the compressed data
+	 * @param[out] dst The target buffer for the uncompressed data
+	 * @param[in] dstSize The size of the target buffer
+	 * @return The amount of bytes written to @c dst or @c -1 on error. If the returned value is equal to @c dstSize
+	 * the output might have been truncated.
+	 */
+	static int64_t decompressInto(const void *src, size_t srcSize, void *dst, size_t dstSize);
 };
 
 } // namespace io
@@ -3,6 +3,7 @@
  */
 
 #include "MemoryArchive.h"
+#include "core/StringUtil.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/MemoryReadStream.h"
 #include "io/Stream.h"
@@ -39,10 +40,31 @@ bool MemoryArchive::remove(const core::String &name) {
 	if (iter == _entries.end()) {
 		return false;
 	}
+	delete iter->second;
 	_entries.erase(iter);
 	return true;
 }
 
+bool MemoryArchive::exists(const core::String &file) const {
+	return _entries.hasKey(file);
+}
+
+void MemoryArchive::list(const core::String &basePath, ArchiveFiles &out, const core::String &filter) const {
+	for (auto iter = _entries.begin(); iter != _entries.end(); ++iter) {
+		if (!basePath.empty() && !core::string::startsWith(iter->key, basePath)) {
+			continue;
+		}
+		FilesystemEntry entry;
+		entry.fullPath = iter->key;
+		entry.name = core::string::extractFilenameWithExtension(iter->key);
+		entry.type = FilesystemEntry::Type::file;
+		entry.size = iter->value->size();
+		if (core::string::fileMatchesMultiple(entry.name.c_str(), filter.c_str())) {
+			out.push_back(entry);
+		}
+	}
+}
+
 SeekableWriteStream *MemoryArchive::writeStream(const core::String &filePath) {
 	auto iter = _entries.find(filePath);
 	if (iter == _entries.end()) {
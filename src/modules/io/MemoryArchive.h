@@ -24,11 +24,15 @@ private:
 	core::StringMap<BufferedReadWriteStream *> _entries;
 
 public:
+	using Archive::exists;
+	using Archive::list;
 	virtual ~MemoryArchive();
 	bool init(const core::String &path, io::SeekableReadStream *stream) override;
 	void shutdown() override;
 	bool add(const core::String &name, const uint8_t *data, size_t size);
-	bool remove(const core::String &name);
+	bool remove(const core::String &name) override;
+	bool exists(const core::String &file) const override;
+	void list(const core::String &basePath, ArchiveFiles &out, const core::String &filter) const override;
 	SeekableReadStream *readStream(const core::String &filePath) override;
 	SeekableWriteStream *writeStream(const core::String &filePath) override;
 };
@@ -0,0 +1,21 @@
+/**
+ * @file
+ */
+
+#include "MemoryMappedReadStream.h"
+#include "io/system/System.h"
+
+namespace io {
+
+MemoryMappedReadStream::MemoryMappedReadStream(const core::String &path) : Super(nullptr, 0) {
+	size_t size = 0u;
+	_mem = fs_mmap(path.c_str(), size);
+	_buf = (const uint8_t *)_mem;
+	_size = (int64_t)size;
+}
+
+MemoryMappedReadStream::~MemoryMappedReadStream() {
+	fs_munmap(_mem, (size_t)_size);
+}
+
+} // namespace io
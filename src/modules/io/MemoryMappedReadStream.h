@@ -0,0 +1,38 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "io/MemoryReadStream.h"
+
+namespace io {
+
+/**
+ * @brief Maps the whole file read-only into the memory - seeking is free and the bytes can be accessed without a copy
+ *
+ * This is useful for large files that are read with a lot of small reads and seeks. Check @c valid() after
+ * construction - not every file can get mapped (e.g. empty files or files from a virtual filesystem).
+ *
+ * @ingroup IO
+ * @see MemoryReadStream
+ * @see FilesystemArchive
+ */
+class MemoryMappedReadStream : public MemoryReadStream {
+private:
+	using Super = MemoryReadStream;
+	void *_mem = nullptr;
+
+public:
+	MemoryMappedReadStream(const core::String &path);
+	virtual ~MemoryMappedReadStream();
+
+	bool valid() const;
+};
+
+inline bool MemoryMappedReadStream::valid() const {
+	return _mem != nullptr;
+}
+
+} // namespace io
@@ -28,8 +28,18 @@ public:
 	int64_t pos() const override;
 	int read(void *dataPtr, size_t dataSize) override;
 	int64_t seek(int64_t position, int whence = SEEK_SET) override;
+
+	/**
+	 * @brief Access to the bytes of the whole stream without any copy
+	 * @see pos()
+	 */
+	const uint8_t *getBuffer() const;
 };
 
+inline const uint8_t *MemoryReadStream::getBuffer() const {
+	return _ownBuf != nullptr ? _ownBuf : _buf;
+}
+
 inline int64_t MemoryReadStream::size() const {
 	return _size;
 }
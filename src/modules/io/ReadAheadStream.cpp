@@ -0,0 +1,148 @@
+/**
+ * @file
+ */
+
+#include "ReadAheadStream.h"
+#include "core/StandardLib.h"
+#include "core/concurrent/Thread.h"
+
+namespace io {
+
+ReadAheadStream::ReadAheadStream(SeekableReadStream *stream, int frameSize)
+	: _stream(stream), _frameSize(frameSize > 0 ? (size_t)frameSize : 1u), _size(stream->size()),
+	  _currentOffset(stream->pos()) {
+	_frames[0] = (uint8_t *)core_malloc(_frameSize);
+	_frames[1] = (uint8_t *)core_malloc(_frameSize);
+	{
+		core::ScopedLock lock(_lock);
+		request(_currentOffset);
+	}
+	_thread = new core::Thread("ReadAhead", run, this);
+}
+
+ReadAheadStream::~ReadAheadStream() {
+	{
+		core::ScopedLock lock(_lock);
+		_quit = true;
+		_conditionVariable.notify_all();
+	}
+	// waits for the thread
+	delete _thread;
+	delete _stream;
+	core_free(_frames[0]);
+	core_free(_frames[1]);
+}
+
+int ReadAheadStream::run(void *data) {
+	ReadAheadStream *self = (ReadAheadStream *)data;
+	self->readAhead();
+	return 0;
+}
+
+void ReadAheadStream::readAhead() {
+	for (;;) {
+		int64_t offset;
+		uint8_t *frame;
+		{
+			core::ScopedLock lock(_lock);
+			_conditionVariable.wait(_lock, [this]() { return _quit || _requestOffset >= 0; });
+			if (_quit) {
+				return;
+			}
+			offset = _requestOffset;
+			_requestOffset = -1;
+			frame = _frames[1 - _current];
+		}
+		int bytes = -1;
+		if (_stream->seek(offset) != -1) {
+			bytes = _stream->read(frame, _frameSize);
+		}
+		core::ScopedLock lock(_lock);
+		_readyOffset = offset;
+		_readySize = bytes;
+		_ready = true;
+		_pending = false;
+		_conditionVariable.notify_all();
+	}
+}
+
+void ReadAheadStream::request(int64_t offset) {
+	_requestOffset = offset;
+	_pending = true;
+	_ready = false;
+	_conditionVariable.notify_all();
+}
+
+bool ReadAheadStream::nextFrame(int64_t offset) {
+	core::ScopedLock lock(_lock);
+	_conditionVariable.wait(_lock, [this]() { return !_pending; });
+	if (!_ready || _readyOffset != offset) {
+		// the read ahead frame doesn't match - e.g. because of a seek
+		request(offset);
+		_conditionVariable.wait(_lock, [this]() { return !_pending; });
+	}
+	_ready = false;
+	_current = 1 - _current;
+	_currentOffset = offset;
+	_currentPos = 0u;
+	_currentSize = _readySize > 0 ? (size_t)_readySize : 0u;
+	if (_currentSize == 0u) {
+		return false;
+	}
+	const int64_t nextOffset = offset + (int64_t)_currentSize;
+	if (nextOffset < _size) {
+		request(nextOffset);
+	}
+	return true;
+}
+
+int ReadAheadStream::read(void *dataPtr, size_t dataSize) {
+	uint8_t *out = (uint8_t *)dataPtr;
+	size_t remaining = dataSize;
+	while (remaining > 0u) {
+		if (_currentPos >= _currentSize) {
+			if (!nextFrame(_currentOffset + (int64_t)_currentSize)) {
+				break;
+			}
+		}
+		const size_t available = core_min(_currentSize - _currentPos, remaining);
+		core_memcpy(out, _frames[_current] + _currentPos, available);
+		_currentPos += available;
+		out += available;
+		remaining -= available;
+	}
+	if (remaining == dataSize && dataSize > 0u) {
+		return -1;
+	}
+	return (int)(dataSize - remaining);
+}
+
+int64_t ReadAheadStream::seek(int64_t position, int whence) {
+	int64_t newPos;
+	switch (whence) {
+	case SEEK_SET:
+		newPos = position;
+		break;
+	case SEEK_CUR:
+		newPos = pos() + position;
+		break;
+	case SEEK_END:
+		newPos = _size + position;
+		break;
+	default:
+		return -1;
+	}
+	if (newPos < 0 || newPos > _size) {
+		return -1;
+	}
+	if (newPos >= _currentOffset && newPos <= _currentOffset + (int64_t)_currentSize) {
+		_currentPos = (size_t)(newPos - _currentOffset);
+		return newPos;
+	}
+	// the next read fetches the frame at the new position
+	_currentOffset = newPos;
+	_currentPos = _currentSize = 0u;
+	return newPos;
+}
+
+} // namespace io
@@ -0,0 +1,87 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Stream.h"
+#include "core/Trace.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+
+namespace core {
+class Thread;
+}
+
+namespace io {
+
+/**
+ * @brief Reads the wrapped stream on a background thread. While the caller decodes the current frame, the next frame
+ * of the stream is already read - this overlaps the (slow) disk or network reads with the decoding of the data.
+ *
+ * Sequential reads profit most. A seek outside of the current frame drops the read ahead frame if it doesn't match the
+ * new position.
+ *
+ * @note The wrapped stream is owned by this instance and only accessed from the read ahead thread
+ * @ingroup IO
+ */
+class ReadAheadStream : public SeekableReadStream {
+private:
+	SeekableReadStream *_stream;
+	const size_t _frameSize;
+	const int64_t _size;
+	uint8_t *_frames[2];
+
+	// the frame that the caller reads from - only touched by the reading thread
+	int _current = 0;
+	size_t _currentSize = 0u;
+	size_t _currentPos = 0u;
+	int64_t _currentOffset;
+
+	// the state that is shared with the read ahead thread
+	core_trace_mutex(core::Lock, _lock, "ReadAheadStream");
+	core::ConditionVariable _conditionVariable;
+	int64_t _requestOffset = -1;
+	int64_t _readyOffset = -1;
+	int _readySize = 0;
+	bool _pending = false;
+	bool _ready = false;
+	bool _quit = false;
+	core::Thread *_thread;
+
+	static int run(void *data);
+	void readAhead();
+	/**
+	 * @brief Asks the read ahead thread to read the frame at the given offset into the frame that is not the current one
+	 * @note The lock must be held
+	 */
+	void request(int64_t offset);
+	/**
+	 * @brief Makes the frame at the given offset the current one
+	 * @return @c false if no byte could be read at the given offset
+	 */
+	bool nextFrame(int64_t offset);
+
+public:
+	/**
+	 * @param[in] stream The stream to read from - the ownership is transferred to this instance
+	 * @param[in] frameSize The amount of bytes that are read ahead at once
+	 */
+	ReadAheadStream(SeekableReadStream *stream, int frameSize = 256 * 1024);
+	virtual ~ReadAheadStream();
+
+	int read(void *dataPtr, size_t dataSize) override;
+	int64_t seek(int64_t position, int whence = SEEK_SET) override;
+	int64_t size() const override;
+	int64_t pos() const override;
+};
+
+inline int64_t ReadAheadStream::size() const {
+	return _size;
+}
+
+inline int64_t ReadAheadStream::pos() const {
+	return _currentOffset + (int64_t)_currentPos;
+}
+
+} // namespace io
@@ -7,9 +7,12 @@
 #include "core/Common.h"
 #include "core/String.h"
 #include "core/NonCopyable.h"
+#include "core/Endian.h"
 #include <stdio.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+#include <type_traits>
 
 /**
  * @defgroup IO IO
@@ -22,6 +25,34 @@ class String;
 
 namespace io {
 
+namespace priv {
+
+/**
+ * @brief Converts a little or big endian encoded value into the native byte order
+ */
+template<typename TYPE, bool BigEndian>
+inline TYPE swapEndian(TYPE val) {
+	if constexpr (sizeof(TYPE) == 2) {
+		uint16_t v;
+		memcpy(&v, &val, sizeof(v));
+		v = BigEndian ? core_swap16be(v) : core_swap16le(v);
+		memcpy(&val, &v, sizeof(v));
+	} else if constexpr (sizeof(TYPE) == 4) {
+		uint32_t v;
+		memcpy(&v, &val, sizeof(v));
+		v = BigEndian ? core_swap32be(v) : core_swap32le(v);
+		memcpy(&val, &v, sizeof(v));
+	} else if constexpr (sizeof(TYPE) == 8) {
+		uint64_t v;
+		memcpy(&v, &val, sizeof(v));
+		v = BigEndian ? core_swap64be(v) : core_swap64le(v);
+		memcpy(&val, &v, sizeof(v));
+	}
+	return val;
+}
+
+} // namespace priv
+
 /**
  * @ingroup IO
  */
@@ -120,6 +151,19 @@ public:
 	 * @return -1 on error - 0 on success
 	 */
 	int readDoubleBE(double &val);
+	/**
+	 * @brief Reads @c amount little endian values with one @c read() call - the values are converted into the
+	 * native byte order in bulk
+	 * @return -1 on error - 0 on success
+	 */
+	template<typename TYPE>
+	int readArray(TYPE *values, size_t amount);
+	/**
+	 * @brief Big endian version of @c readArray()
+	 * @return -1 on error - 0 on success
+	 */
+	template<typename TYPE>
+	int readArrayBE(TYPE *values, size_t amount);
 	/**
 	 * @brief Read a fixed-width string from a file. It may be null-terminated, but
 	 * the position of the stream is still advanced by the given length
@@ -155,6 +199,42 @@ public:
 	bool readUTF16BE(uint16_t characters, core::String &str);
 };
 
+template<typename TYPE>
+int ReadStream::readArray(TYPE *values, size_t amount) {
+	static_assert(std::is_arithmetic<TYPE>::value, "Only arithmetic types can be read as array");
+	if (amount == 0u) {
+		return 0;
+	}
+	const size_t bytes = amount * sizeof(TYPE);
+	if (read(values, bytes) != (int)bytes) {
+		return -1;
+	}
+	if constexpr (sizeof(TYPE) > 1 && CORE_LITTLE_ENDIAN == 0) {
+		for (size_t i = 0; i < amount; ++i) {
+			values[i] = priv::swapEndian<TYPE, false>(values[i]);
+		}
+	}
+	return 0;
+}
+
+template<typename TYPE>
+int ReadStream::readArrayBE(TYPE *values, size_t amount) {
+	static_assert(std::is_arithmetic<TYPE>::value, "Only arithmetic types can be read as array");
+	if (amount == 0u) {
+		return 0;
+	}
+	const size_t bytes = amount * sizeof(TYPE);
+	if (read(values, bytes) != (int)bytes) {
+		return -1;
+	}
+	if constexpr (sizeof(TYPE) > 1 && CORE_LITTLE_ENDIAN == 1) {
+		for (size_t i = 0; i < amount; ++i) {
+			values[i] = priv::swapEndian<TYPE, true>(values[i]);
+		}
+	}
+	return 0;
+}
+
 /**
  * @brief ReadStream with the option to jump back and forth in while reading
  * @ingroup IO
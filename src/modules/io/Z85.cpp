@@ -3,7 +3,6 @@
  */
 
 #include "Z85.h"
-#include "core/ArrayLength.h"
 #include "core/Common.h"
 #include "io/MemoryReadStream.h"
 #include "io/Stream.h"
@@ -13,114 +12,139 @@ namespace Z85 {
 namespace _priv {
 
 // Z85 encoding table
-static const uint8_t LUT[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', 'g',
+static constexpr uint8_t LUT[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', 'g',
 							  'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x',
 							  'y', 'z', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O',
 							  'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', '.', '-', ':', '+', '=', '^',
 							  '!', '/', '*', '?', '&', '<', '>', '(', ')', '[', ']', '{', '}', '@', '%', '$', '#'};
 
+// Z85 decoding table (reverse LUT) - 0xff for characters that are not part of the alphabet
+struct ReverseLUT {
+	uint8_t values[256];
+	constexpr ReverseLUT() : values() {
+		for (int i = 0; i < 256; ++i) {
+			values[i] = 0xff;
+		}
+		for (int i = 0; i < 85; ++i) {
+			values[LUT[i]] = (uint8_t)i;
+		}
+	}
+};
+static constexpr ReverseLUT REV_LUT{};
+
+// the amount of 4 byte chunks that are encoded or decoded at once
+static constexpr size_t BlockChunks = 1024;
+
 // Encode a 4-byte chunk into a 5-character Z85 string
-static CORE_FORCE_INLINE void encodeChunk(const uint8_t src[4], core::String &out) {
-	uint32_t value = (src[0] << 24) | (src[1] << 16) | (src[2] << 8) | src[3];
-	char dest[5];
+static CORE_FORCE_INLINE void encodeChunk(const uint8_t src[4], uint8_t dest[5]) {
+	uint32_t value = ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | (uint32_t)src[3];
 	for (int i = 4; i >= 0; --i) {
 		dest[i] = LUT[value % 85];
 		value /= 85;
 	}
-	out.append(dest, 5);
+}
+
+// Decode a 5-character Z85 string into a 4-byte chunk
+static CORE_FORCE_INLINE bool decodeChunk(const uint8_t src[5], uint8_t dest[4]) {
+	uint32_t value = 0;
+	for (int i = 0; i < 5; ++i) {
+		const uint8_t idx = REV_LUT.values[src[i]];
+		if (idx == 0xff) {
+			return false; // Invalid character in input
+		}
+		value = value * 85 + idx;
+	}
+	dest[0] = (uint8_t)((value >> 24) & 0xFF);
+	dest[1] = (uint8_t)((value >> 16) & 0xFF);
+	dest[2] = (uint8_t)((value >> 8) & 0xFF);
+	dest[3] = (uint8_t)(value & 0xFF);
+	return true;
 }
 
 } // namespace _priv
 
 core::String encode(io::ReadStream &stream) {
 	core::String out;
-	uint8_t source[4];
-	int bytes = 0;
+	uint8_t source[4 * _priv::BlockChunks];
+	uint8_t dest[5 * _priv::BlockChunks];
 
+	// the bytes of an incomplete chunk are kept at the beginning of the source buffer for the next read
+	size_t bytes = 0;
 	while (!stream.eos()) {
-		uint8_t val = 0;
-		if (stream.readUInt8(val) != 0) {
+		const int n = stream.read(source + bytes, sizeof(source) - bytes);
+		if (n < 0) {
 			return ""; // Error reading input
 		}
-		source[bytes++] = val;
-
-		if (bytes == 4) {
-			_priv::encodeChunk(source, out);
-			bytes = 0;
+		if (n == 0) {
+			break;
+		}
+		bytes += (size_t)n;
+		const size_t chunks = bytes / 4;
+		for (size_t i = 0; i < chunks; ++i) {
+			_priv::encodeChunk(source + i * 4, dest + i * 5);
+		}
+		out.append((const char *)dest, chunks * 5);
+		const size_t encoded = chunks * 4;
+		bytes -= encoded;
+		for (size_t i = 0; i < bytes; ++i) {
+			source[i] = source[encoded + i];
 		}
 	}
 
 	// Handle padding (input size not divisible by 4)
 	if (bytes > 0) {
-		for (int i = bytes; i < 4; ++i) {
+		for (size_t i = bytes; i < 4; ++i) {
 			source[i] = 0; // Pad with zero bytes
 		}
-		_priv::encodeChunk(source, out);
-		out = out.substr(0, out.size() - (4 - bytes)); // Remove padding characters
+		_priv::encodeChunk(source, dest);
+		out.append((const char *)dest, 5 - (4 - bytes)); // Remove padding characters
 	}
 
 	return out;
 }
 
 bool decode(io::WriteStream &stream, io::ReadStream &input) {
-	uint8_t source[5];
-	int bytes = 0;
-
-	// Z85 decoding table (reverse LUT)
-	int32_t REV_LUT[256];
-
-	// Initialize the reverse LUT
-	for (int i = 0; i < lengthof(REV_LUT); ++i) {
-		REV_LUT[i] = -1;
-	}
-	for (int i = 0; i < lengthof(_priv::LUT); ++i) {
-		REV_LUT[_priv::LUT[i]] = i;
-	}
+	uint8_t source[5 * _priv::BlockChunks];
+	uint8_t dest[4 * _priv::BlockChunks];
 
-	// Main loop: Process complete 5-character chunks
+	// Main loop: Process complete 5-character chunks - the characters of an incomplete chunk are kept at the
+	// beginning of the source buffer for the next read
+	size_t bytes = 0;
 	while (!input.eos()) {
-		uint8_t val = 0;
-		if (input.readUInt8(val) == -1) {
+		const int n = input.read(source + bytes, sizeof(source) - bytes);
+		if (n < 0) {
 			return false; // Error reading input
 		}
-		source[bytes++] = val;
-
-		if (bytes == 5) {
-			// Decode a 5-character Z85 string into a 4-byte chunk
-			uint32_t value = 0;
-			for (int i = 0; i < 5; ++i) {
-				int32_t idx = REV_LUT[source[i]];
-				if (idx == -1) {
-					return false; // Invalid character in input
-				}
-				value = value * 85 + idx;
-			}
-			uint8_t dest[4] = {(uint8_t)((value >> 24) & 0xFF), (uint8_t)((value >> 16) & 0xFF),
-							   (uint8_t)((value >> 8) & 0xFF), (uint8_t)(value & 0xFF)};
-			if (stream.write(dest, 4) == -1) {
-				return false; // Failed to write chunk
+		if (n == 0) {
+			break;
+		}
+		bytes += (size_t)n;
+		const size_t chunks = bytes / 5;
+		for (size_t i = 0; i < chunks; ++i) {
+			if (!_priv::decodeChunk(source + i * 5, dest + i * 4)) {
+				return false;
 			}
-			bytes = 0; // Reset counter after processing chunk
+		}
+		if (chunks > 0 && stream.write(dest, chunks * 4) == -1) {
+			return false; // Failed to write chunk
+		}
+		const size_t decoded = chunks * 5;
+		bytes -= decoded;
+		for (size_t i = 0; i < bytes; ++i) {
+			source[i] = source[decoded + i];
 		}
 	}
 
 	// Handle remaining bytes (input size not divisible by 5)
 	if (bytes > 0) {
-		for (int i = bytes; i < 5; ++i) {
+		for (size_t i = bytes; i < 5; ++i) {
 			source[i] = 'u'; // 'u' maps to 0 in Z85, padding the incomplete chunk
 		}
 
 		// Decode padded chunk
-		uint32_t value = 0;
-		for (int i = 0; i < 5; ++i) {
-			int32_t idx = REV_LUT[source[i]];
-			if (idx == -1) {
-				return false; // Invalid character in input
-			}
-			value = value * 85 + idx;
+		if (!_priv::decodeChunk(source, dest)) {
+			return false;
 		}
-		uint8_t dest[4] = {(uint8_t)((value >> 24) & 0xFF), (uint8_t)((value >> 16) & 0xFF),
-						   (uint8_t)((value >> 8) & 0xFF), (uint8_t)(value & 0xFF)};
 		if (stream.write(dest, bytes - 1) == -1) { // Write only the original bytes (exclude padding)
 			return false;
 		}
@@ -6,6 +6,9 @@
 #include "core/Log.h"
 #include "core/StandardLib.h"
 #include "core/StringUtil.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/external/miniz.h"
 #include "io/Stream.h"
@@ -58,6 +61,19 @@ static void *ziparchive_realloc(void *opaque, void *address, size_t items, size_
 	return core_realloc(address, items * size);
 }
 
+static BufferedReadWriteStream *ziparchive_extract(mz_zip_archive *zip, mz_uint fileIndex) {
+	BufferedReadWriteStream *stream = new BufferedReadWriteStream();
+	if (!mz_zip_reader_extract_to_callback(zip, fileIndex, ziparchive_write, stream, 0)) {
+		const mz_zip_error error = mz_zip_get_last_error(zip);
+		const char *err = mz_zip_get_error_string(error);
+		Log::error("Failed to extract file %u from zip: %s", fileIndex, err);
+		delete stream;
+		return nullptr;
+	}
+	stream->seek(0);
+	return stream;
+}
+
 ZipArchive::ZipArchive() {
 }
 
@@ -70,6 +86,15 @@ void ZipArchive::shutdown() {
 }
 
 void ZipArchive::reset() {
+	{
+		core::ScopedLock lock(_prefetchLock);
+		for (const auto &e : _prefetched) {
+			delete e->second;
+		}
+		_prefetched.clear();
+	}
+	_index.clear();
+	_stream = nullptr;
 	if (_zip == nullptr) {
 		return;
 	}
@@ -113,8 +138,14 @@ bool ZipArchive::init(const core::String &path, io::SeekableReadStream *stream)
 	zip->m_pAlloc = ziparchive_malloc;
 	zip->m_pRealloc = ziparchive_realloc;
 	zip->m_pFree = ziparchive_free;
-	zip->m_pRead = ziparchive_read;
-	zip->m_pIO_opaque = stream;
+	// the entries might get extracted from several threads - serialize the access to the stream
+	zip->m_pRead = [](void *userdata, mz_uint64 offset, void *targetBuf, size_t targetBufSize) -> size_t {
+		ZipArchive *archive = (ZipArchive *)userdata;
+		core::ScopedLock lock(archive->_streamLock);
+		return ziparchive_read(archive->_stream, offset, targetBuf, targetBufSize);
+	};
+	zip->m_pIO_opaque = this;
+	_stream = stream;
 	_files.clear();
 	int64_t size = stream->size();
 	if (!mz_zip_reader_init(zip, size, 0)) {
@@ -144,6 +175,7 @@ bool ZipArchive::init(const core::String &path, io::SeekableReadStream *stream)
 		entry.type = FilesystemEntry::Type::file;
 		entry.size = zipStat.m_uncomp_size;
 		entry.mtime = zipStat.m_time;
+		_index.put(entry.fullPath.toLower(), i);
 		_files.emplace_back(core::move(entry));
 	}
 	_files.sort([](const io::FilesystemEntry &a, const io::FilesystemEntry &b) { return a.name < b.name; });
@@ -151,11 +183,33 @@ bool ZipArchive::init(const core::String &path, io::SeekableReadStream *stream)
 	return true;
 }
 
+int64_t ZipArchive::fileIndex(const core::String &filePath) const {
+	uint32_t fileIndex;
+	if (!_index.get(filePath.toLower(), fileIndex)) {
+		return -1;
+	}
+	return fileIndex;
+}
+
 SeekableReadStream* ZipArchive::readStream(const core::String &filePath) {
 	if ((mz_zip_archive*)_zip == nullptr) {
 		Log::error("No zip archive loaded");
 		return nullptr;
 	}
+	{
+		core::ScopedLock lock(_prefetchLock);
+		auto iter = _prefetched.find(filePath);
+		if (iter != _prefetched.end()) {
+			BufferedReadWriteStream *stream = iter->second;
+			_prefetched.erase(iter);
+			return stream;
+		}
+	}
+	const int64_t idx = fileIndex(filePath);
+	if (idx >= 0) {
+		return ziparchive_extract((mz_zip_archive *)_zip, (mz_uint)idx);
+	}
+	// not part of the index - e.g. a directory or an encrypted entry - let miniz report the error
 	BufferedReadWriteStream* stream = new BufferedReadWriteStream();
 	if (!mz_zip_reader_extract_file_to_callback((mz_zip_archive*)_zip, filePath.c_str(), ziparchive_write, stream, 0)) {
 		const mz_zip_error error = mz_zip_get_last_error((mz_zip_archive*)_zip);
@@ -168,6 +222,80 @@ SeekableReadStream* ZipArchive::readStream(const core::String &filePath) {
 	return stream;
 }
 
+bool ZipArchive::prefetch(const core::DynamicArray<core::String> &files, core::ThreadPool *threadPool) {
+	if ((mz_zip_archive *)_zip == nullptr) {
+		Log::error("No zip archive loaded");
+		return false;
+	}
+	struct PrefetchState {
+		mz_zip_archive *zip = nullptr;
+		core::DynamicArray<int64_t> indices;
+		core::DynamicArray<BufferedReadWriteStream *> streams;
+		core::AtomicInt next{0};
+		core::AtomicInt done{0};
+		core_trace_mutex(core::Lock, lock, "ZipArchivePrefetchState");
+		core::ConditionVariable finished;
+
+		void run() {
+			const int n = (int)indices.size();
+			for (;;) {
+				const int i = next.increment();
+				if (i >= n) {
+					return;
+				}
+				if (indices[i] >= 0) {
+					streams[i] = ziparchive_extract(zip, (mz_uint)indices[i]);
+				}
+				done.increment();
+				{
+					core::ScopedLock scoped(lock);
+				}
+				finished.notify_all();
+			}
+		}
+	};
+	const int n = (int)files.size();
+	if (n == 0) {
+		return true;
+	}
+	core::SharedPtr<PrefetchState> state = core::make_shared<PrefetchState>();
+	state->zip = (mz_zip_archive *)_zip;
+	state->indices.resize(n);
+	state->streams.resize(n);
+	for (int i = 0; i < n; ++i) {
+		state->indices[i] = fileIndex(files[i]);
+		state->streams[i] = nullptr;
+	}
+	if (threadPool != nullptr && n > 1) {
+		const int workers = core_min(n - 1, (int)threadPool->size());
+		for (int i = 0; i < workers; ++i) {
+			threadPool->schedule([state]() { state->run(); });
+		}
+	}
+	state->run();
+	{
+		core::ScopedLock scoped(state->lock);
+		state->finished.wait(state->lock, [&state, n]() { return (int)state->done == n; });
+	}
+
+	bool success = true;
+	core::ScopedLock lock(_prefetchLock);
+	for (int i = 0; i < n; ++i) {
+		BufferedReadWriteStream *stream = state->streams[i];
+		if (stream == nullptr) {
+			Log::error("Failed to prefetch file '%s' from zip", files[i].c_str());
+			success = false;
+			continue;
+		}
+		auto iter = _prefetched.find(files[i]);
+		if (iter != _prefetched.end()) {
+			delete iter->second;
+		}
+		_prefetched.put(files[i], stream);
+	}
+	return success;
+}
+
 SeekableWriteStream* ZipArchive::writeStream(const core::String &filePath) {
 	// TODO: implement me
 	return nullptr;
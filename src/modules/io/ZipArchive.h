@@ -4,18 +4,43 @@
 
 #pragma once
 
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/StringMap.h"
+#include "core/concurrent/Lock.h"
 #include "io/Archive.h"
 #include "io/Stream.h"
 
+namespace core {
+class ThreadPool;
+}
+
 namespace io {
 
+class BufferedReadWriteStream;
+
 /**
+ * @brief The central directory of the zip file is indexed by the lower case path of the entries on @c init()
+ *
+ * @c readStream() is thread safe - the reads of the zip stream are serialized, the decompression runs in parallel.
  * @ingroup IO
  */
 class ZipArchive : public Archive {
 private:
 	void *_zip = nullptr;
+	io::SeekableReadStream *_stream = nullptr;
+	// serializes the reads of the zip stream
+	core_trace_mutex(core::Lock, _streamLock, "ZipArchiveStream");
+	// the lower case path of the entries to the file index of the central directory
+	core::StringMap<uint32_t, 1031> _index;
+	core_trace_mutex(core::Lock, _prefetchLock, "ZipArchivePrefetch");
+	core::StringMap<BufferedReadWriteStream *, 31> _prefetched;
+
 	void reset();
+	/**
+	 * @return The file index in the central directory or @c -1 if the entry is not part of the index
+	 */
+	int64_t fileIndex(const core::String &filePath) const;
 
 public:
 	ZipArchive();
@@ -25,6 +50,16 @@ public:
 	SeekableReadStream* readStream(const core::String &filePath) override;
 	SeekableWriteStream* writeStream(const core::String &filePath) override;
 
+	/**
+	 * @brief Decompresses the given entries in parallel - the following @c readStream() calls for these entries hand
+	 * out the decompressed data
+	 * @note A prefetched entry is only handed out once
+	 * @param[in] threadPool If this is @c nullptr (or the pool has no threads) the entries are decompressed on the
+	 * calling thread
+	 * @return @c false if one of the entries could not be decompressed
+	 */
+	bool prefetch(const core::DynamicArray<core::String> &files, core::ThreadPool *threadPool);
+
 	bool init(const core::String &path, io::SeekableReadStream *stream) override;
 	void shutdown() override;
 };
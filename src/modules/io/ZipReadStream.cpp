@@ -19,13 +19,100 @@
 
 namespace io {
 
+namespace priv {
+
+struct InflateContext {
+	z_stream stream;
+	int windowBits;
+	uint8_t buf[256 * 1024];
+};
+
+/**
+ * Keeps the inflate states of the closed streams of a thread to reset and reuse them for the next stream instead of
+ * allocating and initializing them again.
+ */
+class InflateContextPool {
+private:
+	static constexpr int MaxContexts = 4;
+	InflateContext *_contexts[MaxContexts];
+	int _count = 0;
+
+	static void destroy(InflateContext *ctx) {
+		inflateEnd(&ctx->stream);
+		core_free(ctx);
+	}
+
+public:
+	~InflateContextPool() {
+		for (int i = 0; i < _count; ++i) {
+			destroy(_contexts[i]);
+		}
+	}
+
+	InflateContext *acquire(int windowBits) {
+		for (int i = _count - 1; i >= 0; --i) {
+			InflateContext *ctx = _contexts[i];
+			if (ctx->windowBits != windowBits) {
+				continue;
+			}
+			_contexts[i] = _contexts[--_count];
+			if (inflateReset(&ctx->stream) != Z_OK) {
+				destroy(ctx);
+				break;
+			}
+			ctx->stream.next_in = Z_NULL;
+			ctx->stream.avail_in = 0;
+			return ctx;
+		}
+		InflateContext *ctx = (InflateContext *)core_malloc(sizeof(InflateContext));
+		core_memset(&ctx->stream, 0, sizeof(ctx->stream));
+		ctx->stream.zalloc = Z_NULL;
+		ctx->stream.zfree = Z_NULL;
+		ctx->windowBits = windowBits;
+		if (inflateInit2(&ctx->stream, windowBits) != Z_OK) {
+			core_free(ctx);
+			return nullptr;
+		}
+		return ctx;
+	}
+
+	void release(InflateContext *ctx) {
+		if (_count < MaxContexts) {
+			_contexts[_count++] = ctx;
+			return;
+		}
+		destroy(ctx);
+	}
+};
+
+static thread_local InflateContextPool inflateContextPool;
+
+/**
+ * @return the amount of header bytes to skip and the window bits for inflate for the given first two bytes of the
+ * compressed data
+ */
+static int detectWindowBits(const uint8_t *header, int &skip) {
+	if (header[0] == 0x1F && header[1] == 0x8B) {
+		// gzip header is 10 bytes long
+		skip = 10;
+		return -Z_DEFAULT_WINDOW_BITS;
+	}
+	skip = 0;
+	if ((header[0] & 0x0F) == Z_DEFLATED &&						// Compression method is DEFLATE
+		((header[0] >> 4) >= 7 && (header[0] >> 4) <= 15) &&	// Valid window size
+		((header[0] << 8 | header[1]) % 31 == 0)) {
+		Log::debug("detected zlib");
+		return Z_DEFAULT_WINDOW_BITS;
+	}
+	Log::debug("Detected raw deflate");
+	return -Z_DEFAULT_WINDOW_BITS;
+}
+
+} // namespace priv
+
 ZipReadStream::ZipReadStream(io::SeekableReadStream &readStream, int size)
-	: _readStream(readStream), _size(size), _remaining(size) {
-	_stream = (z_stream *)core_malloc(sizeof(z_stream));
-	core_memset(((z_stream*)_stream), 0, sizeof(z_stream));
-	((z_stream*)_stream)->zalloc = Z_NULL;
-	((z_stream*)_stream)->zfree = Z_NULL;
-	uint8_t gzipHeader[2];
+	: _ctx(nullptr), _readStream(readStream), _size(size), _remaining(size) {
+	uint8_t gzipHeader[2]{0, 0};
 	if (readStream.readUInt8(gzipHeader[0]) == -1) {
 		_err = true;
 	}
@@ -33,34 +120,59 @@ ZipReadStream::ZipReadStream(io::SeekableReadStream &readStream, int size)
 		_err = true;
 	}
 
-	int windowBits = 0;
-	if (gzipHeader[0] == 0x1F && gzipHeader[1] == 0x8B) {
-		// gzip
-		windowBits = -Z_DEFAULT_WINDOW_BITS;
-		// gzip header is 10 bytes long
-		readStream.skip(8);
-	} else if ((gzipHeader[0] & 0x0F) == Z_DEFLATED &&							// Compression method is DEFLATE
-			   ((gzipHeader[0] >> 4) >= 7 && (gzipHeader[0] >> 4) <= 15) && // Valid window size
-			   ((gzipHeader[0] << 8 | gzipHeader[1]) % 31 == 0)) {
-		// zlib
-		Log::debug("detected zlib");
-		windowBits = Z_DEFAULT_WINDOW_BITS;
-		readStream.seek(-2, SEEK_CUR);
+	int skip = 0;
+	const int windowBits = priv::detectWindowBits(gzipHeader, skip);
+	if (skip > 0) {
+		readStream.skip(skip - 2);
 	} else {
-		// raw deflate
-		Log::debug("Detected raw deflate");
-		windowBits = -Z_DEFAULT_WINDOW_BITS;
 		readStream.seek(-2, SEEK_CUR);
 	}
-	if (inflateInit2(((z_stream*)_stream), windowBits) != Z_OK) {
+	_ctx = priv::inflateContextPool.acquire(windowBits);
+	if (_ctx == nullptr) {
 		Log::error("Failed to initialize zip stream");
 		_err = true;
 	}
 }
 
 ZipReadStream::~ZipReadStream() {
-	inflateEnd(((z_stream*)_stream));
-	core_free(((z_stream*)_stream));
+	if (_ctx != nullptr) {
+		priv::inflateContextPool.release((priv::InflateContext *)_ctx);
+	}
+}
+
+int ZipReadStream::decompressInto(const void *src, size_t srcSize, void *dst, size_t dstSize) {
+	if (srcSize < 2) {
+		return -1;
+	}
+	const uint8_t *in = (const uint8_t *)src;
+	int skip = 0;
+	const int windowBits = priv::detectWindowBits(in, skip);
+	if (srcSize < (size_t)skip) {
+		return -1;
+	}
+	priv::InflateContext *ctx = priv::inflateContextPool.acquire(windowBits);
+	if (ctx == nullptr) {
+		Log::error("Failed to initialize zip stream");
+		return -1;
+	}
+	z_stream *stream = &ctx->stream;
+	stream->next_in = in + skip;
+	stream->avail_in = (unsigned int)(srcSize - skip);
+	stream->next_out = (uint8_t *)dst;
+	stream->avail_out = (unsigned int)dstSize;
+	const int retval = inflate(stream, Z_FINISH);
+	const size_t outputSize = dstSize - (size_t)stream->avail_out;
+	priv::inflateContextPool.release(ctx);
+	switch (retval) {
+	case Z_OK:
+	case Z_STREAM_END:
+	// either the target buffer is full or the input is truncated
+	case Z_BUF_ERROR:
+		return (int)outputSize;
+	default:
+		Log::debug("error while inflating the buffer: '%s'", zError(retval));
+		return -1;
+	}
 }
 
 bool ZipReadStream::eos() const {
@@ -97,7 +209,8 @@ int ZipReadStream::read(void *buf, size_t size) {
 		return 0;
 	}
 	uint8_t *targetPtr = (uint8_t *)buf;
-	z_stream* stream = (z_stream*)_stream;
+	priv::InflateContext *ctx = (priv::InflateContext *)_ctx;
+	z_stream *stream = &ctx->stream;
 	size_t readCnt = 0;
 	while (size > 0) {
 		if (stream->avail_in == 0) {
@@ -106,10 +219,10 @@ int ZipReadStream::read(void *buf, size_t size) {
 				_err = true;
 				return readCnt;
 			}
-			stream->next_in = _buf;
-			stream->avail_in = (unsigned int)core_min(remainingSize, (int64_t)sizeof(_buf));
+			stream->next_in = ctx->buf;
+			stream->avail_in = (unsigned int)core_min(remainingSize, (int64_t)sizeof(ctx->buf));
 			if (remainingSize > 0) {
-				const int bytes = _readStream.read(_buf, stream->avail_in);
+				const int bytes = _readStream.read(ctx->buf, stream->avail_in);
 				if (bytes == -1) {
 					Log::debug("Failed to read from parent stream");
 					_err = true;
@@ -9,14 +9,16 @@
 namespace io {
 
 /**
+ * The inflate state and the input buffer are taken from a thread local pool and are reset and reused by the next
+ * stream that is opened on the thread - formats that open one stream per chunk don't allocate them again and again.
+ *
  * @see ZipWriteStream
  * @ingroup IO
  */
 class ZipReadStream : public io::ReadStream {
 private:
-	void *_stream;
+	void *_ctx;
 	io::SeekableReadStream &_readStream;
-	uint8_t _buf[256 * 1024] {};
 	const int _size;
 	int _remaining;
 	bool _eos = false;
@@ -62,6 +64,21 @@ public:
 	 * @return int64_t
 	 */
 	int64_t remaining() const;
+
+	/**
+	 * @brief Inflates a gzip, zlib or raw deflate buffer in one go into the given target buffer
+	 *
+	 * Use this if the uncompressed size is known (e.g. from a format header) and the compressed data is already in
+	 * memory - the data is inflated directly from the source buffer into the target without going through the input
+	 * buffer of the stream.
+	 *
+	 * @param[in] src The compressed data
+	 * @param[in] srcSize The size of the compressed data
+	 * @param[out] dst The target buffer for the uncompressed data
+	 * @param[in] dstSize The size of the target buffer - inflating stops if the buffer is full
+	 * @return The amount of bytes written to @c dst or @c -1 on error
+	 */
+	static int decompressInto(const void *src, size_t srcSize, void *dst, size_t dstSize);
 };
 
 } // namespace io
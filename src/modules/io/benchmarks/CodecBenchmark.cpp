@@ -0,0 +1,110 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/collection/DynamicArray.h"
+#include "io/Base64.h"
+#include "io/Base64ReadStream.h"
+#include "io/Base64WriteStream.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/MemoryReadStream.h"
+#include "io/Z85.h"
+
+class CodecBenchmark : public app::AbstractBenchmark {
+protected:
+	core::DynamicArray<uint8_t> _data;
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		_data.resize((size_t)state.range(0));
+		for (size_t i = 0; i < _data.size(); ++i) {
+			_data[i] = (uint8_t)(i * 31 + (i >> 8));
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(CodecBenchmark, Base64Encode)(benchmark::State &state) {
+	for (auto _ : state) {
+		io::MemoryReadStream stream(_data.data(), _data.size());
+		const core::String &encoded = io::Base64::encode(stream);
+		benchmark::DoNotOptimize(encoded.c_str());
+	}
+	addBytesCounter(state, (int64_t)_data.size());
+}
+
+BENCHMARK_DEFINE_F(CodecBenchmark, Base64Decode)(benchmark::State &state) {
+	io::MemoryReadStream stream(_data.data(), _data.size());
+	const core::String encoded = io::Base64::encode(stream);
+	io::BufferedReadWriteStream out((int64_t)_data.size());
+	for (auto _ : state) {
+		out.seek(0);
+		if (!io::Base64::decode(out, encoded)) {
+			state.SkipWithError("Failed to decode");
+			break;
+		}
+	}
+	addBytesCounter(state, (int64_t)_data.size());
+}
+
+BENCHMARK_DEFINE_F(CodecBenchmark, Base64WriteStream)(benchmark::State &state) {
+	io::BufferedReadWriteStream out((int64_t)_data.size() * 4 / 3 + 4);
+	for (auto _ : state) {
+		out.seek(0);
+		io::Base64WriteStream base64Stream(out);
+		if (base64Stream.write(_data.data(), _data.size()) == -1 || !base64Stream.flush()) {
+			state.SkipWithError("Failed to encode");
+			break;
+		}
+	}
+	addBytesCounter(state, (int64_t)_data.size());
+}
+
+BENCHMARK_DEFINE_F(CodecBenchmark, Base64ReadStream)(benchmark::State &state) {
+	io::MemoryReadStream stream(_data.data(), _data.size());
+	const core::String encoded = io::Base64::encode(stream);
+	core::DynamicArray<uint8_t> out;
+	out.resize(_data.size());
+	for (auto _ : state) {
+		io::MemoryReadStream in(encoded.c_str(), encoded.size());
+		io::Base64ReadStream base64Stream(in);
+		if (base64Stream.read(out.data(), out.size()) != (int)out.size()) {
+			state.SkipWithError("Failed to decode");
+			break;
+		}
+	}
+	addBytesCounter(state, (int64_t)_data.size());
+}
+
+BENCHMARK_DEFINE_F(CodecBenchmark, Z85Encode)(benchmark::State &state) {
+	for (auto _ : state) {
+		io::MemoryReadStream stream(_data.data(), _data.size());
+		const core::String &encoded = io::Z85::encode(stream);
+		benchmark::DoNotOptimize(encoded.c_str());
+	}
+	addBytesCounter(state, (int64_t)_data.size());
+}
+
+BENCHMARK_DEFINE_F(CodecBenchmark, Z85Decode)(benchmark::State &state) {
+	io::MemoryReadStream stream(_data.data(), _data.size());
+	const core::String encoded = io::Z85::encode(stream);
+	io::BufferedReadWriteStream out((int64_t)_data.size());
+	for (auto _ : state) {
+		out.seek(0);
+		if (!io::Z85::decode(out, encoded)) {
+			state.SkipWithError("Failed to decode");
+			break;
+		}
+	}
+	addBytesCounter(state, (int64_t)_data.size());
+}
+
+BENCHMARK_REGISTER_F(CodecBenchmark, Base64Encode)->RangeMultiplier(16)->Range(1024, 16 * 1024 * 1024);
+BENCHMARK_REGISTER_F(CodecBenchmark, Base64Decode)->RangeMultiplier(16)->Range(1024, 16 * 1024 * 1024);
+BENCHMARK_REGISTER_F(CodecBenchmark, Base64WriteStream)->RangeMultiplier(16)->Range(1024, 16 * 1024 * 1024);
+BENCHMARK_REGISTER_F(CodecBenchmark, Base64ReadStream)->RangeMultiplier(16)->Range(1024, 16 * 1024 * 1024);
+BENCHMARK_REGISTER_F(CodecBenchmark, Z85Encode)->RangeMultiplier(16)->Range(1024, 16 * 1024 * 1024);
+BENCHMARK_REGISTER_F(CodecBenchmark, Z85Decode)->RangeMultiplier(16)->Range(1024, 16 * 1024 * 1024);
+
+BENCHMARK_MAIN();
@@ -62,6 +62,14 @@ core::String fs_cwd() {
 	return "/";
 }
 
+void *fs_mmap(const char *path, size_t &size) {
+	size = 0u;
+	return nullptr;
+}
+
+void fs_munmap(void *mem, size_t size) {
+}
+
 } // namespace io
 
 #endif
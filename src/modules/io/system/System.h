@@ -21,5 +21,13 @@ bool fs_stat(const char *path, FilesystemEntry &entry);
 core::DynamicArray<FilesystemEntry> fs_scandir(const char *path);
 core::String fs_readlink(const char *path);
 core::String fs_cwd();
+/**
+ * @brief Maps the whole file read-only into the address space of the process
+ * @param[out] size The size of the file in bytes
+ * @return @c nullptr if the file could not get mapped - e.g. because it's empty. Release the memory with
+ * @c fs_munmap()
+ */
+void *fs_mmap(const char *path, size_t &size);
+void fs_munmap(void *mem, size_t size);
 
 } // namespace io
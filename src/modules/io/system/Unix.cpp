@@ -15,8 +15,10 @@
 #include "io/Filesystem.h"
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <pwd.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -338,6 +340,35 @@ bool fs_hidden(const char *path) {
 	return p[0] == '.';
 }
 
+void *fs_mmap(const char *path, size_t &size) {
+	size = 0u;
+	const int fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		Log::debug("Failed to open %s for mapping: %s", path, strerror(errno));
+		return nullptr;
+	}
+	struct stat s;
+	if (fstat(fd, &s) != 0 || !S_ISREG(s.st_mode) || s.st_size <= 0) {
+		close(fd);
+		return nullptr;
+	}
+	void *mem = mmap(nullptr, (size_t)s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping stays valid after the descriptor is closed
+	close(fd);
+	if (mem == MAP_FAILED) {
+		Log::debug("Failed to map %s: %s", path, strerror(errno));
+		return nullptr;
+	}
+	size = (size_t)s.st_size;
+	return mem;
+}
+
+void fs_munmap(void *mem, size_t size) {
+	if (mem != nullptr) {
+		munmap(mem, size);
+	}
+}
+
 } // namespace io
 
 #endif
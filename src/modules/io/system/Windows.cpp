@@ -301,6 +301,45 @@ core::DynamicArray<FilesystemEntry> fs_scandir(const char *path) {
 	return entries;
 }
 
+void *fs_mmap(const char *path, size_t &size) {
+	size = 0u;
+	WCHAR *wpath = io_UTF8ToStringW(path);
+	priv::denormalizePath(wpath);
+	HANDLE file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+							  nullptr);
+	SDL_free(wpath);
+	if (file == INVALID_HANDLE_VALUE) {
+		Log::debug("Failed to open %s for mapping", path);
+		return nullptr;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+		CloseHandle(file);
+		return nullptr;
+	}
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr) {
+		Log::debug("Failed to create the file mapping for %s", path);
+		return nullptr;
+	}
+	void *mem = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	// the view keeps the mapping alive
+	CloseHandle(mapping);
+	if (mem == nullptr) {
+		Log::debug("Failed to map %s", path);
+		return nullptr;
+	}
+	size = (size_t)fileSize.QuadPart;
+	return mem;
+}
+
+void fs_munmap(void *mem, size_t size) {
+	if (mem != nullptr) {
+		UnmapViewOfFile(mem);
+	}
+}
+
 #undef io_StringToUTF8W
 #undef io_UTF8ToStringW
 
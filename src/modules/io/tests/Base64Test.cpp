@@ -3,6 +3,7 @@
  */
 
 #include "io/Base64.h"
+#include "core/ArrayLength.h"
 #include "core/tests/TestHelper.h"
 #include "io/Base64ReadStream.h"
 #include "io/Base64WriteStream.h"
@@ -72,4 +73,54 @@ TEST_F(Base64Test, testBase64ReadStream) {
 	decode("Zm9vYmFy", "foobar");
 }
 
+TEST_F(Base64Test, testRoundTripLarge) {
+	// larger than the blocks of the codecs and no multiple of the group size
+	uint8_t input[10000];
+	for (int i = 0; i < lengthof(input); ++i) {
+		input[i] = (uint8_t)(i * 7);
+	}
+	io::MemoryReadStream inputStream(input, sizeof(input));
+	const core::String &base64 = io::Base64::encode(inputStream);
+	EXPECT_EQ(13336u, base64.size());
+	EXPECT_EQ("==", base64.substr(base64.size() - 2));
+
+	io::BufferedReadWriteStream stream;
+	ASSERT_TRUE(io::Base64::decode(stream, base64));
+	ASSERT_EQ((int64_t)sizeof(input), stream.size());
+	EXPECT_EQ(0, memcmp(input, stream.getBuffer(), sizeof(input)));
+
+	io::BufferedReadWriteStream encoded;
+	{
+		io::Base64WriteStream base64Stream(encoded);
+		// uneven writes to split the groups between the calls
+		size_t pos = 0;
+		for (size_t n = 1; pos < sizeof(input); n = n * 2 + 1) {
+			const size_t len = core_min(n, sizeof(input) - pos);
+			ASSERT_NE(-1, base64Stream.write(input + pos, len));
+			pos += len;
+		}
+	}
+	ASSERT_EQ(base64.size(), (size_t)encoded.size());
+	EXPECT_EQ(0, memcmp(base64.c_str(), encoded.getBuffer(), base64.size()));
+
+	encoded.seek(0);
+	io::Base64ReadStream base64Stream(encoded);
+	uint8_t decoded[sizeof(input)];
+	size_t decodedSize = 0;
+	while (!base64Stream.eos()) {
+		const size_t len = core_min((size_t)3001, sizeof(decoded) - decodedSize);
+		const int n = base64Stream.read(decoded + decodedSize, len);
+		ASSERT_GE(n, 0);
+		decodedSize += n;
+	}
+	ASSERT_EQ(sizeof(input), decodedSize);
+	EXPECT_EQ(0, memcmp(input, decoded, sizeof(input)));
+}
+
+TEST_F(Base64Test, testDecodeStopsAtInvalidCharacter) {
+	io::BufferedReadWriteStream stream;
+	EXPECT_TRUE(io::Base64::decode(stream, "Zm9vYm!yZm9v"));
+	EXPECT_EQ(4u, stream.size());
+}
+
 } // namespace io
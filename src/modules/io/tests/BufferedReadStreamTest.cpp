@@ -0,0 +1,101 @@
+/**
+ * @file
+ */
+
+#include "io/BufferedReadStream.h"
+#include "core/ArrayLength.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/MemoryReadStream.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class BufferedReadStreamTest : public testing::Test {};
+
+TEST_F(BufferedReadStreamTest, testReadAcrossFrames) {
+	BufferedReadWriteStream data;
+	for (uint32_t i = 0; i < 64; ++i) {
+		ASSERT_TRUE(data.writeUInt32(i));
+	}
+	data.seek(0);
+	// a frame size that is no multiple of the value size
+	BufferedReadStream stream(data, 7);
+	EXPECT_EQ(data.size(), stream.size());
+	for (uint32_t i = 0; i < 64; ++i) {
+		uint32_t val;
+		ASSERT_EQ(0, stream.readUInt32(val));
+		EXPECT_EQ(i, val);
+	}
+	EXPECT_TRUE(stream.eos());
+	uint8_t byte;
+	EXPECT_EQ(-1, stream.readUInt8(byte));
+}
+
+TEST_F(BufferedReadStreamTest, testEndianess) {
+	const uint8_t buf[]{0x01, 0x02, 0x03, 0x04, 0x01, 0x02, 0x03, 0x04};
+	MemoryReadStream data(buf, sizeof(buf));
+	BufferedReadStream stream(data, 16);
+	uint32_t le;
+	uint32_t be;
+	ASSERT_EQ(0, stream.readUInt32(le));
+	ASSERT_EQ(0, stream.readUInt32BE(be));
+	EXPECT_EQ(0x04030201u, le);
+	EXPECT_EQ(0x01020304u, be);
+}
+
+TEST_F(BufferedReadStreamTest, testSeekAndPeek) {
+	uint8_t buf[32];
+	for (int i = 0; i < lengthof(buf); ++i) {
+		buf[i] = (uint8_t)i;
+	}
+	MemoryReadStream data(buf, sizeof(buf));
+	BufferedReadStream stream(data, 8);
+	EXPECT_EQ(20, stream.seek(20));
+	uint32_t val;
+	ASSERT_EQ(0, stream.peekUInt32(val));
+	EXPECT_EQ(20, stream.pos());
+	EXPECT_EQ(0x17161514u, val);
+	EXPECT_EQ(22, stream.skip(2));
+	uint8_t byte;
+	ASSERT_EQ(0, stream.readUInt8(byte));
+	EXPECT_EQ(22u, byte);
+	EXPECT_EQ(2, stream.seek(-21, SEEK_CUR));
+	ASSERT_EQ(0, stream.readUInt8(byte));
+	EXPECT_EQ(2u, byte);
+	EXPECT_EQ(30, stream.seek(-2, SEEK_END));
+	EXPECT_EQ(-1, stream.seek(1, SEEK_END));
+}
+
+TEST_F(BufferedReadStreamTest, testReadArray) {
+	BufferedReadWriteStream data;
+	for (int16_t i = 0; i < 100; ++i) {
+		ASSERT_TRUE(data.writeInt16((int16_t)(i - 50)));
+	}
+	data.seek(0);
+	BufferedReadStream stream(data, 16);
+	int16_t first;
+	ASSERT_EQ(0, stream.readInt16(first));
+	EXPECT_EQ(-50, first);
+	// larger than the frame - this bypasses the buffer
+	int16_t values[99];
+	ASSERT_EQ(0, stream.readArray(values, lengthof(values)));
+	for (int i = 0; i < lengthof(values); ++i) {
+		EXPECT_EQ(i - 49, values[i]);
+	}
+	EXPECT_EQ(-1, stream.readArray(values, 1));
+}
+
+TEST_F(BufferedReadStreamTest, testRestorePosition) {
+	uint8_t buf[32]{};
+	MemoryReadStream data(buf, sizeof(buf));
+	{
+		BufferedReadStream stream(data, 16);
+		uint16_t val;
+		ASSERT_EQ(0, stream.readUInt16(val));
+		// the frame was read ahead
+		EXPECT_EQ(16, data.pos());
+	}
+	EXPECT_EQ(2, data.pos());
+}
+
+} // namespace io
@@ -290,4 +290,19 @@ TEST(BufferedReadWriteStreamTest, testFourCCBE) {
 	EXPECT_EQ(fcc, fccs);
 }
 
+TEST(BufferedReadWriteStreamTest, testReserve) {
+	BufferedReadWriteStream stream;
+	stream.reserve(1000);
+	const int64_t capacity = stream.capacity();
+	EXPECT_GE(capacity, 1000);
+	for (int i = 0; i < 250; ++i) {
+		EXPECT_TRUE(stream.writeUInt32(i));
+	}
+	EXPECT_EQ(capacity, stream.capacity());
+	EXPECT_NE(stream.seek(0), -1);
+	uint32_t val = 0;
+	EXPECT_EQ(stream.readUInt32(val), 0);
+	EXPECT_EQ(0u, val);
+}
+
 }
@@ -0,0 +1,48 @@
+/**
+ * @file
+ */
+
+#include "io/ChunkedWriteStream.h"
+#include "io/BufferedReadWriteStream.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class ChunkedWriteStreamTest : public testing::Test {};
+
+TEST_F(ChunkedWriteStreamTest, testWriteAcrossChunks) {
+	// a chunk size that is no multiple of the value size
+	ChunkedWriteStream stream(0u, 7u);
+	for (uint32_t i = 0; i < 64; ++i) {
+		ASSERT_TRUE(stream.writeUInt32(i));
+	}
+	EXPECT_EQ(256, stream.size());
+	EXPECT_EQ(37u, stream.chunks());
+	BufferedReadWriteStream out;
+	ASSERT_TRUE(stream.writeTo(out));
+	ASSERT_EQ(stream.size(), out.size());
+	out.seek(0);
+	for (uint32_t i = 0; i < 64; ++i) {
+		uint32_t val;
+		ASSERT_EQ(0, out.readUInt32(val));
+		EXPECT_EQ(i, val);
+	}
+}
+
+TEST_F(ChunkedWriteStreamTest, testSizeHint) {
+	ChunkedWriteStream stream(128u, 16u);
+	uint8_t buf[128];
+	for (int i = 0; i < (int)sizeof(buf); ++i) {
+		buf[i] = (uint8_t)i;
+	}
+	ASSERT_EQ((int)sizeof(buf), stream.write(buf, sizeof(buf)));
+	EXPECT_EQ(1u, stream.chunks());
+	ASSERT_TRUE(stream.writeUInt8(128));
+	EXPECT_EQ(2u, stream.chunks());
+	EXPECT_EQ(129, stream.size());
+	stream.reset();
+	EXPECT_EQ(0u, stream.chunks());
+	EXPECT_EQ(0, stream.size());
+}
+
+} // namespace io
@@ -65,4 +65,33 @@ TEST_F(FilesystemArchiveTest, testFilesytemArchiveList) {
 	EXPECT_EQ(files.back().name, "iotest.txt");
 }
 
+TEST_F(FilesystemArchiveTest, testFilesytemArchiveMemoryMapped) {
+	const core::String content = fs->load("iotest.txt");
+	ASSERT_FALSE(content.empty());
+	io::FilesystemArchive fsa(fs);
+	for (int64_t threshold : {(int64_t)0, (int64_t)-1}) {
+		fsa.setMemoryMappedThreshold(threshold);
+		core::ScopedPtr<io::SeekableReadStream> rs(fsa.readStream("iotest.txt"));
+		ASSERT_TRUE(rs) << "threshold " << threshold;
+		core::String read;
+		ASSERT_TRUE(rs->readString((int)rs->size(), read));
+		EXPECT_EQ(content, read) << "threshold " << threshold;
+	}
+}
+
+TEST_F(FilesystemArchiveTest, testFilesytemArchiveReadAhead) {
+	const core::String content = fs->load("iotest.txt");
+	ASSERT_FALSE(content.empty());
+	io::FilesystemArchive fsa(fs);
+	fsa.setMemoryMappedThreshold(-1);
+	for (int64_t threshold : {(int64_t)0, (int64_t)-1}) {
+		fsa.setReadAheadThreshold(threshold);
+		core::ScopedPtr<io::SeekableReadStream> rs(fsa.readStream("iotest.txt"));
+		ASSERT_TRUE(rs) << "threshold " << threshold;
+		core::String read;
+		ASSERT_TRUE(rs->readString((int)rs->size(), read));
+		EXPECT_EQ(content, read) << "threshold " << threshold;
+	}
+}
+
 } // namespace io
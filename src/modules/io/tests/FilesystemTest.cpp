@@ -8,6 +8,7 @@
 #include "core/Algorithm.h"
 #include "core/Enum.h"
 #include "core/StringUtil.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/FormatDescription.h"
 #include <gtest/gtest.h>
 
@@ -48,6 +49,39 @@ TEST_F(FilesystemTest, testListDirectory) {
 	fs.shutdown();
 }
 
+TEST_F(FilesystemTest, testListDirectoryParallel) {
+	io::Filesystem fs;
+	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
+	EXPECT_TRUE(io::Filesystem::sysCreateDir("listdirparalleltest/dir1/dir2"));
+	EXPECT_TRUE(io::Filesystem::sysCreateDir("listdirparalleltest/dir3"));
+	EXPECT_TRUE(io::Filesystem::sysWrite("listdirparalleltest/dir1/dir2/file1.vox", "1"));
+	EXPECT_TRUE(io::Filesystem::sysWrite("listdirparalleltest/dir1/file2.vox", "2"));
+	EXPECT_TRUE(io::Filesystem::sysWrite("listdirparalleltest/dir3/file3.vox", "3"));
+	EXPECT_TRUE(io::Filesystem::sysWrite("listdirparalleltest/dir3/ignored.txt", "ignore"));
+	EXPECT_TRUE(io::Filesystem::sysWrite("listdirparalleltest/file4.vox", "4"));
+
+	core::DynamicArray<io::FilesystemEntry> serial;
+	fs.list("listdirparalleltest/", serial, "*.vox", 2);
+	core::ThreadPool threadPool(2, "ListDirectory");
+	threadPool.init();
+	core::DynamicArray<io::FilesystemEntry> parallel;
+	fs.list("listdirparalleltest/", parallel, "*.vox", 2, &threadPool);
+	ASSERT_EQ(serial.size(), parallel.size()) << serial << " vs " << parallel;
+	// 4 files and 3 directories
+	EXPECT_EQ(7u, parallel.size()) << parallel;
+	auto byPath = [](const io::FilesystemEntry &first, const io::FilesystemEntry &second) {
+		return first.fullPath < second.fullPath;
+	};
+	serial.sort(byPath);
+	parallel.sort(byPath);
+	for (size_t i = 0; i < serial.size(); ++i) {
+		EXPECT_EQ(serial[i].fullPath, parallel[i].fullPath);
+		EXPECT_EQ(serial[i].type, parallel[i].type) << serial[i].fullPath.c_str();
+		EXPECT_EQ(serial[i].size, parallel[i].size) << serial[i].fullPath.c_str();
+	}
+	fs.shutdown();
+}
+
 #ifndef _WIN32
 TEST_F(FilesystemTest, testSysIsHidden) {
 	EXPECT_TRUE(io::Filesystem::sysIsHidden("/foo/.bar"));
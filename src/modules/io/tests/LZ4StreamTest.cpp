@@ -0,0 +1,103 @@
+/**
+ * @file
+ */
+
+#include "core/ArrayLength.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/LZ4.h"
+#include "io/LZ4ReadStream.h"
+#include "io/LZ4WriteStream.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class LZ4StreamTest : public testing::Test {};
+
+TEST_F(LZ4StreamTest, testLZ4StreamWriteAndRead) {
+	BufferedReadWriteStream stream(1024);
+	{
+		LZ4WriteStream w(stream);
+		for (int i = 0; i < 64; ++i) {
+			ASSERT_TRUE(w.writeInt32(i + 0)) << "unexpected write failure for step: " << i;
+			ASSERT_TRUE(w.writeInt32(i + 1)) << "unexpected write failure for step: " << i;
+			ASSERT_TRUE(w.writeInt32(i + 2)) << "unexpected write failure for step: " << i;
+			ASSERT_TRUE(w.writeInt32(i + 3)) << "unexpected write failure for step: " << i;
+		}
+		ASSERT_TRUE(w.flush());
+		EXPECT_EQ(w.size(), stream.size());
+	}
+	const int size = (int)stream.size();
+	stream.seek(0);
+	{
+		LZ4ReadStream r(stream, size);
+		for (int i = 0; i < 64; ++i) {
+			int32_t n;
+			ASSERT_EQ(0, r.readInt32(n)) << "unexpected read failure for step: " << i;
+			ASSERT_EQ(n, i + 0) << "unexpected extracted value for step: " << i;
+			ASSERT_EQ(0, r.readInt32(n)) << "unexpected read failure for step: " << i;
+			ASSERT_EQ(n, i + 1) << "unexpected extracted value for step: " << i;
+			ASSERT_EQ(0, r.readInt32(n)) << "unexpected read failure for step: " << i;
+			ASSERT_EQ(n, i + 2) << "unexpected extracted value for step: " << i;
+			ASSERT_EQ(0, r.readInt32(n)) << "unexpected read failure for step: " << i;
+			ASSERT_EQ(n, i + 3) << "unexpected extracted value for step: " << i;
+		}
+	}
+	stream.seek(0);
+	{
+		LZ4ReadStream r(stream, size);
+		uint8_t buffer[64 * 4 * 4 + 10]; // bigger
+		ASSERT_EQ(64 * 4 * 4, r.read(buffer, sizeof(buffer)));
+		ASSERT_TRUE(r.eos());
+		ASSERT_EQ(0, r.read(buffer, sizeof(buffer)));
+	}
+}
+
+TEST_F(LZ4StreamTest, testLZ4StreamMultipleBlocks) {
+	// compressible and incompressible blocks
+	const int n = LZ4::BlockSize * 3 + 17;
+	uint8_t *data = new uint8_t[n];
+	uint32_t seed = 42u;
+	for (int i = 0; i < n; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		data[i] = i < LZ4::BlockSize ? (uint8_t)(seed >> 24) : (uint8_t)(i / 100);
+	}
+	BufferedReadWriteStream stream(1024);
+	{
+		LZ4WriteStream w(stream);
+		ASSERT_NE(-1, w.write(data, n));
+		ASSERT_TRUE(w.flush());
+		ASSERT_EQ(-1, w.write(data, 1)) << "no writes are allowed after the stream was finished";
+	}
+	EXPECT_LT(stream.size(), n);
+	// some trailing data that must not be consumed by the read stream
+	ASSERT_TRUE(stream.writeUInt32(0xdeadbeef));
+	stream.seek(0);
+	uint8_t *extracted = new uint8_t[n];
+	LZ4ReadStream r(stream);
+	ASSERT_EQ(n, r.read(extracted, n));
+	// reads the end marker
+	ASSERT_EQ(0, r.read(extracted, 1));
+	ASSERT_TRUE(r.eos());
+	EXPECT_EQ(0, memcmp(data, extracted, n));
+	uint32_t trailing;
+	ASSERT_EQ(0, stream.readUInt32(trailing));
+	EXPECT_EQ(0xdeadbeef, trailing);
+	delete[] extracted;
+	delete[] data;
+}
+
+TEST_F(LZ4StreamTest, testLZ4Corrupted) {
+	uint8_t data[256];
+	for (int i = 0; i < lengthof(data); ++i) {
+		data[i] = (uint8_t)(i % 8);
+	}
+	uint8_t compressed[LZ4::compressBound(sizeof(data))];
+	const int size = LZ4::compress(data, sizeof(data), compressed, sizeof(compressed));
+	ASSERT_GT(size, 0);
+	uint8_t extracted[sizeof(data)];
+	ASSERT_EQ((int)sizeof(data), LZ4::decompress(compressed, size, extracted, sizeof(extracted)));
+	EXPECT_EQ(-1, LZ4::decompress(compressed, size, extracted, sizeof(extracted) - 1));
+	EXPECT_EQ(-1, LZ4::decompress(compressed, size - 1, extracted, sizeof(extracted)));
+}
+
+} // namespace io
@@ -0,0 +1,54 @@
+/**
+ * @file
+ */
+
+#include "io/LZFSEReadStream.h"
+#include "core/collection/DynamicArray.h"
+#include "io/MemoryReadStream.h"
+#include "lzfse.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class LZFSEReadStreamTest : public testing::Test {
+protected:
+	uint8_t _data[64 * 1024];
+	core::DynamicArray<uint8_t> _compressed;
+
+	void SetUp() override {
+		for (int i = 0; i < (int)sizeof(_data); ++i) {
+			_data[i] = (uint8_t)((i * 7) % 31);
+		}
+		_compressed.resize(sizeof(_data) + 1024);
+		const size_t size = lzfse_encode_buffer(_compressed.data(), _compressed.size(), _data, sizeof(_data), nullptr);
+		ASSERT_GT(size, 0u);
+		_compressed.resize(size);
+	}
+};
+
+TEST_F(LZFSEReadStreamTest, testRead) {
+	MemoryReadStream in(_compressed.data(), _compressed.size());
+	LZFSEReadStream stream(in);
+	ASSERT_EQ((int64_t)sizeof(_data), stream.size());
+	uint8_t out[sizeof(_data)];
+	ASSERT_EQ((int)sizeof(out), stream.read(out, sizeof(out)));
+	EXPECT_EQ(0, memcmp(_data, out, sizeof(_data)));
+}
+
+TEST_F(LZFSEReadStreamTest, testDecompressInto) {
+	uint8_t out[sizeof(_data)];
+	ASSERT_EQ((int64_t)sizeof(out),
+			  LZFSEReadStream::decompressInto(_compressed.data(), _compressed.size(), out, sizeof(out)));
+	EXPECT_EQ(0, memcmp(_data, out, sizeof(_data)));
+}
+
+TEST_F(LZFSEReadStreamTest, testDecompressIntoInvalid) {
+	const uint8_t invalid[]{'n', 'o', 'p', 'e', 0, 0, 0, 0};
+	uint8_t out[16];
+	EXPECT_EQ(-1, LZFSEReadStream::decompressInto(invalid, sizeof(invalid), out, sizeof(out)));
+	MemoryReadStream in(invalid, sizeof(invalid));
+	LZFSEReadStream stream(in);
+	EXPECT_EQ(0, stream.size());
+}
+
+} // namespace io
@@ -32,4 +32,13 @@ TEST_F(MemoryArchiveTest, testMemoryArchiveAddViaWrite) {
 	EXPECT_EQ((size_t)stream->size(), sizeof(buf));
 }
 
+TEST_F(MemoryArchiveTest, testMemoryArchiveExists) {
+	io::MemoryArchive a;
+	EXPECT_FALSE(a.exists("test"));
+	uint8_t buf[] = {0, 1, 2, 3};
+	ASSERT_TRUE(a.add("test", buf, sizeof(buf)));
+	EXPECT_TRUE(a.exists("test"));
+	EXPECT_FALSE(a.exists("test2"));
+}
+
 } // namespace io
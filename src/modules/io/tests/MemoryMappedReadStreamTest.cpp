@@ -0,0 +1,40 @@
+/**
+ * @file
+ */
+
+#include "io/MemoryMappedReadStream.h"
+#include "app/tests/AbstractTest.h"
+#include "io/File.h"
+#include "io/Filesystem.h"
+
+namespace io {
+
+class MemoryMappedReadStreamTest : public app::AbstractTest {};
+
+TEST_F(MemoryMappedReadStreamTest, testRead) {
+	const io::FilePtr &file = _testApp->filesystem()->open("iotest.txt");
+	ASSERT_TRUE(file->validHandle());
+	const core::String content = file->load();
+	ASSERT_FALSE(content.empty());
+
+	MemoryMappedReadStream stream(file->name());
+	ASSERT_TRUE(stream.valid());
+	ASSERT_EQ((int64_t)content.size(), stream.size());
+	EXPECT_EQ(0, memcmp(content.c_str(), stream.getBuffer(), content.size()));
+
+	ASSERT_EQ(2, stream.seek(2));
+	uint8_t byte;
+	ASSERT_EQ(0, stream.readUInt8(byte));
+	EXPECT_EQ((uint8_t)content[2], byte);
+	stream.seek(0, SEEK_END);
+	EXPECT_TRUE(stream.eos());
+}
+
+TEST_F(MemoryMappedReadStreamTest, testInvalidFile) {
+	MemoryMappedReadStream stream("does-not-exist.txt");
+	EXPECT_FALSE(stream.valid());
+	EXPECT_EQ(0, stream.size());
+	EXPECT_TRUE(stream.eos());
+}
+
+} // namespace io
@@ -0,0 +1,63 @@
+/**
+ * @file
+ */
+
+#include "io/ReadAheadStream.h"
+#include "core/ArrayLength.h"
+#include "io/BufferedReadWriteStream.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class ReadAheadStreamTest : public testing::Test {
+protected:
+	static BufferedReadWriteStream *createStream(uint32_t values) {
+		BufferedReadWriteStream *stream = new BufferedReadWriteStream();
+		for (uint32_t i = 0; i < values; ++i) {
+			stream->writeUInt32(i);
+		}
+		stream->seek(0);
+		return stream;
+	}
+};
+
+TEST_F(ReadAheadStreamTest, testSequentialRead) {
+	// a frame size that is no multiple of the value size
+	ReadAheadStream stream(createStream(1000), 10);
+	EXPECT_EQ(4000, stream.size());
+	for (uint32_t i = 0; i < 1000; ++i) {
+		uint32_t val;
+		ASSERT_EQ(0, stream.readUInt32(val)) << "value " << i;
+		EXPECT_EQ(i, val);
+	}
+	EXPECT_TRUE(stream.eos());
+	uint8_t byte;
+	EXPECT_EQ(-1, stream.readUInt8(byte));
+}
+
+TEST_F(ReadAheadStreamTest, testSeek) {
+	ReadAheadStream stream(createStream(1000), 64);
+	uint32_t val;
+	EXPECT_EQ(2000, stream.seek(2000));
+	ASSERT_EQ(0, stream.readUInt32(val));
+	EXPECT_EQ(500u, val);
+	EXPECT_EQ(4, stream.seek(-2000, SEEK_CUR));
+	EXPECT_EQ(8, stream.seek(8));
+	ASSERT_EQ(0, stream.readUInt32(val));
+	EXPECT_EQ(2u, val);
+	EXPECT_EQ(3996, stream.seek(-4, SEEK_END));
+	ASSERT_EQ(0, stream.readUInt32(val));
+	EXPECT_EQ(999u, val);
+	EXPECT_EQ(-1, stream.seek(1, SEEK_END));
+}
+
+TEST_F(ReadAheadStreamTest, testLargeRead) {
+	ReadAheadStream stream(createStream(1000), 100);
+	uint32_t values[1000];
+	ASSERT_EQ(0, stream.readArray(values, lengthof(values)));
+	for (int i = 0; i < lengthof(values); ++i) {
+		EXPECT_EQ((uint32_t)i, values[i]);
+	}
+}
+
+} // namespace io
@@ -3,6 +3,7 @@
  */
 
 #include "io/Z85.h"
+#include "core/ArrayLength.h"
 #include "core/tests/TestHelper.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/MemoryReadStream.h"
@@ -32,4 +33,25 @@ TEST_F(Z85Test, testZ85Decode) {
 	EXPECT_STREQ("foobar", strbuff);
 }
 
+TEST_F(Z85Test, testRoundTripLarge) {
+	// larger than the blocks of the codec
+	uint8_t input[10000];
+	for (int i = 0; i < lengthof(input); ++i) {
+		input[i] = (uint8_t)(i * 13);
+	}
+	io::MemoryReadStream inputStream(input, sizeof(input));
+	const core::String encoded = io::Z85::encode(inputStream);
+	EXPECT_EQ(12500u, encoded.size());
+
+	io::BufferedReadWriteStream stream;
+	ASSERT_TRUE(io::Z85::decode(stream, encoded));
+	ASSERT_EQ((int64_t)sizeof(input), stream.size());
+	EXPECT_EQ(0, memcmp(input, stream.getBuffer(), sizeof(input)));
+}
+
+TEST_F(Z85Test, testZ85DecodeInvalid) {
+	io::BufferedReadWriteStream stream;
+	EXPECT_FALSE(io::Z85::decode(stream, "w]zP%vr~"));
+}
+
 } // namespace io
@@ -6,6 +6,7 @@
 #include "app/tests/AbstractTest.h"
 #include "core/ArrayLength.h"
 #include "core/ScopedPtr.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/FileStream.h"
 #include "io/Filesystem.h"
 #include "io/Stream.h"
@@ -37,4 +38,38 @@ TEST_F(ZipArchiveTest, testZipArchive) {
 	EXPECT_EQ("dir/file.txt", files[2].fullPath);
 }
 
+TEST_F(ZipArchiveTest, testReadStreamCaseInsensitive) {
+	const io::FilePtr &file = _testApp->filesystem()->open("iotest.zip", io::FileMode::Read);
+	FileStream fileStream(file);
+	ZipArchive archive;
+	ASSERT_TRUE(archive.init(file->fileName(), &fileStream));
+	core::ScopedPtr<io::SeekableReadStream> outstream(archive.readStream("DIR/File.txt"));
+	ASSERT_TRUE(outstream);
+	core::ScopedPtr<io::SeekableReadStream> missing(archive.readStream("missing.txt"));
+	EXPECT_FALSE(missing);
+}
+
+TEST_F(ZipArchiveTest, testPrefetch) {
+	const io::FilePtr &file = _testApp->filesystem()->open("iotest.zip", io::FileMode::Read);
+	FileStream fileStream(file);
+	ZipArchive archive;
+	ASSERT_TRUE(archive.init(file->fileName(), &fileStream));
+	const ArchiveFiles &files = archive.files();
+	core::DynamicArray<core::String> paths;
+	for (const FilesystemEntry &entry : files) {
+		paths.push_back(entry.fullPath);
+	}
+	core::ThreadPool threadPool(2, "ZipArchive");
+	threadPool.init();
+	ASSERT_TRUE(archive.prefetch(paths, &threadPool));
+	for (const FilesystemEntry &entry : files) {
+		core::ScopedPtr<io::SeekableReadStream> outstream(archive.readStream(entry.fullPath));
+		ASSERT_TRUE(outstream) << entry.fullPath.c_str();
+		EXPECT_EQ((int64_t)entry.size, outstream->size()) << entry.fullPath.c_str();
+		EXPECT_EQ(0, outstream->pos());
+	}
+	paths.push_back("missing.txt");
+	EXPECT_FALSE(archive.prefetch(paths, nullptr));
+}
+
 } // namespace io
@@ -180,4 +180,55 @@ TEST_F(ZipStreamTest, testZipStreamParentFailure) {
 	EXPECT_EQ(-1, r.read(buf, sizeof(buf)));
 }
 
+TEST_F(ZipStreamTest, testDecompressInto) {
+	uint8_t data[4096];
+	for (int i = 0; i < (int)sizeof(data); ++i) {
+		data[i] = (uint8_t)(i % 13);
+	}
+	for (bool rawDeflate : {false, true}) {
+		BufferedReadWriteStream stream(1024);
+		{
+			ZipWriteStream w(stream, 6, rawDeflate);
+			ASSERT_NE(-1, w.write(data, sizeof(data)));
+			ASSERT_TRUE(w.flush());
+		}
+		uint8_t out[sizeof(data)];
+		ASSERT_EQ((int)sizeof(out), ZipReadStream::decompressInto(stream.getBuffer(), stream.size(), out, sizeof(out)));
+		EXPECT_EQ(0, memcmp(data, out, sizeof(data)));
+		// a smaller target buffer is filled completely
+		uint8_t half[sizeof(data) / 2];
+		ASSERT_EQ((int)sizeof(half), ZipReadStream::decompressInto(stream.getBuffer(), stream.size(), half, sizeof(half)));
+		EXPECT_EQ(0, memcmp(data, half, sizeof(half)));
+	}
+}
+
+TEST_F(ZipStreamTest, testDecompressIntoInvalid) {
+	const uint8_t invalid[]{0x78, 0x9c, 0xff, 0xff, 0xff, 0xff};
+	uint8_t out[16];
+	EXPECT_EQ(-1, ZipReadStream::decompressInto(invalid, sizeof(invalid), out, sizeof(out)));
+	EXPECT_EQ(-1, ZipReadStream::decompressInto(invalid, 1, out, sizeof(out)));
+}
+
+TEST_F(ZipStreamTest, testZipStreamReuseContext) {
+	BufferedReadWriteStream stream(1024);
+	{
+		ZipWriteStream w(stream);
+		for (int i = 0; i < 64; ++i) {
+			ASSERT_TRUE(w.writeInt32(i));
+		}
+		ASSERT_TRUE(w.flush());
+	}
+	const int size = (int)stream.size();
+	// the inflate state of the previous stream is reset and reused by the next one
+	for (int n = 0; n < 8; ++n) {
+		stream.seek(0);
+		ZipReadStream r(stream, size);
+		for (int i = 0; i < 64; ++i) {
+			int32_t v;
+			ASSERT_EQ(0, r.readInt32(v)) << "unexpected read failure in run " << n << " for step: " << i;
+			ASSERT_EQ(i, v) << "unexpected extracted value in run " << n << " for step: " << i;
+		}
+	}
+}
+
 } // namespace io
@@ -0,0 +1,319 @@
+/**
+ * @file
+ */
+
+#include "AABBTree.h"
+#include "core/Assert.h"
+#include <glm/common.hpp>
+
+namespace math {
+
+AABBTree::AABBTree(float margin) : _margin(margin) {
+}
+
+int AABBTree::allocateNode() {
+	if (_freeList == InvalidProxy) {
+		_nodes.push_back(TreeNode());
+		return (int)_nodes.size() - 1;
+	}
+	const int nodeIdx = _freeList;
+	_freeList = _nodes[nodeIdx].parent;
+	_nodes[nodeIdx] = TreeNode();
+	return nodeIdx;
+}
+
+void AABBTree::freeNode(int nodeIdx) {
+	TreeNode &node = _nodes[nodeIdx];
+	node.parent = _freeList;
+	node.child1 = InvalidProxy;
+	node.child2 = InvalidProxy;
+	node.height = -1;
+	_freeList = nodeIdx;
+}
+
+AABB<float> AABBTree::fatten(const AABB<float> &aabb) const {
+	const glm::vec3 margin(_margin);
+	return AABB<float>(aabb.mins() - margin, aabb.maxs() + margin);
+}
+
+AABB<float> AABBTree::combine(const AABB<float> &a, const AABB<float> &b) {
+	return AABB<float>(glm::min(a.mins(), b.mins()), glm::max(a.maxs(), b.maxs()));
+}
+
+float AABBTree::surfaceArea(const AABB<float> &aabb) {
+	const glm::vec3 &width = aabb.getWidth();
+	return 2.0f * (width.x * width.y + width.y * width.z + width.z * width.x);
+}
+
+bool AABBTree::intersectRay(const AABB<float> &aabb, const glm::vec3 &origin, const glm::vec3 &invDirection,
+							float maxDistance, float &distance) {
+	const glm::vec3 &mins = aabb.mins();
+	const glm::vec3 &maxs = aabb.maxs();
+	float tmin = 0.0f;
+	float tmax = maxDistance;
+	for (int i = 0; i < 3; ++i) {
+		float t1 = (mins[i] - origin[i]) * invDirection[i];
+		float t2 = (maxs[i] - origin[i]) * invDirection[i];
+		if (t1 > t2) {
+			const float tmp = t1;
+			t1 = t2;
+			t2 = tmp;
+		}
+		// nan comparisons are false - a ray that is parallel to and inside a slab is not limited by it
+		if (t1 > tmin) {
+			tmin = t1;
+		}
+		if (t2 < tmax) {
+			tmax = t2;
+		}
+		if (tmin > tmax) {
+			return false;
+		}
+	}
+	distance = tmin;
+	return true;
+}
+
+int AABBTree::insert(const AABB<float> &aabb, int data) {
+	const int leaf = allocateNode();
+	TreeNode &node = _nodes[leaf];
+	node.aabb = fatten(aabb);
+	node.data = data;
+	node.height = 0;
+	insertLeaf(leaf);
+	++_count;
+	return leaf;
+}
+
+void AABBTree::remove(int proxy) {
+	core_assert(proxy >= 0 && proxy < (int)_nodes.size());
+	core_assert(_nodes[proxy].isLeaf() && _nodes[proxy].height == 0);
+	removeLeaf(proxy);
+	freeNode(proxy);
+	--_count;
+}
+
+bool AABBTree::update(int proxy, const AABB<float> &aabb) {
+	core_assert(proxy >= 0 && proxy < (int)_nodes.size());
+	const AABB<float> &fatAABB = fatten(aabb);
+	const AABB<float> &current = _nodes[proxy].aabb;
+	// also re-insert if the entry shrank a lot - otherwise the queries would visit it for nothing
+	if (current.containsAABB(aabb) && surfaceArea(current) <= 4.0f * surfaceArea(fatAABB)) {
+		return false;
+	}
+	removeLeaf(proxy);
+	_nodes[proxy].aabb = fatAABB;
+	insertLeaf(proxy);
+	return true;
+}
+
+void AABBTree::clear() {
+	_nodes.clear();
+	_root = InvalidProxy;
+	_freeList = InvalidProxy;
+	_count = 0;
+}
+
+void AABBTree::insertLeaf(int leaf) {
+	if (_root == InvalidProxy) {
+		_root = leaf;
+		_nodes[_root].parent = InvalidProxy;
+		return;
+	}
+
+	// find the best sibling by the surface area heuristic
+	const AABB<float> leafAABB = _nodes[leaf].aabb;
+	int index = _root;
+	while (!_nodes[index].isLeaf()) {
+		const TreeNode &node = _nodes[index];
+		const float area = surfaceArea(node.aabb);
+		const float combinedArea = surfaceArea(combine(node.aabb, leafAABB));
+		// cost of creating a new parent for this node and the new leaf
+		const float cost = 2.0f * combinedArea;
+		// minimum cost of pushing the leaf further down the tree
+		const float inheritanceCost = 2.0f * (combinedArea - area);
+		float childCosts[2];
+		const int children[2] = {node.child1, node.child2};
+		for (int i = 0; i < 2; ++i) {
+			const TreeNode &child = _nodes[children[i]];
+			const float childArea = surfaceArea(combine(leafAABB, child.aabb));
+			if (child.isLeaf()) {
+				childCosts[i] = childArea + inheritanceCost;
+			} else {
+				childCosts[i] = childArea - surfaceArea(child.aabb) + inheritanceCost;
+			}
+		}
+		if (cost < childCosts[0] && cost < childCosts[1]) {
+			break;
+		}
+		index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+
+	const int sibling = index;
+	const int oldParent = _nodes[sibling].parent;
+	const int newParent = allocateNode();
+	TreeNode &parentNode = _nodes[newParent];
+	parentNode.parent = oldParent;
+	parentNode.aabb = combine(leafAABB, _nodes[sibling].aabb);
+	parentNode.height = _nodes[sibling].height + 1;
+	parentNode.child1 = sibling;
+	parentNode.child2 = leaf;
+	if (oldParent != InvalidProxy) {
+		if (_nodes[oldParent].child1 == sibling) {
+			_nodes[oldParent].child1 = newParent;
+		} else {
+			_nodes[oldParent].child2 = newParent;
+		}
+	} else {
+		_root = newParent;
+	}
+	_nodes[sibling].parent = newParent;
+	_nodes[leaf].parent = newParent;
+
+	// walk back up the tree fixing the heights and AABBs
+	index = _nodes[leaf].parent;
+	while (index != InvalidProxy) {
+		index = balance(index);
+		TreeNode &node = _nodes[index];
+		const TreeNode &child1 = _nodes[node.child1];
+		const TreeNode &child2 = _nodes[node.child2];
+		node.height = 1 + glm::max(child1.height, child2.height);
+		node.aabb = combine(child1.aabb, child2.aabb);
+		index = node.parent;
+	}
+}
+
+void AABBTree::removeLeaf(int leaf) {
+	if (leaf == _root) {
+		_root = InvalidProxy;
+		return;
+	}
+
+	const int parent = _nodes[leaf].parent;
+	const int grandParent = _nodes[parent].parent;
+	const int sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+	if (grandParent == InvalidProxy) {
+		_root = sibling;
+		_nodes[sibling].parent = InvalidProxy;
+		freeNode(parent);
+		return;
+	}
+
+	// destroy the parent and connect the sibling to the grand parent
+	if (_nodes[grandParent].child1 == parent) {
+		_nodes[grandParent].child1 = sibling;
+	} else {
+		_nodes[grandParent].child2 = sibling;
+	}
+	_nodes[sibling].parent = grandParent;
+	freeNode(parent);
+
+	int index = grandParent;
+	while (index != InvalidProxy) {
+		index = balance(index);
+		TreeNode &node = _nodes[index];
+		const TreeNode &child1 = _nodes[node.child1];
+		const TreeNode &child2 = _nodes[node.child2];
+		node.aabb = combine(child1.aabb, child2.aabb);
+		node.height = 1 + glm::max(child1.height, child2.height);
+		index = node.parent;
+	}
+}
+
+int AABBTree::balance(int iA) {
+	TreeNode *a = &_nodes[iA];
+	if (a->isLeaf() || a->height < 2) {
+		return iA;
+	}
+
+	const int iB = a->child1;
+	const int iC = a->child2;
+	TreeNode *b = &_nodes[iB];
+	TreeNode *c = &_nodes[iC];
+	const int balanceFactor = c->height - b->height;
+
+	// rotate c up
+	if (balanceFactor > 1) {
+		const int iF = c->child1;
+		const int iG = c->child2;
+		TreeNode *f = &_nodes[iF];
+		TreeNode *g = &_nodes[iG];
+
+		c->child1 = iA;
+		c->parent = a->parent;
+		a->parent = iC;
+		if (c->parent != InvalidProxy) {
+			if (_nodes[c->parent].child1 == iA) {
+				_nodes[c->parent].child1 = iC;
+			} else {
+				_nodes[c->parent].child2 = iC;
+			}
+		} else {
+			_root = iC;
+		}
+
+		if (f->height > g->height) {
+			c->child2 = iF;
+			a->child2 = iG;
+			g->parent = iA;
+			a->aabb = combine(b->aabb, g->aabb);
+			c->aabb = combine(a->aabb, f->aabb);
+			a->height = 1 + glm::max(b->height, g->height);
+			c->height = 1 + glm::max(a->height, f->height);
+		} else {
+			c->child2 = iG;
+			a->child2 = iF;
+			f->parent = iA;
+			a->aabb = combine(b->aabb, f->aabb);
+			c->aabb = combine(a->aabb, g->aabb);
+			a->height = 1 + glm::max(b->height, f->height);
+			c->height = 1 + glm::max(a->height, g->height);
+		}
+		return iC;
+	}
+
+	// rotate b up
+	if (balanceFactor < -1) {
+		const int iD = b->child1;
+		const int iE = b->child2;
+		TreeNode *d = &_nodes[iD];
+		TreeNode *e = &_nodes[iE];
+
+		b->child1 = iA;
+		b->parent = a->parent;
+		a->parent = iB;
+		if (b->parent != InvalidProxy) {
+			if (_nodes[b->parent].child1 == iA) {
+				_nodes[b->parent].child1 = iB;
+			} else {
+				_nodes[b->parent].child2 = iB;
+			}
+		} else {
+			_root = iB;
+		}
+
+		if (d->height > e->height) {
+			b->child2 = iD;
+			a->child1 = iE;
+			e->parent = iA;
+			a->aabb = combine(c->aabb, e->aabb);
+			b->aabb = combine(a->aabb, d->aabb);
+			a->height = 1 + glm::max(c->height, e->height);
+			b->height = 1 + glm::max(a->height, d->height);
+		} else {
+			b->child2 = iE;
+			a->child1 = iD;
+			d->parent = iA;
+			a->aabb = combine(c->aabb, d->aabb);
+			b->aabb = combine(a->aabb, e->aabb);
+			a->height = 1 + glm::max(c->height, d->height);
+			b->height = 1 + glm::max(a->height, e->height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+} // namespace math
@@ -0,0 +1,215 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "AABB.h"
+#include "Frustum.h"
+#include "Ray.h"
+#include "core/Trace.h"
+#include "core/collection/Buffer.h"
+#include "core/collection/DynamicArray.h"
+
+namespace math {
+
+/**
+ * @brief Bounding volume hierarchy for AABBs that are added, removed or changed at any time
+ *
+ * The leaves store the given AABB enlarged by a margin - an @c update() only modifies the tree if the new AABB is
+ * no longer contained in the enlarged one. The tree is kept balanced by rotations when leaves are inserted or
+ * removed, so the queries are logarithmic in the amount of entries.
+ *
+ * Unlike @c Octree the tree doesn't need to know the bounds of the whole area up front.
+ */
+class AABBTree {
+public:
+	static constexpr int InvalidProxy = -1;
+
+private:
+	struct TreeNode {
+		AABB<float> aabb;
+		/** the parent node - or the next free node if this node is not in use */
+		int parent = InvalidProxy;
+		int child1 = InvalidProxy;
+		int child2 = InvalidProxy;
+		/** leaves have a height of @c 0 - free nodes @c -1 */
+		int height = -1;
+		int data = 0;
+
+		inline bool isLeaf() const {
+			return child1 == InvalidProxy;
+		}
+	};
+	core::DynamicArray<TreeNode> _nodes;
+	int _root = InvalidProxy;
+	int _freeList = InvalidProxy;
+	int _count = 0;
+	float _margin;
+
+	int allocateNode();
+	void freeNode(int nodeIdx);
+	void insertLeaf(int leaf);
+	void removeLeaf(int leaf);
+	int balance(int nodeIdx);
+	AABB<float> fatten(const AABB<float> &aabb) const;
+	static AABB<float> combine(const AABB<float> &a, const AABB<float> &b);
+	static float surfaceArea(const AABB<float> &aabb);
+	static bool intersectRay(const AABB<float> &aabb, const glm::vec3 &origin, const glm::vec3 &invDirection,
+							 float maxDistance, float &distance);
+
+public:
+	/**
+	 * @param[in] margin The amount the AABBs are enlarged in every direction to avoid tree updates for small
+	 * movements
+	 */
+	AABBTree(float margin = 1.0f);
+
+	/**
+	 * @return The proxy id that must be used to @c update() or @c remove() the entry
+	 */
+	int insert(const AABB<float> &aabb, int data);
+	void remove(int proxy);
+	/**
+	 * @return @c true if the tree had to be modified, @c false if the new AABB is still inside the enlarged AABB
+	 */
+	bool update(int proxy, const AABB<float> &aabb);
+	void clear();
+
+	int data(int proxy) const;
+	/**
+	 * @return The enlarged AABB of the given proxy
+	 */
+	const AABB<float> &aabb(int proxy) const;
+	/**
+	 * @return The amount of entries in the tree
+	 */
+	int size() const;
+	bool empty() const;
+	/**
+	 * @return The height of the tree - @c 0 if the tree is empty or only has one entry
+	 */
+	int height() const;
+
+	/**
+	 * @brief Calls the given function with the data of all entries whose AABB intersects the given AABB
+	 * @note The enlarged AABBs are tested - the caller has to do the exact test if needed
+	 * @param func @c bool(int data) - return @c false to stop the query
+	 */
+	template<class FUNC>
+	void query(const AABB<float> &area, FUNC &&func) const {
+		core_trace_scoped(AABBTreeQuery);
+		if (_root == InvalidProxy) {
+			return;
+		}
+		core::Buffer<int, 64> stack;
+		stack.push_back(_root);
+		while (!stack.empty()) {
+			const int nodeIdx = stack.back();
+			stack.pop();
+			const TreeNode &node = _nodes[nodeIdx];
+			if (!intersects(node.aabb, area)) {
+				continue;
+			}
+			if (node.isLeaf()) {
+				if (!func(node.data)) {
+					return;
+				}
+				continue;
+			}
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+
+	/**
+	 * @brief Calls the given function with the data of all entries whose AABB is visible in the given frustum
+	 * @param func @c bool(int data) - return @c false to stop the query
+	 */
+	template<class FUNC>
+	void query(const Frustum &frustum, FUNC &&func) const {
+		core_trace_scoped(AABBTreeQueryFrustum);
+		if (_root == InvalidProxy) {
+			return;
+		}
+		core::Buffer<int, 64> stack;
+		stack.push_back(_root);
+		while (!stack.empty()) {
+			const int nodeIdx = stack.back();
+			stack.pop();
+			const TreeNode &node = _nodes[nodeIdx];
+			const FrustumResult result = frustum.test(node.aabb.mins(), node.aabb.maxs());
+			if (result == FrustumResult::Outside) {
+				continue;
+			}
+			if (node.isLeaf()) {
+				if (!func(node.data)) {
+					return;
+				}
+				continue;
+			}
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+
+	/**
+	 * @brief Calls the given function with the data of all entries whose AABB is hit by the given ray
+	 * @param func @c float(int data, float distance) - the distance is the distance to the enlarged AABB. Return
+	 * a negative value to stop the query, or the new max distance to skip the entries that are further away - e.g.
+	 * the distance to the closest exact hit so far.
+	 */
+	template<class FUNC>
+	void raycast(const Ray &ray, float maxDistance, FUNC &&func) const {
+		core_trace_scoped(AABBTreeRaycast);
+		if (_root == InvalidProxy) {
+			return;
+		}
+		const glm::vec3 invDirection(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+		core::Buffer<int, 64> stack;
+		stack.push_back(_root);
+		while (!stack.empty()) {
+			const int nodeIdx = stack.back();
+			stack.pop();
+			const TreeNode &node = _nodes[nodeIdx];
+			float distance;
+			if (!intersectRay(node.aabb, ray.origin, invDirection, maxDistance, distance)) {
+				continue;
+			}
+			if (node.isLeaf()) {
+				maxDistance = func(node.data, distance);
+				if (maxDistance < 0.0f) {
+					return;
+				}
+				continue;
+			}
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+};
+
+inline int AABBTree::data(int proxy) const {
+	return _nodes[proxy].data;
+}
+
+inline const AABB<float> &AABBTree::aabb(int proxy) const {
+	return _nodes[proxy].aabb;
+}
+
+inline int AABBTree::size() const {
+	return _count;
+}
+
+inline bool AABBTree::empty() const {
+	return _count == 0;
+}
+
+inline int AABBTree::height() const {
+	if (_root == InvalidProxy) {
+		return 0;
+	}
+	return _nodes[_root].height;
+}
+
+} // namespace math
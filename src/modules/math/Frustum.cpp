@@ -4,14 +4,117 @@
 
 #include "Frustum.h"
 #include "core/Trace.h"
+#include "core/ArrayLength.h"
 #include "core/Assert.h"
+#include "core/Bits.h"
 #include "core/GLM.h"
 #include "math/AABB.h"
+#include "private/FrustumCulling.h"
+#include <SDL_cpuinfo.h>
 #include <glm/gtc/matrix_access.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#if defined(MATH_SIMD_X86) && (defined(__SSE2__) || defined(_M_X64))
+#define MATH_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define MATH_SIMD_NEON
+#include <arm_neon.h>
+#endif
 
 namespace math {
 
+void FrustumBoxes::clear() {
+	for (int i = 0; i < lengthof(_coords); ++i) {
+		_coords[i].clear();
+	}
+	_size = 0;
+}
+
+void FrustumBoxes::reserve(int boxes) {
+	const int padded = (boxes + Lanes - 1) / Lanes * Lanes;
+	for (int i = 0; i < lengthof(_coords); ++i) {
+		_coords[i].reserve(padded);
+	}
+}
+
+int FrustumBoxes::add(const glm::vec3& mins, const glm::vec3& maxs) {
+	if (_size % Lanes == 0) {
+		for (int i = 0; i < lengthof(_coords); ++i) {
+			_coords[i].resize(_size + Lanes);
+		}
+	}
+	for (int axis = 0; axis < 3; ++axis) {
+		_coords[axis][_size] = mins[axis];
+		_coords[3 + axis][_size] = maxs[axis];
+	}
+	return _size++;
+}
+
+namespace priv {
+
+void cullBoxesScalar(const CullPlane *planes, int planeCount, int boxes, uint32_t *visible) {
+	for (int i = 0; i < boxes; ++i) {
+		bool inside = true;
+		for (int p = 0; p < planeCount && inside; ++p) {
+			const CullPlane &plane = planes[p];
+			const float distance = plane.normal[0] * plane.positive[0][i] + plane.normal[1] * plane.positive[1][i] +
+								   plane.normal[2] * plane.positive[2][i] + plane.dist;
+			inside = !(distance < 0.0f);
+		}
+		if (inside) {
+			visible[i / 32] |= 1u << (i % 32);
+		}
+	}
+}
+
+#ifdef MATH_SIMD_SSE2
+// sse2 is always available on x86_64
+static void cullBoxesSSE2(const CullPlane *planes, int planeCount, int boxes, uint32_t *visible) {
+	const __m128 zero = _mm_setzero_ps();
+	for (int i = 0; i < boxes; i += 4) {
+		__m128 outside = zero;
+		for (int p = 0; p < planeCount; ++p) {
+			const CullPlane &plane = planes[p];
+			const __m128 x = _mm_mul_ps(_mm_set1_ps(plane.normal[0]), _mm_loadu_ps(plane.positive[0] + i));
+			const __m128 y = _mm_mul_ps(_mm_set1_ps(plane.normal[1]), _mm_loadu_ps(plane.positive[1] + i));
+			const __m128 z = _mm_mul_ps(_mm_set1_ps(plane.normal[2]), _mm_loadu_ps(plane.positive[2] + i));
+			const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(x, y), z), _mm_set1_ps(plane.dist));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, zero));
+		}
+		const uint32_t mask = (uint32_t)_mm_movemask_ps(outside) ^ 0xfu;
+		visible[i / 32] |= mask << (i % 32);
+	}
+}
+#endif
+
+#ifdef MATH_SIMD_NEON
+// neon is always available on arm64 - the multiply and add are not fused to match the scalar version
+static void cullBoxesNEON(const CullPlane *planes, int planeCount, int boxes, uint32_t *visible) {
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	static const uint32_t laneBits[4] = {1u, 2u, 4u, 8u};
+	const uint32x4_t bits = vld1q_u32(laneBits);
+	for (int i = 0; i < boxes; i += 4) {
+		uint32x4_t outside = vdupq_n_u32(0u);
+		for (int p = 0; p < planeCount; ++p) {
+			const CullPlane &plane = planes[p];
+			const float32x4_t x = vmulq_n_f32(vld1q_f32(plane.positive[0] + i), plane.normal[0]);
+			const float32x4_t y = vmulq_n_f32(vld1q_f32(plane.positive[1] + i), plane.normal[1]);
+			const float32x4_t z = vmulq_n_f32(vld1q_f32(plane.positive[2] + i), plane.normal[2]);
+			const float32x4_t distance = vaddq_f32(vaddq_f32(vaddq_f32(x, y), z), vdupq_n_f32(plane.dist));
+			outside = vorrq_u32(outside, vcltq_f32(distance, zero));
+		}
+		const uint32_t mask = vaddvq_u32(vbicq_u32(bits, outside));
+		visible[i / 32] |= mask << (i % 32);
+	}
+}
+#endif
+
+#ifdef MATH_SIMD_X86
+static const bool s_hasAVX = SDL_HasAVX();
+#endif
+
+} // namespace priv
+
 Frustum::Frustum(const glm::vec3& mins, const glm::vec3& maxs) {
 	update(glm::mat4(1.0f), mins, maxs);
 }
@@ -170,6 +273,52 @@ bool Frustum::isVisible(const glm::vec3& mins, const glm::vec3& maxs) const {
 	return true;
 }
 
+int Frustum::isVisible(const FrustumBoxes& boxes, core::DynamicArray<uint32_t>& visible) const {
+	core_trace_scoped(FrustumIsVisibleBatch);
+	const int size = boxes.size();
+	visible.clear();
+	visible.resize((size + 31) / 32);
+	if (size == 0) {
+		return 0;
+	}
+	priv::CullPlane planes[FRUSTUM_PLANES_MAX];
+	for (uint8_t i = 0; i < FRUSTUM_PLANES_MAX; ++i) {
+		const Plane& p = _planes[i];
+		const glm::vec3& normal = p.norm();
+		priv::CullPlane& plane = planes[i];
+		for (int axis = 0; axis < 3; ++axis) {
+			plane.normal[axis] = normal[axis];
+			plane.positive[axis] = normal[axis] > 0.0f ? boxes.maxs(axis) : boxes.mins(axis);
+		}
+		plane.dist = p.dist();
+	}
+	const int padded = (size + FrustumBoxes::Lanes - 1) / FrustumBoxes::Lanes * FrustumBoxes::Lanes;
+#if defined(MATH_SIMD_X86)
+	if (priv::s_hasAVX) {
+		priv::cullBoxesAVX(planes, FRUSTUM_PLANES_MAX, padded, visible.data());
+	} else {
+#if defined(MATH_SIMD_SSE2)
+		priv::cullBoxesSSE2(planes, FRUSTUM_PLANES_MAX, padded, visible.data());
+#else
+		priv::cullBoxesScalar(planes, FRUSTUM_PLANES_MAX, padded, visible.data());
+#endif
+	}
+#elif defined(MATH_SIMD_NEON)
+	priv::cullBoxesNEON(planes, FRUSTUM_PLANES_MAX, padded, visible.data());
+#else
+	priv::cullBoxesScalar(planes, FRUSTUM_PLANES_MAX, padded, visible.data());
+#endif
+	// the padding boxes are not visible
+	if (size % 32 != 0) {
+		visible.back() &= (1u << (size % 32)) - 1u;
+	}
+	int count = 0;
+	for (uint32_t word : visible) {
+		count += core::popCount(word);
+	}
+	return count;
+}
+
 bool Frustum::isVisible(const glm::vec3& center, float radius) const {
 	for (uint8_t i = 0; i < FRUSTUM_PLANES_MAX; ++i) {
 		const Plane& p = _planes[i];
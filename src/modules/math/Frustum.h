@@ -5,6 +5,7 @@
 #pragma once
 
 #include "Plane.h"
+#include "core/collection/DynamicArray.h"
 #include <stdint.h>
 
 namespace math {
@@ -29,6 +30,42 @@ enum class FrustumResult {
 	Intersect
 };
 
+/**
+ * @brief Axis aligned bounding boxes stored as structure of arrays to test them in one batch with
+ * Frustum::isVisible(const FrustumBoxes&, core::DynamicArray<uint32_t>&)
+ *
+ * The arrays are padded to a multiple of @c Lanes entries - so the vectorized kernels don't need a scalar tail.
+ */
+class FrustumBoxes {
+public:
+	static constexpr int Lanes = 8;
+
+private:
+	// the min x, y, z and max x, y, z coordinates of all boxes
+	core::DynamicArray<float> _coords[6];
+	int _size = 0;
+
+public:
+	void clear();
+	void reserve(int boxes);
+	/**
+	 * @return The index of the box - that is the bit index in the visibility mask
+	 */
+	int add(const glm::vec3& mins, const glm::vec3& maxs);
+
+	int size() const {
+		return _size;
+	}
+
+	const float* mins(int axis) const {
+		return _coords[axis].data();
+	}
+
+	const float* maxs(int axis) const {
+		return _coords[3 + axis].data();
+	}
+};
+
 class Frustum {
 private:
 	Plane _planes[FRUSTUM_PLANES_MAX];
@@ -58,6 +95,23 @@ public:
 
 	bool isVisible(const glm::vec3& center, float radius) const;
 
+	/**
+	 * @brief Tests all boxes against the planes - the result is the same as calling
+	 * isVisible(const glm::vec3&, const glm::vec3&) for each box, but the boxes are tested with SSE2, AVX or NEON
+	 * @param[out] visible The visibility bitmask - bit @c i % 32 of the entry @c i / 32 is set if the box @c i is
+	 * visible
+	 * @return The amount of visible boxes
+	 */
+	int isVisible(const FrustumBoxes& boxes, core::DynamicArray<uint32_t>& visible) const;
+
+	/**
+	 * @return @c true if the bit of the given box index is set in the visibility mask of
+	 * isVisible(const FrustumBoxes&, core::DynamicArray<uint32_t>&)
+	 */
+	static bool isVisible(const core::DynamicArray<uint32_t>& visible, int box) {
+		return (visible[box / 32] & (1u << (box % 32))) != 0u;
+	}
+
 	void split(const glm::mat4& transform, glm::vec3 out[FRUSTUM_VERTICES_MAX]) const;
 
 	void updateVertices(const glm::mat4& view, const glm::mat4& projection);
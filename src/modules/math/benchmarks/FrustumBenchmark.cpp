@@ -0,0 +1,53 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "math/Frustum.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+class FrustumBenchmark : public app::AbstractBenchmark {
+protected:
+	math::Frustum _frustum;
+	math::FrustumBoxes _boxes;
+
+	// a grid of chunk sized boxes around the camera - roughly half of them are visible
+	void setup(int boxes) {
+		_frustum.update(glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+						glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 2000.0f));
+		_boxes.clear();
+		_boxes.reserve(boxes);
+		const int side = (int)glm::ceil(glm::pow((float)boxes, 1.0f / 3.0f));
+		for (int i = 0; i < boxes; ++i) {
+			const glm::vec3 pos((float)(i % side), (float)((i / side) % side), (float)(i / (side * side)));
+			const glm::vec3 mins = (pos - (float)side * 0.5f) * 32.0f;
+			_boxes.add(mins, mins + 32.0f);
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(FrustumBenchmark, IsVisible)(benchmark::State &state) {
+	setup((int)state.range(0));
+	for (auto _ : state) {
+		int visible = 0;
+		for (int i = 0; i < _boxes.size(); ++i) {
+			const glm::vec3 mins(_boxes.mins(0)[i], _boxes.mins(1)[i], _boxes.mins(2)[i]);
+			const glm::vec3 maxs(_boxes.maxs(0)[i], _boxes.maxs(1)[i], _boxes.maxs(2)[i]);
+			visible += _frustum.isVisible(mins, maxs) ? 1 : 0;
+		}
+		benchmark::DoNotOptimize(visible);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(FrustumBenchmark, IsVisibleBatch)(benchmark::State &state) {
+	setup((int)state.range(0));
+	core::DynamicArray<uint32_t> visible;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(_frustum.isVisible(_boxes, visible));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_REGISTER_F(FrustumBenchmark, IsVisible)->RangeMultiplier(8)->Range(512, 32768);
+BENCHMARK_REGISTER_F(FrustumBenchmark, IsVisibleBatch)->RangeMultiplier(8)->Range(512, 32768);
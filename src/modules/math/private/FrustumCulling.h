@@ -0,0 +1,35 @@
+/**
+ * @file
+ *
+ * The kernels of math::Frustum::isVisible(const FrustumBoxes&, core::DynamicArray<uint32_t>&) - this is also included
+ * by the translation units that are compiled with other instruction sets, so only plain data is used here.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace math {
+namespace priv {
+
+struct CullPlane {
+	float normal[3];
+	float dist;
+	// the coordinates of the box corners that are the farthest along the plane normal (the positive vertices)
+	const float *positive[3];
+};
+
+/**
+ * @brief Sets the bits of the boxes that are in front of all planes
+ * @param boxes The amount of boxes - must be a multiple of the lanes of all kernels (FrustumBoxes::Lanes)
+ * @param visible Must be zeroed and have room for one bit per box
+ */
+void cullBoxesScalar(const CullPlane *planes, int planeCount, int boxes, uint32_t *visible);
+
+#ifdef MATH_SIMD_X86
+// see private/FrustumCullingAVX.cpp
+void cullBoxesAVX(const CullPlane *planes, int planeCount, int boxes, uint32_t *visible);
+#endif
+
+} // namespace priv
+} // namespace math
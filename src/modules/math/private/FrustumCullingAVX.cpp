@@ -0,0 +1,39 @@
+/**
+ * @file
+ *
+ * Compiled with AVX enabled - only called if the cpu supports it. Don't include anything but the kernel here.
+ */
+
+#ifdef MATH_SIMD_X86
+
+#include "FrustumCulling.h"
+#include <immintrin.h>
+
+namespace math {
+namespace priv {
+
+/**
+ * The distance is computed in the same order as glm::dot() + dist in Plane::distanceToPlane() - and without fma - so
+ * the result is identical to the scalar version.
+ */
+void cullBoxesAVX(const CullPlane *planes, int planeCount, int boxes, uint32_t *visible) {
+	const __m256 zero = _mm256_setzero_ps();
+	for (int i = 0; i < boxes; i += 8) {
+		__m256 outside = zero;
+		for (int p = 0; p < planeCount; ++p) {
+			const CullPlane &plane = planes[p];
+			const __m256 x = _mm256_mul_ps(_mm256_set1_ps(plane.normal[0]), _mm256_loadu_ps(plane.positive[0] + i));
+			const __m256 y = _mm256_mul_ps(_mm256_set1_ps(plane.normal[1]), _mm256_loadu_ps(plane.positive[1] + i));
+			const __m256 z = _mm256_mul_ps(_mm256_set1_ps(plane.normal[2]), _mm256_loadu_ps(plane.positive[2] + i));
+			const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), _mm256_set1_ps(plane.dist));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, zero, _CMP_LT_OQ));
+		}
+		const uint32_t mask = (uint32_t)_mm256_movemask_ps(outside) ^ 0xffu;
+		visible[i / 32] |= mask << (i % 32);
+	}
+}
+
+} // namespace priv
+} // namespace math
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @file
+ */
+
+#include "math/AABBTree.h"
+#include "app/tests/AbstractTest.h"
+#include "core/collection/DynamicArray.h"
+
+namespace math {
+
+class AABBTreeTest : public app::AbstractTest {
+protected:
+	static AABB<float> box(float x, float size = 1.0f) {
+		return AABB<float>(glm::vec3(x, 0.0f, 0.0f), glm::vec3(x + size, size, size));
+	}
+
+	static core::DynamicArray<int> query(const AABBTree &tree, const AABB<float> &area) {
+		core::DynamicArray<int> results;
+		tree.query(area, [&](int data) {
+			results.push_back(data);
+			return true;
+		});
+		results.sort([](int a, int b) { return a < b; });
+		return results;
+	}
+};
+
+TEST_F(AABBTreeTest, testInsertQuery) {
+	AABBTree tree(0.0f);
+	for (int i = 0; i < 100; ++i) {
+		tree.insert(box((float)i * 10.0f), i);
+	}
+	EXPECT_EQ(100, tree.size());
+	// the tree is balanced even though the entries are inserted in order
+	EXPECT_LE(tree.height(), 14);
+
+	const core::DynamicArray<int> &results = query(tree, AABB<float>(glm::vec3(19.5f, 0.0f, 0.0f), glm::vec3(30.5f, 1.0f, 1.0f)));
+	ASSERT_EQ(2u, results.size());
+	EXPECT_EQ(2, results[0]);
+	EXPECT_EQ(3, results[1]);
+	EXPECT_TRUE(query(tree, AABB<float>(glm::vec3(0.0f, 5.0f, 0.0f), glm::vec3(1000.0f, 6.0f, 1.0f))).empty());
+}
+
+TEST_F(AABBTreeTest, testUpdateRemove) {
+	AABBTree tree(0.5f);
+	const int proxy1 = tree.insert(box(0.0f), 1);
+	const int proxy2 = tree.insert(box(10.0f), 2);
+	// inside the margin - no tree update needed
+	EXPECT_FALSE(tree.update(proxy1, box(0.25f)));
+	EXPECT_TRUE(tree.update(proxy1, box(100.0f)));
+	EXPECT_EQ(1, tree.data(proxy1));
+
+	core::DynamicArray<int> results = query(tree, box(100.0f));
+	ASSERT_EQ(1u, results.size());
+	EXPECT_EQ(1, results[0]);
+	EXPECT_TRUE(query(tree, box(0.0f)).empty());
+
+	tree.remove(proxy2);
+	EXPECT_EQ(1, tree.size());
+	EXPECT_TRUE(query(tree, box(10.0f)).empty());
+	tree.remove(proxy1);
+	EXPECT_TRUE(tree.empty());
+	EXPECT_TRUE(query(tree, box(100.0f)).empty());
+}
+
+TEST_F(AABBTreeTest, testRaycast) {
+	AABBTree tree(0.0f);
+	for (int i = 0; i < 10; ++i) {
+		tree.insert(box((float)i * 10.0f), i);
+	}
+	const Ray ray(glm::vec3(-5.0f, 0.5f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f));
+	int closest = -1;
+	float closestDistance = 1000.0f;
+	int hits = 0;
+	tree.raycast(ray, closestDistance, [&](int data, float distance) {
+		++hits;
+		if (distance < closestDistance) {
+			closestDistance = distance;
+			closest = data;
+		}
+		return closestDistance;
+	});
+	EXPECT_EQ(0, closest);
+	EXPECT_FLOAT_EQ(5.0f, closestDistance);
+	EXPECT_GE(hits, 1);
+
+	hits = 0;
+	const Ray miss(glm::vec3(-5.0f, 5.0f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f));
+	tree.raycast(miss, 1000.0f, [&](int data, float distance) {
+		++hits;
+		return 1000.0f;
+	});
+	EXPECT_EQ(0, hits);
+}
+
+} // namespace math
@@ -87,6 +87,34 @@ TEST_F(FrustumTest, testCullingAABBNegative) {
 	EXPECT_FALSE(_frustum.isVisible(aabb.getLowerCorner(), aabb.getUpperCorner())) << "AABB is not visible but should be";
 }
 
+TEST_F(FrustumTest, testCullingAABBBatch) {
+	// not a multiple of the lanes or mask bits to test the padding
+	FrustumBoxes boxes;
+	for (int x = -5; x <= 5; ++x) {
+		for (int y = -5; y <= 5; ++y) {
+			for (int z = -5; z <= 5; ++z) {
+				const glm::vec3 mins((float)x * 60.0f, (float)y * 60.0f, (float)z * 60.0f);
+				EXPECT_EQ(boxes.size(), boxes.add(mins, mins + glm::vec3(10.0f + (float)(x + 5))));
+			}
+		}
+	}
+	core::DynamicArray<uint32_t> visible;
+	const int count = _frustum.isVisible(boxes, visible);
+	ASSERT_EQ((boxes.size() + 31) / 32, (int)visible.size());
+	int expected = 0;
+	for (int i = 0; i < boxes.size(); ++i) {
+		const glm::vec3 mins(boxes.mins(0)[i], boxes.mins(1)[i], boxes.mins(2)[i]);
+		const glm::vec3 maxs(boxes.maxs(0)[i], boxes.maxs(1)[i], boxes.maxs(2)[i]);
+		const bool v = _frustum.isVisible(mins, maxs);
+		EXPECT_EQ(v, Frustum::isVisible(visible, i)) << toString(mins);
+		expected += v ? 1 : 0;
+	}
+	EXPECT_GT(expected, 0);
+	EXPECT_LT(expected, boxes.size());
+	EXPECT_EQ(expected, count);
+	EXPECT_EQ(0u, visible.back() >> (boxes.size() % 32)) << "The padding boxes must not be visible";
+}
+
 TEST_F(FrustumTest, testInsideOutsidePoint) {
 	EXPECT_EQ(math::FrustumResult::Inside, _frustum.test(glm::vec3(_nearPlane, 0.0, 0.0)));
 	EXPECT_EQ(math::FrustumResult::Outside, _frustum.test(glm::vec3(0.0, 0.0, 0.0)));
@@ -4,17 +4,21 @@
 
 #include "MementoHandler.h"
 
+#include "app/Async.h"
 #include "command/Command.h"
+#include "core/Algorithm.h"
 #include "core/ArrayLength.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/MemoryTracker.h"
+#include "core/PerfStats.h"
 #include "core/ScopedPtr.h"
 #include "core/StandardLib.h"
 #include "core/StringUtil.h"
 #include "io/BufferedReadWriteStream.h"
+#include "io/LZ4ReadStream.h"
+#include "io/LZ4WriteStream.h"
 #include "io/MemoryReadStream.h"
-#include "io/ZipReadStream.h"
-#include "io/ZipWriteStream.h"
 #include "palette/NormalPalette.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/RawVolume.h"
@@ -31,14 +35,14 @@ MementoState::MementoState() : type(MementoType::Max), nodeType(scenegraph::Scen
 }
 
 MementoState::MementoState(const MementoState &other)
-	: type(other.type), data(other.data), parentUUID(other.parentUUID), nodeUUID(other.nodeUUID),
+	: type(other.type), data(other.data), undoData(other.undoData), parentUUID(other.parentUUID), nodeUUID(other.nodeUUID),
 	  referenceUUID(other.referenceUUID), nodeType(other.nodeType), keyFrames(other.keyFrames),
 	  properties(other.properties), name(other.name), pivot(other.pivot), palette(other.palette),
 	  normalPalette(other.normalPalette), stringList(other.stringList) {
 }
 
 MementoState::MementoState(MementoType _type, const MementoState &other)
-	: type(_type), data(other.data), parentUUID(other.parentUUID), nodeUUID(other.nodeUUID),
+	: type(_type), data(other.data), undoData(other.undoData), parentUUID(other.parentUUID), nodeUUID(other.nodeUUID),
 	  referenceUUID(other.referenceUUID), nodeType(other.nodeType), keyFrames(other.keyFrames),
 	  properties(other.properties), name(other.name), pivot(other.pivot), palette(other.palette),
 	  normalPalette(other.normalPalette), stringList(other.stringList) {
@@ -47,6 +51,7 @@ MementoState::MementoState(MementoType _type, const MementoState &other)
 MementoState::MementoState(MementoState &&other) noexcept {
 	type = other.type;
 	data = core::move(other.data);
+	undoData = core::move(other.undoData);
 	parentUUID = other.parentUUID;
 	nodeUUID = other.nodeUUID;
 	referenceUUID = other.referenceUUID;
@@ -66,6 +71,7 @@ MementoState &MementoState::operator=(MementoState &&other) noexcept {
 	}
 	type = other.type;
 	data = core::move(other.data);
+	undoData = core::move(other.undoData);
 	parentUUID = other.parentUUID;
 	nodeUUID = other.nodeUUID;
 	referenceUUID = other.referenceUUID;
@@ -86,6 +92,7 @@ MementoState &MementoState::operator=(const MementoState &other) {
 	}
 	type = other.type;
 	data = other.data;
+	undoData = other.undoData;
 	parentUUID = other.parentUUID;
 	nodeUUID = other.nodeUUID;
 	referenceUUID = other.referenceUUID;
@@ -100,8 +107,8 @@ MementoState &MementoState::operator=(const MementoState &other) {
 	return *this;
 }
 
-MementoState::MementoState(MementoType _type, const MementoData &_data, const core::String &_parentId,
-						   const core::String &_nodeId, const core::String &_referenceId, const core::String &_name,
+MementoState::MementoState(MementoType _type, const MementoData &_data, const core::UUID &_parentId,
+						   const core::UUID &_nodeId, const core::UUID &_referenceId, const core::String &_name,
 						   scenegraph::SceneGraphNodeType _nodeType, const glm::vec3 &_pivot,
 						   const scenegraph::SceneGraphKeyFramesMap &_keyFrames, const palette::Palette &_palette,
 						   const palette::NormalPalette &_normalPalette,
@@ -111,8 +118,8 @@ MementoState::MementoState(MementoType _type, const MementoData &_data, const co
 	  palette(_palette), normalPalette(_normalPalette) {
 }
 
-MementoState::MementoState(MementoType _type, MementoData &&_data, core::String &&_parentId, core::String &&_nodeId,
-						   core::String &&_referenceId, core::String &&_name, scenegraph::SceneGraphNodeType _nodeType,
+MementoState::MementoState(MementoType _type, MementoData &&_data, const core::UUID &_parentId, const core::UUID &_nodeId,
+						   const core::UUID &_referenceId, core::String &&_name, scenegraph::SceneGraphNodeType _nodeType,
 						   glm::vec3 &&_pivot, scenegraph::SceneGraphKeyFramesMap &&_keyFrames,
 						   palette::Palette &&_palette, palette::NormalPalette &&_normalPalette,
 						   scenegraph::SceneGraphNodeProperties &&_properties)
@@ -126,7 +133,7 @@ MementoState::MementoState(MementoType _type, const core::DynamicArray<core::Str
 }
 
 MementoData::MementoData(uint8_t *buf, size_t bufSize, const voxel::Region &region)
-	: _compressedSize(bufSize), _region(region) {
+	: _compressedSize(bufSize), _region(region), _volumeRegion(region) {
 	if (buf != nullptr) {
 		core_assert(_compressedSize > 0);
 		_buffer = buf;
@@ -135,8 +142,21 @@ MementoData::MementoData(uint8_t *buf, size_t bufSize, const voxel::Region &regi
 	}
 }
 
+MementoData::MementoData(uint8_t *buf, size_t bufSize, const voxel::Region &region,
+						 const voxel::Region &volumeRegion, bool delta, bool bricks)
+	: MementoData(buf, bufSize, region) {
+	_volumeRegion = volumeRegion;
+	_delta = delta;
+	_bricks = bricks;
+}
+
+MementoData::MementoData(const MementoCompression &pending, const voxel::Region &region,
+						 const voxel::Region &volumeRegion, bool bricks)
+	: _pending(pending), _region(region), _volumeRegion(volumeRegion), _bricks(bricks) {
+}
+
 MementoData::MementoData(const uint8_t *buf, size_t bufSize, const voxel::Region &region)
-	: _compressedSize(bufSize), _region(region) {
+	: _compressedSize(bufSize), _region(region), _volumeRegion(region) {
 	if (buf != nullptr) {
 		core_assert(_compressedSize > 0);
 		_buffer = (uint8_t *)core_malloc(_compressedSize);
@@ -147,9 +167,12 @@ MementoData::MementoData(const uint8_t *buf, size_t bufSize, const voxel::Region
 }
 
 MementoData::MementoData(MementoData &&o) noexcept
-	: _compressedSize(o._compressedSize), _buffer(o._buffer), _region(o._region) {
+	: _compressedSize(o._compressedSize), _buffer(o._buffer), _pending(core::move(o._pending)),
+	  _spillFile(core::move(o._spillFile)), _spillOffset(o._spillOffset), _region(o._region),
+	  _volumeRegion(o._volumeRegion), _delta(o._delta), _bricks(o._bricks) {
 	o._compressedSize = 0;
 	o._buffer = nullptr;
+	o._spillOffset = -1;
 }
 
 MementoData::~MementoData() {
@@ -159,13 +182,15 @@ MementoData::~MementoData() {
 	}
 }
 
-MementoData::MementoData(const MementoData &o) : _compressedSize(o._compressedSize), _region(o._region) {
+MementoData::MementoData(const MementoData &o)
+	: _compressedSize(o._compressedSize), _pending(o._pending), _spillFile(o._spillFile), _spillOffset(o._spillOffset),
+	  _region(o._region), _volumeRegion(o._volumeRegion), _delta(o._delta), _bricks(o._bricks) {
 	if (o._buffer != nullptr) {
 		core_assert(_compressedSize > 0);
 		_buffer = (uint8_t *)core_malloc(_compressedSize);
 		core_memcpy(_buffer, o._buffer, _compressedSize);
 	} else {
-		core_assert(_compressedSize == 0);
+		core_assert(_compressedSize == 0 || _spillOffset >= 0);
 	}
 }
 
@@ -178,7 +203,14 @@ MementoData &MementoData::operator=(MementoData &&o) noexcept {
 		}
 		_buffer = o._buffer;
 		o._buffer = nullptr;
+		_pending = core::move(o._pending);
+		_spillFile = core::move(o._spillFile);
+		_spillOffset = o._spillOffset;
+		o._spillOffset = -1;
 		_region = o._region;
+		_volumeRegion = o._volumeRegion;
+		_delta = o._delta;
+		_bricks = o._bricks;
 	}
 	return *this;
 }
@@ -195,9 +227,15 @@ MementoData &MementoData::operator=(const MementoData &o) noexcept {
 			_buffer = (uint8_t *)core_malloc(_compressedSize);
 			core_memcpy(_buffer, o._buffer, _compressedSize);
 		} else {
-			core_assert(_compressedSize == 0);
+			core_assert(_compressedSize == 0 || o._spillOffset >= 0);
 		}
+		_pending = o._pending;
+		_spillFile = o._spillFile;
+		_spillOffset = o._spillOffset;
 		_region = o._region;
+		_volumeRegion = o._volumeRegion;
+		_delta = o._delta;
+		_bricks = o._bricks;
 	}
 	return *this;
 }
@@ -216,7 +254,7 @@ MementoData MementoData::fromVolume(const voxel::RawVolume *volume, const voxel:
 
 	const int allVoxels = volume->region().voxels();
 	io::BufferedReadWriteStream outStream(allVoxels * sizeof(voxel::Voxel));
-	io::ZipWriteStream stream(outStream);
+	io::LZ4WriteStream stream(outStream);
 	if (partialMemento) {
 		voxel::RawVolume v(volume, region);
 		stream.write(v.data(), allVoxels * sizeof(voxel::Voxel));
@@ -228,7 +266,362 @@ MementoData MementoData::fromVolume(const voxel::RawVolume *volume, const voxel:
 	return {outStream.release(), size, mementoRegion};
 }
 
+MementoCompressedBuffer::~MementoCompressedBuffer() {
+	core_free(buffer);
+}
+
+static uint8_t *compressBuffer(const uint8_t *buf, size_t bufSize, size_t &size) {
+	io::BufferedReadWriteStream outStream((int64_t)bufSize);
+	io::LZ4WriteStream stream(outStream);
+	stream.write(buf, bufSize);
+	stream.flush();
+	size = (size_t)outStream.size();
+	return outStream.release();
+}
+
+static uint8_t *compressVoxels(const voxel::RawVolume &volume, size_t &size) {
+	return compressBuffer(volume.data(), volume.region().voxels() * sizeof(voxel::Voxel), size);
+}
+
+MementoData MementoData::fromRegion(const voxel::RawVolume &volume, const voxel::Region &region) {
+	voxel::Region mementoRegion = region;
+	mementoRegion.cropTo(volume.region());
+	if (!mementoRegion.isValid()) {
+		return MementoData();
+	}
+	size_t size = 0u;
+	uint8_t *buf;
+	if (mementoRegion == volume.region()) {
+		buf = compressVoxels(volume, size);
+	} else {
+		const voxel::RawVolume v(volume, mementoRegion);
+		buf = compressVoxels(v, size);
+	}
+	return {buf, size, mementoRegion, volume.region(), false};
+}
+
+MementoData MementoData::fromRegionAsync(const voxel::RawVolume &volume, const voxel::Region &region) {
+	if (app::App::getInstance() == nullptr) {
+		return fromRegion(volume, region);
+	}
+	voxel::Region mementoRegion = region;
+	mementoRegion.cropTo(volume.region());
+	if (!mementoRegion.isValid()) {
+		return MementoData();
+	}
+	// only take the snapshot here - the volume might get modified while the compression is running
+	voxel::RawVolume *snapshot;
+	if (mementoRegion == volume.region()) {
+		snapshot = voxel::RawVolume::createShared(volume);
+	} else {
+		snapshot = new voxel::RawVolume(volume, mementoRegion);
+	}
+	std::future<core::SharedPtr<MementoCompressedBuffer>> future = app::async([snapshot]() {
+		core_trace_scoped(MementoCompression);
+		core::ScopedPtr<voxel::RawVolume> v(snapshot);
+		core::SharedPtr<MementoCompressedBuffer> compressed = core::make_shared<MementoCompressedBuffer>();
+		compressed->buffer = compressVoxels(*v, compressed->size);
+		return compressed;
+	});
+	if (!future.valid()) {
+		// the thread pool is already shut down
+		delete snapshot;
+		return fromRegion(volume, mementoRegion);
+	}
+	return {future.share(), mementoRegion, volume.region()};
+}
+
+void MementoData::waitForCompression() const {
+	if (!_pending.valid()) {
+		if (isSpilled()) {
+			core_trace_scoped(MementoLoadSpilled);
+			_buffer = _spillFile->read(_spillOffset, _compressedSize);
+		}
+		return;
+	}
+	core_trace_scoped(MementoWaitForCompression);
+	const core::SharedPtr<MementoCompressedBuffer> &compressed = _pending.get();
+	core_assert(_buffer == nullptr);
+	if (compressed->buffer != nullptr) {
+		// other copies of this instance might still reference the result
+		_compressedSize = compressed->size;
+		_buffer = (uint8_t *)core_malloc(_compressedSize);
+		core_memcpy(_buffer, compressed->buffer, _compressedSize);
+	}
+	_pending = MementoCompression();
+}
+
+bool MementoData::isCompressing() const {
+	return _pending.valid() && _pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+size_t MementoData::memorySize() const {
+	if (_buffer != nullptr) {
+		return _compressedSize;
+	}
+	if (!_pending.valid()) {
+		return 0u;
+	}
+	if (_pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		return _pending.get()->size;
+	}
+	if (_spillOffset >= 0) {
+		return _compressedSize;
+	}
+	return _region.voxels() * sizeof(voxel::Voxel);
+}
+
+bool MementoData::spill(const MementoSpillFilePtr &file) {
+	if (isCompressing()) {
+		return false;
+	}
+	waitForCompression();
+	if (_buffer == nullptr) {
+		return false;
+	}
+	if (_spillOffset < 0) {
+		_spillOffset = file->write(_buffer, _compressedSize);
+		if (_spillOffset < 0) {
+			return false;
+		}
+		_spillFile = file;
+	}
+	core_free(_buffer);
+	_buffer = nullptr;
+	return true;
+}
+
+void MementoData::prefetch() const {
+	if (!isSpilled() || app::App::getInstance() == nullptr) {
+		return;
+	}
+	MementoSpillFilePtr file = _spillFile;
+	const int64_t offset = _spillOffset;
+	const size_t size = _compressedSize;
+	std::future<core::SharedPtr<MementoCompressedBuffer>> future = app::async([file, offset, size]() {
+		core::SharedPtr<MementoCompressedBuffer> compressed = core::make_shared<MementoCompressedBuffer>();
+		compressed->buffer = file->read(offset, size);
+		compressed->size = compressed->buffer != nullptr ? size : 0u;
+		return compressed;
+	});
+	if (future.valid()) {
+		_pending = future.share();
+	}
+}
+
+namespace {
+
+/**
+ * A single changed voxel - the index is the linear index in the region of the delta (x first, then y, then z)
+ */
+struct VoxelDelta {
+	uint32_t index;
+	voxel::Voxel oldVoxel;
+	voxel::Voxel newVoxel;
+};
+using VoxelDeltas = core::DynamicArray<VoxelDelta>;
+
+/**
+ * The entries are sorted by index and only the distance to the previous entry is stored - this
+ * keeps the values small and makes it easy for lz4 to compress neighbouring changes
+ */
+uint8_t *writeDelta(const VoxelDeltas &deltas, size_t &size) {
+	io::BufferedReadWriteStream outStream((int64_t)(sizeof(uint32_t) + deltas.size() * sizeof(VoxelDelta)));
+	io::LZ4WriteStream stream(outStream);
+	stream.writeUInt32((uint32_t)deltas.size());
+	uint32_t lastIndex = 0u;
+	for (const VoxelDelta &delta : deltas) {
+		stream.writeUInt32(delta.index - lastIndex);
+		stream.write(&delta.oldVoxel, sizeof(voxel::Voxel));
+		stream.write(&delta.newVoxel, sizeof(voxel::Voxel));
+		lastIndex = delta.index;
+	}
+	stream.flush();
+	size = (size_t)outStream.size();
+	return outStream.release();
+}
+
+bool readDelta(const uint8_t *buf, size_t bufSize, VoxelDeltas &deltas) {
+	io::MemoryReadStream dataStream(buf, bufSize);
+	io::LZ4ReadStream stream(dataStream, (int)dataStream.size());
+	uint32_t amount = 0u;
+	if (stream.readUInt32(amount) == -1) {
+		return false;
+	}
+	deltas.resize(amount);
+	uint32_t index = 0u;
+	for (uint32_t i = 0u; i < amount; ++i) {
+		VoxelDelta &delta = deltas[i];
+		uint32_t distance = 0u;
+		if (stream.readUInt32(distance) == -1) {
+			return false;
+		}
+		index += distance;
+		delta.index = index;
+		if (stream.read(&delta.oldVoxel, sizeof(voxel::Voxel)) == -1) {
+			return false;
+		}
+		if (stream.read(&delta.newVoxel, sizeof(voxel::Voxel)) == -1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+MementoData MementoData::fromDelta(const voxel::RawVolume &before, const voxel::RawVolume &after,
+								   const voxel::Region &region, int maxVoxels) {
+	core_assert(before.region() == after.region());
+	voxel::Region deltaRegion = region;
+	deltaRegion.cropTo(after.region());
+	if (!deltaRegion.isValid()) {
+		return MementoData();
+	}
+	const glm::ivec3 &mins = deltaRegion.getLowerCorner();
+	const glm::ivec3 &maxs = deltaRegion.getUpperCorner();
+	const int width = deltaRegion.getWidthInVoxels();
+	const size_t rowSize = width * sizeof(voxel::Voxel);
+	VoxelDeltas deltas;
+	uint32_t index = 0u;
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y, index += width) {
+			const glm::ivec3 rowPos(mins.x, y, z);
+			const voxel::Voxel *oldRow = before.row(rowPos);
+			const voxel::Voxel *newRow = after.row(rowPos);
+			if (core_memcmp(oldRow, newRow, rowSize) == 0) {
+				continue;
+			}
+			for (int x = 0; x < width; ++x) {
+				if (core_memcmp(&oldRow[x], &newRow[x], sizeof(voxel::Voxel)) == 0) {
+					continue;
+				}
+				if ((int)deltas.size() >= maxVoxels) {
+					return MementoData();
+				}
+				deltas.push_back(VoxelDelta{index + (uint32_t)x, oldRow[x], newRow[x]});
+			}
+		}
+	}
+	size_t size = 0u;
+	uint8_t *buf = writeDelta(deltas, size);
+	return {buf, size, deltaRegion, after.region(), true};
+}
+
+/**
+ * The edge length of the bricks that are recorded for bigger modifications - see @c MementoData::fromBricks()
+ */
+static constexpr int MementoBrickSize = 16;
+
+void MementoData::changedBricks(const voxel::RawVolume &before, const voxel::RawVolume &after,
+								const voxel::Region &region, core::DynamicArray<voxel::Region> &bricks) {
+	core_trace_scoped(MementoChangedBricks);
+	core_assert(before.region() == after.region());
+	voxel::Region changedRegion = region;
+	changedRegion.cropTo(after.region());
+	if (!changedRegion.isValid()) {
+		return;
+	}
+	const glm::ivec3 &mins = changedRegion.getLowerCorner();
+	const glm::ivec3 &maxs = changedRegion.getUpperCorner();
+	for (int z = mins.z; z <= maxs.z; z += MementoBrickSize) {
+		const int upperZ = core_min(z + MementoBrickSize - 1, maxs.z);
+		for (int y = mins.y; y <= maxs.y; y += MementoBrickSize) {
+			const int upperY = core_min(y + MementoBrickSize - 1, maxs.y);
+			for (int x = mins.x; x <= maxs.x; x += MementoBrickSize) {
+				const int upperX = core_min(x + MementoBrickSize - 1, maxs.x);
+				const size_t rowSize = (upperX - x + 1) * sizeof(voxel::Voxel);
+				bool changed = false;
+				for (int bz = z; bz <= upperZ && !changed; ++bz) {
+					for (int by = y; by <= upperY; ++by) {
+						const glm::ivec3 rowPos(x, by, bz);
+						if (core_memcmp(before.row(rowPos), after.row(rowPos), rowSize) != 0) {
+							changed = true;
+							break;
+						}
+					}
+				}
+				if (changed) {
+					bricks.emplace_back(x, y, z, upperX, upperY, upperZ);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * The bricks are stored one after another - the region of the brick followed by the voxels of the brick (x first,
+ * then y, then z)
+ */
+MementoData MementoData::fromBricks(const voxel::RawVolume &volume, const core::DynamicArray<voxel::Region> &bricks) {
+	core_trace_scoped(MementoFromBricks);
+	if (bricks.empty()) {
+		return MementoData();
+	}
+	voxel::Region region = bricks[0];
+	size_t voxels = 0u;
+	for (const voxel::Region &brick : bricks) {
+		core_assert(volume.region().containsRegion(brick));
+		region.accumulate(brick);
+		voxels += brick.voxels();
+	}
+	// copy the voxels here - the volume might get modified while the compression is running
+	io::BufferedReadWriteStream *outStream = new io::BufferedReadWriteStream(
+		(int64_t)(sizeof(uint32_t) + bricks.size() * 6 * sizeof(int32_t) + voxels * sizeof(voxel::Voxel)));
+	outStream->writeUInt32((uint32_t)bricks.size());
+	for (const voxel::Region &brick : bricks) {
+		const glm::ivec3 &mins = brick.getLowerCorner();
+		const glm::ivec3 &maxs = brick.getUpperCorner();
+		for (int i = 0; i < 3; ++i) {
+			outStream->writeInt32(mins[i]);
+		}
+		for (int i = 0; i < 3; ++i) {
+			outStream->writeInt32(maxs[i]);
+		}
+		const size_t rowSize = brick.getWidthInVoxels() * sizeof(voxel::Voxel);
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				outStream->write(volume.row(glm::ivec3(mins.x, y, z)), rowSize);
+			}
+		}
+	}
+	if (app::App::getInstance() != nullptr) {
+		std::future<core::SharedPtr<MementoCompressedBuffer>> future = app::async([outStream]() {
+			core_trace_scoped(MementoCompression);
+			core::ScopedPtr<io::BufferedReadWriteStream> raw(outStream);
+			core::SharedPtr<MementoCompressedBuffer> compressed = core::make_shared<MementoCompressedBuffer>();
+			compressed->buffer = compressBuffer(raw->getBuffer(), (size_t)raw->size(), compressed->size);
+			return compressed;
+		});
+		if (future.valid()) {
+			return {future.share(), region, volume.region(), true};
+		}
+		// the thread pool is already shut down
+	}
+	core::ScopedPtr<io::BufferedReadWriteStream> raw(outStream);
+	size_t size = 0u;
+	uint8_t *buf = compressBuffer(raw->getBuffer(), (size_t)raw->size(), size);
+	return {buf, size, region, volume.region(), false, true};
+}
+
+MementoData MementoData::reverseDelta() const {
+	core_assert(_delta);
+	waitForCompression();
+	VoxelDeltas deltas;
+	if (!readDelta(_buffer, _compressedSize, deltas)) {
+		Log::error("Failed to read the voxel delta");
+		return MementoData();
+	}
+	for (VoxelDelta &delta : deltas) {
+		core::exchange(delta.oldVoxel, delta.newVoxel);
+	}
+	size_t size = 0u;
+	uint8_t *buf = writeDelta(deltas, size);
+	return {buf, size, _region, _volumeRegion, true};
+}
+
 bool MementoData::toVolume(voxel::RawVolume *volume, const MementoData &mementoData) {
+	mementoData.waitForCompression();
 	if (mementoData._buffer == nullptr) {
 		return false;
 	}
@@ -236,9 +629,62 @@ bool MementoData::toVolume(voxel::RawVolume *volume, const MementoData &mementoD
 	if (volume == nullptr) {
 		return false;
 	}
+	if (mementoData._delta) {
+		VoxelDeltas deltas;
+		if (!readDelta(mementoData._buffer, mementoData._compressedSize, deltas)) {
+			return false;
+		}
+		const glm::ivec3 &mins = mementoData.region().getLowerCorner();
+		const uint32_t width = mementoData.region().getWidthInVoxels();
+		const uint32_t height = mementoData.region().getHeightInVoxels();
+		for (const VoxelDelta &delta : deltas) {
+			const glm::ivec3 pos(mins.x + (int)(delta.index % width), mins.y + (int)((delta.index / width) % height),
+								 mins.z + (int)(delta.index / (width * height)));
+			volume->setVoxel(pos, delta.newVoxel);
+		}
+		return true;
+	}
+	if (mementoData._bricks) {
+		io::MemoryReadStream dataStream(mementoData._buffer, mementoData._compressedSize);
+		io::LZ4ReadStream stream(dataStream, (int)dataStream.size());
+		uint32_t amount = 0u;
+		if (stream.readUInt32(amount) == -1) {
+			return false;
+		}
+		for (uint32_t i = 0u; i < amount; ++i) {
+			glm::ivec3 mins;
+			glm::ivec3 maxs;
+			for (int j = 0; j < 3; ++j) {
+				if (stream.readInt32(mins[j]) == -1) {
+					return false;
+				}
+			}
+			for (int j = 0; j < 3; ++j) {
+				if (stream.readInt32(maxs[j]) == -1) {
+					return false;
+				}
+			}
+			const voxel::Region brick(mins, maxs);
+			if (!volume->region().containsRegion(brick)) {
+				Log::error("The memento brick is outside of the volume");
+				return false;
+			}
+			const size_t rowSize = brick.getWidthInVoxels() * sizeof(voxel::Voxel);
+			for (int z = mins.z; z <= maxs.z; ++z) {
+				for (int y = mins.y; y <= maxs.y; ++y) {
+					const glm::ivec3 rowPos(mins.x, y, z);
+					if (stream.read(volume->writableRow(rowPos), rowSize) == -1) {
+						return false;
+					}
+					volume->updateOccupancy(rowPos);
+				}
+			}
+		}
+		return true;
+	}
 	const size_t uncompressedBufferSize = mementoData.region().voxels() * sizeof(voxel::Voxel);
 	io::MemoryReadStream dataStream(mementoData._buffer, mementoData._compressedSize);
-	io::ZipReadStream stream(dataStream, (int)dataStream.size());
+	io::LZ4ReadStream stream(dataStream, (int)dataStream.size());
 	uint8_t *uncompressedBuf = (uint8_t *)core_malloc(uncompressedBufferSize);
 	if (stream.read(uncompressedBuf, uncompressedBufferSize) == -1) {
 		core_free(uncompressedBuf);
@@ -254,6 +700,8 @@ MementoHandler::MementoHandler() {
 }
 
 MementoHandler::~MementoHandler() {
+	resetLastVolume();
+	core::memoryTrackUpdate(core::MemoryTag::Memento, _trackedMemory, 0u);
 }
 
 bool MementoHandler::init() {
@@ -301,6 +749,8 @@ void MementoHandler::endGroup() {
 		core_assert(!_groups.empty());
 		if (_groups.back().states.empty()) {
 			removeLast();
+		} else {
+			enforceBudget();
 		}
 	}
 }
@@ -323,10 +773,10 @@ const char *MementoHandler::typeToString(MementoType type) {
 void MementoHandler::printState(const MementoState &state) const {
 	core::String palHash = core::string::toString(state.palette.hash());
 	core::String normalPalHash = core::string::toString(state.normalPalette.hash());
-	Log::info("%s: node id: %s", typeToString(state.type), state.nodeUUID.c_str());
-	Log::info(" - parent: %s", state.parentUUID.c_str());
+	Log::info("%s: node id: %s", typeToString(state.type), state.nodeUUID.str().c_str());
+	Log::info(" - parent: %s", state.parentUUID.str().c_str());
 	Log::info(" - name: %s", state.name.c_str());
-	Log::info(" - volume: %s", state.data._buffer == nullptr ? "empty" : "volume");
+	Log::info(" - volume: %s", !state.data.hasVolume() ? "empty" : (state.data._delta ? "delta" : "volume"));
 	const glm::ivec3 &mins = state.dataRegion().getLowerCorner();
 	const glm::ivec3 &maxs = state.dataRegion().getUpperCorner();
 	Log::info(" - region: mins(%i:%i:%i)/maxs(%i:%i:%i)", mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z);
@@ -362,6 +812,30 @@ void MementoHandler::printState(const MementoState &state) const {
 	}
 }
 
+void MementoHandler::registerListener(MementoStateListener *listener) {
+	for (MementoStateListener *l : _listeners) {
+		if (l == listener) {
+			Log::error("Listener is already registered");
+			return;
+		}
+	}
+	_listeners.push_back(listener);
+}
+
+bool MementoHandler::isRegistered(MementoStateListener *listener) const {
+	return core::find(_listeners.begin(), _listeners.end(), listener) != _listeners.end();
+}
+
+void MementoHandler::unregisterListener(MementoStateListener *listener) {
+	for (auto iter = _listeners.begin(); iter != _listeners.end(); ++iter) {
+		if (*iter == listener) {
+			_listeners.erase(iter);
+			return;
+		}
+	}
+	Log::error("Listener not found - could not unregister");
+}
+
 void MementoHandler::print() const {
 	Log::info("Current memento state index: %i", _groupStatePosition);
 
@@ -379,12 +853,199 @@ void MementoHandler::construct() {
 
 void MementoHandler::clearStates() {
 	core_assert_msg(_groupState <= 0, "You should not clear the states while you are recording a group state");
+	{
+		core::ScopedLock lock(_loadedVolumesLock);
+		_loadedVolumes.clear();
+	}
 	_groups.clear();
-	_groupStatePosition = 0u;
+	_groupStatePosition = 0;
+	core::memoryTrackUpdate(core::MemoryTag::Memento, _trackedMemory, 0u);
+	resetLastVolume();
+	_spillFile = MementoSpillFilePtr();
+	for (MementoStateListener *listener : _listeners) {
+		listener->onMementoStatesCleared();
+	}
+}
+
+void MementoHandler::eraseBack(size_t n) {
+	if (n == 0u) {
+		return;
+	}
+	core_assert(n <= _groups.size());
+	_groups.erase(_groups.size() - n, n);
+}
+
+size_t MementoHandler::memoryUsage() const {
+	size_t bytes = 0u;
+	for (const MementoStateGroup &group : _groups) {
+		for (const MementoState &state : group.states) {
+			bytes += sizeof(MementoState) + state.data.memorySize() + state.undoData.memorySize();
+		}
+	}
+	return bytes;
+}
+
+void MementoHandler::enforceBudget() {
+	if (_groupState > 0) {
+		return;
+	}
+	if (_maxStates > 0 && (int)_groups.size() > _maxStates) {
+		const int n = (int)_groups.size() - _maxStates;
+		Log::debug("Remove the %i oldest memento states", n);
+		_groups.erase(0, n);
+		_groupStatePosition = core_max(0, _groupStatePosition - n);
+	}
+	size_t usage = memoryUsage();
+	if (_memoryBudget > 0u && usage > _memoryBudget) {
+		usage = enforceMemoryBudget(usage);
+	}
+	core::memoryTrackUpdate(core::MemoryTag::Memento, _trackedMemory, usage);
+}
+
+size_t MementoHandler::enforceMemoryBudget(size_t usage) {
+	core_trace_scoped(MementoEnforceBudget);
+	if (!_spillPath.empty()) {
+		if (!_spillFile) {
+			_spillFile = core::make_shared<MementoSpillFile>(_spillPath);
+		}
+		// the current and the previous state are kept in memory - they are needed by the next undo or redo
+		for (int i = 0; i < _groupStatePosition - 1 && usage > _memoryBudget; ++i) {
+			for (MementoState &state : _groups[i].states) {
+				const size_t dataBytes = state.data.memorySize();
+				if (state.data.spill(_spillFile)) {
+					usage -= dataBytes;
+				}
+				const size_t undoDataBytes = state.undoData.memorySize();
+				if (state.undoData.spill(_spillFile)) {
+					usage -= undoDataBytes;
+				}
+			}
+		}
+		Log::debug("Memento memory usage after spilling: %i bytes (spill file: %i bytes)", (int)usage,
+				   (int)_spillFile->size());
+		return usage;
+	}
+	// without a spill file the oldest states are removed
+	int n = 0;
+	for (; n < _groupStatePosition - 1 && usage > _memoryBudget; ++n) {
+		for (const MementoState &state : _groups[n].states) {
+			usage -= sizeof(MementoState) + state.data.memorySize() + state.undoData.memorySize();
+		}
+	}
+	if (n > 0) {
+		Log::debug("Remove the %i oldest memento states to stay in the memory budget", n);
+		_groups.erase(0, n);
+		_groupStatePosition -= n;
+	}
+	return usage;
+}
+
+void MementoHandler::prefetchStates() const {
+	if (!_spillFile) {
+		return;
+	}
+	const int start = core_max(0, _groupStatePosition - 4);
+	const int end = core_min((int)_groups.size() - 1, _groupStatePosition + 1);
+	for (int i = start; i <= end; ++i) {
+		for (const MementoState &state : _groups[i].states) {
+			state.data.prefetch();
+			state.undoData.prefetch();
+		}
+	}
+}
+
+void MementoHandler::resetLastVolume() {
+	delete _lastVolume;
+	_lastVolume = nullptr;
+	_lastVolumeUUID = core::UUID();
+}
+
+voxel::RawVolume *MementoHandler::reconstructVolume(const core::UUID &nodeUUID, int groupPosition) const {
+	core::DynamicArray<const MementoData *> modifications;
+	for (int i = groupPosition; i >= 0; --i) {
+		const MementoStateGroup &group = _groups[i];
+		for (int j = (int)group.states.size() - 1; j >= 0; --j) {
+			const MementoState &prevS = group.states[j];
+			if (prevS.nodeUUID != nodeUUID || !prevS.hasVolumeData()) {
+				continue;
+			}
+			if (prevS.type != MementoType::Modification && prevS.type != MementoType::SceneNodeAdded) {
+				continue;
+			}
+			if (!prevS.data.isFullVolume()) {
+				modifications.push_back(&prevS.data);
+				continue;
+			}
+			voxel::RawVolume *volume = new voxel::RawVolume(prevS.data.volumeRegion());
+			MementoData::toVolume(volume, prevS.data);
+			for (int k = (int)modifications.size() - 1; k >= 0; --k) {
+				const MementoData *data = modifications[k];
+				if (data->volumeRegion() != volume->region()) {
+					// the volume was resized in between - we can't replay the changes
+					delete volume;
+					return nullptr;
+				}
+				MementoData::toVolume(volume, *data);
+			}
+			return volume;
+		}
+	}
+	return nullptr;
+}
+
+MementoData MementoHandler::modificationData(const core::UUID &nodeUUID, const voxel::RawVolume *volume,
+											 const voxel::Region &modifiedRegion, MementoData &undoData) {
+	voxel::Region region = modifiedRegion;
+	if (region.isValid()) {
+		region.cropTo(volume->region());
+	}
+	if (!region.isValid()) {
+		region = volume->region();
+	}
+	if (_lastVolume == nullptr || _lastVolumeUUID != nodeUUID) {
+		resetLastVolume();
+		if (!_groups.empty()) {
+			_lastVolume = reconstructVolume(nodeUUID, _groupStatePosition);
+		}
+		_lastVolumeUUID = nodeUUID;
+	}
+	if (_lastVolume == nullptr || _lastVolume->region() != volume->region()) {
+		// no known previous state of the volume (or it was resized) - record the whole volume
+		delete _lastVolume;
+		_lastVolume = new voxel::RawVolume(*volume);
+		return MementoData::fromRegionAsync(*volume, volume->region());
+	}
+	// a delta entry is the index and the old and new voxel - a region snapshot needs the old and new voxels of the
+	// whole region
+	const int regionVoxels = region.voxels();
+	const int maxDeltaVoxels =
+		(int)(((int64_t)regionVoxels * 2 * sizeof(voxel::Voxel)) / (sizeof(uint32_t) + 2 * sizeof(voxel::Voxel)));
+	MementoData data = MementoData::fromDelta(*_lastVolume, *volume, region, maxDeltaVoxels);
+	if (data.hasVolume()) {
+		voxelutil::copy(*volume, region, *_lastVolume, region);
+		return data;
+	}
+	// only record the bricks that were changed - the modified region is often mostly untouched
+	core::DynamicArray<voxel::Region> bricks;
+	MementoData::changedBricks(*_lastVolume, *volume, region, bricks);
+	undoData = MementoData::fromBricks(*_lastVolume, bricks);
+	data = MementoData::fromBricks(*volume, bricks);
+	for (const voxel::Region &brick : bricks) {
+		voxelutil::copy(*volume, brick, *_lastVolume, brick);
+	}
+	return data;
 }
 
 void MementoHandler::undoModification(MementoState &s) {
 	core_assert(s.hasVolumeData());
+	if (s.data.isDelta()) {
+		s.data = s.data.reverseDelta();
+		return;
+	}
+	if (s.undoData.hasVolume()) {
+		s.data = s.undoData;
+		return;
+	}
 	for (int i = _groupStatePosition; i >= 0; --i) {
 		const MementoStateGroup &group = _groups[i];
 		for (const MementoState &prevS : group.states) {
@@ -392,8 +1053,18 @@ void MementoHandler::undoModification(MementoState &s) {
 				continue;
 			}
 			if (prevS.type == MementoType::Modification || prevS.type == MementoType::SceneNodeAdded) {
-				core_assert(prevS.hasVolumeData() || !prevS.referenceUUID.empty());
-				s.data = prevS.data;
+				core_assert(prevS.hasVolumeData() || prevS.referenceUUID.isValid());
+				if (!prevS.hasVolumeData() || prevS.data.isFullVolume()) {
+					s.data = prevS.data;
+				} else {
+					// the previous state only holds the changed voxels - restore the whole volume
+					core::ScopedPtr<voxel::RawVolume> v(reconstructVolume(s.nodeUUID, _groupStatePosition));
+					if (v) {
+						s.data = MementoData::fromVolume(v, voxel::Region::InvalidRegion);
+					} else {
+						Log::warn("Failed to restore the previous volume state of node %s", s.nodeUUID.str().c_str());
+					}
+				}
 				// undo for un-reference node - so we have to make it a reference node again
 				if (s.nodeType != prevS.nodeType) {
 					core_assert(prevS.nodeType == scenegraph::SceneGraphNodeType::ModelReference);
@@ -405,7 +1076,7 @@ void MementoHandler::undoModification(MementoState &s) {
 		}
 	}
 
-	Log::warn("No previous modification state found for node %s", s.nodeUUID.c_str());
+	Log::warn("No previous modification state found for node %s", s.nodeUUID.str().c_str());
 }
 
 void MementoHandler::undoPaletteChange(MementoState &s) {
@@ -418,7 +1089,7 @@ void MementoHandler::undoPaletteChange(MementoState &s) {
 			}
 		}
 	}
-	Log::warn("No previous palette found for node %s", s.nodeUUID.c_str());
+	Log::warn("No previous palette found for node %s", s.nodeUUID.str().c_str());
 }
 
 void MementoHandler::undoNormalPaletteChange(MementoState &s) {
@@ -431,7 +1102,7 @@ void MementoHandler::undoNormalPaletteChange(MementoState &s) {
 			}
 		}
 	}
-	Log::warn("No previous palette found for node %s", s.nodeUUID.c_str());
+	Log::warn("No previous palette found for node %s", s.nodeUUID.str().c_str());
 }
 
 void MementoHandler::undoNodeProperties(MementoState &s) {
@@ -444,7 +1115,7 @@ void MementoHandler::undoNodeProperties(MementoState &s) {
 			}
 		}
 	}
-	Log::warn("No previous node properties found for node %s", s.nodeUUID.c_str());
+	Log::warn("No previous node properties found for node %s", s.nodeUUID.str().c_str());
 }
 
 void MementoHandler::undoKeyFrames(MementoState &s) {
@@ -458,7 +1129,7 @@ void MementoHandler::undoKeyFrames(MementoState &s) {
 			}
 		}
 	}
-	Log::warn("No previous node keyframes found for node %s", s.nodeUUID.c_str());
+	Log::warn("No previous node keyframes found for node %s", s.nodeUUID.str().c_str());
 }
 
 void MementoHandler::undoAnimations(MementoState &s) {
@@ -484,7 +1155,7 @@ void MementoHandler::undoRename(MementoState &s) {
 			}
 		}
 	}
-	Log::warn("No previous name found for node %s", s.nodeUUID.c_str());
+	Log::warn("No previous name found for node %s", s.nodeUUID.str().c_str());
 }
 
 void MementoHandler::undoMove(MementoState &s) {
@@ -497,17 +1168,20 @@ void MementoHandler::undoMove(MementoState &s) {
 			}
 		}
 	}
-	Log::warn("No previous parent found for node %s", s.nodeUUID.c_str());
+	Log::warn("No previous parent found for node %s", s.nodeUUID.str().c_str());
 }
 
 MementoStateGroup MementoHandler::undo() {
 	if (!canUndo()) {
 		return InvalidMementoGroup;
 	}
+	applyLoadedVolumes();
 	Log::debug("Available states: %i, current index: %i", (int)_groups.size(), _groupStatePosition);
+	prefetchStates();
 	MementoStateGroup group = stateGroup();
 	core_assert(!group.states.empty());
 	--_groupStatePosition;
+	resetLastVolume();
 	Log::debug("Undo group states: %i", (int)group.states.size());
 	for (MementoState &s : group.states) {
 		Log::debug("Undo memento type %s", typeToString(s.type));
@@ -529,6 +1203,9 @@ MementoStateGroup MementoHandler::undo() {
 			undoMove(s);
 		}
 	}
+	for (MementoStateListener *listener : _listeners) {
+		listener->onMementoUndo(group);
+	}
 	return group;
 }
 
@@ -536,9 +1213,16 @@ MementoStateGroup MementoHandler::redo() {
 	if (!canRedo()) {
 		return InvalidMementoGroup;
 	}
+	applyLoadedVolumes();
 	++_groupStatePosition;
+	resetLastVolume();
+	prefetchStates();
 	Log::debug("Available states: %i, current index: %i", (int)_groups.size(), _groupStatePosition);
-	return stateGroup();
+	const MementoStateGroup &group = stateGroup();
+	for (MementoStateListener *listener : _listeners) {
+		listener->onMementoRedo(group);
+	}
+	return group;
 }
 
 bool MementoHandler::markAllAnimations(const core::DynamicArray<core::String> &animations) {
@@ -598,9 +1282,56 @@ bool MementoHandler::markInitialSceneState(const scenegraph::SceneGraph &sceneGr
 
 bool MementoHandler::markInitialNodeState(const scenegraph::SceneGraph &sceneGraph,
 										  const scenegraph::SceneGraphNode &node) {
+	if (node.isModelNode() && !node.isVolumeLoaded()) {
+		// don't load the volume here - it's recorded by markNodeVolumeLoaded()
+		Log::debug("Mark node %i as added without volume (%s)", node.id(), node.name().c_str());
+		return markUndo(sceneGraph, node, nullptr, MementoType::SceneNodeAdded, voxel::Region::InvalidRegion);
+	}
 	return markNodeAdded(sceneGraph, node);
 }
 
+void MementoHandler::markNodeVolumeLoaded(const scenegraph::SceneGraphNode &node) {
+	const voxel::RawVolume *volume = node.volume();
+	if (!recordVolumeStates(volume)) {
+		return;
+	}
+	// take the snapshot now - the volume might get modified before the states are updated
+	MementoData data = MementoData::fromRegionAsync(*volume, volume->region());
+	core::ScopedLock lock(_loadedVolumesLock);
+	_loadedVolumes.push_back({node.uuid(), core::move(data)});
+}
+
+void MementoHandler::applyLoadedVolumes() {
+	core::DynamicArray<LoadedVolume> loadedVolumes;
+	{
+		core::ScopedLock lock(_loadedVolumesLock);
+		if (_loadedVolumes.empty()) {
+			return;
+		}
+		loadedVolumes = core::move(_loadedVolumes);
+	}
+	for (LoadedVolume &loaded : loadedVolumes) {
+		bool found = false;
+		for (MementoStateGroup &group : _groups) {
+			for (MementoState &state : group.states) {
+				if (state.nodeUUID != loaded.nodeUUID) {
+					continue;
+				}
+				// only the first state of the node can be recorded without volume
+				if (state.type == MementoType::SceneNodeAdded && !state.hasVolumeData()) {
+					Log::debug("Add the loaded volume to the initial state of node %s", loaded.nodeUUID.str().c_str());
+					state.data = core::move(loaded.data);
+				}
+				found = true;
+				break;
+			}
+			if (found) {
+				break;
+			}
+		}
+	}
+}
+
 bool MementoHandler::markModification(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
 									  const voxel::Region &modifiedRegion) {
 	const int nodeId = node.id();
@@ -681,12 +1412,13 @@ bool MementoHandler::markUndoPreamble() {
 		Log::debug("Don't add memento state - we are currently in locked mode");
 		return false;
 	}
+	applyLoadedVolumes();
 	if (!_groups.empty()) {
 		// if we mark something as new memento state, we can throw away
 		// every other state that follows the new one (everything after
 		// the current state position)
 		const size_t n = _groups.size() - (_groupStatePosition + 1);
-		_groups.erase_back(n);
+		eraseBack(n);
 	}
 	return true;
 }
@@ -695,10 +1427,11 @@ bool MementoHandler::removeLast() {
 	if (_groups.empty()) {
 		return false;
 	}
-	if (_groupStatePosition == stateSize() - 1) {
-		--_groupStatePosition;
+	if (_groupStatePosition == (int)stateSize() - 1) {
+		_groupStatePosition = core_max(0, _groupStatePosition - 1);
 	}
-	_groups.erase_back(1);
+	eraseBack(1);
+	resetLastVolume();
 	return true;
 }
 
@@ -707,13 +1440,13 @@ bool MementoHandler::markUndo(const scenegraph::SceneGraph &sceneGraph, const sc
 	if (!markUndoPreamble()) {
 		return false;
 	}
-	const core::String &parentId = sceneGraph.uuid(node.parent());
-	const core::String &referenceId = sceneGraph.uuid(node.reference());
+	const core::UUID &parentId = sceneGraph.uuid(node.parent());
+	const core::UUID &referenceId = sceneGraph.uuid(node.reference());
 	return markUndo(parentId, node.uuid(), referenceId, node.name(), node.type(), volume, type, modifiedRegion,
 					node.pivot(), node.allKeyFrames(), node.palette(), node.normalPalette(), node.properties());
 }
 
-bool MementoHandler::markUndo(const core::String &parentId, const core::String &nodeId, const core::String &referenceId,
+bool MementoHandler::markUndo(const core::UUID &parentId, const core::UUID &nodeId, const core::UUID &referenceId,
 							  const core::String &name, scenegraph::SceneGraphNodeType nodeType,
 							  const voxel::RawVolume *volume, MementoType type, const voxel::Region &modifiedRegion,
 							  const glm::vec3 &pivot, const scenegraph::SceneGraphKeyFramesMap &allKeyFrames,
@@ -722,15 +1455,29 @@ bool MementoHandler::markUndo(const core::String &parentId, const core::String &
 	if (!markUndoPreamble()) {
 		return false;
 	}
-	Log::debug("New memento state for node %s with name '%s'", nodeId.c_str(), name.c_str());
+	core::ScopedPerfTimer timer(core::PerfStat::MementoSnapshot);
+	Log::debug("New memento state for node %s with name '%s'", nodeId.str().c_str(), name.c_str());
 	voxel::logRegion("MarkUndo", modifiedRegion);
 	if (/*TODO: MEMENTO (type != MementoType::SceneNodeAdded && type != MementoType::Modification) ||*/
 		!recordVolumeStates(volume)) {
 		volume = nullptr;
 	}
-	const MementoData &data = MementoData::fromVolume(volume, modifiedRegion);
+	MementoData undoData;
+	MementoData data;
+	if (type == MementoType::Modification && volume != nullptr) {
+		data = modificationData(nodeId, volume, modifiedRegion, undoData);
+	} else {
+		if (nodeId == _lastVolumeUUID) {
+			resetLastVolume();
+		}
+		if (volume != nullptr) {
+			// TODO: MEMENTO: see issue https://github.com/vengi-voxel/vengi/issues/200 - always the whole volume
+			data = MementoData::fromRegionAsync(*volume, volume->region());
+		}
+	}
 	MementoState state(type, data, parentId, nodeId, referenceId, name, nodeType, pivot, allKeyFrames, palette,
 					   normalPalette, properties);
+	state.undoData = core::move(undoData);
 	addState(core::move(state));
 	return true;
 }
@@ -738,10 +1485,13 @@ bool MementoHandler::markUndo(const core::String &parentId, const core::String &
 void MementoHandler::cutFromGroupStatePosition() {
 	const int cutOff = core_max(0, (int)(stateSize() - _groupStatePosition - 1));
 	Log::debug("Cut off %i states", cutOff);
-	_groups.erase_back(cutOff);
+	eraseBack(cutOff);
 }
 
 void MementoHandler::addState(MementoState &&state) {
+	for (MementoStateListener *listener : _listeners) {
+		listener->onMementoStateAdded(state);
+	}
 	if (_groupState > 0) {
 		Log::debug("add group state: %i", _groupState);
 		_groups.back().states.emplace_back(state);
@@ -753,12 +1503,28 @@ void MementoHandler::addState(MementoState &&state) {
 	cutFromGroupStatePosition();
 	_groups.emplace_back(core::move(group));
 	_groupStatePosition = stateSize() - 1;
+	enforceBudget();
 }
 
 void MementoHandler::setMaxUndoRegion(const voxel::Region &region) {
 	_maxUndoRegion = region;
 }
 
+void MementoHandler::setMemoryBudget(size_t bytes, const core::String &spillPath) {
+	_memoryBudget = bytes;
+	if (_spillPath != spillPath) {
+		_spillPath = spillPath;
+		// the already spilled states keep a reference to the old file
+		_spillFile = MementoSpillFilePtr();
+	}
+	enforceBudget();
+}
+
+void MementoHandler::setMaxStates(int maxStates) {
+	_maxStates = maxStates;
+	enforceBudget();
+}
+
 const voxel::Region &MementoHandler::maxUndoRegion() const {
 	return _maxUndoRegion;
 }
@@ -4,16 +4,23 @@
 
 #pragma once
 
+#include "MementoSpillFile.h"
+#include "MementoStateListener.h"
 #include "core/IComponent.h"
 #include "core/Optional.h"
+#include "core/SharedPtr.h"
 #include "core/String.h"
-#include "core/collection/RingBuffer.h"
+#include "core/Trace.h"
+#include "core/UUID.h"
+#include "core/concurrent/Lock.h"
+#include "core/collection/DynamicArray.h"
 #include "palette/NormalPalette.h"
 #include "palette/Palette.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
+#include <future>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -42,31 +49,85 @@ enum class MementoType {
 	Max
 };
 
+/**
+ * @brief The result of a volume compression that was running on the thread pool
+ */
+struct MementoCompressedBuffer {
+	uint8_t *buffer = nullptr;
+	size_t size = 0u;
+	~MementoCompressedBuffer();
+};
+using MementoCompression = std::shared_future<core::SharedPtr<MementoCompressedBuffer>>;
+
 /**
  * @brief Holds the data of a memento state
  *
- * The given buffer is owned by this class and represents a compressed volume
+ * The given buffer is owned by this class and represents a compressed volume - or a compressed list of the voxels
+ * that were changed by a modification (see @c fromDelta()) - or the compressed voxels of the changed bricks of a
+ * modification (see @c fromBricks())
  */
 class MementoData {
 	friend struct MementoState;
 	friend class MementoHandler;
+	friend class MementoStream;
 
 private:
 	/**
 	 * @brief How big is the buffer with the compressed volume data
 	 */
-	size_t _compressedSize = 0;
+	mutable size_t _compressedSize = 0;
 	/**
 	 * @brief The compressed volume data
 	 */
-	uint8_t *_buffer = nullptr;
+	mutable uint8_t *_buffer = nullptr;
+	/**
+	 * @brief The compression that is still running on the thread pool - the buffer is filled by
+	 * @c waitForCompression()
+	 */
+	mutable MementoCompression _pending;
+	/**
+	 * @brief The file the compressed data was written to if the memory budget of the history was exceeded
+	 */
+	MementoSpillFilePtr _spillFile;
+	int64_t _spillOffset = -1;
 	/**
 	 * The region the given volume data is for
 	 */
 	voxel::Region _region{};
+	/**
+	 * The region of the whole volume - this is the same as @c _region for full volume snapshots
+	 */
+	voxel::Region _volumeRegion{};
+	/**
+	 * The buffer doesn't contain the voxels of the region but only the changed voxels with their old and new values
+	 */
+	bool _delta = false;
+	/**
+	 * The buffer doesn't contain the voxels of the whole region but only the voxels of some bricks inside the region
+	 */
+	bool _bricks = false;
 
 	MementoData(const uint8_t *buf, size_t bufSize, const voxel::Region &region);
 	MementoData(uint8_t *buf, size_t bufSize, const voxel::Region &region);
+	MementoData(uint8_t *buf, size_t bufSize, const voxel::Region &region, const voxel::Region &volumeRegion,
+				bool delta, bool bricks = false);
+	MementoData(const MementoCompression &pending, const voxel::Region &region, const voxel::Region &volumeRegion,
+				bool bricks = false);
+
+	/**
+	 * @brief Blocks until the compression on the thread pool is done - or loads the data from the spill file
+	 */
+	void waitForCompression() const;
+
+	/**
+	 * @brief Write the compressed data to the given file and release the memory
+	 * @note Data that was already written before is not written again
+	 */
+	bool spill(const MementoSpillFilePtr &file);
+	/**
+	 * @brief Starts to load the spilled data on the thread pool
+	 */
+	void prefetch() const;
 
 public:
 	MementoData() {
@@ -76,9 +137,17 @@ public:
 	~MementoData();
 
 	inline size_t size() const {
+		if (_pending.valid()) {
+			waitForCompression();
+		}
 		return _compressedSize;
 	}
 
+	/**
+	 * @return The amount of bytes this instance currently holds in memory - running compressions are estimated
+	 */
+	size_t memorySize() const;
+
 	MementoData &operator=(MementoData &&o) noexcept;
 	MementoData &operator=(const MementoData &o) noexcept;
 
@@ -86,10 +155,46 @@ public:
 		return _region;
 	}
 
+	inline const voxel::Region &volumeRegion() const {
+		return _volumeRegion;
+	}
+
 	inline bool hasVolume() const {
-		return _buffer != nullptr;
+		return _buffer != nullptr || _pending.valid() || _spillOffset >= 0;
+	}
+
+	/**
+	 * @return @c true if the compression of the volume data is still running on the thread pool
+	 */
+	bool isCompressing() const;
+
+	/**
+	 * @return @c true if the compressed data is only available in the spill file
+	 */
+	inline bool isSpilled() const {
+		return _spillOffset >= 0 && _buffer == nullptr && !_pending.valid();
+	}
+
+	inline bool isDelta() const {
+		return _delta;
+	}
+
+	inline bool isBricks() const {
+		return _bricks;
 	}
 
+	/**
+	 * @return @c true if the data contains all voxels of the volume
+	 */
+	inline bool isFullVolume() const {
+		return hasVolume() && !_delta && !_bricks && _region == _volumeRegion;
+	}
+
+	/**
+	 * @brief Swaps the old and new voxel values of a delta - applying the result reverts the modification
+	 */
+	MementoData reverseDelta() const;
+
 	/**
 	 * @brief Converts the given @c mementoData back into a voxels
 	 * @note Inserts the voxels from the memento data into the given volume at the given region.
@@ -102,17 +207,49 @@ public:
 	 * the whole volume is going to added to the memento data.
 	 */
 	static MementoData fromVolume(const voxel::RawVolume *volume, const voxel::Region &region);
+	/**
+	 * @brief Only stores the voxels of the given region of the volume
+	 */
+	static MementoData fromRegion(const voxel::RawVolume &volume, const voxel::Region &region);
+	/**
+	 * @brief Same as @c fromRegion() but the compression is running on the thread pool
+	 * @note The voxels of a whole volume snapshot are shared with the given volume until one of them is modified
+	 */
+	static MementoData fromRegionAsync(const voxel::RawVolume &volume, const voxel::Region &region);
+	/**
+	 * @brief Stores the position and the old and new value of every voxel in the given region that differs between
+	 * the two volumes
+	 * @note Both volumes must have the same region
+	 * @param[in] maxVoxels If more voxels were changed, an empty @c MementoData instance is returned
+	 */
+	static MementoData fromDelta(const voxel::RawVolume &before, const voxel::RawVolume &after,
+								 const voxel::Region &region, int maxVoxels);
+	/**
+	 * @brief Only stores the voxels of the given bricks of the volume - the region of the data is the bounding box
+	 * of the bricks
+	 * @note The voxels are copied immediately, the compression is running on the thread pool
+	 * @sa changedBricks()
+	 */
+	static MementoData fromBricks(const voxel::RawVolume &volume, const core::DynamicArray<voxel::Region> &bricks);
+	/**
+	 * @brief Collects the bricks of the given region that contain voxels that differ between the two volumes
+	 * @note Both volumes must have the same region
+	 */
+	static void changedBricks(const voxel::RawVolume &before, const voxel::RawVolume &after,
+							  const voxel::Region &region, core::DynamicArray<voxel::Region> &bricks);
 };
 
 struct MementoState {
 	MementoType type;
 	// data is not always included in a state - as this is the volume and would consume a lot of memory
 	MementoData data;
+	// the voxels of the modified region before the modification - only set if data is a region or brick snapshot
+	MementoData undoData;
 
 	// when re-adding nodes from a memento state, make sure to add them with the correct uuid
-	core::String parentUUID;
-	core::String nodeUUID;
-	core::String referenceUUID;
+	core::UUID parentUUID;
+	core::UUID nodeUUID;
+	core::UUID referenceUUID;
 
 	scenegraph::SceneGraphNodeType nodeType;
 	scenegraph::SceneGraphKeyFramesMap keyFrames;
@@ -129,13 +266,13 @@ struct MementoState {
 	MementoState(MementoState &&other) noexcept;
 	MementoState &operator=(MementoState &&other) noexcept;
 	MementoState &operator=(const MementoState &other);
-	MementoState(MementoType _type, const MementoData &_data, const core::String &_parentId,
-				 const core::String &_nodeId, const core::String &_referenceId, const core::String &_name,
+	MementoState(MementoType _type, const MementoData &_data, const core::UUID &_parentId,
+				 const core::UUID &_nodeId, const core::UUID &_referenceId, const core::String &_name,
 				 scenegraph::SceneGraphNodeType _nodeType, const glm::vec3 &_pivot,
 				 const scenegraph::SceneGraphKeyFramesMap &_keyFrames, const palette::Palette &_palette,
 				 const palette::NormalPalette &_normalPalette, const scenegraph::SceneGraphNodeProperties &_properties);
-	MementoState(MementoType _type, MementoData &&_data, core::String &&_parentId, core::String &&_nodeId,
-				 core::String &&_referenceId, core::String &&_name, scenegraph::SceneGraphNodeType _nodeType,
+	MementoState(MementoType _type, MementoData &&_data, const core::UUID &_parentId, const core::UUID &_nodeId,
+				 const core::UUID &_referenceId, core::String &&_name, scenegraph::SceneGraphNodeType _nodeType,
 				 glm::vec3 &&_pivot, scenegraph::SceneGraphKeyFramesMap &&_keyFrames, palette::Palette &&_palette,
 				 palette::NormalPalette &&_normalPalette, scenegraph::SceneGraphNodeProperties &&_properties);
 	MementoState(MementoType _type, const core::DynamicArray<core::String> &stringList);
@@ -148,7 +285,7 @@ struct MementoState {
 	 * Some types (@c MementoType) don't have a volume attached.
 	 */
 	inline bool hasVolumeData() const {
-		return data._buffer != nullptr;
+		return data.hasVolume();
 	}
 
 	inline const voxel::Region &dataRegion() const {
@@ -161,22 +298,78 @@ struct MementoStateGroup {
 	core::DynamicArray<MementoState> states;
 };
 
-using MementoStates = core::RingBuffer<MementoStateGroup, 64u>;
+using MementoStates = core::DynamicArray<MementoStateGroup>;
 /**
  * @brief Class that manages the undo and redo steps for the scene
  *
  * @note For the volumes only the dirty regions are stored in a compressed form.
+ * @note The history is limited by a memory budget - the volume data of the oldest states is written to a spill
+ * file if the budget is exceeded and loaded again if the state is needed for undo. See @c setMemoryBudget()
  */
 class MementoHandler : public core::IComponent {
 private:
 	MementoStates _groups;
 	int _groupState = 0;
-	uint8_t _groupStatePosition = 0u;
+	int _groupStatePosition = 0;
+	size_t _memoryBudget = 256u * 1024u * 1024u;
+	// the memory usage that was reported to the memory tracker
+	size_t _trackedMemory = 0u;
+	int _maxStates = 4096;
+	core::String _spillPath;
+	MementoSpillFilePtr _spillFile;
 	int _locked = 0;
 	voxel::Region _maxUndoRegion = voxel::Region::InvalidRegion;
-
+	/**
+	 * A copy of the volume of the last modified node in the state of the last memento state - used to compute
+	 * the voxel deltas for the next modification of the same node
+	 */
+	voxel::RawVolume *_lastVolume = nullptr;
+	core::UUID _lastVolumeUUID;
+	core::DynamicArray<MementoStateListener *> _listeners;
+	struct LoadedVolume {
+		core::UUID nodeUUID;
+		MementoData data;
+	};
+	/** the snapshots of the volumes that were loaded after their initial state was recorded */
+	core::DynamicArray<LoadedVolume> _loadedVolumes;
+	core_trace_mutex(core::Lock, _loadedVolumesLock, "MementoLoadedVolumes");
+
+	void resetLastVolume();
+	/**
+	 * @brief Puts the snapshots of the loaded volumes into the initial states of their nodes
+	 * @sa markNodeVolumeLoaded()
+	 */
+	void applyLoadedVolumes();
+	/**
+	 * @brief Restores the volume of the given node from the last full volume snapshot and the following
+	 * modifications up to the given group position
+	 * @return @c nullptr if no full volume snapshot was found - the caller owns the returned volume
+	 */
+	voxel::RawVolume *reconstructVolume(const core::UUID &nodeUUID, int groupPosition) const;
+	/**
+	 * @brief Creates the memento data for a modification of the given region. Small modifications are stored as
+	 * voxel deltas, bigger ones as snapshots of the bricks of the modified region that were changed. If the previous
+	 * state of the volume is not known, the whole volume is stored.
+	 * @param[out] undoData Filled with the previous voxels of the region if a region snapshot is created
+	 */
+	MementoData modificationData(const core::UUID &nodeUUID, const voxel::RawVolume *volume,
+								 const voxel::Region &modifiedRegion, MementoData &undoData);
 	void cutFromGroupStatePosition();
 	void addState(MementoState &&state);
+	void eraseBack(size_t n);
+	/**
+	 * @brief Removes the oldest states if the max amount of states is exceeded and writes the volume data of the
+	 * oldest states into the spill file until the memory budget is no longer exceeded
+	 */
+	void enforceBudget();
+	/**
+	 * @return The memory usage after the states were spilled or removed
+	 */
+	size_t enforceMemoryBudget(size_t usage);
+	/**
+	 * @brief Loads the spilled data of the states that are likely needed by the next undo steps in the background
+	 */
+	void prefetchStates() const;
 	/**
 	 * @return @c true if it's allowed to create an undo state
 	 */
@@ -208,7 +401,7 @@ protected:
 	 */
 	bool markUndo(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
 				  const voxel::RawVolume *volume, MementoType type, const voxel::Region &region);
-	bool markUndo(const core::String &parentId, const core::String &nodeId, const core::String &referenceId,
+	bool markUndo(const core::UUID &parentId, const core::UUID &nodeId, const core::UUID &referenceId,
 				  const core::String &name, scenegraph::SceneGraphNodeType nodeType, const voxel::RawVolume *volume,
 				  MementoType type, const voxel::Region &region, const glm::vec3 &pivot,
 				  const scenegraph::SceneGraphKeyFramesMap &allKeyFrames, const palette::Palette &palette,
@@ -227,6 +420,21 @@ public:
 	 */
 	void setMaxUndoRegion(const voxel::Region &region);
 	const voxel::Region &maxUndoRegion() const;
+	/**
+	 * @brief The amount of bytes the volume data of the states may use in memory before they are moved into the
+	 * spill file
+	 * @param[in] bytes @c 0 disables the budget
+	 * @param[in] spillPath The file to write the data into - if this is empty, the oldest states are removed instead
+	 */
+	void setMemoryBudget(size_t bytes, const core::String &spillPath = "");
+	/**
+	 * @brief The max amount of undo steps
+	 */
+	void setMaxStates(int maxStates);
+	/**
+	 * @return The amount of bytes the states are currently holding in memory
+	 */
+	size_t memoryUsage() const;
 	/**
 	 * @brief Checks if the given volume states are recorded
 	 */
@@ -246,6 +454,10 @@ public:
 	void beginGroup(const core::String &name);
 	void endGroup();
 
+	bool isRegistered(MementoStateListener *listener) const;
+	void registerListener(MementoStateListener *listener);
+	void unregisterListener(MementoStateListener *listener);
+
 	void print() const;
 	void printState(const MementoState &state) const;
 
@@ -262,8 +474,19 @@ public:
 	bool markNodeTransform(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node);
 	bool markModification(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
 						  const voxel::Region &modifiedRegion);
+	/**
+	 * @note The volumes of the nodes that were not loaded yet are not recorded - they are added to the state by
+	 * @c markNodeVolumeLoaded() once they are loaded
+	 */
 	bool markInitialNodeState(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node);
 	bool markInitialSceneState(const scenegraph::SceneGraph &sceneGraph);
+	/**
+	 * @brief Records the volume of a node that was loaded for the first time - this doesn't add a new state, the
+	 * volume is put into the initial state of the node
+	 * @note Thread safe - the snapshot is taken immediately, the states are updated by the next memento operation
+	 * @sa scenegraph::SceneGraphNode::setLazyVolume()
+	 */
+	void markNodeVolumeLoaded(const scenegraph::SceneGraphNode &node);
 	bool markNodeRenamed(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node);
 	bool markNodeMoved(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node);
 	bool markPaletteChange(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node);
@@ -280,7 +503,7 @@ public:
 	const MementoStates &states() const;
 
 	size_t stateSize() const;
-	uint8_t statePosition() const;
+	int statePosition() const;
 };
 
 class ScopedMementoGroup {
@@ -335,7 +558,7 @@ inline const MementoStates &MementoHandler::states() const {
 	return _groups;
 }
 
-inline uint8_t MementoHandler::statePosition() const {
+inline int MementoHandler::statePosition() const {
 	return _groupStatePosition;
 }
 
@@ -360,7 +583,7 @@ inline bool MementoHandler::canRedo() const {
 	if (stateSize() <= 1) {
 		return false;
 	}
-	return _groupStatePosition <= stateSize() - 2;
+	return _groupStatePosition <= (int)stateSize() - 2;
 }
 
 } // namespace memento
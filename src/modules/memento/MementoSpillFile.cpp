@@ -0,0 +1,60 @@
+/**
+ * @file
+ */
+
+#include "MementoSpillFile.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "io/File.h"
+#include "io/FileStream.h"
+#include "io/Filesystem.h"
+
+namespace memento {
+
+MementoSpillFile::MementoSpillFile(const core::String &path) : _path(path) {
+	io::Filesystem::sysRemoveFile(_path);
+}
+
+MementoSpillFile::~MementoSpillFile() {
+	io::Filesystem::sysRemoveFile(_path);
+}
+
+int64_t MementoSpillFile::write(const uint8_t *buf, size_t size) {
+	core::ScopedLock lock(_lock);
+	io::FilePtr file = core::make_shared<io::File>(_path, io::FileMode::Append);
+	io::FileStream stream(file);
+	if (!stream.valid()) {
+		Log::error("Failed to open the undo spill file %s", _path.c_str());
+		return -1;
+	}
+	if (stream.write(buf, size) != (int)size) {
+		Log::error("Failed to write %i bytes into the undo spill file %s", (int)size, _path.c_str());
+		return -1;
+	}
+	const int64_t offset = _size;
+	_size += (int64_t)size;
+	return offset;
+}
+
+uint8_t *MementoSpillFile::read(int64_t offset, size_t size) {
+	core::ScopedLock lock(_lock);
+	if (offset < 0 || offset + (int64_t)size > _size) {
+		Log::error("Invalid undo spill file range %i:%i", (int)offset, (int)size);
+		return nullptr;
+	}
+	io::FilePtr file = core::make_shared<io::File>(_path, io::FileMode::SysRead);
+	io::FileStream stream(file);
+	if (!stream.valid() || stream.seek(offset) != offset) {
+		Log::error("Failed to open the undo spill file %s", _path.c_str());
+		return nullptr;
+	}
+	uint8_t *buf = (uint8_t *)core_malloc(size);
+	if (stream.read(buf, size) == -1) {
+		Log::error("Failed to read %i bytes from the undo spill file %s", (int)size, _path.c_str());
+		core_free(buf);
+		return nullptr;
+	}
+	return buf;
+}
+
+} // namespace memento
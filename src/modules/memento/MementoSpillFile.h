@@ -0,0 +1,53 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/SharedPtr.h"
+#include "core/String.h"
+#include "core/Trace.h"
+#include "core/concurrent/Lock.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace memento {
+
+/**
+ * @brief Temp file for the compressed volume data of old memento states that exceeded the memory budget of the
+ * undo history
+ *
+ * The data is only appended - the file is removed once the instance is destroyed.
+ * @note The access is serialized - the data can be loaded from the thread pool
+ */
+class MementoSpillFile {
+private:
+	core::String _path;
+	int64_t _size = 0;
+	core_trace_mutex(core::Lock, _lock, "MementoSpillFile");
+
+public:
+	MementoSpillFile(const core::String &path);
+	~MementoSpillFile();
+
+	/**
+	 * @return The offset of the written data in the file or @c -1 on error
+	 */
+	int64_t write(const uint8_t *buf, size_t size);
+	/**
+	 * @return The data at the given offset or @c nullptr on error - the caller owns the returned memory
+	 */
+	uint8_t *read(int64_t offset, size_t size);
+
+	inline int64_t size() const {
+		return _size;
+	}
+
+	inline const core::String &path() const {
+		return _path;
+	}
+};
+
+using MementoSpillFilePtr = core::SharedPtr<MementoSpillFile>;
+
+} // namespace memento
@@ -0,0 +1,33 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+namespace memento {
+
+struct MementoState;
+struct MementoStateGroup;
+
+/**
+ * @brief Get notified about the states that are recorded by the @c MementoHandler - and about the state groups that
+ * are returned by undo and redo
+ */
+class MementoStateListener {
+public:
+	virtual ~MementoStateListener() = default;
+
+	virtual void onMementoStateAdded(const MementoState &state) {
+	}
+	/**
+	 * @note The states are in the order they were recorded - they have to be applied in reverse order
+	 */
+	virtual void onMementoUndo(const MementoStateGroup &group) {
+	}
+	virtual void onMementoRedo(const MementoStateGroup &group) {
+	}
+	virtual void onMementoStatesCleared() {
+	}
+};
+
+} // namespace memento
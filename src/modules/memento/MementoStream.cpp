@@ -0,0 +1,750 @@
+/**
+ * @file
+ */
+
+#include "MementoStream.h"
+#include "core/FourCC.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/MemoryReadStream.h"
+#include "io/Stream.h"
+#include "palette/Material.h"
+#include "scenegraph/SceneGraphKeyFrame.h"
+#include "scenegraph/SceneGraphTransform.h"
+#include "voxel/RawVolume.h"
+#include <glm/gtc/quaternion.hpp>
+
+namespace memento {
+
+#define wrap(read)                                                                                                     \
+	if ((read) != 0) {                                                                                                 \
+		Log::error("Could not read memento stream: Not enough data in stream " CORE_STRINGIFY(read) " (line %i)",      \
+				   (int)__LINE__);                                                                                     \
+		return false;                                                                                                  \
+	}
+
+#define wrapBool(read)                                                                                                 \
+	if ((read) != true) {                                                                                              \
+		Log::error("Could not read or write memento stream " CORE_STRINGIFY(read) " (line %i)", (int)__LINE__);        \
+		return false;                                                                                                  \
+	}
+
+static const uint32_t MementoStreamMagic = FourCC('V', 'M', 'S', 'B');
+// version 2: the uuids are written as 128 bit values
+static const uint8_t MementoStreamVersion = 2;
+
+enum MementoStreamField : uint32_t {
+	FieldParent = 1 << 0,
+	FieldReference = 1 << 1,
+	FieldName = 1 << 2,
+	FieldNodeType = 1 << 3,
+	FieldPivot = 1 << 4,
+	FieldKeyFrames = 1 << 5,
+	FieldPalette = 1 << 6,
+	FieldNormalPalette = 1 << 7,
+	FieldProperties = 1 << 8,
+	FieldData = 1 << 9,
+	FieldStringList = 1 << 10
+};
+
+enum MementoStreamDataFlags : uint8_t { DataBuffer = 1 << 0, DataDelta = 1 << 1, DataBricks = 1 << 2 };
+
+/**
+ * @brief Only the fields that are evaluated when the state is applied are transferred
+ */
+static uint32_t fieldsForType(MementoType type) {
+	switch (type) {
+	case MementoType::Modification:
+		return FieldReference | FieldName | FieldNodeType | FieldPalette | FieldData;
+	case MementoType::SceneNodeMove:
+		return FieldParent | FieldName;
+	case MementoType::SceneNodeAdded:
+	case MementoType::SceneNodeRemoved:
+		return FieldParent | FieldReference | FieldName | FieldNodeType | FieldPivot | FieldKeyFrames | FieldPalette |
+			   FieldNormalPalette | FieldProperties | FieldData;
+	case MementoType::SceneNodeRenamed:
+		return FieldName;
+	case MementoType::SceneNodePaletteChanged:
+		return FieldName | FieldPalette;
+	case MementoType::SceneNodeNormalPaletteChanged:
+		return FieldName | FieldNormalPalette;
+	case MementoType::SceneNodeKeyFrames:
+		return FieldName | FieldPivot | FieldKeyFrames;
+	case MementoType::SceneNodeProperties:
+		return FieldName | FieldProperties;
+	case MementoType::SceneGraphAnimation:
+		return FieldStringList;
+	case MementoType::Max:
+		break;
+	}
+	return 0u;
+}
+
+static bool writeRegion(io::WriteStream &stream, const voxel::Region &region) {
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	for (int i = 0; i < 3; ++i) {
+		wrapBool(stream.writeInt32(mins[i]))
+	}
+	for (int i = 0; i < 3; ++i) {
+		wrapBool(stream.writeInt32(maxs[i]))
+	}
+	return true;
+}
+
+static bool readRegion(io::ReadStream &stream, voxel::Region &region) {
+	glm::ivec3 mins;
+	glm::ivec3 maxs;
+	for (int i = 0; i < 3; ++i) {
+		wrap(stream.readInt32(mins[i]))
+	}
+	for (int i = 0; i < 3; ++i) {
+		wrap(stream.readInt32(maxs[i]))
+	}
+	region = voxel::Region(mins, maxs);
+	return true;
+}
+
+static bool writeVec3(io::WriteStream &stream, const glm::vec3 &v) {
+	for (int i = 0; i < 3; ++i) {
+		wrapBool(stream.writeFloat(v[i]))
+	}
+	return true;
+}
+
+static bool readVec3(io::ReadStream &stream, glm::vec3 &v) {
+	for (int i = 0; i < 3; ++i) {
+		wrap(stream.readFloat(v[i]))
+	}
+	return true;
+}
+
+static bool writeUUID(io::WriteStream &stream, const core::UUID &uuid) {
+	wrapBool(stream.writeUInt64(uuid.data0()))
+	wrapBool(stream.writeUInt64(uuid.data1()))
+	return true;
+}
+
+static bool readUUID(io::ReadStream &stream, core::UUID &uuid) {
+	uint64_t data0;
+	uint64_t data1;
+	wrap(stream.readUInt64(data0))
+	wrap(stream.readUInt64(data1))
+	uuid = core::UUID(data0, data1);
+	return true;
+}
+
+static bool writePalette(io::WriteStream &stream, const palette::Palette &palette) {
+	const bool builtIn = palette.isBuiltIn();
+	wrapBool(stream.writeBool(builtIn))
+	wrapBool(stream.writePascalStringUInt16LE(palette.name()))
+	if (builtIn) {
+		return true;
+	}
+	const int colorCount = palette.colorCount();
+	wrapBool(stream.writeUInt16(colorCount))
+	for (int i = 0; i < colorCount; ++i) {
+		wrapBool(stream.writeUInt32(palette.color(i).rgba))
+	}
+	const palette::PaletteIndicesArray &indices = palette.uiIndices();
+	for (int i = 0; i < colorCount; ++i) {
+		wrapBool(stream.writeUInt8(indices[i]))
+	}
+	for (int i = 0; i < colorCount; ++i) {
+		const palette::Material &material = palette.material(i);
+		wrapBool(stream.writeUInt8((uint8_t)material.type))
+		wrapBool(stream.writeUInt32(material.mask))
+		for (uint32_t n = palette::MaterialMetal; n < palette::MaterialMax; ++n) {
+			const palette::MaterialProperty property = (palette::MaterialProperty)n;
+			if (material.has(property)) {
+				wrapBool(stream.writeFloat(material.value(property)))
+			}
+		}
+	}
+	return true;
+}
+
+static bool readPalette(io::ReadStream &stream, palette::Palette &palette) {
+	const bool builtIn = stream.readBool();
+	core::String name;
+	wrapBool(stream.readPascalStringUInt16LE(name))
+	if (builtIn) {
+		return palette.load(name.c_str());
+	}
+	uint16_t colorCount;
+	wrap(stream.readUInt16(colorCount))
+	if (colorCount > palette::PaletteMaxColors) {
+		Log::error("Invalid palette color count %i", (int)colorCount);
+		return false;
+	}
+	for (uint16_t i = 0; i < colorCount; ++i) {
+		core::RGBA rgba;
+		wrap(stream.readUInt32(rgba.rgba))
+		palette.setColor(i, rgba);
+	}
+	palette.setSize(colorCount);
+	palette::PaletteIndicesArray &indices = palette.uiIndices();
+	for (uint16_t i = 0; i < colorCount; ++i) {
+		wrap(stream.readUInt8(indices[i]))
+	}
+	for (uint16_t i = 0; i < colorCount; ++i) {
+		palette::Material material;
+		uint8_t type;
+		wrap(stream.readUInt8(type))
+		material.type = (palette::MaterialType)type;
+		uint32_t mask;
+		wrap(stream.readUInt32(mask))
+		for (uint32_t n = palette::MaterialMetal; n < palette::MaterialMax; ++n) {
+			if ((mask & (1 << n)) == 0) {
+				continue;
+			}
+			float value;
+			wrap(stream.readFloat(value))
+			material.setValue((palette::MaterialProperty)n, value);
+		}
+		material.mask = mask;
+		palette.setMaterial(i, material);
+	}
+	palette.setName(name);
+	return true;
+}
+
+static bool writeNormalPalette(io::WriteStream &stream, const palette::NormalPalette &normalPalette) {
+	const bool builtIn = normalPalette.isBuiltIn();
+	wrapBool(stream.writeBool(builtIn))
+	wrapBool(stream.writePascalStringUInt16LE(normalPalette.name()))
+	if (builtIn) {
+		return true;
+	}
+	const uint8_t size = (uint8_t)normalPalette.size();
+	wrapBool(stream.writeUInt8(size))
+	for (uint8_t i = 0; i < size; ++i) {
+		wrapBool(stream.writeUInt32(normalPalette.normal(i).rgba))
+	}
+	return true;
+}
+
+static bool readNormalPalette(io::ReadStream &stream, palette::NormalPalette &normalPalette) {
+	const bool builtIn = stream.readBool();
+	core::String name;
+	wrapBool(stream.readPascalStringUInt16LE(name))
+	if (builtIn) {
+		return normalPalette.load(name.c_str());
+	}
+	uint8_t size;
+	wrap(stream.readUInt8(size))
+	core::RGBA normals[palette::NormalPaletteMaxNormals];
+	for (uint8_t i = 0; i < size; ++i) {
+		wrap(stream.readUInt32(normals[i].rgba))
+	}
+	normalPalette.loadNormalMap(normals, size);
+	normalPalette.setName(name);
+	return true;
+}
+
+static bool writeKeyFrames(io::WriteStream &stream, const scenegraph::SceneGraphKeyFramesMap &keyFrames) {
+	wrapBool(stream.writeUInt16((uint16_t)keyFrames.size()))
+	for (const auto &entry : keyFrames) {
+		wrapBool(stream.writePascalStringUInt16LE(entry->key))
+		const scenegraph::SceneGraphKeyFrames &frames = entry->value;
+		wrapBool(stream.writeUInt32((uint32_t)frames.size()))
+		for (const scenegraph::SceneGraphKeyFrame &keyFrame : frames) {
+			wrapBool(stream.writeInt32(keyFrame.frameIdx))
+			wrapBool(stream.writeUInt8((uint8_t)keyFrame.interpolation))
+			wrapBool(stream.writeBool(keyFrame.longRotation))
+			const scenegraph::SceneGraphTransform &transform = keyFrame.transform();
+			wrapBool(writeVec3(stream, transform.localTranslation()))
+			const glm::quat &orientation = transform.localOrientation();
+			for (int i = 0; i < 4; ++i) {
+				wrapBool(stream.writeFloat(orientation[i]))
+			}
+			wrapBool(writeVec3(stream, transform.localScale()))
+		}
+	}
+	return true;
+}
+
+static bool readKeyFrames(io::ReadStream &stream, scenegraph::SceneGraphKeyFramesMap &keyFrames) {
+	uint16_t animations;
+	wrap(stream.readUInt16(animations))
+	for (uint16_t a = 0; a < animations; ++a) {
+		core::String animation;
+		wrapBool(stream.readPascalStringUInt16LE(animation))
+		uint32_t frameCount;
+		wrap(stream.readUInt32(frameCount))
+		scenegraph::SceneGraphKeyFrames frames;
+		frames.reserve(frameCount);
+		for (uint32_t f = 0; f < frameCount; ++f) {
+			scenegraph::SceneGraphKeyFrame keyFrame;
+			wrap(stream.readInt32(keyFrame.frameIdx))
+			uint8_t interpolation;
+			wrap(stream.readUInt8(interpolation))
+			if (interpolation >= (uint8_t)scenegraph::InterpolationType::Max) {
+				Log::error("Invalid interpolation type %i", (int)interpolation);
+				return false;
+			}
+			keyFrame.interpolation = (scenegraph::InterpolationType)interpolation;
+			keyFrame.longRotation = stream.readBool();
+			glm::vec3 translation;
+			wrapBool(readVec3(stream, translation))
+			glm::quat orientation;
+			for (int i = 0; i < 4; ++i) {
+				wrap(stream.readFloat(orientation[i]))
+			}
+			glm::vec3 scale;
+			wrapBool(readVec3(stream, scale))
+			scenegraph::SceneGraphTransform &transform = keyFrame.transform();
+			transform.setLocalTranslation(translation);
+			transform.setLocalOrientation(orientation);
+			transform.setLocalScale(scale);
+			frames.push_back(keyFrame);
+		}
+		keyFrames.put(animation, frames);
+	}
+	return true;
+}
+
+bool MementoStream::writeData(io::WriteStream &stream, const MementoData &data) {
+	// the compression might still run on the thread pool - or the data was moved into the spill file
+	data.waitForCompression();
+	uint8_t flags = 0u;
+	if (data._buffer != nullptr) {
+		flags |= DataBuffer;
+	}
+	if (data._delta) {
+		flags |= DataDelta;
+	}
+	if (data._bricks) {
+		flags |= DataBricks;
+	}
+	wrapBool(stream.writeUInt8(flags))
+	wrapBool(writeRegion(stream, data._region))
+	wrapBool(writeRegion(stream, data._volumeRegion))
+	if (data._buffer != nullptr) {
+		wrapBool(stream.writeUInt32((uint32_t)data._compressedSize))
+		if (stream.write(data._buffer, data._compressedSize) != (int)data._compressedSize) {
+			Log::error("Failed to write the memento data");
+			return false;
+		}
+	}
+	return true;
+}
+
+bool MementoStream::readData(io::ReadStream &stream, MementoData &data) {
+	uint8_t flags;
+	wrap(stream.readUInt8(flags))
+	voxel::Region region;
+	wrapBool(readRegion(stream, region))
+	voxel::Region volumeRegion;
+	wrapBool(readRegion(stream, volumeRegion))
+	uint8_t *buf = nullptr;
+	uint32_t size = 0u;
+	if (flags & DataBuffer) {
+		wrap(stream.readUInt32(size))
+		if (size == 0u) {
+			Log::error("Invalid memento data size");
+			return false;
+		}
+		buf = (uint8_t *)core_malloc(size);
+		if (stream.read(buf, size) != (int)size) {
+			Log::error("Failed to read %u bytes of memento data", size);
+			core_free(buf);
+			return false;
+		}
+	}
+	data = MementoData(buf, size, region, volumeRegion, (flags & DataDelta) != 0, (flags & DataBricks) != 0);
+	return true;
+}
+
+bool MementoStream::writeState(io::WriteStream &stream, const MementoState &state) {
+	wrapBool(stream.writeUInt8((uint8_t)state.type))
+	wrapBool(writeUUID(stream, state.nodeUUID))
+	const uint32_t fields = fieldsForType(state.type);
+	if (fields & FieldParent) {
+		wrapBool(writeUUID(stream, state.parentUUID))
+	}
+	if (fields & FieldReference) {
+		wrapBool(writeUUID(stream, state.referenceUUID))
+	}
+	if (fields & FieldName) {
+		wrapBool(stream.writePascalStringUInt16LE(state.name))
+	}
+	if (fields & FieldNodeType) {
+		wrapBool(stream.writeUInt8((uint8_t)state.nodeType))
+	}
+	if (fields & FieldPivot) {
+		wrapBool(writeVec3(stream, state.pivot))
+	}
+	if (fields & FieldKeyFrames) {
+		wrapBool(writeKeyFrames(stream, state.keyFrames))
+	}
+	if (fields & FieldPalette) {
+		wrapBool(writePalette(stream, state.palette))
+	}
+	if (fields & FieldNormalPalette) {
+		wrapBool(writeNormalPalette(stream, state.normalPalette))
+	}
+	if (fields & FieldProperties) {
+		wrapBool(stream.writeUInt16((uint16_t)state.properties.size()))
+		for (const auto &entry : state.properties) {
+			wrapBool(stream.writePascalStringUInt16LE(entry->key))
+			wrapBool(stream.writePascalStringUInt32LE(entry->value))
+		}
+	}
+	if (fields & FieldData) {
+		wrapBool(writeData(stream, state.data))
+	}
+	if (fields & FieldStringList) {
+		const core::DynamicArray<core::String> *list = state.stringList.value();
+		const uint16_t n = list == nullptr ? 0u : (uint16_t)list->size();
+		wrapBool(stream.writeUInt16(n))
+		for (uint16_t i = 0; i < n; ++i) {
+			wrapBool(stream.writePascalStringUInt16LE((*list)[i]))
+		}
+	}
+	return true;
+}
+
+bool MementoStream::readState(io::ReadStream &stream, MementoState &state) {
+	uint8_t type;
+	wrap(stream.readUInt8(type))
+	if (type >= (uint8_t)MementoType::Max) {
+		Log::error("Invalid memento type %i", (int)type);
+		return false;
+	}
+	state.type = (MementoType)type;
+	wrapBool(readUUID(stream, state.nodeUUID))
+	const uint32_t fields = fieldsForType(state.type);
+	if (fields & FieldParent) {
+		wrapBool(readUUID(stream, state.parentUUID))
+	}
+	if (fields & FieldReference) {
+		wrapBool(readUUID(stream, state.referenceUUID))
+	}
+	if (fields & FieldName) {
+		wrapBool(stream.readPascalStringUInt16LE(state.name))
+	}
+	if (fields & FieldNodeType) {
+		uint8_t nodeType;
+		wrap(stream.readUInt8(nodeType))
+		if (nodeType >= (uint8_t)scenegraph::SceneGraphNodeType::Max) {
+			Log::error("Invalid node type %i", (int)nodeType);
+			return false;
+		}
+		state.nodeType = (scenegraph::SceneGraphNodeType)nodeType;
+	}
+	if (fields & FieldPivot) {
+		wrapBool(readVec3(stream, state.pivot))
+	}
+	if (fields & FieldKeyFrames) {
+		wrapBool(readKeyFrames(stream, state.keyFrames))
+	}
+	if (fields & FieldPalette) {
+		wrapBool(readPalette(stream, state.palette))
+	}
+	if (fields & FieldNormalPalette) {
+		wrapBool(readNormalPalette(stream, state.normalPalette))
+	}
+	if (fields & FieldProperties) {
+		uint16_t n;
+		wrap(stream.readUInt16(n))
+		for (uint16_t i = 0; i < n; ++i) {
+			core::String key;
+			core::String value;
+			wrapBool(stream.readPascalStringUInt16LE(key))
+			wrapBool(stream.readPascalStringUInt32LE(value))
+			state.properties.put(key, value);
+		}
+	}
+	if (fields & FieldData) {
+		wrapBool(readData(stream, state.data))
+	}
+	if (fields & FieldStringList) {
+		uint16_t n;
+		wrap(stream.readUInt16(n))
+		core::DynamicArray<core::String> list;
+		list.resize(n);
+		for (uint16_t i = 0; i < n; ++i) {
+			wrapBool(stream.readPascalStringUInt16LE(list[i]))
+		}
+		state.stringList.setValue(list);
+	}
+	return true;
+}
+
+void MementoStream::add(MementoStreamCommand command, const MementoState &state) {
+	_entries.push_back(Entry{command, state});
+}
+
+void MementoStream::onMementoStateAdded(const MementoState &state) {
+	add(MementoStreamCommand::Apply, state);
+}
+
+void MementoStream::onMementoUndo(const MementoStateGroup &group) {
+	for (int i = (int)group.states.size() - 1; i >= 0; --i) {
+		add(MementoStreamCommand::Undo, group.states[i]);
+	}
+}
+
+void MementoStream::onMementoRedo(const MementoStateGroup &group) {
+	for (const MementoState &state : group.states) {
+		add(MementoStreamCommand::Apply, state);
+	}
+}
+
+void MementoStream::onMementoStatesCleared() {
+	_entries.clear();
+	add(MementoStreamCommand::Reset, MementoState());
+}
+
+void MementoStream::addScene(const scenegraph::SceneGraph &sceneGraph) {
+	onMementoStatesCleared();
+	add(MementoStreamCommand::Apply, MementoState(MementoType::SceneGraphAnimation, sceneGraph.animations()));
+	// depth first to make sure that the parents are known before their children are added
+	core::DynamicArray<int> stack;
+	stack.push_back(sceneGraph.root().id());
+	while (!stack.empty()) {
+		const int nodeId = stack.back();
+		stack.pop();
+		const scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+		const voxel::RawVolume *volume = node.isModelNode() ? node.volume() : nullptr;
+		const MementoData data = MementoData::fromVolume(volume, voxel::Region::InvalidRegion);
+		add(MementoStreamCommand::Apply,
+			MementoState(MementoType::SceneNodeAdded, data, sceneGraph.uuid(node.parent()), node.uuid(),
+						 sceneGraph.uuid(node.reference()), node.name(), node.type(), node.pivot(),
+						 node.allKeyFrames(), node.palette(), node.normalPalette(), node.properties()));
+		const scenegraph::SceneGraphNodeChildren &children = node.children();
+		for (int i = (int)children.size() - 1; i >= 0; --i) {
+			stack.push_back(children[i]);
+		}
+	}
+}
+
+void MementoStream::clear() {
+	_entries.clear();
+}
+
+bool MementoStream::flush(io::WriteStream &stream) {
+	if (_entries.empty()) {
+		return true;
+	}
+	io::BufferedReadWriteStream payload;
+	bool success = true;
+	for (const Entry &entry : _entries) {
+		if (!payload.writeUInt8((uint8_t)entry.command)) {
+			success = false;
+			break;
+		}
+		if (entry.command == MementoStreamCommand::Reset) {
+			continue;
+		}
+		if (!writeState(payload, entry.state)) {
+			success = false;
+			break;
+		}
+	}
+	const uint32_t entries = (uint32_t)_entries.size();
+	_entries.clear();
+	if (!success) {
+		Log::error("Failed to serialize the memento states");
+		return false;
+	}
+	wrapBool(stream.writeUInt32(MementoStreamMagic))
+	wrapBool(stream.writeUInt8(MementoStreamVersion))
+	wrapBool(stream.writeUInt32(_batch++))
+	wrapBool(stream.writeUInt32(entries))
+	wrapBool(stream.writeUInt32((uint32_t)payload.size()))
+	if (stream.write(payload.getBuffer(), payload.size()) != (int)payload.size()) {
+		Log::error("Failed to write the memento stream batch");
+		return false;
+	}
+	return true;
+}
+
+bool MementoStream::apply(io::ReadStream &stream, scenegraph::SceneGraph &sceneGraph) {
+	uint32_t magic;
+	wrap(stream.readUInt32(magic))
+	if (magic != MementoStreamMagic) {
+		Log::error("Invalid memento stream magic");
+		return false;
+	}
+	uint8_t version;
+	wrap(stream.readUInt8(version))
+	if (version != MementoStreamVersion) {
+		Log::error("Unsupported memento stream version %i", (int)version);
+		return false;
+	}
+	uint32_t batch;
+	wrap(stream.readUInt32(batch))
+	uint32_t entries;
+	wrap(stream.readUInt32(entries))
+	uint32_t payloadSize;
+	wrap(stream.readUInt32(payloadSize))
+	// read the whole batch to stay in sync with the stream even if one of the states fails
+	io::BufferedReadWriteStream payload(stream, payloadSize);
+	if (payload.size() != (int64_t)payloadSize) {
+		Log::error("Failed to read the memento stream batch %u", batch);
+		return false;
+	}
+	payload.seek(0);
+	Log::debug("Apply memento stream batch %u with %u entries", batch, entries);
+	bool success = true;
+	for (uint32_t i = 0; i < entries; ++i) {
+		uint8_t command;
+		wrap(payload.readUInt8(command))
+		if (command == (uint8_t)MementoStreamCommand::Reset) {
+			sceneGraph.clear();
+			continue;
+		}
+		if (command >= (uint8_t)MementoStreamCommand::Max) {
+			Log::error("Invalid memento stream command %i", (int)command);
+			return false;
+		}
+		MementoState state;
+		if (!readState(payload, state)) {
+			return false;
+		}
+		if (!applyState(sceneGraph, state, command == (uint8_t)MementoStreamCommand::Undo)) {
+			Log::warn("Failed to apply memento state %s for node %s", MementoHandler::typeToString(state.type),
+					  state.nodeUUID.str().c_str());
+			success = false;
+		}
+	}
+	sceneGraph.updateTransforms();
+	return success;
+}
+
+bool MementoStream::addNode(scenegraph::SceneGraph &sceneGraph, const MementoState &state) {
+	if (state.nodeType == scenegraph::SceneGraphNodeType::Root) {
+		// the remote root node has its own uuid - only the attributes are taken
+		scenegraph::SceneGraphNode &root = sceneGraph.node(sceneGraph.root().id());
+		root.setName(state.name);
+		root.properties().clear();
+		root.addProperties(state.properties);
+		sceneGraph.setAllKeyFramesForNode(root, state.keyFrames);
+		return true;
+	}
+	if (sceneGraph.findNodeByUUID(state.nodeUUID) != nullptr) {
+		Log::warn("Node %s already exists", state.nodeUUID.str().c_str());
+		return false;
+	}
+	scenegraph::SceneGraphNode newNode(state.nodeType, state.nodeUUID);
+	if (newNode.isModelNode()) {
+		newNode.setVolume(new voxel::RawVolume(state.dataRegion()), true);
+		if (state.hasVolumeData()) {
+			MementoData::toVolume(newNode.volume(), state.data);
+		}
+	}
+	newNode.setPalette(state.palette);
+	newNode.setNormalPalette(state.normalPalette);
+	if (newNode.isReferenceNode()) {
+		if (scenegraph::SceneGraphNode *referenceNode = sceneGraph.findNodeByUUID(state.referenceUUID)) {
+			newNode.setReference(referenceNode->id());
+		} else {
+			Log::warn("Reference node %s not found", state.referenceUUID.str().c_str());
+		}
+	}
+	sceneGraph.setAllKeyFramesForNode(newNode, state.keyFrames);
+	newNode.properties().clear();
+	newNode.addProperties(state.properties);
+	newNode.setPivot(state.pivot);
+	newNode.setName(state.name);
+	int parentNodeId = sceneGraph.root().id();
+	if (scenegraph::SceneGraphNode *parentNode = sceneGraph.findNodeByUUID(state.parentUUID)) {
+		parentNodeId = parentNode->id();
+	}
+	return sceneGraph.emplace(core::move(newNode), parentNodeId) != InvalidNodeId;
+}
+
+bool MementoStream::removeNode(scenegraph::SceneGraph &sceneGraph, const MementoState &state) {
+	if (scenegraph::SceneGraphNode *node = sceneGraph.findNodeByUUID(state.nodeUUID)) {
+		return sceneGraph.removeNode(node->id(), true);
+	}
+	return false;
+}
+
+bool MementoStream::applyModification(scenegraph::SceneGraph &sceneGraph, const MementoState &state) {
+	scenegraph::SceneGraphNode *node = sceneGraph.findNodeByUUID(state.nodeUUID);
+	if (node == nullptr) {
+		return false;
+	}
+	if (node->type() == scenegraph::SceneGraphNodeType::Model &&
+		state.nodeType == scenegraph::SceneGraphNodeType::ModelReference) {
+		if (scenegraph::SceneGraphNode *referenceNode = sceneGraph.findNodeByUUID(state.referenceUUID)) {
+			node->setReference(referenceNode->id(), true);
+		}
+	} else {
+		if (node->type() == scenegraph::SceneGraphNodeType::ModelReference &&
+			state.nodeType == scenegraph::SceneGraphNodeType::Model) {
+			node->unreferenceModelNode(sceneGraph.node(node->reference()));
+		}
+		if (node->region() != state.data.volumeRegion()) {
+			node->setVolume(new voxel::RawVolume(state.data.volumeRegion()), true);
+		}
+		if (state.hasVolumeData()) {
+			MementoData::toVolume(node->volume(), state.data);
+		}
+	}
+	node->setName(state.name);
+	node->setPalette(state.palette);
+	return true;
+}
+
+bool MementoStream::applyState(scenegraph::SceneGraph &sceneGraph, const MementoState &state, bool undo) {
+	switch (state.type) {
+	case MementoType::Modification:
+		return applyModification(sceneGraph, state);
+	case MementoType::SceneNodeAdded:
+		return undo ? removeNode(sceneGraph, state) : addNode(sceneGraph, state);
+	case MementoType::SceneNodeRemoved:
+		return undo ? addNode(sceneGraph, state) : removeNode(sceneGraph, state);
+	case MementoType::SceneGraphAnimation:
+		if (const core::DynamicArray<core::String> *animations = state.stringList.value()) {
+			return sceneGraph.setAnimations(*animations);
+		}
+		return false;
+	case MementoType::Max:
+		return false;
+	default:
+		break;
+	}
+	scenegraph::SceneGraphNode *node = sceneGraph.findNodeByUUID(state.nodeUUID);
+	if (node == nullptr) {
+		return false;
+	}
+	switch (state.type) {
+	case MementoType::SceneNodeMove: {
+		int parentNodeId = sceneGraph.root().id();
+		if (scenegraph::SceneGraphNode *parentNode = sceneGraph.findNodeByUUID(state.parentUUID)) {
+			parentNodeId = parentNode->id();
+		}
+		return sceneGraph.changeParent(node->id(), parentNodeId);
+	}
+	case MementoType::SceneNodeRenamed:
+		node->setName(state.name);
+		return true;
+	case MementoType::SceneNodePaletteChanged:
+		node->setPalette(state.palette);
+		return true;
+	case MementoType::SceneNodeNormalPaletteChanged:
+		node->setNormalPalette(state.normalPalette);
+		return true;
+	case MementoType::SceneNodeKeyFrames:
+		sceneGraph.setAllKeyFramesForNode(*node, state.keyFrames);
+		node->setPivot(state.pivot);
+		return true;
+	case MementoType::SceneNodeProperties:
+		node->properties().clear();
+		node->addProperties(state.properties);
+		return true;
+	default:
+		break;
+	}
+	return false;
+}
+
+#undef wrap
+#undef wrapBool
+
+} // namespace memento
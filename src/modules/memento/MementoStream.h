@@ -0,0 +1,101 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "MementoHandler.h"
+#include "MementoStateListener.h"
+#include "core/collection/DynamicArray.h"
+#include <stdint.h>
+
+namespace io {
+class ReadStream;
+class WriteStream;
+} // namespace io
+
+namespace memento {
+
+enum class MementoStreamCommand : uint8_t {
+	/** apply the state - the states that were recorded and the redo steps */
+	Apply,
+	/** revert the state */
+	Undo,
+	/** clear the scene graph - the next states will rebuild the scene */
+	Reset,
+
+	Max
+};
+
+/**
+ * @brief Serializes the memento states into a compact binary delta stream that can be applied to a remote
+ * @c scenegraph::SceneGraph
+ *
+ * The states are collected as a listener of the @c MementoHandler and written as one batch per frame by @c flush().
+ * Only the fields that are needed for the particular @c MementoType are written - the volume data is transferred
+ * in the already compressed form of the memento states (voxel deltas, region or volume snapshots).
+ *
+ * @note The node uuids are used to identify the nodes - the remote scene graph must have been built by the same
+ * stream. Call @c addScene() to start the stream with a snapshot of the whole scene.
+ */
+class MementoStream : public MementoStateListener {
+private:
+	struct Entry {
+		MementoStreamCommand command;
+		MementoState state;
+	};
+	core::DynamicArray<Entry> _entries;
+	uint32_t _batch = 0;
+
+	void add(MementoStreamCommand command, const MementoState &state);
+
+	static bool writeData(io::WriteStream &stream, const MementoData &data);
+	static bool readData(io::ReadStream &stream, MementoData &data);
+	static bool writeState(io::WriteStream &stream, const MementoState &state);
+	static bool readState(io::ReadStream &stream, MementoState &state);
+	static bool addNode(scenegraph::SceneGraph &sceneGraph, const MementoState &state);
+	static bool removeNode(scenegraph::SceneGraph &sceneGraph, const MementoState &state);
+	static bool applyModification(scenegraph::SceneGraph &sceneGraph, const MementoState &state);
+
+public:
+	void onMementoStateAdded(const MementoState &state) override;
+	void onMementoUndo(const MementoStateGroup &group) override;
+	void onMementoRedo(const MementoStateGroup &group) override;
+	void onMementoStatesCleared() override;
+
+	/**
+	 * @brief Queues a reset and all nodes of the given scene graph - the remote scene graph is rebuilt from
+	 * scratch by this
+	 */
+	void addScene(const scenegraph::SceneGraph &sceneGraph);
+
+	/**
+	 * @brief Writes all queued states as one batch into the given stream
+	 * @return @c false if the stream could not be written - the queued states are dropped in any case
+	 */
+	bool flush(io::WriteStream &stream);
+	void clear();
+	bool empty() const;
+	size_t size() const;
+
+	/**
+	 * @brief Reads one batch from the given stream and applies the states to the given scene graph
+	 * @return @c false if the batch could not be read - or one of the states could not be applied
+	 */
+	static bool apply(io::ReadStream &stream, scenegraph::SceneGraph &sceneGraph);
+	/**
+	 * @brief Applies a single state to the given scene graph - this is mirroring what the editor is doing on undo
+	 * and redo
+	 */
+	static bool applyState(scenegraph::SceneGraph &sceneGraph, const MementoState &state, bool undo);
+};
+
+inline bool MementoStream::empty() const {
+	return _entries.empty();
+}
+
+inline size_t MementoStream::size() const {
+	return _entries.size();
+}
+
+} // namespace memento
@@ -5,6 +5,7 @@
 #include "../MementoHandler.h"
 #include "app/tests/AbstractTest.h"
 #include "core/StringUtil.h"
+#include "io/Filesystem.h"
 #include "math/tests/TestMathHelper.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
@@ -18,11 +19,11 @@ private:
 	using Super = app::AbstractTest;
 
 protected:
-	static core::String toFakeUUID(int id) {
+	static core::UUID toFakeUUID(int id) {
 		if (id == InvalidNodeId) {
-			return "";
+			return core::UUID();
 		}
-		return core::string::toString(id);
+		return core::UUID(1u, (uint64_t)id);
 	}
 
 	class TestMementoHandler : public MementoHandler {
@@ -170,7 +171,7 @@ TEST_F(MementoHandlerTest, testUndoRedoDifferentNodes) {
 	{
 		// undo of adding node 2
 		state = firstState(_mementoHandler.undo());
-		EXPECT_EQ(2, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(2), state.nodeUUID);
 		EXPECT_EQ(MementoType::SceneNodeAdded, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(3, state.dataRegion().getWidthInVoxels());
@@ -178,7 +179,7 @@ TEST_F(MementoHandlerTest, testUndoRedoDifferentNodes) {
 	{
 		// undo of adding node 1
 		state = firstState(_mementoHandler.undo());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ(MementoType::SceneNodeAdded, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(2, state.dataRegion().getWidthInVoxels());
@@ -188,7 +189,7 @@ TEST_F(MementoHandlerTest, testUndoRedoDifferentNodes) {
 	{
 		// redo adding node 1
 		state = firstState(_mementoHandler.redo());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ(MementoType::SceneNodeAdded, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(2, state.dataRegion().getWidthInVoxels());
@@ -213,6 +214,47 @@ TEST_F(MementoHandlerTest, testCutStates) {
 	EXPECT_EQ(3, (int)_mementoHandler.stateSize());
 }
 
+TEST_F(MementoHandlerTest, testMaxStates) {
+	_mementoHandler.setMaxStates(2);
+	for (int i = 1; i <= 4; ++i) {
+		core::SharedPtr<voxel::RawVolume> v = create(i);
+		ASSERT_TRUE(_mementoHandler.markUndo(0, 0, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Max, v.get(),
+											 MementoType::Modification));
+	}
+	EXPECT_EQ(2, (int)_mementoHandler.stateSize());
+	EXPECT_EQ(1, _mementoHandler.statePosition());
+	const MementoState &state = firstState(_mementoHandler.undo());
+	ASSERT_TRUE(state.hasVolumeData());
+	EXPECT_EQ(3, state.dataRegion().getWidthInVoxels());
+	EXPECT_FALSE(_mementoHandler.canUndo());
+}
+
+TEST_F(MementoHandlerTest, testMemoryBudgetSpill) {
+	_mementoHandler.setMemoryBudget(1u, io::filesystem()->homeWritePath("test-memento-spill.tmp"));
+	for (int i = 1; i <= 4; ++i) {
+		core::SharedPtr<voxel::RawVolume> v = create(i);
+		ASSERT_TRUE(_mementoHandler.markUndo(0, 0, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Max, v.get(),
+											 MementoType::Modification));
+		// only finished compressions are spilled
+		EXPECT_GT(_mementoHandler.stateGroup().states[0].data.size(), 0u);
+	}
+	const MementoStates &states = _mementoHandler.states();
+	ASSERT_EQ(4, (int)states.size());
+	// the current and the previous state are kept in memory
+	EXPECT_TRUE(states[0].states[0].data.isSpilled());
+	EXPECT_TRUE(states[1].states[0].data.isSpilled());
+	EXPECT_FALSE(states[2].states[0].data.isSpilled());
+	EXPECT_FALSE(states[3].states[0].data.isSpilled());
+
+	MementoState state = firstState(_mementoHandler.undo());
+	EXPECT_EQ(3, state.dataRegion().getWidthInVoxels());
+	state = firstState(_mementoHandler.undo());
+	ASSERT_TRUE(state.hasVolumeData());
+	EXPECT_EQ(2, state.dataRegion().getWidthInVoxels());
+	voxel::RawVolume volume(state.dataRegion());
+	EXPECT_TRUE(MementoData::toVolume(&volume, state.data));
+}
+
 TEST_F(MementoHandlerTest, testAddNewNode) {
 	core::SharedPtr<voxel::RawVolume> first = create(1);
 	core::SharedPtr<voxel::RawVolume> second = create(2);
@@ -233,14 +275,14 @@ TEST_F(MementoHandlerTest, testAddNewNode) {
 	{
 		// undo of adding node 1
 		state = firstState(_mementoHandler.undo());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(3, state.dataRegion().getWidthInVoxels());
 	}
 	{
 		// undo modification in node 0
 		state = firstState(_mementoHandler.undo());
-		EXPECT_EQ(0, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(0), state.nodeUUID);
 		EXPECT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(1, state.dataRegion().getWidthInVoxels());
 	}
@@ -248,14 +290,14 @@ TEST_F(MementoHandlerTest, testAddNewNode) {
 	{
 		// redo modification in node 0
 		state = firstState(_mementoHandler.redo());
-		EXPECT_EQ(0, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(0), state.nodeUUID);
 		EXPECT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(2, state.dataRegion().getWidthInVoxels());
 	}
 	{
 		// redo of adding node 1
 		state = firstState(_mementoHandler.redo());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(3, state.dataRegion().getWidthInVoxels());
 	}
@@ -277,7 +319,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeSimple) {
 		// undo adding node 1
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(0, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 1", state.name);
 		EXPECT_EQ(MementoType::SceneNodeAdded, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
@@ -289,7 +331,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeSimple) {
 		// redo adding node 1
 		state = firstState(_mementoHandler.redo());
 		EXPECT_EQ(1, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ(MementoType::SceneNodeAdded, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(2, state.dataRegion().getWidthInVoxels());
@@ -316,7 +358,7 @@ TEST_F(MementoHandlerTest, testDeleteNode) {
 	{
 		// undo adding node 1
 		state = firstState(_mementoHandler.undo());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Deleted", state.name);
 		EXPECT_EQ(MementoType::SceneNodeRemoved, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
@@ -325,7 +367,7 @@ TEST_F(MementoHandlerTest, testDeleteNode) {
 	{
 		// redo adding node 1
 		state = firstState(_mementoHandler.redo());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Deleted", state.name);
 		EXPECT_EQ(MementoType::SceneNodeRemoved, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
@@ -352,7 +394,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeExt) {
 	{
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(1, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ(MementoType::SceneNodeAdded, state.type);
 		EXPECT_EQ("Node 1 Added", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
@@ -362,7 +404,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeExt) {
 	{
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(0, _mementoHandler.statePosition());
-		EXPECT_EQ(0, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(0), state.nodeUUID);
 		EXPECT_EQ(MementoType::Modification, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(1, state.dataRegion().getWidthInVoxels());
@@ -370,7 +412,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeExt) {
 
 	{
 		state = firstState(_mementoHandler.redo());
-		EXPECT_EQ(0, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(0), state.nodeUUID);
 		EXPECT_EQ(MementoType::Modification, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(2, state.dataRegion().getWidthInVoxels());
@@ -378,7 +420,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeExt) {
 
 	{
 		state = firstState(_mementoHandler.redo());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 1 Added", state.name);
 		EXPECT_EQ(MementoType::SceneNodeAdded, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
@@ -408,7 +450,7 @@ TEST_F(MementoHandlerTest, testDeleteNodeExt) {
 		// undo the deletion of node 1
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(2, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Deleted", state.name);
 		EXPECT_EQ(MementoType::SceneNodeRemoved, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
@@ -420,7 +462,7 @@ TEST_F(MementoHandlerTest, testDeleteNodeExt) {
 		// undo the creation of node 1
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(1, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Added", state.name);
 		EXPECT_EQ(MementoType::SceneNodeAdded, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
@@ -432,7 +474,7 @@ TEST_F(MementoHandlerTest, testDeleteNodeExt) {
 		// undo the modification of node 0
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(0, _mementoHandler.statePosition());
-		EXPECT_EQ(0, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(0), state.nodeUUID);
 		EXPECT_EQ(MementoType::Modification, state.type);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(1, state.dataRegion().getWidthInVoxels());
@@ -443,7 +485,7 @@ TEST_F(MementoHandlerTest, testDeleteNodeExt) {
 		// redo the modification of node 0
 		state = firstState(_mementoHandler.redo());
 		EXPECT_EQ(1, _mementoHandler.statePosition());
-		EXPECT_EQ(0, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(0), state.nodeUUID);
 		EXPECT_EQ("Node 1 Modified", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(2, state.dataRegion().getWidthInVoxels());
@@ -454,7 +496,7 @@ TEST_F(MementoHandlerTest, testDeleteNodeExt) {
 		// redo the add of node 1
 		state = firstState(_mementoHandler.redo());
 		EXPECT_EQ(2, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Added", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(3, state.dataRegion().getWidthInVoxels());
@@ -465,7 +507,7 @@ TEST_F(MementoHandlerTest, testDeleteNodeExt) {
 		// redo the removal of node 1
 		state = firstState(_mementoHandler.redo());
 		EXPECT_EQ(3, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Deleted", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_FALSE(_mementoHandler.canRedo());
@@ -475,7 +517,7 @@ TEST_F(MementoHandlerTest, testDeleteNodeExt) {
 		// undo the removal of node 1
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(2, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Deleted", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(3, state.dataRegion().getWidthInVoxels());
@@ -486,7 +528,7 @@ TEST_F(MementoHandlerTest, testDeleteNodeExt) {
 		// redo the removal of node 1
 		state = firstState(_mementoHandler.redo());
 		EXPECT_EQ(3, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Deleted", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_FALSE(_mementoHandler.canRedo());
@@ -496,7 +538,7 @@ TEST_F(MementoHandlerTest, testDeleteNodeExt) {
 		// undo the removal of node 1
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(2, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Deleted", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(3, state.dataRegion().getWidthInVoxels());
@@ -507,7 +549,7 @@ TEST_F(MementoHandlerTest, testDeleteNodeExt) {
 		// undo the creation of node 1
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(1, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Added", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_TRUE(_mementoHandler.canUndo());
@@ -534,7 +576,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeMultiple) {
 		// undo the creation of node 2
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(1, _mementoHandler.statePosition());
-		EXPECT_EQ(2, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(2), state.nodeUUID);
 		EXPECT_EQ("Node 2 Added", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_TRUE(_mementoHandler.canUndo());
@@ -543,7 +585,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeMultiple) {
 		// undo the creation of node 1
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(0, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 1 Added", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_FALSE(_mementoHandler.canUndo());
@@ -552,7 +594,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeMultiple) {
 		// redo the creation of node 1
 		state = firstState(_mementoHandler.redo());
 		EXPECT_EQ(1, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 1 Added", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(2, state.dataRegion().getWidthInVoxels());
@@ -562,7 +604,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeMultiple) {
 		// redo the creation of node 2
 		state = firstState(_mementoHandler.redo());
 		EXPECT_EQ(2, _mementoHandler.statePosition());
-		EXPECT_EQ(2, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(2), state.nodeUUID);
 		EXPECT_EQ("Node 2 Added", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(3, state.dataRegion().getWidthInVoxels());
@@ -589,7 +631,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeEdit) {
 	{
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(1, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Modified", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(2, state.dataRegion().getWidthInVoxels());
@@ -598,7 +640,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeEdit) {
 	{
 		state = firstState(_mementoHandler.undo());
 		EXPECT_EQ(0, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Added", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_FALSE(_mementoHandler.canUndo());
@@ -606,7 +648,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeEdit) {
 	{
 		state = firstState(_mementoHandler.redo());
 		EXPECT_EQ(1, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Added", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(2, state.dataRegion().getWidthInVoxels());
@@ -615,7 +657,7 @@ TEST_F(MementoHandlerTest, testAddNewNodeEdit) {
 	{
 		state = firstState(_mementoHandler.redo());
 		EXPECT_EQ(2, _mementoHandler.statePosition());
-		EXPECT_EQ(1, core::string::toInt(state.nodeUUID));
+		EXPECT_EQ(toFakeUUID(1), state.nodeUUID);
 		EXPECT_EQ("Node 2 Modified", state.name);
 		ASSERT_TRUE(state.hasVolumeData());
 		EXPECT_EQ(3, state.dataRegion().getWidthInVoxels());
@@ -658,6 +700,130 @@ TEST_F(MementoHandlerTest, testMementoGroupModificationRename) {
 	EXPECT_EQ(voxel::VoxelType::Air, volume.voxel(0, 0, 0).getMaterial());
 }
 
+TEST_F(MementoHandlerTest, testModificationDelta) {
+	scenegraph::SceneGraphNode *node = _sceneGraph.firstModelNode();
+	ASSERT_NE(nullptr, node);
+	node->setVolume(new voxel::RawVolume(voxel::Region(0, 15)), true);
+	_mementoHandler.markInitialNodeState(_sceneGraph, *node);
+	const voxel::Region modifiedRegion(0, 3);
+	node->volume()->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	ASSERT_TRUE(_mementoHandler.markModification(_sceneGraph, *node, modifiedRegion));
+	EXPECT_EQ(2, (int)_mementoHandler.stateSize());
+	{
+		const MementoState &state = firstState(_mementoHandler.stateGroup());
+		EXPECT_TRUE(state.data.isDelta());
+		EXPECT_EQ(modifiedRegion, state.dataRegion());
+		EXPECT_EQ(node->region(), state.data.volumeRegion());
+	}
+
+	voxel::RawVolume volume(*node->volume());
+	MementoState stateUndo = firstState(_mementoHandler.undo());
+	ASSERT_TRUE(MementoData::toVolume(&volume, stateUndo.data));
+	EXPECT_EQ(voxel::VoxelType::Air, volume.voxel(1, 2, 3).getMaterial());
+
+	MementoState stateRedo = firstState(_mementoHandler.redo());
+	ASSERT_TRUE(MementoData::toVolume(&volume, stateRedo.data));
+	EXPECT_EQ(voxel::VoxelType::Generic, volume.voxel(1, 2, 3).getMaterial());
+}
+
+TEST_F(MementoHandlerTest, testModificationRegionSnapshot) {
+	scenegraph::SceneGraphNode *node = _sceneGraph.firstModelNode();
+	ASSERT_NE(nullptr, node);
+	node->setVolume(new voxel::RawVolume(voxel::Region(0, 15)), true);
+	_mementoHandler.markInitialNodeState(_sceneGraph, *node);
+	const voxel::Region modifiedRegion(0, 3);
+	const voxel::Voxel solid = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	for (int z = 0; z <= 3; ++z) {
+		for (int y = 0; y <= 3; ++y) {
+			for (int x = 0; x <= 3; ++x) {
+				node->volume()->setVoxel(x, y, z, solid);
+			}
+		}
+	}
+	ASSERT_TRUE(_mementoHandler.markModification(_sceneGraph, *node, modifiedRegion));
+	{
+		const MementoState &state = firstState(_mementoHandler.stateGroup());
+		EXPECT_FALSE(state.data.isDelta());
+		EXPECT_TRUE(state.data.isBricks());
+		EXPECT_TRUE(state.undoData.hasVolume());
+		EXPECT_EQ(modifiedRegion, state.dataRegion());
+	}
+
+	// apply a second modification to verify that the delta is computed against the recorded state
+	node->volume()->setVoxel(3, 3, 3, voxel::Voxel());
+	ASSERT_TRUE(_mementoHandler.markModification(_sceneGraph, *node, voxel::Region(0, 4)));
+	EXPECT_TRUE(firstState(_mementoHandler.stateGroup()).data.isDelta());
+
+	voxel::RawVolume volume(*node->volume());
+	MementoState stateUndo = firstState(_mementoHandler.undo());
+	ASSERT_TRUE(MementoData::toVolume(&volume, stateUndo.data));
+	EXPECT_EQ(voxel::VoxelType::Generic, volume.voxel(3, 3, 3).getMaterial());
+	stateUndo = firstState(_mementoHandler.undo());
+	ASSERT_TRUE(MementoData::toVolume(&volume, stateUndo.data));
+	EXPECT_EQ(voxel::VoxelType::Air, volume.voxel(0, 0, 0).getMaterial());
+	EXPECT_EQ(voxel::VoxelType::Air, volume.voxel(3, 3, 3).getMaterial());
+}
+
+TEST_F(MementoHandlerTest, testModificationBricks) {
+	scenegraph::SceneGraphNode *node = _sceneGraph.firstModelNode();
+	ASSERT_NE(nullptr, node);
+	node->setVolume(new voxel::RawVolume(voxel::Region(0, 31)), true);
+	_mementoHandler.markInitialNodeState(_sceneGraph, *node);
+	// fill everything but the upper brick - too many voxels for a delta
+	const voxel::Voxel solid = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	const voxel::Region untouched(16, 31);
+	for (int z = 0; z <= 31; ++z) {
+		for (int y = 0; y <= 31; ++y) {
+			for (int x = 0; x <= 31; ++x) {
+				if (!untouched.containsPoint(x, y, z)) {
+					node->volume()->setVoxel(x, y, z, solid);
+				}
+			}
+		}
+	}
+	ASSERT_TRUE(_mementoHandler.markModification(_sceneGraph, *node, node->region()));
+	{
+		const MementoState &state = firstState(_mementoHandler.stateGroup());
+		ASSERT_TRUE(state.data.isBricks());
+		ASSERT_TRUE(state.undoData.isBricks());
+		EXPECT_FALSE(state.data.isFullVolume());
+		voxel::RawVolume volume(node->region());
+		volume.fill(voxel::createVoxel(voxel::VoxelType::Generic, 2));
+		ASSERT_TRUE(MementoData::toVolume(&volume, state.data));
+		EXPECT_EQ(1, volume.voxel(0, 0, 0).getColor());
+		EXPECT_EQ(1, volume.voxel(31, 0, 0).getColor());
+		EXPECT_EQ(2, volume.voxel(16, 16, 16).getColor()) << "The unchanged brick should not be part of the state";
+		EXPECT_EQ(2, volume.voxel(31, 31, 31).getColor()) << "The unchanged brick should not be part of the state";
+	}
+
+	voxel::RawVolume volume(*node->volume());
+	MementoState stateUndo = firstState(_mementoHandler.undo());
+	ASSERT_TRUE(MementoData::toVolume(&volume, stateUndo.data));
+	EXPECT_EQ(voxel::VoxelType::Air, volume.voxel(0, 0, 0).getMaterial());
+	EXPECT_EQ(voxel::VoxelType::Air, volume.voxel(15, 31, 31).getMaterial());
+
+	MementoState stateRedo = firstState(_mementoHandler.redo());
+	ASSERT_TRUE(MementoData::toVolume(&volume, stateRedo.data));
+	EXPECT_EQ(voxel::VoxelType::Generic, volume.voxel(0, 0, 0).getMaterial());
+	EXPECT_EQ(voxel::VoxelType::Generic, volume.voxel(15, 31, 31).getMaterial());
+	EXPECT_EQ(voxel::VoxelType::Air, volume.voxel(16, 16, 16).getMaterial());
+}
+
+TEST_F(MementoHandlerTest, testModifyWhileCompressing) {
+	scenegraph::SceneGraphNode *node = _sceneGraph.firstModelNode();
+	ASSERT_NE(nullptr, node);
+	node->volume()->setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	_mementoHandler.markInitialNodeState(_sceneGraph, *node);
+	// the snapshot must not see this change - even if the compression is still running
+	node->volume()->setVoxel(0, 0, 0, voxel::Voxel());
+	const MementoState &state = firstState(_mementoHandler.stateGroup());
+	ASSERT_TRUE(state.hasVolumeData());
+	voxel::RawVolume volume(node->region());
+	ASSERT_TRUE(MementoData::toVolume(&volume, state.data));
+	EXPECT_FALSE(state.data.isCompressing());
+	EXPECT_EQ(voxel::VoxelType::Generic, volume.voxel(0, 0, 0).getMaterial());
+}
+
 TEST_F(MementoHandlerTest, testSceneNodePaletteChange) {
 	scenegraph::SceneGraphNode *node = _sceneGraph.firstModelNode();
 	ASSERT_NE(nullptr, node);
@@ -677,7 +843,7 @@ TEST_F(MementoHandlerTest, testSceneNodePaletteChange) {
 TEST_F(MementoHandlerTest, testSceneNodeMove) {
 	scenegraph::SceneGraphNode *node = _sceneGraph.firstModelNode();
 	ASSERT_NE(nullptr, node);
-	const core::String oldParent = _sceneGraph.uuid(node->parent());
+	const core::UUID oldParent = _sceneGraph.uuid(node->parent());
 	_mementoHandler.markInitialNodeState(_sceneGraph, *node);
 	const auto *parentNode = _sceneGraph.findNodeByUUID(_mementoHandler.stateGroup().states[0].parentUUID);
 	ASSERT_TRUE(parentNode != nullptr);
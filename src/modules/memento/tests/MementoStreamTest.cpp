@@ -0,0 +1,130 @@
+/**
+ * @file
+ */
+
+#include "../MementoStream.h"
+#include "app/tests/AbstractTest.h"
+#include "io/BufferedReadWriteStream.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
+
+namespace memento {
+
+class MementoStreamTest : public app::AbstractTest {
+private:
+	using Super = app::AbstractTest;
+
+protected:
+	MementoHandler _mementoHandler;
+	MementoStream _stream;
+	scenegraph::SceneGraph _sceneGraph;
+	scenegraph::SceneGraph _remoteSceneGraph;
+
+	void SetUp() override {
+		Super::SetUp();
+		ASSERT_TRUE(_mementoHandler.init());
+		_mementoHandler.registerListener(&_stream);
+	}
+
+	void TearDown() override {
+		_mementoHandler.unregisterListener(&_stream);
+		_mementoHandler.shutdown();
+		_sceneGraph.clear();
+		_remoteSceneGraph.clear();
+		Super::TearDown();
+	}
+
+	int addModelNode(const core::String &name, int parent = 0) {
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(new voxel::RawVolume(voxel::Region(0, 7)), true);
+		node.setName(name);
+		return _sceneGraph.emplace(core::move(node), parent);
+	}
+
+	void sync() {
+		ASSERT_FALSE(_stream.empty());
+		io::BufferedReadWriteStream stream;
+		ASSERT_TRUE(_stream.flush(stream));
+		EXPECT_TRUE(_stream.empty());
+		stream.seek(0);
+		ASSERT_TRUE(MementoStream::apply(stream, _remoteSceneGraph));
+		EXPECT_EQ(stream.size(), stream.pos());
+	}
+
+	scenegraph::SceneGraphNode *remoteNode(int nodeId) {
+		return _remoteSceneGraph.findNodeByUUID(_sceneGraph.node(nodeId).uuid());
+	}
+};
+
+TEST_F(MementoStreamTest, testSceneSnapshot) {
+	scenegraph::SceneGraphNode group(scenegraph::SceneGraphNodeType::Group);
+	group.setName("group");
+	const int groupId = _sceneGraph.emplace(core::move(group));
+	ASSERT_NE(InvalidNodeId, groupId);
+	const int nodeId = addModelNode("model", groupId);
+	ASSERT_NE(InvalidNodeId, nodeId);
+	_sceneGraph.node(nodeId).volume()->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	_sceneGraph.node(nodeId).setProperty("key", "value");
+
+	_stream.addScene(_sceneGraph);
+	sync();
+
+	scenegraph::SceneGraphNode *node = remoteNode(nodeId);
+	ASSERT_NE(nullptr, node);
+	EXPECT_EQ("model", node->name());
+	EXPECT_EQ("value", node->property("key"));
+	EXPECT_EQ(_sceneGraph.node(nodeId).region(), node->region());
+	EXPECT_EQ(voxel::VoxelType::Generic, node->volume()->voxel(1, 2, 3).getMaterial());
+	scenegraph::SceneGraphNode *groupNode = remoteNode(groupId);
+	ASSERT_NE(nullptr, groupNode);
+	EXPECT_EQ(groupNode->id(), node->parent());
+}
+
+TEST_F(MementoStreamTest, testModificationUndoRedo) {
+	const int nodeId = addModelNode("model");
+	ASSERT_NE(InvalidNodeId, nodeId);
+	scenegraph::SceneGraphNode &node = _sceneGraph.node(nodeId);
+	ASSERT_TRUE(_mementoHandler.markInitialSceneState(_sceneGraph));
+	sync();
+	ASSERT_NE(nullptr, remoteNode(nodeId));
+
+	node.volume()->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	ASSERT_TRUE(_mementoHandler.markModification(_sceneGraph, node, voxel::Region(0, 3)));
+	node.setName("renamed");
+	ASSERT_TRUE(_mementoHandler.markNodeRenamed(_sceneGraph, node));
+	sync();
+	EXPECT_EQ("renamed", remoteNode(nodeId)->name());
+	EXPECT_EQ(voxel::VoxelType::Generic, remoteNode(nodeId)->volume()->voxel(1, 2, 3).getMaterial());
+
+	_mementoHandler.undo();
+	_mementoHandler.undo();
+	sync();
+	EXPECT_EQ("model", remoteNode(nodeId)->name());
+	EXPECT_EQ(voxel::VoxelType::Air, remoteNode(nodeId)->volume()->voxel(1, 2, 3).getMaterial());
+
+	_mementoHandler.redo();
+	sync();
+	EXPECT_EQ(voxel::VoxelType::Generic, remoteNode(nodeId)->volume()->voxel(1, 2, 3).getMaterial());
+}
+
+TEST_F(MementoStreamTest, testNodeRemoved) {
+	const int nodeId = addModelNode("model");
+	ASSERT_NE(InvalidNodeId, nodeId);
+	_stream.addScene(_sceneGraph);
+	sync();
+	ASSERT_NE(nullptr, remoteNode(nodeId));
+
+	const core::UUID uuid = _sceneGraph.node(nodeId).uuid();
+	ASSERT_TRUE(_mementoHandler.markNodeRemove(_sceneGraph, _sceneGraph.node(nodeId)));
+	sync();
+	EXPECT_EQ(nullptr, _remoteSceneGraph.findNodeByUUID(uuid));
+
+	_mementoHandler.clearStates();
+	_stream.addScene(_sceneGraph);
+	sync();
+	EXPECT_NE(nullptr, _remoteSceneGraph.findNodeByUUID(uuid));
+	EXPECT_EQ(1u, _remoteSceneGraph.size());
+}
+
+} // namespace memento
@@ -50,9 +50,62 @@ bool Metric::init(const char *prefix, const IMetricSenderPtr &messageSender) {
 }
 
 void Metric::shutdown() {
+	_batch.clear();
+	_batching = false;
 	_messageSender = IMetricSenderPtr();
 }
 
+void Metric::beginBatch() {
+	_batching = true;
+}
+
+bool Metric::endBatch() {
+	_batching = false;
+	return sendBatch();
+}
+
+bool Metric::sendBatch() const {
+	if (_batch.empty()) {
+		return true;
+	}
+	const bool success = _messageSender && _messageSender->send(_batch.c_str());
+	_batch.clear();
+	return success;
+}
+
+bool Metric::send(const char *line) const {
+	if (!_batching) {
+		return _messageSender->send(line);
+	}
+	const size_t len = SDL_strlen(line);
+	if (!_batch.empty() && _batch.size() + 1u + len > MaxBatchSize) {
+		if (!sendBatch()) {
+			return false;
+		}
+	}
+	if (!_batch.empty()) {
+		_batch.append("\n");
+	}
+	_batch.append(line);
+	return true;
+}
+
+/**
+ * @return The sample rate without trailing zeros or an empty string if every sample was recorded
+ */
+static core::String sampleRateStr(float sampleRate) {
+	if (sampleRate >= 1.0f || sampleRate <= 0.0f) {
+		return "";
+	}
+	char buf[32];
+	SDL_snprintf(buf, sizeof(buf), "%f", sampleRate);
+	size_t len = SDL_strlen(buf);
+	while (len > 0 && buf[len - 1] == '0') {
+		buf[--len] = '\0';
+	}
+	return buf;
+}
+
 bool Metric::createTags(char *buffer, size_t len, const TagMap &tags, const char *sep, const char *preamble,
 						const char *split) const {
 	const size_t preambleLen = SDL_strlen(preamble);
@@ -99,7 +152,7 @@ bool Metric::createTags(char *buffer, size_t len, const TagMap &tags, const char
 	return true;
 }
 
-bool Metric::assemble(const char *key, int value, const char *type, const TagMap &tags) const {
+bool Metric::assemble(const char *key, int value, const char *type, const TagMap &tags, float sampleRate) const {
 	if (!_messageSender) {
 		return false;
 	}
@@ -107,6 +160,9 @@ bool Metric::assemble(const char *key, int value, const char *type, const TagMap
 	char buffer[metricSize];
 	constexpr int tagsSize = 256;
 	char tagsBuffer[tagsSize] = "";
+	const core::String &rate = sampleRateStr(sampleRate);
+	// the statsd flavors append the sample rate to the type
+	const core::String &typeRate = rate.empty() ? core::String(type) : core::String::format("%s|@%s", type, rate.c_str());
 	int written;
 	switch (_flavor) {
 	case Flavor::JSON: {
@@ -116,6 +172,9 @@ bool Metric::assemble(const char *key, int value, const char *type, const TagMap
 		json.append("\"name\": \"").append(key).append("\",");
 		json.append("\"value\": ").append(value).append(",");
 		json.append("\"type\": \"").append(type).append("\",");
+		if (!rate.empty()) {
+			json.append("\"samplerate\": ").append(rate).append(",");
+		}
 		json.append("\"uuid\": \"").append(_uuid).append("\",");
 		json.append("\"tags\": {");
 		bool firstTag = true;
@@ -137,33 +196,33 @@ bool Metric::assemble(const char *key, int value, const char *type, const TagMap
 		return true;
 	}
 	case Flavor::Etsy:
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s:%i|%s", _prefix.c_str(), key, value, type);
+		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s:%i|%s", _prefix.c_str(), key, value, typeRate.c_str());
 		break;
 	case Flavor::Datadog:
 		if (!createTags(tagsBuffer, sizeof(tagsBuffer), tags, ":", "|#", ",")) {
 			return false;
 		}
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s:%i|%s%s", _prefix.c_str(), key, value, type, tagsBuffer);
+		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s:%i|%s%s", _prefix.c_str(), key, value, typeRate.c_str(), tagsBuffer);
 		break;
 	case Flavor::Influx:
 		if (!createTags(tagsBuffer, sizeof(tagsBuffer), tags, "=", ",", ",")) {
 			return false;
 		}
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s_%s,type=%s%s value=%i", _prefix.c_str(), key, type,
-							   tagsBuffer, value);
+		written = SDL_snprintf(buffer, sizeof(buffer), "%s_%s,type=%s%s value=%i%s%s", _prefix.c_str(), key, type,
+							   tagsBuffer, value, rate.empty() ? "" : ",samplerate=", rate.c_str());
 		break;
 	case Flavor::Telegraf:
 	default:
 		if (!createTags(tagsBuffer, sizeof(tagsBuffer), tags, "=", ",", ",")) {
 			return false;
 		}
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s%s:%i|%s", _prefix.c_str(), key, tagsBuffer, value, type);
+		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s%s:%i|%s", _prefix.c_str(), key, tagsBuffer, value, typeRate.c_str());
 		break;
 	}
 	if (written >= metricSize) {
 		return false;
 	}
-	return _messageSender->send(buffer);
+	return send(buffer);
 }
 
 } // namespace metric
@@ -36,13 +36,27 @@ using TagMap = core::StringMap<core::String, 4>;
 
 /**
  * @brief The Metric class generates and publishes metrics
+ *
+ * Every call formats one metric line. In batch mode (see @c beginBatch()) the lines are collected and sent as one
+ * packet (separated by newlines) instead of one packet per metric.
+ *
+ * @note Not thread safe - use the @c MetricAggregator to record metrics from several threads
+ * @sa MetricAggregator
  */
 class Metric : public core::NonCopyable {
+public:
+	/**
+	 * @brief The max size of a batched packet - stay below the usual MTU to avoid fragmented udp packets
+	 */
+	static constexpr size_t MaxBatchSize = 1432u;
+
 private:
 	core::String _prefix;
 	core::String _uuid;
 	Flavor _flavor = Flavor::Telegraf;
 	mutable IMetricSenderPtr _messageSender;
+	mutable core::String _batch;
+	mutable bool _batching = false;
 
 	/**
 	 * @brief Create the needed tag list if it is supported by the specified flavor
@@ -54,7 +68,9 @@ private:
 	 * @return @c false if not all tags could get written into the specified target buffer, @c true otherwise
 	 */
 	bool createTags(char *buffer, size_t len, const TagMap& tags, const char* sep, const char* preamble, const char *split = ",") const;
-	bool assemble(const char* key, int value, const char* type, const TagMap& tags = {}) const;
+	bool assemble(const char* key, int value, const char* type, const TagMap& tags = {}, float sampleRate = 1.0f) const;
+	bool send(const char *line) const;
+	bool sendBatch() const;
 public:
 	~Metric();
 
@@ -65,6 +81,16 @@ public:
 	bool init(const char *prefix, const IMetricSenderPtr& messageSender);
 	void shutdown();
 
+	/**
+	 * @brief Collect the metric lines until @c endBatch() is called
+	 * @note The flavors that don't support several metrics in one packet (json) are still sent one by one
+	 */
+	void beginBatch();
+	/**
+	 * @brief Sends the collected metric lines
+	 */
+	bool endBatch();
+
 	/**
 	 * @brief Increments the key
 	 */
@@ -83,6 +109,8 @@ public:
 	 * of the number of samples per event count. For example, a sample rate of 1/10
 	 * would be exported as 0.1. Valid counter values are in the range (-2^63^, 2^63^).
 	 * @code <metric name>:<value>|c[|@<sample rate>] @endcode
+	 * @param sampleRate The rate that was used to sample the delta - the sampling itself is not done here. The
+	 * server scales the value by the inverse of the rate.
 	 * @note Record event counts
 	 */
 	bool count(const char* key, int delta, const TagMap& tags = {}, float sampleRate = 1.0f) const;
@@ -103,10 +131,11 @@ public:
 	 * A timer is a measure of the number of milliseconds elapsed between a start
 	 * and end time, for example the time to complete rendering of a web page for
 	 * a user. Valid timer values are in the range [0, 2^64^).
-	 * @code <metric name>:<value>|ms @endcode
+	 * @code <metric name>:<value>|ms[|@<sample rate>] @endcode
+	 * @param sampleRate A rate of @c 1/n lets the server count the timing @c n times
 	 * @note Record execution times
 	 */
-	bool timing(const char* key, uint32_t millis, const TagMap& tags = {}) const;
+	bool timing(const char* key, uint32_t millis, const TagMap& tags = {}, float sampleRate = 1.0f) const;
 
 	/**
 	 * @brief Records a histogram
@@ -144,15 +173,15 @@ inline bool Metric::decrement(const char* key, const TagMap& tags) const {
 }
 
 inline bool Metric::count(const char* key, int delta, const TagMap& tags, float sampleRate) const {
-	return assemble(key, delta, "c", tags); // TODO:"|@%f", sampleRate
+	return assemble(key, delta, "c", tags, sampleRate);
 }
 
 inline bool Metric::gauge(const char* key, uint32_t value, const TagMap& tags) const {
 	return assemble(key, value, "g", tags);
 }
 
-inline bool Metric::timing(const char* key, uint32_t millis, const TagMap& tags) const {
-	return assemble(key, millis, "ms", tags);
+inline bool Metric::timing(const char* key, uint32_t millis, const TagMap& tags, float sampleRate) const {
+	return assemble(key, millis, "ms", tags, sampleRate);
 }
 
 inline bool Metric::histogram(const char* key, uint32_t millis, const TagMap& tags) const {
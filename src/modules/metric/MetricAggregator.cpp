@@ -0,0 +1,162 @@
+/**
+ * @file
+ */
+
+#include "MetricAggregator.h"
+#include "core/concurrent/Atomic.h"
+#include <random>
+
+namespace metric {
+
+void MetricAggregator::Entry::merge(const Entry &other) {
+	if (type == Type::Gauge) {
+		value = other.value;
+		return;
+	}
+	value += other.value;
+	for (int i = 0; i < Buckets; ++i) {
+		buckets[i].count += other.buckets[i].count;
+		buckets[i].sum += other.buckets[i].sum;
+	}
+}
+
+core::String MetricAggregator::id(const core::String &key, Type type, const core::DynamicArray<core::String> &tags,
+								  float sampleRate) {
+	core::String id = core::String::format("%s|%i|%f", key.c_str(), (int)type, sampleRate);
+	for (const core::String &tag : tags) {
+		id.append("|");
+		id.append(tag);
+	}
+	return id;
+}
+
+int MetricAggregator::bucket(uint32_t millis) {
+	for (int i = 0; i < Buckets - 1; ++i) {
+		if (millis <= BucketBounds[i]) {
+			return i;
+		}
+	}
+	return Buckets - 1;
+}
+
+MetricAggregator::Shard &MetricAggregator::shard() {
+	static core::AtomicInt nextShard{0};
+	static thread_local const int threadShard = nextShard.increment(1) % Shards;
+	return _shards[threadShard];
+}
+
+MetricAggregator::Entry &MetricAggregator::entry(Entries &entries, const core::String &key, Type type,
+												 const TagMap &tags, float sampleRate) {
+	core::DynamicArray<core::String> sortedTags;
+	sortedTags.reserve(tags.size() * 2);
+	for (const auto &e : tags) {
+		size_t idx = 0;
+		while (idx < sortedTags.size() && sortedTags[idx] < e->key) {
+			idx += 2;
+		}
+		const core::String pair[]{e->key, e->value};
+		sortedTags.insert(sortedTags.begin() + idx, pair, 2);
+	}
+	const core::String &entryId = id(key, type, sortedTags, sampleRate);
+	auto iter = entries.find(entryId);
+	if (iter == entries.end()) {
+		Entry newEntry;
+		newEntry.key = key;
+		newEntry.tags = core::move(sortedTags);
+		newEntry.type = type;
+		newEntry.sampleRate = sampleRate;
+		entries.emplace(entryId, core::move(newEntry));
+		iter = entries.find(entryId);
+	}
+	return iter->value;
+}
+
+void MetricAggregator::count(const core::String &key, int delta, const TagMap &tags, float sampleRate) {
+	if (sampleRate <= 0.0f) {
+		return;
+	}
+	if (sampleRate < 1.0f) {
+		static thread_local std::minstd_rand rng(std::random_device{}());
+		std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+		if (distribution(rng) >= sampleRate) {
+			return;
+		}
+	} else {
+		sampleRate = 1.0f;
+	}
+	Shard &s = shard();
+	core::ScopedLock lock(s.lock);
+	entry(s.entries, key, Type::Counter, tags, sampleRate).value += delta;
+}
+
+void MetricAggregator::gauge(const core::String &key, uint32_t value, const TagMap &tags) {
+	Shard &s = shard();
+	core::ScopedLock lock(s.lock);
+	entry(s.entries, key, Type::Gauge, tags, 1.0f).value = value;
+}
+
+void MetricAggregator::timing(const core::String &key, uint32_t millis, const TagMap &tags) {
+	Shard &s = shard();
+	core::ScopedLock lock(s.lock);
+	Bucket &b = entry(s.entries, key, Type::Timing, tags, 1.0f).buckets[bucket(millis)];
+	++b.count;
+	b.sum += millis;
+}
+
+bool MetricAggregator::flush(Metric &metric) {
+	Entries merged;
+	for (int i = 0; i < Shards; ++i) {
+		Entries entries;
+		{
+			core::ScopedLock lock(_shards[i].lock);
+			entries = core::move(_shards[i].entries);
+		}
+		if (merged.empty()) {
+			merged = core::move(entries);
+			continue;
+		}
+		for (const auto &e : entries) {
+			auto iter = merged.find(e->key);
+			if (iter == merged.end()) {
+				merged.emplace(e->key, core::move(e->value));
+			} else {
+				iter->value.merge(e->value);
+			}
+		}
+	}
+
+	bool success = true;
+	metric.beginBatch();
+	for (const auto &e : merged) {
+		const Entry &entry = e->value;
+		TagMap tags((int)entry.tags.size() / 2 + 1);
+		for (size_t i = 0; i + 1 < entry.tags.size(); i += 2) {
+			tags.put(entry.tags[i], entry.tags[i + 1]);
+		}
+		const char *key = entry.key.c_str();
+		switch (entry.type) {
+		case Type::Counter:
+			if (entry.value != 0) {
+				success &= metric.count(key, (int)entry.value, tags, entry.sampleRate);
+			}
+			break;
+		case Type::Gauge:
+			success &= metric.gauge(key, (uint32_t)entry.value, tags);
+			break;
+		case Type::Timing:
+			for (int i = 0; i < Buckets; ++i) {
+				const Bucket &b = entry.buckets[i];
+				if (b.count == 0u) {
+					continue;
+				}
+				const uint32_t mean = (uint32_t)(b.sum / b.count);
+				success &= metric.timing(key, mean, tags, 1.0f / (float)b.count);
+			}
+			break;
+		}
+	}
+	success &= metric.endBatch();
+	return success;
+}
+
+} // namespace metric
@@ -0,0 +1,93 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Metric.h"
+#include "core/NonCopyable.h"
+#include "core/String.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/FlatMap.h"
+#include "core/concurrent/Lock.h"
+#include <stdint.h>
+
+namespace metric {
+
+/**
+ * @brief Aggregates the metrics on the client side and sends them in batches
+ *
+ * Counters are summed up, for gauges only the last value is kept and timings are collected in a histogram. Nothing
+ * is formatted or sent until @c flush() is called - recording a metric is only a map lookup.
+ *
+ * Every thread records into its own shard. The shards are only shared with the thread that calls @c flush() - the
+ * locks are not contended while recording.
+ *
+ * @ingroup Metric
+ */
+class MetricAggregator : public core::NonCopyable {
+public:
+	static constexpr int Shards = 8;
+	/**
+	 * @brief The upper bounds (inclusive) in millis of the timing histogram buckets - the last bucket takes
+	 * everything above
+	 */
+	static constexpr uint32_t BucketBounds[]{1u, 2u, 5u, 10u, 20u, 50u, 100u, 200u, 500u, 1000u, 2000u, 5000u, 10000u};
+	static constexpr int Buckets = (int)(sizeof(BucketBounds) / sizeof(BucketBounds[0])) + 1;
+
+private:
+	enum class Type : uint8_t { Counter, Gauge, Timing };
+
+	struct Bucket {
+		uint32_t count = 0u;
+		uint64_t sum = 0u;
+	};
+
+	struct Entry {
+		core::String key;
+		// key value pairs sorted by the key - a TagMap is only created when the entry is sent
+		core::DynamicArray<core::String> tags;
+		Type type = Type::Counter;
+		float sampleRate = 1.0f;
+		int64_t value = 0;
+		Bucket buckets[Buckets];
+
+		void merge(const Entry &other);
+	};
+
+	// the aggregation key is built from the metric key, the type, the sample rate and the tags
+	using Entries = core::FlatMap<core::String, Entry, core::StringHash>;
+
+	struct Shard {
+		core_trace_mutex(core::Lock, lock, "MetricShard");
+		Entries entries;
+	};
+	Shard _shards[Shards];
+
+	static core::String id(const core::String &key, Type type, const core::DynamicArray<core::String> &tags,
+						   float sampleRate);
+	static int bucket(uint32_t millis);
+	Shard &shard();
+	Entry &entry(Entries &entries, const core::String &key, Type type, const TagMap &tags, float sampleRate);
+
+public:
+	/**
+	 * @param sampleRate Only record the given fraction of the calls (in the range (0, 1]). The sent value is
+	 * marked with the sample rate to let the server scale it.
+	 */
+	void count(const core::String &key, int delta, const TagMap &tags = {}, float sampleRate = 1.0f);
+	void gauge(const core::String &key, uint32_t value, const TagMap &tags = {});
+	void timing(const core::String &key, uint32_t millis, const TagMap &tags = {});
+
+	/**
+	 * @brief Sends the aggregated metrics of all threads as batches and resets the aggregation
+	 *
+	 * Each non empty histogram bucket of a timing is sent as the mean value of the bucket with a sample rate of
+	 * @c 1/count - the server counts it as often as it was recorded.
+	 * @return @c false if any of the metrics failed to get sent
+	 */
+	bool flush(Metric &metric);
+};
+
+} // namespace metric
@@ -3,10 +3,13 @@
  */
 
 #include "MetricFacade.h"
+#include "MetricAggregator.h"
 #include "UDPMetricSender.h"
 #include "core/ConfigVar.h"
 #include "core/Log.h"
+#include "core/TimeProvider.h"
 #include "core/Var.h"
+#include "core/concurrent/Atomic.h"
 #include "core/concurrent/ThreadPool.h"
 #include "metric/HTTPMetricSender.h"
 #include "engine-config.h"
@@ -16,10 +19,23 @@ namespace metric {
 struct MetricState {
 	metric::IMetricSenderPtr _sender;
 	metric::Metric _metric;
-	core::ThreadPool _threadPool{1, "metric"};
+	metric::MetricAggregator _aggregator;
+	core::ThreadPool _threadPool{1, "metric", core::ThreadPriority::Low};
+	core::AtomicBool _initialized{false};
+	core::AtomicBool _flushScheduled{false};
+	uint64_t _initMillis = 0u;
+	int _flushIntervalSeconds = 10;
+	// seconds since init
+	core::AtomicInt _nextFlush{0};
+
+	int secondsSinceInit() const {
+		return (int)((core::TimeProvider::systemMillis() - _initMillis) / 1000u);
+	}
 
 	bool init(const core::String &appname);
 	void shutdown();
+	void flush();
+	void flushIfNeeded();
 
 	static MetricState &getInstance() {
 		static MetricState theInstance;
@@ -51,13 +67,22 @@ bool MetricState::init(const core::String &appname) {
 		Log::warn("Failed to init metrics");
 		return false;
 	}
+	_flushIntervalSeconds = core::Var::get(cfg::MetricFlushInterval, "10", "Seconds between two metric batches",
+										   core::Var::minMaxValidator<1, 3600>)->intVal();
+	_initMillis = core::TimeProvider::systemMillis();
+	_nextFlush = _flushIntervalSeconds;
 	_threadPool.init();
+	_initialized = true;
 	Log::info("Initialized metrics");
 	return true;
 }
 
 void MetricState::shutdown() {
+	const bool initialized = _initialized.exchange(false);
 	_threadPool.shutdown(true);
+	if (initialized) {
+		_aggregator.flush(_metric);
+	}
 	if (_sender) {
 		_sender->shutdown();
 		_sender = metric::IMetricSenderPtr();
@@ -65,14 +90,63 @@ void MetricState::shutdown() {
 	_metric.shutdown();
 }
 
-bool count(const core::String &key, int delta, const TagMap &tags) {
-	MetricState &s = MetricState::getInstance();
-	s._threadPool.enqueue([=, &s]() {
-		s._metric.count(key.c_str(), delta, tags);
+void MetricState::flush() {
+	if (!_initialized) {
+		return;
+	}
+	if (_flushScheduled.exchange(true)) {
+		return;
+	}
+	_nextFlush = secondsSinceInit() + _flushIntervalSeconds;
+	_threadPool.schedule([this]() {
+		_flushScheduled = false;
+		if (!_aggregator.flush(_metric)) {
+			Log::debug("Failed to send some of the metrics");
+		}
 	});
+}
+
+void MetricState::flushIfNeeded() {
+	if (_flushScheduled || secondsSinceInit() < _nextFlush) {
+		return;
+	}
+	flush();
+}
+
+bool count(const core::String &key, int delta, const TagMap &tags, float sampleRate) {
+	MetricState &s = MetricState::getInstance();
+	if (!s._initialized) {
+		return false;
+	}
+	s._aggregator.count(key, delta, tags, sampleRate);
+	s.flushIfNeeded();
 	return true;
 }
 
+bool gauge(const core::String &key, uint32_t value, const TagMap &tags) {
+	MetricState &s = MetricState::getInstance();
+	if (!s._initialized) {
+		return false;
+	}
+	s._aggregator.gauge(key, value, tags);
+	s.flushIfNeeded();
+	return true;
+}
+
+bool timing(const core::String &key, uint32_t millis, const TagMap &tags) {
+	MetricState &s = MetricState::getInstance();
+	if (!s._initialized) {
+		return false;
+	}
+	s._aggregator.timing(key, millis, tags);
+	s.flushIfNeeded();
+	return true;
+}
+
+void flush() {
+	MetricState::getInstance().flush();
+}
+
 bool init(const core::String &appname) {
 	return MetricState::getInstance().init(appname);
 }
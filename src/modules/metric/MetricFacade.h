@@ -8,7 +8,17 @@
 
 namespace metric {
 
-bool count(const core::String &key, int delta = 1, const TagMap &tags = {});
+/**
+ * @brief Records the metrics in the @c MetricAggregator - they are sent in batches every @c metric_flushinterval
+ * seconds and on shutdown.
+ */
+bool count(const core::String &key, int delta = 1, const TagMap &tags = {}, float sampleRate = 1.0f);
+bool gauge(const core::String &key, uint32_t value, const TagMap &tags = {});
+bool timing(const core::String &key, uint32_t millis, const TagMap &tags = {});
+/**
+ * @brief Sends the aggregated metrics now
+ */
+void flush();
 bool init(const core::String &appname);
 void shutdown();
 
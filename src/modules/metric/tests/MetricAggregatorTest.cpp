@@ -0,0 +1,151 @@
+/**
+ * @file
+ */
+
+#include "metric/MetricAggregator.h"
+#include "core/ArrayLength.h"
+#include "core/StringUtil.h"
+#include "core/Var.h"
+#include "core/collection/DynamicArray.h"
+#include "core/tests/TestHelper.h"
+#include "metric/IMetricSender.h"
+#include <future>
+
+namespace metric {
+
+class CollectingSender : public IMetricSender {
+private:
+	mutable core::DynamicArray<core::String> _packets;
+
+public:
+	bool send(const char *buffer) const override {
+		_packets.push_back(buffer);
+		return true;
+	}
+
+	inline const core::DynamicArray<core::String> &packets() const {
+		return _packets;
+	}
+
+	// all packets split into the metric lines - sorted as the aggregation doesn't keep the order
+	core::DynamicArray<core::String> lines() const {
+		core::DynamicArray<core::String> lines;
+		for (const core::String &packet : _packets) {
+			size_t start = 0;
+			for (;;) {
+				const size_t end = packet.find("\n", start);
+				if (end == core::String::npos) {
+					lines.push_back(packet.substr(start));
+					break;
+				}
+				lines.push_back(packet.substr(start, end - start));
+				start = end + 1;
+			}
+		}
+		lines.sort([](const core::String &lhs, const core::String &rhs) { return rhs < lhs; });
+		return lines;
+	}
+};
+
+class MetricAggregatorTest : public testing::Test {
+protected:
+	core::SharedPtr<CollectingSender> sender;
+	Metric metric;
+
+	void SetUp() override {
+		core::Var::get(cfg::MetricUUID, "fake");
+		core::Var::get(cfg::MetricFlavor, "")->setVal("etsy");
+		sender = core::make_shared<CollectingSender>();
+		ASSERT_TRUE(metric.init("test", sender));
+	}
+};
+
+TEST_F(MetricAggregatorTest, testCounterSum) {
+	MetricAggregator aggregator;
+	aggregator.count("a", 1);
+	aggregator.count("a", 2);
+	aggregator.count("b", 1);
+	aggregator.count("a", 1, {{"type", "vox"}});
+	EXPECT_TRUE(sender->packets().empty());
+	ASSERT_TRUE(aggregator.flush(metric));
+	// everything is sent as one batch
+	ASSERT_EQ(1u, sender->packets().size());
+	const core::DynamicArray<core::String> &lines = sender->lines();
+	ASSERT_EQ(3u, lines.size());
+	EXPECT_EQ("test.a:1|c", lines[0]);
+	EXPECT_EQ("test.a:3|c", lines[1]);
+	EXPECT_EQ("test.b:1|c", lines[2]);
+
+	// the aggregation was reset
+	ASSERT_TRUE(aggregator.flush(metric));
+	EXPECT_EQ(1u, sender->packets().size());
+}
+
+TEST_F(MetricAggregatorTest, testGauge) {
+	MetricAggregator aggregator;
+	aggregator.gauge("a", 1);
+	aggregator.gauge("a", 5);
+	ASSERT_TRUE(aggregator.flush(metric));
+	const core::DynamicArray<core::String> &lines = sender->lines();
+	ASSERT_EQ(1u, lines.size());
+	EXPECT_EQ("test.a:5|g", lines[0]);
+}
+
+TEST_F(MetricAggregatorTest, testTimingHistogram) {
+	MetricAggregator aggregator;
+	aggregator.timing("a", 30);
+	aggregator.timing("a", 40);
+	aggregator.timing("a", 3);
+	ASSERT_TRUE(aggregator.flush(metric));
+	const core::DynamicArray<core::String> &lines = sender->lines();
+	ASSERT_EQ(2u, lines.size());
+	// the two values of the same bucket are sent as the mean with the inverse count as sample rate
+	EXPECT_EQ("test.a:35|ms|@0.5", lines[0]);
+	EXPECT_EQ("test.a:3|ms", lines[1]);
+}
+
+TEST_F(MetricAggregatorTest, testSampleRate) {
+	MetricAggregator aggregator;
+	for (int i = 0; i < 1000; ++i) {
+		aggregator.count("a", 1, {}, 0.5f);
+	}
+	aggregator.count("b", 1, {}, 0.0f);
+	ASSERT_TRUE(aggregator.flush(metric));
+	const core::DynamicArray<core::String> &lines = sender->lines();
+	ASSERT_EQ(1u, lines.size());
+	EXPECT_TRUE(core::string::endsWith(lines[0], "|c|@0.5")) << lines[0];
+}
+
+TEST_F(MetricAggregatorTest, testBatchSize) {
+	MetricAggregator aggregator;
+	for (int i = 0; i < 200; ++i) {
+		aggregator.count(core::String::format("key%i", i), 1);
+	}
+	ASSERT_TRUE(aggregator.flush(metric));
+	EXPECT_GT(sender->packets().size(), 1u);
+	for (const core::String &packet : sender->packets()) {
+		EXPECT_LE(packet.size(), Metric::MaxBatchSize);
+	}
+	EXPECT_EQ(200u, sender->lines().size());
+}
+
+TEST_F(MetricAggregatorTest, testThreads) {
+	MetricAggregator aggregator;
+	std::future<void> futures[4];
+	for (int i = 0; i < lengthof(futures); ++i) {
+		futures[i] = std::async(std::launch::async, [&aggregator]() {
+			for (int n = 0; n < 100; ++n) {
+				aggregator.count("a", 1);
+			}
+		});
+	}
+	for (int i = 0; i < lengthof(futures); ++i) {
+		futures[i].wait();
+	}
+	ASSERT_TRUE(aggregator.flush(metric));
+	const core::DynamicArray<core::String> &lines = sender->lines();
+	ASSERT_EQ(1u, lines.size());
+	EXPECT_EQ("test.a:400|c", lines[0]);
+}
+
+} // namespace metric
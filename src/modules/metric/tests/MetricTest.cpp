@@ -47,6 +47,14 @@ protected:
 		return sender->metricLine();
 	}
 
+	inline core::String count(const char *id, int value, Flavor flavor, float sampleRate) const {
+		setFlavor(flavor);
+		Metric m;
+		m.init(PREFIX, sender);
+		m.count(id, value, {}, sampleRate);
+		return sender->metricLine();
+	}
+
 	inline core::String gauge(const char *id, int value, Flavor flavor, const TagMap &tags = {}) const {
 		setFlavor(flavor);
 		Metric m;
@@ -86,6 +94,24 @@ TEST_F(MetricTest, testCounterIncreaseTwo) {
 	EXPECT_EQ(count("test2", 2, Flavor::Etsy), PREFIX ".test2:2|c");
 }
 
+TEST_F(MetricTest, testCounterSampleRate) {
+	EXPECT_EQ(count("test1", 1, Flavor::Etsy, 0.5f), PREFIX ".test1:1|c|@0.5");
+	EXPECT_EQ(count("test1", 1, Flavor::Telegraf, 0.25f), PREFIX ".test1,uuid=fake:1|c|@0.25");
+	EXPECT_EQ(count("test1", 1, Flavor::Etsy, 1.0f), PREFIX ".test1:1|c");
+}
+
+TEST_F(MetricTest, testBatch) {
+	setFlavor(Flavor::Etsy);
+	Metric m;
+	m.init(PREFIX, sender);
+	m.beginBatch();
+	EXPECT_TRUE(m.count("test1", 1));
+	EXPECT_TRUE(m.gauge("test2", 2));
+	EXPECT_EQ("", sender->metricLine());
+	EXPECT_TRUE(m.endBatch());
+	EXPECT_EQ(sender->metricLine(), PREFIX ".test1:1|c\n" PREFIX ".test2:2|g");
+}
+
 TEST_F(MetricTest, testCounterJSON) {
 	EXPECT_EQ(count("test1", 1, Flavor::JSON), R"({"name": "test1","value": 1,"type": "c","uuid": "fake","tags": {}})");
 }
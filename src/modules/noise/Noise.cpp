@@ -7,6 +7,7 @@
 #include "core/Log.h"
 #include "core/Common.h"
 #include "core/collection/Buffer.h"
+#include "core/concurrent/Parallel.h"
 #include <glm/gtc/constants.hpp>
 #include <glm/trigonometric.hpp>
 #ifndef GLM_ENABLE_EXPERIMENTAL
@@ -16,6 +17,7 @@
 #include <glm/gtc/noise.hpp>
 #include <limits>
 #include "Simplex.h"
+#include "SimplexBatch.h"
 
 #define GLM_NOISE 0
 #define CINDER_NOISE 1
@@ -170,4 +172,117 @@ void Noise::seamlessNoise(uint8_t* buffer, int size, int octaves, float persiste
 	}
 }
 
+namespace priv {
+
+static constexpr int RowChunkSize = 256;
+
+/**
+ * @brief Samples the noise for the given points with the batched noise functions - @c z is @c nullptr for the two
+ * dimensional noise
+ */
+static void sample(const float *x, const float *y, const float *z, float *out, int n, const NoiseFieldParams &params) {
+	switch (params.type) {
+	case NoiseType::FBm:
+		if (z == nullptr) {
+			fBmBatch(x, y, out, n, params.octaves, params.lacunarity, params.gain);
+		} else {
+			fBmBatch(x, y, z, out, n, params.octaves, params.lacunarity, params.gain);
+		}
+		break;
+	case NoiseType::RidgedMF:
+		if (z == nullptr) {
+			ridgedMFBatch(x, y, out, n, params.ridgeOffset, params.octaves, params.lacunarity, params.gain);
+		} else {
+			ridgedMFBatch(x, y, z, out, n, params.ridgeOffset, params.octaves, params.lacunarity, params.gain);
+		}
+		break;
+	case NoiseType::Worley:
+		// there is no batched version of the cellular noise
+		if (z == nullptr) {
+			for (int i = 0; i < n; ++i) {
+				out[i] = worleyfBm(glm::vec2(x[i], y[i]), params.octaves, params.lacunarity, params.gain);
+			}
+		} else {
+			for (int i = 0; i < n; ++i) {
+				out[i] = worleyfBm(glm::vec3(x[i], y[i], z[i]), params.octaves, params.lacunarity, params.gain);
+			}
+		}
+		break;
+	case NoiseType::Simplex:
+	default:
+		if (z == nullptr) {
+			noiseBatch(x, y, out, n);
+		} else {
+			noiseBatch(x, y, z, out, n);
+		}
+		break;
+	}
+}
+
+/**
+ * @brief Samples one row of cells along the x axis - the noise type is resolved once per chunk of cells and not per
+ * cell
+ * @param hasZ @c false for two dimensional noise
+ */
+static void fillRow(float *cells, int minX, int width, float y, float z, bool hasZ, const NoiseFieldParams &params) {
+	float xs[RowChunkSize];
+	float ys[RowChunkSize];
+	float zs[RowChunkSize];
+	for (int i = 0; i < RowChunkSize; ++i) {
+		ys[i] = y;
+		zs[i] = z;
+	}
+	for (int start = 0; start < width; start += RowChunkSize) {
+		const int n = core_min(RowChunkSize, width - start);
+		for (int x = 0; x < n; ++x) {
+			xs[x] = (float)(minX + start + x) * params.frequency + params.offset.x;
+		}
+		sample(xs, ys, hasZ ? zs : nullptr, cells + start, n, params);
+	}
+}
+
+} // namespace priv
+
+void Noise::fillVolume(const glm::ivec3 &mins, const glm::ivec3 &dimensions, const NoiseFieldParams &params,
+					   core::DynamicArray<float> &field, core::ThreadPool *threadPool) const {
+	core_trace_scoped(NoiseFillVolume);
+	const glm::ivec3 dim = glm::max(dimensions, glm::ivec3(0));
+	const size_t sliceSize = (size_t)dim.x * dim.y;
+	field.resize(sliceSize * dim.z);
+	if (field.empty()) {
+		return;
+	}
+	const int slices = core::parallelSliceCount(threadPool, dim.z);
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		const int lowerZ = dim.z * slice / slices;
+		const int upperZ = dim.z * (slice + 1) / slices;
+		for (int z = lowerZ; z < upperZ; ++z) {
+			for (int y = 0; y < dim.y; ++y) {
+				const glm::vec3 pos = glm::vec3(mins + glm::ivec3(0, y, z)) * params.frequency + params.offset;
+				priv::fillRow(field.data() + z * sliceSize + (size_t)y * dim.x, mins.x, dim.x, pos.y, pos.z, true, params);
+			}
+		}
+	});
+}
+
+void Noise::fillHeightmap(const glm::ivec2 &mins, const glm::ivec2 &dimensions, const NoiseFieldParams &params,
+						  core::DynamicArray<float> &field, core::ThreadPool *threadPool) const {
+	core_trace_scoped(NoiseFillHeightmap);
+	const glm::ivec2 dim = glm::max(dimensions, glm::ivec2(0));
+	field.resize((size_t)dim.x * dim.y);
+	if (field.empty()) {
+		return;
+	}
+	const glm::vec2 offset(params.offset);
+	const int slices = core::parallelSliceCount(threadPool, dim.y);
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		const int lowerY = dim.y * slice / slices;
+		const int upperY = dim.y * (slice + 1) / slices;
+		for (int y = lowerY; y < upperY; ++y) {
+			const glm::vec2 pos = glm::vec2(mins + glm::ivec2(0, y)) * params.frequency + offset;
+			priv::fillRow(field.data() + (size_t)y * dim.x, mins.x, dim.x, pos.y, 0.0f, false, params);
+		}
+	});
+}
+
 }
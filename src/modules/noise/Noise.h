@@ -5,11 +5,36 @@
 #pragma once
 
 #include "core/IComponent.h"
+#include "core/collection/DynamicArray.h"
 #include <glm/glm.hpp>
 #include <stdint.h>
 
+namespace core {
+class ThreadPool;
+}
+
 namespace noise {
 
+enum class NoiseType { Simplex, FBm, RidgedMF, Worley, Max };
+
+/**
+ * @brief The parameters for filling a whole noise field
+ * @sa Noise::fillVolume()
+ * @sa Noise::fillHeightmap()
+ */
+struct NoiseFieldParams {
+	NoiseType type = NoiseType::Simplex;
+	/** the grid positions are multiplied by this value before they are sampled */
+	float frequency = 1.0f;
+	/** added to the scaled grid positions - allows to move the field without changing its shape */
+	glm::vec3 offset{0.0f};
+	uint8_t octaves = 4;
+	float lacunarity = 2.0f;
+	float gain = 0.5f;
+	/** only used for @c NoiseType::RidgedMF */
+	float ridgeOffset = 1.0f;
+};
+
 /**
  * @brief Normalizes a noise value in the range [-1,-1] to [0,1]
  */
@@ -81,6 +106,29 @@ public:
 	 * @param[in] longitude Given in degrees - must be [-180,180]
 	 */
 	float sphereNoise(float longitude, float latitude);
+
+	/**
+	 * @brief Samples the noise for every cell of the given grid in one go
+	 *
+	 * This is much cheaper than calling the noise function for every voxel from a script - the noise parameters are
+	 * only resolved once and the z slices are computed in parallel if a thread pool is given. The rows are evaluated
+	 * with the vectorized kernels of SimplexBatch.h.
+	 *
+	 * @param[in] mins The grid position of the first cell
+	 * @param[in] dimensions The amount of cells along each axis
+	 * @param[out] field The noise values - the cell @c x, @c y, @c z (relative to @c mins) is at index
+	 * @code x + y * dimensions.x + z * dimensions.x * dimensions.y @endcode
+	 */
+	void fillVolume(const glm::ivec3 &mins, const glm::ivec3 &dimensions, const NoiseFieldParams &params,
+					core::DynamicArray<float> &field, core::ThreadPool *threadPool = nullptr) const;
+
+	/**
+	 * @brief Two dimensional version of @c fillVolume() - e.g. for heightmaps
+	 *
+	 * The cell @c x, @c y (relative to @c mins) is at index @code x + y * dimensions.x @endcode
+	 */
+	void fillHeightmap(const glm::ivec2 &mins, const glm::ivec2 &dimensions, const NoiseFieldParams &params,
+					   core::DynamicArray<float> &field, core::ThreadPool *threadPool = nullptr) const;
 };
 
 }
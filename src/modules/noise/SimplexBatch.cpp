@@ -0,0 +1,224 @@
+/**
+ * @file
+ */
+
+#include "SimplexBatch.h"
+#include "Simplex.h"
+#include "core/Common.h"
+#include <SDL_cpuinfo.h>
+
+namespace noise {
+
+namespace priv {
+
+#ifdef NOISE_SIMD_X86
+// see private/SimplexSSE41.cpp and private/SimplexAVX2.cpp
+int noise2SSE41(const int32_t *perm, const float *x, const float *y, float *out, int n);
+int noise3SSE41(const int32_t *perm, const float *x, const float *y, const float *z, float *out, int n);
+int noise2AVX2(const int32_t *perm, const float *x, const float *y, float *out, int n);
+int noise3AVX2(const int32_t *perm, const float *x, const float *y, const float *z, float *out, int n);
+#endif
+
+static SimdLevel detect() {
+#ifdef NOISE_SIMD_X86
+	if (SDL_HasAVX2()) {
+		return SimdLevel::AVX2;
+	}
+	if (SDL_HasSSE41()) {
+		return SimdLevel::SSE41;
+	}
+#endif
+	return SimdLevel::Scalar;
+}
+
+static const SimdLevel s_detectedSimdLevel = detect();
+static SimdLevel s_simdLevel = s_detectedSimdLevel;
+
+/**
+ * @brief The permutation table of the scalar implementation widened to 32 bit for the vector lookups
+ */
+struct PermTable {
+	int32_t perm[512];
+
+	PermTable() {
+		for (int i = 0; i < 512; ++i) {
+			perm[i] = details::perm[i];
+		}
+	}
+};
+
+/**
+ * @brief The amount of points that are processed at once by the fBm and ridged multifractal functions
+ */
+static constexpr int ChunkSize = 256;
+
+} // namespace priv
+
+SimdLevel detectedSimdLevel() {
+	return priv::s_detectedSimdLevel;
+}
+
+SimdLevel simdLevel() {
+	return priv::s_simdLevel;
+}
+
+void setSimdLevel(SimdLevel level) {
+	priv::s_simdLevel = core_min(level, detectedSimdLevel());
+}
+
+const char *simdLevelName(SimdLevel level) {
+	switch (level) {
+	case SimdLevel::SSE41:
+		return "sse4.1";
+	case SimdLevel::AVX2:
+		return "avx2";
+	case SimdLevel::Scalar:
+	case SimdLevel::Max:
+		break;
+	}
+	return "scalar";
+}
+
+void noiseBatch(const float *x, const float *y, float *out, int n) {
+	int done = 0;
+#ifdef NOISE_SIMD_X86
+	const SimdLevel level = simdLevel();
+	if (level != SimdLevel::Scalar) {
+		const priv::PermTable table;
+		if (level == SimdLevel::AVX2) {
+			done = priv::noise2AVX2(table.perm, x, y, out, n);
+		} else {
+			done = priv::noise2SSE41(table.perm, x, y, out, n);
+		}
+	}
+#endif
+	for (int i = done; i < n; ++i) {
+		out[i] = noise(glm::vec2(x[i], y[i]));
+	}
+}
+
+void noiseBatch(const float *x, const float *y, const float *z, float *out, int n) {
+	int done = 0;
+#ifdef NOISE_SIMD_X86
+	const SimdLevel level = simdLevel();
+	if (level != SimdLevel::Scalar) {
+		const priv::PermTable table;
+		if (level == SimdLevel::AVX2) {
+			done = priv::noise3AVX2(table.perm, x, y, z, out, n);
+		} else {
+			done = priv::noise3SSE41(table.perm, x, y, z, out, n);
+		}
+	}
+#endif
+	for (int i = done; i < n; ++i) {
+		out[i] = noise(glm::vec3(x[i], y[i], z[i]));
+	}
+}
+
+namespace priv {
+
+/**
+ * @brief Evaluates the octaves of the noise chunk by chunk - @c combine is called with the noise of every octave and
+ * must follow the scalar implementation operation by operation
+ */
+template<class Combine>
+static void octaves(const float *x, const float *y, const float *z, float *out, int n, uint8_t octaves,
+					float lacunarity, float gain, Combine &&combine) {
+	float sx[ChunkSize];
+	float sy[ChunkSize];
+	float sz[ChunkSize];
+	float noise[ChunkSize];
+	for (int start = 0; start < n; start += ChunkSize) {
+		const int count = core_min(ChunkSize, n - start);
+		float *chunkOut = out + start;
+		float freq = 1.0f;
+		float amp = 0.5f;
+		for (uint8_t o = 0; o < octaves; ++o) {
+			for (int i = 0; i < count; ++i) {
+				sx[i] = x[start + i] * freq;
+				sy[i] = y[start + i] * freq;
+			}
+			if (z != nullptr) {
+				for (int i = 0; i < count; ++i) {
+					sz[i] = z[start + i] * freq;
+				}
+				noiseBatch(sx, sy, sz, noise, count);
+			} else {
+				noiseBatch(sx, sy, noise, count);
+			}
+			combine(chunkOut, noise, count, o, amp);
+			freq *= lacunarity;
+			amp *= gain;
+		}
+	}
+}
+
+static void fBm(const float *x, const float *y, const float *z, float *out, int n, uint8_t octaves,
+				float lacunarity, float gain) {
+	priv::octaves(x, y, z, out, n, octaves, lacunarity, gain,
+				  [](float *sum, const float *noise, int count, uint8_t octave, float amp) {
+					  if (octave == 0) {
+						  for (int i = 0; i < count; ++i) {
+							  sum[i] = 0.0f;
+						  }
+					  }
+					  for (int i = 0; i < count; ++i) {
+						  sum[i] += noise[i] * amp;
+					  }
+				  });
+	if (octaves == 0) {
+		for (int i = 0; i < n; ++i) {
+			out[i] = 0.0f;
+		}
+	}
+}
+
+static void ridgedMF(const float *x, const float *y, const float *z, float *out, int n, float ridgeOffset,
+					 uint8_t octaves, float lacunarity, float gain) {
+	float prev[ChunkSize];
+	priv::octaves(x, y, z, out, n, octaves, lacunarity, gain,
+				  [&](float *sum, const float *noise, int count, uint8_t octave, float amp) {
+					  if (octave == 0) {
+						  for (int i = 0; i < count; ++i) {
+							  sum[i] = 0.0f;
+							  prev[i] = 1.0f;
+						  }
+					  }
+					  for (int i = 0; i < count; ++i) {
+						  const float r = details::ridge(noise[i], ridgeOffset);
+						  sum[i] += r * amp * prev[i];
+						  prev[i] = r;
+					  }
+				  });
+	if (octaves == 0) {
+		for (int i = 0; i < n; ++i) {
+			out[i] = 0.0f;
+		}
+	}
+	for (int i = 0; i < n; ++i) {
+		out[i] = out[i] * 2.0f - 0.5f;
+	}
+}
+
+} // namespace priv
+
+void fBmBatch(const float *x, const float *y, float *out, int n, uint8_t octaves, float lacunarity, float gain) {
+	priv::fBm(x, y, nullptr, out, n, octaves, lacunarity, gain);
+}
+
+void fBmBatch(const float *x, const float *y, const float *z, float *out, int n, uint8_t octaves, float lacunarity,
+			  float gain) {
+	priv::fBm(x, y, z, out, n, octaves, lacunarity, gain);
+}
+
+void ridgedMFBatch(const float *x, const float *y, float *out, int n, float ridgeOffset, uint8_t octaves,
+				   float lacunarity, float gain) {
+	priv::ridgedMF(x, y, nullptr, out, n, ridgeOffset, octaves, lacunarity, gain);
+}
+
+void ridgedMFBatch(const float *x, const float *y, const float *z, float *out, int n, float ridgeOffset,
+				   uint8_t octaves, float lacunarity, float gain) {
+	priv::ridgedMF(x, y, z, out, n, ridgeOffset, octaves, lacunarity, gain);
+}
+
+} // namespace noise
@@ -0,0 +1,64 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace noise {
+
+/**
+ * @brief The instruction sets the batched noise functions can use
+ */
+enum class SimdLevel : uint8_t { Scalar, SSE41, AVX2, Max };
+
+/**
+ * @return The best instruction set that is supported by the cpu (and the build)
+ */
+SimdLevel detectedSimdLevel();
+
+/**
+ * @return The instruction set the batched noise functions are currently using
+ */
+SimdLevel simdLevel();
+
+/**
+ * @brief Forces the batched noise functions to use the given instruction set - e.g. to compare the implementations in
+ * tests and benchmarks
+ * @note Levels that are not supported by the cpu are clamped to the detected level
+ */
+void setSimdLevel(SimdLevel level);
+
+const char *simdLevelName(SimdLevel level);
+
+/**
+ * @brief 2d simplex noise for @c n points given as separate coordinate arrays
+ *
+ * The results are bitwise identical to calling noise::noise() for each point - no matter which instruction set is
+ * used. Output and input arrays may not overlap.
+ */
+void noiseBatch(const float *x, const float *y, float *out, int n);
+/**
+ * @brief 3d simplex noise for @c n points
+ * @sa noiseBatch()
+ */
+void noiseBatch(const float *x, const float *y, const float *z, float *out, int n);
+
+/**
+ * @brief Batched version of noise::fBm() with bitwise identical results
+ */
+void fBmBatch(const float *x, const float *y, float *out, int n, uint8_t octaves = 4, float lacunarity = 2.0f,
+			  float gain = 0.5f);
+void fBmBatch(const float *x, const float *y, const float *z, float *out, int n, uint8_t octaves = 4,
+			  float lacunarity = 2.0f, float gain = 0.5f);
+
+/**
+ * @brief Batched version of noise::ridgedMF() with bitwise identical results
+ */
+void ridgedMFBatch(const float *x, const float *y, float *out, int n, float ridgeOffset = 1.0f, uint8_t octaves = 4,
+				   float lacunarity = 2.0f, float gain = 0.5f);
+void ridgedMFBatch(const float *x, const float *y, const float *z, float *out, int n, float ridgeOffset = 1.0f,
+				   uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
+
+} // namespace noise
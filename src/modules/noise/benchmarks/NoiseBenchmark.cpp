@@ -0,0 +1,80 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/collection/DynamicArray.h"
+#include "noise/Simplex.h"
+#include "noise/SimplexBatch.h"
+
+class NoiseBenchmark : public app::AbstractBenchmark {
+protected:
+	static constexpr int Points = 4096;
+	core::DynamicArray<float> _x;
+	core::DynamicArray<float> _y;
+	core::DynamicArray<float> _z;
+	core::DynamicArray<float> _out;
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		_x.resize(Points);
+		_y.resize(Points);
+		_z.resize(Points);
+		_out.resize(Points);
+		for (int i = 0; i < Points; ++i) {
+			_x[i] = (float)(i % 64) * 0.05f;
+			_y[i] = (float)(i / 64) * 0.05f;
+			_z[i] = 1.5f;
+		}
+		noise::setSimdLevel((noise::SimdLevel)state.range(0));
+		state.SetLabel(noise::simdLevelName(noise::simdLevel()));
+	}
+
+	void TearDown(::benchmark::State &state) override {
+		noise::setSimdLevel(noise::detectedSimdLevel());
+		app::AbstractBenchmark::TearDown(state);
+	}
+};
+
+BENCHMARK_DEFINE_F(NoiseBenchmark, Noise3Scalar)(benchmark::State &state) {
+	for (auto _ : state) {
+		for (int i = 0; i < Points; ++i) {
+			_out[i] = noise::noise(glm::vec3(_x[i], _y[i], _z[i]));
+		}
+		benchmark::DoNotOptimize(_out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * Points);
+}
+
+BENCHMARK_DEFINE_F(NoiseBenchmark, Noise3Batch)(benchmark::State &state) {
+	for (auto _ : state) {
+		noise::noiseBatch(_x.data(), _y.data(), _z.data(), _out.data(), Points);
+		benchmark::DoNotOptimize(_out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * Points);
+}
+
+BENCHMARK_DEFINE_F(NoiseBenchmark, Noise2Batch)(benchmark::State &state) {
+	for (auto _ : state) {
+		noise::noiseBatch(_x.data(), _y.data(), _out.data(), Points);
+		benchmark::DoNotOptimize(_out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * Points);
+}
+
+BENCHMARK_DEFINE_F(NoiseBenchmark, FBm3Batch)(benchmark::State &state) {
+	for (auto _ : state) {
+		noise::fBmBatch(_x.data(), _y.data(), _z.data(), _out.data(), Points);
+		benchmark::DoNotOptimize(_out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * Points);
+}
+
+// the argument is the noise::SimdLevel - levels that the cpu doesn't support fall back to the detected one
+BENCHMARK_REGISTER_F(NoiseBenchmark, Noise3Scalar)->Arg((int)noise::SimdLevel::Scalar);
+BENCHMARK_REGISTER_F(NoiseBenchmark, Noise3Batch)->DenseRange(0, (int)noise::SimdLevel::Max - 1);
+BENCHMARK_REGISTER_F(NoiseBenchmark, Noise2Batch)->DenseRange(0, (int)noise::SimdLevel::Max - 1);
+BENCHMARK_REGISTER_F(NoiseBenchmark, FBm3Batch)->DenseRange(0, (int)noise::SimdLevel::Max - 1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,130 @@
+/**
+ * @file
+ *
+ * Compiled with AVX2 enabled - only called if the cpu supports it. Don't include anything but the kernels here.
+ */
+
+#ifdef NOISE_SIMD_X86
+
+#include "SimplexKernel.h"
+#include <immintrin.h>
+
+namespace noise {
+namespace priv {
+
+namespace {
+
+struct AVX2 {
+	static constexpr int Width = 8;
+	using Float = __m256;
+	using Int = __m256i;
+
+	static inline Float load(const float *p) {
+		return _mm256_loadu_ps(p);
+	}
+	static inline void store(float *p, Float v) {
+		_mm256_storeu_ps(p, v);
+	}
+	static inline Float set1(float v) {
+		return _mm256_set1_ps(v);
+	}
+	static inline Int set1i(int32_t v) {
+		return _mm256_set1_epi32(v);
+	}
+	static inline Float add(Float a, Float b) {
+		return _mm256_add_ps(a, b);
+	}
+	static inline Float sub(Float a, Float b) {
+		return _mm256_sub_ps(a, b);
+	}
+	static inline Float mul(Float a, Float b) {
+		return _mm256_mul_ps(a, b);
+	}
+	static inline Float xorf(Float a, Float b) {
+		return _mm256_xor_ps(a, b);
+	}
+	static inline Float greater(Float a, Float b) {
+		return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+	}
+	static inline Float greaterEqual(Float a, Float b) {
+		return _mm256_cmp_ps(a, b, _CMP_GE_OQ);
+	}
+	static inline Float less(Float a, Float b) {
+		return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+	}
+	/**
+	 * @return @c a where @c mask is set, @c b otherwise
+	 */
+	static inline Float select(Float mask, Float a, Float b) {
+		return _mm256_blendv_ps(b, a, mask);
+	}
+	/**
+	 * @brief @c (float)((double)a*b) per lane
+	 */
+	static inline Float mulDouble(Float a, double b) {
+		const __m256d factor = _mm256_set1_pd(b);
+		const __m128 lo = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a)), factor));
+		const __m128 hi = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(a, 1)), factor));
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+	}
+	/**
+	 * @brief @c (float)((double)a+b) per lane
+	 */
+	static inline Float addDouble(Float a, double b) {
+		const __m256d summand = _mm256_set1_pd(b);
+		const __m128 lo = _mm256_cvtpd_ps(_mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a)), summand));
+		const __m128 hi = _mm256_cvtpd_ps(_mm256_add_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(a, 1)), summand));
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+	}
+	static inline Int truncate(Float a) {
+		return _mm256_cvttps_epi32(a);
+	}
+	static inline Float toFloat(Int a) {
+		return _mm256_cvtepi32_ps(a);
+	}
+	static inline Int castToInt(Float a) {
+		return _mm256_castps_si256(a);
+	}
+	static inline Float castToFloat(Int a) {
+		return _mm256_castsi256_ps(a);
+	}
+	static inline Int addi(Int a, Int b) {
+		return _mm256_add_epi32(a, b);
+	}
+	static inline Int andi(Int a, Int b) {
+		return _mm256_and_si256(a, b);
+	}
+	static inline Int ori(Int a, Int b) {
+		return _mm256_or_si256(a, b);
+	}
+	/**
+	 * @brief @c ~a&b
+	 */
+	static inline Int andNot(Int a, Int b) {
+		return _mm256_andnot_si256(a, b);
+	}
+	static inline Int equali(Int a, Int b) {
+		return _mm256_cmpeq_epi32(a, b);
+	}
+	static inline Int lessi(Int a, Int b) {
+		return _mm256_cmpgt_epi32(b, a);
+	}
+	static inline Int gather(const int32_t *table, Int idx) {
+		return _mm256_i32gather_epi32(table, idx, 4);
+	}
+};
+
+} // namespace
+
+int noise2AVX2(const int32_t *perm, const float *x, const float *y, float *out, int n) {
+	return noise2Batch<AVX2>(perm, x, y, out, n);
+}
+
+int noise3AVX2(const int32_t *perm, const float *x, const float *y, const float *z, float *out, int n) {
+	return noise3Batch<AVX2>(perm, x, y, z, out, n);
+}
+
+} // namespace priv
+} // namespace noise
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * @file
+ *
+ * Simplex noise kernels that evaluate several points at once. The kernels are templates over the vector type of the
+ * instruction set and are instantiated in translation units that are compiled for that instruction set - so this header
+ * must not include anything that could end up as shared inline code (like glm).
+ *
+ * The kernels follow the scalar implementation in Simplex.h operation by operation to produce bitwise identical
+ * results. This includes the double precision skew factors - the scalar code mixes float and double math there.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace noise {
+namespace priv {
+
+// these must match the values of the scalar implementation in Simplex.h
+static constexpr double SimplexF2 = 0.366025403;
+static constexpr double SimplexG2 = 0.211324865;
+static constexpr double SimplexF3 = 0.333333333;
+static constexpr double SimplexG3 = 0.166666667;
+
+/**
+ * @brief The @c FASTFLOOR macro of the scalar implementation - which is not a real floor for negative integers
+ */
+template<class V>
+inline typename V::Int fastFloor(typename V::Float x) {
+	const typename V::Int truncated = V::truncate(x);
+	// -1 for all lanes that are not greater than zero
+	const typename V::Int minusOne = V::andNot(V::castToInt(V::greater(x, V::set1(0.0f))), V::set1i(-1));
+	return V::addi(truncated, minusOne);
+}
+
+/**
+ * @return The lanes of @c value with the sign flipped where @c mask is set
+ */
+template<class V>
+inline typename V::Float negateIf(typename V::Int mask, typename V::Float value) {
+	const typename V::Float signBit = V::castToFloat(V::andi(mask, V::set1i((int32_t)0x80000000)));
+	return V::xorf(value, signBit);
+}
+
+/**
+ * @return All bits set for the lanes where the given bit of @c h is set
+ */
+template<class V>
+inline typename V::Int bitSet(typename V::Int h, int32_t bit) {
+	return V::equali(V::andi(h, V::set1i(bit)), V::set1i(bit));
+}
+
+template<class V>
+inline typename V::Float grad2(typename V::Int hash, typename V::Float x, typename V::Float y) {
+	const typename V::Int h = V::andi(hash, V::set1i(7));
+	const typename V::Int lower4 = V::lessi(h, V::set1i(4));
+	const typename V::Float u = V::select(V::castToFloat(lower4), x, y);
+	const typename V::Float v = V::select(V::castToFloat(lower4), y, x);
+	const typename V::Float v2 = V::mul(V::set1(2.0f), v);
+	return V::add(negateIf<V>(bitSet<V>(h, 1), u), negateIf<V>(bitSet<V>(h, 2), v2));
+}
+
+template<class V>
+inline typename V::Float grad3(typename V::Int hash, typename V::Float x, typename V::Float y, typename V::Float z) {
+	const typename V::Int h = V::andi(hash, V::set1i(15));
+	const typename V::Float u = V::select(V::castToFloat(V::lessi(h, V::set1i(8))), x, y);
+	const typename V::Int useX = V::ori(V::equali(h, V::set1i(12)), V::equali(h, V::set1i(14)));
+	const typename V::Float xz = V::select(V::castToFloat(useX), x, z);
+	const typename V::Float v = V::select(V::castToFloat(V::lessi(h, V::set1i(4))), y, xz);
+	return V::add(negateIf<V>(bitSet<V>(h, 1), u), negateIf<V>(bitSet<V>(h, 2), v));
+}
+
+/**
+ * @brief The contribution of one simplex corner - @c (t*t)*(t*t)*grad or @c 0 if @c t is negative
+ */
+template<class V>
+inline typename V::Float corner(typename V::Float t, typename V::Float grad) {
+	const typename V::Float t2 = V::mul(t, t);
+	const typename V::Float n = V::mul(V::mul(t2, t2), grad);
+	return V::select(V::less(t, V::set1(0.0f)), V::set1(0.0f), n);
+}
+
+/**
+ * @return @c 1 for the lanes where @c mask is set and @c 0 for all others
+ */
+template<class V>
+inline typename V::Int one(typename V::Int mask) {
+	return V::andi(mask, V::set1i(1));
+}
+
+/**
+ * @brief 2d simplex noise for @c V::Width points
+ * @param perm The permutation table of the scalar implementation widened to 32 bit
+ */
+template<class V>
+inline void noise2(const int32_t *perm, const float *px, const float *py, float *out) {
+	using F = typename V::Float;
+	using I = typename V::Int;
+	const F vx = V::load(px);
+	const F vy = V::load(py);
+
+	const F s = V::mulDouble(V::add(vx, vy), SimplexF2);
+	const I i = fastFloor<V>(V::add(vx, s));
+	const I j = fastFloor<V>(V::add(vy, s));
+
+	const F t = V::mulDouble(V::toFloat(V::addi(i, j)), SimplexG2);
+	const F x0 = V::sub(vx, V::sub(V::toFloat(i), t));
+	const F y0 = V::sub(vy, V::sub(V::toFloat(j), t));
+
+	const I lower = V::castToInt(V::greater(x0, y0));
+	const I i1 = one<V>(lower);
+	const I j1 = one<V>(V::andNot(lower, V::set1i(-1)));
+
+	const F x1 = V::addDouble(V::sub(x0, V::toFloat(i1)), SimplexG2);
+	const F y1 = V::addDouble(V::sub(y0, V::toFloat(j1)), SimplexG2);
+	const F x2 = V::addDouble(V::sub(x0, V::set1(1.0f)), 2.0f * SimplexG2);
+	const F y2 = V::addDouble(V::sub(y0, V::set1(1.0f)), 2.0f * SimplexG2);
+
+	const I ii = V::andi(i, V::set1i(0xff));
+	const I jj = V::andi(j, V::set1i(0xff));
+	const I one1 = V::set1i(1);
+
+	const I gi0 = V::gather(perm, V::addi(ii, V::gather(perm, jj)));
+	const I gi1 = V::gather(perm, V::addi(V::addi(ii, i1), V::gather(perm, V::addi(jj, j1))));
+	const I gi2 = V::gather(perm, V::addi(V::addi(ii, one1), V::gather(perm, V::addi(jj, one1))));
+
+	const F half = V::set1(0.5f);
+	const F t0 = V::sub(V::sub(half, V::mul(x0, x0)), V::mul(y0, y0));
+	const F t1 = V::sub(V::sub(half, V::mul(x1, x1)), V::mul(y1, y1));
+	const F t2 = V::sub(V::sub(half, V::mul(x2, x2)), V::mul(y2, y2));
+	const F n0 = corner<V>(t0, grad2<V>(gi0, x0, y0));
+	const F n1 = corner<V>(t1, grad2<V>(gi1, x1, y1));
+	const F n2 = corner<V>(t2, grad2<V>(gi2, x2, y2));
+
+	V::store(out, V::mul(V::set1(40.0f), V::add(V::add(n0, n1), n2)));
+}
+
+/**
+ * @brief 3d simplex noise for @c V::Width points
+ * @param perm The permutation table of the scalar implementation widened to 32 bit
+ */
+template<class V>
+inline void noise3(const int32_t *perm, const float *px, const float *py, const float *pz, float *out) {
+	using F = typename V::Float;
+	using I = typename V::Int;
+	const F vx = V::load(px);
+	const F vy = V::load(py);
+	const F vz = V::load(pz);
+
+	const F s = V::mulDouble(V::add(V::add(vx, vy), vz), SimplexF3);
+	const I i = fastFloor<V>(V::add(vx, s));
+	const I j = fastFloor<V>(V::add(vy, s));
+	const I k = fastFloor<V>(V::add(vz, s));
+
+	const F t = V::mulDouble(V::toFloat(V::addi(V::addi(i, j), k)), SimplexG3);
+	const F x0 = V::sub(vx, V::sub(V::toFloat(i), t));
+	const F y0 = V::sub(vy, V::sub(V::toFloat(j), t));
+	const F z0 = V::sub(vz, V::sub(V::toFloat(k), t));
+
+	// the branches of the scalar implementation to find the simplex as masks
+	const I allSet = V::set1i(-1);
+	const I xy = V::castToInt(V::greaterEqual(x0, y0));
+	const I yz = V::castToInt(V::greaterEqual(y0, z0));
+	const I xz = V::castToInt(V::greaterEqual(x0, z0));
+	const I notXy = V::andNot(xy, allSet);
+	const I notYz = V::andNot(yz, allSet);
+	const I xyAndXz = V::andi(xy, xz);
+	const I yzAndXz = V::andi(yz, xz);
+	const I i1 = one<V>(xyAndXz);
+	const I j1 = one<V>(V::andi(notXy, yz));
+	const I k1 = one<V>(V::andNot(xyAndXz, notYz));
+	const I i2 = one<V>(V::ori(xy, yzAndXz));
+	const I j2 = one<V>(V::ori(notXy, yz));
+	const I k2 = one<V>(V::ori(V::andi(xy, notYz), V::andNot(yzAndXz, notXy)));
+
+	const F x1 = V::addDouble(V::sub(x0, V::toFloat(i1)), SimplexG3);
+	const F y1 = V::addDouble(V::sub(y0, V::toFloat(j1)), SimplexG3);
+	const F z1 = V::addDouble(V::sub(z0, V::toFloat(k1)), SimplexG3);
+	const F x2 = V::addDouble(V::sub(x0, V::toFloat(i2)), 2.0f * SimplexG3);
+	const F y2 = V::addDouble(V::sub(y0, V::toFloat(j2)), 2.0f * SimplexG3);
+	const F z2 = V::addDouble(V::sub(z0, V::toFloat(k2)), 2.0f * SimplexG3);
+	const F one1f = V::set1(1.0f);
+	const F x3 = V::addDouble(V::sub(x0, one1f), 3.0f * SimplexG3);
+	const F y3 = V::addDouble(V::sub(y0, one1f), 3.0f * SimplexG3);
+	const F z3 = V::addDouble(V::sub(z0, one1f), 3.0f * SimplexG3);
+
+	const I ii = V::andi(i, V::set1i(0xff));
+	const I jj = V::andi(j, V::set1i(0xff));
+	const I kk = V::andi(k, V::set1i(0xff));
+	const I one1 = V::set1i(1);
+
+	const I gi0 = V::gather(perm, V::addi(ii, V::gather(perm, V::addi(jj, V::gather(perm, kk)))));
+	const I gi1 = V::gather(perm, V::addi(V::addi(ii, i1),
+		V::gather(perm, V::addi(V::addi(jj, j1), V::gather(perm, V::addi(kk, k1))))));
+	const I gi2 = V::gather(perm, V::addi(V::addi(ii, i2),
+		V::gather(perm, V::addi(V::addi(jj, j2), V::gather(perm, V::addi(kk, k2))))));
+	const I gi3 = V::gather(perm, V::addi(V::addi(ii, one1),
+		V::gather(perm, V::addi(V::addi(jj, one1), V::gather(perm, V::addi(kk, one1))))));
+
+	const F limit = V::set1(0.6f);
+	const F t0 = V::sub(V::sub(V::sub(limit, V::mul(x0, x0)), V::mul(y0, y0)), V::mul(z0, z0));
+	const F t1 = V::sub(V::sub(V::sub(limit, V::mul(x1, x1)), V::mul(y1, y1)), V::mul(z1, z1));
+	const F t2 = V::sub(V::sub(V::sub(limit, V::mul(x2, x2)), V::mul(y2, y2)), V::mul(z2, z2));
+	const F t3 = V::sub(V::sub(V::sub(limit, V::mul(x3, x3)), V::mul(y3, y3)), V::mul(z3, z3));
+	const F n0 = corner<V>(t0, grad3<V>(gi0, x0, y0, z0));
+	const F n1 = corner<V>(t1, grad3<V>(gi1, x1, y1, z1));
+	const F n2 = corner<V>(t2, grad3<V>(gi2, x2, y2, z2));
+	const F n3 = corner<V>(t3, grad3<V>(gi3, x3, y3, z3));
+
+	V::store(out, V::mul(V::set1(32.0f), V::add(V::add(V::add(n0, n1), n2), n3)));
+}
+
+/**
+ * @brief Evaluates the noise for all full vectors of the given points
+ * @return The amount of points that were evaluated - the remaining points are left for the scalar implementation
+ */
+template<class V>
+int noise2Batch(const int32_t *perm, const float *x, const float *y, float *out, int n) {
+	int i = 0;
+	for (; i + V::Width <= n; i += V::Width) {
+		noise2<V>(perm, x + i, y + i, out + i);
+	}
+	return i;
+}
+
+template<class V>
+int noise3Batch(const int32_t *perm, const float *x, const float *y, const float *z, float *out, int n) {
+	int i = 0;
+	for (; i + V::Width <= n; i += V::Width) {
+		noise3<V>(perm, x + i, y + i, z + i, out + i);
+	}
+	return i;
+}
+
+} // namespace priv
+} // namespace noise
@@ -0,0 +1,131 @@
+/**
+ * @file
+ *
+ * Compiled with SSE4.1 enabled - only called if the cpu supports it. Don't include anything but the kernels here.
+ */
+
+#ifdef NOISE_SIMD_X86
+
+#include "SimplexKernel.h"
+#include <smmintrin.h>
+
+namespace noise {
+namespace priv {
+
+namespace {
+
+struct SSE41 {
+	static constexpr int Width = 4;
+	using Float = __m128;
+	using Int = __m128i;
+
+	static inline Float load(const float *p) {
+		return _mm_loadu_ps(p);
+	}
+	static inline void store(float *p, Float v) {
+		_mm_storeu_ps(p, v);
+	}
+	static inline Float set1(float v) {
+		return _mm_set1_ps(v);
+	}
+	static inline Int set1i(int32_t v) {
+		return _mm_set1_epi32(v);
+	}
+	static inline Float add(Float a, Float b) {
+		return _mm_add_ps(a, b);
+	}
+	static inline Float sub(Float a, Float b) {
+		return _mm_sub_ps(a, b);
+	}
+	static inline Float mul(Float a, Float b) {
+		return _mm_mul_ps(a, b);
+	}
+	static inline Float xorf(Float a, Float b) {
+		return _mm_xor_ps(a, b);
+	}
+	static inline Float greater(Float a, Float b) {
+		return _mm_cmpgt_ps(a, b);
+	}
+	static inline Float greaterEqual(Float a, Float b) {
+		return _mm_cmpge_ps(a, b);
+	}
+	static inline Float less(Float a, Float b) {
+		return _mm_cmplt_ps(a, b);
+	}
+	/**
+	 * @return @c a where @c mask is set, @c b otherwise
+	 */
+	static inline Float select(Float mask, Float a, Float b) {
+		return _mm_blendv_ps(b, a, mask);
+	}
+	/**
+	 * @brief @c (float)((double)a*b) per lane
+	 */
+	static inline Float mulDouble(Float a, double b) {
+		const __m128d factor = _mm_set1_pd(b);
+		const __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(a), factor));
+		const __m128 hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(a, a)), factor));
+		return _mm_movelh_ps(lo, hi);
+	}
+	/**
+	 * @brief @c (float)((double)a+b) per lane
+	 */
+	static inline Float addDouble(Float a, double b) {
+		const __m128d summand = _mm_set1_pd(b);
+		const __m128 lo = _mm_cvtpd_ps(_mm_add_pd(_mm_cvtps_pd(a), summand));
+		const __m128 hi = _mm_cvtpd_ps(_mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(a, a)), summand));
+		return _mm_movelh_ps(lo, hi);
+	}
+	static inline Int truncate(Float a) {
+		return _mm_cvttps_epi32(a);
+	}
+	static inline Float toFloat(Int a) {
+		return _mm_cvtepi32_ps(a);
+	}
+	static inline Int castToInt(Float a) {
+		return _mm_castps_si128(a);
+	}
+	static inline Float castToFloat(Int a) {
+		return _mm_castsi128_ps(a);
+	}
+	static inline Int addi(Int a, Int b) {
+		return _mm_add_epi32(a, b);
+	}
+	static inline Int andi(Int a, Int b) {
+		return _mm_and_si128(a, b);
+	}
+	static inline Int ori(Int a, Int b) {
+		return _mm_or_si128(a, b);
+	}
+	/**
+	 * @brief @c ~a&b
+	 */
+	static inline Int andNot(Int a, Int b) {
+		return _mm_andnot_si128(a, b);
+	}
+	static inline Int equali(Int a, Int b) {
+		return _mm_cmpeq_epi32(a, b);
+	}
+	static inline Int lessi(Int a, Int b) {
+		return _mm_cmplt_epi32(a, b);
+	}
+	static inline Int gather(const int32_t *table, Int idx) {
+		return _mm_setr_epi32(table[_mm_extract_epi32(idx, 0)], table[_mm_extract_epi32(idx, 1)],
+							  table[_mm_extract_epi32(idx, 2)], table[_mm_extract_epi32(idx, 3)]);
+	}
+};
+
+} // namespace
+
+int noise2SSE41(const int32_t *perm, const float *x, const float *y, float *out, int n) {
+	return noise2Batch<SSE41>(perm, x, y, out, n);
+}
+
+int noise3SSE41(const int32_t *perm, const float *x, const float *y, const float *z, float *out, int n) {
+	return noise3Batch<SSE41>(perm, x, y, z, out, n);
+}
+
+} // namespace priv
+} // namespace noise
+
+#endif
@@ -5,9 +5,12 @@
 #include "app/tests/AbstractTest.h"
 #include "io/FileStream.h"
 #include "noise/Noise.h"
+#include "noise/Simplex.h"
+#include "noise/SimplexBatch.h"
 #include "image/Image.h"
 #include "core/GLM.h"
 #include "core/StringUtil.h"
+#include "core/concurrent/ThreadPool.h"
 
 namespace noise {
 
@@ -44,4 +47,107 @@ TEST_F(NoiseTest, testSeamlessNoise) {
 	seamlessNoise();
 }
 
+TEST_F(NoiseTest, testFillVolume) {
+	noise::Noise noise;
+	NoiseFieldParams params;
+	params.type = NoiseType::FBm;
+	params.frequency = 0.1f;
+	params.offset = glm::vec3(0.5f, 1.5f, 2.5f);
+	const glm::ivec3 mins(-3, 2, 5);
+	const glm::ivec3 dim(7, 5, 9);
+	core::ThreadPool threadPool(4, "NoiseField");
+	threadPool.init();
+	core::DynamicArray<float> field;
+	noise.fillVolume(mins, dim, params, field, &threadPool);
+	ASSERT_EQ((size_t)(dim.x * dim.y * dim.z), field.size());
+	for (int z = 0; z < dim.z; ++z) {
+		for (int y = 0; y < dim.y; ++y) {
+			for (int x = 0; x < dim.x; ++x) {
+				const glm::vec3 pos = glm::vec3(mins + glm::ivec3(x, y, z)) * params.frequency + params.offset;
+				const float expected = fBm(pos, params.octaves, params.lacunarity, params.gain);
+				ASSERT_FLOAT_EQ(expected, field[x + y * dim.x + z * dim.x * dim.y]) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
+TEST_F(NoiseTest, testFillHeightmap) {
+	noise::Noise noise;
+	NoiseFieldParams params;
+	params.type = NoiseType::RidgedMF;
+	params.frequency = 0.05f;
+	const glm::ivec2 mins(10, -4);
+	const glm::ivec2 dim(16, 11);
+	core::DynamicArray<float> field;
+	noise.fillHeightmap(mins, dim, params, field);
+	ASSERT_EQ((size_t)(dim.x * dim.y), field.size());
+	for (int y = 0; y < dim.y; ++y) {
+		for (int x = 0; x < dim.x; ++x) {
+			const glm::vec2 pos = glm::vec2(mins + glm::ivec2(x, y)) * params.frequency;
+			const float expected =
+				ridgedMF(pos, params.ridgeOffset, params.octaves, params.lacunarity, params.gain);
+			ASSERT_FLOAT_EQ(expected, field[x + y * dim.x]) << x << ":" << y;
+		}
+	}
+}
+
+TEST_F(NoiseTest, testFillHeightmapWorley) {
+	noise::Noise noise;
+	NoiseFieldParams params;
+	params.type = NoiseType::Worley;
+	params.frequency = 0.2f;
+	params.octaves = 2;
+	const glm::ivec2 mins(-5, 3);
+	const glm::ivec2 dim(9, 4);
+	core::DynamicArray<float> field;
+	noise.fillHeightmap(mins, dim, params, field);
+	ASSERT_EQ((size_t)(dim.x * dim.y), field.size());
+	for (int y = 0; y < dim.y; ++y) {
+		for (int x = 0; x < dim.x; ++x) {
+			const glm::vec2 pos = glm::vec2(mins + glm::ivec2(x, y)) * params.frequency;
+			const float expected = worleyfBm(pos, params.octaves, params.lacunarity, params.gain);
+			ASSERT_FLOAT_EQ(expected, field[x + y * dim.x]) << x << ":" << y;
+		}
+	}
+}
+
+TEST_F(NoiseTest, testSimplexBatch) {
+	// odd amount of points to also cover the scalar remainder - negative integers and zero hit the edge cases of the
+	// floor of the scalar implementation
+	const int n = 1029;
+	core::DynamicArray<float> x, y, z, out;
+	x.resize(n);
+	y.resize(n);
+	z.resize(n);
+	out.resize(n);
+	for (int i = 0; i < n; ++i) {
+		x[i] = (float)(i % 37) * 0.731f - 13.0f;
+		y[i] = (i % 5 == 0) ? 0.0f : (float)(i % 23) * -1.37f + 7.5f;
+		z[i] = (i % 7 == 0) ? -(float)(i % 4) : (float)i * 0.113f - 50.0f;
+	}
+	const SimdLevel detected = detectedSimdLevel();
+	for (int l = 0; l <= (int)detected; ++l) {
+		setSimdLevel((SimdLevel)l);
+		ASSERT_EQ((SimdLevel)l, simdLevel());
+		noiseBatch(x.data(), y.data(), z.data(), out.data(), n);
+		for (int i = 0; i < n; ++i) {
+			// bitwise identical
+			ASSERT_EQ(noise::noise(glm::vec3(x[i], y[i], z[i])), out[i]) << simdLevelName(simdLevel()) << ": " << i;
+		}
+		noiseBatch(x.data(), y.data(), out.data(), n);
+		for (int i = 0; i < n; ++i) {
+			ASSERT_EQ(noise::noise(glm::vec2(x[i], y[i])), out[i]) << simdLevelName(simdLevel()) << ": " << i;
+		}
+		fBmBatch(x.data(), y.data(), z.data(), out.data(), n, 5, 2.1f, 0.45f);
+		for (int i = 0; i < n; ++i) {
+			ASSERT_EQ(fBm(glm::vec3(x[i], y[i], z[i]), 5, 2.1f, 0.45f), out[i]) << simdLevelName(simdLevel()) << ": " << i;
+		}
+		ridgedMFBatch(x.data(), y.data(), out.data(), n, 0.9f, 3);
+		for (int i = 0; i < n; ++i) {
+			ASSERT_EQ(ridgedMF(glm::vec2(x[i], y[i]), 0.9f, 3), out[i]) << simdLevelName(simdLevel()) << ": " << i;
+		}
+	}
+	setSimdLevel(detected);
+}
+
 }
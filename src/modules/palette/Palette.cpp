@@ -26,6 +26,7 @@
 #include "math/Math.h"
 #include "palette/private/GimpPalette.h"
 #include "private/PaletteFormat.h"
+#include "private/PaletteSearch.h"
 #include "core/Endian.h"
 
 #include <float.h>
@@ -86,7 +87,8 @@ void Palette::reduce(uint8_t targetColors) {
 		core::Color::toColorReductionType(core::Var::getSafe(cfg::CoreColorReduction)->strVal().c_str());
 	PaletteColorArray oldcolors;
 	core_memcpy(oldcolors, _colors, sizeof(PaletteColorArray));
-	_colorCount = core::Color::quantize(_colors, targetColors, oldcolors, _colorCount, reductionType);
+	_colorCount = core::Color::quantize(_colors, targetColors, oldcolors, _colorCount, reductionType,
+										 &app::App::getInstance()->threadPool());
 	markDirty();
 }
 
@@ -94,7 +96,8 @@ void Palette::quantize(const core::RGBA *inputColors, const size_t inputColorCou
 	Log::debug("quantize %i colors", (int)inputColorCount);
 	core::Color::ColorReductionType reductionType =
 		core::Color::toColorReductionType(core::Var::getSafe(cfg::CoreColorReduction)->strVal().c_str());
-	_colorCount = core::Color::quantize(_colors, lengthof(_colors), inputColors, inputColorCount, reductionType);
+	_colorCount = core::Color::quantize(_colors, lengthof(_colors), inputColors, inputColorCount, reductionType,
+										 &app::App::getInstance()->threadPool());
 	markDirty();
 }
 
@@ -330,16 +333,15 @@ int Palette::getClosestMatch(core::RGBA rgba, int skipPaletteColorIdx) const {
 	if (size() == 0) {
 		return PaletteColorNotFound;
 	}
-	for (int i = 0; i < _colorCount; ++i) {
-		if (i == skipPaletteColorIdx) {
-			continue;
-		}
-		if (_colors[i] == rgba) {
-			return i;
-		}
-	}
-
 	if (rgba.a == 0) {
+		for (int i = 0; i < _colorCount; ++i) {
+			if (i == skipPaletteColorIdx) {
+				continue;
+			}
+			if (_colors[i] == rgba) {
+				return i;
+			}
+		}
 		for (int i = 0; i < _colorCount; ++i) {
 			if (_colors[i].a == 0) {
 				return i;
@@ -347,24 +349,7 @@ int Palette::getClosestMatch(core::RGBA rgba, int skipPaletteColorIdx) const {
 		}
 		return PaletteColorNotFound;
 	}
-
-	float minDistance = FLT_MAX;
-	int minIndex = PaletteColorNotFound;
-
-	for (int i = 0; i < _colorCount; ++i) {
-		if (i == skipPaletteColorIdx) {
-			continue;
-		}
-		if (_colors[i].a == 0) {
-			continue;
-		}
-		const float val = core::Color::getDistance(_colors[i], rgba, core::Color::Distance::Approximation);
-		if (val < minDistance) {
-			minDistance = val;
-			minIndex = (int)i;
-		}
-	}
-	return minIndex;
+	return priv::closestMatch(_colors, _colorCount, rgba, skipPaletteColorIdx);
 }
 
 uint8_t Palette::findReplacement(uint8_t paletteColorIdx) const {
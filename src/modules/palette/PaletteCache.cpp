@@ -3,24 +3,39 @@
  */
 
 #include "PaletteCache.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/Filesystem.h"
 #include "palette/Palette.h"
 
 namespace palette {
 
 void PaletteCache::clear() {
+	if (_pendingPalettes.valid()) {
+		_pendingPalettes.wait();
+		_pendingPalettes = {};
+	}
 	_availablePalettes.clear();
 }
 
-void PaletteCache::detectPalettes(bool includeBuiltIn) {
+core::DynamicArray<core::String> PaletteCache::searchPalettes(const io::FilesystemPtr &filesystem) {
+	core::DynamicArray<core::String> palettes;
 	core::DynamicArray<io::FilesystemEntry> entities;
-	_filesystem->list("", entities, "palette-*.png");
+	filesystem->list("", entities, "palette-*.png");
 	for (const io::FilesystemEntry &file : entities) {
 		if (file.type != io::FilesystemEntry::Type::file) {
 			continue;
 		}
-		const core::String &name = Palette::extractPaletteName(file.name);
-		_availablePalettes.push_back(name);
+		palettes.push_back(Palette::extractPaletteName(file.name));
+	}
+	return palettes;
+}
+
+void PaletteCache::detectPalettes(bool includeBuiltIn, core::ThreadPool *threadPool) {
+	if (threadPool != nullptr && !_pendingPalettes.valid()) {
+		_pendingPalettes = threadPool->enqueue(searchPalettes, _filesystem);
+	}
+	if (!_pendingPalettes.valid()) {
+		_availablePalettes.append(searchPalettes(_filesystem));
 	}
 
 	if (includeBuiltIn) {
@@ -28,6 +43,7 @@ void PaletteCache::detectPalettes(bool includeBuiltIn) {
 			_availablePalettes.push_back(palette::Palette::builtIn[i]);
 		}
 	}
+	onDetectPalettes();
 }
 
 void PaletteCache::add(const core::String &paletteName) {
@@ -35,6 +51,11 @@ void PaletteCache::add(const core::String &paletteName) {
 }
 
 const core::DynamicArray<core::String> &PaletteCache::availablePalettes() const {
+	if (_pendingPalettes.valid()) {
+		// the palette files are listed before the built-in palettes
+		const core::DynamicArray<core::String> &palettes = _pendingPalettes.get();
+		_availablePalettes.insert(_availablePalettes.begin(), palettes.begin(), palettes.end());
+	}
 	return _availablePalettes;
 }
 
@@ -7,12 +7,17 @@
 #include "core/SharedPtr.h"
 #include "core/String.h"
 #include "core/collection/DynamicArray.h"
+#include <future>
 
 namespace io {
 class Filesystem;
 using FilesystemPtr = core::SharedPtr<Filesystem>;
 } // namespace io
 
+namespace core {
+class ThreadPool;
+}
+
 namespace palette {
 
 /**
@@ -21,7 +26,18 @@ namespace palette {
 class PaletteCache {
 private:
 	io::FilesystemPtr _filesystem;
-	core::DynamicArray<core::String> _availablePalettes;
+	mutable core::DynamicArray<core::String> _availablePalettes;
+	// the palette files that are searched in the background
+	mutable std::future<core::DynamicArray<core::String>> _pendingPalettes;
+
+	static core::DynamicArray<core::String> searchPalettes(const io::FilesystemPtr &filesystem);
+
+protected:
+	/**
+	 * @brief Called on the calling thread of @c detectPalettes() to add further palettes
+	 */
+	virtual void onDetectPalettes() {
+	}
 
 public:
 	PaletteCache(const io::FilesystemPtr &filesystem) : _filesystem(filesystem) {
@@ -30,7 +46,11 @@ public:
 	}
 
 	void clear();
-	virtual void detectPalettes(bool includeBuiltIn = true);
+	/**
+	 * @param threadPool If given, the palette files are searched in the background - they are added once
+	 * @c availablePalettes() is called the next time. This keeps the file system scan out of the application startup.
+	 */
+	void detectPalettes(bool includeBuiltIn = true, core::ThreadPool *threadPool = nullptr);
 	void add(const core::String &paletteName);
 	const core::DynamicArray<core::String> &availablePalettes() const;
 };
@@ -0,0 +1,192 @@
+/**
+ * @file
+ */
+
+#include "PaletteColorCube.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/Parallel.h"
+
+namespace palette {
+
+namespace priv {
+
+static constexpr int MaxCachedCubes = 4;
+static core::DynamicArray<PaletteColorCubePtr> s_cubes;
+core_trace_mutex(core::Lock, s_cubesLock, "PaletteColorCube");
+
+/**
+ * @brief The squared distance range of one channel of a palette color to the channel range of a cell
+ */
+static inline void channelRange(int value, int lower, int upper, int &minSq, int &maxSq) {
+	const int dl = value - lower;
+	const int du = upper - value;
+	const int minDelta = value < lower ? -dl : (value > upper ? -du : 0);
+	const int maxDelta = core_max(dl, du);
+	minSq = minDelta * minDelta;
+	maxSq = maxDelta * maxDelta;
+}
+
+} // namespace priv
+
+PaletteColorCube::PaletteColorCube(const Palette &palette, core::ThreadPool *threadPool) {
+	core_trace_scoped(PaletteColorCube);
+	_colorCount = palette.colorCount();
+	for (int i = 0; i < _colorCount; ++i) {
+		_colors[i] = palette.color(i);
+	}
+	uint8_t opaque[PaletteMaxColors];
+	int opaqueCount = 0;
+	for (int i = 0; i < _colorCount; ++i) {
+		if (_colors[i].a != 0) {
+			opaque[opaqueCount++] = (uint8_t)i;
+		}
+	}
+
+	// every slice handles one red layer of cells - the candidates are concatenated afterwards
+	core::DynamicArray<core::DynamicArray<uint8_t>> layerCandidates;
+	core::DynamicArray<core::DynamicArray<uint32_t>> layerCounts;
+	layerCandidates.resize(CubeSize);
+	layerCounts.resize(CubeSize);
+	core::parallelSlices(threadPool, CubeSize, [&](int cellR) {
+		core::DynamicArray<uint8_t> &candidates = layerCandidates[cellR];
+		core::DynamicArray<uint32_t> &counts = layerCounts[cellR];
+		counts.resize(CubeSize * CubeSize);
+		int lowerBounds[PaletteMaxColors];
+		const int rl = cellR << CellShift;
+		const int ru = rl + (1 << CellShift) - 1;
+		for (int cellG = 0; cellG < CubeSize; ++cellG) {
+			const int gl = cellG << CellShift;
+			const int gu = gl + (1 << CellShift) - 1;
+			for (int cellB = 0; cellB < CubeSize; ++cellB) {
+				const int bl = cellB << CellShift;
+				const int bu = bl + (1 << CellShift) - 1;
+				// see core::Color::getDistance() with core::Color::Distance::Approximation
+				int minUpperBound = INT32_MAX;
+				for (int i = 0; i < opaqueCount; ++i) {
+					const core::RGBA c = _colors[opaque[i]];
+					int minR, maxR, minG, maxG, minB, maxB;
+					priv::channelRange(c.r, rl, ru, minR, maxR);
+					priv::channelRange(c.g, gl, gu, minG, maxG);
+					priv::channelRange(c.b, bl, bu, minB, maxB);
+					const int minMean = (c.r + rl) / 2;
+					const int maxMean = (c.r + ru) / 2;
+					lowerBounds[i] = (((512 + minMean) * minR) >> 8) + 4 * minG + (((767 - maxMean) * minB) >> 8);
+					const int upperBound = (((512 + maxMean) * maxR) >> 8) + 4 * maxG + (((767 - minMean) * maxB) >> 8);
+					minUpperBound = core_min(minUpperBound, upperBound);
+				}
+				uint32_t count = 0u;
+				for (int i = 0; i < opaqueCount; ++i) {
+					if (lowerBounds[i] <= minUpperBound) {
+						candidates.push_back(opaque[i]);
+						++count;
+					}
+				}
+				counts[cellG * CubeSize + cellB] = count;
+			}
+		}
+	});
+
+	size_t total = 0u;
+	for (const core::DynamicArray<uint8_t> &candidates : layerCandidates) {
+		total += candidates.size();
+	}
+	_candidates.reserve(total);
+	_cellOffsets.resize(CubeSize * CubeSize * CubeSize + 1);
+	uint32_t offset = 0u;
+	int cell = 0;
+	for (int cellR = 0; cellR < CubeSize; ++cellR) {
+		_candidates.append(layerCandidates[cellR]);
+		for (uint32_t count : layerCounts[cellR]) {
+			_cellOffsets[cell++] = offset;
+			offset += count;
+		}
+	}
+	_cellOffsets[cell] = offset;
+}
+
+PaletteColorCubePtr PaletteColorCube::get(const Palette &palette, core::ThreadPool *threadPool) {
+	{
+		core::ScopedLock lock(priv::s_cubesLock);
+		for (const PaletteColorCubePtr &cube : priv::s_cubes) {
+			if (cube->matches(palette)) {
+				return cube;
+			}
+		}
+	}
+	// built without holding the lock - in the rare case of two threads building the same cube both are valid
+	PaletteColorCubePtr cube = core::make_shared<PaletteColorCube>(palette, threadPool);
+	core::ScopedLock lock(priv::s_cubesLock);
+	if ((int)priv::s_cubes.size() >= priv::MaxCachedCubes) {
+		priv::s_cubes.erase(0);
+	}
+	priv::s_cubes.push_back(cube);
+	return cube;
+}
+
+void PaletteColorCube::clearCache() {
+	core::ScopedLock lock(priv::s_cubesLock);
+	priv::s_cubes.clear();
+}
+
+bool PaletteColorCube::matches(const Palette &palette) const {
+	if (palette.colorCount() != _colorCount) {
+		return false;
+	}
+	for (int i = 0; i < _colorCount; ++i) {
+		if (palette.color(i) != _colors[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int PaletteColorCube::getClosestMatch(core::RGBA rgba) const {
+	if (rgba.a == 0) {
+		// transparent colors are not part of the cube
+		for (int i = 0; i < _colorCount; ++i) {
+			if (_colors[i] == rgba) {
+				return i;
+			}
+		}
+		for (int i = 0; i < _colorCount; ++i) {
+			if (_colors[i].a == 0) {
+				return i;
+			}
+		}
+		return PaletteColorNotFound;
+	}
+	const int cell = cellIndex(rgba.r >> CellShift, rgba.g >> CellShift, rgba.b >> CellShift);
+	const uint32_t begin = _cellOffsets[cell];
+	const uint32_t end = _cellOffsets[cell + 1];
+	if (end - begin == 1u) {
+		return _candidates[begin];
+	}
+	// an exact match is always a candidate - and the closest colors are, too
+	for (uint32_t i = begin; i < end; ++i) {
+		const uint8_t idx = _candidates[i];
+		if (_colors[idx] == rgba) {
+			return idx;
+		}
+	}
+	int minDistance = INT32_MAX;
+	int minIndex = PaletteColorNotFound;
+	for (uint32_t i = begin; i < end; ++i) {
+		const uint8_t idx = _candidates[i];
+		const core::RGBA c = _colors[idx];
+		const int rmean = (rgba.r + c.r) / 2;
+		const int r = rgba.r - c.r;
+		const int g = rgba.g - c.g;
+		const int b = rgba.b - c.b;
+		const int distance = (((512 + rmean) * r * r) >> 8) + 4 * g * g + (((767 - rmean) * b * b) >> 8);
+		if (distance < minDistance) {
+			minDistance = distance;
+			minIndex = idx;
+		}
+	}
+	return minIndex;
+}
+
+} // namespace palette
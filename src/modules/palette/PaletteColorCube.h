@@ -0,0 +1,80 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/RGBA.h"
+#include "core/SharedPtr.h"
+#include "core/collection/DynamicArray.h"
+#include "palette/Palette.h"
+
+namespace core {
+class ThreadPool;
+}
+
+namespace palette {
+
+class PaletteColorCube;
+using PaletteColorCubePtr = core::SharedPtr<PaletteColorCube>;
+
+/**
+ * @brief Dense rgb lookup table for the closest palette color
+ *
+ * The rgb space is split into @c CubeSize^3 cells. For every cell the palette colors that might be the closest color
+ * for any rgb value inside the cell are stored - a color is dropped if the lower bound of its distance to the cell
+ * is bigger than the upper bound of the distance of another color. Most cells end up with only one candidate and the
+ * lookup is a single table index, the others only search their few candidates.
+ *
+ * The result is identical to @c Palette::getClosestMatch()
+ */
+class PaletteColorCube {
+public:
+	static constexpr int CellShift = 3;
+	static constexpr int CubeSize = 256 >> CellShift;
+
+private:
+	PaletteColorArray _colors{};
+	int _colorCount = 0;
+	/** CubeSize^3 + 1 offsets into @c _candidates - the candidates of a cell are sorted by their palette index */
+	core::DynamicArray<uint32_t> _cellOffsets;
+	core::DynamicArray<uint8_t> _candidates;
+
+	static inline int cellIndex(int r, int g, int b) {
+		return (r * CubeSize + g) * CubeSize + b;
+	}
+
+public:
+	PaletteColorCube(const Palette &palette, core::ThreadPool *threadPool = nullptr);
+
+	/**
+	 * @brief The cube for the colors of the given palette - the last few cubes are cached and shared
+	 */
+	static PaletteColorCubePtr get(const Palette &palette, core::ThreadPool *threadPool = nullptr);
+	/**
+	 * @brief Removes all cached cubes
+	 */
+	static void clearCache();
+
+	/**
+	 * @return The index to the palette color or @c PaletteColorNotFound if no match was found
+	 * @sa Palette::getClosestMatch()
+	 */
+	int getClosestMatch(core::RGBA rgba) const;
+
+	/**
+	 * @return @c true if the cube was built for the same colors as the given palette has
+	 */
+	bool matches(const Palette &palette) const;
+
+	/**
+	 * @return The amount of palette colors that are stored for the cells - for statistics and tests
+	 */
+	size_t candidates() const;
+};
+
+inline size_t PaletteColorCube::candidates() const {
+	return _candidates.size();
+}
+
+} // namespace palette
@@ -5,22 +5,26 @@
 #pragma once
 
 #include "core/Color.h"
-#include "core/collection/Map.h"
+#include "core/collection/FlatMap.h"
 #include "palette/Palette.h"
+#include "palette/PaletteColorCube.h"
 
 namespace palette {
 
 class PaletteLookup {
 private:
 	palette::Palette _palette;
-	core::Map<core::RGBA, uint8_t, 521> _paletteMap;
+	core::FlatMap<core::RGBA, uint8_t, core::RGBAHasher> _paletteMap;
+	// the max amount of cached colors
+	size_t _maxSize;
+	PaletteColorCubePtr _colorCube;
 public:
-	PaletteLookup(const palette::Palette &palette, int maxSize = 32768) : _palette(palette), _paletteMap(maxSize) {
+	PaletteLookup(const palette::Palette &palette, int maxSize = 32768) : _palette(palette), _maxSize(maxSize) {
 		if (_palette.colorCount() <= 0) {
 			_palette.nippon();
 		}
 	}
-	PaletteLookup(int maxSize = 32768) : _paletteMap(maxSize) {
+	PaletteLookup(int maxSize = 32768) : _maxSize(maxSize) {
 		_palette.nippon();
 	}
 
@@ -29,9 +33,21 @@ public:
 	}
 
 	inline palette::Palette &palette() {
+		// the palette might get modified
+		_colorCube = nullptr;
 		return _palette;
 	}
 
+	/**
+	 * @brief Looks up the colors in a precomputed rgb cube of the palette instead of searching and caching them -
+	 * worth it if a lot of different colors are mapped, e.g. for textures
+	 * @note The cube is shared with other lookups for the same palette colors
+	 * @sa PaletteColorCube
+	 */
+	void useColorCube(core::ThreadPool *threadPool = nullptr) {
+		_colorCube = PaletteColorCube::get(_palette, threadPool);
+	}
+
 	/**
 	 * @brief Find the closed index in the currently in-use palette for the given color
 	 * @param color Normalized color value [0.0-1.0]
@@ -43,13 +59,19 @@ public:
 
 	/**
 	 * @brief Find the closed index in the currently in-use palette for the given color
+	 * @return The palette index or @c 0 if no color matches
 	 * @sa core::Color::getClosestMatch()
 	 */
 	uint8_t findClosestIndex(core::RGBA rgba) {
+		if (_colorCube) {
+			const int match = _colorCube->getClosestMatch(rgba);
+			return match == PaletteColorNotFound ? 0 : (uint8_t)match;
+		}
 		uint8_t paletteIndex = 0;
 		if (!_paletteMap.get(rgba, paletteIndex)) {
-			paletteIndex = _palette.getClosestMatch(rgba);
-			if (_paletteMap.size() < _paletteMap.capacity()) {
+			const int match = _palette.getClosestMatch(rgba);
+			paletteIndex = match == PaletteColorNotFound ? 0 : (uint8_t)match;
+			if (_paletteMap.size() < _maxSize) {
 				_paletteMap.put(rgba, paletteIndex);
 			}
 		}
@@ -0,0 +1,120 @@
+/**
+ * @file
+ */
+
+#include "PaletteRegistry.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/DynamicMap.h"
+#include "core/concurrent/Lock.h"
+#include "palette/NormalPalette.h"
+#include "palette/Palette.h"
+
+namespace palette {
+
+namespace priv {
+
+static core::DynamicMap<uint64_t, PalettePtr, 1031> s_palettes;
+static core::DynamicMap<uint32_t, NormalPalettePtr, 31> s_normalPalettes;
+core_trace_mutex(core::Lock, s_registryLock, "PaletteRegistry");
+
+static bool sameContent(const Palette &a, const Palette &b) {
+	if (a.colorCount() != b.colorCount() || a.name() != b.name()) {
+		return false;
+	}
+	for (int i = 0; i < PaletteMaxColors; ++i) {
+		if (a.color(i) != b.color(i) || !(a.material(i) == b.material(i))) {
+			return false;
+		}
+	}
+	return core_memcmp(a.uiIndices(), b.uiIndices(), sizeof(PaletteIndicesArray)) == 0;
+}
+
+static bool sameContent(const NormalPalette &a, const NormalPalette &b) {
+	if (a.size() != b.size() || a.name() != b.name()) {
+		return false;
+	}
+	for (int i = 0; i < NormalPaletteMaxNormals; ++i) {
+		if (a.normal(i) != b.normal(i)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template<class MAP>
+static void pruneMap(MAP &map) {
+	core::DynamicArray<typename MAP::key_type> unused;
+	for (auto iter = map.begin(); iter != map.end(); ++iter) {
+		if (iter->value.unique()) {
+			unused.push_back(iter->key);
+		}
+	}
+	for (const auto &key : unused) {
+		map.remove(key);
+	}
+}
+
+template<class PTR, class MAP, class TYPE>
+static PTR intern(MAP &map, const TYPE &value) {
+	PTR instance = core::make_shared<TYPE>(value);
+	// the hash is only updated by markDirty()
+	instance->markDirty();
+	core::ScopedLock lock(s_registryLock);
+	PTR shared;
+	if (map.get(instance->hash(), shared)) {
+		if (sameContent(*shared.get(), *instance.get())) {
+			return shared;
+		}
+		// hash collision - the instance is just not shared
+		return instance;
+	}
+	map.put(instance->hash(), instance);
+	return instance;
+}
+
+} // namespace priv
+
+PalettePtr PaletteRegistry::intern(const Palette &palette) {
+	core_trace_scoped(PaletteRegistryIntern);
+	return priv::intern<PalettePtr>(priv::s_palettes, palette);
+}
+
+NormalPalettePtr PaletteRegistry::intern(const NormalPalette &normalPalette) {
+	core_trace_scoped(NormalPaletteRegistryIntern);
+	return priv::intern<NormalPalettePtr>(priv::s_normalPalettes, normalPalette);
+}
+
+void PaletteRegistry::detach(PalettePtr &palette) {
+	if (!palette || palette.unique()) {
+		return;
+	}
+	palette = core::make_shared<Palette>(*palette.get());
+}
+
+void PaletteRegistry::detach(NormalPalettePtr &normalPalette) {
+	if (!normalPalette || normalPalette.unique()) {
+		return;
+	}
+	normalPalette = core::make_shared<NormalPalette>(*normalPalette.get());
+}
+
+void PaletteRegistry::prune() {
+	core::ScopedLock lock(priv::s_registryLock);
+	priv::pruneMap(priv::s_palettes);
+	priv::pruneMap(priv::s_normalPalettes);
+}
+
+void PaletteRegistry::clear() {
+	core::ScopedLock lock(priv::s_registryLock);
+	priv::s_palettes.clear();
+	priv::s_normalPalettes.clear();
+}
+
+size_t PaletteRegistry::size() {
+	core::ScopedLock lock(priv::s_registryLock);
+	return priv::s_palettes.size() + priv::s_normalPalettes.size();
+}
+
+} // namespace palette
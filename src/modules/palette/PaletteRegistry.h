@@ -0,0 +1,55 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/SharedPtr.h"
+
+namespace palette {
+
+class Palette;
+class NormalPalette;
+using PalettePtr = core::SharedPtr<Palette>;
+using NormalPalettePtr = core::SharedPtr<NormalPalette>;
+
+/**
+ * @brief Stores identical palettes only once
+ *
+ * Formats with a palette per model produce a lot of identical palettes. @c intern() hands out one shared instance
+ * for all palettes with the same content. The shared instances are never modified - call @c detach() before
+ * modifying a palette to get an own copy of it (copy-on-write).
+ *
+ * Instances that are only referenced by the registry anymore are removed by @c prune() - this is not done
+ * automatically, because the renderer keeps raw pointers to the palettes of the nodes until the next frame.
+ */
+class PaletteRegistry {
+public:
+	/**
+	 * @return The shared instance for the content of the given palette
+	 */
+	static PalettePtr intern(const Palette &palette);
+	static NormalPalettePtr intern(const NormalPalette &normalPalette);
+
+	/**
+	 * @brief Makes sure that the given instance isn't shared - it's replaced by a copy if it is
+	 * @note References to the old instance are still pointing to the shared palette
+	 */
+	static void detach(PalettePtr &palette);
+	static void detach(NormalPalettePtr &normalPalette);
+
+	/**
+	 * @brief Removes the instances that are only referenced by the registry
+	 */
+	static void prune();
+	/**
+	 * @brief Removes all instances from the registry - the instances that are still in use stay valid
+	 */
+	static void clear();
+	/**
+	 * @return The amount of registered palettes and normal palettes - for statistics and tests
+	 */
+	static size_t size();
+};
+
+} // namespace palette
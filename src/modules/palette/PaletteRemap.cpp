@@ -0,0 +1,131 @@
+/**
+ * @file
+ */
+
+#include "PaletteRemap.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/FlatMap.h"
+#include "core/concurrent/Parallel.h"
+#include "palette/Palette.h"
+#include "palette/PaletteColorCube.h"
+#include <glm/common.hpp>
+
+namespace palette {
+
+namespace priv {
+
+// building the rgb cube only pays off for photo like images with a lot of different colors
+static constexpr int ColorCubeMinColors = 16384;
+
+static inline uint8_t clampChannel(int value) {
+	return (uint8_t)glm::clamp(value, 0, 255);
+}
+
+} // namespace priv
+
+void remapColors(const Palette &palette, const core::RGBA *colors, size_t count, int *indices,
+				 core::ThreadPool *threadPool) {
+	core_trace_scoped(RemapColors);
+	core::DynamicArray<core::RGBA> uniqueColors;
+	core::FlatMap<core::RGBA, int, core::RGBAHasher> uniqueIndices;
+	int lastId = -1;
+	for (size_t i = 0; i < count; ++i) {
+		const core::RGBA color = colors[i];
+		// neighbouring pixels often share the same color
+		if (lastId != -1 && uniqueColors[lastId] == color) {
+			indices[i] = lastId;
+			continue;
+		}
+		if (!uniqueIndices.get(color, lastId)) {
+			lastId = (int)uniqueColors.size();
+			uniqueColors.push_back(color);
+			uniqueIndices.put(color, lastId);
+		}
+		indices[i] = lastId;
+	}
+
+	const int uniqueCount = (int)uniqueColors.size();
+	core::DynamicArray<int> palIndices;
+	palIndices.resize(uniqueCount);
+	PaletteColorCubePtr cube;
+	if (uniqueCount > priv::ColorCubeMinColors) {
+		cube = PaletteColorCube::get(palette, threadPool);
+	}
+	const int slices = core::parallelSliceCount(threadPool, uniqueCount);
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		const int lower = uniqueCount * slice / slices;
+		const int upper = uniqueCount * (slice + 1) / slices;
+		for (int i = lower; i < upper; ++i) {
+			palIndices[i] = cube ? cube->getClosestMatch(uniqueColors[i]) : palette.getClosestMatch(uniqueColors[i]);
+		}
+	});
+	for (size_t i = 0; i < count; ++i) {
+		indices[i] = palIndices[indices[i]];
+	}
+}
+
+void remapColorsDithered(const Palette &palette, const core::RGBA *colors, int width, int height, int *indices,
+						 core::ThreadPool *threadPool) {
+	core_trace_scoped(RemapColorsDithered);
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+	// the diffused error creates new colors for almost every pixel
+	PaletteColorCubePtr cube;
+	if (width * height > priv::ColorCubeMinColors) {
+		cube = PaletteColorCube::get(palette, threadPool);
+	}
+	// the error of the current and the next row - one rgb triple per pixel with a border pixel on both sides
+	const int rowSize = (width + 2) * 3;
+	core::DynamicArray<int> errorRows;
+	errorRows.resize(rowSize * 2);
+	int *current = errorRows.data();
+	int *next = current + rowSize;
+	core_memset(current, 0, rowSize * sizeof(int));
+
+	for (int y = 0; y < height; ++y) {
+		core_memset(next, 0, rowSize * sizeof(int));
+		// serpentine scan to avoid the directional artifacts of the error diffusion
+		const bool leftToRight = (y & 1) == 0;
+		const int dir = leftToRight ? 1 : -1;
+		for (int i = 0; i < width; ++i) {
+			const int x = leftToRight ? i : width - 1 - i;
+			const size_t pixelIdx = (size_t)y * width + x;
+			const core::RGBA color = colors[pixelIdx];
+			if (color.a == 0) {
+				indices[pixelIdx] = cube ? cube->getClosestMatch(color) : palette.getClosestMatch(color);
+				continue;
+			}
+			int *err = current + (x + 1) * 3;
+			// the error is stored with 4 bits of fraction
+			const int r = color.r + err[0] / 16;
+			const int g = color.g + err[1] / 16;
+			const int b = color.b + err[2] / 16;
+			const core::RGBA dithered(priv::clampChannel(r), priv::clampChannel(g), priv::clampChannel(b), color.a);
+			const int palIdx = cube ? cube->getClosestMatch(dithered) : palette.getClosestMatch(dithered);
+			indices[pixelIdx] = palIdx;
+			if (palIdx == PaletteColorNotFound) {
+				continue;
+			}
+			const core::RGBA matched = palette.color(palIdx);
+			const int delta[3] = {dithered.r - matched.r, dithered.g - matched.g, dithered.b - matched.b};
+			int *errAhead = err + dir * 3;
+			int *errNext = next + (x + 1) * 3;
+			int *errNextAhead = errNext + dir * 3;
+			int *errNextBehind = errNext - dir * 3;
+			for (int c = 0; c < 3; ++c) {
+				// 7/16, 3/16, 5/16 and 1/16 - with the 4 bits of fraction these are just the numerators
+				errAhead[c] += delta[c] * 7;
+				errNextBehind[c] += delta[c] * 3;
+				errNext[c] += delta[c] * 5;
+				errNextAhead[c] += delta[c];
+			}
+		}
+		core::exchange(current, next);
+	}
+}
+
+} // namespace palette
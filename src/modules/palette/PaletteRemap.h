@@ -0,0 +1,42 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/RGBA.h"
+#include <stddef.h>
+
+namespace core {
+class ThreadPool;
+}
+
+namespace palette {
+
+class Palette;
+
+/**
+ * @brief Maps colors to the indices of the closest palette colors
+ *
+ * The closest match is only searched once for every unique color of the input - in parallel and with the
+ * vectorized search or the cached @c PaletteColorCube if there are a lot of unique colors.
+ *
+ * @param[out] indices The palette index (or @c PaletteColorNotFound) for every color - the result is identical to
+ * calling @c Palette::getClosestMatch() for every color
+ */
+void remapColors(const Palette &palette, const core::RGBA *colors, size_t count, int *indices,
+				 core::ThreadPool *threadPool = nullptr);
+
+/**
+ * @brief Same as @c remapColors() - but the error between the color and the matched palette color is distributed to
+ * the neighbouring pixels (Floyd-Steinberg dithering)
+ *
+ * Transparent pixels are matched without dithering and don't take part in the error diffusion.
+ *
+ * @param colors The pixels of an image with the given dimensions in row-major order
+ * @note The error diffusion is sequential - only the palette lookup table is built in parallel
+ */
+void remapColorsDithered(const Palette &palette, const core::RGBA *colors, int width, int height, int *indices,
+						 core::ThreadPool *threadPool = nullptr);
+
+} // namespace palette
@@ -0,0 +1,130 @@
+/**
+ * @file
+ */
+
+#include "PaletteSearch.h"
+#include "core/Color.h"
+#include <SDL_cpuinfo.h>
+#include <float.h>
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define PALETTE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace palette {
+namespace priv {
+
+int closestMatchScalar(const core::RGBA *colors, int colorCount, core::RGBA rgba, int skip) {
+	for (int i = 0; i < colorCount; ++i) {
+		if (i == skip) {
+			continue;
+		}
+		if (colors[i] == rgba) {
+			return i;
+		}
+	}
+
+	float minDistance = FLT_MAX;
+	int minIndex = -1;
+
+	for (int i = 0; i < colorCount; ++i) {
+		if (i == skip) {
+			continue;
+		}
+		if (colors[i].a == 0) {
+			continue;
+		}
+		const float val = core::Color::getDistance(colors[i], rgba, core::Color::Distance::Approximation);
+		if (val < minDistance) {
+			minDistance = val;
+			minIndex = (int)i;
+		}
+	}
+	return minIndex;
+}
+
+#ifdef PALETTE_SIMD_NEON
+/**
+ * @brief NEON is always available on arm64 - four palette colors per iteration
+ *
+ * The distance of core::Color::Distance::Approximation only consists of integer terms below 2^24 - so it's computed
+ * with integers here and the comparison gives the same result as the float comparison of the scalar version.
+ */
+static int closestMatchNEON(const core::RGBA *colors, int colorCount, core::RGBA rgba, int skip) {
+	const uint32_t *packed = (const uint32_t *)colors;
+	const uint32x4_t target = vdupq_n_u32(rgba.rgba);
+	const int32x4_t tr = vdupq_n_s32(rgba.r);
+	const int32x4_t tg = vdupq_n_s32(rgba.g);
+	const int32x4_t tb = vdupq_n_s32(rgba.b);
+	const uint32x4_t byteMask = vdupq_n_u32(0xff);
+	const int32x4_t count = vdupq_n_s32(colorCount);
+	const int32x4_t skipIdx = vdupq_n_s32(skip);
+	const int32x4_t invalid = vdupq_n_s32(INT32_MAX);
+	static const int32_t laneOffsets[4] = {0, 1, 2, 3};
+	int32x4_t idx = vld1q_s32(laneOffsets);
+	int32x4_t bestDistance = invalid;
+	int32x4_t bestIndex = vdupq_n_s32(-1);
+
+	for (int i = 0; i < colorCount; i += 4) {
+		const uint32x4_t c = vld1q_u32(packed + i);
+		const uint32x4_t valid = vandq_u32(vcltq_s32(idx, count), vmvnq_u32(vceqq_s32(idx, skipIdx)));
+		if (vmaxvq_u32(vandq_u32(vceqq_u32(c, target), valid)) != 0u) {
+			// the exact match with the lowest index wins
+			for (int lane = i; lane < i + 4; ++lane) {
+				if (lane != skip && colors[lane] == rgba) {
+					return lane;
+				}
+			}
+		}
+		const int32x4_t r = vreinterpretq_s32_u32(vandq_u32(c, byteMask));
+		const int32x4_t g = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(c, 8), byteMask));
+		const int32x4_t b = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(c, 16), byteMask));
+		const uint32x4_t opaque = vtstq_u32(c, vdupq_n_u32(0xff000000u));
+		const int32x4_t rmean = vshrq_n_s32(vaddq_s32(tr, r), 1);
+		const int32x4_t dr = vsubq_s32(tr, r);
+		const int32x4_t dg = vsubq_s32(tg, g);
+		const int32x4_t db = vsubq_s32(tb, b);
+		const int32x4_t termR = vshrq_n_s32(vmulq_s32(vmulq_s32(vaddq_s32(vdupq_n_s32(512), rmean), dr), dr), 8);
+		const int32x4_t termG = vshlq_n_s32(vmulq_s32(dg, dg), 2);
+		const int32x4_t termB = vshrq_n_s32(vmulq_s32(vmulq_s32(vsubq_s32(vdupq_n_s32(767), rmean), db), db), 8);
+		int32x4_t distance = vaddq_s32(vaddq_s32(termR, termG), termB);
+		distance = vbslq_s32(vandq_u32(valid, opaque), distance, invalid);
+		const uint32x4_t closer = vcltq_s32(distance, bestDistance);
+		bestDistance = vbslq_s32(closer, distance, bestDistance);
+		bestIndex = vbslq_s32(closer, idx, bestIndex);
+		idx = vaddq_s32(idx, vdupq_n_s32(4));
+	}
+
+	int32_t distances[4];
+	int32_t indices[4];
+	vst1q_s32(distances, bestDistance);
+	vst1q_s32(indices, bestIndex);
+	int32_t minDistance = INT32_MAX;
+	int minIndex = -1;
+	for (int lane = 0; lane < 4; ++lane) {
+		if (distances[lane] < minDistance || (distances[lane] == minDistance && indices[lane] < minIndex)) {
+			minDistance = distances[lane];
+			minIndex = indices[lane];
+		}
+	}
+	return minIndex;
+}
+#endif
+
+#ifdef PALETTE_SIMD_X86
+static const bool s_hasAVX2 = SDL_HasAVX2();
+#endif
+
+int closestMatch(const core::RGBA *colors, int colorCount, core::RGBA rgba, int skip) {
+#if defined(PALETTE_SIMD_X86)
+	if (s_hasAVX2) {
+		return closestMatchAVX2(colors, colorCount, rgba, skip);
+	}
+#elif defined(PALETTE_SIMD_NEON)
+	return closestMatchNEON(colors, colorCount, rgba, skip);
+#endif
+	return closestMatchScalar(colors, colorCount, rgba, skip);
+}
+
+} // namespace priv
+} // namespace palette
@@ -0,0 +1,36 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/RGBA.h"
+
+namespace palette {
+namespace priv {
+
+/**
+ * @brief Searches the index of the given color in the palette colors - or the color with the smallest
+ * core::Color::Distance::Approximation distance if there is no exact match. Transparent palette colors are only
+ * matched exactly.
+ *
+ * @param colors The palette colors - the array must have @c PaletteMaxColors entries, the vectorized kernels read
+ * the entries after @c colorCount in blocks and ignore them
+ * @param skip One palette color index that is not taken into account or @c -1
+ * @return The palette color index or @c -1 if there is no opaque color to match against
+ * @note The result is identical for all instruction sets - if two colors have the same distance, the lower index wins
+ */
+int closestMatch(const core::RGBA *colors, int colorCount, core::RGBA rgba, int skip);
+
+/**
+ * @brief The reference implementation of @c closestMatch()
+ */
+int closestMatchScalar(const core::RGBA *colors, int colorCount, core::RGBA rgba, int skip);
+
+#ifdef PALETTE_SIMD_X86
+// see private/PaletteSearchAVX2.cpp
+int closestMatchAVX2(const core::RGBA *colors, int colorCount, core::RGBA rgba, int skip);
+#endif
+
+} // namespace priv
+} // namespace palette
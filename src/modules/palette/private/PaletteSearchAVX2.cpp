@@ -0,0 +1,85 @@
+/**
+ * @file
+ *
+ * Compiled with AVX2 enabled - only called if the cpu supports it. Don't include anything but the kernel here.
+ */
+
+#ifdef PALETTE_SIMD_X86
+
+#include "PaletteSearch.h"
+#include <immintrin.h>
+
+namespace palette {
+namespace priv {
+
+/**
+ * The distance of core::Color::Distance::Approximation only consists of integer terms below 2^24 - so it's computed
+ * with integers here and the comparison gives the same result as the float comparison of the scalar version.
+ */
+int closestMatchAVX2(const core::RGBA *colors, int colorCount, core::RGBA rgba, int skip) {
+	const __m256i target = _mm256_set1_epi32((int32_t)rgba.rgba);
+	const __m256i tr = _mm256_set1_epi32(rgba.r);
+	const __m256i tg = _mm256_set1_epi32(rgba.g);
+	const __m256i tb = _mm256_set1_epi32(rgba.b);
+	const __m256i byteMask = _mm256_set1_epi32(0xff);
+	const __m256i count = _mm256_set1_epi32(colorCount);
+	const __m256i skipIdx = _mm256_set1_epi32(skip);
+	const __m256i invalid = _mm256_set1_epi32(INT32_MAX);
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i bestDistance = invalid;
+	__m256i bestIndex = _mm256_set1_epi32(-1);
+
+	for (int i = 0; i < colorCount; i += 8) {
+		const __m256i c = _mm256_loadu_si256((const __m256i *)(colors + i));
+		const __m256i valid = _mm256_andnot_si256(_mm256_cmpeq_epi32(idx, skipIdx), _mm256_cmpgt_epi32(count, idx));
+		const int exact = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(_mm256_cmpeq_epi32(c, target), valid)));
+		if (exact != 0) {
+			// the exact match with the lowest index wins
+			int lane = 0;
+			while ((exact & (1 << lane)) == 0) {
+				++lane;
+			}
+			return i + lane;
+		}
+		const __m256i r = _mm256_and_si256(c, byteMask);
+		const __m256i g = _mm256_and_si256(_mm256_srli_epi32(c, 8), byteMask);
+		const __m256i b = _mm256_and_si256(_mm256_srli_epi32(c, 16), byteMask);
+		const __m256i transparent = _mm256_cmpeq_epi32(_mm256_srli_epi32(c, 24), zero);
+		const __m256i rmean = _mm256_srli_epi32(_mm256_add_epi32(tr, r), 1);
+		const __m256i dr = _mm256_sub_epi32(tr, r);
+		const __m256i dg = _mm256_sub_epi32(tg, g);
+		const __m256i db = _mm256_sub_epi32(tb, b);
+		const __m256i termR = _mm256_srli_epi32(
+			_mm256_mullo_epi32(_mm256_add_epi32(_mm256_set1_epi32(512), rmean), _mm256_mullo_epi32(dr, dr)), 8);
+		const __m256i termG = _mm256_slli_epi32(_mm256_mullo_epi32(dg, dg), 2);
+		const __m256i termB = _mm256_srli_epi32(
+			_mm256_mullo_epi32(_mm256_sub_epi32(_mm256_set1_epi32(767), rmean), _mm256_mullo_epi32(db, db)), 8);
+		__m256i distance = _mm256_add_epi32(_mm256_add_epi32(termR, termG), termB);
+		const __m256i use = _mm256_andnot_si256(transparent, valid);
+		distance = _mm256_blendv_epi8(invalid, distance, use);
+		const __m256i closer = _mm256_cmpgt_epi32(bestDistance, distance);
+		bestDistance = _mm256_blendv_epi8(bestDistance, distance, closer);
+		bestIndex = _mm256_blendv_epi8(bestIndex, idx, closer);
+		idx = _mm256_add_epi32(idx, _mm256_set1_epi32(8));
+	}
+
+	alignas(32) int32_t distances[8];
+	alignas(32) int32_t indices[8];
+	_mm256_store_si256((__m256i *)distances, bestDistance);
+	_mm256_store_si256((__m256i *)indices, bestIndex);
+	int32_t minDistance = INT32_MAX;
+	int minIndex = -1;
+	for (int lane = 0; lane < 8; ++lane) {
+		if (distances[lane] < minDistance || (distances[lane] == minDistance && indices[lane] < minIndex)) {
+			minDistance = distances[lane];
+			minIndex = indices[lane];
+		}
+	}
+	return minIndex;
+}
+
+} // namespace priv
+} // namespace palette
+
+#endif
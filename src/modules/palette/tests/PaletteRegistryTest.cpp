@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#include "palette/PaletteRegistry.h"
+#include "app/tests/AbstractTest.h"
+#include "palette/NormalPalette.h"
+#include "palette/Palette.h"
+
+namespace palette {
+
+class PaletteRegistryTest : public app::AbstractTest {
+protected:
+	void TearDown() override {
+		PaletteRegistry::clear();
+		app::AbstractTest::TearDown();
+	}
+};
+
+TEST_F(PaletteRegistryTest, testIntern) {
+	Palette pal1;
+	pal1.nippon();
+	Palette pal2;
+	pal2.nippon();
+	const PalettePtr &shared1 = PaletteRegistry::intern(pal1);
+	const PalettePtr &shared2 = PaletteRegistry::intern(pal2);
+	EXPECT_EQ(shared1.get(), shared2.get());
+	EXPECT_EQ(pal1.hash(), shared1->hash());
+
+	Palette pal3;
+	pal3.magicaVoxel();
+	const PalettePtr &shared3 = PaletteRegistry::intern(pal3);
+	EXPECT_NE(shared1.get(), shared3.get());
+	EXPECT_EQ(2u, PaletteRegistry::size());
+}
+
+TEST_F(PaletteRegistryTest, testInternDifferentName) {
+	Palette pal1;
+	pal1.nippon();
+	Palette pal2;
+	pal2.nippon();
+	pal2.setName("other");
+	const PalettePtr &shared1 = PaletteRegistry::intern(pal1);
+	const PalettePtr &shared2 = PaletteRegistry::intern(pal2);
+	EXPECT_NE(shared1.get(), shared2.get());
+	EXPECT_EQ("other", shared2->name());
+}
+
+TEST_F(PaletteRegistryTest, testDetach) {
+	Palette pal;
+	pal.nippon();
+	PalettePtr shared = PaletteRegistry::intern(pal);
+	PalettePtr own = shared;
+	PaletteRegistry::detach(own);
+	EXPECT_NE(shared.get(), own.get());
+	own->setColor(0, core::RGBA(1, 2, 3, 255));
+	EXPECT_EQ(pal.color(0), shared->color(0));
+
+	// an instance that isn't shared is not copied again
+	Palette *ptr = own.get();
+	PaletteRegistry::detach(own);
+	EXPECT_EQ(ptr, own.get());
+}
+
+TEST_F(PaletteRegistryTest, testPrune) {
+	Palette pal;
+	pal.nippon();
+	{
+		const PalettePtr &shared = PaletteRegistry::intern(pal);
+		PaletteRegistry::prune();
+		EXPECT_EQ(1u, PaletteRegistry::size());
+	}
+	PaletteRegistry::prune();
+	EXPECT_EQ(0u, PaletteRegistry::size());
+}
+
+TEST_F(PaletteRegistryTest, testInternNormalPalette) {
+	NormalPalette pal1;
+	pal1.redAlert2();
+	NormalPalette pal2;
+	pal2.redAlert2();
+	NormalPalette pal3;
+	pal3.tiberianSun();
+	const NormalPalettePtr &shared1 = PaletteRegistry::intern(pal1);
+	const NormalPalettePtr &shared2 = PaletteRegistry::intern(pal2);
+	const NormalPalettePtr &shared3 = PaletteRegistry::intern(pal3);
+	EXPECT_EQ(shared1.get(), shared2.get());
+	EXPECT_NE(shared1.get(), shared3.get());
+}
+
+} // namespace palette
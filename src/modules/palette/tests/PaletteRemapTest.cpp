@@ -0,0 +1,75 @@
+/**
+ * @file
+ */
+
+#include "palette/PaletteRemap.h"
+#include "app/tests/AbstractTest.h"
+#include "core/collection/DynamicArray.h"
+#include "palette/Palette.h"
+
+namespace palette {
+
+class PaletteRemapTest : public app::AbstractTest {};
+
+TEST_F(PaletteRemapTest, testRemapColors) {
+	Palette pal;
+	pal.nippon();
+	// enough unique colors to use the color cube
+	const int count = 128 * 256;
+	core::DynamicArray<core::RGBA> colors;
+	colors.reserve(count);
+	for (int i = 0; i < count; ++i) {
+		colors.push_back(core::RGBA((i * 7) & 255, (i >> 3) & 255, (i * 13) >> 7, i % 5 == 0 ? 0 : 255));
+	}
+	core::DynamicArray<int> indices;
+	indices.resize(count);
+	remapColors(pal, colors.data(), colors.size(), indices.data(), &_testApp->threadPool());
+	for (int i = 0; i < count; ++i) {
+		ASSERT_EQ(pal.getClosestMatch(colors[i]), indices[i]) << i;
+	}
+}
+
+TEST_F(PaletteRemapTest, testRemapColorsDitheredExact) {
+	Palette pal;
+	pal.nippon();
+	const int w = 16;
+	const int h = 8;
+	core::DynamicArray<core::RGBA> colors;
+	colors.resize(w * h);
+	for (int i = 0; i < w * h; ++i) {
+		colors[i] = pal.color(i % 3);
+	}
+	core::DynamicArray<int> indices;
+	indices.resize(w * h);
+	remapColorsDithered(pal, colors.data(), w, h, indices.data());
+	// colors that are part of the palette don't produce any error
+	for (int i = 0; i < w * h; ++i) {
+		EXPECT_EQ(pal.getClosestMatch(colors[i]), indices[i]) << i;
+	}
+}
+
+TEST_F(PaletteRemapTest, testRemapColorsDitheredGray) {
+	Palette pal;
+	pal.setColor(0, core::RGBA(0, 0, 0, 255));
+	pal.setColor(1, core::RGBA(255, 255, 255, 255));
+	pal.setSize(2);
+	const int w = 32;
+	const int h = 32;
+	core::DynamicArray<core::RGBA> colors;
+	colors.resize(w * h);
+	for (int i = 0; i < w * h; ++i) {
+		colors[i] = core::RGBA(128, 128, 128, 255);
+	}
+	core::DynamicArray<int> indices;
+	indices.resize(w * h);
+	remapColorsDithered(pal, colors.data(), w, h, indices.data());
+	int white = 0;
+	for (int i = 0; i < w * h; ++i) {
+		ASSERT_TRUE(indices[i] == 0 || indices[i] == 1) << i;
+		white += indices[i];
+	}
+	// without dithering all pixels would get the same color - with dithering the mean is preserved
+	EXPECT_NEAR(w * h / 2, white, w * h / 16);
+}
+
+} // namespace palette
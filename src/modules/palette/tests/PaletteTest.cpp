@@ -3,11 +3,13 @@
  */
 
 #include "palette/Palette.h"
+#include "palette/PaletteColorCube.h"
 #include "app/tests/AbstractTest.h"
 #include "core/ArrayLength.h"
 #include "core/ConfigVar.h"
 #include "core/Var.h"
 #include "palette/PaletteLookup.h"
+#include "palette/private/PaletteSearch.h"
 
 namespace palette {
 
@@ -24,6 +26,8 @@ TEST_F(PaletteTest, testPaletteLookup) {
 	PaletteLookup pal;
 	core::RGBA rgba{0xffffffff};
 	EXPECT_EQ(0, pal.findClosestIndex(rgba));
+	pal.useColorCube();
+	EXPECT_EQ(0, pal.findClosestIndex(rgba));
 }
 
 TEST_F(PaletteTest, testGimpPalette) {
@@ -268,4 +272,80 @@ TEST_F(PaletteTest, testPixeloramaPalette) {
 	EXPECT_EQ(56, pal.colorCount());
 }
 
+TEST_F(PaletteTest, testClosestMatchSameAsScalar) {
+	PaletteColorArray colors;
+	uint32_t state = 0x12345678u;
+	auto next = [&state]() {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	};
+	for (int colorCount : {1, 7, 8, 33, 200, PaletteMaxColors}) {
+		for (int i = 0; i < PaletteMaxColors; ++i) {
+			// only a few distinct channel values to get equal distances
+			const uint32_t v = next();
+			colors[i] = core::RGBA((v & 7u) * 32u, ((v >> 3) & 7u) * 32u, ((v >> 6) & 7u) * 32u, (v >> 9) % 8u == 0u ? 0u : 255u);
+		}
+		for (int n = 0; n < 500; ++n) {
+			const uint32_t v = next();
+			const core::RGBA rgba((v & 15u) * 16u, ((v >> 4) & 15u) * 16u, ((v >> 8) & 15u) * 16u, 255u);
+			const int skip = (int)(v >> 12) % (colorCount + 1) - 1;
+			EXPECT_EQ(priv::closestMatchScalar(colors, colorCount, rgba, skip),
+					  priv::closestMatch(colors, colorCount, rgba, skip))
+				<< "colors: " << colorCount << ", skip: " << skip;
+			// exact matches
+			const core::RGBA existing = colors[(v >> 20) % colorCount];
+			EXPECT_EQ(priv::closestMatchScalar(colors, colorCount, existing, skip),
+					  priv::closestMatch(colors, colorCount, existing, skip))
+				<< "colors: " << colorCount << ", skip: " << skip;
+		}
+	}
+}
+
+TEST_F(PaletteTest, testColorCubeSameAsPalette) {
+	Palette palettes[3];
+	palettes[0].nippon();
+	palettes[1].magicaVoxel();
+	// duplicates, transparent and half transparent colors
+	palettes[2].setSize(6);
+	palettes[2].setColor(0, core::RGBA(0, 0, 0, 0));
+	palettes[2].setColor(1, core::RGBA(200, 10, 10, 255));
+	palettes[2].setColor(2, core::RGBA(10, 200, 10, 128));
+	palettes[2].setColor(3, core::RGBA(200, 10, 10, 255));
+	palettes[2].setColor(4, core::RGBA(10, 10, 200, 0));
+	palettes[2].setColor(5, core::RGBA(10, 200, 10, 255));
+	uint32_t state = 0x9e3779b9u;
+	auto next = [&state]() {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	};
+	for (const Palette &palette : palettes) {
+		const PaletteColorCube cube(palette);
+		for (int i = 0; i < palette.colorCount(); ++i) {
+			EXPECT_EQ(palette.getClosestMatch(palette.color(i)), cube.getClosestMatch(palette.color(i)));
+		}
+		for (int n = 0; n < 100000; ++n) {
+			const uint32_t v = next();
+			const core::RGBA rgba(v & 0xff, (v >> 8) & 0xff, (v >> 16) & 0xff, (v >> 24) < 16u ? (v >> 24) % 2u * 128u : 255u);
+			ASSERT_EQ(palette.getClosestMatch(rgba), cube.getClosestMatch(rgba))
+				<< "color " << (int)rgba.r << ":" << (int)rgba.g << ":" << (int)rgba.b << ":" << (int)rgba.a;
+		}
+	}
+}
+
+TEST_F(PaletteTest, testColorCubeCache) {
+	Palette pal;
+	pal.nippon();
+	const PaletteColorCubePtr &cube = PaletteColorCube::get(pal);
+	EXPECT_EQ(cube, PaletteColorCube::get(pal));
+	EXPECT_TRUE(cube->matches(pal));
+	pal.setColor(1, core::RGBA(1, 2, 3));
+	EXPECT_FALSE(cube->matches(pal));
+	EXPECT_NE(cube, PaletteColorCube::get(pal));
+	PaletteColorCube::clearCache();
+}
+
 } // namespace palette
@@ -10,6 +10,7 @@
 #include "core/ArrayLength.h"
 #include "core/Trace.h"
 #include "video/FrameBufferConfig.h"
+#include "video/GPUTimer.h"
 #include "video/Renderer.h"
 #include "video/ScopedBlendMode.h"
 #include "video/ScopedFrameBuffer.h"
@@ -157,6 +158,7 @@ void BloomRenderer::apply(video::FrameBuffer *sources, video::FrameBuffer *dests
 
 void BloomRenderer::render(const video::TexturePtr& srcTexture, const video::TexturePtr& glowTexture) {
 	core_trace_scoped(BloomRender);
+	video_pass_scoped(BloomRender);
 	video::ScopedState depthTest(video::State::DepthTest, false);
 	video::ScopedState scissor(video::State::Scissor, false);
 	video::ScopedBlendMode blendMode(video::BlendMode::One, video::BlendMode::OneMinusSourceAlpha);
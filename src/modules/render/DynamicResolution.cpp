@@ -0,0 +1,112 @@
+/**
+ * @file
+ */
+
+#include "DynamicResolution.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include "video/Renderer.h"
+#include <glm/common.hpp>
+#include <glm/exponential.hpp>
+
+namespace render {
+
+bool DynamicResolution::init() {
+	if (!video::hasFeature(video::Feature::TimerQuery)) {
+		return true;
+	}
+	for (int i = 0; i < Queries; ++i) {
+		_queries[i] = video::genQuery();
+		if (_queries[i] == video::InvalidId) {
+			shutdown();
+			return false;
+		}
+		_queryPending[i] = false;
+	}
+	return true;
+}
+
+void DynamicResolution::shutdown() {
+	for (int i = 0; i < Queries; ++i) {
+		if (_queries[i] != video::InvalidId) {
+			video::deleteQuery(_queries[i]);
+		}
+		_queryPending[i] = false;
+	}
+	_currentQuery = 0;
+	_measuring = false;
+	_fullResolutionMillis = 0.0;
+	_lastMillis = 0.0;
+	_scale = 1.0f;
+	_idleFrames = IdleFrames;
+}
+
+void DynamicResolution::readQueries() {
+	for (int i = 0; i < Queries; ++i) {
+		if (!_queryPending[i] || !video::isQueryResultAvailable(_queries[i])) {
+			continue;
+		}
+		const uint32_t nanos = video::queryResult(_queries[i]);
+		_queryPending[i] = false;
+		addSample((double)nanos / 1000000.0, _queryScales[i]);
+	}
+}
+
+void DynamicResolution::begin() {
+	if (_queries[0] == video::InvalidId) {
+		return;
+	}
+	readQueries();
+	// all queries are still waiting for their results - this frame is not measured
+	if (_queryPending[_currentQuery]) {
+		return;
+	}
+	_measuring = video::beginQuery(video::QueryType::TimeElapsed, _queries[_currentQuery]);
+}
+
+void DynamicResolution::end() {
+	if (!_measuring) {
+		return;
+	}
+	video::endQuery(video::QueryType::TimeElapsed);
+	_queryScales[_currentQuery] = _scale;
+	_queryPending[_currentQuery] = true;
+	_currentQuery = (_currentQuery + 1) % Queries;
+	_measuring = false;
+}
+
+void DynamicResolution::addSample(double gpuMillis, float scale) {
+	_lastMillis = gpuMillis;
+	core_trace_plot("DynamicResolutionGPUMillis", gpuMillis);
+	if (scale <= 0.0f) {
+		return;
+	}
+	// the costs of the frame are dominated by the amount of pixels
+	const double fullResolutionMillis = gpuMillis / (double)(scale * scale);
+	if (_fullResolutionMillis <= 0.0) {
+		_fullResolutionMillis = fullResolutionMillis;
+	} else {
+		_fullResolutionMillis = glm::mix(_fullResolutionMillis, fullResolutionMillis, 0.25);
+	}
+}
+
+float DynamicResolution::update(bool moving, double budgetMillis) {
+	if (moving) {
+		_idleFrames = 0;
+	} else if (_idleFrames < IdleFrames) {
+		++_idleFrames;
+	}
+	if (_idleFrames >= IdleFrames || budgetMillis <= 0.0 || _fullResolutionMillis <= budgetMillis) {
+		_scale = 1.0f;
+		return _scale;
+	}
+	const float scale = (float)glm::sqrt(budgetMillis / _fullResolutionMillis);
+	_scale = core_max(MinScale, glm::floor(scale / ScaleStep) * ScaleStep);
+	return _scale;
+}
+
+glm::ivec2 DynamicResolution::resolution(const glm::ivec2 &size) const {
+	return glm::max(glm::ivec2(1), glm::ivec2(glm::vec2(size) * _scale));
+}
+
+} // namespace render
@@ -0,0 +1,89 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "video/Types.h"
+#include <glm/vec2.hpp>
+
+namespace render {
+
+/**
+ * @brief Scales the resolution of a render target to keep the gpu time of the frames in a budget
+ *
+ * The gpu time is measured with timer queries - the results are read a few frames later to not stall the pipeline.
+ * While the view is moving the resolution is reduced until the frames fit into the budget. Once the view was idle for
+ * a few frames the full resolution is used again.
+ *
+ * @note Without @c video::Feature::TimerQuery the full resolution is always used
+ */
+class DynamicResolution {
+public:
+	static constexpr float MinScale = 0.5f;
+	// the scale is snapped to multiples of this value to not resize the render targets in every frame
+	static constexpr float ScaleStep = 0.125f;
+	// the amount of frames without movement before the full resolution is used again
+	static constexpr int IdleFrames = 10;
+	static constexpr int Queries = 3;
+
+private:
+	video::Id _queries[Queries]{video::InvalidId, video::InvalidId, video::InvalidId};
+	// the scale the frame of the pending query was rendered with
+	float _queryScales[Queries]{0.0f, 0.0f, 0.0f};
+	bool _queryPending[Queries]{false, false, false};
+	int _currentQuery = 0;
+	bool _measuring = false;
+	// the smoothed gpu time of a frame in the full resolution - estimated from the scaled frames
+	double _fullResolutionMillis = 0.0;
+	double _lastMillis = 0.0;
+	float _scale = 1.0f;
+	int _idleFrames = IdleFrames;
+
+	void readQueries();
+
+public:
+	bool init();
+	void shutdown();
+
+	/**
+	 * @brief Starts to measure the gpu time of the following commands
+	 * @note Call @c end() after the frame was rendered
+	 */
+	void begin();
+	void end();
+
+	/**
+	 * @brief Adds the measured gpu time of a frame that was rendered with the given scale
+	 * @note This is called with the results of the timer queries - see @c begin()
+	 */
+	void addSample(double gpuMillis, float scale);
+
+	/**
+	 * @brief Computes the scale of the resolution for the current frame
+	 * @param[in] moving @c true if the view changed in this frame
+	 * @param[in] budgetMillis The gpu time a frame should take
+	 * @return The scale of the resolution - @c 1.0 is the full resolution
+	 */
+	float update(bool moving, double budgetMillis);
+
+	/**
+	 * @return The given size scaled by the current scale
+	 */
+	glm::ivec2 resolution(const glm::ivec2 &size) const;
+	float scale() const;
+	/**
+	 * @return The gpu time of the last measured frame
+	 */
+	double gpuMillis() const;
+};
+
+inline float DynamicResolution::scale() const {
+	return _scale;
+}
+
+inline double DynamicResolution::gpuMillis() const {
+	return _lastMillis;
+}
+
+} // namespace render
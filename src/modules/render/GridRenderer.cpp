@@ -11,6 +11,7 @@
 #include "math/AABB.h"
 #include "math/Plane.h"
 #include "video/Camera.h"
+#include "video/GPUTimer.h"
 #include "video/ScopedState.h"
 
 namespace render {
@@ -140,6 +141,7 @@ void GridRenderer::clear() {
 
 void GridRenderer::render(const video::Camera &camera, const math::AABB<float> &aabb) {
 	core_trace_scoped(GridRendererRender);
+	video_pass_scoped(GridRendererRender);
 
 	if (_dirty) {
 		update(aabb);
@@ -19,6 +19,7 @@ ShapeRenderer::ShapeRenderer()
 		_vertexIndex[i] = -1;
 		_indexIndex[i] = -1;
 		_primitives[i] = video::Primitive::Triangles;
+		_hashes[i] = 0u;
 	}
 }
 
@@ -32,7 +33,8 @@ bool ShapeRenderer::init() {
 		Log::error("Failed to setup color shader");
 		return false;
 	}
-	core_assert_always(_uniformBlock.create(_uniformBlockData));
+	// the block is updated for every rendered shape - e.g. the occlusion query boxes of the voxel renderer
+	core_assert_always(_uniformBlock.create(_uniformBlockData, 64));
 	core_assert_always(_colorShader.setUniformblock(_uniformBlock.getUniformblockUniformBuffer()));
 
 	return true;
@@ -49,6 +51,7 @@ bool ShapeRenderer::deleteMesh(int32_t meshIndex) {
 	_vertexIndex[meshIndex] = -1;
 	_indexIndex[meshIndex] = -1;
 	_primitives[meshIndex] = video::Primitive::Triangles;
+	_hashes[meshIndex] = 0u;
 	if (meshIndex > 0 && (uint32_t)meshIndex == _currentMeshIndex) {
 		--_currentMeshIndex;
 	}
@@ -120,6 +123,7 @@ int32_t ShapeRenderer::create(const video::ShapeBuilder &shapeBuilder) {
 	}
 
 	_primitives[meshIndex] = shapeBuilder.primitive();
+	_hashes[meshIndex] = shapeBuilder.hash();
 
 	++_currentMeshIndex;
 	return meshIndex;
@@ -130,6 +134,12 @@ void ShapeRenderer::update(uint32_t meshIndex, const video::ShapeBuilder &shapeB
 		Log::warn("Invalid mesh index given: %u", meshIndex);
 		return;
 	}
+	// most of the shapes are rebuilt every frame without any change - e.g. the selections or the scene aabbs
+	const uint32_t hash = shapeBuilder.hash();
+	if (_vertexIndex[meshIndex] != -1 && _hashes[meshIndex] == hash) {
+		return;
+	}
+	_hashes[meshIndex] = hash;
 	_vertices.clear();
 	_vertices.reserve(shapeBuilder.getVertices().size());
 	shapeBuilder.iterate(
@@ -141,6 +151,8 @@ void ShapeRenderer::update(uint32_t meshIndex, const video::ShapeBuilder &shapeB
 		verticesData = &_vertices.front();
 	}
 	video::Buffer &vbo = _vbo[meshIndex];
+	// the meshes that get updated are usually updated every frame - e.g. the gizmos
+	vbo.setMode(_vertexIndex[meshIndex], video::BufferMode::Persistent);
 	core_assert_always(vbo.update(_vertexIndex[meshIndex], verticesData, _vertices.size() * sizeof(Vertex)));
 	const video::ShapeBuilder::Indices &indices = shapeBuilder.getIndices();
 	const void *indicesData = nullptr;
@@ -36,6 +36,8 @@ private:
 	bool _hidden[MAX_MESHES] { false };
 	int32_t _indexIndex[MAX_MESHES];
 	video::Primitive _primitives[MAX_MESHES];
+	// the hash of the uploaded geometry - unchanged shapes are not uploaded again
+	uint32_t _hashes[MAX_MESHES];
 	uint32_t _currentMeshIndex = 0u;
 	alignas(16) mutable shader::ColorData::UniformblockData _uniformBlockData;
 	mutable shader::ColorData _uniformBlock;
@@ -67,6 +69,9 @@ public:
 
 	void shutdown() override;
 
+	/**
+	 * @note The upload is skipped if the geometry of the @c ShapeBuilder didn't change since the last upload
+	 */
 	void update(uint32_t meshIndex, const video::ShapeBuilder& shapeBuilder);
 
 	bool render(uint32_t meshIndex, const video::Camera& camera, const glm::mat4& model = glm::mat4(1.0f)) const;
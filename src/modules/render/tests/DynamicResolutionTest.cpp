@@ -0,0 +1,46 @@
+/**
+ * @file
+ */
+
+#include "render/DynamicResolution.h"
+#include "app/tests/AbstractTest.h"
+
+namespace render {
+
+class DynamicResolutionTest : public app::AbstractTest {};
+
+TEST_F(DynamicResolutionTest, testFullResolutionInBudget) {
+	DynamicResolution dynamicResolution;
+	dynamicResolution.addSample(4.0, 1.0f);
+	EXPECT_FLOAT_EQ(1.0f, dynamicResolution.update(true, 8.0));
+	EXPECT_EQ(glm::ivec2(640, 480), dynamicResolution.resolution(glm::ivec2(640, 480)));
+}
+
+TEST_F(DynamicResolutionTest, testScaleWhileMoving) {
+	DynamicResolution dynamicResolution;
+	// four times the budget - half of the resolution in both directions fits into the budget
+	dynamicResolution.addSample(32.0, 1.0f);
+	EXPECT_FLOAT_EQ(0.5f, dynamicResolution.update(true, 8.0));
+	EXPECT_EQ(glm::ivec2(320, 240), dynamicResolution.resolution(glm::ivec2(640, 480)));
+
+	// the samples of the scaled frames are projected to the full resolution
+	dynamicResolution.addSample(8.0, 0.5f);
+	EXPECT_FLOAT_EQ(0.5f, dynamicResolution.update(true, 8.0));
+
+	// the scale is snapped and never drops below the minimum
+	dynamicResolution.addSample(1000.0, 1.0f);
+	EXPECT_FLOAT_EQ(DynamicResolution::MinScale, dynamicResolution.update(true, 8.0));
+}
+
+TEST_F(DynamicResolutionTest, testFullResolutionWhenIdle) {
+	DynamicResolution dynamicResolution;
+	dynamicResolution.addSample(32.0, 1.0f);
+	EXPECT_FLOAT_EQ(0.5f, dynamicResolution.update(true, 8.0));
+	for (int i = 0; i < DynamicResolution::IdleFrames - 1; ++i) {
+		EXPECT_FLOAT_EQ(0.5f, dynamicResolution.update(false, 8.0));
+	}
+	EXPECT_FLOAT_EQ(1.0f, dynamicResolution.update(false, 8.0));
+	EXPECT_FLOAT_EQ(0.5f, dynamicResolution.update(true, 8.0));
+}
+
+} // namespace render
@@ -0,0 +1,48 @@
+/**
+ * @file
+ */
+
+#include "video/ProgramCache.h"
+#include "ColorShader.h"
+#include "io/MemoryArchive.h"
+#include "video/tests/AbstractGLTest.h"
+
+namespace render {
+
+class ProgramCacheTest : public video::AbstractGLTest {
+protected:
+	void TearDown() override {
+		core::Singleton<video::ShaderManager>::getInstance().setProgramCache({});
+		video::AbstractGLTest::TearDown();
+	}
+};
+
+TEST_F(ProgramCacheTest, testKey) {
+	video::ProgramCache::Sources sources;
+	sources[(int)video::ShaderType::Vertex] = "void main() {}";
+	const uint64_t key = video::ProgramCache::key("driver", sources);
+	EXPECT_EQ(key, video::ProgramCache::key("driver", sources));
+	EXPECT_NE(key, video::ProgramCache::key("other driver", sources));
+	video::ProgramCache::Sources fragment;
+	fragment[(int)video::ShaderType::Fragment] = sources[(int)video::ShaderType::Vertex];
+	EXPECT_NE(key, video::ProgramCache::key("driver", fragment));
+}
+
+TEST_F(ProgramCacheTest, testLoadFromCache) {
+	if (!video::hasFeature(video::Feature::ProgramBinary)) {
+		GTEST_SKIP() << "No program binary support";
+	}
+	core::Singleton<video::ShaderManager>::getInstance().setProgramCache(io::openMemoryArchive());
+	shader::ColorShader shader;
+	ASSERT_TRUE(shader.setup());
+	EXPECT_NE(video::InvalidId, shader.getShader(video::ShaderType::Vertex));
+	shader.shutdown();
+
+	// the program is loaded from the cache - the shaders are not compiled again
+	ASSERT_TRUE(shader.setup());
+	EXPECT_EQ(video::InvalidId, shader.getShader(video::ShaderType::Vertex));
+	EXPECT_TRUE(shader.hasUniform("u_uniformblock"));
+	shader.shutdown();
+}
+
+} // namespace render
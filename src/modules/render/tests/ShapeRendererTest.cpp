@@ -0,0 +1,63 @@
+/**
+ * @file
+ */
+
+#include "render/ShapeRenderer.h"
+#include "video/Camera.h"
+#include "video/ShapeBuilder.h"
+#include "video/tests/AbstractGLTest.h"
+
+namespace render {
+
+class ShapeRendererTest : public video::AbstractGLTest {};
+
+TEST_F(ShapeRendererTest, testUpdate) {
+	ShapeRenderer renderer;
+	ASSERT_TRUE(renderer.init());
+	video::ShapeBuilder builder;
+	builder.setColor(glm::vec4(1.0f));
+	builder.cube(glm::vec3(0.0f), glm::vec3(1.0f));
+	const int32_t meshIndex = renderer.create(builder);
+	ASSERT_NE(-1, meshIndex);
+
+	video::Camera camera;
+	camera.setSize(glm::ivec2(640, 480));
+	camera.update(0.0);
+	// the updated meshes are streamed through the regions of the persistent mapped buffers - more updates than
+	// regions and a growing mesh have to reuse and reallocate them
+	for (int i = 0; i < 8; ++i) {
+		builder.clear();
+		builder.setColor(glm::vec4(1.0f));
+		for (int j = 0; j <= i * i; ++j) {
+			builder.cube(glm::vec3((float)j), glm::vec3((float)j + 1.0f));
+		}
+		renderer.update(meshIndex, builder);
+		EXPECT_TRUE(renderer.render(meshIndex, camera));
+	}
+	renderer.shutdown();
+}
+
+TEST_F(ShapeRendererTest, testUpdateUnchanged) {
+	ShapeRenderer renderer;
+	ASSERT_TRUE(renderer.init());
+	video::ShapeBuilder builder;
+	builder.setColor(glm::vec4(1.0f));
+	builder.aabb(glm::vec3(0.0f), glm::vec3(1.0f));
+	int32_t meshIndex = -1;
+	renderer.createOrUpdate(meshIndex, builder);
+	ASSERT_NE(-1, meshIndex);
+
+	video::Camera camera;
+	camera.setSize(glm::ivec2(640, 480));
+	camera.update(0.0);
+	// the unchanged shape is not uploaded again - but still rendered
+	for (int i = 0; i < 4; ++i) {
+		builder.clear();
+		builder.aabb(glm::vec3(0.0f), glm::vec3(1.0f));
+		renderer.createOrUpdate(meshIndex, builder);
+		EXPECT_TRUE(renderer.render(meshIndex, camera));
+	}
+	renderer.shutdown();
+}
+
+}
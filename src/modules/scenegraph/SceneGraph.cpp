@@ -4,18 +4,25 @@
 
 #include "SceneGraph.h"
 #include "SceneUtil.h"
+#include "app/App.h"
+#include "app/Async.h"
 #include "core/Algorithm.h"
+#include "core/ArrayLength.h"
 #include "core/Common.h"
 #include "core/Log.h"
 #include "core/StandardLib.h"
 #include "core/StringUtil.h"
+#include "core/Trace.h"
 #include "core/collection/DynamicArray.h"
+#include "core/concurrent/Parallel.h"
 #include "palette/Palette.h"
+#include "palette/PaletteRegistry.h"
 #include "scenegraph/FrameTransform.h"
 #include "scenegraph/SceneGraphAnimation.h"
 #include "scenegraph/SceneGraphKeyFrame.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "scenegraph/SceneGraphUtil.h"
+#include "voxel/CompressedVolume.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Region.h"
@@ -51,6 +58,7 @@ SceneGraph::SceneGraph(int nodes) : _nodes(nodes), _activeAnimation(DEFAULT_ANIM
 }
 
 SceneGraph::~SceneGraph() {
+	discardCompressedVolumes();
 	for (const auto &entry : _nodes) {
 		entry->value.release();
 	}
@@ -59,17 +67,40 @@ SceneGraph::~SceneGraph() {
 }
 
 SceneGraph::SceneGraph(SceneGraph &&other) noexcept
-	: _nodes(core::move(other._nodes)), _nextNodeId(other._nextNodeId), _activeNodeId(other._activeNodeId),
+	: _nodes(core::move(other._nodes)), _uuidIndex(core::move(other._uuidIndex)),
+	  _nameIndex(core::move(other._nameIndex)), _nextNodeId(other._nextNodeId), _activeNodeId(other._activeNodeId),
 	  _animations(core::move(other._animations)), _activeAnimation(core::move(other._activeAnimation)),
-	  _cachedMaxFrame(other._cachedMaxFrame) {
+	  _cachedMaxFrame(other._cachedMaxFrame), _dirtyTransformNodes(core::move(other._dirtyTransformNodes)),
+	  _allTransformsDirty(other._allTransformsDirty),
+	  _pendingCompressions(core::move(other._pendingCompressions)) {
 	other._nextNodeId = 0;
+	other._allTransformsDirty = true;
+	other.invalidateBakedTransforms();
+	other.clearSpatialIndex();
 	other._activeNodeId = InvalidNodeId;
+	for (int i = 0; i < (int)lengthof(_typeIndex); ++i) {
+		_typeIndex[i] = core::move(other._typeIndex[i]);
+	}
+	for (const auto &entry : _nodes) {
+		entry->value._sceneGraph = this;
+	}
 	_dirty = other.dirty();
 }
 
 SceneGraph &SceneGraph::operator=(SceneGraph &&other) noexcept {
 	if (this != &other) {
+		// the node ids of the pending compressions belong to the old nodes
+		discardCompressedVolumes();
+		_pendingCompressions = core::move(other._pendingCompressions);
 		_nodes = core::move(other._nodes);
+		_uuidIndex = core::move(other._uuidIndex);
+		_nameIndex = core::move(other._nameIndex);
+		for (int i = 0; i < (int)lengthof(_typeIndex); ++i) {
+			_typeIndex[i] = core::move(other._typeIndex[i]);
+		}
+		for (const auto &entry : _nodes) {
+			entry->value._sceneGraph = this;
+		}
 		_nextNodeId = other._nextNodeId;
 		other._nextNodeId = 0;
 		_activeNodeId = other._activeNodeId;
@@ -77,11 +108,24 @@ SceneGraph &SceneGraph::operator=(SceneGraph &&other) noexcept {
 		_animations = core::move(other._animations);
 		_activeAnimation = core::move(other._activeAnimation);
 		_cachedMaxFrame = other._cachedMaxFrame;
+		_dirtyTransformNodes = core::move(other._dirtyTransformNodes);
+		_allTransformsDirty = other._allTransformsDirty;
+		other._allTransformsDirty = true;
+		invalidateBakedTransforms();
+		other.invalidateBakedTransforms();
+		clearSpatialIndex();
+		other.clearSpatialIndex();
 		_dirty = other.dirty();
 	}
 	return *this;
 }
 
+void SceneGraph::onVolumeLoaded(int nodeId) {
+	for (SceneGraphListener *listener : _listeners) {
+		listener->onNodeVolumeLoaded(nodeId);
+	}
+}
+
 void SceneGraph::registerListener(SceneGraphListener *listener) {
 	for (SceneGraphListener *l : _listeners) {
 		if (l == listener) {
@@ -192,6 +236,7 @@ bool SceneGraph::removeAnimation(const core::String &animation) {
 		return false;
 	}
 	_animations.erase(iter);
+	_bakedTransforms.remove(animation);
 	for (const auto &entry : _nodes) {
 		entry->value.removeAnimation(animation);
 	}
@@ -224,6 +269,8 @@ const core::String &SceneGraph::activeAnimation() const {
 
 void SceneGraph::markMaxFramesDirty() {
 	_cachedMaxFrame = -1;
+	// the key frames were moved
+	invalidateBakedTransforms();
 }
 
 FrameIndex SceneGraph::maxFrames() const {
@@ -268,7 +315,7 @@ palette::Palette &SceneGraph::firstPalette() const {
 	return node->palette();
 }
 
-const core::String &SceneGraph::uuid(int nodeId) const {
+const core::UUID &SceneGraph::uuid(int nodeId) const {
 	auto iter = _nodes.find(nodeId);
 	if (iter == _nodes.end()) {
 		return _emptyUUID;
@@ -391,8 +438,42 @@ FrameTransform SceneGraph::transformForFrame(const SceneGraphNode &node, FrameIn
 	return transformForFrame(node, _activeAnimation, frameIdx);
 }
 
+// the key frames must be sorted by their frame
+static glm::mat4 localMatrixForFrame(const SceneGraphKeyFrames &kfs, FrameIndex frameIdx) {
+	const KeyFrameIndex n = (KeyFrameIndex)kfs.size();
+	core_assert(n > 0);
+	if (n == 1) {
+		return kfs[0].transform().localMatrix();
+	}
+	const KeyFrameIndex end = lowerBoundKeyFrame(kfs, frameIdx);
+	if (end == n) {
+		return kfs[n - 1].transform().localMatrix();
+	}
+	if (end == 0 || kfs[end].frameIdx == frameIdx) {
+		return kfs[end].transform().localMatrix();
+	}
+	const SceneGraphKeyFrame &source = kfs[end - 1];
+	const SceneGraphKeyFrame &target = kfs[end];
+	const InterpolationType interpolationType = source.interpolation;
+	const double deltaFrame = scenegraph::interpolate(interpolationType, (double)frameIdx, (double)source.frameIdx, (double)target.frameIdx);
+	const float lerpFactor = glm::clamp((float)(deltaFrame - (double)source.frameIdx), 0.0f, 1.0f);
+
+	const glm::vec3 translation = glm::mix(source.transform().localTranslation(), target.transform().localTranslation(), lerpFactor);
+	const glm::quat orientation = glm::slerp(source.transform().localOrientation(), target.transform().localOrientation(), lerpFactor);
+	const glm::vec3 scale = glm::mix(source.transform().localScale(), target.transform().localScale(), lerpFactor);
+	return glm::translate(translation) * glm::mat4_cast(orientation) * glm::scale(scale);
+}
+
 FrameTransform SceneGraph::transformForFrame(const SceneGraphNode &node, const core::String &animation,
 											 FrameIndex frameIdx) const {
+	if (!_bakedTransforms.empty()) {
+		auto iter = _bakedTransforms.find(animation);
+		if (iter != _bakedTransforms.end()) {
+			if (const FrameTransform *baked = iter->value.transform(node.id(), frameIdx)) {
+				return *baked;
+			}
+		}
+	}
 	// TODO: SCENEGRAPH: ik solver https://github.com/vengi-voxel/vengi/issues/182
 	// and https://github.com/vengi-voxel/vengi/issues/265
 	// TODO: SCENEGRAPH: solve flipping of child transforms if parent has rotation applied - see
@@ -404,39 +485,91 @@ FrameTransform SceneGraph::transformForFrame(const SceneGraphNode &node, const c
 		parentTransform = transformForFrame(this->node(node.parent()), animation, frameIdx);
 	}
 
+	const SceneGraphKeyFrames &kfs = animation == _activeAnimation ? node.keyFrames() : node.keyFrames(animation);
 	FrameTransform transform;
-	KeyFrameIndex keyFrameIdx = InvalidKeyFrame;
-	if (node.keyFrames().size() == 1) {
-		const SceneGraphKeyFrame *kf = node.keyFrame(0);
-		transform.matrix = parentTransform.matrix * kf->transform().localMatrix();
-	} else if (node.hasKeyFrameForFrame(frameIdx, &keyFrameIdx)) {
-		const SceneGraphKeyFrame *kf = node.keyFrame(keyFrameIdx);
-		transform.matrix = parentTransform.matrix * kf->transform().localMatrix();
-	} else {
-		const KeyFrameIndex start = node.previousKeyFrameForFrame(frameIdx);
-		const KeyFrameIndex end = node.nextKeyFrameForFrame(frameIdx);
-		if (start == end) {
-			const SceneGraphKeyFrame *kf = node.keyFrame(start);
-			transform.matrix = parentTransform.matrix * kf->transform().localMatrix();
+	transform.matrix = parentTransform.matrix * localMatrixForFrame(kfs, frameIdx);
+	return transform;
+}
+
+void SceneGraph::bakeTransforms_r(const SceneGraphNode &node, const core::String &animation, BakedTransforms &baked,
+								  int parentId) const {
+	const SceneGraphKeyFrames &kfs = animation == _activeAnimation ? node.keyFrames() : node.keyFrames(animation);
+	const size_t frames = (size_t)baked.maxFrame + 1u;
+	FrameTransform *transforms = &baked.transforms[(size_t)node.id() * frames];
+	const FrameTransform *parentTransforms = nullptr;
+	if (parentId != InvalidNodeId) {
+		parentTransforms = &baked.transforms[(size_t)parentId * frames];
+	}
+	for (FrameIndex frameIdx = 0; frameIdx <= baked.maxFrame; ++frameIdx) {
+		const glm::mat4 &localMatrix = localMatrixForFrame(kfs, frameIdx);
+		if (parentTransforms == nullptr) {
+			transforms[frameIdx].matrix = localMatrix;
 		} else {
-			const SceneGraphKeyFrame *source = node.keyFrame(start);
-			const SceneGraphKeyFrame *target = node.keyFrame(end);
-			core_assert_always(source && target);
-			const InterpolationType interpolationType = source->interpolation;
-			const double deltaFrame = scenegraph::interpolate(interpolationType, (double)frameIdx, (double)source->frameIdx, (double)target->frameIdx);
-			const float lerpFactor = glm::clamp((float)(deltaFrame - (double)source->frameIdx), 0.0f, 1.0f);
+			transforms[frameIdx].matrix = parentTransforms[frameIdx].matrix * localMatrix;
+		}
+	}
+	for (int childId : node.children()) {
+		bakeTransforms_r(this->node(childId), animation, baked, node.id());
+	}
+}
 
-			const glm::vec3 translation = glm::mix(source->transform().localTranslation(), target->transform().localTranslation(), lerpFactor);
-			const glm::quat orientation = glm::slerp(source->transform().localOrientation(), target->transform().localOrientation(), lerpFactor);
-			const glm::vec3 scale = glm::mix(source->transform().localScale(), target->transform().localScale(), lerpFactor);
-			transform.matrix = parentTransform.matrix * (glm::translate(translation) * glm::mat4_cast(orientation) * glm::scale(scale));
+bool SceneGraph::bakeTransforms(const core::String &animation) const {
+	core_trace_scoped(BakeTransforms);
+	if (_bakedTransforms.hasKey(animation)) {
+		return true;
+	}
+	if (!hasAnimation(animation)) {
+		return false;
+	}
+	BakedTransforms baked;
+	baked.nodes = _nextNodeId;
+	baked.maxFrame = 0;
+	for (const auto &entry : _nodes) {
+		const SceneGraphNode &node = entry->value;
+		const SceneGraphKeyFrames &kfs = animation == _activeAnimation ? node.keyFrames() : node.keyFrames(animation);
+		if (!kfs.empty()) {
+			baked.maxFrame = core_max(baked.maxFrame, kfs.back().frameIdx);
 		}
 	}
-	return transform;
+	const size_t entries = (size_t)baked.nodes * ((size_t)baked.maxFrame + 1u);
+	// 64 bytes per transform - don't use more than 64MB
+	if (entries > 1024u * 1024u) {
+		Log::debug("Don't bake animation %s with %i nodes and %i frames", animation.c_str(), baked.nodes,
+				   baked.maxFrame + 1);
+		return false;
+	}
+	baked.transforms.resize(entries);
+	bakeTransforms_r(root(), animation, baked, InvalidNodeId);
+	_bakedTransforms.emplace(animation, core::move(baked));
+	return true;
+}
+
+void SceneGraph::invalidateBakedTransforms() const {
+	if (!_bakedTransforms.empty()) {
+		_bakedTransforms.clear();
+	}
+}
+
+void SceneGraph::markTransformsDirty(int nodeId) {
+	invalidateBakedTransforms();
+	markBoundsDirty(nodeId);
+	if (_allTransformsDirty) {
+		return;
+	}
+	if (nodeId == 0 || _dirtyTransformNodes.size() >= _nodes.size()) {
+		_allTransformsDirty = true;
+		_dirtyTransformNodes.clear();
+		return;
+	}
+	if (!_dirtyTransformNodes.empty() && _dirtyTransformNodes.back() == nodeId) {
+		return;
+	}
+	_dirtyTransformNodes.push_back(nodeId);
 }
 
 void SceneGraph::updateTransforms_r(SceneGraphNode &n) {
-	for (SceneGraphKeyFrame &keyframe : *n.keyFrames()) {
+	// don't use the non-const accessor here - it would mark the node as modified again
+	for (SceneGraphKeyFrame &keyframe : *n._keyFrames) {
 		keyframe.transform().update(*this, n, keyframe.frameIdx, true);
 	}
 	for (int childrenId : n.children()) {
@@ -445,12 +578,161 @@ void SceneGraph::updateTransforms_r(SceneGraphNode &n) {
 }
 
 void SceneGraph::updateTransforms() {
-	const core::String animId = _activeAnimation;
-	for (const core::String &animation : animations()) {
-		core_assert_always(setAnimation(animation));
-		updateTransforms_r(node(0));
+	core_trace_scoped(UpdateTransforms);
+	invalidateBakedTransforms();
+	core::DynamicArray<int> roots;
+	if (_allTransformsDirty) {
+		roots.push_back(0);
+	} else {
+		// only visit the subtrees of the modified nodes - and each subtree only once
+		core::DynamicArray<int> dirtyNodes = core::move(_dirtyTransformNodes);
+		dirtyNodes.sort([](int a, int b) { return a > b; });
+		for (size_t i = 0; i < dirtyNodes.size(); ++i) {
+			const int nodeId = dirtyNodes[i];
+			if ((i > 0 && dirtyNodes[i - 1] == nodeId) || !hasNode(nodeId)) {
+				continue;
+			}
+			bool dirtyParent = false;
+			for (int parentId = node(nodeId).parent(); parentId != InvalidNodeId; parentId = node(parentId).parent()) {
+				const size_t index = lowerBound(dirtyNodes, parentId);
+				if (index < dirtyNodes.size() && dirtyNodes[index] == parentId) {
+					dirtyParent = true;
+					break;
+				}
+			}
+			if (!dirtyParent) {
+				roots.push_back(nodeId);
+			}
+		}
+	}
+	if (!roots.empty()) {
+		const core::String animId = _activeAnimation;
+		for (const core::String &animation : animations()) {
+			core_assert_always(setAnimation(animation));
+			for (int nodeId : roots) {
+				updateTransforms_r(node(nodeId));
+			}
+		}
+		core_assert_always(setAnimation(animId));
 	}
-	core_assert_always(setAnimation(animId));
+	// the update itself marks the nodes it touches
+	_dirtyTransformNodes.clear();
+	_allTransformsDirty = false;
+}
+
+void SceneGraph::markBoundsDirty(int nodeId) {
+	if (_allBoundsDirty) {
+		return;
+	}
+	if (nodeId == 0 || _dirtyBoundsNodes.size() >= _nodes.size()) {
+		_allBoundsDirty = true;
+		_dirtyBoundsNodes.clear();
+		return;
+	}
+	if (!_dirtyBoundsNodes.empty() && _dirtyBoundsNodes.back() == nodeId) {
+		return;
+	}
+	_dirtyBoundsNodes.push_back(nodeId);
+	if (!hasNode(nodeId) || !node(nodeId).isModelNode()) {
+		return;
+	}
+	// the references are using the region of the referenced node
+	for (int referenceId : _typeIndex[(int)SceneGraphNodeType::ModelReference]) {
+		if (node(referenceId).reference() == nodeId) {
+			markBoundsDirty(referenceId);
+		}
+	}
+}
+
+void SceneGraph::clearSpatialIndex() const {
+	_spatialIndex.clear();
+	_spatialIndexProxies.clear();
+	_dirtyBoundsNodes.clear();
+	_allBoundsDirty = true;
+}
+
+void SceneGraph::removeNodeBounds(int nodeId) const {
+	if (nodeId < 0 || nodeId >= (int)_spatialIndexProxies.size()) {
+		return;
+	}
+	const int proxy = _spatialIndexProxies[nodeId];
+	if (proxy != math::AABBTree::InvalidProxy) {
+		_spatialIndex.remove(proxy);
+		_spatialIndexProxies[nodeId] = math::AABBTree::InvalidProxy;
+	}
+}
+
+void SceneGraph::updateNodeBounds(const SceneGraphNode &n, FrameIndex frameIdx) const {
+	const bool validReference = !n.isReferenceNode() || hasNode(n.reference());
+	if (!n.isAnyModelNode() || !validReference) {
+		removeNodeBounds(n.id());
+		return;
+	}
+	const voxel::Region &region = resolveRegion(n);
+	if (!region.isValid()) {
+		removeNodeBounds(n.id());
+		return;
+	}
+	const FrameTransform &transform = transformForFrame(n, frameIdx);
+	const math::AABB<float> &aabb = toAABB(toOBB(true, region, n.pivot(), transform));
+	while ((int)_spatialIndexProxies.size() <= n.id()) {
+		_spatialIndexProxies.push_back(math::AABBTree::InvalidProxy);
+	}
+	int &proxy = _spatialIndexProxies[n.id()];
+	if (proxy == math::AABBTree::InvalidProxy) {
+		proxy = _spatialIndex.insert(aabb, n.id());
+	} else {
+		_spatialIndex.update(proxy, aabb);
+	}
+}
+
+void SceneGraph::updateNodeBounds_r(const SceneGraphNode &n, FrameIndex frameIdx) const {
+	updateNodeBounds(n, frameIdx);
+	for (int childId : n.children()) {
+		updateNodeBounds_r(node(childId), frameIdx);
+	}
+}
+
+void SceneGraph::updateSpatialIndex(FrameIndex frameIdx) const {
+	if (_spatialIndexFrame != frameIdx || _spatialIndexAnimation != _activeAnimation) {
+		// the entries are only re-inserted if their bounds moved out of the enlarged bounds
+		_spatialIndexFrame = frameIdx;
+		_spatialIndexAnimation = _activeAnimation;
+		_allBoundsDirty = true;
+	}
+	if (!_allBoundsDirty && _dirtyBoundsNodes.empty()) {
+		return;
+	}
+	core_trace_scoped(UpdateSpatialIndex);
+	if (_allBoundsDirty) {
+		updateNodeBounds_r(root(), frameIdx);
+	} else {
+		for (int nodeId : _dirtyBoundsNodes) {
+			if (hasNode(nodeId)) {
+				updateNodeBounds_r(node(nodeId), frameIdx);
+			}
+		}
+	}
+	_dirtyBoundsNodes.clear();
+	_allBoundsDirty = false;
+}
+
+void SceneGraph::nodesInRegion(const math::AABB<float> &area, FrameIndex frameIdx,
+							   core::DynamicArray<int> &nodeIds) const {
+	updateSpatialIndex(frameIdx);
+	_spatialIndex.query(area, [&](int nodeId) {
+		nodeIds.push_back(nodeId);
+		return true;
+	});
+}
+
+void SceneGraph::nodesInFrustum(const math::Frustum &frustum, FrameIndex frameIdx,
+								core::DynamicArray<int> &nodeIds) const {
+	updateSpatialIndex(frameIdx);
+	_spatialIndex.query(frustum, [&](int nodeId) {
+		nodeIds.push_back(nodeId);
+		return true;
+	});
 }
 
 voxel::Region SceneGraph::calcRegion() const {
@@ -532,33 +814,132 @@ SceneGraphNode *SceneGraph::findNodeByPropertyValue(const core::String &key, con
 }
 
 SceneGraphNode *SceneGraph::findNodeByName(const core::String &name) {
-	for (const auto &entry : _nodes) {
-		Log::trace("node name: %s", entry->value.name().c_str());
-		if (entry->value.name() == name) {
-			return &entry->value;
+	auto iter = _nameIndex.find(name);
+	if (iter == _nameIndex.end()) {
+		return nullptr;
+	}
+	// if there are several nodes with the same name, the one that was added first is returned
+	int nodeId = InvalidNodeId;
+	for (int id : iter->value) {
+		if (nodeId == InvalidNodeId || id < nodeId) {
+			nodeId = id;
 		}
 	}
-	return nullptr;
+	auto nodeIter = _nodes.find(nodeId);
+	if (nodeIter == _nodes.end()) {
+		return nullptr;
+	}
+	return &nodeIter->value;
 }
 
-SceneGraphNode *SceneGraph::findNodeByUUID(const core::String &uuid) {
-	for (const auto &entry : _nodes) {
-		Log::trace("node uuid: %s", entry->value.uuid().c_str());
-		if (entry->value.uuid() == uuid) {
-			return &entry->value;
-		}
+SceneGraphNode *SceneGraph::findNodeByUUID(const core::UUID &uuid) {
+	int nodeId;
+	if (!_uuidIndex.get(uuid, nodeId)) {
+		return nullptr;
 	}
-	return nullptr;
+	auto iter = _nodes.find(nodeId);
+	if (iter == _nodes.end()) {
+		return nullptr;
+	}
+	return &iter->value;
 }
 
 const SceneGraphNode *SceneGraph::findNodeByName(const core::String &name) const {
-	for (const auto &entry : _nodes) {
-		Log::trace("node name: %s", entry->value.name().c_str());
-		if (entry->value.name() == name) {
-			return &entry->value;
+	return const_cast<SceneGraph *>(this)->findNodeByName(name);
+}
+
+size_t SceneGraph::lowerBound(const core::DynamicArray<int> &ids, int nodeId) {
+	size_t first = 0u;
+	size_t count = ids.size();
+	while (count > 0u) {
+		const size_t step = count / 2u;
+		if (ids[first + step] < nodeId) {
+			first += step + 1u;
+			count -= step + 1u;
+		} else {
+			count = step;
 		}
 	}
-	return nullptr;
+	return first;
+}
+
+void SceneGraph::addToTypeIndex(core::DynamicArray<int> &ids, int nodeId) {
+	// the ids are increasing - so this is usually an append
+	if (ids.empty() || ids.back() < nodeId) {
+		ids.push_back(nodeId);
+		return;
+	}
+	const size_t index = lowerBound(ids, nodeId);
+	if (index < ids.size() && ids[index] == nodeId) {
+		return;
+	}
+	ids.insert(ids.begin() + index, &nodeId, 1);
+}
+
+void SceneGraph::removeFromTypeIndex(core::DynamicArray<int> &ids, int nodeId) {
+	const size_t index = lowerBound(ids, nodeId);
+	if (index < ids.size() && ids[index] == nodeId) {
+		ids.erase(index);
+	}
+}
+
+void SceneGraph::indexNode(SceneGraphNode &node) {
+	node._sceneGraph = this;
+	markTransformsDirty(node.id());
+	addToTypeIndex(_typeIndex[(int)node.type()], node.id());
+	if (node.isAnyModelNode()) {
+		addToTypeIndex(_typeIndex[(int)SceneGraphNodeType::AllModels], node.id());
+	}
+	addToTypeIndex(_typeIndex[(int)SceneGraphNodeType::All], node.id());
+	_uuidIndex.put(node.uuid(), node.id());
+	auto iter = _nameIndex.find(node.name());
+	if (iter == _nameIndex.end()) {
+		core::DynamicArray<int> ids;
+		ids.push_back(node.id());
+		_nameIndex.emplace(node.name(), core::move(ids));
+	} else {
+		iter->value.push_back(node.id());
+	}
+}
+
+void SceneGraph::removeFromNameIndex(const core::String &name, int nodeId) {
+	auto iter = _nameIndex.find(name);
+	if (iter == _nameIndex.end()) {
+		return;
+	}
+	core::DynamicArray<int> &ids = iter->value;
+	for (size_t i = 0; i < ids.size(); ++i) {
+		if (ids[i] == nodeId) {
+			ids.erase(i);
+			break;
+		}
+	}
+	if (ids.empty()) {
+		_nameIndex.erase(iter);
+	}
+}
+
+void SceneGraph::unindexNode(const SceneGraphNode &node) {
+	removeFromTypeIndex(_typeIndex[(int)node.type()], node.id());
+	removeFromTypeIndex(_typeIndex[(int)SceneGraphNodeType::AllModels], node.id());
+	removeFromTypeIndex(_typeIndex[(int)SceneGraphNodeType::All], node.id());
+	_uuidIndex.remove(node.uuid());
+	removeFromNameIndex(node.name(), node.id());
+}
+
+void SceneGraph::updateNameIndex(const SceneGraphNode &node, const core::String &newName) {
+	if (node.name() == newName) {
+		return;
+	}
+	removeFromNameIndex(node.name(), node.id());
+	auto iter = _nameIndex.find(newName);
+	if (iter == _nameIndex.end()) {
+		core::DynamicArray<int> ids;
+		ids.push_back(node.id());
+		_nameIndex.emplace(newName, core::move(ids));
+	} else {
+		iter->value.push_back(node.id());
+	}
 }
 
 SceneGraphNode *SceneGraph::first() {
@@ -591,7 +972,7 @@ int SceneGraph::emplace(SceneGraphNode &&node, int parent) {
 	}
 
 	if (findNodeByUUID(node.uuid()) != nullptr) {
-		Log::error("Node with UUID %s already exists in the scene graph", node.uuid().c_str());
+		Log::error("Node with UUID %s already exists in the scene graph", node.uuid().str().c_str());
 		node.release();
 		return InvalidNodeId;
 	}
@@ -622,9 +1003,11 @@ int SceneGraph::emplace(SceneGraphNode &&node, int parent) {
 	Log::debug("Adding scene graph node of type %i with id %i and parent %i", (int)type, node.id(),
 			   node.parent());
 	_nodes.emplace(nodeId, core::forward<SceneGraphNode>(node));
+	indexNode(this->node(nodeId));
 	if (type == SceneGraphNodeType::Model) {
 		_regionDirty = true;
 	}
+	markBoundsDirty(nodeId);
 	for (SceneGraphListener *listener : _listeners) {
 		listener->onNodeAdded(nodeId);
 	}
@@ -674,6 +1057,7 @@ bool SceneGraph::changeParent(int nodeId, int newParentId, bool updateTransform)
 		return false;
 	}
 	n.setParent(newParentId);
+	markTransformsDirty(nodeId);
 	if (updateTransform) {
 		for (const core::String &animation : animations()) {
 			for (SceneGraphKeyFrame &keyframe : n.keyFrames(animation)) {
@@ -720,12 +1104,19 @@ bool SceneGraph::removeNode(int nodeId, bool recursive) {
 			core_assert(cnode.parent() == nodeId);
 			cnode.setParent(parent);
 			core_assert_always(parentNode.addChild(childId));
+			markTransformsDirty(childId);
 		}
 	}
 	for (SceneGraphListener *listener : _listeners) {
 		listener->onNodeRemove(nodeId);
 	}
+	unindexNode(iter->value);
+	// the references to this node must be updated, too
+	markBoundsDirty(nodeId);
+	removeNodeBounds(nodeId);
+	iter->value._sceneGraph = nullptr;
 	core_assert_always(_nodes.erase(iter));
+	invalidateBakedTransforms();
 	if (_activeNodeId == nodeId) {
 		if (!empty(SceneGraphNodeType::Model)) {
 			// get the first model node
@@ -756,37 +1147,127 @@ void SceneGraph::reserve(size_t size) {
 }
 
 bool SceneGraph::empty(SceneGraphNodeType type) const {
-	for (const auto &entry : _nodes) {
-		if (entry->value.type() == type) {
-			return false;
-		}
-	}
-	return true;
+	return size(type) == 0u;
 }
 
 size_t SceneGraph::size(SceneGraphNodeType type) const {
 	if (type == SceneGraphNodeType::All) {
 		return _nodes.size();
 	}
-	size_t n = 0;
+	if (type == SceneGraphNodeType::Max) {
+		return 0u;
+	}
+	return _typeIndex[(int)type].size();
+}
+
+int SceneGraph::compressInactiveNodes(uint64_t nowMillis, uint64_t inactiveMillis, bool wait) {
+	core_trace_scoped(CompressInactiveNodes);
+	// the compressions that are started by this call are only applied with the next call - unless we wait for them
+	int compressed = applyCompressedVolumes(nowMillis, false);
 	for (const auto &entry : _nodes) {
-		if (entry->value.type() == type) {
-			++n;
-		} else if (type == SceneGraphNodeType::AllModels) {
-			if (entry->value.isAnyModelNode()) {
-				++n;
-			}
+		SceneGraphNode &node = entry->value;
+		if (!node.isModelNode() || node.isVolumeCompressed() || !node.owns()) {
+			continue;
 		}
+		if (node.consumeVolumeAccess() || node.id() == _activeNodeId) {
+			node.setVolumeAccessMillis(nowMillis);
+			continue;
+		}
+		if (nowMillis - node.volumeAccessMillis() < inactiveMillis) {
+			continue;
+		}
+		if (isCompressing(node.id())) {
+			continue;
+		}
+		// don't use volume() here - this would mark the volume as accessed
+		const voxel::RawVolume *source = node._volume;
+		// the modifications of the node volume detach it from the copy the worker is reading
+		voxel::RawVolume *copy = voxel::RawVolume::createShared(*source);
+		PendingCompression pending;
+		pending.nodeId = node.id();
+		pending.source = source;
+		pending.version = source->version();
+		pending.compressed = app::async([copy]() {
+			voxel::CompressedVolume *compressed = new voxel::CompressedVolume(*copy);
+			delete copy;
+			return compressed;
+		});
+		_pendingCompressions.emplace_back(core::move(pending));
+	}
+	if (wait) {
+		compressed += applyCompressedVolumes(nowMillis, true);
+	}
+	if (compressed > 0) {
+		Log::debug("Compressed %i inactive nodes", compressed);
+	}
+	return compressed;
+}
+
+bool SceneGraph::isCompressing(int nodeId) const {
+	for (const PendingCompression &pending : _pendingCompressions) {
+		if (pending.nodeId == nodeId) {
+			return true;
+		}
+	}
+	return false;
+}
+
+int SceneGraph::applyCompressedVolumes(uint64_t nowMillis, bool wait) {
+	int compressed = 0;
+	core::DynamicArray<PendingCompression> running;
+	for (PendingCompression &pending : _pendingCompressions) {
+		if (!wait && pending.compressed.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			running.emplace_back(core::move(pending));
+			continue;
+		}
+		voxel::CompressedVolume *volume = pending.compressed.get();
+		if (!hasNode(pending.nodeId)) {
+			delete volume;
+			continue;
+		}
+		SceneGraphNode &node = this->node(pending.nodeId);
+		if (node._volume != pending.source || node._volume->version() != pending.version) {
+			delete volume;
+			continue;
+		}
+		if (node.consumeVolumeAccess() || node.id() == _activeNodeId) {
+			node.setVolumeAccessMillis(nowMillis);
+			delete volume;
+			continue;
+		}
+		if (node.setCompressedVolume(volume)) {
+			++compressed;
+		}
+	}
+	_pendingCompressions = core::move(running);
+	return compressed;
+}
+
+void SceneGraph::discardCompressedVolumes() {
+	for (PendingCompression &pending : _pendingCompressions) {
+		delete pending.compressed.get();
 	}
-	return n;
+	_pendingCompressions.clear();
 }
 
 void SceneGraph::clear() {
+	discardCompressedVolumes();
 	for (const auto &entry : _nodes) {
 		entry->value.release();
 	}
 	_nodes.clear();
+	// the palettes of the removed nodes are no longer needed
+	palette::PaletteRegistry::prune();
+	_uuidIndex.clear();
+	_nameIndex.clear();
+	for (core::DynamicArray<int> &ids : _typeIndex) {
+		ids.clear();
+	}
 	_animations.clear();
+	invalidateBakedTransforms();
+	_dirtyTransformNodes.clear();
+	_allTransformsDirty = true;
+	clearSpatialIndex();
 	addAnimation(DEFAULT_ANIMATION);
 	setAnimation(DEFAULT_ANIMATION);
 	_nextNodeId = 1;
@@ -796,6 +1277,7 @@ void SceneGraph::clear() {
 	node.setId(0);
 	node.setParent(InvalidNodeId);
 	_nodes.emplace(0, core::move(node));
+	indexNode(this->node(0));
 	_region = voxel::Region::InvalidRegion;
 }
 
@@ -933,7 +1415,73 @@ voxel::RawVolume *SceneGraph::resolveVolume(SceneGraphNode &n) {
 	return n.volume();
 }
 
+namespace priv {
+
+/**
+ * @brief The part of a model node that is copied into the merged volume
+ */
+struct MergeJob {
+	const voxel::RawVolume *volume;
+	const palette::Palette *palette;
+	/** the source region - cropped to the source volume and the merged volume */
+	voxel::Region region;
+	/** the offset from the source region to the target region in the merged volume */
+	glm::ivec3 offset;
+	/** the jobs with the same level don't overlap and are copied concurrently */
+	int level;
+
+	inline voxel::Region targetRegion() const {
+		voxel::Region target = region;
+		target.shift(offset);
+		return target;
+	}
+};
+
+/**
+ * @brief Copies the solid voxels of the job row by row into the merged volume and maps the colors to the merged
+ * palette
+ * @param[in] mergedVoxels The voxel data of the merged volume - starting at the lower corner of @c mergedRegion
+ */
+static void mergeJob(const MergeJob &job, voxel::Voxel *mergedVoxels, const voxel::Region &mergedRegion,
+					 const palette::Palette &mergedPalette) {
+	core_trace_scoped(MergeJob);
+	// the closest match is searched once per source palette color and not for every voxel
+	int16_t colorMapping[palette::PaletteMaxColors];
+	for (int i = 0; i < palette::PaletteMaxColors; ++i) {
+		colorMapping[i] = -1;
+	}
+	const voxel::Region &region = job.region;
+	const glm::ivec3 &mergedLower = mergedRegion.getLowerCorner();
+	const int mergedWidth = mergedRegion.getWidthInVoxels();
+	const int mergedHeight = mergedRegion.getHeightInVoxels();
+	const int width = region.getWidthInVoxels();
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		const int destZ = z + job.offset.z - mergedLower.z;
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			const int destY = y + job.offset.y - mergedLower.y;
+			const int destX = region.getLowerX() + job.offset.x - mergedLower.x;
+			const voxel::Voxel *src = job.volume->row(glm::ivec3(region.getLowerX(), y, z));
+			voxel::Voxel *dest = mergedVoxels + ((size_t)destZ * mergedHeight + destY) * mergedWidth + destX;
+			for (int x = 0; x < width; ++x) {
+				voxel::Voxel voxel = src[x];
+				if (isAir(voxel.getMaterial())) {
+					continue;
+				}
+				const uint8_t color = voxel.getColor();
+				if (colorMapping[color] == -1) {
+					colorMapping[color] = (uint8_t)mergedPalette.getClosestMatch(job.palette->color(color));
+				}
+				voxel.setColor((uint8_t)colorMapping[color]);
+				dest[x] = voxel;
+			}
+		}
+	}
+}
+
+} // namespace priv
+
 SceneGraph::MergeResult SceneGraph::merge(bool skipHidden) const {
+	core_trace_scoped(SceneGraphMerge);
 	const size_t n = size(SceneGraphNodeType::AllModels);
 	if (n == 0) {
 		return MergeResult{};
@@ -952,6 +1500,11 @@ SceneGraph::MergeResult SceneGraph::merge(bool skipHidden) const {
 	const palette::NormalPalette &normalPalette = firstModelNode()->normalPalette();
 
 	voxel::RawVolume *merged = new voxel::RawVolume(mergedRegion);
+
+	// the volumes and palettes are resolved here - this might decompress the volume or create the palette of a node
+	core::DynamicArray<priv::MergeJob> jobs;
+	jobs.reserve(n);
+	int levels = 0;
 	for (const auto &e : nodes()) {
 		const SceneGraphNode &node = e->second;
 		if (!node.isAnyModelNode()) {
@@ -960,21 +1513,59 @@ SceneGraph::MergeResult SceneGraph::merge(bool skipHidden) const {
 		if (skipHidden && !node.visible()) {
 			continue;
 		}
+		const voxel::RawVolume *v = resolveVolume(node);
+		if (v == nullptr) {
+			continue;
+		}
 		const voxel::Region &sourceRegion = resolveRegion(node);
 		const voxel::Region &destRegion = sceneRegion(node, keyFrameIdx);
-
-		auto func = [&node, &mergedPalette](voxel::Voxel &voxel) {
-			if (isAir(voxel.getMaterial())) {
-				return false;
-			}
-			const core::RGBA color = node.palette().color(voxel.getColor());
-			const uint8_t index = mergedPalette.getClosestMatch(color);
-			voxel.setColor(index);
-			return true;
-		};
-		const voxel::RawVolume *v = resolveVolume(node);
 		// TODO: SCENEGRAPH: rotation
-		voxelutil::mergeVolumes(merged, v, destRegion, sourceRegion, func);
+		priv::MergeJob job;
+		job.volume = v;
+		job.palette = &node.palette();
+		job.offset = destRegion.getLowerCorner() - sourceRegion.getLowerCorner();
+		job.region = sourceRegion;
+		if (!job.region.cropTo(v->region())) {
+			continue;
+		}
+		voxel::Region mergedSourceRegion = mergedRegion;
+		mergedSourceRegion.shift(-job.offset);
+		if (!job.region.cropTo(mergedSourceRegion)) {
+			continue;
+		}
+		// the nodes are merged in the order of their ids - a node has to wait for all the nodes before it that
+		// write into the same voxels
+		job.level = 0;
+		const voxel::Region &targetRegion = job.targetRegion();
+		for (const priv::MergeJob &other : jobs) {
+			if (other.level >= job.level && voxel::intersects(other.targetRegion(), targetRegion)) {
+				job.level = other.level + 1;
+			}
+		}
+		levels = core_max(levels, job.level + 1);
+		jobs.push_back(job);
+	}
+
+	if (!jobs.empty()) {
+		voxel::Voxel *mergedVoxels = merged->writableRow(mergedRegion.getLowerCorner());
+		core::DynamicArray<const priv::MergeJob *> levelJobs;
+		levelJobs.reserve(jobs.size());
+		for (int level = 0; level < levels; ++level) {
+			levelJobs.clear();
+			for (const priv::MergeJob &job : jobs) {
+				if (job.level == level) {
+					levelJobs.push_back(&job);
+				}
+			}
+			core::parallelFor(
+				&app::App::getInstance()->threadPool(), 0, (int)levelJobs.size(),
+				[&](int from, int to) {
+					for (int i = from; i < to; ++i) {
+						priv::mergeJob(*levelJobs[i], mergedVoxels, mergedRegion, mergedPalette);
+					}
+				},
+				1);
+		}
 	}
 	return MergeResult{merged, mergedPalette, normalPalette};
 }
@@ -9,15 +9,21 @@
 #pragma once
 
 #include "SceneGraphNode.h"
+#include "SceneGraphNodes.h"
 #include "FrameTransform.h"
 #include "core/DirtyState.h"
+#include "core/UUID.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/DynamicStringMap.h"
+#include "core/collection/FlatMap.h"
 #include "math/AABB.h"
+#include "math/AABBTree.h"
 #include "palette/NormalPalette.h"
 #include "palette/Palette.h"
 #include "scenegraph/SceneGraphKeyFrame.h"
 #include "scenegraph/SceneGraphListener.h"
 #include "voxel/Region.h"
+#include <future>
 
 namespace voxel {
 class RawVolume;
@@ -26,7 +32,24 @@ class RawVolume;
 namespace scenegraph {
 
 using SceneGraphAnimationIds = core::DynamicArray<core::String>;
-using SceneGraphNodes = core::Map<int, SceneGraphNode, 251>;
+
+/**
+ * @brief The world transforms of all nodes for the frames @c 0 to @c maxFrame of one animation
+ * @sa SceneGraph::bakeTransforms()
+ */
+struct BakedTransforms {
+	FrameIndex maxFrame = -1;
+	int nodes = 0;
+	/** indexed by node id and frame */
+	core::DynamicArray<FrameTransform> transforms;
+
+	inline const FrameTransform *transform(int nodeId, FrameIndex frameIdx) const {
+		if (nodeId < 0 || nodeId >= nodes || frameIdx < 0 || frameIdx > maxFrame) {
+			return nullptr;
+		}
+		return &transforms[(size_t)nodeId * (size_t)(maxFrame + 1) + (size_t)frameIdx];
+	}
+};
 
 /**
  * @brief The internal format for the save/load methods.
@@ -35,8 +58,18 @@ using SceneGraphNodes = core::Map<int, SceneGraphNode, 251>;
  * @sa SceneGraphNode
  */
 class SceneGraph : public core::DirtyState {
+	friend class SceneGraphNode;
 protected:
 	SceneGraphNodes _nodes;
+	/** the uuids are unique in the scene graph - maps them to the node id */
+	core::FlatMap<core::UUID, int, core::UUIDHash> _uuidIndex;
+	/** the names don't have to be unique - maps them to the ids of all nodes with that name */
+	core::FlatMap<core::String, core::DynamicArray<int>, core::StringHash> _nameIndex;
+	/**
+	 * the sorted ids of the nodes per type - including the fake types @c SceneGraphNodeType::AllModels and
+	 * @c SceneGraphNodeType::All for the iterators
+	 */
+	core::DynamicArray<int> _typeIndex[(int)SceneGraphNodeType::All + 1];
 	int _nextNodeId = 0;
 	int _activeNodeId = InvalidNodeId;
 	SceneGraphAnimationIds _animations;
@@ -44,12 +77,85 @@ protected:
 	mutable voxel::Region _region;
 	mutable bool _regionDirty = true;
 	mutable FrameIndex _cachedMaxFrame = -1;
-	const core::String _emptyUUID;
+	const core::UUID _emptyUUID;
 	core::DynamicArray<SceneGraphListener*> _listeners;
+	/** the nodes that were modified since the last @c updateTransforms() call - the roots of the dirty subtrees */
+	core::DynamicArray<int> _dirtyTransformNodes;
+	/** set if the root node was modified or too many nodes were modified to track them */
+	bool _allTransformsDirty = true;
+	/** the animations that were baked by @c bakeTransforms() - any modification of the nodes invalidates them */
+	mutable core::DynamicStringMap<BakedTransforms> _bakedTransforms;
+	/** bounding volume hierarchy over the world bounds of the model nodes for @c _spatialIndexFrame */
+	mutable math::AABBTree _spatialIndex;
+	/** the proxy ids of the nodes in the spatial index - indexed by the node id */
+	mutable core::DynamicArray<int> _spatialIndexProxies;
+	/** the nodes whose bounds - and the bounds of their children - must be updated in the spatial index */
+	mutable core::DynamicArray<int> _dirtyBoundsNodes;
+	mutable bool _allBoundsDirty = true;
+	mutable FrameIndex _spatialIndexFrame = -1;
+	mutable core::String _spatialIndexAnimation;
+	/** a volume of an inactive node that is compressed on the thread pool - see compressInactiveNodes() */
+	struct PendingCompression {
+		int nodeId = InvalidNodeId;
+		/** the volume of the node and its version when the compression was started */
+		const voxel::RawVolume *source = nullptr;
+		uint64_t version = 0u;
+		std::future<voxel::CompressedVolume *> compressed;
+	};
+	core::DynamicArray<PendingCompression> _pendingCompressions;
 
 	void updateTransforms_r(SceneGraphNode &node);
+	/**
+	 * @brief Called by the @c SceneGraphNode whenever its key frames or transforms might have been modified
+	 */
+	void markTransformsDirty(int nodeId);
+	void invalidateBakedTransforms() const;
+	/**
+	 * @brief Brings the spatial index up to date for the given frame of the active animation
+	 */
+	void updateSpatialIndex(FrameIndex frameIdx) const;
+	void updateNodeBounds(const SceneGraphNode &node, FrameIndex frameIdx) const;
+	void updateNodeBounds_r(const SceneGraphNode &node, FrameIndex frameIdx) const;
+	void removeNodeBounds(int nodeId) const;
+	void clearSpatialIndex() const;
+	/**
+	 * @brief Called by the @c SceneGraphNode when its lazy volume was loaded for the first time
+	 */
+	void onVolumeLoaded(int nodeId);
+	/**
+	 * @brief Replaces the volumes of the nodes by their compressed copies that are finished - the copies of nodes that
+	 * were accessed or modified in the meantime are discarded
+	 * @param[in] wait Wait for the compressions that are still running
+	 * @return The amount of compressed nodes
+	 */
+	int applyCompressedVolumes(uint64_t nowMillis, bool wait);
+	bool isCompressing(int nodeId) const;
+	/**
+	 * @brief Waits for the running compressions and deletes their results
+	 */
+	void discardCompressedVolumes();
+	void bakeTransforms_r(const SceneGraphNode &node, const core::String &animation, BakedTransforms &baked,
+						  int parentId) const;
 	voxel::Region calcRegion() const;
 
+	/**
+	 * @brief Adds the node to the uuid and name lookup indices
+	 * @note The node must already be stored in @c _nodes
+	 */
+	void indexNode(SceneGraphNode &node);
+	void unindexNode(const SceneGraphNode &node);
+	/**
+	 * @brief Called by @c SceneGraphNode::setName() before the name of a node of this scene graph is changed
+	 */
+	void updateNameIndex(const SceneGraphNode &node, const core::String &newName);
+	void removeFromNameIndex(const core::String &name, int nodeId);
+	/**
+	 * @return The index of the first id in the sorted list that is not less than the given id
+	 */
+	static size_t lowerBound(const core::DynamicArray<int> &ids, int nodeId);
+	static void addToTypeIndex(core::DynamicArray<int> &ids, int nodeId);
+	static void removeFromTypeIndex(core::DynamicArray<int> &ids, int nodeId);
+
 public:
 	SceneGraph(int nodes = 262144);
 	virtual ~SceneGraph();
@@ -107,7 +213,7 @@ public:
 	 * @sa sceneRegion()
 	 */
 	const voxel::Region &region() const;
-	const core::String &uuid(int nodeId) const;
+	const core::UUID &uuid(int nodeId) const;
 
 	bool isRegistered(SceneGraphListener *listener) const;
 	void unregisterListener(SceneGraphListener *listener);
@@ -134,9 +240,19 @@ public:
 	 * @brief Interpolates the transforms for the given frame. It searches the keyframe before and after
 	 * the given input frame and interpolates according to the given delta frames between the particular
 	 * keyframes.
+	 * @note If the animation was baked by @c bakeTransforms(), the baked transform is returned
 	 */
 	FrameTransform transformForFrame(const SceneGraphNode &node, FrameIndex frameIdx) const;
 	FrameTransform transformForFrame(const SceneGraphNode &node, const core::String &animation, FrameIndex frameIdx) const;
+	/**
+	 * @brief Evaluates the world transforms of all nodes for all frames of the given animation once. The following
+	 * @c transformForFrame() calls for this animation are just a lookup.
+	 * @note Any modification of the key frames, transforms or the hierarchy invalidates the baked transforms. This is
+	 * meant to be called before an animation is played back or exported.
+	 * @note Not thread safe - don't call this while other threads are using @c transformForFrame()
+	 * @return @c false if the animation doesn't exist or would need too much memory
+	 */
+	bool bakeTransforms(const core::String &animation) const;
 
 	/**
 	 * Calculate the region for the whole scene having the transform for the given frame applied
@@ -152,8 +268,43 @@ public:
 	bool setAnimation(const core::String &animation);
 	const core::String &activeAnimation() const;
 
+	/**
+	 * @brief Applies the modified transforms. Only the subtrees of the nodes that were modified since the last call
+	 * are visited.
+	 */
 	void updateTransforms();
 	void markMaxFramesDirty();
+	/**
+	 * @brief Marks the world bounds of the given node and its children as modified. This is done automatically for
+	 * transform, pivot and volume changes - but must be called if the region of a volume is changed in place.
+	 */
+	void markBoundsDirty(int nodeId);
+
+	/**
+	 * @brief Collects the ids of the model nodes whose world bounds in the given frame intersect the given area
+	 * @note The bounds of the nodes are enlarged by a small margin - do the exact test if needed
+	 */
+	void nodesInRegion(const math::AABB<float> &area, FrameIndex frameIdx, core::DynamicArray<int> &nodeIds) const;
+	/**
+	 * @brief Collects the ids of the model nodes whose world bounds in the given frame are visible in the frustum
+	 */
+	void nodesInFrustum(const math::Frustum &frustum, FrameIndex frameIdx, core::DynamicArray<int> &nodeIds) const;
+
+	/**
+	 * @brief Calls the given function for the model nodes whose world bounds in the given frame are hit by the ray
+	 *
+	 * This is using the spatial index - and thus doesn't visit all the nodes of the scene graph.
+	 *
+	 * @param func @c float(const SceneGraphNode &node, float distance) - see @c math::AABBTree::raycast(). Return
+	 * the distance of the closest exact hit to skip the nodes that are further away.
+	 */
+	template<class FUNC>
+	void raycastNodes(const math::Ray &ray, FrameIndex frameIdx, float maxDistance, FUNC &&func) const {
+		updateSpatialIndex(frameIdx);
+		_spatialIndex.raycast(ray, maxDistance, [&](int nodeId, float distance) {
+			return func(node(nodeId), distance);
+		});
+	}
 
 	/**
 	 * @brief We move into the scene graph to make it clear who is owning the volume.
@@ -167,7 +318,7 @@ public:
 	int emplace(SceneGraphNode &&node, int parent = 0);
 
 	SceneGraphNode* findNodeByName(const core::String& name);
-	SceneGraphNode* findNodeByUUID(const core::String& uuid);
+	SceneGraphNode* findNodeByUUID(const core::UUID& uuid);
 	const SceneGraphNode* findNodeByName(const core::String& name) const;
 	SceneGraphNode* findNodeByPropertyValue(const core::String &key, const core::String &value) const;
 	SceneGraphNode* first();
@@ -258,87 +409,94 @@ public:
 	 */
 	void clear();
 
+	/**
+	 * @brief Replace the volumes of model nodes that were not accessed for the given amount of time with a
+	 * compressed copy. The volumes are compressed on the thread pool - the finished copies replace the volumes of
+	 * their nodes with the next call.
+	 * @note The active node is never compressed
+	 * @note The volumes are inflated again on demand by @c SceneGraphNode::volume()
+	 * @note The workers compress a copy that shares the voxel data - a node that is modified or accessed while its
+	 * volume is compressed keeps its volume
+	 * @param[in] nowMillis The current time in millis
+	 * @param[in] inactiveMillis The time a node must not have been accessed to get compressed
+	 * @param[in] wait Wait for the compressions to finish instead of applying them with the next call
+	 * @return The amount of compressed nodes
+	 */
+	int compressInactiveNodes(uint64_t nowMillis, uint64_t inactiveMillis, bool wait = false);
+
+	/**
+	 * @brief Iterates the ids of the type index of the given filter in ascending order
+	 *
+	 * Removing nodes while iterating is allowed - adding nodes is not.
+	 */
 	class iterator {
 	private:
-		int _startNodeId = -1;
+		const core::DynamicArray<int> *_ids = nullptr;
+		size_t _index = 0u;
+		int _nodeId = InvalidNodeId;
 		int _endNodeId = -1;
-		SceneGraphNodeType _filter = SceneGraphNodeType::Max;
 		const SceneGraph *_sceneGraph = nullptr;
 	public:
 		constexpr iterator() {
 		}
 
-		iterator(int startNodeId, int endNodeId, SceneGraphNodeType filter, const SceneGraph *sceneGraph) :
-				_startNodeId(startNodeId), _endNodeId(endNodeId), _filter(filter), _sceneGraph(sceneGraph) {
-			while (_startNodeId != _endNodeId) {
-				if (!_sceneGraph->hasNode(_startNodeId)) {
-					++_startNodeId;
-					continue;
-				}
-				SceneGraphNodeType type = _sceneGraph->node(_startNodeId).type();
-				if (type == _filter || _filter == SceneGraphNodeType::All) {
-					break;
-				} else if (_filter == SceneGraphNodeType::AllModels) {
-					if (type == SceneGraphNodeType::Model || type == SceneGraphNodeType::ModelReference) {
-						break;
-					}
-				}
-				++_startNodeId;
+		iterator(SceneGraphNodeType filter, const SceneGraph *sceneGraph)
+			: _endNodeId(sceneGraph->_nextNodeId), _sceneGraph(sceneGraph) {
+			if (filter == SceneGraphNodeType::Max) {
+				// the end iterator
+				return;
+			}
+			_ids = &sceneGraph->_typeIndex[(int)filter];
+			if (!_ids->empty()) {
+				_nodeId = (*_ids)[0];
 			}
 		}
 
 		inline SceneGraphNode& operator*() const {
-			return _sceneGraph->node(_startNodeId);
+			return _sceneGraph->node(_nodeId);
 		}
 
 		iterator &operator++() {
 			core_assert_msg(_sceneGraph->_nextNodeId == _endNodeId, "Concurrent modification detected!");
-			if (_startNodeId != _endNodeId) {
-				for (;;) {
-					++_startNodeId;
-					if (_startNodeId == _endNodeId) {
-						break;
-					}
-					if (!_sceneGraph->hasNode(_startNodeId)) {
-						continue;
-					}
-					SceneGraphNodeType type = _sceneGraph->node(_startNodeId).type();
-					if (type == _filter || _filter == SceneGraphNodeType::All) {
-						break;
-					} else if (_filter == SceneGraphNodeType::AllModels) {
-						if (type == SceneGraphNodeType::Model || type == SceneGraphNodeType::ModelReference) {
-							break;
-						}
-					}
+			if (_nodeId == InvalidNodeId) {
+				return *this;
+			}
+			if (_index >= _ids->size() || (*_ids)[_index] != _nodeId) {
+				// the current node was removed - find the position of the next id again
+				_index = lowerBound(*_ids, _nodeId);
+				if (_index < _ids->size() && (*_ids)[_index] == _nodeId) {
+					++_index;
 				}
+			} else {
+				++_index;
 			}
-
+			_nodeId = _index < _ids->size() ? (*_ids)[_index] : InvalidNodeId;
 			return *this;
 		}
 
 		inline SceneGraphNode& operator->() const {
-			return _sceneGraph->node(_startNodeId);
+			return _sceneGraph->node(_nodeId);
 		}
 
 		inline bool operator!=(const iterator& rhs) const {
-			return _startNodeId != rhs._startNodeId;
+			return _nodeId != rhs._nodeId;
 		}
 
 		inline bool operator==(const iterator& rhs) const {
-			return _startNodeId == rhs._startNodeId;
+			return _nodeId == rhs._nodeId;
 		}
 	};
 
 	inline auto begin(SceneGraphNodeType filter) {
-		return iterator(0, _nextNodeId, filter, this);
+		return iterator(filter, this);
 	}
 
 	inline auto begin(SceneGraphNodeType filter) const {
-		return iterator(0, _nextNodeId, filter, this);
+		return iterator(filter, this);
 	}
 
 	inline auto end() {
-		return iterator(0, _nextNodeId, SceneGraphNodeType::Max, this);
+		return iterator(SceneGraphNodeType::Max, this);
 	}
 
 	inline auto beginAll() const {
@@ -354,7 +512,7 @@ public:
 	}
 
 	inline auto end() const {
-		return iterator(0, _nextNodeId, SceneGraphNodeType::Max, this);
+		return iterator(SceneGraphNodeType::Max, this);
 	}
 
 	/**
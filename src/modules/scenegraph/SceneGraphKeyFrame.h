@@ -5,7 +5,7 @@
 #pragma once
 
 #include "core/ArrayLength.h"
-#include "core/collection/DynamicArray.h"
+#include "core/collection/SmallVector.h"
 #include "core/collection/StringMap.h"
 #include "scenegraph/SceneGraphTransform.h"
 
@@ -57,7 +57,29 @@ public:
 		return _transform;
 	}
 };
-using SceneGraphKeyFrames = core::DynamicArray<SceneGraphKeyFrame>;
+// most nodes only have one key frame per animation
+using SceneGraphKeyFrames = core::SmallVector<SceneGraphKeyFrame, 1>;
 using SceneGraphKeyFramesMap = core::StringMap<SceneGraphKeyFrames>;
 
+/**
+ * @brief Binary search over key frames that are sorted by their frame
+ * @return The index of the first key frame with a frame that is not less than the given frame - or the size of the
+ * key frames if there is no such key frame
+ * @ingroup SceneGraph
+ */
+inline KeyFrameIndex lowerBoundKeyFrame(const SceneGraphKeyFrames &keyFrames, FrameIndex frameIdx) {
+	KeyFrameIndex first = 0;
+	KeyFrameIndex count = (KeyFrameIndex)keyFrames.size();
+	while (count > 0) {
+		const KeyFrameIndex step = count / 2;
+		if (keyFrames[first + step].frameIdx < frameIdx) {
+			first += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+	return first;
+}
+
 }; // namespace scenegraph
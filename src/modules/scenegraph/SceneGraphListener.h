@@ -24,6 +24,13 @@ public:
 	}
 	virtual void onNodesAligned() {
 	}
+	/**
+	 * @brief Called when the lazy volume of a node was loaded for the first time
+	 * @note This might be called from any thread that accesses the volume
+	 * @sa SceneGraphNode::setLazyVolume()
+	 */
+	virtual void onNodeVolumeLoaded(int nodeId) {
+	}
 };
 
 } // namespace scenegraph
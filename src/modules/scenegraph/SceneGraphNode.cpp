@@ -3,16 +3,20 @@
  */
 
 #include "SceneGraphNode.h"
+#include "SceneGraph.h"
 #include "core/Assert.h"
 #include "core/Color.h"
 #include "core/GLM.h"
-#include "core/Hash.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
+#include "core/Trace.h"
+#include "core/concurrent/Lock.h"
 #include "palette/NormalPalette.h"
 #include "palette/Palette.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphAnimation.h"
+#include "voxel/CompressedVolume.h"
+#include "voxel/LazyVolume.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Region.h"
@@ -24,11 +28,16 @@ namespace scenegraph {
 SceneGraphNode::SceneGraphNode(SceneGraphNode &&move) noexcept {
 	_volume = move._volume;
 	move._volume = nullptr;
+	_lazyVolume = move._lazyVolume.exchange(nullptr);
+	_lazyRegion = move._lazyRegion;
+	_volumeLoaded = move._volumeLoaded.exchange(true);
+	_volumeAccessed = move._volumeAccessed;
+	_volumeAccessMillis = move._volumeAccessMillis;
 	_name = core::move(move._name);
 	_id = move._id;
 	move._id = InvalidNodeId;
 	_uuid = move._uuid;
-	move._uuid.clear();
+	move._uuid = core::UUID();
 	_referenceId = move._referenceId;
 	move._referenceId = InvalidNodeId;
 	_palette = core::move(move._palette);
@@ -47,6 +56,13 @@ SceneGraphNode::SceneGraphNode(SceneGraphNode &&move) noexcept {
 	move._flags &= ~VolumeOwned;
 }
 
+void SceneGraphNode::setName(const core::String &name) {
+	if (_sceneGraph != nullptr) {
+		_sceneGraph->updateNameIndex(*this, name);
+	}
+	_name = name;
+}
+
 SceneGraphNode::~SceneGraphNode() {
 	release();
 }
@@ -55,13 +71,22 @@ SceneGraphNode &SceneGraphNode::operator=(SceneGraphNode &&move) noexcept {
 	if (&move == this) {
 		return *this;
 	}
+	// the uuid and the name of a node that is part of a scene graph are replaced
+	if (_sceneGraph != nullptr) {
+		_sceneGraph->unindexNode(*this);
+	}
 	setVolume(move._volume, move._flags & VolumeOwned);
 	move._volume = nullptr;
+	_lazyVolume = move._lazyVolume.exchange(nullptr);
+	_lazyRegion = move._lazyRegion;
+	_volumeLoaded = move._volumeLoaded.exchange(true);
+	_volumeAccessed = move._volumeAccessed;
+	_volumeAccessMillis = move._volumeAccessMillis;
 	_name = core::move(move._name);
 	_id = move._id;
 	move._id = InvalidNodeId;
 	_uuid = move._uuid;
-	move._uuid.clear();
+	move._uuid = core::UUID();
 	_referenceId = move._referenceId;
 	move._referenceId = InvalidNodeId;
 	_palette = core::move(move._palette);
@@ -77,13 +102,16 @@ SceneGraphNode &SceneGraphNode::operator=(SceneGraphNode &&move) noexcept {
 	_type = move._type;
 	_flags = move._flags;
 	move._flags &= ~VolumeOwned;
+	if (_sceneGraph != nullptr) {
+		_sceneGraph->indexNode(*this);
+	}
 	return *this;
 }
 
-SceneGraphNode::SceneGraphNode(SceneGraphNodeType type, const core::String &uuid)
+SceneGraphNode::SceneGraphNode(SceneGraphNodeType type, const core::UUID &uuid)
 	: _type(type), _flags(VolumeOwned | Visible), _uuid(uuid), _properties(128) {
-	if (_uuid.empty()) {
-		_uuid = core::generateUUID();
+	if (!_uuid.isValid()) {
+		_uuid = core::UUID::generate();
 	}
 	// ensure that there is at least one animation with keyframes
 	setAnimation(DEFAULT_ANIMATION);
@@ -97,6 +125,7 @@ bool SceneGraphNode::addAnimation(const core::String &anim) {
 	SceneGraphKeyFrames frames;
 	frames.emplace_back(SceneGraphKeyFrame{});
 	_keyFramesMap.emplace(anim, core::move(frames));
+	markTransformsDirty();
 	Log::debug("Added animation %s to node %s (%i)", anim.c_str(), _name.c_str(), _id);
 	return true;
 }
@@ -110,6 +139,7 @@ bool SceneGraphNode::removeAnimation(const core::String &anim) {
 		_keyFrames = nullptr;
 	}
 	_keyFramesMap.erase(iter);
+	markTransformsDirty();
 	if (_keyFramesMap.empty()) {
 		setAnimation(DEFAULT_ANIMATION);
 	}
@@ -149,45 +179,83 @@ void SceneGraphNode::setNormalPalette(const palette::NormalPalette &normalPalett
 	if (normalPalette.size() <= 0) {
 		return;
 	}
-	_normalPalette.setValue(normalPalette);
-	_normalPalette.value()->markDirty();
+	if (_normalPalette.unique()) {
+		*_normalPalette.get() = normalPalette;
+		_normalPalette->markDirty();
+		return;
+	}
+	_normalPalette = palette::PaletteRegistry::intern(normalPalette);
 }
 
 bool SceneGraphNode::hasNormalPalette() const {
-	return _normalPalette.hasValue();
+	return _normalPalette;
 }
 
-palette::NormalPalette &SceneGraphNode::normalPalette() const {
+const palette::NormalPalette &SceneGraphNode::normalPalette() const {
 	if (!hasNormalPalette()) {
 		palette::NormalPalette normalPalette;
 		normalPalette.redAlert2();
-		_normalPalette.setValue(normalPalette);
+		_normalPalette = palette::PaletteRegistry::intern(normalPalette);
+	}
+	return *_normalPalette.get();
+}
+
+palette::NormalPalette &SceneGraphNode::normalPalette() {
+	(void)((const SceneGraphNode *)this)->normalPalette();
+	palette::PaletteRegistry::detach(_normalPalette);
+	return *_normalPalette.get();
+}
+
+bool SceneGraphNode::sameNormalPalette(const SceneGraphNode &other) const {
+	if (_normalPalette == other._normalPalette) {
+		return true;
 	}
-	return *_normalPalette.value();
+	return normalPalette().hash() == other.normalPalette().hash();
 }
 
 bool SceneGraphNode::hasPalette() const {
-	return _palette.hasValue();
+	return _palette;
 }
 
 void SceneGraphNode::setPalette(const palette::Palette &palette) {
 	if (palette.size() <= 0) {
 		return;
 	}
-	_palette.setValue(palette);
-	_palette.value()->markDirty();
+	if (_palette.unique()) {
+		// an own palette is overwritten - the renderer might still point to it
+		*_palette.get() = palette;
+		_palette->markDirty();
+		return;
+	}
+	_palette = palette::PaletteRegistry::intern(palette);
 }
 
-palette::Palette &SceneGraphNode::palette() const {
-	if (!_palette.hasValue()) {
+const palette::Palette &SceneGraphNode::palette() const {
+	if (!_palette) {
 		palette::Palette palette;
 		palette.nippon();
-		_palette.setValue(palette);
+		_palette = palette::PaletteRegistry::intern(palette);
 	}
-	return *_palette.value();
+	return *_palette.get();
+}
+
+palette::Palette &SceneGraphNode::palette() {
+	(void)((const SceneGraphNode *)this)->palette();
+	palette::PaletteRegistry::detach(_palette);
+	return *_palette.get();
 }
 
-bool SceneGraphNode::removeUnusedColors(bool updateVoxels) {
+bool SceneGraphNode::samePalette(const SceneGraphNode &other) const {
+	if (_palette == other._palette) {
+		return true;
+	}
+	return palette().hash() == other.palette().hash();
+}
+
+bool SceneGraphNode::removeUnusedColors(bool updateVoxels, voxel::Region *dirtyRegion) {
+	if (dirtyRegion != nullptr) {
+		*dirtyRegion = voxel::Region::InvalidRegion;
+	}
 	voxel::RawVolume *v = volume();
 	if (v == nullptr) {
 		return false;
@@ -214,9 +282,7 @@ bool SceneGraphNode::removeUnusedColors(bool updateVoxels) {
 		int newMappingPos = 0;
 		core::Array<uint8_t, palette::PaletteMaxColors> newMapping;
 		for (size_t i = 0; i < palette::PaletteMaxColors; ++i) {
-			if (usedColors[i]) {
-				newMapping[i] = newMappingPos++;
-			}
+			newMapping[i] = usedColors[i] ? newMappingPos++ : (uint8_t)i;
 		}
 		palette::Palette newPalette;
 		for (size_t i = 0; i < palette::PaletteMaxColors; ++i) {
@@ -227,9 +293,11 @@ bool SceneGraphNode::removeUnusedColors(bool updateVoxels) {
 		}
 		core_assert(newPalette.colorCount() > 0);
 		pal = newPalette;
-		voxelutil::visitVolume(*v, [v, &newMapping, &pal] (int x, int y, int z, const voxel::Voxel& voxel) {
-			v->setVoxel(x, y, z, voxel::createVoxel(pal, newMapping[voxel.getColor()]));
-		});
+		// the colors in front of the first unused one keep their index - those voxels are not touched
+		const voxel::Region remapped = voxelutil::remapColors(v, pal, newMapping.data());
+		if (dirtyRegion != nullptr) {
+			*dirtyRegion = remapped;
+		}
 		pal.markDirty();
 		pal.markSave();
 	} else {
@@ -284,8 +352,9 @@ int SceneGraphNode::findUnusedPaletteIndex(bool startFromEnd) const {
 }
 
 void SceneGraphNode::fixErrors() {
+	markTransformsDirty();
 	if (_type == SceneGraphNodeType::Model) {
-		if (_volume == nullptr) {
+		if (_volume == nullptr && !isVolumeCompressed()) {
 			setVolume(new voxel::RawVolume(voxel::Region(0, 0)), true);
 		}
 	}
@@ -303,7 +372,7 @@ void SceneGraphNode::fixErrors() {
 
 bool SceneGraphNode::validate() const {
 	if (_type == SceneGraphNodeType::Model) {
-		if (_volume == nullptr) {
+		if (_volume == nullptr && !isVolumeCompressed()) {
 			Log::error("Model node %s (%i) has no volume", _name.c_str(), _id);
 			return false;
 		}
@@ -331,6 +400,7 @@ bool SceneGraphNode::validate() const {
 bool SceneGraphNode::setPivot(const glm::vec3 &pivot) {
 	glm_assert_vec3(pivot);
 	_pivot = pivot;
+	markBoundsDirty();
 	return true;
 }
 
@@ -345,6 +415,7 @@ glm::vec3 SceneGraphNode::worldPivot() const {
 
 void SceneGraphNode::translate(const glm::vec3 &translation) {
 	Log::debug("Translate the node by %f %f %f", translation.x, translation.y, translation.z);
+	markTransformsDirty();
 	for (auto *keyFrames : _keyFramesMap) {
 		for (SceneGraphKeyFrame &keyFrame : keyFrames->value) {
 			SceneGraphTransform &transform = keyFrame.transform();
@@ -356,6 +427,7 @@ void SceneGraphNode::translate(const glm::vec3 &translation) {
 }
 
 void SceneGraphNode::setTranslation(const glm::vec3 &translation, bool world) {
+	markTransformsDirty();
 	for (auto *keyFrames : _keyFramesMap) {
 		for (SceneGraphKeyFrame &keyFrame : keyFrames->value) {
 			SceneGraphTransform &transform = keyFrame.transform();
@@ -369,6 +441,7 @@ void SceneGraphNode::setTranslation(const glm::vec3 &translation, bool world) {
 }
 
 void SceneGraphNode::setRotation(const glm::quat &rotation, bool world) {
+	markTransformsDirty();
 	for (auto *keyFrames : _keyFramesMap) {
 		for (SceneGraphKeyFrame &keyFrame : keyFrames->value) {
 			SceneGraphTransform &transform = keyFrame.transform();
@@ -384,15 +457,100 @@ void SceneGraphNode::setRotation(const glm::quat &rotation, bool world) {
 void SceneGraphNode::release() {
 	if (_flags & VolumeOwned) {
 		delete _volume;
-		releaseOwnership();
+		_flags &= ~VolumeOwned;
 	}
+	delete _lazyVolume.exchange(nullptr);
 	_volume = nullptr;
+	_volumeLoaded = true;
 }
 
 void SceneGraphNode::releaseOwnership() {
+	// the caller takes over the volume instance - so it must be resident
+	inflateVolume();
 	_flags &= ~VolumeOwned;
 }
 
+bool SceneGraphNode::compressVolume() {
+	if (isVolumeCompressed() || _volume == nullptr || (_flags & VolumeOwned) == 0) {
+		return false;
+	}
+	return setCompressedVolume(new voxel::CompressedVolume(*_volume));
+}
+
+bool SceneGraphNode::setCompressedVolume(voxel::CompressedVolume *compressed) {
+	if (isVolumeCompressed() || _volume == nullptr || (_flags & VolumeOwned) == 0) {
+		delete compressed;
+		return false;
+	}
+	core_assert(compressed->region() == _volume->region());
+	Log::debug("Compressed volume of node %i from %i to %i bytes", _id, (int)voxel::RawVolume::size(_volume->region()),
+			   (int)compressed->size());
+	delete _volume;
+	_volume = nullptr;
+	_lazyRegion = compressed->region();
+	_lazyVolume = compressed;
+	return true;
+}
+
+void SceneGraphNode::setLazyVolume(voxel::LazyVolume *lazyVolume) {
+	core_assert_msg(_type == SceneGraphNodeType::Model, "Expected to get a model node, but got a node with type %i",
+					(int)_type);
+	release();
+	if (lazyVolume != nullptr) {
+		_lazyRegion = lazyVolume->region();
+		_lazyVolume = lazyVolume;
+		_volumeLoaded = false;
+		_flags |= VolumeOwned;
+	}
+	markBoundsDirty();
+}
+
+/**
+ * @brief Guards the inflation of the lazy volumes - the nodes are inflated by the const readers, too (e.g. the mesh
+ * extraction workers). This is rare enough to share the lock between all nodes.
+ */
+static core::Lock &inflateLock() {
+	static core::Lock lock;
+	return lock;
+}
+
+void SceneGraphNode::inflateVolume() {
+	if (!isVolumeCompressed()) {
+		return;
+	}
+	{
+		core::ScopedLock scoped(inflateLock());
+		voxel::LazyVolume *lazyVolume = _lazyVolume;
+		if (lazyVolume == nullptr) {
+			// another thread inflated the volume while we were waiting for the lock
+			return;
+		}
+		core_trace_scoped(InflateNodeVolume);
+		voxel::RawVolume *volume = lazyVolume->load();
+		if (volume == nullptr) {
+			Log::error("Failed to load the volume of node %i", _id);
+			volume = new voxel::RawVolume(lazyVolume->region());
+		}
+		// the volume must be set before the lazy volume is reset - the readers don't take the lock
+		_volume = volume;
+		_lazyVolume = nullptr;
+		delete lazyVolume;
+	}
+	_volumeAccessed = true;
+	Log::debug("Inflated volume of node %i", _id);
+	if (!_volumeLoaded.exchange(true)) {
+		if (_sceneGraph != nullptr && _id != InvalidNodeId) {
+			_sceneGraph->onVolumeLoaded(_id);
+		}
+	}
+}
+
+bool SceneGraphNode::consumeVolumeAccess() {
+	const bool accessed = _volumeAccessed;
+	_volumeAccessed = false;
+	return accessed;
+}
+
 void SceneGraphNode::setVolume(voxel::RawVolume *volume, bool transferOwnership) {
 	core_assert_msg(_type == SceneGraphNodeType::Model, "Expected to get a model node, but got a node with type %i",
 					(int)_type);
@@ -403,6 +561,7 @@ void SceneGraphNode::setVolume(voxel::RawVolume *volume, bool transferOwnership)
 		_flags &= ~VolumeOwned;
 	}
 	_volume = volume;
+	markBoundsDirty();
 }
 
 void SceneGraphNode::setVolume(const voxel::RawVolume *volume) {
@@ -410,6 +569,7 @@ void SceneGraphNode::setVolume(const voxel::RawVolume *volume) {
 					(int)_type);
 	release();
 	_volume = const_cast<voxel::RawVolume *>(volume);
+	markBoundsDirty();
 }
 
 bool SceneGraphNode::isLocked() const {
@@ -462,6 +622,7 @@ bool SceneGraphNode::setReference(int nodeId, bool forceChangeNodeType) {
 		}
 	}
 	_referenceId = nodeId;
+	markBoundsDirty();
 	return true;
 }
 
@@ -481,12 +642,15 @@ bool SceneGraphNode::unreferenceModelNode(const SceneGraphNode &node) {
 	}
 	_type = SceneGraphNodeType::Model;
 	_referenceId = InvalidNodeId;
-	setVolume(new voxel::RawVolume(node.volume()), true);
+	setVolume(voxel::RawVolume::createShared(*node.volume()), true);
 	setPalette(node.palette());
 	return true;
 }
 
 const voxel::Region &SceneGraphNode::region() const {
+	if (isVolumeCompressed()) {
+		return _lazyRegion;
+	}
 	if (_volume == nullptr) {
 		return voxel::Region::InvalidRegion;
 	}
@@ -674,6 +838,8 @@ const SceneGraphKeyFrames &SceneGraphNode::keyFrames(const core::String &anim) c
 }
 
 SceneGraphKeyFrames *SceneGraphNode::keyFrames() {
+	// the caller might modify the key frames
+	markTransformsDirty();
 	return _keyFrames;
 }
 
@@ -686,13 +852,8 @@ bool SceneGraphNode::hasKeyFrame(FrameIndex frameIdx) const {
 	if (kfs == nullptr) {
 		return false;
 	}
-	for (size_t i = 0; i < kfs->size(); ++i) {
-		const SceneGraphKeyFrame &kf = (*kfs)[i];
-		if (kf.frameIdx == frameIdx) {
-			return true;
-		}
-	}
-	return false;
+	const KeyFrameIndex i = lowerBoundKeyFrame(*kfs, frameIdx);
+	return i < (KeyFrameIndex)kfs->size() && (*kfs)[i].frameIdx == frameIdx;
 }
 
 KeyFrameIndex SceneGraphNode::addKeyFrame(FrameIndex frameIdx) {
@@ -700,26 +861,16 @@ KeyFrameIndex SceneGraphNode::addKeyFrame(FrameIndex frameIdx) {
 	if (kfs == nullptr) {
 		return InvalidKeyFrame;
 	}
-	for (size_t i = 0; i < kfs->size(); ++i) {
-		const SceneGraphKeyFrame &kf = (*kfs)[i];
-		if (kf.frameIdx == frameIdx) {
-			Log::debug("keyframe already exists at index %i", (int)i);
-			return InvalidKeyFrame;
-		}
+	// the key frames are sorted by their frame - insert the new one at the right position
+	const KeyFrameIndex i = lowerBoundKeyFrame(*kfs, frameIdx);
+	if (i < (KeyFrameIndex)kfs->size() && (*kfs)[i].frameIdx == frameIdx) {
+		Log::debug("keyframe already exists at index %i", (int)i);
+		return InvalidKeyFrame;
 	}
 
 	SceneGraphKeyFrame keyFrame;
 	keyFrame.frameIdx = frameIdx;
-	kfs->push_back(keyFrame);
-	sortKeyFrames();
-	size_t i = 0;
-	for (; i < kfs->size(); ++i) {
-		const SceneGraphKeyFrame &kf = (*kfs)[i];
-		if (kf.frameIdx == frameIdx) {
-			break;
-		}
-	}
-	core_assert(i != kfs->size());
+	kfs->insert(kfs->begin() + i, keyFrame);
 	return i;
 }
 
@@ -732,6 +883,18 @@ void SceneGraphNode::sortKeyFrames() {
 	}
 }
 
+void SceneGraphNode::markTransformsDirty() {
+	if (_sceneGraph != nullptr && _id != InvalidNodeId) {
+		_sceneGraph->markTransformsDirty(_id);
+	}
+}
+
+void SceneGraphNode::markBoundsDirty() {
+	if (_sceneGraph != nullptr && _id != InvalidNodeId) {
+		_sceneGraph->markBoundsDirty(_id);
+	}
+}
+
 bool SceneGraphNode::removeKeyFrame(FrameIndex frameIdx) {
 	const SceneGraphKeyFrames *kfs = keyFrames();
 	if (kfs == nullptr || kfs->size() <= 1) {
@@ -752,6 +915,7 @@ bool SceneGraphNode::removeKeyFrameByIndex(KeyFrameIndex keyFrameIdx) {
 
 bool SceneGraphNode::duplicateKeyFrames(const core::String &fromAnimation, const core::String &toAnimation) {
 	_keyFramesMap.put(toAnimation, keyFrames(fromAnimation));
+	markTransformsDirty();
 	return true;
 }
 
@@ -768,6 +932,7 @@ bool SceneGraphNode::setKeyFrames(const SceneGraphKeyFrames &kf) {
 
 void SceneGraphNode::setAllKeyFrames(const SceneGraphKeyFramesMap &map, const core::String &animation) {
 	_keyFramesMap = map;
+	markTransformsDirty();
 	setAnimation(animation);
 }
 
@@ -776,20 +941,18 @@ const SceneGraphKeyFramesMap &SceneGraphNode::allKeyFrames() const {
 }
 
 SceneGraphKeyFramesMap &SceneGraphNode::allKeyFrames() {
+	markTransformsDirty();
 	return _keyFramesMap;
 }
 
 bool SceneGraphNode::hasKeyFrameForFrame(FrameIndex frameIdx, KeyFrameIndex *existingIndex) const {
 	const SceneGraphKeyFrames &kfs = keyFrames();
-	const KeyFrameIndex n = (KeyFrameIndex)kfs.size();
-	for (KeyFrameIndex i = 0; i < n; ++i) {
-		const SceneGraphKeyFrame &kf = kfs[i];
-		if (kf.frameIdx == frameIdx) {
-			if (existingIndex) {
-				*existingIndex = i;
-			}
-			return true;
+	const KeyFrameIndex i = lowerBoundKeyFrame(kfs, frameIdx);
+	if (i < (KeyFrameIndex)kfs.size() && kfs[i].frameIdx == frameIdx) {
+		if (existingIndex) {
+			*existingIndex = i;
 		}
+		return true;
 	}
 	return false;
 }
@@ -799,16 +962,12 @@ KeyFrameIndex SceneGraphNode::nextKeyFrameForFrame(FrameIndex frameIdx) const {
 	// this assumes that the key frames are sorted by their frame
 	const int n = (int)kfs.size();
 	core_assert(n > 0);
-	int closest = 0;
-	for (int i = 0; i < n; ++i) {
-		const SceneGraphKeyFrame &kf = kfs[i];
-		if (kf.frameIdx <= frameIdx) {
-			closest = i;
-		} else {
-			return i;
-		}
+	// the first key frame after the given frame - or the last one
+	const KeyFrameIndex i = lowerBoundKeyFrame(kfs, frameIdx + 1);
+	if (i < n) {
+		return i;
 	}
-	return closest;
+	return n - 1;
 }
 
 KeyFrameIndex SceneGraphNode::previousKeyFrameForFrame(FrameIndex frameIdx) const {
@@ -816,14 +975,12 @@ KeyFrameIndex SceneGraphNode::previousKeyFrameForFrame(FrameIndex frameIdx) cons
 	// this assumes that the key frames are sorted by their frame
 	const int n = (int)kfs.size();
 	core_assert(n > 0);
-	int closest = 0;
-	for (int i = 0; i < n; ++i) {
-		const SceneGraphKeyFrame &kf = kfs[i];
-		if (kf.frameIdx < frameIdx) {
-			closest = i;
-		}
+	// the last key frame before the given frame - or the first one
+	const KeyFrameIndex i = lowerBoundKeyFrame(kfs, frameIdx);
+	if (i == 0) {
+		return 0;
 	}
-	return closest;
+	return i - 1;
 }
 
 KeyFrameIndex SceneGraphNode::keyFrameForFrame(FrameIndex frameIdx) const {
@@ -831,18 +988,14 @@ KeyFrameIndex SceneGraphNode::keyFrameForFrame(FrameIndex frameIdx) const {
 	// this assumes that the key frames are sorted by their frame
 	const int n = (int)kfs.size();
 	core_assert(n > 0);
-	for (int i = 0; i < n; ++i) {
-		const SceneGraphKeyFrame &kf = kfs[i];
-		if (kf.frameIdx == frameIdx) {
-			return i;
-		} else if (kf.frameIdx > frameIdx) {
-			if (i == 0) {
-				return 0;
-			}
-			return i - 1;
-		}
+	const KeyFrameIndex i = lowerBoundKeyFrame(kfs, frameIdx);
+	if (i < n && kfs[i].frameIdx == frameIdx) {
+		return i;
 	}
-	return n - 1;
+	if (i == 0) {
+		return 0;
+	}
+	return i - 1;
 }
 
 FrameIndex SceneGraphNode::maxFrame() const {
@@ -854,7 +1007,7 @@ FrameIndex SceneGraphNode::maxFrame() const {
 	return maxFrameIdx;
 }
 
-SceneGraphNodeCamera::SceneGraphNodeCamera(const core::String &uuid) : Super(SceneGraphNodeType::Camera, uuid) {
+SceneGraphNodeCamera::SceneGraphNodeCamera(const core::UUID &uuid) : Super(SceneGraphNodeType::Camera, uuid) {
 }
 
 float SceneGraphNodeCamera::farPlane() const {
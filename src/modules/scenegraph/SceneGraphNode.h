@@ -7,15 +7,20 @@
 #include "core/Optional.h"
 #include "core/RGBA.h"
 #include "core/String.h"
+#include "core/UUID.h"
+#include "core/concurrent/Atomic.h"
 #include "core/ArrayLength.h"
-#include "core/collection/Buffer.h"
+#include "core/collection/SmallVector.h"
 #include "core/collection/StringMap.h"
 #include "SceneGraphKeyFrame.h"
 #include "palette/NormalPalette.h"
+#include "palette/PaletteRegistry.h"
+#include "voxel/Region.h"
 
 namespace voxel {
+class CompressedVolume;
+class LazyVolume;
 class RawVolume;
-class Region;
 }
 namespace palette {
 class Palette;
@@ -55,7 +60,8 @@ static constexpr const char* SceneGraphNodeTypeStr[] {
 };
 static_assert((int)(scenegraph::SceneGraphNodeType::Max) == lengthof(SceneGraphNodeTypeStr), "Array sizes don't match Max");
 
-using SceneGraphNodeChildren = const core::Buffer<int, 32>;
+// most nodes only have a few children - they are stored without allocation
+using SceneGraphNodeChildren = const core::SmallVector<int, 8>;
 using SceneGraphNodeProperties = core::StringMap<core::String>;
 
 #define InvalidNodeId (-1)
@@ -68,7 +74,7 @@ using SceneGraphNodeProperties = core::StringMap<core::String>;
 class SceneGraphNode {
 	friend class SceneGraph;
 public:
-	SceneGraphNode(SceneGraphNodeType type = SceneGraphNodeType::Model, const core::String &uuid = "");
+	SceneGraphNode(SceneGraphNodeType type = SceneGraphNodeType::Model, const core::UUID &uuid = core::UUID());
 	SceneGraphNode(SceneGraphNode &&move) noexcept;
 	SceneGraphNode &operator=(SceneGraphNode &&move) noexcept;
 
@@ -89,15 +95,35 @@ protected:
 	core::RGBA _color;
 	glm::vec3 _pivot {0.0f};
 
-	core::String _uuid;
+	core::UUID _uuid;
 	core::String _name;
 	voxel::RawVolume *_volume = nullptr;
+	/**
+	 * if this is set, the volume is not resident and @c _volume is @c nullptr - the const readers might inflate the
+	 * volume concurrently, see inflateVolume()
+	 * @sa compressVolume()
+	 * @sa setLazyVolume()
+	 */
+	core::AtomicPtr<voxel::LazyVolume> _lazyVolume;
+	/** the region of the lazy volume - it is deleted by inflating the volume while other readers might query it */
+	voxel::Region _lazyRegion;
+	/** the volume was set by @c setLazyVolume() and was not yet accessed */
+	core::AtomicBool _volumeLoaded{true};
+	/** set whenever the volume is accessed - used to detect inactive nodes */
+	mutable core::AtomicBool _volumeAccessed{true};
+	uint64_t _volumeAccessMillis = 0u;
 	SceneGraphKeyFramesMap _keyFramesMap;
 	SceneGraphKeyFrames *_keyFrames = nullptr;
-	core::Buffer<int, 32> _children;
+	core::SmallVector<int, 8> _children;
 	SceneGraphNodeProperties _properties;
-	mutable core::Optional<palette::Palette> _palette;
-	mutable core::Optional<palette::NormalPalette> _normalPalette;
+	/** shared with all nodes that have the same palette - see palette::PaletteRegistry */
+	mutable palette::PalettePtr _palette;
+	mutable palette::NormalPalettePtr _normalPalette;
+	/**
+	 * the scene graph this node was added to - it keeps the uuid and name lookup indices up to date if the node is
+	 * renamed
+	 */
+	SceneGraph *_sceneGraph = nullptr;
 
 	/**
 	 * @brief Called in emplace() if a parent id is given
@@ -105,6 +131,16 @@ protected:
 	void setParent(int id);
 	void setId(int id);
 	void sortKeyFrames();
+	/**
+	 * @brief Informs the scene graph that the key frames or transforms of this node might have been modified
+	 * @sa SceneGraph::updateTransforms()
+	 */
+	void markTransformsDirty();
+	/**
+	 * @brief Informs the scene graph that the world bounds of this node might have been modified
+	 * @sa SceneGraph::markBoundsDirty()
+	 */
+	void markBoundsDirty();
 
 public:
 	~SceneGraphNode();
@@ -141,14 +177,33 @@ public:
 	bool unreferenceModelNode(const SceneGraphNode &node);
 
 	bool hasPalette() const;
-	palette::Palette &palette() const;
+	/**
+	 * @note Identical palettes are shared between the nodes - don't keep the reference after modifying the node
+	 */
+	const palette::Palette &palette() const;
+	/**
+	 * @brief The palette of this node for modification - a shared palette is copied first
+	 */
+	palette::Palette &palette();
 	void setPalette(const palette::Palette &palette);
+	/**
+	 * @return @c true if both nodes have the same palette - this is only a pointer or hash compare
+	 */
+	bool samePalette(const SceneGraphNode &other) const;
 
 	bool hasNormalPalette() const;
-	palette::NormalPalette &normalPalette() const;
+	const palette::NormalPalette &normalPalette() const;
+	palette::NormalPalette &normalPalette();
 	void setNormalPalette(const palette::NormalPalette &normalPalette);
+	bool sameNormalPalette(const SceneGraphNode &other) const;
 
-	bool removeUnusedColors(bool updateVoxels);
+	/**
+	 * @param updateVoxels If @c true the used colors are moved to the front of the palette and the voxels are
+	 * remapped, otherwise the unused colors are just reset
+	 * @param dirtyRegion If not @c nullptr this is set to the region of the voxels that got a new color index - only
+	 * these voxels have to be extracted again
+	 */
+	bool removeUnusedColors(bool updateVoxels, voxel::Region *dirtyRegion = nullptr);
 	int findUnusedPaletteIndex(bool startFromEnd) const;
 
 	// normalized pivot of [0-1] to be somewhere inside the volume region
@@ -189,15 +244,57 @@ public:
 	/**
 	 * @note If this node is a reference node ( @c SceneGraphNodeType::ModelReference ) then this will return @c
 	 * nullptr, too - use @c SceneGraph::resolveVolume() instead.
+	 * @note A compressed volume is inflated on demand - this is thread safe, concurrent readers (e.g. the extraction
+	 * workers) inflate the volume only once
 	 * @return voxel::RawVolume - might be @c nullptr
 	 */
 	const voxel::RawVolume *volume() const;
 	/**
 	 * @note If this node is a reference node ( @c SceneGraphNodeType::ModelReference ) then this will return @c
 	 * nullptr, too - use @c SceneGraph::resolveVolume() instead.
+	 * @note A compressed volume is inflated on demand
 	 * @return voxel::RawVolume - might be @c nullptr
 	 */
 	voxel::RawVolume *volume();
+	/**
+	 * @brief Replaces the owned volume by a run-length encoded copy. The volume is inflated again on the next
+	 * @c volume() call.
+	 * @note The old @c voxel::RawVolume pointer is no longer valid after this call
+	 * @return @c false if the node doesn't own a volume or the volume is already compressed
+	 */
+	bool compressVolume();
+	/**
+	 * @brief Same as @c compressVolume() but with an already compressed copy of the current volume
+	 * @note Takes the ownership of the given instance
+	 */
+	bool setCompressedVolume(voxel::CompressedVolume *compressed);
+	/**
+	 * @brief Sets a volume that is only loaded by the next @c volume() call - this allows to defer the decoding of
+	 * the voxels of a loaded file until they are needed
+	 * @note Takes the ownership of the given instance
+	 * @sa isVolumeLoaded()
+	 */
+	void setLazyVolume(voxel::LazyVolume *lazyVolume);
+	/**
+	 * @brief Inflate a compressed volume - or load a lazy volume
+	 * @note Thread safe - the volume is only inflated once
+	 */
+	void inflateVolume();
+	/**
+	 * @return @c true if the volume is not resident - either compressed or not yet loaded
+	 */
+	bool isVolumeCompressed() const;
+	/**
+	 * @return @c false if the volume was set by @c setLazyVolume() and was never accessed. Nothing was decoded for
+	 * these nodes yet - unlike for compressed volumes there are no meshes or undo states for them.
+	 */
+	bool isVolumeLoaded() const;
+	/**
+	 * @brief Checks whether the volume was accessed since the last call and resets the state
+	 */
+	bool consumeVolumeAccess();
+	uint64_t volumeAccessMillis() const;
+	void setVolumeAccessMillis(uint64_t millis);
 	/**
 	 * @brief Remaps the voxel colors to the new given palette
 	 * @note The palette is not set by this method - you have to call @c setPalette() on your own.
@@ -225,7 +322,7 @@ public:
 	// meta data
 
 	const core::String &name() const;
-	const core::String &uuid() const;
+	const core::UUID &uuid() const;
 	void setName(const core::String &name);
 	bool visible() const;
 	void setVisible(bool visible);
@@ -304,7 +401,7 @@ private:
 	using Super = SceneGraphNode;
 	// no members - just convenience methods
 public:
-	SceneGraphNodeCamera(const core::String &uuid = "");
+	SceneGraphNodeCamera(const core::UUID &uuid = core::UUID());
 
 	static constexpr const char *Modes[] = {"orthographic", "perspective"};
 	static constexpr const char *PropMode = "cam_mode";
@@ -365,7 +462,7 @@ inline const SceneGraphNodeCamera& toCameraNode(const SceneGraphNode& node) {
 }
 
 inline bool SceneGraphNode::owns() const {
-	return _volume;
+	return _volume != nullptr || isVolumeCompressed();
 }
 
 inline core::RGBA SceneGraphNode::color() const {
@@ -396,32 +493,46 @@ inline int SceneGraphNode::id() const {
 	return _id;
 }
 
-inline const voxel::RawVolume *SceneGraphNode::volume() const {
+inline voxel::RawVolume *SceneGraphNode::volume() {
 	if (_type != SceneGraphNodeType::Model) {
 		return nullptr;
 	}
+	if (isVolumeCompressed()) {
+		inflateVolume();
+	}
+	_volumeAccessed = true;
 	return _volume;
 }
 
-inline voxel::RawVolume *SceneGraphNode::volume() {
-	if (_type != SceneGraphNodeType::Model) {
-		return nullptr;
-	}
-	return _volume;
+inline const voxel::RawVolume *SceneGraphNode::volume() const {
+	// the lazy volume and the access state are atomic and the inflation is guarded - see inflateVolume()
+	return const_cast<SceneGraphNode *>(this)->volume();
+}
+
+inline bool SceneGraphNode::isVolumeCompressed() const {
+	return (const voxel::LazyVolume *)_lazyVolume != nullptr;
+}
+
+inline bool SceneGraphNode::isVolumeLoaded() const {
+	return _volumeLoaded;
+}
+
+inline uint64_t SceneGraphNode::volumeAccessMillis() const {
+	return _volumeAccessMillis;
+}
+
+inline void SceneGraphNode::setVolumeAccessMillis(uint64_t millis) {
+	_volumeAccessMillis = millis;
 }
 
 inline const core::String &SceneGraphNode::name() const {
 	return _name;
 }
 
-inline const core::String &SceneGraphNode::uuid() const {
+inline const core::UUID &SceneGraphNode::uuid() const {
 	return _uuid;
 }
 
-inline void SceneGraphNode::setName(const core::String &name) {
-	_name = name;
-}
-
 inline bool SceneGraphNode::visible() const {
 	return _flags & Visible;
 }
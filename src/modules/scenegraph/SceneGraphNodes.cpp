@@ -0,0 +1,109 @@
+/**
+ * @file
+ */
+
+#include "SceneGraphNodes.h"
+#include "core/Assert.h"
+#include "core/Bits.h"
+#include <new>
+
+namespace scenegraph {
+
+SceneGraphNodes::SceneGraphNodes(int reserve) {
+	if (reserve > 0) {
+		_blocks.reserve((reserve + BlockMask) >> BlockBits);
+	}
+}
+
+SceneGraphNodes::~SceneGraphNodes() {
+	clear();
+}
+
+SceneGraphNodes::SceneGraphNodes(SceneGraphNodes &&other) noexcept
+	: _blocks(core::move(other._blocks)), _size(other._size) {
+	other._blocks.clear();
+	other._size = 0u;
+}
+
+SceneGraphNodes &SceneGraphNodes::operator=(SceneGraphNodes &&other) noexcept {
+	if (this != &other) {
+		clear();
+		_blocks = core::move(other._blocks);
+		_size = other._size;
+		other._blocks.clear();
+		other._size = 0u;
+	}
+	return *this;
+}
+
+int SceneGraphNodes::next(int id) const {
+	const int slots = (int)_blocks.size() << BlockBits;
+	++id;
+	while (id < slots) {
+		const Block *block = _blocks[id >> BlockBits];
+		const uint64_t used = block != nullptr ? block->used >> (id & BlockMask) : 0u;
+		if (used == 0u) {
+			// skip the rest of the block
+			id = ((id >> BlockBits) + 1) << BlockBits;
+			continue;
+		}
+		return id + core::countTrailingZeros(used);
+	}
+	return InvalidNodeId;
+}
+
+void SceneGraphNodes::emplace(int id, SceneGraphNode &&node) {
+	core_assert(id >= 0);
+	const int blockIndex = id >> BlockBits;
+	while ((int)_blocks.size() <= blockIndex) {
+		_blocks.push_back(nullptr);
+	}
+	Block *&block = _blocks[blockIndex];
+	if (block == nullptr) {
+		block = new Block;
+	}
+	const uint64_t bit = UINT64_C(1) << (id & BlockMask);
+	core_assert_msg((block->used & bit) == 0u, "Slot %i is already used", id);
+	new (block->slot(id & BlockMask)) KeyValue(id, core::move(node));
+	block->used |= bit;
+	++_size;
+}
+
+bool SceneGraphNodes::remove(int id) {
+	KeyValue *kv = get(id);
+	if (kv == nullptr) {
+		return false;
+	}
+	kv->~KeyValue();
+	Block *&block = _blocks[id >> BlockBits];
+	block->used &= ~(UINT64_C(1) << (id & BlockMask));
+	if (block->used == 0u) {
+		delete block;
+		block = nullptr;
+	}
+	--_size;
+	return true;
+}
+
+bool SceneGraphNodes::erase(const iterator &iter) {
+	return remove(iter._id);
+}
+
+void SceneGraphNodes::clear() {
+	for (Block *block : _blocks) {
+		if (block == nullptr) {
+			continue;
+		}
+		uint64_t used = block->used;
+		while (used != 0u) {
+			const int index = core::countTrailingZeros(used);
+			block->slot(index)->~KeyValue();
+			used &= used - 1u;
+		}
+		delete block;
+	}
+	_blocks.clear();
+	_size = 0u;
+}
+
+} // namespace scenegraph
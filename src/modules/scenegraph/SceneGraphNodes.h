@@ -0,0 +1,151 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "SceneGraphNode.h"
+#include "core/collection/DynamicArray.h"
+#include <stdint.h>
+
+namespace scenegraph {
+
+/**
+ * @brief The node storage of the scene graph
+ *
+ * The node id is the slot index - the nodes are stored in fixed size blocks of slots. The blocks are never moved,
+ * so the addresses of the nodes are stable, and iterating the nodes is a linear walk over the blocks. The node ids
+ * are never reused by the scene graph, the blocks whose slots are all removed are released again.
+ *
+ * The iteration interface matches the one of @c core::Map (@c entry->key and @c entry->value).
+ *
+ * @ingroup SceneGraph
+ */
+class SceneGraphNodes {
+public:
+	struct KeyValue {
+		inline KeyValue(int _key, SceneGraphNode &&_value)
+			: key(_key), value(core::move(_value)), first(key), second(value) {
+		}
+
+		int key;
+		SceneGraphNode value;
+		const int &first;
+		const SceneGraphNode &second;
+	};
+
+private:
+	static constexpr int BlockBits = 6;
+	static constexpr int BlockSize = 1 << BlockBits;
+	static constexpr int BlockMask = BlockSize - 1;
+
+	struct Block {
+		alignas(KeyValue) uint8_t data[sizeof(KeyValue) * BlockSize];
+		/** one bit per used slot */
+		uint64_t used = 0u;
+
+		inline KeyValue *slot(int index) {
+			return (KeyValue *)data + index;
+		}
+	};
+	core::DynamicArray<Block *> _blocks;
+	size_t _size = 0u;
+
+	/**
+	 * @return The next used slot after the given id or @c InvalidNodeId
+	 */
+	int next(int id) const;
+
+public:
+	class iterator {
+		friend class SceneGraphNodes;
+	private:
+		const SceneGraphNodes *_nodes = nullptr;
+		int _id = InvalidNodeId;
+
+	public:
+		constexpr iterator() {
+		}
+		inline iterator(const SceneGraphNodes *nodes, int id) : _nodes(nodes), _id(id) {
+		}
+
+		inline KeyValue *operator*() const {
+			return _nodes->get(_id);
+		}
+
+		inline KeyValue *operator->() const {
+			return _nodes->get(_id);
+		}
+
+		inline iterator &operator++() {
+			_id = _nodes->next(_id);
+			return *this;
+		}
+
+		inline bool operator!=(const iterator &rhs) const {
+			return _id != rhs._id;
+		}
+
+		inline bool operator==(const iterator &rhs) const {
+			return _id == rhs._id;
+		}
+	};
+
+	/**
+	 * @param reserve The expected amount of nodes
+	 */
+	SceneGraphNodes(int reserve = 0);
+	~SceneGraphNodes();
+	SceneGraphNodes(const SceneGraphNodes &) = delete;
+	SceneGraphNodes &operator=(const SceneGraphNodes &) = delete;
+	SceneGraphNodes(SceneGraphNodes &&other) noexcept;
+	SceneGraphNodes &operator=(SceneGraphNodes &&other) noexcept;
+
+	/**
+	 * @return The stored node for the given id or @c nullptr if the slot is not used
+	 */
+	inline KeyValue *get(int id) const {
+		if (id < 0 || (id >> BlockBits) >= (int)_blocks.size()) {
+			return nullptr;
+		}
+		Block *block = _blocks[id >> BlockBits];
+		if (block == nullptr || (block->used & (UINT64_C(1) << (id & BlockMask))) == 0u) {
+			return nullptr;
+		}
+		return block->slot(id & BlockMask);
+	}
+
+	inline iterator find(int id) const {
+		return iterator(this, get(id) != nullptr ? id : InvalidNodeId);
+	}
+
+	inline bool hasKey(int id) const {
+		return get(id) != nullptr;
+	}
+
+	inline iterator begin() const {
+		return iterator(this, next(InvalidNodeId));
+	}
+
+	inline iterator end() const {
+		return iterator(this, InvalidNodeId);
+	}
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	/**
+	 * @note The slot for the given id must not be used
+	 */
+	void emplace(int id, SceneGraphNode &&node);
+	bool erase(const iterator &iter);
+	bool remove(int id);
+	void clear();
+};
+
+} // namespace scenegraph
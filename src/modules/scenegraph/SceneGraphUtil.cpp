@@ -3,9 +3,16 @@
  */
 
 #include "SceneGraphUtil.h"
+#include "app/App.h"
+#include "core/Algorithm.h"
+#include "core/Common.h"
 #include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/collection/Map.h"
 #include <glm/ext/scalar_constants.hpp>
 #include "core/collection/DynamicArray.h"
+#include "core/concurrent/Parallel.h"
 #include "math/Easing.h"
 #include "voxel/RawVolume.h"
 #include "scenegraph/SceneGraphNode.h"
@@ -96,7 +103,7 @@ int createNodeReference(SceneGraph &sceneGraph, const SceneGraphNode &node, int
 void copyNode(const SceneGraphNode &src, SceneGraphNode &target, bool copyVolume, bool copyKeyFrames) {
 	if (copyVolume) {
 		core_assert_msg(src.volume() != nullptr, "Source node has no volume - and is of type %d", (int)src.type());
-		target.setVolume(new voxel::RawVolume(src.volume()), true);
+		target.setVolume(voxel::RawVolume::createShared(*src.volume()), true);
 	} else if (src.isModelNode()) {
 		target.setVolume(src.volume());
 	}
@@ -107,7 +114,7 @@ int copyNodeToSceneGraph(SceneGraph &sceneGraph, const SceneGraphNode &node, int
 	SceneGraphNode newNode(node.type());
 	copy(node, newNode);
 	if (newNode.type() == SceneGraphNodeType::Model) {
-		newNode.setVolume(new voxel::RawVolume(node.volume()), true);
+		newNode.setVolume(voxel::RawVolume::createShared(*node.volume()), true);
 	}
 	const int nodeId = addToGraph(sceneGraph, core::move(newNode), parent);
 	if (recursive) {
@@ -168,7 +175,7 @@ static int copySceneGraphNode_r(SceneGraph &target, const SceneGraph &source, co
 	SceneGraphNode newNode(sourceNode.type());
 	copy(sourceNode, newNode);
 	if (newNode.type() == SceneGraphNodeType::Model) {
-		newNode.setVolume(new voxel::RawVolume(sourceNode.volume()), true);
+		newNode.setVolume(voxel::RawVolume::createShared(*sourceNode.volume()), true);
 	}
 	const int newNodeId = addToGraph(target, core::move(newNode), parent);
 	if (newNodeId == InvalidNodeId) {
@@ -207,6 +214,136 @@ core::DynamicArray<int> copySceneGraph(SceneGraph &target, const SceneGraph &sou
 	return nodesAdded;
 }
 
+using NodeMapping = core::Map<int, int, 521>;
+
+static int snapshotSceneGraphNode_r(SceneGraph &target, const SceneGraph &source, const SceneGraphNode &sourceNode,
+									int parent, NodeMapping &nodeMapping) {
+	SceneGraphNode newNode(sourceNode.type(), sourceNode.uuid());
+	copy(sourceNode, newNode, false);
+	newNode.setAllKeyFrames(sourceNode.allKeyFrames(), source.activeAnimation());
+	if (newNode.type() == SceneGraphNodeType::Model) {
+		newNode.setVolume(voxel::RawVolume::createShared(*sourceNode.volume()), true);
+	}
+	const int newNodeId = addToGraph(target, core::move(newNode), parent);
+	if (newNodeId == InvalidNodeId) {
+		return InvalidNodeId;
+	}
+	nodeMapping.put(sourceNode.id(), newNodeId);
+	for (int sourceNodeIdx : sourceNode.children()) {
+		if (snapshotSceneGraphNode_r(target, source, source.node(sourceNodeIdx), newNodeId, nodeMapping) ==
+			InvalidNodeId) {
+			return InvalidNodeId;
+		}
+	}
+	return newNodeId;
+}
+
+bool snapshotSceneGraph(SceneGraph &target, const SceneGraph &source) {
+	core_trace_scoped(SnapshotSceneGraph);
+	target.setAnimations(source.animations());
+	target.setAnimation(source.activeAnimation());
+	const SceneGraphNode &sourceRoot = source.root();
+	SceneGraphNode &targetRoot = target.node(target.root().id());
+	targetRoot.setName(sourceRoot.name());
+	targetRoot.addProperties(sourceRoot.properties());
+	targetRoot.setAllKeyFrames(sourceRoot.allKeyFrames(), source.activeAnimation());
+
+	NodeMapping nodeMapping((int)source.nodeSize());
+	nodeMapping.put(sourceRoot.id(), targetRoot.id());
+	for (int sourceNodeId : sourceRoot.children()) {
+		if (snapshotSceneGraphNode_r(target, source, source.node(sourceNodeId), targetRoot.id(), nodeMapping) ==
+			InvalidNodeId) {
+			Log::error("Failed to create a snapshot of the scene graph");
+			return false;
+		}
+	}
+
+	// the node ids of the snapshot might differ from the source node ids
+	for (auto iter = target.begin(SceneGraphNodeType::ModelReference); iter != target.end(); ++iter) {
+		SceneGraphNode &node = *iter;
+		int nodeId = InvalidNodeId;
+		if (!nodeMapping.get(node.reference(), nodeId)) {
+			Log::error("Failed to map the reference of node %i", node.id());
+			return false;
+		}
+		node.setReference(nodeId);
+	}
+	target.updateTransforms();
+	return true;
+}
+
+int convertDuplicatesToReferences(SceneGraph &sceneGraph) {
+	core_trace_scoped(ConvertDuplicatesToReferences);
+	core::DynamicArray<int> nodeIds;
+	for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
+		const SceneGraphNode &node = *iter;
+		// don't use volume() for compressed volumes - this would decompress them
+		if (node.isVolumeCompressed() || !node.owns() || node.volume() == nullptr) {
+			continue;
+		}
+		nodeIds.push_back(node.id());
+	}
+	if (nodeIds.size() < 2) {
+		return 0;
+	}
+	// the node with the lowest id is kept as model node
+	core::sort(nodeIds.begin(), nodeIds.end(), core::Less<int>());
+
+	// the volumes are owned by the nodes - so every volume is only hashed once
+	core::DynamicArray<const voxel::RawVolume *> volumes;
+	volumes.reserve(nodeIds.size());
+	for (int nodeId : nodeIds) {
+		volumes.push_back(sceneGraph.node(nodeId).volume());
+	}
+	core::DynamicArray<uint64_t> hashes;
+	hashes.resize(nodeIds.size());
+	core::parallelFor(
+		&app::App::getInstance()->threadPool(), 0, (int)volumes.size(),
+		[&](int from, int to) {
+			for (int i = from; i < to; ++i) {
+				hashes[i] = volumes[i]->hash();
+			}
+		},
+		1);
+
+	core::Map<uint64_t, int> models((int)nodeIds.size());
+	core::Map<int, int> converted;
+	for (size_t i = 0; i < nodeIds.size(); ++i) {
+		SceneGraphNode &node = sceneGraph.node(nodeIds[i]);
+		int modelId = InvalidNodeId;
+		if (!models.get(hashes[i], modelId)) {
+			models.put(hashes[i], node.id());
+			continue;
+		}
+		const voxel::RawVolume *model = sceneGraph.node(modelId).volume();
+		const voxel::RawVolume *volume = volumes[i];
+		if (model->region() != volume->region() ||
+			(model->data() != volume->data() &&
+			 core_memcmp(model->data(), volume->data(), voxel::RawVolume::size(volume->region())) != 0)) {
+			// hash collision
+			continue;
+		}
+		Log::debug("Convert node %i into a reference of node %i", node.id(), modelId);
+		node.setReference(modelId, true);
+		converted.put(node.id(), modelId);
+	}
+	if (converted.empty()) {
+		return 0;
+	}
+
+	// the references of the converted nodes are pointing to the model node now
+	for (auto iter = sceneGraph.begin(SceneGraphNodeType::ModelReference); iter != sceneGraph.end(); ++iter) {
+		SceneGraphNode &node = *iter;
+		int modelId = InvalidNodeId;
+		if (converted.get(node.reference(), modelId)) {
+			node.setReference(modelId);
+		}
+	}
+	sceneGraph.updateTransforms();
+	Log::debug("Converted %i duplicated models into references", (int)converted.size());
+	return (int)converted.size();
+}
+
 // TODO: SCENEGRAPH: split is destroying groups
 // TODO: SCENEGRAPH: for referenced nodes we should have to create new model references for each newly splitted model node, too
 bool splitVolumes(const scenegraph::SceneGraph &srcSceneGraph, scenegraph::SceneGraph &destSceneGraph, bool crop,
@@ -231,7 +368,7 @@ bool splitVolumes(const scenegraph::SceneGraph &srcSceneGraph, scenegraph::Scene
 			continue;
 		}
 		Log::debug("Split needed for node '%s'", node.name().c_str());
-		core::DynamicArray<voxel::RawVolume *> rawVolumes = voxelutil::splitVolume(node.volume(), maxSize, createEmpty);
+		core::DynamicArray<voxel::RawVolume *> rawVolumes = voxelutil::splitVolume(node.volume(), maxSize, createEmpty, &app::App::getInstance()->threadPool());
 		Log::debug("Created %i volumes", (int)rawVolumes.size());
 		for (voxel::RawVolume *v : rawVolumes) {
 			scenegraph::SceneGraphNode newNode(SceneGraphNodeType::Model);
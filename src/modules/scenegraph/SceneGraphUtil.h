@@ -26,11 +26,31 @@ int addSceneGraphNodes(SceneGraph &target, SceneGraph &source, int parent, const
 
 core::DynamicArray<int> copySceneGraph(SceneGraph &target, const SceneGraph &source, int parent = 0);
 
+/**
+ * @brief Creates a copy of the whole scene graph that can be saved while the source is modified further
+ *
+ * The volumes share the voxel data with the source volumes (copy on write) - so this is cheap. Unlike
+ * @c copySceneGraph() all animations and key frames are copied and the model references point to the copied nodes.
+ * @param[out] target An empty scene graph
+ */
+bool snapshotSceneGraph(SceneGraph &target, const SceneGraph &source);
+
 /**
  * @param[in] parent The parent node id - if @c -1 it will use the node parent id
  */
 int createNodeReference(SceneGraph &sceneGraph, const SceneGraphNode &node, int parent = -1);
 
+/**
+ * @brief Convert the model nodes that have the same voxels as a model node with a lower id into references of that
+ * node
+ *
+ * The volumes are compared by their content hash (@c voxel::RawVolume::hash()) and their voxel data. The region must
+ * be the same, too - otherwise the converted nodes would move. The palette, name, transform and children of the
+ * converted nodes are kept. Nodes with compressed volumes or volumes that are not owned by the node are skipped.
+ * @return The amount of converted nodes
+ */
+int convertDuplicatesToReferences(SceneGraph &sceneGraph);
+
 /**
  * @param createEmpty if @c true, for empty parts of the source volume empty volumes will be created, too. Otherwise
  * they will be ignored.
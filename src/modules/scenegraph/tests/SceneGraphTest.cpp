@@ -4,13 +4,16 @@
 
 #include "app/tests/AbstractTest.h"
 #include "core/ScopedPtr.h"
+#include "scenegraph/SceneGraphListener.h"
 #include "scenegraph/tests/TestHelper.h"
 #include "palette/tests/TestHelper.h"
 #include "math/tests/TestMathHelper.h"
+#include "voxel/CompressedVolume.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #include <glm/gtc/quaternion.hpp>
+#include <future>
 
 namespace scenegraph {
 
@@ -168,6 +171,27 @@ TEST_F(SceneGraphTest, testPaletteMergeTooManyColors) {
 	ASSERT_EQ(palette.colorCount(), 2) << palette;
 }
 
+TEST_F(SceneGraphTest, testSharedPalettes) {
+	palette::Palette pal;
+	pal.nippon();
+	SceneGraphNode node1(SceneGraphNodeType::Model);
+	node1.setPalette(pal);
+	SceneGraphNode node2(SceneGraphNodeType::Model);
+	node2.setPalette(pal);
+	const SceneGraphNode &constNode1 = node1;
+	const SceneGraphNode &constNode2 = node2;
+	EXPECT_EQ(&constNode1.palette(), &constNode2.palette()) << "The same palette should only be stored once";
+	EXPECT_TRUE(node1.samePalette(node2));
+
+	// modifying the palette of one node must not change the palette of the other node
+	const core::RGBA oldColor = constNode2.palette().color(0);
+	node1.palette().setColor(0, core::RGBA(1, 2, 3, 255));
+	EXPECT_NE(&constNode1.palette(), &constNode2.palette());
+	EXPECT_FALSE(node1.samePalette(node2));
+	EXPECT_EQ(oldColor, constNode2.palette().color(0));
+	EXPECT_EQ(core::RGBA(1, 2, 3, 255), constNode1.palette().color(0));
+}
+
 TEST_F(SceneGraphTest, testChildren) {
 	SceneGraph sceneGraph;
 	{
@@ -231,6 +255,104 @@ TEST_F(SceneGraphTest, testRemove) {
 	EXPECT_TRUE(sceneGraph.empty(SceneGraphNodeType::Model));
 }
 
+TEST_F(SceneGraphTest, testFindNodeByUUID) {
+	SceneGraph sceneGraph;
+	SceneGraphNode node(SceneGraphNodeType::Group);
+	const core::UUID uuid = node.uuid();
+	const int nodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(InvalidNodeId, nodeId);
+	SceneGraphNode *found = sceneGraph.findNodeByUUID(uuid);
+	ASSERT_NE(nullptr, found);
+	EXPECT_EQ(nodeId, found->id());
+
+	SceneGraphNode duplicate(SceneGraphNodeType::Group, uuid);
+	EXPECT_EQ(InvalidNodeId, sceneGraph.emplace(core::move(duplicate))) << "The uuid must be unique";
+
+	EXPECT_TRUE(sceneGraph.removeNode(nodeId, false));
+	EXPECT_EQ(nullptr, sceneGraph.findNodeByUUID(uuid));
+	SceneGraphNode readded(SceneGraphNodeType::Group, uuid);
+	EXPECT_NE(InvalidNodeId, sceneGraph.emplace(core::move(readded))) << "The uuid is free again after removing the node";
+}
+
+TEST_F(SceneGraphTest, testFindNodeByName) {
+	SceneGraph sceneGraph;
+	int nodeIds[2];
+	for (int i = 0; i < 2; ++i) {
+		SceneGraphNode node(SceneGraphNodeType::Group);
+		node.setName("same");
+		nodeIds[i] = sceneGraph.emplace(core::move(node));
+	}
+	ASSERT_NE(nullptr, sceneGraph.findNodeByName("same"));
+	EXPECT_EQ(nodeIds[0], sceneGraph.findNodeByName("same")->id()) << "The first added node should be found";
+	EXPECT_EQ(nullptr, sceneGraph.findNodeByName("other"));
+
+	sceneGraph.node(nodeIds[0]).setName("other");
+	ASSERT_NE(nullptr, sceneGraph.findNodeByName("other"));
+	EXPECT_EQ(nodeIds[0], sceneGraph.findNodeByName("other")->id());
+	ASSERT_NE(nullptr, sceneGraph.findNodeByName("same"));
+	EXPECT_EQ(nodeIds[1], sceneGraph.findNodeByName("same")->id());
+
+	EXPECT_TRUE(sceneGraph.removeNode(nodeIds[1], false));
+	EXPECT_EQ(nullptr, sceneGraph.findNodeByName("same"));
+
+	// the indices are moved with the scene graph
+	SceneGraph moved(core::move(sceneGraph));
+	moved.node(nodeIds[0]).setName("renamed");
+	EXPECT_EQ(nullptr, moved.findNodeByName("other"));
+	ASSERT_NE(nullptr, moved.findNodeByName("renamed"));
+	EXPECT_NE(nullptr, moved.findNodeByName("root"));
+}
+
+TEST_F(SceneGraphTest, testIterateByType) {
+	SceneGraph sceneGraph;
+	core::DynamicArray<int> modelIds;
+	for (int i = 0; i < 200; ++i) {
+		if (i % 3 == 0) {
+			SceneGraphNode node(SceneGraphNodeType::Group);
+			ASSERT_NE(InvalidNodeId, sceneGraph.emplace(core::move(node)));
+			continue;
+		}
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(new voxel::RawVolume(voxel::Region(0, 0)), true);
+		const int nodeId = sceneGraph.emplace(core::move(node));
+		ASSERT_NE(InvalidNodeId, nodeId);
+		modelIds.push_back(nodeId);
+	}
+	EXPECT_EQ(modelIds.size(), sceneGraph.size(SceneGraphNodeType::Model));
+	EXPECT_EQ(200u - modelIds.size(), sceneGraph.size(SceneGraphNodeType::Group));
+	EXPECT_EQ(201u, sceneGraph.size(SceneGraphNodeType::All));
+
+	size_t n = 0;
+	for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
+		ASSERT_LT(n, modelIds.size());
+		EXPECT_EQ(modelIds[n], (*iter).id()) << "The models should be iterated in the order of their ids";
+		++n;
+	}
+	EXPECT_EQ(modelIds.size(), n);
+
+	// removing the current node while iterating continues with the next node
+	n = 0;
+	for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
+		EXPECT_EQ(modelIds[n], (*iter).id());
+		if (n % 2 == 0) {
+			EXPECT_TRUE(sceneGraph.removeNode((*iter).id(), false));
+		}
+		++n;
+	}
+	EXPECT_EQ(modelIds.size(), n);
+	EXPECT_EQ(modelIds.size() / 2, sceneGraph.size(SceneGraphNodeType::Model));
+
+	size_t entries = 0;
+	int lastId = InvalidNodeId;
+	for (const auto &entry : sceneGraph.nodes()) {
+		EXPECT_LT(lastId, entry->key);
+		EXPECT_EQ(entry->key, entry->value.id());
+		lastId = entry->key;
+		++entries;
+	}
+	EXPECT_EQ(sceneGraph.nodes().size(), entries);
+}
+
 TEST_F(SceneGraphTest, testMerge) {
 	SceneGraph sceneGraph;
 	{
@@ -258,6 +380,47 @@ TEST_F(SceneGraphTest, testMerge) {
 	EXPECT_TRUE(voxel::isBlocked(v->voxel(1, 1, 1).getMaterial()));
 }
 
+TEST_F(SceneGraphTest, testMergeOverlapping) {
+	SceneGraph sceneGraph;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setName("node1");
+		voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(0, 3));
+		v->fill(voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		node.setVolume(v, true);
+		sceneGraph.emplace(core::move(node));
+	}
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setName("node2");
+		voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(0, 3));
+		v->setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+		node.setVolume(v, true);
+		sceneGraph.emplace(core::move(node));
+	}
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setName("node3");
+		voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(0, 1));
+		v->setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 3));
+		node.setVolume(v, true);
+		SceneGraphTransform transform;
+		transform.setWorldTranslation(glm::vec3(10));
+		node.setTransform(0, transform);
+		sceneGraph.emplace(core::move(node));
+	}
+	SceneGraph::MergeResult merged = sceneGraph.merge();
+	core::ScopedPtr<voxel::RawVolume> v(merged.volume());
+	ASSERT_NE(nullptr, v);
+	// the nodes are merged in the order they were added - the later node wins for overlapping voxels
+	EXPECT_EQ(2, v->voxel(1, 1, 1).getColor());
+	EXPECT_EQ(1, v->voxel(0, 0, 0).getColor());
+	EXPECT_EQ(1, v->voxel(3, 3, 3).getColor());
+	EXPECT_EQ(3, v->voxel(10, 10, 10).getColor());
+	EXPECT_TRUE(voxel::isAir(v->voxel(11, 11, 11).getMaterial()));
+	EXPECT_EQ(64u + 1u, v->solidVoxelCount());
+}
+
 TEST_F(SceneGraphTest, testMergeWithTranslation) {
 	SceneGraph sceneGraph;
 	{
@@ -614,6 +777,105 @@ TEST_F(SceneGraphTest, testKeyFrameTransformParentRotation2) {
 	}
 }
 
+TEST_F(SceneGraphTest, testKeyFrameForFrame) {
+	SceneGraphNode node;
+	EXPECT_EQ(1, node.addKeyFrame(10));
+	EXPECT_EQ(2, node.addKeyFrame(20));
+	EXPECT_EQ(0, node.keyFrameForFrame(0));
+	EXPECT_EQ(0, node.keyFrameForFrame(5));
+	EXPECT_EQ(1, node.keyFrameForFrame(10));
+	EXPECT_EQ(1, node.keyFrameForFrame(15));
+	EXPECT_EQ(2, node.keyFrameForFrame(25));
+	EXPECT_EQ(0, node.previousKeyFrameForFrame(0));
+	EXPECT_EQ(0, node.previousKeyFrameForFrame(10));
+	EXPECT_EQ(1, node.previousKeyFrameForFrame(15));
+	EXPECT_EQ(2, node.previousKeyFrameForFrame(25));
+	EXPECT_EQ(1, node.nextKeyFrameForFrame(0));
+	EXPECT_EQ(2, node.nextKeyFrameForFrame(10));
+	EXPECT_EQ(2, node.nextKeyFrameForFrame(20));
+	EXPECT_EQ(2, node.nextKeyFrameForFrame(25));
+	KeyFrameIndex keyFrameIdx = InvalidKeyFrame;
+	EXPECT_TRUE(node.hasKeyFrameForFrame(20, &keyFrameIdx));
+	EXPECT_EQ(2, keyFrameIdx);
+	EXPECT_FALSE(node.hasKeyFrameForFrame(15));
+}
+
+TEST_F(SceneGraphTest, testUpdateTransformsModifiedChild) {
+	SceneGraph sceneGraph;
+	voxel::RawVolume v(voxel::Region(0, 0));
+	int parentId;
+	int childId;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(&v, false);
+		node.setName("Parent");
+		node.transform(0).setWorldTranslation(glm::vec3(10.0f, 0.0f, 0.0f));
+		parentId = sceneGraph.emplace(core::move(node));
+	}
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(&v, false);
+		node.setName("Child");
+		childId = sceneGraph.emplace(core::move(node), parentId);
+	}
+	sceneGraph.updateTransforms();
+	{
+		SceneGraphNode &child = sceneGraph.node(childId);
+		child.transform(0).setLocalTranslation(glm::vec3(0.0f, 5.0f, 0.0f));
+		EXPECT_TRUE(child.transform(0).dirty());
+	}
+	sceneGraph.updateTransforms();
+	const SceneGraphNode &child = sceneGraph.node(childId);
+	EXPECT_FALSE(child.transform(0).dirty());
+	EXPECT_VEC_NEAR(glm::vec3(10.0f, 5.0f, 0.0f), child.transform(0).worldTranslation(), 0.0001f);
+	EXPECT_VEC_NEAR(glm::vec3(10.0f, 0.0f, 0.0f), sceneGraph.node(parentId).transform(0).worldTranslation(), 0.0001f);
+}
+
+TEST_F(SceneGraphTest, testBakeTransforms) {
+	SceneGraph sceneGraph;
+	voxel::RawVolume v(voxel::Region(0, 0));
+	int parentId;
+	int childId;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(&v, false);
+		node.setName("Parent");
+		parentId = sceneGraph.emplace(core::move(node));
+	}
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(&v, false);
+		node.setName("Child");
+		node.transform(0).setLocalTranslation(glm::vec3(0.0f, 1.0f, 0.0f));
+		childId = sceneGraph.emplace(core::move(node), parentId);
+	}
+	{
+		SceneGraphNode &parent = sceneGraph.node(parentId);
+		ASSERT_EQ(1, parent.addKeyFrame(20));
+		parent.keyFrame(1).transform().setLocalTranslation(glm::vec3(100.0f, 0.0f, 0.0f));
+	}
+	sceneGraph.updateTransforms();
+
+	const core::String &animation = sceneGraph.activeAnimation();
+	core::DynamicArray<FrameTransform> expected;
+	for (FrameIndex frameIdx = 0; frameIdx <= 25; ++frameIdx) {
+		expected.push_back(sceneGraph.transformForFrame(sceneGraph.node(childId), frameIdx));
+	}
+	ASSERT_TRUE(sceneGraph.bakeTransforms(animation));
+	for (FrameIndex frameIdx = 0; frameIdx <= 25; ++frameIdx) {
+		const FrameTransform &transform = sceneGraph.transformForFrame(sceneGraph.node(childId), frameIdx);
+		EXPECT_VEC_NEAR(expected[frameIdx].translation(), transform.translation(), 0.0001f) << "frame " << frameIdx;
+	}
+	EXPECT_VEC_NEAR(glm::vec3(50.0f, 1.0f, 0.0f),
+					sceneGraph.transformForFrame(sceneGraph.node(childId), 10).translation(), 0.0001f);
+
+	// modifying the key frames invalidates the baked transforms
+	sceneGraph.node(parentId).keyFrame(1).transform().setLocalTranslation(glm::vec3(200.0f, 0.0f, 0.0f));
+	sceneGraph.updateTransforms();
+	EXPECT_VEC_NEAR(glm::vec3(100.0f, 1.0f, 0.0f),
+					sceneGraph.transformForFrame(sceneGraph.node(childId), 10).translation(), 0.0001f);
+}
+
 TEST_F(SceneGraphTest, testSceneRegion) {
 	SceneGraph sceneGraph;
 	voxel::RawVolume v(voxel::Region(-3, 3));
@@ -647,4 +909,191 @@ TEST_F(SceneGraphTest, testSceneRegion) {
 	EXPECT_EQ(15, maxs.z);
 }
 
+TEST_F(SceneGraphTest, testCompressInactiveNodes) {
+	SceneGraph sceneGraph;
+	int activeNodeId;
+	int inactiveNodeId;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(new voxel::RawVolume(voxel::Region(0, 31)), true);
+		activeNodeId = sceneGraph.emplace(core::move(node));
+	}
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(0, 31));
+		v->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+		node.setVolume(v, true);
+		inactiveNodeId = sceneGraph.emplace(core::move(node));
+	}
+	ASSERT_TRUE(sceneGraph.setActiveNode(activeNodeId));
+	// the first call just records the access time
+	EXPECT_EQ(0, sceneGraph.compressInactiveNodes(0u, 1000u));
+	EXPECT_EQ(0, sceneGraph.compressInactiveNodes(500u, 1000u));
+	EXPECT_EQ(1, sceneGraph.compressInactiveNodes(1000u, 1000u, true));
+
+	SceneGraphNode &inactiveNode = sceneGraph.node(inactiveNodeId);
+	EXPECT_TRUE(inactiveNode.isVolumeCompressed());
+	EXPECT_FALSE(sceneGraph.node(activeNodeId).isVolumeCompressed());
+	EXPECT_EQ(voxel::Region(0, 31), inactiveNode.region());
+
+	const voxel::RawVolume *v = inactiveNode.volume();
+	ASSERT_NE(nullptr, v);
+	EXPECT_FALSE(inactiveNode.isVolumeCompressed());
+	EXPECT_EQ(42, v->voxel(1, 2, 3).getColor());
+	EXPECT_EQ(voxel::VoxelType::Air, v->voxel(3, 2, 1).getMaterial());
+	// accessed again - so it is not compressed
+	EXPECT_EQ(0, sceneGraph.compressInactiveNodes(2000u, 1000u));
+}
+
+TEST_F(SceneGraphTest, testCompressInactiveNodesAsync) {
+	SceneGraph sceneGraph;
+	int unmodifiedNodeId;
+	int modifiedNodeId;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(new voxel::RawVolume(voxel::Region(0, 31)), true);
+		unmodifiedNodeId = sceneGraph.emplace(core::move(node));
+	}
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(new voxel::RawVolume(voxel::Region(0, 31)), true);
+		modifiedNodeId = sceneGraph.emplace(core::move(node));
+	}
+	EXPECT_EQ(0, sceneGraph.compressInactiveNodes(0u, 1000u));
+	// the compressions are started - but only applied with the next call
+	EXPECT_EQ(0, sceneGraph.compressInactiveNodes(1000u, 1000u));
+	EXPECT_FALSE(sceneGraph.node(unmodifiedNodeId).isVolumeCompressed());
+
+	// the node is modified while its volume is compressed - the compressed copy is discarded
+	voxel::RawVolume *v = sceneGraph.node(modifiedNodeId).volume();
+	ASSERT_NE(nullptr, v);
+	v->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+
+	EXPECT_EQ(1, sceneGraph.compressInactiveNodes(1000u, 1000u, true));
+	EXPECT_TRUE(sceneGraph.node(unmodifiedNodeId).isVolumeCompressed());
+	SceneGraphNode &modifiedNode = sceneGraph.node(modifiedNodeId);
+	EXPECT_FALSE(modifiedNode.isVolumeCompressed());
+	EXPECT_EQ(42, modifiedNode.volume()->voxel(1, 2, 3).getColor());
+}
+
+TEST_F(SceneGraphTest, testLazyVolume) {
+	class LoadedListener : public SceneGraphListener {
+	public:
+		core::DynamicArray<int> loaded;
+		void onNodeVolumeLoaded(int nodeId) override {
+			loaded.push_back(nodeId);
+		}
+	};
+	LoadedListener listener;
+	SceneGraph sceneGraph;
+	sceneGraph.registerListener(&listener);
+	voxel::RawVolume v(voxel::Region(0, 31));
+	v.setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+	int nodeId;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setLazyVolume(new voxel::CompressedVolume(v));
+		nodeId = sceneGraph.emplace(core::move(node));
+	}
+	ASSERT_NE(InvalidNodeId, nodeId);
+	SceneGraphNode &node = sceneGraph.node(nodeId);
+	EXPECT_FALSE(node.isVolumeLoaded());
+	EXPECT_TRUE(node.isVolumeCompressed());
+	EXPECT_EQ(voxel::Region(0, 31), node.region());
+	EXPECT_TRUE(listener.loaded.empty());
+
+	const voxel::RawVolume *loaded = node.volume();
+	ASSERT_NE(nullptr, loaded);
+	EXPECT_TRUE(node.isVolumeLoaded());
+	EXPECT_EQ(42, loaded->voxel(1, 2, 3).getColor());
+	ASSERT_EQ(1u, listener.loaded.size());
+	EXPECT_EQ(nodeId, listener.loaded[0]);
+
+	// compressing an inactive node again doesn't count as a new load
+	ASSERT_TRUE(node.compressVolume());
+	ASSERT_NE(nullptr, node.volume());
+	EXPECT_EQ(1u, listener.loaded.size());
+	sceneGraph.unregisterListener(&listener);
+}
+
+TEST_F(SceneGraphTest, testLazyVolumeConcurrentReaders) {
+	class LoadedListener : public SceneGraphListener {
+	public:
+		core::AtomicInt loaded{0};
+		void onNodeVolumeLoaded(int) override {
+			loaded.increment(1);
+		}
+	};
+	LoadedListener listener;
+	SceneGraph sceneGraph;
+	sceneGraph.registerListener(&listener);
+	voxel::RawVolume v(voxel::Region(0, 31));
+	v.setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+	int nodeId;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setLazyVolume(new voxel::CompressedVolume(v));
+		nodeId = sceneGraph.emplace(core::move(node));
+	}
+	ASSERT_NE(InvalidNodeId, nodeId);
+	const SceneGraphNode &node = sceneGraph.node(nodeId);
+	// the const readers inflate the volume - but only one of them loads it
+	std::future<const voxel::RawVolume *> readers[4];
+	for (int i = 0; i < (int)lengthof(readers); ++i) {
+		readers[i] = std::async(std::launch::async, [&node]() { return node.volume(); });
+	}
+	const voxel::RawVolume *loaded = readers[0].get();
+	ASSERT_NE(nullptr, loaded);
+	for (int i = 1; i < (int)lengthof(readers); ++i) {
+		EXPECT_EQ(loaded, readers[i].get());
+	}
+	EXPECT_TRUE(node.isVolumeLoaded());
+	EXPECT_FALSE(node.isVolumeCompressed());
+	EXPECT_EQ(42, loaded->voxel(1, 2, 3).getColor());
+	EXPECT_EQ(1, (int)listener.loaded);
+	sceneGraph.unregisterListener(&listener);
+}
+
+TEST_F(SceneGraphTest, testSpatialIndex) {
+	SceneGraph sceneGraph;
+	voxel::RawVolume v(voxel::Region(0, 7));
+	core::DynamicArray<int> nodeIds;
+	for (int i = 0; i < 10; ++i) {
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(&v, false);
+		node.setPivot(glm::vec3(0.0f));
+		node.transform(0).setWorldTranslation(glm::vec3((float)i * 20.0f, 0.0f, 0.0f));
+		nodeIds.push_back(sceneGraph.emplace(core::move(node)));
+	}
+	sceneGraph.updateTransforms();
+
+	core::DynamicArray<int> found;
+	sceneGraph.nodesInRegion(math::AABB<float>(glm::vec3(40.0f, 0.0f, 0.0f), glm::vec3(48.0f, 8.0f, 8.0f)), 0, found);
+	ASSERT_EQ(1u, found.size());
+	EXPECT_EQ(nodeIds[2], found[0]);
+
+	const math::Ray ray(glm::vec3(-10.0f, 4.0f, 4.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+	int closestId = InvalidNodeId;
+	sceneGraph.raycastNodes(ray, 0, 1000.0f, [&](const SceneGraphNode &node, float distance) {
+		closestId = node.id();
+		return distance;
+	});
+	EXPECT_EQ(nodeIds[0], closestId);
+
+	// the index is updated for the modified node only
+	sceneGraph.node(nodeIds[2]).transform(0).setWorldTranslation(glm::vec3(500.0f, 0.0f, 0.0f));
+	sceneGraph.updateTransforms();
+	found.clear();
+	sceneGraph.nodesInRegion(math::AABB<float>(glm::vec3(40.0f, 0.0f, 0.0f), glm::vec3(48.0f, 8.0f, 8.0f)), 0, found);
+	EXPECT_TRUE(found.empty());
+	sceneGraph.nodesInRegion(math::AABB<float>(glm::vec3(500.0f, 0.0f, 0.0f), glm::vec3(508.0f, 8.0f, 8.0f)), 0, found);
+	ASSERT_EQ(1u, found.size());
+	EXPECT_EQ(nodeIds[2], found[0]);
+
+	ASSERT_TRUE(sceneGraph.removeNode(nodeIds[2], false));
+	found.clear();
+	sceneGraph.nodesInRegion(math::AABB<float>(glm::vec3(500.0f, 0.0f, 0.0f), glm::vec3(508.0f, 8.0f, 8.0f)), 0, found);
+	EXPECT_TRUE(found.empty());
+}
+
 } // namespace scenegraph
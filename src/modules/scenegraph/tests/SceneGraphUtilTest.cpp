@@ -4,6 +4,7 @@
 
 #include "scenegraph/SceneGraphUtil.h"
 #include "app/tests/AbstractTest.h"
+#include "core/StringUtil.h"
 #include "voxel/RawVolume.h"
 #include "scenegraph/SceneGraphNode.h"
 
@@ -34,4 +35,68 @@ TEST_F(SceneGraphUtilTest, testAddSceneGraphNodes) {
 	ASSERT_EQ(1, target.node(2).parent());
 }
 
+TEST_F(SceneGraphUtilTest, testSnapshotSceneGraph) {
+	SceneGraph source;
+	// create a gap in the node ids - the snapshot node ids differ from the source node ids
+	{
+		SceneGraphNode node(SceneGraphNodeType::Group);
+		source.removeNode(source.emplace(core::move(node)), false);
+	}
+	int modelNodeId = InvalidNodeId;
+	{
+		SceneGraphNode node;
+		node.setName("model");
+		voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(0, 1));
+		v->setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		node.setVolume(v, true);
+		modelNodeId = source.emplace(core::move(node));
+	}
+	ASSERT_NE(InvalidNodeId, modelNodeId);
+	ASSERT_NE(InvalidNodeId, createNodeReference(source, source.node(modelNodeId)));
+
+	SceneGraph target;
+	ASSERT_TRUE(snapshotSceneGraph(target, source));
+	ASSERT_EQ(1u, target.size(SceneGraphNodeType::Model));
+	ASSERT_EQ(1u, target.size(SceneGraphNodeType::ModelReference));
+	const SceneGraphNode *model = target.findNodeByName("model");
+	ASSERT_NE(nullptr, model);
+	const SceneGraphNode &reference = *target.begin(SceneGraphNodeType::ModelReference);
+	EXPECT_EQ(model->id(), reference.reference());
+	EXPECT_EQ(source.node(modelNodeId).uuid(), model->uuid());
+
+	// modifying the source after the snapshot was taken doesn't change the snapshot
+	source.node(modelNodeId).volume()->setVoxel(0, 0, 0, voxel::Voxel());
+	EXPECT_EQ(1, model->volume()->voxel(0, 0, 0).getColor());
+	EXPECT_TRUE(voxel::isBlocked(model->volume()->voxel(0, 0, 0).getMaterial()));
+}
+
+TEST_F(SceneGraphUtilTest, testConvertDuplicatesToReferences) {
+	SceneGraph sceneGraph;
+	const voxel::Region region(0, 3);
+	int modelIds[4];
+	for (int i = 0; i < 4; ++i) {
+		SceneGraphNode node;
+		node.setName(core::string::format("model%i", i));
+		voxel::RawVolume *volume = new voxel::RawVolume(region);
+		// the third model differs
+		volume->setVoxel(1, 1, i == 2 ? 2 : 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		node.setVolume(volume, true);
+		modelIds[i] = sceneGraph.emplace(core::move(node));
+	}
+	// a reference to a model that is converted is pointing to the first model afterwards
+	const int referenceId = createNodeReference(sceneGraph, sceneGraph.node(modelIds[3]));
+	ASSERT_NE(InvalidNodeId, referenceId);
+
+	EXPECT_EQ(2, convertDuplicatesToReferences(sceneGraph));
+	EXPECT_EQ(SceneGraphNodeType::Model, sceneGraph.node(modelIds[0]).type());
+	EXPECT_EQ(SceneGraphNodeType::ModelReference, sceneGraph.node(modelIds[1]).type());
+	EXPECT_EQ(modelIds[0], sceneGraph.node(modelIds[1]).reference());
+	EXPECT_EQ("model1", sceneGraph.node(modelIds[1]).name());
+	EXPECT_EQ(SceneGraphNodeType::Model, sceneGraph.node(modelIds[2]).type());
+	EXPECT_EQ(modelIds[0], sceneGraph.node(modelIds[3]).reference());
+	EXPECT_EQ(modelIds[0], sceneGraph.node(referenceId).reference());
+	EXPECT_TRUE(sceneGraph.validate());
+	EXPECT_EQ(0, convertDuplicatesToReferences(sceneGraph));
+}
+
 } // namespace voxelformat
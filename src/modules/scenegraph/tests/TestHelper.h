@@ -14,7 +14,7 @@ inline ::std::ostream &operator<<(::std::ostream &os, const scenegraph::SceneGra
 	os << "SceneGraph: " << sceneGraph.size() << " nodes\n";
 	for (const auto &entry : sceneGraph.nodes()) {
 		const SceneGraphNode &node = entry->second;
-		os << " - " << SceneGraphNodeTypeStr[(int)node.type()] << ": " << node.name().c_str() << " (" << node.uuid().c_str() << ")\n";
+		os << " - " << SceneGraphNodeTypeStr[(int)node.type()] << ": " << node.name().c_str() << " (" << node.uuid().str().c_str() << ")\n";
 	}
 	return os;
 }
@@ -14,10 +14,12 @@
 #endif
 
 #include "command/Command.h"
+#include "core/ArrayLength.h"
 #include "core/BindingContext.h"
 #include "core/Color.h"
 #include "core/Common.h"
 #include "core/Log.h"
+#include "core/PerfStats.h"
 #include "core/StringUtil.h"
 #include "core/TimeProvider.h"
 #include "core/Var.h"
@@ -27,6 +29,7 @@
 #include "io/Filesystem.h"
 #include "io/FormatDescription.h"
 #include "util/KeybindingHandler.h"
+#include "video/GPUTimer.h"
 #include "video/Renderer.h"
 #include "video/TextureConfig.h"
 #include "video/Types.h"
@@ -193,6 +196,8 @@ app::AppState IMGUIApp::onConstruct() {
 	_showMetrics = core::Var::get(cfg::UIShowMetrics, "false", core::CV_NOPERSIST, _("Show metric and debug window"),
 								  core::Var::boolValidator);
 #endif
+	_showGPUTimes = core::Var::get(cfg::UIShowGPUTimes, "false", core::CV_NOPERSIST,
+								   _("Show the gpu times of the render passes"), core::Var::boolValidator);
 	_uiFontSize =
 		core::Var::get(cfg::UIFontSize, "14", -1, _("Allow to change the ui font size"), [](const core::String &val) {
 			const float size = core::string::toFloat(val);
@@ -204,6 +209,8 @@ app::AppState IMGUIApp::onConstruct() {
 
 	command::Command::registerCommand("ui_showtextures",
 									  [&](const command::CmdArgs &args) { _showTexturesDialog = true; });
+	command::Command::registerCommand("ui_showstats", [&](const command::CmdArgs &args) { _showStatsDialog = true; })
+		.setHelp(_("Show the performance statistics"));
 	command::Command::registerCommand("ui_close", [&](const command::CmdArgs &args) { _closeModalPopup = true; });
 
 	return state;
@@ -517,6 +524,27 @@ void IMGUIApp::renderBindingsDialog() {
 	ImGui::End();
 }
 
+void IMGUIApp::renderGPUTimes() {
+	const ImGuiViewport *viewport = ImGui::GetMainViewport();
+	const float padding = ImGui::GetStyle().WindowPadding.x;
+	const ImVec2 pos(viewport->WorkPos.x + viewport->WorkSize.x - padding, viewport->WorkPos.y + padding);
+	ImGui::SetNextWindowPos(pos, ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+	ImGui::SetNextWindowBgAlpha(0.6f);
+	const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+								   ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+								   ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoInputs;
+	if (ImGui::Begin("##gputimes", nullptr, flags)) {
+		if (!video::hasFeature(video::Feature::TimerQuery)) {
+			ImGui::TextUnformatted(_("No support for gpu timer queries"));
+		} else {
+			for (const video::GPUTimer::PassTime &passTime : video::gpuTimer().results()) {
+				ImGui::Text("%*s%s: %.3f ms", passTime.depth * 2, "", passTime.name, passTime.millis);
+			}
+		}
+	}
+	ImGui::End();
+}
+
 void IMGUIApp::renderCvarDialog() {
 	if (ImGui::Begin(_("Configuration variables"), &_showCvarDialog, ImGuiWindowFlags_AlwaysAutoResize)) {
 		static const uint32_t TableFlags = ImGuiTableFlags_Reorderable | ImGuiTableFlags_Resizable |
@@ -601,6 +629,64 @@ void IMGUIApp::renderCommandDialog() {
 	ImGui::End();
 }
 
+void IMGUIApp::renderStatsDialog() {
+	if (ImGui::Begin(_("Performance statistics"), &_showStatsDialog)) {
+		if (ImPlot::BeginPlot("##frametimes", ImVec2(-1.0f, 150.0f), ImPlotFlags_NoInputs)) {
+			ImPlot::SetupAxes(nullptr, _("Milliseconds"), ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+			ImPlot::PlotLine(_("Frame"), _statsFrameMillis, (int)lengthof(_statsFrameMillis), 1.0, 0.0, 0,
+							 _statsFrameOffset);
+			ImPlot::EndPlot();
+		}
+		static const uint32_t TableFlags = ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersInner |
+										   ImGuiTableFlags_RowBg;
+		if (ImGui::BeginTable("##perfstats", 8, TableFlags)) {
+			ImGui::TableSetupColumn(_("Name"), ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn(_("Count"), ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn(_("Last"), ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn(_("Mean"), ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("p50", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("p90", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("p99", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn(_("Max"), ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableHeadersRow();
+			for (int i = 0; i < (int)core::PerfStat::Max; ++i) {
+				const core::PerfStat stat = (core::PerfStat)i;
+				const core::PerfStats &stats = core::perfStats(stat);
+				const bool gauge = core::perfStatType(stat) == core::PerfStatType::Gauge;
+				ImGui::TableNextColumn();
+				ImGui::Text("%s (%s)", core::perfStatName(stat), core::perfStatUnit(stat));
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", (uint32_t)stats.count);
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", (uint32_t)stats.last);
+				ImGui::TableNextColumn();
+				if (!gauge) {
+					ImGui::Text("%.1f", stats.mean());
+				}
+				ImGui::TableNextColumn();
+				if (!gauge) {
+					ImGui::Text("%u", (uint32_t)stats.p50);
+				}
+				ImGui::TableNextColumn();
+				if (!gauge) {
+					ImGui::Text("%u", (uint32_t)stats.p90);
+				}
+				ImGui::TableNextColumn();
+				if (!gauge) {
+					ImGui::Text("%u", (uint32_t)stats.p99);
+				}
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", (uint32_t)stats.max);
+			}
+			ImGui::EndTable();
+		}
+		if (ImGui::Button(_("Reset"))) {
+			core::perfReset();
+		}
+	}
+	ImGui::End();
+}
+
 void IMGUIApp::renderTexturesDialog() {
 	if (ImGui::Begin(_("Textures"), &_showTexturesDialog)) {
 		const core::DynamicSet<video::Id> &textures = video::textures();
@@ -630,9 +716,12 @@ app::AppState IMGUIApp::onRunning() {
 	if (state != app::AppState::Running) {
 		return state;
 	}
+	video::gpuTimer().setEnabled(_showGPUTimes->boolVal());
 	video::clear(video::ClearFlag::Color);
 
 	_console.update(_deltaFrameSeconds);
+	_statsFrameMillis[_statsFrameOffset] = (float)(_deltaFrameSeconds * 1000.0);
+	_statsFrameOffset = (_statsFrameOffset + 1) % (int)lengthof(_statsFrameMillis);
 
 	if (_uiKeyMap->isDirty() || _resetKeybindings) {
 		_keybindingHandler.clear();
@@ -714,6 +803,10 @@ app::AppState IMGUIApp::onRunning() {
 			renderCvarDialog();
 		}
 
+		if (_showStatsDialog) {
+			renderStatsDialog();
+		}
+
 		if (_showBindingsDialog) {
 			renderBindingsDialog();
 		}
@@ -725,6 +818,9 @@ app::AppState IMGUIApp::onRunning() {
 				_showMetrics->setVal("false");
 			}
 		}
+		if (_showGPUTimes->boolVal()) {
+			renderGPUTimes();
+		}
 		_console.renderNotifications();
 
 		core::String buf;
@@ -748,7 +844,10 @@ app::AppState IMGUIApp::onRunning() {
 	ImGui::EndFrame();
 	ImGui::Render();
 
-	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+	{
+		video_pass_scoped(UI);
+		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+	}
 
 	// Update and Render additional Platform Windows
 	if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
@@ -771,7 +870,11 @@ app::AppState IMGUIApp::onRunning() {
 			_startedFromCommandlineFrameDelay--;
 		}
 		if (_startedFromCommandlineFrameDelay == 0) {
-			ImGuiTestEngine_QueueTests(_imguiTestEngine, ImGuiTestGroup_Tests, "tests", ImGuiTestRunFlags_RunFromCommandLine);
+			if (_runPerfTests) {
+				ImGuiTestEngine_QueueTests(_imguiTestEngine, ImGuiTestGroup_Perfs, "perfs", ImGuiTestRunFlags_RunFromCommandLine);
+			} else {
+				ImGuiTestEngine_QueueTests(_imguiTestEngine, ImGuiTestGroup_Tests, "tests", ImGuiTestRunFlags_RunFromCommandLine);
+			}
 			_startedFromCommandlineFrameDelay--;
 		}
 
@@ -33,6 +33,7 @@ protected:
 	core::Set<int32_t> _keys;
 	core::VarPtr _renderUI;
 	core::VarPtr _showMetrics;
+	core::VarPtr _showGPUTimes;
 	core::VarPtr _uiFontSize;
 	video::Id _texture = video::InvalidId;
 	IMGUIConsole _console;
@@ -68,6 +69,12 @@ protected:
 	bool _showTexturesDialog = false;
 	bool _showCommandDialog = false;
 	bool _showCvarDialog = false;
+	bool _showStatsDialog = false;
+	/**
+	 * the frame times in millis of the last frames for the statistics dialog - @c _statsFrameOffset is the oldest one
+	 */
+	float _statsFrameMillis[256]{};
+	int _statsFrameOffset = 0;
 	bool _closeModalPopup = false;
 	bool _showFileDialog = false;
 	bool _imguiBackendInitialized = false;
@@ -96,6 +103,8 @@ protected:
 #ifdef IMGUI_ENABLE_TEST_ENGINE
 	ImGuiTestEngine *_imguiTestEngine = nullptr;
 	int _startedFromCommandlineFrameDelay = 3;
+	// run the perf scenarios (ImGuiTestGroup_Perfs) instead of the tests in command line mode
+	bool _runPerfTests = false;
 	// used for the imgui test engine (IM_REGISTER_TEST)
 	virtual bool registerUITests() {
 		_fileDialog.registerUITests(_imguiTestEngine, "filedialog");
@@ -126,7 +135,17 @@ protected:
 	void renderBindingsDialog();
 	void renderTexturesDialog();
 	void renderCvarDialog();
+	/**
+	 * @brief Renders the always-on performance statistics
+	 * @sa core::perfStats()
+	 */
+	void renderStatsDialog();
 	void renderCommandDialog();
+	/**
+	 * @brief Renders an overlay with the gpu times of the render passes
+	 * @sa video::GPUTimer
+	 */
+	void renderGPUTimes();
 public:
 	IMGUIApp(const io::FilesystemPtr& filesystem, const core::TimeProviderPtr& timeProvider, size_t threadPoolSize = 1);
 	virtual ~IMGUIApp();
@@ -168,6 +187,7 @@ public:
 	void showBindingsDialog();
 	void showTexturesDialog();
 	void showCvarDialog();
+	void showStatsDialog();
 	void showCommandDialog();
 	void fileDialog(const video::FileDialogSelectionCallback& callback, const video::FileDialogOptions& options, video::OpenFileMode mode, const io::FormatDescription* formats = nullptr, const core::String &filename = "") override;
 };
@@ -184,6 +204,10 @@ inline void IMGUIApp::showCvarDialog() {
 	_showCvarDialog = true;
 }
 
+inline void IMGUIApp::showStatsDialog() {
+	_showStatsDialog = true;
+}
+
 inline void IMGUIApp::showCommandDialog() {
 	_showCommandDialog = true;
 }
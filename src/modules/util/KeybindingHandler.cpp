@@ -70,7 +70,7 @@ bool isValidForBinding(int16_t pressedModMask, int16_t commandModMask) {
  * @return @c true if the key+modifier combination lead to a command execution via
  * key bindings, @c false otherwise
  */
-static bool executeCommandsForBinding(const BindMap& bindings, int32_t key, int16_t modMask, double nowSeconds, uint16_t count) {
+static bool executeCommandsForBinding(BindMap& bindings, int32_t key, int16_t modMask, double nowSeconds, uint16_t count) {
 	auto range = bindings.equal_range(key);
 	const int16_t modifier = modMask & (KMOD_SHIFT | KMOD_CONTROL | KMOD_ALT);
 	bool handled = false;
@@ -88,7 +88,7 @@ static bool executeCommandsForBinding(const BindMap& bindings, int32_t key, int1
 		}
 		Log::trace("Execute the command %s for key %i", command.c_str(), key);
 		if (command[0] == COMMAND_PRESSED[0]) {
-			if (command::Command::execute("%s %i %f", command.c_str(), key, nowSeconds) == 1) {
+			if (i->second.handle.execute({core::string::toString(key), core::string::toString(nowSeconds)})) {
 				Log::trace("The tracking command was executed");
 				handled = true;
 				continue;
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "command/Command.h"
 #include "core/BindingContext.h"
 #include "core/String.h"
 #include <unordered_map>
@@ -12,12 +13,14 @@ namespace util {
 
 struct CommandModifierPair {
 	inline CommandModifierPair(const core::String& _command, int16_t _modifier, uint16_t _count, core::BindingContext _context) :
-			command(_command), modifier(_modifier), count(_count), context(_context) {
+			command(_command), modifier(_modifier), count(_count), context(_context), handle(_command) {
 	}
 	core::String command;
 	int16_t modifier;
 	uint16_t count;
 	core::BindingContext context;
+	// resolves the action button commands once - they are executed for every key repeat
+	command::CommandHandle handle;
 };
 typedef std::unordered_multimap<int32_t, CommandModifierPair> BindMap;
 
@@ -6,6 +6,8 @@
 #include "Renderer.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
 
 namespace video {
 
@@ -59,6 +61,14 @@ Id Buffer::bufferHandle(int32_t idx) const {
 
 void Buffer::setMode(int32_t idx, BufferMode mode) {
 	core_assert(idx >= 0 && idx < MAX_HANDLES);
+	if (mode != BufferMode::Persistent && _mapped[idx] != nullptr) {
+		// the immutable storage can't get respecified
+		releasePersistent(idx);
+		video::deleteBuffer(_handles[idx]);
+		_handles[idx] = video::genBuffer();
+		_size[idx] = 0u;
+		_dirtyAttributes = true;
+	}
 	_modes[idx] = mode;
 }
 
@@ -110,7 +120,13 @@ bool Buffer::bind() const {
 			continue;
 		}
 		video::bindBuffer(_targets[a.bufferIndex], _handles[a.bufferIndex]);
-		video::configureAttribute(a);
+		if (_offset[a.bufferIndex] != 0) {
+			Attribute regionAttribute = a;
+			regionAttribute.offset += _offset[a.bufferIndex];
+			video::configureAttribute(regionAttribute);
+		} else {
+			video::configureAttribute(a);
+		}
 	}
 	for (unsigned int i = 0; i < _handleIdx; ++i) {
 		if (_targets[i] != BufferType::IndexBuffer) {
@@ -146,6 +162,11 @@ bool Buffer::clear(int32_t idx) {
 		return false;
 	}
 
+	if (_mapped[idx] != nullptr) {
+		// the immutable storage can't get invalidated - but the content is undefined after a clear anyway
+		return true;
+	}
+
 	const BufferType type = _targets[idx];
 	const Id id = _handles[idx];
 	const size_t size = _size[idx];
@@ -153,6 +174,62 @@ bool Buffer::clear(int32_t idx) {
 	return true;
 }
 
+void Buffer::releasePersistent(int32_t idx) {
+	for (int i = 0; i < PERSISTENT_REGIONS; ++i) {
+		video::deleteFence(_fences[idx][i]);
+	}
+	_mapped[idx] = nullptr;
+	_capacity[idx] = 0u;
+	_offset[idx] = 0;
+	_region[idx] = 0;
+}
+
+bool Buffer::allocPersistent(int32_t idx, size_t size) {
+	// the storage is immutable - a new buffer is needed to grow it. Deleting the buffer also unmaps it.
+	releasePersistent(idx);
+	video::deleteBuffer(_handles[idx]);
+	_handles[idx] = video::genBuffer();
+	if (_handles[idx] == InvalidId) {
+		Log::error("Failed to create buffer (size: %i)", (int)size);
+		return false;
+	}
+	// the vertex array has to point to the new buffer
+	_dirtyAttributes = true;
+	const size_t capacity = align(size + size / 2, _targets[idx]);
+	_mapped[idx] = (uint8_t *)video::bufferStorage(_handles[idx], _targets[idx], capacity * PERSISTENT_REGIONS);
+	if (_mapped[idx] == nullptr) {
+		return false;
+	}
+	_capacity[idx] = capacity;
+	return true;
+}
+
+bool Buffer::updatePersistent(int32_t idx, const void* data, size_t size) {
+	if (size > _capacity[idx]) {
+		if (!allocPersistent(idx, size)) {
+			return false;
+		}
+	} else {
+		// all the draws that are reading from the current region are already submitted
+		core_assert(_fences[idx][_region[idx]] == InvalidIdPtr);
+		_fences[idx][_region[idx]] = video::genFenc();
+		_region[idx] = (_region[idx] + 1) % PERSISTENT_REGIONS;
+		IdPtr &fence = _fences[idx][_region[idx]];
+		if (fence != InvalidIdPtr) {
+			core_trace_scoped(BufferWaitFence);
+			// one second in nanoseconds - the region is usually released frames before
+			if (!video::checkFence(fence, 1000000000u)) {
+				Log::warn("Timeout while waiting for the gpu to release the buffer region");
+			}
+			video::deleteFence(fence);
+		}
+	}
+	_offset[idx] = (intptr_t)(_region[idx] * _capacity[idx]);
+	core_memcpy(_mapped[idx] + _offset[idx], data, size);
+	_dirtyAttributes = true;
+	return true;
+}
+
 bool Buffer::update(int32_t idx, const void* data, size_t size, bool orphaning) {
 	if (!isValid(idx)) {
 		return false;
@@ -177,6 +254,18 @@ bool Buffer::update(int32_t idx, const void* data, size_t size, bool orphaning)
 #endif
 	//core_assert_msg((_size[idx] & 15) == 0, "Size is not aligned properly: %i", (int)_size[idx]);
 	const BufferType type = _targets[idx];
+	if (_modes[idx] == BufferMode::Persistent && type == BufferType::ArrayBuffer && size > 0) {
+		if (updatePersistent(idx, data, size)) {
+			return true;
+		}
+		if (!isValid(idx)) {
+			return false;
+		}
+		// no buffer storage support - this is a new mutable buffer now
+		_modes[idx] = BufferMode::Stream;
+		video::bufferData(_handles[idx], type, _modes[idx], data, size);
+		return true;
+	}
 	const Id id = _handles[idx];
 	if (size > 0 && oldSize >= size && _modes[idx] != BufferMode::Static) {
 		video::bufferSubData(id, type, 0, data, size);
@@ -437,6 +526,9 @@ Buffer::~Buffer() {
 }
 
 void Buffer::shutdown() {
+	for (uint32_t i = 0u; i < _handleIdx; ++i) {
+		releasePersistent((int32_t)i);
+	}
 	video::deleteVertexArray(_vao);
 	video::deleteBuffers(_handleIdx, _handles);
 	_handleIdx = 0;
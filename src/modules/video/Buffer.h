@@ -29,11 +29,25 @@ private:
 	BufferMode _modes[MAX_HANDLES] = {BufferMode::Static, BufferMode::Static, BufferMode::Static, BufferMode::Static, BufferMode::Static, BufferMode::Static, BufferMode::Static, BufferMode::Static};
 	uint32_t _handleIdx = 0u;
 
+	// the persistent mapped buffers are split into regions - the gpu might still read from the previous regions
+	// while the next one is written
+	static constexpr int PERSISTENT_REGIONS = 3;
+	uint8_t *_mapped[MAX_HANDLES] = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+	// the size of one region of the persistent mapped buffers
+	size_t _capacity[MAX_HANDLES] = {0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u};
+	// the offset of the region that was written last
+	intptr_t _offset[MAX_HANDLES] = {0, 0, 0, 0, 0, 0, 0, 0};
+	int _region[MAX_HANDLES] = {0, 0, 0, 0, 0, 0, 0, 0};
+	IdPtr _fences[MAX_HANDLES][PERSISTENT_REGIONS] {};
+
 	core::List<Attribute> _attributes;
 	mutable Id _vao = InvalidId;
 	mutable bool _dirtyAttributes = true;
 
 	static size_t align(size_t x, BufferType type);
+	bool allocPersistent(int32_t idx, size_t size);
+	bool updatePersistent(int32_t idx, const void* data, size_t size);
+	void releasePersistent(int32_t idx);
 public:
 	/**
 	 * @brief Ctor that also creates buffer handle.
@@ -63,6 +77,10 @@ public:
 	 * @note This is useful when you are using different graphic contexts
 	 */
 	void destroyVertexArray();
+	/**
+	 * @note Array buffers in @c BufferMode::Persistent are written into the next region of the persistent mapped
+	 * memory - the vertex attributes are pointed to that region with the next @c bind() call
+	 */
 	bool update(int32_t idx, const void* data, size_t size, bool orphaning = false);
 
 	/**
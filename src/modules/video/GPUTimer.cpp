@@ -0,0 +1,120 @@
+/**
+ * @file
+ */
+
+#include "GPUTimer.h"
+#include "core/Singleton.h"
+#include "video/Renderer.h"
+
+namespace video {
+
+GPUTimer &gpuTimer() {
+	return core::Singleton<GPUTimer>::getInstance();
+}
+
+void GPUTimer::setEnabled(bool enabled) {
+	_enabled = enabled && hasFeature(Feature::TimerQuery);
+}
+
+Id GPUTimer::query() {
+	if (!_freeQueries.empty()) {
+		const Id id = _freeQueries.back();
+		_freeQueries.pop();
+		return id;
+	}
+	return genQuery();
+}
+
+void GPUTimer::begin(const char *name) {
+	if (!_enabled) {
+		return;
+	}
+	core::DynamicArray<Pass> &passes = _passes[_buffer];
+	Pass pass{name, (int)_open.size(), query(), InvalidId};
+	queryTimestamp(pass.begin);
+	_open.push_back((int)passes.size());
+	passes.push_back(pass);
+}
+
+void GPUTimer::end() {
+	// the timer might have been enabled in between
+	if (_open.empty()) {
+		return;
+	}
+	Pass &pass = _passes[_buffer][_open.back()];
+	_open.pop();
+	pass.end = query();
+	queryTimestamp(pass.end);
+}
+
+void GPUTimer::release(core::DynamicArray<Pass> &passes) {
+	for (const Pass &pass : passes) {
+		_freeQueries.push_back(pass.begin);
+		if (pass.end != InvalidId) {
+			_freeQueries.push_back(pass.end);
+		}
+	}
+	passes.clear();
+}
+
+void GPUTimer::collect(const core::DynamicArray<Pass> &passes) {
+	if (passes.empty()) {
+		return;
+	}
+	// the nested passes end before their parents - all of them must be executed
+	for (const Pass &pass : passes) {
+		if (!isQueryResultAvailable(pass.end)) {
+			return;
+		}
+	}
+	_results.clear();
+	for (const Pass &pass : passes) {
+		const uint64_t begin = timestampResult(pass.begin);
+		const uint64_t end = timestampResult(pass.end);
+		const double millis = end > begin ? (double)(end - begin) / 1000000.0 : 0.0;
+		// the passes of e.g. multiple viewports are summed up
+		PassTime *passTime = nullptr;
+		for (PassTime &t : _results) {
+			if (t.name == pass.name && t.depth == pass.depth) {
+				passTime = &t;
+				break;
+			}
+		}
+		if (passTime == nullptr) {
+			_results.push_back(PassTime{pass.name, pass.depth, millis});
+		} else {
+			passTime->millis += millis;
+		}
+	}
+}
+
+void GPUTimer::frameEnd() {
+	// passes that are still open end with the frame
+	while (!_open.empty()) {
+		end();
+	}
+	// the passes of the previous frame
+	const int buffer = (_buffer + 1) % Buffers;
+	collect(_passes[buffer]);
+	release(_passes[buffer]);
+	if (!_enabled) {
+		release(_passes[_buffer]);
+		_results.clear();
+	}
+	_buffer = buffer;
+}
+
+void GPUTimer::shutdown() {
+	_open.clear();
+	for (int i = 0; i < Buffers; ++i) {
+		release(_passes[i]);
+	}
+	for (Id &id : _freeQueries) {
+		deleteQuery(id);
+	}
+	_freeQueries.release();
+	_results.release();
+	_enabled = false;
+}
+
+} // namespace video
@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+#include "video/Trace.h"
+#include "video/Types.h"
+
+namespace video {
+
+/**
+ * @brief Measures the gpu time of the render passes
+ *
+ * A timestamp query is recorded at the begin and at the end of each pass - this allows to nest the passes. The
+ * queries are double buffered: the results of a frame are read at the end of the next frame to not stall the
+ * pipeline. The results of a frame are dropped if the gpu didn't execute them in time.
+ *
+ * @note Without @c Feature::TimerQuery nothing is measured
+ * @sa video_pass_scoped()
+ */
+class GPUTimer : public core::NonCopyable {
+public:
+	static constexpr int Buffers = 2;
+
+	struct PassTime {
+		const char *name = nullptr;
+		// the nesting level of the pass
+		int depth = 0;
+		// the summed gpu time of all the executions of the pass in a frame
+		double millis = 0.0;
+	};
+
+private:
+	struct Pass {
+		const char *name;
+		int depth;
+		Id begin;
+		Id end;
+	};
+	core::DynamicArray<Pass> _passes[Buffers];
+	// the indices of the passes that are not yet finished
+	core::DynamicArray<int> _open;
+	core::DynamicArray<Id> _freeQueries;
+	core::DynamicArray<PassTime> _results;
+	int _buffer = 0;
+	bool _enabled = false;
+
+	Id query();
+	void release(core::DynamicArray<Pass> &passes);
+	void collect(const core::DynamicArray<Pass> &passes);
+
+public:
+	/**
+	 * @brief The passes are only measured if the timer is enabled
+	 */
+	void setEnabled(bool enabled);
+	bool enabled() const;
+
+	void begin(const char *name);
+	void end();
+
+	/**
+	 * @brief Reads the results of the previous frame and starts a new frame
+	 */
+	void frameEnd();
+	void shutdown();
+
+	/**
+	 * @return The gpu times of the passes in the order they started in the last measured frame
+	 */
+	const core::DynamicArray<PassTime> &results() const;
+};
+
+inline bool GPUTimer::enabled() const {
+	return _enabled;
+}
+
+inline const core::DynamicArray<GPUTimer::PassTime> &GPUTimer::results() const {
+	return _results;
+}
+
+GPUTimer &gpuTimer();
+
+class ScopedGPUTimer {
+public:
+	ScopedGPUTimer(const char *name) {
+		gpuTimer().begin(name);
+	}
+	~ScopedGPUTimer() {
+		gpuTimer().end();
+	}
+};
+
+/**
+ * @brief Measures the gpu time of a render pass for the gpu timer overlay and adds a gpu zone to the trace
+ * @note Can be used next to a @c core_trace_scoped() zone with the same name
+ */
+#define video_pass_scoped(name)                                                                                        \
+	video_trace_scoped(name##Pass);                                                                                    \
+	video::ScopedGPUTimer __gpu_timer__##name(#name)
+
+} // namespace video
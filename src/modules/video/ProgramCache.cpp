@@ -0,0 +1,104 @@
+/**
+ * @file
+ */
+
+#include "ProgramCache.h"
+#include "core/FourCC.h"
+#include "core/Hash.h"
+#include "core/Log.h"
+#include "core/ScopedPtr.h"
+#include "core/StringUtil.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "video/Renderer.h"
+
+namespace video {
+
+static constexpr uint32_t ProgramCacheMagic = FourCC('V', 'P', 'C', 'H');
+static constexpr uint32_t ProgramCacheVersion = 1u;
+static constexpr uint64_t FNVPrime = 1099511628211UL;
+
+static inline uint64_t hashValue(uint64_t hash, uint64_t value) {
+	return (hash ^ value) * FNVPrime;
+}
+
+ProgramCache::ProgramCache(const io::ArchivePtr &archive, const core::String &prefix)
+	: _archive(archive), _prefix(prefix) {
+}
+
+core::String ProgramCache::entryName(uint64_t key) const {
+	return core::string::format("%s%08x%08x.bin", _prefix.c_str(), (uint32_t)(key >> 32u), (uint32_t)key);
+}
+
+uint64_t ProgramCache::key(const core::String &driver, const Sources &sources) {
+	uint64_t hash = core::hash("programcache");
+	hash = hashValue(hash, ProgramCacheVersion);
+	hash = hashValue(hash, core::hash(driver.c_str()));
+	for (int i = 0; i < (int)sources.size(); ++i) {
+		hash = hashValue(hash, (uint64_t)i);
+		hash = hashValue(hash, core::hash(sources[i].c_str()));
+	}
+	return hash;
+}
+
+bool ProgramCache::load(uint64_t key, Id program, const core::String &name) {
+	core_trace_scoped(ProgramCacheLoad);
+	const core::String &entry = entryName(key);
+	if (!_archive->exists(entry)) {
+		return false;
+	}
+	core::ScopedPtr<io::SeekableReadStream> stream(_archive->readStream(entry));
+	if (!stream) {
+		return false;
+	}
+	uint32_t magic = 0u;
+	uint32_t version = 0u;
+	uint64_t storedKey = 0u;
+	uint32_t format = 0u;
+	uint32_t size = 0u;
+	if (stream->readUInt32(magic) != 0 || stream->readUInt32(version) != 0 || stream->readUInt64(storedKey) != 0 ||
+		stream->readUInt32(format) != 0 || stream->readUInt32(size) != 0) {
+		return false;
+	}
+	if (magic != ProgramCacheMagic || version != ProgramCacheVersion || storedKey != key || size == 0u ||
+		(int64_t)size > stream->remaining()) {
+		Log::debug("Invalid program cache entry %s for %s", entry.c_str(), name.c_str());
+		return false;
+	}
+	core::DynamicArray<uint8_t> binary;
+	binary.resize(size);
+	if (stream->read(binary.data(), size) != (int)size) {
+		return false;
+	}
+	if (!video::programBinary(program, format, binary.data(), binary.size(), name)) {
+		return false;
+	}
+	Log::debug("Loaded the program %s from the cache", name.c_str());
+	return true;
+}
+
+bool ProgramCache::store(uint64_t key, Id program, const core::String &name) {
+	core_trace_scoped(ProgramCacheStore);
+	uint32_t format = 0u;
+	core::DynamicArray<uint8_t> binary;
+	if (!video::getProgramBinary(program, format, binary)) {
+		Log::debug("Could not retrieve the program binary of %s", name.c_str());
+		return false;
+	}
+	const core::String &entry = entryName(key);
+	core::ScopedPtr<io::SeekableWriteStream> stream(_archive->writeStream(entry));
+	if (!stream) {
+		return false;
+	}
+	// entries might get overwritten - the size of the binary marks the end of the entry
+	stream->seek(0);
+	if (!stream->writeUInt32(ProgramCacheMagic) || !stream->writeUInt32(ProgramCacheVersion) ||
+		!stream->writeUInt64(key) || !stream->writeUInt32(format) || !stream->writeUInt32((uint32_t)binary.size()) ||
+		stream->write(binary.data(), binary.size()) != (int)binary.size()) {
+		Log::error("Failed to write the program cache entry %s for %s", entry.c_str(), name.c_str());
+		return false;
+	}
+	return true;
+}
+
+} // namespace video
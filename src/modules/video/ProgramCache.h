@@ -0,0 +1,52 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "ShaderTypes.h"
+#include "core/String.h"
+#include "core/collection/Array.h"
+#include "io/Archive.h"
+#include <stdint.h>
+
+namespace video {
+
+/**
+ * @brief Stores the binaries of the linked shader programs in an archive
+ *
+ * The entries are keyed by a hash of the driver and the final sources of the shader stages - a program that was
+ * linked before doesn't need to be compiled again. The driver rejects outdated binaries - the shaders are compiled
+ * and linked then and the entry is replaced.
+ *
+ * @note Only available with @c Feature::ProgramBinary
+ * @sa ShaderManager::setProgramCache()
+ */
+class ProgramCache {
+public:
+	typedef core::Array<core::String, (int)ShaderType::Max> Sources;
+
+private:
+	io::ArchivePtr _archive;
+	core::String _prefix;
+
+	core::String entryName(uint64_t key) const;
+
+public:
+	ProgramCache(const io::ArchivePtr &archive, const core::String &prefix = "shadercache/");
+
+	/**
+	 * @param driver See @c video::driverIdentifier()
+	 * @param sources The sources of the shader stages - empty for the unused stages
+	 */
+	static uint64_t key(const core::String &driver, const Sources &sources);
+
+	/**
+	 * @return @c false if there is no valid entry for the key or the driver rejected the binary - the shaders
+	 * have to be linked then
+	 */
+	bool load(uint64_t key, Id program, const core::String &name);
+	bool store(uint64_t key, Id program, const core::String &name);
+};
+
+} // namespace video
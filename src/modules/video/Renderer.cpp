@@ -20,7 +20,9 @@ static const char *featuresArray[] = {
 	"r_instancedarrays",		"r_debugoutput",
 	"r_directstateaccess",		"r_bufferstorage",
 	"r_multidrawindirect",		"r_computeshaders",
-	"r_transformfeedback",		"r_shaderstoragebufferobject"
+	"r_transformfeedback",		"r_shaderstoragebufferobject",
+	"r_programbinary",			"r_parallelshadercompile",
+	"r_timerquery"
 };
 static_assert(core::enumVal(Feature::Max) == (int)lengthof(featuresArray), "Array sizes don't match with Feature enum");
 static core::VarPtr featureVars[core::enumVal(Feature::Max)];
@@ -82,6 +84,20 @@ void deleteBuffer(Id& id) {
 	id = InvalidId;
 }
 
+void deleteQuery(Id& id) {
+	if (id == InvalidId) {
+		return;
+	}
+	deleteQueries(1, &id);
+	id = InvalidId;
+}
+
+Id genQuery() {
+	Id id;
+	genQueries(1, &id);
+	return id;
+}
+
 Id genVertexArray() {
 	Id id;
 	genVertexArrays(1, &id);
@@ -124,6 +124,15 @@ inline void drawElements(Primitive mode, size_t numIndices, size_t indexSize, vo
 	drawElements(mode, numIndices, mapIndexTypeBySize(indexSize), offset);
 }
 
+inline void drawElementsInstanced(Primitive mode, size_t numIndices, size_t indexSize, int amount,
+								  void *offset = nullptr) {
+	drawElementsInstanced(mode, numIndices, mapIndexTypeBySize(indexSize), amount, offset);
+}
+
+inline void multiDrawElementsIndirect(Primitive mode, size_t indexSize, size_t offset, int drawCount) {
+	multiDrawElementsIndirect(mode, mapIndexTypeBySize(indexSize), offset, drawCount);
+}
+
 inline bool hasFeature(Feature feature) {
 	return renderState().supports(feature);
 }
@@ -135,6 +144,8 @@ void deleteTexture(Id &id);
 void deleteRenderbuffer(Id &id);
 void deleteBuffer(Id &id);
 Id genBuffer();
+void deleteQuery(Id &id);
+Id genQuery();
 Id genTexture(const TextureConfig &cfg);
 Id genVertexArray();
 Id genRenderbuffer();
@@ -7,6 +7,7 @@
 #include "RenderBuffer.h"
 #include "ShaderTypes.h"
 #include "core/SharedPtr.h"
+#include "core/collection/DynamicArray.h"
 #include "core/collection/DynamicSet.h"
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
@@ -101,17 +102,57 @@ bool bindTexture(TextureUnit unit, TextureType type, Id handle);
  * @note The returned buffer should get freed with SDL_free
  */
 bool readTexture(TextureUnit unit, TextureType type, TextureFormat format, Id handle, int w, int h, uint8_t **pixels);
+/**
+ * @brief Queues the copy of the texture pixels into the given @c BufferType::PixelPackBuffer - this doesn't wait for
+ * the gpu
+ * @note The buffer must be big enough for the texture. Use a fence to know when the pixels can get mapped.
+ * @sa TextureReadback
+ */
+bool readTextureToBuffer(TextureUnit unit, TextureType type, TextureFormat format, Id handle, Id buffer);
 bool useProgram(Id handle);
 Id getProgram();
 bool bindVertexArray(Id handle);
 Id boundVertexArray();
 Id boundBuffer(BufferType type);
+/**
+ * @return @c nullptr on failure - the buffer must get unmapped before it is used by the gpu again
+ */
+void *mapBuffer(Id handle, BufferType type, AccessMode mode);
 void unmapBuffer(Id handle, BufferType type);
 bool bindBuffer(BufferType type, Id handle);
 bool unbindBuffer(BufferType type);
 bool bindBufferBase(BufferType type, Id handle, uint32_t index = 0u);
+/**
+ * @brief Binds a part of the buffer to the indexed binding point
+ * @param offset The offset in bytes - must be a multiple of @c Spec::UniformBufferAlignment for uniform buffers
+ */
+bool bindBufferRange(BufferType type, Id handle, uint32_t index, intptr_t offset, size_t size);
 void genBuffers(uint8_t amount, Id *ids);
 void deleteBuffers(uint8_t amount, Id *ids);
+void genQueries(uint8_t amount, Id *ids);
+void deleteQueries(uint8_t amount, Id *ids);
+bool beginQuery(QueryType type, Id id);
+bool endQuery(QueryType type);
+/**
+ * @return @c true if the result of the query can be read without waiting for the gpu
+ */
+bool isQueryResultAvailable(Id id);
+/**
+ * @note Blocks until the result is available
+ * @sa isQueryResultAvailable()
+ */
+uint32_t queryResult(Id id);
+/**
+ * @brief Records the gpu time in nanoseconds once all previous commands are executed
+ * @note Unlike @c QueryType::TimeElapsed this can be nested - see Feature::TimerQuery
+ * @sa timestampResult()
+ */
+bool queryTimestamp(Id id);
+/**
+ * @note Blocks until the result is available
+ * @sa isQueryResultAvailable()
+ */
+uint64_t timestampResult(Id id);
 void genVertexArrays(uint8_t amount, Id *ids);
 void deleteShader(Id &id);
 Id genShader(ShaderType type);
@@ -144,6 +185,13 @@ bool setupRenderBuffer(TextureFormat format, int w, int h, int samples);
 Id bindRenderbuffer(Id handle);
 void bufferData(Id handle, BufferType type, BufferMode mode, const void *data, size_t size);
 void bufferSubData(Id handle, BufferType type, intptr_t offset, const void *data, size_t size);
+/**
+ * @brief Allocates the immutable storage of the buffer and maps it persistent and coherent for writing
+ * @note The mapping stays valid until the buffer is deleted - use fences to not overwrite data that is still used
+ * by the gpu. The storage can't get resized - a new buffer is needed for this.
+ * @return @c nullptr on failure or if @c Feature::BufferStorage isn't supported
+ */
+void *bufferStorage(Id handle, BufferType type, size_t size);
 const glm::vec4 &framebufferUV();
 bool bindFrameBufferAttachment(Id texture, FrameBufferAttachment attachment, int layerIndex, bool clear);
 bool setupFramebuffer(const TexturePtr (&colorTextures)[core::enumVal(FrameBufferAttachment::Max)],
@@ -151,12 +199,50 @@ bool setupFramebuffer(const TexturePtr (&colorTextures)[core::enumVal(FrameBuffe
 void setupTexture(const TextureConfig &config);
 void uploadTexture(video::TextureType type, video::TextureFormat format, int width, int height, const uint8_t *data,
 				   int index, int samples);
+/**
+ * @brief Replaces a box of texels of the texture that is bound to @c TextureUnit::Upload
+ * @param data The tightly packed texels of the box - the texture storage must already exist
+ */
+void uploadTextureRegion(video::TextureType type, video::TextureFormat format, int x, int y, int z, int width,
+						 int height, int depth, const uint8_t *data);
+/**
+ * @brief Generates the mipmap levels of the texture that is bound to @c TextureUnit::Upload from the base level
+ * @sa TextureConfig::mipmaps()
+ */
+void generateMipmaps(video::TextureType type);
 void drawElements(Primitive mode, size_t numIndices, DataType type, void *offset = nullptr);
+/**
+ * @brief Draws the indices @c amount times - the attributes with a divisor advance per instance
+ * @note Only available with @c Feature::InstancedArrays
+ */
+void drawElementsInstanced(Primitive mode, size_t numIndices, DataType type, int amount, void *offset = nullptr);
+/**
+ * @brief Executes the draw commands of the bound @c BufferType::IndirectBuffer with one call
+ * @param offset The offset of the first @c DrawElementsIndirectCommand in the indirect buffer in bytes
+ * @param drawCount The amount of commands to execute
+ * @note Only available with @c Feature::MultiDrawIndirect
+ */
+void multiDrawElementsIndirect(Primitive mode, DataType type, size_t offset, int drawCount);
 void drawArrays(Primitive mode, size_t count);
 void enableDebug(DebugSeverity severity);
 bool compileShader(Id id, ShaderType shaderType, const core::String &source, const core::String &name = "unknown-shader");
 bool linkShader(Id program, Id vert, Id frag, Id geom, const core::String &name = "unknown-shader");
 bool linkComputeShader(Id program, Id comp, const core::String &name = "unknown-shader");
+/**
+ * @brief Retrieve the binary of a linked program to load it with @c programBinary() later
+ * @note Only available with @c Feature::ProgramBinary
+ */
+bool getProgramBinary(Id program, uint32_t &format, core::DynamicArray<uint8_t> &binary);
+/**
+ * @brief Load a program from a binary that was retrieved with @c getProgramBinary() instead of linking the shaders
+ * @return @c false if the driver rejected the binary - e.g. because it was updated in the meantime
+ */
+bool programBinary(Id program, uint32_t format, const uint8_t *binary, size_t size,
+				   const core::String &name = "unknown-shader");
+/**
+ * @brief The program binaries are only valid for the driver this identifies
+ */
+const core::String &driverIdentifier();
 bool bindImage(Id handle, AccessMode mode, ImageFormat format);
 /**
  * @brief Execute a compute shader
@@ -16,6 +16,7 @@
 #include "core/Enum.h"
 #include "core/Singleton.h"
 #include "core/StringUtil.h"
+#include "ProgramCache.h"
 #include "ShaderManager.h"
 #include "UniformBuffer.h"
 #include "video/Renderer.h"
@@ -161,6 +162,9 @@ void Shader::shutdown() {
 	for (auto& shader : _shader) {
 		video::deleteShader(shader);
 	}
+	for (auto& source : _sources) {
+		source.clear();
+	}
 	_uniformStateMap.clear();
 	video::deleteProgram(_program);
 	_initialized = false;
@@ -184,22 +188,7 @@ bool Shader::load(const core::String& name, const core::String& buffer, ShaderTy
 		return false;
 	}
 	_name = name;
-	const core::String& source = getSource(shaderType, buffer);
-
-	Id id = getShader(shaderType);
-	if (id == InvalidId) {
-		id = video::genShader(shaderType);
-		if (id == InvalidId) {
-			Log::error("Failed to generate shader handle for %s\n", name.c_str());
-			return false;
-		}
-		_shader[(int)shaderType] = id;
-	}
-	if (!video::compileShader(id, shaderType, source, _name)) {
-		_shader[(int)shaderType] = InvalidId;
-		Log::error("Failed to compile shader for %s\n", name.c_str());
-		return false;
-	}
+	_sources[(int)shaderType] = getSource(shaderType, buffer);
 	return true;
 }
 
@@ -243,7 +232,10 @@ bool Shader::reload() {
 }
 
 bool Shader::init() {
-	createProgramFromShaders();
+	if (!createProgramFromShaders()) {
+		// the program handle was already deleted
+		_program = InvalidId;
+	}
 	const bool success = _program != InvalidId;
 	_initialized = success;
 	if (_initialized) {
@@ -495,26 +487,71 @@ core::String Shader::getSource(ShaderType shaderType, const core::String& buffer
 	return src;
 }
 
+bool Shader::compileShaders() {
+	for (int i = 0; i < (int)ShaderType::Max; ++i) {
+		if (_sources[i].empty()) {
+			continue;
+		}
+		const ShaderType shaderType = (ShaderType)i;
+		Id id = getShader(shaderType);
+		if (id == InvalidId) {
+			id = video::genShader(shaderType);
+			if (id == InvalidId) {
+				Log::error("Failed to generate shader handle for %s\n", _name.c_str());
+				return false;
+			}
+			_shader[i] = id;
+		}
+		if (!video::compileShader(id, shaderType, _sources[i], _name)) {
+			_shader[i] = InvalidId;
+			Log::error("Failed to compile shader for %s\n", _name.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
 bool Shader::createProgramFromShaders() {
 	if (_program == InvalidId) {
 		_program = video::genProgram();
 	}
 
-	const Id comp = getShader(ShaderType::Compute);
-	if (comp != InvalidId) {
-		return video::linkComputeShader(_program, comp, _name);
+	ProgramCache *cache = nullptr;
+	uint64_t key = 0u;
+	if (video::hasFeature(Feature::ProgramBinary)) {
+		cache = core::Singleton<ShaderManager>::getInstance().programCache();
+	}
+	if (cache != nullptr) {
+		key = ProgramCache::key(video::driverIdentifier(), _sources);
+		if (cache->load(key, _program, _name)) {
+			return true;
+		}
 	}
 
-	const Id vert = getShader(ShaderType::Vertex);
-	const Id frag = getShader(ShaderType::Fragment);
-	const Id geom = getShader(ShaderType::Geometry);
+	if (!compileShaders()) {
+		video::deleteProgram(_program);
+		return false;
+	}
 
-	return video::linkShader(_program, vert, frag, geom, _name);
+	bool linked;
+	const Id comp = getShader(ShaderType::Compute);
+	if (comp != InvalidId) {
+		linked = video::linkComputeShader(_program, comp, _name);
+	} else {
+		const Id vert = getShader(ShaderType::Vertex);
+		const Id frag = getShader(ShaderType::Fragment);
+		const Id geom = getShader(ShaderType::Geometry);
+		linked = video::linkShader(_program, vert, frag, geom, _name);
+	}
+	if (linked && cache != nullptr) {
+		cache->store(key, _program, _name);
+	}
+	return linked;
 }
 
 bool Shader::run(const glm::uvec3& workGroups, bool wait) {
-	const Id comp = getShader(ShaderType::Compute);
-	if (comp == InvalidId) {
+	// the shader handle is not created if the program was loaded from the cache
+	if (_sources[(int)ShaderType::Compute].empty()) {
 		return false;
 	}
 	return video::runShader(_program, workGroups, wait);
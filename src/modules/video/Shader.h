@@ -46,6 +46,10 @@ protected:
 	typedef core::Array<Id, (int)ShaderType::Max> ShaderArray;
 	ShaderArray _shader;
 
+	// the final sources of the loaded stages - they are compiled in init() if the program isn't cached
+	typedef core::Array<core::String, (int)ShaderType::Max> SourceArray;
+	SourceArray _sources;
+
 	typedef core::Map<int, uint64_t, 8> UniformStateMap;
 	mutable UniformStateMap _uniformStateMap{128};
 
@@ -82,6 +86,7 @@ protected:
 
 	int fetchAttributes();
 
+	bool compileShaders();
 	bool createProgramFromShaders();
 
 	/**
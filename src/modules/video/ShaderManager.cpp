@@ -23,6 +23,18 @@ void ShaderManager::unregisterShader(Shader* shader) {
 	_shaders.erase(i);
 }
 
+void ShaderManager::setProgramCache(const io::ArchivePtr &archive) {
+	if (!archive) {
+		_programCache.release();
+		return;
+	}
+	_programCache = core::make_shared<ProgramCache>(archive);
+}
+
+ProgramCache *ShaderManager::programCache() const {
+	return _programCache.get();
+}
+
 void ShaderManager::update() {
 	core_trace_scoped(ShaderManagerUpdate);
 	if (!core::Var::hasDirtyShaderVars()) {
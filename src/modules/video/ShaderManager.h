@@ -3,7 +3,10 @@
  */
 #pragma once
 
+#include "ProgramCache.h"
+#include "core/SharedPtr.h"
 #include "core/collection/DynamicArray.h"
+#include "io/Archive.h"
 
 namespace video {
 
@@ -19,10 +22,19 @@ class ShaderManager {
 private:
 	typedef core::DynamicArray<Shader*> Shaders;
 	Shaders _shaders;
+	core::SharedPtr<ProgramCache> _programCache;
 public:
 	void registerShader(Shader* shader);
 	void unregisterShader(Shader* shader);
 
+	/**
+	 * @brief The linked programs are stored in the given archive and loaded from there instead of compiling the
+	 * shaders again - an empty archive disables the cache
+	 * @note Only used with @c Feature::ProgramBinary
+	 */
+	void setProgramCache(const io::ArchivePtr &archive);
+	ProgramCache *programCache() const;
+
 	/**
 	 * @brief Checks whether a shader var was changed, and recompile all shaders if needed.
 	 */
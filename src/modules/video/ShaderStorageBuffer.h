@@ -0,0 +1,59 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Renderer.h"
+#include "core/NonCopyable.h"
+
+namespace video {
+
+/**
+ * @brief A Buffer Object that a shader program can read and write - e.g. the input and output of a compute shader.
+ *
+ * In contrast to uniform buffers the size is only limited by the gpu memory and the last member of the interface
+ * block can be an unsized array.
+ * @sa UniformBuffer
+ * @ingroup Video
+ */
+class ShaderStorageBuffer : public core::NonCopyable {
+private:
+	Id _handle = InvalidId;
+	size_t _size = 0;
+
+public:
+	~ShaderStorageBuffer();
+
+	void shutdown();
+
+	Id handle() const;
+	bool create(const void *data, size_t size);
+	bool update(const void *data, size_t size);
+	/**
+	 * @brief Update a part of the buffer - the buffer is not resized
+	 */
+	bool updateSubData(intptr_t offset, const void *data, size_t size);
+	size_t size() const;
+	/**
+	 * @param[in] index The binding index of the buffer block to bind the buffer to
+	 */
+	bool bind(uint32_t index = 0u) const;
+	/**
+	 * @brief Map the buffer into the client memory - e.g. to read the results of a compute shader
+	 * @return @c nullptr on failure
+	 * @sa unmap()
+	 */
+	void *map(AccessMode mode = AccessMode::Read) const;
+	void unmap() const;
+};
+
+inline size_t ShaderStorageBuffer::size() const {
+	return _size;
+}
+
+inline Id ShaderStorageBuffer::handle() const {
+	return _handle;
+}
+
+}
@@ -7,6 +7,7 @@
 #include "core/Common.h"
 #include "core/Assert.h"
 #include "core/ArrayLength.h"
+#include "core/Hash.h"
 #include "math/Frustum.h"
 #include "core/Color.h"
 #include "core/GLM.h"
@@ -287,7 +288,6 @@ void ShapeBuilder::aabb(const glm::vec3& mins, const glm::vec3& maxs, float thic
 		glm::vec3(-1.0f,  1.0f, -1.0f), glm::vec3(-1.0f, -1.0f, -1.0f),
 		glm::vec3( 1.0f,  1.0f, -1.0f), glm::vec3( 1.0f, -1.0f, -1.0f)
 	};
-	reserve(lengthof(vecs), 24);
 	const glm::vec3& width = maxs - mins;
 	const glm::vec3& halfWidth = width / 2.0f;
 	const glm::vec3& center = maxs - halfWidth;
@@ -295,6 +295,22 @@ void ShapeBuilder::aabb(const glm::vec3& mins, const glm::vec3& maxs, float thic
 		vecs[i] = vecs[i] * halfWidth + center;
 	}
 
+	if (thickness <= 1.0f) {
+		// the lines share the corner vertices
+		setPrimitive(Primitive::Lines);
+		reserve(lengthof(vecs), 24);
+		uint32_t indices[lengthof(vecs)];
+		for (size_t i = 0; i < lengthof(vecs); ++i) {
+			indices[i] = addVertex(vecs[i]);
+		}
+		static const uint8_t lines[] = {0, 1, 1, 3, 3, 2, 2, 0, 4, 5, 5, 7, 7, 6, 6, 4, 0, 4, 2, 6, 1, 5, 3, 7};
+		for (size_t i = 0; i < lengthof(lines); i += 2) {
+			addIndex(indices[lines[i]], indices[lines[i + 1]]);
+		}
+		return;
+	}
+	reserve(lengthof(vecs), 24);
+
 	// front
 	line(vecs[0], vecs[1], thickness);
 	line(vecs[1], vecs[3], thickness);
@@ -446,6 +462,15 @@ void ShapeBuilder::pyramid(const glm::vec3& size) {
 	addIndex(startIndex + 4);
 }
 
+uint32_t ShapeBuilder::hash() const {
+	uint32_t h = core::hash(&_primitive, sizeof(_primitive));
+	h = core::hash(_vertices.data(), (int)_vertices.bytes(), h);
+	h = core::hash(_colors.data(), (int)_colors.bytes(), h);
+	h = core::hash(_normals.data(), (int)_normals.bytes(), h);
+	h = core::hash(_texcoords.data(), (int)_texcoords.bytes(), h);
+	return core::hash(_indices.data(), (int)_indices.bytes(), h);
+}
+
 uint32_t ShapeBuilder::addVertex(const glm::vec3& vertex, const glm::vec2& uv, const glm::vec3& normal) {
 	core_assert(_colors.capacity() > _colors.size());
 	_colors.push_back(_color);
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "core/Common.h"
 #include "core/Enum.h"
 #include "math/Tri.h"
 #include "math/AABB.h"
@@ -53,6 +54,15 @@ private:
 	glm::vec4 _color;
 	glm::vec3 _position {0.0f};
 	bool _applyRotation = false;
+
+	template<class ARRAY>
+	static inline size_t grow(const ARRAY &array, int additional) {
+		const size_t needed = array.size() + additional;
+		if (needed <= array.capacity()) {
+			return needed;
+		}
+		return core_max(needed, array.capacity() * 2);
+	}
 public:
 	ShapeBuilder(int initialSize = 0);
 
@@ -63,12 +73,15 @@ public:
 	 * @param indices The amount of additional indices
 	 */
 	inline void reserve(int vertices, int indices) {
-		_colors.reserve(_colors.size() + vertices);
-		_vertices.reserve(_vertices.size() + vertices);
-		_normals.reserve(_normals.size() + vertices);
-		_texcoords.reserve(_texcoords.size() + vertices);
-
-		_indices.reserve(_indices.size() + indices);
+		// grow geometrically - the shapes reserve their few vertices one after another and a lot of shapes (e.g.
+		// the selections) would otherwise copy the whole buffers for every few added shapes
+		const size_t vertexCapacity = grow(_vertices, vertices);
+		_colors.reserve(vertexCapacity);
+		_vertices.reserve(vertexCapacity);
+		_normals.reserve(vertexCapacity);
+		_texcoords.reserve(vertexCapacity);
+
+		_indices.reserve(grow(_indices, indices));
 	}
 
 	inline void addIndex(uint32_t index) {
@@ -201,6 +214,10 @@ public:
 	}
 	const Indices& getIndices() const;
 	const Colors& getColors() const;
+	/**
+	 * @brief Hash over the generated geometry - allows to detect unchanged shapes without uploading them again
+	 */
+	uint32_t hash() const;
 	const Texcoords& getTexcoords() const;
 
 	bool setColor(const glm::vec4& color);
@@ -16,7 +16,10 @@ Texture::Texture(const TextureConfig& cfg, int width, int height, const core::St
 	_config = cfg;
 }
 
-Texture::Texture(const image::ImagePtr &image) : _name(image->name()) {
+Texture::Texture(const image::ImagePtr &image) : Texture(image, TextureConfig()) {
+}
+
+Texture::Texture(const image::ImagePtr &image, const TextureConfig &cfg) : _name(image->name()), _config(cfg) {
 	_config.type(TextureType::Texture2D);
 	_width = image->width();
 	_height = image->height();
@@ -28,12 +31,13 @@ Texture::Texture(const image::ImagePtr &image) : _name(image->name()) {
 
 	if (image->isLoading()) {
 		_image = image;
-		_state = io::IOSTATE_LOADING;
 		_width = 1;
 		_height = 1;
 		_dummy = true;
 		const uint32_t empty = 0x00000000;
 		upload((const uint8_t *)&empty);
+		// the upload of the placeholder pixel doesn't mean that the texture is loaded
+		_state = io::IOSTATE_LOADING;
 	} else if (image->isLoaded()) {
 		upload(image->width(), image->height(), image->data());
 		_state = io::IOSTATE_LOADED;
@@ -61,13 +65,17 @@ void Texture::upload(const image::ImagePtr &image, int index) {
 	}
 	if (image->isLoading()) {
 		_image = image;
-		_state = io::IOSTATE_LOADING;
 		_width = 1;
 		_height = 1;
 		_dummy = true;
 		const uint32_t empty = 0x00000000;
 		upload((const uint8_t *)&empty);
+		// the upload of the placeholder pixel doesn't mean that the texture is loaded
+		_state = io::IOSTATE_LOADING;
 	} else if (image->isLoaded()) {
+		// replaces a placeholder of an image that is still loading
+		_image = image::ImagePtr();
+		_dummy = false;
 		upload(image->width(), image->height(), image->data());
 		_state = io::IOSTATE_LOADED;
 	}
@@ -110,10 +118,26 @@ void Texture::upload(int width, int height, const uint8_t* data, int index) {
 	video::bindTexture(TextureUnit::Upload, type(), _handle);
 	video::setupTexture(_config);
 	video::uploadTexture(type(), format(), _width, _height, data, index, _config.samples());
+	if (_config.mipmaps() && data != nullptr) {
+		video::generateMipmaps(type());
+	}
 	_layerCount = core_max(_layerCount, index);
 	_state = io::IOSTATE_LOADED;
 }
 
+void Texture::uploadRegion(int x, int y, int z, int width, int height, int depth, const uint8_t *data) {
+	if (_handle == InvalidId || width <= 0 || height <= 0 || depth <= 0) {
+		return;
+	}
+	core_assert(x >= 0 && y >= 0 && z >= 0 && x + width <= _width && y + height <= _height);
+	video::bindTexture(TextureUnit::Upload, type(), _handle);
+	video::setupTexture(_config);
+	video::uploadTextureRegion(type(), format(), x, y, z, width, height, depth, data);
+	if (_config.mipmaps()) {
+		video::generateMipmaps(type());
+	}
+}
+
 void Texture::bind(TextureUnit unit) const {
 	core_assert_always(_handle != InvalidId);
 	video::bindTexture(unit, type(), _handle);
@@ -37,6 +37,10 @@ private:
 
 public:
 	Texture(const image::ImagePtr& image);
+	/**
+	 * @param cfg The filter, wrap and mipmap settings - the type and format are taken from the image
+	 */
+	Texture(const image::ImagePtr& image, const TextureConfig& cfg);
 	Texture(const TextureConfig& cfg, int width = 1, int height = 1, const core::String& name = "");
 	~Texture();
 	void shutdown();
@@ -56,6 +60,13 @@ public:
 	void upload(int width, int height, const uint8_t* data = nullptr, int index = 1);
 	void upload(const uint8_t* data = nullptr, int index = 1);
 	void upload(const image::ImagePtr &image, int index = 1);
+	/**
+	 * @brief Replaces a box of texels - the texture must have been uploaded before
+	 * @param data The tightly packed texels of the box
+	 * @note For 2d textures @c z must be @c 0 and @c depth must be @c 1 - the layers of array and 3d textures are
+	 * addressed with @c z
+	 */
+	void uploadRegion(int x, int y, int z, int width, int height, int depth, const uint8_t *data);
 
 	/**
 	 * @note The returned buffer should get freed with @c core_free()
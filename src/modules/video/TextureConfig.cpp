@@ -74,6 +74,11 @@ TextureConfig& TextureConfig::alignment(uint8_t alignment) {
 	return *this;
 }
 
+TextureConfig& TextureConfig::mipmaps(bool mipmaps) {
+	_mipmaps = mipmaps;
+	return *this;
+}
+
 TextureConfig& TextureConfig::borderColor(const glm::vec4& borderColor) {
 	_useBorderColor = true;
 	_borderColor = borderColor;
@@ -27,6 +27,7 @@ private:
 	uint8_t _layers = 1u;
 	uint8_t _alignment = 1u;
 	bool _useBorderColor = false;
+	bool _mipmaps = false;
 	glm::vec4 _borderColor {0.0f};
 	int _samples = 0;
 public:
@@ -53,6 +54,11 @@ public:
 	 * Valid values are @c 0, @c 1, @c 2, @c 4 and @c 8.
 	 */
 	TextureConfig& alignment(uint8_t alignment);
+	/**
+	 * @brief Generate the mipmap levels on the gpu after the texture data was uploaded - the min filter is used
+	 * for the mipmap levels, too
+	 */
+	TextureConfig& mipmaps(bool mipmaps);
 
 	TextureWrap wrapR() const;
 	TextureWrap wrapS() const;
@@ -67,6 +73,7 @@ public:
 	CompareFunc compareFunc() const;
 	TextureCompareMode compareMode() const;
 	bool useBorderColor() const;
+	bool mipmaps() const;
 	const glm::vec4& borderColor() const;
 };
 
@@ -122,6 +129,10 @@ inline bool TextureConfig::useBorderColor() const {
 	return _useBorderColor;
 }
 
+inline bool TextureConfig::mipmaps() const {
+	return _mipmaps;
+}
+
 inline const glm::vec4& TextureConfig::borderColor() const {
 	return _borderColor;
 }
@@ -3,21 +3,57 @@
  */
 
 #include "TexturePool.h"
+#include "app/Async.h"
 #include "command/Command.h"
 #include "core/Log.h"
+#include "core/MemoryTracker.h"
+#include "core/Trace.h"
 #include "image/Image.h"
 #include "io/MemoryReadStream.h"
 #include "app/I18N.h"
 
 namespace video {
 
+namespace priv {
+
+static size_t imageBytes(const image::ImagePtr &image, bool mipmaps) {
+	const size_t bytes = (size_t)image->width() * image->height() * image->depth();
+	// the mipmap chain adds one third of the base level
+	return mipmaps ? bytes + bytes / 3u : bytes;
+}
+
+} // namespace priv
+
 bool TexturePool::has(const core::String& name) const {
 	return _cache.find(name) != _cache.end();
 }
 
+void TexturePool::touch(const core::String &name) {
+	auto i = _usage.find(name);
+	if (i != _usage.end()) {
+		i->value.lastUsed = _frame;
+	}
+}
+
+void TexturePool::account(const core::String &name, const image::ImagePtr &image, bool reloadable, bool mipmaps) {
+	Usage usage;
+	auto i = _usage.find(name);
+	if (i != _usage.end()) {
+		usage = i->value;
+		_memory -= usage.bytes;
+	}
+	usage.bytes = image && image->isLoaded() ? priv::imageBytes(image, mipmaps) : 0u;
+	usage.lastUsed = _frame;
+	usage.reloadable = reloadable;
+	_memory += usage.bytes;
+	_usage.put(name, usage);
+	core::memoryTrackUpdate(core::MemoryTag::Texture, _trackedMemory, _memory);
+}
+
 video::TexturePtr TexturePool::get(const core::String &name) {
 	auto i = _cache.find(name);
 	if (i != _cache.end()) {
+		touch(name);
 		return i->value;
 	}
 	return _empty;
@@ -26,6 +62,7 @@ video::TexturePtr TexturePool::get(const core::String &name) {
 video::TexturePtr TexturePool::load(const core::String& name, const uint8_t *rgba, size_t size) {
 	auto i = _cache.find(name);
 	if (i != _cache.end()) {
+		touch(name);
 		return i->value;
 	}
 	const image::ImagePtr &image = loadImage(name, rgba, size);
@@ -34,12 +71,14 @@ video::TexturePtr TexturePool::load(const core::String& name, const uint8_t *rgb
 	}
 	TexturePtr texture = createTextureFromImage(image);
 	_cache.put(name, texture);
+	account(name, image, false, false);
 	return texture;
 }
 
 video::TexturePtr TexturePool::load(const core::String &name, bool emptyAsFallback) {
 	auto i = _cache.find(name);
 	if (i != _cache.end()) {
+		touch(name);
 		return i->value;
 	}
 	const image::ImagePtr &image = loadImage(name);
@@ -51,12 +90,47 @@ video::TexturePtr TexturePool::load(const core::String &name, bool emptyAsFallba
 		texture = _empty;
 	}
 	_cache.put(name, texture);
+	account(name, image, true, false);
+	return texture;
+}
+
+video::TexturePtr TexturePool::loadAsync(const core::String &name) {
+	auto i = _cache.find(name);
+	if (i != _cache.end()) {
+		touch(name);
+		return i->value;
+	}
+	TextureConfig cfg;
+	cfg.mipmaps(true);
+	// the placeholder image stays in the loading state - the texture is replaced in update()
+	const TexturePtr &texture = core::make_shared<Texture>(image::createEmptyImage(name), cfg);
+	_cache.put(name, texture);
+	account(name, image::ImagePtr(), true, true);
+	_futures.push_back(app::async([this, name]() { _decoded.push(image::loadImage(name)); }).share());
 	return texture;
 }
 
 video::TexturePtr TexturePool::addImage(const image::ImagePtr &image) {
 	_images.put(image->name(), image);
-	return load(image->name());
+	const TexturePtr &texture = load(image->name());
+	// the image can't get loaded again by its name
+	account(image->name(), image, false, false);
+	return texture;
+}
+
+video::TexturePtr TexturePool::addImageAsync(const image::ImagePtr &image) {
+	auto i = _cache.find(image->name());
+	if (i != _cache.end()) {
+		touch(image->name());
+		return i->value;
+	}
+	TextureConfig cfg;
+	cfg.mipmaps(true);
+	const TexturePtr &texture = core::make_shared<Texture>(image::createEmptyImage(image->name()), cfg);
+	_cache.put(image->name(), texture);
+	account(image->name(), image::ImagePtr(), false, true);
+	_uploads.push_back(image);
+	return texture;
 }
 
 image::ImagePtr TexturePool::loadImage(const core::String& name, const uint8_t *rgba, size_t size) {
@@ -80,9 +154,95 @@ image::ImagePtr TexturePool::loadImage(const core::String &name) {
 	return image;
 }
 
+int TexturePool::pending() const {
+	int n = (int)_uploads.size() + (int)_decoded.size();
+	for (const std::shared_future<void> &future : _futures) {
+		if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			++n;
+		}
+	}
+	return n;
+}
+
+void TexturePool::update() {
+	core_trace_scoped(TexturePoolUpdate);
+	++_frame;
+	for (size_t i = 0; i < _futures.size();) {
+		if (_futures[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			_futures.erase(i);
+		} else {
+			++i;
+		}
+	}
+	_decoded.popAll(_uploads);
+
+	size_t uploaded = 0u;
+	size_t n = 0u;
+	for (; n < _uploads.size(); ++n) {
+		if (n > 0u && uploaded >= _uploadBudget) {
+			break;
+		}
+		const image::ImagePtr &image = _uploads[n];
+		auto i = _cache.find(image->name());
+		if (i == _cache.end()) {
+			// the pool was cleared in the meantime
+			continue;
+		}
+		if (!image->isLoaded()) {
+			Log::warn("Failed to load texture %s", image->name().c_str());
+			_cache.remove(image->name());
+			_usage.remove(image->name());
+			continue;
+		}
+		i->value->upload(image);
+		_images.put(image->name(), image);
+		Usage usage;
+		_usage.get(image->name(), usage);
+		account(image->name(), image, usage.reloadable, true);
+		uploaded += priv::imageBytes(image, false);
+	}
+	_uploads.erase(0, n);
+
+	evict();
+}
+
+void TexturePool::evict() {
+	if (_maxMemory == 0u) {
+		return;
+	}
+	while (_memory > _maxMemory) {
+		core::String lruName;
+		uint64_t lruFrame = _frame;
+		for (const auto &e : _usage) {
+			const Usage &usage = e->value;
+			// textures that are used in this frame are still referenced by the draw commands
+			if (!usage.reloadable || usage.lastUsed >= lruFrame) {
+				continue;
+			}
+			auto i = _cache.find(e->key);
+			if (i == _cache.end() || !i->value.unique()) {
+				continue;
+			}
+			lruName = e->key;
+			lruFrame = usage.lastUsed;
+		}
+		if (lruName.empty()) {
+			break;
+		}
+		Usage usage;
+		_usage.get(lruName, usage);
+		Log::debug("Evict texture %s (%i bytes)", lruName.c_str(), (int)usage.bytes);
+		_memory -= usage.bytes;
+		_usage.remove(lruName);
+		_cache.remove(lruName);
+		_images.remove(lruName);
+	}
+	core::memoryTrackUpdate(core::MemoryTag::Texture, _trackedMemory, _memory);
+}
+
 void TexturePool::construct() {
 	command::Command::registerCommand("texturepoollist", [this](const command::CmdArgs &args) {
-		Log::info("TexturePool");
+		Log::info("TexturePool (%i kb of %i kb)", (int)(_memory / 1024u), (int)(_maxMemory / 1024u));
 		for (const auto &e : _cache) {
 			Log::info("- %s\n", e->first.c_str());
 		}
@@ -95,6 +255,11 @@ bool TexturePool::init() {
 }
 
 void TexturePool::shutdown() {
+	for (std::shared_future<void> &future : _futures) {
+		future.wait();
+	}
+	_futures.clear();
+	_decoded.clear();
 	_empty = TexturePtr();
 	clear();
 }
@@ -102,6 +267,10 @@ void TexturePool::shutdown() {
 void TexturePool::clear() {
 	_cache.clear();
 	_images.clear();
+	_usage.clear();
+	_uploads.clear();
+	_memory = 0u;
+	core::memoryTrackUpdate(core::MemoryTag::Texture, _trackedMemory, _memory);
 }
 
 } // namespace video
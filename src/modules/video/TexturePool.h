@@ -9,26 +9,91 @@
 #include "image/Image.h"
 #include "core/String.h"
 #include "core/SharedPtr.h"
+#include "core/collection/ConcurrentQueue.h"
+#include "core/collection/DynamicArray.h"
 #include "core/collection/DynamicStringMap.h"
+#include <future>
 
 namespace video {
 
 /**
+ * @brief Caches the textures and images by name
+ *
+ * Textures can get loaded asynchronously with @c loadAsync() - the image is decoded on the thread pool and
+ * uploaded in @c update() on the main thread. Only as many bytes as the upload budget allows are uploaded per
+ * frame. The returned texture is a placeholder until then.
+ *
+ * The memory of the textures is accounted - if the max memory is exceeded, the least recently used textures that
+ * can get loaded again by their name and that are not referenced outside of the pool are removed in @c update().
+ *
  * @ingroup Video
  */
 class TexturePool : public core::IComponent {
 private:
+	struct Usage {
+		size_t bytes = 0u;
+		uint64_t lastUsed = 0u;
+		// the texture can get loaded again by its name - only these are evicted
+		bool reloadable = false;
+	};
 	core::DynamicStringMap<TexturePtr> _cache;
 	core::DynamicStringMap<image::ImagePtr> _images;
+	core::DynamicStringMap<Usage> _usage;
+	// decoded by the thread pool - waiting for the upload
+	core::ConcurrentQueue<image::ImagePtr> _decoded;
+	core::DynamicArray<image::ImagePtr> _uploads;
+	core::DynamicArray<std::shared_future<void>> _futures;
 	TexturePtr _empty;
+	uint64_t _frame = 0u;
+	size_t _memory = 0u;
+	// the memory that was reported to the memory tracker
+	size_t _trackedMemory = 0u;
+	size_t _maxMemory = 256u * 1024u * 1024u;
+	size_t _uploadBudget = 16u * 1024u * 1024u;
+
+	void touch(const core::String &name);
+	void account(const core::String &name, const image::ImagePtr &image, bool reloadable, bool mipmaps);
+	void evict();
 public:
 	video::TexturePtr load(const core::String& name, bool emptyAsFallback = true);
 	video::TexturePtr load(const core::String& name, const uint8_t *rgba, size_t size);
+	/**
+	 * @brief Decodes the image on the thread pool and uploads it with mipmaps in @c update()
+	 * @return The texture that is a transparent placeholder (and not @c isLoaded()) until the upload happened
+	 */
+	video::TexturePtr loadAsync(const core::String& name);
 	video::TexturePtr get(const core::String& name);
 	bool has(const core::String& name) const;
 	image::ImagePtr loadImage(const core::String& name);
 	image::ImagePtr loadImage(const core::String& name, const uint8_t *rgba, size_t size);
 	video::TexturePtr addImage(const image::ImagePtr &image);
+	/**
+	 * @brief Same as @c addImage() - but the upload happens in @c update() within the upload budget
+	 */
+	video::TexturePtr addImageAsync(const image::ImagePtr &image);
+
+	/**
+	 * @brief Uploads the decoded images within the upload budget and evicts the least recently used textures if
+	 * the max memory is exceeded. Call this once per frame on the main thread.
+	 */
+	void update();
+
+	/**
+	 * @param bytes The amount of texture memory before textures are evicted - @c 0 disables the eviction
+	 */
+	void setMaxMemory(size_t bytes);
+	/**
+	 * @param bytes The amount of image data that is uploaded per @c update() call - at least one image is uploaded
+	 */
+	void setUploadBudget(size_t bytes);
+	/**
+	 * @return The accounted texture memory in bytes
+	 */
+	size_t memory() const;
+	/**
+	 * @return The amount of textures that are still decoded or waiting for the upload
+	 */
+	int pending() const;
 
 	const core::DynamicStringMap<TexturePtr> &cache() {
 		return _cache;
@@ -40,6 +105,18 @@ public:
 	void clear();
 };
 
+inline void TexturePool::setMaxMemory(size_t bytes) {
+	_maxMemory = bytes;
+}
+
+inline void TexturePool::setUploadBudget(size_t bytes) {
+	_uploadBudget = bytes;
+}
+
+inline size_t TexturePool::memory() const {
+	return _memory;
+}
+
 typedef core::SharedPtr<TexturePool> TexturePoolPtr;
 
 }
@@ -0,0 +1,119 @@
+/**
+ * @file
+ */
+
+#include "TextureReadback.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "video/Renderer.h"
+#include "video/Trace.h"
+
+namespace video {
+
+void TextureReadback::readSync(const TexturePtr &texture, const core::String &name, const Callback &callback) {
+	uint8_t *pixels = nullptr;
+	image::ImagePtr image;
+	if (readTexture(TextureUnit::Upload, texture->type(), texture->format(), texture->handle(), texture->width(),
+					texture->height(), &pixels)) {
+		image::Image::flipVerticalRGBA(pixels, texture->width(), texture->height());
+		image = image::createEmptyImage(name);
+		image->loadRGBA(pixels, texture->width(), texture->height());
+	} else {
+		Log::error("Failed to read texture %s", name.c_str());
+	}
+	core_free(pixels);
+	callback(image);
+}
+
+bool TextureReadback::read(const TexturePtr &texture, const core::String &name, const Callback &callback) {
+	video_trace_scoped(TextureReadback);
+	if (!texture || texture->format() != TextureFormat::RGBA) {
+		Log::error("Can't read texture %s - only rgba textures are supported", name.c_str());
+		return false;
+	}
+	if (_pending == Buffers) {
+		// all buffers are in use - the oldest request must be finished to reuse its buffer
+		finish(_requests[_first], UINT64_MAX);
+	}
+	Request &request = _requests[(_first + _pending) % Buffers];
+	const size_t size = (size_t)texture->width() * (size_t)texture->height() * 4u;
+	if (request.buffer == InvalidId) {
+		request.buffer = genBuffer();
+	}
+	if (request.buffer != InvalidId && request.capacity < size) {
+		bufferData(request.buffer, BufferType::PixelPackBuffer, BufferMode::StreamRead, nullptr, size);
+		request.capacity = size;
+	}
+	if (request.buffer == InvalidId ||
+		!readTextureToBuffer(TextureUnit::Upload, texture->type(), texture->format(), texture->handle(),
+							 request.buffer)) {
+		readSync(texture, name, callback);
+		return true;
+	}
+	request.fence = genFenc();
+	request.width = texture->width();
+	request.height = texture->height();
+	request.name = name;
+	request.callback = callback;
+	++_pending;
+	return true;
+}
+
+bool TextureReadback::finish(Request &request, uint64_t timeout) {
+	if (request.fence != InvalidIdPtr) {
+		if (!checkFence(request.fence, timeout)) {
+			return false;
+		}
+		deleteFence(request.fence);
+	}
+	image::ImagePtr image;
+	const uint8_t *pixels = (const uint8_t *)mapBuffer(request.buffer, BufferType::PixelPackBuffer, AccessMode::Read);
+	if (pixels != nullptr) {
+		// the rows are flipped while they are copied out of the mapped buffer
+		const size_t pitch = (size_t)request.width * 4u;
+		uint8_t *flipped = (uint8_t *)core_malloc(pitch * request.height);
+		for (int y = 0; y < request.height; ++y) {
+			core_memcpy(flipped + (size_t)y * pitch, pixels + (size_t)(request.height - 1 - y) * pitch, pitch);
+		}
+		unmapBuffer(request.buffer, BufferType::PixelPackBuffer);
+		image = image::createEmptyImage(request.name);
+		image->loadRGBA(flipped, request.width, request.height);
+		core_free(flipped);
+	} else {
+		Log::error("Failed to map the pixel buffer of %s", request.name.c_str());
+	}
+	const Callback callback = core::move(request.callback);
+	request.callback = Callback();
+	_first = (_first + 1) % Buffers;
+	--_pending;
+	callback(image);
+	return true;
+}
+
+void TextureReadback::update() {
+	video_trace_scoped(TextureReadbackUpdate);
+	while (_pending > 0) {
+		// don't wait for the gpu - a timeout of 0 is treated as not signaled
+		if (!finish(_requests[_first], 1u)) {
+			break;
+		}
+	}
+}
+
+void TextureReadback::flush() {
+	while (_pending > 0) {
+		finish(_requests[_first], UINT64_MAX);
+	}
+}
+
+void TextureReadback::shutdown() {
+	for (Request &request : _requests) {
+		deleteFence(request.fence);
+		deleteBuffer(request.buffer);
+		request = Request();
+	}
+	_first = 0;
+	_pending = 0;
+}
+
+} // namespace video
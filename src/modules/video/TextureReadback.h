@@ -0,0 +1,80 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/String.h"
+#include "image/Image.h"
+#include "video/Texture.h"
+#include "video/Types.h"
+#include <functional>
+
+namespace video {
+
+/**
+ * @brief Reads textures back from the gpu without stalling the pipeline
+ *
+ * The pixels are copied into a @c BufferType::PixelPackBuffer and a fence is inserted after the copy. The image is
+ * delivered by @c update() once the fence is signaled - usually a frame or two later. The images are always delivered
+ * in the order they were requested. If all buffers are in use, the oldest request is finished first, which waits
+ * for the gpu.
+ *
+ * Without pixel pack buffer support (e.g. vulkan) the texture is read synchronously and the image is delivered
+ * directly.
+ *
+ * @note Only textures in @c TextureFormat::RGBA are supported
+ * @sa FrameBuffer::image()
+ */
+class TextureReadback : public core::NonCopyable {
+public:
+	using Callback = std::function<void(const image::ImagePtr &image)>;
+	static constexpr int Buffers = 3;
+
+private:
+	struct Request {
+		Id buffer = InvalidId;
+		IdPtr fence = InvalidIdPtr;
+		size_t capacity = 0u;
+		int width = 0;
+		int height = 0;
+		core::String name;
+		Callback callback;
+	};
+	Request _requests[Buffers];
+	// the index of the oldest pending request
+	int _first = 0;
+	int _pending = 0;
+
+	bool finish(Request &request, uint64_t timeout);
+	void readSync(const TexturePtr &texture, const core::String &name, const Callback &callback);
+
+public:
+	/**
+	 * @brief Queues the read of the texture - the texture can be rendered to again after this call
+	 * @param callback Receives the image - the origin is upper left like for @c FrameBuffer::image()
+	 * @return @c false if the texture can't be read
+	 */
+	bool read(const TexturePtr &texture, const core::String &name, const Callback &callback);
+	/**
+	 * @brief Delivers the images of the finished reads - call this once per frame
+	 */
+	void update();
+	/**
+	 * @brief Waits for all pending reads and delivers their images
+	 */
+	void flush();
+	void shutdown();
+
+	/**
+	 * @return The amount of reads that were not yet delivered
+	 */
+	int pending() const;
+};
+
+inline int TextureReadback::pending() const {
+	return _pending;
+}
+
+} // namespace video
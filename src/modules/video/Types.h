@@ -230,6 +230,19 @@ enum class BufferType {
 	PixelBuffer,
 	ShaderStorageBuffer,
 	IndirectBuffer,
+	// the target of pixels that are read back from the gpu
+	PixelPackBuffer,
+
+	Max
+};
+
+enum class QueryType {
+	// the amount of samples that passed the depth test
+	SamplesPassed,
+	// if any sample passed the depth test
+	AnySamplesPassed,
+	// the gpu time in nanoseconds of the commands between begin and end - see Feature::TimerQuery
+	TimeElapsed,
 
 	Max
 };
@@ -238,6 +251,10 @@ enum class BufferMode {
 	Static,
 	Dynamic,
 	Stream,
+	// streamed through persistent mapped memory - falls back to Stream without Feature::BufferStorage
+	Persistent,
+	// written once by the gpu and read back once by the application - e.g. for BufferType::PixelPackBuffer
+	StreamRead,
 
 	Max
 };
@@ -376,6 +393,10 @@ enum class TextureFormat {
 	S8,
 
 	RG16U,
+	// two normalized 8 bit channels - e.g. a palette index and a flag
+	RG8,
+	// one normalized 8 bit channel - e.g. an occlusion value
+	R8,
 
 	Max
 };
@@ -432,6 +453,12 @@ enum class Feature {
 	ComputeShaders,
 	TransformFeedback,
 	ShaderStorageBufferObject,
+	// retrieve the linked programs with glGetProgramBinary to store them in the ProgramCache
+	ProgramBinary,
+	// the driver compiles and links the shaders on its own threads
+	ParallelShaderCompile,
+	// measure the gpu time with QueryType::TimeElapsed
+	TimerQuery,
 
 	Max
 };
@@ -498,4 +525,18 @@ struct Attribute {
 	bool typeIsInt = false;
 };
 
+/**
+ * The layout of the commands in the indirect buffer for @c multiDrawElementsIndirect()
+ */
+struct DrawElementsIndirectCommand {
+	/** the amount of indices to draw */
+	uint32_t count = 0u;
+	uint32_t instanceCount = 1u;
+	/** the offset of the first index in the index buffer - in indices, not in bytes */
+	uint32_t firstIndex = 0u;
+	/** the value that is added to the indices */
+	int32_t baseVertex = 0;
+	uint32_t baseInstance = 0u;
+};
+
 }
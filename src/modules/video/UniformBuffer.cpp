@@ -4,6 +4,7 @@
 
 #include "UniformBuffer.h"
 #include "core/Assert.h"
+#include "core/Common.h"
 
 namespace video {
 
@@ -14,13 +15,27 @@ UniformBuffer::~UniformBuffer() {
 
 void UniformBuffer::shutdown() {
 	video::deleteBuffer(_handle);
+	_slots = 1;
+	_slot = 0;
+	_slotSize = 0;
 }
 
-bool UniformBuffer::create(const void *data, size_t size) {
+bool UniformBuffer::create(const void *data, size_t size, int slots) {
 	if (_handle != video::InvalidId) {
 		shutdown();
 	}
 	_handle = video::genBuffer();
+	_slots = core_max(1, slots);
+	if (_slots > 1) {
+		const size_t alignment = (size_t)core_max(1, video::specificationi(Spec::UniformBufferAlignment));
+		_slotSize = (size + alignment - 1) / alignment * alignment;
+		const int maxSize = video::limit(Limit::MaxUniformBufferSize);
+		if (maxSize > 0) {
+			_slots = core_max(1, core_min(_slots, maxSize / (int)_slotSize));
+		}
+		// start with the last slot - the first update allocates the storage
+		_slot = _slots - 1;
+	}
 	return update(data, size);
 }
 
@@ -28,7 +43,18 @@ bool UniformBuffer::update(const void *data, size_t size) {
 	if (_handle == video::InvalidId) {
 		return false;
 	}
-	video::bufferData(_handle, BufferType::UniformBuffer, BufferMode::Dynamic, data, size);
+	if (_slots <= 1) {
+		video::bufferData(_handle, BufferType::UniformBuffer, BufferMode::Dynamic, data, size);
+		_size = size;
+		return true;
+	}
+	core_assert_msg(size <= _slotSize, "Given size %i exceeds the slot size %i", (int)size, (int)_slotSize);
+	_slot = (_slot + 1) % _slots;
+	if (_slot == 0) {
+		// orphan the storage - the draws of the previous round keep the old one
+		video::bufferData(_handle, BufferType::UniformBuffer, BufferMode::Stream, nullptr, _slotSize * _slots);
+	}
+	video::bufferSubData(_handle, BufferType::UniformBuffer, (intptr_t)(_slot * _slotSize), data, size);
 	_size = size;
 	return true;
 }
@@ -37,6 +63,9 @@ bool UniformBuffer::bind(uint32_t index) const {
 	if (_handle == video::InvalidId) {
 		return false;
 	}
+	if (_slots > 1) {
+		return video::bindBufferRange(BufferType::UniformBuffer, _handle, index, (intptr_t)(_slot * _slotSize), _size);
+	}
 	video::bindBufferBase(BufferType::UniformBuffer, _handle, index);
 	return true;
 }
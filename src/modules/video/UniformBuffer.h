@@ -29,6 +29,10 @@ class UniformBuffer : public core::NonCopyable {
 private:
 	Id _handle = InvalidId;
 	size_t _size = 0;
+	// the size of a slot - aligned to the uniform buffer offset alignment
+	size_t _slotSize = 0;
+	int _slots = 1;
+	int _slot = 0;
 
 public:
 	~UniformBuffer();
@@ -36,7 +40,12 @@ public:
 	void shutdown();
 
 	Id handle() const;
-	bool create(const void *data, size_t size);
+	/**
+	 * @param[in] slots The amount of copies of the data the buffer can hold. Each @c update() writes the next slot and
+	 * @c bind() binds the range of it. The draws that are still using the previous slots don't have to be waited for.
+	 * The storage is orphaned once all slots are used. Use this for data that changes with every draw call.
+	 */
+	bool create(const void *data, size_t size, int slots = 1);
 	bool update(const void *data, size_t size);
 	size_t size() const;
 	/**
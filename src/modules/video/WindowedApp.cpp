@@ -18,11 +18,16 @@
 #include "core/Var.h"
 #include "io/FormatDescription.h"
 #include "io/Filesystem.h"
+#include "io/FilesystemArchive.h"
 #include "util/CustomButtonNames.h"
 #include "util/KeybindingHandler.h"
 #include "video/EventHandler.h"
+#include "video/GPUTimer.h"
 #include <glm/common.hpp>
 #include <SDL.h>
+#ifdef USE_VULKAN
+#include <SDL_vulkan.h>
+#endif
 
 #ifdef __WINDOWS__
 #include <windows.h>
@@ -43,6 +48,14 @@ inline void checkSDLError(const char *file, unsigned int line, const char *funct
 	}
 }
 #define sdlCheckError() checkSDLError(__FILE__, __LINE__, SDL_FUNCTION)
+
+inline void drawableSize(SDL_Window *window, int &w, int &h) {
+#ifdef USE_VULKAN
+	SDL_Vulkan_GetDrawableSize(window, &w, &h);
+#else
+	SDL_GL_GetDrawableSize(window, &w, &h);
+#endif
+}
 }
 
 WindowedApp::WindowedApp(const io::FilesystemPtr& filesystem, const core::TimeProviderPtr& timeProvider, size_t threadPoolSize) :
@@ -62,6 +75,7 @@ WindowedApp::~WindowedApp() {
 
 void WindowedApp::onAfterRunning() {
 	core_trace_scoped(WindowedAppAfterRunning);
+	video::gpuTimer().frameEnd();
 	video::endFrame(_window);
 }
 
@@ -77,7 +91,7 @@ bool WindowedApp::handleSDLEvent(SDL_Event& event) {
 			const int w = event.window.data1;
 			const int h = event.window.data2;
 			int frameBufferWidth, frameBufferHeight;
-			SDL_GL_GetDrawableSize(_window, &frameBufferWidth, &frameBufferHeight);
+			drawableSize(_window, frameBufferWidth, frameBufferHeight);
 			_aspect = (float)frameBufferWidth / (float)frameBufferHeight;
 			_frameBufferDimension = glm::ivec2(frameBufferWidth, frameBufferHeight);
 			_windowDimension = glm::ivec2(w, h);
@@ -306,7 +320,11 @@ app::AppState WindowedApp::onInit() {
 #endif
 	SDL_SetHint(SDL_HINT_MAC_CTRL_CLICK_EMULATE_RIGHT_CLICK, "1");
 
+#ifdef USE_VULKAN
+	int flags = SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE;
+#else
 	int flags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE;
+#endif
 	if (!_showWindow) {
 		flags |= SDL_WINDOW_HIDDEN;
 	}
@@ -365,7 +383,7 @@ app::AppState WindowedApp::onInit() {
 	// some platforms may override or hardcode the resolution - so
 	// we have to query it here to get the actual resolution
 	int frameBufferWidth, frameBufferHeight;
-	SDL_GL_GetDrawableSize(_window, &frameBufferWidth, &frameBufferHeight);
+	drawableSize(_window, frameBufferWidth, frameBufferHeight);
 	_aspect = (float)frameBufferWidth / (float)frameBufferHeight;
 	_frameBufferDimension = glm::ivec2(frameBufferWidth, frameBufferHeight);
 
@@ -379,6 +397,10 @@ app::AppState WindowedApp::onInit() {
 	const float scaleFactor = (float)_frameBufferDimension.x / (float)_windowDimension.x;
 	video::init(_windowDimension.x, _windowDimension.y, scaleFactor);
 	video::viewport(0, 0, _frameBufferDimension.x, _frameBufferDimension.y);
+	if (core::Var::getSafe(cfg::ClientShaderCache)->boolVal() && video::hasFeature(video::Feature::ProgramBinary)) {
+		// the entries are written into the home directory
+		core::Singleton<ShaderManager>::getInstance().setProgramCache(io::openFilesystemArchive(filesystem(), "", false));
+	}
 
 	video_trace_init();
 
@@ -399,6 +421,7 @@ app::AppState WindowedApp::onConstruct() {
 	core::Var::get(cfg::ClientGamma, "1.0", core::CV_SHADER, _("Gamma correction"));
 	core::Var::get(cfg::ClientWindowDisplay, 0);
 	core::Var::get(cfg::ClientOpenGLVersion, "3.3", core::CV_READONLY);
+	core::Var::get(cfg::ClientShaderCache, "true", _("Store the compiled shaders in the home directory"), core::Var::boolValidator);
 	core::Var::get(cfg::ClientMouseRotationSpeed, "0.01");
 	core::Var::get(cfg::RenderOutline, "false", core::CV_SHADER, _("Render voxel outline"), core::Var::boolValidator);
 	core::Var::get(cfg::RenderNormals, "false", core::CV_SHADER, _("Render voxel normals"), core::Var::boolValidator);
@@ -429,6 +452,8 @@ app::AppState WindowedApp::onConstruct() {
 
 app::AppState WindowedApp::onCleanup() {
 	core::Singleton<video::EventHandler>::getInstance().removeObserver(this);
+	core::Singleton<ShaderManager>::getInstance().setProgramCache({});
+	video::gpuTimer().shutdown();
 	video::destroyContext(_rendererContext);
 	if (_window != nullptr) {
 		SDL_DestroyWindow(_window);
@@ -21,4 +21,18 @@ BENCHMARK_DEFINE_F(ShapeBuilderBenchmark, OBB)(benchmark::State &state) {
 
 BENCHMARK_REGISTER_F(ShapeBuilderBenchmark, OBB)->Arg(0)->Arg(45);
 
+BENCHMARK_DEFINE_F(ShapeBuilderBenchmark, AABBs)(benchmark::State &state) {
+	video::ShapeBuilder shapeBuilder;
+	for (auto _ : state) {
+		shapeBuilder.clear();
+		for (int64_t i = 0; i < state.range(); ++i) {
+			const glm::vec3 mins((float)i);
+			shapeBuilder.aabb(mins, mins + 1.0f);
+		}
+		benchmark::DoNotOptimize(shapeBuilder.hash());
+	}
+}
+
+BENCHMARK_REGISTER_F(ShapeBuilderBenchmark, AABBs)->Arg(10)->Arg(1000)->Arg(10000);
+
 BENCHMARK_MAIN();
@@ -247,7 +247,10 @@ void setupFeatures() {
 		{"GL_ARB_multi_draw_indirect"},
 		{"GL_ARB_compute_shader"},
 		{"GL_ARB_transform_feedback2"},
-		{"GL_ARB_shader_storage_buffer_object"}
+		{"GL_ARB_shader_storage_buffer_object"},
+		{"GL_ARB_get_program_binary"},
+		{"GL_KHR_parallel_shader_compile", "GL_ARB_parallel_shader_compile"},
+		{"GL_ARB_timer_query", "GL_EXT_disjoint_timer_query"}
 	};
 	static_assert(core::enumVal(Feature::Max) == (int)lengthof(extensionArray), "Array sizes don't match for Feature enum");
 
@@ -271,6 +274,15 @@ void setupFeatures() {
 		}
 	}
 
+	if (renderState().features[core::enumVal(Feature::ProgramBinary)]) {
+		// the extension might be supported without any binary format - e.g. if the driver cache is disabled
+		GLint binaryFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+		checkError();
+		Log::debug("GL_NUM_PROGRAM_BINARY_FORMATS: %i", binaryFormats);
+		renderState().features[core::enumVal(Feature::ProgramBinary)] = binaryFormats > 0;
+	}
+
 	int mask = 0;
 	if (SDL_GL_GetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, &mask) != -1) {
 		if ((mask & SDL_GL_CONTEXT_PROFILE_CORE) != 0) {
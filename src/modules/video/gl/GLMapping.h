@@ -29,7 +29,9 @@ static const struct Formats {
 	{32, GL_DEPTH_COMPONENT24, GL_DEPTH24_STENCIL8, GL_UNSIGNED_INT_24_8},
 	{32, GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT},
 	{0, GL_STENCIL_INDEX8, GL_STENCIL_INDEX8, GL_STENCIL_INDEX8},
-	{16, GL_RG16UI, GL_RG, GL_UNSIGNED_BYTE}
+	{16, GL_RG16UI, GL_RG, GL_UNSIGNED_BYTE},
+	{16, GL_RG8, GL_RG, GL_UNSIGNED_BYTE},
+	{8, GL_R8, GL_RED, GL_UNSIGNED_BYTE}
 };
 static_assert(core::enumVal(TextureFormat::Max) == lengthof(textureFormats), "Array sizes don't match Max");
 
@@ -46,7 +48,9 @@ static const GLenum TextureFormats[] {
 	GL_DEPTH_COMPONENT32F,
 	GL_STENCIL_INDEX8,
 
-	GL_RG16UI
+	GL_RG16UI,
+	GL_RG8,
+	GL_R8
 };
 static_assert(core::enumVal(TextureFormat::Max) == lengthof(TextureFormats), "Array sizes don't match Max");
 
@@ -114,7 +118,9 @@ static_assert(core::enumVal(Vendor::Max) == lengthof(VendorStrings), "Array size
 static const GLenum BufferModes[] {
 	GL_STATIC_DRAW,
 	GL_DYNAMIC_DRAW,
-	GL_STREAM_DRAW
+	GL_STREAM_DRAW,
+	GL_STREAM_DRAW,
+	GL_STREAM_READ
 };
 static_assert(core::enumVal(BufferMode::Max) == lengthof(BufferModes), "Array sizes don't match Max");
 
@@ -132,10 +138,18 @@ static const GLenum BufferTypes[] {
 	GL_TRANSFORM_FEEDBACK_BUFFER,
 	GL_PIXEL_UNPACK_BUFFER,
 	GL_SHADER_STORAGE_BUFFER,
-	GL_DRAW_INDIRECT_BUFFER
+	GL_DRAW_INDIRECT_BUFFER,
+	GL_PIXEL_PACK_BUFFER
 };
 static_assert(core::enumVal(BufferType::Max) == lengthof(BufferTypes), "Array sizes don't match Max");
 
+static const GLenum QueryTypes[] {
+	GL_SAMPLES_PASSED,
+	GL_ANY_SAMPLES_PASSED,
+	GL_TIME_ELAPSED
+};
+static_assert(core::enumVal(QueryType::Max) == lengthof(QueryTypes), "Array sizes don't match Max");
+
 static const GLenum States[] {
 	0,
 	GL_STENCIL_TEST,
@@ -574,6 +574,29 @@ bool readTexture(TextureUnit unit, TextureType type, TextureFormat format, Id ha
 	return true;
 }
 
+bool readTextureToBuffer(TextureUnit unit, TextureType type, TextureFormat format, Id handle, Id buffer) {
+	video_trace_scoped(ReadTextureToBuffer);
+	if (buffer == InvalidId) {
+		return false;
+	}
+	bindTexture(unit, type, handle);
+	const _priv::Formats &f = _priv::textureFormats[core::enumVal(format)];
+	const Id oldBuffer = boundBuffer(BufferType::PixelPackBuffer);
+	bindBuffer(BufferType::PixelPackBuffer, buffer);
+	core_assert(glPixelStorei != nullptr);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	core_assert(glGetTexImage != nullptr);
+	// with a bound pixel pack buffer the pointer is the offset into the buffer
+	glGetTexImage(_priv::TextureTypes[core::enumVal(type)], 0, f.dataFormat, f.dataType, nullptr);
+	const bool error = checkError();
+	if (oldBuffer == InvalidId) {
+		unbindBuffer(BufferType::PixelPackBuffer);
+	} else {
+		bindBuffer(BufferType::PixelPackBuffer, oldBuffer);
+	}
+	return !error;
+}
+
 bool useProgram(Id handle) {
 	if (glstate().programHandle == handle) {
 		return false;
@@ -631,6 +654,23 @@ void *mapBuffer(Id handle, BufferType type, AccessMode mode) {
 	return data;
 }
 
+void unmapBuffer(Id handle, BufferType type) {
+	video_trace_scoped(UnmapBuffer);
+	if (useFeature(Feature::DirectStateAccess)) {
+		core_assert(glUnmapNamedBuffer != nullptr);
+		glUnmapNamedBuffer(handle);
+		checkError();
+		return;
+	}
+	bindBuffer(type, handle);
+	const int typeIndex = core::enumVal(type);
+	const GLenum glType = _priv::BufferTypes[typeIndex];
+	core_assert(glUnmapBuffer != nullptr);
+	glUnmapBuffer(glType);
+	checkError();
+	unbindBuffer(type);
+}
+
 bool bindBuffer(BufferType type, Id handle) {
 	video_trace_scoped(BindBuffer);
 	const int typeIndex = core::enumVal(type);
@@ -673,6 +713,18 @@ bool bindBufferBase(BufferType type, Id handle, uint32_t index) {
 	return true;
 }
 
+bool bindBufferRange(BufferType type, Id handle, uint32_t index, intptr_t offset, size_t size) {
+	video_trace_scoped(BindBufferRange);
+	const int typeIndex = core::enumVal(type);
+	const GLenum glType = _priv::BufferTypes[typeIndex];
+	// the range changes with every call - so there is no state check here
+	glstate().bufferHandle[typeIndex] = handle;
+	core_assert(glBindBufferRange != nullptr);
+	glBindBufferRange(glType, (GLuint)index, handle, (GLintptr)offset, (GLsizeiptr)size);
+	checkError();
+	return true;
+}
+
 void genBuffers(uint8_t amount, Id *ids) {
 	static_assert(sizeof(Id) == sizeof(GLuint), "Unexpected sizes");
 	if (useFeature(Feature::DirectStateAccess)) {
@@ -706,6 +758,88 @@ void deleteBuffers(uint8_t amount, Id *ids) {
 	}
 }
 
+void genQueries(uint8_t amount, Id *ids) {
+	static_assert(sizeof(Id) == sizeof(GLuint), "Unexpected sizes");
+	core_assert(glGenQueries != nullptr);
+	glGenQueries((GLsizei)amount, (GLuint *)ids);
+	checkError();
+}
+
+void deleteQueries(uint8_t amount, Id *ids) {
+	if (amount == 0) {
+		return;
+	}
+	static_assert(sizeof(Id) == sizeof(GLuint), "Unexpected sizes");
+	core_assert(glDeleteQueries != nullptr);
+	glDeleteQueries((GLsizei)amount, (GLuint *)ids);
+	checkError();
+	for (uint8_t i = 0u; i < amount; ++i) {
+		ids[i] = InvalidId;
+	}
+}
+
+bool beginQuery(QueryType type, Id id) {
+	if (id == InvalidId) {
+		return false;
+	}
+	const GLenum glType = _priv::QueryTypes[core::enumVal(type)];
+	core_assert(glBeginQuery != nullptr);
+	glBeginQuery(glType, (GLuint)id);
+	checkError();
+	return true;
+}
+
+bool endQuery(QueryType type) {
+	const GLenum glType = _priv::QueryTypes[core::enumVal(type)];
+	core_assert(glEndQuery != nullptr);
+	glEndQuery(glType);
+	checkError();
+	return true;
+}
+
+bool isQueryResultAvailable(Id id) {
+	if (id == InvalidId) {
+		return false;
+	}
+	GLuint available = 0;
+	core_assert(glGetQueryObjectuiv != nullptr);
+	glGetQueryObjectuiv((GLuint)id, GL_QUERY_RESULT_AVAILABLE, &available);
+	checkError();
+	return available != 0;
+}
+
+uint32_t queryResult(Id id) {
+	if (id == InvalidId) {
+		return 0u;
+	}
+	GLuint result = 0;
+	core_assert(glGetQueryObjectuiv != nullptr);
+	glGetQueryObjectuiv((GLuint)id, GL_QUERY_RESULT, &result);
+	checkError();
+	return (uint32_t)result;
+}
+
+bool queryTimestamp(Id id) {
+	if (id == InvalidId) {
+		return false;
+	}
+	core_assert(glQueryCounter != nullptr);
+	glQueryCounter((GLuint)id, GL_TIMESTAMP);
+	checkError();
+	return true;
+}
+
+uint64_t timestampResult(Id id) {
+	if (id == InvalidId) {
+		return 0u;
+	}
+	GLuint64 result = 0;
+	core_assert(glGetQueryObjectui64v != nullptr);
+	glGetQueryObjectui64v((GLuint)id, GL_QUERY_RESULT, &result);
+	checkError();
+	return (uint64_t)result;
+}
+
 void genVertexArrays(uint8_t amount, Id *ids) {
 	static_assert(sizeof(Id) == sizeof(GLuint), "Unexpected sizes");
 	if (useFeature(Feature::DirectStateAccess)) {
@@ -1138,6 +1272,42 @@ void bufferSubData(Id handle, BufferType type, intptr_t offset, const void *data
 	}
 }
 
+void *bufferStorage(Id handle, BufferType type, size_t size) {
+	video_trace_scoped(BufferStorage);
+	if (size == 0 || !hasFeature(Feature::BufferStorage)) {
+		return nullptr;
+	}
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLuint lid = (GLuint)handle;
+	void *data = nullptr;
+	if (useFeature(Feature::DirectStateAccess)) {
+		core_assert(glNamedBufferStorage != nullptr);
+		glNamedBufferStorage(lid, (GLsizeiptr)size, nullptr, flags);
+		checkError();
+		core_assert(glMapNamedBufferRange != nullptr);
+		data = glMapNamedBufferRange(lid, 0, (GLsizeiptr)size, flags);
+		checkError();
+	} else {
+		const GLenum glType = _priv::BufferTypes[core::enumVal(type)];
+		const Id oldBuffer = boundBuffer(type);
+		const bool changed = bindBuffer(type, handle);
+		core_assert(glBufferStorage != nullptr);
+		glBufferStorage(glType, (GLsizeiptr)size, nullptr, flags);
+		checkError();
+		core_assert(glMapBufferRange != nullptr);
+		data = glMapBufferRange(glType, 0, (GLsizeiptr)size, flags);
+		checkError();
+		if (changed) {
+			if (oldBuffer == InvalidId) {
+				unbindBuffer(type);
+			} else {
+				bindBuffer(type, oldBuffer);
+			}
+		}
+	}
+	return data;
+}
+
 // the fbo is flipped in memory, we have to deal with it here
 const glm::vec4 &framebufferUV() {
 	static const glm::vec4 uv(0.0f, 1.0f, 1.0, 0.0f);
@@ -1277,7 +1447,10 @@ void setupTexture(const TextureConfig &config) {
 		checkError();
 	}
 	if (config.type() != TextureType::Texture2DMultisample && config.filterMin() != TextureFilter::Max) {
-		const GLenum glFilterMin = _priv::TextureFilters[core::enumVal(config.filterMin())];
+		GLenum glFilterMin = _priv::TextureFilters[core::enumVal(config.filterMin())];
+		if (config.mipmaps()) {
+			glFilterMin = config.filterMin() == TextureFilter::Nearest ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR;
+		}
 		glTexParameteri(glType, GL_TEXTURE_MIN_FILTER, glFilterMin);
 		checkError();
 	}
@@ -1354,6 +1527,35 @@ void uploadTexture(TextureType type, TextureFormat format, int width, int height
 	}
 }
 
+void uploadTextureRegion(TextureType type, TextureFormat format, int x, int y, int z, int width, int height, int depth,
+						 const uint8_t *data) {
+	video_trace_scoped(UploadTextureRegion);
+	const _priv::Formats &f = _priv::textureFormats[core::enumVal(format)];
+	const GLenum glType = _priv::TextureTypes[core::enumVal(type)];
+	core_assert(type != TextureType::Max);
+	core_assert(type != TextureType::Texture2DMultisample && type != TextureType::Texture2DMultisampleArray);
+	if (type == TextureType::Texture1D) {
+		core_assert(glTexSubImage1D != nullptr);
+		glTexSubImage1D(glType, 0, x, width, f.dataFormat, f.dataType, (const GLvoid *)data);
+	} else if (type == TextureType::Texture2D) {
+		core_assert(glTexSubImage2D != nullptr);
+		glTexSubImage2D(glType, 0, x, y, width, height, f.dataFormat, f.dataType, (const GLvoid *)data);
+	} else {
+		core_assert(glTexSubImage3D != nullptr);
+		glTexSubImage3D(glType, 0, x, y, z, width, height, depth, f.dataFormat, f.dataType, (const GLvoid *)data);
+	}
+	checkError();
+}
+
+void generateMipmaps(TextureType type) {
+	video_trace_scoped(GenerateMipmaps);
+	core_assert(type != TextureType::Texture2DMultisample && type != TextureType::Texture2DMultisampleArray);
+	const GLenum glType = _priv::TextureTypes[core::enumVal(type)];
+	core_assert(glGenerateMipmap != nullptr);
+	glGenerateMipmap(glType);
+	checkError();
+}
+
 void drawElements(Primitive mode, size_t numIndices, DataType type, void *offset) {
 	video_trace_scoped(DrawElements);
 	if (numIndices <= 0) {
@@ -1368,6 +1570,37 @@ void drawElements(Primitive mode, size_t numIndices, DataType type, void *offset
 	checkError();
 }
 
+void drawElementsInstanced(Primitive mode, size_t numIndices, DataType type, int amount, void *offset) {
+	video_trace_scoped(DrawElementsInstanced);
+	if (numIndices <= 0 || amount <= 0) {
+		return;
+	}
+	core_assert_msg(glstate().vertexArrayHandle != InvalidId, "No vertex buffer is bound for this draw call");
+	const GLenum glMode = _priv::Primitives[core::enumVal(mode)];
+	const GLenum glType = _priv::DataTypes[core::enumVal(type)];
+	video::validate(glstate().programHandle);
+	core_assert(glDrawElementsInstanced != nullptr);
+	glDrawElementsInstanced(glMode, (GLsizei)numIndices, glType, (GLvoid *)offset, (GLsizei)amount);
+	checkError();
+}
+
+void multiDrawElementsIndirect(Primitive mode, DataType type, size_t offset, int drawCount) {
+	video_trace_scoped(MultiDrawElementsIndirect);
+	if (drawCount <= 0) {
+		return;
+	}
+	core_assert_msg(glstate().vertexArrayHandle != InvalidId, "No vertex buffer is bound for this draw call");
+	core_assert_msg(glstate().bufferHandle[core::enumVal(BufferType::IndirectBuffer)] != InvalidId,
+					"No indirect buffer is bound for this draw call");
+	const GLenum glMode = _priv::Primitives[core::enumVal(mode)];
+	const GLenum glType = _priv::DataTypes[core::enumVal(type)];
+	video::validate(glstate().programHandle);
+	core_assert(glMultiDrawElementsIndirect != nullptr);
+	glMultiDrawElementsIndirect(glMode, glType, (const GLvoid *)(intptr_t)offset, (GLsizei)drawCount,
+								(GLsizei)sizeof(DrawElementsIndirectCommand));
+	checkError();
+}
+
 void drawArrays(Primitive mode, size_t count) {
 	video_trace_scoped(DrawArrays);
 	const GLenum glMode = _priv::Primitives[core::enumVal(mode)];
@@ -1408,21 +1641,7 @@ void enableDebug(DebugSeverity severity) {
 	Log::info("enable opengl debug messages");
 }
 
-bool compileShader(Id id, ShaderType shaderType, const core::String &source, const core::String &name) {
-	video_trace_scoped(CompileShader);
-	if (id == InvalidId) {
-		return false;
-	}
-	const char *src = source.c_str();
-	video::checkError();
-	const GLuint lid = (GLuint)id;
-	core_assert(glShaderSource != nullptr);
-	glShaderSource(lid, 1, (const GLchar **)&src, nullptr);
-	video::checkError();
-	core_assert(glCompileShader != nullptr);
-	glCompileShader(lid);
-	video::checkError();
-
+static bool checkCompileStatus(GLuint lid, ShaderType shaderType, const core::String &name) {
 	GLint status = 0;
 	core_assert(glGetShaderiv != nullptr);
 	glGetShaderiv(lid, GL_COMPILE_STATUS, &status);
@@ -1461,8 +1680,17 @@ bool compileShader(Id id, ShaderType shaderType, const core::String &source, con
 			break;
 		}
 
-		if (status != GL_TRUE) {
-			Log::error("Failed to compile: %s\n%s\nshaderType: %s", name.c_str(), compileLog.c_str(), strShaderType);
+		Log::error("Failed to compile: %s\n%s\nshaderType: %s", name.c_str(), compileLog.c_str(), strShaderType);
+		GLint sourceLength = 0;
+		glGetShaderiv(lid, GL_SHADER_SOURCE_LENGTH, &sourceLength);
+		video::checkError();
+		if (sourceLength > 1) {
+			GLchar *strSource = new GLchar[sourceLength + 1];
+			core_assert(glGetShaderSource != nullptr);
+			glGetShaderSource(lid, sourceLength, nullptr, strSource);
+			video::checkError();
+			const core::String source(strSource);
+			delete[] strSource;
 			core::DynamicArray<core::String> tokens;
 			core::string::splitString(source, tokens, "\n");
 			int i = 1;
@@ -1470,10 +1698,44 @@ bool compileShader(Id id, ShaderType shaderType, const core::String &source, con
 				Log::error("%03i: %s", i, line.c_str());
 				++i;
 			}
-		} else {
-			Log::info("%s: %s", name.c_str(), compileLog.c_str());
 		}
 	}
+	return false;
+}
+
+// the binary of the linked program can be stored in the ProgramCache
+static void retrievableProgramBinary(GLuint lid) {
+	if (!hasFeature(Feature::ProgramBinary)) {
+		return;
+	}
+	core_assert(glProgramParameteri != nullptr);
+	glProgramParameteri(lid, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	video::checkError();
+}
+
+bool compileShader(Id id, ShaderType shaderType, const core::String &source, const core::String &name) {
+	video_trace_scoped(CompileShader);
+	if (id == InvalidId) {
+		return false;
+	}
+	const char *src = source.c_str();
+	video::checkError();
+	const GLuint lid = (GLuint)id;
+	core_assert(glShaderSource != nullptr);
+	glShaderSource(lid, 1, (const GLchar **)&src, nullptr);
+	video::checkError();
+	core_assert(glCompileShader != nullptr);
+	glCompileShader(lid);
+	video::checkError();
+
+	if (hasFeature(Feature::ParallelShaderCompile)) {
+		// querying the status would block until the driver threads are done - the stages of a program are
+		// compiled in parallel this way and the errors are reported when the program fails to link
+		return true;
+	}
+	if (checkCompileStatus(lid, shaderType, name)) {
+		return true;
+	}
 	deleteShader(id);
 	return false;
 }
@@ -1484,6 +1746,7 @@ bool linkComputeShader(Id program, Id comp, const core::String &name) {
 	core_assert(glAttachShader != nullptr);
 	glAttachShader(lid, comp);
 	video::checkError();
+	retrievableProgramBinary(lid);
 	core_assert(glLinkProgram != nullptr);
 	glLinkProgram(lid);
 	GLint status = 0;
@@ -1491,6 +1754,9 @@ bool linkComputeShader(Id program, Id comp, const core::String &name) {
 	glGetProgramiv(lid, GL_LINK_STATUS, &status);
 	video::checkError();
 	if (status == GL_FALSE) {
+		if (hasFeature(Feature::ParallelShaderCompile)) {
+			checkCompileStatus((GLuint)comp, ShaderType::Compute, name);
+		}
 		GLint infoLogLength = 0;
 		core_assert(glGetProgramiv != nullptr);
 		glGetProgramiv(lid, GL_INFO_LOG_LENGTH, &infoLogLength);
@@ -1562,7 +1828,7 @@ bool runShader(Id program, const glm::uvec3 &workGroups, bool wait) {
 		glMemoryBarrier(GL_ALL_BARRIER_BITS);
 		video::checkError();
 	}
-	return false;
+	return true;
 }
 
 bool linkShader(Id program, Id vert, Id frag, Id geom, const core::String &name) {
@@ -1578,6 +1844,7 @@ bool linkShader(Id program, Id vert, Id frag, Id geom, const core::String &name)
 		checkError();
 	}
 
+	retrievableProgramBinary(lid);
 	core_assert(glLinkProgram != nullptr);
 	glLinkProgram(lid);
 	checkError();
@@ -1586,6 +1853,13 @@ bool linkShader(Id program, Id vert, Id frag, Id geom, const core::String &name)
 	glGetProgramiv(lid, GL_LINK_STATUS, &status);
 	checkError();
 	if (status == GL_FALSE) {
+		if (hasFeature(Feature::ParallelShaderCompile)) {
+			checkCompileStatus((GLuint)vert, ShaderType::Vertex, name);
+			checkCompileStatus((GLuint)frag, ShaderType::Fragment, name);
+			if (geom != InvalidId) {
+				checkCompileStatus((GLuint)geom, ShaderType::Geometry, name);
+			}
+		}
 		GLint infoLogLength = 0;
 		glGetProgramiv(lid, GL_INFO_LOG_LENGTH, &infoLogLength);
 		checkError();
@@ -1621,6 +1895,58 @@ bool linkShader(Id program, Id vert, Id frag, Id geom, const core::String &name)
 	return true;
 }
 
+bool getProgramBinary(Id program, uint32_t &format, core::DynamicArray<uint8_t> &binary) {
+	video_trace_scoped(GetProgramBinary);
+	if (program == InvalidId || !hasFeature(Feature::ProgramBinary)) {
+		return false;
+	}
+	const GLuint lid = (GLuint)program;
+	GLint length = 0;
+	core_assert(glGetProgramiv != nullptr);
+	glGetProgramiv(lid, GL_PROGRAM_BINARY_LENGTH, &length);
+	checkError();
+	if (length <= 0) {
+		return false;
+	}
+	binary.resize(length);
+	GLenum binaryFormat = 0;
+	GLsizei written = 0;
+	core_assert(glGetProgramBinary != nullptr);
+	glGetProgramBinary(lid, length, &written, &binaryFormat, binary.data());
+	if (checkError() || written <= 0) {
+		binary.clear();
+		return false;
+	}
+	binary.resize(written);
+	format = (uint32_t)binaryFormat;
+	return true;
+}
+
+bool programBinary(Id program, uint32_t format, const uint8_t *binary, size_t size, const core::String &name) {
+	video_trace_scoped(ProgramBinary);
+	if (program == InvalidId || !hasFeature(Feature::ProgramBinary)) {
+		return false;
+	}
+	const GLuint lid = (GLuint)program;
+	core_assert(glProgramBinary != nullptr);
+	glProgramBinary(lid, (GLenum)format, binary, (GLsizei)size);
+	// an outdated binary is no error - the driver was updated and the shaders have to be linked again
+	checkError(false);
+	GLint status = 0;
+	core_assert(glGetProgramiv != nullptr);
+	glGetProgramiv(lid, GL_LINK_STATUS, &status);
+	checkError();
+	if (status != GL_TRUE) {
+		Log::debug("The driver rejected the program binary for %s", name.c_str());
+		return false;
+	}
+	return true;
+}
+
+const core::String &driverIdentifier() {
+	return glstate().driverIdentifier;
+}
+
 int fetchUniforms(Id program, ShaderUniforms &uniforms, const core::String &name) {
 	video_trace_scoped(FetchUniforms);
 	int uniformsCnt = _priv::fillUniforms(program, uniforms, name, false);
@@ -1776,6 +2102,8 @@ bool init(int windowWidth, int windowHeight, float scaleFactor) {
 	Log::debug("GL_VENDOR: %s", glvendor);
 	Log::debug("GL_RENDERER: %s", glrenderer);
 	Log::debug("GL_VERSION: %s", glversion);
+	glstate().driverIdentifier = core::string::format("%s|%s|%s", glvendor ? glvendor : "", glrenderer ? glrenderer : "",
+											 glversion ? glversion : "");
 	if (glvendor != nullptr) {
 		const core::String vendor(glvendor);
 		for (int i = 0; i < core::enumVal(Vendor::Max); ++i) {
@@ -1808,6 +2136,17 @@ bool init(int windowWidth, int windowHeight, float scaleFactor) {
 		Log::debug("Activated vsync");
 	}
 
+	if (hasFeature(Feature::ParallelShaderCompile)) {
+		// let the driver decide about the amount of compiler threads
+		if (glMaxShaderCompilerThreadsKHR != nullptr) {
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+		} else if (glMaxShaderCompilerThreadsARB != nullptr) {
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+		}
+		checkError();
+		Log::debug("Use parallel shader compilation");
+	}
+
 	if (useFeature(Feature::DirectStateAccess)) {
 		Log::debug("Use direct state access");
 	} else {
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "core/String.h"
 #include "core/collection/DynamicSet.h"
 #include "core/collection/BitSet.h"
 #include "flextGL.h"
@@ -26,6 +27,8 @@ struct GLState {
 	core::DynamicSet<Id> textures;
 	bool clipOriginLowerLeft = true;
 	GLVersion glVersion {0, 0};
+	// vendor, renderer and version string of the driver
+	core::String driverIdentifier;
 	glm::vec4 clearColor {0.0f};
 	Face cullFace = Face::Back;
 	CompareFunc depthFunc = CompareFunc::Less;
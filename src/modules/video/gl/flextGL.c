@@ -62,6 +62,18 @@ int flextInit(void)
         FLEXT_ARB_shader_storage_buffer_object = GL_TRUE;
     }
 
+    if (SDL_GL_ExtensionSupported("GL_ARB_get_program_binary")) {
+        FLEXT_ARB_get_program_binary = GL_TRUE;
+    }
+
+    if (SDL_GL_ExtensionSupported("GL_ARB_parallel_shader_compile")) {
+        FLEXT_ARB_parallel_shader_compile = GL_TRUE;
+    }
+
+    if (SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile")) {
+        FLEXT_KHR_parallel_shader_compile = GL_TRUE;
+    }
+
 
     return 0;
 }
@@ -191,6 +203,12 @@ void flextLoadOpenGLFunctions(void)
     glpfDrawArraysIndirect = (PFNGLDRAWARRAYSINDIRECT_PROC*)SDL_GL_GetProcAddress("glDrawArraysIndirect");
     glpfDrawElementsIndirect = (PFNGLDRAWELEMENTSINDIRECT_PROC*)SDL_GL_GetProcAddress("glDrawElementsIndirect");
 
+    /* GL_ARB_get_program_binary */
+
+    glpfGetProgramBinary = (PFNGLGETPROGRAMBINARY_PROC*)SDL_GL_GetProcAddress("glGetProgramBinary");
+    glpfProgramBinary = (PFNGLPROGRAMBINARY_PROC*)SDL_GL_GetProcAddress("glProgramBinary");
+    glpfProgramParameteri = (PFNGLPROGRAMPARAMETERI_PROC*)SDL_GL_GetProcAddress("glProgramParameteri");
+
     /* GL_ARB_instanced_arrays */
 
     glpfVertexAttribDivisorARB = (PFNGLVERTEXATTRIBDIVISORARB_PROC*)SDL_GL_GetProcAddress("glVertexAttribDivisorARB");
@@ -200,6 +218,10 @@ void flextLoadOpenGLFunctions(void)
     glpfMultiDrawArraysIndirect = (PFNGLMULTIDRAWARRAYSINDIRECT_PROC*)SDL_GL_GetProcAddress("glMultiDrawArraysIndirect");
     glpfMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECT_PROC*)SDL_GL_GetProcAddress("glMultiDrawElementsIndirect");
 
+    /* GL_ARB_parallel_shader_compile */
+
+    glpfMaxShaderCompilerThreadsARB = (PFNGLMAXSHADERCOMPILERTHREADSARB_PROC*)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsARB");
+
     /* GL_ARB_shader_image_load_store */
 
     glpfBindImageTexture = (PFNGLBINDIMAGETEXTURE_PROC*)SDL_GL_GetProcAddress("glBindImageTexture");
@@ -219,6 +241,10 @@ void flextLoadOpenGLFunctions(void)
     glpfPauseTransformFeedback = (PFNGLPAUSETRANSFORMFEEDBACK_PROC*)SDL_GL_GetProcAddress("glPauseTransformFeedback");
     glpfResumeTransformFeedback = (PFNGLRESUMETRANSFORMFEEDBACK_PROC*)SDL_GL_GetProcAddress("glResumeTransformFeedback");
 
+    /* GL_KHR_parallel_shader_compile */
+
+    glpfMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHR_PROC*)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsKHR");
+
     /* GL_VERSION_1_0 */
 
     glpfBlendFunc = (PFNGLBLENDFUNC_PROC*)SDL_GL_GetProcAddress("glBlendFunc");
@@ -612,6 +638,9 @@ int FLEXT_ARB_compute_shader = GL_FALSE;
 int FLEXT_ARB_shader_image_load_store = GL_FALSE;
 int FLEXT_ARB_transform_feedback2 = GL_FALSE;
 int FLEXT_ARB_shader_storage_buffer_object = GL_FALSE;
+int FLEXT_ARB_get_program_binary = GL_FALSE;
+int FLEXT_ARB_parallel_shader_compile = GL_FALSE;
+int FLEXT_KHR_parallel_shader_compile = GL_FALSE;
 
 /* ---------------------- Function pointer definitions --------------------- */
 
@@ -736,6 +765,12 @@ PFNGLVERTEXARRAYVERTEXBUFFERS_PROC* glpfVertexArrayVertexBuffers = NULL;
 PFNGLDRAWARRAYSINDIRECT_PROC* glpfDrawArraysIndirect = NULL;
 PFNGLDRAWELEMENTSINDIRECT_PROC* glpfDrawElementsIndirect = NULL;
 
+/* GL_ARB_get_program_binary */
+
+PFNGLGETPROGRAMBINARY_PROC* glpfGetProgramBinary = NULL;
+PFNGLPROGRAMBINARY_PROC* glpfProgramBinary = NULL;
+PFNGLPROGRAMPARAMETERI_PROC* glpfProgramParameteri = NULL;
+
 /* GL_ARB_instanced_arrays */
 
 PFNGLVERTEXATTRIBDIVISORARB_PROC* glpfVertexAttribDivisorARB = NULL;
@@ -745,6 +780,10 @@ PFNGLVERTEXATTRIBDIVISORARB_PROC* glpfVertexAttribDivisorARB = NULL;
 PFNGLMULTIDRAWARRAYSINDIRECT_PROC* glpfMultiDrawArraysIndirect = NULL;
 PFNGLMULTIDRAWELEMENTSINDIRECT_PROC* glpfMultiDrawElementsIndirect = NULL;
 
+/* GL_ARB_parallel_shader_compile */
+
+PFNGLMAXSHADERCOMPILERTHREADSARB_PROC* glpfMaxShaderCompilerThreadsARB = NULL;
+
 /* GL_ARB_shader_image_load_store */
 
 PFNGLBINDIMAGETEXTURE_PROC* glpfBindImageTexture = NULL;
@@ -764,6 +803,10 @@ PFNGLISTRANSFORMFEEDBACK_PROC* glpfIsTransformFeedback = NULL;
 PFNGLPAUSETRANSFORMFEEDBACK_PROC* glpfPauseTransformFeedback = NULL;
 PFNGLRESUMETRANSFORMFEEDBACK_PROC* glpfResumeTransformFeedback = NULL;
 
+/* GL_KHR_parallel_shader_compile */
+
+PFNGLMAXSHADERCOMPILERTHREADSKHR_PROC* glpfMaxShaderCompilerThreadsKHR = NULL;
+
 /* GL_VERSION_1_0 */
 
 PFNGLBLENDFUNC_PROC* glpfBlendFunc = NULL;
@@ -0,0 +1,44 @@
+/**
+ * @file
+ */
+
+#include "video/GPUTimer.h"
+#include "video/tests/AbstractGLTest.h"
+
+namespace video {
+
+class GPUTimerTest : public AbstractGLTest {};
+
+TEST_F(GPUTimerTest, testNestedPasses) {
+	if (!hasFeature(Feature::TimerQuery)) {
+		GTEST_SKIP() << "No support for timer queries";
+	}
+	GPUTimer timer;
+	timer.setEnabled(true);
+	ASSERT_TRUE(timer.enabled());
+	for (int i = 0; i < 2; ++i) {
+		timer.begin("outer");
+		timer.begin("inner");
+		clear(ClearFlag::Color);
+		timer.end();
+		timer.begin("inner");
+		timer.end();
+		timer.end();
+		finish();
+		timer.frameEnd();
+	}
+	const core::DynamicArray<GPUTimer::PassTime> &results = timer.results();
+	ASSERT_EQ(2u, results.size());
+	EXPECT_STREQ("outer", results[0].name);
+	EXPECT_EQ(0, results[0].depth);
+	EXPECT_STREQ("inner", results[1].name);
+	EXPECT_EQ(1, results[1].depth);
+	EXPECT_GE(results[0].millis, 0.0);
+
+	timer.setEnabled(false);
+	timer.frameEnd();
+	EXPECT_TRUE(timer.results().empty());
+	timer.shutdown();
+}
+
+} // namespace video
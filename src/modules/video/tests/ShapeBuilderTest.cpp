@@ -17,4 +17,28 @@ TEST_F(ShapeBuilderTest, testInclude) {
 	EXPECT_EQ(24u, shapeBuilder.getIndices().size());
 }
 
+TEST_F(ShapeBuilderTest, testAABBSharedVertices) {
+	ShapeBuilder shapeBuilder;
+	for (int i = 0; i < 1000; ++i) {
+		const glm::vec3 mins((float)i);
+		shapeBuilder.aabb(mins, mins + 1.0f);
+	}
+	EXPECT_EQ(Primitive::Lines, shapeBuilder.primitive());
+	EXPECT_EQ(8000u, shapeBuilder.getVertices().size());
+	EXPECT_EQ(24000u, shapeBuilder.getIndices().size());
+	EXPECT_EQ(glm::vec3(1.0f), shapeBuilder.getVertices()[8 + 5]);
+}
+
+TEST_F(ShapeBuilderTest, testHash) {
+	ShapeBuilder shapeBuilder;
+	shapeBuilder.aabb(glm::vec3(0.0f), glm::vec3(1.0f));
+	const uint32_t hash = shapeBuilder.hash();
+	shapeBuilder.clear();
+	shapeBuilder.aabb(glm::vec3(0.0f), glm::vec3(1.0f));
+	EXPECT_EQ(hash, shapeBuilder.hash());
+	shapeBuilder.clear();
+	shapeBuilder.aabb(glm::vec3(0.0f), glm::vec3(2.0f));
+	EXPECT_NE(hash, shapeBuilder.hash());
+}
+
 } // namespace video
@@ -0,0 +1,84 @@
+/**
+ * @file
+ */
+
+#include "video/TexturePool.h"
+#include "core/TimeProvider.h"
+#include "image/Image.h"
+#include "video/tests/AbstractGLTest.h"
+
+namespace video {
+
+class TexturePoolTest : public AbstractGLTest {
+protected:
+	image::ImagePtr createImage(const core::String &name, int w, int h) {
+		core::DynamicArray<core::RGBA> pixels;
+		pixels.resize(w * h);
+		for (int i = 0; i < w * h; ++i) {
+			pixels[i] = core::RGBA(i * 10, 255 - i * 10, i, 255);
+		}
+		const image::ImagePtr &image = image::createEmptyImage(name);
+		image->loadRGBA((const uint8_t *)pixels.data(), w, h);
+		return image;
+	}
+};
+
+TEST_F(TexturePoolTest, testAddImageAsyncBudget) {
+	TexturePool pool;
+	ASSERT_TRUE(pool.init());
+	// only one image per update
+	pool.setUploadBudget(1u);
+	const TexturePtr &texture1 = pool.addImageAsync(createImage("image1", 4, 2));
+	const TexturePtr &texture2 = pool.addImageAsync(createImage("image2", 8, 4));
+	ASSERT_TRUE(texture1);
+	ASSERT_TRUE(texture2);
+	EXPECT_FALSE(texture1->isLoaded());
+	EXPECT_FALSE(texture2->isLoaded());
+	EXPECT_EQ(2, pool.pending());
+	EXPECT_EQ(0u, pool.memory());
+
+	pool.update();
+	EXPECT_TRUE(texture1->isLoaded());
+	EXPECT_FALSE(texture2->isLoaded());
+	EXPECT_EQ(4, texture1->width());
+	EXPECT_EQ(2, texture1->height());
+	EXPECT_EQ(1, pool.pending());
+
+	pool.update();
+	EXPECT_TRUE(texture2->isLoaded());
+	EXPECT_EQ(8, texture2->width());
+	EXPECT_EQ(0, pool.pending());
+	// rgba with mipmaps
+	EXPECT_EQ((size_t)(4 * 2 * 4 + 4 * 2 * 4 / 3 + 8 * 4 * 4 + 8 * 4 * 4 / 3), pool.memory());
+	pool.shutdown();
+}
+
+TEST_F(TexturePoolTest, testLoadAsyncAndEvict) {
+	const core::String filename = "texturepool-test.png";
+	ASSERT_TRUE(image::writeImage(createImage("write", 16, 16), filename));
+
+	TexturePool pool;
+	ASSERT_TRUE(pool.init());
+	TexturePtr texture = pool.loadAsync(filename);
+	ASSERT_TRUE(texture);
+	const uint64_t start = core::TimeProvider::systemMillis();
+	while (pool.pending() > 0 && core::TimeProvider::systemMillis() - start < 5000u) {
+		pool.update();
+	}
+	ASSERT_TRUE(texture->isLoaded());
+	EXPECT_EQ(16, texture->width());
+	EXPECT_TRUE(pool.has(filename));
+	EXPECT_GT(pool.memory(), 0u);
+
+	pool.setMaxMemory(1u);
+	pool.update();
+	// still referenced
+	EXPECT_TRUE(pool.has(filename));
+	texture = TexturePtr();
+	pool.update();
+	EXPECT_FALSE(pool.has(filename));
+	EXPECT_EQ(0u, pool.memory());
+	pool.shutdown();
+}
+
+} // namespace video
@@ -0,0 +1,56 @@
+/**
+ * @file
+ */
+
+#include "video/TextureReadback.h"
+#include "core/collection/DynamicArray.h"
+#include "video/TextureConfig.h"
+#include "video/tests/AbstractGLTest.h"
+
+namespace video {
+
+class TextureReadbackTest : public AbstractGLTest {};
+
+TEST_F(TextureReadbackTest, testReadInOrder) {
+	const int w = 4;
+	const int h = 2;
+	core::RGBA pixels[w * h];
+	for (int i = 0; i < w * h; ++i) {
+		pixels[i] = core::RGBA(i * 10, 255 - i * 10, i, 255);
+	}
+	TextureConfig cfg;
+	cfg.format(TextureFormat::RGBA);
+	const TexturePtr &texture = createTexture(cfg, w, h, "readback");
+	ASSERT_TRUE(texture);
+	texture->upload(w, h, (const uint8_t *)pixels);
+
+	TextureReadback readback;
+	core::DynamicArray<image::ImagePtr> images;
+	// one more read than there are buffers - the oldest read is finished to get a free buffer
+	const int reads = TextureReadback::Buffers + 1;
+	for (int i = 0; i < reads; ++i) {
+		ASSERT_TRUE(readback.read(texture, core::String::format("readback%i", i),
+								  [&](const image::ImagePtr &image) { images.push_back(image); }));
+		readback.update();
+	}
+	readback.flush();
+	EXPECT_EQ(0, readback.pending());
+	ASSERT_EQ(reads, (int)images.size());
+	for (int i = 0; i < reads; ++i) {
+		const image::ImagePtr &image = images[i];
+		ASSERT_TRUE(image->isLoaded());
+		EXPECT_EQ(core::String::format("readback%i", i), image->name());
+		ASSERT_EQ(w, image->width());
+		ASSERT_EQ(h, image->height());
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				// the image origin is upper left
+				EXPECT_EQ(pixels[(h - 1 - y) * w + x], image->colorAt(x, y)) << x << ":" << y;
+			}
+		}
+	}
+	readback.shutdown();
+	texture->shutdown();
+}
+
+} // namespace video
@@ -5,6 +5,8 @@
  */
 
 #include "VkRenderer.h"
+#include "VkState.h"
+#include "core/ArrayLength.h"
 #include "core/Log.h"
 #include "core/StandardLib.h"
 #include "core/Var.h"
@@ -17,52 +19,81 @@
 
 namespace video {
 
+static inline _priv::VkState &vkstate() {
+	static _priv::VkState s;
+	return s;
+}
+
 void setup() {
 }
 
-bool init(int windowWidth, int windowHeight, float scaleFactor) {
-	if (flextVkInit() == -1) {
-		Log::error("Could not initialize opengl: %s", SDL_GetError());
+/**
+ * @return @c false if no device with a queue family that supports graphics and the presentation to the surface was
+ * found
+ */
+static bool selectPhysicalDevice() {
+	uint32_t physicalDeviceCount = 0u;
+	vkEnumeratePhysicalDevices(vkstate().instance, &physicalDeviceCount, nullptr);
+	if (physicalDeviceCount == 0u) {
+		Log::error("No vulkan device found");
 		return false;
 	}
-
-	SDL_Window *window = nullptr;
-
-	VkInstance instance;
-	{
-		unsigned int count;
-		SDL_Vulkan_GetInstanceExtensions(window, &count, nullptr);
-		const char **names = (const char **)core_malloc(sizeof(const char *) * count);
-		SDL_Vulkan_GetInstanceExtensions(window, &count, names);
-
-		VkInstanceCreateInfo createInfo;
-		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-		createInfo.pNext = nullptr;
-		createInfo.flags = 0;
-		createInfo.pApplicationInfo = nullptr;
-		createInfo.enabledLayerCount = 0;
-		createInfo.ppEnabledLayerNames = nullptr;
-		createInfo.enabledExtensionCount = count;
-		createInfo.ppEnabledExtensionNames = names;
-
-		vkCreateInstance(&createInfo, nullptr, &instance);
-		core_free(names);
+	VkPhysicalDevice *physicalDevices = (VkPhysicalDevice *)core_malloc(sizeof(VkPhysicalDevice) * physicalDeviceCount);
+	vkEnumeratePhysicalDevices(vkstate().instance, &physicalDeviceCount, physicalDevices);
+	bool found = false;
+	for (uint32_t i = 0u; i < physicalDeviceCount && !found; ++i) {
+		uint32_t queueFamilyCount = 0u;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevices[i], &queueFamilyCount, nullptr);
+		VkQueueFamilyProperties *queueFamilies =
+			(VkQueueFamilyProperties *)core_malloc(sizeof(VkQueueFamilyProperties) * queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevices[i], &queueFamilyCount, queueFamilies);
+		for (uint32_t family = 0u; family < queueFamilyCount; ++family) {
+			if ((queueFamilies[family].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0) {
+				continue;
+			}
+			VkBool32 present = VK_FALSE;
+			vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevices[i], family, vkstate().surface, &present);
+			if (present != VK_TRUE) {
+				continue;
+			}
+			vkstate().physicalDevice = physicalDevices[i];
+			vkstate().queueFamily = family;
+			found = true;
+			break;
+		}
+		core_free(queueFamilies);
 	}
+	core_free(physicalDevices);
+	if (!found) {
+		Log::error("No vulkan device with graphics and present support found");
+		return false;
+	}
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(vkstate().physicalDevice, &properties);
+	Log::info("Vulkan device: %s", properties.deviceName);
+	return true;
+}
 
-	uint32_t physicalDeviceCount;
-	vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, nullptr);
-	VkPhysicalDevice *physicalDevices = (VkPhysicalDevice *)core_malloc(sizeof(VkPhysicalDevice) * physicalDeviceCount);
-	vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, physicalDevices);
+bool init(int windowWidth, int windowHeight, float scaleFactor) {
+	if (vkstate().instance == VK_NULL_HANDLE) {
+		Log::error("No vulkan instance - createContext() must be called before init()");
+		return false;
+	}
+	resize(windowWidth, windowHeight, scaleFactor);
+	if (!selectPhysicalDevice()) {
+		return false;
+	}
 
 	VkDeviceQueueCreateInfo queueCreateInfo;
 	queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
 	queueCreateInfo.pNext = nullptr;
 	queueCreateInfo.flags = 0;
-	queueCreateInfo.queueFamilyIndex = 0;
+	queueCreateInfo.queueFamilyIndex = vkstate().queueFamily;
 	queueCreateInfo.queueCount = 1;
 	const float queuePriority = 1.0f;
 	queueCreateInfo.pQueuePriorities = &queuePriority;
 
+	const char *deviceExtensions[] = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 	VkDeviceCreateInfo deviceCreateInfo;
 	deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 	deviceCreateInfo.pNext = nullptr;
@@ -71,44 +102,38 @@ bool init(int windowWidth, int windowHeight, float scaleFactor) {
 	deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
 	deviceCreateInfo.enabledLayerCount = 0;
 	deviceCreateInfo.ppEnabledLayerNames = nullptr;
-	deviceCreateInfo.enabledExtensionCount = 0;
-	deviceCreateInfo.ppEnabledExtensionNames = nullptr;
+	deviceCreateInfo.enabledExtensionCount = lengthof(deviceExtensions);
+	deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions;
 	deviceCreateInfo.pEnabledFeatures = nullptr;
 
-	VkDevice device;
-	vkCreateDevice(physicalDevices[0], &deviceCreateInfo, nullptr, &device);
-
-	core_free(physicalDevices);
-
-	VkQueue queue;
-	vkGetDeviceQueue(device, 0, 0, &queue);
+	if (vkCreateDevice(vkstate().physicalDevice, &deviceCreateInfo, nullptr, &vkstate().device) != VK_SUCCESS) {
+		Log::error("Could not create the vulkan device");
+		return false;
+	}
+	vkGetDeviceQueue(vkstate().device, vkstate().queueFamily, 0, &vkstate().queue);
 
 	VkCommandPoolCreateInfo commandPoolCreateInfo;
 	commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 	commandPoolCreateInfo.pNext = nullptr;
 	commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-	commandPoolCreateInfo.queueFamilyIndex = 0;
-
-	VkCommandPool commandPool;
-	vkCreateCommandPool(device, &commandPoolCreateInfo, nullptr, &commandPool);
-
-	VkCommandBufferAllocateInfo allocateInfo;
-	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocateInfo.pNext = nullptr;
-	allocateInfo.commandPool = commandPool;
-	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocateInfo.commandBufferCount = 1;
-
-	VkCommandBuffer commandBuffer;
-	vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer);
-
-	VkSurfaceKHR surface;
-	SDL_Vulkan_CreateSurface(window, instance, &surface);
+	commandPoolCreateInfo.queueFamilyIndex = vkstate().queueFamily;
+	if (vkCreateCommandPool(vkstate().device, &commandPoolCreateInfo, nullptr, &vkstate().commandPool) !=
+		VK_SUCCESS) {
+		Log::error("Could not create the vulkan command pool");
+		return false;
+	}
 
-	if (useFeature(Feature::DirectStateAccess)) {
-		Log::debug("Use direct state access");
-	} else {
-		Log::debug("No direct state access");
+	// the pipelines for the recorded render states are created through this cache
+	VkPipelineCacheCreateInfo pipelineCacheCreateInfo;
+	pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	pipelineCacheCreateInfo.pNext = nullptr;
+	pipelineCacheCreateInfo.flags = 0;
+	pipelineCacheCreateInfo.initialDataSize = 0;
+	pipelineCacheCreateInfo.pInitialData = nullptr;
+	if (vkCreatePipelineCache(vkstate().device, &pipelineCacheCreateInfo, nullptr, &vkstate().pipelineCache) !=
+		VK_SUCCESS) {
+		Log::error("Could not create the vulkan pipeline cache");
+		return false;
 	}
 
 	const core::VarPtr &multisampleBuffers = core::Var::getSafe(cfg::ClientMultiSampleBuffers);
@@ -123,21 +148,79 @@ bool init(int windowWidth, int windowHeight, float scaleFactor) {
 }
 
 void resize(int windowWidth, int windowHeight, float scaleFactor) {
+	vkstate().windowWidth = windowWidth;
+	vkstate().windowHeight = windowHeight;
+	vkstate().scaleFactor = scaleFactor;
 }
 
 float getScaleFactor() {
-	return 1.0f;
+	return vkstate().scaleFactor;
 }
 
 glm::ivec2 getWindowSize() {
-	return glm::ivec2(-1);
+	return glm::ivec2(vkstate().windowWidth, vkstate().windowHeight);
 }
 
 void destroyContext(RendererContext &context) {
+	_priv::VkState &state = vkstate();
+	if (state.device != VK_NULL_HANDLE) {
+		vkDeviceWaitIdle(state.device);
+		if (state.pipelineCache != VK_NULL_HANDLE) {
+			vkDestroyPipelineCache(state.device, state.pipelineCache, nullptr);
+		}
+		if (state.commandPool != VK_NULL_HANDLE) {
+			vkDestroyCommandPool(state.device, state.commandPool, nullptr);
+		}
+		vkDestroyDevice(state.device, nullptr);
+	}
+	if (state.surface != VK_NULL_HANDLE) {
+		vkDestroySurfaceKHR(state.instance, state.surface, nullptr);
+	}
+	if (state.instance != VK_NULL_HANDLE) {
+		vkDestroyInstance(state.instance, nullptr);
+	}
+	state = _priv::VkState();
+	context = nullptr;
 }
 
 RendererContext createContext(SDL_Window *window) {
-	return nullptr;
+	if (flextVkInit() == -1) {
+		Log::error("Could not initialize vulkan: %s", SDL_GetError());
+		return nullptr;
+	}
+	vkstate().window = window;
+
+	unsigned int count = 0u;
+	if (!SDL_Vulkan_GetInstanceExtensions(window, &count, nullptr)) {
+		Log::error("Could not get the vulkan instance extensions: %s", SDL_GetError());
+		return nullptr;
+	}
+	const char **names = (const char **)core_malloc(sizeof(const char *) * count);
+	SDL_Vulkan_GetInstanceExtensions(window, &count, names);
+
+	VkInstanceCreateInfo createInfo;
+	createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	createInfo.pNext = nullptr;
+	createInfo.flags = 0;
+	createInfo.pApplicationInfo = nullptr;
+	createInfo.enabledLayerCount = 0;
+	createInfo.ppEnabledLayerNames = nullptr;
+	createInfo.enabledExtensionCount = count;
+	createInfo.ppEnabledExtensionNames = names;
+
+	const VkResult result = vkCreateInstance(&createInfo, nullptr, &vkstate().instance);
+	core_free(names);
+	if (result != VK_SUCCESS) {
+		Log::error("Could not create the vulkan instance");
+		return nullptr;
+	}
+	flextVkInitInstance(vkstate().instance);
+
+	if (!SDL_Vulkan_CreateSurface(window, vkstate().instance, &vkstate().surface)) {
+		Log::error("Could not create the vulkan surface: %s", SDL_GetError());
+		return nullptr;
+	}
+	return (RendererContext)vkstate().instance;
 }
 
 void activateContext(SDL_Window *window, RendererContext &context) {
@@ -165,60 +248,121 @@ bool pointSize(float size) {
 }
 
 float lineWidth(float width) {
-	return 1.0f;
+	const float oldWidth = vkstate().lineWidth;
+	vkstate().lineWidth = width;
+	return oldWidth;
+}
+
+float currentLineWidth() {
+	return vkstate().lineWidth;
 }
 
 bool clearColor(const glm::vec4 &clearColor) {
-	return false;
+	if (vkstate().clearColor == clearColor) {
+		return false;
+	}
+	vkstate().clearColor = clearColor;
+	return true;
 }
 
 const glm::vec4 &currentClearColor() {
-	static glm::vec4 todo;
-	return todo;
+	return vkstate().clearColor;
 }
 
 void clear(ClearFlag flag) {
 }
 
 bool viewport(int x, int y, int w, int h) {
-	return false;
+	_priv::VkState &state = vkstate();
+	if (state.viewportX == x && state.viewportY == y && state.viewportW == w && state.viewportH == h) {
+		return false;
+	}
+	state.viewportX = x;
+	state.viewportY = y;
+	state.viewportW = w;
+	state.viewportH = h;
+	return true;
 }
 
 void getScissor(int &x, int &y, int &w, int &h) {
+	x = vkstate().scissorX;
+	y = vkstate().scissorY;
+	w = vkstate().scissorW;
+	h = vkstate().scissorH;
 }
 
 void getViewport(int &x, int &y, int &w, int &h) {
+	x = vkstate().viewportX;
+	y = vkstate().viewportY;
+	w = vkstate().viewportW;
+	h = vkstate().viewportH;
 }
 
 bool scissor(int x, int y, int w, int h) {
-	return false;
+	if (w < 0) {
+		w = 0;
+	}
+	if (h < 0) {
+		h = 0;
+	}
+	_priv::VkState &state = vkstate();
+	if (state.scissorX == x && state.scissorY == y && state.scissorW == w && state.scissorH == h) {
+		return false;
+	}
+	state.scissorX = x;
+	state.scissorY = y;
+	state.scissorW = w;
+	state.scissorH = h;
+	return true;
 }
 
 bool enable(State state) {
+	const int stateIndex = core::enumVal(state);
+	if (vkstate().states[stateIndex]) {
+		return true;
+	}
+	vkstate().states.set(stateIndex, true);
 	return false;
 }
 
 bool currentState(State state) {
-	return false;
+	return vkstate().states[core::enumVal(state)];
 }
 
 bool disable(State state) {
-	return false;
+	const int stateIndex = core::enumVal(state);
+	if (!vkstate().states[stateIndex]) {
+		return false;
+	}
+	vkstate().states.set(stateIndex, false);
+	return true;
 }
 
 void colorMask(bool red, bool green, bool blue, bool alpha) {
 }
 
 bool cullFace(Face face) {
-	return false;
+	if (vkstate().cullFace == face) {
+		return false;
+	}
+	vkstate().cullFace = face;
+	return true;
+}
+
+Face currentCullFace() {
+	return vkstate().cullFace;
 }
 
 bool depthFunc(CompareFunc func) {
-	return false;
+	if (vkstate().depthFunc == func) {
+		return false;
+	}
+	vkstate().depthFunc = func;
+	return true;
 }
 
 CompareFunc getDepthFunc() {
-	return CompareFunc::Max;
+	return vkstate().depthFunc;
 }
 
 void getBlendState(bool &enabled, BlendMode &src, BlendMode &dest, BlendEquation &func) {
@@ -233,7 +377,9 @@ bool blendEquation(BlendEquation func) {
 }
 
 PolygonMode polygonMode(Face face, PolygonMode mode) {
-	return PolygonMode::Max;
+	const PolygonMode old = vkstate().polygonMode;
+	vkstate().polygonMode = mode;
+	return old;
 }
 
 bool polygonOffset(const glm::vec2 &offset) {
@@ -256,6 +402,10 @@ bool readTexture(TextureUnit unit, TextureType type, TextureFormat format, Id ha
 	return false;
 }
 
+bool readTextureToBuffer(TextureUnit unit, TextureType type, TextureFormat format, Id handle, Id buffer) {
+	return false;
+}
+
 bool useProgram(Id handle) {
 	return false;
 }
@@ -276,6 +426,13 @@ Id boundBuffer(BufferType type) {
 	return InvalidId;
 }
 
+void *mapBuffer(Id handle, BufferType type, AccessMode mode) {
+	return nullptr;
+}
+
+void unmapBuffer(Id handle, BufferType type) {
+}
+
 bool bindBuffer(BufferType type, Id handle) {
 	return false;
 }
@@ -284,6 +441,10 @@ bool unbindBuffer(BufferType type) {
 	return false;
 }
 
+bool bindBufferRange(BufferType type, Id handle, uint32_t index, intptr_t offset, size_t size) {
+	return false;
+}
+
 bool bindBufferBase(BufferType type, Id handle, uint32_t index) {
 	return false;
 }
@@ -294,6 +455,48 @@ void genBuffers(uint8_t amount, Id *ids) {
 void deleteBuffers(uint8_t amount, Id *ids) {
 }
 
+void genQueries(uint8_t amount, Id *ids) {
+}
+
+void deleteQueries(uint8_t amount, Id *ids) {
+}
+
+IdPtr genFenc() {
+	return InvalidIdPtr;
+}
+
+void deleteFence(IdPtr &id) {
+	id = InvalidIdPtr;
+}
+
+bool checkFence(IdPtr id, uint64_t timeout) {
+	return false;
+}
+
+bool beginQuery(QueryType type, Id id) {
+	return false;
+}
+
+bool endQuery(QueryType type) {
+	return false;
+}
+
+bool isQueryResultAvailable(Id id) {
+	return false;
+}
+
+uint32_t queryResult(Id id) {
+	return 0u;
+}
+
+bool queryTimestamp(Id id) {
+	return false;
+}
+
+uint64_t timestampResult(Id id) {
+	return 0u;
+}
+
 void genVertexArrays(uint8_t amount, Id *ids) {
 }
 
@@ -372,6 +575,10 @@ void bufferData(Id handle, BufferType type, BufferMode mode, const void *data, s
 void bufferSubData(Id handle, BufferType type, intptr_t offset, const void *data, size_t size) {
 }
 
+void *bufferStorage(Id handle, BufferType type, size_t size) {
+	return nullptr;
+}
+
 const glm::vec4 &framebufferUV() {
 	static glm::vec4 todo;
 	return todo;
@@ -391,9 +598,21 @@ void setupTexture(const TextureConfig &config) {
 void uploadTexture(video::TextureType type, video::TextureFormat format, int width, int height, const uint8_t *data, int index, int samples) {
 }
 
+void uploadTextureRegion(video::TextureType type, video::TextureFormat format, int x, int y, int z, int width, int height, int depth, const uint8_t *data) {
+}
+
+void generateMipmaps(video::TextureType type) {
+}
+
 void drawElements(Primitive mode, size_t numIndices, DataType type, void *offset) {
 }
 
+void drawElementsInstanced(Primitive mode, size_t numIndices, DataType type, int amount, void *offset) {
+}
+
+void multiDrawElementsIndirect(Primitive mode, DataType type, size_t offset, int drawCount) {
+}
+
 void drawArrays(Primitive mode, size_t count) {
 }
 
@@ -412,6 +631,19 @@ bool linkComputeShader(Id program, Id comp, const core::String &name) {
 	return false;
 }
 
+bool getProgramBinary(Id program, uint32_t &format, core::DynamicArray<uint8_t> &binary) {
+	return false;
+}
+
+bool programBinary(Id program, uint32_t format, const uint8_t *binary, size_t size, const core::String &name) {
+	return false;
+}
+
+const core::String &driverIdentifier() {
+	static core::String todo;
+	return todo;
+}
+
 bool bindImage(Id handle, AccessMode mode, ImageFormat format) {
 	return false;
 }
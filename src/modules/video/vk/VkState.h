@@ -0,0 +1,57 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/BitSet.h"
+#include "flextVk.h"
+#include "video/Types.h"
+#include <glm/vec4.hpp>
+
+struct SDL_Window;
+
+namespace video {
+
+namespace _priv {
+
+/**
+ * The vulkan objects of the renderer and the recorded render states.
+ *
+ * Vulkan bakes most of the render states into the pipelines - the states are recorded here to select the pipeline
+ * for the next draw call from the pipeline cache.
+ */
+struct VkState {
+	SDL_Window *window = nullptr;
+	VkInstance instance = VK_NULL_HANDLE;
+	VkSurfaceKHR surface = VK_NULL_HANDLE;
+	VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+	VkDevice device = VK_NULL_HANDLE;
+	// the queue family that supports graphics and the presentation to the surface
+	uint32_t queueFamily = 0u;
+	VkQueue queue = VK_NULL_HANDLE;
+	VkCommandPool commandPool = VK_NULL_HANDLE;
+	VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+
+	glm::vec4 clearColor {0.0f};
+	Face cullFace = Face::Back;
+	CompareFunc depthFunc = CompareFunc::Less;
+	PolygonMode polygonMode = PolygonMode::Solid;
+	float lineWidth = 1.0f;
+	float scaleFactor = 1.0f;
+	int windowWidth = 0;
+	int windowHeight = 0;
+	int viewportX = 0;
+	int viewportY = 0;
+	int viewportW = 0;
+	int viewportH = 0;
+	int scissorX = 0;
+	int scissorY = 0;
+	int scissorW = 0;
+	int scissorH = 0;
+	core::BitSet states{core::enumVal(State::Max)};
+};
+
+}
+
+}
@@ -54,6 +54,11 @@ struct ChunkMesh {
 			mesh[i].optimize();
 		}
 	}
+	void simplify(float targetError) {
+		for (int i = 0; i < Meshes; ++i) {
+			mesh[i].simplify(targetError);
+		}
+	}
 };
 
 } // namespace voxel
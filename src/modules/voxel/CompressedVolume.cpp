@@ -0,0 +1,68 @@
+/**
+ * @file
+ */
+
+#include "CompressedVolume.h"
+#include "RawVolume.h"
+#include "core/Assert.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+
+namespace voxel {
+
+static inline bool isSameRun(const Voxel &a, const Voxel &b) {
+	return core_memcmp((const void *)&a, (const void *)&b, sizeof(Voxel)) == 0;
+}
+
+CompressedVolume::CompressedVolume(const RawVolume &volume)
+	: LazyVolume(volume.region()), _borderVoxel(volume.borderValue()) {
+	core_trace_scoped(CompressVolume);
+	const Voxel *data = (const Voxel *)volume.data();
+	const size_t n = (size_t)_region.voxels();
+	if (n == 0u) {
+		return;
+	}
+	// count the runs first to not waste memory by the growing strategy of the array
+	size_t runs = 1u;
+	uint32_t length = 1u;
+	for (size_t i = 1u; i < n; ++i) {
+		if (length < UINT32_MAX && isSameRun(data[i - 1], data[i])) {
+			++length;
+			continue;
+		}
+		++runs;
+		length = 1u;
+	}
+	_runs.reserve(runs);
+
+	Run run{data[0], 1u};
+	for (size_t i = 1u; i < n; ++i) {
+		if (run.length < UINT32_MAX && isSameRun(run.voxel, data[i])) {
+			++run.length;
+			continue;
+		}
+		_runs.push_back(run);
+		run.voxel = data[i];
+		run.length = 1u;
+	}
+	_runs.push_back(run);
+}
+
+RawVolume *CompressedVolume::inflate() const {
+	core_trace_scoped(InflateVolume);
+	const size_t size = RawVolume::size(_region);
+	Voxel *data = (Voxel *)core_malloc(size);
+	core_assert_msg_always(data != nullptr, "Failed to allocate the memory for an inflated volume");
+	Voxel *cursor = data;
+	for (const Run &run : _runs) {
+		for (uint32_t i = 0u; i < run.length; ++i) {
+			*cursor++ = run.voxel;
+		}
+	}
+	core_assert(cursor == data + _region.voxels());
+	RawVolume *volume = RawVolume::createRaw(data, _region);
+	volume->setBorderValue(_borderVoxel);
+	return volume;
+}
+
+} // namespace voxel
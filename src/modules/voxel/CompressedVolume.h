@@ -0,0 +1,61 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "LazyVolume.h"
+#include "Voxel.h"
+#include "core/collection/DynamicArray.h"
+
+namespace voxel {
+
+class RawVolume;
+
+/**
+ * @brief Run-length encoded, read-only copy of a @c RawVolume.
+ *
+ * Each run stores the full voxel (material, palette color index, normal and flags) and the amount of consecutive
+ * voxels in the linear memory layout of the @c RawVolume. Large air areas and solid areas of one color collapse
+ * into a few bytes - this is used to keep inactive volumes in memory without paying for the fully expanded data.
+ *
+ * @sa RawVolume
+ */
+class CompressedVolume : public LazyVolume {
+private:
+	struct Run {
+		Voxel voxel;
+		uint32_t length;
+	};
+	core::DynamicArray<Run> _runs;
+	Voxel _borderVoxel;
+
+public:
+	CompressedVolume(const RawVolume &volume);
+
+	/**
+	 * @brief Create a new RawVolume instance with the uncompressed voxel data
+	 * @note It's the callers responsibility to properly release the memory.
+	 */
+	[[nodiscard]] RawVolume *inflate() const;
+
+	[[nodiscard]] RawVolume *load() const override {
+		return inflate();
+	}
+
+	/**
+	 * @return The amount of runs that are needed to describe the volume
+	 */
+	inline size_t runs() const {
+		return _runs.size();
+	}
+
+	/**
+	 * @return The amount of bytes that are needed to store the compressed data
+	 */
+	inline size_t size() const override {
+		return _runs.size() * sizeof(Run);
+	}
+};
+
+} // namespace voxel
@@ -0,0 +1,50 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Region.h"
+#include "core/NonCopyable.h"
+#include <stddef.h>
+
+namespace voxel {
+
+class RawVolume;
+
+/**
+ * @brief A volume that is not resident in memory - the voxels are only created by @c load()
+ *
+ * The scene graph nodes use this to keep the volumes of inactive nodes compressed, or to defer the decoding of the
+ * voxels of a loaded file until a volume is accessed for the first time.
+ *
+ * @sa CompressedVolume
+ */
+class LazyVolume : public core::NonCopyable {
+protected:
+	Region _region;
+
+public:
+	LazyVolume(const Region &region) : _region(region) {
+	}
+	virtual ~LazyVolume() = default;
+
+	inline const Region &region() const {
+		return _region;
+	}
+
+	/**
+	 * @brief Create a new RawVolume instance with the voxel data
+	 * @note It's the callers responsibility to properly release the memory.
+	 * @note Must be thread safe - this might be called from any thread
+	 * @return @c nullptr if the voxels could not be loaded
+	 */
+	[[nodiscard]] virtual RawVolume *load() const = 0;
+
+	/**
+	 * @return The amount of bytes that are held in memory until the volume is loaded
+	 */
+	virtual size_t size() const = 0;
+};
+
+} // namespace voxel
@@ -150,6 +150,7 @@ void Mesh::setOffset(const glm::ivec3 &offset) {
 void Mesh::clear() {
 	_vecVertices.clear();
 	_vecIndices.clear();
+	_normals.clear();
 	_offset = glm::ivec3(0);
 }
 
@@ -505,15 +506,42 @@ void Mesh::optimize() {
 		return;
 	}
 	core_trace_scoped(MeshOptimize);
-	meshopt_optimizeVertexCache(_vecIndices.data(), _vecIndices.data(), _vecIndices.size(), _vecVertices.size());
-	meshopt_optimizeOverdraw(_vecIndices.data(), _vecIndices.data(), _vecIndices.size(), &_vecVertices.data()->position.x, _vecVertices.size(), sizeof(VoxelVertex), 1.05f);
-	meshopt_optimizeVertexFetch(_vecVertices.data(), _vecIndices.data(), _vecIndices.size(), _vecVertices.data(), _vecVertices.size(), sizeof(VoxelVertex));
+	const size_t indices = _vecIndices.size();
+	const size_t vertices = _vecVertices.size();
+	meshopt_optimizeVertexCache(_vecIndices.data(), _vecIndices.data(), indices, vertices);
+	meshopt_optimizeOverdraw(_vecIndices.data(), _vecIndices.data(), indices, &_vecVertices.data()->position.x,
+							 vertices, sizeof(VoxelVertex), 1.05f);
+	// the normals are a second vertex stream that must be reordered in the same way as the vertices
+	IndexArray remap(vertices);
+	const size_t usedVertices = meshopt_optimizeVertexFetchRemap(remap.data(), _vecIndices.data(), indices, vertices);
+	meshopt_remapVertexBuffer(_vecVertices.data(), _vecVertices.data(), vertices, sizeof(VoxelVertex), remap.data());
+	_vecVertices.resize(usedVertices);
+	if (!_normals.empty()) {
+		meshopt_remapVertexBuffer(_normals.data(), _normals.data(), vertices, sizeof(glm::vec3), remap.data());
+		_normals.resize(usedVertices);
+	}
+	meshopt_remapIndexBuffer(_vecIndices.data(), _vecIndices.data(), indices, remap.data());
+}
+
+bool Mesh::simplify(float targetError) {
+	if (isEmpty() || targetError <= 0.0f) {
+		return false;
+	}
+	core_trace_scoped(MeshSimplify);
 	const IndexArray oldIndices(_vecIndices);
+	float resultError = 0.0f;
+	// no target index count - only the error bounds the simplification
 	const size_t newSize =
 		meshopt_simplify(_vecIndices.data(), oldIndices.data(), oldIndices.size(), &_vecVertices.data()->position.x,
-						 _vecVertices.size(), sizeof(VoxelVertex), oldIndices.size() / 2, 0.1f, 0, nullptr);
-	Log::debug("newSize: %i, oldsize: %i", (int)newSize, (int)oldIndices.size());
+						 _vecVertices.size(), sizeof(VoxelVertex), 0, targetError, 0, &resultError);
+	Log::debug("Simplified mesh from %i to %i indices (error: %f)", (int)oldIndices.size(), (int)newSize,
+			   resultError);
+	if (newSize == oldIndices.size()) {
+		return false;
+	}
 	_vecIndices.resize(newSize);
+	removeUnusedVertices();
+	return true;
 }
 
 } // namespace voxel
@@ -5,13 +5,15 @@
 #pragma once
 
 #include "VoxelVertex.h"
+#include "core/MemoryTracker.h"
 #include "core/collection/DynamicArray.h"
 
 namespace voxel {
 
-using VertexArray = core::DynamicArray<voxel::VoxelVertex, 1024>;
-using IndexArray = core::DynamicArray<voxel::IndexType, 1024>;
-using NormalArray = core::DynamicArray<glm::vec3, 1024>;
+using MeshAllocator = core::TrackedAllocator<core::MemoryTag::Mesh>;
+using VertexArray = core::DynamicArray<voxel::VoxelVertex, 1024, MeshAllocator>;
+using IndexArray = core::DynamicArray<voxel::IndexType, 1024, MeshAllocator>;
+using NormalArray = core::DynamicArray<glm::vec3, 1024, MeshAllocator>;
 
 /**
  * @brief A simple and general-purpose mesh class to represent the data returned by the surface extraction functions.
@@ -53,7 +55,18 @@ public:
 	void addTriangle(IndexType index0, IndexType index1, IndexType index2);
 	void setNormal(IndexType index, const glm::vec3 &normal);
 
+	/**
+	 * @brief Reorders the triangles for the post transform vertex cache and less overdraw and the vertices in the
+	 * order of their first use. This doesn't change the look of the mesh.
+	 */
 	void optimize();
+	/**
+	 * @brief Removes triangles as long as the deviation from the original surface stays below the given error
+	 * @param targetError The error relative to the extents of the mesh (e.g. 0.01 for 1%)
+	 * @note This is lossy and should only be used for smooth (non cubic) meshes
+	 * @return @c true if triangles were removed
+	 */
+	bool simplify(float targetError);
 
 	void clear();
 	bool isEmpty() const;
@@ -0,0 +1,366 @@
+/**
+ * @file
+ */
+
+#include "MeshCache.h"
+#include "core/Algorithm.h"
+#include "core/FourCC.h"
+#include "core/Hash.h"
+#include "core/Log.h"
+#include "core/ScopedPtr.h"
+#include "core/StringUtil.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/LZ4ReadStream.h"
+#include "io/LZ4WriteStream.h"
+#include "palette/Palette.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/Mesh.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+
+namespace voxel {
+
+static constexpr uint32_t MeshCacheMagic = FourCC('V', 'M', 'C', 'H');
+// increase this if the extractors produce different meshes for the same voxels or the entry layout changes
+// version 2: lz4 instead of zlib compression
+// version 3: the voxels are hashed with RawVolume::hash()
+// version 4: the whole key is stored to detect hash collisions
+static constexpr uint32_t MeshCacheVersion = 4u;
+static constexpr uint64_t FNVPrime = 1099511628211UL;
+
+static inline uint64_t hashValue(uint64_t hash, uint64_t value) {
+	return (hash ^ value) * FNVPrime;
+}
+
+bool MeshCacheKey::operator==(const MeshCacheKey &other) const {
+	return hash == other.hash && voxelHash == other.voxelHash && paletteHash == other.paletteHash &&
+		   hashRegion == other.hashRegion && extractRegion == other.extractRegion && type == other.type &&
+		   brickSize == other.brickSize && lods == other.lods && ambientOcclusion == other.ambientOcclusion;
+}
+
+MeshCache::MeshCache(const io::ArchivePtr &archive, const core::String &prefix, uint64_t maxSize)
+	: _archive(archive), _prefix(prefix), _maxSize(maxSize) {
+}
+
+core::String MeshCache::entryName(uint64_t key) const {
+	return core::string::format("%s%08x%08x.mesh", _prefix.c_str(), (uint32_t)(key >> 32u), (uint32_t)key);
+}
+
+MeshCacheKey MeshCache::key(const RawVolume &volume, const Region &hashRegion, const Region &extractRegion,
+							const palette::Palette &palette, SurfaceExtractionType type, int brickSize, bool lods,
+							bool ambientOcclusion) {
+	core_trace_scoped(MeshCacheKey);
+	MeshCacheKey key;
+	key.voxelHash = volume.hash(hashRegion);
+	key.paletteHash = palette.hash();
+	key.hashRegion = hashRegion;
+	key.extractRegion = extractRegion;
+	key.type = (uint32_t)type;
+	key.brickSize = brickSize;
+	key.lods = lods;
+	key.ambientOcclusion = ambientOcclusion;
+
+	uint64_t hash = core::hash("meshcache");
+	hash = hashValue(hash, MeshCacheVersion);
+	hash = hashValue(hash, key.type);
+	hash = hashValue(hash, (uint64_t)brickSize);
+	hash = hashValue(hash, lods ? 1u : 0u);
+	hash = hashValue(hash, ambientOcclusion ? 1u : 0u);
+	hash = hashValue(hash, key.paletteHash);
+	for (const Region &region : {hashRegion, extractRegion}) {
+		const glm::ivec3 &lower = region.getLowerCorner();
+		const glm::ivec3 &upper = region.getUpperCorner();
+		for (int i = 0; i < 3; ++i) {
+			hash = hashValue(hash, (uint32_t)lower[i]);
+			hash = hashValue(hash, (uint32_t)upper[i]);
+		}
+	}
+	// the position of the voxels is already part of the hash
+	key.hash = hashValue(hash, key.voxelHash);
+	return key;
+}
+
+void MeshCache::index() {
+	if (_indexed) {
+		return;
+	}
+	_indexed = true;
+	io::ArchiveFiles files;
+	_archive->list(_prefix, files, "*.mesh");
+	// the oldest entries are the first candidates for the eviction
+	core::sort(files.begin(), files.end(),
+			   [](const io::FilesystemEntry &a, const io::FilesystemEntry &b) { return a.mtime < b.mtime; });
+	for (const io::FilesystemEntry &file : files) {
+		if (file.isFile()) {
+			touch(_prefix + file.name, file.size);
+		}
+	}
+	Log::debug("Found %i mesh cache entries with %i kb", (int)_entries.size(), (int)(_totalSize / 1024u));
+}
+
+void MeshCache::touch(const core::String &name, uint64_t size) {
+	Entry entry;
+	auto iter = _entries.find(name);
+	if (iter != _entries.end()) {
+		entry = iter->value;
+		_totalSize -= entry.size;
+	}
+	// overwritten entries are not truncated - they keep their old size if the new data is smaller
+	entry.size = core_max(entry.size, size);
+	entry.lastAccess = ++_accessCounter;
+	_totalSize += entry.size;
+	_entries.put(name, entry);
+}
+
+void MeshCache::remove(const core::String &name) {
+	auto iter = _entries.find(name);
+	if (iter != _entries.end()) {
+		_totalSize -= iter->value.size;
+		_entries.erase(iter);
+	}
+	if (!_archive->remove(name)) {
+		Log::debug("Failed to remove the mesh cache entry %s", name.c_str());
+	}
+}
+
+void MeshCache::evict() {
+	if (_totalSize <= _maxSize) {
+		return;
+	}
+	core_trace_scoped(MeshCacheEvict);
+	core::DynamicArray<core::String> names;
+	names.reserve(_entries.size());
+	for (auto iter = _entries.begin(); iter != _entries.end(); ++iter) {
+		names.push_back(iter->key);
+	}
+	core::sort(names.begin(), names.end(), [this](const core::String &a, const core::String &b) {
+		return _entries.find(a)->value.lastAccess < _entries.find(b)->value.lastAccess;
+	});
+	// free a bit more than needed to not evict again with the next stored entry
+	const uint64_t targetSize = _maxSize / 4u * 3u;
+	for (const core::String &name : names) {
+		if (_totalSize <= targetSize) {
+			break;
+		}
+		remove(name);
+	}
+	Log::debug("Evicted mesh cache entries - %i entries with %i kb left", (int)_entries.size(),
+			   (int)(_totalSize / 1024u));
+}
+
+uint64_t MeshCache::size() {
+	core::ScopedLock scoped(_lock);
+	index();
+	return _totalSize;
+}
+
+static bool readKey(io::ReadStream &stream, MeshCacheKey &key) {
+	uint32_t flags = 0u;
+	if (stream.readUInt64(key.hash) != 0 || stream.readUInt64(key.voxelHash) != 0 ||
+		stream.readUInt64(key.paletteHash) != 0 || stream.readUInt32(key.type) != 0 ||
+		stream.readInt32(key.brickSize) != 0 || stream.readUInt32(flags) != 0) {
+		return false;
+	}
+	key.lods = (flags & 1u) != 0u;
+	key.ambientOcclusion = (flags & 2u) != 0u;
+	for (Region *region : {&key.hashRegion, &key.extractRegion}) {
+		glm::ivec3 lower;
+		glm::ivec3 upper;
+		for (int i = 0; i < 3; ++i) {
+			if (stream.readInt32(lower[i]) != 0 || stream.readInt32(upper[i]) != 0) {
+				return false;
+			}
+		}
+		*region = Region(lower, upper);
+	}
+	return true;
+}
+
+static bool writeKey(io::WriteStream &stream, const MeshCacheKey &key) {
+	const uint32_t flags = (key.lods ? 1u : 0u) | (key.ambientOcclusion ? 2u : 0u);
+	if (!stream.writeUInt64(key.hash) || !stream.writeUInt64(key.voxelHash) || !stream.writeUInt64(key.paletteHash) ||
+		!stream.writeUInt32(key.type) || !stream.writeInt32(key.brickSize) || !stream.writeUInt32(flags)) {
+		return false;
+	}
+	for (const Region *region : {&key.hashRegion, &key.extractRegion}) {
+		const glm::ivec3 &lower = region->getLowerCorner();
+		const glm::ivec3 &upper = region->getUpperCorner();
+		for (int i = 0; i < 3; ++i) {
+			if (!stream.writeInt32(lower[i]) || !stream.writeInt32(upper[i])) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool readFully(io::ReadStream &stream, void *data, size_t size) {
+	uint8_t *target = (uint8_t *)data;
+	while (size > 0) {
+		const int read = stream.read(target, size);
+		if (read <= 0) {
+			return false;
+		}
+		target += read;
+		size -= read;
+	}
+	return true;
+}
+
+static bool readMesh(io::ReadStream &stream, Mesh &mesh) {
+	glm::ivec3 offset;
+	uint32_t vertices = 0u;
+	uint32_t indices = 0u;
+	uint32_t normals = 0u;
+	if (stream.readInt32(offset.x) != 0 || stream.readInt32(offset.y) != 0 || stream.readInt32(offset.z) != 0 ||
+		stream.readUInt32(vertices) != 0 || stream.readUInt32(indices) != 0 || stream.readUInt32(normals) != 0) {
+		return false;
+	}
+	if (normals != 0u && normals != vertices) {
+		return false;
+	}
+	mesh.clear();
+	mesh.setOffset(offset);
+	VertexArray &vertexArray = mesh.getVertexVector();
+	vertexArray.resize(vertices);
+	IndexArray &indexArray = mesh.getIndexVector();
+	indexArray.resize(indices);
+	NormalArray &normalArray = mesh.getNormalVector();
+	normalArray.resize(normals);
+	if (!readFully(stream, vertexArray.data(), vertices * sizeof(VoxelVertex)) ||
+		!readFully(stream, indexArray.data(), indices * sizeof(IndexType)) ||
+		!readFully(stream, normalArray.data(), normals * sizeof(glm::vec3))) {
+		return false;
+	}
+	for (IndexType index : indexArray) {
+		if (index >= vertices) {
+			return false;
+		}
+	}
+	mesh.compressIndices();
+	return true;
+}
+
+// the stream is compressing - the return values of write() are not the amount of given bytes
+static bool writeMesh(io::WriteStream &stream, const Mesh &mesh) {
+	const glm::ivec3 &offset = mesh.getOffset();
+	const VertexArray &vertexArray = mesh.getVertexVector();
+	const IndexArray &indexArray = mesh.getIndexVector();
+	const NormalArray &normalArray = mesh.getNormalVector();
+	if (!stream.writeInt32(offset.x) || !stream.writeInt32(offset.y) || !stream.writeInt32(offset.z) ||
+		!stream.writeUInt32((uint32_t)vertexArray.size()) || !stream.writeUInt32((uint32_t)indexArray.size()) ||
+		!stream.writeUInt32((uint32_t)normalArray.size())) {
+		return false;
+	}
+	const size_t vertexBytes = vertexArray.size() * sizeof(VoxelVertex);
+	const size_t indexBytes = indexArray.size() * sizeof(IndexType);
+	const size_t normalBytes = normalArray.size() * sizeof(glm::vec3);
+	if (vertexBytes > 0 && stream.write(vertexArray.data(), vertexBytes) < 0) {
+		return false;
+	}
+	if (indexBytes > 0 && stream.write(indexArray.data(), indexBytes) < 0) {
+		return false;
+	}
+	if (normalBytes > 0 && stream.write(normalArray.data(), normalBytes) < 0) {
+		return false;
+	}
+	return true;
+}
+
+bool MeshCache::load(const MeshCacheKey &key, ChunkMesh &mesh, core::DynamicArray<Mesh> &lods) {
+	core_trace_scoped(MeshCacheLoad);
+	const core::String &name = entryName(key.hash);
+	core::ScopedPtr<io::BufferedReadWriteStream> buffer;
+	{
+		core::ScopedLock scoped(_lock);
+		index();
+		if (!_entries.hasKey(name) && !_archive->exists(name)) {
+			return false;
+		}
+		core::ScopedPtr<io::SeekableReadStream> stream(_archive->readStream(name));
+		if (!stream) {
+			return false;
+		}
+		buffer = new io::BufferedReadWriteStream(*stream, stream->size());
+		touch(name, buffer->size());
+	}
+	buffer->seek(0);
+	uint32_t magic = 0u;
+	uint32_t version = 0u;
+	MeshCacheKey storedKey;
+	uint32_t lodCount = 0u;
+	uint32_t compressedSize = 0u;
+	if (buffer->readUInt32(magic) != 0 || buffer->readUInt32(version) != 0 || !readKey(*buffer, storedKey) ||
+		buffer->readUInt32(lodCount) != 0 || buffer->readUInt32(compressedSize) != 0) {
+		return false;
+	}
+	if (magic != MeshCacheMagic || version != MeshCacheVersion || (int64_t)compressedSize > buffer->remaining()) {
+		Log::debug("Remove outdated mesh cache entry %s", name.c_str());
+		core::ScopedLock scoped(_lock);
+		remove(name);
+		return false;
+	}
+	if (storedKey != key) {
+		// hash collision - the entry belongs to other voxels or settings
+		Log::debug("Mesh cache entry %s doesn't match the key", name.c_str());
+		return false;
+	}
+	io::LZ4ReadStream lz4Stream(*buffer, (int)compressedSize);
+	bool success = true;
+	for (int i = 0; i < ChunkMesh::Meshes && success; ++i) {
+		success = readMesh(lz4Stream, mesh.mesh[i]);
+	}
+	lods.resize(lodCount);
+	for (uint32_t i = 0u; i < lodCount && success; ++i) {
+		success = readMesh(lz4Stream, lods[i]);
+	}
+	if (!success) {
+		Log::warn("Failed to read the mesh cache entry %s", name.c_str());
+		mesh.clear();
+		lods.clear();
+		return false;
+	}
+	return true;
+}
+
+bool MeshCache::store(const MeshCacheKey &key, const ChunkMesh &mesh, const core::DynamicArray<Mesh> &lods) {
+	core_trace_scoped(MeshCacheStore);
+	const core::String &name = entryName(key.hash);
+	io::BufferedReadWriteStream buffer(64 * 1024);
+	{
+		io::LZ4WriteStream lz4Stream(buffer);
+		bool success = true;
+		for (int i = 0; i < ChunkMesh::Meshes && success; ++i) {
+			success = writeMesh(lz4Stream, mesh.mesh[i]);
+		}
+		for (size_t i = 0; i < lods.size() && success; ++i) {
+			success = writeMesh(lz4Stream, lods[i]);
+		}
+		if (!success || !lz4Stream.flush()) {
+			Log::error("Failed to compress the mesh cache entry %s", name.c_str());
+			return false;
+		}
+	}
+	const uint32_t compressedSize = (uint32_t)buffer.size();
+	core::ScopedLock scoped(_lock);
+	index();
+	{
+		core::ScopedPtr<io::SeekableWriteStream> stream(_archive->writeStream(name));
+		if (!stream) {
+			return false;
+		}
+		// entries might get overwritten - the size of the compressed data marks the end of the entry
+		stream->seek(0);
+		if (!stream->writeUInt32(MeshCacheMagic) || !stream->writeUInt32(MeshCacheVersion) || !writeKey(*stream, key) ||
+			!stream->writeUInt32((uint32_t)lods.size()) || !stream->writeUInt32(compressedSize) ||
+			stream->write(buffer.getBuffer(), compressedSize) != (int)compressedSize) {
+			Log::error("Failed to write the mesh cache entry %s", name.c_str());
+			return false;
+		}
+		touch(name, stream->pos());
+	}
+	evict();
+	return true;
+}
+
+} // namespace voxel
@@ -0,0 +1,117 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/StringMap.h"
+#include "core/concurrent/Lock.h"
+#include "io/Archive.h"
+#include "voxel/Region.h"
+#include "voxel/SurfaceExtractor.h"
+#include <stdint.h>
+
+namespace palette {
+class Palette;
+}
+
+namespace voxel {
+
+class Mesh;
+class RawVolume;
+struct ChunkMesh;
+
+/**
+ * @brief Identifies a cache entry - the @c hash is used for the entry name, the other members are stored in the entry
+ * and compared on load to detect hash collisions
+ */
+struct MeshCacheKey {
+	uint64_t hash = 0u;
+	uint64_t voxelHash = 0u;
+	uint64_t paletteHash = 0u;
+	Region hashRegion;
+	Region extractRegion;
+	uint32_t type = 0u;
+	int32_t brickSize = 0;
+	bool lods = false;
+	bool ambientOcclusion = true;
+
+	bool operator==(const MeshCacheKey &other) const;
+	inline bool operator!=(const MeshCacheKey &other) const {
+		return !(*this == other);
+	}
+};
+
+/**
+ * @brief Stores the extracted meshes of the chunks as lz4 compressed entries in an archive
+ *
+ * The entries are keyed by a hash of the voxels the meshes were extracted from, the palette and the extraction
+ * settings - loading a scene again doesn't need to extract the unmodified chunks again. If the entries get bigger
+ * than the given maximum size, the least recently used entries are deleted.
+ *
+ * @note The entries store the in-memory representation of the vertices - this is a cache, not a file format.
+ * @note The archive access is serialized - the entries can be loaded and stored from the extraction threads.
+ * @sa MeshState::setMeshCache()
+ */
+class MeshCache {
+private:
+	struct Entry {
+		uint64_t size = 0u;
+		uint64_t lastAccess = 0u;
+	};
+	io::ArchivePtr _archive;
+	core::String _prefix;
+	const uint64_t _maxSize;
+	core_trace_mutex(core::Lock, _lock, "MeshCache");
+	core::StringMap<Entry> _entries;
+	uint64_t _totalSize = 0u;
+	uint64_t _accessCounter = 0u;
+	bool _indexed = false;
+
+	core::String entryName(uint64_t key) const;
+	// collects the entries that are already in the archive - must be called with the lock held
+	void index();
+	// must be called with the lock held
+	void touch(const core::String &name, uint64_t size);
+	// must be called with the lock held
+	void remove(const core::String &name);
+	// deletes the least recently used entries until the cache is below the maximum size again - must be called with
+	// the lock held
+	void evict();
+
+public:
+	static constexpr uint64_t DefaultMaxSize = 512u * 1024u * 1024u;
+
+	/**
+	 * @param maxSize The maximum size of all entries in bytes
+	 */
+	MeshCache(const io::ArchivePtr &archive, const core::String &prefix = "meshcache/",
+			  uint64_t maxSize = DefaultMaxSize);
+
+	/**
+	 * @param hashRegion The region of the voxels that are read by the extraction - including the neighbours
+	 * @param extractRegion The region the meshes are extracted for
+	 * @param brickSize See @c SurfaceExtractionContext::brickSize
+	 * @param lods @c true if the levels of detail are stored with the meshes
+	 * @param ambientOcclusion See @c SurfaceExtractionContext::ambientOcclusion
+	 */
+	static MeshCacheKey key(const RawVolume &volume, const Region &hashRegion, const Region &extractRegion,
+							const palette::Palette &palette, SurfaceExtractionType type, int brickSize, bool lods,
+							bool ambientOcclusion = true);
+
+	/**
+	 * @return @c false if there is no valid entry for the key - the meshes are empty then
+	 */
+	bool load(const MeshCacheKey &key, ChunkMesh &mesh, core::DynamicArray<Mesh> &lods);
+	bool store(const MeshCacheKey &key, const ChunkMesh &mesh, const core::DynamicArray<Mesh> &lods);
+
+	/**
+	 * @return The size of all entries in bytes
+	 */
+	uint64_t size();
+};
+
+} // namespace voxel
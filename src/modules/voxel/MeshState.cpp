@@ -4,18 +4,37 @@
 
 #include "MeshState.h"
 #include "app/App.h"
+#include "core/Algorithm.h"
+#include "core/ConfigVar.h"
 #include "core/Log.h"
+#include "core/PerfStats.h"
+#include "core/ScopedPtr.h"
+#include "core/TimeProvider.h"
+#include "io/FilesystemArchive.h"
 #include "palette/NormalPalette.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Mesh.h"
 #include "voxel/SurfaceExtractor.h"
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
 
 namespace voxel {
 
 bool MeshState::init() {
 	_meshMode = core::Var::getSafe(cfg::VoxelMeshMode);
 	_meshMode->markClean();
+	_extractingLODs = extractLODs();
+	_extractionStats = ExtractionStats();
 
+	const int threads = _meshThreads->intVal();
+	if (threads > 0) {
+		_threadPool.setThreads(threads);
+	}
+	// the mesh workers start after the ones of the application pool to not share the cores
+	const int firstCore = core::Var::getSafe(cfg::CoreThreadAffinity)->intVal();
+	if (firstCore >= 0) {
+		_threadPool.setAffinity(firstCore + (int)app::App::getInstance()->threadPool().size());
+	}
 	_threadPool.init();
 	Log::debug("Threadpool size: %i", (int)_threadPool.size());
 	return true;
@@ -23,6 +42,13 @@ bool MeshState::init() {
 
 void MeshState::construct() {
 	_meshSize = core::Var::get(cfg::VoxelMeshSize, "64", core::CV_READONLY);
+	_meshLOD = core::Var::get(cfg::VoxelMeshLOD, "false");
+	_meshCacheVar = core::Var::get(cfg::VoxelMeshCache, "false");
+	_meshCacheSize = core::Var::get(cfg::VoxelMeshCacheSize, "512", "The maximum size of the mesh cache in megabytes",
+									core::Var::minMaxValidator<1, 65536>);
+	_meshThreads = core::Var::get(cfg::VoxelMeshThreads, "0", "The amount of mesh extraction threads - 0 uses half of the cores",
+								  core::Var::minMaxValidator<0, 1024>);
+	_aoVolume = core::Var::get(cfg::VoxelAOVolume, "false");
 }
 
 glm::vec3 MeshState::VolumeData::centerPos() const {
@@ -38,37 +64,63 @@ glm::vec3 MeshState::VolumeData::centerPos(int x, int y, int z) const {
 	return pos;
 }
 
+MeshState::~MeshState() {
+	freeVolumeData();
+}
+
+MeshState::VolumeData &MeshState::createVolumeData(int idx) {
+	core_assert(idx >= 0);
+	if (idx >= (int)_volumeData.size()) {
+		_volumeData.resize(idx + 1);
+	}
+	if (_volumeData[idx] == nullptr) {
+		_volumeData[idx] = new VolumeData();
+	}
+	return *_volumeData[idx];
+}
+
+void MeshState::freeVolumeData() {
+	clear();
+	for (VolumeData *state : _volumeData) {
+		delete state;
+	}
+	_volumeData.release();
+}
+
 const glm::vec3 &MeshState::mins(int idx) const {
-	return _volumeData[idx]._mins;
+	return volumeData(idx)._mins;
 }
 
 const glm::vec3 &MeshState::maxs(int idx) const {
-	return _volumeData[idx]._maxs;
+	return volumeData(idx)._maxs;
 }
 
 glm::vec3 MeshState::centerPos(int idx) const {
-	return _volumeData[idx].centerPos();
+	return volumeData(idx).centerPos();
 }
 
 glm::vec3 MeshState::centerPos(int idx, int x, int y, int z) const {
-	return _volumeData[idx].centerPos(x, y, z);
+	return volumeData(idx).centerPos(x, y, z);
 }
 
 const glm::mat4 &MeshState::model(int idx) const {
-	return _volumeData[idx]._model;
+	return volumeData(idx)._model;
 }
 
 const glm::vec3 &MeshState::pivot(int idx) const {
-	return _volumeData[idx]._pivot;
+	return volumeData(idx)._pivot;
 }
 
 void MeshState::setModel(int idx, const glm::mat4 &model) {
-	_volumeData[idx]._model = model;
+	if (idx < 0) {
+		return;
+	}
+	createVolumeData(idx)._model = model;
 }
 
 bool MeshState::setModelMatrix(int idx, const glm::mat4 &model, const glm::vec3 &pivot, const glm::vec3 &mins,
 									   const glm::vec3 &maxs) {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
+	if (idx < 0) {
 		Log::error("Given id %i is out of bounds", idx);
 		return false;
 	}
@@ -76,7 +128,11 @@ bool MeshState::setModelMatrix(int idx, const glm::mat4 &model, const glm::vec3
 		Log::error("No volume found at: %i", idx);
 		return false;
 	}
-	VolumeData &state = _volumeData[idx];
+	VolumeData &state = createVolumeData(idx);
+	if (state._model != model || state._pivot != pivot) {
+		// the chunks of the volume are somewhere else in the world now
+		_cameraMoved = true;
+	}
 	state._model = model;
 	state._pivot = pivot;
 	state._mins = mins;
@@ -85,80 +141,407 @@ bool MeshState::setModelMatrix(int idx, const glm::mat4 &model, const glm::vec3
 }
 
 void MeshState::clear() {
-	for (int i = 0; i < MeshType_Max; ++i) {
-		for (const auto &iter : _meshes[i]) {
-			for (voxel::Mesh *mesh : iter->value) {
-				delete mesh;
+	for (VolumeData *state : _volumeData) {
+		if (state == nullptr) {
+			continue;
+		}
+		for (int i = 0; i < MeshType_Max; ++i) {
+			for (const auto &iter : state->_meshes[i]) {
+				delete iter->value;
 			}
+			state->_meshes[i].clear();
 		}
-		_meshes[i].clear();
+		for (int i = 0; i < LODLevels - 1; ++i) {
+			for (const auto &iter : state->_lodMeshes[i]) {
+				delete iter->value;
+			}
+			state->_lodMeshes[i].clear();
+		}
+	}
+}
+
+void MeshState::acquireMesh(voxel::Mesh &mesh) {
+	if (!_meshPool.pop(mesh)) {
+		mesh = voxel::Mesh(65536, 65536, true);
+	}
+}
+
+void MeshState::releaseMesh(voxel::Mesh &mesh) {
+	// don't keep more buffers than the extraction tasks can use
+	const uint32_t maxPooledMeshes = (uint32_t)_threadPool.size() * voxel::ChunkMesh::Meshes * 2u;
+	if (mesh.getVertexVector().capacity() == 0u || _meshPool.size() >= maxPooledMeshes) {
+		mesh = voxel::Mesh(0, 0, true);
+		return;
 	}
+	mesh.clear();
+	_meshPool.push(core::move(mesh));
+}
+
+void MeshState::deleteMesh(voxel::Mesh *mesh) {
+	if (mesh == nullptr) {
+		return;
+	}
+	releaseMesh(*mesh);
+	delete mesh;
 }
 
 void MeshState::addOrReplaceMeshes(MeshState::ExtractionCtx &result, MeshType type) {
-	auto iter = _meshes[type].find(result.mins);
-	if (iter != _meshes[type].end()) {
-		delete iter->value[result.idx];
-		iter->value[result.idx] = new voxel::Mesh(core::move(result.mesh.mesh[type]));
+	MeshesMap &meshes = createVolumeData(result.idx)._meshes[type];
+	voxel::Mesh *mesh = new voxel::Mesh(core::move(result.mesh.mesh[type]));
+	auto iter = meshes.find(result.mins);
+	if (iter != meshes.end()) {
+		deleteMesh(iter->value);
+		iter->value = mesh;
 		return;
 	}
-	_meshes[type].emplace(result.mins, Meshes());
-	auto newIter = _meshes[type].find(result.mins);
-	newIter->value[result.idx] = new voxel::Mesh(core::move(result.mesh.mesh[type]));
+	meshes.put(result.mins, mesh);
+}
+
+void MeshState::replaceLODMeshes(MeshState::ExtractionCtx &result) {
+	VolumeData &state = createVolumeData(result.idx);
+	for (int i = 0; i < LODLevels - 1; ++i) {
+		MeshesMap &meshes = state._lodMeshes[i];
+		auto iter = meshes.find(result.mins);
+		if (iter != meshes.end()) {
+			// the level of detail meshes are small - their buffers are not reused
+			delete iter->value;
+			meshes.erase(iter);
+		}
+		if (i >= (int)result.lods.size()) {
+			continue;
+		}
+		meshes.put(result.mins, new voxel::Mesh(core::move(result.lods[i])));
+	}
+	result.lods.clear();
+}
+
+// each brick is extracted on its own - a triangle belongs to the brick that contains its floored center
+static void spliceMesh(voxel::Mesh &target, const voxel::Mesh &patch, const voxel::Region &region) {
+	core_assert(target.getNormalVector().empty());
+	voxel::VertexArray &vertices = target.getVertexVector();
+	voxel::IndexArray &indices = target.getIndexVector();
+	size_t kept = 0u;
+	for (size_t i = 0u; i < indices.size(); i += 3u) {
+		const glm::vec3 center = (vertices[indices[i]].position + vertices[indices[i + 1]].position +
+								  vertices[indices[i + 2]].position) / 3.0f;
+		if (region.containsPoint(glm::ivec3(glm::floor(center)))) {
+			continue;
+		}
+		indices[kept++] = indices[i];
+		indices[kept++] = indices[i + 1];
+		indices[kept++] = indices[i + 2];
+	}
+	indices.resize(kept);
+	const voxel::IndexType vertexOffset = (voxel::IndexType)vertices.size();
+	vertices.append(patch.getVertexVector());
+	indices.reserve(indices.size() + patch.getNoOfIndices());
+	for (voxel::IndexType index : patch.getIndexVector()) {
+		indices.push_back(index + vertexOffset);
+	}
+	target.removeUnusedVertices();
+}
+
+bool MeshState::hasMeshes(const glm::ivec3 &mins, int idx) const {
+	const VolumeData &state = volumeData(idx);
+	for (int i = 0; i < MeshType_Max; ++i) {
+		auto iter = state._meshes[i].find(mins);
+		if (iter == state._meshes[i].end() || iter->value == nullptr) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool MeshState::spliceMeshes(MeshState::ExtractionCtx &result) {
+	if (!hasMeshes(result.mins, result.idx)) {
+		return false;
+	}
+	VolumeData &state = createVolumeData(result.idx);
+	for (int i = 0; i < MeshType_Max; ++i) {
+		auto iter = state._meshes[i].find(result.mins);
+		spliceMesh(*iter->value, result.mesh.mesh[i], result.region);
+		releaseMesh(result.mesh.mesh[i]);
+	}
+	return true;
+}
+
+void MeshState::updateExtractionStats(uint64_t scheduled) {
+	const uint64_t now = core::TimeProvider::systemMillis();
+	const uint64_t latency = now > scheduled ? now - scheduled : 0u;
+	ExtractionStats &stats = _extractionStats;
+	++stats.extractions;
+	stats.lastLatencyMillis = latency;
+	stats.maxLatencyMillis = core_max(stats.maxLatencyMillis, latency);
+	stats.averageLatencyMillis += ((double)latency - stats.averageLatencyMillis) / (double)stats.extractions;
+	core_trace_plot("MeshStateExtractionLatency", (int64_t)latency);
+	core::perfRecord(core::PerfStat::Extraction, latency * 1000u);
+}
+
+int MeshState::startChunkJob(ExtractRegion &extractRegion, core::SharedPtr<core::AtomicInt> &generation) {
+	const glm::ivec4 key(extractRegion.mins, extractRegion.idx);
+	auto iter = _chunkJobs.find(key);
+	if (iter == _chunkJobs.end()) {
+		ChunkJobs chunkJobs;
+		chunkJobs.generation = core::make_shared<core::AtomicInt>(0);
+		chunkJobs.region = extractRegion.region;
+		chunkJobs.patch = extractRegion.patch;
+		chunkJobs.jobs = 1;
+		_chunkJobs.put(key, chunkJobs);
+		generation = chunkJobs.generation;
+		return 0;
+	}
+	ChunkJobs &chunkJobs = iter->value;
+	// the meshes of the unfinished jobs are dropped - so this job must extract their regions, too
+	if (!chunkJobs.patch || !extractRegion.patch) {
+		const int s = _meshSize->intVal();
+		chunkJobs.region = voxel::Region(extractRegion.mins, extractRegion.mins + s - 1);
+		chunkJobs.patch = false;
+	} else {
+		chunkJobs.region.accumulate(extractRegion.region);
+	}
+	extractRegion.region = chunkJobs.region;
+	extractRegion.patch = chunkJobs.patch;
+	++chunkJobs.jobs;
+	generation = chunkJobs.generation;
+	return generation->increment() + 1;
+}
+
+bool MeshState::finishChunkJob(const MeshState::ExtractionCtx &result) {
+	const glm::ivec4 key(result.mins, result.idx);
+	auto iter = _chunkJobs.find(key);
+	if (iter == _chunkJobs.end()) {
+		// the jobs were cleared in the meantime - see clearPendingExtractions()
+		return true;
+	}
+	ChunkJobs &chunkJobs = iter->value;
+	const bool latest = (int)*chunkJobs.generation.get() == result.generation;
+	if (--chunkJobs.jobs <= 0) {
+		_chunkJobs.remove(key);
+	}
+	return latest;
+}
+
+void MeshState::pushResult(MeshState::ExtractionCtx &&result) {
+	if (!_finishedQueue.push(core::move(result))) {
+		_pendingQueue.push(core::move(result));
+	}
+}
+
+bool MeshState::popResult(MeshState::ExtractionCtx &result) {
+	if (_finishedQueue.pop(result)) {
+		return true;
+	}
+	return _pendingQueue.pop(result);
 }
 
 int MeshState::pop() {
 	MeshState::ExtractionCtx result;
-	while (_pendingQueue.pop(result)) {
-		if (_volumeData[result.idx]._rawVolume == nullptr) {
+	while (popResult(result)) {
+		if (!finishChunkJob(result)) {
+			++_extractionStats.superseded;
+			for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+				releaseMesh(result.mesh.mesh[i]);
+			}
+			continue;
+		}
+		if (volume(result.idx) == nullptr) {
+			for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+				releaseMesh(result.mesh.mesh[i]);
+			}
+			continue;
+		}
+		if (result.patch) {
+			if (spliceMeshes(result)) {
+				// the levels of detail are extracted from the whole chunk - or removed if they are outdated now
+				replaceLODMeshes(result);
+				updateExtractionStats(result.scheduled);
+				return result.idx;
+			}
+			// the meshes of the chunk were deleted in the meantime - the whole chunk must be extracted again
+			for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+				releaseMesh(result.mesh.mesh[i]);
+			}
+			const voxel::Region chunkRegion(result.mins, result.mins + _meshSize->intVal() - 1);
+			addExtractRegion(chunkRegion, result.mins, result.idx, false, result.scheduled);
 			continue;
 		}
 		addOrReplaceMeshes(result, MeshType_Opaque);
 		addOrReplaceMeshes(result, MeshType_Transparency);
+		replaceLODMeshes(result);
+		updateExtractionStats(result.scheduled);
 		return result.idx;
 	}
 	return -1;
 }
 
 bool MeshState::deleteMeshes(const glm::ivec3 &pos, int idx) {
+	if (idx < 0 || idx >= (int)_volumeData.size() || _volumeData[idx] == nullptr) {
+		return false;
+	}
+	VolumeData &state = *_volumeData[idx];
 	bool d = false;
 	for (int i = 0; i < MeshType_Max; ++i) {
-		auto &meshes = _meshes[i];
+		auto &meshes = state._meshes[i];
 		auto iter = meshes.find(pos);
 		if (iter != meshes.end()) {
-			MeshState::Meshes &array = iter->value;
-			voxel::Mesh *mesh = array[idx];
-			delete mesh;
-			array[idx] = nullptr;
+			deleteMesh(iter->value);
+			meshes.erase(iter);
 			d = true;
 		}
 	}
+	for (int i = 0; i < LODLevels - 1; ++i) {
+		auto &meshes = state._lodMeshes[i];
+		auto iter = meshes.find(pos);
+		if (iter != meshes.end()) {
+			delete iter->value;
+			meshes.erase(iter);
+		}
+	}
 	return d;
 }
 
 bool MeshState::deleteMeshes(int idx) {
+	if (idx < 0 || idx >= (int)_volumeData.size() || _volumeData[idx] == nullptr) {
+		return false;
+	}
+	VolumeData &state = *_volumeData[idx];
 	bool d = false;
 	for (int i = 0; i < MeshType_Max; ++i) {
-		auto &meshes = _meshes[i];
+		auto &meshes = state._meshes[i];
 		for (const auto &iter : meshes) {
-			MeshState::Meshes &array = iter->value;
-			voxel::Mesh *mesh = array[idx];
-			delete mesh;
-			array[idx] = nullptr;
+			deleteMesh(iter->value);
 			d = true;
 		}
+		meshes.clear();
+	}
+	for (int i = 0; i < LODLevels - 1; ++i) {
+		for (const auto &iter : state._lodMeshes[i]) {
+			delete iter->value;
+		}
+		state._lodMeshes[i].clear();
 	}
 	return d;
 }
 
-const MeshState::MeshesMap &MeshState::meshes(MeshType type) const {
-	return _meshes[type];
+const MeshState::MeshesMap &MeshState::meshes(MeshType type, int idx) const {
+	return volumeData(idx)._meshes[type];
+}
+
+int MeshState::meshSize() const {
+	return _meshSize->intVal();
+}
+
+const MeshState::MeshesMap &MeshState::lodMeshes(int lod, int idx) const {
+	core_assert(lod >= 0 && lod < LODLevels);
+	const VolumeData &state = volumeData(idx);
+	if (lod == 0) {
+		return state._meshes[MeshType_Opaque];
+	}
+	return state._lodMeshes[lod - 1];
+}
+
+void MeshState::setDownsampler(const Downsampler &downsampler) {
+	_downsampler = downsampler;
+}
+
+void MeshState::setMeshCache(const io::ArchivePtr &archive) {
+	const uint64_t maxSize = (uint64_t)_meshCacheSize->intVal() * 1024u * 1024u;
+	_meshCache = core::make_shared<voxel::MeshCache>(archive, "meshcache/", maxSize);
+}
+
+bool MeshState::useMeshCache() {
+	if (!_meshCacheVar->boolVal()) {
+		return false;
+	}
+	if (!_meshCache) {
+		const io::FilesystemPtr &filesystem = app::App::getInstance()->filesystem();
+		if (!filesystem) {
+			return false;
+		}
+		// the entries are written into the home directory
+		setMeshCache(io::openFilesystemArchive(filesystem, "", false));
+	}
+	return true;
+}
+
+bool MeshState::extractLODs() const {
+	if (!_downsampler || !_meshLOD->boolVal() || meshMode() != voxel::SurfaceExtractionType::Cubic) {
+		return false;
+	}
+	// each level must have at least one voxel
+	const int s = _meshSize->intVal();
+	const int lowestResolution = 1 << (LODLevels - 1);
+	return s >= lowestResolution && s % lowestResolution == 0;
+}
+
+// the faces between two chunks belong to the upper chunk - the first level of detail covers the adjacent voxels of
+// the lower neighbour chunks, too. Otherwise there would be holes where a full resolution neighbour ends at the
+// chunk border.
+static void addLowerNeighbours(const voxel::RawVolume &volume, const voxel::Region &chunkRegion,
+							   voxel::RawVolume &dest) {
+	const glm::ivec3 &mins = chunkRegion.getLowerCorner();
+	const int size = chunkRegion.getWidthInVoxels();
+	for (int axis = 0; axis < 3; ++axis) {
+		const int axis1 = (axis + 1) % 3;
+		const int axis2 = (axis + 2) % 3;
+		glm::ivec3 pos = mins;
+		pos[axis] = mins[axis] - 1;
+		for (int i = 0; i < size; ++i) {
+			pos[axis1] = mins[axis1] + i;
+			for (int j = 0; j < size; ++j) {
+				pos[axis2] = mins[axis2] + j;
+				const voxel::Voxel &voxel = volume.voxel(pos);
+				if (!voxel::isBlocked(voxel.getMaterial())) {
+					continue;
+				}
+				glm::ivec3 destPos = (pos - mins) / 2;
+				destPos[axis] = 0;
+				if (voxel::isAir(dest.voxel(destPos).getMaterial())) {
+					dest.setVoxel(destPos, voxel);
+				}
+			}
+		}
+	}
+}
+
+void MeshState::extractLODs(const voxel::RawVolume &volume, const voxel::Region &chunkRegion,
+							const palette::Palette &palette, core::DynamicArray<voxel::Mesh> &lods) {
+	core_trace_scoped(MeshStateExtractLODs);
+	const glm::ivec3 &mins = chunkRegion.getLowerCorner();
+	const int chunkSize = chunkRegion.getWidthInVoxels();
+	lods.reserve(LODLevels - 1);
+	// each level is downsampled from the previous one
+	core::ScopedPtr<voxel::RawVolume> previous;
+	for (int lod = 1; lod < LODLevels; ++lod) {
+		const int size = chunkSize >> lod;
+		voxel::RawVolume *lodVolume = new voxel::RawVolume(voxel::Region(0, size - 1));
+		if (previous) {
+			_downsampler(*previous, palette, previous->region(), *lodVolume);
+		} else {
+			_downsampler(volume, palette, chunkRegion, *lodVolume);
+			addLowerNeighbours(volume, chunkRegion, *lodVolume);
+		}
+		previous = lodVolume;
+
+		voxel::ChunkMesh mesh;
+		// everything outside of the level volume is air - this closes the mesh at the chunk borders. The upper corner
+		// is shifted to get the faces at the upper borders, too.
+		voxel::Region region = lodVolume->region();
+		region.shiftUpperCorner(1, 1, 1);
+		voxel::SurfaceExtractionContext ctx = voxel::buildCubicContext(lodVolume, region, mesh);
+		voxel::extractSurface(ctx);
+		const float scale = (float)(1 << lod);
+		for (voxel::VoxelVertex &vertex : mesh.mesh[MeshType_Opaque].getVertexVector()) {
+			vertex.position = vertex.position * scale + glm::vec3(mins);
+		}
+		// the transparent voxels are always rendered in the full resolution
+		lods.push_back(core::move(mesh.mesh[MeshType_Opaque]));
+	}
 }
 
 void MeshState::count(MeshType meshType, int idx, size_t &vertCount, size_t &normalsCount, size_t &indCount) const {
-	for (const auto &i : _meshes[meshType]) {
-		const MeshState::Meshes &meshes = i->value;
-		const voxel::Mesh *mesh = meshes[idx];
+	for (const auto &i : volumeData(idx)._meshes[meshType]) {
+		const voxel::Mesh *mesh = i->value;
 		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
 			continue;
 		}
@@ -172,18 +555,20 @@ void MeshState::count(MeshType meshType, int idx, size_t &vertCount, size_t &nor
 }
 
 const palette::Palette &MeshState::palette(int idx) const {
-	if (idx < 0 || idx > MAX_VOLUMES || !_volumeData[idx]._palette.hasValue()) {
+	const VolumeData &state = volumeData(idx);
+	if (state._palette == nullptr) {
 		return voxel::getPalette();
 	}
-	return *_volumeData[idx]._palette.value();
+	return *state._palette;
 }
 
 const palette::NormalPalette &MeshState::normalsPalette(int idx) const {
-	if (idx < 0 || idx > MAX_VOLUMES || !_volumeData[idx]._normalPalette.hasValue()) {
+	const VolumeData &state = volumeData(idx);
+	if (state._normalPalette == nullptr) {
 		static palette::NormalPalette normalPalette;
 		return normalPalette;
 	}
-	return *_volumeData[idx]._normalPalette.value();
+	return *state._normalPalette;
 }
 
 voxel::Region MeshState::calculateExtractRegion(int x, int y, int z, const glm::ivec3 &meshSize) const {
@@ -192,8 +577,135 @@ voxel::Region MeshState::calculateExtractRegion(int x, int y, int z, const glm::
 	return voxel::Region{mins, maxs};
 }
 
+// check the rows of the given region for solid voxels without copying them
+static bool isOnlyAir(const voxel::RawVolume &v, voxel::Region region) {
+	region.cropTo(v.region());
+	if (!region.isValid() || !voxel::intersects(v.solidRegion(), region)) {
+		return true;
+	}
+	const int32_t width = region.getWidthInVoxels();
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			const voxel::Voxel *row = v.row(glm::ivec3(region.getLowerX(), y, z));
+			for (int32_t x = 0; x < width; ++x) {
+				if (!voxel::isAir(row[x].getMaterial())) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void MeshState::setCamera(const glm::vec3 &position, const glm::mat4 &view, const glm::mat4 &projection) {
+	const glm::mat4 viewProjection = projection * view;
+	if (_hasCamera && _cameraPos == position && _cameraViewProjection == viewProjection) {
+		return;
+	}
+	_hasCamera = true;
+	_cameraMoved = true;
+	_cameraPos = position;
+	_cameraViewProjection = viewProjection;
+	_frustum.update(view, projection);
+}
+
+void MeshState::addExtractRegion(const voxel::Region &region, const glm::ivec3 &mins, int idx, bool patch,
+								 uint64_t scheduled) {
+	const glm::ivec4 key(mins, idx);
+	auto iter = _extractRegions.find(key);
+	if (iter == _extractRegions.end()) {
+		ExtractRegion extractRegion(region, mins, idx, patch);
+		extractRegion.scheduled = scheduled;
+		extractRegion.sequence = _extractSequence++;
+		_extractRegions.put(key, extractRegion);
+		_extractOrderDirty = true;
+		return;
+	}
+	++_extractionStats.collapsed;
+	ExtractRegion &pending = iter->value;
+	pending.scheduled = core_min(pending.scheduled, scheduled);
+	if (!pending.patch) {
+		// the whole chunk is extracted anyway
+		return;
+	}
+	if (!patch) {
+		pending.region = region;
+		pending.patch = false;
+		return;
+	}
+	// both regions are made of whole bricks - so is the region that covers both
+	pending.region.accumulate(region);
+}
+
+int MeshState::extractTier(const ExtractRegion &extractRegion, float &distance) const {
+	distance = 0.0f;
+	if (hidden(extractRegion.idx)) {
+		return 2;
+	}
+	if (!_hasCamera) {
+		return 0;
+	}
+	const VolumeData &state = volumeData(extractRegion.idx);
+	const glm::mat4 &model = state._model;
+	const float scale = glm::max(glm::length(glm::vec3(model[0])),
+								 glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	const float chunkSize = (float)_meshSize->intVal();
+	const glm::vec3 center = glm::vec3(extractRegion.mins) + chunkSize * 0.5f - state._pivot;
+	const glm::vec3 worldCenter(model * glm::vec4(center, 1.0f));
+	const float radius = glm::length(glm::vec3(chunkSize * 0.5f)) * scale;
+	distance = glm::distance(_cameraPos, worldCenter);
+	return _frustum.isVisible(worldCenter, radius) ? 0 : 1;
+}
+
+void MeshState::prioritizeExtractions() {
+	core_trace_scoped(MeshStatePrioritizeExtractions);
+	_extractOrder.clear();
+	_extractOrder.reserve(_extractRegions.size());
+	for (const auto &iter : _extractRegions) {
+		ExtractPriority priority;
+		priority.key = iter->key;
+		priority.sequence = iter->value.sequence;
+		priority.tier = extractTier(iter->value, priority.distance);
+		_extractOrder.push_back(priority);
+	}
+	// the chunk with the highest priority is taken from the end
+	core::sort(_extractOrder.begin(), _extractOrder.end(),
+			   [](const ExtractPriority &lhs, const ExtractPriority &rhs) { return rhs < lhs; });
+	_extractOrderDirty = false;
+	_cameraMoved = false;
+	_lastPrioritizing = core::TimeProvider::systemMillis();
+}
+
+bool MeshState::popExtractRegion(ExtractRegion &extractRegion) {
+	if (_extractRegions.empty()) {
+		_extractOrder.clear();
+		return false;
+	}
+	// a moving camera would sort the pending extractions in every frame
+	static constexpr uint64_t PrioritizeDelayMillis = 100u;
+	if (_extractOrderDirty ||
+		(_cameraMoved && core::TimeProvider::systemMillis() - _lastPrioritizing >= PrioritizeDelayMillis)) {
+		prioritizeExtractions();
+	}
+	while (!_extractOrder.empty()) {
+		const glm::ivec4 key = _extractOrder.back().key;
+		_extractOrder.pop();
+		auto iter = _extractRegions.find(key);
+		// the pending extractions of removed volumes are not part of the map anymore
+		if (iter == _extractRegions.end()) {
+			continue;
+		}
+		extractRegion = iter->value;
+		_extractRegions.erase(iter);
+		return true;
+	}
+	return false;
+}
+
 bool MeshState::runScheduledExtractions(size_t maxExtraction) {
 	const size_t n = _extractRegions.size();
+	core::perfGauge(core::PerfStat::ExtractionQueue, (uint64_t)n + (uint64_t)core_max(0, (int)_pendingExtractorTasks));
+	core_trace_plot("MeshStateQueueDepth", (int64_t)n);
 	if (n == 0) {
 		return false;
 	}
@@ -201,10 +713,17 @@ bool MeshState::runScheduledExtractions(size_t maxExtraction) {
 		return true;
 	}
 	voxel::SurfaceExtractionType type = (voxel::SurfaceExtractionType)_meshMode->intVal();
+	const int bricks = brickSize();
+	const bool lods = extractLODs();
+	// the renderer applies the ambient occlusion from its own volume
+	const bool ambientOcclusion = !_aoVolume->boolVal();
+	const bool useCache = useMeshCache();
+	const int s = _meshSize->intVal();
+	core::DynamicArray<int> extracted;
 	size_t i;
 	for (i = 0; i < n; ++i) {
 		ExtractRegion extractRegion;
-		if (!_extractRegions.pop(extractRegion)) {
+		if (!popExtractRegion(extractRegion)) {
 			break;
 		}
 		const int idx = extractRegion.idx;
@@ -212,47 +731,106 @@ bool MeshState::runScheduledExtractions(size_t maxExtraction) {
 		if (v == nullptr) {
 			continue;
 		}
+		core::SharedPtr<core::AtomicInt> latestGeneration;
+		const int generation = startChunkJob(extractRegion, latestGeneration);
 		const voxel::Region &finalRegion = extractRegion.region;
+		const glm::ivec3 &mins = extractRegion.mins;
+		// the levels of detail are always extracted from the whole chunk
+		const voxel::Region chunkRegion(mins, mins + s - 1);
+		const voxel::Region &sourceRegion = lods ? chunkRegion : finalRegion;
+		const voxel::Region copyRegion(sourceRegion.getLowerCorner() - 2, sourceRegion.getUpperCorner() + 2);
+		extracted.push_back(idx);
+		// if the volume wasn't modified since the last run it's very likely that nobody modifies it while the
+		// extraction is running - share the voxel data with the worker instead of copying the region. If it gets
+		// modified anyway, the volume gets its own copy of the voxel data and the worker keeps the old one.
+		const bool shareVolume = v->version() == volumeData(idx)._extractVersion;
 		bool onlyAir = true;
-		const voxel::Region copyRegion(finalRegion.getLowerCorner() - 2, finalRegion.getUpperCorner() + 2);
-		if (!copyRegion.isValid()) {
-			continue;
+		voxel::RawVolume copy = shareVolume ? voxel::RawVolume(*v, voxel::RawVolume::SharedTag())
+											: voxel::RawVolume(*v, copyRegion, &onlyAir);
+		if (shareVolume) {
+			onlyAir = isOnlyAir(*v, copyRegion);
 		}
-		voxel::RawVolume copy(v, copyRegion, &onlyAir);
-		const glm::ivec3 &mins = finalRegion.getLowerCorner();
+		const bool patch = extractRegion.patch;
+		const uint64_t scheduled = extractRegion.scheduled;
 		if (!onlyAir) {
 			const palette::Palette &pal = palette(resolveIdx(idx));
+			// the patches of modified chunks are not cached - they are only valid for the existing meshes
+			core::SharedPtr<voxel::MeshCache> meshCache;
+			if (useCache && !patch) {
+				meshCache = _meshCache;
+			}
+			voxel::Region hashRegion = copyRegion;
+			hashRegion.cropTo(v->region());
 			++_pendingExtractorTasks;
-			_threadPool.enqueue([type, movedPal = core::move(pal), movedCopy = core::move(copy), mins, idx,
-								 finalRegion, this]() {
+			_threadPool.schedule([type, bricks, lods, ambientOcclusion, movedPal = core::move(pal),
+								 movedCopy = core::move(copy), mins, idx, patch, finalRegion, chunkRegion, hashRegion, meshCache, scheduled, generation,
+								 latestGeneration, this]() {
 				++_runningExtractorTasks;
-				voxel::ChunkMesh mesh(65536, 65536, true);
-				voxel::SurfaceExtractionContext ctx = voxel::createContext(type, &movedCopy, finalRegion, movedPal, mesh, mins);
-				voxel::extractSurface(ctx);
-				_pendingQueue.emplace(mins, idx, core::move(mesh));
+				if ((int)*latestGeneration.get() != generation) {
+					// a newer job of the chunk was started in the meantime - pop() drops the meshes anyway
+					pushResult(MeshState::ExtractionCtx(mins, idx, core::move(voxel::ChunkMesh(0, 0)), patch,
+														finalRegion, scheduled, generation));
+					--_runningExtractorTasks;
+					--_pendingExtractorTasks;
+					return;
+				}
+				voxel::ChunkMesh mesh(0, 0, true);
+				for (int m = 0; m < voxel::ChunkMesh::Meshes; ++m) {
+					acquireMesh(mesh.mesh[m]);
+				}
+				core::DynamicArray<voxel::Mesh> lodMeshes;
+				voxel::MeshCacheKey cacheKey;
+				if (meshCache) {
+					cacheKey = voxel::MeshCache::key(movedCopy, hashRegion, finalRegion, movedPal, type, bricks, lods,
+													 ambientOcclusion);
+				}
+				if (!meshCache || !meshCache->load(cacheKey, mesh, lodMeshes)) {
+					voxel::SurfaceExtractionContext ctx = voxel::createContext(
+						type, &movedCopy, finalRegion, movedPal, mesh, finalRegion.getLowerCorner(), true, true,
+						ambientOcclusion);
+					ctx.brickSize = bricks;
+					ctx.vertexOcclusion = ambientOcclusion;
+					voxel::extractSurface(ctx);
+					if (lods) {
+						extractLODs(movedCopy, chunkRegion, movedPal, lodMeshes);
+					}
+					if (meshCache) {
+						meshCache->store(cacheKey, mesh, lodMeshes);
+					}
+				}
+				MeshState::ExtractionCtx result(mins, idx, core::move(mesh), patch, finalRegion, scheduled,
+												generation);
+				result.lods = core::move(lodMeshes);
+				pushResult(core::move(result));
 				Log::debug("Enqueue mesh for idx: %i (%i:%i:%i)", idx, mins.x, mins.y, mins.z);
 				--_runningExtractorTasks;
 				--_pendingExtractorTasks;
 			});
 		} else {
-			_pendingQueue.emplace(mins, idx, core::move(voxel::ChunkMesh(0, 0)));
+			_pendingQueue.emplace(mins, idx, core::move(voxel::ChunkMesh(0, 0)), patch, finalRegion, scheduled,
+								  generation);
 		}
 		--maxExtraction;
 		if (maxExtraction == 0) {
 			break;
 		}
 	}
+	for (int idx : extracted) {
+		createVolumeData(idx)._extractVersion = volume(idx)->version();
+	}
 
 	return true;
 }
 
 bool MeshState::update() {
 	bool triggerClear = false;
-	if (_meshMode->isDirty()) {
+	if (_meshMode->isDirty() || _aoVolume->isDirty() || _extractingLODs != extractLODs()) {
 		_meshMode->markClean();
+		_aoVolume->markClean();
+		_extractingLODs = extractLODs();
 		clearPendingExtractions();
 
-		for (int i = 0; i < MAX_VOLUMES; ++i) {
+		for (int i = 0; i < volumeSlots(); ++i) {
 			if (voxel::RawVolume *v = volume(i)) {
 				scheduleRegionExtraction(i, v->region());
 			}
@@ -263,6 +841,28 @@ bool MeshState::update() {
 	return triggerClear;
 }
 
+int MeshState::brickSize() const {
+	if (meshMode() != voxel::SurfaceExtractionType::Cubic) {
+		return 0;
+	}
+	const int s = _meshSize->intVal();
+	if (s <= BrickSize || s % BrickSize != 0) {
+		return 0;
+	}
+	return BrickSize;
+}
+
+// the bricks of the chunk that intersect the dirty region
+static voxel::Region brickRegion(const voxel::Region &dirtyRegion, const voxel::Region &chunkRegion, int brickSize) {
+	const glm::ivec3 lower = glm::max(dirtyRegion.getLowerCorner(), chunkRegion.getLowerCorner());
+	const glm::ivec3 upper = glm::min(dirtyRegion.getUpperCorner(), chunkRegion.getUpperCorner());
+	if (glm::any(glm::greaterThan(lower, upper))) {
+		return voxel::Region::InvalidRegion;
+	}
+	const int mask = ~(brickSize - 1);
+	return voxel::Region(lower & mask, (upper & mask) + brickSize - 1);
+}
+
 bool MeshState::scheduleRegionExtraction(int idx, const voxel::Region &region) {
 	core_trace_scoped(MeshStateScheduleExtraction);
 	const int bufferIndex = resolveIdx(idx);
@@ -284,7 +884,12 @@ bool MeshState::scheduleRegionExtraction(int idx, const voxel::Region &region) {
 	const glm::ivec3 &l = (region.getLowerCorner() - meshSizeMinusOne) / meshSize;
 	const glm::ivec3 &u = (region.getUpperCorner() + 1) / meshSize;
 
+	// the faces of the neighbours of the modified voxels might change, too - see the cubic surface extractor docs
+	const voxel::Region dirtyRegion(region.getLowerCorner() - 1, region.getUpperCorner() + 1);
+	const int bricks = brickSize();
+
 	bool deletedMesh = false;
+	const uint64_t now = core::TimeProvider::systemMillis();
 	Log::debug("modified region: %s", region.toString().c_str());
 	for (int x = l.x; x <= u.x; ++x) {
 		for (int y = l.y; y <= u.y; ++y) {
@@ -298,8 +903,21 @@ bool MeshState::scheduleRegionExtraction(int idx, const voxel::Region &region) {
 					continue;
 				}
 
+				if (bricks > 0 && hasMeshes(mins, bufferIndex)) {
+					const voxel::Region &patchRegion = brickRegion(dirtyRegion, finalRegion, bricks);
+					if (!patchRegion.isValid()) {
+						// the existing meshes of this chunk are not affected
+						continue;
+					}
+					if (patchRegion != finalRegion) {
+						Log::debug("extract bricks: %s", patchRegion.toString().c_str());
+						addExtractRegion(patchRegion, mins, bufferIndex, true, now);
+						continue;
+					}
+				}
+
 				Log::debug("extract region: %s", finalRegion.toString().c_str());
-				_extractRegions.emplace(finalRegion, bufferIndex, hidden(bufferIndex));
+				addExtractRegion(finalRegion, mins, bufferIndex, false, now);
 			}
 		}
 	}
@@ -312,6 +930,48 @@ void MeshState::extractAllPending() {
 	waitForPendingExtractions();
 }
 
+void MeshState::extractAllPending(const SyncExtractor &extractor) {
+	if (!extractor || meshMode() != voxel::SurfaceExtractionType::Cubic) {
+		extractAllPending();
+		return;
+	}
+	core_trace_scoped(MeshStateExtractAllPendingSync);
+	core::DynamicArray<ExtractRegion> refused;
+	ExtractRegion extractRegion;
+	while (popExtractRegion(extractRegion)) {
+		const int idx = extractRegion.idx;
+		const voxel::RawVolume *v = volume(idx);
+		if (v == nullptr) {
+			continue;
+		}
+		if (_chunkJobs.hasKey(glm::ivec4(extractRegion.mins, idx))) {
+			// the unfinished jobs of the chunk are superseded by the surface extractor - see startChunkJob()
+			refused.push_back(extractRegion);
+			continue;
+		}
+		voxel::ChunkMesh mesh(0, 0, true);
+		for (int m = 0; m < voxel::ChunkMesh::Meshes; ++m) {
+			acquireMesh(mesh.mesh[m]);
+		}
+		if (!extractor(*v, extractRegion.region, mesh)) {
+			for (int m = 0; m < voxel::ChunkMesh::Meshes; ++m) {
+				releaseMesh(mesh.mesh[m]);
+			}
+			refused.push_back(extractRegion);
+			continue;
+		}
+		createVolumeData(idx)._extractVersion = v->version();
+		core::SharedPtr<core::AtomicInt> latestGeneration;
+		const int generation = startChunkJob(extractRegion, latestGeneration);
+		_pendingQueue.emplace(extractRegion.mins, idx, core::move(mesh), extractRegion.patch, extractRegion.region,
+							  extractRegion.scheduled, generation);
+	}
+	for (const ExtractRegion &r : refused) {
+		addExtractRegion(r.region, r.mins, r.idx, r.patch, r.scheduled);
+	}
+	extractAllPending();
+}
+
 void MeshState::waitForPendingExtractions() {
 	while (_pendingExtractorTasks > 0) {
 		app::App::getInstance()->wait(1);
@@ -324,6 +984,8 @@ void MeshState::clearPendingExtractions() {
 		app::App::getInstance()->wait(1);
 	}
 	_pendingQueue.clear();
+	_finishedQueue.clear();
+	_chunkJobs.clear();
 	_pendingExtractorTasks = 0;
 }
 
@@ -340,10 +1002,10 @@ int MeshState::resolveIdx(int idx) const {
 }
 
 bool MeshState::sameNormalPalette(int idx, const palette::NormalPalette *palette) const {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
+	if (idx < 0) {
 		return false;
 	}
-	const palette::NormalPalette *normalPalette = _volumeData[idx]._normalPalette.value();
+	const palette::NormalPalette *normalPalette = volumeData(idx)._normalPalette;
 	if (normalPalette == nullptr) {
 		return palette == nullptr;
 	}
@@ -353,109 +1015,117 @@ bool MeshState::sameNormalPalette(int idx, const palette::NormalPalette *palette
 	return normalPalette->hash() == palette->hash();
 }
 
-voxel::RawVolume *MeshState::setVolume(int idx, voxel::RawVolume *v, palette::Palette *palette, palette::NormalPalette *normalPalette, bool meshDelete,
+voxel::RawVolume *MeshState::setVolume(int idx, voxel::RawVolume *v, const palette::Palette *palette, const palette::NormalPalette *normalPalette, bool meshDelete,
 									   bool &meshDeleted) {
 	meshDeleted = false;
-	if (idx < 0 || idx >= MAX_VOLUMES) {
+	if (idx < 0) {
 		return nullptr;
 	}
-	_volumeData[idx]._palette.setValue(palette);
-	_volumeData[idx]._normalPalette.setValue(normalPalette);
-	voxel::RawVolume *old = volume(idx);
+	if (v == nullptr && (idx >= (int)_volumeData.size() || _volumeData[idx] == nullptr)) {
+		// don't allocate a slot to reset it
+		return nullptr;
+	}
+	VolumeData &state = createVolumeData(idx);
+	state._palette = palette;
+	state._normalPalette = normalPalette;
+	voxel::RawVolume *old = state._rawVolume;
 	if (old == v) {
 		return nullptr;
 	}
 	core_trace_scoped(RawVolumeRendererSetVolume);
-	_volumeData[idx]._rawVolume = v;
+	state._rawVolume = v;
+	state._extractVersion = v != nullptr ? v->version() : 0u;
 	if (meshDelete) {
 		deleteMeshes(idx);
 		meshDeleted = true;
 	}
-	const size_t n = _extractRegions.size();
-	for (size_t i = 0; i < n; ++i) {
-		if (_extractRegions[i].idx == idx) {
-			_extractRegions[i].idx = -1;
+	core::DynamicArray<glm::ivec4> removed;
+	for (const auto &iter : _extractRegions) {
+		if (iter->value.idx == idx) {
+			removed.push_back(iter->key);
 		}
 	}
+	for (const glm::ivec4 &key : removed) {
+		_extractRegions.remove(key);
+	}
 
 	return old;
 }
 
 core::DynamicArray<voxel::RawVolume *> MeshState::shutdown() {
 	_threadPool.shutdown();
-	clear();
+	_meshPool.release();
 	core::DynamicArray<voxel::RawVolume *> old;
-	old.reserve(MAX_VOLUMES);
-	for (int idx = 0; idx < (int)_volumeData.size(); ++idx) {
-		VolumeData &state = _volumeData[idx];
+	old.reserve(_volumeData.size());
+	for (const VolumeData *state : _volumeData) {
 		// hand over the ownership to the caller
-		old.push_back(state._rawVolume);
-		state._rawVolume = nullptr;
+		old.push_back(state != nullptr ? state->_rawVolume : nullptr);
 	}
+	freeVolumeData();
 	return old;
 }
 
 void MeshState::resetReferences() {
-	for (auto &s : _volumeData) {
-		s._reference = -1;
+	for (VolumeData *state : _volumeData) {
+		if (state != nullptr) {
+			state->_reference = -1;
+		}
 	}
 }
 
 int MeshState::reference(int idx) const {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
-		return -1;
-	}
-	return _volumeData[idx]._reference;
+	return volumeData(idx)._reference;
 }
 
 void MeshState::setReference(int idx, int referencedIdx) {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
+	if (idx < 0) {
 		return;
 	}
-	VolumeData &state = _volumeData[idx];
-	state._reference = referencedIdx;
+	createVolumeData(idx)._reference = referencedIdx;
 }
 
 bool MeshState::hidden(int idx) const {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
+	if (idx < 0) {
 		return true;
 	}
-	return _volumeData[idx]._hidden;
+	return volumeData(idx)._hidden;
 }
 
 void MeshState::hide(int idx, bool hide) {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
+	if (idx < 0) {
 		return;
 	}
-	_volumeData[idx]._hidden = hide;
+	VolumeData &state = createVolumeData(idx);
+	if (state._hidden != hide) {
+		// the chunks of hidden volumes are extracted last
+		_extractOrderDirty = true;
+	}
+	state._hidden = hide;
 }
 
 video::Face MeshState::cullFace(int idx) const {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
-		return video::Face::Back;
-	}
-	return _volumeData[idx]._cullFace;
+	return volumeData(idx)._cullFace;
 }
 
 void MeshState::setCullFace(int idx, video::Face face) {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
+	if (idx < 0) {
 		return;
 	}
-	_volumeData[idx]._cullFace = face;
+	createVolumeData(idx)._cullFace = face;
 }
 
 bool MeshState::grayed(int idx) const {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
+	if (idx < 0) {
 		return true;
 	}
-	return _volumeData[idx]._gray;
+	return volumeData(idx)._gray;
 }
 
 void MeshState::gray(int idx, bool gray) {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
+	if (idx < 0) {
 		return;
 	}
-	_volumeData[idx]._gray = gray;
+	createVolumeData(idx)._gray = gray;
 }
 
 } // namespace voxel
@@ -7,28 +7,35 @@
 #include "core/Optional.h"
 #include "core/SharedPtr.h"
 #include "core/Var.h"
-#include "core/collection/Array.h"
+#include "core/collection/DynamicArray.h"
 #include "core/collection/ConcurrentPriorityQueue.h"
-#include "core/collection/DynamicMap.h"
-#include "core/collection/PriorityQueue.h"
+#include "core/collection/ConcurrentQueue.h"
+#include "core/collection/ConcurrentRingBuffer.h"
+#include "core/collection/FlatMap.h"
 #include "core/concurrent/ThreadPool.h"
+#include "math/Frustum.h"
 #include "palette/NormalPalette.h"
 #include "palette/Palette.h"
 #include "video/Types.h"
 #include "voxel/ChunkMesh.h"
 #include "voxel/Mesh.h"
+#include "voxel/MeshCache.h"
 
 #include "core/GLM.h"
 #include "voxel/RawVolume.h"
 #include "voxel/SurfaceExtractor.h"
+#include <functional>
 #include <glm/mat4x4.hpp>
 
 namespace voxel {
 
-static constexpr int MAX_VOLUMES = 2048;
-
 enum MeshType { MeshType_Opaque, MeshType_Transparency, MeshType_Max };
 
+/**
+ * @brief The amount of mesh resolutions per chunk - level @c n has 1/2^n of the full resolution
+ */
+static constexpr int LODLevels = 4;
+
 /**
  * @brief Handles the mesh extraction of the volumes
  *
@@ -37,14 +44,20 @@ enum MeshType { MeshType_Opaque, MeshType_Transparency, MeshType_Max };
  */
 class MeshState {
 public:
-	typedef core::Array<voxel::Mesh *, MAX_VOLUMES> Meshes;
-	typedef core::DynamicMap<glm::ivec3, Meshes, 531, glm::hash<glm::ivec3>> MeshesMap;
+	/**
+	 * @brief The meshes of the chunks of one volume - keyed by the lower corner of the chunk
+	 */
+	typedef core::FlatMap<glm::ivec3, voxel::Mesh *, glm::hash<glm::ivec3>> MeshesMap;
 
 private:
 	struct VolumeData {
+		MeshesMap _meshes[MeshType_Max];
+		// the opaque meshes of the chunks for the levels of detail 1 and up
+		MeshesMap _lodMeshes[LODLevels - 1];
 		voxel::RawVolume *_rawVolume = nullptr;
-		core::Optional<palette::Palette> _palette;
-		core::Optional<palette::NormalPalette> _normalPalette;
+		// the palettes are owned by the scene graph nodes
+		const palette::Palette *_palette = nullptr;
+		const palette::NormalPalette *_normalPalette = nullptr;
 		bool _hidden = false;
 		bool _gray = false;
 		// if all axes scale positive: cull the back face
@@ -55,6 +68,8 @@ private:
 		glm::vec3 _pivot{0.0f};
 		glm::vec3 _mins{0.0f};
 		glm::vec3 _maxs{0.0f};
+		// the version of the volume at the last extraction run - see RawVolume::version()
+		uint64_t _extractVersion = 0u;
 		/**
 		 * @brief Applies the model matrix
 		 * @note Used for sorting (for transparency)
@@ -62,59 +77,281 @@ private:
 		glm::vec3 centerPos() const;
 		glm::vec3 centerPos(int x, int y, int z) const;
 	};
-	typedef core::Array<VolumeData, MAX_VOLUMES> Volumes;
+	/**
+	 * @brief The slots of the volumes - they are allocated on first use and grow with the highest used index
+	 */
+	core::DynamicArray<VolumeData *> _volumeData;
+	/**
+	 * @return The slot of the volume or an empty default slot if it wasn't used yet
+	 */
+	const VolumeData &volumeData(int idx) const;
+	/**
+	 * @brief Allocates the slot of the volume if needed
+	 * @note The index must not be negative
+	 */
+	VolumeData &createVolumeData(int idx);
+	/**
+	 * @brief Deletes the meshes and the slots of the volumes - the volumes are not deleted
+	 */
+	void freeVolumeData();
 
 	struct ExtractionCtx {
 		ExtractionCtx() {
 		}
-		ExtractionCtx(const glm::ivec3 &_mins, int _idx, voxel::ChunkMesh &&_mesh)
-			: mins(_mins), idx(_idx), mesh(_mesh) {
+		ExtractionCtx(const glm::ivec3 &_mins, int _idx, voxel::ChunkMesh &&_mesh, bool _patch,
+					  const voxel::Region &_region, uint64_t _scheduled, int _generation)
+			: mins(_mins), idx(_idx), mesh(core::move(_mesh)), patch(_patch), region(_region), scheduled(_scheduled),
+			  generation(_generation) {
 		}
 		glm::ivec3 mins{};
 		int idx = -1;
 		voxel::ChunkMesh mesh;
+		// the mesh only contains the faces of the bricks in the region - see spliceMeshes()
+		bool patch = false;
+		voxel::Region region{};
+		// the opaque meshes of the levels of detail 1 and up - empty if they were not extracted
+		core::DynamicArray<voxel::Mesh> lods;
+		// see ExtractRegion::scheduled
+		uint64_t scheduled = 0u;
+		// see ChunkJobs::generation
+		int generation = 0;
 
 		inline bool operator<(const ExtractionCtx &rhs) const {
 			return idx < rhs.idx;
 		}
 	};
 
-	MeshesMap _meshes[MeshType_Max];
-	Volumes _volumeData;
 	core::VarPtr _meshSize;
 
 	struct ExtractRegion {
-		ExtractRegion(const voxel::Region &_region, int _idx, bool _visible)
-			: region(_region), idx(_idx), visible(_visible) {
+		ExtractRegion(const voxel::Region &_region, const glm::ivec3 &_mins, int _idx, bool _patch)
+			: region(_region), mins(_mins), idx(_idx), patch(_patch) {
 		}
 		ExtractRegion() {
 		}
 		voxel::Region region{};
+		// the lower corner of the chunk the region belongs to
+		glm::ivec3 mins{};
 		int idx = 0;
-		bool visible = false;
-
-		inline bool operator<(const ExtractRegion &rhs) const {
-			return idx < rhs.idx && visible < rhs.visible;
+		// only the bricks in the region are extracted and replaced in the existing chunk mesh
+		bool patch = false;
+		// the millis of the first request that was collapsed into this one - see ExtractionStats
+		uint64_t scheduled = 0u;
+		// the order of the requests - chunks with the same priority are extracted first come first serve
+		uint64_t sequence = 0u;
+	};
+	// there is only one pending extraction per chunk (lower corner and volume index) - see addExtractRegion()
+	typedef core::FlatMap<glm::ivec4, ExtractRegion, glm::hash<glm::ivec4>> RegionMap;
+	RegionMap _extractRegions;
+
+	struct ExtractPriority {
+		glm::ivec4 key{0};
+		// 0 for chunks in the view frustum, 1 for chunks outside of it, 2 for hidden volumes
+		int tier = 0;
+		// the distance of the chunk center to the camera
+		float distance = 0.0f;
+		uint64_t sequence = 0u;
+
+		inline bool operator<(const ExtractPriority &rhs) const {
+			if (tier != rhs.tier) {
+				return tier < rhs.tier;
+			}
+			if (distance != rhs.distance) {
+				return distance < rhs.distance;
+			}
+			return sequence < rhs.sequence;
 		}
 	};
-	using RegionQueue = core::PriorityQueue<ExtractRegion>;
-	RegionQueue _extractRegions;
+	// the keys of the pending extractions - the one with the highest priority is the last entry
+	core::DynamicArray<ExtractPriority> _extractOrder;
+	// new chunks were added or the volumes were hidden - the order must be calculated again
+	bool _extractOrderDirty = false;
+	uint64_t _extractSequence = 0u;
+	uint64_t _lastPrioritizing = 0u;
+
+	// the extraction jobs of a chunk that were started but not yet handed over by pop()
+	struct ChunkJobs {
+		// the generation of the latest job - the jobs of older generations are superseded. Shared with the
+		// extraction tasks to not extract the meshes of superseded jobs at all.
+		core::SharedPtr<core::AtomicInt> generation;
+		// the region of all the started jobs
+		voxel::Region region{};
+		bool patch = true;
+		int jobs = 0;
+	};
+	typedef core::FlatMap<glm::ivec4, ChunkJobs, glm::hash<glm::ivec4>> ChunkJobsMap;
+	ChunkJobsMap _chunkJobs;
+
+	/**
+	 * @brief A job that is started for a chunk supersedes all the unfinished jobs of the chunk - its region is
+	 * extended to cover their regions, too.
+	 * @return The generation of the job
+	 */
+	int startChunkJob(ExtractRegion &extractRegion, core::SharedPtr<core::AtomicInt> &generation);
+	/**
+	 * @return @c false if the job was superseded by a newer job of the same chunk - the meshes must be dropped then
+	 */
+	bool finishChunkJob(const MeshState::ExtractionCtx &result);
+	/**
+	 * @brief Hands the result of an extraction task over to the main thread
+	 */
+	void pushResult(MeshState::ExtractionCtx &&result);
+	bool popResult(MeshState::ExtractionCtx &result);
+
+	bool _hasCamera = false;
+	bool _cameraMoved = false;
+	glm::vec3 _cameraPos{0.0f};
+	glm::mat4 _cameraViewProjection{1.0f};
+	math::Frustum _frustum;
+
+	/**
+	 * @brief Collapses the request with a pending extraction of the same chunk. A full extraction of the chunk
+	 * supersedes the patches, the regions of two patches are merged.
+	 */
+	void addExtractRegion(const voxel::Region &region, const glm::ivec3 &mins, int idx, bool patch,
+						  uint64_t scheduled);
+	/**
+	 * @brief Takes the pending extraction with the highest priority
+	 * @sa prioritizeExtractions()
+	 */
+	bool popExtractRegion(ExtractRegion &extractRegion);
+	/**
+	 * @brief Sorts the pending extractions by the visibility of the chunks and their distance to the camera
+	 */
+	void prioritizeExtractions();
+	int extractTier(const ExtractRegion &extractRegion, float &distance) const;
+	/**
+	 * @brief Records the latency of an extraction whose meshes are handed over by pop()
+	 */
+	void updateExtractionStats(uint64_t scheduled);
 
 	core::AtomicInt _runningExtractorTasks{0};
 	core::AtomicInt _pendingExtractorTasks{0};
 	voxel::Region calculateExtractRegion(int x, int y, int z, const glm::ivec3 &meshSize) const;
 	core::ThreadPool _threadPool{core::halfcpus(), "VolumeRndr"};
 	core::ConcurrentPriorityQueue<MeshState::ExtractionCtx> _pendingQueue;
+	// lock free hand over of the extraction task results - the priority queue takes the overflow
+	core::ConcurrentRingBuffer<MeshState::ExtractionCtx, 128> _finishedQueue;
+	// the buffers of replaced or deleted meshes - they are reused by the extraction tasks
+	core::ConcurrentQueue<voxel::Mesh> _meshPool;
 	core::VarPtr _meshMode;
+	core::VarPtr _meshLOD;
+	core::VarPtr _meshCacheVar;
+	core::VarPtr _meshCacheSize;
+	core::VarPtr _meshThreads;
+	core::VarPtr _aoVolume;
+	core::SharedPtr<voxel::MeshCache> _meshCache;
+	// opens the mesh cache in the home directory on the first call if cfg::VoxelMeshCache is enabled
+	bool useMeshCache();
+	// the state of extractLODs() at the last update() call
+	bool _extractingLODs = false;
 	bool deleteMeshes(const glm::ivec3 &pos, int idx);
 	void clear();
 	bool runScheduledExtractions(size_t maxExtraction = 1);
 	void waitForPendingExtractions();
 	bool deleteMeshes(int idx);
 	void addOrReplaceMeshes(MeshState::ExtractionCtx &result, MeshType type);
+	/**
+	 * @brief Replace the level of detail meshes of the chunk - the old meshes are removed if the result has none
+	 */
+	void replaceLODMeshes(MeshState::ExtractionCtx &result);
+	/**
+	 * @return @c true if the chunks should get extracted in the lower resolutions, too
+	 * @sa cfg::VoxelMeshLOD
+	 */
+	bool extractLODs() const;
+	/**
+	 * @brief Downsample the chunk and extract the opaque meshes of the levels of detail
+	 */
+	void extractLODs(const voxel::RawVolume &volume, const voxel::Region &chunkRegion,
+					 const palette::Palette &palette, core::DynamicArray<voxel::Mesh> &lods);
+	/**
+	 * @brief Replace the faces of the bricks of the result region in the existing chunk meshes
+	 * @return @c false if there are no meshes for the chunk
+	 */
+	bool spliceMeshes(MeshState::ExtractionCtx &result);
+	bool hasMeshes(const glm::ivec3 &mins, int idx) const;
+	/**
+	 * @return The size of the bricks the chunks are extracted in or @c 0 if the chunks are extracted as a whole
+	 */
+	int brickSize() const;
+	/**
+	 * @brief Take a mesh with already allocated buffers from the pool or create a new one
+	 */
+	void acquireMesh(voxel::Mesh &mesh);
+	/**
+	 * @brief Hand the buffers of the given mesh back to the pool - the mesh is empty afterwards
+	 */
+	void releaseMesh(voxel::Mesh &mesh);
+	void deleteMesh(voxel::Mesh *mesh);
+
+public:
+	/**
+	 * @brief Scales the source region down to half of its size into the destination volume
+	 * @note Called from the extraction threads
+	 */
+	typedef std::function<void(const voxel::RawVolume &source, const palette::Palette &palette,
+							   const voxel::Region &sourceRegion, voxel::RawVolume &dest)>
+		Downsampler;
+
+private:
+	Downsampler _downsampler;
 
 public:
-	const MeshesMap &meshes(MeshType type) const;
+	struct ExtractionStats {
+		// the amount of meshes that were handed over by pop() since init()
+		uint64_t extractions = 0u;
+		// the amount of requests that were collapsed with a pending extraction of the same chunk
+		uint64_t collapsed = 0u;
+		// the amount of started jobs whose meshes were dropped because a newer job of the same chunk was started
+		uint64_t superseded = 0u;
+		// the millis between the first request for a chunk and the hand over of its meshes by pop()
+		uint64_t lastLatencyMillis = 0u;
+		uint64_t maxLatencyMillis = 0u;
+		double averageLatencyMillis = 0.0;
+	};
+
+private:
+	ExtractionStats _extractionStats;
+
+public:
+	~MeshState();
+
+	/**
+	 * @brief The cubic meshes of the chunks are extracted in bricks of this size. A small modification only extracts
+	 * the affected bricks again and replaces their faces in the chunk mesh - the costs don't depend on the mesh size.
+	 */
+	static constexpr int BrickSize = 16;
+
+	const MeshesMap &meshes(MeshType type, int idx) const;
+	/**
+	 * @return The size of the chunks the volumes are extracted in
+	 */
+	int meshSize() const;
+	/**
+	 * @brief The opaque meshes of the given level of detail - level @c 0 are the full resolution meshes
+	 * @note The vertices are in the same coordinate space as the full resolution meshes. The meshes are closed at
+	 * the chunk borders and cover the voxels of the full resolution (and the adjacent voxels of the lower
+	 * neighbour chunks) to not show cracks next to chunks of another level.
+	 */
+	const MeshesMap &lodMeshes(int lod, int idx) const;
+	/**
+	 * @return The amount of volume slots - all the used volume indices are below this value
+	 */
+	int volumeSlots() const;
+	/**
+	 * @brief Enables the extraction of the levels of detail
+	 * @note Must be set before the extraction threads are running
+	 * @sa cfg::VoxelMeshLOD
+	 */
+	void setDownsampler(const Downsampler &downsampler);
+	/**
+	 * @brief Use the given archive for the mesh cache instead of the home directory
+	 * @note Must be set before the extraction threads are running - the cache is only used if
+	 * @c cfg::VoxelMeshCache is enabled
+	 * @sa cfg::VoxelMeshCacheSize
+	 */
+	void setMeshCache(const io::ArchivePtr &archive);
 	/**
 	 * @brief This will transfer the extracted meshes into the mesh state and make
 	 * it available to others
@@ -124,6 +361,13 @@ public:
 	const palette::Palette &palette(int idx) const;
 	const palette::NormalPalette &normalsPalette(int idx) const;
 
+	/**
+	 * @return The amount of meshes whose buffers are kept for the next extractions
+	 */
+	uint32_t pooledMeshes() const {
+		return _meshPool.size();
+	}
+
 	bool hasNormals() const {
 		return meshMode() == voxel::SurfaceExtractionType::MarchingCubes;
 	}
@@ -135,9 +379,33 @@ public:
 	 */
 	void extractAllPending();
 	/**
-	 * @return the amount of pending extractions
+	 * @brief Extracts the cubic mesh of the region on the calling thread - with the vertex positions translated to
+	 * the lower corner of the region
+	 * @return @c false if the region should get extracted by the surface extractor instead
+	 */
+	typedef std::function<bool(const voxel::RawVolume &volume, const voxel::Region &region, voxel::ChunkMesh &mesh)>
+		SyncExtractor;
+	/**
+	 * @brief Extracts all the pending regions with the given extractor if the cubic mesh mode is active. The regions
+	 * that the extractor refuses are extracted by the surface extractor afterwards.
+	 * @note This method is blocking
+	 */
+	void extractAllPending(const SyncExtractor &extractor);
+	/**
+	 * @return the amount of pending extractions - the queue depth
 	 */
 	int pendingExtractions() const;
+	/**
+	 * @return the amount of extractions that were started but whose meshes were not yet handed over by pop()
+	 */
+	int runningExtractions() const;
+	const ExtractionStats &extractionStats() const;
+	/**
+	 * @brief The pending extractions are prioritized by the visibility of the chunks in the view frustum and their
+	 * distance to the camera. Without a camera they are only prioritized by the hidden state of the volumes.
+	 * @note Call this before update() - the pending extractions are prioritized again if the camera was moved
+	 */
+	void setCamera(const glm::vec3 &position, const glm::mat4 &view, const glm::mat4 &projection);
 	void clearPendingExtractions();
 
 	/**
@@ -183,8 +451,8 @@ public:
 
 	bool sameNormalPalette(int idx, const palette::NormalPalette *palette) const;
 
-	[[nodiscard]] voxel::RawVolume *setVolume(int idx, voxel::RawVolume *volume, palette::Palette *palette,
-											  palette::NormalPalette *normalPalette, bool meshDelete,
+	[[nodiscard]] voxel::RawVolume *setVolume(int idx, voxel::RawVolume *volume, const palette::Palette *palette,
+											  const palette::NormalPalette *normalPalette, bool meshDelete,
 											  bool &meshDeleted);
 
 	/**
@@ -227,18 +495,32 @@ inline int MeshState::pendingExtractions() const {
 	return (int)_extractRegions.size();
 }
 
-inline voxel::RawVolume *MeshState::volume(int idx) {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
-		return nullptr;
+inline int MeshState::runningExtractions() const {
+	return _pendingExtractorTasks + (int)_pendingQueue.size() + (int)_finishedQueue.size();
+}
+
+inline const MeshState::ExtractionStats &MeshState::extractionStats() const {
+	return _extractionStats;
+}
+
+inline int MeshState::volumeSlots() const {
+	return (int)_volumeData.size();
+}
+
+inline const MeshState::VolumeData &MeshState::volumeData(int idx) const {
+	if (idx < 0 || idx >= (int)_volumeData.size() || _volumeData[idx] == nullptr) {
+		static const VolumeData empty;
+		return empty;
 	}
-	return _volumeData[idx]._rawVolume;
+	return *_volumeData[idx];
+}
+
+inline voxel::RawVolume *MeshState::volume(int idx) {
+	return volumeData(idx)._rawVolume;
 }
 
 inline const voxel::RawVolume *MeshState::volume(int idx) const {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
-		return nullptr;
-	}
-	return _volumeData[idx]._rawVolume;
+	return volumeData(idx)._rawVolume;
 }
 
 } // namespace voxel
@@ -39,15 +39,15 @@ public:
 	}
 
 	inline const Voxel &voxel(const glm::ivec3 &pos) const {
-		if (_modifications.hasVoxel(pos)) {
-			return _modifications.voxel(pos);
+		if (const Voxel *voxel = _modifications.findVoxel(pos)) {
+			return *voxel;
 		}
 		return _volume.voxel(pos.x, pos.y, pos.z);
 	}
 
 	inline const Voxel &voxel(int x, int y, int z) const {
-		if (_modifications.hasVoxel(x, y, z)) {
-			return _modifications.voxel(x, y, z);
+		if (const Voxel *voxel = _modifications.findVoxel({x, y, z})) {
+			return *voxel;
 		}
 		return _volume.voxel(x, y, z);
 	}
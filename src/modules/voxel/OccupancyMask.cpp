@@ -0,0 +1,218 @@
+/**
+ * @file
+ */
+
+#include "OccupancyMask.h"
+#include "RawVolume.h"
+#include "core/Assert.h"
+#include "core/Bits.h"
+#include "core/Trace.h"
+#include <glm/common.hpp>
+
+namespace voxel {
+
+// the bits from lower to upper (inclusive) set
+static inline uint64_t rangeMask(int lower, int upper) {
+	const uint64_t upperMask = upper >= 63 ? UINT64_MAX : (UINT64_C(1) << (upper + 1)) - 1u;
+	return upperMask & ~((UINT64_C(1) << lower) - 1u);
+}
+
+OccupancyMask::OccupancyMask(const RawVolume &volume)
+	: _dimensions(volume.width(), volume.height(), volume.depth()), _wordsPerRow((_dimensions.x + 63) / 64),
+	  _bricksY((_dimensions.y + BrickRows - 1) / BrickRows), _bricksZ((_dimensions.z + BrickRows - 1) / BrickRows) {
+	_bits.resize((size_t)_wordsPerRow * _dimensions.y * _dimensions.z);
+	_summary.resize(((size_t)_wordsPerRow * _bricksY * _bricksZ + 63) / 64);
+	rebuild(volume);
+}
+
+void OccupancyMask::setBrickSolid(int wordX, int brickY, int brickZ, bool solid) {
+	const size_t brick = brickIndex(wordX, brickY, brickZ);
+	const uint64_t bit = UINT64_C(1) << (brick & 63);
+	if (solid) {
+		_summary[brick >> 6] |= bit;
+	} else {
+		_summary[brick >> 6] &= ~bit;
+	}
+}
+
+void OccupancyMask::updateBrick(int wordX, int brickY, int brickZ) {
+	const int y0 = brickY * BrickRows;
+	const int z0 = brickZ * BrickRows;
+	const int y1 = glm::min(y0 + BrickRows, _dimensions.y);
+	const int z1 = glm::min(z0 + BrickRows, _dimensions.z);
+	uint64_t any = 0u;
+	for (int z = z0; z < z1; ++z) {
+		for (int y = y0; y < y1; ++y) {
+			any |= _bits[wordIndex(wordX * 64, y, z)];
+		}
+	}
+	setBrickSolid(wordX, brickY, brickZ, any != 0u);
+}
+
+void OccupancyMask::rebuildRow(const RawVolume &volume, int y, int z) {
+	core_assert(volume.width() == _dimensions.x && volume.height() == _dimensions.y &&
+				volume.depth() == _dimensions.z);
+	const Region &region = volume.region();
+	const Voxel *row = volume.row(region.getLowerCorner() + glm::ivec3(0, y, z));
+	uint64_t *words = &_bits[wordIndex(0, y, z)];
+	for (int w = 0; w < _wordsPerRow; ++w) {
+		const int x0 = w * 64;
+		const int n = glm::min(64, _dimensions.x - x0);
+		uint64_t word = 0u;
+		for (int x = 0; x < n; ++x) {
+			word |= (uint64_t)isBlocked(row[x0 + x].getMaterial()) << x;
+		}
+		words[w] = word;
+		updateBrick(w, y / BrickRows, z / BrickRows);
+	}
+}
+
+void OccupancyMask::rebuild(const RawVolume &volume) {
+	core_trace_scoped(OccupancyMaskRebuild);
+	for (int z = 0; z < _dimensions.z; ++z) {
+		for (int y = 0; y < _dimensions.y; ++y) {
+			rebuildRow(volume, y, z);
+		}
+	}
+}
+
+void OccupancyMask::set(int x, int y, int z, bool solid) {
+	uint64_t &word = _bits[wordIndex(x, y, z)];
+	const uint64_t bit = UINT64_C(1) << (x & 63);
+	if (solid) {
+		word |= bit;
+		setBrickSolid(x >> 6, y / BrickRows, z / BrickRows, true);
+		return;
+	}
+	word &= ~bit;
+	if (word == 0u) {
+		updateBrick(x >> 6, y / BrickRows, z / BrickRows);
+	}
+}
+
+void OccupancyMask::fill(bool solid) {
+	if (!solid) {
+		_bits.fill(0u);
+		_summary.fill(0u);
+		return;
+	}
+	for (int z = 0; z < _dimensions.z; ++z) {
+		for (int y = 0; y < _dimensions.y; ++y) {
+			uint64_t *words = &_bits[wordIndex(0, y, z)];
+			for (int w = 0; w < _wordsPerRow; ++w) {
+				words[w] = rangeMask(0, glm::min(63, _dimensions.x - 1 - w * 64));
+			}
+		}
+	}
+	for (int bz = 0; bz < _bricksZ; ++bz) {
+		for (int by = 0; by < _bricksY; ++by) {
+			for (int w = 0; w < _wordsPerRow; ++w) {
+				setBrickSolid(w, by, bz, true);
+			}
+		}
+	}
+}
+
+bool OccupancyMask::isEmpty() const {
+	for (uint64_t summary : _summary) {
+		if (summary != 0u) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool OccupancyMask::isEmpty(const glm::ivec3 &mins, const glm::ivec3 &maxs) const {
+	const glm::ivec3 lower = glm::max(mins, glm::ivec3(0));
+	const glm::ivec3 upper = glm::min(maxs, _dimensions - 1);
+	if (lower.x > upper.x || lower.y > upper.y || lower.z > upper.z) {
+		return true;
+	}
+	const int lowerWord = lower.x >> 6;
+	const int upperWord = upper.x >> 6;
+	for (int bz = lower.z / BrickRows; bz <= upper.z / BrickRows; ++bz) {
+		const int z0 = glm::max(lower.z, bz * BrickRows);
+		const int z1 = glm::min(upper.z, bz * BrickRows + BrickRows - 1);
+		for (int by = lower.y / BrickRows; by <= upper.y / BrickRows; ++by) {
+			const int y0 = glm::max(lower.y, by * BrickRows);
+			const int y1 = glm::min(upper.y, by * BrickRows + BrickRows - 1);
+			for (int w = lowerWord; w <= upperWord; ++w) {
+				if (!isBrickSolid(w, by, bz)) {
+					continue;
+				}
+				const uint64_t mask = rangeMask(w == lowerWord ? lower.x & 63 : 0, w == upperWord ? upper.x & 63 : 63);
+				for (int z = z0; z <= z1; ++z) {
+					for (int y = y0; y <= y1; ++y) {
+						if ((_bits[wordIndex(w * 64, y, z)] & mask) != 0u) {
+							return false;
+						}
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+int OccupancyMask::findSolid(int x, int y, int z, int upperX) const {
+	upperX = glm::min(upperX, _dimensions.x - 1);
+	if (x > upperX) {
+		return -1;
+	}
+	const uint64_t *words = &_bits[wordIndex(0, y, z)];
+	const int upperWord = upperX >> 6;
+	for (int w = x >> 6; w <= upperWord; ++w) {
+		uint64_t word = words[w];
+		if (w == (x >> 6)) {
+			word &= rangeMask(x & 63, 63);
+		}
+		if (word != 0u) {
+			const int solidX = w * 64 + core::countTrailingZeros(word);
+			return solidX <= upperX ? solidX : -1;
+		}
+	}
+	return -1;
+}
+
+bool OccupancyMask::bounds(glm::ivec3 &mins, glm::ivec3 &maxs) const {
+	core_trace_scoped(OccupancyMaskBounds);
+	glm::ivec3 lower(INT32_MAX);
+	glm::ivec3 upper(INT32_MIN);
+	for (int bz = 0; bz < _bricksZ; ++bz) {
+		const int z1 = glm::min(_dimensions.z, bz * BrickRows + BrickRows);
+		for (int by = 0; by < _bricksY; ++by) {
+			const int y1 = glm::min(_dimensions.y, by * BrickRows + BrickRows);
+			for (int w = 0; w < _wordsPerRow; ++w) {
+				if (!isBrickSolid(w, by, bz)) {
+					continue;
+				}
+				for (int z = bz * BrickRows; z < z1; ++z) {
+					for (int y = by * BrickRows; y < y1; ++y) {
+						const uint64_t word = _bits[wordIndex(w * 64, y, z)];
+						if (word == 0u) {
+							continue;
+						}
+						lower = glm::min(lower, glm::ivec3(w * 64 + core::countTrailingZeros(word), y, z));
+						upper = glm::max(upper, glm::ivec3(w * 64 + 63 - core::countLeadingZeros(word), y, z));
+					}
+				}
+			}
+		}
+	}
+	if (lower.x == INT32_MAX) {
+		return false;
+	}
+	mins = lower;
+	maxs = upper;
+	return true;
+}
+
+size_t OccupancyMask::solidVoxels() const {
+	size_t count = 0u;
+	for (uint64_t word : _bits) {
+		count += core::popCount(word);
+	}
+	return count;
+}
+
+} // namespace voxel
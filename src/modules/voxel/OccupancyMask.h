@@ -0,0 +1,138 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/vec3.hpp>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace voxel {
+
+class RawVolume;
+
+/**
+ * @brief One bit per voxel that tells whether the voxel is solid (not air)
+ *
+ * The bits of a row along the x axis are stored in 64 bit words. In addition there is one summary bit for each brick
+ * of 64x4x4 voxels that is set if any of the voxels in the brick is solid. This allows to skip empty space 64 voxels
+ * at once and whole bricks without touching the voxel data.
+ *
+ * @note All coordinates are local to the lower corner of the volume region - (0, 0, 0) to (width - 1, height - 1,
+ * depth - 1). The mask doesn't know about the position of the volume.
+ * @sa RawVolume::setOccupancyTracking()
+ */
+class OccupancyMask : public core::NonCopyable {
+public:
+	static constexpr int BrickWidth = 64;
+	static constexpr int BrickRows = 4;
+
+private:
+	glm::ivec3 _dimensions;
+	int _wordsPerRow;
+	int _bricksY;
+	int _bricksZ;
+	core::DynamicArray<uint64_t> _bits;
+	core::DynamicArray<uint64_t> _summary;
+
+	inline size_t wordIndex(int x, int y, int z) const {
+		return ((size_t)y + (size_t)z * _dimensions.y) * _wordsPerRow + (x >> 6);
+	}
+
+	inline size_t brickIndex(int wordX, int brickY, int brickZ) const {
+		return (size_t)wordX + ((size_t)brickY + (size_t)brickZ * _bricksY) * _wordsPerRow;
+	}
+
+	inline bool isBrickSolid(int wordX, int brickY, int brickZ) const {
+		const size_t brick = brickIndex(wordX, brickY, brickZ);
+		return (_summary[brick >> 6] & (UINT64_C(1) << (brick & 63))) != 0u;
+	}
+
+	void setBrickSolid(int wordX, int brickY, int brickZ, bool solid);
+	void updateBrick(int wordX, int brickY, int brickZ);
+
+public:
+	OccupancyMask(const RawVolume &volume);
+
+	/**
+	 * @brief Update all bits from the voxel data of the given volume - the dimensions must match
+	 */
+	void rebuild(const RawVolume &volume);
+	/**
+	 * @brief Update the bits of one row along the x axis from the voxel data of the given volume
+	 */
+	void rebuildRow(const RawVolume &volume, int y, int z);
+	void set(int x, int y, int z, bool solid);
+	/**
+	 * @brief Mark all voxels as solid or as air
+	 */
+	void fill(bool solid);
+
+	inline void set(const glm::ivec3 &pos, bool solid) {
+		set(pos.x, pos.y, pos.z, solid);
+	}
+
+	inline bool isSolid(int x, int y, int z) const {
+		return (_bits[wordIndex(x, y, z)] & (UINT64_C(1) << (x & 63))) != 0u;
+	}
+
+	inline bool isSolid(const glm::ivec3 &pos) const {
+		return isSolid(pos.x, pos.y, pos.z);
+	}
+
+	/**
+	 * @return @c true if there is no solid voxel in the brick that contains the given voxel
+	 * @sa brickMins()
+	 */
+	inline bool isBrickEmpty(int x, int y, int z) const {
+		return !isBrickSolid(x >> 6, y / BrickRows, z / BrickRows);
+	}
+
+	/**
+	 * @return The lower corner of the brick that contains the given voxel
+	 * @note The bricks at the upper border of the mask might be smaller than @c BrickWidth x @c BrickRows x
+	 * @c BrickRows
+	 */
+	inline glm::ivec3 brickMins(const glm::ivec3 &pos) const {
+		return glm::ivec3(pos.x & ~(BrickWidth - 1), pos.y / BrickRows * BrickRows, pos.z / BrickRows * BrickRows);
+	}
+
+	/**
+	 * @return @c true if there is no solid voxel in the given inclusive coordinates
+	 */
+	bool isEmpty(const glm::ivec3 &mins, const glm::ivec3 &maxs) const;
+	bool isEmpty() const;
+
+	/**
+	 * @brief Search the first solid voxel in the row at @c y and @c z in the inclusive range of @c x to @c upperX
+	 * @return The x coordinate of the solid voxel or @c -1 if there is none
+	 */
+	int findSolid(int x, int y, int z, int upperX) const;
+
+	/**
+	 * @brief Compute the inclusive bounds of all solid voxels
+	 * @return @c false if there is no solid voxel
+	 */
+	bool bounds(glm::ivec3 &mins, glm::ivec3 &maxs) const;
+
+	/**
+	 * @return The amount of solid voxels
+	 */
+	size_t solidVoxels() const;
+
+	inline const glm::ivec3 &dimensions() const {
+		return _dimensions;
+	}
+
+	/**
+	 * @return The amount of bytes that are needed to store the mask
+	 */
+	inline size_t size() const {
+		return (_bits.size() + _summary.size()) * sizeof(uint64_t);
+	}
+};
+
+} // namespace voxel
@@ -0,0 +1,273 @@
+/**
+ * @file
+ */
+
+#include "OctreeVolume.h"
+#include "RawVolume.h"
+#include "core/Assert.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/collection/FlatMap.h"
+#include "core/concurrent/Parallel.h"
+
+namespace voxel {
+
+namespace priv {
+
+struct OctreeNodeHasher {
+	inline size_t operator()(const OctreeVolume::Node &node) const {
+		size_t hash = 0u;
+		for (int i = 0; i < 8; ++i) {
+			hash = hash * 31u + node.children[i];
+		}
+		return hash;
+	}
+};
+
+struct OctreeNodeCompare {
+	inline bool operator()(const OctreeVolume::Node &lhs, const OctreeVolume::Node &rhs) const {
+		return core_memcmp(lhs.children, rhs.children, sizeof(lhs.children)) == 0;
+	}
+};
+
+static inline uint32_t voxelBits(const Voxel &voxel) {
+	uint32_t bits;
+	core_memcpy(&bits, &voxel, sizeof(bits));
+	return bits;
+}
+
+// the voxels outside of the region - a fresh RawVolume is cleared to zeros, too
+static inline Voxel paddingVoxel() {
+	Voxel voxel;
+	core_memset((void *)&voxel, 0, sizeof(voxel));
+	return voxel;
+}
+
+static inline glm::ivec3 octantOffset(int octant, int size) {
+	return glm::ivec3(octant & 1, (octant >> 1) & 1, (octant >> 2) & 1) * size;
+}
+
+} // namespace priv
+
+/**
+ * @brief Collects the unique nodes and voxels - the children of a node are always added before the node
+ */
+class OctreeVolume::Builder {
+private:
+	core::FlatMap<Node, uint32_t, priv::OctreeNodeHasher, priv::OctreeNodeCompare> _nodeMap;
+	core::FlatMap<uint32_t, uint32_t> _valueMap;
+
+public:
+	core::DynamicArray<Node> nodes;
+	core::DynamicArray<Voxel> values;
+
+	uint32_t value(const Voxel &voxel) {
+		const uint32_t bits = priv::voxelBits(voxel);
+		uint32_t idx;
+		if (!_valueMap.get(bits, idx)) {
+			idx = (uint32_t)values.size();
+			values.push_back(voxel);
+			_valueMap.put(bits, idx);
+		}
+		return UniformBit | idx;
+	}
+
+	uint32_t node(const Node &node) {
+		bool uniform = (node.children[0] & UniformBit) != 0u;
+		for (int i = 1; i < 8 && uniform; ++i) {
+			uniform = node.children[i] == node.children[0];
+		}
+		if (uniform) {
+			return node.children[0];
+		}
+		uint32_t idx;
+		if (!_nodeMap.get(node, idx)) {
+			idx = (uint32_t)nodes.size();
+			core_assert_msg(idx < UniformBit, "Too many octree nodes");
+			nodes.push_back(node);
+			_nodeMap.put(node, idx);
+		}
+		return idx;
+	}
+
+	uint32_t build(const RawVolume &volume, const glm::ivec3 &mins, int size) {
+		const Region &region = volume.region();
+		if (size == 1) {
+			if (!region.containsPoint(mins)) {
+				return value(priv::paddingVoxel());
+			}
+			return value(volume.voxel(mins));
+		}
+		if (!intersects(region, Region(mins, mins + (size - 1)))) {
+			return value(priv::paddingVoxel());
+		}
+		const int half = size / 2;
+		Node n;
+		for (int i = 0; i < 8; ++i) {
+			n.children[i] = build(volume, mins + priv::octantOffset(i, half), half);
+		}
+		return node(n);
+	}
+
+	/**
+	 * @brief Adds the nodes and voxels of the other builder that are not yet known
+	 * @return The given reference of the other builder mapped to this builder
+	 */
+	uint32_t merge(const Builder &other, uint32_t ref) {
+		core::DynamicArray<uint32_t> valueRefs;
+		valueRefs.reserve(other.values.size());
+		for (const Voxel &voxel : other.values) {
+			valueRefs.push_back(value(voxel));
+		}
+		core::DynamicArray<uint32_t> nodeRefs;
+		nodeRefs.reserve(other.nodes.size());
+		auto map = [&](uint32_t r) { return (r & UniformBit) ? valueRefs[r & ~UniformBit] : nodeRefs[r]; };
+		for (const Node &otherNode : other.nodes) {
+			Node n;
+			for (int i = 0; i < 8; ++i) {
+				n.children[i] = map(otherNode.children[i]);
+			}
+			nodeRefs.push_back(node(n));
+		}
+		return map(ref);
+	}
+};
+
+int OctreeVolume::brickSize() const {
+	return core_min(BrickSize, 1 << _depth);
+}
+
+OctreeVolume::OctreeVolume(const RawVolume &volume, core::ThreadPool *threadPool)
+	: LazyVolume(volume.region()), _borderVoxel(volume.borderValue()) {
+	core_trace_scoped(OctreeVolumeBuild);
+	const glm::ivec3 &dim = _region.getDimensionsInVoxels();
+	const int extent = core_max(dim.x, core_max(dim.y, dim.z));
+	while ((1 << _depth) < extent) {
+		++_depth;
+	}
+	const int size = brickSize();
+	const int bricks = (1 << _depth) / size;
+	const int brickCount = bricks * bricks * bricks;
+	const glm::ivec3 &mins = _region.getLowerCorner();
+
+	// the bricks are built with their own nodes - the shared subtrees of different bricks are found by the merge
+	core::DynamicArray<Builder *> builders;
+	builders.resize(brickCount);
+	core::DynamicArray<uint32_t> brickRefs;
+	brickRefs.resize(brickCount);
+	core::parallelFor(
+		threadPool, 0, brickCount,
+		[&](int from, int to) {
+			for (int i = from; i < to; ++i) {
+				const glm::ivec3 brick(i % bricks, (i / bricks) % bricks, i / (bricks * bricks));
+				builders[i] = new Builder();
+				brickRefs[i] = builders[i]->build(volume, mins + brick * size, size);
+			}
+		},
+		1);
+
+	Builder builder;
+	for (int i = 0; i < brickCount; ++i) {
+		brickRefs[i] = builder.merge(*builders[i], brickRefs[i]);
+		delete builders[i];
+	}
+
+	// the levels above the bricks
+	for (int n = bricks; n > 1; n /= 2) {
+		const int parents = n / 2;
+		core::DynamicArray<uint32_t> parentRefs;
+		parentRefs.resize(parents * parents * parents);
+		for (int i = 0; i < (int)parentRefs.size(); ++i) {
+			const glm::ivec3 parent(i % parents, (i / parents) % parents, i / (parents * parents));
+			Node node;
+			for (int c = 0; c < 8; ++c) {
+				const glm::ivec3 child = parent * 2 + priv::octantOffset(c, 1);
+				node.children[c] = brickRefs[child.x + child.y * n + child.z * n * n];
+			}
+			parentRefs[i] = builder.node(node);
+		}
+		brickRefs = core::move(parentRefs);
+	}
+	_root = brickRefs[0];
+	_nodes = core::move(builder.nodes);
+	_values = core::move(builder.values);
+	Log::debug("Octree volume with %i nodes and %i voxels for %i voxels", (int)_nodes.size(), (int)_values.size(),
+			   _region.voxels());
+}
+
+const Voxel &OctreeVolume::voxel(const glm::ivec3 &pos) const {
+	if (!_region.containsPoint(pos)) {
+		return _borderVoxel;
+	}
+	const glm::ivec3 local = pos - _region.getLowerCorner();
+	uint32_t ref = _root;
+	for (int level = _depth - 1; (ref & UniformBit) == 0u; --level) {
+		core_assert(level >= 0);
+		const int octant = ((local.x >> level) & 1) | (((local.y >> level) & 1) << 1) | (((local.z >> level) & 1) << 2);
+		ref = _nodes[ref].children[octant];
+	}
+	return _values[ref & ~UniformBit];
+}
+
+uint32_t OctreeVolume::brickRef(const glm::ivec3 &brick) const {
+	int levels = 0;
+	while ((brickSize() << levels) < (1 << _depth)) {
+		++levels;
+	}
+	uint32_t ref = _root;
+	for (int level = levels - 1; level >= 0 && (ref & UniformBit) == 0u; --level) {
+		const int octant = ((brick.x >> level) & 1) | (((brick.y >> level) & 1) << 1) | (((brick.z >> level) & 1) << 2);
+		ref = _nodes[ref].children[octant];
+	}
+	return ref;
+}
+
+void OctreeVolume::inflate(uint32_t ref, const glm::ivec3 &mins, int size, Voxel *data) const {
+	const glm::ivec3 &dim = _region.getDimensionsInVoxels();
+	if ((ref & UniformBit) == 0u) {
+		const Node &node = _nodes[ref];
+		const int half = size / 2;
+		for (int i = 0; i < 8; ++i) {
+			inflate(node.children[i], mins + priv::octantOffset(i, half), half, data);
+		}
+		return;
+	}
+	const Voxel &voxel = _values[ref & ~UniformBit];
+	if (priv::voxelBits(voxel) == 0u) {
+		// the volume is already cleared - this also skips the padding
+		return;
+	}
+	const glm::ivec3 maxs = glm::min(mins + size, dim);
+	for (int z = mins.z; z < maxs.z; ++z) {
+		for (int y = mins.y; y < maxs.y; ++y) {
+			Voxel *row = data + y * dim.x + z * dim.x * dim.y;
+			for (int x = mins.x; x < maxs.x; ++x) {
+				row[x] = voxel;
+			}
+		}
+	}
+}
+
+RawVolume *OctreeVolume::inflate(core::ThreadPool *threadPool) const {
+	core_trace_scoped(OctreeVolumeInflate);
+	RawVolume *volume = new RawVolume(_region);
+	volume->setBorderValue(_borderVoxel);
+	Voxel *data = volume->writableRow(_region.getLowerCorner());
+	const int size = brickSize();
+	const int bricks = (1 << _depth) / size;
+	const int brickCount = bricks * bricks * bricks;
+	// the bricks don't overlap - so they are written in parallel
+	core::parallelFor(
+		threadPool, 0, brickCount,
+		[&](int from, int to) {
+			for (int i = from; i < to; ++i) {
+				const glm::ivec3 brick(i % bricks, (i / bricks) % bricks, i / (bricks * bricks));
+				inflate(brickRef(brick), brick * size, size, data);
+			}
+		},
+		1);
+	return volume;
+}
+
+} // namespace voxel
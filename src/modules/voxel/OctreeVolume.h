@@ -0,0 +1,112 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "LazyVolume.h"
+#include "Voxel.h"
+#include "core/GLM.h"
+#include "core/collection/DynamicArray.h"
+
+namespace core {
+class ThreadPool;
+}
+
+namespace voxel {
+
+class RawVolume;
+
+/**
+ * @brief Read-only copy of a @c RawVolume as sparse voxel octree with shared subtrees (a directed acyclic graph)
+ *
+ * Subtrees that only contain one voxel are collapsed into a reference to that voxel, and identical subtrees are only
+ * stored once - no matter where they are located in the volume. Sparse models and models with a lot of repetition
+ * (scans, architecture) need a fraction of the memory of the expanded voxel data. The voxels can still be accessed
+ * without inflating the volume.
+ *
+ * The volume is converted brick by brick (see @c BrickSize) - the bricks are built and inflated in parallel if a
+ * thread pool is given.
+ *
+ * @sa CompressedVolume
+ * @sa RawVolume
+ */
+class OctreeVolume : public LazyVolume {
+public:
+	/**
+	 * @brief The side length of the subtrees that are converted in one task
+	 */
+	static constexpr int BrickSize = 32;
+
+	struct Node {
+		// the octants are indexed by x | y << 1 | z << 2
+		uint32_t children[8];
+	};
+
+private:
+	/**
+	 * @brief A child reference with this bit set is the index of the voxel of the whole subtree in @c _values -
+	 * otherwise it's the index of a node in @c _nodes
+	 */
+	static constexpr uint32_t UniformBit = 0x80000000u;
+
+	core::DynamicArray<Node> _nodes;
+	core::DynamicArray<Voxel> _values;
+	uint32_t _root = UniformBit;
+	// the octree covers a cube with a side length of 1 << _depth
+	int _depth = 0;
+	Voxel _borderVoxel;
+
+	class Builder;
+	int brickSize() const;
+	/**
+	 * @return The reference of the subtree of the given brick - might be a collapsed parent of the brick
+	 */
+	uint32_t brickRef(const glm::ivec3 &brick) const;
+	/**
+	 * @brief Writes the voxels of the subtree into the voxel data of a fresh volume of the region
+	 * @param mins The lower corner of the subtree relative to the lower corner of the region
+	 */
+	void inflate(uint32_t ref, const glm::ivec3 &mins, int size, Voxel *data) const;
+
+public:
+	OctreeVolume(const RawVolume &volume, core::ThreadPool *threadPool = nullptr);
+
+	/**
+	 * @return The voxel at the given position or the border voxel if the position is outside the region
+	 */
+	const Voxel &voxel(const glm::ivec3 &pos) const;
+
+	/**
+	 * @brief Create a new RawVolume instance with the uncompressed voxel data
+	 * @note It's the callers responsibility to properly release the memory.
+	 */
+	[[nodiscard]] RawVolume *inflate(core::ThreadPool *threadPool = nullptr) const;
+
+	[[nodiscard]] RawVolume *load() const override {
+		return inflate();
+	}
+
+	/**
+	 * @return The amount of unique nodes of the octree
+	 */
+	inline size_t nodes() const {
+		return _nodes.size();
+	}
+
+	/**
+	 * @return The amount of unique voxels of the volume
+	 */
+	inline size_t values() const {
+		return _values.size();
+	}
+
+	/**
+	 * @return The amount of bytes that are needed to store the octree
+	 */
+	inline size_t size() const override {
+		return _nodes.size() * sizeof(Node) + _values.size() * sizeof(Voxel);
+	}
+};
+
+} // namespace voxel
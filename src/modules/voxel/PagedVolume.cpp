@@ -0,0 +1,310 @@
+/**
+ * @file
+ */
+
+#include "PagedVolume.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
+
+namespace voxel {
+
+static constexpr size_t BrickBytes = PagedVolume::BrickVoxels * sizeof(Voxel);
+
+const Voxel *PagedVolume::airBrick() {
+	// zero initialized - this is the same state a cleared RawVolume has
+	alignas(Voxel) static const uint8_t data[BrickBytes] = {};
+	return (const Voxel *)data;
+}
+
+PagedVolume::PagedVolume(const Region &region) : _region(region) {
+	core_assert_msg(width() > 0, "Volume width must be greater than zero.");
+	core_assert_msg(height() > 0, "Volume height must be greater than zero.");
+	core_assert_msg(depth() > 0, "Volume depth must be greater than zero.");
+	_bricksPerAxis.x = (width() + BrickMask) >> BrickShift;
+	_bricksPerAxis.y = (height() + BrickMask) >> BrickShift;
+	_bricksPerAxis.z = (depth() + BrickMask) >> BrickShift;
+	_bricks.resize((size_t)_bricksPerAxis.x * _bricksPerAxis.y * _bricksPerAxis.z);
+}
+
+PagedVolume::PagedVolume(PagedVolume &&move) noexcept
+	: _region(move._region), _bricksPerAxis(move._bricksPerAxis), _borderVoxel(move._borderVoxel),
+	  _bricks(core::move(move._bricks)) {
+	move._bricks.clear();
+}
+
+PagedVolume::~PagedVolume() {
+	clear();
+}
+
+size_t PagedVolume::size() const {
+	return (size_t)allocatedBricks() * BrickBytes;
+}
+
+int PagedVolume::allocatedBricks() const {
+	int n = 0;
+	for (const Voxel *brick : _bricks) {
+		if (brick != nullptr) {
+			++n;
+		}
+	}
+	return n;
+}
+
+void PagedVolume::setBorderValue(const Voxel &voxel) {
+	_borderVoxel = voxel;
+}
+
+bool PagedVolume::setVoxel(int32_t x, int32_t y, int32_t z, const Voxel &voxel) {
+	if (!_region.containsPoint(x, y, z)) {
+		return false;
+	}
+	const int32_t lx = x - _region.getLowerX();
+	const int32_t ly = y - _region.getLowerY();
+	const int32_t lz = z - _region.getLowerZ();
+	const int idx = voxelIndex(lx, ly, lz);
+	Voxel *&brick = _bricks[brickIndex(lx, ly, lz)];
+	if (brick == nullptr) {
+		// writing air into the shared air brick doesn't need any allocation
+		if (isAir(voxel.getMaterial())) {
+			return false;
+		}
+		brick = (Voxel *)core_malloc(BrickBytes);
+		core_assert_msg_always(brick != nullptr, "Failed to allocate a brick for the volume");
+		core_memset((void *)brick, 0, BrickBytes);
+	} else if (brick[idx].isSame(voxel)) {
+		return false;
+	}
+	brick[idx] = voxel;
+	return true;
+}
+
+void PagedVolume::clear() {
+	for (Voxel *&brick : _bricks) {
+		core_free(brick);
+		brick = nullptr;
+	}
+}
+
+void PagedVolume::fill(const voxel::Voxel &voxel) {
+	if (isAir(voxel.getMaterial())) {
+		clear();
+		return;
+	}
+	for (Voxel *&brick : _bricks) {
+		if (brick == nullptr) {
+			brick = (Voxel *)core_malloc(BrickBytes);
+			core_assert_msg_always(brick != nullptr, "Failed to allocate a brick for the volume");
+		}
+		for (int i = 0; i < BrickVoxels; ++i) {
+			brick[i] = voxel;
+		}
+	}
+}
+
+int PagedVolume::compact() {
+	int released = 0;
+	for (Voxel *&brick : _bricks) {
+		if (brick == nullptr) {
+			continue;
+		}
+		bool onlyAir = true;
+		for (int i = 0; i < BrickVoxels; ++i) {
+			if (!isAir(brick[i].getMaterial())) {
+				onlyAir = false;
+				break;
+			}
+		}
+		if (!onlyAir) {
+			continue;
+		}
+		core_free(brick);
+		brick = nullptr;
+		++released;
+	}
+	return released;
+}
+
+Region PagedVolume::solidRegion() const {
+	glm::ivec3 mins(INT32_MAX);
+	glm::ivec3 maxs(INT32_MIN);
+	const int bricksPerSlice = _bricksPerAxis.x * _bricksPerAxis.y;
+	for (int i = 0; i < (int)_bricks.size(); ++i) {
+		const Voxel *brick = _bricks[i];
+		if (brick == nullptr) {
+			continue;
+		}
+		const glm::ivec3 brickMins = _region.getLowerCorner() + glm::ivec3(i % _bricksPerAxis.x,
+																		   (i / _bricksPerAxis.x) % _bricksPerAxis.y,
+																		   i / bricksPerSlice) * BrickSize;
+		for (int idx = 0; idx < BrickVoxels; ++idx) {
+			if (isAir(brick[idx].getMaterial())) {
+				continue;
+			}
+			const glm::ivec3 pos = brickMins + glm::ivec3(idx & BrickMask, (idx >> BrickShift) & BrickMask,
+														  idx >> (BrickShift * 2));
+			mins = glm::min(mins, pos);
+			maxs = glm::max(maxs, pos);
+		}
+	}
+	if (mins.x > maxs.x) {
+		return Region::InvalidRegion;
+	}
+	return Region(mins, maxs);
+}
+
+PagedVolume::Sampler::Sampler(const PagedVolume *volume)
+	: _volume(const_cast<PagedVolume *>(volume)), _region(volume->region()) {
+}
+
+PagedVolume::Sampler::Sampler(const PagedVolume &volume)
+	: _volume(const_cast<PagedVolume *>(&volume)), _region(volume.region()) {
+}
+
+PagedVolume::Sampler::~Sampler() {
+}
+
+bool PagedVolume::Sampler::setVoxel(const Voxel &voxel) {
+	if (_currentPositionInvalid) {
+		return false;
+	}
+	_volume->setVoxel(_posInVolume, voxel);
+	// the write might have allocated the brick
+	updateBrick();
+	return true;
+}
+
+void PagedVolume::Sampler::updateInterior() {
+	const glm::ivec3 &lowerCorner = _region.getLowerCorner();
+	const glm::ivec3 &upperCorner = _region.getUpperCorner();
+	_interior = glm::all(glm::greaterThan(_posInBrick, glm::ivec3(0))) &&
+				glm::all(glm::lessThan(_posInBrick, glm::ivec3(BrickMask))) &&
+				glm::all(glm::greaterThan(_posInVolume, lowerCorner)) &&
+				glm::all(glm::lessThan(_posInVolume, upperCorner));
+}
+
+void PagedVolume::Sampler::updateBrick() {
+	if (!currentPositionValid()) {
+		_currentVoxel = nullptr;
+		_interior = false;
+		return;
+	}
+	const glm::ivec3 &lowerCorner = _region.getLowerCorner();
+	const int32_t lx = _posInVolume.x - lowerCorner.x;
+	const int32_t ly = _posInVolume.y - lowerCorner.y;
+	const int32_t lz = _posInVolume.z - lowerCorner.z;
+	_posInBrick.x = lx & BrickMask;
+	_posInBrick.y = ly & BrickMask;
+	_posInBrick.z = lz & BrickMask;
+	_currentVoxel = _volume->brick(lx, ly, lz) + voxelIndex(lx, ly, lz);
+	updateInterior();
+}
+
+bool PagedVolume::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos) {
+	_posInVolume.x = xPos;
+	_posInVolume.y = yPos;
+	_posInVolume.z = zPos;
+
+	const voxel::Region &region = this->region();
+	_currentPositionInvalid = 0u;
+	if (!region.containsPointInX(xPos)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDX;
+	}
+	if (!region.containsPointInY(yPos)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDY;
+	}
+	if (!region.containsPointInZ(zPos)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDZ;
+	}
+
+	updateBrick();
+	return currentPositionValid();
+}
+
+void PagedVolume::Sampler::move(int axis, int32_t delta) {
+	static const uint8_t invalidFlags[] = {SAMPLER_INVALIDX, SAMPLER_INVALIDY, SAMPLER_INVALIDZ};
+	static const int32_t brickStrides[] = {1, BrickSize, BrickSize * BrickSize};
+	const bool oldPositionValid = currentPositionValid();
+
+	_posInVolume[axis] += delta;
+	if (_posInVolume[axis] < _region.getLowerCorner()[axis] || _posInVolume[axis] > _region.getUpperCorner()[axis]) {
+		_currentPositionInvalid |= invalidFlags[axis];
+	} else {
+		_currentPositionInvalid &= ~invalidFlags[axis];
+	}
+
+	if (!currentPositionValid()) {
+		_currentVoxel = nullptr;
+		_interior = false;
+		return;
+	}
+	const int32_t posInBrick = _posInBrick[axis] + delta;
+	if (oldPositionValid && (posInBrick & ~BrickMask) == 0) {
+		// still in the same brick
+		_posInBrick[axis] = posInBrick;
+		_currentVoxel += (intptr_t)(delta * brickStrides[axis]);
+		updateInterior();
+		return;
+	}
+	updateBrick();
+}
+
+void PagedVolume::Sampler::movePositive(math::Axis axis, uint32_t offset) {
+	switch (axis) {
+	case math::Axis::X:
+		movePositiveX(offset);
+		break;
+	case math::Axis::Y:
+		movePositiveY(offset);
+		break;
+	case math::Axis::Z:
+		movePositiveZ(offset);
+		break;
+	default:
+		break;
+	}
+}
+
+void PagedVolume::Sampler::movePositiveX(uint32_t offset) {
+	move(0, (int32_t)offset);
+}
+
+void PagedVolume::Sampler::movePositiveY(uint32_t offset) {
+	move(1, (int32_t)offset);
+}
+
+void PagedVolume::Sampler::movePositiveZ(uint32_t offset) {
+	move(2, (int32_t)offset);
+}
+
+void PagedVolume::Sampler::moveNegative(math::Axis axis, uint32_t offset) {
+	switch (axis) {
+	case math::Axis::X:
+		moveNegativeX(offset);
+		break;
+	case math::Axis::Y:
+		moveNegativeY(offset);
+		break;
+	case math::Axis::Z:
+		moveNegativeZ(offset);
+		break;
+	default:
+		break;
+	}
+}
+
+void PagedVolume::Sampler::moveNegativeX(uint32_t offset) {
+	move(0, -(int32_t)offset);
+}
+
+void PagedVolume::Sampler::moveNegativeY(uint32_t offset) {
+	move(1, -(int32_t)offset);
+}
+
+void PagedVolume::Sampler::moveNegativeZ(uint32_t offset) {
+	move(2, -(int32_t)offset);
+}
+
+} // namespace voxel
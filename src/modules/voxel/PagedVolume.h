@@ -0,0 +1,467 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Region.h"
+#include "Voxel.h"
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+#include "math/Axis.h"
+#include "voxelutil/VolumeVisitor.h"
+#include <glm/vec3.hpp>
+
+namespace voxel {
+
+/**
+ * Volume implementation that splits the region into fixed size bricks. A brick is only allocated on the first write
+ * of a non-air voxel - all unallocated bricks share one read-only all-air brick. This keeps the memory footprint of
+ * large, mostly empty volumes (e.g. minecraft region imports) proportional to the amount of set voxels.
+ *
+ * The volume exposes the same @c Sampler interface as @c RawVolume, so templated code like
+ * @c voxelutil::visitVolume() can work on it unchanged.
+ *
+ * @sa RawVolume
+ * @sa SparseVolume
+ */
+class PagedVolume : public core::NonCopyable {
+public:
+	static constexpr int BrickShift = 4;
+	/** The edge length of a cubic brick in voxels */
+	static constexpr int BrickSize = 1 << BrickShift;
+	static constexpr int BrickMask = BrickSize - 1;
+	static constexpr int BrickVoxels = BrickSize * BrickSize * BrickSize;
+
+	class Sampler {
+	private:
+		static const uint8_t SAMPLER_INVALIDX = 1 << 0;
+		static const uint8_t SAMPLER_INVALIDY = 1 << 1;
+		static const uint8_t SAMPLER_INVALIDZ = 1 << 2;
+
+		/**
+		 * @brief Looks up a neighbour voxel - stays inside the current brick if possible and falls back to the
+		 * volume lookup if the neighbour lives in another brick or outside of the volume region.
+		 */
+		const Voxel &peek(int dx, int dy, int dz) const;
+		/**
+		 * @brief Resolves the brick for the current position
+		 */
+		void updateBrick();
+		void updateInterior();
+		void move(int axis, int32_t delta);
+
+	public:
+		Sampler(const PagedVolume &volume);
+		Sampler(const PagedVolume *volume);
+		virtual ~Sampler();
+
+		const Voxel &voxel() const;
+		const Region &region() const;
+
+		bool currentPositionValid() const;
+
+		bool setPosition(const glm::ivec3 &pos);
+		bool setPosition(int32_t x, int32_t y, int32_t z);
+		virtual bool setVoxel(const Voxel &voxel);
+		const glm::ivec3 &position() const;
+
+		void movePositiveX(uint32_t offset = 1);
+		void movePositiveY(uint32_t offset = 1);
+		void movePositiveZ(uint32_t offset = 1);
+		void movePositive(math::Axis axis, uint32_t offset = 1);
+
+		void moveNegativeX(uint32_t offset = 1);
+		void moveNegativeY(uint32_t offset = 1);
+		void moveNegativeZ(uint32_t offset = 1);
+		void moveNegative(math::Axis axis, uint32_t offset = 1);
+
+		const Voxel &peekVoxel1nx1ny1nz() const;
+		const Voxel &peekVoxel1nx1ny0pz() const;
+		const Voxel &peekVoxel1nx1ny1pz() const;
+		const Voxel &peekVoxel1nx0py1nz() const;
+		const Voxel &peekVoxel1nx0py0pz() const;
+		const Voxel &peekVoxel1nx0py1pz() const;
+		const Voxel &peekVoxel1nx1py1nz() const;
+		const Voxel &peekVoxel1nx1py0pz() const;
+		const Voxel &peekVoxel1nx1py1pz() const;
+
+		const Voxel &peekVoxel0px1ny1nz() const;
+		const Voxel &peekVoxel0px1ny0pz() const;
+		const Voxel &peekVoxel0px1ny1pz() const;
+		const Voxel &peekVoxel0px0py1nz() const;
+		const Voxel &peekVoxel0px0py0pz() const;
+		const Voxel &peekVoxel0px0py1pz() const;
+		const Voxel &peekVoxel0px1py1nz() const;
+		const Voxel &peekVoxel0px1py0pz() const;
+		const Voxel &peekVoxel0px1py1pz() const;
+
+		const Voxel &peekVoxel1px1ny1nz() const;
+		const Voxel &peekVoxel1px1ny0pz() const;
+		const Voxel &peekVoxel1px1ny1pz() const;
+		const Voxel &peekVoxel1px0py1nz() const;
+		const Voxel &peekVoxel1px0py0pz() const;
+		const Voxel &peekVoxel1px0py1pz() const;
+		const Voxel &peekVoxel1px1py1nz() const;
+		const Voxel &peekVoxel1px1py0pz() const;
+		const Voxel &peekVoxel1px1py1pz() const;
+
+	protected:
+		PagedVolume *_volume;
+
+		voxel::Region _region;
+
+		// The current position in the volume
+		glm::ivec3 _posInVolume{0, 0, 0};
+
+		// The current position inside the current brick
+		glm::ivec3 _posInBrick{0, 0, 0};
+
+		/** Points into the current brick - this might be the shared air brick */
+		const Voxel *_currentVoxel = nullptr;
+
+		/** Whether the current position is inside the volume */
+		uint8_t _currentPositionInvalid = 0u;
+
+		/** All 26 neighbours are inside of the current brick and the volume region */
+		bool _interior = false;
+	};
+
+	/// Constructor for creating a fixed size volume - no brick is allocated here
+	PagedVolume(const Region &region);
+	PagedVolume(PagedVolume &&move) noexcept;
+	~PagedVolume();
+
+	/**
+	 * @return The amount of bytes that are currently allocated for the bricks
+	 */
+	size_t size() const;
+
+	/**
+	 * @return The amount of bricks that hold voxel data
+	 */
+	int allocatedBricks() const;
+
+	/**
+	 * @return The amount of bricks that are needed to cover the whole region
+	 */
+	inline int bricks() const {
+		return (int)_bricks.size();
+	}
+
+	/**
+	 * The border value is returned whenever an attempt is made to read a voxel which
+	 * is outside the extents of the volume.
+	 * @return The value used for voxels outside of the volume
+	 */
+	const Voxel &borderValue() const;
+
+	/**
+	 * Sets the value used for voxels which are outside the volume
+	 */
+	void setBorderValue(const Voxel &voxel);
+
+	/**
+	 * @return A Region representing the extent of the volume.
+	 */
+	const Region &region() const;
+
+	/**
+	 * @return The width of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g.
+	 * 0 to 63 then the width is 64.
+	 * @sa height(), getDepth()
+	 */
+	int32_t width() const;
+	/**
+	 * @return The height of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g.
+	 * 0 to 63 then the height is 64.
+	 * @sa width(), getDepth()
+	 */
+	int32_t height() const;
+	/**
+	 * @return The depth of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g.
+	 * 0 to 63 then the depth is 64.
+	 * @sa width(), height()
+	 */
+	int32_t depth() const;
+
+	/**
+	 * Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+	 */
+	const Voxel &voxel(int32_t x, int32_t y, int32_t z) const;
+	inline const Voxel &voxel(const glm::ivec3 &pos) const {
+		return voxel(pos.x, pos.y, pos.z);
+	}
+
+	/**
+	 * Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
+	 * @return @c true if the voxel was placed, @c false if it was already the same voxel or outside the region
+	 */
+	bool setVoxel(int32_t x, int32_t y, int32_t z, const Voxel &voxel);
+	inline bool setVoxel(const glm::ivec3 &pos, const Voxel &voxel) {
+		return setVoxel(pos.x, pos.y, pos.z, voxel);
+	}
+
+	/**
+	 * @brief Releases all bricks
+	 */
+	void clear();
+	void fill(const voxel::Voxel &voxel);
+
+	/**
+	 * @brief Releases all bricks that only contain air voxels
+	 * @return The amount of released bricks
+	 */
+	int compact();
+
+	/**
+	 * @brief The exact bounds of all solid voxels in this volume
+	 * @note Only the allocated bricks are checked
+	 * @return Region::InvalidRegion if there is no solid voxel
+	 */
+	Region solidRegion() const;
+
+	/**
+	 * @brief Shift the region of the volume by the given coordinates
+	 */
+	void translate(const glm::ivec3 &t) {
+		_region.shift(t.x, t.y, t.z);
+	}
+
+	template<class Volume>
+	void copyTo(Volume &target) const {
+		auto visitor = [&target](int x, int y, int z, const voxel::Voxel &voxel) { target.setVoxel(x, y, z, voxel); };
+		voxelutil::visitVolume(*this, visitor);
+	}
+
+	template<class Volume>
+	void copyFrom(const Volume &source) {
+		voxel::Region region = source.region();
+		region.cropTo(_region);
+		auto visitor = [this](int x, int y, int z, const voxel::Voxel &voxel) { setVoxel(x, y, z, voxel); };
+		voxelutil::visitVolume(source, region, 1, 1, 1, visitor);
+	}
+
+private:
+	friend class Sampler;
+
+	/**
+	 * @return The shared read-only brick for unallocated bricks - all voxels are air
+	 */
+	static const Voxel *airBrick();
+
+	inline int brickIndex(int32_t lx, int32_t ly, int32_t lz) const {
+		return (lx >> BrickShift) + (ly >> BrickShift) * _bricksPerAxis.x +
+			   (lz >> BrickShift) * _bricksPerAxis.x * _bricksPerAxis.y;
+	}
+
+	static inline int voxelIndex(int32_t lx, int32_t ly, int32_t lz) {
+		return (lx & BrickMask) + (ly & BrickMask) * BrickSize + (lz & BrickMask) * BrickSize * BrickSize;
+	}
+
+	/**
+	 * @param lx The x coordinate relative to the lower corner of the region
+	 */
+	const Voxel *brick(int32_t lx, int32_t ly, int32_t lz) const;
+
+	/** The size of the volume */
+	Region _region;
+
+	/** The amount of bricks in each direction */
+	glm::ivec3 _bricksPerAxis{0};
+
+	/** The border value */
+	Voxel _borderVoxel;
+
+	/** nullptr entries are not yet allocated and are represented by the air brick */
+	core::DynamicArray<Voxel *> _bricks;
+};
+
+inline const Region &PagedVolume::region() const {
+	return _region;
+}
+
+inline const Voxel &PagedVolume::borderValue() const {
+	return _borderVoxel;
+}
+
+inline int32_t PagedVolume::width() const {
+	return _region.getWidthInVoxels();
+}
+
+inline int32_t PagedVolume::height() const {
+	return _region.getHeightInVoxels();
+}
+
+inline int32_t PagedVolume::depth() const {
+	return _region.getDepthInVoxels();
+}
+
+inline const Voxel *PagedVolume::brick(int32_t lx, int32_t ly, int32_t lz) const {
+	const Voxel *data = _bricks[brickIndex(lx, ly, lz)];
+	if (data == nullptr) {
+		return airBrick();
+	}
+	return data;
+}
+
+inline const Voxel &PagedVolume::voxel(int32_t x, int32_t y, int32_t z) const {
+	if (_region.containsPoint(x, y, z)) {
+		const int32_t lx = x - _region.getLowerX();
+		const int32_t ly = y - _region.getLowerY();
+		const int32_t lz = z - _region.getLowerZ();
+		return brick(lx, ly, lz)[voxelIndex(lx, ly, lz)];
+	}
+	return _borderVoxel;
+}
+
+inline const Region &PagedVolume::Sampler::region() const {
+	return _region;
+}
+
+inline const glm::ivec3 &PagedVolume::Sampler::position() const {
+	return _posInVolume;
+}
+
+inline bool PagedVolume::Sampler::currentPositionValid() const {
+	return !_currentPositionInvalid;
+}
+
+inline const Voxel &PagedVolume::Sampler::voxel() const {
+	if (this->currentPositionValid()) {
+		return *_currentVoxel;
+	}
+	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y, this->_posInVolume.z);
+}
+
+inline bool PagedVolume::Sampler::setPosition(const glm::ivec3 &v3dNewPos) {
+	return setPosition(v3dNewPos.x, v3dNewPos.y, v3dNewPos.z);
+}
+
+inline const Voxel &PagedVolume::Sampler::peek(int dx, int dy, int dz) const {
+	if (_interior) {
+		return *(_currentVoxel + dx + dy * BrickSize + dz * BrickSize * BrickSize);
+	}
+	const int32_t x = _posInVolume.x + dx;
+	const int32_t y = _posInVolume.y + dy;
+	const int32_t z = _posInVolume.z + dz;
+	if (this->currentPositionValid()) {
+		const int32_t bx = _posInBrick.x + dx;
+		const int32_t by = _posInBrick.y + dy;
+		const int32_t bz = _posInBrick.z + dz;
+		if (((bx | by | bz) & ~BrickMask) == 0 && _region.containsPoint(x, y, z)) {
+			return *(_currentVoxel + dx + dy * BrickSize + dz * BrickSize * BrickSize);
+		}
+	}
+	return this->_volume->voxel(x, y, z);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1nx1ny1nz() const {
+	return peek(-1, -1, -1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1nx1ny0pz() const {
+	return peek(-1, -1, 0);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1nx1ny1pz() const {
+	return peek(-1, -1, 1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1nx0py1nz() const {
+	return peek(-1, 0, -1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1nx0py0pz() const {
+	return peek(-1, 0, 0);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1nx0py1pz() const {
+	return peek(-1, 0, 1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1nx1py1nz() const {
+	return peek(-1, 1, -1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1nx1py0pz() const {
+	return peek(-1, 1, 0);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1nx1py1pz() const {
+	return peek(-1, 1, 1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel0px1ny1nz() const {
+	return peek(0, -1, -1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel0px1ny0pz() const {
+	return peek(0, -1, 0);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel0px1ny1pz() const {
+	return peek(0, -1, 1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel0px0py1nz() const {
+	return peek(0, 0, -1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel0px0py0pz() const {
+	return voxel();
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel0px0py1pz() const {
+	return peek(0, 0, 1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel0px1py1nz() const {
+	return peek(0, 1, -1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel0px1py0pz() const {
+	return peek(0, 1, 0);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel0px1py1pz() const {
+	return peek(0, 1, 1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1px1ny1nz() const {
+	return peek(1, -1, -1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1px1ny0pz() const {
+	return peek(1, -1, 0);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1px1ny1pz() const {
+	return peek(1, -1, 1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1px0py1nz() const {
+	return peek(1, 0, -1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1px0py0pz() const {
+	return peek(1, 0, 0);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1px0py1pz() const {
+	return peek(1, 0, 1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1px1py1nz() const {
+	return peek(1, 1, -1);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1px1py0pz() const {
+	return peek(1, 1, 0);
+}
+
+inline const Voxel &PagedVolume::Sampler::peekVoxel1px1py1pz() const {
+	return peek(1, 1, 1);
+}
+
+} // namespace voxel
@@ -3,10 +3,14 @@
  */
 
 #include "RawVolume.h"
+#include "OccupancyMask.h"
 #include "core/Assert.h"
+#include "core/Hash.h"
+#include "core/MemoryTracker.h"
 #include "core/StandardLib.h"
 #include <glm/common.hpp>
 #include <limits>
+#include <thread>
 
 namespace voxel {
 
@@ -26,22 +30,79 @@ RawVolume::RawVolume(const Region &regValid) : _region(regValid) {
 RawVolume::RawVolume(const RawVolume *copy) : _region(copy->region()) {
 	setBorderValue(copy->borderValue());
 	const size_t size = RawVolume::size(_region);
-	_data = (Voxel *)core_malloc(size);
+	_data = (Voxel *)core::memoryAlloc(core::MemoryTag::Volume, size);
+	_refs = new core::AtomicInt(1);
 	_borderVoxel = copy->_borderVoxel;
 	core_memcpy((void*)_data, (void*)copy->_data, size);
+	// the slice counts of the source might get computed by another reader right now
+	if (copy->_slicesState == SlicesValid) {
+		_slices = copy->_slices;
+		_solidVoxels = copy->_solidVoxels;
+		_slicesState = SlicesValid;
+	}
+	_brickHashes = copy->_brickHashes;
+	_dirtyBricks = copy->_dirtyBricks;
 }
 
 RawVolume::RawVolume(const RawVolume &copy) : _region(copy.region()) {
 	setBorderValue(copy.borderValue());
 	const size_t size = RawVolume::size(_region);
-	_data = (Voxel *)core_malloc(size);
+	_data = (Voxel *)core::memoryAlloc(core::MemoryTag::Volume, size);
+	_refs = new core::AtomicInt(1);
 	_borderVoxel = copy._borderVoxel;
 	core_memcpy((void*)_data, (void*)copy._data, size);
+	// the slice counts of the source might get computed by another reader right now
+	if (copy._slicesState == SlicesValid) {
+		_slices = copy._slices;
+		_solidVoxels = copy._solidVoxels;
+		_slicesState = SlicesValid;
+	}
+	_brickHashes = copy._brickHashes;
+	_dirtyBricks = copy._dirtyBricks;
+}
+
+RawVolume::RawVolume(const RawVolume &src, SharedTag) : _region(src.region()), _borderVoxel(src._borderVoxel) {
+	src._refs->increment();
+	_data = src._data;
+	_refs = src._refs;
+	// the slice counts of the source might get computed by another reader right now
+	if (src._slicesState == SlicesValid) {
+		_slices = src._slices;
+		_solidVoxels = src._solidVoxels;
+		_slicesState = SlicesValid;
+	}
+	_brickHashes = src._brickHashes;
+	_dirtyBricks = src._dirtyBricks;
+}
+
+void RawVolume::releaseData() {
+	if (_refs == nullptr) {
+		return;
+	}
+	// decrement returns the previous value
+	if (_refs->decrement() == 1) {
+		core::memoryFree(core::MemoryTag::Volume, _data, RawVolume::size(_region));
+		delete _refs;
+	}
+	_data = nullptr;
+	_refs = nullptr;
+}
+
+void RawVolume::unshare() {
+	const size_t size = RawVolume::size(_region);
+	Voxel *data = (Voxel *)core::memoryAlloc(core::MemoryTag::Volume, size);
+	core_assert_msg_always(data != nullptr, "Failed to allocate the memory for a volume with the dimensions %i:%i:%i",
+						   width(), height(), depth());
+	core_memcpy((void *)data, (const void *)_data, size);
+	releaseData();
+	_data = data;
+	_refs = new core::AtomicInt(1);
 }
 
-static inline voxel::Region accumulate(const core::DynamicArray<Region> &regions) {
+static inline voxel::Region accumulate(const Region *regions, size_t regionCount) {
 	voxel::Region r = voxel::Region::InvalidRegion;
-	for (const Region &region : regions) {
+	for (size_t i = 0u; i < regionCount; ++i) {
+		const Region &region = regions[i];
 		if (r.isValid()) {
 			r.accumulate(region);
 		} else {
@@ -52,12 +113,17 @@ static inline voxel::Region accumulate(const core::DynamicArray<Region> &regions
 }
 
 RawVolume::RawVolume(const RawVolume &src, const core::DynamicArray<Region> &copyRegions)
-	: _region(accumulate(copyRegions)) {
+	: RawVolume(src, copyRegions.data(), copyRegions.size()) {
+}
+
+RawVolume::RawVolume(const RawVolume &src, const Region *copyRegions, size_t regionCount)
+	: _region(accumulate(copyRegions, regionCount)) {
 	_region.cropTo(src.region());
 	setBorderValue(src.borderValue());
 	initialise(_region);
 
-	for (Region copyRegion : copyRegions) {
+	for (size_t i = 0u; i < regionCount; ++i) {
+		Region copyRegion = copyRegions[i];
 		core_assert(copyRegion.isValid());
 		copyRegion.cropTo(_region);
 		RawVolume::Sampler destSampler(*this);
@@ -79,22 +145,26 @@ RawVolume::RawVolume(const RawVolume &src, const core::DynamicArray<Region> &cop
 RawVolume::RawVolume(const RawVolume& src, const Region& region, bool *onlyAir) : _region(region) {
 	core_assert(region.isValid());
 	setBorderValue(src.borderValue());
+	const bool overlaps = intersects(src.region(), _region);
+	const bool sameRegion = src.region() == _region;
+	if (overlaps && !sameRegion && !src.region().containsRegion(_region)) {
+		// crop before the allocation - the size of the data must match the region
+		_region.cropTo(src._region);
+	}
 	const size_t size = RawVolume::size(_region);
-	_data = (Voxel *)core_malloc(size);
-	if (!intersects(src.region(), _region)) {
+	_data = (Voxel *)core::memoryAlloc(core::MemoryTag::Volume, size);
+	_refs = new core::AtomicInt(1);
+	if (!overlaps) {
 		if (onlyAir) {
 			*onlyAir = true;
 		}
 		core_memset((void *)_data, 0, size);
-	} else if (src.region() == _region) {
+	} else if (sameRegion) {
 		core_memcpy((void *)_data, (void *)src._data, size);
 		if (onlyAir) {
 			*onlyAir = false;
 		}
 	} else {
-		if (!src.region().containsRegion(_region)) {
-			_region.cropTo(src._region);
-		}
 		if (onlyAir) {
 			*onlyAir = true;
 		}
@@ -131,7 +201,17 @@ RawVolume::RawVolume(const RawVolume& src, const Region& region, bool *onlyAir)
 
 RawVolume::RawVolume(RawVolume &&move) noexcept {
 	_data = move._data;
+	_refs = move._refs;
+	_occupancy = move._occupancy;
+	_slices = core::move(move._slices);
+	_solidVoxels = move._solidVoxels;
+	_slicesState = move._slicesState;
+	_brickHashes = core::move(move._brickHashes);
+	_dirtyBricks = core::move(move._dirtyBricks);
+	_version = move._version;
 	move._data = nullptr;
+	move._refs = nullptr;
+	move._occupancy = nullptr;
 	_region = move._region;
 	_borderVoxel = move._borderVoxel;
 }
@@ -140,17 +220,200 @@ RawVolume::RawVolume(const Voxel *data, const voxel::Region &region) {
 	initialise(region);
 	const size_t size = RawVolume::size(_region);
 	core_memcpy((void *)_data, (const void *)data, size);
+	_slicesState = SlicesDirty;
 }
 
-RawVolume::RawVolume(Voxel *data, const voxel::Region &region) : _region(region), _data(data) {
+RawVolume::RawVolume(Voxel *data, const voxel::Region &region)
+	: _region(region), _data(data), _refs(new core::AtomicInt(1)) {
 	core_assert_msg(width() > 0, "Volume width must be greater than zero.");
 	core_assert_msg(height() > 0, "Volume height must be greater than zero.");
 	core_assert_msg(depth() > 0, "Volume depth must be greater than zero.");
+	// the volume takes the ownership of the data
+	core::memoryTrackAlloc(core::MemoryTag::Volume, _data, RawVolume::size(_region));
+}
+
+void RawVolume::resetSlices() {
+	_slices.resize(width() + height() + depth());
+	_slices.fill(0u);
+	_solidVoxels = 0u;
+	_slicesState = SlicesValid;
+}
+
+void RawVolume::updateSlices() const {
+	// the slice counts are computed by the const queries - concurrent readers (e.g. the extraction workers) might
+	// get here at the same time. Only one of them computes the counts, the others wait for it.
+	for (;;) {
+		const int state = _slicesState;
+		if (state == SlicesValid) {
+			return;
+		}
+		if (state == SlicesDirty && _slicesState.compare_exchange(SlicesDirty, SlicesUpdating)) {
+			break;
+		}
+		std::this_thread::yield();
+	}
+	const int w = width();
+	const int h = height();
+	const int d = depth();
+	_slices.resize(w + h + d);
+	_slices.fill(0u);
+	uint32_t *x = _slices.data();
+	uint32_t *y = x + w;
+	uint32_t *z = y + h;
+	size_t solidVoxels = 0u;
+	const Voxel *voxels = _data;
+	for (int iz = 0; iz < d; ++iz) {
+		for (int iy = 0; iy < h; ++iy) {
+			uint32_t rowCount = 0u;
+			for (int ix = 0; ix < w; ++ix, ++voxels) {
+				if (isBlocked(voxels->getMaterial())) {
+					++x[ix];
+					++rowCount;
+				}
+			}
+			y[iy] += rowCount;
+			z[iz] += rowCount;
+			solidVoxels += rowCount;
+		}
+	}
+	_solidVoxels = solidVoxels;
+	// publishes the slice counts to the waiting readers
+	_slicesState = SlicesValid;
+}
+
+// the first and the last slice with solid voxels
+static inline bool sliceBounds(const uint32_t *slices, int n, int &lower, int &upper) {
+	lower = 0;
+	while (lower < n && slices[lower] == 0u) {
+		++lower;
+	}
+	if (lower == n) {
+		return false;
+	}
+	upper = n - 1;
+	while (slices[upper] == 0u) {
+		--upper;
+	}
+	return true;
+}
+
+Region RawVolume::solidRegion() const {
+	updateSlices();
+	if (_solidVoxels == 0u) {
+		return Region::InvalidRegion;
+	}
+	const uint32_t *x = _slices.data();
+	const uint32_t *y = x + width();
+	const uint32_t *z = y + height();
+	glm::ivec3 lower(0);
+	glm::ivec3 upper(0);
+	sliceBounds(x, width(), lower.x, upper.x);
+	sliceBounds(y, height(), lower.y, upper.y);
+	sliceBounds(z, depth(), lower.z, upper.z);
+	const glm::ivec3 &offset = _region.getLowerCorner();
+	return Region(offset + lower, offset + upper);
+}
+
+glm::ivec3 RawVolume::mins() const {
+	return solidRegion().getLowerCorner();
+}
+
+glm::ivec3 RawVolume::maxs() const {
+	return solidRegion().getUpperCorner();
+}
+
+size_t RawVolume::solidVoxelCount() const {
+	updateSlices();
+	return _solidVoxels;
+}
+
+uint64_t RawVolume::hashBrick(const glm::ivec3 &brick) const {
+	const glm::ivec3 mins = brick * HashBrickSize;
+	const glm::ivec3 maxs = glm::min(mins + HashBrickSize, _region.getDimensionsInVoxels());
+	const size_t rowSize = (size_t)(maxs.x - mins.x) * sizeof(Voxel);
+	// the rows of a brick are not next to each other - the hash of the previous row is the seed of the next row
+	uint64_t hash = 0u;
+	for (int z = mins.z; z < maxs.z; ++z) {
+		for (int y = mins.y; y < maxs.y; ++y) {
+			hash = core::hash64(_data + mins.x + y * width() + z * _region.stride(), rowSize, hash);
+		}
+	}
+	return hash;
+}
+
+void RawVolume::updateBrickHashes() const {
+	const glm::ivec3 &bricks = hashBricks();
+	const size_t brickCount = (size_t)bricks.x * bricks.y * bricks.z;
+	if (_brickHashes.empty()) {
+		_brickHashes.resize(brickCount);
+		_dirtyBricks.resize(brickCount);
+		_dirtyBricks.fill(1u);
+	}
+	size_t i = 0;
+	for (int z = 0; z < bricks.z; ++z) {
+		for (int y = 0; y < bricks.y; ++y) {
+			for (int x = 0; x < bricks.x; ++x, ++i) {
+				if (_dirtyBricks[i] == 0u) {
+					continue;
+				}
+				_brickHashes[i] = hashBrick(glm::ivec3(x, y, z));
+				_dirtyBricks[i] = 0u;
+			}
+		}
+	}
+}
+
+uint64_t RawVolume::hash() const {
+	updateBrickHashes();
+	const glm::ivec3 &dim = _region.getDimensionsInVoxels();
+	const uint64_t hash = core::hash64(&dim, sizeof(dim));
+	return core::hash64(_brickHashes.data(), _brickHashes.size() * sizeof(uint64_t), hash);
+}
+
+uint64_t RawVolume::hash(const Region &region) const {
+	Region hashRegion = region;
+	if (!hashRegion.cropTo(_region)) {
+		return 0u;
+	}
+	const glm::ivec3 &dim = hashRegion.getDimensionsInVoxels();
+	uint64_t hash = core::hash64(&dim, sizeof(dim));
+	const size_t rowSize = (size_t)dim.x * sizeof(Voxel);
+	for (int z = hashRegion.getLowerZ(); z <= hashRegion.getUpperZ(); ++z) {
+		for (int y = hashRegion.getLowerY(); y <= hashRegion.getUpperY(); ++y) {
+			hash = core::hash64(row(glm::ivec3(hashRegion.getLowerX(), y, z)), rowSize, hash);
+		}
+	}
+	return hash;
+}
+
+uint64_t RawVolume::brickHash(const glm::ivec3 &pos) const {
+	core_assert(_region.containsPoint(pos));
+	updateBrickHashes();
+	const glm::ivec3 &bricks = hashBricks();
+	const glm::ivec3 brick = (pos - _region.getLowerCorner()) / HashBrickSize;
+	return _brickHashes[brick.x + (brick.y + brick.z * bricks.y) * bricks.x];
 }
 
 RawVolume::~RawVolume() {
-	core_free(_data);
-	_data = nullptr;
+	releaseData();
+	delete _occupancy;
+}
+
+void RawVolume::setOccupancyTracking(bool enable) {
+	if (!enable) {
+		delete _occupancy;
+		_occupancy = nullptr;
+	} else if (_occupancy == nullptr) {
+		_occupancy = new OccupancyMask(*this);
+	}
+}
+
+void RawVolume::updateOccupancy(const glm::ivec3 &pos) {
+	if (_occupancy == nullptr) {
+		return;
+	}
+	const glm::ivec3 localPos = pos - _region.getLowerCorner();
+	_occupancy->rebuildRow(*this, localPos.y, localPos.z);
 }
 
 bool RawVolume::move(const glm::ivec3 &shift) {
@@ -162,6 +425,7 @@ bool RawVolume::move(const glm::ivec3 &shift) {
 	t.x = (t.x % w + w) % w;
 	t.y = (t.y % h + h) % h;
 	t.z = (t.z % d + d) % d;
+	detach();
 
 	const int hwstride = h * w;
 	for (int z = 0; z < d; ++z) {
@@ -178,6 +442,19 @@ bool RawVolume::move(const glm::ivec3 &shift) {
 	}
 
 	core::rotate(_data, _data + t.z * hwstride, _data + d * hwstride);
+	invalidateBrickHashes();
+	++_version;
+	if (_slicesState == SlicesValid) {
+		uint32_t *x = _slices.data();
+		uint32_t *y = x + w;
+		uint32_t *z = y + h;
+		core::rotate(x, x + t.x, x + w);
+		core::rotate(y, y + t.y, y + h);
+		core::rotate(z, z + t.z, z + d);
+	}
+	if (_occupancy != nullptr) {
+		_occupancy->rebuild(*this);
+	}
 
 	return true;
 }
@@ -245,7 +522,14 @@ bool RawVolume::setVoxel(const glm::ivec3 &pos, const Voxel &voxel) {
 	if (_data[index].isSame(voxel)) {
 		return false;
 	}
+	detach();
+	updateSlices(localPos, isBlocked(_data[index].getMaterial()), isBlocked(voxel.getMaterial()));
+	markBrickDirty(localPos);
 	_data[index] = voxel;
+	++_version;
+	if (_occupancy != nullptr) {
+		_occupancy->set(localPos, isBlocked(voxel.getMaterial()));
+	}
 	return true;
 }
 
@@ -253,7 +537,14 @@ void RawVolume::setVoxelUnsafe(const glm::ivec3 &pos, const Voxel &voxel) {
 	const glm::ivec3 &lowerCorner = _region.getLowerCorner();
 	const glm::ivec3 localPos = pos - lowerCorner;
 	const int index = localPos.x + localPos.y * width() + localPos.z * width() * height();
+	detach();
+	updateSlices(localPos, isBlocked(_data[index].getMaterial()), isBlocked(voxel.getMaterial()));
+	markBrickDirty(localPos);
 	_data[index] = voxel;
+	++_version;
+	if (_occupancy != nullptr) {
+		_occupancy->set(localPos, isBlocked(voxel.getMaterial()));
+	}
 }
 
 /**
@@ -268,9 +559,10 @@ void RawVolume::initialise(const Region &regValidRegion) {
 
 	// Create the data
 	const size_t size = RawVolume::size(_region);
-	_data = (Voxel *)core_malloc(size);
+	_data = (Voxel *)core::memoryAlloc(core::MemoryTag::Volume, size);
 	core_assert_msg_always(_data != nullptr, "Failed to allocate the memory for a volume with the dimensions %i:%i:%i",
 						   width(), height(), depth());
+	_refs = new core::AtomicInt(1);
 
 	// Clear to zeros
 	clear();
@@ -278,14 +570,53 @@ void RawVolume::initialise(const Region &regValidRegion) {
 
 void RawVolume::clear() {
 	const size_t size = RawVolume::size(_region);
+	if (isShared()) {
+		// no need to copy the data that is overwritten anyway
+		releaseData();
+		_data = (Voxel *)core::memoryAlloc(core::MemoryTag::Volume, size);
+		core_assert_msg_always(_data != nullptr, "Failed to allocate the memory for a volume with the dimensions %i:%i:%i",
+							   width(), height(), depth());
+		_refs = new core::AtomicInt(1);
+	}
 	core_memset(_data, 0, size);
+	resetSlices();
+	invalidateBrickHashes();
+	++_version;
+	if (_occupancy != nullptr) {
+		_occupancy->fill(false);
+	}
 }
 
 void RawVolume::fill(const voxel::Voxel &voxel) {
+	detach();
 	const size_t size = width() * height() * depth();
 	for (size_t i = 0; i < size; ++i) {
 		_data[i] = voxel;
 	}
+	resetSlices();
+	invalidateBrickHashes();
+	++_version;
+	if (isBlocked(voxel.getMaterial())) {
+		const int w = width();
+		const int h = height();
+		const int d = depth();
+		uint32_t *x = _slices.data();
+		uint32_t *y = x + w;
+		uint32_t *z = y + h;
+		for (int i = 0; i < w; ++i) {
+			x[i] = h * d;
+		}
+		for (int i = 0; i < h; ++i) {
+			y[i] = w * d;
+		}
+		for (int i = 0; i < d; ++i) {
+			z[i] = w * h;
+		}
+		_solidVoxels = size;
+	}
+	if (_occupancy != nullptr) {
+		_occupancy->fill(isBlocked(voxel.getMaterial()));
+	}
 }
 
 RawVolume::Sampler::Sampler(const RawVolume *volume)
@@ -303,7 +634,19 @@ bool RawVolume::Sampler::setVoxel(const Voxel &voxel) {
 	if (_currentPositionInvalid) {
 		return false;
 	}
+	if (_volume->isShared()) {
+		const ptrdiff_t offset = _currentVoxel - _volume->_data;
+		_volume->unshare();
+		_currentVoxel = _volume->_data + offset;
+	}
+	_volume->updateSlices(_posInVolume - _region.getLowerCorner(), isBlocked(_currentVoxel->getMaterial()),
+						  isBlocked(voxel.getMaterial()));
+	_volume->markBrickDirty(_posInVolume - _region.getLowerCorner());
 	*_currentVoxel = voxel;
+	++_volume->_version;
+	if (_volume->_occupancy != nullptr) {
+		_volume->_occupancy->set(_posInVolume - _region.getLowerCorner(), isBlocked(voxel.getMaterial()));
+	}
 	return true;
 }
 
@@ -6,14 +6,25 @@
 
 #include "Region.h"
 #include "Voxel.h"
+#include "core/Assert.h"
 #include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
 #include "math/Axis.h"
 #include <glm/vec3.hpp>
 
 namespace voxel {
 
+class OccupancyMask;
+
 /**
  * Simple volume implementation which stores data in a single large 3D array.
+ *
+ * The volume is not locked. It is only modified by the thread that owns it (usually the main thread). Tasks that
+ * read the voxels on other threads (mesh extraction, thumbnails, autosave, scripts) get their own copy - either
+ * a copy of the regions they need or a copy that shares the voxel data (@c createShared()). The shared data is
+ * duplicated before the owner modifies it, so the copy stays consistent without blocking the modifications.
+ *
+ * @sa createShared()
  */
 class RawVolume {
 public:
@@ -95,6 +106,8 @@ public:
 
 	RawVolume(const Voxel *data, const voxel::Region &region);
 	RawVolume(Voxel *data, const voxel::Region &region);
+	struct SharedTag {};
+	RawVolume(const RawVolume &src, SharedTag);
 
 public:
 	/// Constructor for creating a fixed size volume.
@@ -104,6 +117,7 @@ public:
 	RawVolume(RawVolume &&move) noexcept;
 	RawVolume(const RawVolume &copy, const Region &region, bool *onlyAir = nullptr);
 	RawVolume(const RawVolume &copy, const core::DynamicArray<Region> &regions);
+	RawVolume(const RawVolume &copy, const Region *regions, size_t regionCount);
 
 	/**
 	 * @brief Calculate the amount of bytes a volume with the given region would consume
@@ -118,6 +132,20 @@ public:
 		return new RawVolume(data, region);
 	}
 
+	/**
+	 * @brief Create a copy of the given volume that shares the voxel data (copy on write)
+	 *
+	 * The voxel data is duplicated as soon as one of the volumes that share the data gets modified. This makes
+	 * duplicating nodes cheap.
+	 * @note A Sampler that was created before the volume detached from the shared data still reads the shared data.
+	 * Only the Sampler that is used to modify the volume is updated. Call detach() before you start to modify a
+	 * shared volume with several samplers.
+	 * @note It's the callers responsibility to properly release the memory.
+	 */
+	static RawVolume *createShared(const RawVolume &volume) {
+		return new RawVolume(volume, SharedTag());
+	}
+
 	~RawVolume();
 
 	/**
@@ -166,14 +194,27 @@ public:
 
 	/**
 	 * the vector that describes the mins value of an aabb where a voxel is set in this volume
-	 * deleting a voxel afterwards might lead to invalid results
+	 * @sa solidRegion()
 	 */
 	glm::ivec3 mins() const;
 	/**
 	 * the vector that describes the maxs value of an aabb where a voxel is set in this volume
-	 * deleting a voxel afterwards might lead to invalid results
+	 * @sa solidRegion()
 	 */
 	glm::ivec3 maxs() const;
+	/**
+	 * @brief The exact bounds of all solid voxels in this volume
+	 *
+	 * The amount of solid voxels per slice along each axis is kept up to date for every modification. This makes
+	 * the bounds cheap to query - only the slices are checked, not the voxels.
+	 * @note Concurrent readers are safe - the slice counts are computed by one of them, the others wait for it
+	 * @return Region::InvalidRegion if there is no solid voxel
+	 */
+	Region solidRegion() const;
+	/**
+	 * @return The amount of voxels that are not air
+	 */
+	size_t solidVoxelCount() const;
 
 	/**
 	 * Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
@@ -204,10 +245,109 @@ public:
 	void clear();
 	void fill(const voxel::Voxel &voxel);
 
+	/**
+	 * @return @c true if the voxel data is shared with a copy of this volume
+	 */
+	inline bool isShared() const {
+		return *_refs > 1;
+	}
+
+	/**
+	 * @brief Get an exclusive copy of the voxel data if it is shared with other volumes
+	 * @sa createShared()
+	 */
+	inline void detach() {
+		if (isShared()) {
+			unshare();
+		}
+	}
+
+	/**
+	 * @brief Keep a bit mask of the solid voxels in sync with the voxel data
+	 * @note The mask is not shared with copies of the volume.
+	 * @sa occupancy()
+	 */
+	void setOccupancyTracking(bool enable);
+
+	/**
+	 * @return The occupancy mask or @c nullptr if the tracking is not enabled
+	 * @sa setOccupancyTracking()
+	 */
+	inline const OccupancyMask *occupancy() const {
+		return _occupancy;
+	}
+
+	/**
+	 * @brief Update the occupancy mask for a row that was modified with writableRow()
+	 */
+	void updateOccupancy(const glm::ivec3 &pos);
+
+	/**
+	 * @brief Incremented for every modification of the voxel data
+	 * @note Can be used to check whether the volume was modified since the last time the value was queried
+	 */
+	inline uint64_t version() const {
+		return _version;
+	}
+
+	/**
+	 * @brief The side length of the bricks the content hash is cached for
+	 * @sa hash()
+	 */
+	static constexpr int HashBrickSize = 16;
+
+	/**
+	 * @brief Hash of the voxel data and the dimensions of the volume - not of the position
+	 *
+	 * Volumes with the same hash have the same voxels (byte by byte). The hashes of the bricks of @c HashBrickSize
+	 * voxels are cached and only the bricks that were modified since the last call are hashed again. Modifications
+	 * with @c writableRow() hash all bricks again.
+	 * @note Not thread safe - the cached brick hashes are updated by this query
+	 */
+	uint64_t hash() const;
+	/**
+	 * @brief Hash of the voxels in the given region (cropped to the volume) and its dimensions
+	 *
+	 * The hash is computed from the voxel data without using the brick cache. Two regions with the same voxels give
+	 * the same hash - no matter where they are located or which volume they are taken from.
+	 * @return @c 0 if the region doesn't intersect the volume
+	 */
+	uint64_t hash(const Region &region) const;
+	/**
+	 * @brief The cached hash of the brick that contains the given position - can be used to find the modified parts
+	 * of a volume
+	 */
+	uint64_t brickHash(const glm::ivec3 &pos) const;
+
 	inline const uint8_t *data() const {
 		return (const uint8_t *)_data;
 	}
 
+	/**
+	 * @brief Access the voxels of a row along the x axis - they are stored next to each other
+	 * @param pos The start position of the row - must be inside of the region. There are
+	 * @c region().getUpperX() - pos.x + 1 voxels available.
+	 */
+	inline const Voxel *row(const glm::ivec3 &pos) const {
+		return _data + index(pos);
+	}
+
+	/**
+	 * @brief Writable access to the voxels of a row along the x axis
+	 * @note Gets an exclusive copy of shared voxel data - see detach()
+	 * @note Call updateOccupancy() after the row was modified
+	 * @note The slice counts for solidRegion() and the brick hashes are computed again on the next query - the
+	 * callers might write all the voxel data starting at the row
+	 * @sa row()
+	 */
+	inline Voxel *writableRow(const glm::ivec3 &pos) {
+		detach();
+		_slicesState = SlicesDirty;
+		invalidateBrickHashes();
+		++_version;
+		return _data + index(pos);
+	}
+
 	/**
 	 * @brief Shift the region of the volume by the given coordinates
 	 */
@@ -224,6 +364,51 @@ public:
 
 private:
 	void initialise(const Region &region);
+	inline int index(const glm::ivec3 &pos) const {
+		core_assert(_region.containsPoint(pos));
+		const glm::ivec3 localPos = pos - _region.getLowerCorner();
+		return localPos.x + localPos.y * width() + localPos.z * _region.stride();
+	}
+	void releaseData();
+	void unshare();
+	void resetSlices();
+	void updateBrickHashes() const;
+	uint64_t hashBrick(const glm::ivec3 &brick) const;
+	inline glm::ivec3 hashBricks() const {
+		return (_region.getDimensionsInVoxels() + HashBrickSize - 1) / HashBrickSize;
+	}
+	inline void invalidateBrickHashes() {
+		_brickHashes.clear();
+		_dirtyBricks.clear();
+	}
+	inline void markBrickDirty(const glm::ivec3 &localPos) {
+		if (_brickHashes.empty()) {
+			return;
+		}
+		const glm::ivec3 &bricks = hashBricks();
+		const glm::ivec3 brick = localPos / HashBrickSize;
+		_dirtyBricks[brick.x + (brick.y + brick.z * bricks.y) * bricks.x] = 1u;
+	}
+	void updateSlices() const;
+	inline void updateSlices(const glm::ivec3 &localPos, bool wasSolid, bool solid) {
+		if (wasSolid == solid || _slicesState != SlicesValid) {
+			return;
+		}
+		uint32_t *x = _slices.data();
+		uint32_t *y = x + width();
+		uint32_t *z = y + height();
+		if (solid) {
+			++x[localPos.x];
+			++y[localPos.y];
+			++z[localPos.z];
+			++_solidVoxels;
+		} else {
+			--x[localPos.x];
+			--y[localPos.y];
+			--z[localPos.z];
+			--_solidVoxels;
+		}
+	}
 
 	/** The size of the volume */
 	Region _region;
@@ -233,6 +418,31 @@ private:
 
 	/** The voxel data */
 	Voxel *_data;
+
+	/** The amount of volumes that share the voxel data */
+	core::AtomicInt *_refs;
+
+	/** The modification counter */
+	uint64_t _version = 0u;
+
+	/** The optional bit mask of the solid voxels */
+	OccupancyMask *_occupancy = nullptr;
+
+	/** The amount of solid voxels per x slice, followed by the y and the z slices */
+	mutable core::DynamicArray<uint32_t> _slices;
+	mutable size_t _solidVoxels = 0u;
+	/** The slice counts are up to date */
+	static constexpr int SlicesValid = 0;
+	/** The slice counts are computed from the voxel data on the next query */
+	static constexpr int SlicesDirty = 1;
+	/** One of the readers computes the slice counts - see updateSlices() */
+	static constexpr int SlicesUpdating = 2;
+	mutable core::AtomicInt _slicesState{SlicesDirty};
+
+	/** The cached hashes of the bricks in x, y, z order - all bricks are hashed on the next query if empty */
+	mutable core::DynamicArray<uint64_t> _brickHashes;
+	/** The bricks that are hashed again on the next query */
+	mutable core::DynamicArray<uint8_t> _dirtyBricks;
 };
 
 inline const Region &RawVolume::region() const {
@@ -0,0 +1,77 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "RawVolume.h"
+#include "core/Common.h"
+#include "core/NonCopyable.h"
+
+namespace voxel {
+
+/**
+ * @brief Writes runs of voxels along the y axis directly into the voxel data of a @c RawVolume
+ *
+ * Made for the loaders of formats that store their voxels in vertical columns (slab6, ace of spades). The runs are
+ * clipped against the region and written without the bookkeeping of @c RawVolume::setVoxel() for each voxel - the
+ * solid region of the volume is computed again on the next query. Different columns can be written from different
+ * threads.
+ *
+ * @note Don't access the volume in any other way while the writer is alive
+ */
+class RawVolumeColumnWriter : public core::NonCopyable {
+private:
+	RawVolume &_volume;
+	Voxel *_data;
+	const Region _region;
+	const int _width;
+	const int _sliceSize;
+
+public:
+	RawVolumeColumnWriter(RawVolume &volume)
+		: _volume(volume), _data(volume.writableRow(volume.region().getLowerCorner())), _region(volume.region()),
+		  _width(volume.width()), _sliceSize(volume.width() * volume.height()) {
+	}
+
+	~RawVolumeColumnWriter() {
+		if (_volume.occupancy() == nullptr) {
+			return;
+		}
+		for (int z = _region.getLowerZ(); z <= _region.getUpperZ(); ++z) {
+			for (int y = _region.getLowerY(); y <= _region.getUpperY(); ++y) {
+				_volume.updateOccupancy(glm::ivec3(_region.getLowerX(), y, z));
+			}
+		}
+	}
+
+	inline const Region &region() const {
+		return _region;
+	}
+
+	/**
+	 * @brief Sets the voxels from @c minsY to @c maxsY (both inclusive) of the column at @c x and @c z
+	 */
+	void fill(int x, int z, int minsY, int maxsY, const Voxel &voxel) {
+		if (x < _region.getLowerX() || x > _region.getUpperX() || z < _region.getLowerZ() ||
+			z > _region.getUpperZ()) {
+			return;
+		}
+		minsY = core_max(minsY, _region.getLowerY());
+		maxsY = core_min(maxsY, _region.getUpperY());
+		if (minsY > maxsY) {
+			return;
+		}
+		const glm::ivec3 &lower = _region.getLowerCorner();
+		Voxel *column = _data + (x - lower.x) + (z - lower.z) * _sliceSize;
+		for (int y = minsY - lower.y; y <= maxsY - lower.y; ++y) {
+			column[y * _width] = voxel;
+		}
+	}
+
+	inline void setVoxel(int x, int y, int z, const Voxel &voxel) {
+		fill(x, z, y, y, voxel);
+	}
+};
+
+} // namespace voxel
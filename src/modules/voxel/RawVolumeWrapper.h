@@ -136,6 +136,20 @@ public:
 		return _dirtyRegion;
 	}
 
+	/**
+	 * @brief Mark a region as modified that was written directly into the wrapped volume
+	 */
+	void addDirtyRegion(const Region& region) {
+		if (!region.isValid()) {
+			return;
+		}
+		if (_dirtyRegion.isValid()) {
+			_dirtyRegion.accumulate(region);
+		} else {
+			_dirtyRegion = region;
+		}
+	}
+
 	/**
 	 * @return @c false if the voxel was not placed because the given position is outside of the valid region, @c
 	 * true if the voxel was placed in the region.
@@ -156,6 +170,46 @@ public:
 		return true;
 	}
 
+	/**
+	 * @brief Places the voxel in the row along the x axis from @c x0 to @c x1 (both inclusive)
+	 *
+	 * The row is clipped to the valid region and written in one go instead of voxel by voxel. Voxels that already have
+	 * the given value are not touched.
+	 * @return The amount of voxels of the row that are inside the valid region
+	 * @note Subclasses that override setVoxel() must override this, too
+	 */
+	virtual int setRow(int x0, int x1, int y, int z, const Voxel& voxel) {
+		if (!_region.containsPointInY(y) || !_region.containsPointInZ(z)) {
+			return 0;
+		}
+		x0 = core_max(x0, _region.getLowerX());
+		x1 = core_min(x1, _region.getUpperX());
+		if (x0 > x1) {
+			return 0;
+		}
+		const glm::ivec3 start(x0, y, z);
+		const int n = x1 - x0 + 1;
+		const Voxel *voxels = _volume->row(start);
+		int first = 0;
+		while (first < n && voxels[first].isSame(voxel)) {
+			++first;
+		}
+		if (first == n) {
+			return n;
+		}
+		int last = n - 1;
+		while (voxels[last].isSame(voxel)) {
+			--last;
+		}
+		Voxel *writable = _volume->writableRow(start);
+		for (int i = first; i <= last; ++i) {
+			writable[i] = voxel;
+		}
+		_volume->updateOccupancy(start);
+		addDirtyRegion(Region(x0 + first, y, z, x0 + last, y, z));
+		return n;
+	}
+
 	inline bool setVoxels(int x, int z, const Voxel* voxels, int amount) {
 		for (int y = 0; y < amount; ++y) {
 			setVoxel(x, y, z, voxels[y]);
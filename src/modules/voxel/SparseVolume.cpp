@@ -3,6 +3,7 @@
  */
 
 #include "SparseVolume.h"
+#include "core/Common.h"
 
 namespace voxel {
 
@@ -22,15 +23,30 @@ bool SparseVolume::setVoxel(const glm::ivec3 &pos, const voxel::Voxel &voxel) {
 }
 
 const Voxel &SparseVolume::voxel(const glm::ivec3 &pos) const {
-	auto iter = _map.find(pos);
-	if (iter != _map.end()) {
-		return iter->second;
+	if (const Voxel *voxel = _map.ptr(pos)) {
+		return *voxel;
 	}
 	return _emptyVoxel;
 }
 
 bool SparseVolume::hasVoxel(const glm::ivec3 &pos) const {
-	return _map.find(pos) != _map.end();
+	return _map.hasKey(pos);
+}
+
+int SparseVolume::setRow(int x0, int x1, int y, int z, const voxel::Voxel &voxel) {
+	if (_isRegionValid) {
+		if (!_region.containsPointInY(y) || !_region.containsPointInZ(z)) {
+			return 0;
+		}
+		x0 = core_max(x0, _region.getLowerX());
+		x1 = core_min(x1, _region.getUpperX());
+	}
+	int n = 0;
+	for (int x = x0; x <= x1; ++x) {
+		setVoxel(glm::ivec3(x, y, z), voxel);
+		++n;
+	}
+	return n;
 }
 
 void SparseVolume::clear() {
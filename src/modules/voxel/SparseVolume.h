@@ -5,7 +5,7 @@
 #pragma once
 
 #include "core/GLM.h"
-#include "core/collection/DynamicMap.h"
+#include "core/collection/FlatMap.h"
 #include "math/Axis.h"
 #include "voxelutil/VolumeVisitor.h"
 
@@ -17,7 +17,7 @@ namespace voxel {
  */
 class SparseVolume {
 private:
-	core::DynamicMap<glm::ivec3, voxel::Voxel, 1031, glm::hash<glm::ivec3>> _map;
+	core::FlatMap<glm::ivec3, voxel::Voxel, glm::hash<glm::ivec3>> _map;
 	static const constexpr voxel::Voxel _emptyVoxel{VoxelType::Air, 0, 0, 0};
 	const voxel::Region _region;
 	const bool _isRegionValid;
@@ -117,6 +117,12 @@ public:
 
 	bool setVoxel(const glm::ivec3 &pos, const voxel::Voxel &voxel);
 
+	/**
+	 * @brief Places the voxel in the row along the x axis from @c x0 to @c x1 (both inclusive)
+	 * @return The amount of voxels of the row that are inside the valid region
+	 */
+	int setRow(int x0, int x1, int y, int z, const voxel::Voxel &voxel);
+
 	void clear();
 
 	/**
@@ -138,6 +144,13 @@ public:
 
 	[[nodiscard]] bool hasVoxel(const glm::ivec3 &pos) const;
 
+	/**
+	 * @return @c nullptr if there is no voxel stored for the given position
+	 */
+	[[nodiscard]] inline const Voxel *findVoxel(const glm::ivec3 &pos) const {
+		return _map.ptr(pos);
+	}
+
 	[[nodiscard]] inline bool empty() const {
 		return size() == 0;
 	}
@@ -170,8 +183,8 @@ public:
 	template<class Volume>
 	void copyTo(Volume &target) const {
 		for (auto iter = _map.begin(); iter != _map.end(); ++iter) {
-			const glm::ivec3 &pos = iter->first;
-			const voxel::Voxel &voxel = iter->second;
+			const glm::ivec3 &pos = iter->key;
+			const voxel::Voxel &voxel = iter->value;
 			target.setVoxel(pos.x, pos.y, pos.z, voxel);
 		}
 	}
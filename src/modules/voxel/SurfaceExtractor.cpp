@@ -3,6 +3,16 @@
  */
 
 #include "SurfaceExtractor.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/SharedPtr.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/ChunkMesh.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Region.h"
 #include "voxel/RawVolume.h"
@@ -24,13 +34,179 @@ SurfaceExtractionContext buildMarchingCubesContext(const RawVolume *volume, cons
 									false, false, false, optimize);
 }
 
-void extractSurface(SurfaceExtractionContext &ctx) {
+// the minimum amount of z slices that are extracted by one task
+static constexpr int MinSliceDepth = 32;
+
+static void extractRegion(const SurfaceExtractionContext &ctx, const Region &region, ChunkMesh &mesh, bool optimize) {
 	if (ctx.type == SurfaceExtractionType::MarchingCubes) {
-		voxel::extractMarchingCubesMesh(ctx.volume, ctx.palette, ctx.region, &ctx.mesh, ctx.optimize);
+		voxel::extractMarchingCubesMesh(ctx.volume, ctx.palette, region, &mesh, optimize);
 	} else {
-		voxel::extractCubicMesh(ctx.volume, ctx.region, &ctx.mesh, ctx.translate, ctx.mergeQuads, ctx.reuseVertices,
-								ctx.ambientOcclusion, ctx.optimize);
+		voxel::extractCubicMesh(ctx.volume, region, &mesh, ctx.translate, ctx.mergeQuads, ctx.reuseVertices,
+								ctx.ambientOcclusion, optimize, ctx.vertexOcclusion);
+	}
+}
+
+static void appendMesh(Mesh &target, const Mesh &source, const glm::vec3 &translate) {
+	const size_t vertexOffset = target.getNoOfVertices();
+	VertexArray &vertices = target.getVertexVector();
+	vertices.reserve(vertexOffset + source.getNoOfVertices());
+	for (const VoxelVertex &vertex : source.getVertexVector()) {
+		vertices.push_back(vertex);
+		vertices.back().position += translate;
+	}
+	const NormalArray &sourceNormals = source.getNormalVector();
+	if (!sourceNormals.empty()) {
+		NormalArray &normals = target.getNormalVector();
+		normals.resize(vertexOffset);
+		normals.append(sourceNormals);
+	}
+	IndexArray &indices = target.getIndexVector();
+	indices.reserve(indices.size() + source.getNoOfIndices());
+	for (IndexType index : source.getIndexVector()) {
+		indices.push_back((IndexType)(index + vertexOffset));
+	}
+}
+
+namespace {
+
+/**
+ * @brief The state is shared with the tasks of the thread pool - a task that is started after all slices were taken
+ * by other threads only touches the counter and must not access the context anymore.
+ */
+struct SliceExtraction {
+	const SurfaceExtractionContext *ctx = nullptr;
+	core::DynamicArray<Region> regions;
+	core::DynamicArray<ChunkMesh> meshes;
+	core::AtomicInt next{0};
+	core::AtomicInt done{0};
+	core_trace_mutex(core::Lock, lock, "SliceExtraction");
+	core::ConditionVariable finished;
+
+	void run() {
+		const int slices = (int)regions.size();
+		for (;;) {
+			const int slice = next.increment();
+			if (slice >= slices) {
+				return;
+			}
+			extractRegion(*ctx, regions[slice], meshes[slice], false);
+			done.increment();
+			{
+				core::ScopedLock scoped(lock);
+			}
+			finished.notify_all();
+		}
+	}
+};
+
+} // namespace
+
+static void extractSlices(SurfaceExtractionContext &ctx, int slices) {
+	core_trace_scoped(ExtractSurfaceSlices);
+	const Region &region = ctx.region;
+	const glm::ivec3 &lower = region.getLowerCorner();
+	const glm::ivec3 &upper = region.getUpperCorner();
+	const int depth = region.getDepthInVoxels();
+
+	core::SharedPtr<SliceExtraction> state = core::make_shared<SliceExtraction>();
+	state->ctx = &ctx;
+	state->regions.reserve(slices);
+	for (int i = 0; i < slices; ++i) {
+		int lowerZ = lower.z + depth * i / slices;
+		const int upperZ = lower.z + depth * (i + 1) / slices - 1;
+		if (i > 0 && ctx.type == SurfaceExtractionType::MarchingCubes) {
+			// the first slice of the region only generates the vertices for the cells of the next slice
+			--lowerZ;
+		}
+		state->regions.emplace_back(lower.x, lower.y, lowerZ, upper.x, upper.y, upperZ);
 	}
+	state->meshes.resize(slices);
+
+	for (int i = 1; i < slices; ++i) {
+		ctx.threadPool->schedule([state]() { state->run(); });
+	}
+	state->run();
+	{
+		core::ScopedLock scoped(state->lock);
+		state->finished.wait(state->lock, [&state, slices]() { return (int)state->done == slices; });
+	}
+
+	ChunkMesh &result = ctx.mesh;
+	result.clear();
+	for (int i = 0; i < slices; ++i) {
+		// the cubic vertices are relative to the lower corner of the extracted region
+		glm::vec3 translate(0.0f);
+		if (ctx.type == SurfaceExtractionType::Cubic) {
+			translate = state->regions[i].getLowerCorner() - lower;
+		}
+		for (int m = 0; m < ChunkMesh::Meshes; ++m) {
+			appendMesh(result.mesh[m], state->meshes[i].mesh[m], translate);
+		}
+	}
+	result.setOffset(lower);
+	if (ctx.optimize) {
+		result.optimize();
+	}
+	result.removeUnusedVertices();
+	for (int m = 0; m < ChunkMesh::Meshes; ++m) {
+		result.mesh[m].compressIndices();
+	}
+}
+
+static void extractBricks(SurfaceExtractionContext &ctx) {
+	core_trace_scoped(ExtractSurfaceBricks);
+	const int brickSize = ctx.brickSize;
+	core_assert((brickSize & (brickSize - 1)) == 0);
+	const Region &region = ctx.region;
+	const glm::ivec3 &lower = region.getLowerCorner();
+	const glm::ivec3 &upper = region.getUpperCorner();
+	// align to the brick grid - this also works for negative coordinates
+	const glm::ivec3 brickLower = lower & ~(brickSize - 1);
+
+	ChunkMesh &result = ctx.mesh;
+	result.clear();
+	ChunkMesh brickMesh(0, 0, true);
+	for (int z = brickLower.z; z <= upper.z; z += brickSize) {
+		for (int y = brickLower.y; y <= upper.y; y += brickSize) {
+			for (int x = brickLower.x; x <= upper.x; x += brickSize) {
+				Region brick(x, y, z, x + brickSize - 1, y + brickSize - 1, z + brickSize - 1);
+				brick.cropTo(region);
+				const glm::ivec3 translate = ctx.translate + brick.getLowerCorner() - lower;
+				voxel::extractCubicMesh(ctx.volume, brick, &brickMesh, translate, ctx.mergeQuads, ctx.reuseVertices,
+										ctx.ambientOcclusion, false, ctx.vertexOcclusion);
+				for (int m = 0; m < ChunkMesh::Meshes; ++m) {
+					appendMesh(result.mesh[m], brickMesh.mesh[m], glm::vec3(0.0f));
+				}
+			}
+		}
+	}
+	result.setOffset(lower);
+}
+
+static void extractMesh(SurfaceExtractionContext &ctx) {
+	if (ctx.brickSize > 0 && ctx.type == SurfaceExtractionType::Cubic) {
+		extractBricks(ctx);
+		return;
+	}
+	if (ctx.threadPool != nullptr) {
+		const int slices = core_min((int)ctx.threadPool->size() + 1, ctx.region.getDepthInVoxels() / MinSliceDepth);
+		if (slices > 1) {
+			extractSlices(ctx, slices);
+			return;
+		}
+	}
+	extractRegion(ctx, ctx.region, ctx.mesh, ctx.optimize);
+}
+
+void extractSurface(SurfaceExtractionContext &ctx) {
+	// the zone value is the amount of voxels - the plots show the size of the extracted meshes over time
+	core_trace_value_scoped(ExtractSurface, ctx.region.voxels());
+	extractMesh(ctx);
+	core_trace_plot("ExtractSurfaceVoxels", (int64_t)ctx.region.voxels());
+	core_trace_plot("ExtractSurfaceVertices",
+					(int64_t)(ctx.mesh.mesh[0].getNoOfVertices() + ctx.mesh.mesh[1].getNoOfVertices()));
+	core_trace_plot("ExtractSurfaceTriangles",
+					(int64_t)(ctx.mesh.mesh[0].getNoOfIndices() + ctx.mesh.mesh[1].getNoOfIndices()) / 3);
 }
 
 voxel::SurfaceExtractionContext createContext(voxel::SurfaceExtractionType type, const voxel::RawVolume *volume,
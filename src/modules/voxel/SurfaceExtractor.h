@@ -6,6 +6,10 @@
 
 #include "math/Math.h"
 
+namespace core {
+class ThreadPool;
+}
+
 namespace palette {
 class Palette;
 }
@@ -34,6 +38,34 @@ struct SurfaceExtractionContext {
 	const bool reuseVertices;	 // used only for Cubic
 	const bool ambientOcclusion; // used only for Cubic
 	const bool optimize;
+	/**
+	 * @brief Optional thread pool to split the extraction of the region into slices along the z axis
+	 *
+	 * The calling thread takes part in the extraction and only waits for the slices that are already in progress - so
+	 * it's fine to use the pool the caller is running on. The meshes of the slices are stitched together in the order
+	 * of the slices, the result only depends on the size of the pool. Vertices are not shared and quads are not merged
+	 * across the borders of the slices.
+	 */
+	core::ThreadPool *threadPool = nullptr;
+	/**
+	 * @brief Optional size of the bricks the region is extracted in - used only for Cubic
+	 *
+	 * The bricks are aligned to the origin of the volume coordinates. Quads are not merged and vertices are not shared
+	 * across the borders of the bricks - each face belongs to the brick that contains the floored center of its
+	 * triangles. This allows to replace the faces of single bricks with the result of a later extraction of only these
+	 * bricks. Takes precedence over the @c threadPool and @c optimize is ignored.
+	 * @note Must be a power of two
+	 */
+	int brickSize = 0;
+	/**
+	 * @brief Compute the ambient occlusion of the vertices - used only for Cubic
+	 *
+	 * If this is @c false, all vertices get the unoccluded value @c 3 and more of them can be shared and merged. This
+	 * is meant for renderers that apply the occlusion in a different way (see @c voxelrender::AmbientOcclusionVolume)
+	 * - @c ambientOcclusion should be disabled then, too. @c ambientOcclusion alone only disables the check of the
+	 * occlusion values when the quads are merged - the vertices still get their computed occlusion.
+	 */
+	bool vertexOcclusion = true;
 };
 
 SurfaceExtractionContext buildCubicContext(const RawVolume *volume, const Region &region, ChunkMesh &mesh,
@@ -6,6 +6,7 @@
 
 #include "Voxel.h"
 #include <glm/vec3.hpp>
+#include <glm/ext/vector_int3_sized.hpp>
 
 namespace voxel {
 
@@ -31,7 +32,27 @@ struct VoxelVertex {
 };
 static_assert(sizeof(VoxelVertex) == 16, "Unexpected size of the vertex struct");
 
-// TODO: maybe reduce to uint16_t and use glDrawElementsBaseVertex
+/**
+ * @brief The vertex layout that is uploaded for the cubic meshes
+ *
+ * The positions of the cubic meshes are always integral - they are stored relative to the lower corner of the volume
+ * region to fit into 16 bit. The renderer moves the pivot by the same offset. Volumes that are too big for 16 bit
+ * positions are uploaded with the float layout.
+ * @sa VoxelVertex
+ */
+struct PackedVoxelVertex {
+	glm::i16vec3 position;
+	/** @sa VoxelVertex::info */
+	uint8_t info;
+	uint8_t colorIndex;
+	uint8_t normalIndex;
+	uint8_t padding[3];
+};
+static_assert(sizeof(PackedVoxelVertex) == 12, "Unexpected size of the packed vertex struct");
+
+/**
+ * @note The renderer uploads 16 bit indices if all the vertices of a volume can be addressed with them
+ */
 typedef uint32_t IndexType;
 
 }
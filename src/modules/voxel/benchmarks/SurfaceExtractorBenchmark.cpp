@@ -3,13 +3,19 @@
  */
 
 #include "app/benchmark/AbstractBenchmark.h"
+#include "palette/Palette.h"
 #include "voxel/ChunkMesh.h"
+#include "voxel/PagedVolume.h"
 #include "voxel/RawVolume.h"
 #include "voxel/SurfaceExtractor.h"
+#include "voxel/private/CubicSurfaceExtractor.h"
 
 class SurfaceExtractorBenchmark : public app::AbstractBenchmark {
 protected:
 	voxel::RawVolume v{voxel::Region{0, 0, 0, 143, 22, 134}};
+	voxel::PagedVolume pv{voxel::Region{0, 0, 0, 143, 22, 134}};
+	// terrain like volume with color stripes - a lot of coplanar quads per slice
+	voxel::RawVolume dense{voxel::Region{0, 0, 0, 127, 31, 127}};
 
 public:
 	void SetUp(::benchmark::State &state) override {
@@ -88,10 +94,22 @@ public:
 		v.setVoxel(96, 6, 69, voxel::createVoxel(voxel::VoxelType::Generic, 47));
 		v.setVoxel(97, 6, 69, voxel::createVoxel(voxel::VoxelType::Generic, 47));
 		v.setVoxel(98, 6, 69, voxel::createVoxel(voxel::VoxelType::Generic, 47));
+		pv.copyFrom(v);
+
+		for (int z = 0; z <= 127; ++z) {
+			for (int x = 0; x <= 127; ++x) {
+				const int height = 8 + (x / 16 + z / 16) % 8;
+				const uint8_t color = 1 + (x / 4 + z / 4) % 3;
+				for (int y = 0; y <= height; ++y) {
+					dense.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+				}
+			}
+		}
 	}
 };
 
 BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, Visit)(benchmark::State &state) {
+	resetAllocations();
 	for (auto _ : state) {
 		const bool mergeQuads = true;
 		const bool reuseVertices = true;
@@ -103,8 +121,71 @@ BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, Visit)(benchmark::State &state) {
 			voxel::buildCubicContext(&v, v.region(), mesh, glm::ivec3(0), mergeQuads, reuseVertices, ambientOcclusion);
 		voxel::extractSurface(ctx);
 	}
+	addVoxelCounter(state, v.region().voxels());
+	addMemoryCounters(state);
+}
+
+BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, ExtractCubicLinear)(benchmark::State &state) {
+	resetAllocations();
+	for (auto _ : state) {
+		voxel::ChunkMesh mesh;
+		voxel::extractCubicMesh(&v, v.region(), &mesh, glm::ivec3(0), true, true, true);
+	}
+	addVoxelCounter(state, v.region().voxels());
+	addMemoryCounters(state);
+}
+
+BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, ExtractCubicBricks)(benchmark::State &state) {
+	resetAllocations();
+	for (auto _ : state) {
+		voxel::ChunkMesh mesh;
+		voxel::extractCubicMesh(&pv, pv.region(), &mesh, glm::ivec3(0), true, true, true);
+	}
+	addVoxelCounter(state, pv.region().voxels());
+	addMemoryCounters(state);
+}
+
+BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, ExtractCubicDense)(benchmark::State &state) {
+	resetAllocations();
+	for (auto _ : state) {
+		voxel::ChunkMesh mesh;
+		voxel::extractCubicMesh(&dense, dense.region(), &mesh, glm::ivec3(0), true, true, state.range(0) != 0);
+	}
+	addVoxelCounter(state, dense.region().voxels());
+	addMemoryCounters(state);
+}
+
+BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, ExtractMarchingCubesDense)(benchmark::State &state) {
+	resetAllocations();
+	palette::Palette palette;
+	palette.nippon();
+	for (auto _ : state) {
+		voxel::ChunkMesh mesh;
+		voxel::SurfaceExtractionContext ctx = voxel::buildMarchingCubesContext(&dense, dense.region(), mesh, palette);
+		voxel::extractSurface(ctx);
+	}
+	addVoxelCounter(state, dense.region().voxels());
+	addMemoryCounters(state);
+}
+
+BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, ExtractMarchingCubesSparse)(benchmark::State &state) {
+	resetAllocations();
+	palette::Palette palette;
+	palette.nippon();
+	for (auto _ : state) {
+		voxel::ChunkMesh mesh;
+		voxel::SurfaceExtractionContext ctx = voxel::buildMarchingCubesContext(&v, v.region(), mesh, palette);
+		voxel::extractSurface(ctx);
+	}
+	addVoxelCounter(state, v.region().voxels());
+	addMemoryCounters(state);
 }
 
 BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, Visit);
+BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, ExtractCubicLinear);
+BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, ExtractCubicBricks);
+BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, ExtractCubicDense)->Arg(0)->Arg(1);
+BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, ExtractMarchingCubesDense);
+BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, ExtractMarchingCubesSparse);
 
 BENCHMARK_MAIN();
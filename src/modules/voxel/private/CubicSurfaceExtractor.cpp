@@ -5,6 +5,7 @@
 #include "CubicSurfaceExtractor.h"
 #include "core/Common.h"
 #include "voxel/ChunkMesh.h"
+#include "voxel/PagedVolume.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
 #include "voxel/VoxelVertex.h"
@@ -16,9 +17,10 @@
 #include "voxel/Region.h"
 #include "core/Trace.h"
 #include "voxel/Face.h"
+#include "core/Allocator.h"
+#include "core/Bits.h"
+#include "core/collection/DynamicArray.h"
 #include <glm/vec3.hpp>
-#include <list>
-#include <vector>
 
 namespace voxel {
 
@@ -40,10 +42,14 @@ const uint32_t MaxVerticesPerPosition = 8;
  */
 
 struct Quad {
-	inline Quad(IndexType v0, IndexType v1, IndexType v2, IndexType v3) : vertices{v0, v1, v2, v3} {
+	inline Quad(IndexType v0, IndexType v1, IndexType v2, IndexType v3, int32_t _u, int32_t _v) :
+			vertices{v0, v1, v2, v3}, u(_u), v(_v) {
 	}
 
 	IndexType vertices[4];
+	// the position of the face in the slice
+	int32_t u;
+	int32_t v;
 };
 
 struct VertexData {
@@ -62,16 +68,20 @@ private:
 public:
 	Array(uint32_t width, uint32_t height, uint32_t depth) :
 			_width(width), _height(height), _depth(depth) {
-		_elements = (VertexData*)core_malloc(width * height * depth * sizeof(VertexData));
+		_elements = (VertexData*)core::FrameAllocator::allocate(bytes());
 		clear();
 	}
 
 	~Array() {
-		core_free(_elements);
+		core::FrameAllocator::deallocate(_elements, bytes());
+	}
+
+	inline size_t bytes() const {
+		return (size_t)_width * _height * _depth * sizeof(VertexData);
 	}
 
 	void clear() {
-		core_memset(_elements, 0x0, _width * _height * _depth * sizeof(VertexData));
+		core_memset(_elements, 0x0, bytes());
 	}
 
 	inline VertexData& operator()(uint32_t x, uint32_t y, uint32_t z) {
@@ -85,10 +95,93 @@ public:
 };
 
 /**
- * @brief Should be a list because random inserts which we need in @c performQuadMerging are O(1)
+ * @brief All the quads of one slice - they are in the same plane and face in the same direction
+ * @note The temporaries of the extraction live in the frame allocator of the extracting thread - see
+ * extractCubicMeshImpl()
+ */
+typedef core::DynamicArray<Quad, 32u, core::FrameAllocator> QuadList;
+typedef core::DynamicArray<QuadList, 32u, core::FrameAllocator> QuadListVector;
+
+/**
+ * @brief Maps the faces of a slice to the quads of the slice. The faces of a row are stored as bits in 64 bit words
+ * to find the next quad and the amount of adjacent quads in a row without looking at every face.
  */
-typedef std::list<Quad> QuadList;
-typedef std::vector<QuadList> QuadListVector;
+class QuadGrid : public core::NonCopyable {
+private:
+	int _width = 0;
+	int _height = 0;
+	int _wordsPerRow = 0;
+	core::DynamicArray<uint64_t, 32u, core::FrameAllocator> _bits;
+	core::DynamicArray<int32_t, 32u, core::FrameAllocator> _quads;
+
+	inline const uint64_t *row(int v) const {
+		return &_bits[(size_t)v * _wordsPerRow];
+	}
+
+public:
+	void init(const QuadList &quads, int width, int height) {
+		_width = width;
+		_height = height;
+		_wordsPerRow = (width + 63) / 64;
+		_bits.resize((size_t)_wordsPerRow * height);
+		_bits.fill(0u);
+		_quads.resize((size_t)width * height);
+		for (size_t i = 0; i < quads.size(); ++i) {
+			const Quad &quad = quads[i];
+			core_assert(quad.u >= 0 && quad.u < width && quad.v >= 0 && quad.v < height);
+			_quads[quad.u + (size_t)quad.v * width] = (int32_t)i;
+			_bits[(size_t)quad.v * _wordsPerRow + (quad.u >> 6)] |= UINT64_C(1) << (quad.u & 63);
+		}
+	}
+
+	inline int32_t quad(int u, int v) const {
+		return _quads[u + (size_t)v * _width];
+	}
+
+	/**
+	 * @return The first position in the row @c v starting at @c u that has a quad or @c -1
+	 */
+	int next(int u, int v) const {
+		const uint64_t *words = row(v);
+		for (int w = u >> 6; w < _wordsPerRow; ++w) {
+			uint64_t word = words[w];
+			if (w == (u >> 6)) {
+				word &= ~((UINT64_C(1) << (u & 63)) - 1u);
+			}
+			if (word != 0u) {
+				return w * 64 + core::countTrailingZeros(word);
+			}
+		}
+		return -1;
+	}
+
+	/**
+	 * @return The amount of adjacent quads in the row @c v starting at @c u
+	 */
+	int run(int u, int v) const {
+		const uint64_t *words = row(v);
+		int length = 0;
+		while (u < _width) {
+			const int bit = u & 63;
+			// the shifted in zeros stop the count at the end of the word
+			const uint64_t inverted = ~(words[u >> 6] >> bit);
+			const int bits = inverted == 0u ? 64 : core::countTrailingZeros(inverted);
+			length += bits;
+			if (bits < 64 - bit) {
+				break;
+			}
+			u += bits;
+		}
+		return length;
+	}
+
+	void remove(int u, int v, int length) {
+		uint64_t *words = &_bits[(size_t)v * _wordsPerRow];
+		for (int i = u; i < u + length; ++i) {
+			words[i >> 6] &= ~(UINT64_C(1) << (i & 63));
+		}
+	}
+};
 
 /**
  * @section Surface extraction
@@ -131,7 +224,7 @@ static CORE_FORCE_INLINE bool isSameColor(const VoxelVertex& v1, const VoxelVert
 	return v1.colorIndex == v2.colorIndex;
 }
 
-static bool mergeQuads(Quad& q1, Quad& q2, Mesh* meshCurrent) {
+static bool mergeQuads(Quad& q1, const Quad& q2, Mesh* meshCurrent) {
 	core_trace_scoped(MergeQuads);
 	const VertexArray& vv = meshCurrent->getVertexVector();
 	const VoxelVertex& v11 = vv[q1.vertices[0]];
@@ -182,7 +275,7 @@ static bool mergeQuads(Quad& q1, Quad& q2, Mesh* meshCurrent) {
 	return false;
 }
 
-static bool mergeQuadsAO(Quad& q1, Quad& q2, Mesh* meshCurrent) {
+static bool mergeQuadsAO(Quad& q1, const Quad& q2, Mesh* meshCurrent) {
 	core_trace_scoped(MergeQuads);
 	const VertexArray& vv = meshCurrent->getVertexVector();
 	const VoxelVertex& v11 = vv[q1.vertices[0]];
@@ -233,54 +326,23 @@ static bool mergeQuadsAO(Quad& q1, Quad& q2, Mesh* meshCurrent) {
 	return false;
 }
 
-static bool performQuadMergingAO(QuadList& quads, Mesh* meshCurrent) {
-	core_trace_scoped(PerformQuadMerging);
-	bool didMerge = false;
-
-	for (QuadList::iterator outerIter = quads.begin(); outerIter != quads.end(); ++outerIter) {
-		QuadList::iterator innerIter = outerIter;
-		++innerIter;
-		while (innerIter != quads.end()) {
-			Quad& q1 = *outerIter;
-			Quad& q2 = *innerIter;
-
-			const bool result = mergeQuadsAO(q1, q2, meshCurrent);
-
-			if (result) {
-				didMerge = true;
-				innerIter = quads.erase(innerIter);
-			} else {
-				++innerIter;
-			}
-		}
+static CORE_FORCE_INLINE bool mergeQuads(Quad& q1, const Quad& q2, Mesh* meshCurrent, bool ambientOcclusion) {
+	if (ambientOcclusion) {
+		return mergeQuadsAO(q1, q2, meshCurrent);
 	}
-
-	return didMerge;
+	return mergeQuads(q1, q2, meshCurrent);
 }
 
-static bool performQuadMerging(QuadList& quads, Mesh* meshCurrent) {
-	core_trace_scoped(PerformQuadMerging);
-	bool didMerge = false;
-
-	for (QuadList::iterator outerIter = quads.begin(); outerIter != quads.end(); ++outerIter) {
-		QuadList::iterator innerIter = outerIter;
-		++innerIter;
-		while (innerIter != quads.end()) {
-			Quad& q1 = *outerIter;
-			Quad& q2 = *innerIter;
-
-			const bool result = mergeQuads(q1, q2, meshCurrent);
-
-			if (result) {
-				didMerge = true;
-				innerIter = quads.erase(innerIter);
-			} else {
-				++innerIter;
-			}
-		}
+/**
+ * @brief Merge the given amount of adjacent quads in the row @c v that follow the quad at @c u into the given quad
+ * @return The amount of quads that are part of the merged quad - starting with the quad at @c u
+ */
+static int mergeRun(const QuadGrid& grid, const QuadList& quads, Quad& quad, int u, int v, int length, Mesh* meshCurrent, bool ambientOcclusion) {
+	int merged = 1;
+	while (merged < length && mergeQuads(quad, quads[grid.quad(u + merged, v)], meshCurrent, ambientOcclusion)) {
+		++merged;
 	}
-
-	return didMerge;
+	return merged;
 }
 
 /**
@@ -311,50 +373,84 @@ CORE_FORCE_INLINE bool isQuadFlipped(const VoxelVertex& v00, const VoxelVertex&
 	return v00.ambientOcclusion + v11.ambientOcclusion > v01.ambientOcclusion + v10.ambientOcclusion;
 }
 
-static void meshify(Mesh* result, bool mergeQuads, bool ambientOcclusion, QuadListVector& vecListQuads) {
+static void addQuad(Mesh* result, const Quad& quad) {
+	const IndexType i0 = quad.vertices[0];
+	const IndexType i1 = quad.vertices[1];
+	const IndexType i2 = quad.vertices[2];
+	const IndexType i3 = quad.vertices[3];
+	const VoxelVertex& v00 = result->getVertex(i3);
+	const VoxelVertex& v01 = result->getVertex(i0);
+	const VoxelVertex& v10 = result->getVertex(i2);
+	const VoxelVertex& v11 = result->getVertex(i1);
+
+	if (isQuadFlipped(v00, v01, v10, v11)) {
+		result->addTriangle(i1, i2, i3);
+		result->addTriangle(i1, i3, i0);
+	} else {
+		result->addTriangle(i0, i1, i2);
+		result->addTriangle(i0, i2, i3);
+	}
+}
+
+/**
+ * @brief Greedy merging of the quads of each slice: the quads of a row are merged as long as the vertices match,
+ * then the following rows are added as long as the same range of quads can be merged into one quad and that quad
+ * can be merged with the quads of the previous rows.
+ *
+ * @param width The size of the slices along the first axis of the plane (@c u of the quads)
+ * @param height The size of the slices along the second axis of the plane (@c v of the quads)
+ */
+static void meshify(Mesh* result, bool mergeQuads, bool ambientOcclusion, QuadListVector& vecListQuads, int width, int height) {
 	core_trace_scoped(GenerateMeshify);
-	for (QuadList& listQuads : vecListQuads) {
-		if (mergeQuads) {
-			core_trace_scoped(MergeQuads);
-			// Repeatedly call this function until it returns
-			// false to indicate nothing more can be done.
-			if (ambientOcclusion) {
-				while (performQuadMergingAO(listQuads, result)) {
-				}
-			} else {
-				while (performQuadMerging(listQuads, result)) {
-				}
+	QuadGrid grid;
+	for (const QuadList& listQuads : vecListQuads) {
+		if (!mergeQuads) {
+			for (const Quad& quad : listQuads) {
+				addQuad(result, quad);
 			}
+			continue;
 		}
-
-		for (const Quad& quad : listQuads) {
-			const IndexType i0 = quad.vertices[0];
-			const IndexType i1 = quad.vertices[1];
-			const IndexType i2 = quad.vertices[2];
-			const IndexType i3 = quad.vertices[3];
-			const VoxelVertex& v00 = result->getVertex(i3);
-			const VoxelVertex& v01 = result->getVertex(i0);
-			const VoxelVertex& v10 = result->getVertex(i2);
-			const VoxelVertex& v11 = result->getVertex(i1);
-
-			if (isQuadFlipped(v00, v01, v10, v11)) {
-				result->addTriangle(i1, i2, i3);
-				result->addTriangle(i1, i3, i0);
-			} else {
-				result->addTriangle(i0, i1, i2);
-				result->addTriangle(i0, i2, i3);
+		if (listQuads.empty()) {
+			continue;
+		}
+		core_trace_scoped(MergeQuads);
+		grid.init(listQuads, width, height);
+		for (int v = 0; v < height; ++v) {
+			for (int u = grid.next(0, v); u != -1; u = grid.next(u, v)) {
+				Quad merged = listQuads[grid.quad(u, v)];
+				const int length = mergeRun(grid, listQuads, merged, u, v, grid.run(u, v), result, ambientOcclusion);
+				grid.remove(u, v, length);
+				for (int nextV = v + 1; nextV < height; ++nextV) {
+					if (grid.run(u, nextV) < length) {
+						break;
+					}
+					Quad strip = listQuads[grid.quad(u, nextV)];
+					if (mergeRun(grid, listQuads, strip, u, nextV, length, result, ambientOcclusion) != length) {
+						break;
+					}
+					if (!voxel::mergeQuads(merged, strip, result, ambientOcclusion)) {
+						break;
+					}
+					grid.remove(u, nextV, length);
+				}
+				addQuad(result, merged);
+				u += length;
 			}
 		}
 	}
 }
 
-static IndexType addVertex(bool reuseVertices, uint32_t x, uint32_t y, uint32_t z, const Voxel& materialIn, Array& existingVertices,
+/**
+ * @param calcAmbientOcclusion If this is @c false the vertices are not occluded at all - this allows to reuse and
+ * merge more of them if the occlusion is applied in a different way
+ */
+static IndexType addVertex(bool reuseVertices, bool calcAmbientOcclusion, uint32_t x, uint32_t y, uint32_t z, const Voxel& materialIn, Array& existingVertices,
 		Mesh* meshCurrent, const VoxelType face1, const VoxelType face2, const VoxelType corner, const glm::ivec3& offset) {
 	core_trace_scoped(AddVertex);
-	const uint8_t ambientOcclusion = vertexAmbientOcclusion(
+	const uint8_t ambientOcclusion = calcAmbientOcclusion ? vertexAmbientOcclusion(
 		!isAir(face1) && !isTransparent(face1),
 		!isAir(face2) && !isTransparent(face2),
-		!isAir(corner) && !isTransparent(corner));
+		!isAir(corner) && !isTransparent(corner)) : 3u;
 
 	for (uint32_t ct = 0; ct < MaxVerticesPerPosition; ++ct) {
 		VertexData& entry = existingVertices(x, y, ct);
@@ -389,8 +485,11 @@ static IndexType addVertex(bool reuseVertices, uint32_t x, uint32_t y, uint32_t
 	return 0; //Should never happen.
 }
 
-void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion, bool optimize) {
+template<class Volume>
+static void extractCubicMeshImpl(const Volume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion, bool optimize, bool vertexOcclusion) {
 	core_trace_scoped(ExtractCubicMesh);
+	// all the quad lists and vertex caches are given back at once when the extraction is done
+	core::FrameAllocatorScope frameAllocatorScope;
 
 	result->clear();
 	const glm::ivec3& offset = region.getLowerCorner();
@@ -429,17 +528,17 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 	vecQuadsT[core::enumVal(FaceNames::NegativeZ)].resize(zSize);
 	vecQuadsT[core::enumVal(FaceNames::PositiveZ)].resize(zSize);
 
-	voxel::RawVolume::Sampler volumeSampler(volData);
+	typename Volume::Sampler volumeSampler(volData);
 
 	{
 	core_trace_scoped(QuadGeneration);
 	volumeSampler.setPosition(offset);
 	for (int32_t z = offset.z; z <= upper.z; ++z) {
 		const uint32_t regZ = z - offset.z;
-		voxel::RawVolume::Sampler volumeSampler2 = volumeSampler;
+		typename Volume::Sampler volumeSampler2 = volumeSampler;
 		for (int32_t x = offset.x; x <= upper.x; ++x) {
 			const uint32_t regX = x - offset.x;
-			voxel::RawVolume::Sampler volumeSampler3 = volumeSampler2;
+			typename Volume::Sampler volumeSampler3 = volumeSampler2;
 			for (int32_t y = offset.y; y <= upper.y; ++y) {
 				const uint32_t regY = y - offset.y;
 
@@ -496,25 +595,25 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 
 				// X [A] LEFT
 				if (isQuadNeeded(voxelCurrentMaterial, voxelLeftMaterial, FaceNames::NegativeX)) {
-					const IndexType v_0_1 = addVertex(reuseVertices, regX, regY,     regZ,     voxelCurrent, previousSliceVertices, &result->mesh[0],
+					const IndexType v_0_1 = addVertex(reuseVertices, vertexOcclusion, regX, regY,     regZ,     voxelCurrent, previousSliceVertices, &result->mesh[0],
 							voxelLeftBeforeMaterial, voxelBelowLeftMaterial, voxelBelowLeftBeforeMaterial, translate);
-					const IndexType v_1_4 = addVertex(reuseVertices, regX, regY,     regZ + 1, voxelCurrent, currentSliceVertices,  &result->mesh[0],
+					const IndexType v_1_4 = addVertex(reuseVertices, vertexOcclusion, regX, regY,     regZ + 1, voxelCurrent, currentSliceVertices,  &result->mesh[0],
 							voxelBelowLeftMaterial, voxelLeftBehindMaterial, voxelBelowLeftBehindMaterial, translate);
-					const IndexType v_2_8 = addVertex(reuseVertices, regX, regY + 1, regZ + 1, voxelCurrent, currentSliceVertices,  &result->mesh[0],
+					const IndexType v_2_8 = addVertex(reuseVertices, vertexOcclusion, regX, regY + 1, regZ + 1, voxelCurrent, currentSliceVertices,  &result->mesh[0],
 							voxelLeftBehindMaterial, voxelAboveLeftMaterial, voxelAboveLeftBehindMaterial, translate);
-					const IndexType v_3_5 = addVertex(reuseVertices, regX, regY + 1, regZ,     voxelCurrent, previousSliceVertices, &result->mesh[0],
+					const IndexType v_3_5 = addVertex(reuseVertices, vertexOcclusion, regX, regY + 1, regZ,     voxelCurrent, previousSliceVertices, &result->mesh[0],
 							voxelAboveLeftMaterial, voxelLeftBeforeMaterial, voxelAboveLeftBeforeMaterial, translate);
-					vecQuads[core::enumVal(FaceNames::NegativeX)][regX].emplace_back(v_0_1, v_1_4, v_2_8, v_3_5);
+					vecQuads[core::enumVal(FaceNames::NegativeX)][regX].emplace_back(v_0_1, v_1_4, v_2_8, v_3_5, regY, regZ);
 				} else if (isTransparentQuadNeeded(voxelCurrentMaterial, voxelLeftMaterial, FaceNames::NegativeX)) {
-					const IndexType v_0_1 = addVertex(reuseVertices, regX, regY,     regZ,     voxelCurrent, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_0_1 = addVertex(reuseVertices, vertexOcclusion, regX, regY,     regZ,     voxelCurrent, previousSliceVerticesT, &result->mesh[1],
 							voxelLeftBeforeMaterial, voxelBelowLeftMaterial, voxelBelowLeftBeforeMaterial, translate);
-					const IndexType v_1_4 = addVertex(reuseVertices, regX, regY,     regZ + 1, voxelCurrent, currentSliceVerticesT,  &result->mesh[1],
+					const IndexType v_1_4 = addVertex(reuseVertices, vertexOcclusion, regX, regY,     regZ + 1, voxelCurrent, currentSliceVerticesT,  &result->mesh[1],
 							voxelBelowLeftMaterial, voxelLeftBehindMaterial, voxelBelowLeftBehindMaterial, translate);
-					const IndexType v_2_8 = addVertex(reuseVertices, regX, regY + 1, regZ + 1, voxelCurrent, currentSliceVerticesT,  &result->mesh[1],
+					const IndexType v_2_8 = addVertex(reuseVertices, vertexOcclusion, regX, regY + 1, regZ + 1, voxelCurrent, currentSliceVerticesT,  &result->mesh[1],
 							voxelLeftBehindMaterial, voxelAboveLeftMaterial, voxelAboveLeftBehindMaterial, translate);
-					const IndexType v_3_5 = addVertex(reuseVertices, regX, regY + 1, regZ,     voxelCurrent, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_3_5 = addVertex(reuseVertices, vertexOcclusion, regX, regY + 1, regZ,     voxelCurrent, previousSliceVerticesT, &result->mesh[1],
 							voxelAboveLeftMaterial, voxelLeftBeforeMaterial, voxelAboveLeftBeforeMaterial, translate);
-					vecQuadsT[core::enumVal(FaceNames::NegativeX)][regX].emplace_back(v_0_1, v_1_4, v_2_8, v_3_5);
+					vecQuadsT[core::enumVal(FaceNames::NegativeX)][regX].emplace_back(v_0_1, v_1_4, v_2_8, v_3_5, regY, regZ);
 				}
 
 				// X [B] RIGHT
@@ -527,15 +626,15 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 					const VoxelType _voxelAboveRightBefore = voxelAboveBefore.getMaterial();
 					const VoxelType _voxelBelowRightBefore = voxelBelowBefore.getMaterial();
 
-					const IndexType v_0_2 = addVertex(reuseVertices, regX, regY,     regZ,     voxelLeft, previousSliceVertices, &result->mesh[0],
+					const IndexType v_0_2 = addVertex(reuseVertices, vertexOcclusion, regX, regY,     regZ,     voxelLeft, previousSliceVertices, &result->mesh[0],
 							voxelBelowMaterial, voxelBeforeMaterial, _voxelBelowRightBefore, translate);
-					const IndexType v_1_3 = addVertex(reuseVertices, regX, regY,     regZ + 1, voxelLeft, currentSliceVertices,  &result->mesh[0],
+					const IndexType v_1_3 = addVertex(reuseVertices, vertexOcclusion, regX, regY,     regZ + 1, voxelLeft, currentSliceVertices,  &result->mesh[0],
 							voxelBelowMaterial, _voxelRightBehind, _voxelBelowRightBehind, translate);
-					const IndexType v_2_7 = addVertex(reuseVertices, regX, regY + 1, regZ + 1, voxelLeft, currentSliceVertices,  &result->mesh[0],
+					const IndexType v_2_7 = addVertex(reuseVertices, vertexOcclusion, regX, regY + 1, regZ + 1, voxelLeft, currentSliceVertices,  &result->mesh[0],
 							_voxelAboveRight, _voxelRightBehind, _voxelAboveRightBehind, translate);
-					const IndexType v_3_6 = addVertex(reuseVertices, regX, regY + 1, regZ,     voxelLeft, previousSliceVertices, &result->mesh[0],
+					const IndexType v_3_6 = addVertex(reuseVertices, vertexOcclusion, regX, regY + 1, regZ,     voxelLeft, previousSliceVertices, &result->mesh[0],
 							_voxelAboveRight, voxelBeforeMaterial, _voxelAboveRightBefore, translate);
-					vecQuads[core::enumVal(FaceNames::PositiveX)][regX].emplace_back(v_0_2, v_3_6, v_2_7, v_1_3);
+					vecQuads[core::enumVal(FaceNames::PositiveX)][regX].emplace_back(v_0_2, v_3_6, v_2_7, v_1_3, regY, regZ);
 				} else if (isTransparentQuadNeeded(voxelLeftMaterial, voxelCurrentMaterial, FaceNames::PositiveX)) {
 					const VoxelType _voxelRightBehind      = volumeSampler3.peekVoxel0px0py1pz().getMaterial();
 					const VoxelType _voxelAboveRight       = volumeSampler3.peekVoxel0px1py0pz().getMaterial();
@@ -545,15 +644,15 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 					const VoxelType _voxelAboveRightBefore = voxelAboveBefore.getMaterial();
 					const VoxelType _voxelBelowRightBefore = voxelBelowBefore.getMaterial();
 
-					const IndexType v_0_2 = addVertex(reuseVertices, regX, regY,     regZ,     voxelLeft, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_0_2 = addVertex(reuseVertices, vertexOcclusion, regX, regY,     regZ,     voxelLeft, previousSliceVerticesT, &result->mesh[1],
 							voxelBelowMaterial, voxelBeforeMaterial, _voxelBelowRightBefore, translate);
-					const IndexType v_1_3 = addVertex(reuseVertices, regX, regY,     regZ + 1, voxelLeft, currentSliceVerticesT,  &result->mesh[1],
+					const IndexType v_1_3 = addVertex(reuseVertices, vertexOcclusion, regX, regY,     regZ + 1, voxelLeft, currentSliceVerticesT,  &result->mesh[1],
 							voxelBelowMaterial, _voxelRightBehind, _voxelBelowRightBehind, translate);
-					const IndexType v_2_7 = addVertex(reuseVertices, regX, regY + 1, regZ + 1, voxelLeft, currentSliceVerticesT,  &result->mesh[1],
+					const IndexType v_2_7 = addVertex(reuseVertices, vertexOcclusion, regX, regY + 1, regZ + 1, voxelLeft, currentSliceVerticesT,  &result->mesh[1],
 							_voxelAboveRight, _voxelRightBehind, _voxelAboveRightBehind, translate);
-					const IndexType v_3_6 = addVertex(reuseVertices, regX, regY + 1, regZ,     voxelLeft, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_3_6 = addVertex(reuseVertices, vertexOcclusion, regX, regY + 1, regZ,     voxelLeft, previousSliceVerticesT, &result->mesh[1],
 							_voxelAboveRight, voxelBeforeMaterial, _voxelAboveRightBefore, translate);
-					vecQuadsT[core::enumVal(FaceNames::PositiveX)][regX].emplace_back(v_0_2, v_3_6, v_2_7, v_1_3);
+					vecQuadsT[core::enumVal(FaceNames::PositiveX)][regX].emplace_back(v_0_2, v_3_6, v_2_7, v_1_3, regY, regZ);
 				}
 
 				// Y [C] BELOW
@@ -568,15 +667,15 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 					const VoxelType voxelBelowBehindMaterial      = voxelBelowBehind.getMaterial();
 					const VoxelType voxelBelowRightBehindMaterial = voxelBelowRightBehind.getMaterial();
 
-					const IndexType v_0_1 = addVertex(reuseVertices, regX,     regY, regZ,     voxelCurrent, previousSliceVertices, &result->mesh[0],
+					const IndexType v_0_1 = addVertex(reuseVertices, vertexOcclusion, regX,     regY, regZ,     voxelCurrent, previousSliceVertices, &result->mesh[0],
 							voxelBelowBeforeMaterial, voxelBelowLeftMaterial, voxelBelowLeftBeforeMaterial, translate);
-					const IndexType v_1_2 = addVertex(reuseVertices, regX + 1, regY, regZ,     voxelCurrent, previousSliceVertices, &result->mesh[0],
+					const IndexType v_1_2 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY, regZ,     voxelCurrent, previousSliceVertices, &result->mesh[0],
 							voxelBelowRightMaterial, voxelBelowBeforeMaterial, voxelBelowRightBeforeMaterial, translate);
-					const IndexType v_2_3 = addVertex(reuseVertices, regX + 1, regY, regZ + 1, voxelCurrent, currentSliceVertices,  &result->mesh[0],
+					const IndexType v_2_3 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY, regZ + 1, voxelCurrent, currentSliceVertices,  &result->mesh[0],
 							voxelBelowBehindMaterial, voxelBelowRightMaterial, voxelBelowRightBehindMaterial, translate);
-					const IndexType v_3_4 = addVertex(reuseVertices, regX,     regY, regZ + 1, voxelCurrent, currentSliceVertices,  &result->mesh[0],
+					const IndexType v_3_4 = addVertex(reuseVertices, vertexOcclusion, regX,     regY, regZ + 1, voxelCurrent, currentSliceVertices,  &result->mesh[0],
 							voxelBelowLeftMaterial, voxelBelowBehindMaterial, voxelBelowLeftBehindMaterial, translate);
-					vecQuads[core::enumVal(FaceNames::NegativeY)][regY].emplace_back(v_0_1, v_1_2, v_2_3, v_3_4);
+					vecQuads[core::enumVal(FaceNames::NegativeY)][regY].emplace_back(v_0_1, v_1_2, v_2_3, v_3_4, regX, regZ);
 				} else if (isTransparentQuadNeeded(voxelCurrentMaterial, voxelBelowMaterial, FaceNames::NegativeY)) {
 					const Voxel& voxelBelowRightBehind = volumeSampler3.peekVoxel1px1ny1pz();
 					const Voxel& voxelBelowRight       = volumeSampler3.peekVoxel1px1ny0pz();
@@ -588,15 +687,15 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 					const VoxelType voxelBelowBehindMaterial      = voxelBelowBehind.getMaterial();
 					const VoxelType voxelBelowRightBehindMaterial = voxelBelowRightBehind.getMaterial();
 
-					const IndexType v_0_1 = addVertex(reuseVertices, regX,     regY, regZ,     voxelCurrent, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_0_1 = addVertex(reuseVertices, vertexOcclusion, regX,     regY, regZ,     voxelCurrent, previousSliceVerticesT, &result->mesh[1],
 							voxelBelowBeforeMaterial, voxelBelowLeftMaterial, voxelBelowLeftBeforeMaterial, translate);
-					const IndexType v_1_2 = addVertex(reuseVertices, regX + 1, regY, regZ,     voxelCurrent, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_1_2 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY, regZ,     voxelCurrent, previousSliceVerticesT, &result->mesh[1],
 							voxelBelowRightMaterial, voxelBelowBeforeMaterial, voxelBelowRightBeforeMaterial, translate);
-					const IndexType v_2_3 = addVertex(reuseVertices, regX + 1, regY, regZ + 1, voxelCurrent, currentSliceVerticesT,  &result->mesh[1],
+					const IndexType v_2_3 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY, regZ + 1, voxelCurrent, currentSliceVerticesT,  &result->mesh[1],
 							voxelBelowBehindMaterial, voxelBelowRightMaterial, voxelBelowRightBehindMaterial, translate);
-					const IndexType v_3_4 = addVertex(reuseVertices, regX,     regY, regZ + 1, voxelCurrent, currentSliceVerticesT,  &result->mesh[1],
+					const IndexType v_3_4 = addVertex(reuseVertices, vertexOcclusion, regX,     regY, regZ + 1, voxelCurrent, currentSliceVerticesT,  &result->mesh[1],
 							voxelBelowLeftMaterial, voxelBelowBehindMaterial, voxelBelowLeftBehindMaterial, translate);
-					vecQuadsT[core::enumVal(FaceNames::NegativeY)][regY].emplace_back(v_0_1, v_1_2, v_2_3, v_3_4);
+					vecQuadsT[core::enumVal(FaceNames::NegativeY)][regY].emplace_back(v_0_1, v_1_2, v_2_3, v_3_4, regX, regZ);
 				}
 
 
@@ -609,15 +708,15 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 					const VoxelType _voxelAboveRightBefore = voxelRightBefore.getMaterial();
 					const VoxelType _voxelAboveLeftBehind  = voxelLeftBehind.getMaterial();
 
-					const IndexType v_0_5 = addVertex(reuseVertices, regX,     regY, regZ,     voxelBelow, previousSliceVertices, &result->mesh[0],
+					const IndexType v_0_5 = addVertex(reuseVertices, vertexOcclusion, regX,     regY, regZ,     voxelBelow, previousSliceVertices, &result->mesh[0],
 							voxelBeforeMaterial, voxelLeftMaterial, voxelLeftBeforeMaterial, translate);
-					const IndexType v_1_6 = addVertex(reuseVertices, regX + 1, regY, regZ,     voxelBelow, previousSliceVertices, &result->mesh[0],
+					const IndexType v_1_6 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY, regZ,     voxelBelow, previousSliceVertices, &result->mesh[0],
 							_voxelAboveRight, voxelBeforeMaterial, _voxelAboveRightBefore, translate);
-					const IndexType v_2_7 = addVertex(reuseVertices, regX + 1, regY, regZ + 1, voxelBelow, currentSliceVertices,  &result->mesh[0],
+					const IndexType v_2_7 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY, regZ + 1, voxelBelow, currentSliceVertices,  &result->mesh[0],
 							_voxelAboveBehind, _voxelAboveRight, _voxelAboveRightBehind, translate);
-					const IndexType v_3_8 = addVertex(reuseVertices, regX,     regY, regZ + 1, voxelBelow, currentSliceVertices,  &result->mesh[0],
+					const IndexType v_3_8 = addVertex(reuseVertices, vertexOcclusion, regX,     regY, regZ + 1, voxelBelow, currentSliceVertices,  &result->mesh[0],
 							voxelLeftMaterial, _voxelAboveBehind, _voxelAboveLeftBehind, translate);
-					vecQuads[core::enumVal(FaceNames::PositiveY)][regY].emplace_back(v_0_5, v_3_8, v_2_7, v_1_6);
+					vecQuads[core::enumVal(FaceNames::PositiveY)][regY].emplace_back(v_0_5, v_3_8, v_2_7, v_1_6, regX, regZ);
 				} else if (isTransparentQuadNeeded(voxelBelowMaterial, voxelCurrentMaterial, FaceNames::PositiveY)) {
 					const VoxelType _voxelAboveRight       = volumeSampler3.peekVoxel1px0py0pz().getMaterial();
 					const VoxelType _voxelAboveBehind      = volumeSampler3.peekVoxel0px0py1pz().getMaterial();
@@ -626,15 +725,15 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 					const VoxelType _voxelAboveRightBefore = voxelRightBefore.getMaterial();
 					const VoxelType _voxelAboveLeftBehind  = voxelLeftBehind.getMaterial();
 
-					const IndexType v_0_5 = addVertex(reuseVertices, regX,     regY, regZ,     voxelBelow, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_0_5 = addVertex(reuseVertices, vertexOcclusion, regX,     regY, regZ,     voxelBelow, previousSliceVerticesT, &result->mesh[1],
 							voxelBeforeMaterial, voxelLeftMaterial, voxelLeftBeforeMaterial, translate);
-					const IndexType v_1_6 = addVertex(reuseVertices, regX + 1, regY, regZ,     voxelBelow, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_1_6 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY, regZ,     voxelBelow, previousSliceVerticesT, &result->mesh[1],
 							_voxelAboveRight, voxelBeforeMaterial, _voxelAboveRightBefore, translate);
-					const IndexType v_2_7 = addVertex(reuseVertices, regX + 1, regY, regZ + 1, voxelBelow, currentSliceVerticesT,  &result->mesh[1],
+					const IndexType v_2_7 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY, regZ + 1, voxelBelow, currentSliceVerticesT,  &result->mesh[1],
 							_voxelAboveBehind, _voxelAboveRight, _voxelAboveRightBehind, translate);
-					const IndexType v_3_8 = addVertex(reuseVertices, regX,     regY, regZ + 1, voxelBelow, currentSliceVerticesT,  &result->mesh[1],
+					const IndexType v_3_8 = addVertex(reuseVertices, vertexOcclusion, regX,     regY, regZ + 1, voxelBelow, currentSliceVerticesT,  &result->mesh[1],
 							voxelLeftMaterial, _voxelAboveBehind, _voxelAboveLeftBehind, translate);
-					vecQuadsT[core::enumVal(FaceNames::PositiveY)][regY].emplace_back(v_0_5, v_3_8, v_2_7, v_1_6);
+					vecQuadsT[core::enumVal(FaceNames::PositiveY)][regY].emplace_back(v_0_5, v_3_8, v_2_7, v_1_6, regX, regZ);
 				}
 
 				// Z [E] BEFORE
@@ -645,15 +744,15 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 					const VoxelType voxelAboveRightBeforeMaterial = voxelAboveRightBefore.getMaterial();
 					const VoxelType voxelBelowRightBeforeMaterial = voxelBelowRightBefore.getMaterial();
 
-					const IndexType v_0_1 = addVertex(reuseVertices, regX,     regY,     regZ, voxelCurrent, previousSliceVertices, &result->mesh[0],
+					const IndexType v_0_1 = addVertex(reuseVertices, vertexOcclusion, regX,     regY,     regZ, voxelCurrent, previousSliceVertices, &result->mesh[0],
 							voxelBelowBeforeMaterial, voxelLeftBeforeMaterial, voxelBelowLeftBeforeMaterial, translate); //1
-					const IndexType v_1_5 = addVertex(reuseVertices, regX,     regY + 1, regZ, voxelCurrent, previousSliceVertices, &result->mesh[0],
+					const IndexType v_1_5 = addVertex(reuseVertices, vertexOcclusion, regX,     regY + 1, regZ, voxelCurrent, previousSliceVertices, &result->mesh[0],
 							voxelAboveBeforeMaterial, voxelLeftBeforeMaterial, voxelAboveLeftBeforeMaterial, translate); //5
-					const IndexType v_2_6 = addVertex(reuseVertices, regX + 1, regY + 1, regZ, voxelCurrent, previousSliceVertices, &result->mesh[0],
+					const IndexType v_2_6 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY + 1, regZ, voxelCurrent, previousSliceVertices, &result->mesh[0],
 							voxelAboveBeforeMaterial, voxelRightBeforeMaterial, voxelAboveRightBeforeMaterial, translate); //6
-					const IndexType v_3_2 = addVertex(reuseVertices, regX + 1, regY,     regZ, voxelCurrent, previousSliceVertices, &result->mesh[0],
+					const IndexType v_3_2 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY,     regZ, voxelCurrent, previousSliceVertices, &result->mesh[0],
 							voxelBelowBeforeMaterial, voxelRightBeforeMaterial, voxelBelowRightBeforeMaterial, translate); //2
-					vecQuads[core::enumVal(FaceNames::NegativeZ)][regZ].emplace_back(v_0_1, v_1_5, v_2_6, v_3_2);
+					vecQuads[core::enumVal(FaceNames::NegativeZ)][regZ].emplace_back(v_0_1, v_1_5, v_2_6, v_3_2, regX, regY);
 				} else if (isTransparentQuadNeeded(voxelCurrentMaterial, voxelBeforeMaterial, FaceNames::NegativeZ)) {
 					const VoxelType voxelBelowBeforeMaterial = voxelBelowBefore.getMaterial();
 					const VoxelType voxelAboveBeforeMaterial = voxelAboveBefore.getMaterial();
@@ -661,15 +760,15 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 					const VoxelType voxelAboveRightBeforeMaterial = voxelAboveRightBefore.getMaterial();
 					const VoxelType voxelBelowRightBeforeMaterial = voxelBelowRightBefore.getMaterial();
 
-					const IndexType v_0_1 = addVertex(reuseVertices, regX,     regY,     regZ, voxelCurrent, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_0_1 = addVertex(reuseVertices, vertexOcclusion, regX,     regY,     regZ, voxelCurrent, previousSliceVerticesT, &result->mesh[1],
 							voxelBelowBeforeMaterial, voxelLeftBeforeMaterial, voxelBelowLeftBeforeMaterial, translate); //1
-					const IndexType v_1_5 = addVertex(reuseVertices, regX,     regY + 1, regZ, voxelCurrent, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_1_5 = addVertex(reuseVertices, vertexOcclusion, regX,     regY + 1, regZ, voxelCurrent, previousSliceVerticesT, &result->mesh[1],
 							voxelAboveBeforeMaterial, voxelLeftBeforeMaterial, voxelAboveLeftBeforeMaterial, translate); //5
-					const IndexType v_2_6 = addVertex(reuseVertices, regX + 1, regY + 1, regZ, voxelCurrent, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_2_6 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY + 1, regZ, voxelCurrent, previousSliceVerticesT, &result->mesh[1],
 							voxelAboveBeforeMaterial, voxelRightBeforeMaterial, voxelAboveRightBeforeMaterial, translate); //6
-					const IndexType v_3_2 = addVertex(reuseVertices, regX + 1, regY,     regZ, voxelCurrent, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_3_2 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY,     regZ, voxelCurrent, previousSliceVerticesT, &result->mesh[1],
 							voxelBelowBeforeMaterial, voxelRightBeforeMaterial, voxelBelowRightBeforeMaterial, translate); //2
-					vecQuadsT[core::enumVal(FaceNames::NegativeZ)][regZ].emplace_back(v_0_1, v_1_5, v_2_6, v_3_2);
+					vecQuadsT[core::enumVal(FaceNames::NegativeZ)][regZ].emplace_back(v_0_1, v_1_5, v_2_6, v_3_2, regX, regY);
 				}
 
 				// Z [F] BEHIND
@@ -679,30 +778,30 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 					const VoxelType _voxelAboveRightBehind = volumeSampler3.peekVoxel1px1py0pz().getMaterial();
 					const VoxelType _voxelBelowRightBehind = volumeSampler3.peekVoxel1px1ny0pz().getMaterial();
 
-					const IndexType v_0_4 = addVertex(reuseVertices, regX,     regY,     regZ, voxelBefore, previousSliceVertices, &result->mesh[0],
+					const IndexType v_0_4 = addVertex(reuseVertices, vertexOcclusion, regX,     regY,     regZ, voxelBefore, previousSliceVertices, &result->mesh[0],
 							voxelBelowMaterial, voxelLeftMaterial, voxelBelowLeftMaterial, translate); //4
-					const IndexType v_1_8 = addVertex(reuseVertices, regX,     regY + 1, regZ, voxelBefore, previousSliceVertices, &result->mesh[0],
+					const IndexType v_1_8 = addVertex(reuseVertices, vertexOcclusion, regX,     regY + 1, regZ, voxelBefore, previousSliceVertices, &result->mesh[0],
 							_voxelAboveBehind, voxelLeftMaterial, voxelAboveLeftMaterial, translate); //8
-					const IndexType v_2_7 = addVertex(reuseVertices, regX + 1, regY + 1, regZ, voxelBefore, previousSliceVertices, &result->mesh[0],
+					const IndexType v_2_7 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY + 1, regZ, voxelBefore, previousSliceVertices, &result->mesh[0],
 							_voxelAboveBehind, _voxelRightBehind, _voxelAboveRightBehind, translate); //7
-					const IndexType v_3_3 = addVertex(reuseVertices, regX + 1, regY,     regZ, voxelBefore, previousSliceVertices, &result->mesh[0],
+					const IndexType v_3_3 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY,     regZ, voxelBefore, previousSliceVertices, &result->mesh[0],
 							voxelBelowMaterial, _voxelRightBehind, _voxelBelowRightBehind, translate); //3
-					vecQuads[core::enumVal(FaceNames::PositiveZ)][regZ].emplace_back(v_0_4, v_3_3, v_2_7, v_1_8);
+					vecQuads[core::enumVal(FaceNames::PositiveZ)][regZ].emplace_back(v_0_4, v_3_3, v_2_7, v_1_8, regX, regY);
 				} else if (isTransparentQuadNeeded(voxelBeforeMaterial, voxelCurrentMaterial, FaceNames::PositiveZ)) {
 					const VoxelType _voxelRightBehind      = volumeSampler3.peekVoxel1px0py1pz().getMaterial();
 					const VoxelType _voxelAboveBehind      = volumeSampler3.peekVoxel0px1py0pz().getMaterial();
 					const VoxelType _voxelAboveRightBehind = volumeSampler3.peekVoxel1px1py0pz().getMaterial();
 					const VoxelType _voxelBelowRightBehind = volumeSampler3.peekVoxel1px1ny0pz().getMaterial();
 
-					const IndexType v_0_4 = addVertex(reuseVertices, regX,     regY,     regZ, voxelBefore, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_0_4 = addVertex(reuseVertices, vertexOcclusion, regX,     regY,     regZ, voxelBefore, previousSliceVerticesT, &result->mesh[1],
 							voxelBelowMaterial, voxelLeftMaterial, voxelBelowLeftMaterial, translate); //4
-					const IndexType v_1_8 = addVertex(reuseVertices, regX,     regY + 1, regZ, voxelBefore, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_1_8 = addVertex(reuseVertices, vertexOcclusion, regX,     regY + 1, regZ, voxelBefore, previousSliceVerticesT, &result->mesh[1],
 							_voxelAboveBehind, voxelLeftMaterial, voxelAboveLeftMaterial, translate); //8
-					const IndexType v_2_7 = addVertex(reuseVertices, regX + 1, regY + 1, regZ, voxelBefore, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_2_7 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY + 1, regZ, voxelBefore, previousSliceVerticesT, &result->mesh[1],
 							_voxelAboveBehind, _voxelRightBehind, _voxelAboveRightBehind, translate); //7
-					const IndexType v_3_3 = addVertex(reuseVertices, regX + 1, regY,     regZ, voxelBefore, previousSliceVerticesT, &result->mesh[1],
+					const IndexType v_3_3 = addVertex(reuseVertices, vertexOcclusion, regX + 1, regY,     regZ, voxelBefore, previousSliceVerticesT, &result->mesh[1],
 							voxelBelowMaterial, _voxelRightBehind, _voxelBelowRightBehind, translate); //3
-					vecQuadsT[core::enumVal(FaceNames::PositiveZ)][regZ].emplace_back(v_0_4, v_3_3, v_2_7, v_1_8);
+					vecQuadsT[core::enumVal(FaceNames::PositiveZ)][regZ].emplace_back(v_0_4, v_3_3, v_2_7, v_1_8, regX, regY);
 				}
 				volumeSampler3.movePositiveY();
 			}
@@ -719,14 +818,27 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 
 	{
 		core_trace_scoped(GenerateMesh);
-		for (QuadListVector& vecListQuads : vecQuads) {
-			meshify(&result->mesh[0], mergeQuads, ambientOcclusion, vecListQuads);
-		}
-		for (QuadListVector& vecListQuads : vecQuadsT) {
-			meshify(&result->mesh[1], mergeQuads, ambientOcclusion, vecListQuads);
+		for (int face = 0; face < core::enumVal(FaceNames::Max); ++face) {
+			const FaceNames faceName = (FaceNames)face;
+			// the size of the slices along the two axes of the plane
+			int width;
+			int height;
+			if (faceName == FaceNames::NegativeX || faceName == FaceNames::PositiveX) {
+				width = ySize - 1;
+				height = zSize - 1;
+			} else if (faceName == FaceNames::NegativeY || faceName == FaceNames::PositiveY) {
+				width = xSize - 1;
+				height = zSize - 1;
+			} else {
+				width = xSize - 1;
+				height = ySize - 1;
+			}
+			meshify(&result->mesh[0], mergeQuads, ambientOcclusion, vecQuads[face], width, height);
+			meshify(&result->mesh[1], mergeQuads, ambientOcclusion, vecQuadsT[face], width, height);
 		}
 	}
 
+	core_trace_scoped(PostProcessMesh);
 	if (optimize) {
 		result->optimize();
 	}
@@ -734,4 +846,12 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 	result->compressIndices();
 }
 
+void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion, bool optimize, bool vertexOcclusion) {
+	extractCubicMeshImpl(volData, region, result, translate, mergeQuads, reuseVertices, ambientOcclusion, optimize, vertexOcclusion);
+}
+
+void extractCubicMesh(const voxel::PagedVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion, bool optimize, bool vertexOcclusion) {
+	extractCubicMeshImpl(volData, region, result, translate, mergeQuads, reuseVertices, ambientOcclusion, optimize, vertexOcclusion);
+}
+
 }
@@ -13,6 +13,7 @@ class Palette;
 namespace voxel {
 
 class RawVolume;
+class PagedVolume;
 class Region;
 struct ChunkMesh;
 
@@ -98,7 +99,18 @@ struct ChunkMesh;
  * @li It leaves the user in control of memory allocation and would allow them to implement e.g. a mesh pooling system.
  * @li The user-provided mesh could have a different index type (e.g. 16-bit indices) to reduce memory usage.
  * @li The user could provide a custom mesh class, e.g a thin wrapper around an openGL VBO to allow direct writing into this structure.
+ *
+ * @param ambientOcclusion Only merge quads with the same ambient occlusion values of their vertices
+ * @param vertexOcclusion If this is @c false the vertices are not occluded at all (the value is @c 3) - see
+ * @c SurfaceExtractionContext::vertexOcclusion
+ */
+void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true, bool optimize = false, bool vertexOcclusion = true);
+
+/**
+ * @brief Same as above - but for the brick tiled volume. The neighbour lookups that are done for every voxel stay inside
+ * of one brick for most of the voxels.
+ * @sa PagedVolume
  */
-void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true, bool optimize = false);
+void extractCubicMesh(const voxel::PagedVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true, bool optimize = false, bool vertexOcclusion = true);
 
 }
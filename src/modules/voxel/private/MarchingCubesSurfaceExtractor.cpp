@@ -5,6 +5,8 @@
 #include "MarchingCubesSurfaceExtractor.h"
 #include "core/Color.h"
 #include "core/Common.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
 #include "core/collection/Array2DView.h"
 #include "MarchingCubesTables.h"
 #include "math/Axis.h"
@@ -45,30 +47,70 @@ static inline Voxel blendMaterials(const palette::Palette &palette, const Voxel
 	return createVoxel(palette, palIdx);
 }
 
-// Gradient estimation
-static glm::vec3 computeCentralDifferenceGradient(const RawVolume::Sampler &volIter) {
-	const float voxel1nx = convertToDensity(volIter.peekVoxel1nx0py0pz());
-	const float voxel1px = convertToDensity(volIter.peekVoxel1px0py0pz());
-
-	const float voxel1ny = convertToDensity(volIter.peekVoxel0px1ny0pz());
-	const float voxel1py = convertToDensity(volIter.peekVoxel0px1py0pz());
+// The voxels of the slices are converted into planes of one byte per voxel (1 for voxels below the threshold) with a
+// border of one voxel around the region. The cell indices of a whole row are combined from two planes without any
+// branch (the bits of the border don't generate a vertex or triangle) and the gradients are computed from the planes
+// instead of sampling the volume again.
+static constexpr int32_t SlicePlanes = 4; // z - 2 to z + 1 are needed for the gradients of the vertices
+
+static void fillSlicePlane(const RawVolume *volume, const Region &region, int32_t z, uint8_t *plane) {
+	const int32_t w = region.getWidthInVoxels() + 2;
+	const int32_t h = region.getHeightInVoxels() + 2;
+	const Region &volumeRegion = volume->region();
+	const int32_t lowerX = region.getLowerX() - 1;
+	// the voxels outside of the volume are the border voxels
+	const uint8_t border = isAir(volume->voxel(volumeRegion.getUpperCorner() + 1).getMaterial()) ? 1u : 0u;
+	const int32_t insideLowerX = core_max(lowerX, volumeRegion.getLowerX());
+	const int32_t insideUpperX = core_min(region.getUpperX() + 1, volumeRegion.getUpperX());
+	for (int32_t y = 0; y < h; ++y) {
+		uint8_t *target = plane + y * w;
+		const glm::ivec3 pos(insideLowerX, region.getLowerY() - 1 + y, z);
+		if (insideLowerX > insideUpperX || !volumeRegion.containsPoint(pos)) {
+			core_memset(target, border, w);
+			continue;
+		}
+		const int32_t before = insideLowerX - lowerX;
+		const int32_t inside = insideUpperX - insideLowerX + 1;
+		core_memset(target, border, before);
+		const Voxel *voxels = volume->row(pos);
+		for (int32_t x = 0; x < inside; ++x) {
+			target[before + x] = isAir(voxels[x].getMaterial()) ? 1u : 0u;
+		}
+		core_memset(target + before + inside, border, w - before - inside);
+	}
+}
 
-	const float voxel1nz = convertToDensity(volIter.peekVoxel0px0py1nz());
-	const float voxel1pz = convertToDensity(volIter.peekVoxel0px0py1pz());
+// Each bit of the cell index specifies whether a given corner of the cell is below the threshold. The pointers are
+// pointing to the border column of the planes for the current row.
+static void buildCellIndices(const uint8_t *current, const uint8_t *previous, int32_t w, int32_t stride,
+							 uint8_t *cellIndices) {
+	const uint8_t *currentBelow = current - stride;
+	const uint8_t *previousBelow = previous - stride;
+	for (int32_t x = 0; x < w; ++x) {
+		cellIndices[x] = (uint8_t)((current[x + 1] << 7) | (current[x] << 6) | (currentBelow[x + 1] << 5) |
+								   (currentBelow[x] << 4) | (previous[x + 1] << 3) | (previous[x] << 2) |
+								   (previousBelow[x + 1] << 1) | previousBelow[x]);
+	}
+}
 
-	return glm::vec3(voxel1nx - voxel1px, voxel1ny - voxel1py, voxel1nz - voxel1pz);
+// Gradient estimation - the central difference of the densities of the neighbours of the voxel at the given index
+static inline glm::vec3 computeCentralDifferenceGradient(const uint8_t *below, const uint8_t *current,
+														 const uint8_t *above, int32_t idx, int32_t stride) {
+	// the planes are 1 for a density of 0 - so the negated difference is used
+	return glm::vec3((int)current[idx + 1] - (int)current[idx - 1],
+					 (int)current[idx + stride] - (int)current[idx - stride], (int)above[idx] - (int)below[idx]) *
+		   MarchingCubeMaxDensity;
 }
 
 static void generateVertex(math::Axis axis, const palette::Palette &palette, RawVolume::Sampler &sampler,
 				   ChunkMesh *result, core::Array2DView<glm::ivec3> &indicesView,
-				   const Voxel &v111, const glm::vec3 &n111, float v111Density, int x, int y) {
+				   const Voxel &v111, const glm::vec3 &n111, const glm::vec3 &n110, float v111Density, int x, int y) {
 	sampler.moveNegative(axis);
 	const Voxel v110 = sampler.voxel();
 	const float v110Density = convertToDensity(v110);
 	const float interpolate = (DensityThreshold - v110Density) / (v111Density - v110Density);
 
 	// Compute the normal
-	const glm::vec3 n110 = computeCentralDifferenceGradient(sampler);
 	glm::vec3 normal = (n111 * interpolate) + (n110 * (1 - interpolate));
 
 	// The gradient for a voxel can be zero (e.g. solid voxel surrounded by empty ones) and so
@@ -98,6 +140,7 @@ static void generateVertex(math::Axis axis, const palette::Palette &palette, Raw
 void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &palette, const Region &region, ChunkMesh *result, bool optimize) {
 	core_assert_msg(volume != nullptr, "Provided volume cannot be null");
 	core_assert_msg(result != nullptr, "Provided mesh cannot be null");
+	core_trace_scoped(ExtractMarchingCubesMesh);
 
 	result->clear();
 
@@ -106,14 +149,18 @@ void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &p
 	const int32_t h = region.getHeightInVoxels();
 	const int32_t d = region.getDepthInVoxels();
 
-	// A naive implementation of Marching Cubes might sample the eight corner voxels of every cell to determine the cell
-	// index. However, when processing the cells sequentially we can observe that many of the voxels are shared with
-	// previous adjacent cells, and so we can obtain these by careful bit-shifting. These variables keep track of
-	// previous cells for this purpose.
-	uint8_t previousCellIndex = 0;
-	core::DynamicArray<uint8_t> previousRowCellIndices(w);
-	core::DynamicArray<uint8_t> previousSliceCellIndicesBuf((size_t)(w * h));
-	core::Array2DView<uint8_t> previousSliceCellIndicesView(previousSliceCellIndicesBuf.data(), w, h);
+	// The voxels of the slices z - 2 to z + 1 - see fillSlicePlane()
+	const int32_t stride = w + 2;
+	const int32_t planeSize = stride * (h + 2);
+	core::DynamicArray<uint8_t> planesBuf((size_t)(planeSize * SlicePlanes));
+	auto plane = [&planesBuf, planeSize](int32_t z) {
+		return planesBuf.data() + ((z + SlicePlanes) % SlicePlanes) * planeSize;
+	};
+	for (int32_t z = -2; z <= 0; ++z) {
+		fillSlicePlane(volume, region, region.getLowerZ() + z, plane(z));
+	}
+	// The cell indices of the current row - padded to test groups of cells at once
+	core::DynamicArray<uint8_t> cellIndices((size_t)w + sizeof(uint64_t));
 
 	// A given vertex may be shared by multiple triangles, so we need to keep track of the indices into the vertex
 	// array.
@@ -133,87 +180,66 @@ void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &p
 		core::Array2DView<glm::ivec3> indicesView(indicesBuf.data(), w, h);
 		core::Array2DView<glm::ivec3> previousIndicesView(previousIndicesBuf.data(), w, h);
 
+		fillSlicePlane(volume, region, region.getLowerZ() + z + 1, plane(z + 1));
+		const uint8_t *planeBelow = plane(z - 2);
+		const uint8_t *previousPlane = plane(z - 1);
+		const uint8_t *currentPlane = plane(z);
+		const uint8_t *nextPlane = plane(z + 1);
+
 		for (int32_t y = 0; y < h; y++) {
+			const int32_t rowIdx = (y + 1) * stride;
+			buildCellIndices(currentPlane + rowIdx, previousPlane + rowIdx, w, stride, cellIndices.data());
+
 			// Copying a sampler which is already pointing at the correct location seems (slightly) faster than
 			// calling setPosition(). Therefore we make use of 'startOfRow' and 'startOfSlice' to reset the sampler.
+			// It's only moved forward to the occupied cells.
 			RawVolume::Sampler sampler = startOfRow;
+			int32_t samplerX = 0;
 
 			for (int32_t x = 0; x < w; x++) {
-				// Note: In many cases the provided region will be (mostly) empty which means mesh vertices/indices
-				// are not generated and the only thing that is done for each cell is the computation of "cellIndex".
-				// It appears that retrieving the voxel value is not so expensive and that it is the bitwise combining
-				// which actually carries the cost.
-				//
-				// If we really need to speed this up more then it may be possible to pack 4 8-bit cell indices into
-				// a single 32-bit value and then perform the bitwise logic on all four of them at the same time.
-				// However, this complicates the code and there would still be the cost of packing/unpacking so it's
-				// not clear if there is really a benefit. It's something to consider in the future.
-
-				// Each bit of the cell index specifies whether a given corner of the cell is above or below the
-				// threshold.
-				uint8_t cellIndex = 0;
-
-				// Four bits of our cube index are obtained by looking at the cube index for
-				// the previous slice and copying four of those bits into their new positions.
-				uint8_t previousCellIndexZ = previousSliceCellIndicesView.get(x, y);
-				previousCellIndexZ >>= 4;
-				cellIndex |= previousCellIndexZ;
-
-				// Two bits of our cube index are obtained by looking at the cube index for
-				// the previous row and copying two of those bits into their new positions.
-				uint8_t previousCellIndexY = previousRowCellIndices[x];
-				previousCellIndexY &= 204; // 204 = 128+64+8+4
-				previousCellIndexY >>= 2;
-				cellIndex |= previousCellIndexY;
-
-				// One bit of our cube index are obtained by looking at the cube index for
-				// the previous cell and copying one of those bits into it's new position.
-				uint8_t previousCellIndexX = previousCellIndex;
-				previousCellIndexX &= 170; // 170 = 128+32+8+2
-				previousCellIndexX >>= 1;
-				cellIndex |= previousCellIndexX;
-
-				// The last bit of our cube index is obtained by looking
-				// at the relevant voxel and comparing it to the threshold
-				const Voxel v111 = sampler.voxel();
-				if (convertToDensity(v111) < DensityThreshold) {
-					cellIndex |= 128;
+				// Most cells in a volume are completely above or below the threshold and hence unoccupied - skip
+				// them in groups of eight
+				if (x + (int32_t)sizeof(uint64_t) <= w) {
+					uint64_t group;
+					core_memcpy(&group, cellIndices.data() + x, sizeof(group));
+					if (group == 0u || group == UINT64_MAX) {
+						x += (int32_t)sizeof(uint64_t) - 1;
+						continue;
+					}
 				}
-
-				// The current value becomes the previous value, ready for the next iteration.
-				previousCellIndex = cellIndex;
-				previousRowCellIndices[x] = cellIndex;
-				previousSliceCellIndicesView.set(x, y, cellIndex);
+				const uint8_t cellIndex = cellIndices[x];
 
 				// 12 bits of edge determine whether a vertex is placed on each of the 12 edges of the cell.
 				const uint16_t edge = edgeTable[cellIndex];
 
 				// Test whether any vertices and indices should be generated for the current cell (i.e. it is occupied).
-				// Performance note: This condition is usually false because most cells in a volume are completely above
-				// or below the threshold and hence unoccupied. However, even when it is always false (testing on an
-				// empty volume) it still incurs significant overhead, probably because the code is large and bloats the
-				// for loop which contains it. On my empty volume test case the code as given runs in 34ms, but if I
-				// replace the condition with 'false' it runs in 24ms and gives the same output (i.e. none).
 				if (core_unlikely(edge != 0u)) {
+					sampler.movePositiveX(x - samplerX);
+					samplerX = x;
+					const Voxel v111 = sampler.voxel();
 					const float v111Density = convertToDensity(v111);
 
 					// Performance note: Computing normals is one of the bottlenecks in the mesh generation process. The
-					// central difference approach actually samples the same voxel more than once as we call it on two
-					// adjacent voxels. Perhaps we could expand this and eliminate duplicates in the future.
-					// Alternatively, we could compute vertex normals from adjacent face normals instead of via central
-					// differencing, but not for vertices on the edge of the region (as this causes visual
-					// discontinuities).
-					const glm::vec3 n111 = computeCentralDifferenceGradient(sampler);
+					// gradients are computed from the slice planes to not sample the volume for each neighbour.
+					const int32_t idx = rowIdx + x + 1;
+					const glm::vec3 n111 =
+						computeCentralDifferenceGradient(previousPlane, currentPlane, nextPlane, idx, stride);
 
 					/* Find the vertices where the surface intersects the cube */
 					if ((edge & 64) && x > 0) {
-						generateVertex(math::Axis::X, palette, sampler, result, indicesView, v111, n111, v111Density, x, y);
+						const glm::vec3 n110 =
+							computeCentralDifferenceGradient(previousPlane, currentPlane, nextPlane, idx - 1, stride);
+						generateVertex(math::Axis::X, palette, sampler, result, indicesView, v111, n111, n110, v111Density, x, y);
 					}
 					if ((edge & 32) && y > 0) {
-						generateVertex(math::Axis::Y, palette, sampler, result, indicesView, v111, n111, v111Density, x, y);
+						const glm::vec3 n110 =
+							computeCentralDifferenceGradient(previousPlane, currentPlane, nextPlane, idx - stride, stride);
+						generateVertex(math::Axis::Y, palette, sampler, result, indicesView, v111, n111, n110, v111Density, x, y);
 					}
 					if ((edge & 1024) && z > 0) {
-						generateVertex(math::Axis::Z, palette, sampler, result, indicesView, v111, n111, v111Density, x, y);
+						const glm::vec3 n110 =
+							computeCentralDifferenceGradient(planeBelow, previousPlane, currentPlane, idx, stride);
+						generateVertex(math::Axis::Z, palette, sampler, result, indicesView, v111, n111, n110, v111Density, x, y);
 					}
 
 					// Now output the indices. For the first row, column or slice there aren't
@@ -270,7 +296,6 @@ void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &p
 						}
 					}
 				}
-				sampler.movePositiveX();
 			}
 			startOfRow.movePositiveY();
 		}
@@ -279,6 +304,7 @@ void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &p
 		core::exchange(indicesBuf, previousIndicesBuf);
 	}
 
+	core_trace_scoped(PostProcessMesh);
 	if (optimize) {
 		result->optimize();
 	}
@@ -0,0 +1,43 @@
+/**
+ * @file
+ */
+
+#include "voxel/CompressedVolume.h"
+#include "app/tests/AbstractTest.h"
+#include "core/ScopedPtr.h"
+#include "core/StandardLib.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+#include "voxel/Voxel.h"
+
+namespace voxel {
+
+class CompressedVolumeTest : public app::AbstractTest {};
+
+TEST_F(CompressedVolumeTest, testEmpty) {
+	const voxel::Region region(0, 63);
+	RawVolume v(region);
+	CompressedVolume compressed(v);
+	EXPECT_EQ(1u, compressed.runs());
+	EXPECT_LT(compressed.size(), RawVolume::size(region));
+	core::ScopedPtr<RawVolume> inflated(compressed.inflate());
+	ASSERT_EQ(region, inflated->region());
+	EXPECT_EQ(0, core_memcmp(v.data(), inflated->data(), RawVolume::size(region)));
+}
+
+TEST_F(CompressedVolumeTest, testRoundTrip) {
+	const voxel::Region region(-3, 4, -5, 12, 17, 9);
+	RawVolume v(region);
+	v.setBorderValue(voxel::createVoxel(VoxelType::Generic, 3));
+	for (int i = 0; i < 200; ++i) {
+		const glm::ivec3 pos(i % 16 - 3, (i * 7) % 14 + 4, (i * 13) % 15 - 5);
+		v.setVoxel(pos, voxel::createVoxel(VoxelType::Generic, i % 16, i % 4));
+	}
+	CompressedVolume compressed(v);
+	core::ScopedPtr<RawVolume> inflated(compressed.inflate());
+	ASSERT_EQ(region, inflated->region());
+	EXPECT_EQ(0, core_memcmp(v.data(), inflated->data(), RawVolume::size(region)));
+	EXPECT_TRUE(v.borderValue().isSame(inflated->borderValue()));
+}
+
+} // namespace voxel
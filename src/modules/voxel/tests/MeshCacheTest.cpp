@@ -0,0 +1,182 @@
+/**
+ * @file
+ */
+
+#include "voxel/MeshCache.h"
+#include "app/tests/AbstractTest.h"
+#include "core/ScopedPtr.h"
+#include "core/StringUtil.h"
+#include "io/MemoryArchive.h"
+#include "palette/Palette.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/RawVolume.h"
+#include "voxel/SurfaceExtractor.h"
+
+namespace voxel {
+
+class MeshCacheTest : public app::AbstractTest {
+protected:
+	palette::Palette _palette;
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		_palette.nippon();
+	}
+
+	MeshCacheKey key(const RawVolume &volume) const {
+		return MeshCache::key(volume, volume.region(), volume.region(), _palette, SurfaceExtractionType::Cubic, 0,
+							  false);
+	}
+};
+
+TEST_F(MeshCacheTest, testStoreAndLoad) {
+	RawVolume volume(Region(0, 7));
+	volume.setVoxel(1, 2, 3, createVoxel(VoxelType::Generic, 1));
+	volume.setVoxel(4, 4, 4, createVoxel(VoxelType::Transparent, 2));
+	ChunkMesh mesh;
+	SurfaceExtractionContext ctx = buildCubicContext(&volume, volume.region(), mesh, glm::ivec3(0));
+	extractSurface(ctx);
+	core::DynamicArray<Mesh> lods;
+	lods.push_back(mesh.mesh[0]);
+
+	MeshCache cache(io::openMemoryArchive());
+	const MeshCacheKey k = key(volume);
+	ChunkMesh loaded;
+	core::DynamicArray<Mesh> loadedLods;
+	EXPECT_FALSE(cache.load(k, loaded, loadedLods));
+	ASSERT_TRUE(cache.store(k, mesh, lods));
+	ASSERT_TRUE(cache.load(k, loaded, loadedLods));
+	ASSERT_EQ(1u, loadedLods.size());
+	for (int i = 0; i < ChunkMesh::Meshes; ++i) {
+		const Mesh &expected = mesh.mesh[i];
+		const Mesh &actual = loaded.mesh[i];
+		ASSERT_GT(expected.getNoOfIndices(), 0u);
+		ASSERT_EQ(expected.getNoOfVertices(), actual.getNoOfVertices());
+		ASSERT_EQ(expected.getNoOfIndices(), actual.getNoOfIndices());
+		EXPECT_EQ(expected.getOffset(), actual.getOffset());
+		for (size_t v = 0; v < expected.getNoOfVertices(); ++v) {
+			EXPECT_EQ(expected.getVertexVector()[v].position, actual.getVertexVector()[v].position);
+			EXPECT_EQ(expected.getVertexVector()[v].colorIndex, actual.getVertexVector()[v].colorIndex);
+		}
+		for (size_t n = 0; n < expected.getNoOfIndices(); ++n) {
+			EXPECT_EQ(expected.getIndexVector()[n], actual.getIndexVector()[n]);
+		}
+	}
+	EXPECT_EQ(mesh.mesh[0].getNoOfIndices(), loadedLods[0].getNoOfIndices());
+}
+
+TEST_F(MeshCacheTest, testKey) {
+	RawVolume volume(Region(0, 7));
+	volume.setVoxel(1, 2, 3, createVoxel(VoxelType::Generic, 1));
+	const MeshCacheKey k = key(volume);
+	EXPECT_EQ(k, key(volume));
+
+	RawVolume color(volume);
+	color.setVoxel(1, 2, 3, createVoxel(VoxelType::Generic, 2));
+	EXPECT_NE(k, key(color));
+
+	EXPECT_NE(k, MeshCache::key(volume, volume.region(), volume.region(), _palette,
+								SurfaceExtractionType::MarchingCubes, 0, false));
+	EXPECT_NE(k, MeshCache::key(volume, volume.region(), volume.region(), _palette, SurfaceExtractionType::Cubic, 0,
+								true));
+	EXPECT_NE(k, MeshCache::key(volume, volume.region(), Region(0, 3), _palette, SurfaceExtractionType::Cubic, 0,
+								false));
+	EXPECT_NE(k, MeshCache::key(volume, volume.region(), volume.region(), _palette, SurfaceExtractionType::Cubic, 0,
+								false, false));
+	palette::Palette palette;
+	palette.magicaVoxel();
+	EXPECT_NE(k, MeshCache::key(volume, volume.region(), volume.region(), palette, SurfaceExtractionType::Cubic, 0,
+								false));
+}
+
+TEST_F(MeshCacheTest, testInvalidEntry) {
+	RawVolume volume(Region(0, 7));
+	volume.setVoxel(1, 2, 3, createVoxel(VoxelType::Generic, 1));
+	ChunkMesh mesh;
+	SurfaceExtractionContext ctx = buildCubicContext(&volume, volume.region(), mesh, glm::ivec3(0));
+	extractSurface(ctx);
+
+	io::MemoryArchivePtr archive = io::openMemoryArchive();
+	MeshCache cache(archive, "");
+	const MeshCacheKey k = key(volume);
+	ASSERT_TRUE(cache.store(k, mesh, {}));
+	// replace the entry with a truncated copy
+	const core::String name = core::string::format("%08x%08x.mesh", (uint32_t)(k.hash >> 32u), (uint32_t)k.hash);
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(name));
+	ASSERT_TRUE(stream);
+	const int64_t size = stream->size();
+	core::DynamicArray<uint8_t> data;
+	data.resize(size / 2);
+	ASSERT_EQ((int)data.size(), stream->read(data.data(), data.size()));
+	ASSERT_TRUE(archive->remove(name));
+	ASSERT_TRUE(archive->add(name, data.data(), data.size()));
+
+	ChunkMesh loaded;
+	core::DynamicArray<Mesh> lods;
+	EXPECT_FALSE(cache.load(k, loaded, lods));
+	EXPECT_TRUE(loaded.isEmpty());
+	EXPECT_FALSE(archive->exists(name)) << "The invalid entry should have been removed";
+}
+
+TEST_F(MeshCacheTest, testHashCollision) {
+	RawVolume volume(Region(0, 7));
+	volume.setVoxel(1, 2, 3, createVoxel(VoxelType::Generic, 1));
+	ChunkMesh mesh;
+	SurfaceExtractionContext ctx = buildCubicContext(&volume, volume.region(), mesh, glm::ivec3(0));
+	extractSurface(ctx);
+
+	MeshCache cache(io::openMemoryArchive());
+	const MeshCacheKey k = key(volume);
+	ASSERT_TRUE(cache.store(k, mesh, {}));
+
+	// other voxels that end up with the same entry name must not get the stored meshes
+	RawVolume other(volume);
+	other.setVoxel(1, 2, 3, createVoxel(VoxelType::Generic, 2));
+	MeshCacheKey collision = key(other);
+	collision.hash = k.hash;
+	ChunkMesh loaded;
+	core::DynamicArray<Mesh> lods;
+	EXPECT_FALSE(cache.load(collision, loaded, lods));
+	EXPECT_TRUE(cache.load(k, loaded, lods));
+}
+
+TEST_F(MeshCacheTest, testEvict) {
+	io::MemoryArchivePtr archive = io::openMemoryArchive();
+	core::DynamicArray<MeshCacheKey> keys;
+	uint64_t entrySize = 0u;
+	{
+		MeshCache cache(archive, "");
+		for (uint8_t color = 1; color <= 4; ++color) {
+			RawVolume volume(Region(0, 7));
+			volume.setVoxel(1, 2, 3, createVoxel(VoxelType::Generic, color));
+			ChunkMesh mesh;
+			SurfaceExtractionContext ctx = buildCubicContext(&volume, volume.region(), mesh, glm::ivec3(0));
+			extractSurface(ctx);
+			keys.push_back(key(volume));
+			ASSERT_TRUE(cache.store(keys.back(), mesh, {}));
+		}
+		entrySize = cache.size() / keys.size();
+	}
+	ASSERT_GT(entrySize, 0u);
+
+	// room for three entries - the least recently used entries are deleted
+	const uint64_t maxSize = entrySize * 3u + entrySize / 2u;
+	MeshCache cache(archive, "", maxSize);
+	EXPECT_EQ(entrySize * keys.size(), cache.size()) << "The existing entries should be found";
+	ChunkMesh loaded;
+	core::DynamicArray<Mesh> lods;
+	ASSERT_TRUE(cache.load(keys[0], loaded, lods));
+	RawVolume volume(Region(0, 7));
+	volume.setVoxel(1, 2, 3, createVoxel(VoxelType::Generic, 5));
+	ChunkMesh mesh;
+	SurfaceExtractionContext ctx = buildCubicContext(&volume, volume.region(), mesh, glm::ivec3(0));
+	extractSurface(ctx);
+	const MeshCacheKey newKey = key(volume);
+	ASSERT_TRUE(cache.store(newKey, mesh, {}));
+	EXPECT_LE(cache.size(), maxSize);
+	EXPECT_TRUE(cache.load(newKey, loaded, lods));
+	EXPECT_TRUE(cache.load(keys[0], loaded, lods)) << "The recently used entry should be kept";
+	EXPECT_FALSE(cache.load(keys[1], loaded, lods));
+}
+
+} // namespace voxel
@@ -4,10 +4,14 @@
 
 #include "voxel/MeshState.h"
 #include "app/tests/AbstractTest.h"
+#include "core/ConfigVar.h"
 #include "core/StringUtil.h"
+#include "io/MemoryArchive.h"
 #include "palette/Palette.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/SurfaceExtractor.h"
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
 
 namespace voxel {
 
@@ -16,13 +20,83 @@ private:
 	using Super = app::AbstractTest;
 
 protected:
+	int _meshSize = 16;
+
+	// wait for the meshes of the first finished extraction
+	static int popFirst(MeshState &meshState) {
+		for (int i = 0; i < 10000; ++i) {
+			const int idx = meshState.pop();
+			if (idx != -1) {
+				return idx;
+			}
+			app::App::getInstance()->wait(1);
+		}
+		return -1;
+	}
+
 	void SetUp() override {
 		Super::SetUp();
-		core::Var::get(cfg::VoxelMeshSize, "16", core::CV_READONLY);
+		core::Var::get(cfg::VoxelMeshSize, core::string::toString(_meshSize), core::CV_READONLY);
 		core::Var::get(cfg::VoxelMeshMode, core::string::toString((int)voxel::SurfaceExtractionType::Cubic));
 	}
 };
 
+class MeshStateLODTest : public MeshStateTest {
+protected:
+	// a voxel of the lower resolution is solid if any of its eight voxels is solid
+	static void downsample(const voxel::RawVolume &source, const palette::Palette &palette,
+						   const voxel::Region &sourceRegion, voxel::RawVolume &dest) {
+		const voxel::Region &destRegion = dest.region();
+		const glm::ivec3 &dim = destRegion.getDimensionsInVoxels();
+		for (int z = 0; z < dim.z; ++z) {
+			for (int y = 0; y < dim.y; ++y) {
+				for (int x = 0; x < dim.x; ++x) {
+					for (int i = 0; i < 8; ++i) {
+						const glm::ivec3 child(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+						const glm::ivec3 pos = sourceRegion.getLowerCorner() + glm::ivec3(x, y, z) * 2 + child;
+						const voxel::Voxel &voxel = source.voxel(pos);
+						if (voxel::isBlocked(voxel.getMaterial())) {
+							dest.setVoxel(destRegion.getLowerCorner() + glm::ivec3(x, y, z), voxel);
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	static const voxel::Mesh *mesh(const MeshState &meshState, int lod, const glm::ivec3 &mins, int idx = 0) {
+		const MeshState::MeshesMap &meshes = meshState.lodMeshes(lod, idx);
+		auto iter = meshes.find(mins);
+		if (iter == meshes.end()) {
+			return nullptr;
+		}
+		return iter->value;
+	}
+
+	static void extract(MeshState &meshState) {
+		meshState.extractAllPending();
+		while (meshState.pop() != -1) {
+		}
+	}
+};
+
+class MeshStateBricksTest : public MeshStateTest {
+public:
+	MeshStateBricksTest() {
+		_meshSize = 64;
+	}
+
+	void extract(MeshState &meshState, size_t &vertices, size_t &indices) {
+		meshState.extractAllPending();
+		while (meshState.pop() != -1) {
+		}
+		size_t normals = 0;
+		vertices = indices = 0;
+		meshState.count(MeshType_Opaque, 0, vertices, normals, indices);
+	}
+};
+
 TEST_F(MeshStateTest, testExtractRegion) {
 	voxel::RawVolume v(voxel::Region(-1, 1));
 
@@ -59,9 +133,434 @@ TEST_F(MeshStateTest, testExtractRegionBoundary) {
 	meshState.scheduleRegionExtraction(0, region);
 	EXPECT_EQ(8, meshState.pendingExtractions());
 
+	// the chunk is already pending
 	const voxel::Region region2(14, 14);
 	meshState.scheduleRegionExtraction(0, region2);
-	EXPECT_EQ(9, meshState.pendingExtractions());
+	EXPECT_EQ(8, meshState.pendingExtractions());
+	(void)meshState.shutdown();
+}
+
+TEST_F(MeshStateTest, testManyVolumes) {
+	voxel::RawVolume v(voxel::Region(0, 7));
+	v.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+
+	MeshState meshState;
+	meshState.construct();
+	meshState.init();
+	bool deleted = false;
+	palette::Palette pal;
+	pal.nippon();
+	EXPECT_EQ(0, meshState.volumeSlots());
+	// the volume slots are not limited and are only allocated for the used indices
+	const int idx = 5000;
+	(void)meshState.setVolume(idx, &v, &pal, nullptr, true, deleted);
+	EXPECT_EQ(idx + 1, meshState.volumeSlots());
+	EXPECT_EQ(nullptr, meshState.volume(idx - 1));
+	EXPECT_FALSE(meshState.hidden(idx - 1));
+	meshState.scheduleRegionExtraction(idx, v.region());
+	meshState.extractAllPending();
+	while (meshState.pop() != -1) {
+	}
+	EXPECT_TRUE(meshState.meshes(MeshType_Opaque, idx).hasKey(glm::ivec3(0)));
+	EXPECT_TRUE(meshState.meshes(MeshType_Opaque, idx - 1).empty());
+	EXPECT_TRUE(meshState.meshes(MeshType_Opaque, idx + 1).empty());
+
+	size_t vertices = 0, normals = 0, indices = 0;
+	meshState.count(MeshType_Opaque, idx, vertices, normals, indices);
+	EXPECT_GT(indices, 0u);
+
+	const core::DynamicArray<voxel::RawVolume *> &volumes = meshState.shutdown();
+	ASSERT_EQ(idx + 1, (int)volumes.size());
+	EXPECT_EQ(&v, volumes[idx]);
+	EXPECT_EQ(0, meshState.volumeSlots());
+}
+
+TEST_F(MeshStateTest, testCollapseExtractions) {
+	voxel::RawVolume v(voxel::Region(0, 31));
+	v.setVoxel(15, 15, 15, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+
+	MeshState meshState;
+	meshState.construct();
+	meshState.init();
+	bool deleted = false;
+	palette::Palette pal;
+	pal.nippon();
+	(void)meshState.setVolume(0, &v, &pal, nullptr, true, deleted);
+
+	const voxel::Region region(15, 15);
+	meshState.scheduleRegionExtraction(0, region);
+	meshState.scheduleRegionExtraction(0, region);
+	EXPECT_EQ(8, meshState.pendingExtractions());
+	EXPECT_EQ(8u, meshState.extractionStats().collapsed);
+
+	meshState.extractAllPending();
+	while (meshState.pop() != -1) {
+	}
+	EXPECT_EQ(0, meshState.pendingExtractions());
+	EXPECT_EQ(0, meshState.runningExtractions());
+	EXPECT_EQ(8u, meshState.extractionStats().extractions);
+	EXPECT_GE(meshState.extractionStats().maxLatencyMillis, meshState.extractionStats().lastLatencyMillis);
+	(void)meshState.shutdown();
+}
+
+TEST_F(MeshStateTest, testSupersededExtractions) {
+	voxel::RawVolume v(voxel::Region(0, 31));
+	v.setVoxel(5, 5, 5, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+
+	MeshState meshState;
+	meshState.construct();
+	meshState.init();
+	bool deleted = false;
+	palette::Palette pal;
+	pal.nippon();
+	(void)meshState.setVolume(0, &v, &pal, nullptr, true, deleted);
+
+	// both jobs of the chunk are started before the meshes of the first one are handed over
+	const voxel::Region region(5, 5);
+	meshState.scheduleRegionExtraction(0, region);
+	EXPECT_FALSE(meshState.update());
+	v.setVoxel(5, 6, 5, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	meshState.scheduleRegionExtraction(0, voxel::Region(5, 6, 5, 5, 6, 5));
+	EXPECT_FALSE(meshState.update());
+	meshState.extractAllPending();
+	int popped = 0;
+	while (meshState.pop() != -1) {
+		++popped;
+	}
+	EXPECT_EQ(1, popped) << "Only the meshes of the latest job should get handed over";
+	EXPECT_EQ(1u, meshState.extractionStats().superseded);
+
+	size_t vertices = 0, normals = 0, indices = 0;
+	meshState.count(MeshType_Opaque, 0, vertices, normals, indices);
+	MeshState fullMeshState;
+	fullMeshState.construct();
+	fullMeshState.init();
+	(void)fullMeshState.setVolume(0, &v, &pal, nullptr, true, deleted);
+	fullMeshState.scheduleRegionExtraction(0, v.region());
+	fullMeshState.extractAllPending();
+	while (fullMeshState.pop() != -1) {
+	}
+	size_t fullVertices = 0, fullIndices = 0;
+	fullMeshState.count(MeshType_Opaque, 0, fullVertices, normals, fullIndices);
+	EXPECT_EQ(fullVertices, vertices);
+	EXPECT_EQ(fullIndices, indices);
+	(void)fullMeshState.shutdown();
+	(void)meshState.shutdown();
+}
+
+TEST_F(MeshStateTest, testPrioritizeExtractions) {
+	voxel::RawVolume v1(voxel::Region(0, 15));
+	v1.setVoxel(3, 4, 5, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	voxel::RawVolume v2(v1);
+
+	MeshState meshState;
+	meshState.construct();
+	meshState.init();
+	bool deleted = false;
+	palette::Palette pal;
+	pal.nippon();
+	(void)meshState.setVolume(0, &v1, &pal, nullptr, true, deleted);
+	(void)meshState.setVolume(1, &v2, &pal, nullptr, true, deleted);
+	const glm::vec3 offset(1000.0f, 0.0f, 0.0f);
+	meshState.setModelMatrix(1, glm::translate(glm::mat4(1.0f), offset), glm::vec3(0.0f), glm::vec3(0.0f),
+							 glm::vec3(16.0f));
+
+	// the second volume is in front of the camera, the first one far behind it
+	const glm::vec3 eye = offset + glm::vec3(8.0f, 8.0f, 40.0f);
+	const glm::mat4 view = glm::lookAt(eye, offset + glm::vec3(8.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 500.0f);
+	meshState.setCamera(eye, view, projection);
+	meshState.scheduleRegionExtraction(0, v1.region());
+	meshState.scheduleRegionExtraction(1, v2.region());
+	const int pending = meshState.pendingExtractions();
+	// update() only starts one extraction
+	EXPECT_FALSE(meshState.update());
+	EXPECT_EQ(pending - 1, meshState.pendingExtractions());
+	EXPECT_EQ(1, popFirst(meshState)) << "The chunks on the screen should get extracted first";
+	meshState.extractAllPending();
+	while (meshState.pop() != -1) {
+	}
+
+	// without a camera the hidden volumes are extracted last
+	MeshState hiddenMeshState;
+	hiddenMeshState.construct();
+	hiddenMeshState.init();
+	(void)hiddenMeshState.setVolume(0, &v1, &pal, nullptr, true, deleted);
+	(void)hiddenMeshState.setVolume(1, &v2, &pal, nullptr, true, deleted);
+	hiddenMeshState.scheduleRegionExtraction(0, v1.region());
+	hiddenMeshState.scheduleRegionExtraction(1, v2.region());
+	hiddenMeshState.hide(0, true);
+	EXPECT_FALSE(hiddenMeshState.update());
+	EXPECT_EQ(1, popFirst(hiddenMeshState));
+	hiddenMeshState.extractAllPending();
+	while (hiddenMeshState.pop() != -1) {
+	}
+	(void)hiddenMeshState.shutdown();
+	(void)meshState.shutdown();
+}
+
+TEST_F(MeshStateTest, testExtractSharedAndCopiedVolume) {
+	voxel::RawVolume v(voxel::Region(0, 31));
+	v.setVoxel(3, 4, 5, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	v.setVoxel(20, 21, 22, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+
+	MeshState meshState;
+	meshState.construct();
+	meshState.init();
+	bool deleted = false;
+	palette::Palette pal;
+	pal.nippon();
+	(void)meshState.setVolume(0, &v, &pal, nullptr, true, deleted);
+
+	// the volume wasn't modified - the workers share the voxel data
+	meshState.scheduleRegionExtraction(0, v.region());
+	meshState.extractAllPending();
+	while (meshState.pop() != -1) {
+	}
+	EXPECT_FALSE(v.isShared()) << "The workers should have released the voxel data";
+	size_t sharedVertices = 0, sharedNormals = 0, sharedIndices = 0;
+	meshState.count(MeshType_Opaque, 0, sharedVertices, sharedNormals, sharedIndices);
+	EXPECT_GT(sharedIndices, 0u);
+
+	// the volume was modified - the regions are copied for the workers
+	const uint64_t version = v.version();
+	v.setVoxel(3, 4, 5, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	v.setVoxel(3, 4, 5, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	EXPECT_NE(version, v.version());
+	meshState.scheduleRegionExtraction(0, v.region());
+	meshState.extractAllPending();
+	while (meshState.pop() != -1) {
+	}
+	size_t copiedVertices = 0, copiedNormals = 0, copiedIndices = 0;
+	meshState.count(MeshType_Opaque, 0, copiedVertices, copiedNormals, copiedIndices);
+	EXPECT_EQ(sharedVertices, copiedVertices);
+	EXPECT_EQ(sharedIndices, copiedIndices);
+	(void)meshState.shutdown();
+}
+
+TEST_F(MeshStateTest, testReuseMeshBuffers) {
+	voxel::RawVolume v(voxel::Region(0, 31));
+	v.setVoxel(3, 4, 5, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+
+	MeshState meshState;
+	meshState.construct();
+	meshState.init();
+	bool deleted = false;
+	palette::Palette pal;
+	pal.nippon();
+	(void)meshState.setVolume(0, &v, &pal, nullptr, true, deleted);
+
+	meshState.scheduleRegionExtraction(0, v.region());
+	meshState.extractAllPending();
+	while (meshState.pop() != -1) {
+	}
+	EXPECT_EQ(0u, meshState.pooledMeshes());
+	size_t vertices = 0, normals = 0, indices = 0;
+	meshState.count(MeshType_Opaque, 0, vertices, normals, indices);
+	EXPECT_GT(indices, 0u);
+
+	// the new meshes replace the old ones - their buffers are kept for the next extraction
+	const voxel::Region region(0, 15);
+	meshState.scheduleRegionExtraction(0, region);
+	meshState.extractAllPending();
+	while (meshState.pop() != -1) {
+	}
+	const uint32_t pooled = meshState.pooledMeshes();
+	EXPECT_GT(pooled, 0u);
+
+	meshState.scheduleRegionExtraction(0, region);
+	meshState.extractAllPending();
+	while (meshState.pop() != -1) {
+	}
+	EXPECT_EQ(pooled, meshState.pooledMeshes()) << "The extraction should have used the pooled buffers";
+	size_t reusedVertices = 0, reusedNormals = 0, reusedIndices = 0;
+	meshState.count(MeshType_Opaque, 0, reusedVertices, reusedNormals, reusedIndices);
+	EXPECT_EQ(vertices, reusedVertices);
+	EXPECT_EQ(indices, reusedIndices);
+	(void)meshState.shutdown();
+}
+
+TEST_F(MeshStateTest, testMeshCache) {
+	core::Var::get(cfg::VoxelMeshCache, "false")->setVal(true);
+	voxel::RawVolume v(voxel::Region(0, 31));
+	v.setVoxel(3, 4, 5, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	v.setVoxel(20, 21, 22, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	palette::Palette pal;
+	pal.nippon();
+	const io::ArchivePtr &archive = io::openMemoryArchive();
+
+	size_t vertices[2] = {0, 0}, normals[2] = {0, 0}, indices[2] = {0, 0};
+	for (int run = 0; run < 2; ++run) {
+		MeshState meshState;
+		meshState.construct();
+		meshState.setMeshCache(archive);
+		meshState.init();
+		bool deleted = false;
+		(void)meshState.setVolume(0, &v, &pal, nullptr, true, deleted);
+		meshState.scheduleRegionExtraction(0, v.region());
+		meshState.extractAllPending();
+		while (meshState.pop() != -1) {
+		}
+		meshState.count(MeshType_Opaque, 0, vertices[run], normals[run], indices[run]);
+		(void)meshState.shutdown();
+	}
+	EXPECT_GT(indices[0], 0u);
+	EXPECT_EQ(vertices[0], vertices[1]);
+	EXPECT_EQ(indices[0], indices[1]);
+
+	// the chunk at the origin with the neighbour voxels that are read by the extractor
+	voxel::MeshCache cache(archive);
+	const voxel::MeshCacheKey key = voxel::MeshCache::key(v, voxel::Region(0, 17), voxel::Region(0, 15), pal,
+														  voxel::SurfaceExtractionType::Cubic, 0, false);
+	voxel::ChunkMesh mesh;
+	core::DynamicArray<voxel::Mesh> lods;
+	EXPECT_TRUE(cache.load(key, mesh, lods));
+	EXPECT_GT(mesh.mesh[MeshType_Opaque].getNoOfIndices(), 0u);
+	core::Var::getSafe(cfg::VoxelMeshCache)->setVal(false);
+}
+
+TEST_F(MeshStateLODTest, testExtractLODs) {
+	voxel::RawVolume v(voxel::Region(0, 31));
+	for (int z = 2; z <= 12; ++z) {
+		for (int y = 2; y <= 12; ++y) {
+			for (int x = 2; x <= 12; ++x) {
+				v.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+			}
+		}
+	}
+	// the face to the next chunk belongs to the mesh of the next chunk
+	v.setVoxel(15, 20, 20, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+
+	MeshState meshState;
+	meshState.construct();
+	meshState.setDownsampler(downsample);
+	meshState.init();
+	bool deleted = false;
+	palette::Palette pal;
+	pal.nippon();
+	(void)meshState.setVolume(0, &v, &pal, nullptr, true, deleted);
+	meshState.scheduleRegionExtraction(0, v.region());
+	extract(meshState);
+	EXPECT_EQ(nullptr, mesh(meshState, 1, glm::ivec3(0))) << "The levels of detail are disabled by default";
+
+	core::Var::getSafe(cfg::VoxelMeshLOD)->setVal(true);
+	EXPECT_TRUE(meshState.update()) << "Enabling the levels of detail should extract all meshes again";
+	extract(meshState);
+	const voxel::Mesh *fullMesh = mesh(meshState, 0, glm::ivec3(0));
+	ASSERT_NE(nullptr, fullMesh);
+	for (int lod = 1; lod < LODLevels; ++lod) {
+		const voxel::Mesh *lodMesh = mesh(meshState, lod, glm::ivec3(0));
+		ASSERT_NE(nullptr, lodMesh) << "lod " << lod;
+		EXPECT_GT(lodMesh->getNoOfIndices(), 0u) << "lod " << lod;
+		EXPECT_LE(lodMesh->getNoOfIndices(), fullMesh->getNoOfIndices()) << "lod " << lod;
+		// the vertices are in the space of the full resolution and cover the box
+		glm::vec3 mins(1000.0f);
+		glm::vec3 maxs(-1000.0f);
+		for (const voxel::VoxelVertex &vertex : lodMesh->getVertexVector()) {
+			mins = glm::min(mins, vertex.position);
+			maxs = glm::max(maxs, vertex.position);
+		}
+		EXPECT_TRUE(glm::all(glm::lessThanEqual(mins, glm::vec3(2.0f)))) << "lod " << lod;
+		EXPECT_TRUE(glm::all(glm::greaterThanEqual(maxs, glm::vec3(13.0f)))) << "lod " << lod;
+		EXPECT_TRUE(glm::all(glm::greaterThanEqual(mins, glm::vec3(0.0f)))) << "lod " << lod;
+		EXPECT_TRUE(glm::all(glm::lessThanEqual(maxs, glm::vec3(16.0f)))) << "lod " << lod;
+	}
+	// the next chunk covers the voxel of its lower neighbour to not leave a hole next to a full resolution chunk
+	const voxel::Mesh *neighbour = mesh(meshState, 1, glm::ivec3(16, 16, 16));
+	ASSERT_NE(nullptr, neighbour);
+	EXPECT_GT(neighbour->getNoOfIndices(), 0u);
+
+	core::Var::getSafe(cfg::VoxelMeshLOD)->setVal(false);
+	EXPECT_TRUE(meshState.update());
+	extract(meshState);
+	EXPECT_EQ(nullptr, mesh(meshState, 1, glm::ivec3(0)));
+	EXPECT_NE(nullptr, mesh(meshState, 0, glm::ivec3(0)));
+	(void)meshState.shutdown();
+}
+
+TEST_F(MeshStateBricksTest, testExtractBricks) {
+	voxel::RawVolume v(voxel::Region(0, 63));
+	for (int z = 2; z < 50; ++z) {
+		for (int x = 3; x < 60; ++x) {
+			for (int y = 0; y < 5 + (x * z) % 7; ++y) {
+				v.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1 + (x + z) % 3));
+			}
+		}
+	}
+
+	MeshState meshState;
+	meshState.construct();
+	meshState.init();
+	bool deleted = false;
+	palette::Palette pal;
+	pal.nippon();
+	(void)meshState.setVolume(0, &v, &pal, nullptr, true, deleted);
+	size_t vertices = 0, indices = 0;
+	meshState.scheduleRegionExtraction(0, v.region());
+	extract(meshState, vertices, indices);
+	EXPECT_GT(indices, 0u);
+
+	// a voxel in the middle of a brick and one at the border of two bricks
+	const glm::ivec3 positions[] = {glm::ivec3(20, 4, 20), glm::ivec3(15, 8, 31)};
+	for (const glm::ivec3 &pos : positions) {
+		v.setVoxel(pos, voxel::createVoxel(voxel::VoxelType::Generic, 5));
+		v.setVoxel(pos + glm::ivec3(0, 1, 0), voxel::Voxel());
+		meshState.scheduleRegionExtraction(0, voxel::Region(pos, pos + glm::ivec3(0, 1, 0)));
+		EXPECT_EQ(1, meshState.pendingExtractions()) << "Only the bricks of one chunk should get extracted";
+		extract(meshState, vertices, indices);
+
+		// the replaced bricks must give the same mesh as the extraction of the whole chunk
+		MeshState fullMeshState;
+		fullMeshState.construct();
+		fullMeshState.init();
+		(void)fullMeshState.setVolume(0, &v, &pal, nullptr, true, deleted);
+		size_t fullVertices = 0, fullIndices = 0;
+		fullMeshState.scheduleRegionExtraction(0, v.region());
+		extract(fullMeshState, fullVertices, fullIndices);
+		EXPECT_EQ(fullVertices, vertices);
+		EXPECT_EQ(fullIndices, indices);
+		(void)fullMeshState.shutdown();
+	}
+
+	// the job of the second brick supersedes the unfinished job of the first one and extracts both bricks
+	v.setVoxel(glm::ivec3(8, 6, 8), voxel::createVoxel(voxel::VoxelType::Generic, 4));
+	meshState.scheduleRegionExtraction(0, voxel::Region(glm::ivec3(8, 6, 8), glm::ivec3(8, 6, 8)));
+	EXPECT_FALSE(meshState.update());
+	v.setVoxel(glm::ivec3(50, 6, 50), voxel::createVoxel(voxel::VoxelType::Generic, 4));
+	meshState.scheduleRegionExtraction(0, voxel::Region(glm::ivec3(50, 6, 50), glm::ivec3(50, 6, 50)));
+	EXPECT_FALSE(meshState.update());
+	extract(meshState, vertices, indices);
+	EXPECT_EQ(1u, meshState.extractionStats().superseded);
+	{
+		MeshState fullMeshState;
+		fullMeshState.construct();
+		fullMeshState.init();
+		(void)fullMeshState.setVolume(0, &v, &pal, nullptr, true, deleted);
+		size_t fullVertices = 0, fullIndices = 0;
+		fullMeshState.scheduleRegionExtraction(0, v.region());
+		extract(fullMeshState, fullVertices, fullIndices);
+		EXPECT_EQ(fullVertices, vertices);
+		EXPECT_EQ(fullIndices, indices);
+		(void)fullMeshState.shutdown();
+	}
+
+	// the bricks of two modifications of the same chunk are extracted together
+	v.setVoxel(glm::ivec3(5, 6, 5), voxel::createVoxel(voxel::VoxelType::Generic, 5));
+	v.setVoxel(glm::ivec3(40, 10, 40), voxel::createVoxel(voxel::VoxelType::Generic, 5));
+	meshState.scheduleRegionExtraction(0, voxel::Region(glm::ivec3(5, 6, 5), glm::ivec3(5, 6, 5)));
+	meshState.scheduleRegionExtraction(0, voxel::Region(glm::ivec3(40, 10, 40), glm::ivec3(40, 10, 40)));
+	EXPECT_EQ(1, meshState.pendingExtractions());
+	extract(meshState, vertices, indices);
+	MeshState fullMeshState;
+	fullMeshState.construct();
+	fullMeshState.init();
+	(void)fullMeshState.setVolume(0, &v, &pal, nullptr, true, deleted);
+	size_t fullVertices = 0, fullIndices = 0;
+	fullMeshState.scheduleRegionExtraction(0, v.region());
+	extract(fullMeshState, fullVertices, fullIndices);
+	EXPECT_EQ(fullVertices, vertices);
+	EXPECT_EQ(fullIndices, indices);
+	(void)fullMeshState.shutdown();
 	(void)meshState.shutdown();
 }
 
@@ -5,10 +5,75 @@
 #include "app/tests/AbstractTest.h"
 #include "voxel/Mesh.h"
 #include "voxel/VoxelVertex.h"
+#include <glm/vec3.hpp>
 
 namespace voxel {
 
-class MeshTest : public app::AbstractTest {};
+class MeshTest : public app::AbstractTest {
+protected:
+	// a flat grid of quads with two triangles each
+	void createGrid(Mesh &mesh, int size) {
+		voxel::VoxelVertex v;
+		v.info = 3;
+		v.colorIndex = 1;
+		for (int z = 0; z <= size; ++z) {
+			for (int x = 0; x <= size; ++x) {
+				v.position = {(float)x, 0.0f, (float)z};
+				mesh.addVertex(v);
+			}
+		}
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				const IndexType i0 = z * (size + 1) + x;
+				const IndexType i1 = i0 + 1;
+				const IndexType i2 = i0 + size + 1;
+				const IndexType i3 = i2 + 1;
+				mesh.addTriangle(i0, i2, i1);
+				mesh.addTriangle(i1, i2, i3);
+			}
+		}
+	}
+
+	glm::vec3 positionSum(const Mesh &mesh) {
+		glm::vec3 sum(0.0f);
+		for (size_t i = 0; i < mesh.getNoOfIndices(); ++i) {
+			sum += mesh.getVertex(mesh.getIndex(i)).position;
+		}
+		return sum;
+	}
+};
+
+TEST_F(MeshTest, testOptimize) {
+	Mesh mesh;
+	createGrid(mesh, 8);
+	voxel::VoxelVertex unused;
+	unused.position = {100.0f, 100.0f, 100.0f};
+	mesh.addVertex(unused);
+	const size_t indices = mesh.getNoOfIndices();
+	const glm::vec3 sum = positionSum(mesh);
+	mesh.optimize();
+	EXPECT_EQ(indices, mesh.getNoOfIndices());
+	EXPECT_EQ(9u * 9u, mesh.getNoOfVertices());
+	EXPECT_EQ(sum, positionSum(mesh));
+	// the vertices are in the order of their first use
+	EXPECT_EQ(0u, mesh.getIndex(0));
+	EXPECT_EQ(1u, mesh.getIndex(1));
+	EXPECT_EQ(2u, mesh.getIndex(2));
+}
+
+TEST_F(MeshTest, testSimplify) {
+	Mesh mesh;
+	createGrid(mesh, 16);
+	const size_t indices = mesh.getNoOfIndices();
+	EXPECT_FALSE(mesh.simplify(0.0f));
+	EXPECT_EQ(indices, mesh.getNoOfIndices());
+	EXPECT_TRUE(mesh.simplify(0.01f));
+	EXPECT_LT(mesh.getNoOfIndices(), indices / 4);
+	EXPECT_EQ(0u, mesh.getNoOfIndices() % 3);
+	for (size_t i = 0; i < mesh.getNoOfIndices(); ++i) {
+		EXPECT_LT(mesh.getIndex(i), mesh.getNoOfVertices());
+	}
+}
 
 TEST_F(MeshTest, DISABLED_testSort) {
 	Mesh mesh;
@@ -0,0 +1,83 @@
+/**
+ * @file
+ */
+
+#include "voxel/OccupancyMask.h"
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+#include "voxel/Voxel.h"
+
+namespace voxel {
+
+class OccupancyMaskTest : public app::AbstractTest {};
+
+TEST_F(OccupancyMaskTest, testBuild) {
+	const voxel::Region region(-2, 3, -4, 97, 12, 5);
+	RawVolume v(region);
+	const Voxel solid = createVoxel(VoxelType::Generic, 1);
+	v.setVoxel(glm::ivec3(-2, 3, -4), solid);
+	v.setVoxel(glm::ivec3(70, 10, 2), solid);
+	OccupancyMask mask(v);
+	EXPECT_EQ(2u, mask.solidVoxels());
+	EXPECT_TRUE(mask.isSolid(0, 0, 0));
+	EXPECT_TRUE(mask.isSolid(72, 7, 6));
+	EXPECT_FALSE(mask.isSolid(71, 7, 6));
+	glm::ivec3 mins, maxs;
+	ASSERT_TRUE(mask.bounds(mins, maxs));
+	EXPECT_EQ(glm::ivec3(0, 0, 0), mins);
+	EXPECT_EQ(glm::ivec3(72, 7, 6), maxs);
+}
+
+TEST_F(OccupancyMaskTest, testTracking) {
+	const voxel::Region region(0, 0, 0, 130, 9, 9);
+	RawVolume v(region);
+	v.setOccupancyTracking(true);
+	const OccupancyMask *mask = v.occupancy();
+	ASSERT_NE(nullptr, mask);
+	EXPECT_TRUE(mask->isEmpty());
+
+	const Voxel solid = createVoxel(VoxelType::Generic, 1);
+	v.setVoxel(glm::ivec3(129, 5, 8), solid);
+	EXPECT_FALSE(mask->isEmpty());
+	EXPECT_TRUE(mask->isSolid(129, 5, 8));
+	EXPECT_EQ(129, mask->findSolid(0, 5, 8, 130));
+	EXPECT_EQ(-1, mask->findSolid(0, 5, 8, 128));
+	EXPECT_TRUE(mask->isEmpty(glm::ivec3(0), glm::ivec3(128, 9, 9)));
+	EXPECT_FALSE(mask->isEmpty(glm::ivec3(0), glm::ivec3(129, 9, 9)));
+
+	RawVolume::Sampler sampler(v);
+	sampler.setPosition(3, 4, 5);
+	sampler.setVoxel(solid);
+	EXPECT_TRUE(mask->isSolid(3, 4, 5));
+	EXPECT_EQ(2u, mask->solidVoxels());
+
+	v.setVoxel(glm::ivec3(129, 5, 8), Voxel());
+	EXPECT_FALSE(mask->isSolid(129, 5, 8));
+	EXPECT_TRUE(mask->isEmpty(glm::ivec3(64, 0, 0), glm::ivec3(130, 9, 9)));
+
+	v.fill(solid);
+	EXPECT_EQ((size_t)region.voxels(), mask->solidVoxels());
+	v.clear();
+	EXPECT_TRUE(mask->isEmpty());
+	EXPECT_EQ(0u, mask->solidVoxels());
+}
+
+TEST_F(OccupancyMaskTest, testMove) {
+	const voxel::Region region(0, 7);
+	RawVolume v(region);
+	v.setOccupancyTracking(true);
+	v.setVoxel(glm::ivec3(0, 0, 0), createVoxel(VoxelType::Generic, 1));
+	v.move(glm::ivec3(1, 2, 3));
+	EXPECT_FALSE(v.occupancy()->isSolid(0, 0, 0));
+	EXPECT_EQ(1u, v.occupancy()->solidVoxels());
+	for (int z = 0; z <= 7; ++z) {
+		for (int y = 0; y <= 7; ++y) {
+			for (int x = 0; x <= 7; ++x) {
+				EXPECT_EQ(isBlocked(v.voxel(x, y, z).getMaterial()), v.occupancy()->isSolid(x, y, z));
+			}
+		}
+	}
+}
+
+} // namespace voxel
@@ -0,0 +1,110 @@
+/**
+ * @file
+ */
+
+#include "voxel/OctreeVolume.h"
+#include "app/tests/AbstractTest.h"
+#include "core/ScopedPtr.h"
+#include "core/StandardLib.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+#include "voxel/Voxel.h"
+
+namespace voxel {
+
+class OctreeVolumeTest : public app::AbstractTest {
+protected:
+	void fill(RawVolume &v) {
+		const Region &region = v.region();
+		for (int i = 0; i < 500; ++i) {
+			const glm::ivec3 pos(region.getLowerX() + (i * 3) % region.getWidthInVoxels(),
+								 region.getLowerY() + (i * 7) % region.getHeightInVoxels(),
+								 region.getLowerZ() + (i * 13) % region.getDepthInVoxels());
+			v.setVoxel(pos, voxel::createVoxel(VoxelType::Generic, i % 16, i % 4));
+		}
+	}
+};
+
+TEST_F(OctreeVolumeTest, testEmpty) {
+	const voxel::Region region(0, 63);
+	RawVolume v(region);
+	OctreeVolume octree(v);
+	EXPECT_EQ(0u, octree.nodes());
+	EXPECT_EQ(1u, octree.values());
+	core::ScopedPtr<RawVolume> inflated(octree.inflate());
+	ASSERT_EQ(region, inflated->region());
+	EXPECT_EQ(0, core_memcmp(v.data(), inflated->data(), RawVolume::size(region)));
+}
+
+TEST_F(OctreeVolumeTest, testRoundTrip) {
+	// not a cube and not a power of two
+	const voxel::Region region(-3, 4, -5, 12, 17, 9);
+	RawVolume v(region);
+	v.setBorderValue(voxel::createVoxel(VoxelType::Generic, 3));
+	fill(v);
+	OctreeVolume octree(v);
+	core::ScopedPtr<RawVolume> inflated(octree.inflate());
+	ASSERT_EQ(region, inflated->region());
+	EXPECT_EQ(0, core_memcmp(v.data(), inflated->data(), RawVolume::size(region)));
+	EXPECT_TRUE(v.borderValue().isSame(inflated->borderValue()));
+}
+
+TEST_F(OctreeVolumeTest, testRoundTripThreadPool) {
+	// more than one brick
+	const voxel::Region region(-10, 0, 5, 90, 40, 75);
+	RawVolume v(region);
+	fill(v);
+	core::ThreadPool threadPool(4, "OctreeVolume");
+	threadPool.init();
+	OctreeVolume octree(v, &threadPool);
+	OctreeVolume serial(v);
+	EXPECT_EQ(serial.nodes(), octree.nodes());
+	EXPECT_EQ(serial.values(), octree.values());
+	core::ScopedPtr<RawVolume> inflated(octree.inflate(&threadPool));
+	ASSERT_EQ(region, inflated->region());
+	EXPECT_EQ(0, core_memcmp(v.data(), inflated->data(), RawVolume::size(region)));
+}
+
+TEST_F(OctreeVolumeTest, testVoxel) {
+	const voxel::Region region(-3, 4, -5, 40, 17, 9);
+	RawVolume v(region);
+	v.setBorderValue(voxel::createVoxel(VoxelType::Generic, 3));
+	fill(v);
+	OctreeVolume octree(v);
+	for (int z = region.getLowerZ() - 1; z <= region.getUpperZ() + 1; ++z) {
+		for (int y = region.getLowerY() - 1; y <= region.getUpperY() + 1; ++y) {
+			for (int x = region.getLowerX() - 1; x <= region.getUpperX() + 1; ++x) {
+				const glm::ivec3 pos(x, y, z);
+				if (region.containsPoint(pos)) {
+					ASSERT_TRUE(v.voxel(pos).isSame(octree.voxel(pos))) << "at " << x << ":" << y << ":" << z;
+				} else {
+					ASSERT_TRUE(v.borderValue().isSame(octree.voxel(pos))) << "at " << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+}
+
+TEST_F(OctreeVolumeTest, testSharedSubtrees) {
+	// the same 8x8x8 pattern repeated in every cell is only stored once
+	const voxel::Region region(0, 127);
+	RawVolume v(region);
+	for (int z = 0; z < 128; ++z) {
+		for (int y = 0; y < 128; ++y) {
+			for (int x = 0; x < 128; ++x) {
+				if ((x % 8) == (y % 8) || (z % 8) == 3) {
+					v.setVoxel(x, y, z, voxel::createVoxel(VoxelType::Generic, (x + y + z) % 8));
+				}
+			}
+		}
+	}
+	OctreeVolume octree(v);
+	// the cell subtrees plus one node per level above the cells
+	EXPECT_LT(octree.nodes(), 600u);
+	EXPECT_LT(octree.size(), RawVolume::size(region) / 100);
+	core::ScopedPtr<RawVolume> inflated(octree.inflate());
+	EXPECT_EQ(0, core_memcmp(v.data(), inflated->data(), RawVolume::size(region)));
+}
+
+} // namespace voxel
@@ -0,0 +1,133 @@
+/**
+ * @file
+ */
+
+#include "voxel/PagedVolume.h"
+#include "app/tests/AbstractTest.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+#include "voxel/Voxel.h"
+#include "voxel/private/CubicSurfaceExtractor.h"
+#include "voxelutil/VolumeVisitor.h"
+
+namespace voxel {
+
+class PagedVolumeTest : public app::AbstractTest {};
+
+TEST_F(PagedVolumeTest, testSetVoxels) {
+	const voxel::Region region(0, 63);
+	PagedVolume v(region);
+	EXPECT_EQ(64, v.bricks());
+	EXPECT_EQ(0, v.allocatedBricks());
+	EXPECT_EQ(0u, v.size());
+	EXPECT_EQ(VoxelType::Air, v.voxel(10, 10, 10).getMaterial());
+	EXPECT_FALSE(v.setVoxel(10, 10, 10, voxel::createVoxel(VoxelType::Air, 0)));
+	EXPECT_EQ(0, v.allocatedBricks());
+	EXPECT_TRUE(v.setVoxel(10, 10, 10, voxel::createVoxel(VoxelType::Generic, 1)));
+	EXPECT_FALSE(v.setVoxel(10, 10, 10, voxel::createVoxel(VoxelType::Generic, 1)));
+	EXPECT_EQ(1, v.allocatedBricks());
+	EXPECT_EQ(1, v.voxel(10, 10, 10).getColor());
+	EXPECT_TRUE(v.setVoxel(63, 63, 63, voxel::createVoxel(VoxelType::Generic, 2)));
+	EXPECT_FALSE(v.setVoxel(64, 64, 64, voxel::createVoxel(VoxelType::Generic, 2)));
+	EXPECT_EQ(2, v.allocatedBricks());
+	EXPECT_EQ(2, v.voxel(63, 63, 63).getColor());
+	EXPECT_TRUE(v.setVoxel(10, 10, 10, voxel::createVoxel(VoxelType::Air, 0)));
+	EXPECT_EQ(1, v.compact());
+	EXPECT_EQ(1, v.allocatedBricks());
+	v.clear();
+	EXPECT_EQ(0, v.allocatedBricks());
+}
+
+TEST_F(PagedVolumeTest, testUnalignedRegion) {
+	const voxel::Region region(-5, -3, -7, 20, 17, 3);
+	PagedVolume v(region);
+	const voxel::Voxel voxel = voxel::createVoxel(VoxelType::Generic, 1);
+	v.fill(voxel);
+	int cnt = voxelutil::visitVolume(v, [](int, int, int, const voxel::Voxel &) {});
+	EXPECT_EQ(region.voxels(), cnt);
+	EXPECT_EQ(VoxelType::Air, v.voxel(region.getUpperCorner() + 1).getMaterial());
+	EXPECT_EQ(VoxelType::Generic, v.voxel(region.getLowerCorner()).getMaterial());
+}
+
+TEST_F(PagedVolumeTest, testSamplerMatchesRawVolume) {
+	const voxel::Region region(-3, 40);
+	PagedVolume v(region);
+	RawVolume rv(region);
+	for (int i = 0; i < 2000; ++i) {
+		const glm::ivec3 pos((i * 7) % 44 - 3, (i * 13) % 44 - 3, (i * 29) % 44 - 3);
+		const voxel::Voxel voxel = voxel::createVoxel(VoxelType::Generic, i % 255);
+		v.setVoxel(pos, voxel);
+		rv.setVoxel(pos, voxel);
+	}
+
+	PagedVolume::Sampler sampler(v);
+	RawVolume::Sampler rawSampler(rv);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++) {
+			sampler.setPosition(region.getLowerX(), y, z);
+			rawSampler.setPosition(region.getLowerX(), y, z);
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++) {
+				ASSERT_TRUE(rawSampler.voxel().isSame(sampler.voxel())) << x << ":" << y << ":" << z;
+				ASSERT_TRUE(rawSampler.peekVoxel1nx1ny1nz().isSame(sampler.peekVoxel1nx1ny1nz()));
+				ASSERT_TRUE(rawSampler.peekVoxel1nx0py0pz().isSame(sampler.peekVoxel1nx0py0pz()));
+				ASSERT_TRUE(rawSampler.peekVoxel1px0py0pz().isSame(sampler.peekVoxel1px0py0pz()));
+				ASSERT_TRUE(rawSampler.peekVoxel0px1py0pz().isSame(sampler.peekVoxel0px1py0pz()));
+				ASSERT_TRUE(rawSampler.peekVoxel0px1ny0pz().isSame(sampler.peekVoxel0px1ny0pz()));
+				ASSERT_TRUE(rawSampler.peekVoxel0px0py1pz().isSame(sampler.peekVoxel0px0py1pz()));
+				ASSERT_TRUE(rawSampler.peekVoxel0px0py1nz().isSame(sampler.peekVoxel0px0py1nz()));
+				ASSERT_TRUE(rawSampler.peekVoxel1px1py1pz().isSame(sampler.peekVoxel1px1py1pz()));
+				sampler.movePositiveX();
+				rawSampler.movePositiveX();
+			}
+		}
+	}
+}
+
+TEST_F(PagedVolumeTest, testCopyFromRawVolume) {
+	const voxel::Region region(0, 30);
+	RawVolume rv(region);
+	rv.setVoxel(1, 2, 3, voxel::createVoxel(VoxelType::Generic, 1));
+	rv.setVoxel(30, 30, 30, voxel::createVoxel(VoxelType::Generic, 2));
+	PagedVolume v(region);
+	v.copyFrom(rv);
+	EXPECT_EQ(2, v.allocatedBricks());
+	EXPECT_EQ(1, v.voxel(1, 2, 3).getColor());
+	EXPECT_EQ(2, v.voxel(30, 30, 30).getColor());
+
+	RawVolume target(region);
+	v.copyTo(target);
+	EXPECT_EQ(1, target.voxel(1, 2, 3).getColor());
+	EXPECT_EQ(2, target.voxel(30, 30, 30).getColor());
+}
+
+TEST_F(PagedVolumeTest, testExtractCubicMesh) {
+	const voxel::Region region(0, 40);
+	RawVolume rv(region);
+	for (int i = 0; i < 500; ++i) {
+		const glm::ivec3 pos((i * 7) % 41, (i * 13) % 41, (i * 29) % 41);
+		rv.setVoxel(pos, voxel::createVoxel(VoxelType::Generic, i % 255));
+	}
+	PagedVolume v(region);
+	v.copyFrom(rv);
+
+	ChunkMesh rawMesh;
+	ChunkMesh pagedMesh;
+	extractCubicMesh(&rv, region, &rawMesh, glm::ivec3(0));
+	extractCubicMesh(&v, region, &pagedMesh, glm::ivec3(0));
+	ASSERT_GT(rawMesh.mesh[0].getNoOfVertices(), 0u);
+	EXPECT_EQ(rawMesh.mesh[0].getNoOfVertices(), pagedMesh.mesh[0].getNoOfVertices());
+	EXPECT_EQ(rawMesh.mesh[0].getNoOfIndices(), pagedMesh.mesh[0].getNoOfIndices());
+}
+
+TEST_F(PagedVolumeTest, testSolidRegion) {
+	PagedVolume v(voxel::Region(0, -64, 0, 15, 63, 15));
+	EXPECT_FALSE(v.solidRegion().isValid());
+	v.setVoxel(3, -40, 5, voxel::createVoxel(VoxelType::Generic, 1));
+	v.setVoxel(9, 50, 2, voxel::createVoxel(VoxelType::Generic, 2));
+	const voxel::Region &region = v.solidRegion();
+	EXPECT_EQ(glm::ivec3(3, -40, 2), region.getLowerCorner());
+	EXPECT_EQ(glm::ivec3(9, 50, 5), region.getUpperCorner());
+}
+
+} // namespace voxel
@@ -0,0 +1,62 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolumeColumnWriter.h"
+#include "voxel/OccupancyMask.h"
+
+namespace voxel {
+
+class RawVolumeColumnWriterTest : public app::AbstractTest {};
+
+TEST_F(RawVolumeColumnWriterTest, testFill) {
+	const Region region(-2, 1, 3, 5, 9, 7);
+	RawVolume v(region);
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	{
+		RawVolumeColumnWriter writer(v);
+		writer.fill(0, 4, 2, 5, voxel);
+		writer.setVoxel(5, 9, 7, voxel);
+	}
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const bool expected = (x == 0 && z == 4 && y >= 2 && y <= 5) || (x == 5 && y == 9 && z == 7);
+				EXPECT_EQ(expected, isBlocked(v.voxel(x, y, z).getMaterial())) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+	EXPECT_EQ(5u, v.solidVoxelCount());
+	EXPECT_EQ(Region(0, 2, 4, 5, 9, 7), v.solidRegion());
+}
+
+TEST_F(RawVolumeColumnWriterTest, testClipping) {
+	const Region region(0, 7);
+	RawVolume v(region);
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	{
+		RawVolumeColumnWriter writer(v);
+		writer.fill(3, 3, -10, 100, voxel);
+		writer.fill(-1, 3, 0, 7, voxel);
+		writer.fill(3, 8, 0, 7, voxel);
+		writer.fill(4, 4, 8, 10, voxel);
+	}
+	EXPECT_EQ(8u, v.solidVoxelCount());
+	EXPECT_EQ(Region(3, 0, 3, 3, 7, 3), v.solidRegion());
+}
+
+TEST_F(RawVolumeColumnWriterTest, testOccupancy) {
+	const Region region(0, 7);
+	RawVolume v(region);
+	v.setOccupancyTracking(true);
+	{
+		RawVolumeColumnWriter writer(v);
+		writer.fill(1, 2, 0, 3, createVoxel(VoxelType::Generic, 1));
+	}
+	ASSERT_NE(nullptr, v.occupancy());
+	EXPECT_TRUE(v.occupancy()->isSolid(glm::ivec3(1, 3, 2)));
+	EXPECT_FALSE(v.occupancy()->isSolid(glm::ivec3(1, 4, 2)));
+}
+
+} // namespace voxel
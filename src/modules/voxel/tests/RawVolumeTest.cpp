@@ -3,9 +3,11 @@
  */
 
 #include "AbstractVoxelTest.h"
+#include "core/ScopedPtr.h"
 #include "core/collection/DynamicArray.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
+#include <future>
 
 namespace voxel {
 
@@ -50,6 +52,36 @@ TEST_F(RawVolumeTest, testCopyRegions) {
 	EXPECT_EQ(3, v2.voxel(2, 0, 0).getColor());
 }
 
+TEST_F(RawVolumeTest, testCopyOnWrite) {
+	const voxel::Region region(0, 4);
+	RawVolume v(region);
+	v.setVoxel(1, 1, 1, voxel::createVoxel(VoxelType::Generic, 1));
+	core::ScopedPtr<RawVolume> shared(RawVolume::createShared(v));
+	RawVolume &copy = *shared;
+	EXPECT_TRUE(v.isShared());
+	EXPECT_TRUE(copy.isShared());
+	EXPECT_EQ(v.data(), copy.data());
+
+	EXPECT_TRUE(copy.setVoxel(2, 2, 2, voxel::createVoxel(VoxelType::Generic, 2)));
+	EXPECT_FALSE(v.isShared());
+	EXPECT_FALSE(copy.isShared());
+	EXPECT_NE(v.data(), copy.data());
+	EXPECT_EQ(1, copy.voxel(1, 1, 1).getColor());
+	EXPECT_EQ(2, copy.voxel(2, 2, 2).getColor());
+	EXPECT_TRUE(isAir(v.voxel(2, 2, 2).getMaterial()));
+
+	core::ScopedPtr<RawVolume> sharedSampler(RawVolume::createShared(v));
+	RawVolume &samplerCopy = *sharedSampler;
+	EXPECT_TRUE(samplerCopy.isShared());
+	RawVolume::Sampler sampler(samplerCopy);
+	ASSERT_TRUE(sampler.setPosition(3, 3, 3));
+	EXPECT_TRUE(sampler.setVoxel(voxel::createVoxel(VoxelType::Generic, 3)));
+	EXPECT_FALSE(v.isShared());
+	EXPECT_EQ(3, samplerCopy.voxel(3, 3, 3).getColor());
+	EXPECT_TRUE(isAir(v.voxel(3, 3, 3).getMaterial()));
+	EXPECT_EQ(1, samplerCopy.voxel(1, 1, 1).getColor());
+}
+
 TEST_F(RawVolumeTest, testSamplerPeek) {
 	RawVolume v(_region);
 	pageIn(v.region(), v);
@@ -105,6 +137,79 @@ TEST_F(RawVolumeTest, testMove) {
 	EXPECT_EQ((int)v.voxel(1, 0, 0).getMaterial(), (int)VoxelType::Generic);
 }
 
+TEST_F(RawVolumeTest, testSolidRegion) {
+	const Region region(-5, 10);
+	RawVolume v(region);
+	EXPECT_FALSE(v.solidRegion().isValid());
+	EXPECT_EQ(0u, v.solidVoxelCount());
+
+	const Voxel solid = createVoxel(VoxelType::Generic, 1);
+	v.setVoxel(-2, 3, 7, solid);
+	v.setVoxel(4, -1, 9, solid);
+	EXPECT_EQ(Region(-2, -1, 7, 4, 3, 9), v.solidRegion());
+	EXPECT_EQ(glm::ivec3(-2, -1, 7), v.mins());
+	EXPECT_EQ(glm::ivec3(4, 3, 9), v.maxs());
+	EXPECT_EQ(2u, v.solidVoxelCount());
+
+	// deleting voxels shrinks the bounds again
+	v.setVoxel(4, -1, 9, Voxel());
+	EXPECT_EQ(Region(-2, 3, 7, -2, 3, 7), v.solidRegion());
+	EXPECT_EQ(1u, v.solidVoxelCount());
+
+	RawVolume::Sampler sampler(v);
+	sampler.setPosition(10, 10, 10);
+	sampler.setVoxel(solid);
+	EXPECT_EQ(Region(-2, 3, 7, 10, 10, 10), v.solidRegion());
+
+	// the moved slices must match the recounted voxels
+	v.move(glm::ivec3(3, 5, 7));
+	const Region moved = v.solidRegion();
+	voxel::Region expected = Region::InvalidRegion;
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				if (!isBlocked(v.voxel(x, y, z).getMaterial())) {
+					continue;
+				}
+				if (expected.isValid()) {
+					expected.accumulate(glm::ivec3(x, y, z));
+				} else {
+					expected = Region(x, y, z, x, y, z);
+				}
+			}
+		}
+	}
+	EXPECT_EQ(expected, moved);
+	EXPECT_EQ(2u, v.solidVoxelCount());
+
+	v.fill(solid);
+	EXPECT_EQ(region, v.solidRegion());
+	EXPECT_EQ((size_t)region.voxels(), v.solidVoxelCount());
+	v.clear();
+	EXPECT_FALSE(v.solidRegion().isValid());
+}
+
+TEST_F(RawVolumeTest, testSolidRegionConcurrentReaders) {
+	const Region region(0, 63);
+	RawVolume v(region);
+	const Voxel solid = createVoxel(VoxelType::Generic, 1);
+	// the slice counts are computed again on the next query
+	Voxel *row = v.writableRow(glm::ivec3(0, 5, 9));
+	row[3] = solid;
+	row[40] = solid;
+	v.setVoxel(7, 60, 11, solid);
+
+	// the readers don't modify the volume - but one of them computes the slice counts
+	std::future<Region> readers[8];
+	for (int i = 0; i < (int)lengthof(readers); ++i) {
+		readers[i] = std::async(std::launch::async, [&v]() { return v.solidRegion(); });
+	}
+	for (int i = 0; i < (int)lengthof(readers); ++i) {
+		EXPECT_EQ(Region(3, 5, 9, 40, 60, 11), readers[i].get());
+	}
+	EXPECT_EQ(3u, v.solidVoxelCount());
+}
+
 TEST_F(RawVolumeTest, testFullSamplerLoop) {
 	RawVolume v(_region);
 	pageIn(v.region(), v);
@@ -245,4 +350,55 @@ TEST_F(RawVolumeTest, testFullSamplerLoop) {
 	}
 }
 
+TEST_F(RawVolumeTest, testHash) {
+	RawVolume v1(Region(-3, 2, 5, 40, 20, 37));
+	// the position of the volume is not part of the hash
+	RawVolume v2(Region(100, 100, 100, 143, 118, 132));
+	EXPECT_EQ(v1.hash(), v2.hash());
+	EXPECT_NE(v1.hash(), RawVolume(Region(0, 15)).hash());
+
+	v1.setVoxel(0, 3, 6, voxel::createVoxel(VoxelType::Generic, 2));
+	EXPECT_NE(v1.hash(), v2.hash());
+	v2.setVoxel(103, 101, 101, voxel::createVoxel(VoxelType::Generic, 2));
+	EXPECT_EQ(v1.hash(), v2.hash());
+
+	// only the brick of the modified voxel changes
+	const uint64_t brickHash = v1.brickHash(glm::ivec3(40, 20, 37));
+	RawVolume copy(v1);
+	copy.setVoxel(40, 20, 37, voxel::createVoxel(VoxelType::Generic, 5));
+	EXPECT_NE(brickHash, copy.brickHash(glm::ivec3(40, 20, 37)));
+	EXPECT_EQ(v1.brickHash(glm::ivec3(0, 3, 6)), copy.brickHash(glm::ivec3(0, 3, 6)));
+
+	// a modification with a sampler is detected, too
+	RawVolume sampled(v1);
+	RawVolume::Sampler sampler(sampled);
+	sampler.setPosition(40, 20, 37);
+	sampler.setVoxel(voxel::createVoxel(VoxelType::Generic, 5));
+	EXPECT_EQ(copy.hash(), sampled.hash());
+
+	// undoing the modification of a shared copy gives the hash of the source again
+	core::ScopedPtr<RawVolume> shared(RawVolume::createShared(copy));
+	EXPECT_EQ(copy.hash(), shared->hash());
+	shared->setVoxel(40, 20, 37, v1.voxel(40, 20, 37));
+	EXPECT_EQ(v1.hash(), shared->hash());
+
+	// the brick hashes are computed again after a modification of the data
+	RawVolume written(copy);
+	voxel::Voxel *data = written.writableRow(written.region().getLowerCorner());
+	data[0] = voxel::createVoxel(VoxelType::Generic, 7);
+	EXPECT_NE(copy.hash(), written.hash());
+}
+
+TEST_F(RawVolumeTest, testHashRegion) {
+	RawVolume v1(Region(0, 15));
+	RawVolume v2(Region(-50, 30));
+	v1.setVoxel(1, 2, 3, voxel::createVoxel(VoxelType::Generic, 1));
+	v2.setVoxel(11, 12, 13, voxel::createVoxel(VoxelType::Generic, 1));
+	EXPECT_EQ(v1.hash(Region(0, 7)), v2.hash(Region(10, 17)));
+	EXPECT_NE(v1.hash(Region(0, 7)), v2.hash(Region(9, 16)));
+	// cropped to the volume
+	EXPECT_EQ(v1.hash(Region(0, 15)), v1.hash(Region(-5, 20)));
+	EXPECT_EQ(0u, v1.hash(Region(100, 101)));
+}
+
 }
@@ -3,7 +3,9 @@
  */
 
 #include "app/tests/AbstractTest.h"
+#include "core/ScopedPtr.h"
 #include "voxel/RawVolumeWrapper.h"
+#include <future>
 
 namespace voxel {
 
@@ -46,4 +48,27 @@ TEST_F(RawVolumeWrapperTest, testSetMaxBoundary) {
 	EXPECT_FALSE(w.setVoxel(8, 7, 7, voxel::createVoxel(VoxelType::Air, 0)));
 }
 
+TEST_F(RawVolumeWrapperTest, testSharedSnapshot) {
+	Region region(0, 7);
+	RawVolume v(region);
+	v.setVoxel(1, 1, 1, voxel::createVoxel(VoxelType::Generic, 1));
+	// the other thread reads a copy that shares the voxels - the wrapper modifies the volume without any lock
+	core::ScopedPtr<RawVolume> snapshot(RawVolume::createShared(v));
+	{
+		RawVolumeWrapper w(&v);
+		EXPECT_TRUE(w.setVoxel(1, 1, 1, voxel::createVoxel(VoxelType::Generic, 2)));
+		EXPECT_TRUE(w.setVoxel(2, 2, 2, voxel::createVoxel(VoxelType::Generic, 3)));
+	}
+	std::future<int> reader = std::async(std::launch::async, [&snapshot]() {
+		int colors = 0;
+		for (int i = 0; i < 8; ++i) {
+			colors += snapshot->voxel(i, i, i).getColor();
+		}
+		return colors;
+	});
+	EXPECT_EQ(1, reader.get()) << "The snapshot must not see the modifications";
+	EXPECT_EQ(2, v.voxel(1, 1, 1).getColor());
+	EXPECT_EQ(3, v.voxel(2, 2, 2).getColor());
+}
+
 }
@@ -4,13 +4,109 @@
 
 #include "voxel/SurfaceExtractor.h"
 #include "app/tests/AbstractTest.h"
+#include "core/Algorithm.h"
+#include "core/concurrent/ThreadPool.h"
+#include "palette/Palette.h"
 #include "voxel/ChunkMesh.h"
 #include "voxel/RawVolume.h"
+#include "voxel/private/CubicSurfaceExtractor.h"
+#include "voxel/private/MarchingCubesTables.h"
+#include <glm/geometric.hpp>
 
 namespace voxel {
 
 class SurfaceExtractorTest : public app::AbstractTest {};
 
+// the corners of a triangle in half voxel units - rotated to start with the smallest corner to keep the winding order
+struct HalfVoxelTriangle {
+	glm::ivec3 corners[3];
+
+	HalfVoxelTriangle(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2) {
+		const glm::ivec3 c[3]{glm::ivec3(glm::round(p0 * 2.0f)), glm::ivec3(glm::round(p1 * 2.0f)),
+							  glm::ivec3(glm::round(p2 * 2.0f))};
+		int first = 0;
+		for (int i = 1; i < 3; ++i) {
+			if (less(c[i], c[first])) {
+				first = i;
+			}
+		}
+		for (int i = 0; i < 3; ++i) {
+			corners[i] = c[(first + i) % 3];
+		}
+	}
+
+	static bool less(const glm::ivec3 &a, const glm::ivec3 &b) {
+		if (a.x != b.x) {
+			return a.x < b.x;
+		}
+		if (a.y != b.y) {
+			return a.y < b.y;
+		}
+		return a.z < b.z;
+	}
+
+	bool operator<(const HalfVoxelTriangle &other) const {
+		for (int i = 0; i < 3; ++i) {
+			if (corners[i] != other.corners[i]) {
+				return less(corners[i], other.corners[i]);
+			}
+		}
+		return false;
+	}
+
+	bool operator==(const HalfVoxelTriangle &other) const {
+		return corners[0] == other.corners[0] && corners[1] == other.corners[1] && corners[2] == other.corners[2];
+	}
+};
+
+static core::DynamicArray<HalfVoxelTriangle> sortedTriangles(const voxel::Mesh &mesh) {
+	core::DynamicArray<HalfVoxelTriangle> triangles;
+	const voxel::VertexArray &vertices = mesh.getVertexVector();
+	const voxel::IndexArray &indices = mesh.getIndexVector();
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		triangles.emplace_back(vertices[indices[i]].position, vertices[indices[i + 1]].position,
+							   vertices[indices[i + 2]].position);
+	}
+	core::sort(triangles.begin(), triangles.end(), core::Less<HalfVoxelTriangle>());
+	return triangles;
+}
+
+// a straightforward marching cubes extraction as reference: the cell index is built from the eight corner voxels of
+// each cell and the density is binary - so the vertices are always in the middle of the edges
+static core::DynamicArray<HalfVoxelTriangle> referenceMarchingCubes(const voxel::RawVolume &volume,
+																	 const voxel::Region &region) {
+	// the middle of the twelve edges of the cell relative to its upper corner
+	static const glm::vec3 edgeCenters[12]{
+		{-0.5f, -1.0f, -1.0f}, {0.0f, -0.5f, -1.0f}, {-0.5f, 0.0f, -1.0f}, {-1.0f, -0.5f, -1.0f},
+		{-0.5f, -1.0f, 0.0f},  {0.0f, -0.5f, 0.0f},	 {-0.5f, 0.0f, 0.0f},  {-1.0f, -0.5f, 0.0f},
+		{-1.0f, -1.0f, -0.5f}, {0.0f, -1.0f, -0.5f}, {0.0f, 0.0f, -0.5f},  {-1.0f, 0.0f, -0.5f}};
+	core::DynamicArray<HalfVoxelTriangle> triangles;
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	// the region size in cells is one less than the region size in voxels
+	for (int z = mins.z + 1; z <= maxs.z; ++z) {
+		for (int y = mins.y + 1; y <= maxs.y; ++y) {
+			for (int x = mins.x + 1; x <= maxs.x; ++x) {
+				uint8_t cellIndex = 0;
+				for (int corner = 0; corner < 8; ++corner) {
+					const glm::ivec3 pos(x - 1 + (corner & 1), y - 1 + ((corner >> 1) & 1), z - 1 + (corner >> 2));
+					if (voxel::isAir(volume.voxel(pos).getMaterial())) {
+						cellIndex |= (uint8_t)(1u << corner);
+					}
+				}
+				const glm::vec3 upper(x, y, z);
+				for (int i = 0; triTable[cellIndex][i] != -1; i += 3) {
+					triangles.emplace_back(upper + edgeCenters[triTable[cellIndex][i + 0]],
+										   upper + edgeCenters[triTable[cellIndex][i + 1]],
+										   upper + edgeCenters[triTable[cellIndex][i + 2]]);
+				}
+			}
+		}
+	}
+	core::sort(triangles.begin(), triangles.end(), core::Less<HalfVoxelTriangle>());
+	return triangles;
+}
+
 // https://github.com/vengi-voxel/vengi/issues/389
 // 63 vertices mesh object. When you import this one into Blender, then when manually merged (Mesh > Merge > By Distance
 // 0.0001m) will yield to 48 vertices. There are 15 pairs of overlapping vertices: index 52 and 56 are overlapping in
@@ -133,4 +229,242 @@ TEST_F(SurfaceExtractorTest, testMeshExtractionIssue445) {
 	EXPECT_EQ(8, (int)mesh.mesh[0].getNoOfVertices());
 }
 
+// the area of all triangles must match the amount of visible voxel faces - no matter how the quads were merged
+static int meshArea(const voxel::Mesh &mesh) {
+	double area = 0.0;
+	for (size_t i = 0; i < mesh.getNoOfIndices(); i += 3) {
+		const glm::vec3 p0 = mesh.getVertex(mesh.getIndex(i + 0)).position;
+		const glm::vec3 p1 = mesh.getVertex(mesh.getIndex(i + 1)).position;
+		const glm::vec3 p2 = mesh.getVertex(mesh.getIndex(i + 2)).position;
+		area += glm::length(glm::cross(p1 - p0, p2 - p0)) * 0.5;
+	}
+	return (int)glm::round(area);
+}
+
+static int visibleFaces(const voxel::RawVolume &v) {
+	const voxel::Region &region = v.region();
+	const glm::ivec3 directions[] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+	int faces = 0;
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				if (voxel::isAir(v.voxel(x, y, z).getMaterial())) {
+					continue;
+				}
+				for (const glm::ivec3 &dir : directions) {
+					const glm::ivec3 pos = glm::ivec3(x, y, z) + dir;
+					if (!region.containsPoint(pos) || voxel::isAir(v.voxel(pos).getMaterial())) {
+						++faces;
+					}
+				}
+			}
+		}
+	}
+	return faces;
+}
+
+TEST_F(SurfaceExtractorTest, testMergeQuads) {
+	const voxel::Region region(0, 0, 0, 31, 7, 31);
+	voxel::RawVolume v(region);
+	// a few voxels with a different color on top of the box - the faces around them must not be merged
+	for (int z = 0; z <= 31; ++z) {
+		for (int y = 0; y <= 7; ++y) {
+			for (int x = 0; x <= 31; ++x) {
+				const uint8_t color = (y == 7 && x % 8 == 3 && z % 5 == 1) ? 2 : 1;
+				v.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+			}
+		}
+	}
+
+	voxel::Region extractRegion = region;
+	extractRegion.shiftUpperCorner(1, 1, 1);
+	for (int ambientOcclusion = 0; ambientOcclusion <= 1; ++ambientOcclusion) {
+		voxel::ChunkMesh mesh;
+		SurfaceExtractionContext ctx =
+			voxel::buildCubicContext(&v, extractRegion, mesh, glm::ivec3(0), true, true, ambientOcclusion != 0);
+		voxel::extractSurface(ctx);
+		EXPECT_EQ(72 * 6, (int)mesh.mesh[0].getNoOfIndices());
+		EXPECT_EQ(visibleFaces(v), meshArea(mesh.mesh[0]));
+	}
+}
+
+TEST_F(SurfaceExtractorTest, testMergeQuadsSteps) {
+	const voxel::Region region(0, 0, 0, 23, 11, 23);
+	voxel::RawVolume v(region);
+	for (int z = 0; z <= 23; ++z) {
+		for (int x = 0; x <= 23; ++x) {
+			const int height = 2 + (x / 5 + z / 7) % 8;
+			const uint8_t color = 1 + (x / 3 + z / 4) % 3;
+			for (int y = 0; y <= height; ++y) {
+				v.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+			}
+		}
+	}
+
+	voxel::Region extractRegion = region;
+	extractRegion.shiftUpperCorner(1, 1, 1);
+	const int faces = visibleFaces(v);
+	for (int ambientOcclusion = 0; ambientOcclusion <= 1; ++ambientOcclusion) {
+		voxel::ChunkMesh merged;
+		voxel::extractCubicMesh(&v, extractRegion, &merged, glm::ivec3(0), true, true, ambientOcclusion != 0);
+		voxel::ChunkMesh unmerged;
+		voxel::extractCubicMesh(&v, extractRegion, &unmerged, glm::ivec3(0), false, true, ambientOcclusion != 0);
+		EXPECT_EQ(faces * 6, (int)unmerged.mesh[0].getNoOfIndices());
+		EXPECT_LT(merged.mesh[0].getNoOfIndices(), unmerged.mesh[0].getNoOfIndices());
+		EXPECT_EQ(faces, meshArea(merged.mesh[0]));
+	}
+}
+
+TEST_F(SurfaceExtractorTest, testVertexOcclusion) {
+	// a step - the vertices of the top face of the lower voxel at the step are occluded
+	voxel::RawVolume v(voxel::Region(0, 3));
+	v.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	v.setVoxel(2, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	v.setVoxel(2, 2, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	auto occluded = [](const voxel::Mesh &mesh) {
+		int n = 0;
+		for (const voxel::VoxelVertex &vertex : mesh.getVertexVector()) {
+			if (vertex.ambientOcclusion != 3u) {
+				++n;
+			}
+		}
+		return n;
+	};
+
+	voxel::ChunkMesh withOcclusion;
+	voxel::extractCubicMesh(&v, v.region(), &withOcclusion, glm::ivec3(0), true, true, true);
+	const int expected = occluded(withOcclusion.mesh[0]);
+	ASSERT_GT(expected, 0);
+
+	// disabling the ambient occlusion only affects the merging of the quads - the vertices are still occluded
+	voxel::ChunkMesh noMerge;
+	voxel::extractCubicMesh(&v, v.region(), &noMerge, glm::ivec3(0), false, true, false);
+	EXPECT_GT(occluded(noMerge.mesh[0]), 0);
+
+	voxel::ChunkMesh noVertexOcclusion;
+	voxel::SurfaceExtractionContext ctx =
+		voxel::buildCubicContext(&v, v.region(), noVertexOcclusion, glm::ivec3(0), true, true, false);
+	ctx.vertexOcclusion = false;
+	voxel::extractSurface(ctx);
+	ASSERT_GT(noVertexOcclusion.mesh[0].getNoOfVertices(), 0u);
+	EXPECT_EQ(0, occluded(noVertexOcclusion.mesh[0]));
+}
+
+TEST_F(SurfaceExtractorTest, testExtractSlices) {
+	const voxel::Region region(0, 0, 0, 19, 11, 99);
+	voxel::RawVolume v(region);
+	for (int z = 0; z <= 99; ++z) {
+		for (int x = 0; x <= 19; ++x) {
+			const int height = 2 + (x / 5 + z / 7) % 8;
+			const uint8_t color = 1 + (x / 3 + z / 4) % 3;
+			for (int y = 0; y <= height; ++y) {
+				v.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+			}
+		}
+	}
+	voxel::Region extractRegion = region;
+	extractRegion.shiftUpperCorner(1, 1, 1);
+
+	core::ThreadPool threadPool(2, "ExtractSlices");
+	threadPool.init();
+	const int faces = visibleFaces(v);
+	for (int mergeQuads = 0; mergeQuads <= 1; ++mergeQuads) {
+		voxel::ChunkMesh single;
+		SurfaceExtractionContext singleCtx =
+			voxel::buildCubicContext(&v, extractRegion, single, glm::ivec3(0), mergeQuads != 0, true, true);
+		voxel::extractSurface(singleCtx);
+
+		voxel::ChunkMesh slices;
+		SurfaceExtractionContext slicesCtx =
+			voxel::buildCubicContext(&v, extractRegion, slices, glm::ivec3(0), mergeQuads != 0, true, true);
+		slicesCtx.threadPool = &threadPool;
+		voxel::extractSurface(slicesCtx);
+
+		EXPECT_EQ(single.mesh[0].getOffset(), slices.mesh[0].getOffset());
+		EXPECT_EQ(faces, meshArea(slices.mesh[0]));
+		if (mergeQuads == 0) {
+			EXPECT_EQ(single.mesh[0].getNoOfIndices(), slices.mesh[0].getNoOfIndices());
+		}
+
+		// the result doesn't depend on the scheduling
+		voxel::ChunkMesh slices2;
+		SurfaceExtractionContext slicesCtx2 =
+			voxel::buildCubicContext(&v, extractRegion, slices2, glm::ivec3(0), mergeQuads != 0, true, true);
+		slicesCtx2.threadPool = &threadPool;
+		voxel::extractSurface(slicesCtx2);
+		ASSERT_EQ(slices.mesh[0].getNoOfIndices(), slices2.mesh[0].getNoOfIndices());
+		ASSERT_EQ(slices.mesh[0].getNoOfVertices(), slices2.mesh[0].getNoOfVertices());
+		for (size_t i = 0; i < slices.mesh[0].getNoOfIndices(); ++i) {
+			ASSERT_EQ(slices.mesh[0].getIndex(i), slices2.mesh[0].getIndex(i));
+		}
+	}
+
+	palette::Palette palette;
+	palette.nippon();
+	voxel::ChunkMesh single;
+	SurfaceExtractionContext singleCtx = voxel::buildMarchingCubesContext(&v, extractRegion, single, palette);
+	voxel::extractSurface(singleCtx);
+	voxel::ChunkMesh slices;
+	SurfaceExtractionContext slicesCtx = voxel::buildMarchingCubesContext(&v, extractRegion, slices, palette);
+	slicesCtx.threadPool = &threadPool;
+	voxel::extractSurface(slicesCtx);
+	EXPECT_GT(single.mesh[0].getNoOfIndices(), 0u);
+	EXPECT_EQ(single.mesh[0].getNoOfIndices(), slices.mesh[0].getNoOfIndices());
+	EXPECT_LE(slices.mesh[0].getNoOfVertices(), slices.mesh[0].getNormalVector().size());
+}
+
+TEST_F(SurfaceExtractorTest, testMarchingCubesSingleVoxel) {
+	voxel::RawVolume v(voxel::Region(0, 0, 0, 2, 2, 2));
+	v.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	palette::Palette palette;
+	palette.nippon();
+	voxel::ChunkMesh mesh;
+	SurfaceExtractionContext ctx = voxel::buildMarchingCubesContext(&v, v.region(), mesh, palette);
+	voxel::extractSurface(ctx);
+	// an octahedron around the voxel
+	const voxel::Mesh &m = mesh.mesh[0];
+	ASSERT_EQ(6u, m.getNoOfVertices());
+	ASSERT_EQ(8u * 3u, m.getNoOfIndices());
+	ASSERT_EQ(6u, m.getNormalVector().size());
+	for (size_t i = 0; i < m.getNoOfVertices(); ++i) {
+		const glm::vec3 dir = m.getVertexVector()[i].position - glm::vec3(1.0f);
+		EXPECT_FLOAT_EQ(0.5f, glm::length(dir));
+		EXPECT_FLOAT_EQ(1.0f, glm::dot(m.getNormalVector()[i], dir * 2.0f));
+		EXPECT_EQ(1u, m.getVertexVector()[i].colorIndex);
+	}
+}
+
+TEST_F(SurfaceExtractorTest, testMarchingCubesReference) {
+	voxel::RawVolume v(voxel::Region(0, 0, 0, 29, 23, 26));
+	for (int z = 0; z <= 26; ++z) {
+		for (int x = 0; x <= 29; ++x) {
+			const int height = 3 + (x * 7 + z * 3) % 11;
+			for (int y = 0; y <= height; ++y) {
+				// holes and overhangs to get all kinds of cells
+				if ((x * 5 + y * 3 + z) % 13 == 0) {
+					continue;
+				}
+				v.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1 + (x + z) % 3));
+			}
+		}
+	}
+	palette::Palette palette;
+	palette.nippon();
+	// the whole volume with a border outside of it, a region at the volume edge and one inside
+	const voxel::Region regions[]{voxel::Region(-1, -1, -1, 30, 24, 27), voxel::Region(20, 0, 10, 35, 16, 26),
+								  voxel::Region(3, 4, 5, 17, 12, 21)};
+	for (const voxel::Region &region : regions) {
+		voxel::ChunkMesh mesh;
+		SurfaceExtractionContext ctx = voxel::buildMarchingCubesContext(&v, region, mesh, palette);
+		voxel::extractSurface(ctx);
+		const core::DynamicArray<HalfVoxelTriangle> expected = referenceMarchingCubes(v, region);
+		const core::DynamicArray<HalfVoxelTriangle> triangles = sortedTriangles(mesh.mesh[0]);
+		ASSERT_GT(expected.size(), 0u) << region.toString().c_str();
+		ASSERT_EQ(expected.size(), triangles.size()) << region.toString().c_str();
+		for (size_t i = 0; i < expected.size(); ++i) {
+			ASSERT_TRUE(expected[i] == triangles[i]) << "triangle " << i << " differs in " << region.toString().c_str();
+		}
+	}
+}
+
 } // namespace voxel
@@ -3,14 +3,19 @@
  */
 
 #include "CollectionManager.h"
+#include "app/App.h"
 #include "app/Async.h"
+#include "app/I18N.h"
+#include "core/FourCC.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "core/Var.h"
+#include "core/collection/StringMap.h"
 #include "http/HttpCacheStream.h"
 #include "image/Image.h"
 #include "io/Archive.h"
+#include "io/FileStream.h"
 #include "io/FilesystemArchive.h"
 #include "io/Stream.h"
 #include "voxelcollection/Downloader.h"
@@ -20,8 +25,15 @@
 
 namespace voxelcollection {
 
-CollectionManager::CollectionManager(const io::FilesystemPtr &filesystem, const video::TexturePoolPtr &texturePool)
-	: _texturePool(texturePool), _filesystem(filesystem) {
+static constexpr uint32_t LocalIndexMagic = FourCC('V', 'C', 'L', 'I');
+static constexpr uint32_t LocalIndexVersion = 1;
+// the thumbnail textures and renderings that are handled in one update() call
+static constexpr int MaxThumbnailUploadsPerUpdate = 16;
+static constexpr int MaxThumbnailRendersPerUpdate = 4;
+
+CollectionManager::CollectionManager(const io::FilesystemPtr &filesystem, const video::TexturePoolPtr &texturePool,
+									 int maxDownloads)
+	: _texturePool(texturePool), _filesystem(filesystem), _downloadPool(core_max(1, maxDownloads), "Download") {
 	_archive = io::openFilesystemArchive(filesystem, "", false);
 }
 
@@ -29,6 +41,7 @@ CollectionManager::~CollectionManager() {
 }
 
 bool CollectionManager::init() {
+	_downloadPool.init();
 	VoxelSource local;
 	local.name = LOCAL_SOURCE;
 	_sources.push_back(local);
@@ -48,6 +61,17 @@ bool CollectionManager::init() {
 	if (_localDir.empty()) {
 		var->setVal(documents);
 	}
+	core::Var::get(cfg::AssetPanelLocalDepth, "0", _("The amount of sub directories of the local directory to scan"));
+	const long cacheSizeMiB =
+		core::Var::get(cfg::HttpCacheSize, "1024", _("The maximum size of the http cache in MiB - 0 disables the limit"))
+			->longVal();
+	if (cacheSizeMiB > 0) {
+		const io::FilesystemPtr filesystem = _filesystem;
+		_futures.emplace_back(app::async([filesystem, cacheSizeMiB]() {
+			const uint64_t maxBytes = (uint64_t)cacheSizeMiB * 1024u * 1024u;
+			http::HttpCacheStream::evict(filesystem, filesystem->homePath(), maxBytes);
+		}));
+	}
 	return true;
 }
 
@@ -106,6 +130,107 @@ void CollectionManager::shutdown() {
 		}
 	}
 	_futures.clear();
+	_downloadPool.shutdown();
+}
+
+VoxelFile CollectionManager::localVoxelFile(const core::String &localDir, const io::FilesystemEntry &entry) const {
+	VoxelFile voxelFile;
+	voxelFile.name = entry.fullPath.substr(localDir.size());
+	voxelFile.fullPath = entry.fullPath;
+	voxelFile.url = "file://" + entry.fullPath;
+	voxelFile.source = LOCAL_SOURCE;
+	voxelFile.license = "unknown";
+	// voxelFile.licenseUrl = "";
+	// voxelFile.thumbnailUrl = "";
+	voxelFile.downloaded = true;
+	return voxelFile;
+}
+
+core::String CollectionManager::localIndexFile() const {
+	return _filesystem->homeWritePath("collection-local.idx");
+}
+
+#define wrapBool(read)                                                                                                 \
+	if (!(read)) {                                                                                                     \
+		Log::debug("Failed to read the local collection index (line %i)", (int)__LINE__);                              \
+		return false;                                                                                                  \
+	}
+
+#define wrap(read)                                                                                                     \
+	if ((read) != 0) {                                                                                                 \
+		Log::debug("Failed to read the local collection index (line %i)", (int)__LINE__);                              \
+		return false;                                                                                                  \
+	}
+
+bool CollectionManager::loadLocalIndex(const core::String &localDir,
+									   core::DynamicArray<io::FilesystemEntry> &entries) const {
+	const io::FilePtr &file = _filesystem->open(localIndexFile(), io::FileMode::SysRead);
+	if (!file->validHandle()) {
+		return false;
+	}
+	io::FileStream stream(file);
+	uint32_t magic;
+	wrap(stream.readUInt32(magic))
+	if (magic != LocalIndexMagic) {
+		Log::debug("Invalid magic for the local collection index");
+		return false;
+	}
+	uint32_t version;
+	wrap(stream.readUInt32(version))
+	if (version != LocalIndexVersion) {
+		Log::debug("Unsupported local collection index version %u", version);
+		return false;
+	}
+	core::String dir;
+	wrapBool(stream.readPascalStringUInt16LE(dir))
+	if (dir != localDir) {
+		Log::debug("The local collection index is for a different directory: %s", dir.c_str());
+		return false;
+	}
+	uint32_t count;
+	wrap(stream.readUInt32(count))
+	const int64_t remaining = stream.remaining();
+	// each entry has at least the string length and the two 64 bit values
+	if ((int64_t)count * 18 > remaining) {
+		Log::debug("Invalid entry count %u in the local collection index", count);
+		return false;
+	}
+	entries.reserve(entries.size() + count);
+	for (uint32_t i = 0; i < count; ++i) {
+		io::FilesystemEntry entry;
+		wrapBool(stream.readPascalStringUInt16LE(entry.fullPath))
+		wrap(stream.readUInt64(entry.mtime))
+		wrap(stream.readUInt64(entry.size))
+		entry.name = core::string::extractFilenameWithExtension(entry.fullPath);
+		entry.type = io::FilesystemEntry::Type::file;
+		entries.push_back(entry);
+	}
+	return true;
+}
+
+#undef wrap
+#undef wrapBool
+
+bool CollectionManager::saveLocalIndex(const core::String &localDir,
+									   const core::DynamicArray<io::FilesystemEntry> &entries) const {
+	const io::FilePtr &file = _filesystem->open(localIndexFile(), io::FileMode::SysWrite);
+	if (!file->validHandle()) {
+		Log::warn("Failed to write the local collection index %s", file->name().c_str());
+		return false;
+	}
+	io::FileStream stream(file);
+	bool success = stream.writeUInt32(LocalIndexMagic) && stream.writeUInt32(LocalIndexVersion);
+	success &= stream.writePascalStringUInt16LE(localDir);
+	success &= stream.writeUInt32((uint32_t)entries.size());
+	for (const io::FilesystemEntry &entry : entries) {
+		success &= stream.writePascalStringUInt16LE(entry.fullPath);
+		success &= stream.writeUInt64(entry.mtime);
+		success &= stream.writeUInt64(entry.size);
+	}
+	if (!success) {
+		Log::warn("Failed to write the local collection index %s", file->name().c_str());
+	}
+	return success;
 }
 
 bool CollectionManager::local() {
@@ -118,33 +243,47 @@ bool CollectionManager::local() {
 		Log::debug("No local dir set");
 		return false;
 	}
-	_local = app::async([&, localDir]() {
+	const int depth = core::Var::getSafe(cfg::AssetPanelLocalDepth)->intVal();
+	_local = app::async([&, localDir, depth]() {
 		if (_shouldQuit) {
 			return;
 		}
+		// show the files of the last scan until the current scan is done
+		core::DynamicArray<io::FilesystemEntry> indexed;
+		if (loadLocalIndex(localDir, indexed)) {
+			Log::debug("Found %i indexed entries for %s", (int)indexed.size(), localDir.c_str());
+			for (const io::FilesystemEntry &entry : indexed) {
+				_newVoxelFiles.push(localVoxelFile(localDir, entry));
+			}
+		}
+		core::StringMap<bool, 4096> known;
+		for (const io::FilesystemEntry &entry : indexed) {
+			known.put(entry.fullPath, true);
+		}
+
 		core::DynamicArray<io::FilesystemEntry> entities;
 		Log::info("Local document scanning (%s)...", localDir.c_str());
-		_archive->list(localDir, entities, "");
+		_filesystem->list(localDir, entities, "", depth, &app::App::getInstance()->threadPool());
 		Log::debug("Found %i entries in %s", (int)entities.size(), localDir.c_str());
 
+		core::DynamicArray<io::FilesystemEntry> voxelEntries;
 		for (const io::FilesystemEntry &entry : entities) {
 			if (_shouldQuit) {
 				return;
 			}
-			if (!io::isA(entry.name, voxelformat::voxelLoad())) {
+			if (entry.isDirectory() || !io::isA(entry.name, voxelformat::voxelLoad())) {
 				continue;
 			}
-			VoxelFile voxelFile;
-			voxelFile.name = entry.fullPath.substr(localDir.size());
-			voxelFile.fullPath = entry.fullPath;
-			voxelFile.url = "file://" + entry.fullPath;
-			voxelFile.source = LOCAL_SOURCE;
-			voxelFile.license = "unknown";
-			// voxelFile.licenseUrl = "";
-			// voxelFile.thumbnailUrl = "";
-			voxelFile.downloaded = true;
-			_newVoxelFiles.push(voxelFile);
+			voxelEntries.push_back(entry);
+			if (!known.remove(entry.fullPath)) {
+				_newVoxelFiles.push(localVoxelFile(localDir, entry));
+			}
+		}
+		// whatever is left in the index doesn't exist anymore
+		for (const auto &e : known) {
+			_removedVoxelFiles.push(e->key);
 		}
+		saveLocalIndex(localDir, voxelEntries);
 	});
 	return true;
 }
@@ -192,7 +331,7 @@ void CollectionManager::loadThumbnail(const VoxelFile &voxelFile) {
 		return;
 	}
 	if (!voxelFile.thumbnailUrl.empty()) {
-		_futures.emplace_back(app::async([=]() {
+		_futures.emplace_back(_downloadPool.enqueue([=]() {
 			if (_shouldQuit) {
 				return;
 			}
@@ -200,7 +339,9 @@ void CollectionManager::loadThumbnail(const VoxelFile &voxelFile) {
 			this->_imageQueue.push(image::loadImage(voxelFile.name, stream));
 		}));
 	} else {
-		_futures.emplace_back(app::async([this, archive, voxelFile, targetImageFile]() {
+		// local files are decoded by all workers - the download pool is limited to the amount of concurrent downloads
+		core::ThreadPool &threadPool = voxelFile.isLocal() ? app::App::getInstance()->threadPool() : _downloadPool;
+		_futures.emplace_back(threadPool.enqueue([this, archive, voxelFile, targetImageFile]() {
 			if (_shouldQuit) {
 				return;
 			}
@@ -214,7 +355,7 @@ void CollectionManager::loadThumbnail(const VoxelFile &voxelFile) {
 			}
 			thumbnailImage->setName(voxelFile.name);
 			core::ScopedPtr<io::SeekableWriteStream> imageStream(archive->writeStream(targetImageFile));
-			if (!image::writeImage(thumbnailImage, *imageStream)) {
+			if (!image::writeImage(thumbnailImage, *imageStream, image::PngCompression::Fast)) {
 				Log::warn("Failed to save thumbnail for %s to %s", voxelFile.name.c_str(), targetImageFile.c_str());
 			} else {
 				Log::debug("Created thumbnail for %s at %s", voxelFile.name.c_str(), targetImageFile.c_str());
@@ -225,30 +366,61 @@ void CollectionManager::loadThumbnail(const VoxelFile &voxelFile) {
 }
 
 bool CollectionManager::createThumbnail(const VoxelFile &voxelFile) {
-	scenegraph::SceneGraph sceneGraph;
-	io::FileDescription fileDesc;
-	const core::String &fileName = absolutePath(voxelFile);
-	fileDesc.set(fileName);
-	voxelformat::LoadContext loadctx;
-	if (!voxelformat::loadFormat(fileDesc, _archive, sceneGraph, loadctx)) {
-		Log::error("Failed to load given input file: %s", fileName.c_str());
+	if (_shouldQuit) {
 		return false;
 	}
-	voxelformat::ThumbnailContext ctx;
-	image::ImagePtr image = voxelrender::volumeThumbnail(sceneGraph, ctx);
-	if (!image || !image->isLoaded()) {
-		Log::error("Failed to create thumbnail for %s", fileName.c_str());
-		return false;
+	const core::String &fileName = absolutePath(voxelFile);
+	io::ArchivePtr archive = _archive;
+	// only the rendering needs the gl context - the files are decoded in parallel
+	_futures.emplace_back(app::async([this, voxelFile, fileName, archive]() {
+		if (_shouldQuit) {
+			return;
+		}
+		io::FileDescription fileDesc;
+		fileDesc.set(fileName);
+		voxelformat::LoadContext loadctx;
+		core::SharedPtr<scenegraph::SceneGraph> sceneGraph = core::make_shared<scenegraph::SceneGraph>();
+		if (!voxelformat::loadFormat(fileDesc, archive, *sceneGraph.get(), loadctx)) {
+			Log::error("Failed to load given input file: %s", fileName.c_str());
+			return;
+		}
+		_thumbnailJobs.push({voxelFile, sceneGraph});
+	}));
+	return true;
+}
+
+void CollectionManager::renderThumbnails(int n) {
+	core::DynamicArray<ThumbnailJob> jobs;
+	if (!_thumbnailJobs.pop(jobs, n)) {
+		return;
 	}
-	image->setName(voxelFile.id());
-	_imageQueue.push(image);
-	const core::String &targetImageFile = voxelFile.targetFile() + ".png";
-	core::ScopedPtr<io::SeekableWriteStream> writeStream(_archive->writeStream(targetImageFile));
-	if (!writeStream || !image::writeImage(image, *writeStream)) {
-		Log::warn("Failed to write thumbnail to %s - no caching", targetImageFile.c_str());
+	core::DynamicArray<const scenegraph::SceneGraph *> sceneGraphs;
+	sceneGraphs.reserve(jobs.size());
+	for (const ThumbnailJob &job : jobs) {
+		sceneGraphs.push_back(job.sceneGraph.get());
+	}
+	voxelformat::ThumbnailContext ctx;
+	const core::DynamicArray<image::ImagePtr> &images = voxelrender::volumeThumbnails(sceneGraphs, ctx);
+	io::ArchivePtr archive = _archive;
+	for (size_t i = 0; i < images.size(); ++i) {
+		const VoxelFile &voxelFile = jobs[i].voxelFile;
+		const image::ImagePtr &image = images[i];
+		if (!image || !image->isLoaded()) {
+			Log::error("Failed to create thumbnail for %s", voxelFile.name.c_str());
+			continue;
+		}
+		image->setName(voxelFile.id());
+		_texturePool->addImage(image);
+		const core::String &targetImageFile = voxelFile.targetFile() + ".png";
+		_futures.emplace_back(app::async([image, archive, targetImageFile]() {
+			core::ScopedPtr<io::SeekableWriteStream> writeStream(archive->writeStream(targetImageFile));
+			if (!writeStream || !image::writeImage(image, *writeStream, image::PngCompression::Fast)) {
+				Log::warn("Failed to write thumbnail to %s - no caching", targetImageFile.c_str());
+				return;
+			}
+			Log::info("Created thumbnail at %s", targetImageFile.c_str());
+		}));
 	}
-	Log::info("Created thumbnail for %s at %s", fileName.c_str(), targetImageFile.c_str());
-	return true;
 }
 
 void CollectionManager::resolve(const VoxelSource &source, bool async) {
@@ -299,8 +471,11 @@ void CollectionManager::update(double nowSeconds, int n) {
 		_onlineSources = {};
 	}
 
-	image::ImagePtr image;
-	if (_imageQueue.pop(image)) {
+	renderThumbnails(MaxThumbnailRendersPerUpdate);
+
+	core::DynamicArray<image::ImagePtr> images;
+	_imageQueue.pop(images, MaxThumbnailUploadsPerUpdate);
+	for (const image::ImagePtr &image : images) {
 		if (image && image->isLoaded()) {
 			_texturePool->addImage(image);
 		}
@@ -322,6 +497,10 @@ void CollectionManager::update(double nowSeconds, int n) {
 			_voxelFilesMap.put(voxelFile.source, collection);
 		}
 	}
+	// the removed files must not be applied before all files of the index were added
+	if (_newVoxelFiles.empty()) {
+		removeLocalFiles();
+	}
 	for (auto e : _voxelFilesMap) {
 		VoxelCollection &collection = e->value;
 		if (collection.sorted) {
@@ -336,31 +515,62 @@ void CollectionManager::update(double nowSeconds, int n) {
 	_count += voxelFiles.size();
 }
 
-void CollectionManager::downloadAll() {
-	const io::ArchivePtr archive = _archive;
-	_futures.emplace_back(app::async([this, voxelFilesMap = _voxelFilesMap, archive]() {
-		int all = 0;
-		for (const auto &e : voxelFilesMap) {
-			all += (int)e->value.files.size();
+void CollectionManager::removeLocalFiles() {
+	auto iter = _voxelFilesMap.find(LOCAL_SOURCE);
+	core::String fullPath;
+	while (_removedVoxelFiles.pop(fullPath)) {
+		if (iter == _voxelFilesMap.end()) {
+			continue;
 		}
+		VoxelFiles &files = iter->value.files;
+		for (size_t i = 0; i < files.size(); ++i) {
+			if (files[i].fullPath == fullPath) {
+				Log::debug("Remove local file %s", fullPath.c_str());
+				files.erase(i);
+				--_count;
+				break;
+			}
+		}
+	}
+}
 
-		int current = 0;
-		for (const auto &e : voxelFilesMap) {
-			for (VoxelFile &voxelFile : e->value.files) {
-				if (_shouldQuit) {
-					return;
-				}
-				++current;
-				if (voxelFile.downloaded) {
-					continue;
-				}
-				download(archive, voxelFile);
+void CollectionManager::downloadAll() {
+	if (_downloadsQueued > 0) {
+		Log::debug("Downloads are already running");
+		return;
+	}
+	VoxelFiles voxelFiles;
+	for (const auto &e : _voxelFilesMap) {
+		for (const VoxelFile &voxelFile : e->value.files) {
+			if (!voxelFile.downloaded) {
+				voxelFiles.push_back(voxelFile);
+			}
+		}
+	}
+	if (voxelFiles.empty()) {
+		return;
+	}
+	// set the amount before the first download finishes
+	_downloadsDone = 0;
+	_downloadsQueued = (int)voxelFiles.size();
+	const io::ArchivePtr archive = _archive;
+	for (const VoxelFile &voxelFile : voxelFiles) {
+		_futures.emplace_back(_downloadPool.enqueue([this, archive, voxelFile]() {
+			if (!_shouldQuit) {
+				VoxelFile file = voxelFile;
+				download(archive, file);
+			}
+			const int all = _downloadsQueued;
+			const int current = _downloadsDone.increment() + 1;
+			if (current >= all) {
+				_downloadProgress = 0;
+				_downloadsQueued = 0;
+			} else {
 				const float p = ((float)current / (float)all * 100.0f);
 				_downloadProgress = (int)p;
 			}
-		}
-		_downloadProgress = 0;
-	}));
+		}));
+	}
 }
 
 bool CollectionManager::download(const io::ArchivePtr &archive, VoxelFile &voxelFile) {
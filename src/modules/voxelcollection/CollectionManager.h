@@ -9,8 +9,10 @@
 #include "core/collection/DynamicArray.h"
 #include "core/collection/StringSet.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/Archive.h"
 #include "io/Filesystem.h"
+#include "scenegraph/SceneGraph.h"
 #include "video/Texture.h"
 #include "video/TexturePool.h"
 #include "voxelcollection/Downloader.h"
@@ -23,13 +25,26 @@ private:
 	io::ArchivePtr _archive;
 
 	core::ConcurrentQueue<VoxelFile> _newVoxelFiles;
+	// the full paths of local files that were removed since the last scan
+	core::ConcurrentQueue<core::String> _removedVoxelFiles;
 	VoxelFileMap _voxelFilesMap;
 
 	core::ConcurrentQueue<image::ImagePtr> _imageQueue;
+	// the scenes that were loaded by the workers and wait for their thumbnail to get rendered on the main thread
+	struct ThumbnailJob {
+		VoxelFile voxelFile;
+		core::SharedPtr<scenegraph::SceneGraph> sceneGraph;
+	};
+	core::ConcurrentQueue<ThumbnailJob> _thumbnailJobs;
 	video::TexturePoolPtr _texturePool;
 	io::FilesystemPtr _filesystem;
 
+	// the network requests run here - this limits the amount of concurrent downloads and keeps
+	// the blocking requests away from the application thread pool
+	core::ThreadPool _downloadPool;
 	core::AtomicInt _downloadProgress = 0; // 0-100
+	core::AtomicInt _downloadsQueued = 0;
+	core::AtomicInt _downloadsDone = 0;
 	core::AtomicBool _shouldQuit = false;
 	int _count = 0;
 
@@ -42,9 +57,19 @@ private:
 	std::future<VoxelSources> _onlineSources;
 	core::DynamicArray<std::future<void>> _futures;
 	bool download(const io::ArchivePtr &archive, VoxelFile &voxelFile);
+	VoxelFile localVoxelFile(const core::String &localDir, const io::FilesystemEntry &entry) const;
+	void removeLocalFiles();
+	/**
+	 * @brief Renders the thumbnails of up to @c n loaded scenes in one batch - the png files are written by the workers
+	 */
+	void renderThumbnails(int n);
 
 public:
-	CollectionManager(const io::FilesystemPtr &filesystem, const video::TexturePoolPtr &texturePool);
+	/**
+	 * @param[in] maxDownloads The amount of concurrent downloads (thumbnails and voxel files)
+	 */
+	CollectionManager(const io::FilesystemPtr &filesystem, const video::TexturePoolPtr &texturePool,
+					  int maxDownloads = 4);
 	virtual ~CollectionManager();
 
 	bool init() override;
@@ -57,6 +82,17 @@ public:
 	const core::String &localDir() const;
 	bool setLocalDir(const core::String &dir);
 
+	/**
+	 * @brief The index of the last scan of the local directory - this allows us to show the local files on startup
+	 * before the scan is done. The scan only applies the differences.
+	 */
+	core::String localIndexFile() const;
+	/**
+	 * @return @c false if there is no index for the given local directory
+	 */
+	bool loadLocalIndex(const core::String &localDir, core::DynamicArray<io::FilesystemEntry> &entries) const;
+	bool saveLocalIndex(const core::String &localDir, const core::DynamicArray<io::FilesystemEntry> &entries) const;
+
 	bool local();
 	bool online();
 	/**
@@ -77,6 +113,10 @@ public:
 	 * @note This does NOT create thumbnails from vengi render shots
 	 */
 	void loadThumbnail(const VoxelFile &voxelFile);
+	/**
+	 * @brief Queues the creation of a thumbnail - the file is loaded by a worker, the thumbnail is rendered in
+	 * update() and written to the cache by a worker again
+	 */
 	bool createThumbnail(const VoxelFile &voxelFile);
 
 	void thumbnailAll();
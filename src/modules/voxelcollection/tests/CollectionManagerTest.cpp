@@ -42,6 +42,26 @@ TEST_F(CollectionManagerTest, DISABLED_testLocal) {
 	ASSERT_GT(_mgr->allEntries(), 0);
 }
 
+TEST_F(CollectionManagerTest, testLocalIndex) {
+	core::DynamicArray<io::FilesystemEntry> entries;
+	io::FilesystemEntry entry;
+	entry.fullPath = _mgr->localDir() + "dir/file.vox";
+	entry.mtime = 1234u;
+	entry.size = 42u;
+	entries.push_back(entry);
+	ASSERT_TRUE(_mgr->saveLocalIndex(_mgr->localDir(), entries));
+
+	core::DynamicArray<io::FilesystemEntry> loaded;
+	EXPECT_FALSE(_mgr->loadLocalIndex("/some/other/dir/", loaded));
+	ASSERT_TRUE(_mgr->loadLocalIndex(_mgr->localDir(), loaded));
+	ASSERT_EQ(1u, loaded.size());
+	EXPECT_EQ(entry.fullPath, loaded[0].fullPath);
+	EXPECT_EQ("file.vox", loaded[0].name);
+	EXPECT_EQ(1234u, loaded[0].mtime);
+	EXPECT_EQ(42u, loaded[0].size);
+	EXPECT_TRUE(io::Filesystem::sysRemoveFile(_mgr->localIndexFile()));
+}
+
 TEST_F(CollectionManagerTest, DISABLED_testOnline) {
 	const size_t before = _mgr->sources().size();
 	ASSERT_TRUE(_mgr->online());
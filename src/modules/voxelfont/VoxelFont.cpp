@@ -58,6 +58,7 @@ bool VoxelFont::init(const char *filename) {
 }
 
 void VoxelFont::shutdown() {
+	_glyphs.clear();
 	delete _font;
 	_font = nullptr;
 
@@ -80,45 +81,65 @@ void VoxelFont::dimensions(const char *string, uint8_t size, int &w, int &h) con
 	}
 }
 
-int VoxelFont::renderCharacter(int codepoint, uint8_t size, int thickness, const glm::ivec3 &pos,
-							   voxel::RawVolumeWrapper &volume, const voxel::Voxel &voxel, math::Axis axis) {
+const VoxelFont::Glyph &VoxelFont::glyph(int codepoint, uint8_t size) {
+	const uint64_t key = ((uint64_t)size << 32u) | (uint32_t)codepoint;
+	if (const Glyph *cached = _glyphs.ptr(key)) {
+		return *cached;
+	}
+	Glyph glyph;
 	const float scale = stbtt_ScaleForPixelHeight(_font, (float)size);
 	int w;
 	int h;
 	unsigned char *bitmap = stbtt_GetCodepointBitmap(_font, 0.0f, scale, codepoint, &w, &h, nullptr, nullptr);
-	thickness = core_max(1, thickness);
-
 	if (bitmap == nullptr) {
 		Log::warn("Could not create voxelfont mesh for character: %i", codepoint);
-		return 0;
+	} else {
+		int ix0, iy0, ix1, iy1;
+		stbtt_GetCodepointBitmapBox(_font, codepoint, 0.0f, scale, &ix0, &iy0, &ix1, &iy1);
+		for (int y = 0; y < h; ++y) {
+			const unsigned char *row = bitmap + y * w;
+			for (int x = 0; x < w; ++x) {
+				// antialiasing
+				if (row[x] < 25) {
+					continue;
+				}
+				const int start = x;
+				while (x + 1 < w && row[x + 1] >= 25) {
+					++x;
+				}
+				glyph.spans.push_back({start + ix0, x + ix0, h - 1 - y});
+			}
+		}
+		glyph.width = w;
+		stbtt_FreeBitmap(bitmap, nullptr);
 	}
+	_glyphs.emplace(key, core::move(glyph));
+	return *_glyphs.ptr(key);
+}
 
-	int ix0, iy0, ix1, iy1;
-	stbtt_GetCodepointBitmapBox(_font, codepoint, 0.0f, scale, &ix0, &iy0, &ix1, &iy1);
-
+int VoxelFont::renderCharacter(int codepoint, uint8_t size, int thickness, const glm::ivec3 &pos,
+							   voxel::RawVolumeWrapper &volume, const voxel::Voxel &voxel, math::Axis axis) {
+	const Glyph &g = glyph(codepoint, size);
+	thickness = core_max(1, thickness);
 	const int widthIndex = math::getIndexForAxis(axis);
-	glm::ivec3 dim;
-	dim[(widthIndex + 0) % 3] = w;
-	dim[(widthIndex + 1) % 3] = h;
-	dim[(widthIndex + 2) % 3] = thickness;
-
-	for (int y = 0; y < h; ++y) {
-		for (int x = 0; x < w; ++x) {
-			// antialiasing
-			if (bitmap[y * w + x] >= 25) {
-				glm::ivec3 v;
-				v[(widthIndex + 0) % 3] = x + ix0;
-				v[(widthIndex + 1) % 3] = dim[(widthIndex + 1) % 3] - 1 - y;
-				v[(widthIndex + 2) % 3] = 0;
-				for (int z = 0; z < thickness; ++z) {
-					v[(widthIndex + 2) % 3] = z;
-					volume.setVoxel(pos + v, voxel);
-				}
+	const int heightIndex = (widthIndex + 1) % 3;
+	const int depthIndex = (widthIndex + 2) % 3;
+	for (const Span &span : g.spans) {
+		glm::ivec3 v;
+		v[heightIndex] = pos[heightIndex] + span.y;
+		for (int z = 0; z < thickness; ++z) {
+			v[depthIndex] = pos[depthIndex] + z;
+			if (widthIndex == 0) {
+				volume.setRow(pos.x + span.x0, pos.x + span.x1, v.y, v.z, voxel);
+				continue;
+			}
+			for (int x = span.x0; x <= span.x1; ++x) {
+				v[widthIndex] = pos[widthIndex] + x;
+				volume.setVoxel(v, voxel);
 			}
 		}
 	}
-	stbtt_FreeBitmap(bitmap, nullptr);
-	return w;
+	return g.width;
 }
 
 } // namespace voxelfont
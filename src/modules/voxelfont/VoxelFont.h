@@ -5,6 +5,8 @@
 #pragma once
 
 #include "core/String.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/FlatMap.h"
 #include "math/Axis.h"
 #include <glm/fwd.hpp>
 #include <stdint.h>
@@ -20,14 +22,33 @@ namespace voxelfont {
 
 /**
  * @brief Will take any TTF font and rasterizes into voxels
+ *
+ * The rasterized glyphs are cached per font size as rows of solid pixels - rendering the same character again is only
+ * a copy of these rows into the volume. The cache is cleared if another font is loaded.
  */
 class VoxelFont {
 private:
+	/**
+	 * @brief A horizontal run of solid pixels of a glyph - relative to the pen position and already flipped to grow
+	 * upwards
+	 */
+	struct Span {
+		int x0;
+		int x1;
+		int y;
+	};
+	struct Glyph {
+		core::DynamicArray<Span> spans;
+		/** the width of the glyph bitmap - the pen advance */
+		int width = 0;
+	};
 	stbtt_fontinfo *_font = nullptr;
 	uint8_t *_ttfBuffer = nullptr;
 	core::String _filename;
+	// the key is the font size and the codepoint
+	core::FlatMap<uint64_t, Glyph> _glyphs;
 
-	bool renderGlyphs(const char *string);
+	const Glyph &glyph(int codepoint, uint8_t size);
 
 public:
 	~VoxelFont();
@@ -36,6 +57,9 @@ public:
 	void shutdown();
 
 	void dimensions(const char *string, uint8_t size, int &w, int &h) const;
+	/**
+	 * @return The width of the rendered character - @c 0 if the character couldn't get rasterized
+	 */
 	int renderCharacter(int codepoint, uint8_t size, int thickness, const glm::ivec3 &pos,
 						voxel::RawVolumeWrapper &volume, const voxel::Voxel &voxel, math::Axis axis = math::Axis::X);
 };
@@ -3,14 +3,17 @@
  */
 
 #include "Format.h"
+#include "FormatProbe.h"
 #include "VolumeFormat.h"
 #include "app/App.h"
+#include "app/Async.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Parallel.h"
 #include "core/Color.h"
 #include "core/Common.h"
-#include "core/ConfigVar.h"
 #include "core/Log.h"
+#include "core/PerfStats.h"
 #include "core/StringUtil.h"
-#include "core/Var.h"
 #include "core/collection/DynamicArray.h"
 #include "image/Image.h"
 #include "io/Archive.h"
@@ -101,6 +104,16 @@ size_t PaletteFormat::loadPalette(const core::String &filename, const io::Archiv
 	return palette.size();
 }
 
+bool Format::probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+				   const LoadContext &ctx) {
+	scenegraph::SceneGraph sceneGraph;
+	if (!load(filename, archive, sceneGraph, ctx)) {
+		return false;
+	}
+	probeSceneGraph(sceneGraph, info);
+	return true;
+}
+
 image::ImagePtr Format::loadScreenshot(const core::String &filename, const io::ArchivePtr &, const LoadContext &) {
 	Log::debug("%s doesn't have a supported embedded screenshot", filename.c_str());
 	return image::ImagePtr();
@@ -111,11 +124,12 @@ glm::ivec3 Format::maxSize() const {
 }
 
 bool Format::singleVolume() const {
-	return core::Var::getSafe(cfg::VoxformatMerge)->boolVal();
+	return _config.merge;
 }
 
 bool Format::save(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
 				  const io::ArchivePtr &archive, const SaveContext &ctx) {
+	setConfig(ctx.config);
 	bool needsSplit = false;
 	const glm::ivec3 maxsize = maxSize();
 	if (maxsize.x > 0 && maxsize.y > 0 && maxsize.z > 0) {
@@ -138,7 +152,7 @@ bool Format::save(const scenegraph::SceneGraph &sceneGraph, const core::String &
 		return false;
 	}
 
-	const bool saveVisibleOnly = core::Var::getSafe(cfg::VoxformatSaveVisibleOnly)->boolVal();
+	const bool saveVisibleOnly = ctx.config.saveVisibleOnly;
 	if (singleVolume() && sceneGraph.size(scenegraph::SceneGraphNodeType::AllModels) > 1) {
 		Log::debug("Merge volumes before saving as the target format only supports one volume");
 		scenegraph::SceneGraph::MergeResult merged = sceneGraph.merge(saveVisibleOnly);
@@ -178,9 +192,14 @@ bool Format::save(const scenegraph::SceneGraph &sceneGraph, const core::String &
 
 bool Format::load(const core::String &filename, const io::ArchivePtr &archive, scenegraph::SceneGraph &sceneGraph,
 				  const LoadContext &ctx) {
-	if (!loadGroups(filename, archive, sceneGraph, ctx)) {
-		return false;
+	setConfig(ctx.config);
+	{
+		core::ScopedPerfTimer timer(core::PerfStat::FormatDecode);
+		if (!loadGroups(filename, archive, sceneGraph, ctx)) {
+			return false;
+		}
 	}
+	core::ScopedPerfTimer timer(core::PerfStat::FormatValidate);
 	if (!sceneGraph.validate()) {
 		Log::warn("Failed to validate the scene graph - try to fix as much as we can");
 		sceneGraph.fixErrors();
@@ -189,6 +208,12 @@ bool Format::load(const core::String &filename, const io::ArchivePtr &archive, s
 			return false;
 		}
 	}
+	if (_config.createReferences) {
+		const int converted = scenegraph::convertDuplicatesToReferences(sceneGraph);
+		if (converted > 0) {
+			Log::info("Converted %i duplicated models into references", converted);
+		}
+	}
 	return true;
 }
 
@@ -196,6 +221,72 @@ bool Format::stopExecution() {
 	return app::App::getInstance()->shouldQuit();
 }
 
+bool Format::decodeParallel(size_t amount, const std::function<bool(size_t)> &decoder) {
+	if (amount <= 1u) {
+		return amount == 0u || decoder(0);
+	}
+	// one index per task - the calling thread takes part and finishes the work if the pool is shutting down
+	core::AtomicBool success(true);
+	core::parallelFor(
+		&app::App::getInstance()->threadPool(), 0, (int)amount,
+		[&](int from, int to) {
+			for (int i = from; i < to; ++i) {
+				if (!decoder((size_t)i)) {
+					success = false;
+				}
+			}
+		},
+		1);
+	return success;
+}
+
+bool Format::encodeParallel(size_t amount, const std::function<bool(size_t, io::WriteStream &)> &encoder,
+							EncodedBuffers &buffers) {
+	buffers.clear();
+	buffers.reserve(amount);
+	for (size_t i = 0; i < amount; ++i) {
+		buffers.emplace_back(core::make_shared<io::ChunkedWriteStream>());
+	}
+	return decodeParallel(amount, [&](size_t i) { return encoder(i, *buffers[i].get()); });
+}
+
+bool Format::encodeParallel(size_t amount, const std::function<bool(size_t, io::WriteStream &)> &encoder,
+							io::WriteStream &stream) {
+	if (amount <= 1u) {
+		return amount == 0u || encoder(0, stream);
+	}
+	EncodedBuffers buffers;
+	buffers.reserve(amount);
+	core::DynamicArray<std::future<bool>> futures;
+	futures.reserve(amount);
+	for (size_t i = 0; i < amount; ++i) {
+		buffers.emplace_back(core::make_shared<io::ChunkedWriteStream>());
+		io::ChunkedWriteStream *buffer = buffers[i].get();
+		futures.emplace_back(app::async([&encoder, buffer, i]() { return encoder(i, *buffer); }));
+	}
+	// all futures must be finished before the buffers go out of scope - even if one of them failed
+	bool success = true;
+	for (size_t i = 0; i < amount; ++i) {
+		io::ChunkedWriteStream *buffer = buffers[i].get();
+		bool encoded;
+		if (futures[i].valid()) {
+			encoded = futures[i].get();
+		} else {
+			// the thread pool doesn't accept new tasks while it's shutting down
+			encoded = encoder(i, *buffer);
+		}
+		if (success && encoded && buffer->size() > 0) {
+			if (!buffer->writeTo(stream)) {
+				Log::error("Failed to write the encoded buffer %i", (int)i);
+				success = false;
+			}
+		}
+		success &= encoded;
+		buffers[i] = core::SharedPtr<io::ChunkedWriteStream>();
+	}
+	return success;
+}
+
 bool PaletteFormat::loadGroups(const core::String &filename, const io::ArchivePtr &archive,
 							   scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) {
 	palette::Palette palette;
@@ -203,7 +294,8 @@ bool PaletteFormat::loadGroups(const core::String &filename, const io::ArchivePt
 		return false;
 	}
 
-	const bool createPalette = core::Var::getSafe(cfg::VoxelCreatePalette)->boolVal();
+	core::ScopedPerfTimer timer(core::PerfStat::FormatPalette);
+	const bool createPalette = ctx.config.createPalette;
 	if (!createPalette) {
 		Log::info("Remap the palette to %s", voxel::getPalette().name().c_str());
 		for (const auto &e :sceneGraph.nodes()) {
@@ -222,11 +314,12 @@ bool PaletteFormat::loadGroups(const core::String &filename, const io::ArchivePt
 int PaletteFormat::emptyPaletteIndex() const {
 	// this is only taken into account if the format doesn't force a
 	// particular empty index by overriding this method.
-	return core::Var::getSafe(cfg::VoxformatEmptyPaletteIndex)->intVal();
+	return _config.emptyPaletteIndex;
 }
 
 bool PaletteFormat::save(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
 						 const io::ArchivePtr &archive, const SaveContext &ctx) {
+	setConfig(ctx.config);
 	int emptyIndex = this->emptyPaletteIndex();
 	if (onlyOnePalette() && sceneGraph.hasMoreThanOnePalette()) {
 		Log::debug("Need to merge palettes before saving");
@@ -310,16 +403,19 @@ bool PaletteFormat::save(const scenegraph::SceneGraph &sceneGraph, const core::S
 	return Format::save(sceneGraph, filename, archive, ctx);
 }
 
-Format::Format() {
-	_flattenFactor = core::Var::getSafe(cfg::VoxformatRGBFlattenFactor)->intVal();
+Format::Format() : _config(FormatConfig::fromVars()) {
+}
+
+void Format::setConfig(const FormatConfig &config) {
+	_config = config;
 }
 
 core::RGBA Format::flattenRGB(core::RGBA rgba) const {
-	return core::Color::flattenRGB(rgba.r, rgba.g, rgba.b, rgba.a, _flattenFactor);
+	return core::Color::flattenRGB(rgba.r, rgba.g, rgba.b, rgba.a, _config.rgbFlattenFactor);
 }
 
 core::RGBA Format::flattenRGB(uint8_t r, uint8_t g, uint8_t b, uint8_t a) const {
-	return core::Color::flattenRGB(r, g, b, a, _flattenFactor);
+	return core::Color::flattenRGB(r, g, b, a, _config.rgbFlattenFactor);
 }
 
 int Format::createPalette(const RGBAMap &colors, palette::Palette &palette) const {
@@ -360,13 +456,16 @@ int Format::createPalette(const RGBAMaterialMap &colors, palette::Palette &palet
 bool RGBAFormat::loadGroups(const core::String &filename, const io::ArchivePtr &archive,
 							scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) {
 	palette::Palette palette;
-	const bool createPalette = core::Var::getSafe(cfg::VoxelCreatePalette)->boolVal();
-	if (createPalette) {
-		if (loadPalette(filename, archive, palette, ctx) <= 0) {
+	{
+		core::ScopedPerfTimer timer(core::PerfStat::FormatPalette);
+		const bool createPalette = ctx.config.createPalette;
+		if (createPalette) {
+			if (loadPalette(filename, archive, palette, ctx) <= 0) {
+				palette = voxel::getPalette();
+			}
+		} else {
 			palette = voxel::getPalette();
 		}
-	} else {
-		palette = voxel::getPalette();
 	}
 	if (!loadGroupsRGBA(filename, archive, sceneGraph, palette, ctx)) {
 		return false;
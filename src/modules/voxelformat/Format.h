@@ -8,15 +8,21 @@
 
 #pragma once
 
+#include "core/SharedPtr.h"
+#include "core/collection/DynamicArray.h"
 #include "core/collection/DynamicMap.h"
 #include "image/Image.h"
 #include "io/Archive.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/ChunkedWriteStream.h"
 #include "io/FormatDescription.h"
 #include "io/Stream.h"
 #include "palette/Palette.h"
 #include "voxel/RawVolume.h"
+#include "voxelformat/FormatConfig.h"
 #include "voxelformat/FormatThumbnail.h"
 #include <glm/fwd.hpp>
+#include <functional>
 
 namespace palette {
 class Palette;
@@ -33,6 +39,8 @@ class SceneGraphNode;
 
 namespace voxelformat {
 
+struct ProbeInfo;
+
 /**
  * see @c Format::createPalette()
  *
@@ -47,6 +55,10 @@ typedef void (*ProgressMonitor)(const char *name, int cur, int max);
 
 struct LoadContext {
 	ProgressMonitor monitor = nullptr;
+	/**
+	 * The settings for this load operation - by default a snapshot of the cvars at the time the context was created
+	 */
+	FormatConfig config = FormatConfig::fromVars();
 	inline void progress(const char *name, int cur, int max) const {
 		if (monitor == nullptr) {
 			return;
@@ -56,6 +68,10 @@ struct LoadContext {
 };
 struct SaveContext {
 	ProgressMonitor monitor = nullptr;
+	/**
+	 * The settings for this save operation - by default a snapshot of the cvars at the time the context was created
+	 */
+	FormatConfig config = FormatConfig::fromVars();
 	inline void progress(const char *name, int cur, int max) const {
 		if (monitor == nullptr) {
 			return;
@@ -79,7 +95,11 @@ static constexpr int MaxRegionSize = 256;
  */
 class Format {
 protected:
-	uint8_t _flattenFactor;
+	/**
+	 * @brief The settings of the current operation - taken from the @c LoadContext or @c SaveContext
+	 * @sa setConfig()
+	 */
+	FormatConfig _config;
 	/**
 	 * @brief If you have to split the volumes in the scene graph because the format only supports a certain size, you
 	 * can return the max size here. If the returned value is not a valid volume size (<= 0) the value is ignored.
@@ -129,6 +149,41 @@ protected:
 	 */
 	static bool stopExecution();
 
+	/**
+	 * @brief Decodes the independent models of a format in parallel on the thread pool of the app
+	 *
+	 * The decoder is called for each index in [0, amount) and should only write into the results for its own index.
+	 * All calls are finished when this returns. Assemble the scene graph afterwards on the calling thread in the order of
+	 * the indices - this keeps the node ids deterministic.
+	 *
+	 * @return @c false if any of the calls returned @c false
+	 */
+	static bool decodeParallel(size_t amount, const std::function<bool(size_t)> &decoder);
+	using EncodedBuffers = core::DynamicArray<core::SharedPtr<io::ChunkedWriteStream>>;
+	/**
+	 * @brief Encodes the independent models of a format in parallel on the thread pool of the app into memory buffers
+	 *
+	 * The encoder is called for each index in [0, amount) and should only write into the given stream - which is the
+	 * buffer for this index. Use this if the payloads are not written one after another - e.g. because they are nested
+	 * in other chunks. The buffers don't reallocate while growing - use @c io::ChunkedWriteStream::writeTo() to write
+	 * them.
+	 *
+	 * @return @c false if any of the calls returned @c false
+	 */
+	static bool encodeParallel(size_t amount, const std::function<bool(size_t, io::WriteStream &)> &encoder,
+							   EncodedBuffers &buffers);
+	/**
+	 * @brief Encodes the independent models of a format in parallel and writes them in the order of the indices into
+	 * the given stream
+	 *
+	 * Each buffer is written as soon as its encoder and all the encoders of the previous indices are done - the memory
+	 * of the buffer is freed afterwards.
+	 *
+	 * @return @c false if any of the calls returned @c false or writing into the stream failed
+	 */
+	static bool encodeParallel(size_t amount, const std::function<bool(size_t, io::WriteStream &)> &encoder,
+							   io::WriteStream &stream);
+
 	static core::String stringProperty(const scenegraph::SceneGraphNode *node, const core::String &name,
 									   const core::String &defaultVal = "");
 	static bool boolProperty(const scenegraph::SceneGraphNode *node, const core::String &name, bool defaultVal = false);
@@ -157,6 +212,12 @@ public:
 	Format();
 	virtual ~Format() = default;
 
+	/**
+	 * @brief Applies the settings of a context. @c load() and @c save() are doing this on their own - the other entry
+	 * points like @c loadPalette() are using the cvar values from the time the format was created otherwise.
+	 */
+	void setConfig(const FormatConfig &config);
+
 	/**
 	 * @brief If a format only supports a single volume. If this returns true, the @¢ save() method gets a scene graph
 	 * with only one model
@@ -174,6 +235,16 @@ public:
 	virtual image::ImagePtr loadScreenshot(const core::String &filename, const io::ArchivePtr &archive,
 										   const LoadContext &ctx);
 
+	/**
+	 * @brief Describes the scene of the file without loading the voxels: the node tree, the regions of the models and
+	 * the embedded palette.
+	 * @note The default implementation loads the whole scene graph - formats should implement this natively to
+	 * speed up the indexing of collections.
+	 * @sa probeSceneGraph()
+	 */
+	virtual bool probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+					   const LoadContext &ctx);
+
 	/**
 	 * @brief Only load the palette that is included in the format
 	 * @note Not all voxel formats have a palette included - if they do and don't have this method implemented, they
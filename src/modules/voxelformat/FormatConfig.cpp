@@ -20,6 +20,81 @@ static bool colorReductionValidator(const core::String &value) {
 	return core::Color::toColorReductionType(value.c_str()) != core::Color::ColorReductionType::Max;
 }
 
+static bool boolVar(const char *name, bool defaultVal) {
+	const core::VarPtr &var = core::Var::get(name);
+	return var ? var->boolVal() : defaultVal;
+}
+
+static int intVar(const char *name, int defaultVal) {
+	const core::VarPtr &var = core::Var::get(name);
+	return var ? var->intVal() : defaultVal;
+}
+
+static float floatVar(const char *name, float defaultVal) {
+	const core::VarPtr &var = core::Var::get(name);
+	return var ? var->floatVal() : defaultVal;
+}
+
+static core::String strVar(const char *name, const core::String &defaultVal) {
+	const core::VarPtr &var = core::Var::get(name);
+	return var ? var->strVal() : defaultVal;
+}
+
+FormatConfig FormatConfig::fromVars() {
+	FormatConfig c;
+	c.merge = boolVar(cfg::VoxformatMerge, c.merge);
+	c.createReferences = boolVar(cfg::VoxformatCreateReferences, c.createReferences);
+	c.saveVisibleOnly = boolVar(cfg::VoxformatSaveVisibleOnly, c.saveVisibleOnly);
+	c.createPalette = boolVar(cfg::VoxelCreatePalette, c.createPalette);
+	c.emptyPaletteIndex = intVar(cfg::VoxformatEmptyPaletteIndex, c.emptyPaletteIndex);
+	c.rgbFlattenFactor = (uint8_t)intVar(cfg::VoxformatRGBFlattenFactor, c.rgbFlattenFactor);
+	c.rgbWeightedAverage = boolVar(cfg::VoxformatRGBWeightedAverage, c.rgbWeightedAverage);
+
+	c.scale = floatVar(cfg::VoxformatScale, c.scale);
+	c.scaleX = floatVar(cfg::VoxformatScaleX, c.scaleX);
+	c.scaleY = floatVar(cfg::VoxformatScaleY, c.scaleY);
+	c.scaleZ = floatVar(cfg::VoxformatScaleZ, c.scaleZ);
+	c.fillHollow = boolVar(cfg::VoxformatFillHollow, c.fillHollow);
+	c.voxelizeMode = intVar(cfg::VoxformatVoxelizeMode, c.voxelizeMode);
+	c.normalPalette = strVar(cfg::NormalPalette, c.normalPalette);
+	c.texturePath = strVar(cfg::VoxformatTexturePath, c.texturePath);
+	c.pointCloudSize = intVar(cfg::VoxformatPointCloudSize, c.pointCloudSize);
+	c.meshBucketSize = intVar(cfg::VoxformatMeshBucketSize, c.meshBucketSize);
+
+	c.mergeQuads = boolVar(cfg::VoxformatMergequads, c.mergeQuads);
+	c.reuseVertices = boolVar(cfg::VoxformatReusevertices, c.reuseVertices);
+	c.ambientOcclusion = boolVar(cfg::VoxformatAmbientocclusion, c.ambientOcclusion);
+	c.quads = boolVar(cfg::VoxformatQuads, c.quads);
+	c.withColor = boolVar(cfg::VoxformatWithColor, c.withColor);
+	c.withNormals = boolVar(cfg::VoxformatWithNormals, c.withNormals);
+	c.colorAsFloat = boolVar(cfg::VoxformatColorAsFloat, c.colorAsFloat);
+	c.withTexCoords = boolVar(cfg::VoxformatWithtexcoords, c.withTexCoords);
+	c.transform = boolVar(cfg::VoxformatTransform, c.transform);
+	c.optimize = boolVar(cfg::VoxformatOptimize, c.optimize);
+	c.simplifyError = floatVar(cfg::VoxformatSimplifyError, c.simplifyError);
+	c.withMaterials = boolVar(cfg::VoxFormatWithMaterials, c.withMaterials);
+	c.meshMode = intVar(cfg::VoxelMeshMode, c.meshMode);
+	c.gltfKHRMaterialsPbrSpecularGlossiness =
+		boolVar(cfg::VoxFormatGLTF_KHR_materials_pbrSpecularGlossiness, c.gltfKHRMaterialsPbrSpecularGlossiness);
+	c.gltfKHRMaterialsSpecular = boolVar(cfg::VoxFormatGLTF_KHR_materials_specular, c.gltfKHRMaterialsSpecular);
+	c.gltfKHRMeshQuantization = boolVar(cfg::VoxFormatGLTF_KHR_mesh_quantization, c.gltfKHRMeshQuantization);
+
+	c.qbtPaletteMode = boolVar(cfg::VoxformatQBTPaletteMode, c.qbtPaletteMode);
+	c.qbtMergeCompounds = boolVar(cfg::VoxformatQBTMergeCompounds, c.qbtMergeCompounds);
+	c.qbSaveLeftHanded = boolVar(cfg::VoxformatQBSaveLeftHanded, c.qbSaveLeftHanded);
+	c.qbSaveCompressed = boolVar(cfg::VoxformatQBSaveCompressed, c.qbSaveCompressed);
+	c.voxCreateGroups = boolVar(cfg::VoxformatVOXCreateGroups, c.voxCreateGroups);
+	c.voxCreateLayers = boolVar(cfg::VoxformatVOXCreateLayers, c.voxCreateLayers);
+	c.vengiCompressionLevel = intVar(cfg::VoxformatVENGICompressionLevel, c.vengiCompressionLevel);
+	c.vengiLazyLoad = boolVar(cfg::VoxformatVENGILazyLoad, c.vengiLazyLoad);
+
+	c.imageImportType = intVar(cfg::VoxformatImageImportType, c.imageImportType);
+	c.imageVolumeMaxDepth = intVar(cfg::VoxformatImageVolumeMaxDepth, c.imageVolumeMaxDepth);
+	c.imageVolumeBothSides = boolVar(cfg::VoxformatImageVolumeBothSides, c.imageVolumeBothSides);
+	c.imageHeightmapMinHeight = intVar(cfg::VoxformatImageHeightmapMinHeight, c.imageHeightmapMinHeight);
+	return c;
+}
+
 bool FormatConfig::init() {
 	core::Var::get(cfg::CoreColorReduction,
 				   core::Color::toColorReductionTypeString(core::Color::ColorReductionType::MedianCut),
@@ -66,12 +141,22 @@ bool FormatConfig::init() {
 				   _("Export with uv coordinates of the palette image"), core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatTransform, "true", core::CV_NOPERSIST,
 				   _("Apply the scene graph transform to mesh exports"), core::Var::boolValidator);
-	core::Var::get(cfg::VoxformatOptimize, "false", core::CV_NOPERSIST, _("Apply mesh optimization steps to meshes"),
-				   core::Var::boolValidator);
+	core::Var::get(cfg::VoxformatOptimize, "true", core::CV_NOPERSIST,
+				   _("Optimize the meshes for the vertex cache, overdraw and vertex fetch"), core::Var::boolValidator);
+	core::Var::get(cfg::VoxformatSimplifyError, "0.0", core::CV_NOPERSIST,
+				   _("Simplify the marching cubes meshes with this error relative to the mesh extents (0 = off)"),
+				   [](const core::String &var) {
+					   const float error = var.toFloat();
+					   return error >= 0.0f && error <= 1.0f;
+				   });
 	core::Var::get(cfg::VoxformatFillHollow, "true", core::CV_NOPERSIST,
 				   _("Fill the hollows when voxelizing a mesh format"), core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatVoxelizeMode, MeshFormat::VoxelizeMode::HighQuality, core::CV_NOPERSIST,
-				   _("0 = high quality, 1 = faster and less memory"), core::Var::minMaxValidator<0, 1>);
+				   _("0 = high quality, 1 = faster and less memory, 2 = rasterize without subdividing"),
+				   core::Var::minMaxValidator<0, 2>);
+	core::Var::get(cfg::VoxformatMeshBucketSize, "256", core::CV_NOPERSIST,
+				   _("Split large levels into buckets of this size that are voxelized into their own models (0 = off)"),
+				   core::Var::minMaxValidator<0, 65536>);
 	core::Var::get(cfg::VoxformatQBTPaletteMode, "true", core::CV_NOPERSIST,
 				   _("Use palette mode in qubicle qbt export"), core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatQBTMergeCompounds, "false", core::CV_NOPERSIST, _("Merge compounds on load"),
@@ -80,6 +165,9 @@ bool FormatConfig::init() {
 				   _("This is the NAME part of palette-<NAME>.png or absolute png file to use (1x256)"));
 	core::Var::get(cfg::VoxformatMerge, "false", core::CV_NOPERSIST, _("Merge all objects into one"),
 				   core::Var::boolValidator);
+	core::Var::get(cfg::VoxformatCreateReferences, "false", core::CV_NOPERSIST,
+				   _("Convert models with the same voxels into references of the first model on load"),
+				   core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatEmptyPaletteIndex, "-1", core::CV_NOPERSIST,
 				   _("The index of the empty color in the palette"), [](const core::String &var) {
 					   const int type = var.toInt();
@@ -95,6 +183,11 @@ bool FormatConfig::init() {
 				   _("Toggle between left and right handed"), core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatQBSaveCompressed, "true", core::CV_NOPERSIST, _("Save RLE compressed"),
 				   core::Var::boolValidator);
+	core::Var::get(cfg::VoxformatVENGICompressionLevel, "6", core::CV_NOPERSIST,
+				   _("The compression level of the vengi format (0 = no compression, 9 = best compression)"),
+				   core::Var::minMaxValidator<0, 9>);
+	core::Var::get(cfg::VoxformatVENGILazyLoad, "false", core::CV_NOPERSIST,
+				   _("Decode the voxels of the vengi format on first access of a model"), core::Var::boolValidator);
 	core::Var::get(cfg::VoxelCreatePalette, "true", core::CV_NOPERSIST, _("Create own palette from textures or colors or remap the existing palette colors to a new palette"),
 				   core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatPointCloudSize, "1", core::CV_NOPERSIST,
@@ -104,6 +197,9 @@ bool FormatConfig::init() {
 				   core::Var::boolValidator);
 	core::Var::get(cfg::VoxFormatGLTF_KHR_materials_specular, "false", core::CV_NOPERSIST,
 				   _("Apply KHR_materials_specular when saving into the gltf format"), core::Var::boolValidator);
+	core::Var::get(cfg::VoxFormatGLTF_KHR_mesh_quantization, "false", core::CV_NOPERSIST,
+				   _("Store the vertex attributes as integers (KHR_mesh_quantization) when saving into the gltf format"),
+				   core::Var::boolValidator);
 	core::Var::get(cfg::VoxFormatWithMaterials, "true", core::CV_NOPERSIST,
 				   _("Try to export material properties if the formats support it"), core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatImageVolumeMaxDepth, "1", core::CV_NOPERSIST,
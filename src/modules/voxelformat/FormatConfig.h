@@ -4,11 +4,90 @@
 
 #pragma once
 
+#include "core/String.h"
+#include <stdint.h>
+
 namespace voxelformat {
 
-class FormatConfig {
-public:
+/**
+ * @brief The settings of the formats for a single load or save operation
+ *
+ * The formats don't query the cvars while they are running - they use the values of the @c LoadContext or
+ * @c SaveContext they were called with. This allows to run several conversions with different settings in parallel.
+ * The defaults match the defaults of the cvars that are registered in @c init().
+ *
+ * @sa fromVars()
+ */
+struct FormatConfig {
+	// general
+	bool merge = false;
+	bool createReferences = false;
+	bool saveVisibleOnly = false;
+	bool createPalette = true;
+	int emptyPaletteIndex = -1;
+	uint8_t rgbFlattenFactor = 0;
+	bool rgbWeightedAverage = true;
+
+	// mesh import
+	float scale = 1.0f;
+	float scaleX = 1.0f;
+	float scaleY = 1.0f;
+	float scaleZ = 1.0f;
+	bool fillHollow = true;
+	/** @sa MeshFormat::VoxelizeMode */
+	int voxelizeMode = 0;
+	core::String normalPalette = "built-in:redalert2";
+	core::String texturePath;
+	int pointCloudSize = 1;
+	/** @sa MeshFormat::voxelizeBuckets() */
+	int meshBucketSize = 256;
+
+	// mesh export
+	bool mergeQuads = true;
+	bool reuseVertices = true;
+	bool ambientOcclusion = false;
+	bool quads = true;
+	bool withColor = true;
+	bool withNormals = false;
+	bool colorAsFloat = true;
+	bool withTexCoords = true;
+	bool transform = true;
+	bool optimize = true;
+	/** relative error of the simplification of non cubic meshes - 0 disables it @sa voxel::Mesh::simplify() */
+	float simplifyError = 0.0f;
+	bool withMaterials = true;
+	/** @sa voxel::SurfaceExtractionType */
+	int meshMode = 0;
+	bool gltfKHRMaterialsPbrSpecularGlossiness = true;
+	bool gltfKHRMaterialsSpecular = false;
+	bool gltfKHRMeshQuantization = false;
+
+	// format specific
+	bool qbtPaletteMode = true;
+	bool qbtMergeCompounds = false;
+	bool qbSaveLeftHanded = true;
+	bool qbSaveCompressed = true;
+	bool voxCreateGroups = true;
+	bool voxCreateLayers = true;
+	int vengiCompressionLevel = 6;
+	/** keep the compressed voxels of the vengi format in memory and only decode them on first access */
+	bool vengiLazyLoad = false;
+
+	// image import
+	/** @sa PNGFormat::ImportType */
+	int imageImportType = 0;
+	int imageVolumeMaxDepth = 1;
+	bool imageVolumeBothSides = true;
+	int imageHeightmapMinHeight = 0;
+
+	/**
+	 * @brief Registers the cvars of the formats
+	 */
 	static bool init();
+	/**
+	 * @brief Snapshot of the current cvar values. The defaults are kept for cvars that are not registered.
+	 */
+	static FormatConfig fromVars();
 };
 
 } // namespace voxelformat
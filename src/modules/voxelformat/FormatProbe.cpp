@@ -0,0 +1,58 @@
+/**
+ * @file
+ */
+
+#include "FormatProbe.h"
+#include "scenegraph/SceneGraph.h"
+
+namespace voxelformat {
+
+int ProbeInfo::addNode(const core::String &name, scenegraph::SceneGraphNodeType type, int parent,
+					   const voxel::Region &region) {
+	ProbeNode node;
+	node.name = name;
+	node.type = type;
+	node.parent = parent;
+	node.region = region;
+	nodes.push_back(node);
+	return (int)nodes.size() - 1;
+}
+
+void ProbeInfo::setPalette(const palette::Palette &pal) {
+	palette = pal;
+	palette.markDirty();
+	paletteHash = palette.hash();
+}
+
+size_t ProbeInfo::models() const {
+	size_t n = 0u;
+	for (const ProbeNode &node : nodes) {
+		if (node.type == scenegraph::SceneGraphNodeType::Model) {
+			++n;
+		}
+	}
+	return n;
+}
+
+static void probeNode(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node, int parent,
+					  ProbeInfo &info) {
+	for (int childId : node.children()) {
+		const scenegraph::SceneGraphNode &child = sceneGraph.node(childId);
+		voxel::Region region = voxel::Region::InvalidRegion;
+		if (child.isModelNode()) {
+			region = child.region();
+		}
+		const int idx = info.addNode(child.name(), child.type(), parent, region);
+		probeNode(sceneGraph, child, idx, info);
+	}
+}
+
+void probeSceneGraph(const scenegraph::SceneGraph &sceneGraph, ProbeInfo &info) {
+	info.nodes.clear();
+	probeNode(sceneGraph, sceneGraph.root(), -1, info);
+	if (const scenegraph::SceneGraphNode *node = sceneGraph.firstModelNode()) {
+		info.setPalette(node->palette());
+	}
+}
+
+} // namespace voxelformat
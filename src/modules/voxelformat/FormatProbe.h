@@ -0,0 +1,60 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/collection/DynamicArray.h"
+#include "image/Image.h"
+#include "palette/Palette.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/Region.h"
+
+namespace scenegraph {
+class SceneGraph;
+}
+
+namespace voxelformat {
+
+/**
+ * @brief A node of the scene that is described by @c ProbeInfo
+ */
+struct ProbeNode {
+	core::String name;
+	scenegraph::SceneGraphNodeType type = scenegraph::SceneGraphNodeType::Model;
+	/** the index of the parent in @c ProbeInfo::nodes or @c -1 for the children of the root node */
+	int parent = -1;
+	/** the region of the volume of a model node - invalid for all other node types */
+	voxel::Region region = voxel::Region::InvalidRegion;
+};
+
+/**
+ * @brief A lightweight description of a file that is created without loading the voxels
+ *
+ * @sa Format::probe()
+ * @sa probeFormat()
+ */
+struct ProbeInfo {
+	/** the parents are always added before their children */
+	core::DynamicArray<ProbeNode> nodes;
+	/** the embedded palette - empty for formats that store rgba colors */
+	palette::Palette palette;
+	/** the @c palette::Palette::hash() of the embedded palette or @c 0 if there is none */
+	uint64_t paletteHash = 0u;
+	/** the embedded screenshot - only set for formats that support it */
+	image::ImagePtr thumbnail;
+
+	int addNode(const core::String &name, scenegraph::SceneGraphNodeType type, int parent,
+				const voxel::Region &region = voxel::Region::InvalidRegion);
+	void setPalette(const palette::Palette &pal);
+	size_t models() const;
+};
+
+/**
+ * @brief Fills the nodes and the palette of the given probe info from a loaded scene graph. This is the fallback for
+ * the formats that don't implement @c Format::probe() on their own.
+ */
+void probeSceneGraph(const scenegraph::SceneGraph &sceneGraph, ProbeInfo &info);
+
+} // namespace voxelformat
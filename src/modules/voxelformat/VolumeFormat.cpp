@@ -5,6 +5,7 @@
 #include "VolumeFormat.h"
 #include "app/App.h"
 #include "core/Log.h"
+#include "core/PerfStats.h"
 #include "core/ScopedPtr.h"
 #include "core/SharedPtr.h"
 #include "core/StringUtil.h"
@@ -281,6 +282,7 @@ image::ImagePtr loadScreenshot(const core::String &filename, const io::ArchivePt
 	}
 	const core::SharedPtr<Format> &f = getFormat(*desc, magic);
 	if (f) {
+		f->setConfig(ctx.config);
 		return f->loadScreenshot(filename, archive, ctx);
 	}
 	Log::error("Failed to load model screenshot from file %s - "
@@ -316,6 +318,7 @@ size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive,
 		return 0;
 	}
 	if (const core::SharedPtr<Format> &f = getFormat(*desc, magic)) {
+		f->setConfig(ctx.config);
 		const size_t n = f->loadPalette(filename, archive, palette, ctx);
 		palette.markDirty();
 		return n;
@@ -326,9 +329,35 @@ size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive,
 	return 0;
 }
 
+bool probeFormat(const io::FileDescription &fileDesc, const io::ArchivePtr &archive, ProbeInfo &info,
+				 const LoadContext &ctx) {
+	core_trace_scoped(ProbeVolumeFormat);
+	const uint32_t magic = loadMagic(fileDesc.name, archive);
+	const io::FormatDescription *desc = io::getDescription(fileDesc, magic, voxelLoad());
+	if (desc == nullptr) {
+		return false;
+	}
+	const core::String &filename = fileDesc.name;
+	const core::SharedPtr<Format> &f = getFormat(*desc, magic);
+	if (!f) {
+		Log::error("Failed to probe model file %s - unsupported file format", filename.c_str());
+		return false;
+	}
+	f->setConfig(ctx.config);
+	if (!f->probe(filename, archive, info, ctx)) {
+		Log::error("Error while probing %s", filename.c_str());
+		return false;
+	}
+	if (!info.thumbnail && (desc->flags & VOX_FORMAT_FLAG_SCREENSHOT_EMBEDDED)) {
+		info.thumbnail = f->loadScreenshot(filename, archive, ctx);
+	}
+	return true;
+}
+
 bool loadFormat(const io::FileDescription &fileDesc, const io::ArchivePtr &archive,
 				scenegraph::SceneGraph &newSceneGraph, const LoadContext &ctx) {
 	core_trace_scoped(LoadVolumeFormat);
+	core::ScopedPerfTimer timer(core::PerfStat::FormatLoad);
 	const uint32_t magic = loadMagic(fileDesc.name, archive);
 	const io::FormatDescription *desc = io::getDescription(fileDesc, magic, voxelLoad());
 	if (desc == nullptr) {
@@ -408,6 +437,7 @@ bool saveFormat(scenegraph::SceneGraph &sceneGraph, const core::String &filename
 		Log::error("Failed to save model file %s - no volumes given", filename.c_str());
 		return false;
 	}
+	core::ScopedPerfTimer timer(core::PerfStat::FormatSave);
 	const core::String &ext = core::string::extractExtension(filename);
 	if (desc) {
 		if (!desc->matchesExtension(ext)) {
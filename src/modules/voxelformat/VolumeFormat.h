@@ -6,6 +6,7 @@
 #pragma once
 
 #include "Format.h"
+#include "FormatProbe.h"
 #include "io/FormatDescription.h"
 #include "io/Stream.h"
 #include "scenegraph/SceneGraph.h"
@@ -31,6 +32,12 @@ bool importPalette(const core::String &filename, palette::Palette &palette);
 size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
 				   const LoadContext &ctx);
 image::ImagePtr loadScreenshot(const core::String &filename, const io::ArchivePtr &archive, const LoadContext &ctx);
+/**
+ * @brief Describes the scene of the given file without loading the voxels - see @c Format::probe()
+ * @note The embedded screenshot is loaded, too - if the format supports it
+ */
+bool probeFormat(const io::FileDescription &fileDesc, const io::ArchivePtr &archive, ProbeInfo &info,
+				 const LoadContext &ctx);
 bool loadFormat(const io::FileDescription &fileDesc, const io::ArchivePtr &archive, scenegraph::SceneGraph &sceneGraph,
 				const LoadContext &ctx);
 
@@ -0,0 +1,66 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/Log.h"
+#include "io/FilesystemArchive.h"
+#include "io/FormatDescription.h"
+#include "palette/Palette.h"
+#include "scenegraph/SceneGraph.h"
+#include "voxel/RawVolume.h"
+#include "voxelformat/Format.h"
+#include "voxelformat/FormatConfig.h"
+#include "voxelformat/VolumeFormat.h"
+
+namespace voxelformat {
+
+/**
+ * @brief Loads the datasets (the files of the unit tests) for the benchmarks
+ *
+ * The files must be given to the @c engine_add_benchmark() cmake function to get copied next to the benchmark binary.
+ */
+class AbstractFormatBenchmark : public app::AbstractBenchmark {
+protected:
+	bool onInitApp() override {
+		FormatConfig::init();
+		return true;
+	}
+
+	io::ArchivePtr datasetArchive() const {
+		return io::openFilesystemArchive(_benchmarkApp->filesystem());
+	}
+
+	bool loadDataset(const core::String &file, scenegraph::SceneGraph &sceneGraph) const {
+		io::FileDescription fileDesc;
+		fileDesc.set(file);
+		LoadContext ctx;
+		if (!loadFormat(fileDesc, datasetArchive(), sceneGraph, ctx)) {
+			Log::error("Failed to load dataset %s", file.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Loads the dataset and merges all models into one volume
+	 * @return The merged volume - the caller takes the ownership - or @c nullptr on error
+	 */
+	voxel::RawVolume *loadDatasetVolume(const core::String &file, palette::Palette &palette) const {
+		scenegraph::SceneGraph sceneGraph;
+		if (!loadDataset(file, sceneGraph)) {
+			return nullptr;
+		}
+		const scenegraph::SceneGraph::MergeResult &merged = sceneGraph.merge();
+		if (!merged.hasVolume()) {
+			Log::error("Dataset %s has no volume", file.c_str());
+			return nullptr;
+		}
+		palette = merged.palette;
+		return merged.volume();
+	}
+};
+
+} // namespace voxelformat
@@ -0,0 +1,190 @@
+/**
+ * @file
+ *
+ * Regression benchmarks for the format loaders and writers. The @c Load benchmark reads one representative file of
+ * the unit tests per format family. The @c SaveSynthetic and @c LoadSynthetic benchmarks write and read a synthetic
+ * terrain scene of several sizes for every format that supports saving - the loaded data is kept in a memory archive to
+ * not measure the disk.
+ *
+ * Each benchmark reports the file bytes per second, the allocations per iteration and the peak resident set size of
+ * the process. The peak is a process wide high water mark - run a single benchmark with
+ * @c --benchmark_filter to get the value of one format.
+ */
+
+#include "AbstractFormatBenchmark.h"
+#include "core/ScopedPtr.h"
+#include "io/Archive.h"
+#include "io/MemoryArchive.h"
+#include "io/Stream.h"
+#include "scenegraph/SceneGraphNode.h"
+#include <glm/gtc/noise.hpp>
+
+namespace {
+
+struct FileEntry {
+	const char *name;
+	const char *file;
+};
+
+// the additional files of the multi file formats (like the mtl file of the obj) are part of the corpus, too - see
+// BENCHMARK_FILES in the CMakeLists.txt
+static const FileEntry Files[] = {
+	{"qb", "chr_knight.qb"},
+	{"qbt", "qubicle.qbt"},
+	{"qbcl", "qubicle.qbcl"},
+	{"qef", "qubicle.qef"},
+	{"vox", "vox_character.vox"},
+	{"vxm", "test.vxm"},
+	{"vxb", "sandbox-block2.vxb"},
+	{"vengi", "bat_anim.vengi"},
+	{"gox", "chr_knight.gox"},
+	{"cub", "cw.cub"},
+	{"kv6", "test.kv6"},
+	{"kvx", "test.kvx"},
+	{"vxl", "aceofspades.vxl"},
+	{"binvox", "test.binvox"},
+	{"mca", "minecraft_113.mca"},
+	{"litematic", "test.litematic"},
+	{"vbx", "voxelbuilder.vbx"},
+	{"pcubes", "particubes.pcubes"},
+	{"csm", "chronovox-studio.csm"},
+	{"ben", "sora.ben"},
+	{"gltf", "rgb.gltf"},
+	{"obj", "cube.obj"},
+	{"stl", "ascii.stl"},
+	{"ply", "ascii.ply"},
+	{"fbx", "chr_knight.fbx"},
+	{"md2", "fuel_can.md2"},
+};
+static constexpr int FilesSize = (int)(sizeof(Files) / sizeof(Files[0]));
+
+static int saveFormats() {
+	int n = 0;
+	for (const io::FormatDescription *desc = voxelformat::voxelSave(); desc->valid(); ++desc) {
+		++n;
+	}
+	return n;
+}
+
+} // namespace
+
+class FormatBenchmark : public voxelformat::AbstractFormatBenchmark {
+protected:
+	scenegraph::SceneGraph _sceneGraph;
+
+	void createTerrain(int size) {
+		const int height = size / 4;
+		voxel::RawVolume *volume = new voxel::RawVolume(voxel::Region(0, 0, 0, size - 1, height - 1, size - 1));
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				const float n = glm::simplex(glm::vec2(x, z) * 0.02f) * 0.5f + 0.5f;
+				const int columnHeight = glm::clamp((int)(n * (float)height), 1, height);
+				for (int y = 0; y < columnHeight; ++y) {
+					const uint8_t color = 1 + (uint8_t)((y * 7 + columnHeight) % 16);
+					volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+				}
+			}
+		}
+		palette::Palette palette;
+		palette.nippon();
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(volume, true);
+		node.setName("terrain");
+		node.setPalette(palette);
+		_sceneGraph.emplace(core::move(node));
+	}
+
+	static core::String syntheticFilename(const io::FormatDescription &desc) {
+		return "synthetic." + desc.mainExtension();
+	}
+
+	static int64_t fileSize(const io::ArchivePtr &archive, const core::String &filename) {
+		core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
+		if (!stream) {
+			return -1;
+		}
+		return stream->size();
+	}
+
+	void addCounters(benchmark::State &state, int64_t bytes) {
+		addBytesCounter(state, bytes);
+		addMemoryCounters(state);
+	}
+
+	void runLoad(benchmark::State &state, const core::String &filename, const io::ArchivePtr &archive) {
+		const int64_t bytes = fileSize(archive, filename);
+		if (bytes < 0) {
+			state.SkipWithError("Failed to open the file");
+			return;
+		}
+		io::FileDescription fileDesc;
+		fileDesc.set(filename);
+		resetAllocations();
+		for (auto _ : state) {
+			scenegraph::SceneGraph sceneGraph;
+			voxelformat::LoadContext ctx;
+			if (!voxelformat::loadFormat(fileDesc, archive, sceneGraph, ctx)) {
+				state.SkipWithError("Failed to load the file");
+				return;
+			}
+			benchmark::DoNotOptimize(sceneGraph.size());
+		}
+		addCounters(state, bytes);
+	}
+
+public:
+	void TearDown(::benchmark::State &state) override {
+		_sceneGraph.clear();
+		voxelformat::AbstractFormatBenchmark::TearDown(state);
+	}
+};
+
+BENCHMARK_DEFINE_F(FormatBenchmark, Load)(benchmark::State &state) {
+	const FileEntry &entry = Files[state.range(0)];
+	state.SetLabel(entry.name);
+	runLoad(state, entry.file, datasetArchive());
+}
+
+BENCHMARK_DEFINE_F(FormatBenchmark, SaveSynthetic)(benchmark::State &state) {
+	const io::FormatDescription &desc = voxelformat::voxelSave()[state.range(0)];
+	state.SetLabel(desc.name.c_str());
+	createTerrain((int)state.range(1));
+	const core::String &filename = syntheticFilename(desc);
+	int64_t bytes = 0;
+	resetAllocations();
+	for (auto _ : state) {
+		const io::ArchivePtr &archive = io::openMemoryArchive();
+		voxelformat::SaveContext ctx;
+		if (!voxelformat::saveFormat(_sceneGraph, filename, &desc, archive, ctx)) {
+			state.SkipWithError("Failed to save the scene");
+			return;
+		}
+		bytes = fileSize(archive, filename);
+	}
+	addCounters(state, bytes);
+}
+
+BENCHMARK_DEFINE_F(FormatBenchmark, LoadSynthetic)(benchmark::State &state) {
+	const io::FormatDescription &desc = voxelformat::voxelSave()[state.range(0)];
+	state.SetLabel(desc.name.c_str());
+	createTerrain((int)state.range(1));
+	const core::String &filename = syntheticFilename(desc);
+	const io::ArchivePtr &archive = io::openMemoryArchive();
+	voxelformat::SaveContext ctx;
+	if (!voxelformat::saveFormat(_sceneGraph, filename, &desc, archive, ctx)) {
+		state.SkipWithError("Failed to save the scene");
+		return;
+	}
+	_sceneGraph.clear();
+	runLoad(state, filename, archive);
+}
+
+BENCHMARK_REGISTER_F(FormatBenchmark, Load)->ArgName("file")->DenseRange(0, FilesSize - 1, 1);
+BENCHMARK_REGISTER_F(FormatBenchmark, SaveSynthetic)
+	->ArgNames({"format", "size"})
+	->ArgsProduct({benchmark::CreateDenseRange(0, saveFormats() - 1, 1), {64, 256}});
+BENCHMARK_REGISTER_F(FormatBenchmark, LoadSynthetic)
+	->ArgNames({"format", "size"})
+	->ArgsProduct({benchmark::CreateDenseRange(0, saveFormats() - 1, 1), {64, 256}});
+
+// BENCHMARK_MAIN() is in MeshExtractionBenchmark.cpp
@@ -0,0 +1,145 @@
+/**
+ * @file
+ *
+ * Regression benchmarks for the surface extractors. The corpus contains some of the models of the unit tests and
+ * synthetic volumes of several sizes. Each benchmark reports the extracted voxels and triangles per second and the
+ * allocations per extraction.
+ */
+
+#include "AbstractFormatBenchmark.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/SurfaceExtractor.h"
+#include <glm/gtc/noise.hpp>
+
+namespace {
+
+enum class CorpusType { File, Noise, Terrain };
+
+struct CorpusEntry {
+	const char *name;
+	CorpusType type;
+	// only used for CorpusType::File
+	const char *file;
+	// the edge length of the synthetic volumes
+	int size;
+};
+
+static const CorpusEntry Corpus[] = {
+	{"chr_knight", CorpusType::File, "chr_knight.qb", 0},
+	{"robo", CorpusType::File, "robo.qb", 0},
+	{"8ontop", CorpusType::File, "8ontop.vox", 0},
+	{"vox_character", CorpusType::File, "vox_character.vox", 0},
+	{"noise32", CorpusType::Noise, nullptr, 32},
+	{"noise64", CorpusType::Noise, nullptr, 64},
+	{"noise128", CorpusType::Noise, nullptr, 128},
+	{"terrain64", CorpusType::Terrain, nullptr, 64},
+	{"terrain128", CorpusType::Terrain, nullptr, 128},
+	{"terrain256", CorpusType::Terrain, nullptr, 256},
+};
+static constexpr int CorpusSize = (int)(sizeof(Corpus) / sizeof(Corpus[0]));
+
+} // namespace
+
+class MeshExtractionBenchmark : public voxelformat::AbstractFormatBenchmark {
+protected:
+	voxel::RawVolume *_volume = nullptr;
+	palette::Palette _palette;
+
+	void createNoise(int size) {
+		_volume = new voxel::RawVolume(voxel::Region(0, 0, 0, size - 1, size - 1, size - 1));
+		for (int z = 0; z < size; ++z) {
+			for (int y = 0; y < size; ++y) {
+				for (int x = 0; x < size; ++x) {
+					const float n = glm::simplex(glm::vec3(x, y, z) * 0.08f);
+					if (n > 0.2f) {
+						const uint8_t color = 1 + (uint8_t)((x / 4 + y / 4 + z / 4) % 8);
+						_volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+					}
+				}
+			}
+		}
+	}
+
+	void createTerrain(int size) {
+		const int height = size / 4;
+		_volume = new voxel::RawVolume(voxel::Region(0, 0, 0, size - 1, height - 1, size - 1));
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				const float n = glm::simplex(glm::vec2(x, z) * 0.02f) * 0.5f + 0.5f;
+				const int columnHeight = glm::clamp((int)(n * (float)height), 1, height);
+				for (int y = 0; y < columnHeight; ++y) {
+					const uint8_t color = y + 3 < columnHeight ? 1 : 2;
+					_volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+				}
+			}
+		}
+	}
+
+	static uint64_t triangles(const voxel::ChunkMesh &mesh) {
+		uint64_t indices = 0;
+		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+			indices += mesh.mesh[i].getNoOfIndices();
+		}
+		return indices / 3;
+	}
+
+	void run(benchmark::State &state, voxel::SurfaceExtractionType type, bool mergeQuads, bool ambientOcclusion) {
+		if (_volume == nullptr) {
+			state.SkipWithError("Failed to create the volume of the corpus entry");
+			return;
+		}
+		const voxel::Region &region = _volume->region();
+		uint64_t tris = 0;
+		resetAllocations();
+		for (auto _ : state) {
+			voxel::ChunkMesh mesh;
+			voxel::SurfaceExtractionContext ctx = voxel::createContext(type, _volume, region, _palette, mesh,
+																	   region.getLowerCorner(), mergeQuads, true,
+																	   ambientOcclusion);
+			voxel::extractSurface(ctx);
+			tris = triangles(mesh);
+			benchmark::DoNotOptimize(mesh);
+		}
+		state.SetLabel(Corpus[state.range(0)].name);
+		addVoxelCounter(state, region.voxels());
+		state.counters["triangles/s"] = benchmark::Counter((double)tris, benchmark::Counter::kIsIterationInvariantRate);
+		addMemoryCounters(state);
+	}
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		voxelformat::AbstractFormatBenchmark::SetUp(state);
+		_palette.nippon();
+		const CorpusEntry &entry = Corpus[state.range(0)];
+		if (entry.type == CorpusType::File) {
+			_volume = loadDatasetVolume(entry.file, _palette);
+		} else if (entry.type == CorpusType::Noise) {
+			createNoise(entry.size);
+		} else {
+			createTerrain(entry.size);
+		}
+	}
+
+	void TearDown(::benchmark::State &state) override {
+		delete _volume;
+		_volume = nullptr;
+		voxelformat::AbstractFormatBenchmark::TearDown(state);
+	}
+};
+
+BENCHMARK_DEFINE_F(MeshExtractionBenchmark, Cubic)(benchmark::State &state) {
+	run(state, voxel::SurfaceExtractionType::Cubic, state.range(1) != 0, state.range(2) != 0);
+}
+
+BENCHMARK_DEFINE_F(MeshExtractionBenchmark, MarchingCubes)(benchmark::State &state) {
+	run(state, voxel::SurfaceExtractionType::MarchingCubes, false, false);
+}
+
+BENCHMARK_REGISTER_F(MeshExtractionBenchmark, Cubic)
+	->ArgNames({"corpus", "merge", "ao"})
+	->ArgsProduct({benchmark::CreateDenseRange(0, CorpusSize - 1, 1), {0, 1}, {0, 1}});
+BENCHMARK_REGISTER_F(MeshExtractionBenchmark, MarchingCubes)
+	->ArgName("corpus")
+	->DenseRange(0, CorpusSize - 1, 1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+/**
+ * @file
+ *
+ * Benchmarks the voxelization of large meshes - like the meshes of photogrammetry scans. The mesh is a uv sphere with
+ * the given amount of slices and stacks.
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/Color.h"
+#include "scenegraph/SceneGraph.h"
+#include "voxelformat/FormatConfig.h"
+#include "voxelformat/private/mesh/MeshFormat.h"
+#include <glm/ext/scalar_constants.hpp>
+#include <glm/trigonometric.hpp>
+
+namespace {
+
+class BenchmarkMeshFormat : public voxelformat::MeshFormat {
+public:
+	bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &, const core::String &,
+					const io::ArchivePtr &, const glm::vec3 &, bool, bool, bool) override {
+		return false;
+	}
+
+	int voxelize(scenegraph::SceneGraph &sceneGraph, const MeshTriCollection &tris) const {
+		return voxelizeNode("sphere", sceneGraph, tris);
+	}
+};
+
+static glm::vec3 spherePos(int slice, int stack, int slices, int stacks, float radius) {
+	const float theta = (float)stack / (float)stacks * glm::pi<float>();
+	const float phi = (float)slice / (float)slices * glm::two_pi<float>();
+	return glm::vec3(glm::sin(theta) * glm::cos(phi), glm::cos(theta), glm::sin(theta) * glm::sin(phi)) * radius;
+}
+
+} // namespace
+
+class VoxelizeBenchmark : public app::AbstractBenchmark {
+protected:
+	voxelformat::MeshFormat::MeshTriCollection _tris;
+
+	void createSphere(int segments, float radius) {
+		_tris.clear();
+		_tris.reserve((size_t)segments * segments * 2);
+		for (int stack = 0; stack < segments; ++stack) {
+			for (int slice = 0; slice < segments; ++slice) {
+				const glm::vec3 p00 = spherePos(slice, stack, segments, segments, radius);
+				const glm::vec3 p10 = spherePos(slice + 1, stack, segments, segments, radius);
+				const glm::vec3 p01 = spherePos(slice, stack + 1, segments, segments, radius);
+				const glm::vec3 p11 = spherePos(slice + 1, stack + 1, segments, segments, radius);
+				const core::RGBA color((uint8_t)(slice * 255 / segments), (uint8_t)(stack * 255 / segments), 128, 255);
+				voxelformat::MeshTri tri;
+				tri.color[0] = tri.color[1] = tri.color[2] = color;
+				tri.vertices[0] = p00;
+				tri.vertices[1] = p01;
+				tri.vertices[2] = p10;
+				_tris.push_back(tri);
+				tri.vertices[0] = p10;
+				tri.vertices[1] = p01;
+				tri.vertices[2] = p11;
+				_tris.push_back(tri);
+			}
+		}
+	}
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		voxelformat::FormatConfig::init();
+		createSphere((int)state.range(0), (float)state.range(1));
+	}
+
+	void TearDown(::benchmark::State &state) override {
+		_tris.release();
+		app::AbstractBenchmark::TearDown(state);
+	}
+};
+
+BENCHMARK_DEFINE_F(VoxelizeBenchmark, Sphere)(benchmark::State &state) {
+	const BenchmarkMeshFormat format;
+	for (auto _ : state) {
+		scenegraph::SceneGraph sceneGraph;
+		int nodeId = format.voxelize(sceneGraph, _tris);
+		benchmark::DoNotOptimize(nodeId);
+	}
+	state.counters["triangles/s"] =
+		benchmark::Counter((double)_tris.size(), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK_REGISTER_F(VoxelizeBenchmark, Sphere)
+	->ArgNames({"segments", "radius"})
+	->ArgsProduct({{64, 256, 720}, {32, 128}})
+	->Unit(benchmark::kMillisecond);
+
+// BENCHMARK_MAIN() is in MeshExtractionBenchmark.cpp
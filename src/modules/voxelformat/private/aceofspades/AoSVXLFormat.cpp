@@ -3,14 +3,18 @@
  */
 
 #include "AoSVXLFormat.h"
+#include "app/App.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Parallel.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "palette/Palette.h"
 #include "palette/PaletteLookup.h"
 #include "voxel/RawVolume.h"
+#include "voxel/RawVolumeColumnWriter.h"
 #include "voxelutil/VolumeVisitor.h"
 #define libvxl_assert core_assert_msg
 #define libvxl_mem_malloc core_malloc
@@ -53,6 +57,97 @@ static inline uint8_t vxl_red(uint32_t c) {
 	return (c >> 16) & 0xFF;
 }
 
+namespace priv {
+
+// the color of the solid voxels below the surface that don't have a color in the file
+static const uint32_t vxlSolidColor = DEFAULT_COLOR(0, 0, 0);
+
+// the span data is stored in little endian byte order - b, g, r, a
+static inline uint32_t vxlColor(const uint8_t *data) {
+	return ((uint32_t)data[2] << 16) | ((uint32_t)data[1] << 8) | (uint32_t)data[0];
+}
+
+static inline int vxlTopColors(const libvxl_span &span) {
+	return span.color_end >= span.color_start ? span.color_end - span.color_start + 1 : 0;
+}
+
+/**
+ * @brief Collects the offsets of the span lists of the columns - the columns are stored row by row
+ * @return @c false if the spans exceed the data or are invalid
+ */
+static bool vxlColumnOffsets(const uint8_t *data, size_t size, int columns, core::DynamicArray<size_t> &offsets) {
+	offsets.reserve(columns);
+	size_t offset = 0;
+	for (int i = 0; i < columns; ++i) {
+		offsets.push_back(offset);
+		int bottomColors = 0;
+		for (;;) {
+			if (offset + sizeof(libvxl_span) > size) {
+				return false;
+			}
+			libvxl_span span;
+			core_memcpy(&span, data + offset, sizeof(span));
+			if (span.air_start < bottomColors) {
+				return false;
+			}
+			const int topColors = vxlTopColors(span);
+			if (span.length == 0) {
+				if (span.color_end + 1 < span.color_start) {
+					return false;
+				}
+				offset += (topColors + 1) * 4;
+				if (offset > size) {
+					return false;
+				}
+				break;
+			}
+			if (topColors + 1 > span.length) {
+				return false;
+			}
+			bottomColors = span.length - 1 - topColors;
+			offset += span.length * 4;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Decodes the spans of a column into the colors and the solid state of each voxel from the top (z = 0) to
+ * the bottom - in the same way as libvxl does it
+ * @note The spans must have been validated by @c vxlColumnOffsets()
+ */
+static void vxlDecodeColumn(const uint8_t *data, size_t offset, int mapHeight, uint32_t *colors, bool *solid) {
+	for (int z = 0; z < mapHeight; ++z) {
+		colors[z] = vxlSolidColor;
+		solid[z] = true;
+	}
+	for (;;) {
+		libvxl_span span;
+		core_memcpy(&span, data + offset, sizeof(span));
+		const uint8_t *colorData = data + offset + sizeof(span);
+		for (int z = span.air_start; z < span.color_start && z < mapHeight; ++z) {
+			solid[z] = false;
+		}
+		for (int z = span.color_start; z <= span.color_end && z < mapHeight; ++z) {
+			colors[z] = vxlColor(colorData + (z - span.color_start) * 4);
+		}
+		if (span.length == 0) {
+			break;
+		}
+		const int topColors = vxlTopColors(span);
+		const int bottomColors = span.length - 1 - topColors;
+		offset += span.length * 4;
+		libvxl_span next;
+		core_memcpy(&next, data + offset, sizeof(next));
+		const int bottomStart = next.air_start - bottomColors;
+		for (int z = bottomStart; z < next.air_start && z < mapHeight; ++z) {
+			colors[z] = vxlColor(colorData + (topColors + z - bottomStart) * 4);
+		}
+	}
+}
+
+} // namespace priv
+
 bool AoSVXLFormat::loadGroupsRGBA(const core::String &filename, const io::ArchivePtr &archive,
 								  scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette,
 								  const LoadContext &ctx) {
@@ -76,36 +171,58 @@ bool AoSVXLFormat::loadGroupsRGBA(const core::String &filename, const io::Archiv
 		return false;
 	}
 
-	struct libvxl_map map;
-
-	if (!libvxl_create(&map, mapSize, mapSize, mapHeight, data, size)) {
-		Log::error("Failed to create libvxl map");
+	Log::debug("Read vxl of size %i:%i:%i", (int)mapSize, (int)mapHeight, (int)mapSize);
+	if (mapSize == 0 || mapHeight == 0 || mapHeight > 256) {
+		Log::error("Invalid vxl size %i:%i", (int)mapSize, (int)mapHeight);
 		core_free(data);
 		return false;
 	}
 
-	Log::debug("Read vxl of size %i:%i:%i", (int)mapSize, (int)mapHeight, (int)mapSize);
+	// the span lists of the columns have different lengths - find them first to decode the columns in parallel
+	core::DynamicArray<size_t> offsets;
+	if (!priv::vxlColumnOffsets(data, size, (int)(mapSize * mapSize), offsets)) {
+		Log::error("Invalid vxl column data");
+		core_free(data);
+		return false;
+	}
 
 	const voxel::Region region(0, 0, 0, (int)mapSize - 1, (int)mapHeight - 1, (int)mapSize - 1);
 	voxel::RawVolume *volume = new voxel::RawVolume(region);
 	scenegraph::SceneGraphNode node;
 	node.setVolume(volume, true);
 	palette::PaletteLookup palLookup(palette);
-
-	for (int x = 0; x < (int)mapSize; x++) {
-		for (int y = 0; y < (int)mapSize; y++) {
-			for (int z = 0; z < (int)mapHeight; z++) {
-				if (!libvxl_map_issolid(&map, x, y, z)) {
-					continue;
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	// the lookup is thread safe with the color cube
+	palLookup.useColorCube(&threadPool);
+	const int height = (int)mapHeight;
+	{
+		voxel::RawVolumeColumnWriter writer(*volume);
+		core::parallelFor(&threadPool, 0, (int)mapSize, [&](int from, int to) {
+			uint32_t colors[256];
+			bool solid[256];
+			for (int y = from; y < to; ++y) {
+				for (int x = 0; x < (int)mapSize; ++x) {
+					priv::vxlDecodeColumn(data, offsets[x + y * mapSize], height, colors, solid);
+					// write runs of the same voxel - most of the column is the solid ground below the surface
+					for (int z = 0; z < height;) {
+						if (!solid[z]) {
+							++z;
+							continue;
+						}
+						const uint32_t color = colors[z];
+						int end = z + 1;
+						while (end < height && solid[end] && colors[end] == color) {
+							++end;
+						}
+						const core::RGBA rgba(vxl_red(color), vxl_green(color), vxl_blue(color));
+						const voxel::Voxel voxel = voxel::createVoxel(palette, palLookup.findClosestIndex(rgba));
+						writer.fill(x, y, height - end, height - 1 - z, voxel);
+						z = end;
+					}
 				}
-				const uint32_t color = libvxl_map_get(&map, x, y, z);
-				const core::RGBA rgba = core::RGBA(vxl_red(color), vxl_green(color), vxl_blue(color));
-				const uint8_t paletteIndex = palLookup.findClosestIndex(rgba);
-				volume->setVoxel(x, (int)mapHeight - 1 - z, y, voxel::createVoxel(palette, paletteIndex));
 			}
-		}
+		});
 	}
-	libvxl_free(&map);
 	core_free(data);
 
 	node.setName(core::string::extractFilename(filename));
@@ -137,29 +254,33 @@ size_t AoSVXLFormat::loadPalette(const core::String &filename, const io::Archive
 	}
 
 	Log::debug("Read vxl of size %i:%i:%i", (int)mapSize, (int)mapHeight, (int)mapSize);
+	if (mapSize == 0 || mapHeight == 0 || mapHeight > 256) {
+		Log::error("Invalid vxl size %i:%i", (int)mapSize, (int)mapHeight);
+		core_free(data);
+		return 0;
+	}
 
-	struct libvxl_map map;
-
-	if (!libvxl_create(&map, mapSize, mapSize, mapHeight, data, size)) {
-		Log::error("Failed to create libvxl map");
+	core::DynamicArray<size_t> offsets;
+	if (!priv::vxlColumnOffsets(data, size, (int)(mapSize * mapSize), offsets)) {
+		Log::error("Invalid vxl column data");
 		core_free(data);
 		return 0;
 	}
 
 	RGBAMap colors;
-	for (int x = 0; x < (int)mapSize; x++) {
-		for (int y = 0; y < (int)mapSize; y++) {
-			for (int z = 0; z < (int)mapHeight; z++) {
-				if (!libvxl_map_issolid(&map, x, y, z)) {
-					continue;
-				}
-				const uint32_t color = libvxl_map_get(&map, x, y, z);
-				const core::RGBA rgba = flattenRGB(vxl_red(color), vxl_green(color), vxl_blue(color));
-				colors.put(rgba, true);
+	uint32_t columnColors[256];
+	bool solid[256];
+	for (size_t offset : offsets) {
+		priv::vxlDecodeColumn(data, offset, (int)mapHeight, columnColors, solid);
+		for (int z = 0; z < (int)mapHeight; ++z) {
+			if (!solid[z]) {
+				continue;
 			}
+			const uint32_t color = columnColors[z];
+			const core::RGBA rgba = flattenRGB(vxl_red(color), vxl_green(color), vxl_blue(color));
+			colors.put(rgba, true);
 		}
 	}
-	libvxl_free(&map);
 	core_free(data);
 
 	return createPalette(colors, palette);
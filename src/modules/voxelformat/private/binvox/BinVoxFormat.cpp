@@ -8,6 +8,7 @@
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "io/Archive.h"
+#include "io/BufferedReadStream.h"
 #include "io/Stream.h"
 #include "scenegraph/SceneGraph.h"
 #include "palette/Palette.h"
@@ -26,7 +27,7 @@ namespace voxelformat {
 		return false;                                                                                                  \
 	}
 
-bool BinVoxFormat::readData(State &state, const core::String &filename, io::SeekableReadStream &stream,
+bool BinVoxFormat::readData(State &state, const core::String &filename, io::BufferedReadStream &stream,
 							scenegraph::SceneGraph &sceneGraph) {
 	const voxel::Region region(0, 0, 0, (int)state._d - 1, (int)state._w - 1, (int)state._h - 1);
 	if (!region.isValid()) {
@@ -74,11 +75,13 @@ bool BinVoxFormat::loadGroups(const core::String &filename, const io::ArchivePtr
 							  scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) {
 	char line[512];
 
-	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
-	if (!stream) {
+	core::ScopedPtr<io::SeekableReadStream> fileStream(archive->readStream(filename));
+	if (!fileStream) {
 		Log::error("Failed to open stream for file: %s", filename.c_str());
 		return false;
 	}
+	io::BufferedReadStream bufferedStream(*fileStream);
+	io::BufferedReadStream *stream = &bufferedStream;
 
 	wrapBool(stream->readLine(sizeof(line), line))
 	if (0 != strcmp(line, "#binvox 1")) {
@@ -6,6 +6,10 @@
 
 #include "voxelformat/Format.h"
 
+namespace io {
+class BufferedReadStream;
+}
+
 namespace voxelformat {
 
 /**
@@ -29,7 +33,7 @@ private:
 		float _scale = 0.0f;
 	};
 
-	bool readData(State &state, const core::String &filename, io::SeekableReadStream &stream,
+	bool readData(State &state, const core::String &filename, io::BufferedReadStream &stream,
 				  scenegraph::SceneGraph &sceneGraph);
 
 protected:
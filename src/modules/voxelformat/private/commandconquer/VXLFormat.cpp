@@ -3,6 +3,7 @@
  */
 
 #include "VXLFormat.h"
+#include "core/Allocator.h"
 #include "core/Assert.h"
 #include "core/Common.h"
 #include "core/Log.h"
@@ -386,8 +387,9 @@ bool VXLFormat::readLayer(io::SeekableReadStream &stream, vxl::VXLModel &mdl, ui
 	const vxl::VXLLayerHeader &header = mdl.layerHeaders[nodeIdx];
 
 	const uint32_t baseSize = footer.xsize * footer.ysize;
-	core::Buffer<int32_t> colStart(baseSize);
-	core::Buffer<int32_t> colEnd(baseSize);
+	core::FrameAllocatorScope frameAllocatorScope;
+	core::Buffer<int32_t, 32u, core::FrameAllocator> colStart(baseSize);
+	core::Buffer<int32_t, 32u, core::FrameAllocator> colEnd(baseSize);
 
 	Log::debug("Read layer body at %u", (int)nodeStart);
 
@@ -18,6 +18,7 @@
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
+#include "voxelformat/FormatProbe.h"
 #include "voxelutil/VolumeCropper.h"
 #include "voxelutil/VolumeMerger.h"
 #include "voxelutil/VolumeRotator.h"
@@ -334,8 +335,8 @@ bool GoxFormat::loadChunk_LAYR(State &state, const GoxChunk &c, io::SeekableRead
 		}
 	}
 
-	voxel::RawVolume *mirrored = voxelutil::mirrorAxis(modelVolume, math::Axis::X);
-	voxel::RawVolume *cropped = voxelutil::cropVolume(mirrored);
+	voxelutil::mirrorAxis(*modelVolume, math::Axis::X);
+	voxel::RawVolume *cropped = voxelutil::cropVolume(modelVolume);
 	const glm::ivec3 mins = cropped->region().getLowerCorner();
 	cropped->translate(-mins);
 
@@ -347,7 +348,45 @@ bool GoxFormat::loadChunk_LAYR(State &state, const GoxChunk &c, io::SeekableRead
 	node.setPalette(palLookup.palette());
 	sceneGraph.emplace(core::move(node));
 	delete modelVolume;
-	delete mirrored;
+	return true;
+}
+
+bool GoxFormat::probeChunk_LAYR(State &state, const GoxChunk &c, io::SeekableReadStream &stream, int blocks,
+								ProbeInfo &info) {
+	uint32_t blockCount;
+	wrap(stream.readUInt32(blockCount))
+	// see loadChunk_LAYR() - the blocks are merged into a volume of this size before the volume is cropped
+	voxel::Region region(0, 0, 0, 1, 1, 1);
+	for (uint32_t i = 0; i < blockCount; ++i) {
+		uint32_t index;
+		wrap(stream.readUInt32(index))
+		if (index >= (uint32_t)blocks) {
+			Log::error("Index out of bounds: %u", index);
+			return false;
+		}
+		int32_t x, y, z;
+		wrap(stream.readInt32(x))
+		wrap(stream.readInt32(y))
+		wrap(stream.readInt32(z))
+		if (state.version == 1) {
+			x -= 8;
+			y -= 8;
+			z -= 8;
+		}
+		wrapBool(stream.skip(4) != -1)
+		region.accumulate(voxel::Region(x, z, y, x + (BlockSize - 1), z + (BlockSize - 1), y + (BlockSize - 1)));
+	}
+	core::String name = core::string::format("model %i", (int)info.nodes.size() + 1);
+	char dictKey[256];
+	char dictValue[256];
+	int valueLength = 0;
+	while (loadChunk_DictEntry(c, stream, dictKey, dictValue, valueLength)) {
+		if (!strcmp(dictKey, "name")) {
+			name = dictValue;
+		}
+	}
+	info.addNode(name, scenegraph::SceneGraphNodeType::Model, -1,
+				 voxel::Region(glm::ivec3(0), region.getDimensionsInVoxels() - 1));
 	return true;
 }
 
@@ -572,6 +611,51 @@ size_t GoxFormat::loadPalette(const core::String &filename, const io::ArchivePtr
 	return createPalette(colors, palette);
 }
 
+bool GoxFormat::probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+					  const LoadContext &ctx) {
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
+	if (!stream) {
+		Log::error("Could not open file %s", filename.c_str());
+		return false;
+	}
+	uint32_t magic;
+	wrap(stream->readUInt32(magic))
+
+	if (magic != FourCC('G', 'O', 'X', ' ')) {
+		Log::error("Invalid magic");
+		return false;
+	}
+
+	State state;
+	wrap(stream->readInt32(state.version))
+
+	if (state.version > 2) {
+		Log::error("Unknown gox format version found: %u", state.version);
+		return false;
+	}
+
+	int blocks = 0;
+	GoxChunk c;
+	while (loadChunk_Header(c, *stream)) {
+		if (c.type == FourCC('B', 'L', '1', '6')) {
+			++blocks;
+			stream->seek(c.length, SEEK_CUR);
+		} else if (c.type == FourCC('L', 'A', 'Y', 'R')) {
+			wrapBool(probeChunk_LAYR(state, c, *stream, blocks, info))
+		} else if (c.type == FourCC('P', 'R', 'E', 'V')) {
+			image::ImagePtr img = image::createEmptyImage(core::string::extractFilename(filename) + ".png");
+			if (img->load(*stream, c.length)) {
+				info.thumbnail = img;
+			}
+			stream->seek(c.streamStartPos + c.length);
+		} else {
+			stream->seek(c.length, SEEK_CUR);
+		}
+		loadChunk_ValidateCRC(*stream);
+	}
+	return !info.nodes.empty();
+}
+
 bool GoxFormat::loadGroupsRGBA(const core::String &filename, const io::ArchivePtr &archive,
 							   scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette,
 							   const LoadContext &ctx) {
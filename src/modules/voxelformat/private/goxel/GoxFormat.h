@@ -94,6 +94,12 @@ private:
 	bool loadChunk_LAYR(State &state, const GoxChunk &c, io::SeekableReadStream &stream,
 						scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette);
 	bool loadChunk_BL16(State &state, const GoxChunk &c, io::SeekableReadStream &stream);
+	/**
+	 * @brief Reads the name and the bounding box of the blocks of a layer - the blocks are not decoded
+	 * @param[in] blocks The amount of BL16 chunks that were found so far
+	 */
+	bool probeChunk_LAYR(State &state, const GoxChunk &c, io::SeekableReadStream &stream, int blocks,
+						 ProbeInfo &info);
 	bool loadChunk_MATE(State &state, const GoxChunk &c, io::SeekableReadStream &stream,
 						scenegraph::SceneGraph &sceneGraph);
 	bool loadChunk_CAMR(State &state, const GoxChunk &c, io::SeekableReadStream &stream,
@@ -133,6 +139,12 @@ private:
 					const io::ArchivePtr &archive, const SaveContext &ctx) override;
 
 public:
+	/**
+	 * @note The regions of the models are the bounding boxes of their blocks - the loaded volumes might be smaller
+	 * because the empty voxels are cropped
+	 */
+	bool probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+			   const LoadContext &ctx) override;
 	size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
 					   const LoadContext &ctx) override;
 	image::ImagePtr loadScreenshot(const core::String &filename, const io::ArchivePtr &archive,
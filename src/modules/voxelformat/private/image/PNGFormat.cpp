@@ -3,16 +3,19 @@
  */
 
 #include "PNGFormat.h"
-#include "core/ConfigVar.h"
+#include "app/App.h"
+#include "core/Common.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
-#include "core/Var.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Parallel.h"
 #include "image/Image.h"
 #include "io/Archive.h"
 #include "io/FilesystemEntry.h"
 #include "io/Stream.h"
 #include "palette/Palette.h"
+#include "palette/PaletteColorCube.h"
 #include "palette/PaletteLookup.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
@@ -24,6 +27,8 @@ namespace voxelformat {
 
 #define MaxHeightmapWidth 4096
 #define MaxHeightmapHeight 4096
+// the amount of slice pixels from which on the colors are matched with a palette::PaletteColorCube
+#define ColorCubeMinPixels (256 * 256)
 
 static int extractLayerFromFilename(const core::String &filename) {
 	core::String name = core::string::extractFilename(filename);
@@ -65,30 +70,51 @@ bool PNGFormat::importSlices(scenegraph::SceneGraph &sceneGraph, const palette::
 	node.setName(core::string::extractFilename(filename));
 	node.setPalette(palette);
 
-	for (const auto &entity : entities) {
-		const core::String &layetFilename = entity.fullPath;
-		const image::ImagePtr &image = image::loadImage(layetFilename);
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	// building the rgb cube only pays off if there are a lot of pixels to match
+	palette::PaletteColorCubePtr cube;
+	if ((int64_t)imageWidth * imageHeight * (int64_t)entities.size() > ColorCubeMinPixels) {
+		cube = palette::PaletteColorCube::get(palette, &threadPool);
+	}
+	// every slice is decoded, matched against the palette and freed by one task - only as many images as there are
+	// threads are kept in memory. The slices write to their own z-slab of the voxel data.
+	voxel::Voxel *voxels = volume->writableRow(region.getLowerCorner());
+	const int stride = region.stride();
+	core::AtomicBool success(true);
+	core::parallelSlices(&threadPool, (int)entities.size(), [&](int i) {
+		if (!success) {
+			return;
+		}
+		const core::String &layerFilename = entities[i].fullPath;
+		const image::ImagePtr &image = image::loadImage(layerFilename);
 		if (!image || !image->isLoaded()) {
-			Log::error("Failed to load image %s", layetFilename.c_str());
-			return false;
+			Log::error("Failed to load image %s", layerFilename.c_str());
+			success = false;
+			return;
 		}
 		if (imageWidth != image->width() || imageHeight != image->height()) {
-			Log::error("Image %s has different dimensions than the first image (%d:%d) vs (%d:%d)", layetFilename.c_str(),
-					   image->width(), image->height(), imageWidth, imageHeight);
-			return false;
+			Log::error("Image %s has different dimensions than the first image (%d:%d) vs (%d:%d)",
+					   layerFilename.c_str(), image->width(), image->height(), imageWidth, imageHeight);
+			success = false;
+			return;
 		}
-		const int layer = extractLayerFromFilename(layetFilename);
-		Log::debug("Import layer %i of image %s", layer, layetFilename.c_str());
+		const int layer = extractLayerFromFilename(layerFilename);
+		Log::debug("Import layer %i of image %s", layer, layerFilename.c_str());
+		voxel::Voxel *slab = voxels + (size_t)(layer - minsZ) * stride;
 		for (int y = 0; y < imageHeight; ++y) {
+			voxel::Voxel *row = slab + (size_t)y * imageWidth;
 			for (int x = 0; x < imageWidth; ++x) {
 				const core::RGBA &color = flattenRGB(image->colorAt(x, y));
 				if (color.a == 0) {
 					continue;
 				}
-				const int palIdx = palette.getClosestMatch(color);
-				volume->setVoxel(x, y, layer, voxel::createVoxel(palette, palIdx));
+				const int palIdx = cube ? cube->getClosestMatch(color) : palette.getClosestMatch(color);
+				row[x] = voxel::createVoxel(palette, palIdx);
 			}
 		}
+	});
+	if (!success) {
+		return false;
 	}
 	if (sceneGraph.emplace(core::move(node)) == InvalidNodeId) {
 		Log::error("Failed to add node to scene graph");
@@ -105,7 +131,8 @@ bool PNGFormat::importAsHeightmap(scenegraph::SceneGraph &sceneGraph, const pale
 		return false;
 	}
 	const bool coloredHeightmap = image->depth() == 4 && !image->isGrayScale();
-	const int maxHeight = voxelutil::importHeightMaxHeight(image, coloredHeightmap);
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	const int maxHeight = voxelutil::importHeightMaxHeight(image, coloredHeightmap, &threadPool);
 	if (maxHeight <= 0) {
 		Log::error("There is no height in either the red channel or the alpha channel");
 		return false;
@@ -119,13 +146,13 @@ bool PNGFormat::importAsHeightmap(scenegraph::SceneGraph &sceneGraph, const pale
 	voxel::RawVolumeWrapper wrapper(volume);
 	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
 	const voxel::Voxel dirtVoxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
-	const uint8_t minHeight = core::Var::getSafe(cfg::VoxformatImageHeightmapMinHeight)->intVal();;
+	const uint8_t minHeight = _config.imageHeightmapMinHeight;
 	if (coloredHeightmap) {
 		palette::PaletteLookup palLookup(palette);
-		voxelutil::importColoredHeightmap(wrapper, palLookup, image, dirtVoxel, minHeight, false);
+		voxelutil::importColoredHeightmap(wrapper, palLookup, image, dirtVoxel, minHeight, false, &threadPool);
 	} else {
 		const voxel::Voxel grassVoxel = voxel::createVoxel(voxel::VoxelType::Generic, 2);
-		voxelutil::importHeightmap(wrapper, image, dirtVoxel, grassVoxel, minHeight, false);
+		voxelutil::importHeightmap(wrapper, image, dirtVoxel, grassVoxel, minHeight, false, &threadPool);
 	}
 	node.setPalette(palette);
 	node.setVolume(volume, true);
@@ -136,8 +163,8 @@ bool PNGFormat::importAsHeightmap(scenegraph::SceneGraph &sceneGraph, const pale
 bool PNGFormat::importAsVolume(scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette,
 							   const core::String &filename, const io::ArchivePtr &archive) const {
 	const image::ImagePtr &image = image::loadImage(filename);
-	const int maxDepth = core::Var::getSafe(cfg::VoxformatImageVolumeMaxDepth)->intVal();
-	const bool bothSides = core::Var::getSafe(cfg::VoxformatImageVolumeBothSides)->boolVal();
+	const int maxDepth = _config.imageVolumeMaxDepth;
+	const bool bothSides = _config.imageVolumeBothSides;
 	const core::String &depthMapFilename = voxelutil::getDefaultDepthMapFile(filename);
 	core::ScopedPtr<io::SeekableReadStream> depthMapStream(archive->readStream(depthMapFilename));
 	const image::ImagePtr &depthMapImage = image::loadImage(depthMapFilename, *depthMapStream, depthMapStream->size());
@@ -178,7 +205,7 @@ bool PNGFormat::importAsPlane(scenegraph::SceneGraph &sceneGraph, const palette:
 bool PNGFormat::loadGroupsRGBA(const core::String &filename, const io::ArchivePtr &archive,
 							   scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette,
 							   const LoadContext &ctx) {
-	const int type = core::Var::getSafe(cfg::VoxformatImageImportType)->intVal();
+	const int type = ctx.config.imageImportType;
 	if (type == ImportType::Heightmap) {
 		return importAsHeightmap(sceneGraph, palette, filename, archive);
 	}
@@ -211,7 +238,7 @@ bool PNGFormat::loadGroupsRGBA(const core::String &filename, const io::ArchivePt
 size_t PNGFormat::loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
 							  const LoadContext &ctx) {
 	const image::ImagePtr &image = image::loadImage(filename);
-	const int type = core::Var::getSafe(cfg::VoxformatImageImportType)->intVal();
+	const int type = ctx.config.imageImportType;
 	if (type == ImportType::Heightmap) {
 		image->makeOpaque();
 	}
@@ -236,29 +263,41 @@ bool PNGFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core:
 		core_assert(volume != nullptr);
 		const voxel::Region &region = volume->region();
 		const palette::Palette &palette = node.palette();
-		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
-			const core::String &layerFilename = core::string::format("%s-%s-%i.png", basename.c_str(), node.uuid().c_str(), z);
-			image::Image image(layerFilename);
-			core::Buffer<core::RGBA> rgba(region.getWidthInVoxels() * region.getHeightInVoxels());
+		const int width = region.getWidthInVoxels();
+		const int height = region.getHeightInVoxels();
+		// every slice is converted, encoded and freed by one task - the stack is never kept in memory as a whole
+		core::AtomicBool success(true);
+		core::parallelSlices(&app::App::getInstance()->threadPool(), region.getDepthInVoxels(), [&](int slice) {
+			if (!success) {
+				return;
+			}
+			const int z = region.getLowerZ() + slice;
+			const core::String &layerFilename = core::string::format("%s-%s-%i.png", basename.c_str(), node.uuid().str().c_str(), z);
+			core::Buffer<core::RGBA> rgba(width * height);
 			for (int y = region.getUpperY(); y >= region.getLowerY(); --y) {
-				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
-					const voxel::Voxel &v = volume->voxel(x, y, z);
+				const voxel::Voxel *row = volume->row(glm::ivec3(region.getLowerX(), y, z));
+				core::RGBA *imageRow = &rgba[(region.getUpperY() - y) * width];
+				for (int x = 0; x < width; ++x) {
+					const voxel::Voxel &v = row[x];
 					if (voxel::isAir(v.getMaterial())) {
 						continue;
 					}
-					const core::RGBA color = palette.color(v.getColor());
-					const int idx = (region.getUpperY() - y) * region.getWidthInVoxels() + (x - region.getLowerX());
-					rgba[idx] = color;
+					imageRow[x] = palette.color(v.getColor());
 				}
 			}
-			if (!image.loadRGBA((const uint8_t *)rgba.data(), region.getWidthInVoxels(), region.getHeightInVoxels())) {
+			const image::ImagePtr &image = image::createEmptyImage(layerFilename);
+			if (!image->loadRGBA((const uint8_t *)rgba.data(), width, height)) {
 				Log::error("Failed to load sliced rgba data %s", layerFilename.c_str());
-				return false;
+				success = false;
+				return;
 			}
 			if (!image::writeImage(image, layerFilename)) {
-				Log::error("Failed to write slice image %s", layerFilename.c_str());
-				return false;
+				Log::error("Failed to write the slice image %s", layerFilename.c_str());
+				success = false;
 			}
+		});
+		if (!success) {
+			return false;
 		}
 	}
 	return true;
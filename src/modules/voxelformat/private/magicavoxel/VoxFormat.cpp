@@ -3,14 +3,16 @@
  */
 
 #include "VoxFormat.h"
-#include "core/ConfigVar.h"
+#include "core/FourCC.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
-#include "core/Var.h"
+#include "core/collection/Map.h"
+#include "core/collection/StringMap.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/RawVolume.h"
+#include "voxelformat/FormatProbe.h"
 #include "voxelformat/external/ogt_vox.h"
 #include "voxelutil/VolumeVisitor.h"
 #include "MagicaVoxel.h"
@@ -50,8 +52,12 @@ size_t VoxFormat::loadPalette(const core::String &filename, const io::ArchivePtr
 	return palette.colorCount();
 }
 
-bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceIdx, scenegraph::SceneGraph &sceneGraph,
-							 int parent, core::DynamicArray<MVModelToNode> &models, const palette::Palette &palette) {
+/**
+ * @brief Creates the volume of the given instance in the transformed region - this is independent of all the other
+ * instances
+ */
+static voxel::RawVolume *loadInstanceVolume(const ogt_vox_scene *scene, uint32_t ogt_instanceIdx,
+											const palette::Palette &palette) {
 	const ogt_vox_instance &ogtInstance = scene->instances[ogt_instanceIdx];
 	const ogt_vox_model *ogtModel = scene->models[ogtInstance.model_index];
 	const glm::mat4 &ogtMat = ogtTransformToMat(ogtInstance, 0, scene, ogtModel);
@@ -59,12 +65,8 @@ bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceId
 	const glm::ivec3 &ogtMaxs = calcTransform(ogtMat, ogtVolumeSize(ogtModel));
 	const glm::ivec3 mins(-(ogtMins.x + 1), ogtMins.z, ogtMins.y);
 	const glm::ivec3 maxs(-(ogtMaxs.x + 1), ogtMaxs.z, ogtMaxs.y);
-	voxel::Region region(glm::min(mins, maxs), glm::max(mins, maxs));
-	const glm::ivec3 shift = region.getLowerCorner();
-	region.shift(-shift);
+	const voxel::Region region(glm::min(mins, maxs), glm::max(mins, maxs));
 	voxel::RawVolume *v = new voxel::RawVolume(region);
-	scenegraph::SceneGraphTransform transform;
-	transform.setWorldTranslation(shift);
 
 	const uint8_t *ogtVoxel = ogtModel->voxel_data;
 	for (uint32_t k = 0; k < ogtModel->size_z; ++k) {
@@ -76,10 +78,22 @@ bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceId
 				const voxel::Voxel voxel = voxel::createVoxel(palette, ogtVoxel[0] - 1);
 				const glm::ivec3 &ogtPos = calcTransform(ogtMat, glm::vec3(i, j, k));
 				const glm::ivec3 pos(-(ogtPos.x + 1), ogtPos.z, ogtPos.y);
-				v->setVoxel(pos - shift, voxel);
+				v->setVoxel(pos, voxel);
 			}
 		}
 	}
+	return v;
+}
+
+bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceIdx, scenegraph::SceneGraph &sceneGraph,
+							 int parent, core::DynamicArray<MVModelToNode> &instances, const palette::Palette &palette) {
+	const ogt_vox_instance &ogtInstance = scene->instances[ogt_instanceIdx];
+	voxel::RawVolume *v = instances[ogt_instanceIdx].volume;
+	instances[ogt_instanceIdx].volume = nullptr;
+	const glm::ivec3 shift = v->region().getLowerCorner();
+	v->translate(-shift);
+	scenegraph::SceneGraphTransform transform;
+	transform.setWorldTranslation(shift);
 
 	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
 	loadKeyFrames(sceneGraph, node, ogtInstance, scene);
@@ -98,7 +112,6 @@ bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceId
 	node.setVisible(!instanceHidden(scene, ogtInstance));
 	node.setVolume(v, true);
 	// TODO: VOXELFORMAT: use already loaded models and create a model reference if needed
-	// TODO: VOXELFORMAT: node.setVolume(new voxel::RawVolume(models[ogtInstance.model_index].volume), true);
 	// TODO: VOXELFORMAT: set correct pivot
 	// TODO: VOXELFORMAT: node.setPivot({ogtPivot.x / (float)ogtModel->size_x, ogtPivot.z / (float)ogtModel->size_z, ogtPivot.y / (float)ogtModel->size_y});
 	// TODO: VOXELFORMAT: node.setPivot({(ogtPivot.x + 0.5f) / (float)ogtModel->size_x, (ogtPivot.z + 0.5f) / (float)ogtModel->size_z, (ogtPivot.y + 0.5f) / (float)ogtModel->size_y});
@@ -107,7 +120,7 @@ bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceId
 }
 
 bool VoxFormat::loadGroup(const ogt_vox_scene *scene, uint32_t ogt_groupIdx, scenegraph::SceneGraph &sceneGraph,
-						  int parent, core::DynamicArray<MVModelToNode> &models, core::Set<uint32_t> &addedInstances,
+						  int parent, core::DynamicArray<MVModelToNode> &instances, core::Set<uint32_t> &addedInstances,
 						  const palette::Palette &palette) {
 	const ogt_vox_group &ogt_group = scene->groups[ogt_groupIdx];
 	bool hidden = ogt_group.hidden;
@@ -138,7 +151,7 @@ bool VoxFormat::loadGroup(const ogt_vox_scene *scene, uint32_t ogt_groupIdx, sce
 			continue;
 		}
 		Log::debug("Found matching group (%u) with scene graph parent: %i", groupIdx, groupId);
-		if (!loadGroup(scene, groupIdx, sceneGraph, groupId, models, addedInstances, palette)) {
+		if (!loadGroup(scene, groupIdx, sceneGraph, groupId, instances, addedInstances, palette)) {
 			return false;
 		}
 	}
@@ -151,7 +164,7 @@ bool VoxFormat::loadGroup(const ogt_vox_scene *scene, uint32_t ogt_groupIdx, sce
 		if (!addedInstances.insert(n)) {
 			continue;
 		}
-		if (!loadInstance(scene, n, sceneGraph, groupId, models, palette)) {
+		if (!loadInstance(scene, n, sceneGraph, groupId, instances, palette)) {
 			return false;
 		}
 	}
@@ -201,9 +214,298 @@ bool VoxFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 	return true;
 }
 
+namespace priv {
+
+/**
+ * @brief A node of the scene graph chunks (nTRN, nGRP and nSHP) of a vox file
+ */
+struct VoxProbeNode {
+	uint32_t id = 0u;
+	core::String name;
+	/** the child of a transform - the children of a group */
+	core::DynamicArray<uint32_t> children;
+	/** the model of a shape */
+	int32_t model = -1;
+	int32_t layer = -1;
+	/** the packed rotation of the first frame of a transform */
+	uint8_t rotation = 4u;
+	bool transform = false;
+	bool group = false;
+};
+
+struct VoxProbeLayer {
+	core::String name;
+};
+
+struct VoxProbeState {
+	core::DynamicArray<glm::ivec3> sizes;
+	core::Map<uint32_t, VoxProbeNode> nodes;
+	core::Map<int32_t, VoxProbeLayer> layers;
+	core::RGBA colors[256];
+	uint8_t imap[256];
+	bool hasColors = false;
+	bool hasImap = false;
+	bool hasTransforms = false;
+};
+
+static bool readDict(io::SeekableReadStream &stream, core::StringMap<core::String> &dict) {
+	uint32_t entries;
+	if (stream.readUInt32(entries) != 0) {
+		return false;
+	}
+	for (uint32_t i = 0; i < entries; ++i) {
+		core::String key;
+		core::String value;
+		if (!stream.readPascalStringUInt32LE(key) || !stream.readPascalStringUInt32LE(value)) {
+			return false;
+		}
+		dict.put(key, value);
+	}
+	return true;
+}
+
+static bool readChunk(io::SeekableReadStream &stream, uint32_t id, VoxProbeState &state) {
+	switch (id) {
+	case FourCC('S', 'I', 'Z', 'E'): {
+		glm::ivec3 size;
+		if (stream.readInt32(size.x) != 0 || stream.readInt32(size.y) != 0 || stream.readInt32(size.z) != 0) {
+			return false;
+		}
+		state.sizes.push_back(size);
+		return true;
+	}
+	case FourCC('n', 'T', 'R', 'N'): {
+		VoxProbeNode node;
+		core::StringMap<core::String> dict;
+		uint32_t child;
+		uint32_t reserved;
+		uint32_t frames;
+		if (stream.readUInt32(node.id) != 0 || !readDict(stream, dict) || stream.readUInt32(child) != 0 ||
+			stream.readUInt32(reserved) != 0 || stream.readInt32(node.layer) != 0 || stream.readUInt32(frames) != 0) {
+			return false;
+		}
+		dict.get("_name", node.name);
+		for (uint32_t i = 0; i < frames; ++i) {
+			core::StringMap<core::String> frame;
+			if (!readDict(stream, frame)) {
+				return false;
+			}
+			core::String rotation;
+			if (i == 0 && frame.get("_r", rotation)) {
+				node.rotation = (uint8_t)rotation.toInt();
+			}
+		}
+		node.children.push_back(child);
+		node.transform = true;
+		state.hasTransforms = true;
+		state.nodes.put(node.id, node);
+		return true;
+	}
+	case FourCC('n', 'G', 'R', 'P'): {
+		VoxProbeNode node;
+		core::StringMap<core::String> dict;
+		uint32_t children;
+		if (stream.readUInt32(node.id) != 0 || !readDict(stream, dict) || stream.readUInt32(children) != 0) {
+			return false;
+		}
+		for (uint32_t i = 0; i < children; ++i) {
+			uint32_t child;
+			if (stream.readUInt32(child) != 0) {
+				return false;
+			}
+			node.children.push_back(child);
+		}
+		node.group = true;
+		state.nodes.put(node.id, node);
+		return true;
+	}
+	case FourCC('n', 'S', 'H', 'P'): {
+		VoxProbeNode node;
+		core::StringMap<core::String> dict;
+		uint32_t models;
+		if (stream.readUInt32(node.id) != 0 || !readDict(stream, dict) || stream.readUInt32(models) != 0) {
+			return false;
+		}
+		// only the first model is used - just like the loader does
+		if (models > 0u && stream.readInt32(node.model) != 0) {
+			return false;
+		}
+		state.nodes.put(node.id, node);
+		return true;
+	}
+	case FourCC('L', 'A', 'Y', 'R'): {
+		int32_t layerId;
+		core::StringMap<core::String> dict;
+		if (stream.readInt32(layerId) != 0 || !readDict(stream, dict)) {
+			return false;
+		}
+		VoxProbeLayer layer;
+		dict.get("_name", layer.name);
+		state.layers.put(layerId, layer);
+		return true;
+	}
+	case FourCC('R', 'G', 'B', 'A'): {
+		for (int i = 0; i < 256; ++i) {
+			core::RGBA &color = state.colors[i];
+			if (stream.readUInt8(color.r) != 0 || stream.readUInt8(color.g) != 0 || stream.readUInt8(color.b) != 0 ||
+				stream.readUInt8(color.a) != 0) {
+				return false;
+			}
+		}
+		state.hasColors = true;
+		return true;
+	}
+	case FourCC('I', 'M', 'A', 'P'): {
+		if (stream.read(state.imap, sizeof(state.imap)) != (int)sizeof(state.imap)) {
+			return false;
+		}
+		state.hasImap = true;
+		return true;
+	}
+	default:
+		return true;
+	}
+}
+
+/**
+ * @brief The rows of the rotation matrix as the index of the non-zero column - the signs don't change the size
+ */
+static glm::ivec3 rotationColumns(uint8_t rotation) {
+	const int c0 = rotation & 3;
+	const int c1 = (rotation >> 2) & 3;
+	return glm::ivec3(c0, c1, 3 - c0 - c1);
+}
+
+static void probeNode(const VoxProbeState &state, uint32_t nodeId, int parent, const glm::ivec3 &columns, int depth,
+					  ProbeInfo &info) {
+	VoxProbeNode transform;
+	if (depth > 64 || !state.nodes.get(nodeId, transform) || !transform.transform) {
+		return;
+	}
+	VoxProbeNode child;
+	if (!state.nodes.get(transform.children[0], child)) {
+		return;
+	}
+	const glm::ivec3 local = rotationColumns(transform.rotation);
+	const glm::ivec3 global(local[columns.x], local[columns.y], local[columns.z]);
+	VoxProbeLayer layer;
+	const bool hasLayer = state.layers.get(transform.layer, layer);
+	if (child.group) {
+		int groupId = parent;
+		if (depth > 0) {
+			core::String name = transform.name.empty() ? "Group" : transform.name;
+			if (hasLayer && !layer.name.empty()) {
+				name = layer.name;
+			}
+			groupId = info.addNode(name, scenegraph::SceneGraphNodeType::Group, parent);
+		}
+		for (uint32_t c : child.children) {
+			probeNode(state, c, groupId, global, depth + 1, info);
+		}
+		return;
+	}
+	if (child.model < 0 || child.model >= (int32_t)state.sizes.size()) {
+		return;
+	}
+	const core::String &name = transform.name.empty() && hasLayer ? layer.name : transform.name;
+	const glm::ivec3 &size = state.sizes[child.model];
+	// the size in the vox coordinate system - z is pointing upwards
+	const glm::ivec3 voxSize(size[global.x], size[global.y], size[global.z]);
+	const glm::ivec3 dims(voxSize.x, voxSize.z, voxSize.y);
+	info.addNode(name, scenegraph::SceneGraphNodeType::Model, parent, voxel::Region(glm::ivec3(0), dims - 1));
+}
+
+} // namespace priv
+
+bool VoxFormat::probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+					  const LoadContext &ctx) {
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
+	if (!stream) {
+		Log::error("Could not open file %s", filename.c_str());
+		return false;
+	}
+	uint32_t magic;
+	uint32_t version;
+	if (stream->readUInt32(magic) != 0 || stream->readUInt32(version) != 0 || magic != FourCC('V', 'O', 'X', ' ')) {
+		Log::error("Invalid vox header in %s", filename.c_str());
+		return false;
+	}
+	priv::VoxProbeState state;
+	// the voxel data is skipped - only the chunk headers, the sizes and the scene graph chunks are read
+	while (!stream->eos()) {
+		uint32_t id;
+		uint32_t contentSize;
+		uint32_t childSize;
+		if (stream->readUInt32(id) != 0 || stream->readUInt32(contentSize) != 0 ||
+			stream->readUInt32(childSize) != 0) {
+			Log::error("Failed to read chunk header in %s", filename.c_str());
+			return false;
+		}
+		const int64_t start = stream->pos();
+		if (id == FourCC('M', 'A', 'I', 'N')) {
+			// the children of the main chunk follow inline
+			if (stream->skip(contentSize) == -1) {
+				return false;
+			}
+			continue;
+		}
+		if (!priv::readChunk(*stream, id, state)) {
+			Log::error("Failed to read chunk %u in %s", id, filename.c_str());
+			return false;
+		}
+		if (stream->seek(start + (int64_t)contentSize + (int64_t)childSize) == -1) {
+			return false;
+		}
+	}
+
+	// see loadPaletteFromScene() - but without the materials
+	palette::Palette palette;
+	if (state.hasColors) {
+		palette.setSize(0);
+		int n = 0;
+		for (int i = 0; i < 255; ++i) {
+			const int fileIdx = state.hasImap ? (state.imap[i] + 255) & 255 : i;
+			palette.setColor(i, state.colors[fileIdx]);
+			if (state.colors[fileIdx].a > 0) {
+				n = i + 1;
+			}
+		}
+		if (n > 0) {
+			palette.setSize(n);
+		}
+	} else {
+		palette.magicaVoxel();
+	}
+	info.setPalette(palette);
+
+	if (state.hasTransforms) {
+		priv::probeNode(state, 0u, -1, glm::ivec3(0, 1, 2), 0, info);
+	} else {
+		for (const glm::ivec3 &size : state.sizes) {
+			info.addNode("", scenegraph::SceneGraphNodeType::Model, -1,
+						 voxel::Region(glm::ivec3(0), glm::ivec3(size.x, size.z, size.y) - 1));
+		}
+	}
+	if (info.nodes.empty() && palette.colorCount() > 0) {
+		info.addNode(core::string::extractFilename(filename), scenegraph::SceneGraphNodeType::Model, -1,
+					 voxel::Region(0, 31));
+	}
+	return true;
+}
+
 bool VoxFormat::loadScene(const ogt_vox_scene *scene, scenegraph::SceneGraph &sceneGraph,
 						  const palette::Palette &palette) {
-	core::DynamicArray<MVModelToNode> models = loadModels(scene, palette);
+	// the volumes of the instances are created in parallel - the scene graph is assembled afterwards
+	core::DynamicArray<MVModelToNode> instances;
+	instances.reserve(scene->num_instances);
+	for (uint32_t n = 0; n < scene->num_instances; ++n) {
+		instances.emplace_back(nullptr, InvalidNodeId);
+	}
+	decodeParallel(scene->num_instances, [&](size_t n) {
+		instances[n].volume = loadInstanceVolume(scene, (uint32_t)n, palette);
+		return true;
+	});
+
 	core::Set<uint32_t> addedInstances;
 	for (uint32_t i = 0; i < scene->num_groups; ++i) {
 		const ogt_vox_group &group = scene->groups[i];
@@ -212,7 +514,7 @@ bool VoxFormat::loadScene(const ogt_vox_scene *scene, scenegraph::SceneGraph &sc
 			continue;
 		}
 		Log::debug("Add root group %u/%u", i, scene->num_groups);
-		if (!loadGroup(scene, i, sceneGraph, -1, models, addedInstances, palette)) {
+		if (!loadGroup(scene, i, sceneGraph, -1, instances, addedInstances, palette)) {
 			return false;
 		}
 		break;
@@ -222,11 +524,12 @@ bool VoxFormat::loadScene(const ogt_vox_scene *scene, scenegraph::SceneGraph &sc
 			continue;
 		}
 		// TODO: VOXELFORMAT: the parent is wrong
-		if (!loadInstance(scene, n, sceneGraph, sceneGraph.root().id(), models, palette)) {
+		if (!loadInstance(scene, n, sceneGraph, sceneGraph.root().id(), instances, palette)) {
 			return false;
 		}
 	}
 	if (scene->num_instances == 0 && scene->num_models > 0) {
+		core::DynamicArray<MVModelToNode> models = loadModels(scene, palette);
 		for (MVModelToNode &m : models) {
 			scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
 			node.setVolume(m.volume, true);
@@ -287,7 +590,7 @@ void VoxFormat::saveNode(const scenegraph::SceneGraph &sceneGraph, scenegraph::S
 		} else {
 			Log::debug("Add group node");
 		}
-		const bool addLayers = core::Var::getSafe(cfg::VoxformatVOXCreateLayers)->boolVal();
+		const bool addLayers = _config.voxCreateLayers;
 		if (node.isRootNode() || addLayers) {
 			// TODO: VOXELFORMAT: only add the layer if there are models in this group?
 			// https://github.com/vengi-voxel/vengi/issues/186
@@ -303,7 +606,7 @@ void VoxFormat::saveNode(const scenegraph::SceneGraph &sceneGraph, scenegraph::S
 			ctx.layers.push_back(ogt_layer);
 		}
 		const uint32_t ownLayerId = (int)ctx.layers.size() - 1;
-		const bool addGroups = core::Var::getSafe(cfg::VoxformatVOXCreateGroups)->boolVal();
+		const bool addGroups = _config.voxCreateGroups;
 		if (node.isRootNode() || addGroups) {
 			ogt_vox_group ogt_group;
 			core_memset(&ogt_group, 0, sizeof(ogt_group));
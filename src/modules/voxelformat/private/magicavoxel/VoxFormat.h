@@ -34,9 +34,9 @@ private:
 					 uint32_t parentGroupIdx, uint32_t layerIdx, uint32_t modelIdx);
 	bool loadScene(const ogt_vox_scene *scene, scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette);
 	bool loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceIdx, scenegraph::SceneGraph &sceneGraph,
-					  int parent, core::DynamicArray<MVModelToNode> &models, const palette::Palette &palette);
+					  int parent, core::DynamicArray<MVModelToNode> &instances, const palette::Palette &palette);
 	bool loadGroup(const ogt_vox_scene *scene, uint32_t ogt_parentGroupIdx, scenegraph::SceneGraph &sceneGraph,
-				   int parent, core::DynamicArray<MVModelToNode> &models, core::Set<uint32_t> &addedInstances,
+				   int parent, core::DynamicArray<MVModelToNode> &instances, core::Set<uint32_t> &addedInstances,
 				   const palette::Palette &palette);
 	bool loadGroupsPalette(const core::String &filename, const io::ArchivePtr &archive,
 						   scenegraph::SceneGraph &sceneGraph, palette::Palette &palette,
@@ -50,6 +50,11 @@ public:
 	VoxFormat();
 	size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
 					   const LoadContext &ctx) override;
+	/**
+	 * @brief Walks the chunks without decoding the voxels of the models
+	 */
+	bool probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+			   const LoadContext &ctx) override;
 
 	static const io::FormatDescription &format() {
 		static io::FormatDescription f{
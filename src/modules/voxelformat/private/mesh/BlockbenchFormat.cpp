@@ -567,7 +567,7 @@ static bool parseAnimations(const core::String &filename, const BlockbenchFormat
 		for (const priv::Animator &animator : animation.animators) {
 			Log::debug("Animator: %s", animator.name.c_str());
 			if (scenegraph::SceneGraphNode *node = sceneGraph.findNodeByUUID(animator.uuid)) {
-				Log::debug("Found node: %s (uuid: %s)", node->name().c_str(), node->uuid().c_str());
+				Log::debug("Found node: %s (uuid: %s)", node->name().c_str(), node->uuid().str().c_str());
 				const auto &keyframes = animator.keyframes;
 				scenegraph::KeyFrameIndex keyFrameIdx = 0;
 				node->keyFrames()->reserve(keyframes.size());
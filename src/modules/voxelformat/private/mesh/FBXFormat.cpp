@@ -343,7 +343,8 @@ int FBXFormat::addMeshNode(const ufbx_scene *scene, const ufbx_node *node, const
 
 			if (texture) {
 				const core::String &fbxTextureFilename = priv::_ufbx_to_string(texture->relative_filename);
-				const core::String &textureName = lookupTexture(filename, fbxTextureFilename, archive);
+				const core::String &textureName =
+					lookupTexture(filename, fbxTextureFilename, archive, _config.texturePath);
 				if (!textureName.empty()) {
 					const image::ImagePtr &tex = image::loadImage(textureName);
 					if (tex->isLoaded()) {
@@ -5,14 +5,12 @@
 #include "GLTFFormat.h"
 #include "app/App.h"
 #include "core/Color.h"
-#include "core/ConfigVar.h"
 #include "core/FourCC.h"
 #include "core/Log.h"
 #include "core/RGBA.h"
 #include "core/ScopedPtr.h"
 #include "core/String.h"
 #include "core/StringUtil.h"
-#include "core/Var.h"
 #include "core/collection/DynamicArray.h"
 #include "engine-config.h"
 #include "image/Image.h"
@@ -111,6 +109,50 @@ static core::RGBA toColor(const tinygltf::Accessor *gltfAttributeAccessor, const
 	return core::RGBA(0, 0, 0, 255);
 }
 
+/**
+ * @brief Reads the float components of an attribute that might be quantized (KHR_mesh_quantization)
+ * @return @c false if the component type is not supported
+ */
+static bool toFloats(const tinygltf::Accessor *gltfAttributeAccessor, const uint8_t *buf, size_t stride, float *out,
+					 int n) {
+	io::MemoryReadStream stream(buf, stride);
+	const bool normalized = gltfAttributeAccessor->normalized;
+	for (int i = 0; i < n; ++i) {
+		switch (gltfAttributeAccessor->componentType) {
+		case TINYGLTF_COMPONENT_TYPE_FLOAT:
+			stream.readFloat(out[i]);
+			break;
+		case TINYGLTF_COMPONENT_TYPE_BYTE: {
+			int8_t val;
+			stream.readInt8(val);
+			out[i] = normalized ? glm::max((float)val / 127.0f, -1.0f) : (float)val;
+			break;
+		}
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+			uint8_t val;
+			stream.readUInt8(val);
+			out[i] = normalized ? (float)val / 255.0f : (float)val;
+			break;
+		}
+		case TINYGLTF_COMPONENT_TYPE_SHORT: {
+			int16_t val;
+			stream.readInt16(val);
+			out[i] = normalized ? glm::max((float)val / 32767.0f, -1.0f) : (float)val;
+			break;
+		}
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+			uint16_t val;
+			stream.readUInt16(val);
+			out[i] = normalized ? (float)val / 65535.0f : (float)val;
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
 template<typename T>
 void copyGltfIndices(const uint8_t *data, size_t count, size_t stride, core::DynamicArray<uint32_t> &indices,
 					 size_t offset) {
@@ -219,11 +261,10 @@ void GLTFFormat::createPointMesh(tinygltf::Model &gltfModel, const scenegraph::S
 
 void GLTFFormat::saveGltfNode(core::Map<int, int> &nodeMapping, tinygltf::Model &gltfModel, tinygltf::Scene &gltfScene,
 							  const scenegraph::SceneGraphNode &node, Stack &stack,
-							  const scenegraph::SceneGraph &sceneGraph, const glm::vec3 &scale, bool exportAnimations) {
+							  const scenegraph::SceneGraph &sceneGraph, const glm::vec3 &scale, bool exportAnimations,
+							  int meshIdx) {
 	tinygltf::Node gltfNode;
-	if (node.isAnyModelNode()) {
-		gltfNode.mesh = (int)gltfModel.meshes.size();
-	}
+	gltfNode.mesh = meshIdx;
 	if (node.type() == scenegraph::SceneGraphNodeType::Point) {
 		createPointMesh(gltfModel, node);
 		gltfNode.mesh = (int)gltfModel.meshes.size();
@@ -271,40 +312,91 @@ void GLTFFormat::saveGltfNode(core::Map<int, int> &nodeMapping, tinygltf::Model
 	}
 }
 
-uint32_t GLTFFormat::writeBuffer(const voxel::Mesh *mesh, uint8_t idx, io::SeekableWriteStream &os, bool withColor,
-								 bool withTexCoords, bool colorAsFloat, bool exportNormals, bool applyTransform,
-								 const glm::vec3 &pivotOffset, const palette::Palette &palette, Bounds &bounds) {
-	const int nv = (int)mesh->getNoOfVertices();
-	const int ni = (int)mesh->getNoOfIndices();
-
+uint32_t GLTFFormat::writeBuffer(const voxel::Mesh *mesh, uint8_t idx, bool withColor, bool withTexCoords,
+								 bool colorAsFloat, bool exportNormals, bool applyTransform, bool quantize,
+								 const glm::vec3 &pivotOffset, const palette::Palette &palette,
+								 PrimitiveBuffer &primitiveBuffer) {
 	const voxel::VertexArray &vertices = mesh->getVertexVector();
 	const voxel::NormalArray &normals = mesh->getNormalVector();
 	const voxel::IndexArray &indices = mesh->getIndexVector();
-
-	for (int i = 0; i < ni; i++) {
+	const int ni = (int)indices.size();
+
+	// the vertices of the other colors are not written - the used vertices are renumbered in the order of their first
+	// use to keep the vertex fetch order of the optimized mesh
+	core::DynamicArray<uint32_t> remap;
+	remap.resize(vertices.size());
+	remap.fill(UINT_MAX);
+	core::DynamicArray<uint32_t> usedVertices;
+	core::DynamicArray<uint32_t> primitiveIndices;
+	primitiveIndices.reserve(ni);
+	for (int i = 0; i < ni; i += 3) {
 		if (vertices[indices[i]].colorIndex != idx) {
 			continue;
 		}
-		if (bounds.maxIndex < indices[i]) {
-			bounds.maxIndex = indices[i];
+		for (int j = 0; j < 3; ++j) {
+			const voxel::IndexType index = indices[i + j];
+			if (remap[index] == UINT_MAX) {
+				remap[index] = (uint32_t)usedVertices.size();
+				usedVertices.push_back(index);
+			}
+			primitiveIndices.push_back(remap[index]);
 		}
-		if (indices[i] < bounds.minIndex) {
-			bounds.minIndex = indices[i];
+	}
+	if (primitiveIndices.empty()) {
+		return 0u;
+	}
+
+	const int nv = (int)usedVertices.size();
+	// the maximum value of the component type is not allowed as index
+	primitiveBuffer.shortIndices = nv < (int)UINT16_MAX;
+	primitiveBuffer.quantized = quantize;
+	primitiveBuffer.shortPositions = quantize;
+	for (int i = 0; i < nv && primitiveBuffer.shortPositions; ++i) {
+		glm::vec3 pos = vertices[usedVertices[i]].position;
+		if (applyTransform) {
+			pos += pivotOffset;
+		}
+		primitiveBuffer.shortPositions = glm::all(glm::equal(pos, glm::round(pos))) &&
+										 glm::all(glm::greaterThanEqual(pos, glm::vec3((float)INT16_MIN))) &&
+										 glm::all(glm::lessThanEqual(pos, glm::vec3((float)INT16_MAX)));
+	}
+
+	io::BufferedReadWriteStream &os = *primitiveBuffer.stream.get();
+	Bounds &bounds = primitiveBuffer.bounds;
+	for (uint32_t index : primitiveIndices) {
+		if (bounds.maxIndex < index) {
+			bounds.maxIndex = index;
+		}
+		if (index < bounds.minIndex) {
+			bounds.minIndex = index;
+		}
+		if (primitiveBuffer.shortIndices) {
+			os.writeUInt16((uint16_t)index);
+		} else {
+			os.writeUInt32(index);
 		}
-		os.writeUInt32(indices[i]);
 		++bounds.ni;
 	}
-	static_assert(sizeof(voxel::IndexType) == 4, "if not 4 bytes - we might need padding here");
+	// the vertex attributes must be aligned to 4 bytes
+	while (os.size() % 4 != 0) {
+		os.writeUInt8(0);
+	}
 	const uint32_t indexOffset = (uint32_t)os.size();
 
 	for (int i = 0; i < nv; i++) {
-		glm::vec3 pos = vertices[i].position;
+		const voxel::IndexType vertexIndex = usedVertices[i];
+		const voxel::VoxelVertex &vertex = vertices[vertexIndex];
+		glm::vec3 pos = vertex.position;
 		if (applyTransform) {
 			pos += pivotOffset;
 		}
 
 		for (int coordIndex = 0; coordIndex < glm::vec3::length(); coordIndex++) {
-			os.writeFloat(pos[coordIndex]);
+			if (primitiveBuffer.shortPositions) {
+				os.writeInt16((int16_t)pos[coordIndex]);
+			} else {
+				os.writeFloat(pos[coordIndex]);
+			}
 			if (bounds.maxVertex[coordIndex] < pos[coordIndex]) {
 				bounds.maxVertex[coordIndex] = pos[coordIndex];
 			}
@@ -312,20 +404,36 @@ uint32_t GLTFFormat::writeBuffer(const voxel::Mesh *mesh, uint8_t idx, io::Seeka
 				bounds.minVertex[coordIndex] = pos[coordIndex];
 			}
 		}
+		if (primitiveBuffer.shortPositions) {
+			os.writeInt16(0);
+		}
 		++bounds.nv;
 
 		if (exportNormals) {
-			for (int coordIndex = 0; coordIndex < glm::vec3::length(); coordIndex++) {
-				os.writeFloat(normals[i][coordIndex]);
+			const glm::vec3 &normal = normals[vertexIndex];
+			if (quantize) {
+				for (int coordIndex = 0; coordIndex < glm::vec3::length(); coordIndex++) {
+					os.writeInt8((int8_t)glm::round(glm::clamp(normal[coordIndex], -1.0f, 1.0f) * 127.0f));
+				}
+				os.writeInt8(0);
+			} else {
+				for (int coordIndex = 0; coordIndex < glm::vec3::length(); coordIndex++) {
+					os.writeFloat(normal[coordIndex]);
+				}
 			}
 		}
 
 		if (withTexCoords) {
-			const glm::vec2 &uv = paletteUV(vertices[i].colorIndex);
-			os.writeFloat(uv.x);
-			os.writeFloat(uv.y);
+			const glm::vec2 &uv = paletteUV(vertex.colorIndex);
+			if (quantize) {
+				os.writeUInt16((uint16_t)glm::round(glm::clamp(uv.x, 0.0f, 1.0f) * 65535.0f));
+				os.writeUInt16((uint16_t)glm::round(glm::clamp(uv.y, 0.0f, 1.0f) * 65535.0f));
+			} else {
+				os.writeFloat(uv.x);
+				os.writeFloat(uv.y);
+			}
 		} else if (withColor) {
-			const core::RGBA paletteColor = palette.color(vertices[i].colorIndex);
+			const core::RGBA paletteColor = palette.color(vertex.colorIndex);
 			if (colorAsFloat) {
 				const glm::vec4 &color = core::Color::fromRGBA(paletteColor);
 				for (int colorIdx = 0; colorIdx < glm::vec4::length(); colorIdx++) {
@@ -342,48 +450,58 @@ uint32_t GLTFFormat::writeBuffer(const voxel::Mesh *mesh, uint8_t idx, io::Seeka
 	return indexOffset;
 }
 
-bool GLTFFormat::savePrimitivesPerMaterial(uint8_t idx, const glm::vec3 &pivotOffset, tinygltf::Model &gltfModel,
-										   tinygltf::Mesh &gltfMesh, const voxel::Mesh *mesh,
-										   const palette::Palette &palette, bool withColor, bool withTexCoords,
-										   bool colorAsFloat, bool exportNormals, bool applyTransform,
-										   int texcoordIndex, const MaterialMap &paletteMaterialIndices) {
-
+bool GLTFFormat::writePrimitiveBuffer(uint8_t idx, const glm::vec3 &pivotOffset, const voxel::Mesh *mesh,
+									  const palette::Palette &palette, bool withColor, bool withTexCoords,
+									  bool colorAsFloat, bool exportNormals, bool applyTransform, bool quantize,
+									  PrimitiveBuffer &primitiveBuffer) {
 	const size_t expectedSize =
 		mesh->getNoOfIndices() * sizeof(voxel::IndexType) + mesh->getNoOfVertices() * 10 * sizeof(float);
-	io::BufferedReadWriteStream os((int64_t)expectedSize);
+	primitiveBuffer.stream = core::make_shared<io::BufferedReadWriteStream>((int64_t)expectedSize);
 
-	Bounds bounds;
+	Bounds &bounds = primitiveBuffer.bounds;
 	bounds.minIndex = UINT_MAX;
 	bounds.maxVertex = glm::vec3{-FLT_MAX};
 	bounds.minVertex = glm::vec3{FLT_MAX};
 
-	const uint32_t indicesBufferByteLen = writeBuffer(mesh, idx, os, withColor, withTexCoords, colorAsFloat,
-													  exportNormals, applyTransform, pivotOffset, palette, bounds);
+	primitiveBuffer.indicesBufferByteLen = writeBuffer(mesh, idx, withColor, withTexCoords, colorAsFloat, exportNormals,
+													   applyTransform, quantize, pivotOffset, palette, primitiveBuffer);
+	return primitiveBuffer.indicesBufferByteLen != 0u;
+}
+
+bool GLTFFormat::savePrimitivesPerMaterial(uint8_t idx, tinygltf::Model &gltfModel, tinygltf::Mesh &gltfMesh,
+										   const PrimitiveBuffer &primitiveBuffer, const palette::Palette &palette,
+										   bool withColor, bool withTexCoords, bool colorAsFloat, bool exportNormals,
+										   int texcoordIndex, const MaterialMap &paletteMaterialIndices) {
+	const uint32_t indicesBufferByteLen = primitiveBuffer.indicesBufferByteLen;
 	if (indicesBufferByteLen == 0u) {
 		return false;
 	}
+	const io::BufferedReadWriteStream &os = *primitiveBuffer.stream.get();
+	const Bounds &bounds = primitiveBuffer.bounds;
+	const bool quantized = primitiveBuffer.quantized;
+	// the quantized attributes are padded to 4 bytes - see writeBuffer()
+	const size_t positionSize = primitiveBuffer.shortPositions ? 4 * sizeof(int16_t) : 3 * sizeof(float);
+	const size_t normalSize = quantized ? 4 * sizeof(int8_t) : 3 * sizeof(float);
+	const size_t texcoordSize = quantized ? 2 * sizeof(uint16_t) : 2 * sizeof(float);
+	const size_t colorSize = colorAsFloat ? 4 * sizeof(float) : 4 * sizeof(uint8_t);
+	const size_t attributeOffset = positionSize + (exportNormals ? normalSize : 0u);
+
 	tinygltf::BufferView gltfIndicesBufferView;
 	gltfIndicesBufferView.buffer = (int)gltfModel.buffers.size();
 	gltfIndicesBufferView.byteOffset = 0;
-	gltfIndicesBufferView.byteLength = indicesBufferByteLen;
+	gltfIndicesBufferView.byteLength =
+		bounds.ni * (primitiveBuffer.shortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
 	gltfIndicesBufferView.target = TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER;
 
 	tinygltf::BufferView gltfVerticesBufferView;
 	gltfVerticesBufferView.buffer = (int)gltfModel.buffers.size();
 	gltfVerticesBufferView.byteOffset = indicesBufferByteLen;
 	gltfVerticesBufferView.byteLength = os.size() - indicesBufferByteLen;
-	gltfVerticesBufferView.byteStride = 3 * sizeof(float);
-	if (exportNormals) {
-		gltfVerticesBufferView.byteStride += 3 * sizeof(float);
-	}
+	gltfVerticesBufferView.byteStride = attributeOffset;
 	if (withTexCoords) {
-		gltfVerticesBufferView.byteStride += 2 * sizeof(float);
+		gltfVerticesBufferView.byteStride += texcoordSize;
 	} else if (withColor) {
-		if (colorAsFloat) {
-			gltfVerticesBufferView.byteStride += 4 * sizeof(float);
-		} else {
-			gltfVerticesBufferView.byteStride += 4 * sizeof(uint8_t);
-		}
+		gltfVerticesBufferView.byteStride += colorSize;
 	}
 	gltfVerticesBufferView.target = TINYGLTF_TARGET_ARRAY_BUFFER;
 
@@ -391,7 +509,8 @@ bool GLTFFormat::savePrimitivesPerMaterial(uint8_t idx, const glm::vec3 &pivotOf
 	tinygltf::Accessor gltfIndicesAccessor;
 	gltfIndicesAccessor.bufferView = (int)gltfModel.bufferViews.size();
 	gltfIndicesAccessor.byteOffset = 0;
-	gltfIndicesAccessor.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
+	gltfIndicesAccessor.componentType =
+		primitiveBuffer.shortIndices ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
 	gltfIndicesAccessor.count = bounds.ni;
 	gltfIndicesAccessor.type = TINYGLTF_TYPE_SCALAR;
 	gltfIndicesAccessor.maxValues.push_back(bounds.maxIndex);
@@ -401,7 +520,8 @@ bool GLTFFormat::savePrimitivesPerMaterial(uint8_t idx, const glm::vec3 &pivotOf
 	tinygltf::Accessor gltfVerticesAccessor;
 	gltfVerticesAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
 	gltfVerticesAccessor.byteOffset = 0;
-	gltfVerticesAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+	gltfVerticesAccessor.componentType =
+		primitiveBuffer.shortPositions ? TINYGLTF_COMPONENT_TYPE_SHORT : TINYGLTF_COMPONENT_TYPE_FLOAT;
 	gltfVerticesAccessor.count = bounds.nv;
 	gltfVerticesAccessor.type = TINYGLTF_TYPE_VEC3;
 	gltfVerticesAccessor.maxValues = {bounds.maxVertex[0], bounds.maxVertex[1], bounds.maxVertex[2]};
@@ -410,27 +530,31 @@ bool GLTFFormat::savePrimitivesPerMaterial(uint8_t idx, const glm::vec3 &pivotOf
 	// Describe the layout of normals - they are followed
 	tinygltf::Accessor gltfNormalAccessor;
 	gltfNormalAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
-	gltfNormalAccessor.byteOffset = 3 * sizeof(float);
-	gltfNormalAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+	gltfNormalAccessor.byteOffset = positionSize;
+	gltfNormalAccessor.componentType = quantized ? TINYGLTF_COMPONENT_TYPE_BYTE : TINYGLTF_COMPONENT_TYPE_FLOAT;
+	gltfNormalAccessor.normalized = quantized;
 	gltfNormalAccessor.count = bounds.nv;
 	gltfNormalAccessor.type = TINYGLTF_TYPE_VEC3;
 
 	tinygltf::Accessor gltfColorAccessor;
 	if (withTexCoords) {
 		gltfColorAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
-		gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+		gltfColorAccessor.componentType =
+			quantized ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : TINYGLTF_COMPONENT_TYPE_FLOAT;
+		gltfColorAccessor.normalized = quantized;
 		gltfColorAccessor.count = bounds.nv;
-		gltfColorAccessor.byteOffset = (exportNormals ? 2 : 1) * 3 * sizeof(float);
+		gltfColorAccessor.byteOffset = attributeOffset;
 		gltfColorAccessor.type = TINYGLTF_TYPE_VEC2;
 	} else if (withColor) {
 		gltfColorAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
 		gltfColorAccessor.count = bounds.nv;
 		gltfColorAccessor.type = TINYGLTF_TYPE_VEC4;
-		gltfColorAccessor.byteOffset = (exportNormals ? 2 : 1) * 3 * sizeof(float);
+		gltfColorAccessor.byteOffset = attributeOffset;
 		if (colorAsFloat) {
 			gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
 		} else {
 			gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+			gltfColorAccessor.normalized = true;
 		}
 	}
 
@@ -664,8 +788,8 @@ void GLTFFormat::generateMaterials(bool withTexCoords, tinygltf::Model &gltfMode
 		const int textureIndex = saveTexture(gltfModel, palette);
 		const int emissiveTextureIndex = saveEmissiveTexture(gltfModel, palette);
 		const bool KHR_materials_pbrSpecularGlossiness =
-			core::Var::getSafe(cfg::VoxFormatGLTF_KHR_materials_pbrSpecularGlossiness)->boolVal();
-		const bool withMaterials = core::Var::getSafe(cfg::VoxFormatWithMaterials)->boolVal();
+			_config.gltfKHRMaterialsPbrSpecularGlossiness;
+		const bool withMaterials = _config.withMaterials;
 
 		core::Array<int, palette::PaletteMaxColors> materialIds;
 		materialIds.fill(-1);
@@ -706,7 +830,7 @@ void GLTFFormat::generateMaterials(bool withTexCoords, tinygltf::Model &gltfMode
 				if (KHR_materials_pbrSpecularGlossiness) {
 					save_KHR_materials_pbrSpecularGlossiness(material, color, gltfMaterial, gltfModel);
 				} else {
-					if (core::Var::getSafe(cfg::VoxFormatGLTF_KHR_materials_specular)->boolVal()) {
+					if (_config.gltfKHRMaterialsSpecular) {
 						save_KHR_materials_specular(material, color, gltfMaterial, gltfModel);
 					}
 					save_KHR_materials_ior(material, gltfMaterial, gltfModel);
@@ -723,9 +847,9 @@ void GLTFFormat::generateMaterials(bool withTexCoords, tinygltf::Model &gltfMode
 	}
 }
 
-bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const scenegraph::SceneGraph &sceneGraph,
-							const Meshes &meshes, const core::String &filename, const io::ArchivePtr &archive,
-							const glm::vec3 &scale, bool quad, bool withColor, bool withTexCoords) {
+bool GLTFFormat::saveMeshStream(const scenegraph::SceneGraph &sceneGraph, MeshStream &meshStream,
+								const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale,
+								bool quad, bool withColor, bool withTexCoords) {
 	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(filename));
 	if (!stream) {
 		Log::error("Could not open file %s", filename.c_str());
@@ -738,14 +862,16 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 	tinygltf::Model gltfModel;
 	tinygltf::Scene gltfScene;
 
-	const bool colorAsFloat = core::Var::get(cfg::VoxformatColorAsFloat)->boolVal();
+	const bool quantize = _config.gltfKHRMeshQuantization;
+	// the quantized colors are normalized bytes
+	const bool colorAsFloat = _config.colorAsFloat && !quantize;
 	if (colorAsFloat) {
 		Log::debug("Export colors as float");
 	} else {
 		Log::debug("Export colors as byte");
 	}
 
-	const size_t modelNodes = meshes.size();
+	const size_t modelNodes = sceneGraph.size(scenegraph::SceneGraphNodeType::AllModels);
 	const core::String &appname = app::App::getInstance()->fullAppname();
 	const core::String &generator = core::string::format("%s " PROJECT_VERSION, appname.c_str());
 	// Define the asset. The version is required
@@ -761,29 +887,47 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 
 	MaterialMap paletteMaterialIndices((int)sceneGraph.size());
 	core::Map<int, int> nodeMapping((int)sceneGraph.nodeSize());
+	// the gltf meshes of the nodes that are sharing their mesh with other nodes - see MeshStream::key()
+	core::Map<int, SharedMeshes> sharedMeshes;
 	while (!stack.empty()) {
 		const int nodeId = stack.back().first;
 		const scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
 		palette::Palette palette = node.palette();
 
-		if (meshIdxNodeMap.find(nodeId) == meshIdxNodeMap.end()) {
+		if (!node.isAnyModelNode()) {
 			saveGltfNode(nodeMapping, gltfModel, gltfScene, node, stack, sceneGraph, scale, false);
 			continue;
 		}
 
-		int meshExtIdx = 0;
-		core_assert_always(meshIdxNodeMap.get(nodeId, meshExtIdx));
-		const MeshExt &meshExt = meshes[meshExtIdx];
+		// the mesh is extracted now and freed as soon as the buffers of the gltf primitives were created
+		voxel::ChunkMesh *chunkMesh = meshStream.acquire(node);
+		if (chunkMesh == nullptr) {
+			meshStream.release(node);
+			saveGltfNode(nodeMapping, gltfModel, gltfScene, node, stack, sceneGraph, scale, false);
+			continue;
+		}
+		const MeshExt meshExt = meshStream.createMeshExt(chunkMesh, node);
+		const int meshKey = meshStream.key(node);
+		auto sharedIter = sharedMeshes.find(meshKey);
+		if (sharedIter != sharedMeshes.end() && sharedIter->value.pivot == meshExt.pivot) {
+			// model references are just new gltf nodes for the already exported meshes
+			for (int meshIdx : sharedIter->value.meshes) {
+				saveGltfNode(nodeMapping, gltfModel, gltfScene, node, stack, sceneGraph, scale, exportAnimations,
+							 meshIdx);
+			}
+			meshStream.release(node);
+			continue;
+		}
+		SharedMeshes shared;
+		shared.pivot = meshExt.pivot;
 
 		int texcoordIndex = 0;
-		if (node.isAnyModelNode()) {
-			for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
-				const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
-				if (mesh->isEmpty()) {
-					continue;
-				}
-				generateMaterials(withTexCoords, gltfModel, paletteMaterialIndices, node, palette, texcoordIndex);
+		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+			const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
+			if (mesh->isEmpty()) {
+				continue;
 			}
+			generateMaterials(withTexCoords, gltfModel, paletteMaterialIndices, node, palette, texcoordIndex);
 		}
 
 		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
@@ -813,19 +957,47 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 			const glm::vec3 &offset = mesh->getOffset();
 			const glm::vec3 pivotOffset = offset - meshExt.pivot * meshExt.size;
 
-			tinygltf::Mesh gltfMesh;
-			gltfMesh.name = objectName;
+			// only the colors that are used by the mesh get a primitive
+			core::Array<bool, palette::PaletteMaxColors> usedColors;
+			usedColors.fill(false);
+			const voxel::VertexArray &vertices = mesh->getVertexVector();
+			const voxel::IndexArray &indices = mesh->getIndexVector();
+			for (int j = 0; j < ni; ++j) {
+				usedColors[vertices[indices[j]].colorIndex] = true;
+			}
+			core::DynamicArray<uint8_t> colorIndices;
 			for (int j = 0; j < palette.colorCount(); ++j) {
-				if (palette.color(j).a == 0) {
+				if (palette.color(j).a == 0 || !usedColors[j]) {
 					continue;
 				}
-				savePrimitivesPerMaterial(j, pivotOffset, gltfModel, gltfMesh, mesh, palette, withColor, withTexCoords,
-										  colorAsFloat, exportNormals, meshExt.applyTransform, texcoordIndex,
+				colorIndices.push_back(j);
+			}
+
+			// serialize the buffers of the primitives in parallel and add them in the order of the colors
+			core::DynamicArray<PrimitiveBuffer> primitiveBuffers;
+			primitiveBuffers.resize(colorIndices.size());
+			decodeParallel(colorIndices.size(), [&](size_t n) {
+				return writePrimitiveBuffer(colorIndices[n], pivotOffset, mesh, palette, withColor, withTexCoords,
+											colorAsFloat, exportNormals, meshExt.applyTransform, quantize,
+											primitiveBuffers[n]);
+			});
+
+			tinygltf::Mesh gltfMesh;
+			gltfMesh.name = objectName;
+			for (size_t j = 0; j < colorIndices.size(); ++j) {
+				savePrimitivesPerMaterial(colorIndices[j], gltfModel, gltfMesh, primitiveBuffers[j], palette,
+										  withColor, withTexCoords, colorAsFloat, exportNormals, texcoordIndex,
 										  paletteMaterialIndices);
+				// the data was copied into the gltf buffer
+				primitiveBuffers[j] = PrimitiveBuffer();
 			}
-			saveGltfNode(nodeMapping, gltfModel, gltfScene, node, stack, sceneGraph, scale, exportAnimations);
+			const int meshIdx = (int)gltfModel.meshes.size();
+			saveGltfNode(nodeMapping, gltfModel, gltfScene, node, stack, sceneGraph, scale, exportAnimations, meshIdx);
 			gltfModel.meshes.emplace_back(core::move(gltfMesh));
+			shared.meshes.push_back(meshIdx);
 		}
+		meshStream.release(node);
+		sharedMeshes.put(meshKey, shared);
 	}
 
 	if (exportAnimations) {
@@ -845,6 +1017,11 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 		Log::debug("No animations found");
 	}
 
+	if (quantize && !gltfModel.meshes.empty()) {
+		addExtension(gltfModel, "KHR_mesh_quantization");
+		gltfModel.extensionsRequired.push_back("KHR_mesh_quantization");
+	}
+
 	gltfModel.scenes.emplace_back(core::move(gltfScene));
 	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Camera); iter != sceneGraph.end(); ++iter) {
 		tinygltf::Camera gltfCamera = _priv::processCamera(toCameraNode(*iter));
@@ -1120,13 +1297,100 @@ bool GLTFFormat::loadIndices(const tinygltf::Model &gltfModel, const tinygltf::P
 	return true;
 }
 
-void GLTFFormat::loadTexture(const core::String &filename, const io::ArchivePtr &archive,
-							 const tinygltf::Model &gltfModel, GltfMaterialData &materialData,
-							 const tinygltf::TextureInfo &gltfTextureInfo, const int textureIndex) const {
+image::ImagePtr GLTFFormat::loadTextureImage(const core::String &filename, const io::ArchivePtr &archive,
+											 const tinygltf::Model &gltfModel, int imageIndex) const {
+	const tinygltf::Image &gltfImage = gltfModel.images[imageIndex];
+	Log::debug("Image '%s': components: %i, width: %i, height: %i, bits: %i", gltfImage.uri.c_str(),
+			   gltfImage.component, gltfImage.width, gltfImage.height, gltfImage.bits);
+	if (!gltfImage.uri.empty()) {
+		core::String name = gltfImage.uri.c_str();
+		image::ImagePtr tex = image::loadImage(name);
+		if (!tex->isLoaded()) {
+			name = lookupTexture(filename, name, archive, _config.texturePath);
+			tex = image::loadImage(name);
+			if (tex->isLoaded()) {
+				Log::debug("Use image %s", name.c_str());
+			} else {
+				Log::warn("Failed to load %s", name.c_str());
+			}
+		}
+		return tex;
+	}
+	core::String name = gltfImage.name.c_str();
+	if (name.empty()) {
+		name = core::string::format("image%i", imageIndex);
+	}
+	if (gltfImage.bufferView >= 0 && gltfImage.bufferView < (int)gltfModel.bufferViews.size()) {
+		const tinygltf::BufferView &gltfImgBufferView = gltfModel.bufferViews[gltfImage.bufferView];
+		if (gltfImgBufferView.buffer < 0 || gltfImgBufferView.buffer >= (int)gltfModel.buffers.size()) {
+			Log::warn("Invalid buffer index for image: %i", gltfImgBufferView.buffer);
+			return image::ImagePtr();
+		}
+		const tinygltf::Buffer &gltfImgBuffer = gltfModel.buffers[gltfImgBufferView.buffer];
+		const size_t offset = gltfImgBufferView.byteOffset;
+		const uint8_t *buf = gltfImgBuffer.data.data() + offset;
+		image::ImagePtr tex = image::createEmptyImage(name.c_str());
+		if (!tex->load(buf, (int)gltfImgBufferView.byteLength)) {
+			Log::warn("Failed to load embedded image %s", name.c_str());
+		} else {
+			Log::debug("Loaded embedded image %s", name.c_str());
+		}
+		return tex;
+	}
+	if (gltfImage.image.empty()) {
+		Log::warn("Invalid buffer view index for image: %i", gltfImage.bufferView);
+		return image::ImagePtr();
+	}
+	image::ImagePtr tex = image::createEmptyImage(name);
+	if (gltfImage.as_is) {
+		// data uris are not decoded by tinygltf - see SetImagesAsIs()
+		if (!tex->load(gltfImage.image.data(), (int)gltfImage.image.size())) {
+			Log::warn("Failed to load embedded image %s", name.c_str());
+		}
+	} else if (gltfImage.component == 4) {
+		core_assert(gltfImage.image.size() == (size_t)(gltfImage.width * gltfImage.height * gltfImage.component));
+		tex->loadRGBA(gltfImage.image.data(), gltfImage.width, gltfImage.height);
+		Log::debug("Use image %s", name.c_str());
+	} else {
+		Log::warn("Failed to load image with %i components", gltfImage.component);
+		return image::ImagePtr();
+	}
+	return tex;
+}
+
+void GLTFFormat::loadTextureImages(const core::String &filename, const io::ArchivePtr &archive,
+								   const tinygltf::Model &gltfModel, core::DynamicArray<image::ImagePtr> &images) const {
+	images.resize(gltfModel.images.size());
+	// only decode the images that are used as base color texture - and each of them only once
+	core::DynamicArray<int> imageIndices;
+	core::DynamicArray<bool> used;
+	used.resize(gltfModel.images.size());
+	for (const tinygltf::Material &gltfMaterial : gltfModel.materials) {
+		const int textureIndex = gltfMaterial.pbrMetallicRoughness.baseColorTexture.index;
+		if (textureIndex < 0 || textureIndex >= (int)gltfModel.textures.size()) {
+			continue;
+		}
+		const int imageIndex = gltfModel.textures[textureIndex].source;
+		if (imageIndex < 0 || imageIndex >= (int)gltfModel.images.size() || used[imageIndex]) {
+			continue;
+		}
+		used[imageIndex] = true;
+		imageIndices.push_back(imageIndex);
+	}
+	decodeParallel(imageIndices.size(), [&](size_t n) {
+		const int imageIndex = imageIndices[n];
+		images[imageIndex] = loadTextureImage(filename, archive, gltfModel, imageIndex);
+		return true;
+	});
+}
+
+void GLTFFormat::loadTexture(const tinygltf::Model &gltfModel, const core::DynamicArray<image::ImagePtr> &images,
+							 GltfMaterialData &materialData, const tinygltf::TextureInfo &gltfTextureInfo,
+							 const int textureIndex) const {
 	int texCoordIndex = 0;
 	const tinygltf::Texture &gltfTexture = gltfModel.textures[textureIndex];
 	MeshMaterialPtr &meshMaterial = materialData.meshMaterial;
-	if (gltfTexture.source >= 0 && gltfTexture.source < (int)gltfModel.images.size()) {
+	if (gltfTexture.source >= 0 && gltfTexture.source < (int)images.size()) {
 		if (gltfTexture.sampler >= 0 && gltfTexture.sampler < (int)gltfModel.samplers.size()) {
 			const tinygltf::Sampler &gltfTextureSampler = gltfModel.samplers[gltfTexture.sampler];
 			Log::debug("Sampler: '%s', wrapS: %i, wrapT: %i", gltfTextureSampler.name.c_str(), gltfTextureSampler.wrapS,
@@ -1134,60 +1398,11 @@ void GLTFFormat::loadTexture(const core::String &filename, const io::ArchivePtr
 			meshMaterial->wrapS = _priv::convertTextureWrap(gltfTextureSampler.wrapS);
 			meshMaterial->wrapT = _priv::convertTextureWrap(gltfTextureSampler.wrapT);
 		}
-		const tinygltf::Image &gltfImage = gltfModel.images[gltfTexture.source];
-		Log::debug("Image '%s': components: %i, width: %i, height: %i, bits: %i", gltfImage.uri.c_str(),
-				   gltfImage.component, gltfImage.width, gltfImage.height, gltfImage.bits);
-		if (gltfImage.uri.empty()) {
-			if (gltfImage.bufferView >= 0 && gltfImage.bufferView < (int)gltfModel.bufferViews.size()) {
-				const tinygltf::BufferView &gltfImgBufferView = gltfModel.bufferViews[gltfImage.bufferView];
-				if (gltfImgBufferView.buffer >= 0 && gltfImgBufferView.buffer < (int)gltfModel.buffers.size()) {
-					const tinygltf::Buffer &gltfImgBuffer = gltfModel.buffers[gltfImgBufferView.buffer];
-					const size_t offset = gltfImgBufferView.byteOffset;
-					const uint8_t *buf = gltfImgBuffer.data.data() + offset;
-					core::String name = gltfImage.name.c_str();
-					if (name.empty()) {
-						name = core::string::format("image%i", gltfTexture.source);
-					}
-					image::ImagePtr tex = image::createEmptyImage(name.c_str());
-					if (!tex->load(buf, (int)gltfImgBufferView.byteLength)) {
-						Log::warn("Failed to load embedded image %s", name.c_str());
-					} else {
-						Log::debug("Loaded embedded image %s", name.c_str());
-					}
-					meshMaterial->texture = tex;
-				} else {
-					Log::warn("Invalid buffer index for image: %i", gltfImgBufferView.buffer);
-				}
-			} else if (!gltfImage.image.empty()) {
-				if (gltfImage.component == 4) {
-					core::String name = gltfImage.name.c_str();
-					if (name.empty()) {
-						name = core::string::format("image%i", gltfTexture.source);
-					}
-					meshMaterial->texture = image::createEmptyImage(name);
-					core_assert(gltfImage.image.size() ==
-								(size_t)(gltfImage.width * gltfImage.height * gltfImage.component));
-					meshMaterial->texture->loadRGBA(gltfImage.image.data(), gltfImage.width, gltfImage.height);
-					Log::debug("Use image %s", name.c_str());
-					texCoordIndex = gltfTextureInfo.texCoord;
-				} else {
-					Log::warn("Failed to load image with %i components", gltfImage.component);
-				}
-			} else {
-				Log::warn("Invalid buffer view index for image: %i", gltfImage.bufferView);
-			}
-		} else {
-			core::String name = gltfImage.uri.c_str();
-			meshMaterial->texture = image::loadImage(name);
-			if (!meshMaterial->texture->isLoaded()) {
-				name = lookupTexture(filename, name, archive);
-				meshMaterial->texture = image::loadImage(name);
-				if (meshMaterial->texture->isLoaded()) {
-					Log::debug("Use image %s", name.c_str());
-					texCoordIndex = gltfTextureInfo.texCoord;
-				} else {
-					Log::warn("Failed to load %s", name.c_str());
-				}
+		const image::ImagePtr &tex = images[gltfTexture.source];
+		if (tex) {
+			meshMaterial->texture = tex;
+			if (tex->isLoaded()) {
+				texCoordIndex = gltfTextureInfo.texCoord;
 			}
 		}
 	} else {
@@ -1311,14 +1526,13 @@ void GLTFFormat::load_KHR_materials_emissive_strength(palette::Material &materia
 					  material.value(palette::MaterialProperty::MaterialEmit) * strength);
 }
 
-bool GLTFFormat::loadMaterial(const core::String &filename, const io::ArchivePtr &archive,
-							  const tinygltf::Model &gltfModel, const tinygltf::Material &gltfMaterial,
-							  GltfMaterialData &materialData) const {
+bool GLTFFormat::loadMaterial(const tinygltf::Model &gltfModel, const core::DynamicArray<image::ImagePtr> &images,
+							  const tinygltf::Material &gltfMaterial, GltfMaterialData &materialData) const {
 	MeshMaterialPtr &meshMaterial = materialData.meshMaterial;
 	meshMaterial->name = gltfMaterial.name.c_str();
 	const tinygltf::TextureInfo &gltfTextureInfo = gltfMaterial.pbrMetallicRoughness.baseColorTexture;
 	if (gltfTextureInfo.index != -1 && gltfTextureInfo.index < (int)gltfModel.textures.size()) {
-		loadTexture(filename, archive, gltfModel, materialData, gltfTextureInfo, gltfTextureInfo.index);
+		loadTexture(gltfModel, images, materialData, gltfTextureInfo, gltfTextureInfo.index);
 	} else {
 		Log::debug("Invalid texture index given %i", gltfTextureInfo.index);
 	}
@@ -1374,34 +1588,32 @@ bool GLTFFormat::loadAttributes(const core::String &filename, const tinygltf::Mo
 				   (int)stride);
 		const uint8_t *buf = gltfAttributeBuffer.data.data() + offset;
 		if (attrType == "POSITION") {
-			if (gltfAttributeAccessor->componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) {
-				Log::debug("Skip non float type for %s", attrType.c_str());
-				continue;
-			}
-			foundPositions = gltfAttributeAccessor->count;
 			core_assert(gltfAttributeAccessor->type == TINYGLTF_TYPE_VEC3);
+			foundPositions = gltfAttributeAccessor->count;
 			for (size_t i = 0; i < gltfAttributeAccessor->count; i++) {
-				io::MemoryReadStream posStream(buf, stride);
 				glm::vec3 pos;
-				posStream.readFloat(pos.x);
-				posStream.readFloat(pos.y);
-				posStream.readFloat(pos.z);
+				if (!_priv::toFloats(gltfAttributeAccessor, buf, stride, glm::value_ptr(pos), 3)) {
+					Log::debug("Skip unsupported type (%i) for %s", gltfAttributeAccessor->componentType,
+							   attrType.c_str());
+					foundPositions = 0;
+					break;
+				}
 				vertices[verticesOffset + i].pos = pos;
 				vertices[verticesOffset + i].meshMaterial = gltfMaterial.meshMaterial;
 				buf += stride;
 			}
 		} else if (attrType == gltfMaterial.texCoordAttribute.c_str()) {
-			if (gltfAttributeAccessor->componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) {
-				Log::debug("Skip non float type (%i) for %s", gltfAttributeAccessor->componentType, attrType.c_str());
-				continue;
-			}
 			core_assert(gltfAttributeAccessor->type == TINYGLTF_TYPE_VEC2);
+			const bool isFloat = gltfAttributeAccessor->componentType == TINYGLTF_COMPONENT_TYPE_FLOAT;
 			for (size_t i = 0; i < gltfAttributeAccessor->count; i++) {
-				io::MemoryReadStream uvStream(buf, stride);
 				glm::vec2 uv;
-				uvStream.readFloat(uv.x);
-				uvStream.readFloat(uv.y);
-				if (!gltfAttributeAccessor->normalized) {
+				if (!_priv::toFloats(gltfAttributeAccessor, buf, stride, glm::value_ptr(uv), 2)) {
+					Log::debug("Skip unsupported type (%i) for %s", gltfAttributeAccessor->componentType,
+							   attrType.c_str());
+					break;
+				}
+				// the quantized coordinates are flipped like the float coordinates
+				if (!isFloat || !gltfAttributeAccessor->normalized) {
 					uv.y = 1.0f - uv.y;
 				}
 				vertices[verticesOffset + i].uv = uv;
@@ -1425,6 +1637,53 @@ bool GLTFFormat::loadAttributes(const core::String &filename, const tinygltf::Mo
 	return foundPositions > 0;
 }
 
+void GLTFFormat::loadPrimitive(const core::String &filename, const tinygltf::Model &gltfModel,
+							   const core::DynamicArray<GltfMaterialData> &materials,
+							   const tinygltf::Primitive &gltfPrimitive, GltfPrimitiveData &primitiveData) const {
+	core::DynamicArray<GltfVertex> &vertices = primitiveData.vertices;
+	core::DynamicArray<uint32_t> &indices = primitiveData.indices;
+	primitiveData.validVertices = loadAttributes(filename, gltfModel, materials, gltfPrimitive, vertices);
+	if (!primitiveData.validVertices || gltfPrimitive.mode == TINYGLTF_MODE_POINTS) {
+		return;
+	}
+	if (gltfPrimitive.indices == -1) {
+		if (gltfPrimitive.mode != TINYGLTF_MODE_TRIANGLES) {
+			Log::warn("Unexpected primitive mode for assembling the indices: %i", gltfPrimitive.mode);
+			primitiveData.validIndices = false;
+			return;
+		}
+		indices.resize(vertices.size());
+		for (size_t i = 0; i < indices.size(); ++i) {
+			indices[i] = (uint32_t)i;
+		}
+	} else if (!loadIndices(gltfModel, gltfPrimitive, indices, 0)) {
+		Log::warn("Failed to load indices");
+		primitiveData.validIndices = false;
+		return;
+	}
+	if (vertices.empty() || indices.size() % 3 != 0) {
+		return;
+	}
+
+	const glm::vec3 &scale = getInputScale();
+	const size_t maxIndices = indices.size();
+	MeshTriCollection &tris = primitiveData.tris;
+	tris.reserve(maxIndices / 3);
+	for (size_t indexOffset = 0; indexOffset < maxIndices; indexOffset += 3) {
+		voxelformat::MeshTri meshTri;
+		for (size_t i = 0; i < 3; ++i) {
+			const size_t idx = indices[i + indexOffset];
+			meshTri.vertices[i] = vertices[idx].pos * scale;
+			meshTri.uv[i] = vertices[idx].uv;
+			meshTri.color[i] = vertices[idx].color;
+		}
+		const size_t textureIdx = indices[indexOffset];
+		const GltfVertex &v = vertices[textureIdx];
+		meshTri.material = v.meshMaterial;
+		tris.push_back(meshTri);
+	}
+}
+
 bool GLTFFormat::loadAnimationChannel(const tinygltf::Model &gltfModel, const tinygltf::Animation &gltfAnimation,
 									  const tinygltf::AnimationChannel &gltfAnimChannel,
 									  scenegraph::SceneGraphNode &node) const {
@@ -1627,16 +1886,24 @@ bool GLTFFormat::loadNode_r(const core::String &filename, scenegraph::SceneGraph
 
 	Log::debug("Mesh node %i", gltfNodeIdx);
 
-	const glm::vec3 &scale = getInputScale();
 	MeshTriCollection tris;
 
 	const tinygltf::Mesh &gltfMesh = gltfModel.meshes[gltfNode.mesh];
 	Log::debug("Primitives: %i in mesh %i", (int)gltfMesh.primitives.size(), gltfNode.mesh);
 
-	for (const tinygltf::Primitive &primitive : gltfMesh.primitives) {
-		core::DynamicArray<uint32_t> indices;
-		core::DynamicArray<GltfVertex> vertices;
-		if (!loadAttributes(filename, gltfModel, materials, primitive, vertices)) {
+	// convert the accessors of all primitives in parallel - the scene graph is assembled in order afterwards
+	core::DynamicArray<GltfPrimitiveData> primitives;
+	primitives.resize(gltfMesh.primitives.size());
+	decodeParallel(primitives.size(), [&](size_t n) {
+		loadPrimitive(filename, gltfModel, materials, gltfMesh.primitives[n], primitives[n]);
+		return true;
+	});
+
+	for (size_t p = 0; p < primitives.size(); ++p) {
+		const tinygltf::Primitive &primitive = gltfMesh.primitives[p];
+		GltfPrimitiveData &primitiveData = primitives[p];
+		const core::DynamicArray<GltfVertex> &vertices = primitiveData.vertices;
+		if (!primitiveData.validVertices) {
 			Log::warn("Failed to load vertices");
 			continue;
 		}
@@ -1669,20 +1936,10 @@ bool GLTFFormat::loadNode_r(const core::String &filename, scenegraph::SceneGraph
 			for (int childId : gltfNode.children) {
 				loadNode_r(filename, sceneGraph, gltfModel, materials, childId, nodeId);
 			}
-		} else if (primitive.indices == -1) {
-			if (primitive.mode == TINYGLTF_MODE_TRIANGLES) {
-				const size_t indicedEnd = vertices.size();
-				for (size_t i = 0; i < indicedEnd; ++i) {
-					indices.push_back((uint32_t)i);
-				}
-			} else {
-				Log::warn("Unexpected primitive mode for assembling the indices: %i", primitive.mode);
-				return false;
-			}
-		} else if (!loadIndices(gltfModel, primitive, indices, 0)) {
-			Log::warn("Failed to load indices");
+		} else if (!primitiveData.validIndices) {
 			return false;
 		}
+		const core::DynamicArray<uint32_t> &indices = primitiveData.indices;
 		// skip empty meshes
 		if (indices.empty() || vertices.empty()) {
 			Log::debug("No indices (%i) or vertices (%i) found for mesh %i", (int)indices.size(), (int)vertices.size(),
@@ -1700,21 +1957,8 @@ bool GLTFFormat::loadNode_r(const core::String &filename, scenegraph::SceneGraph
 			return false;
 		}
 
-		const size_t maxIndices = indices.size();
-		tris.reserve(tris.size() + maxIndices / 3);
-		for (size_t indexOffset = 0; indexOffset < maxIndices; indexOffset += 3) {
-			voxelformat::MeshTri meshTri;
-			for (size_t i = 0; i < 3; ++i) {
-				const size_t idx = indices[i + indexOffset];
-				meshTri.vertices[i] = vertices[idx].pos * scale;
-				meshTri.uv[i] = vertices[idx].uv;
-				meshTri.color[i] = vertices[idx].color;
-			}
-			const size_t textureIdx = indices[indexOffset];
-			const GltfVertex &v = vertices[textureIdx];
-			meshTri.material = v.meshMaterial;
-			tris.push_back(meshTri);
-		}
+		tris.append(primitiveData.tris);
+		primitiveData = GltfPrimitiveData();
 	}
 
 	const int nodeId = voxelizeNode(gltfNode.name.c_str(), sceneGraph, tris, parentNodeId, false);
@@ -1758,6 +2002,8 @@ bool GLTFFormat::voxelizeGroups(const core::String &filename, const io::ArchiveP
 
 	const core::String filePath = core::string::extractDir(filename);
 	tinygltf::TinyGLTF gltfLoader;
+	// the images are decoded in parallel by loadTextureImages()
+	gltfLoader.SetImagesAsIs(true);
 	tinygltf::Model gltfModel;
 	if (magic == FourCC('g', 'l', 'T', 'F')) {
 		Log::debug("Detected binary gltf stream");
@@ -1792,11 +2038,14 @@ bool GLTFFormat::voxelizeGroups(const core::String &filename, const io::ArchiveP
 	Log::debug("Lights: %i", (int)gltfModel.lights.size());
 	const int parentNodeId = sceneGraph.root().id();
 
+	core::DynamicArray<image::ImagePtr> images;
+	loadTextureImages(filename, archive, gltfModel, images);
+
 	core::DynamicArray<GltfMaterialData> materials;
 	materials.resize(gltfModel.materials.size());
 	for (size_t i = 0; i < gltfModel.materials.size(); ++i) {
 		const tinygltf::Material &gltfMaterial = gltfModel.materials[i];
-		loadMaterial(filename, archive, gltfModel, gltfMaterial, materials[i]);
+		loadMaterial(gltfModel, images, gltfMaterial, materials[i]);
 	}
 
 	scenegraph::SceneGraphNode &root = sceneGraph.node(parentNodeId);
@@ -84,21 +84,61 @@ private:
 	void createPointMesh(tinygltf::Model &gltfModel, const scenegraph::SceneGraphNode &node) const;
 	using Stack = core::DynamicArray<core::Pair<int, int>>;
 	using MaterialMap = core::Map<uint64_t, core::Array<int, palette::PaletteMaxColors>>;
+	/**
+	 * @brief The gltf meshes of a node that can be used by the nodes that are sharing the same mesh
+	 */
+	struct SharedMeshes {
+		glm::vec3 pivot{0.0f};
+		core::DynamicArray<int> meshes;
+	};
+	/**
+	 * @param meshIdx The index of the gltf mesh of the node or @c -1 if the node doesn't have a mesh
+	 */
 	void saveGltfNode(core::Map<int, int> &nodeMapping, tinygltf::Model &gltfModel, tinygltf::Scene &gltfScene,
 					  const scenegraph::SceneGraphNode &graphNode, Stack &stack,
-					  const scenegraph::SceneGraph &sceneGraph, const glm::vec3 &scale, bool exportAnimations);
-	uint32_t writeBuffer(const voxel::Mesh *mesh, uint8_t idx, io::SeekableWriteStream &os, bool withColor,
-						 bool withTexCoords, bool colorAsFloat, bool exportNormals, bool applyTransform,
-						 const glm::vec3 &pivotOffset, const palette::Palette &palette, Bounds &bounds);
+					  const scenegraph::SceneGraph &sceneGraph, const glm::vec3 &scale, bool exportAnimations,
+					  int meshIdx = -1);
+	/**
+	 * @brief The serialized indices and vertices of the primitive for one color of a mesh
+	 */
+	struct PrimitiveBuffer {
+		core::SharedPtr<io::BufferedReadWriteStream> stream;
+		// the size of the indices including the padding - the vertices are following
+		uint32_t indicesBufferByteLen = 0u;
+		Bounds bounds;
+		// the primitive uses less than 65535 vertices
+		bool shortIndices = false;
+		// KHR_mesh_quantization - the normals and texture coordinates are normalized integers
+		bool quantized = false;
+		// KHR_mesh_quantization - all positions are whole numbers in the range of a short
+		bool shortPositions = false;
+	};
+	/**
+	 * @brief Writes the triangles of the given color and only the vertices they are using - in the order of their first
+	 * use
+	 * @return The size of the indices including the padding or @c 0 if there is no triangle for the given color
+	 */
+	static uint32_t writeBuffer(const voxel::Mesh *mesh, uint8_t idx, bool withColor, bool withTexCoords,
+								bool colorAsFloat, bool exportNormals, bool applyTransform, bool quantize,
+								const glm::vec3 &pivotOffset, const palette::Palette &palette,
+								PrimitiveBuffer &primitiveBuffer);
+	/**
+	 * @note This is called in parallel for the colors of a mesh
+	 * @return @c false if the mesh doesn't have any triangle for the given color
+	 */
+	static bool writePrimitiveBuffer(uint8_t idx, const glm::vec3 &pivotOffset, const voxel::Mesh *mesh,
+									 const palette::Palette &palette, bool withColor, bool withTexCoords,
+									 bool colorAsFloat, bool exportNormals, bool applyTransform, bool quantize,
+									 PrimitiveBuffer &primitiveBuffer);
 	int saveEmissiveTexture(tinygltf::Model &gltfModel, const palette::Palette &palette) const;
 	int saveTexture(tinygltf::Model &gltfModel, const palette::Palette &palette) const;
 	void generateMaterials(bool withTexCoords, tinygltf::Model &gltfModel, MaterialMap &paletteMaterialIndices,
 						   const scenegraph::SceneGraphNode &node, const palette::Palette &palette,
 						   int &texcoordIndex) const;
-	bool savePrimitivesPerMaterial(uint8_t idx, const glm::vec3 &pivotOffset, tinygltf::Model &gltfModel,
-								   tinygltf::Mesh &gltfMesh, const voxel::Mesh *mesh, const palette::Palette &palette,
+	bool savePrimitivesPerMaterial(uint8_t idx, tinygltf::Model &gltfModel, tinygltf::Mesh &gltfMesh,
+								   const PrimitiveBuffer &primitiveBuffer, const palette::Palette &palette,
 								   bool withColor, bool withTexCoords, bool colorAsFloat, bool exportNormals,
-								   bool applyTransform, int texcoordIndex, const MaterialMap &paletteMaterialIndices);
+								   int texcoordIndex, const MaterialMap &paletteMaterialIndices);
 
 	void saveAnimation(int targetNode, tinygltf::Model &m, const scenegraph::SceneGraphNode &node,
 					   tinygltf::Animation &gltfAnimation);
@@ -115,11 +155,38 @@ private:
 		core::String texCoordAttribute;
 		MeshMaterialPtr meshMaterial;
 	};
-	void loadTexture(const core::String &filename, const io::ArchivePtr &archive, const tinygltf::Model &gltfModel,
+	/**
+	 * @brief The converted accessors of a gltf primitive
+	 */
+	struct GltfPrimitiveData {
+		core::DynamicArray<GltfVertex> vertices;
+		core::DynamicArray<uint32_t> indices;
+		MeshTriCollection tris;
+		// the primitive is skipped if the vertices could not be loaded
+		bool validVertices = false;
+		// the node is not loaded if the indices could not be assembled
+		bool validIndices = true;
+	};
+	image::ImagePtr loadTextureImage(const core::String &filename, const io::ArchivePtr &archive,
+									 const tinygltf::Model &gltfModel, int imageIndex) const;
+	/**
+	 * @brief Decodes the images of the base color textures of all materials in parallel
+	 * @param[out] images The decoded images by gltf image index - unused images stay empty
+	 */
+	void loadTextureImages(const core::String &filename, const io::ArchivePtr &archive,
+						   const tinygltf::Model &gltfModel, core::DynamicArray<image::ImagePtr> &images) const;
+	void loadTexture(const tinygltf::Model &gltfModel, const core::DynamicArray<image::ImagePtr> &images,
 					 GltfMaterialData &materialData, const tinygltf::TextureInfo &gltfTextureInfo,
 					 int textureIndex) const;
-	bool loadMaterial(const core::String &filename, const io::ArchivePtr &archive, const tinygltf::Model &gltfModel,
+	bool loadMaterial(const tinygltf::Model &gltfModel, const core::DynamicArray<image::ImagePtr> &images,
 					  const tinygltf::Material &gltfMaterial, GltfMaterialData &materialData) const;
+	/**
+	 * @brief Converts the vertices and indices of the primitive into triangles
+	 * @note This is called in parallel for the primitives of a mesh
+	 */
+	void loadPrimitive(const core::String &filename, const tinygltf::Model &gltfModel,
+					   const core::DynamicArray<GltfMaterialData> &materials, const tinygltf::Primitive &gltfPrimitive,
+					   GltfPrimitiveData &primitiveData) const;
 	bool loadAttributes(const core::String &filename, const tinygltf::Model &gltfModel,
 						const core::DynamicArray<GltfMaterialData> &materials, const tinygltf::Primitive &gltfPrimitive,
 						core::DynamicArray<GltfVertex> &vertices) const;
@@ -141,9 +208,12 @@ private:
 						const LoadContext &ctx) override;
 
 public:
-	bool saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const scenegraph::SceneGraph &sceneGraph,
-					const Meshes &meshes, const core::String &filename, const io::ArchivePtr &archive,
-					const glm::vec3 &scale, bool quad, bool withColor, bool withTexCoords) override;
+	/**
+	 * @note The model references are exported as gltf nodes that are using the meshes of the referenced models
+	 */
+	bool saveMeshStream(const scenegraph::SceneGraph &sceneGraph, MeshStream &meshStream,
+						const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale, bool quad,
+						bool withColor, bool withTexCoords) override;
 
 	static const io::FormatDescription &format() {
 		static io::FormatDescription f{"GL Transmission Format",
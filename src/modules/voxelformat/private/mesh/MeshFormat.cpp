@@ -4,17 +4,16 @@
 
 #include "MeshFormat.h"
 #include "app/App.h"
-#include "app/Async.h"
+#include "core/Algorithm.h"
+#include "core/ArrayLength.h"
 #include "core/Color.h"
 #include "core/GLM.h"
-#include "core/ConfigVar.h"
 #include "core/Log.h"
 #include "core/RGBA.h"
 #include "core/StringUtil.h"
-#include "core/Var.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Map.h"
-#include "core/concurrent/Lock.h"
+#include "core/concurrent/Parallel.h"
 #include "io/Archive.h"
 #include "palette/NormalPalette.h"
 #include "palette/PaletteLookup.h"
@@ -35,10 +34,6 @@
 
 namespace voxelformat {
 
-MeshFormat::MeshFormat() {
-	_weightedAverage = core::Var::getSafe(cfg::VoxformatRGBWeightedAverage)->boolVal();
-}
-
 MeshFormat::MeshExt *MeshFormat::getParent(const scenegraph::SceneGraph &sceneGraph, MeshFormat::Meshes &meshes,
 										   int nodeId) {
 	if (!sceneGraph.hasNode(nodeId)) {
@@ -53,12 +48,12 @@ MeshFormat::MeshExt *MeshFormat::getParent(const scenegraph::SceneGraph &sceneGr
 	return nullptr;
 }
 
-glm::vec3 MeshFormat::getInputScale() {
-	const float scale = core::Var::getSafe(cfg::VoxformatScale)->floatVal();
+glm::vec3 MeshFormat::getInputScale() const {
+	const float scale = _config.scale;
 
-	float scaleX = core::Var::getSafe(cfg::VoxformatScaleX)->floatVal();
-	float scaleY = core::Var::getSafe(cfg::VoxformatScaleY)->floatVal();
-	float scaleZ = core::Var::getSafe(cfg::VoxformatScaleZ)->floatVal();
+	float scaleX = _config.scaleX;
+	float scaleY = _config.scaleY;
+	float scaleZ = _config.scaleZ;
 
 	scaleX = glm::epsilonNotEqual(scaleX, 1.0f, glm::epsilon<float>()) ? scaleX : scale;
 	scaleY = glm::epsilonNotEqual(scaleY, 1.0f, glm::epsilon<float>()) ? scaleY : scale;
@@ -111,13 +106,16 @@ void MeshFormat::addToPosMap(PosMap &posMap, core::RGBA rgba, uint32_t area, uin
 	if (rgba.a <= AlphaThreshold) {
 		return;
 	}
-	auto iter = posMap.find(pos);
-	if (iter == posMap.end()) {
-		posMap.emplace(pos, {area, rgba, normalIdx, material});
-	} else {
-		PosSampling &posSampling = iter->value;
-		posSampling.add(area, rgba, normalIdx, material);
-	}
+	posMap.add(pos, area, rgba, normalIdx, material);
+}
+
+static inline glm::ivec3 voxelPos(const voxel::Region &region, const voxelformat::MeshTri &meshTri) {
+	glm::vec3 c = meshTri.center();
+	convertToVoxelGrid(c);
+	const glm::ivec3 p(c);
+	core_assert_msg(region.containsPoint(p), "Failed to transform tri %i:%i:%i (region: %s)", p.x, p.y, p.z,
+					region.toString().c_str());
+	return p;
 }
 
 void MeshFormat::transformTris(const voxel::Region &region, const MeshTriCollection &tris, PosMap &posMap,
@@ -132,18 +130,226 @@ void MeshFormat::transformTris(const voxel::Region &region, const MeshTriCollect
 			continue;
 		}
 		const uint32_t area = (uint32_t)(meshTri.area() * 1000.0f);
-		glm::vec3 c = meshTri.center();
-		convertToVoxelGrid(c);
-
 		const uint8_t normalIdx = normalPalette.getClosestMatch(meshTri.normal());
+		addToPosMap(posMap, rgba, area, normalIdx, voxelPos(region, meshTri), meshTri.material);
+	}
+}
+
+namespace {
+/**
+ * @brief The contribution of a subdivided triangle to a voxel position
+ */
+struct PosContribution {
+	glm::ivec3 pos;
+	uint32_t area;
+	core::RGBA rgba;
+	uint8_t normalIdx;
+	/** the index of the input triangle to look up the material */
+	uint32_t triIdx;
+};
+using PosContributions = core::DynamicArray<PosContribution>;
+} // namespace
+
+void MeshFormat::generateMipmaps(const MeshTriCollection &tris) {
+	const MeshMaterial *last = nullptr;
+	for (const voxelformat::MeshTri &meshTri : tris) {
+		// the triangles of a material are usually stored next to each other
+		if (!meshTri.material || meshTri.material.get() == last) {
+			continue;
+		}
+		last = meshTri.material.get();
+		meshTri.material->generateMipmaps();
+	}
+}
+
+voxel::Region MeshFormat::shardRegion(const voxel::Region &region, int shard) {
+	// a position belongs to the slice (x - lowerX) * PosMapShards / width
+	const int width = region.getWidthInVoxels();
+	const int lowerX = region.getLowerX() + (shard * width + PosMapShards - 1) / PosMapShards;
+	const int upperX = region.getLowerX() + ((shard + 1) * width + PosMapShards - 1) / PosMapShards - 1;
+	return voxel::Region(lowerX, region.getLowerY(), region.getLowerZ(), upperX, region.getUpperY(),
+						 region.getUpperZ());
+}
+
+template<class FUNC>
+size_t MeshFormat::transformTrisBatched(const voxel::Region &region, const MeshTriCollection &tris, PosMaps &posMaps,
+										FUNC &&func) {
+	const size_t batches = (tris.size() + TrisPerTask - 1) / TrisPerTask;
+	Log::debug("Transform %i triangles in %i batches", (int)tris.size(), (int)batches);
+	const int lowerX = region.getLowerX();
+	const int width = region.getWidthInVoxels();
+
+	// each task only writes into its own slices - the order of the contributions for a position is kept by merging
+	// the tasks in the order of the input triangles
+	core::DynamicArray<PosContributions> contributions;
+	contributions.resize(batches * PosMapShards);
+	core::ThreadPool *threadPool = &app::App::getInstance()->threadPool();
+	const size_t processed = core::parallelReduce<size_t>(
+		threadPool, 0, (int)batches, 0u,
+		[&](int from, int to) {
+			size_t batchProcessed = 0u;
+			for (size_t batch = from; batch < (size_t)to; ++batch) {
+				PosContributions *shards = &contributions[batch * PosMapShards];
+				const size_t end = core_min(tris.size(), (batch + 1) * TrisPerTask);
+				auto emit = [&](size_t triIdx, const glm::ivec3 &p, uint32_t area, core::RGBA rgba,
+								uint8_t normalIdx) {
+					const int shard = (p.x - lowerX) * PosMapShards / width;
+					shards[shard].push_back({p, area, rgba, normalIdx, (uint32_t)triIdx});
+				};
+				batchProcessed += func(batch * TrisPerTask, end, emit);
+			}
+			return batchProcessed;
+		},
+		[](size_t a, size_t b) { return a + b; }, 1);
+
+	// the maps are filled up if this is not the first batch of a mesh
+	if (posMaps.empty()) {
+		posMaps.reserve(PosMapShards);
+		for (int shard = 0; shard < PosMapShards; ++shard) {
+			posMaps.emplace_back(shardRegion(region, shard));
+		}
+	}
+	core::parallelFor(
+		threadPool, 0, PosMapShards,
+		[&](int from, int to) {
+			for (int shard = from; shard < to; ++shard) {
+				PosMap &posMap = posMaps[shard];
+				for (size_t batch = 0; batch < batches; ++batch) {
+					if (stopExecution()) {
+						return;
+					}
+					PosContributions &batchContributions = contributions[batch * PosMapShards + shard];
+					for (const PosContribution &c : batchContributions) {
+						addToPosMap(posMap, c.rgba, c.area, c.normalIdx, c.pos, tris[c.triIdx].material);
+					}
+					batchContributions.release();
+				}
+			}
+		},
+		1);
+	return processed;
+}
+
+size_t MeshFormat::transformTrisParallel(const voxel::Region &region, const MeshTriCollection &tris, PosMaps &posMaps,
+										 const palette::NormalPalette &normalPalette) {
+	const size_t subdividedTris = transformTrisBatched(region, tris, posMaps, [&](size_t start, size_t end, auto &&emit) {
+		MeshTriCollection subdivided;
+		size_t subdividedCount = 0;
+		for (size_t i = start; i < end; ++i) {
+			if (stopExecution()) {
+				break;
+			}
+			subdivided.clear();
+			subdivideTri(tris[i], subdivided);
+			subdividedCount += subdivided.size();
+			for (const voxelformat::MeshTri &meshTri : subdivided) {
+				const core::RGBA rgba = meshTri.centerColor();
+				if (rgba.a <= AlphaThreshold) {
+					continue;
+				}
+				const uint32_t area = (uint32_t)(meshTri.area() * 1000.0f);
+				const uint8_t normalIdx = normalPalette.getClosestMatch(meshTri.normal());
+				emit(i, voxelPos(region, meshTri), area, rgba, normalIdx);
+			}
+		}
+		return subdividedCount;
+	});
+	Log::debug("subdivided into %i triangles", (int)subdividedTris);
+	return subdividedTris;
+}
+
+/**
+ * @brief Calls @c func for every voxel of the region that overlaps the triangle - the voxel at @c p covers the box
+ * from @c p to @c p+1
+ *
+ * The triangle is walked in columns along the dominant axis of its normal. The plane changes by at most one voxel
+ * per column step along this axis - so only the few voxels within the depth range of the plane over the column
+ * footprint are tested with the separating axis test.
+ */
+template<class FUNC>
+static void rasterizeTriangle(const voxel::Region &region, const voxelformat::MeshTri &meshTri, FUNC &&func) {
+	const glm::vec3 &v0 = meshTri.vertices[0];
+	const glm::vec3 &v1 = meshTri.vertices[1];
+	const glm::vec3 &v2 = meshTri.vertices[2];
+	const glm::vec3 n = glm::cross(v1 - v0, v2 - v0);
+	const glm::vec3 absN = glm::abs(n);
+	// the distance of a box corner to the plane along the normal - for scaling the coverage
+	const float maxDist = 0.5f * (absN.x + absN.y + absN.z);
+	if (maxDist <= glm::epsilon<float>()) {
+		return;
+	}
+	int w = 0;
+	if (absN.y > absN[w]) {
+		w = 1;
+	}
+	if (absN.z > absN[w]) {
+		w = 2;
+	}
+	const int u = (w + 1) % 3;
+	const int v = (w + 2) % 3;
+	const glm::vec3 mins = meshTri.mins();
+	const glm::vec3 maxs = meshTri.maxs();
+	// ceil - 1 to include the voxels that only touch the triangle with their upper face
+	const glm::ivec3 lower = glm::max(glm::ivec3(glm::ceil(mins)) - 1, region.getLowerCorner());
+	const glm::ivec3 upper = glm::min(glm::ivec3(glm::floor(maxs)), region.getUpperCorner());
+	const float d = glm::dot(n, v0);
+	const glm::vec3 voxelHalf(0.5f);
 
-		const glm::ivec3 p(c);
-		core_assert_msg(region.containsPoint(p), "Failed to transform tri %i:%i:%i (region: %s)", p.x, p.y, p.z,
-						region.toString().c_str());
-		addToPosMap(posMap, rgba, area, normalIdx, p, meshTri.material);
+	glm::ivec3 p;
+	for (int iu = lower[u]; iu <= upper[u]; ++iu) {
+		p[u] = iu;
+		for (int iv = lower[v]; iv <= upper[v]; ++iv) {
+			p[v] = iv;
+			// the depth range of the plane over the footprint of the column - the plane is linear, so the corners
+			// of the footprint give the extremes
+			const float depth = (d - n[u] * (float)iu - n[v] * (float)iv) / n[w];
+			const float du = n[u] / n[w];
+			const float dv = n[v] / n[w];
+			const float depthMin = depth - glm::max(du, 0.0f) - glm::max(dv, 0.0f);
+			const float depthMax = depth - glm::min(du, 0.0f) - glm::min(dv, 0.0f);
+			const int from = glm::max(lower[w], (int)glm::ceil(glm::max(depthMin, mins[w])) - 1);
+			const int to = glm::min(upper[w], (int)glm::floor(glm::min(depthMax, maxs[w])));
+			for (int iw = from; iw <= to; ++iw) {
+				p[w] = iw;
+				const glm::vec3 center = glm::vec3(p) + voxelHalf;
+				if (!glm::intersectTriangleAABB(center, voxelHalf, v0, v1, v2)) {
+					continue;
+				}
+				const float dist = glm::abs(glm::dot(n, center) - d);
+				func(p, center, 1.0f - glm::min(dist / maxDist, 1.0f));
+			}
+		}
 	}
 }
 
+size_t MeshFormat::rasterizeTrisParallel(const voxel::Region &region, const MeshTriCollection &tris, PosMaps &posMaps,
+										 const palette::NormalPalette &normalPalette) {
+	const size_t voxels = transformTrisBatched(region, tris, posMaps, [&](size_t start, size_t end, auto &&emit) {
+		size_t touched = 0;
+		for (size_t i = start; i < end; ++i) {
+			if (stopExecution()) {
+				break;
+			}
+			const voxelformat::MeshTri &meshTri = tris[i];
+			const uint8_t normalIdx = normalPalette.getClosestMatch(meshTri.normal());
+			// the texels that are covered by one voxel face - to pick the mipmap level
+			const float area = meshTri.area();
+			const float uvArea = area > 0.0f ? meshTri.uvArea() / area : 0.0f;
+			rasterizeTriangle(region, meshTri, [&](const glm::ivec3 &p, const glm::vec3 &center, float coverage) {
+				const core::RGBA rgba = meshTri.colorAt(meshTri.clampedUV(center), false, uvArea);
+				if (rgba.a <= AlphaThreshold) {
+					return;
+				}
+				emit(i, p, (uint32_t)(coverage * 1000.0f) + 1u, rgba, normalIdx);
+				++touched;
+			});
+		}
+		return touched;
+	});
+	Log::debug("rasterized %i triangles into %i voxels", (int)tris.size(), (int)voxels);
+	return voxels;
+}
+
 void MeshFormat::transformTrisAxisAligned(const voxel::Region &region, const MeshTriCollection &tris, PosMap &posMap, const palette::NormalPalette &normalPalette) {
 	Log::debug("axis aligned %i triangles", (int)tris.size());
 	for (const voxelformat::MeshTri &meshTri : tris) {
@@ -231,18 +437,98 @@ static void voxelizeTriangle(const glm::vec3 &trisMins, const voxelformat::MeshT
 	}
 }
 
-int MeshFormat::voxelizeNode(const core::String &uuid, const core::String &name, scenegraph::SceneGraph &sceneGraph, const MeshTriCollection &tris,
-							 int parent, bool resetOrigin) const {
-	if (tris.empty()) {
-		Log::warn("Empty volume - no triangles given");
-		return InvalidNodeId;
+bool MeshFormat::MeshTriSource::visit(const BatchFunc &func) {
+	if (_complete) {
+		// everything fit into one batch in an earlier visit
+		return func(_tris);
+	}
+	_tris.clear();
+	bool flushed = false;
+	auto flush = [&]() {
+		flushed = true;
+		const bool ret = func(_tris);
+		_tris.clear();
+		return ret;
+	};
+	if (!produce(_tris, flush)) {
+		_tris.release();
+		return false;
+	}
+	if (!flushed) {
+		_complete = true;
+		return func(_tris);
+	}
+	if (_tris.empty()) {
+		return true;
+	}
+	const bool ret = func(_tris);
+	_tris.release();
+	return ret;
+}
+
+namespace {
+/**
+ * @brief Hands out the given triangles as one batch
+ */
+class MeshTriCollectionSource : public MeshFormat::MeshTriSource {
+private:
+	const MeshFormat::MeshTriCollection &_collection;
+
+protected:
+	bool produce(MeshFormat::MeshTriCollection &, const std::function<bool()> &) override {
+		return true;
+	}
+
+public:
+	MeshTriCollectionSource(const MeshFormat::MeshTriCollection &collection) : _collection(collection) {
+	}
+
+	bool visit(const BatchFunc &func) override {
+		return func(_collection);
 	}
+};
+} // namespace
 
-	const bool axisAligned = isVoxelMesh(tris);
+int MeshFormat::voxelizeNode(const core::UUID &uuid, const core::String &name, scenegraph::SceneGraph &sceneGraph,
+							 const MeshTriCollection &tris, int parent, bool resetOrigin) const {
+	MeshTriCollectionSource source(tris);
+	return voxelizeNode(uuid, name, sceneGraph, source, parent, resetOrigin);
+}
 
+int MeshFormat::voxelizeNode(const core::UUID &uuid, const core::String &name, scenegraph::SceneGraph &sceneGraph,
+							 MeshTriSource &source, int parent, bool resetOrigin) const {
+	// the first pass over the triangles collects the bounds
+	bool axisAligned = true;
+	size_t triCount = 0;
 	glm::vec3 trisMins;
 	glm::vec3 trisMaxs;
-	core_assert_always(calculateAABB(tris, trisMins, trisMaxs));
+	const bool visited = source.visit([&](const MeshTriCollection &tris) {
+		glm::vec3 batchMins;
+		glm::vec3 batchMaxs;
+		if (!calculateAABB(tris, batchMins, batchMaxs)) {
+			return true;
+		}
+		if (triCount == 0u) {
+			trisMins = batchMins;
+			trisMaxs = batchMaxs;
+		} else {
+			trisMins = glm::min(trisMins, batchMins);
+			trisMaxs = glm::max(trisMaxs, batchMaxs);
+		}
+		triCount += tris.size();
+		if (axisAligned) {
+			axisAligned = isVoxelMesh(tris);
+		}
+		return !stopExecution();
+	});
+	if (!visited) {
+		Log::error("Failed to read the triangles");
+		return InvalidNodeId;
+	}
+	if (triCount == 0u) {
+		Log::warn("Empty volume - no triangles given");
+		return InvalidNodeId;
+	}
 	Log::debug("mins: %f:%f:%f, maxs: %f:%f:%f", trisMins.x, trisMins.y, trisMins.z, trisMaxs.x, trisMaxs.y,
 			   trisMaxs.z);
 
@@ -269,59 +555,68 @@ int MeshFormat::voxelizeNode(const core::String &uuid, const core::String &name,
 	node.setVolume(new voxel::RawVolume(region), true);
 	node.setName(name);
 	palette::NormalPalette normalPalette;
-	const core::VarPtr &normalPaletteVar = core::Var::getSafe(cfg::NormalPalette);
-	if (!normalPalette.load(normalPaletteVar->strVal().c_str())) {
-		Log::debug("Failed to load normal palette %s - use redalert2 as default", normalPaletteVar->strVal().c_str());
+	if (!normalPalette.load(_config.normalPalette.c_str())) {
+		Log::debug("Failed to load normal palette %s - use redalert2 as default", _config.normalPalette.c_str());
 		normalPalette.redAlert2();
 	} else {
-		Log::debug("Loaded normal palette %s", normalPaletteVar->strVal().c_str());
+		Log::debug("Loaded normal palette %s", _config.normalPalette.c_str());
 	}
 	// TODO: VOXELFORMAT: auto generate the normal palette from the input tris?
 	node.setNormalPalette(normalPalette);
 
-	const int voxelizeMode = core::Var::getSafe(cfg::VoxformatVoxelizeMode)->intVal();
-	const bool fillHollow = core::Var::getSafe(cfg::VoxformatFillHollow)->boolVal();
+	const int voxelizeMode = _config.voxelizeMode;
+	const bool fillHollow = _config.fillHollow;
 	if (axisAligned) {
-		const int maxVoxels = vdim.x * vdim.y * vdim.z;
-		Log::debug("max voxels: %i (%i:%i:%i)", maxVoxels, vdim.x, vdim.y, vdim.z);
-		PosMap posMap(maxVoxels);
-		transformTrisAxisAligned(region, tris, posMap, normalPalette);
-		voxelizeTris(node, posMap, fillHollow);
+		PosMaps posMaps;
+		posMaps.emplace_back(region);
+		source.visit([&](const MeshTriCollection &tris) {
+			transformTrisAxisAligned(region, tris, posMaps[0], normalPalette);
+			return !stopExecution();
+		});
+		voxelizeTris(node, posMaps, fillHollow);
 	} else if (voxelizeMode == VoxelizeMode::Fast) {
 		voxel::RawVolumeWrapper wrapper(node.volume());
 		palette::Palette palette;
 
-		const bool shouldCreatePalette = core::Var::getSafe(cfg::VoxelCreatePalette)->boolVal();
+		const bool shouldCreatePalette = _config.createPalette;
 		if (shouldCreatePalette) {
 			RGBAMaterialMap colorMaterials;
 			Log::debug("create palette");
-			for (const voxelformat::MeshTri &meshTri : tris) {
+			source.visit([&](const MeshTriCollection &tris) {
+				for (const voxelformat::MeshTri &meshTri : tris) {
 #if 1
-				voxelizeTriangle(trisMins, meshTri, [this, &colorMaterials] (const voxelformat::MeshTri &tri, const glm::vec2 &uv, int x, int y, int z) {
-					const core::RGBA rgba = flattenRGB(tri.colorAt(uv));
-					colorMaterials.put(rgba, tri.material ? &tri.material->material : nullptr);
-				});
+					voxelizeTriangle(trisMins, meshTri, [this, &colorMaterials] (const voxelformat::MeshTri &tri, const glm::vec2 &uv, int x, int y, int z) {
+						const core::RGBA rgba = flattenRGB(tri.colorAt(uv));
+						colorMaterials.put(rgba, tri.material ? &tri.material->material : nullptr);
+					});
 #else
-				const core::RGBA rgba = flattenRGB(triangle.centerColor());
-				colorMaterials.put(rgba, tri.material ? &tri.material->material : nullptr);
+					const core::RGBA rgba = flattenRGB(triangle.centerColor());
+					colorMaterials.put(rgba, tri.material ? &tri.material->material : nullptr);
 #endif
-			}
+				}
+				return !stopExecution();
+			});
 			createPalette(colorMaterials, palette);
 		} else {
 			palette = voxel::getPalette();
 		}
 
-		Log::debug("create voxels from %i tris", (int)tris.size());
+		Log::debug("create voxels from %i tris", (int)triCount);
 		palette::PaletteLookup palLookup(palette);
-		for (const voxelformat::MeshTri &meshTri : tris) {
-			voxelizeTriangle(trisMins, meshTri, [&] (const voxelformat::MeshTri &tri, const glm::vec2 &uv, int x, int y, int z) {
-				const core::RGBA color = flattenRGB(tri.colorAt(uv));
-				const glm::vec3 &normal = tri.normal();
-				const uint8_t normalIndex = normalPalette.getClosestMatch(normal);
-				const voxel::Voxel voxel = voxel::createVoxel(palette, palLookup.findClosestIndex(color), normalIndex);
-				wrapper.setVoxel(x, y, z, voxel);
-			});
-		}
+		// textured meshes produce a lot of different colors
+		palLookup.useColorCube(&app::App::getInstance()->threadPool());
+		source.visit([&](const MeshTriCollection &tris) {
+			for (const voxelformat::MeshTri &meshTri : tris) {
+				voxelizeTriangle(trisMins, meshTri, [&] (const voxelformat::MeshTri &tri, const glm::vec2 &uv, int x, int y, int z) {
+					const core::RGBA color = flattenRGB(tri.colorAt(uv));
+					const glm::vec3 &normal = tri.normal();
+					const uint8_t normalIndex = normalPalette.getClosestMatch(normal);
+					const voxel::Voxel voxel = voxel::createVoxel(palette, palLookup.findClosestIndex(color), normalIndex);
+					wrapper.setVoxel(x, y, z, voxel);
+				});
+			}
+			return !stopExecution();
+		});
 
 		if (palette.colorCount() == 1) {
 			core::RGBA c = palette.color(0);
@@ -336,31 +631,32 @@ int MeshFormat::voxelizeNode(const core::String &uuid, const core::String &name,
 			const voxel::Voxel voxel = voxel::createVoxel(palette, FillColorIndex);
 			voxelutil::fillHollow(wrapper, voxel);
 		}
-	} else {
-		Log::debug("Subdivide %i triangles", (int)tris.size());
-		core::DynamicArray<std::future<MeshTriCollection>> futures;
-		futures.reserve(tris.size());
-		for (const voxelformat::MeshTri &meshTri : tris) {
-			futures.emplace_back(app::async([meshTri]() {
-				MeshTriCollection subdivided;
-				subdivideTri(meshTri, subdivided);
-				return subdivided;
-			}));
-		}
-		MeshTriCollection subdivided;
-		for (std::future<MeshTriCollection> &future : futures) {
-			const MeshTriCollection &sub = future.get();
-			subdivided.append(sub);
+	} else if (voxelizeMode == VoxelizeMode::Rasterize) {
+		PosMaps posMaps;
+		size_t voxels = 0;
+		source.visit([&](const MeshTriCollection &tris) {
+			generateMipmaps(tris);
+			voxels += rasterizeTrisParallel(region, tris, posMaps, normalPalette);
+			return !stopExecution();
+		});
+		if (voxels == 0u) {
+			Log::warn("Empty volume - no voxels touched");
+			return InvalidNodeId;
 		}
-
-		if (subdivided.empty()) {
+		voxelizeTris(node, posMaps, fillHollow);
+	} else {
+		PosMaps posMaps;
+		size_t subdividedTris = 0;
+		source.visit([&](const MeshTriCollection &tris) {
+			generateMipmaps(tris);
+			subdividedTris += transformTrisParallel(region, tris, posMaps, normalPalette);
+			return !stopExecution();
+		});
+		if (subdividedTris == 0u) {
 			Log::warn("Empty volume - could not subdivide");
 			return InvalidNodeId;
 		}
-
-		PosMap posMap((int)subdivided.size() * 3);
-		transformTris(region, subdivided, posMap, normalPalette);
-		voxelizeTris(node, posMap, fillHollow);
+		voxelizeTris(node, posMaps, fillHollow);
 	}
 
 	if (resetOrigin) {
@@ -375,6 +671,97 @@ int MeshFormat::voxelizeNode(const core::String &uuid, const core::String &name,
 	return sceneGraph.emplace(core::move(node), parent);
 }
 
+/**
+ * @brief Subdivides the triangle until it is not bigger than the given size on any axis
+ */
+static void splitTri(const voxelformat::MeshTri &meshTri, float maxSize, MeshFormat::MeshTriCollection &todo,
+					 MeshFormat::MeshTriCollection &out) {
+	todo.clear();
+	todo.push_back(meshTri);
+	while (!todo.empty()) {
+		const voxelformat::MeshTri tri = todo.back();
+		todo.pop();
+		const glm::vec3 &size = tri.maxs() - tri.mins();
+		if (glm::all(glm::lessThanEqual(size, glm::vec3(maxSize)))) {
+			out.push_back(tri);
+			continue;
+		}
+		voxelformat::MeshTri subdivided[4];
+		tri.subdivide(subdivided);
+		for (int i = 0; i < lengthof(subdivided); ++i) {
+			todo.push_back(subdivided[i]);
+		}
+	}
+}
+
+int MeshFormat::voxelizeBuckets(const core::String &name, scenegraph::SceneGraph &sceneGraph,
+								const MeshTriCollection &tris, int parent) const {
+	const int bucketSize = _config.meshBucketSize;
+	glm::vec3 trisMins;
+	glm::vec3 trisMaxs;
+	if (bucketSize <= 0 || !calculateAABB(tris, trisMins, trisMaxs) ||
+		glm::all(glm::lessThanEqual(trisMaxs - trisMins, glm::vec3((float)bucketSize)))) {
+		return voxelizeNode(name, sceneGraph, tris, parent);
+	}
+
+	MeshTriCollection bucketTris;
+	bucketTris.reserve(tris.size());
+	MeshTriCollection todo;
+	for (const voxelformat::MeshTri &meshTri : tris) {
+		splitTri(meshTri, (float)bucketSize, todo, bucketTris);
+	}
+
+	// the bucket coordinates are relative to the mins and packed into 21 bits each
+	struct BucketTri {
+		uint64_t key;
+		uint32_t tri;
+	};
+	core::DynamicArray<BucketTri> entries;
+	entries.resize(bucketTris.size());
+	for (size_t i = 0; i < bucketTris.size(); ++i) {
+		const glm::ivec3 bucket(glm::floor((bucketTris[i].center() - trisMins) / (float)bucketSize));
+		const glm::u64vec3 k(glm::clamp(bucket, glm::ivec3(0), glm::ivec3((1 << 21) - 1)));
+		entries[i].key = k.x | (k.y << 21) | (k.z << 42);
+		entries[i].tri = (uint32_t)i;
+	}
+	core::sort(entries.begin(), entries.end(),
+			   [](const BucketTri &a, const BucketTri &b) { return a.key < b.key; });
+
+	scenegraph::SceneGraphNode groupNode(scenegraph::SceneGraphNodeType::Group);
+	groupNode.setName(name);
+	const int groupId = sceneGraph.emplace(core::move(groupNode), parent);
+	if (groupId == InvalidNodeId) {
+		return InvalidNodeId;
+	}
+
+	int buckets = 0;
+	MeshTriCollection cellTris;
+	size_t start = 0;
+	while (start < entries.size() && !stopExecution()) {
+		const uint64_t key = entries[start].key;
+		size_t end = start;
+		cellTris.clear();
+		while (end < entries.size() && entries[end].key == key) {
+			cellTris.push_back(bucketTris[entries[end].tri]);
+			++end;
+		}
+		start = end;
+		const int x = (int)(key & ((1 << 21) - 1));
+		const int y = (int)((key >> 21) & ((1 << 21) - 1));
+		const int z = (int)(key >> 42);
+		const core::String &bucketName = core::string::format("%s %i:%i:%i", name.c_str(), x, y, z);
+		if (voxelizeNode(bucketName, sceneGraph, cellTris, groupId) != InvalidNodeId) {
+			++buckets;
+		}
+	}
+	Log::debug("Voxelized %i buckets of %s", buckets, name.c_str());
+	if (buckets == 0) {
+		sceneGraph.removeNode(groupId, false);
+		return InvalidNodeId;
+	}
+	return groupId;
+}
+
 bool MeshFormat::calculateAABB(const MeshTriCollection &tris, glm::vec3 &mins, glm::vec3 &maxs) {
 	if (tris.empty()) {
 		mins = maxs = glm::vec3(0.0f);
@@ -391,42 +778,46 @@ bool MeshFormat::calculateAABB(const MeshTriCollection &tris, glm::vec3 &mins, g
 	return true;
 }
 
-void MeshFormat::voxelizeTris(scenegraph::SceneGraphNode &node, const PosMap &posMap, bool fillHollow) const {
+void MeshFormat::voxelizeTris(scenegraph::SceneGraphNode &node, const PosMaps &posMaps, bool fillHollow) const {
 	voxel::RawVolumeWrapper wrapper(node.volume());
 	palette::Palette palette;
-	const bool shouldCreatePalette = core::Var::getSafe(cfg::VoxelCreatePalette)->boolVal();
+	const bool shouldCreatePalette = _config.createPalette;
 	if (shouldCreatePalette) {
 		RGBAMaterialMap colorMaterials;
 		Log::debug("create palette");
-		for (const auto &entry : posMap) {
-			if (stopExecution()) {
-				return;
-			}
-			const PosSampling &pos = entry->second;
-			const core::RGBA rgba = pos.getColor(_flattenFactor, _weightedAverage);
-			if (rgba.a <= AlphaThreshold) {
-				continue;
+		for (const PosMap &posMap : posMaps) {
+			for (const PosSamplingGrid::Entry &entry : posMap) {
+				if (stopExecution()) {
+					return;
+				}
+				const PosSampling &pos = entry.sampling;
+				const core::RGBA rgba = pos.getColor(_config.rgbFlattenFactor, _config.rgbWeightedAverage);
+				if (rgba.a <= AlphaThreshold) {
+					continue;
+				}
+				const MeshMaterialPtr &material = pos.getMaterial();
+				colorMaterials.put(rgba, material ? &material->material : nullptr);
 			}
-			const MeshMaterialPtr &material = pos.getMaterial();
-			colorMaterials.put(rgba, material ? &material->material : nullptr);
 		}
 		createPalette(colorMaterials, palette);
 	} else {
 		palette = voxel::getPalette();
 	}
 
-	Log::debug("create voxels for %i positions", (int)posMap.size());
-	for (const auto &entry : posMap) {
-		if (stopExecution()) {
-			return;
-		}
-		const PosSampling &pos = entry->second;
-		const core::RGBA rgba = pos.getColor(_flattenFactor, _weightedAverage);
-		if (rgba.a <= AlphaThreshold) {
-			continue;
+	for (const PosMap &posMap : posMaps) {
+		Log::debug("create voxels for %i positions", (int)posMap.size());
+		for (const PosSamplingGrid::Entry &entry : posMap) {
+			if (stopExecution()) {
+				return;
+			}
+			const PosSampling &pos = entry.sampling;
+			const core::RGBA rgba = pos.getColor(_config.rgbFlattenFactor, _config.rgbWeightedAverage);
+			if (rgba.a <= AlphaThreshold) {
+				continue;
+			}
+			const voxel::Voxel voxel = voxel::createVoxel(palette, palette.getClosestMatch(rgba), pos.getNormal());
+			wrapper.setVoxel(entry.pos, voxel);
 		}
-		const voxel::Voxel voxel = voxel::createVoxel(palette, palette.getClosestMatch(rgba), pos.getNormal());
-		wrapper.setVoxel(entry->first, voxel);
 	}
 	if (palette.colorCount() == 1) {
 		core::RGBA c = palette.color(0);
@@ -468,7 +859,7 @@ bool MeshFormat::voxelizePointCloud(const core::String &filename, scenegraph::Sc
 		maxs = glm::max(maxs, v.position);
 	}
 
-	const int pointSize = core_max(1, core::Var::getSafe(cfg::VoxformatPointCloudSize)->intVal());
+	const int pointSize = core_max(1, _config.pointCloudSize);
 	const voxel::Region region(glm::floor(mins), glm::ceil(maxs) + glm::vec3((float)(pointSize - 1)));
 	voxel::RawVolume *v = new voxel::RawVolume(region);
 	const palette::Palette &palette = voxel::getPalette();
@@ -497,80 +888,167 @@ bool MeshFormat::voxelizeGroups(const core::String &filename, const io::ArchiveP
 	return false;
 }
 
-bool MeshFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
-							const io::ArchivePtr &archive, const SaveContext &saveCtx) {
-	const bool mergeQuads = core::Var::getSafe(cfg::VoxformatMergequads)->boolVal();
-	const bool reuseVertices = core::Var::getSafe(cfg::VoxformatReusevertices)->boolVal();
-	const bool ambientOcclusion = core::Var::getSafe(cfg::VoxformatAmbientocclusion)->boolVal();
-	const bool quads = core::Var::getSafe(cfg::VoxformatQuads)->boolVal();
-	const bool withColor = core::Var::getSafe(cfg::VoxformatWithColor)->boolVal();
-	const bool withNormals = core::Var::getSafe(cfg::VoxformatWithNormals)->boolVal();
-	const bool withTexCoords = core::Var::getSafe(cfg::VoxformatWithtexcoords)->boolVal();
-	const bool applyTransform = core::Var::getSafe(cfg::VoxformatTransform)->boolVal();
-	const bool optimizeMesh = core::Var::getSafe(cfg::VoxformatOptimize)->boolVal();
-
-	const voxel::SurfaceExtractionType type = (voxel::SurfaceExtractionType)core::Var::getSafe(cfg::VoxelMeshMode)->intVal();
-
-	const size_t models = sceneGraph.size(scenegraph::SceneGraphNodeType::AllModels);
-	Meshes meshes;
-	core::Map<int, int> meshIdxNodeMap;
-	core_trace_mutex(core::Lock, lock, "MeshFormat");
-	// TODO: VOXELFORMAT: this could get optimized by re-using the same mesh for multiple nodes (in case of reference nodes)
+MeshFormat::MeshStream::MeshStream(const scenegraph::SceneGraph &sceneGraph, const FormatConfig &config)
+	: _sceneGraph(sceneGraph), _config(config) {
 	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
-		const scenegraph::SceneGraphNode &node = *iter;
-		app::async([&, volume = sceneGraph.resolveVolume(node), region = sceneGraph.resolveRegion(node)]() {
-			voxel::ChunkMesh *mesh = new voxel::ChunkMesh();
-			voxel::Region regionExt = region;
-			// we are increasing the region by one voxel to ensure the inclusion of the boundary voxels in this mesh
-			regionExt.shiftUpperCorner(1, 1, 1);
-			voxel::SurfaceExtractionContext ctx =
-				voxel::createContext(type, volume, regionExt, node.palette(), *mesh, {0, 0, 0}, mergeQuads,
-									 reuseVertices, ambientOcclusion);
-			voxel::extractSurface(ctx);
-			if (withNormals) {
-				Log::debug("Calculate normals");
-				mesh->calculateNormals();
-			}
-			if (optimizeMesh) {
-				mesh->optimize();
-			}
+		const int id = key(*iter);
+		auto entryIter = _entries.find(id);
+		if (entryIter == _entries.end()) {
+			Entry entry;
+			entry.users = 1;
+			_entries.put(id, entry);
+		} else {
+			++entryIter->value.users;
+		}
+	}
+}
 
-			core::ScopedLock scoped(lock);
-			meshes.emplace_back(mesh, node, applyTransform);
-		});
+MeshFormat::MeshStream::~MeshStream() {
+	for (auto iter = _entries.begin(); iter != _entries.end(); ++iter) {
+		delete iter->value.mesh;
 	}
-	for (;;) {
-		lock.lock();
-		const size_t size = meshes.size();
-		lock.unlock();
-		if (size < models) {
-			app::App::getInstance()->wait(10);
-		} else {
-			break;
+}
+
+int MeshFormat::MeshStream::key(const scenegraph::SceneGraphNode &node) const {
+	const scenegraph::SceneGraphNode *model = &node;
+	while (model->type() == scenegraph::SceneGraphNodeType::ModelReference) {
+		model = &_sceneGraph.node(model->reference());
+	}
+	// the palette is needed to split the mesh into the opaque and transparent parts
+	if (model != &node && model->palette().hash() != node.palette().hash()) {
+		return node.id();
+	}
+	return model->id();
+}
+
+voxel::ChunkMesh *MeshFormat::MeshStream::extract(const scenegraph::SceneGraphNode &node) const {
+	const voxel::SurfaceExtractionType type = (voxel::SurfaceExtractionType)_config.meshMode;
+	voxel::ChunkMesh *mesh = new voxel::ChunkMesh();
+	voxel::Region regionExt = _sceneGraph.resolveRegion(node);
+	// we are increasing the region by one voxel to ensure the inclusion of the boundary voxels in this mesh
+	regionExt.shiftUpperCorner(1, 1, 1);
+	voxel::SurfaceExtractionContext ctx =
+		voxel::createContext(type, _sceneGraph.resolveVolume(node), regionExt, node.palette(), *mesh, {0, 0, 0},
+							 _config.mergeQuads, _config.reuseVertices, _config.ambientOcclusion);
+	// large volumes are split into slices that are extracted in parallel
+	ctx.threadPool = &app::App::getInstance()->threadPool();
+	voxel::extractSurface(ctx);
+	if (_config.simplifyError > 0.0f && type != voxel::SurfaceExtractionType::Cubic) {
+		// the cubic meshes are already as small as possible without changing their look
+		mesh->simplify(_config.simplifyError);
+	}
+	if (_config.withNormals) {
+		Log::debug("Calculate normals");
+		mesh->calculateNormals();
+	}
+	if (_config.optimize) {
+		mesh->optimize();
+	}
+	if (mesh->isEmpty()) {
+		delete mesh;
+		return nullptr;
+	}
+	return mesh;
+}
+
+void MeshFormat::MeshStream::extractAll() {
+	core::DynamicArray<int> nodeIds;
+	nodeIds.reserve(_entries.size());
+	for (auto iter = _entries.begin(); iter != _entries.end(); ++iter) {
+		if (!iter->value.extracted) {
+			nodeIds.push_back(iter->key);
 		}
 	}
-	Meshes nonEmptyMeshes;
-	nonEmptyMeshes.reserve(meshes.size());
+	core::DynamicArray<voxel::ChunkMesh *> meshes(nodeIds.size());
+	decodeParallel(nodeIds.size(), [&](size_t n) {
+		meshes[n] = extract(_sceneGraph.node(nodeIds[n]));
+		return true;
+	});
+	for (size_t i = 0; i < nodeIds.size(); ++i) {
+		auto iter = _entries.find(nodeIds[i]);
+		iter->value.mesh = meshes[i];
+		iter->value.extracted = true;
+	}
+}
 
-	// filter out empty meshes
-	for (auto iter = meshes.begin(); iter != meshes.end(); ++iter) {
-		if (iter->mesh->isEmpty()) {
-			continue;
+voxel::ChunkMesh *MeshFormat::MeshStream::acquire(const scenegraph::SceneGraphNode &node) {
+	const int id = key(node);
+	auto iter = _entries.find(id);
+	core_assert_msg(iter != _entries.end(), "No mesh entry for node %i", node.id());
+	Entry &entry = iter->value;
+	if (!entry.extracted) {
+		entry.mesh = extract(_sceneGraph.node(id));
+		entry.extracted = true;
+	}
+	if (entry.mesh != nullptr) {
+		++_nonEmpty;
+	}
+	return entry.mesh;
+}
+
+void MeshFormat::MeshStream::release(const scenegraph::SceneGraphNode &node) {
+	auto iter = _entries.find(key(node));
+	core_assert_msg(iter != _entries.end(), "No mesh entry for node %i", node.id());
+	Entry &entry = iter->value;
+	if (--entry.users > 0) {
+		return;
+	}
+	delete entry.mesh;
+	entry.mesh = nullptr;
+}
+
+MeshFormat::MeshExt MeshFormat::MeshStream::createMeshExt(voxel::ChunkMesh *mesh,
+														  const scenegraph::SceneGraphNode &node) const {
+	MeshExt meshExt(mesh, node, _config.transform);
+	meshExt.size = _sceneGraph.resolveRegion(node).getDimensionsInVoxels();
+	return meshExt;
+}
+
+bool MeshFormat::saveMeshStream(const scenegraph::SceneGraph &sceneGraph, MeshStream &meshStream,
+								const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale,
+								bool quad, bool withColor, bool withTexCoords) {
+	meshStream.extractAll();
+	Meshes meshes;
+	meshes.reserve(sceneGraph.size(scenegraph::SceneGraphNodeType::AllModels));
+	core::Map<int, int> meshIdxNodeMap;
+	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
+		// filter out empty meshes
+		if (voxel::ChunkMesh *mesh = meshStream.acquire(*iter)) {
+			meshes.emplace_back(meshStream.createMeshExt(mesh, *iter));
+			meshIdxNodeMap.put((*iter).id(), (int)meshes.size() - 1);
 		}
-		nonEmptyMeshes.emplace_back(*iter);
-		meshIdxNodeMap.put(iter->nodeId, (int)nonEmptyMeshes.size() - 1);
 	}
-	bool state;
-	if (nonEmptyMeshes.empty() && sceneGraph.empty(scenegraph::SceneGraphNodeType::Point)) {
-		Log::warn("Empty scene can't get saved as mesh");
-		state = false;
-	} else {
+	bool state = true;
+	if (!meshes.empty() || !sceneGraph.empty(scenegraph::SceneGraphNodeType::Point)) {
 		Log::debug("Save meshes");
-		state = saveMeshes(meshIdxNodeMap, sceneGraph, nonEmptyMeshes, filename, archive, {1.0f, 1.0f, 1.0f},
-						   type == voxel::SurfaceExtractionType::Cubic ? quads : false, withColor, withTexCoords);
+		state = saveMeshes(meshIdxNodeMap, sceneGraph, meshes, filename, archive, scale, quad, withColor,
+						   withTexCoords);
 	}
-	for (MeshExt &meshext : meshes) {
-		delete meshext.mesh;
+	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
+		meshStream.release(*iter);
+	}
+	return state;
+}
+
+bool MeshFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &,
+							const core::String &filename, const io::ArchivePtr &, const glm::vec3 &, bool, bool,
+							bool) {
+	Log::error("Saving meshes is not supported for %s", filename.c_str());
+	return false;
+}
+
+bool MeshFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
+							const io::ArchivePtr &archive, const SaveContext &saveCtx) {
+	const FormatConfig &config = saveCtx.config;
+	const voxel::SurfaceExtractionType type = (voxel::SurfaceExtractionType)config.meshMode;
+	const bool quads = type == voxel::SurfaceExtractionType::Cubic ? config.quads : false;
+
+	MeshStream meshStream(sceneGraph, config);
+	const bool state = saveMeshStream(sceneGraph, meshStream, filename, archive, {1.0f, 1.0f, 1.0f}, quads,
+									  config.withColor, config.withTexCoords);
+	if (meshStream.nonEmpty() == 0u && sceneGraph.empty(scenegraph::SceneGraphNodeType::Point)) {
+		Log::warn("Empty scene can't get saved as mesh");
+		return false;
 	}
 	return state;
 }
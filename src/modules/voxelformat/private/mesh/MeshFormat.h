@@ -6,12 +6,14 @@
 
 #include "MeshTri.h"
 #include "PosSampling.h"
+#include "core/UUID.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Map.h"
 #include "io/Archive.h"
 #include "palette/NormalPalette.h"
 #include "voxel/ChunkMesh.h"
 #include "voxelformat/Format.h"
+#include <functional>
 
 namespace voxelformat {
 
@@ -27,10 +29,52 @@ public:
 	static constexpr const uint8_t FillColorIndex = 2;
 	using MeshTriCollection = core::DynamicArray<voxelformat::MeshTri, 512>;
 
+	/**
+	 * @brief Hands out the triangles of a mesh in batches - this allows to voxelize meshes without keeping all the
+	 * triangles in memory
+	 *
+	 * The source is visited several times during the voxelization and must produce the same triangles on each visit.
+	 * If all triangles fit into one batch, they are only produced once and kept for the following visits.
+	 *
+	 * @sa voxelizeNode()
+	 */
+	class MeshTriSource {
+	private:
+		MeshTriCollection _tris;
+		bool _complete = false;
+
+	protected:
+		/**
+		 * @brief Appends the triangles to the given collection
+		 * @param flush Must be called once the collection has at least @c BatchSize entries - the collection is
+		 * empty afterwards. Stop producing if this returns @c false.
+		 */
+		virtual bool produce(MeshTriCollection &tris, const std::function<bool()> &flush) = 0;
+
+	public:
+		static constexpr size_t BatchSize = 1 << 16;
+		using BatchFunc = std::function<bool(const MeshTriCollection &)>;
+
+		virtual ~MeshTriSource() {
+		}
+
+		/**
+		 * @brief Calls the given function for every batch of triangles
+		 * @return @c false if the triangles could not get produced or the function returned @c false
+		 */
+		virtual bool visit(const BatchFunc &func);
+	};
+
 	/**
 	 * Subdivide until we brought the triangles down to the size of 1 or smaller
 	 */
 	static void subdivideTri(const voxelformat::MeshTri &meshTri, MeshTriCollection &tinyTris);
+	/**
+	 * @brief Creates the mipmaps for the textures of the triangle materials - the subdivided triangles are sampled
+	 * with the mipmap level that matches their size in the texture.
+	 * @note Must be called before the triangles are sampled in parallel
+	 */
+	static void generateMipmaps(const MeshTriCollection &tris);
 	static bool calculateAABB(const MeshTriCollection &tris, glm::vec3 &mins, glm::vec3 &maxs);
 	/**
 	 * @brief Checks whether the given triangles are axis aligned - usually true for voxel meshes
@@ -38,11 +82,6 @@ public:
 	static bool isVoxelMesh(const MeshTriCollection &tris);
 
 protected:
-	/**
-	 * @brief Color flatten factor - see @c PosSampling::getColor()
-	 */
-	bool _weightedAverage = true;
-
 	struct PointCloudVertex {
 		glm::vec3 position{0.0f};
 		core::RGBA color{0, 0, 0, 255};
@@ -60,13 +99,80 @@ protected:
 		int nodeId = -1;
 	};
 	using Meshes = core::DynamicArray<MeshExt>;
+
+	/**
+	 * @brief Extracts the meshes of the model nodes of a scene graph
+	 *
+	 * A mesh is extracted on the first @c acquire() call and freed once all the nodes that are sharing it released it.
+	 * Model reference nodes share the mesh of the model they are referencing - as long as they are using the same
+	 * palette.
+	 *
+	 * @sa saveMeshStream()
+	 */
+	class MeshStream {
+	private:
+		struct Entry {
+			voxel::ChunkMesh *mesh = nullptr;
+			int users = 0;
+			bool extracted = false;
+		};
+		const scenegraph::SceneGraph &_sceneGraph;
+		const FormatConfig &_config;
+		core::Map<int, Entry> _entries;
+		size_t _nonEmpty = 0u;
+
+		voxel::ChunkMesh *extract(const scenegraph::SceneGraphNode &node) const;
+
+	public:
+		MeshStream(const scenegraph::SceneGraph &sceneGraph, const FormatConfig &config);
+		~MeshStream();
+
+		/**
+		 * @brief Extracts the meshes of all nodes in parallel - the whole scene is kept in memory until the nodes get
+		 * released
+		 */
+		void extractAll();
+		/**
+		 * @return The mesh of the given model or model reference node or @c nullptr if the mesh is empty
+		 * @note Each call must be paired with a call to @c release() for the same node
+		 */
+		voxel::ChunkMesh *acquire(const scenegraph::SceneGraphNode &node);
+		void release(const scenegraph::SceneGraphNode &node);
+		/**
+		 * @return The id of the node the mesh is extracted for - all nodes with the same key share the same mesh
+		 */
+		int key(const scenegraph::SceneGraphNode &node) const;
+		/**
+		 * @return The amount of acquired meshes that were not empty
+		 */
+		size_t nonEmpty() const {
+			return _nonEmpty;
+		}
+		/**
+		 * @brief Creates the @c MeshExt for the given node - the size is taken from the resolved region, which means
+		 * that it's also valid for model references
+		 */
+		MeshExt createMeshExt(voxel::ChunkMesh *mesh, const scenegraph::SceneGraphNode &node) const;
+	};
+
+	/**
+	 * @brief Writes the meshes of the scene graph
+	 *
+	 * The default implementation extracts the meshes of all nodes before they are handed over to @c saveMeshes().
+	 * Formats that are able to write the nodes one after another should override this and acquire and release the
+	 * meshes of the nodes while they are writing them - this keeps only one mesh in memory at a time. They don't have
+	 * to implement @c saveMeshes() then.
+	 */
+	virtual bool saveMeshStream(const scenegraph::SceneGraph &sceneGraph, MeshStream &meshStream,
+								const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale,
+								bool quad, bool withColor, bool withTexCoords);
 	virtual bool saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const scenegraph::SceneGraph &sceneGraph,
 							const Meshes &meshes, const core::String &filename, const io::ArchivePtr &archive,
 							const glm::vec3 &scale = glm::vec3(1.0f), bool quad = false, bool withColor = true,
-							bool withTexCoords = true) = 0;
+							bool withTexCoords = true);
 
 	static MeshExt *getParent(const scenegraph::SceneGraph &sceneGraph, Meshes &meshes, int nodeId);
-	static glm::vec3 getInputScale();
+	glm::vec3 getInputScale() const;
 
 	/**
 	 * @brief Voxelizes the input mesh
@@ -119,17 +225,68 @@ protected:
 	 * @see voxelformat::MeshTri
 	 * @see voxelizeGroups()
 	 */
-	int voxelizeNode(const core::String &uuid, const core::String &name, scenegraph::SceneGraph &sceneGraph,
+	int voxelizeNode(const core::UUID &uuid, const core::String &name, scenegraph::SceneGraph &sceneGraph,
 					 const MeshTriCollection &tris, int parent = 0, bool resetOrigin = true) const;
 	int voxelizeNode(const core::String &name, scenegraph::SceneGraph &sceneGraph, const MeshTriCollection &tris,
 					 int parent = 0, bool resetOrigin = true) const {
-		return voxelizeNode("", name, sceneGraph, tris, parent, resetOrigin);
+		return voxelizeNode(core::UUID(), name, sceneGraph, tris, parent, resetOrigin);
+	}
+	/**
+	 * @brief Voxelizes the triangles of the given source - the memory doesn't depend on the amount of triangles
+	 *
+	 * @see voxelizeNode()
+	 * @see MeshTriSource
+	 */
+	int voxelizeNode(const core::UUID &uuid, const core::String &name, scenegraph::SceneGraph &sceneGraph,
+					 MeshTriSource &source, int parent = 0, bool resetOrigin = true) const;
+	int voxelizeNode(const core::String &name, scenegraph::SceneGraph &sceneGraph, MeshTriSource &source,
+					 int parent = 0, bool resetOrigin = true) const {
+		return voxelizeNode(core::UUID(), name, sceneGraph, source, parent, resetOrigin);
 	}
+	/**
+	 * @brief Splits the triangles of large meshes like game levels into cubic buckets and voxelizes each bucket into
+	 * its own model node below a group node
+	 *
+	 * The side length of the buckets is configured by @c FormatConfig::meshBucketSize. Triangles that are bigger than
+	 * a bucket are subdivided - each triangle belongs to the bucket of its center. If all triangles fit into one
+	 * bucket, this is the same as @c voxelizeNode().
+	 *
+	 * @return The id of the group node or of the model node, or InvalidNodeId if voxelization failed.
+	 */
+	int voxelizeBuckets(const core::String &name, scenegraph::SceneGraph &sceneGraph, const MeshTriCollection &tris,
+						int parent = 0) const;
 
 	/**
-	 * @brief A map with positions and colors that can get averaged from the input triangles
+	 * @brief The positions and colors that can get averaged from the input triangles
+	 */
+	using PosMap = PosSamplingGrid;
+	/**
+	 * @brief Disjoint maps with positions and colors - see @c transformTrisParallel()
+	 */
+	using PosMaps = core::DynamicArray<PosMap>;
+	/**
+	 * @brief The amount of slices along the x axis of the region that are merged in parallel
+	 */
+	static constexpr const int PosMapShards = 16;
+	/**
+	 * @brief The part of the region that belongs to the given slice - might be invalid for small regions
 	 */
-	typedef core::Map<glm::ivec3, PosSampling, 64, glm::hash<glm::ivec3>> PosMap;
+	static voxel::Region shardRegion(const voxel::Region &region, int shard);
+	/**
+	 * @brief The amount of input triangles that are subdivided or rasterized in one task
+	 */
+	static constexpr const int TrisPerTask = 256;
+	/**
+	 * @brief Runs @c func for batches of @c TrisPerTask input triangles on the thread pool and merges the emitted
+	 * positions into @c PosMapShards disjoint maps
+	 *
+	 * @param func Called with the start and end index of the batch and an emit callback that takes the index of the
+	 * input triangle, the position, the area, the color and the normal index. Returns the amount of processed elements.
+	 * @return The sum of the values returned by @c func
+	 */
+	template<class FUNC>
+	static size_t transformTrisBatched(const voxel::Region &region, const MeshTriCollection &tris, PosMaps &posMaps,
+									   FUNC &&func);
 	static void addToPosMap(PosMap &posMap, core::RGBA rgba, uint32_t area, uint8_t normalIdx, const glm::ivec3 &pos,
 							const MeshMaterialPtr &material);
 
@@ -139,10 +296,39 @@ protected:
 	 * @param[in] tris The triangles to voxelize
 	 * @param[out] posMap The PosMap instance to fill with positions and colors
 	 * @sa transformTrisAxisAligned()
+	 * @sa transformTrisParallel()
 	 * @sa voxelizeTris()
 	 */
 	static void transformTris(const voxel::Region &region, const MeshTriCollection &tris, PosMap &posMap,
 							  const palette::NormalPalette &normalPalette);
+	/**
+	 * @brief Subdivides the given input triangles and converts them into a list of positions to place the voxels at
+	 *
+	 * The triangles are subdivided in batches of @c TrisPerTask on the thread pool. Each task sorts the positions of
+	 * its triangles into @c PosMapShards slices along the x axis of the region - the slices are merged in parallel
+	 * afterwards. The result is the same as calling @c subdivideTri() and @c transformTris() for all triangles.
+	 *
+	 * @param[in] tris The triangles to voxelize - they are not yet subdivided
+	 * @param[out] posMaps The disjoint maps of the slices - each map only covers the region of its slice. The maps
+	 * are created if the array is empty - otherwise the positions are added to the given maps.
+	 * @return The amount of subdivided triangles
+	 */
+	static size_t transformTrisParallel(const voxel::Region &region, const MeshTriCollection &tris, PosMaps &posMaps,
+										const palette::NormalPalette &normalPalette);
+	/**
+	 * @brief Conservative rasterization of the given input triangles without subdividing them
+	 *
+	 * Every voxel that overlaps a triangle is visited exactly once for that triangle - the triangles are walked in
+	 * columns along the dominant axis of their normal and only the voxels of the plane within a column are tested
+	 * against the triangle. The color is sampled at the voxel center and weighted by the distance of the center to
+	 * the triangle plane. The work is proportional to the triangle area - not to the size of its bounding box.
+	 *
+	 * @param[in] tris The triangles to voxelize
+	 * @param[out] posMaps The disjoint maps of the slices - see @c transformTrisParallel()
+	 * @return The amount of voxels that were touched by the triangles
+	 */
+	static size_t rasterizeTrisParallel(const voxel::Region &region, const MeshTriCollection &tris, PosMaps &posMaps,
+										const palette::NormalPalette &normalPalette);
 	/**
 	 * @brief Convert the given input triangles into a list of positions to place the voxels at. This version is for
 	 * aligned aligned triangles. This is usually the case for meshes that were exported from voxels.
@@ -157,21 +343,21 @@ protected:
 	/**
 	 * @brief Convert the given @c PosMap into a volume
 	 *
-	 * @note The @c PosMap values can get calculated by @c transformTris() or @c transformTrisAxisAligned()
-	 * @param[in] posMap The @c PosMap values with voxel positions and colors
+	 * @note The @c PosMap values can get calculated by @c transformTrisParallel(), @c rasterizeTrisParallel() or
+	 * @c transformTrisAxisAligned()
+	 * @param[in] posMaps The disjoint @c PosMap values with voxel positions and colors
 	 * @param[in] fillHollow Fill the inner parts of a voxel volume
 	 * @param[out] node The node to create the volume in
 	 */
-	void voxelizeTris(scenegraph::SceneGraphNode &node, const PosMap &posMap, bool fillHollow) const;
+	void voxelizeTris(scenegraph::SceneGraphNode &node, const PosMaps &posMaps, bool fillHollow) const;
 
 public:
-	MeshFormat();
 	bool loadGroups(const core::String &filename, const io::ArchivePtr &archive, scenegraph::SceneGraph &sceneGraph,
 					const LoadContext &ctx) override;
 	bool saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
 					const io::ArchivePtr &archive, const SaveContext &ctx) override;
 
-	enum VoxelizeMode { HighQuality = 0, Fast = 1 };
+	enum VoxelizeMode { HighQuality = 0, Fast = 1, Rasterize = 2 };
 };
 
 } // namespace voxelformat
@@ -3,6 +3,8 @@
  */
 
 #include "MeshMaterial.h"
+#include <glm/common.hpp>
+#include <glm/exponential.hpp>
 
 namespace voxelformat {
 
@@ -48,17 +50,57 @@ core::RGBA MeshMaterial::apply(core::RGBA color) const {
 	return color;
 }
 
-bool MeshMaterial::colorAt(core::RGBA &color, const glm::vec2 &uv, bool originUpperLeft) const {
+bool MeshMaterial::colorAt(core::RGBA &color, const glm::vec2 &uv, bool originUpperLeft, float uvArea) const {
 	if (!texture || !texture->isLoaded()) {
 		if (baseColorFactor <= 0.0f) {
 			return false;
 		}
 		color = core::RGBA(0, 0, 0);
 	} else {
-		color = texture->colorAt(uv, wrapS, wrapT, originUpperLeft);
+		const image::Image *image = texture.get();
+		const float texels = uvArea * (float)texture->width() * (float)texture->height();
+		if (texels > 1.0f && !mipmaps.empty()) {
+			// each level halves the size in both directions - and covers four times the texels
+			const int level = glm::min((int)(0.5f * glm::log2(texels)), (int)mipmaps.size());
+			if (level > 0) {
+				image = mipmaps[level - 1].get();
+			}
+		}
+		color = image->colorAt(uv, wrapS, wrapT, originUpperLeft);
 	}
 	color = apply(color);
 	return true;
 }
 
+void MeshMaterial::generateMipmaps() {
+	if (!mipmaps.empty() || !texture || !texture->isLoaded()) {
+		return;
+	}
+	const image::Image *source = texture.get();
+	while (source->width() > 1 || source->height() > 1) {
+		const int w = glm::max(1, source->width() / 2);
+		const int h = glm::max(1, source->height() / 2);
+		image::ImagePtr mipmap = image::createEmptyImage(texture->name());
+		const bool loaded = mipmap->load(w, h, [source](int x, int y, core::RGBA &rgba) {
+			const int x0 = glm::min(x * 2, source->width() - 1);
+			const int y0 = glm::min(y * 2, source->height() - 1);
+			const int x1 = glm::min(x0 + 1, source->width() - 1);
+			const int y1 = glm::min(y0 + 1, source->height() - 1);
+			const core::RGBA c00 = source->colorAt(x0, y0);
+			const core::RGBA c10 = source->colorAt(x1, y0);
+			const core::RGBA c01 = source->colorAt(x0, y1);
+			const core::RGBA c11 = source->colorAt(x1, y1);
+			rgba.r = (uint8_t)(((int)c00.r + c10.r + c01.r + c11.r + 2) / 4);
+			rgba.g = (uint8_t)(((int)c00.g + c10.g + c01.g + c11.g + 2) / 4);
+			rgba.b = (uint8_t)(((int)c00.b + c10.b + c01.b + c11.b + 2) / 4);
+			rgba.a = (uint8_t)(((int)c00.a + c10.a + c01.a + c11.a + 2) / 4);
+		});
+		if (!loaded) {
+			break;
+		}
+		mipmaps.push_back(mipmap);
+		source = mipmap.get();
+	}
+}
+
 } // namespace voxelformat
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "core/SharedPtr.h"
+#include "core/collection/DynamicArray.h"
 #include "core/collection/StringMap.h"
 #include "image/Image.h"
 #include "palette/Material.h"
@@ -24,11 +25,26 @@ public:
 	core::RGBA emitColor{0, 0, 0, 0};
 	float baseColorFactor = 0.0f;
 	float transparency = 0.0f;
+	/**
+	 * @brief Box filtered versions of the texture - the first entry is half the size of the texture
+	 * @sa generateMipmaps()
+	 */
+	core::DynamicArray<image::ImagePtr> mipmaps;
 
 	int width() const;
 	int height() const;
 	[[nodiscard]] core::RGBA apply(core::RGBA color) const;
-	[[nodiscard]] bool colorAt(core::RGBA &color, const glm::vec2 &uv, bool originUpperLeft = false) const;
+	/**
+	 * @param uvArea The area of the sampled surface in uv space - this selects the mipmap level that matches the
+	 * amount of texels that are covered. @c 0 samples the texture itself.
+	 */
+	[[nodiscard]] bool colorAt(core::RGBA &color, const glm::vec2 &uv, bool originUpperLeft = false,
+							   float uvArea = 0.0f) const;
+	/**
+	 * @brief Creates the mipmaps of the texture if they don't exist yet
+	 * @note Not thread safe - must be called before the material is sampled from several threads
+	 */
+	void generateMipmaps();
 };
 
 using MeshMaterialPtr = core::SharedPtr<MeshMaterial>;
@@ -3,6 +3,7 @@
  */
 
 #include "MeshTri.h"
+#include <glm/common.hpp>
 #include <glm/ext/scalar_common.hpp>
 #include <glm/ext/scalar_constants.hpp>
 #include <glm/geometric.hpp>
@@ -29,14 +30,21 @@ core::RGBA MeshTri::blendedColor() const {
 	return core::RGBA::mix(core::RGBA::mix(color[0], color[1]), color[2]);
 }
 
+float MeshTri::uvArea() const {
+	const glm::vec2 e1 = uv[1] - uv[0];
+	const glm::vec2 e2 = uv[2] - uv[0];
+	return glm::abs(e1.x * e2.y - e1.y * e2.x) * 0.5f;
+}
+
 core::RGBA MeshTri::centerColor() const {
 	const glm::vec2 &c = centerUV();
-	return colorAt(c);
+	// the center sample represents the whole triangle - sample the mipmap level for the covered texels
+	return colorAt(c, false, uvArea());
 }
 
-core::RGBA MeshTri::colorAt(const glm::vec2 &inputuv, bool originUpperLeft) const {
+core::RGBA MeshTri::colorAt(const glm::vec2 &inputuv, bool originUpperLeft, float uvArea) const {
 	core::RGBA rgba;
-	if (!material || !material->colorAt(rgba, inputuv, originUpperLeft)) {
+	if (!material || !material->colorAt(rgba, inputuv, originUpperLeft, uvArea)) {
 		rgba = blendedColor();
 	}
 	return rgba;
@@ -76,4 +84,14 @@ bool MeshTri::calcUVs(const glm::vec3 &pos, glm::vec2 &outUV) const {
 	return false;
 }
 
+glm::vec2 MeshTri::clampedUV(const glm::vec3 &pos) const {
+	glm::vec3 b = glm::max(calculateBarycentric(pos), glm::vec3(0.0f));
+	const float sum = b.x + b.y + b.z;
+	if (sum <= 0.0f) {
+		return centerUV();
+	}
+	b /= sum;
+	return b.x * uv[0] + b.y * uv[1] + b.z * uv[2];
+}
+
 } // namespace voxelformat
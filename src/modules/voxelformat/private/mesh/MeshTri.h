@@ -26,13 +26,24 @@ struct MeshTri : public math::Tri {
 	MeshMaterialPtr material;
 
 	[[nodiscard]] glm::vec2 centerUV() const;
+	/**
+	 * @return The area of the triangle in uv space
+	 */
+	[[nodiscard]] float uvArea() const;
 
 	/**
 	 * @return @c false if the given position is not within the triangle area. The value of uv should not be used in
 	 * this case.
 	 */
 	[[nodiscard]] bool calcUVs(const glm::vec3 &pos, glm::vec2 &uv) const;
-	[[nodiscard]] core::RGBA colorAt(const glm::vec2 &uv, bool originUpperLeft = false) const;
+	/**
+	 * @brief Like @c calcUVs() but positions outside of the triangle are clamped to its border
+	 */
+	[[nodiscard]] glm::vec2 clampedUV(const glm::vec3 &pos) const;
+	/**
+	 * @param uvArea see @c MeshMaterial::colorAt()
+	 */
+	[[nodiscard]] core::RGBA colorAt(const glm::vec2 &uv, bool originUpperLeft = false, float uvArea = 0.0f) const;
 	[[nodiscard]] core::RGBA extracted() const;
 	[[nodiscard]] core::RGBA centerColor() const;
 	[[nodiscard]] core::RGBA blendedColor() const;
@@ -98,9 +98,9 @@ bool OBJFormat::writeMtlFile(io::SeekableWriteStream &stream, const core::String
 	return true;
 }
 
-bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes,
-						   const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale,
-						   bool quad, bool withColor, bool withTexCoords) {
+bool OBJFormat::saveMeshStream(const scenegraph::SceneGraph &sceneGraph, MeshStream &meshStream,
+							   const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale,
+							   bool quad, bool withColor, bool withTexCoords) {
 	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(filename));
 	if (!stream) {
 		Log::error("Could not open file %s", filename.c_str());
@@ -110,7 +110,7 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 	wrapBool(stream->writeStringFormat(false, "\n"))
 	wrapBool(stream->writeStringFormat(false, "g Model\n"))
 
-	Log::debug("Exporting %i layers", (int)meshes.size());
+	Log::debug("Exporting %i layers", (int)sceneGraph.size(scenegraph::SceneGraphNodeType::AllModels));
 
 	const core::String &mtlname = core::string::replaceExtension(filename, "mtl");
 	Log::debug("Use mtl file: %s", mtlname.c_str());
@@ -123,7 +123,14 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 
 	int idxOffset = 0;
 	int texcoordOffset = 0;
-	for (const auto &meshExt : meshes) {
+	// the meshes are written and freed one after another
+	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
+		voxel::ChunkMesh *chunkMesh = meshStream.acquire(*iter);
+		if (chunkMesh == nullptr) {
+			meshStream.release(*iter);
+			continue;
+		}
+		const MeshExt meshExt = meshStream.createMeshExt(chunkMesh, *iter);
 		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
 			const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
 			if (mesh->isEmpty()) {
@@ -272,6 +279,7 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 				}
 			}
 		}
+		meshStream.release(*iter);
 	}
 	return true;
 }
@@ -359,7 +367,8 @@ bool OBJFormat::voxelizeGroups(const core::String &filename, const io::ArchivePt
 		meshMaterial->transparency = 1.0f - material.dissolve;
 
 		if (!material.diffuse_texname.empty()) {
-			const core::String &diffuseTextureName = lookupTexture(filename, material.diffuse_texname.c_str(), archive);
+			const core::String &diffuseTextureName =
+				lookupTexture(filename, material.diffuse_texname.c_str(), archive, _config.texturePath);
 			image::ImagePtr diffuseTexture = image::loadImage(diffuseTextureName);
 			if (diffuseTexture->isLoaded()) {
 				Log::debug("Use image %s", diffuseTextureName.c_str());
@@ -31,9 +31,9 @@ protected:
 						scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) override;
 
 public:
-	bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &meshes,
-					const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale, bool quad,
-					bool withColor, bool withTexCoords) override;
+	bool saveMeshStream(const scenegraph::SceneGraph &sceneGraph, MeshStream &meshStream,
+						const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale, bool quad,
+						bool withColor, bool withTexCoords) override;
 
 	static const io::FormatDescription &format() {
 		static io::FormatDescription f{"Wavefront Object", {"obj"}, {}, VOX_FORMAT_FLAG_MESH | FORMAT_FLAG_SAVE};
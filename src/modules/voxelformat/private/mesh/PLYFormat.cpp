@@ -10,6 +10,7 @@
 #include "core/collection/DynamicArray.h"
 #include "engine-config.h"
 #include "io/Archive.h"
+#include "io/BufferedReadWriteStream.h"
 #include "io/EndianStreamReadWrapper.h"
 #include "palette/Palette.h"
 #include "scenegraph/SceneGraph.h"
@@ -279,12 +280,16 @@ bool PLYFormat::parseHeader(io::SeekableReadStream &stream, Header &header) {
 }
 
 bool PLYFormat::parseFacesAscii(const Element &element, io::SeekableReadStream &stream,
-								core::DynamicArray<PLYFace> &faces, core::DynamicArray<PLYPolygon> &polygons) const {
+								core::DynamicArray<PLYFace> &faces, core::DynamicArray<PLYPolygon> &polygons,
+								const std::function<bool()> &flush) const {
 	core::DynamicArray<core::String> tokens;
 	tokens.reserve(32);
 
-	faces.reserve(element.count);
+	faces.reserve(core_min((size_t)element.count, MeshTriSource::BatchSize) + 1);
 	for (int idx = 0; idx < element.count; ++idx) {
+		if (faces.size() + polygons.size() >= MeshTriSource::BatchSize && !flush()) {
+			return false;
+		}
 		core::String line;
 		wrapBool(stream.readLine(line))
 		tokens.clear();
@@ -539,11 +544,14 @@ void PLYFormat::triangulatePolygons(const core::DynamicArray<PLYPolygon> &polygo
 
 bool PLYFormat::parseFacesBinary(const Element &element, io::SeekableReadStream &stream,
 								 core::DynamicArray<PLYFace> &faces, core::DynamicArray<PLYPolygon> &polygons,
-								 const Header &header) const {
+								 const Header &header, const std::function<bool()> &flush) const {
 	io::EndianStreamReadWrapper es(stream, header.format == PlyFormatType::BinaryBigEndian);
 	Log::debug("loading %i faces", element.count);
-	faces.reserve(element.count);
+	faces.reserve(core_min((size_t)element.count, MeshTriSource::BatchSize) + 1);
 	for (int i = 0; i < element.count; ++i) {
+		if (faces.size() + polygons.size() >= MeshTriSource::BatchSize && !flush()) {
+			return false;
+		}
 		for (size_t j = 0; j < element.properties.size(); ++j) {
 			const Property &prop = element.properties[j];
 			if (!prop.isList) {
@@ -655,84 +663,124 @@ bool PLYFormat::skipElementBinary(const Element &element, io::SeekableReadStream
 
 bool PLYFormat::parseMeshBinary(const core::String &filename, io::SeekableReadStream &stream,
 								scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx, const Header &header,
-								MeshTriCollection &tris) const {
-	core::DynamicArray<PLYVertex> vertices;
-	core::DynamicArray<PLYFace> faces;
-	core::DynamicArray<PLYPolygon> polygons;
+								core::DynamicArray<PLYVertex> &vertices, int64_t &facesPos) const {
 	for (int i = 0; i < (int)header.elements.size(); ++i) {
 		const Element &element = header.elements[i];
 		if (element.name == "vertex") {
 			if (!parseVerticesBinary(element, stream, vertices, header)) {
 				return false;
 			}
-		} else if (element.name == "face") {
-			if (!parseFacesBinary(element, stream, faces, polygons, header)) {
-				return false;
-			}
-		} else {
-			if (!skipElementBinary(element, stream, header)) {
-				Log::error("Failed to skip element %s", element.name.c_str());
-				return false;
-			}
 			continue;
 		}
+		if (element.name == "face") {
+			facesPos = stream.pos();
+		}
+		if (!skipElementBinary(element, stream, header)) {
+			Log::error("Failed to skip element %s", element.name.c_str());
+			return false;
+		}
 	}
-
-	triangulatePolygons(polygons, vertices, faces);
-	convertToTris(tris, vertices, faces);
-
 	return true;
 }
 
 bool PLYFormat::parseMeshAscii(const core::String &filename, io::SeekableReadStream &stream,
 							   scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx, const Header &header,
-							   MeshTriCollection &tris) const {
-	core::DynamicArray<PLYVertex> vertices;
-	core::DynamicArray<PLYFace> faces;
-	core::DynamicArray<PLYPolygon> polygons;
+							   core::DynamicArray<PLYVertex> &vertices, int64_t &facesPos) const {
 	for (int i = 0; i < (int)header.elements.size(); ++i) {
 		const Element &element = header.elements[i];
 		if (element.name == "vertex") {
 			if (!parseVerticesAscii(element, stream, vertices)) {
 				return false;
 			}
-		} else if (element.name == "face") {
-			if (!parseFacesAscii(element, stream, faces, polygons)) {
-				return false;
-			}
-		} else {
-			for (int skip = 0; skip < element.count; ++skip) {
-				core::String line;
-				wrapBool(stream.readLine(line))
-			}
 			continue;
 		}
+		if (element.name == "face") {
+			facesPos = stream.pos();
+		}
+		for (int skip = 0; skip < element.count; ++skip) {
+			core::String line;
+			wrapBool(stream.readLine(line))
+		}
 	}
+	return true;
+}
 
-	triangulatePolygons(polygons, vertices, faces);
-	convertToTris(tris, vertices, faces);
-
+bool PLYFormat::parseFaces(io::SeekableReadStream &stream, const Header &header, const Element &element,
+						   core::DynamicArray<PLYVertex> &vertices, MeshTriCollection &tris,
+						   const std::function<bool()> &flush) const {
+	core::DynamicArray<PLYFace> faces;
+	core::DynamicArray<PLYPolygon> polygons;
+	auto convert = [&]() {
+		triangulatePolygons(polygons, vertices, faces);
+		convertToTris(tris, vertices, faces);
+		faces.clear();
+		polygons.clear();
+	};
+	auto flushFaces = [&]() {
+		convert();
+		return flush();
+	};
+	if (header.format == PlyFormatType::Ascii) {
+		if (!parseFacesAscii(element, stream, faces, polygons, flushFaces)) {
+			return false;
+		}
+	} else if (!parseFacesBinary(element, stream, faces, polygons, header, flushFaces)) {
+		return false;
+	}
+	convert();
 	return true;
 }
 
+class PLYFormat::PLYSource : public MeshTriSource {
+private:
+	const PLYFormat &_format;
+	io::SeekableReadStream &_stream;
+	const Header &_header;
+	const Element &_element;
+	core::DynamicArray<PLYVertex> &_vertices;
+	const int64_t _facesPos;
+
+protected:
+	bool produce(MeshTriCollection &tris, const std::function<bool()> &flush) override {
+		if (_stream.seek(_facesPos) == -1) {
+			Log::error("Failed to seek to the ply faces");
+			return false;
+		}
+		return _format.parseFaces(_stream, _header, _element, _vertices, tris, flush);
+	}
+
+public:
+	PLYSource(const PLYFormat &format, io::SeekableReadStream &stream, const Header &header, const Element &element,
+			  core::DynamicArray<PLYVertex> &vertices, int64_t facesPos)
+		: _format(format), _stream(stream), _header(header), _element(element), _vertices(vertices),
+		  _facesPos(facesPos) {
+	}
+};
+
 bool PLYFormat::parseMesh(const core::String &filename, io::SeekableReadStream &stream,
 						  scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx, const Header &header) {
-	MeshTriCollection tris;
+	// only the vertices are kept in memory - the faces are read in batches for each pass of the voxelization
+	core::DynamicArray<PLYVertex> vertices;
+	int64_t facesPos = -1;
 	if (header.format == PlyFormatType::Ascii) {
-		if (!parseMeshAscii(filename, stream, sceneGraph, ctx, header, tris)) {
+		if (!parseMeshAscii(filename, stream, sceneGraph, ctx, header, vertices, facesPos)) {
 			return false;
 		}
 	} else if (header.format == PlyFormatType::BinaryLittleEndian || header.format == PlyFormatType::BinaryBigEndian) {
-		if (!parseMeshBinary(filename, stream, sceneGraph, ctx, header, tris)) {
+		if (!parseMeshBinary(filename, stream, sceneGraph, ctx, header, vertices, facesPos)) {
 			return false;
 		}
 	}
+	auto predicate = [](const Element &e) { return e.name == "face"; };
+	auto faceElement = core::find_if(header.elements.begin(), header.elements.end(), predicate);
+	if (facesPos < 0 || faceElement == header.elements.end()) {
+		Log::error("No faces found in ply file %s", filename.c_str());
+		return false;
+	}
 
 	const glm::vec3 scale = getInputScale();
-	for (voxelformat::MeshTri &meshTri : tris) {
-		meshTri.vertices[0] *= scale;
-		meshTri.vertices[1] *= scale;
-		meshTri.vertices[2] *= scale;
+	for (PLYVertex &vertex : vertices) {
+		vertex.position *= scale;
 	}
 
 	if (!header.comment.empty()) {
@@ -740,7 +788,8 @@ bool PLYFormat::parseMesh(const core::String &filename, io::SeekableReadStream &
 		root.setProperty("comment", header.comment);
 	}
 
-	return voxelizeNode(filename, sceneGraph, tris);
+	PLYSource source(*this, stream, header, *faceElement, vertices, facesPos);
+	return voxelizeNode(filename, sceneGraph, source);
 }
 
 bool PLYFormat::voxelizeGroups(const core::String &filename, const io::ArchivePtr &archive,
@@ -775,37 +824,25 @@ bool PLYFormat::voxelizeGroups(const core::String &filename, const io::ArchivePt
 #undef wrapBool
 #undef wrap
 
-bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes,
-						   const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale,
-						   bool quad, bool withColor, bool withTexCoords) {
+bool PLYFormat::saveMeshStream(const scenegraph::SceneGraph &sceneGraph, MeshStream &meshStream,
+							   const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale,
+							   bool quad, bool withColor, bool withTexCoords) {
 	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(filename));
 	if (!stream) {
 		Log::error("Could not open file %s", filename.c_str());
 		return false;
 	}
-	int elementsCnt = 0;
-	int indicesCnt = 0;
-	for (const auto &meshExt : meshes) {
-		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
-			const voxel::Mesh &mesh = meshExt.mesh->mesh[i];
-			if (mesh.isEmpty()) {
-				continue;
-			}
-			elementsCnt += (int)mesh.getNoOfVertices();
-			indicesCnt += (int)mesh.getNoOfIndices();
-		}
-	}
-
-	if (elementsCnt == 0 || indicesCnt == 0) {
-		return false;
-	}
 
 	const core::String paletteName = core::string::replaceExtension(voxel::getPalette().name(), "png");
 	stream->writeStringFormat(false, "ply\nformat ascii 1.0\n");
 	stream->writeStringFormat(false, "comment version " PROJECT_VERSION " github.com/vengi-voxel/vengi\n");
 	stream->writeStringFormat(false, "comment TextureFile %s\n", paletteName.c_str());
 
-	stream->writeStringFormat(false, "element vertex %i\n", elementsCnt);
+	// the amount of vertices and faces is only known after all meshes were written - the zero padded placeholders
+	// are patched at the end
+	stream->writeStringFormat(false, "element vertex ");
+	const int64_t vertexCountPos = stream->pos();
+	stream->writeStringFormat(false, "%010i\n", 0);
 	stream->writeStringFormat(false, "property float x\n");
 	stream->writeStringFormat(false, "property float z\n");
 	stream->writeStringFormat(false, "property float y\n");
@@ -820,24 +857,34 @@ bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 		stream->writeStringFormat(false, "property uchar alpha\n");
 	}
 
-	int faces;
-	if (quad) {
-		faces = indicesCnt / 6;
-	} else {
-		faces = indicesCnt / 3;
-	}
-
-	stream->writeStringFormat(false, "element face %i\n", faces);
+	stream->writeStringFormat(false, "element face ");
+	const int64_t faceCountPos = stream->pos();
+	stream->writeStringFormat(false, "%010i\n", 0);
 	stream->writeStringFormat(false, "property list uchar uint vertex_indices\n");
 	stream->writeStringFormat(false, "end_header\n");
 
-	for (const auto &meshExt : meshes) {
+	// the faces follow the vertices of all meshes - only the faces are kept in memory while the meshes are freed
+	io::BufferedReadWriteStream faceStream;
+	int idxOffset = 0;
+	int faces = 0;
+	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
+		voxel::ChunkMesh *chunkMesh = meshStream.acquire(*iter);
+		if (chunkMesh == nullptr) {
+			meshStream.release(*iter);
+			continue;
+		}
+		const MeshExt meshExt = meshStream.createMeshExt(chunkMesh, *iter);
 		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
 			const voxel::Mesh &mesh = meshExt.mesh->mesh[i];
 			if (mesh.isEmpty()) {
 				continue;
 			}
 			const int nv = (int)mesh.getNoOfVertices();
+			const int ni = (int)mesh.getNoOfIndices();
+			if (ni % 3 != 0) {
+				Log::error("Unexpected indices amount");
+				return false;
+			}
 			const voxel::VoxelVertex *vertices = mesh.getRawVertexData();
 			const scenegraph::SceneGraphNode &graphNode = sceneGraph.node(meshExt.nodeId);
 			scenegraph::KeyFrameIndex keyFrameIdx = 0;
@@ -864,22 +911,7 @@ bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 				}
 				stream->writeStringFormat(false, "\n");
 			}
-		}
-	}
 
-	int idxOffset = 0;
-	for (const auto &meshExt : meshes) {
-		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
-			const voxel::Mesh &mesh = meshExt.mesh->mesh[i];
-			if (mesh.isEmpty()) {
-				continue;
-			}
-			const int ni = (int)mesh.getNoOfIndices();
-			const int nv = (int)mesh.getNoOfVertices();
-			if (ni % 3 != 0) {
-				Log::error("Unexpected indices amount");
-				return false;
-			}
 			const voxel::IndexType *indices = mesh.getRawIndexData();
 			if (quad) {
 				for (int j = 0; j < ni; j += 6) {
@@ -887,19 +919,36 @@ bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					const uint32_t two = idxOffset + indices[j + 1];
 					const uint32_t three = idxOffset + indices[j + 2];
 					const uint32_t four = idxOffset + indices[j + 5];
-					stream->writeStringFormat(false, "4 %i %i %i %i\n", (int)one, (int)two, (int)three, (int)four);
+					faceStream.writeStringFormat(false, "4 %i %i %i %i\n", (int)one, (int)two, (int)three, (int)four);
 				}
+				faces += ni / 6;
 			} else {
 				for (int j = 0; j < ni; j += 3) {
 					const uint32_t one = idxOffset + indices[j + 0];
 					const uint32_t two = idxOffset + indices[j + 1];
 					const uint32_t three = idxOffset + indices[j + 2];
-					stream->writeStringFormat(false, "3 %i %i %i\n", (int)one, (int)two, (int)three);
+					faceStream.writeStringFormat(false, "3 %i %i %i\n", (int)one, (int)two, (int)three);
 				}
+				faces += ni / 3;
 			}
 			idxOffset += nv;
 		}
+		meshStream.release(*iter);
+	}
+
+	if (idxOffset == 0 || faces == 0) {
+		return false;
+	}
+	if (stream->write(faceStream.getBuffer(), faceStream.size()) != (int)faceStream.size()) {
+		Log::error("Failed to write the ply faces");
+		return false;
 	}
+	const int64_t endPos = stream->pos();
+	stream->seek(vertexCountPos);
+	stream->writeStringFormat(false, "%010i", idxOffset);
+	stream->seek(faceCountPos);
+	stream->writeStringFormat(false, "%010i", faces);
+	stream->seek(endPos);
 	return sceneGraph.firstPalette().save(paletteName.c_str());
 }
 } // namespace voxelformat
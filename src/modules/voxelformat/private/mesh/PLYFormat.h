@@ -81,14 +81,19 @@ protected:
 	static DataType dataType(const core::String &in);
 	static PropertyUse use(const core::String &in);
 	static bool parseHeader(io::SeekableReadStream &stream, Header &header);
+	/**
+	 * @param flush Called once the faces and polygons reach the batch size of @c MeshTriSource - they are expected
+	 * to be empty afterwards
+	 */
 	bool parseFacesAscii(const Element &element, io::SeekableReadStream &stream, core::DynamicArray<PLYFace> &faces,
-						 core::DynamicArray<PLYPolygon> &polygons) const;
+						 core::DynamicArray<PLYPolygon> &polygons, const std::function<bool()> &flush) const;
 	bool parseVerticesAscii(const Element &element, io::SeekableReadStream &stream,
 							core::DynamicArray<PLYVertex> &vertices) const;
 	void triangulatePolygons(const core::DynamicArray<PLYPolygon> &polygons,
 							 const core::DynamicArray<PLYVertex> &vertices, core::DynamicArray<PLYFace> &faces) const;
 	bool parseFacesBinary(const Element &element, io::SeekableReadStream &stream, core::DynamicArray<PLYFace> &faces,
-						  core::DynamicArray<PLYPolygon> &polygons, const Header &header) const;
+						  core::DynamicArray<PLYPolygon> &polygons, const Header &header,
+						  const std::function<bool()> &flush) const;
 	bool parseVerticesBinary(const Element &element, io::SeekableReadStream &stream,
 							 core::DynamicArray<PLYVertex> &vertices, const Header &header) const;
 
@@ -101,14 +106,24 @@ protected:
 	bool parsePointCloud(const core::String &filename, io::SeekableReadStream &stream,
 						 scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx, const Header &header) const;
 
+	/**
+	 * @brief Reads the vertices and remembers the stream position of the face element
+	 */
 	bool parseMeshBinary(const core::String &filename, io::SeekableReadStream &stream,
 						 scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx, const Header &header,
-						 MeshTriCollection &tris) const;
+						 core::DynamicArray<PLYVertex> &vertices, int64_t &facesPos) const;
 	void convertToTris(MeshTriCollection &tris, core::DynamicArray<PLYVertex> &vertices,
 					   core::DynamicArray<PLYFace> &faces) const;
 	bool parseMeshAscii(const core::String &filename, io::SeekableReadStream &stream,
 						scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx, const Header &header,
-						MeshTriCollection &tris) const;
+						core::DynamicArray<PLYVertex> &vertices, int64_t &facesPos) const;
+	/**
+	 * @brief Reads the faces in batches and converts them into triangles - see @c MeshTriSource
+	 */
+	class PLYSource;
+	bool parseFaces(io::SeekableReadStream &stream, const Header &header, const Element &element,
+					core::DynamicArray<PLYVertex> &vertices, MeshTriCollection &tris,
+					const std::function<bool()> &flush) const;
 	bool parseMesh(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph,
 				   const LoadContext &ctx, const Header &header);
 
@@ -116,9 +131,12 @@ protected:
 						const LoadContext &ctx) override;
 
 public:
-	bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &meshes,
-					const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale, bool quad,
-					bool withColor, bool withTexCoords) override;
+	/**
+	 * @note The faces are buffered in memory until the vertices of all meshes were written
+	 */
+	bool saveMeshStream(const scenegraph::SceneGraph &sceneGraph, MeshStream &meshStream,
+						const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale, bool quad,
+						bool withColor, bool withTexCoords) override;
 
 	static const io::FormatDescription &format() {
 		static io::FormatDescription f{"Polygon File Format", {"ply"}, {}, VOX_FORMAT_FLAG_MESH | FORMAT_FLAG_SAVE};
@@ -4,6 +4,8 @@
 
 #include "PosSampling.h"
 #include "core/Color.h"
+#include "core/Common.h"
+#include <glm/vector_relational.hpp>
 
 namespace voxelformat {
 
@@ -134,4 +136,58 @@ core::RGBA PosSampling::getColor(uint8_t flattenFactor, bool weightedAverage) co
 	return core::Color::flattenRGB(color.r, color.g, color.b, color.a, flattenFactor);
 }
 
+PosSamplingGrid::PosSamplingGrid(const voxel::Region &region)
+	: _lower(region.getLowerCorner()), _upper(region.getUpperCorner()) {
+	_bricks = (region.getDimensionsInVoxels() + (BrickSize - 1)) / BrickSize;
+	_brickOffsets.resize((size_t)_bricks.x * _bricks.y * _bricks.z);
+}
+
+uint32_t *PosSamplingGrid::cell(const glm::ivec3 &pos, bool create) {
+	if (glm::any(glm::lessThan(pos, _lower)) || glm::any(glm::greaterThan(pos, _upper))) {
+		return nullptr;
+	}
+	const glm::ivec3 local = pos - _lower;
+	const glm::ivec3 brick = local >> BrickShift;
+	uint32_t &offset = _brickOffsets[((size_t)brick.z * _bricks.y + brick.y) * _bricks.x + brick.x];
+	if (offset == 0u) {
+		if (!create) {
+			return nullptr;
+		}
+		// the array only grows linearly by itself
+		if (_cells.capacity() < _cells.size() + BrickCells) {
+			_cells.reserve(core_max(_cells.capacity() * 2, _cells.size() + BrickCells));
+		}
+		offset = (uint32_t)_cells.size() + 1u;
+		_cells.resize(_cells.size() + BrickCells);
+	}
+	const glm::ivec3 inner = local & (BrickSize - 1);
+	return &_cells[offset - 1u + (inner.z * BrickSize + inner.y) * BrickSize + inner.x];
+}
+
+bool PosSamplingGrid::add(const glm::ivec3 &pos, uint32_t area, core::RGBA color, uint8_t normal,
+						  const MeshMaterialPtr &material) {
+	uint32_t *c = cell(pos, true);
+	if (c == nullptr) {
+		return false;
+	}
+	if (*c != 0u) {
+		_entries[*c - 1u].sampling.add(area, color, normal, material);
+		return true;
+	}
+	if (_entries.capacity() == _entries.size()) {
+		_entries.reserve(core_max((size_t)64, _entries.capacity() * 2));
+	}
+	_entries.emplace_back(pos, PosSampling(area, color, normal, material));
+	*c = (uint32_t)_entries.size();
+	return true;
+}
+
+const PosSampling *PosSamplingGrid::find(const glm::ivec3 &pos) const {
+	const uint32_t *c = const_cast<PosSamplingGrid *>(this)->cell(pos, false);
+	if (c == nullptr || *c == 0u) {
+		return nullptr;
+	}
+	return &_entries[*c - 1u].sampling;
+}
+
 } // namespace voxelformat
@@ -7,6 +7,8 @@
 #include "MeshMaterial.h"
 #include "core/RGBA.h"
 #include "core/collection/Array.h"
+#include "core/collection/DynamicArray.h"
+#include "voxel/Region.h"
 
 #define MaxTriangleColorContributions 4
 #define AlphaThreshold 0
@@ -67,4 +69,73 @@ public:
 	const MeshMaterialPtr &getMaterial() const;
 };
 
+/**
+ * @brief Sparse grid of @c PosSampling values for the positions of a region
+ *
+ * The region is split into bricks of 8x8x8 voxels. The cells of a brick are allocated once the first position of the
+ * brick is added. A lookup is two array accesses and the memory only depends on the touched bricks - not on the
+ * amount of samples or the size of the region.
+ */
+class PosSamplingGrid {
+public:
+	struct Entry {
+		Entry(const glm::ivec3 &_pos, const PosSampling &_sampling) : pos(_pos), sampling(_sampling) {
+		}
+		glm::ivec3 pos;
+		PosSampling sampling;
+	};
+	using Entries = core::DynamicArray<Entry>;
+
+private:
+	static constexpr int BrickShift = 3;
+	static constexpr int BrickSize = 1 << BrickShift;
+	static constexpr int BrickCells = BrickSize * BrickSize * BrickSize;
+
+	glm::ivec3 _lower;
+	glm::ivec3 _upper;
+	glm::ivec3 _bricks;
+	/**
+	 * @brief The offset of the brick cells + 1 for each brick of the region - @c 0 for bricks without samples
+	 */
+	core::DynamicArray<uint32_t> _brickOffsets;
+	/**
+	 * @brief The index of the entry + 1 for each cell of the allocated bricks - @c 0 for cells without samples
+	 */
+	core::DynamicArray<uint32_t> _cells;
+	Entries _entries;
+
+	uint32_t *cell(const glm::ivec3 &pos, bool create);
+
+public:
+	PosSamplingGrid(const voxel::Region &region);
+
+	/**
+	 * @return @c false if the position is outside of the region
+	 */
+	bool add(const glm::ivec3 &pos, uint32_t area, core::RGBA color, uint8_t normal, const MeshMaterialPtr &material);
+	/**
+	 * @return @c nullptr if there are no samples for the given position
+	 */
+	const PosSampling *find(const glm::ivec3 &pos) const;
+
+	/**
+	 * @brief The positions with samples in the order they were added
+	 */
+	inline const Entries &entries() const {
+		return _entries;
+	}
+
+	inline size_t size() const {
+		return _entries.size();
+	}
+
+	inline Entries::iterator begin() const {
+		return _entries.begin();
+	}
+
+	inline Entries::iterator end() const {
+		return _entries.end();
+	}
+};
+
 } // namespace voxelformat
@@ -4,6 +4,7 @@
 
 #include "STLFormat.h"
 #include "core/Color.h"
+#include "core/Endian.h"
 #include "core/FourCC.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
@@ -16,11 +17,14 @@ namespace voxelformat {
 
 namespace priv {
 static constexpr const size_t BinaryHeaderSize = 80;
+// normal, three vertices and the attribute byte count
+static constexpr const size_t BinaryRecordSize = 12 * sizeof(float) + sizeof(uint16_t);
+static constexpr const size_t RecordsPerRead = 256;
 }
 
-bool STLFormat::parseAscii(io::SeekableReadStream &stream, MeshTriCollection &tris) {
+bool STLFormat::parseAscii(io::SeekableReadStream &stream, const glm::vec3 &scale, MeshTriCollection &tris,
+						   const std::function<bool()> &flush) {
 	char line[512];
-	const glm::vec3 &scale = getInputScale();
 	stream.seek(0);
 	while (stream.readLine(sizeof(line), line)) {
 		if (!strncmp(line, "solid", 5)) {
@@ -67,6 +71,9 @@ bool STLFormat::parseAscii(io::SeekableReadStream &stream, MeshTriCollection &tr
 							return false;
 						}
 						tris.push_back(meshTri);
+						if (tris.size() >= MeshTriSource::BatchSize && !flush()) {
+							return false;
+						}
 					}
 				}
 			}
@@ -81,8 +88,8 @@ bool STLFormat::parseAscii(io::SeekableReadStream &stream, MeshTriCollection &tr
 		return false;                                                                                                  \
 	}
 
-bool STLFormat::parseBinary(io::SeekableReadStream &stream, MeshTriCollection &tris) {
-	const glm::vec3 &scale = getInputScale();
+bool STLFormat::parseBinary(io::SeekableReadStream &stream, const glm::vec3 &scale, MeshTriCollection &tris,
+							const std::function<bool()> &flush) {
 	if (stream.seek(priv::BinaryHeaderSize) == -1) {
 		Log::error("Failed to seek after the binary stl header");
 		return false;
@@ -94,21 +101,33 @@ bool STLFormat::parseBinary(io::SeekableReadStream &stream, MeshTriCollection &t
 		Log::error("No faces in stl file");
 		return false;
 	}
-	tris.resize(numFaces);
-	for (uint32_t fn = 0; fn < numFaces; ++fn) {
-		voxelformat::MeshTri &meshTri = tris[fn];
-		glm::vec3 normal;
-		wrap(stream.readFloat(normal.x))
-		wrap(stream.readFloat(normal.y))
-		wrap(stream.readFloat(normal.z))
-		for (int i = 0; i < 3; ++i) {
-			wrap(stream.readFloat(meshTri.vertices[i].x))
-			wrap(stream.readFloat(meshTri.vertices[i].y))
-			wrap(stream.readFloat(meshTri.vertices[i].z))
-			meshTri.vertices[i] *= scale;
+	// the face records are read in blocks and decoded from memory
+	uint8_t records[priv::RecordsPerRead * priv::BinaryRecordSize];
+	uint32_t fn = 0;
+	while (fn < numFaces) {
+		const uint32_t n = core_min(numFaces - fn, (uint32_t)priv::RecordsPerRead);
+		if (stream.read(records, n * priv::BinaryRecordSize) != (int)(n * priv::BinaryRecordSize)) {
+			Log::error("Failed to read the stl faces %u of %u", fn, numFaces);
+			return false;
+		}
+		for (uint32_t r = 0; r < n; ++r) {
+			// skip the normal
+			const uint8_t *record = records + r * priv::BinaryRecordSize + 3 * sizeof(float);
+			voxelformat::MeshTri meshTri;
+			for (int i = 0; i < 3; ++i) {
+				for (int j = 0; j < 3; ++j) {
+					uint32_t bits;
+					memcpy(&bits, record, sizeof(bits));
+					bits = core_swap32le(bits);
+					memcpy(&meshTri.vertices[i][j], &bits, sizeof(bits));
+					record += sizeof(bits);
+				}
+				meshTri.vertices[i] *= scale;
+			}
+			tris.push_back(meshTri);
 		}
-		if (stream.skip(2) == -1) {
-			Log::error("Failed to seek while parsing the frames");
+		fn += n;
+		if (tris.size() >= MeshTriSource::BatchSize && !flush()) {
 			return false;
 		}
 	}
@@ -116,6 +135,26 @@ bool STLFormat::parseBinary(io::SeekableReadStream &stream, MeshTriCollection &t
 	return true;
 }
 
+class STLFormat::STLSource : public MeshTriSource {
+private:
+	io::SeekableReadStream &_stream;
+	const glm::vec3 _scale;
+	const bool _ascii;
+
+protected:
+	bool produce(MeshTriCollection &tris, const std::function<bool()> &flush) override {
+		if (_ascii) {
+			return parseAscii(_stream, _scale, tris, flush);
+		}
+		return parseBinary(_stream, _scale, tris, flush);
+	}
+
+public:
+	STLSource(io::SeekableReadStream &stream, const glm::vec3 &scale, bool ascii)
+		: _stream(stream), _scale(scale), _ascii(ascii) {
+	}
+};
+
 bool STLFormat::voxelizeGroups(const core::String &filename, const io::ArchivePtr &archive,
 							   scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) {
 	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
@@ -127,22 +166,15 @@ bool STLFormat::voxelizeGroups(const core::String &filename, const io::ArchivePt
 	wrap(stream->readUInt32(magic));
 	const bool ascii = FourCC('s', 'o', 'l', 'i') == magic;
 
-	MeshTriCollection tris;
-	if (ascii) {
-		Log::debug("found ascii format");
-		if (!parseAscii(*stream, tris)) {
-			Log::error("Failed to parse ascii stl file %s", filename.c_str());
-			return false;
-		}
-	} else {
-		Log::debug("found binary format");
-		if (!parseBinary(*stream, tris)) {
-			Log::error("Failed to parse binary stl file %s", filename.c_str());
-			return false;
-		}
-	}
+	Log::debug("found %s format", ascii ? "ascii" : "binary");
 
-	return voxelizeNode(filename, sceneGraph, tris) > 0;
+	// the file is parsed again for each pass of the voxelization - large files are never fully kept in memory
+	STLSource source(*stream, getInputScale(), ascii);
+	if (voxelizeNode(filename, sceneGraph, source) <= 0) {
+		Log::error("Failed to voxelize stl file %s", filename.c_str());
+		return false;
+	}
+	return true;
 }
 
 #undef wrap
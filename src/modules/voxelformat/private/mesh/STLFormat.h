@@ -39,8 +39,14 @@ private:
 	bool writeVertex(io::SeekableWriteStream &stream, const MeshExt &meshExt, const voxel::VoxelVertex &v1,
 					 const scenegraph::SceneGraphTransform &transform, const glm::vec3 &scale);
 
-	bool parseBinary(io::SeekableReadStream &stream, MeshTriCollection &tris);
-	bool parseAscii(io::SeekableReadStream &stream, MeshTriCollection &tris);
+	/**
+	 * @brief Reads the triangles of the stl file in batches - see @c MeshTriSource
+	 */
+	class STLSource;
+	static bool parseBinary(io::SeekableReadStream &stream, const glm::vec3 &scale, MeshTriCollection &tris,
+							const std::function<bool()> &flush);
+	static bool parseAscii(io::SeekableReadStream &stream, const glm::vec3 &scale, MeshTriCollection &tris,
+						   const std::function<bool()> &flush);
 
 	bool voxelizeGroups(const core::String &filename, const io::ArchivePtr &archive,
 						scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) override;
@@ -14,12 +14,15 @@ namespace voxelformat {
  * @brief Tries to find a texture that matches the given not-yet-found texture name somewhere in the search path or in
  * some directory relative to the given reference file. It can also handle inputs without extensions - we apply the
  * extensions for all supported image files that could serve as textures here.
+ *
+ * @param searchPath An additional directory to search in - see @c FormatConfig::texturePath
  */
-core::Path lookupTexture(const core::Path &referenceFile, const core::Path &file, const io::ArchivePtr &archive);
+core::Path lookupTexture(const core::Path &referenceFile, const core::Path &file, const io::ArchivePtr &archive,
+						 const core::String &searchPath = "");
 
 inline core::String lookupTexture(const core::String &referenceFile, const core::String &file,
-								  const io::ArchivePtr &archive) {
-	const core::Path &path = lookupTexture(core::Path(referenceFile), core::Path(file), archive);
+								  const io::ArchivePtr &archive, const core::String &searchPath = "") {
+	const core::Path &path = lookupTexture(core::Path(referenceFile), core::Path(file), archive, searchPath);
 	return path.lexicallyNormal();
 }
 
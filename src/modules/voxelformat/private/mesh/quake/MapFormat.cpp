@@ -208,7 +208,7 @@ bool MapFormat::parseBrush(const core::String &filename, const io::ArchivePtr &a
 		auto iter = materials.find(qface.texture);
 		MeshMaterialPtr material;
 		if (iter == materials.end()) {
-			const core::String &imageName = lookupTexture(filename, qface.texture, archive);
+			const core::String &imageName = lookupTexture(filename, qface.texture, archive, _config.texturePath);
 			const image::ImagePtr &image = image::loadImage(imageName);
 			material = createMaterial(image);
 			materials.put(qface.texture, material);
@@ -315,7 +315,7 @@ bool MapFormat::voxelizeGroups(const core::String &filename, const io::ArchivePt
 			core::String classname;
 			props.get("classname", classname);
 			const core::String name = core::string::format("%s brush %i", classname.c_str(), entity);
-			const int nodeId = voxelizeNode(name, sceneGraph, tris);
+			const int nodeId = voxelizeBuckets(name, sceneGraph, tris);
 			if (nodeId == InvalidNodeId) {
 				Log::error("Voxelization failed");
 				return false;
@@ -224,10 +224,11 @@ bool QuakeBSPFormat::loadUFOAlienInvasionTextures(const core::String &filename,
 		if (tex->isLoaded()) {
 			Log::debug("Use image %s", textureName.c_str());
 			texture.material = createMaterial(tex);
-			meshMaterials.put(textureName, texture.material);
 		} else {
 			Log::warn("Failed to load %s", textureName.c_str());
 		}
+		// many texinfos are sharing the same texture - cache the failed lookups, too
+		meshMaterials.put(texture.name, texture.material);
 	}
 	return true;
 }
@@ -711,7 +712,7 @@ bool QuakeBSPFormat::voxelize(const core::DynamicArray<Texture> &textures, const
 		tris.push_back(meshTri);
 	}
 
-	return voxelizeNode(name, sceneGraph, tris) > 0;
+	return voxelizeBuckets(name, sceneGraph, tris) > 0;
 }
 
 bool QuakeBSPFormat::voxelizeGroups(const core::String &filename, const io::ArchivePtr &archive,
@@ -3,7 +3,6 @@
  */
 
 #include "DatFormat.h"
-#include "app/Async.h"
 #include "core/Color.h"
 #include "core/Common.h"
 #include "core/Log.h"
@@ -81,41 +80,41 @@ bool DatFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 		return false;
 	}
 
-	int nodesAdded = 0;
-
-	core::DynamicArray<std::future<scenegraph::SceneGraph>> futures;
+	core::DynamicArray<core::String> regionFilenames;
+	regionFilenames.reserve(entities.size());
 	Log::info("Found %i region files", (int)entities.size());
 	for (const io::FilesystemEntry &e : entities) {
 		if (e.type != io::FilesystemEntry::Type::file) {
 			continue;
 		}
-		const core::String &regionFilename = core::string::path(baseName, "region", e.name);
-		futures.emplace_back(app::async([regionFilename, &archive, &loadctx]() {
-			MCRFormat mcrFormat;
-			scenegraph::SceneGraph newSceneGraph;
-			if (!mcrFormat.load(regionFilename, archive, newSceneGraph, loadctx)) {
-				Log::debug("Could not load %s", regionFilename.c_str());
-				return core::move(newSceneGraph);
-			}
-			const scenegraph::SceneGraph::MergeResult &merged = newSceneGraph.merge();
-			newSceneGraph.clear();
-			if (!merged.hasVolume()) {
-				return core::move(newSceneGraph);
-			}
-			scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
-			node.setVolume(merged.volume(), true);
-			node.setPalette(merged.palette);
-			node.setNormalPalette(merged.normalPalette);
-			newSceneGraph.emplace(core::move(node));
-			return core::move(newSceneGraph);
-		}));
+		regionFilenames.push_back(core::string::path(baseName, "region", e.name));
 	}
-	Log::debug("Scheduled %i regions", (int)futures.size());
-	int count = 0;
-	for (auto &f : futures) {
-		scenegraph::SceneGraph newSceneGraph = core::move(f.get());
-		nodesAdded += scenegraph::addSceneGraphNodes(sceneGraph, newSceneGraph, rootNode);
-		Log::debug("... loaded %i", count++);
+
+	core::DynamicArray<scenegraph::SceneGraph> regions(regionFilenames.size());
+	decodeParallel(regionFilenames.size(), [&](size_t i) {
+		const core::String &regionFilename = regionFilenames[i];
+		scenegraph::SceneGraph &newSceneGraph = regions[i];
+		MCRFormat mcrFormat;
+		if (!mcrFormat.load(regionFilename, archive, newSceneGraph, loadctx)) {
+			Log::debug("Could not load %s", regionFilename.c_str());
+			return true;
+		}
+		const scenegraph::SceneGraph::MergeResult &merged = newSceneGraph.merge();
+		newSceneGraph.clear();
+		if (!merged.hasVolume()) {
+			return true;
+		}
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(merged.volume(), true);
+		node.setPalette(merged.palette);
+		node.setNormalPalette(merged.normalPalette);
+		newSceneGraph.emplace(core::move(node));
+		return true;
+	});
+	Log::debug("Loaded %i regions", (int)regions.size());
+	int nodesAdded = 0;
+	for (scenegraph::SceneGraph &region : regions) {
+		nodesAdded += scenegraph::addSceneGraphNodes(sceneGraph, region, rootNode);
 	}
 
 	return nodesAdded > 0;
@@ -3,19 +3,24 @@
  */
 
 #include "MCRFormat.h"
+#include "core/Allocator.h"
 #include "core/Color.h"
 #include "core/Common.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "core/collection/DynamicArray.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/MemoryReadStream.h"
 #include "io/Stream.h"
 #include "io/ZipReadStream.h"
 #include "io/ZipWriteStream.h"
 #include "scenegraph/SceneGraph.h"
 #include "palette/Palette.h"
-#include "voxelutil/VolumeCropper.h"
-#include "voxelutil/VolumeMerger.h"
+#include "voxel/PagedVolume.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/VolumeVisitor.h"
+#include "MinecraftBlockStates.h"
 #include "MinecraftPaletteMap.h"
 #include "NamedBinaryTag.h"
 
@@ -96,6 +101,9 @@ bool MCRFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 
 bool MCRFormat::loadMinecraftRegion(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream,
 									const palette::Palette &palette) {
+	// the chunks are independent zlib blobs - read them sequentially and decode them in parallel
+	core::DynamicArray<int> sectors;
+	core::DynamicArray<core::Buffer<uint8_t>> chunks;
 	for (int i = 0; i < SECTOR_INTS; ++i) {
 		if (_offsets[i].sectorCount == 0u || _offsets[i].offset < sizeof(_offsets)) {
 			continue;
@@ -106,17 +114,47 @@ bool MCRFormat::loadMinecraftRegion(scenegraph::SceneGraph &sceneGraph, io::Seek
 		if (stream.seek(_offsets[i].offset) == -1) {
 			continue;
 		}
-		if (!readCompressedNBT(sceneGraph, stream, i, palette)) {
+		core::Buffer<uint8_t> data;
+		if (!readCompressedChunk(stream, data)) {
 			Log::error("Failed to load minecraft chunk section %i for offset %u", i, (int)_offsets[i].offset);
 			return false;
 		}
+		if (data.empty()) {
+			continue;
+		}
+		sectors.push_back(i);
+		chunks.emplace_back(core::move(data));
 	}
 
+	core::DynamicArray<voxel::RawVolume *> volumes;
+	volumes.resize(chunks.size());
+	const bool decoded = decodeParallel(chunks.size(), [&](size_t n) {
+		volumes[n] = parseCompressedNBT(chunks[n], sectors[n], palette);
+		chunks[n].release();
+		if (volumes[n] == nullptr) {
+			Log::error("Failed to load minecraft chunk section %i for offset %u", sectors[n],
+					   (int)_offsets[sectors[n]].offset);
+			return false;
+		}
+		return true;
+	});
+	if (!decoded) {
+		for (voxel::RawVolume *v : volumes) {
+			delete v;
+		}
+		return false;
+	}
+	// add the nodes in the order of the sectors
+	for (voxel::RawVolume *v : volumes) {
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(v, true);
+		node.setPalette(palette);
+		sceneGraph.emplace(core::move(node));
+	}
 	return true;
 }
 
-bool MCRFormat::readCompressedNBT(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream, int sector,
-								  const palette::Palette &palette) {
+bool MCRFormat::readCompressedChunk(io::SeekableReadStream &stream, core::Buffer<uint8_t> &data) {
 	uint32_t nbtSize;
 	wrap(stream.readUInt32BE(nbtSize));
 	if (nbtSize == 0) {
@@ -138,45 +176,169 @@ bool MCRFormat::readCompressedNBT(scenegraph::SceneGraph &sceneGraph, io::Seekab
 
 	// the version is included in the length
 	--nbtSize;
-
-	io::ZipReadStream zipStream(stream, (int)nbtSize);
-	priv::NamedBinaryTagContext ctx;
-	ctx.stream = &zipStream;
-	const priv::NamedBinaryTag &root = priv::NamedBinaryTag::parse(ctx);
-	if (!root.valid()) {
-		Log::error("Could not parse nbt structure");
+	if (nbtSize == 0) {
+		Log::debug("Empty nbt chunk found");
+		return true;
+	}
+	data.resize(nbtSize);
+	if (stream.read(data.data(), nbtSize) != (int)nbtSize) {
+		Log::error("Failed to read the compressed nbt data of %u bytes", nbtSize);
 		return false;
 	}
+	return true;
+}
+
+/**
+ * @brief Collects the tags of the chunk that are needed to convert the sections - everything else is skipped
+ */
+class MCRFormat::ChunkVisitor : public priv::NamedBinaryTagVisitor {
+private:
+	enum class Scope { Root, Level, Sections, Section, SectionBlockStates, Palette, PaletteEntry };
+	core::DynamicArray<Scope> _scopes;
+	ChunkData &_chunk;
+
+	inline Scope scope() const {
+		return _scopes.back();
+	}
 
-	voxel::RawVolume *volume;
-	// https://minecraft.wiki/w/Data_version
-	const int32_t dataVersion = root.get("DataVersion").int32();
-	Log::debug("Found data version %i", dataVersion);
-	if (dataVersion >= 2844) {
-		volume = parseSections(dataVersion, root, sector, palette);
-		if (volume == nullptr) {
+	inline ChunkSection &section() {
+		return _chunk.sections.back();
+	}
+
+public:
+	ChunkVisitor(ChunkData &chunk) : _chunk(chunk) {
+	}
+
+	bool enterCompound(const priv::NBTStringView &name) override {
+		if (_scopes.empty()) {
+			_scopes.push_back(Scope::Root);
+			return true;
+		}
+		const Scope parent = scope();
+		if (parent == Scope::Root && name == "Level") {
+			_chunk.hasLevel = true;
+			_scopes.push_back(Scope::Level);
+		} else if (parent == Scope::Sections) {
+			_chunk.sections.emplace_back();
+			_scopes.push_back(Scope::Section);
+		} else if (parent == Scope::Section && name == "block_states") {
+			_scopes.push_back(Scope::SectionBlockStates);
+		} else if (parent == Scope::Palette) {
+			section().names.emplace_back();
+			_scopes.push_back(Scope::PaletteEntry);
+		} else {
 			return false;
 		}
-	} else {
-		volume = parseLevelCompound(dataVersion, root, sector, palette);
-		if (volume == nullptr) {
+		return true;
+	}
+
+	void leaveCompound() override {
+		_scopes.pop();
+	}
+
+	bool enterList(const priv::NBTStringView &name, priv::TagType type, uint32_t length) override {
+		const Scope parent = scope();
+		if ((parent == Scope::Root && name == "sections") || (parent == Scope::Level && name == "Sections")) {
+			_chunk.hasSections = true;
+			_chunk.sections.reserve(length);
+			_scopes.push_back(Scope::Sections);
+		} else if ((parent == Scope::SectionBlockStates && name == "palette") ||
+				   (parent == Scope::Section && name == "Palette")) {
+			section().hasPalette = true;
+			section().names.reserve(length);
+			_scopes.push_back(Scope::Palette);
+		} else {
 			return false;
 		}
+		return true;
 	}
-	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
-	node.setVolume(volume, true);
-	node.setPalette(palette);
-	sceneGraph.emplace(core::move(node));
-	return true;
+
+	void leaveList() override {
+		_scopes.pop();
+	}
+
+	void visit(const priv::NBTStringView &name, const priv::NBTValue &value) override {
+		switch (scope()) {
+		case Scope::Root:
+			if (name == "DataVersion") {
+				_chunk.dataVersion = value.int32();
+			} else if (name == "xPos") {
+				_chunk.xPos = value.int32();
+			} else if (name == "zPos") {
+				_chunk.zPos = value.int32();
+			} else if (name == "Status") {
+				_chunk.status = value.string();
+			}
+			break;
+		case Scope::Level:
+			if (name == "xPos") {
+				_chunk.xPos = value.int32();
+			} else if (name == "zPos") {
+				_chunk.zPos = value.int32();
+			} else if (name == "Status") {
+				_chunk.levelStatus = value.string();
+			}
+			break;
+		case Scope::Section:
+			if (name == "Y") {
+				section().y = value.int8();
+			} else if (name == "BlockStates") {
+				section().blockStates = value;
+			} else if (name == "Blocks") {
+				section().blocks = value;
+			}
+			break;
+		case Scope::SectionBlockStates:
+			if (name == "data") {
+				section().data = value;
+			}
+			break;
+		case Scope::PaletteEntry:
+			if (name == "Name") {
+				section().names.back() = value.string();
+			}
+			break;
+		default:
+			break;
+		}
+	}
+};
+
+voxel::RawVolume *MCRFormat::parseCompressedNBT(const core::Buffer<uint8_t> &data, int sector,
+												const palette::Palette &palette) {
+	// the collected sections are given back when the chunk is converted
+	core::FrameAllocatorScope frameAllocatorScope;
+	io::MemoryReadStream dataStream(data.data(), data.size());
+	io::ZipReadStream zipStream(dataStream, (int)dataStream.size());
+	// the collected tags are views into this buffer
+	io::BufferedReadWriteStream nbtData(zipStream);
+	if (zipStream.err()) {
+		Log::error("Failed to decompress the nbt data");
+		return nullptr;
+	}
+	ChunkData chunk;
+	ChunkVisitor visitor(chunk);
+	priv::NamedBinaryTagReader reader(nbtData.getBuffer(), (size_t)nbtData.size());
+	if (!reader.parse(visitor)) {
+		Log::error("Could not parse nbt structure");
+		return nullptr;
+	}
+
+	// https://minecraft.wiki/w/Data_version
+	Log::debug("Found data version %i", chunk.dataVersion);
+	if (chunk.dataVersion >= 2844) {
+		return parseSections(chunk, sector, palette);
+	}
+	return parseLevelCompound(chunk, sector, palette);
 }
 
-int MCRFormat::getVoxel(int dataVersion, const priv::NamedBinaryTag &data, const glm::ivec3 &pos) {
+int MCRFormat::getVoxel(int dataVersion, const priv::NBTArrayView<int8_t> &data, const glm::ivec3 &pos) {
 	const uint32_t i = pos.y * MAX_SIZE * MAX_SIZE + pos.z * MAX_SIZE + pos.x;
-	if (i >= data.byteArray()->size()) {
-		Log::error("Byte array index out of bounds: %u/%i", i, (int)data.byteArray()->size());
+	if (i >= data.size()) {
+		Log::error("Byte array index out of bounds: %u/%i", i, (int)data.size());
 		return -1;
 	}
-	const int val = (int)(uint8_t)(*data.byteArray())[i];
+	const int val = (int)(uint8_t)data[i];
 	if (val < 0) {
 		Log::error("Invalid value: %i", val);
 		return -1;
@@ -184,62 +346,54 @@ int MCRFormat::getVoxel(int dataVersion, const priv::NamedBinaryTag &data, const
 	return val;
 }
 
-voxel::RawVolume *MCRFormat::error(SectionVolumes &volumes) {
-	for (voxel::RawVolume *v : volumes) {
-		delete v;
-	}
-	return nullptr;
+voxel::Region MCRFormat::chunkRegion() {
+	// the section y is a signed byte
+	return voxel::Region(0, INT8_MIN * MAX_SIZE, 0, MAX_SIZE - 1, (INT8_MAX + 1) * MAX_SIZE - 1, MAX_SIZE - 1);
 }
 
-voxel::RawVolume *MCRFormat::finalize(SectionVolumes &volumes, int xPos, int zPos) {
-	if (volumes.empty()) {
+voxel::RawVolume *MCRFormat::finalize(const voxel::PagedVolume &chunkVolume, int xPos, int zPos) {
+	const voxel::Region &region = chunkVolume.solidRegion();
+	if (!region.isValid()) {
 		Log::error("No volumes found at %i:%i", xPos, zPos);
 		return nullptr;
 	}
-	// TODO: VOXELFORMAT: only merge connected y chunks - don't fill empty chunks - just a waste of memory
-	voxel::RawVolume *merged = voxelutil::merge(volumes);
-	for (voxel::RawVolume *v : volumes) {
-		delete v;
-	}
-	merged->translate(glm::ivec3(xPos * MAX_SIZE, 0, zPos * MAX_SIZE));
-	voxel::RawVolume *cropped = voxelutil::cropVolume(merged);
-	delete merged;
-	return cropped;
+	// only the bounds of the solid voxels are allocated as dense volume - the empty sections in between stay bricks
+	// that were never allocated
+	voxel::RawVolume *v = new voxel::RawVolume(region);
+	voxelutil::visitVolume(chunkVolume, region, [v](int x, int y, int z, const voxel::Voxel &voxel) {
+		v->setVoxel(x, y, z, voxel);
+	});
+	v->translate(glm::ivec3(xPos * MAX_SIZE, 0, zPos * MAX_SIZE));
+	return v;
 }
 
-bool MCRFormat::parseBlockStates(int dataVersion, const palette::Palette &palette, const priv::NamedBinaryTag &data,
-								 SectionVolumes &volumes, int sectionY, const MinecraftSectionPalette &secPal) {
+bool MCRFormat::parseBlockStates(int dataVersion, const palette::Palette &palette, const priv::NBTValue &data,
+								 voxel::PagedVolume &chunkVolume, int sectionY,
+								 const MinecraftSectionPalette &secPal) {
 	Log::debug("Parse block states");
-	const bool hasData = data.type() == priv::TagType::LONG_ARRAY && !data.longArray()->empty();
-
-	const glm::ivec3 mins(0, 0, 0);
-	const glm::ivec3 maxs(MAX_SIZE - 1, MAX_SIZE - 1, MAX_SIZE - 1);
-	const voxel::Region region(mins, maxs);
-	voxel::RawVolume *v = new voxel::RawVolume(region);
-	bool hasBlocks = false;
+	const bool hasData = data.type() == priv::TagType::LONG_ARRAY && !data.longArray().empty();
+	const int sectionMinsY = sectionY * MAX_SIZE;
 
 	if (secPal.pal.empty()) {
 		if (data.type() != priv::TagType::BYTE_ARRAY) {
 			Log::error("Unknown block data type: %i for version %i", (int)data.type(), dataVersion);
-			delete v;
 			return false;
 		}
+		const priv::NBTArrayView<int8_t> &blockData = data.byteArray();
 		glm::ivec3 sPos;
 		for (sPos.y = 0; sPos.y < MAX_SIZE; ++sPos.y) {
 			for (sPos.z = 0; sPos.z < MAX_SIZE; ++sPos.z) {
 				for (sPos.x = 0; sPos.x < MAX_SIZE; ++sPos.x) {
-					const int color = getVoxel(dataVersion, data, sPos);
+					const int color = getVoxel(dataVersion, blockData, sPos);
 					if (color < 0) {
 						Log::error("Failed to load voxel at position %i:%i:%i (dataversion: %i)", sPos.x, sPos.y,
 								   sPos.z, dataVersion);
-						delete v;
 						return false;
 					}
 					if (color) {
 						const uint8_t palColIdx = palette.getClosestMatch(secPal.mcpal.color(color));
 						const voxel::Voxel voxel = voxel::createVoxel(palette, palColIdx);
-						v->setVoxel(sPos, voxel);
-						hasBlocks = true;
+						chunkVolume.setVoxel(sPos.x, sectionMinsY + sPos.y, sPos.z, voxel);
 					}
 				}
 			}
@@ -247,66 +401,27 @@ bool MCRFormat::parseBlockStates(int dataVersion, const palette::Palette &palett
 	} else if (hasData) {
 		if (data.type() != priv::TagType::LONG_ARRAY) {
 			Log::error("Unknown block data type: %i for version %i", (int)data.type(), dataVersion);
-			delete v;
 			return false;
 		}
 
-		const core::DynamicArray<int64_t> &blockStates = *data.longArray();
+		const priv::NBTArrayView<int64_t> &blockStates = data.longArray();
 
 		constexpr int blockCount = MAX_SIZE * MAX_SIZE * MAX_SIZE;
+		// the indices don't span two longs since data version 2529
+		const bool padded = dataVersion >= 2529;
+		const int bitSize = padded ? (int)secPal.numBits : (int)(blockStates.size() * 64 / blockCount);
+		uint16_t indices[blockCount];
+		if (!unpackBlockStates(blockStates, bitSize, padded, indices, blockCount)) {
+			Log::error("Failed to unpack the block states for version %i", dataVersion);
+			return false;
+		}
 		uint8_t blocks[blockCount];
-		int bsCnt = 0;
-		size_t bitCnt = 0;
-		if (dataVersion < 2529) {
-			const size_t bitSize = (data.longArray()->size()) * 64 / blockCount;
-			const uint32_t bitMask = (1 << bitSize) - 1;
-			for (int i = 0; i < blockCount; i++) {
-				if (bitCnt + bitSize <= 64) {
-					const uint64_t blockState = blockStates[bsCnt];
-					const uint64_t blockIndex = (blockState >> bitCnt) & bitMask;
-					if (blockIndex < secPal.pal.size()) {
-						blocks[i] = secPal.pal[blockIndex];
-						hasBlocks = true;
-					} else {
-						blocks[i] = 0;
-					}
-					bitCnt += bitSize;
-					if (bitCnt == 64) {
-						bitCnt = 0;
-						bsCnt++;
-					}
-				} else {
-					const uint64_t blockState1 = blockStates[bsCnt++];
-					const uint64_t blockState2 = blockStates[bsCnt];
-					uint32_t blockIndex = (blockState1 >> bitCnt) & bitMask;
-					bitCnt += bitSize;
-					bitCnt -= 64;
-					blockIndex += (blockState2 << (bitSize - bitCnt)) & bitMask;
-					if (blockIndex < secPal.pal.size()) {
-						blocks[i] = secPal.pal[blockIndex];
-						hasBlocks = true;
-					} else {
-						blocks[i] = 0;
-					}
-				}
-			}
-		} else {
-			const size_t bitSize = secPal.numBits;
-			const uint32_t bitMask = (1 << bitSize) - 1;
-			for (int i = 0; i < blockCount; i++) {
-				const uint64_t blockState = blockStates[bsCnt];
-				const uint64_t blockIndex = (blockState >> bitCnt) & bitMask;
-				if (blockIndex < secPal.pal.size()) {
-					blocks[i] = secPal.pal[blockIndex];
-					hasBlocks = true;
-				} else {
-					blocks[i] = 0;
-				}
-				bitCnt += bitSize;
-				if (bitCnt + bitSize > 64) {
-					bsCnt++;
-					bitCnt = 0;
-				}
+		for (int i = 0; i < blockCount; i++) {
+			const uint16_t blockIndex = indices[i];
+			if (blockIndex < secPal.pal.size()) {
+				blocks[i] = secPal.pal[blockIndex];
+			} else {
+				blocks[i] = 0;
 			}
 		}
 
@@ -319,140 +434,90 @@ bool MCRFormat::parseBlockStates(int dataVersion, const palette::Palette &palett
 					if (color) {
 						const uint8_t palColIdx = palette.getClosestMatch(secPal.mcpal.color(color));
 						const voxel::Voxel voxel = voxel::createVoxel(palette, palColIdx);
-						v->setVoxel(sPos, voxel);
+						chunkVolume.setVoxel(sPos.x, sectionMinsY + sPos.y, sPos.z, voxel);
 					}
 				}
 			}
 		}
 	}
-
-	if (hasBlocks) {
-		glm::ivec3 translate;
-		translate.x = 0;
-		translate.y = sectionY * MAX_SIZE;
-		translate.z = 0;
-
-		v->translate(translate);
-		volumes.push_back(v);
-	} else {
-		delete v;
-	}
 	return true;
 }
 
-voxel::RawVolume *MCRFormat::parseSections(int dataVersion, const priv::NamedBinaryTag &root, int sector,
-										   const palette::Palette &pal) {
-	const priv::NamedBinaryTag &sections = root.get("sections");
-	if (!sections.valid()) {
+voxel::RawVolume *MCRFormat::parseSections(const ChunkData &chunk, int sector, const palette::Palette &pal) {
+	const int32_t dataVersion = chunk.dataVersion;
+	if (!chunk.hasSections) {
 		Log::error("Could not find 'sections' tag");
 		return nullptr;
 	}
-	if (sections.type() != priv::TagType::LIST) {
-		Log::error("Unexpected tag type found for 'sections' tag: %i", (int)sections.type());
-		return nullptr;
-	}
-
-	const int32_t xPos = root.get("xPos").int32();
-	const int32_t zPos = root.get("zPos").int32();
 
-	Log::debug("xpos: %i, zpos: %i", xPos, zPos);
+	Log::debug("xpos: %i, zpos: %i", chunk.xPos, chunk.zPos);
 
-	const priv::NBTList &sectionsList = *sections.list();
-	Log::debug("Found %i sections", (int)sectionsList.size());
-	if (sectionsList.empty()) {
+	Log::debug("Found %i sections", (int)chunk.sections.size());
+	if (chunk.sections.empty()) {
 		Log::warn("Empty region - no sections found - version: %i", dataVersion);
 		return nullptr;
 	}
-	SectionVolumes volumes;
-	for (const priv::NamedBinaryTag &section : sectionsList) {
-		const priv::NamedBinaryTag &blockStates = section.get("block_states");
-		if (!blockStates.valid()) {
-			Log::error("Could not find 'block_states'");
-			return error(volumes);
-		}
-		const priv::NamedBinaryTag &ylvl = section.get("Y");
-		if (!ylvl.valid()) {
-			Log::debug("Could not find Y int in section compound");
-		}
-		const int8_t sectionY = ylvl.int8();
+	voxel::PagedVolume chunkVolume(chunkRegion());
+	for (const ChunkSection &section : chunk.sections) {
+		const int8_t sectionY = section.y;
 		if (sectionY == -1) {
 			Log::debug("Skip empty section compound");
 		}
 		Log::debug("Y level for section compound: %i", (int)sectionY);
 
-		const priv::NamedBinaryTag &palette = blockStates.get("palette");
-		if (!palette.valid()) {
+		if (!section.hasPalette) {
 			Log::error("Could not find 'palette'");
-			return error(volumes);
+			return nullptr;
 		}
 		MinecraftSectionPalette secPal;
 		secPal.mcpal.minecraft();
-		if (!parsePaletteList(dataVersion, palette, secPal)) {
+		if (!parsePaletteList(dataVersion, section, secPal)) {
 			Log::error("Could not parse palette chunk");
-			return error(volumes);
+			return nullptr;
 		}
-		const priv::NamedBinaryTag &data = blockStates.get("data");
-		if (!parseBlockStates(dataVersion, pal, data, volumes, sectionY, secPal)) {
+		if (!parseBlockStates(dataVersion, pal, section.data, chunkVolume, sectionY, secPal)) {
 			Log::error("Failed to parse 'data' tag");
-			return error(volumes);
+			return nullptr;
 		}
 	}
-	return finalize(volumes, xPos, zPos);
+	return finalize(chunkVolume, chunk.xPos, chunk.zPos);
 }
 
-voxel::RawVolume *MCRFormat::parseLevelCompound(int dataVersion, const priv::NamedBinaryTag &root, int sector,
-												const palette::Palette &pal) {
-	const priv::NamedBinaryTag &levels = root.get("Level");
-	if (!levels.valid()) {
+voxel::RawVolume *MCRFormat::parseLevelCompound(const ChunkData &chunk, int sector, const palette::Palette &pal) {
+	const int32_t dataVersion = chunk.dataVersion;
+	if (!chunk.hasLevel) {
 		Log::error("Could not find 'Level' tag");
 		return nullptr;
 	}
-	if (levels.type() != priv::TagType::COMPOUND) {
-		Log::error("Invalid type for 'Level' tag: %i", (int)levels.type());
-		return nullptr;
-	}
-	const int32_t xPos = levels.get("xPos").int32();
-	const int32_t zPos = levels.get("zPos").int32();
 
 	if (dataVersion >= 1976) {
-		const core::String *tagStatus = root.get("Status").string();
-		if (tagStatus == nullptr) {
+		if (chunk.status.empty()) {
 			Log::debug("Status for level node wasn't found (version: %i)", dataVersion);
-		} else if (*tagStatus != "full") {
-			Log::debug("Status for level node is not full but %s (version: %i)", tagStatus->c_str(), dataVersion);
+		} else if (chunk.status != "full") {
+			Log::debug("Status for level node is not full but %s (version: %i)", chunk.status.str().c_str(),
+					   dataVersion);
 		}
 	} else if (dataVersion >= 1628) {
-		const core::String *tagStatus = levels.get("Status").string();
-		if (tagStatus == nullptr) {
+		if (chunk.levelStatus.empty()) {
 			Log::debug("Status for level node wasn't found (version: %i)", dataVersion);
-		} else if (*tagStatus != "postprocessed") {
-			Log::debug("Status for level node is not postprocessed but %s (version: %i)", tagStatus->c_str(),
-					   dataVersion);
+		} else if (chunk.levelStatus != "postprocessed") {
+			Log::debug("Status for level node is not postprocessed but %s (version: %i)",
+					   chunk.levelStatus.str().c_str(), dataVersion);
 		}
 	}
 
-	const priv::NamedBinaryTag &sections = levels.get("Sections");
-	if (!sections.valid()) {
+	if (!chunk.hasSections) {
 		Log::error("Could not find 'Sections' tag");
 		return nullptr;
 	}
-	if (sections.type() != priv::TagType::LIST) {
-		Log::error("Invalid type for 'Sections' tag: %i", (int)sections.type());
-		return nullptr;
-	}
-	const priv::NBTList &sectionsList = *sections.list();
-	Log::debug("Found %i sections", (int)sectionsList.size());
-	if (sectionsList.empty()) {
+	Log::debug("Found %i sections", (int)chunk.sections.size());
+	if (chunk.sections.empty()) {
 		Log::warn("Empty region - no sections found - version: %i", dataVersion);
 		return nullptr;
 	}
-	SectionVolumes volumes;
-	for (const priv::NamedBinaryTag &section : sectionsList) {
-		const priv::NamedBinaryTag &ylvl = section.get("Y");
-		if (!ylvl.valid()) {
-			Log::debug("Could not find Y int in section compound");
-		}
-		const int8_t sectionY = ylvl.int8();
+	voxel::PagedVolume chunkVolume(chunkRegion());
+	for (const ChunkSection &section : chunk.sections) {
+		const int8_t sectionY = section.y;
 		if (sectionY == -1) {
 			Log::debug("Skip empty section compound");
 		}
@@ -461,40 +526,32 @@ voxel::RawVolume *MCRFormat::parseLevelCompound(int dataVersion, const priv::Nam
 		MinecraftSectionPalette secPal;
 		secPal.mcpal.minecraft();
 
-		const priv::NamedBinaryTag &palette = section.get("Palette");
-		if (palette.valid()) {
-			if (!parsePaletteList(dataVersion, palette, secPal)) {
+		if (section.hasPalette) {
+			if (!parsePaletteList(dataVersion, section, secPal)) {
 				Log::error("Failed to parse 'Palette' tag");
-				return error(volumes);
+				return nullptr;
 			}
 		} else {
 			Log::debug("Could not find a Palette compound in section %i", dataVersion);
 		}
 
 		// TODO:"Data"(byte_array)
-		// const priv::NamedBinaryTag &data = section.get("Data");
-		const core::String &tagId = dataVersion <= 1343 ? "Blocks" : "BlockStates";
-		const priv::NamedBinaryTag &blockStates = section.get(tagId);
+		const char *tagId = dataVersion <= 1343 ? "Blocks" : "BlockStates";
+		const priv::NBTValue &blockStates = dataVersion <= 1343 ? section.blocks : section.blockStates;
 		if (!blockStates.valid()) {
-			Log::debug("Could not find '%s'", tagId.c_str());
+			Log::debug("Could not find '%s'", tagId);
 			continue;
 		}
-		if (!parseBlockStates(dataVersion, pal, blockStates, volumes, sectionY, secPal)) {
-			Log::error("Failed to parse '%s' tag", tagId.c_str());
-			return error(volumes);
+		if (!parseBlockStates(dataVersion, pal, blockStates, chunkVolume, sectionY, secPal)) {
+			Log::error("Failed to parse '%s' tag", tagId);
+			return nullptr;
 		}
 	}
-	return finalize(volumes, xPos, zPos);
+	return finalize(chunkVolume, chunk.xPos, chunk.zPos);
 }
 
-bool MCRFormat::parsePaletteList(int dataVersion, const priv::NamedBinaryTag &palette,
-								 MinecraftSectionPalette &sectionPal) {
-	if (palette.type() != priv::TagType::LIST) {
-		Log::error("Invalid type for palette: %i", (int)palette.type());
-		return false;
-	}
-	const priv::NBTList &paletteList = *palette.list();
-	const size_t paletteCount = paletteList.size();
+bool MCRFormat::parsePaletteList(int dataVersion, const ChunkSection &section, MinecraftSectionPalette &sectionPal) {
+	const size_t paletteCount = section.names.size();
 	if (paletteCount > 512u) {
 		Log::error("Palette overflow");
 		return false;
@@ -503,22 +560,11 @@ bool MCRFormat::parsePaletteList(int dataVersion, const priv::NamedBinaryTag &pa
 	sectionPal.numBits = (uint32_t)glm::max(glm::ceil(glm::log2((float)paletteCount)), 4.0f);
 
 	int paletteEntry = 0;
-	for (const priv::NamedBinaryTag &block : paletteList) {
-		if (block.type() != priv::TagType::COMPOUND) {
-			Log::error("Invalid block type %i", (int)block.type());
-			return false;
-		}
-
-		for (const auto &entry : *block.compound()) {
-			if (entry->key != "Name") {
-				continue;
-			}
-			const priv::NamedBinaryTag &nbt = entry->value;
-			const core::String *value = nbt.string();
-			if (value == nullptr) {
-				continue;
-			}
-			sectionPal.pal[paletteEntry] = findPaletteIndex(*value);
+	for (const priv::NBTStringView &name : section.names) {
+		if (name.empty()) {
+			sectionPal.pal[paletteEntry] = 0;
+		} else {
+			sectionPal.pal[paletteEntry] = findPaletteIndex(name.data(), name.size(), -1);
 		}
 		++paletteEntry;
 	}
@@ -9,18 +9,17 @@
 #include "core/collection/DynamicArray.h"
 #include "core/collection/DynamicMap.h"
 #include "palette/Palette.h"
+#include "NamedBinaryTagReader.h"
 
 namespace io {
 class ZipReadStream;
 }
 
-namespace voxelformat {
+namespace voxel {
+class PagedVolume;
+}
 
-namespace priv {
-class NamedBinaryTag;
-using NBTCompound = core::DynamicMap<core::String, NamedBinaryTag, 11, core::StringHash>;
-using NBTList = core::DynamicArray<NamedBinaryTag>;
-} // namespace priv
+namespace voxelformat {
 
 /**
  * A minecraft chunk contains the terrain and entity information about a grid of the size 16x256x16
@@ -91,28 +90,75 @@ private:
 		palette::Palette mcpal;
 	};
 
-	using SectionVolumes = core::DynamicArray<voxel::RawVolume *>;
+	/**
+	 * @brief The tags of a section that are needed to convert it into a volume - the names and arrays are views into
+	 * the uncompressed nbt data of the chunk
+	 */
+	struct ChunkSection {
+		int8_t y = 0;
+		bool hasPalette = false;
+		/**
+		 * @brief The names of the palette entries - empty views for entries without a name
+		 */
+		core::DynamicArray<priv::NBTStringView> names;
+		// long array for data versions >= 2844 ('data' in the 'block_states' compound)
+		priv::NBTValue data;
+		// long array between 1343 and 2844
+		priv::NBTValue blockStates;
+		// byte array for data versions <= 1343
+		priv::NBTValue blocks;
+	};
 
-	voxel::RawVolume *error(SectionVolumes &volumes);
-	voxel::RawVolume *finalize(SectionVolumes &volumes, int xPos, int zPos);
+	/**
+	 * @brief The chunk tags that are collected by the @c ChunkVisitor
+	 */
+	struct ChunkData {
+		int32_t dataVersion = 0;
+		int32_t xPos = 0;
+		int32_t zPos = 0;
+		bool hasLevel = false;
+		bool hasSections = false;
+		priv::NBTStringView status;
+		priv::NBTStringView levelStatus;
+		// only alive while the chunk is parsed - see parseCompressedNBT()
+		core::DynamicArray<ChunkSection, 32u, core::FrameAllocator> sections;
+	};
+	class ChunkVisitor;
+
+	/**
+	 * @brief The sections of a chunk are collected in a paged volume that covers all possible section heights. Each
+	 * section is one brick of the volume - only the sections with blocks allocate memory.
+	 */
+	static voxel::Region chunkRegion();
+	/**
+	 * @brief Copies the solid voxels of the chunk into a volume of their bounds at the position of the chunk
+	 */
+	voxel::RawVolume *finalize(const voxel::PagedVolume &chunkVolume, int xPos, int zPos);
 
-	static int getVoxel(int dataVersion, const priv::NamedBinaryTag &data, const glm::ivec3 &pos);
+	static int getVoxel(int dataVersion, const priv::NBTArrayView<int8_t> &data, const glm::ivec3 &pos);
 
 	// shared across versions
-	bool parsePaletteList(int dataVersion, const priv::NamedBinaryTag &palette, MinecraftSectionPalette &sectionPal);
-	bool parseBlockStates(int dataVersion, const palette::Palette &palette, const priv::NamedBinaryTag &data,
-						  SectionVolumes &volumes, int sectionY, const MinecraftSectionPalette &secPal);
+	bool parsePaletteList(int dataVersion, const ChunkSection &section, MinecraftSectionPalette &sectionPal);
+	bool parseBlockStates(int dataVersion, const palette::Palette &palette, const priv::NBTValue &data,
+						  voxel::PagedVolume &chunkVolume, int sectionY, const MinecraftSectionPalette &secPal);
 
 	// new version (>= 2844)
-	voxel::RawVolume *parseSections(int dataVersion, const priv::NamedBinaryTag &root, int sector,
-									const palette::Palette &palette);
+	voxel::RawVolume *parseSections(const ChunkData &chunk, int sector, const palette::Palette &palette);
 
 	// old version (< 2844)
-	voxel::RawVolume *parseLevelCompound(int dataVersion, const priv::NamedBinaryTag &root, int sector,
+	voxel::RawVolume *parseLevelCompound(const ChunkData &chunk, int sector, const palette::Palette &palette);
+
+	/**
+	 * @brief Reads the compressed nbt data of the chunk at the current stream position - the data stays empty for
+	 * empty chunks
+	 */
+	bool readCompressedChunk(io::SeekableReadStream &stream, core::Buffer<uint8_t> &data);
+	/**
+	 * @brief Decompresses and parses the nbt data of a chunk and converts the sections into a volume
+	 * @note This is called in parallel for the chunks of a region
+	 */
+	voxel::RawVolume *parseCompressedNBT(const core::Buffer<uint8_t> &data, int sector,
 										 const palette::Palette &palette);
-
-	bool readCompressedNBT(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream, int sector,
-						   const palette::Palette &palette);
 	bool loadMinecraftRegion(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream,
 							 const palette::Palette &palette);
 
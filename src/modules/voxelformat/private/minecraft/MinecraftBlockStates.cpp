@@ -0,0 +1,137 @@
+/**
+ * @file
+ */
+
+#include "MinecraftBlockStates.h"
+#include "core/Log.h"
+
+namespace voxelformat {
+
+size_t blockStatesLongs(int count, int bits, bool padded) {
+	if (bits <= 0 || count <= 0) {
+		return 0u;
+	}
+	if (padded) {
+		const int perLong = 64 / bits;
+		return (size_t)((count + perLong - 1) / perLong);
+	}
+	return (size_t)(((int64_t)count * bits + 63) / 64);
+}
+
+// the indices of one long are extracted with constant shifts - this allows the compiler to unroll and vectorize the
+// inner loop
+template<int Bits>
+static void unpackLongs(const priv::NBTArrayView<int64_t> &words, uint16_t *out, int count) {
+	constexpr int PerLong = 64 / Bits;
+	constexpr uint64_t Mask = (1ull << Bits) - 1ull;
+	const int fullLongs = count / PerLong;
+	for (int w = 0; w < fullLongs; ++w) {
+		const uint64_t word = (uint64_t)words[w];
+		uint16_t *o = out + w * PerLong;
+		for (int i = 0; i < PerLong; ++i) {
+			o[i] = (uint16_t)((word >> (i * Bits)) & Mask);
+		}
+	}
+	const int remaining = count - fullLongs * PerLong;
+	if (remaining > 0) {
+		const uint64_t word = (uint64_t)words[fullLongs];
+		uint16_t *o = out + fullLongs * PerLong;
+		for (int i = 0; i < remaining; ++i) {
+			o[i] = (uint16_t)((word >> (i * Bits)) & Mask);
+		}
+	}
+}
+
+static void unpackPadded(const priv::NBTArrayView<int64_t> &words, int bits, uint16_t *out, int count) {
+	const int perLong = 64 / bits;
+	const uint64_t mask = (1ull << bits) - 1ull;
+	for (int i = 0; i < count; ++i) {
+		const uint64_t word = (uint64_t)words[i / perLong];
+		out[i] = (uint16_t)((word >> ((i % perLong) * bits)) & mask);
+	}
+}
+
+static void unpackSpanning(const priv::NBTArrayView<int64_t> &words, int bits, uint16_t *out, int count) {
+	const uint64_t mask = (1ull << bits) - 1ull;
+	for (int i = 0; i < count; ++i) {
+		const uint64_t bit = (uint64_t)i * bits;
+		const size_t w = (size_t)(bit >> 6);
+		const int offset = (int)(bit & 63);
+		uint64_t val = (uint64_t)words[w] >> offset;
+		if (offset + bits > 64) {
+			val |= (uint64_t)words[w + 1] << (64 - offset);
+		}
+		out[i] = (uint16_t)(val & mask);
+	}
+}
+
+bool unpackBlockStates(const priv::NBTArrayView<int64_t> &words, int bits, bool padded, uint16_t *out, int count) {
+	if (bits < 1 || bits > 16) {
+		Log::error("Unsupported block states bit width: %i", bits);
+		return false;
+	}
+	if (words.size() < blockStatesLongs(count, bits, padded)) {
+		Log::error("Not enough block states for %i indices with %i bits: %i", count, bits, (int)words.size());
+		return false;
+	}
+	// without padding the indices only span two longs if the bit width is no divisor of 64
+	if (!padded && 64 % bits != 0) {
+		unpackSpanning(words, bits, out, count);
+		return true;
+	}
+	switch (bits) {
+	case 4:
+		unpackLongs<4>(words, out, count);
+		break;
+	case 5:
+		unpackLongs<5>(words, out, count);
+		break;
+	case 6:
+		unpackLongs<6>(words, out, count);
+		break;
+	case 7:
+		unpackLongs<7>(words, out, count);
+		break;
+	case 8:
+		unpackLongs<8>(words, out, count);
+		break;
+	default:
+		unpackPadded(words, bits, out, count);
+		break;
+	}
+	return true;
+}
+
+bool packBlockStates(const uint16_t *indices, int count, int bits, bool padded, core::DynamicArray<int64_t> &words) {
+	if (bits < 1 || bits > 16) {
+		Log::error("Unsupported block states bit width: %i", bits);
+		return false;
+	}
+	const uint64_t mask = (1ull << bits) - 1ull;
+	words.clear();
+	words.resize(blockStatesLongs(count, bits, padded));
+	for (size_t i = 0; i < words.size(); ++i) {
+		words[i] = 0;
+	}
+	if (padded) {
+		const int perLong = 64 / bits;
+		for (int i = 0; i < count; ++i) {
+			const uint64_t val = (uint64_t)(indices[i] & mask) << ((i % perLong) * bits);
+			words[i / perLong] = (int64_t)((uint64_t)words[i / perLong] | val);
+		}
+		return true;
+	}
+	for (int i = 0; i < count; ++i) {
+		const uint64_t val = indices[i] & mask;
+		const uint64_t bit = (uint64_t)i * bits;
+		const size_t w = (size_t)(bit >> 6);
+		const int offset = (int)(bit & 63);
+		words[w] = (int64_t)((uint64_t)words[w] | (val << offset));
+		if (offset + bits > 64) {
+			words[w + 1] = (int64_t)((uint64_t)words[w + 1] | (val >> (64 - offset)));
+		}
+	}
+	return true;
+}
+
+} // namespace voxelformat
@@ -0,0 +1,38 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "NamedBinaryTagReader.h"
+#include "core/collection/DynamicArray.h"
+#include <stdint.h>
+
+namespace voxelformat {
+
+/**
+ * @brief The amount of longs that are needed to store the given amount of block state indices
+ * @param padded Since data version 2529 an index doesn't span two longs - the remaining bits of a long are unused
+ */
+size_t blockStatesLongs(int count, int bits, bool padded);
+
+/**
+ * @brief Unpacks the palette indices of a block states long array
+ *
+ * The common bit widths are handled by specialized kernels that process a whole long at once.
+ *
+ * @param[in] words The big endian long array of the nbt data
+ * @param[in] bits The amount of bits per index [1-16]
+ * @param[in] padded Since data version 2529 an index doesn't span two longs - the remaining bits of a long are unused
+ * @param[out] out Receives @c count indices
+ * @return @c false if the bit width is not supported or the array is too small
+ */
+bool unpackBlockStates(const priv::NBTArrayView<int64_t> &words, int bits, bool padded, uint16_t *out, int count);
+
+/**
+ * @brief Packs the given palette indices into a block states long array - the counterpart of @c unpackBlockStates()
+ * @param[out] words The longs in native byte order
+ */
+bool packBlockStates(const uint16_t *indices, int count, int bits, bool padded, core::DynamicArray<int64_t> &words);
+
+} // namespace voxelformat
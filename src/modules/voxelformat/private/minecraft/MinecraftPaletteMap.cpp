@@ -5,6 +5,9 @@
 #include "MinecraftPaletteMap.h"
 #include "core/Log.h"
 #include "core/ArrayLength.h"
+#include "core/Assert.h"
+#include <SDL_stdinc.h>
+#include <string.h>
 
 namespace voxelformat {
 
@@ -964,25 +967,85 @@ const PaletteArray &getPaletteArray() {
 	return mcPalette;
 }
 
-int findPaletteIndex(const core::String &name, int defaultValue) {
-	core::String key = name;
-	// minecraft:dark_oak_stairs[facing=east,half=bottom,shape=outer_left,waterlogged=false][INT] = 554
-	size_t pos = key.find(":");
-	if (pos != core::String::npos) {
-		key = key.substr(pos + 1, key.size() - pos - 1);
+namespace {
+
+/**
+ * @brief Open addressing hash table for the block names of the palette array - it's built once and shared by all
+ * lookups of all formats
+ */
+class PaletteNameTable {
+private:
+	// power of two and more than twice the amount of entries
+	static constexpr uint32_t Slots = 2048u;
+	struct Slot {
+		const char *name = nullptr;
+		uint32_t length = 0u;
+		int palIdx = -1;
+	};
+	Slot _slots[Slots];
+
+	static uint32_t hash(const char *name, size_t length) {
+		uint64_t hash = 14695981039346656037UL;
+		for (size_t i = 0; i < length; ++i) {
+			hash ^= uint64_t(name[i]);
+			hash = hash * 1099511628211UL;
+		}
+		return (uint32_t)(hash ^ (hash >> 32));
+	}
+
+public:
+	PaletteNameTable(const PaletteArray &array) {
+		core_assert(array.size() * 2 < Slots);
+		for (const McColorScheme &entry : array) {
+			const size_t length = SDL_strlen(entry.name);
+			for (uint32_t i = hash(entry.name, length);; ++i) {
+				Slot &slot = _slots[i & (Slots - 1)];
+				if (slot.name == nullptr) {
+					slot.name = entry.name;
+					slot.length = (uint32_t)length;
+					slot.palIdx = entry.palIdx;
+					break;
+				}
+			}
+		}
 	}
-	size_t n = key.find("[");
-	if (n != core::String::npos) {
-		key = key.substr(0, n);
+
+	int find(const char *name, size_t length) const {
+		for (uint32_t i = hash(name, length);; ++i) {
+			const Slot &slot = _slots[i & (Slots - 1)];
+			if (slot.name == nullptr) {
+				return -1;
+			}
+			if (slot.length == length && SDL_memcmp(slot.name, name, length) == 0) {
+				return slot.palIdx;
+			}
+		}
+	}
+};
+
+} // namespace
+
+int findPaletteIndex(const char *name, size_t length, int defaultValue) {
+	// minecraft:dark_oak_stairs[facing=east,half=bottom,shape=outer_left,waterlogged=false][INT] = 554
+	const char *end = name + length;
+	const char *start = (const char *)memchr(name, ':', length);
+	start = start == nullptr ? name : start + 1;
+	const char *properties = (const char *)memchr(start, '[', end - start);
+	if (properties != nullptr) {
+		end = properties;
 	}
 
-	const PaletteMap &map = getPaletteMap();
-	auto iter = map.find(key);
-	if (iter == map.end()) {
-		Log::debug("Could not find a color mapping for '%s'", key.c_str());
+	static const PaletteNameTable table(getPaletteArray());
+	const int palIdx = table.find(start, end - start);
+	if (palIdx == -1) {
+		Log::debug("Could not find a color mapping for '%.*s'", (int)(end - start), start);
 		return defaultValue;
 	}
-	return iter->value.palIdx;
+	return palIdx;
+}
+
+int findPaletteIndex(const core::String &name, int defaultValue) {
+	return findPaletteIndex(name.c_str(), name.size(), defaultValue);
 }
 
 const PaletteMap &getPaletteMap() {
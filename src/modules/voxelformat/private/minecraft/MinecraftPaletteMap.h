@@ -32,5 +32,9 @@ const PaletteArray &getPaletteArray();
  * @param[in] defaultValue the value that is returned if the given name could not get matched
  */
 int findPaletteIndex(const core::String &name, int defaultValue = -1);
+/**
+ * @brief Same as above but without any allocation - the name doesn't have to be null terminated
+ */
+int findPaletteIndex(const char *name, size_t length, int defaultValue);
 
 } // namespace voxelformat
@@ -0,0 +1,196 @@
+/**
+ * @file
+ */
+
+#include "NamedBinaryTagReader.h"
+#include "core/Log.h"
+
+namespace voxelformat {
+
+namespace priv {
+
+float NBTValue::float32(float defaultVal) const {
+	if (_tagType != TagType::FLOAT) {
+		return defaultVal;
+	}
+	const uint32_t bits = NBTArrayView<uint32_t>(_data, 1)[0];
+	float val;
+	memcpy(&val, &bits, sizeof(val));
+	return val;
+}
+
+double NBTValue::float64(double defaultVal) const {
+	if (_tagType != TagType::DOUBLE) {
+		return defaultVal;
+	}
+	const uint64_t bits = NBTArrayView<uint64_t>(_data, 1)[0];
+	double val;
+	memcpy(&val, &bits, sizeof(val));
+	return val;
+}
+
+NamedBinaryTagReader::NamedBinaryTagReader(const uint8_t *buf, size_t size) : _buf(buf), _size(size) {
+}
+
+const uint8_t *NamedBinaryTagReader::advance(size_t bytes) {
+	if (bytes > _size - _pos) {
+		return nullptr;
+	}
+	const uint8_t *ptr = _buf + _pos;
+	_pos += bytes;
+	return ptr;
+}
+
+bool NamedBinaryTagReader::readType(TagType &type) {
+	const uint8_t *ptr = advance(1);
+	if (ptr == nullptr) {
+		return false;
+	}
+	type = (TagType)*ptr;
+	return true;
+}
+
+bool NamedBinaryTagReader::readUInt32(uint32_t &val) {
+	const uint8_t *ptr = advance(sizeof(val));
+	if (ptr == nullptr) {
+		return false;
+	}
+	val = NBTArrayView<uint32_t>(ptr, 1)[0];
+	return true;
+}
+
+bool NamedBinaryTagReader::readName(NBTStringView &name) {
+	const uint8_t *ptr = advance(sizeof(uint16_t));
+	if (ptr == nullptr) {
+		return false;
+	}
+	const uint16_t length = NBTArrayView<uint16_t>(ptr, 1)[0];
+	const uint8_t *str = advance(length);
+	if (str == nullptr) {
+		return false;
+	}
+	name = NBTStringView((const char *)str, length);
+	return true;
+}
+
+bool NamedBinaryTagReader::parse(NamedBinaryTagVisitor &visitor) {
+	_pos = 0u;
+	TagType type;
+	if (!readType(type) || type != TagType::COMPOUND) {
+		Log::debug("Missing root compound");
+		return false;
+	}
+	NBTStringView rootName;
+	if (!readName(rootName)) {
+		return false;
+	}
+	return parseType(type, rootName, &visitor, 0);
+}
+
+bool NamedBinaryTagReader::parseType(TagType type, const NBTStringView &name, NamedBinaryTagVisitor *visitor,
+									 int level) {
+	if (level > MaxDepth) {
+		Log::error("Max nbt depth exceeded");
+		return false;
+	}
+	switch (type) {
+	case TagType::COMPOUND: {
+		if (visitor != nullptr && !visitor->enterCompound(name)) {
+			visitor = nullptr;
+		}
+		TagType subType;
+		for (;;) {
+			if (!readType(subType)) {
+				return false;
+			}
+			if (subType == TagType::END) {
+				break;
+			}
+			NBTStringView subName;
+			if (!readName(subName)) {
+				return false;
+			}
+			if (!parseType(subType, subName, visitor, level + 1)) {
+				return false;
+			}
+		}
+		if (visitor != nullptr) {
+			visitor->leaveCompound();
+		}
+		return true;
+	}
+	case TagType::LIST: {
+		TagType contentType;
+		uint32_t length;
+		if (!readType(contentType) || !readUInt32(length)) {
+			return false;
+		}
+		const bool validContent = contentType > TagType::END && contentType < TagType::MAX;
+		if (visitor != nullptr && !visitor->enterList(name, validContent ? contentType : TagType::END, length)) {
+			visitor = nullptr;
+		}
+		if (validContent) {
+			const NBTStringView empty;
+			for (uint32_t i = 0; i < length; i++) {
+				if (!parseType(contentType, empty, visitor, level + 1)) {
+					return false;
+				}
+			}
+		}
+		if (visitor != nullptr) {
+			visitor->leaveList();
+		}
+		return true;
+	}
+	case TagType::STRING: {
+		NBTStringView str;
+		if (!readName(str)) {
+			return false;
+		}
+		if (visitor != nullptr) {
+			visitor->visit(name, NBTValue(type, (const uint8_t *)str.data(), (uint32_t)str.size()));
+		}
+		return true;
+	}
+	case TagType::BYTE_ARRAY:
+	case TagType::INT_ARRAY:
+	case TagType::LONG_ARRAY: {
+		uint32_t length;
+		if (!readUInt32(length)) {
+			return false;
+		}
+		const size_t elementSize = type == TagType::BYTE_ARRAY ? 1u : (type == TagType::INT_ARRAY ? 4u : 8u);
+		const uint8_t *data = advance((size_t)length * elementSize);
+		if (data == nullptr) {
+			Log::error("Array of %u elements exceeds the nbt data", length);
+			return false;
+		}
+		if (visitor != nullptr) {
+			visitor->visit(name, NBTValue(type, data, length));
+		}
+		return true;
+	}
+	case TagType::BYTE:
+	case TagType::SHORT:
+	case TagType::INT:
+	case TagType::LONG:
+	case TagType::FLOAT:
+	case TagType::DOUBLE: {
+		static const size_t Sizes[] = {0, 1, 2, 4, 8, 4, 8};
+		const uint8_t *data = advance(Sizes[(int)type]);
+		if (data == nullptr) {
+			return false;
+		}
+		if (visitor != nullptr) {
+			visitor->visit(name, NBTValue(type, data, 1u));
+		}
+		return true;
+	}
+	default:
+		Log::error("Unknown nbt tag type %i", (int)type);
+		return false;
+	}
+}
+
+} // namespace priv
+} // namespace voxelformat
@@ -0,0 +1,259 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "NamedBinaryTag.h"
+#include "core/Assert.h"
+#include "core/Endian.h"
+#include "core/String.h"
+#include <stdint.h>
+#include <string.h>
+
+namespace voxelformat {
+
+namespace priv {
+
+/**
+ * @brief A view into the big endian encoded array values of the nbt data - the values are decoded on access
+ */
+template<typename TYPE>
+class NBTArrayView {
+private:
+	const uint8_t *_data = nullptr;
+	uint32_t _size = 0u;
+
+public:
+	constexpr NBTArrayView() {
+	}
+
+	NBTArrayView(const uint8_t *data, uint32_t size) : _data(data), _size(size) {
+	}
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	TYPE operator[](size_t idx) const {
+		core_assert(idx < _size);
+		const uint8_t *ptr = _data + idx * sizeof(TYPE);
+		if constexpr (sizeof(TYPE) == 1) {
+			return (TYPE)*ptr;
+		} else if constexpr (sizeof(TYPE) == 2) {
+			uint16_t val;
+			memcpy(&val, ptr, sizeof(val));
+			return (TYPE)core_swap16be(val);
+		} else if constexpr (sizeof(TYPE) == 4) {
+			uint32_t val;
+			memcpy(&val, ptr, sizeof(val));
+			return (TYPE)core_swap32be(val);
+		} else {
+			uint64_t val;
+			memcpy(&val, ptr, sizeof(val));
+			return (TYPE)core_swap64be(val);
+		}
+	}
+};
+
+/**
+ * @brief A view into the (modified utf8) string data of the nbt data
+ */
+class NBTStringView {
+private:
+	const char *_data = nullptr;
+	uint16_t _size = 0u;
+
+public:
+	constexpr NBTStringView() {
+	}
+
+	NBTStringView(const char *data, uint16_t size) : _data(data), _size(size) {
+	}
+
+	inline const char *data() const {
+		return _data;
+	}
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	inline core::String str() const {
+		return core::String(_data, _size);
+	}
+
+	bool operator==(const char *other) const {
+		return strncmp(_data == nullptr ? "" : _data, other, _size) == 0 && other[_size] == '\0';
+	}
+
+	inline bool operator!=(const char *other) const {
+		return !(*this == other);
+	}
+};
+
+/**
+ * @brief A tag that is no compound or list - the strings and arrays are views into the nbt data
+ */
+class NBTValue {
+private:
+	const uint8_t *_data = nullptr;
+	uint32_t _length = 0u;
+	TagType _tagType = TagType::MAX;
+
+	template<typename TYPE>
+	TYPE read(TagType type, TYPE defaultVal) const {
+		if (_tagType != type) {
+			return defaultVal;
+		}
+		return NBTArrayView<TYPE>(_data, 1)[0];
+	}
+
+public:
+	constexpr NBTValue() {
+	}
+
+	/**
+	 * @param length The amount of elements for the array types and the amount of bytes for strings
+	 */
+	NBTValue(TagType type, const uint8_t *data, uint32_t length) : _data(data), _length(length), _tagType(type) {
+	}
+
+	inline bool valid() const {
+		return _tagType != TagType::MAX;
+	}
+
+	inline TagType type() const {
+		return _tagType;
+	}
+
+	inline int8_t int8(int8_t defaultVal = 0) const {
+		return read<int8_t>(TagType::BYTE, defaultVal);
+	}
+
+	inline int16_t int16(int16_t defaultVal = 0) const {
+		return read<int16_t>(TagType::SHORT, defaultVal);
+	}
+
+	inline int32_t int32(int32_t defaultVal = 0) const {
+		return read<int32_t>(TagType::INT, defaultVal);
+	}
+
+	inline int64_t int64(int64_t defaultVal = 0) const {
+		return read<int64_t>(TagType::LONG, defaultVal);
+	}
+
+	float float32(float defaultVal = 0.0f) const;
+	double float64(double defaultVal = 0.0) const;
+
+	inline NBTStringView string() const {
+		if (_tagType != TagType::STRING) {
+			return NBTStringView();
+		}
+		return NBTStringView((const char *)_data, (uint16_t)_length);
+	}
+
+	inline NBTArrayView<int8_t> byteArray() const {
+		if (_tagType != TagType::BYTE_ARRAY) {
+			return NBTArrayView<int8_t>();
+		}
+		return NBTArrayView<int8_t>(_data, _length);
+	}
+
+	inline NBTArrayView<int32_t> intArray() const {
+		if (_tagType != TagType::INT_ARRAY) {
+			return NBTArrayView<int32_t>();
+		}
+		return NBTArrayView<int32_t>(_data, _length);
+	}
+
+	inline NBTArrayView<int64_t> longArray() const {
+		if (_tagType != TagType::LONG_ARRAY) {
+			return NBTArrayView<int64_t>();
+		}
+		return NBTArrayView<int64_t>(_data, _length);
+	}
+};
+
+/**
+ * @brief Callbacks for the @c NamedBinaryTagReader
+ *
+ * The names and values are only valid as long as the buffer of the reader is valid. List entries don't have a name.
+ */
+class NamedBinaryTagVisitor {
+public:
+	virtual ~NamedBinaryTagVisitor() {
+	}
+
+	/**
+	 * @return @c false to skip the content of the compound - @c leaveCompound() is not called then
+	 */
+	virtual bool enterCompound(const NBTStringView &name) {
+		return true;
+	}
+	virtual void leaveCompound() {
+	}
+	/**
+	 * @param type The type of the list entries
+	 * @return @c false to skip the entries of the list - @c leaveList() is not called then
+	 */
+	virtual bool enterList(const NBTStringView &name, TagType type, uint32_t length) {
+		return true;
+	}
+	virtual void leaveList() {
+	}
+	/**
+	 * @brief Called for every tag that is no compound and no list
+	 */
+	virtual void visit(const NBTStringView &name, const NBTValue &value) {
+	}
+};
+
+/**
+ * @brief Event based nbt reader that works on the uncompressed nbt data without building the tag tree of
+ * @c NamedBinaryTag
+ *
+ * The strings and arrays are not copied - the visitor gets views into the given buffer. Skipped compounds and lists
+ * are only validated, not parsed.
+ *
+ * @sa NamedBinaryTag::parse()
+ */
+class NamedBinaryTagReader {
+private:
+	static constexpr int MaxDepth = 512;
+	const uint8_t *_buf;
+	const size_t _size;
+	size_t _pos = 0u;
+
+	bool readType(TagType &type);
+	bool readUInt32(uint32_t &val);
+	bool readName(NBTStringView &name);
+	/**
+	 * @brief Returns a pointer to the next @c bytes bytes and advances the position
+	 */
+	const uint8_t *advance(size_t bytes);
+	/**
+	 * @param visitor @c nullptr to skip the tag
+	 */
+	bool parseType(TagType type, const NBTStringView &name, NamedBinaryTagVisitor *visitor, int level);
+
+public:
+	NamedBinaryTagReader(const uint8_t *buf, size_t size);
+
+	/**
+	 * @brief Parses the root compound
+	 * @return @c false if the data is not valid nbt data
+	 */
+	bool parse(NamedBinaryTagVisitor &visitor);
+};
+
+} // namespace priv
+} // namespace voxelformat
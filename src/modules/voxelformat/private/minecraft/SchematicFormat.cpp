@@ -193,7 +193,7 @@ bool SchematicFormat::loadLitematic(const priv::NamedBinaryTag &schematic, scene
 			int paletteSize = 0;
 			for (const auto & palNbt : blockStatePaletteNbt) {
 				const priv::NamedBinaryTag &materialName = palNbt.get("Name");
-				mcpal[paletteSize++] = findPaletteIndex(materialName.string()->c_str(), 1);
+				mcpal[paletteSize++] = findPaletteIndex(*materialName.string(), 1);
 			}
 			const int n = (int)blockStatePaletteNbt.size();
 			int bits = 0;
@@ -7,8 +7,9 @@
 #include "core/Enum.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
-#include "core/Var.h"
+#include "core/collection/DynamicArray.h"
 #include "core/collection/DynamicMap.h"
+#include "io/BufferedReadStream.h"
 #include "io/Stream.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
@@ -16,6 +17,7 @@
 #include "palette/Palette.h"
 #include "palette/PaletteLookup.h"
 #include "voxelformat/Format.h"
+#include "voxelformat/FormatProbe.h"
 #include "voxelutil/VolumeVisitor.h"
 
 namespace voxelformat {
@@ -52,7 +54,7 @@ const int NEXT_SLICE_FLAG = 6;
 
 class MatrixWriter {
 private:
-	io::SeekableWriteStream &_stream;
+	io::WriteStream &_stream;
 	const voxel::RawVolume *_volume;
 	const palette::Palette &_palette;
 	const glm::ivec3 _maxs;
@@ -73,7 +75,7 @@ private:
 	}
 
 public:
-	MatrixWriter(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
+	MatrixWriter(io::WriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
 				 const scenegraph::SceneGraphNode &node, bool leftHanded, bool rleCompressed)
 		: _stream(stream), _volume(sceneGraph.resolveVolume(node)), _palette(node.palette()),
 		  _maxs(_volume->region().getUpperCorner()), _leftHanded(leftHanded), _rleCompressed(rleCompressed) {
@@ -146,7 +148,7 @@ public:
 	}
 };
 
-bool QBFormat::saveMatrix(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
+bool QBFormat::saveMatrix(io::WriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
 						  const scenegraph::SceneGraphNode &node, bool leftHanded, bool rleCompressed) const {
 	const int nameLength = (int)node.name().size();
 	wrapSave(stream.writeUInt8(nameLength));
@@ -201,23 +203,26 @@ bool QBFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::
 	}
 	wrapSave(stream->writeUInt32(257)) // version
 	wrapSave(stream->writeUInt32((uint32_t)ColorFormat::RGBA))
-	const bool leftHanded = core::Var::getSafe(cfg::VoxformatQBSaveLeftHanded)->boolVal();
+	const bool leftHanded = ctx.config.qbSaveLeftHanded;
 	const ZAxisOrientation orientation = leftHanded ? ZAxisOrientation::LeftHanded : ZAxisOrientation::RightHanded;
-	const bool rleCompressed = core::Var::getSafe(cfg::VoxformatQBSaveCompressed)->boolVal();
+	const bool rleCompressed = ctx.config.qbSaveCompressed;
 	wrapSave(stream->writeUInt32((uint32_t)orientation))
 	wrapSave(stream->writeUInt32(rleCompressed ? (uint32_t)Compression::RLE : (uint32_t)Compression::None))
 	wrapSave(stream->writeUInt32((uint32_t)VisibilityMask::AlphaChannelVisibleByValue))
 	wrapSave(stream->writeUInt32((uint32_t)sceneGraph.size(scenegraph::SceneGraphNodeType::AllModels)))
+	core::DynamicArray<const scenegraph::SceneGraphNode *> nodes;
 	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
-		const scenegraph::SceneGraphNode &node = *iter;
-		if (!saveMatrix(*stream, sceneGraph, node, leftHanded, rleCompressed)) {
-			return false;
-		}
-	}
-	return true;
+		nodes.push_back(&*iter);
+	}
+	return encodeParallel(
+		nodes.size(),
+		[&](size_t i, io::WriteStream &out) {
+			return saveMatrix(out, sceneGraph, *nodes[i], leftHanded, rleCompressed);
+		},
+		*stream);
 }
 
-voxel::Voxel QBFormat::getVoxel(State &state, io::SeekableReadStream &stream, palette::PaletteLookup &palLookup) {
+voxel::Voxel QBFormat::getVoxel(State &state, io::BufferedReadStream &stream, palette::PaletteLookup &palLookup) {
 	core::RGBA color(0);
 	if (!readColor(state, stream, color)) {
 		return voxel::Voxel();
@@ -230,7 +235,7 @@ voxel::Voxel QBFormat::getVoxel(State &state, io::SeekableReadStream &stream, pa
 	return v;
 }
 
-bool QBFormat::readColor(State &state, io::SeekableReadStream &stream, core::RGBA &color) {
+bool QBFormat::readColor(State &state, io::BufferedReadStream &stream, core::RGBA &color) {
 	if (state._colorFormat == ColorFormat::RGBA) {
 		wrap(stream.readUInt8(color.r))
 		wrap(stream.readUInt8(color.g))
@@ -252,7 +257,7 @@ bool QBFormat::readColor(State &state, io::SeekableReadStream &stream, core::RGB
 	return true;
 }
 
-bool QBFormat::readMatrix(State &state, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph,
+bool QBFormat::readMatrix(State &state, io::BufferedReadStream &stream, scenegraph::SceneGraph &sceneGraph,
 						  palette::PaletteLookup &palLookup) {
 	core::String name;
 	wrapBool(stream.readPascalStringUInt8(name))
@@ -380,7 +385,7 @@ bool QBFormat::readMatrix(State &state, io::SeekableReadStream &stream, scenegra
 	return true;
 }
 
-bool QBFormat::readPalette(State &state, io::SeekableReadStream &stream, RGBAMap &colors) {
+bool QBFormat::readPalette(State &state, io::BufferedReadStream &stream, RGBAMap &colors) {
 	uint8_t nameLength;
 	wrap(stream.readUInt8(nameLength));
 	if (stream.skip(nameLength) == -1) {
@@ -453,39 +458,123 @@ bool QBFormat::readPalette(State &state, io::SeekableReadStream &stream, RGBAMap
 	return true;
 }
 
-size_t QBFormat::loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
-							 const LoadContext &ctx) {
-	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
-	if (!stream) {
-		Log::error("Could not load file %s", filename.c_str());
-		return 0;
-	}
-
-	State state;
-	wrap(stream->readUInt32(state._version))
+bool QBFormat::readHeader(State &state, io::BufferedReadStream &stream, uint32_t &numMatrices) {
+	wrap(stream.readUInt32(state._version))
 	uint32_t colorFormat;
-	wrap(stream->readUInt32(colorFormat))
+	wrap(stream.readUInt32(colorFormat))
 	state._colorFormat = (ColorFormat)colorFormat;
 	uint32_t zAxisOrientation;
-	wrap(stream->readUInt32(zAxisOrientation))
+	wrap(stream.readUInt32(zAxisOrientation))
 	state._zAxisOrientation = (ZAxisOrientation)zAxisOrientation;
 	uint32_t compressed;
-	wrap(stream->readUInt32(compressed))
+	wrap(stream.readUInt32(compressed))
 	state._compressed = (Compression)compressed;
 	uint32_t visibilityMaskEncoded;
-	wrap(stream->readUInt32(visibilityMaskEncoded))
+	wrap(stream.readUInt32(visibilityMaskEncoded))
 	state._visibilityMaskEncoded = (VisibilityMask)visibilityMaskEncoded;
 
-	uint32_t numMatrices;
-	wrap(stream->readUInt32(numMatrices))
+	wrap(stream.readUInt32(numMatrices))
 	if (numMatrices > 16384) {
 		Log::error("Max allowed matrices exceeded: %u", numMatrices);
+		return false;
+	}
+	return true;
+}
+
+bool QBFormat::probeMatrix(State &state, io::BufferedReadStream &stream, ProbeInfo &info) {
+	core::String name;
+	wrapBool(stream.readPascalStringUInt8(name))
+	glm::uvec3 size(0);
+	wrap(stream.readUInt32(size.x))
+	wrap(stream.readUInt32(size.y))
+	wrap(stream.readUInt32(size.z))
+	if (size.x == 0 || size.y == 0 || size.z == 0) {
+		Log::error("Invalid size (%i:%i:%i)", size.x, size.y, size.z);
+		return false;
+	}
+	if (size.x > 2048 || size.y > 2048 || size.z > 2048) {
+		Log::error("Volume exceeds the max allowed size: %i:%i:%i", size.x, size.y, size.z);
+		return false;
+	}
+	// offset
+	if (stream.skip(3 * sizeof(int32_t)) == -1) {
+		Log::error("Failed to skip the matrix offset");
+		return false;
+	}
+	voxel::Region region;
+	if (state._zAxisOrientation == ZAxisOrientation::RightHanded) {
+		region = voxel::Region(0, 0, 0, (int)size.z - 1, (int)size.y - 1, (int)size.x - 1);
+	} else {
+		region = voxel::Region(0, 0, 0, (int)size.x - 1, (int)size.y - 1, (int)size.z - 1);
+	}
+	info.addNode(name, scenegraph::SceneGraphNodeType::Model, -1, region);
+
+	// every voxel is a 4 byte color - see readColor()
+	if (state._compressed == Compression::None) {
+		if (stream.skip((int64_t)size.x * size.y * size.z * 4) == -1) {
+			Log::error("Failed to skip the matrix voxels");
+			return false;
+		}
+		return true;
+	}
+	for (uint32_t z = 0u; z < size.z; ++z) {
+		for (;;) {
+			uint32_t data;
+			wrap(stream.peekUInt32(data))
+			if (data == qb::NEXT_SLICE_FLAG) {
+				stream.skip(sizeof(data));
+				break;
+			}
+			if (data == qb::RLE_FLAG) {
+				stream.skip(2 * sizeof(data));
+			}
+			if (stream.skip(sizeof(data)) == -1) {
+				Log::error("Failed to skip the matrix voxels");
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool QBFormat::probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+					 const LoadContext &ctx) {
+	core::ScopedPtr<io::SeekableReadStream> fileStream(archive->readStream(filename));
+	if (!fileStream) {
+		Log::error("Could not load file %s", filename.c_str());
+		return false;
+	}
+	io::BufferedReadStream stream(*fileStream);
+	State state;
+	uint32_t numMatrices;
+	wrapBool(readHeader(state, stream, numMatrices))
+	for (uint32_t i = 0; i < numMatrices; i++) {
+		if (!probeMatrix(state, stream, info)) {
+			Log::error("Failed to probe the matrix %u", i);
+			break;
+		}
+	}
+	return true;
+}
+
+size_t QBFormat::loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
+							 const LoadContext &ctx) {
+	core::ScopedPtr<io::SeekableReadStream> fileStream(archive->readStream(filename));
+	if (!fileStream) {
+		Log::error("Could not load file %s", filename.c_str());
+		return 0;
+	}
+	io::BufferedReadStream stream(*fileStream);
+
+	State state;
+	uint32_t numMatrices;
+	if (!readHeader(state, stream, numMatrices)) {
 		return 0;
 	}
 	RGBAMap colors;
 	for (uint32_t i = 0; i < numMatrices; i++) {
 		Log::debug("Loading matrix colors: %u", i);
-		if (!readPalette(state, *stream, colors)) {
+		if (!readPalette(state, stream, colors)) {
 			Log::error("Failed to load the matrix colors %u", i);
 			break;
 		}
@@ -496,32 +585,15 @@ size_t QBFormat::loadPalette(const core::String &filename, const io::ArchivePtr
 bool QBFormat::loadGroupsRGBA(const core::String &filename, const io::ArchivePtr &archive,
 							  scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette,
 							  const LoadContext &ctx) {
-	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
-	if (!stream) {
+	core::ScopedPtr<io::SeekableReadStream> fileStream(archive->readStream(filename));
+	if (!fileStream) {
 		Log::error("Could not load file %s", filename.c_str());
 		return false;
 	}
+	io::BufferedReadStream stream(*fileStream);
 	State state;
-	wrap(stream->readUInt32(state._version))
-	uint32_t colorFormat;
-	wrap(stream->readUInt32(colorFormat))
-	state._colorFormat = (ColorFormat)colorFormat;
-	uint32_t zAxisOrientation;
-	wrap(stream->readUInt32(zAxisOrientation))
-	state._zAxisOrientation = (ZAxisOrientation)zAxisOrientation;
-	uint32_t compressed;
-	wrap(stream->readUInt32(compressed))
-	state._compressed = (Compression)compressed;
-	uint32_t visibilityMaskEncoded;
-	wrap(stream->readUInt32(visibilityMaskEncoded))
-	state._visibilityMaskEncoded = (VisibilityMask)visibilityMaskEncoded;
-
 	uint32_t numMatrices;
-	wrap(stream->readUInt32(numMatrices))
-	if (numMatrices > 16384) {
-		Log::error("Max allowed matrices exceeded: %u", numMatrices);
-		return false;
-	}
+	wrapBool(readHeader(state, stream, numMatrices))
 
 	Log::debug("Version: %u", state._version);
 	Log::debug("ColorFormat: %u", core::enumVal(state._colorFormat));
@@ -534,7 +606,7 @@ bool QBFormat::loadGroupsRGBA(const core::String &filename, const io::ArchivePtr
 	palette::PaletteLookup palLookup(palette);
 	for (uint32_t i = 0; i < numMatrices; i++) {
 		Log::debug("Loading matrix: %u", i);
-		if (!readMatrix(state, *stream, sceneGraph, palLookup)) {
+		if (!readMatrix(state, stream, sceneGraph, palLookup)) {
 			Log::error("Failed to load the matrix %u", i);
 			break;
 		}
@@ -6,6 +6,10 @@
 
 #include "voxelformat/Format.h"
 
+namespace io {
+class BufferedReadStream;
+}
+
 namespace palette {
 class PaletteLookup;
 }
@@ -43,20 +47,27 @@ private:
 	// left shift values for the vis mask for the single faces
 	enum class VisMaskSides : uint8_t { Invisble, Left, Right, Top, Bottom, Front, Back };
 
-	bool readColor(State &state, io::SeekableReadStream &stream, core::RGBA &color);
-	voxel::Voxel getVoxel(State &state, io::SeekableReadStream &stream, palette::PaletteLookup &palLookup);
-	bool readMatrix(State &state, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph,
+	bool readHeader(State &state, io::BufferedReadStream &stream, uint32_t &numMatrices);
+	bool readColor(State &state, io::BufferedReadStream &stream, core::RGBA &color);
+	voxel::Voxel getVoxel(State &state, io::BufferedReadStream &stream, palette::PaletteLookup &palLookup);
+	bool readMatrix(State &state, io::BufferedReadStream &stream, scenegraph::SceneGraph &sceneGraph,
 					palette::PaletteLookup &palLookup);
-	bool readPalette(State &state, io::SeekableReadStream &stream, RGBAMap &colors);
+	bool readPalette(State &state, io::BufferedReadStream &stream, RGBAMap &colors);
+	/**
+	 * @brief Reads the name and the size of a matrix and skips the voxels
+	 */
+	bool probeMatrix(State &state, io::BufferedReadStream &stream, ProbeInfo &info);
 	bool loadGroupsRGBA(const core::String &filename, const io::ArchivePtr &archive,
 						scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette,
 						const LoadContext &ctx) override;
-	bool saveMatrix(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
+	bool saveMatrix(io::WriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
 					const scenegraph::SceneGraphNode &node, bool leftHanded, bool rleCompressed) const;
 	bool saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
 					const io::ArchivePtr &archive, const SaveContext &ctx) override;
 
 public:
+	bool probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+			   const LoadContext &ctx) override;
 	size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
 					   const LoadContext &ctx) override;
 
@@ -7,11 +7,9 @@
 #include "core/Common.h"
 #include "core/FourCC.h"
 #include "core/GLM.h"
-#include "core/ConfigVar.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
-#include "core/Var.h"
-#include "io/BufferedReadWriteStream.h"
+#include "io/ChunkedWriteStream.h"
 #include "io/Stream.h"
 #include "io/ZipReadStream.h"
 #include "io/ZipWriteStream.h"
@@ -20,6 +18,7 @@
 #include "voxel/MaterialColor.h"
 #include "palette/Palette.h"
 #include "voxel/RawVolume.h"
+#include "voxelformat/FormatProbe.h"
 #include <glm/common.hpp>
 
 namespace voxelformat {
@@ -130,18 +129,15 @@ public:
 		return false;                                                                                                  \
 	}
 
-bool QBTFormat::saveMatrix(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
-						   const scenegraph::SceneGraphNode &node, bool colorMap) const {
+bool QBTFormat::compressMatrix(io::WriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
+							   const scenegraph::SceneGraphNode &node, bool colorMap) const {
 	const voxel::Region &region = sceneGraph.resolveRegion(node);
 	const glm::ivec3 &mins = region.getLowerCorner();
 	const glm::ivec3 &maxs = region.getUpperCorner();
-	const glm::ivec3 size = region.getDimensionsInVoxels();
 
 	const palette::Palette &palette = node.palette();
 
-	const int zlibBufSize = size.x * size.y * size.z * (int)sizeof(uint32_t);
-	io::BufferedReadWriteStream bufferStream(zlibBufSize);
-	io::ZipWriteStream zipStream(bufferStream);
+	io::ZipWriteStream zipStream(stream);
 
 	const voxel::RawVolume *v = sceneGraph.resolveVolume(node);
 	for (int x = mins.x; x <= maxs.x; ++x) {
@@ -173,7 +169,18 @@ bool QBTFormat::saveMatrix(io::SeekableWriteStream &stream, const scenegraph::Sc
 		}
 	}
 
-	zipStream.flush();
+	return zipStream.flush();
+}
+
+bool QBTFormat::saveMatrix(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
+						   const scenegraph::SceneGraphNode &node, const SaveState &state) const {
+	const io::ChunkedWriteStream *bufferStream = nullptr;
+	if (!state.matrices.get(node.id(), bufferStream)) {
+		Log::error("Could not save qbt file: no voxel data for node %i", node.id());
+		return false;
+	}
+	const voxel::Region &region = sceneGraph.resolveRegion(node);
+	const glm::ivec3 size = region.getDimensionsInVoxels();
 
 	wrapSave(stream.writePascalStringUInt32LE(node.name()));
 	Log::debug("Save matrix with name %s", node.name().c_str());
@@ -199,9 +206,9 @@ bool QBTFormat::saveMatrix(io::SeekableWriteStream &stream, const scenegraph::Sc
 	wrapSave(stream.writeUInt32(size.y));
 	wrapSave(stream.writeUInt32(size.z));
 
-	Log::debug("save %i compressed bytes", (int)bufferStream.size());
-	wrapSave(stream.writeUInt32(bufferStream.size()));
-	if (stream.write(bufferStream.getBuffer(), bufferStream.size()) == -1) {
+	Log::debug("save %i compressed bytes", (int)bufferStream->size());
+	wrapSave(stream.writeUInt32(bufferStream->size()));
+	if (!bufferStream->writeTo(stream)) {
 		Log::error("Could not save qbt file: failed to write the compressed buffer");
 		return false;
 	}
@@ -223,39 +230,39 @@ bool QBTFormat::saveColorMap(io::SeekableWriteStream &stream, const palette::Pal
 }
 
 bool QBTFormat::saveCompound(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
-							 const scenegraph::SceneGraphNode &node, bool colorMap) const {
-	wrapSave(saveMatrix(stream, sceneGraph, node, colorMap))
+							 const scenegraph::SceneGraphNode &node, const SaveState &state) const {
+	wrapSave(saveMatrix(stream, sceneGraph, node, state))
 	wrapSave(stream.writeUInt32((int)node.children().size()));
 	for (int nodeId : node.children()) {
 		const scenegraph::SceneGraphNode &cnode = sceneGraph.node(nodeId);
-		wrapSave(saveNode(stream, sceneGraph, cnode, colorMap))
+		wrapSave(saveNode(stream, sceneGraph, cnode, state))
 	}
 	return true;
 }
 
 bool QBTFormat::saveNode(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
-						 const scenegraph::SceneGraphNode &node, bool colorMap) const {
+						 const scenegraph::SceneGraphNode &node, const SaveState &state) const {
 	const scenegraph::SceneGraphNodeType type = node.type();
 	if (node.isAnyModelNode()) {
 		if (node.children().empty()) {
 			qbt::ScopedQBTHeader header(stream, type);
-			wrapSave(saveMatrix(stream, sceneGraph, node, colorMap) && header.success())
+			wrapSave(saveMatrix(stream, sceneGraph, node, state) && header.success())
 		} else {
 			qbt::ScopedQBTHeader scoped(stream, qbt::NODE_TYPE_COMPOUND);
-			wrapSave(saveCompound(stream, sceneGraph, node, colorMap) && scoped.success())
+			wrapSave(saveCompound(stream, sceneGraph, node, state) && scoped.success())
 		}
 	} else if (type == scenegraph::SceneGraphNodeType::Group || type == scenegraph::SceneGraphNodeType::Root) {
-		wrapSave(saveModel(stream, sceneGraph, node, colorMap))
+		wrapSave(saveModel(stream, sceneGraph, node, state))
 	}
 	return true;
 }
 
 bool QBTFormat::saveModel(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
-						  const scenegraph::SceneGraphNode &node, bool colorMap) const {
+						  const scenegraph::SceneGraphNode &node, const SaveState &state) const {
 	if (node.children().size() == 1) {
 		for (int nodeId : node.children()) {
 			const scenegraph::SceneGraphNode &cnode = sceneGraph.node(nodeId);
-			wrapSave(saveNode(stream, sceneGraph, cnode, colorMap))
+			wrapSave(saveNode(stream, sceneGraph, cnode, state))
 		}
 		return true;
 	}
@@ -264,7 +271,7 @@ bool QBTFormat::saveModel(io::SeekableWriteStream &stream, const scenegraph::Sce
 	wrapSave(stream.writeUInt32(children));
 	for (int nodeId : node.children()) {
 		const scenegraph::SceneGraphNode &cnode = sceneGraph.node(nodeId);
-		wrapSave(saveNode(stream, sceneGraph, cnode, colorMap))
+		wrapSave(saveNode(stream, sceneGraph, cnode, state))
 	}
 	return scoped.success();
 }
@@ -290,8 +297,9 @@ bool QBTFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core:
 	wrapSave(stream->writeFloat(1.0f)); // globalscale
 	wrapSave(stream->writeFloat(1.0f)); // globalscale
 	wrapSave(stream->writeFloat(1.0f)); // globalscale
-	const bool colorMap = core::Var::getSafe(cfg::VoxformatQBTPaletteMode)->boolVal();
-	if (colorMap) {
+	SaveState state;
+	state.colorMap = ctx.config.qbtPaletteMode;
+	if (state.colorMap) {
 		const palette::Palette &palette = sceneGraph.firstPalette();
 		if (!saveColorMap(*stream, palette)) {
 			return false;
@@ -305,7 +313,24 @@ bool QBTFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core:
 	if (!stream->writeString("DATATREE", false)) {
 		return false;
 	}
-	return saveNode(*stream, sceneGraph, sceneGraph.root(), colorMap);
+
+	core::DynamicArray<const scenegraph::SceneGraphNode *> nodes;
+	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
+		nodes.push_back(&*iter);
+	}
+	EncodedBuffers buffers;
+	const bool compressed = encodeParallel(
+		nodes.size(),
+		[&](size_t i, io::WriteStream &out) { return compressMatrix(out, sceneGraph, *nodes[i], state.colorMap); },
+		buffers);
+	if (!compressed) {
+		Log::error("Could not save qbt file: failed to compress the voxel data");
+		return false;
+	}
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		state.matrices.put(nodes[i]->id(), buffers[i].get());
+	}
+	return saveNode(*stream, sceneGraph, sceneGraph.root(), state);
 }
 
 bool QBTFormat::skipNode(io::SeekableReadStream &stream) {
@@ -329,16 +354,17 @@ bool QBTFormat::skipNode(io::SeekableReadStream &stream) {
  * ChildCount 4 bytes, uint, number of child nodes
  * Children ChildCount nodes currently of type Matrix or Compound
  */
-bool QBTFormat::loadCompound(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, int parent,
-							 palette::Palette &palette, Header &state) {
-	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Group);
-	node.setName("Compound");
-	int nodeId = sceneGraph.emplace(core::move(node), parent);
-
-	if (!loadMatrix(stream, sceneGraph, nodeId, palette, state)) {
+bool QBTFormat::loadCompound(io::SeekableReadStream &stream, TreeNodes &nodes, int parent, bool voxels) {
+	TreeNode node;
+	node.name = "Compound";
+	node.parent = parent;
+	const int nodeIdx = (int)nodes.size();
+	nodes.emplace_back(core::move(node));
+
+	if (!loadMatrix(stream, nodes, nodeIdx, voxels)) {
 		return false;
 	}
-	const bool mergeCompounds = core::Var::getSafe(cfg::VoxformatQBTMergeCompounds)->boolVal();
+	const bool mergeCompounds = _config.qbtMergeCompounds;
 	uint32_t childCount;
 	wrap(stream.readUInt32(childCount));
 	Log::debug("Load %u children", childCount);
@@ -349,7 +375,7 @@ bool QBTFormat::loadCompound(io::SeekableReadStream &stream, scenegraph::SceneGr
 				return false;
 			}
 		} else {
-			if (!loadNode(stream, sceneGraph, nodeId, palette, state)) {
+			if (!loadNode(stream, nodes, nodeIdx, voxels)) {
 				return false;
 			}
 		}
@@ -381,17 +407,14 @@ bool QBTFormat::loadCompound(io::SeekableReadStream &stream, scenegraph::SceneGr
  * than 0 then the voxel is solid. Even when a voxel is solid is may not be needed to be rendered because it is a core
  * voxel that is surrounded by 6 other voxels and thus invisible. If M = 1 then the voxel is a core voxel.
  */
-bool QBTFormat::loadMatrix(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, int parent,
-						   palette::Palette &palette, Header &state) {
+bool QBTFormat::loadMatrix(io::SeekableReadStream &stream, TreeNodes &nodes, int parent, bool voxels) {
 	core::String name;
 	wrapBool(stream.readPascalStringUInt32LE(name))
 	Log::debug("Matrix name: %s", name.c_str());
 	glm::ivec3 translation;
-	scenegraph::SceneGraphTransform transform;
 	wrap(stream.readInt32(translation.x))
 	wrap(stream.readInt32(translation.y))
 	wrap(stream.readInt32(translation.z))
-	transform.setWorldTranslation(translation);
 
 	glm::uvec3 localScale;
 	wrap(stream.readUInt32(localScale.x))
@@ -427,50 +450,30 @@ bool QBTFormat::loadMatrix(io::SeekableReadStream &stream, scenegraph::SceneGrap
 		Log::warn("Size of matrix results in empty space - voxelDataSize: %u", voxelDataSize);
 		return false;
 	}
-	io::ZipReadStream zipStream(stream, voxelDataSize);
-
 	const voxel::Region region(glm::ivec3(0), glm::ivec3(size) - 1);
 	if (!region.isValid()) {
 		Log::error("Invalid region");
 		return false;
 	}
-	core::ScopedPtr<voxel::RawVolume> volume(new voxel::RawVolume(region));
-	for (int32_t x = 0; x < (int)size.x; x++) {
-		for (int32_t z = 0; z < (int)size.z; z++) {
-			for (int32_t y = 0; y < (int)size.y; y++) {
-				uint8_t red;
-				wrap(zipStream.readUInt8(red))
-				uint8_t green;
-				wrap(zipStream.readUInt8(green))
-				uint8_t blue;
-				wrap(zipStream.readUInt8(blue))
-				uint8_t mask;
-				wrap(zipStream.readUInt8(mask))
-				if (mask == 0u) {
-					continue;
-				}
-				if (state.colorFormat == ColorFormat::Palette) {
-					const voxel::Voxel &voxel = voxel::createVoxel(palette, red);
-					volume->setVoxel(x, y, z, voxel);
-				} else {
-					const core::RGBA color = flattenRGB(red, green, blue);
-					uint8_t index = 1;
-					palette.tryAdd(color, false, &index);
-					const voxel::Voxel &voxel = voxel::createVoxel(palette, index);
-					volume->setVoxel(x, y, z, voxel);
-				}
-			}
-		}
+	TreeNode node;
+	node.matrix = true;
+	node.parent = parent;
+	node.name = name;
+	node.translation = translation;
+	node.pivot = pivot;
+	node.size = size;
+	if (!voxels) {
+		wrapBool(stream.skip(voxelDataSize) != -1)
+		nodes.emplace_back(core::move(node));
+		return true;
 	}
-	scenegraph::SceneGraphNode node;
-	node.setVolume(volume.release(), true);
-	node.setName(name);
-	node.setPivot(pivot);
-	node.setPalette(palette);
-	const scenegraph::KeyFrameIndex keyFrameIdx = 0;
-	node.setTransform(keyFrameIdx, transform);
-	const int id = sceneGraph.emplace(core::move(node), parent);
-	return id != -1;
+	node.voxelData.resize(voxelDataSize);
+	if (stream.read(node.voxelData.data(), voxelDataSize) != (int)voxelDataSize) {
+		Log::error("Could not load qbt file: Not enough data in stream for the voxel data");
+		return false;
+	}
+	nodes.emplace_back(core::move(node));
+	return true;
 }
 
 /**
@@ -479,8 +482,7 @@ bool QBTFormat::loadMatrix(io::SeekableReadStream &stream, scenegraph::SceneGrap
  * DataSize 4 bytes, uint, number of bytes used for this node and all child nodes (excluding TypeID and DataSize of this
  * node) ChildCount 4 bytes, uint, number of child nodes Children ChildCount nodes currently of type Matrix or Compound
  */
-bool QBTFormat::loadModel(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, int parent,
-						  palette::Palette &palette, Header &state) {
+bool QBTFormat::loadModel(io::SeekableReadStream &stream, TreeNodes &nodes, int parent, bool voxels) {
 	uint32_t childCount;
 	wrap(stream.readUInt32(childCount));
 	if (childCount > 2048u) {
@@ -488,11 +490,13 @@ bool QBTFormat::loadModel(io::SeekableReadStream &stream, scenegraph::SceneGraph
 		return false;
 	}
 	Log::debug("Found %u children", childCount);
-	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Group);
-	node.setName("Model");
-	int nodeId = sceneGraph.emplace(core::move(node), parent);
+	TreeNode node;
+	node.name = "Model";
+	node.parent = parent;
+	const int nodeIdx = (int)nodes.size();
+	nodes.emplace_back(core::move(node));
 	for (uint32_t i = 0; i < childCount; i++) {
-		if (!loadNode(stream, sceneGraph, nodeId, palette, state)) {
+		if (!loadNode(stream, nodes, nodeIdx, voxels)) {
 			return false;
 		}
 	}
@@ -504,8 +508,7 @@ bool QBTFormat::loadModel(io::SeekableReadStream &stream, scenegraph::SceneGraph
  * SectionCaption 8 bytes = "DATATREE"
  * RootNode, can currently either be Model, Compound or Matrix
  */
-bool QBTFormat::loadNode(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, int parent,
-						 palette::Palette &palette, Header &state) {
+bool QBTFormat::loadNode(io::SeekableReadStream &stream, TreeNodes &nodes, int parent, bool voxels) {
 	uint32_t nodeTypeID;
 	wrap(stream.readUInt32(nodeTypeID));
 	uint32_t dataSize;
@@ -515,7 +518,7 @@ bool QBTFormat::loadNode(io::SeekableReadStream &stream, scenegraph::SceneGraph
 	switch (nodeTypeID) {
 	case qbt::NODE_TYPE_MATRIX: {
 		Log::debug("Found matrix");
-		if (!loadMatrix(stream, sceneGraph, parent, palette, state)) {
+		if (!loadMatrix(stream, nodes, parent, voxels)) {
 			Log::error("Failed to load matrix");
 			return false;
 		}
@@ -524,7 +527,7 @@ bool QBTFormat::loadNode(io::SeekableReadStream &stream, scenegraph::SceneGraph
 	}
 	case qbt::NODE_TYPE_MODEL:
 		Log::debug("Found model");
-		if (!loadModel(stream, sceneGraph, parent, palette, state)) {
+		if (!loadModel(stream, nodes, parent, voxels)) {
 			Log::error("Failed to load model");
 			return false;
 		}
@@ -532,7 +535,7 @@ bool QBTFormat::loadNode(io::SeekableReadStream &stream, scenegraph::SceneGraph
 		break;
 	case qbt::NODE_TYPE_COMPOUND:
 		Log::debug("Found compound");
-		if (!loadCompound(stream, sceneGraph, parent, palette, state)) {
+		if (!loadCompound(stream, nodes, parent, voxels)) {
 			Log::error("Failed to load compound");
 			return false;
 		}
@@ -547,6 +550,109 @@ bool QBTFormat::loadNode(io::SeekableReadStream &stream, scenegraph::SceneGraph
 	return true;
 }
 
+/**
+ * The matrices of a data tree are inflated in parallel - the scene graph nodes are created afterwards in the order of
+ * the tree. See @c loadMatrix() for the layout of the voxel data.
+ */
+bool QBTFormat::loadDataTree(TreeNodes &nodes, scenegraph::SceneGraph &sceneGraph, palette::Palette &palette,
+							 const Header &state) {
+	// the rgba colors are added to the palette in the order of the matrices - only the inflating is done in parallel
+	// in this case
+	const bool colorMap = state.colorFormat == ColorFormat::Palette;
+	core::DynamicArray<core::DynamicArray<uint8_t>> rgbm(nodes.size());
+	const bool decoded = decodeParallel(nodes.size(), [&](size_t i) {
+		TreeNode &node = nodes[i];
+		if (!node.matrix) {
+			return true;
+		}
+		const glm::uvec3 &size = node.size;
+		core::DynamicArray<uint8_t> &buf = rgbm[i];
+		buf.resize((size_t)size.x * size.y * size.z * 4u);
+		if (io::ZipReadStream::decompressInto(node.voxelData.data(), node.voxelData.size(), buf.data(), buf.size()) !=
+			(int)buf.size()) {
+			Log::error("Could not load qbt file: Not enough data in the voxel data of matrix %s", node.name.c_str());
+			return false;
+		}
+		node.voxelData.release();
+		node.volume = new voxel::RawVolume(voxel::Region(glm::ivec3(0), glm::ivec3(size) - 1));
+		if (!colorMap) {
+			return true;
+		}
+		const uint8_t *data = buf.data();
+		for (int32_t x = 0; x < (int)size.x; x++) {
+			for (int32_t z = 0; z < (int)size.z; z++) {
+				for (int32_t y = 0; y < (int)size.y; y++, data += 4) {
+					if (data[3] == 0u) {
+						continue;
+					}
+					node.volume->setVoxel(x, y, z, voxel::createVoxel(palette, data[0]));
+				}
+			}
+		}
+		buf.release();
+		return true;
+	});
+	if (!decoded) {
+		for (TreeNode &node : nodes) {
+			delete node.volume;
+		}
+		return false;
+	}
+	if (!colorMap) {
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			TreeNode &node = nodes[i];
+			if (!node.matrix) {
+				continue;
+			}
+			const glm::uvec3 &size = node.size;
+			const uint8_t *data = rgbm[i].data();
+			for (int32_t x = 0; x < (int)size.x; x++) {
+				for (int32_t z = 0; z < (int)size.z; z++) {
+					for (int32_t y = 0; y < (int)size.y; y++, data += 4) {
+						if (data[3] == 0u) {
+							continue;
+						}
+						const core::RGBA color = flattenRGB(data[0], data[1], data[2]);
+						uint8_t index = 1;
+						palette.tryAdd(color, false, &index);
+						node.volume->setVoxel(x, y, z, voxel::createVoxel(palette, index));
+					}
+				}
+			}
+			rgbm[i].release();
+		}
+	}
+
+	core::DynamicArray<int> nodeIds(nodes.size());
+	bool success = true;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		TreeNode &node = nodes[i];
+		const int parent = node.parent == -1 ? sceneGraph.root().id() : nodeIds[node.parent];
+		if (!node.matrix) {
+			scenegraph::SceneGraphNode groupNode(scenegraph::SceneGraphNodeType::Group);
+			groupNode.setName(node.name);
+			nodeIds[i] = sceneGraph.emplace(core::move(groupNode), parent);
+			continue;
+		}
+		if (!success) {
+			delete node.volume;
+			continue;
+		}
+		scenegraph::SceneGraphNode modelNode;
+		modelNode.setVolume(node.volume, true);
+		modelNode.setName(node.name);
+		modelNode.setPivot(node.pivot);
+		modelNode.setPalette(palette);
+		scenegraph::SceneGraphTransform transform;
+		transform.setWorldTranslation(node.translation);
+		const scenegraph::KeyFrameIndex keyFrameIdx = 0;
+		modelNode.setTransform(keyFrameIdx, transform);
+		nodeIds[i] = sceneGraph.emplace(core::move(modelNode), parent);
+		success = nodeIds[i] != -1;
+	}
+	return success;
+}
+
 /**
  * Color Map
  * SectionCaption 8 bytes = "COLORMAP"
@@ -651,11 +757,16 @@ size_t QBTFormat::loadPalette(const core::String &filename, const io::ArchivePtr
 			return 0u;
 		}
 		if (0 == memcmp(buf, "DATATREE", 8)) {
-			scenegraph::SceneGraph sceneGraph;
-			if (!loadNode(*stream, sceneGraph, sceneGraph.root().id(), palette, state)) {
+			TreeNodes nodes;
+			if (!loadNode(*stream, nodes, -1)) {
 				Log::error("Failed to load node");
 				return 0u;
 			}
+			scenegraph::SceneGraph sceneGraph;
+			if (!loadDataTree(nodes, sceneGraph, palette, state)) {
+				Log::error("Failed to load the data tree");
+				return 0u;
+			}
 		} else {
 			Log::error("Unknown section found: %c%c%c%c%c%c%c%c", buf[0], buf[1], buf[2], buf[3], buf[4], buf[5],
 					   buf[6], buf[7]);
@@ -667,6 +778,53 @@ size_t QBTFormat::loadPalette(const core::String &filename, const io::ArchivePtr
 	return 0;
 }
 
+bool QBTFormat::probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+					  const LoadContext &ctx) {
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
+	if (!stream) {
+		Log::error("Could not load file %s", filename.c_str());
+		return false;
+	}
+	Header state;
+	wrapBool(loadHeader(*stream, state))
+
+	while (stream->remaining() > 0) {
+		char buf[8];
+		wrapBool(stream->readString(sizeof(buf), buf));
+		if (0 == memcmp(buf, "COLORMAP", 7)) {
+			palette::Palette palette;
+			if (!loadColorMap(*stream, palette)) {
+				Log::error("Failed to load color map");
+				return false;
+			}
+			if (palette.colorCount() > 0) {
+				info.setPalette(palette);
+			}
+		} else if (0 == memcmp(buf, "DATATREE", 8)) {
+			TreeNodes nodes;
+			if (!loadNode(*stream, nodes, -1, false)) {
+				Log::error("Failed to load node");
+				return false;
+			}
+			const int offset = (int)info.nodes.size();
+			for (const TreeNode &node : nodes) {
+				const int parent = node.parent == -1 ? -1 : offset + node.parent;
+				if (node.matrix) {
+					const voxel::Region region(glm::ivec3(0), glm::ivec3(node.size) - 1);
+					info.addNode(node.name, scenegraph::SceneGraphNodeType::Model, parent, region);
+				} else {
+					info.addNode(node.name, scenegraph::SceneGraphNodeType::Group, parent);
+				}
+			}
+		} else {
+			Log::error("Unknown section found: %c%c%c%c%c%c%c%c", buf[0], buf[1], buf[2], buf[3], buf[4], buf[5],
+					   buf[6], buf[7]);
+			return false;
+		}
+	}
+	return true;
+}
+
 bool QBTFormat::loadGroupsPalette(const core::String &filename, const io::ArchivePtr &archive,
 								  scenegraph::SceneGraph &sceneGraph, palette::Palette &palette, const LoadContext &ctx) {
 	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
@@ -693,10 +851,15 @@ bool QBTFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 			}
 		} else if (0 == memcmp(buf, "DATATREE", 8)) {
 			Log::debug("load data tree");
-			if (!loadNode(*stream, sceneGraph, sceneGraph.root().id(), palette, state)) {
+			TreeNodes nodes;
+			if (!loadNode(*stream, nodes, -1)) {
 				Log::error("Failed to load node");
 				return false;
 			}
+			if (!loadDataTree(nodes, sceneGraph, palette, state)) {
+				Log::error("Failed to load the data tree");
+				return false;
+			}
 		} else {
 			Log::error("Unknown section found: %c%c%c%c%c%c%c%c", buf[0], buf[1], buf[2], buf[3], buf[4], buf[5],
 					   buf[6], buf[7]);
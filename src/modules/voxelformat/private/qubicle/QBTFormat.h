@@ -30,35 +30,71 @@ private:
 		glm::vec3 globalScale{0};
 	};
 
+	/**
+	 * @brief The nodes of the data tree are read first. The voxel data of the matrices is decoded in parallel
+	 * afterwards and the scene graph is assembled in the order of the nodes.
+	 */
+	struct TreeNode {
+		/** either a matrix or a group for a model or compound node */
+		bool matrix = false;
+		/** the index of the parent in the @c TreeNodes or @c -1 for the node the data tree is added to */
+		int parent = -1;
+		core::String name;
+		glm::ivec3 translation{0};
+		glm::vec3 pivot{0.0f};
+		glm::uvec3 size{0};
+		/** the zlib compressed rgbm values of a matrix */
+		core::DynamicArray<uint8_t> voxelData;
+		voxel::RawVolume *volume = nullptr;
+	};
+	using TreeNodes = core::DynamicArray<TreeNode>;
+
 	bool loadHeader(io::SeekableReadStream &stream, Header &state);
 
 	bool skipNode(io::SeekableReadStream &stream);
-	bool loadMatrix(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, int parent,
-					palette::Palette &palette, Header &state);
-	bool loadCompound(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, int parent,
-					  palette::Palette &palette, Header &state);
-	bool loadModel(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, int parent,
-				   palette::Palette &palette, Header &state);
-	bool loadNode(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, int parent,
-				  palette::Palette &palette, Header &state);
+	/**
+	 * @param voxels @c false to skip the compressed voxel data of the matrices - see @c probe()
+	 */
+	bool loadMatrix(io::SeekableReadStream &stream, TreeNodes &nodes, int parent, bool voxels = true);
+	bool loadCompound(io::SeekableReadStream &stream, TreeNodes &nodes, int parent, bool voxels = true);
+	bool loadModel(io::SeekableReadStream &stream, TreeNodes &nodes, int parent, bool voxels = true);
+	bool loadNode(io::SeekableReadStream &stream, TreeNodes &nodes, int parent, bool voxels = true);
+	/**
+	 * @brief Decodes the voxel data of the matrices in parallel and adds all nodes to the scene graph
+	 */
+	bool loadDataTree(TreeNodes &nodes, scenegraph::SceneGraph &sceneGraph, palette::Palette &palette,
+					  const Header &state);
 	bool loadColorMap(io::SeekableReadStream &stream, palette::Palette &palette);
 	bool loadGroupsPalette(const core::String &filename, const io::ArchivePtr &archive,
 						   scenegraph::SceneGraph &sceneGraph, palette::Palette &palette,
 						   const LoadContext &ctx) override;
 
+	/**
+	 * @brief The voxel data of the matrices is compressed in parallel before the data tree is written
+	 */
+	struct SaveState {
+		bool colorMap = false;
+		/** the zlib compressed rgbm values by node id */
+		core::DynamicMap<int, const io::ChunkedWriteStream *> matrices;
+	};
+
 	bool saveNode(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
-				  const scenegraph::SceneGraphNode &node, bool colorMap) const;
+				  const scenegraph::SceneGraphNode &node, const SaveState &state) const;
 	bool saveCompound(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
-					  const scenegraph::SceneGraphNode &node, bool colorMap) const;
+					  const scenegraph::SceneGraphNode &node, const SaveState &state) const;
+	bool compressMatrix(io::WriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
+						const scenegraph::SceneGraphNode &node, bool colorMap) const;
 	bool saveMatrix(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
-					const scenegraph::SceneGraphNode &node, bool colorMap) const;
+					const scenegraph::SceneGraphNode &node, const SaveState &state) const;
 	bool saveColorMap(io::SeekableWriteStream &stream, const palette::Palette &palette) const;
 	bool saveModel(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph,
-				   const scenegraph::SceneGraphNode &node, bool colorMap) const;
+				   const scenegraph::SceneGraphNode &node, const SaveState &state) const;
 	bool saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
 					const io::ArchivePtr &archive, const SaveContext &ctx) override;
 
 public:
+	bool probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+			   const LoadContext &ctx) override;
 	size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
 					   const LoadContext &ctx) override;
 
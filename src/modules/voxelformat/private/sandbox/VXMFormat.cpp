@@ -17,6 +17,7 @@
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/MaterialColor.h"
 #include "palette/Palette.h"
+#include "voxelformat/FormatProbe.h"
 #include <glm/common.hpp>
 
 namespace voxelformat {
@@ -30,14 +31,6 @@ static const uint8_t EMPTY_PALETTE = 0xFFu;
 		return false;                                                                                                  \
 	}
 
-#define wrapDelete(read, mem)                                                                                          \
-	if ((read) != 0) {                                                                                                 \
-		Log::error("Could not load vxm file: Not enough data in stream " CORE_STRINGIFY(read) " (line %i)",            \
-				   (int)__LINE__);                                                                                     \
-		delete (mem);                                                                                                  \
-		return false;                                                                                                  \
-	}
-
 #define wrapBool(read)                                                                                                 \
 	if ((read) != true) {                                                                                              \
 		Log::error("Could not load vxm file: Not enough data in stream " CORE_STRINGIFY(read) " (line %i)",            \
@@ -268,18 +261,12 @@ bool VXMFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core:
 	return true;
 }
 
-bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::ArchivePtr &archive,
-								  scenegraph::SceneGraph &sceneGraph, palette::Palette &palette, const LoadContext &ctx) {
-	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
-	if (!stream) {
-		Log::error("Could not load file %s", filename.c_str());
-		return false;
-	}
+bool VXMFormat::loadHeader(io::SeekableReadStream &stream, Header &header, palette::Palette &palette) {
 	uint8_t magic[4];
-	wrap(stream->readUInt8(magic[0]))
-	wrap(stream->readUInt8(magic[1]))
-	wrap(stream->readUInt8(magic[2]))
-	wrap(stream->readUInt8(magic[3]))
+	wrap(stream.readUInt8(magic[0]))
+	wrap(stream.readUInt8(magic[1]))
+	wrap(stream.readUInt8(magic[2]))
+	wrap(stream.readUInt8(magic[3]))
 	if (magic[0] != 'V' || magic[1] != 'X' || magic[2] != 'M') {
 		Log::error("Could not load vxm file: Invalid magic found (%c%c%c%c)", magic[0], magic[1], magic[2], magic[3]);
 		return false;
@@ -299,23 +286,22 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 		return false;
 	}
 
-	scenegraph::SceneGraphTransform transform;
 	glm::vec3 normalizedPivot = glm::vec3{0.5f, 0.0f, 0.5f};
 	glm::uvec3 size(0);
 	Log::debug("Found vxm%i", version);
 	if (version >= 6) {
-		wrap(stream->readUInt32(size.x));
-		wrap(stream->readUInt32(size.y));
-		wrap(stream->readUInt32(size.z));
+		wrap(stream.readUInt32(size.x));
+		wrap(stream.readUInt32(size.y));
+		wrap(stream.readUInt32(size.z));
 	}
 	if (version >= 5) {
-		wrap(stream->readFloat(normalizedPivot.x));
-		wrap(stream->readFloat(normalizedPivot.y));
-		wrap(stream->readFloat(normalizedPivot.z));
+		wrap(stream.readFloat(normalizedPivot.x));
+		wrap(stream.readFloat(normalizedPivot.y));
+		wrap(stream.readFloat(normalizedPivot.z));
 	}
 	if (version >= 9) {
 		uint8_t surface;
-		wrap(stream->readUInt8(surface))
+		wrap(stream.readUInt8(surface))
 		if (surface) {
 			uint32_t skipWidth = 0u;
 			uint32_t skipHeight = 0u;
@@ -324,16 +310,16 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 			uint32_t normal;
 			// since version 10 the start and end values are floats
 			// but for us this fact doesn't matter
-			wrap(stream->readUInt32(startx))
-			wrap(stream->readUInt32(starty))
-			wrap(stream->readUInt32(startz))
-			wrap(stream->readUInt32(endx))
-			wrap(stream->readUInt32(endy))
-			wrap(stream->readUInt32(endz))
-			wrap(stream->readUInt32(normal))
+			wrap(stream.readUInt32(startx))
+			wrap(stream.readUInt32(starty))
+			wrap(stream.readUInt32(startz))
+			wrap(stream.readUInt32(endx))
+			wrap(stream.readUInt32(endy))
+			wrap(stream.readUInt32(endz))
+			wrap(stream.readUInt32(normal))
 			if (version >= 10) {
-				wrap(stream->readUInt32(skipWidth))
-				wrap(stream->readUInt32(skipHeight))
+				wrap(stream.readUInt32(skipWidth))
+				wrap(stream.readUInt32(skipHeight))
 			} else {
 				switch (normal) {
 				case 0:
@@ -353,25 +339,25 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 					break;
 				}
 			}
-			stream->skip(skipWidth * skipHeight);
+			stream.skip(skipWidth * skipHeight);
 		}
 	}
 	if (version >= 8) {
 		float dummy;				   // since version 'A'
-		wrap(stream->readFloat(dummy)); // lod scale
-		wrap(stream->readFloat(dummy)); // lod pivot x
-		wrap(stream->readFloat(dummy)); // lod pivot y
-		wrap(stream->readFloat(dummy)); // lod pivot z
+		wrap(stream.readFloat(dummy)); // lod scale
+		wrap(stream.readFloat(dummy)); // lod pivot x
+		wrap(stream.readFloat(dummy)); // lod pivot y
+		wrap(stream.readFloat(dummy)); // lod pivot z
 	}
 
 	uint32_t lodLevels = 1;
 	if (version >= 7) {
-		wrap(stream->readUInt32(lodLevels));
+		wrap(stream.readUInt32(lodLevels));
 	}
 	for (uint32_t lodLevel = 0u; lodLevel < lodLevels; ++lodLevel) {
 		glm::uvec2 textureDim;
-		wrap(stream->readUInt32(textureDim.x));
-		wrap(stream->readUInt32(textureDim.y));
+		wrap(stream.readUInt32(textureDim.x));
+		wrap(stream.readUInt32(textureDim.y));
 		if (glm::any(glm::greaterThan(textureDim, glm::uvec2(2048)))) {
 			Log::warn("Size of texture exceeds the max allowed value");
 			return false;
@@ -379,19 +365,19 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 
 		if (version >= 11) {
 			uint32_t pixelSize;
-			wrap(stream->readUInt32(pixelSize));
-			stream->skip(pixelSize); // zipped pixel data
+			wrap(stream.readUInt32(pixelSize));
+			stream.skip(pixelSize); // zipped pixel data
 		} else if (version == 3) {
 			uint8_t byte;
 			do {
-				wrap(stream->readUInt8(byte));
+				wrap(stream.readUInt8(byte));
 				if (byte != 0u) {
-					stream->skip(3);
+					stream.skip(3);
 				}
 			} while (byte != 0);
 		} else {
 			uint32_t texAmount;
-			wrap(stream->readUInt32(texAmount));
+			wrap(stream.readUInt32(texAmount));
 			if (texAmount > 0xFFFF) {
 				Log::warn("Size of textures exceeds the max allowed value: %i", texAmount);
 				return false;
@@ -400,17 +386,17 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 			Log::debug("texAmount: %i", (int)texAmount);
 			for (uint32_t t = 0u; t < texAmount; t++) {
 				char textureId[1024];
-				wrapBool(stream->readString(sizeof(textureId), textureId, true))
+				wrapBool(stream.readString(sizeof(textureId), textureId, true))
 				if (version >= 6) {
 					uint32_t texZipped;
-					wrap(stream->readUInt32(texZipped));
-					stream->skip(texZipped);
+					wrap(stream.readUInt32(texZipped));
+					stream.skip(texZipped);
 				} else {
 					Log::debug("tex: %i: %s", (int)t, textureId);
 					uint32_t px = 0u;
 					for (;;) {
 						uint8_t rleStride;
-						wrap(stream->readUInt8(rleStride));
+						wrap(stream.readUInt8(rleStride));
 						if (rleStride == 0u) {
 							break;
 						}
@@ -419,7 +405,7 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 							glm::u8vec3h rgb;
 						};
 						static_assert(sizeof(TexColor) == 3, "Unexpected TexColor size");
-						stream->skip(sizeof(TexColor));
+						stream.skip(sizeof(TexColor));
 						px += rleStride;
 						if (px > textureDim.x * textureDim.y * sizeof(TexColor)) {
 							Log::error("RLE texture chunk exceeds max allowed size");
@@ -431,7 +417,7 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 
 		for (int i = 0; i < 6; ++i) {
 			uint32_t quadAmount;
-			wrap(stream->readUInt32(quadAmount));
+			wrap(stream.readUInt32(quadAmount));
 			if (quadAmount > 0x40000U) {
 				Log::warn("Size of quads exceeds the max allowed value");
 				return false;
@@ -441,14 +427,14 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 				glm::ivec2h uv;
 			};
 			static_assert(sizeof(QuadVertex) == 20, "Unexpected QuadVertex size");
-			stream->skip(quadAmount * 4 * sizeof(QuadVertex));
+			stream.skip(quadAmount * 4 * sizeof(QuadVertex));
 		}
 	}
 
 	if (version <= 5) {
-		wrap(stream->readUInt32(size.x));
-		wrap(stream->readUInt32(size.y));
-		wrap(stream->readUInt32(size.z));
+		wrap(stream.readUInt32(size.x));
+		wrap(stream.readUInt32(size.y));
+		wrap(stream.readUInt32(size.z));
 	}
 
 	if (glm::any(glm::greaterThan(size, glm::uvec3(MaxRegionSize)))) {
@@ -464,34 +450,34 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 
 	if (version >= 11) {
 		// TODO: MATERIAL: parse the material emit data
-		stream->skip(256l * 4l); // palette data rgba for albedo materials
-		stream->skip(256l * 4l); // palette data rgba for emissive materials
+		stream.skip(256l * 4l); // palette data rgba for albedo materials
+		stream.skip(256l * 4l); // palette data rgba for emissive materials
 		uint8_t chunkAmount;	// palette chunks
-		wrap(stream->readUInt8(chunkAmount));
+		wrap(stream.readUInt8(chunkAmount));
 		for (int i = 0; i < (int)chunkAmount; ++i) {
 			char chunkId[1024];
-			wrapBool(stream->readString(sizeof(chunkId), chunkId, true))
-			stream->skip(1); // chunk offset
-			stream->skip(1); // chunk length
+			wrapBool(stream.readString(sizeof(chunkId), chunkId, true))
+			stream.skip(1); // chunk offset
+			stream.skip(1); // chunk length
 		}
 	}
 
 	uint8_t materialAmount;
-	wrap(stream->readUInt8(materialAmount));
+	wrap(stream.readUInt8(materialAmount));
 	Log::debug("Palette of size %i", (int)materialAmount);
 
 	for (int i = 0; i < (int)materialAmount; ++i) {
 		uint8_t blue;
-		wrap(stream->readUInt8(blue));
+		wrap(stream.readUInt8(blue));
 		uint8_t green;
-		wrap(stream->readUInt8(green));
+		wrap(stream.readUInt8(green));
 		uint8_t red;
-		wrap(stream->readUInt8(red));
+		wrap(stream.readUInt8(red));
 		uint8_t alpha;
-		wrap(stream->readUInt8(alpha));
+		wrap(stream.readUInt8(alpha));
 		if (version > 3) {
 			uint8_t emissive;
-			wrap(stream->readUInt8(emissive));
+			wrap(stream.readUInt8(emissive));
 			palette.setColor(i, core::RGBA(red, green, blue, alpha));
 			if (emissive) {
 				palette.setEmit(i, 1.0f);
@@ -499,6 +485,66 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 		}
 	}
 	palette.setSize(materialAmount);
+	header.version = version;
+	header.size = size;
+	header.pivot = normalizedPivot;
+	header.materialAmount = materialAmount;
+	return true;
+}
+
+bool VXMFormat::probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+					  const LoadContext &ctx) {
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
+	if (!stream) {
+		Log::error("Could not load file %s", filename.c_str());
+		return false;
+	}
+	Header header;
+	palette::Palette palette;
+	wrapBool(loadHeader(*stream, header, palette))
+	info.setPalette(palette);
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(header.size) - 1);
+
+	uint8_t maxModels = 1;
+	if (header.version >= 12) {
+		wrap(stream->readUInt8(maxModels));
+	}
+	for (uint8_t model = 0; model < maxModels; ++model) {
+		char modelName[1024];
+		if (header.version >= 12) {
+			wrapBool(stream->readString(sizeof(modelName), modelName, true))
+			stream->readBool(); // visible
+		} else {
+			core::string::formatBuf(modelName, sizeof(modelName), "Model %i", model);
+		}
+		info.addNode(modelName, scenegraph::SceneGraphNodeType::Model, -1, region);
+		// skip the pairs of length and material index
+		for (;;) {
+			uint8_t length;
+			wrap(stream->readUInt8(length));
+			if (length == 0u) {
+				break;
+			}
+			wrapBool(stream->skip(1) != -1)
+		}
+	}
+	return true;
+}
+
+bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::ArchivePtr &archive,
+								  scenegraph::SceneGraph &sceneGraph, palette::Palette &palette, const LoadContext &ctx) {
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
+	if (!stream) {
+		Log::error("Could not load file %s", filename.c_str());
+		return false;
+	}
+	Header header;
+	wrapBool(loadHeader(*stream, header, palette))
+	const int version = header.version;
+	const glm::uvec3 &size = header.size;
+	const glm::vec3 &normalizedPivot = header.pivot;
+	const uint8_t materialAmount = header.materialAmount;
+	scenegraph::SceneGraphTransform transform;
 
 	const voxel::Region region(glm::ivec3(0), glm::ivec3(size) - 1);
 
@@ -507,26 +553,45 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 		wrap(stream->readUInt8(maxModels));
 	}
 
-	for (uint8_t model = 0; model < maxModels; ++model) {
-		int idx = 0;
+	struct Model {
+		core::String name;
 		bool visible = true;
+		// the run length encoded voxels - pairs of length and material index
+		core::DynamicArray<uint8_t> runs;
+		voxel::RawVolume *volume = nullptr;
+	};
+	core::DynamicArray<Model> models(maxModels);
+	for (uint8_t model = 0; model < maxModels; ++model) {
+		Model &m = models[model];
 		char modelName[1024];
 		if (version >= 12) {
 			wrapBool(stream->readString(sizeof(modelName), modelName, true))
-			visible = stream->readBool();
+			m.visible = stream->readBool();
 		} else {
 			core::string::formatBuf(modelName, sizeof(modelName), "Model %i", model);
 		}
-		voxel::RawVolume *volume = new voxel::RawVolume(region);
+		m.name = modelName;
 		for (;;) {
 			uint8_t length;
-			wrapDelete(stream->readUInt8(length), volume);
+			wrap(stream->readUInt8(length));
 			if (length == 0u) {
 				break;
 			}
-
 			uint8_t matIdx;
-			wrapDelete(stream->readUInt8(matIdx), volume);
+			wrap(stream->readUInt8(matIdx));
+			m.runs.push_back(length);
+			m.runs.push_back(matIdx);
+		}
+	}
+
+	// the runs of the models are independent of each other - expand them in parallel
+	decodeParallel(models.size(), [&](size_t n) {
+		Model &m = models[n];
+		m.volume = new voxel::RawVolume(region);
+		int idx = 0;
+		for (size_t r = 0; r < m.runs.size(); r += 2) {
+			const uint8_t length = m.runs[r];
+			const uint8_t matIdx = m.runs[r + 1];
 			if (matIdx == EMPTY_PALETTE) {
 				idx += length;
 				continue;
@@ -544,14 +609,19 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 				const int x = i / (int)(size.y * size.z);
 				const int y = (i / (int)size.z) % (int)size.y;
 				const int z = i % (int)size.z;
-				volume->setVoxel(size.x - x - 1, y, z, voxel);
+				m.volume->setVoxel(size.x - x - 1, y, z, voxel);
 			}
 			idx += length;
 		}
+		m.runs.release();
+		return true;
+	});
+
+	for (Model &m : models) {
 		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
-		node.setVolume(volume, true);
-		node.setName(modelName);
-		node.setVisible(visible);
+		node.setVolume(m.volume, true);
+		node.setName(m.name);
+		node.setVisible(m.visible);
 		node.setPivot(normalizedPivot);
 		node.setPalette(palette);
 		node.setProperty("vxmversion", core::string::toString(version));
@@ -606,6 +676,5 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 
 #undef wrap
 #undef wrapBool
-#undef wrapDelete
 
 } // namespace voxelformat
@@ -18,6 +18,16 @@ namespace voxelformat {
  */
 class VXMFormat : public PaletteFormat {
 private:
+	struct Header {
+		int version = 0;
+		glm::uvec3 size{0};
+		glm::vec3 pivot{0.5f, 0.0f, 0.5f};
+		uint8_t materialAmount = 0;
+	};
+	/**
+	 * @brief Reads everything up to the models - the palette is filled with the materials
+	 */
+	bool loadHeader(io::SeekableReadStream &stream, Header &header, palette::Palette &palette);
 	bool writeRLE(io::WriteStream &stream, int rleCount, const voxel::Voxel &voxel, const palette::Palette &nodePalette,
 				  const palette::Palette &palette) const;
 	bool loadGroupsPalette(const core::String &filename, const io::ArchivePtr &archive,
@@ -27,6 +37,8 @@ private:
 					const io::ArchivePtr &archive, const SaveContext &ctx) override;
 
 public:
+	bool probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+			   const LoadContext &ctx) override;
 	image::ImagePtr loadScreenshot(const core::String &filename, const io::ArchivePtr &archive,
 								   const LoadContext &ctx) override;
 
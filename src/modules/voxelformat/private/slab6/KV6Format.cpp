@@ -8,15 +8,18 @@
 #include "core/FourCC.h"
 #include "core/Log.h"
 #include "core/RGBA.h"
+#include "core/ArrayLength.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "core/collection/DynamicArray.h"
 #include "io/Archive.h"
+#include "io/BufferedReadStream.h"
 #include "io/Stream.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "palette/Palette.h"
 #include "voxel/RawVolume.h"
+#include "voxel/RawVolumeColumnWriter.h"
 #include "voxel/Voxel.h"
 #include "voxelformat/Format.h"
 #include "voxelutil/VolumeSplitter.h"
@@ -379,11 +382,13 @@ bool KV6Format::loadKFA(const core::String &filename, const io::ArchivePtr &arch
 
 bool KV6Format::loadGroupsPalette(const core::String &filename, const io::ArchivePtr &archive,
 								  scenegraph::SceneGraph &sceneGraph, palette::Palette &palette, const LoadContext &ctx) {
-	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
-	if (!stream) {
+	core::ScopedPtr<io::SeekableReadStream> fileStream(archive->readStream(filename));
+	if (!fileStream) {
 		Log::error("Could not load file %s", filename.c_str());
 		return false;
 	}
+	io::BufferedReadStream bufferedStream(*fileStream);
+	io::BufferedReadStream *stream = &bufferedStream;
 	uint32_t magic;
 	wrap(stream->readUInt32(magic))
 	if (magic != FourCC('K', 'v', 'x', 'l')) {
@@ -454,13 +459,13 @@ bool KV6Format::loadGroupsPalette(const core::String &filename, const io::Archiv
 
 	core::ScopedPtr<priv::State> state(new priv::State());
 	for (uint32_t c = 0u; c < numvoxs; ++c) {
-		core::RGBA color;
-		wrapBool(priv::readBGRColor(*stream, color));
-		wrap2(stream->skip(1)) // slab6 always 128
-		wrap(stream->readUInt8(state->voxdata[c].z))
-		wrap2(stream->skip(1)) // slab6 always 0
-		wrap(stream->readUInt8((uint8_t &)state->voxdata[c].vis))
-		wrap(stream->readUInt8(state->voxdata[c].dir))
+		// b, g, r, 128 (slab6), z, 0 (slab6), vis, dir
+		uint8_t voxel[8];
+		wrap(stream->readArray(voxel, lengthof(voxel)))
+		const core::RGBA color(voxel[2], voxel[1], voxel[0]);
+		state->voxdata[c].z = voxel[4];
+		state->voxdata[c].vis = (priv::SLABVisibility)voxel[6];
+		state->voxdata[c].dir = voxel[7];
 
 		if (slab5) {
 			palette.tryAdd(color, false, &state->voxdata[c].col, false);
@@ -471,27 +476,22 @@ bool KV6Format::loadGroupsPalette(const core::String &filename, const io::Archiv
 				   (uint8_t)state->voxdata[c].vis, state->voxdata[c].dir, state->voxdata[c].col);
 	}
 
+	wrap(stream->readArray(state->xoffsets, width))
 	for (uint32_t x = 0u; x < width; ++x) {
-		wrap(stream->readInt32(state->xoffsets[x]))
-		Log::debug("xoffsets[%u]: %i", x, state->xoffsets[x]);
-	}
-
-	for (uint32_t x = 0u; x < width; ++x) {
-		for (uint32_t y = 0u; y < depth; ++y) {
-			wrap(stream->readUInt16(state->xyoffsets[x][y]))
-			Log::debug("xyoffsets[%u][%u]: %u", x, y, state->xyoffsets[x][y]);
-		}
+		wrap(stream->readArray(state->xyoffsets[x], depth))
 	}
 
 	voxel::RawVolume *volume = new voxel::RawVolume(region);
-
-	int idx = 0;
-	for (uint32_t x = 0; x < width; ++x) {
-		for (uint32_t y = 0; y < depth; ++y) {
-			for (int end = idx + state->xyoffsets[x][y]; idx < end; ++idx) {
-				const priv::VoxtypeKV6 &vox = state->voxdata[idx];
-				const voxel::Voxel col = voxel::createVoxel(palette, vox.col);
-				volume->setVoxel((int)x, (int)((height - 1) - vox.z), (int)y, col);
+	{
+		voxel::RawVolumeColumnWriter writer(*volume);
+		int idx = 0;
+		for (uint32_t x = 0; x < width; ++x) {
+			for (uint32_t y = 0; y < depth; ++y) {
+				for (int end = idx + state->xyoffsets[x][y]; idx < end; ++idx) {
+					const priv::VoxtypeKV6 &vox = state->voxdata[idx];
+					const voxel::Voxel col = voxel::createVoxel(palette, vox.col);
+					writer.setVoxel((int)x, (int)((height - 1) - vox.z), (int)y, col);
+				}
 			}
 		}
 	}
@@ -8,11 +8,13 @@
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "core/collection/Vector.h"
+#include "io/BufferedReadStream.h"
 #include "io/Stream.h"
 #include "scenegraph/SceneGraph.h"
 #include "voxel/MaterialColor.h"
 #include "palette/Palette.h"
 #include "voxel/RawVolume.h"
+#include "voxel/RawVolumeColumnWriter.h"
 #include <glm/common.hpp>
 
 namespace voxelformat {
@@ -67,11 +69,13 @@ struct VoxtypeKVX {
 
 bool KVXFormat::loadGroupsPalette(const core::String &filename, const io::ArchivePtr &archive,
 								  scenegraph::SceneGraph &sceneGraph, palette::Palette &palette, const LoadContext &ctx) {
-	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
-	if (!stream) {
+	core::ScopedPtr<io::SeekableReadStream> fileStream(archive->readStream(filename));
+	if (!fileStream) {
 		Log::error("Could not load file %s", filename.c_str());
 		return false;
 	}
+	io::BufferedReadStream bufferedStream(*fileStream);
+	io::BufferedReadStream *stream = &bufferedStream;
 	// Total # of bytes (not including numbytes) in each mip-map level
 	// but there is only 1 mip-map level (or 5 in unstripped kvx files)
 	uint32_t numbytes;
@@ -126,14 +130,9 @@ bool KVXFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 	 */
 	uint16_t xyoffsets[256][257];
 	uint32_t xoffsets[257];
-	for (uint32_t x = 0u; x <= xsiz_w; ++x) {
-		wrap(stream->readUInt32(xoffsets[x]))
-	}
-
+	wrap(stream->readArray(xoffsets, xsiz_w + 1))
 	for (uint32_t x = 0u; x < xsiz_w; ++x) {
-		for (uint32_t y = 0u; y <= ysiz_d; ++y) {
-			wrap(stream->readUInt16(xyoffsets[x][y]))
-		}
+		wrap(stream->readArray(xyoffsets[x], ysiz_d + 1))
 	}
 
 	const uint32_t offset = (xsiz_w + 1) * 4 + xsiz_w * (ysiz_d + 1) * 2;
@@ -175,6 +174,7 @@ bool KVXFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 	node.setPivot(normalizedPivot);
 	sceneGraph.emplace(core::move(node));
 
+	voxel::RawVolumeColumnWriter writer(*volume);
 	for (uint32_t x = 0; x < xsiz_w; ++x) {
 		for (uint32_t y = 0; y < ysiz_d; ++y) {
 			const uint16_t end = xyoffsets[x][y + 1];
@@ -186,14 +186,12 @@ bool KVXFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 				wrap(stream->readUInt8(header.ztop))
 				wrap(stream->readUInt8(header.zlength))
 				wrap(stream->readUInt8((uint8_t &)header.vis))
+				uint8_t cols[256];
+				wrap(stream->readArray(cols, header.zlength))
 				for (uint8_t i = 0u; i < header.zlength; ++i) {
-					uint8_t col;
-					wrap(stream->readUInt8(col))
-					voxel::Voxel voxel = voxel::createVoxel(palette, col);
-					const int nx = (int)x;
+					const voxel::Voxel voxel = voxel::createVoxel(palette, cols[i]);
 					const int ny = region.getUpperY() - (int)header.ztop - (int)i;
-					const int nz = (int)y;
-					volume->setVoxel(nx, ny, nz, voxel);
+					writer.setVoxel((int)x, ny, (int)y, voxel);
 				}
 				n -= (int32_t)(header.zlength + 3 /* 3 byte slab header */);
 			}
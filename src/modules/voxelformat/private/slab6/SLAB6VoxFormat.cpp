@@ -6,8 +6,10 @@
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
+#include "core/collection/DynamicArray.h"
 #include "scenegraph/SceneGraph.h"
 #include "palette/Palette.h"
+#include "voxel/RawVolumeColumnWriter.h"
 #include "SLABShared.h"
 
 #define wrap(read)                                                                                                     \
@@ -90,17 +92,25 @@ bool SLAB6VoxFormat::loadGroupsPalette(const core::String &filename, const io::A
 
 	stream->seek(voxelPos);
 	const uint8_t emptyColorIndex = (uint8_t)emptyPaletteIndex();
+	core::DynamicArray<uint8_t> column;
+	column.resize(height);
+	voxel::RawVolumeColumnWriter writer(*volume);
 	for (uint32_t w = 0u; w < width; ++w) {
 		for (uint32_t d = 0u; d < depth; ++d) {
-			for (uint32_t h = 0u; h < height; ++h) {
-				uint8_t palIdx;
-				wrap(stream->readUInt8(palIdx))
-				if (palIdx == emptyColorIndex) {
-					continue;
+			wrap(stream->readArray(column.data(), height))
+			// write the runs of the same color at once
+			for (uint32_t h = 0u; h < height;) {
+				const uint8_t palIdx = column[h];
+				uint32_t end = h + 1;
+				while (end < height && column[end] == palIdx) {
+					++end;
 				}
-				const voxel::Voxel &voxel = voxel::createVoxel(palette, palIdx);
-				// we have to flip depth with height for our own coordinate system
-				volume->setVoxel(w, (int)height - (int)h - 1, (int)d, voxel);
+				if (palIdx != emptyColorIndex) {
+					const voxel::Voxel voxel = voxel::createVoxel(palette, palIdx);
+					// we have to flip depth with height for our own coordinate system
+					writer.fill((int)w, (int)d, (int)height - (int)end, (int)height - (int)h - 1, voxel);
+				}
+				h = end;
 			}
 		}
 	}
@@ -10,8 +10,8 @@
 #include "core/StringUtil.h"
 #include "palette/Palette.h"
 #include "scenegraph/SceneGraph.h"
+#include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
-#include "voxelutil/VolumeVisitor.h"
 
 namespace voxelformat {
 
@@ -232,8 +232,7 @@ bool SMTPLFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const cor
 	palette::Palette starMadePal;
 	loadPalette(starMadePal);
 
-	const int32_t numBlocks = voxelutil::visitVolume(
-		*node->volume(), [](int, int, int, const voxel::Voxel &) {}, voxelutil::SkipEmpty());
+	const int32_t numBlocks = (int32_t)node->volume()->solidVoxelCount();
 	wrapBool(stream->writeUInt32BE(numBlocks))
 	Log::debug("Number of blocks: %i", numBlocks);
 
@@ -4,21 +4,28 @@
 
 #include "VENGIFormat.h"
 #include "core/ArrayLength.h"
+#include "core/Common.h"
 #include "core/FourCC.h"
-#include "core/ConfigVar.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
-#include "core/Var.h"
+#include "core/Trace.h"
 #include "core/collection/Array.h"
+#include "core/collection/Buffer.h"
+#include "core/collection/DynamicArray.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/MemoryReadStream.h"
 #include "io/ZipReadStream.h"
 #include "io/ZipWriteStream.h"
 #include "palette/NormalPalette.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "palette/Palette.h"
+#include "voxel/LazyVolume.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
+#include "voxelformat/FormatProbe.h"
 #include "voxelutil/VolumeVisitor.h"
+#include "voxelutil/VoxelUtil.h"
 
 #include <glm/gtc/type_ptr.hpp>
 
@@ -36,6 +43,61 @@
 
 namespace voxelformat {
 
+/** the versions up to this one are stored as one zlib stream */
+static constexpr uint32_t MaxStreamVersion = 4u;
+/** the version of the indexed layout with the independently compressed bricks */
+static constexpr uint32_t IndexedVersion = 5u;
+/** the bricks of the indexed layout are run length encoded */
+static constexpr uint32_t RLEVersion = 6u;
+/** the highest bit of the run length marks a run of air voxels */
+static constexpr uint16_t RLEAirRun = 0x8000u;
+static constexpr uint32_t RLEMaxRunLength = 0x8000u;
+
+class VENGIFormat::LazyBrickVolume : public voxel::LazyVolume {
+private:
+	struct CompressedBrick {
+		voxel::Region region;
+		core::Buffer<uint8_t> blob;
+	};
+	palette::Palette _palette;
+	uint32_t _version;
+	core::DynamicArray<CompressedBrick> _bricks;
+
+public:
+	LazyBrickVolume(const voxel::Region &region, const palette::Palette &palette, uint32_t version)
+		: voxel::LazyVolume(region), _palette(palette), _version(version) {
+	}
+
+	void addBrick(const voxel::Region &region, core::Buffer<uint8_t> &&blob) {
+		_bricks.push_back({region, core::move(blob)});
+	}
+
+	voxel::RawVolume *load() const override {
+		core_trace_scoped(LoadVENGIBricks);
+		voxel::RawVolume *volume = new voxel::RawVolume(_region);
+		voxel::Voxel *data = volume->writableRow(_region.getLowerCorner());
+		for (const CompressedBrick &brick : _bricks) {
+			io::MemoryReadStream blobStream(brick.blob.data(), brick.blob.size());
+			io::ZipReadStream zipStream(blobStream, (int)blobStream.size());
+			if (!loadBrick(data, _region, _palette, brick.region, _version, zipStream)) {
+				Log::error("Failed to load brick %i:%i:%i", brick.region.getLowerX(), brick.region.getLowerY(),
+						   brick.region.getLowerZ());
+				delete volume;
+				return nullptr;
+			}
+		}
+		return volume;
+	}
+
+	size_t size() const override {
+		size_t bytes = 0u;
+		for (const CompressedBrick &brick : _bricks) {
+			bytes += brick.blob.size();
+		}
+		return bytes;
+	}
+};
+
 static scenegraph::SceneGraphNodeType toNodeType(const core::String &type) {
 	for (int i = 0; i < lengthof(scenegraph::SceneGraphNodeTypeStr); ++i) {
 		if (type == scenegraph::SceneGraphNodeTypeStr[i]) {
@@ -80,39 +142,88 @@ bool VENGIFormat::saveAnimation(const scenegraph::SceneGraphNode &node, const co
 	return true;
 }
 
-bool VENGIFormat::saveNodeData(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
-							   io::WriteStream &stream) {
+bool VENGIFormat::saveNodeRegion(const scenegraph::SceneGraphNode &node, io::WriteStream &stream) {
 	if (node.type() != scenegraph::SceneGraphNodeType::Model) {
 		return true;
 	}
-	wrapBool(stream.writeUInt32(FourCC('D', 'A', 'T', 'A')))
-	const voxel::RawVolume *v = node.volume();
-	const voxel::Region &region = v->region();
+	wrapBool(stream.writeUInt32(FourCC('R', 'E', 'G', 'N')))
+	const voxel::Region &region = node.volume()->region();
 	wrapBool(stream.writeInt32(region.getLowerX()))
 	wrapBool(stream.writeInt32(region.getLowerY()))
 	wrapBool(stream.writeInt32(region.getLowerZ()))
 	wrapBool(stream.writeInt32(region.getUpperX()))
 	wrapBool(stream.writeInt32(region.getUpperY()))
 	wrapBool(stream.writeInt32(region.getUpperZ()))
-	const int replaceIndex = core::Var::getSafe(cfg::VoxformatEmptyPaletteIndex)->intVal();
-	int replacement = -1;
-	if (replaceIndex != -1) {
-		replacement = node.palette().findReplacement(replaceIndex);
-		Log::debug("Looking for a similar color in the palette: %d", replacement);
-	}
-	auto visitor = [&stream, replacement, replaceIndex](int, int, int, const voxel::Voxel &voxel) {
-		const bool air = isAir(voxel.getMaterial());
-		stream.writeBool(air);
-		if (!air) {
-			if (voxel.getColor() == replaceIndex) {
-				stream.writeUInt8(replacement);
-			} else {
-				stream.writeUInt8(voxel.getColor());
-			}
-			stream.writeUInt8(voxel.getNormal());
+	return true;
+}
+
+bool VENGIFormat::saveBrick(const scenegraph::SceneGraphNode &node, const voxel::Region &region, int replacement,
+							io::WriteStream &stream) {
+	const voxel::RawVolume *v = node.volume();
+	const int replaceIndex = _config.emptyPaletteIndex;
+	const int width = region.getWidthInVoxels();
+	// the runs are collected in memory and handed over to the compression in one call
+	io::BufferedReadWriteStream runs(region.voxels() / 8);
+	uint32_t runLength = 0u;
+	bool runAir = false;
+	uint8_t runColor = 0u;
+	uint8_t runNormal = 0u;
+	auto writeRun = [&]() {
+		if (runAir) {
+			return runs.writeUInt16(RLEAirRun | (uint16_t)(runLength - 1u));
 		}
+		return runs.writeUInt16((uint16_t)(runLength - 1u)) && runs.writeUInt8(runColor) &&
+			   runs.writeUInt8(runNormal);
 	};
-	voxelutil::visitVolume(*v, visitor, voxelutil::VisitAll(), voxelutil::VisitorOrder::XYZ);
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			const voxel::Voxel *row = v->row(glm::ivec3(region.getLowerX(), y, z));
+			for (int x = 0; x < width; ++x) {
+				const voxel::Voxel &voxel = row[x];
+				const bool air = isAir(voxel.getMaterial());
+				uint8_t color = 0u;
+				uint8_t normal = 0u;
+				if (!air) {
+					color = voxel.getColor() == replaceIndex ? (uint8_t)replacement : voxel.getColor();
+					normal = voxel.getNormal();
+				}
+				if (runLength > 0u) {
+					if (air == runAir && color == runColor && normal == runNormal && runLength < RLEMaxRunLength) {
+						++runLength;
+						continue;
+					}
+					wrapBool(writeRun())
+				}
+				runLength = 1u;
+				runAir = air;
+				runColor = color;
+				runNormal = normal;
+			}
+		}
+	}
+	if (runLength > 0u) {
+		wrapBool(writeRun())
+	}
+	wrap(stream.write(runs.getBuffer(), (size_t)runs.size()))
+	return true;
+}
+
+bool VENGIFormat::saveIndex(const Index &index, io::WriteStream &stream) {
+	wrapBool(stream.writeUInt32(FourCC('I', 'N', 'D', 'X')))
+	wrapBool(stream.writeUInt64(index.sceneOffset))
+	wrapBool(stream.writeUInt32(index.sceneSize))
+	wrapBool(stream.writeUInt32((uint32_t)index.bricks.size()))
+	for (const Brick &brick : index.bricks) {
+		wrapBool(stream.writeInt32(brick.fileNodeId))
+		wrapBool(stream.writeInt32(brick.region.getLowerX()))
+		wrapBool(stream.writeInt32(brick.region.getLowerY()))
+		wrapBool(stream.writeInt32(brick.region.getLowerZ()))
+		wrapBool(stream.writeInt32(brick.region.getUpperX()))
+		wrapBool(stream.writeInt32(brick.region.getUpperY()))
+		wrapBool(stream.writeInt32(brick.region.getUpperZ()))
+		wrapBool(stream.writeUInt64(brick.offset))
+		wrapBool(stream.writeUInt32(brick.compressedSize))
+	}
 	return true;
 }
 
@@ -202,7 +313,7 @@ bool VENGIFormat::saveNode(const scenegraph::SceneGraph &sceneGraph, io::WriteSt
 		wrapBool(saveNodePaletteColors(sceneGraph, node, stream))
 	}
 	wrapBool(saveNodePaletteNormals(sceneGraph, node, stream))
-	wrapBool(saveNodeData(sceneGraph, node, stream))
+	wrapBool(saveNodeRegion(node, stream))
 	for (const core::String &animation : sceneGraph.animations()) {
 		wrapBool(saveAnimation(node, animation, stream))
 	}
@@ -259,6 +370,99 @@ bool VENGIFormat::loadNodeData(scenegraph::SceneGraph &sceneGraph, scenegraph::S
 	return true;
 }
 
+bool VENGIFormat::loadNodeRegion(io::ReadStream &stream, voxel::Region &region) {
+	glm::ivec3 mins, maxs;
+	wrap(stream.readInt32(mins.x))
+	wrap(stream.readInt32(mins.y))
+	wrap(stream.readInt32(mins.z))
+	wrap(stream.readInt32(maxs.x))
+	wrap(stream.readInt32(maxs.y))
+	wrap(stream.readInt32(maxs.z))
+	region = voxel::Region(mins, maxs);
+	if (!region.isValid()) {
+		Log::error("Invalid region %i:%i:%i %i:%i:%i", mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z);
+		return false;
+	}
+	return true;
+}
+
+bool VENGIFormat::loadBrick(voxel::Voxel *data, const voxel::Region &volumeRegion, const palette::Palette &palette,
+							const voxel::Region &region, uint32_t version, io::ReadStream &stream) {
+	const glm::ivec3 &volumeMins = volumeRegion.getLowerCorner();
+	const int volumeWidth = volumeRegion.getWidthInVoxels();
+	const int stride = volumeRegion.stride();
+	auto rowData = [&](int y, int z) {
+		return data + (region.getLowerX() - volumeMins.x) + (y - volumeMins.y) * volumeWidth +
+			   (z - volumeMins.z) * stride;
+	};
+	if (version < RLEVersion) {
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				voxel::Voxel *row = rowData(y, z);
+				for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+					uint8_t air;
+					wrap(stream.readUInt8(air))
+					if (air) {
+						continue;
+					}
+					uint8_t color;
+					wrap(stream.readUInt8(color))
+					uint8_t normal;
+					wrap(stream.readUInt8(normal))
+					row[x] = voxel::createVoxel(palette, color, normal);
+				}
+			}
+		}
+		return true;
+	}
+
+	// the runs may span several rows - the volume is fresh, so the air runs are skipped
+	const int width = region.getWidthInVoxels();
+	int x = 0;
+	int y = region.getLowerY();
+	int z = region.getLowerZ();
+	int64_t remaining = region.voxels();
+	while (remaining > 0) {
+		uint16_t header;
+		wrap(stream.readUInt16(header))
+		int runLength = (int)(header & ~RLEAirRun) + 1;
+		if (runLength > remaining) {
+			Log::error("Invalid run length %i in brick %i:%i:%i", runLength, region.getLowerX(), region.getLowerY(),
+					   region.getLowerZ());
+			return false;
+		}
+		remaining -= runLength;
+		const bool air = (header & RLEAirRun) != 0u;
+		voxel::Voxel voxel;
+		if (!air) {
+			uint8_t color;
+			wrap(stream.readUInt8(color))
+			uint8_t normal;
+			wrap(stream.readUInt8(normal))
+			voxel = voxel::createVoxel(palette, color, normal);
+		}
+		while (runLength > 0) {
+			const int n = core_min(runLength, width - x);
+			if (!air) {
+				voxel::Voxel *row = rowData(y, z);
+				for (int i = x; i < x + n; ++i) {
+					row[i] = voxel;
+				}
+			}
+			runLength -= n;
+			x += n;
+			if (x == width) {
+				x = 0;
+				if (++y > region.getUpperY()) {
+					y = region.getLowerY();
+					++z;
+				}
+			}
+		}
+	}
+	return true;
+}
+
 bool VENGIFormat::loadNodePaletteNormals(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node,
 										uint32_t version, io::ReadStream &stream) {
 	palette::NormalPalette normalPalette;
@@ -453,6 +657,18 @@ bool VENGIFormat::loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint3
 			if (!loadNodeData(sceneGraph, node, version, stream)) {
 				return false;
 			}
+		} else if (chunkMagic == FourCC('R', 'E', 'G', 'N')) {
+			// the voxels are loaded from the bricks of the index table
+			voxel::Region region;
+			if (!loadNodeRegion(stream, region)) {
+				return false;
+			}
+			if (_config.vengiLazyLoad) {
+				// the bricks are handed over once the index table was processed
+				node.setLazyVolume(new LazyBrickVolume(region, node.palette(), version));
+			} else {
+				node.setVolume(new voxel::RawVolume(region), true);
+			}
 		} else if (chunkMagic == FourCC('P', 'A', 'L', 'C')) {
 			if (!loadNodePaletteColors(sceneGraph, node, version, stream)) {
 				return false;
@@ -482,6 +698,320 @@ bool VENGIFormat::loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint3
 	return false;
 }
 
+bool VENGIFormat::skipNodeData(uint32_t version, io::ReadStream &stream, voxel::Region &region) {
+	glm::ivec3 mins, maxs;
+	wrap(stream.readInt32(mins.x))
+	wrap(stream.readInt32(mins.y))
+	wrap(stream.readInt32(mins.z))
+	wrap(stream.readInt32(maxs.x))
+	wrap(stream.readInt32(maxs.y))
+	wrap(stream.readInt32(maxs.z))
+	region = voxel::Region(mins, maxs);
+	if (!region.isValid()) {
+		Log::error("Invalid region %i:%i:%i %i:%i:%i", mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z);
+		return false;
+	}
+	// see loadNodeData() - every voxel is at least the air flag - so we never read beyond the chunk
+	const int colorBytes = version >= 4u ? 2 : 1;
+	size_t voxels = (size_t)region.getWidthInVoxels() * region.getHeightInVoxels() * region.getDepthInVoxels();
+	int pending = 0;
+	uint8_t buf[4096];
+	while (voxels > 0u || pending > 0) {
+		const int n = (int)core_min(sizeof(buf), voxels + (size_t)pending);
+		wrapBool(stream.read(buf, n) == n)
+		for (int i = 0; i < n; ++i) {
+			if (pending > 0) {
+				--pending;
+				continue;
+			}
+			--voxels;
+			if (buf[i] == 0u) {
+				pending = colorBytes;
+			}
+		}
+	}
+	return true;
+}
+
+bool VENGIFormat::probeNode(scenegraph::SceneGraph &sceneGraph, ProbeInfo &info, int parent, uint32_t version,
+							io::ReadStream &stream) {
+	core::String name;
+	wrapBool(stream.readPascalStringUInt16LE(name))
+	core::String type;
+	wrapBool(stream.readPascalStringUInt16LE(type))
+	const scenegraph::SceneGraphNodeType nodeType = toNodeType(type);
+	if (nodeType == scenegraph::SceneGraphNodeType::Max) {
+		Log::error("Could not load node type %s", type.c_str());
+		return false;
+	}
+	const bool root = nodeType == scenegraph::SceneGraphNodeType::Root;
+	const int idx = root ? parent : info.addNode(name, nodeType, parent);
+	scenegraph::SceneGraphNode node(nodeType);
+
+	if (version >= 2) {
+		int fileNodeId;
+		wrap(stream.readInt32(fileNodeId))
+		int referenceNodeId;
+		wrap(stream.readInt32(referenceNodeId))
+	}
+	stream.readBool(); // visible
+	stream.readBool(); // locked
+	uint32_t color;
+	wrap(stream.readUInt32(color))
+	if (version >= 3) {
+		glm::vec3 pivot;
+		wrap(stream.readFloat(pivot.x))
+		wrap(stream.readFloat(pivot.y))
+		wrap(stream.readFloat(pivot.z))
+	}
+
+	while (!stream.eos()) {
+		uint32_t chunkMagic;
+		wrap(stream.readUInt32(chunkMagic))
+		if (chunkMagic == FourCC('P', 'R', 'O', 'P')) {
+			wrapBool(loadNodeProperties(sceneGraph, node, version, stream))
+		} else if (chunkMagic == FourCC('D', 'A', 'T', 'A')) {
+			voxel::Region region;
+			wrapBool(skipNodeData(version, stream, region))
+			if (!root) {
+				info.nodes[idx].region = region;
+			}
+		} else if (chunkMagic == FourCC('R', 'E', 'G', 'N')) {
+			voxel::Region region;
+			wrapBool(loadNodeRegion(stream, region))
+			if (!root) {
+				info.nodes[idx].region = region;
+			}
+		} else if (chunkMagic == FourCC('P', 'A', 'L', 'C') || chunkMagic == FourCC('P', 'A', 'L', 'I')) {
+			if (chunkMagic == FourCC('P', 'A', 'L', 'C')) {
+				wrapBool(loadNodePaletteColors(sceneGraph, node, version, stream))
+			} else {
+				wrapBool(loadNodePaletteIdentifier(sceneGraph, node, version, stream))
+			}
+			if (nodeType == scenegraph::SceneGraphNodeType::Model && info.paletteHash == 0u) {
+				info.setPalette(node.palette());
+			}
+		} else if (chunkMagic == FourCC('P', 'A', 'L', 'N')) {
+			wrapBool(loadNodePaletteNormals(sceneGraph, node, version, stream))
+		} else if (chunkMagic == FourCC('A', 'N', 'I', 'M')) {
+			wrapBool(loadAnimation(sceneGraph, node, version, stream))
+		} else if (chunkMagic == FourCC('N', 'O', 'D', 'E')) {
+			wrapBool(probeNode(sceneGraph, info, idx, version, stream))
+		} else if (chunkMagic == FourCC('E', 'N', 'D', 'N')) {
+			return true;
+		}
+	}
+	Log::error("ENDN magic is missing");
+	return false;
+}
+
+bool VENGIFormat::loadIndex(io::SeekableReadStream &stream, uint32_t &version, Index &index) {
+	wrap(stream.readUInt32(version))
+	if (version < IndexedVersion || version > RLEVersion) {
+		Log::error("Unsupported version %u", version);
+		return false;
+	}
+	uint64_t indexOffset;
+	wrap(stream.readUInt64(indexOffset))
+	const int64_t size = stream.size();
+	if (indexOffset >= (uint64_t)size) {
+		Log::error("Invalid index offset %u", (uint32_t)indexOffset);
+		return false;
+	}
+	wrap(stream.seek((int64_t)indexOffset))
+	uint32_t magic;
+	wrap(stream.readUInt32(magic))
+	if (magic != FourCC('I', 'N', 'D', 'X')) {
+		Log::error("Invalid index magic");
+		return false;
+	}
+	wrap(stream.readUInt64(index.sceneOffset))
+	wrap(stream.readUInt32(index.sceneSize))
+	if (index.sceneOffset + index.sceneSize > (uint64_t)size) {
+		Log::error("Invalid scene graph blob");
+		return false;
+	}
+	uint32_t brickCount;
+	wrap(stream.readUInt32(brickCount))
+	// fileNodeId, region, offset and size
+	const int64_t brickEntrySize = 7 * sizeof(int32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+	if ((int64_t)brickCount * brickEntrySize > stream.remaining()) {
+		Log::error("Invalid brick count %u", brickCount);
+		return false;
+	}
+	index.bricks.reserve(brickCount);
+	for (uint32_t i = 0; i < brickCount; ++i) {
+		Brick brick;
+		wrap(stream.readInt32(brick.fileNodeId))
+		wrapBool(loadNodeRegion(stream, brick.region))
+		wrap(stream.readUInt64(brick.offset))
+		wrap(stream.readUInt32(brick.compressedSize))
+		if (brick.offset + brick.compressedSize > (uint64_t)size) {
+			Log::error("Invalid brick %u", i);
+			return false;
+		}
+		index.bricks.push_back(brick);
+	}
+	return true;
+}
+
+bool VENGIFormat::updateReferences(scenegraph::SceneGraph &sceneGraph, const NodeMapping &nodeMapping) {
+	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::ModelReference); iter != sceneGraph.end();
+		 ++iter) {
+		scenegraph::SceneGraphNode &node = *iter;
+		int nodeId;
+		if (!nodeMapping.get(node.reference(), nodeId)) {
+			Log::error("Failed to perform node id mapping for references");
+			return false;
+		}
+		Log::debug("Update node reference for node %i to: %i", node.id(), nodeId);
+		node.setReference(nodeId);
+	}
+	return true;
+}
+
+bool VENGIFormat::loadIndexed(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph) {
+	uint32_t version;
+	Index index;
+	wrapBool(loadIndex(stream, version, index))
+	wrap(stream.seek((int64_t)index.sceneOffset))
+	NodeMapping nodeMapping;
+	{
+		io::ZipReadStream zipStream(stream, (int)index.sceneSize);
+		uint32_t chunkMagic;
+		wrap(zipStream.readUInt32(chunkMagic))
+		if (chunkMagic != FourCC('N', 'O', 'D', 'E')) {
+			Log::error("Unknown chunk magic");
+			return false;
+		}
+		wrapBool(loadNode(sceneGraph, sceneGraph.root().id(), version, zipStream, nodeMapping))
+	}
+
+	// the bricks of a volume are decoded in the same task - the volumes don't allow parallel writes
+	core::Map<int, int> nodeTasks;
+	core::DynamicArray<scenegraph::SceneGraphNode *> taskNodes;
+	core::DynamicArray<core::DynamicArray<size_t>> taskBricks;
+	core::DynamicArray<core::Buffer<uint8_t>> blobs;
+	blobs.resize(index.bricks.size());
+	for (size_t i = 0; i < index.bricks.size(); ++i) {
+		const Brick &brick = index.bricks[i];
+		int nodeId;
+		if (!nodeMapping.get(brick.fileNodeId, nodeId)) {
+			Log::error("Could not find the node %i of brick %i", brick.fileNodeId, (int)i);
+			return false;
+		}
+		scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+		if (!node.isModelNode() || !node.region().containsRegion(brick.region)) {
+			Log::error("Brick %i doesn't match the node %i", (int)i, brick.fileNodeId);
+			return false;
+		}
+		wrap(stream.seek((int64_t)brick.offset))
+		blobs[i].resize(brick.compressedSize);
+		wrapBool(stream.read(blobs[i].data(), brick.compressedSize) == (int)brick.compressedSize)
+		int task;
+		if (!nodeTasks.get(nodeId, task)) {
+			task = (int)taskNodes.size();
+			nodeTasks.put(nodeId, task);
+			taskNodes.push_back(&node);
+			taskBricks.emplace_back();
+		}
+		taskBricks[task].push_back(i);
+	}
+	if (_config.vengiLazyLoad) {
+		for (size_t n = 0; n < taskNodes.size(); ++n) {
+			scenegraph::SceneGraphNode &node = *taskNodes[n];
+			LazyBrickVolume *lazyVolume = new LazyBrickVolume(node.region(), node.palette(), version);
+			for (size_t i : taskBricks[n]) {
+				lazyVolume->addBrick(index.bricks[i].region, core::move(blobs[i]));
+			}
+			node.setLazyVolume(lazyVolume);
+		}
+		wrapBool(updateReferences(sceneGraph, nodeMapping))
+		sceneGraph.updateTransforms();
+		return true;
+	}
+	// the bricks don't overlap - so they are decoded in parallel straight into the voxel data of the volumes
+	core::DynamicArray<voxel::Voxel *> taskData;
+	taskData.reserve(taskNodes.size());
+	for (scenegraph::SceneGraphNode *node : taskNodes) {
+		taskData.push_back(node->volume()->writableRow(node->region().getLowerCorner()));
+	}
+	core::DynamicArray<int> brickTasks;
+	brickTasks.resize(index.bricks.size());
+	for (size_t n = 0; n < taskBricks.size(); ++n) {
+		for (size_t i : taskBricks[n]) {
+			brickTasks[i] = (int)n;
+		}
+	}
+	const bool decoded = decodeParallel(index.bricks.size(), [&](size_t i) {
+		const int task = brickTasks[i];
+		const scenegraph::SceneGraphNode &node = *taskNodes[task];
+		io::MemoryReadStream blobStream(blobs[i].data(), blobs[i].size());
+		io::ZipReadStream zipStream(blobStream, (int)blobStream.size());
+		if (!loadBrick(taskData[task], node.region(), node.palette(), index.bricks[i].region, version, zipStream)) {
+			Log::error("Failed to load brick %i", (int)i);
+			return false;
+		}
+		blobs[i].release();
+		return true;
+	});
+	if (!decoded) {
+		return false;
+	}
+	wrapBool(updateReferences(sceneGraph, nodeMapping))
+	sceneGraph.updateTransforms();
+	return true;
+}
+
+bool VENGIFormat::probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+						const LoadContext &ctx) {
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
+	if (!stream) {
+		Log::error("Could not load file %s", filename.c_str());
+		return false;
+	}
+	uint32_t magic;
+	wrap(stream->readUInt32(magic))
+	if (magic != FourCC('V', 'E', 'N', 'G')) {
+		Log::error("Invalid magic");
+		return false;
+	}
+	// only used for the animations of the temporary nodes
+	scenegraph::SceneGraph sceneGraph;
+	uint32_t layout;
+	wrap(stream->readUInt32(layout))
+	if (layout == FourCC('V', 'I', 'D', 'X')) {
+		// only the scene graph blob is read - the bricks are not touched
+		uint32_t version;
+		Index index;
+		wrapBool(loadIndex(*stream, version, index))
+		wrap(stream->seek((int64_t)index.sceneOffset))
+		io::ZipReadStream zipStream(*stream, (int)index.sceneSize);
+		uint32_t chunkMagic;
+		wrap(zipStream.readUInt32(chunkMagic))
+		if (chunkMagic != FourCC('N', 'O', 'D', 'E')) {
+			Log::error("Unknown chunk magic");
+			return false;
+		}
+		return probeNode(sceneGraph, info, -1, version, zipStream);
+	}
+	wrap(stream->seek(-4, SEEK_CUR))
+	io::ZipReadStream zipStream(*stream, stream->size());
+	uint32_t version;
+	wrap(zipStream.readUInt32(version))
+	if (version > MaxStreamVersion) {
+		Log::error("Unsupported version %u", version);
+		return false;
+	}
+	uint32_t chunkMagic;
+	wrap(zipStream.readUInt32(chunkMagic))
+	if (chunkMagic != FourCC('N', 'O', 'D', 'E')) {
+		Log::error("Unknown chunk magic");
+		return false;
+	}
+	return probeNode(sceneGraph, info, -1, version, zipStream);
+}
+
 bool VENGIFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
 							 const io::ArchivePtr &archive, const SaveContext &ctx) {
 	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(filename));
@@ -490,12 +1020,86 @@ bool VENGIFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const cor
 		return false;
 	}
 	Log::debug("Save scenegraph as vengi");
+	const int level = _config.vengiCompressionLevel;
 	wrapBool(stream->writeUInt32(FourCC('V', 'E', 'N', 'G')))
-	io::ZipWriteStream zipStream(*stream, stream->size());
-	wrapBool(zipStream.writeUInt32(4))
-	if (!saveNode(sceneGraph, zipStream, sceneGraph.root())) {
+	wrapBool(stream->writeUInt32(FourCC('V', 'I', 'D', 'X')))
+	wrapBool(stream->writeUInt32(RLEVersion))
+	const int64_t indexOffsetPos = stream->pos();
+	// patched once the index table was written
+	wrapBool(stream->writeUInt64(0u))
+
+	Index index;
+	index.sceneOffset = (uint64_t)stream->pos();
+	{
+		io::ZipWriteStream zipStream(*stream, level);
+		wrapBool(saveNode(sceneGraph, zipStream, sceneGraph.root()))
+		wrapBool(zipStream.flush())
+		index.sceneSize = (uint32_t)zipStream.size();
+	}
+
+	core::DynamicArray<const scenegraph::SceneGraphNode *> brickNodes;
+	core::DynamicArray<int> replacements;
+	for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
+		const scenegraph::SceneGraphNode &node = *iter;
+		int replacement = -1;
+		if (_config.emptyPaletteIndex != -1) {
+			replacement = node.palette().findReplacement(_config.emptyPaletteIndex);
+			Log::debug("Looking for a similar color in the palette: %d", replacement);
+		}
+		const voxel::Region &region = node.volume()->region();
+		const glm::ivec3 &upper = region.getUpperCorner();
+		for (int z = region.getLowerZ(); z <= upper.z; z += BrickSize) {
+			for (int y = region.getLowerY(); y <= upper.y; y += BrickSize) {
+				for (int x = region.getLowerX(); x <= upper.x; x += BrickSize) {
+					const glm::ivec3 mins(x, y, z);
+					Brick brick;
+					brick.fileNodeId = node.id();
+					brick.region = voxel::Region(mins, glm::min(mins + (BrickSize - 1), upper));
+					index.bricks.push_back(brick);
+					brickNodes.push_back(&node);
+					replacements.push_back(replacement);
+				}
+			}
+		}
+	}
+	// empty bricks are not written - they keep a compressed size of 0
+	uint64_t offset = (uint64_t)stream->pos();
+	const bool encoded = encodeParallel(
+		index.bricks.size(),
+		[&](size_t i, io::WriteStream &out) {
+			Brick &brick = index.bricks[i];
+			if (voxelutil::isEmpty(*brickNodes[i]->volume(), brick.region)) {
+				return true;
+			}
+			io::ZipWriteStream zipStream(out, level);
+			if (!saveBrick(*brickNodes[i], brick.region, replacements[i], zipStream) || !zipStream.flush()) {
+				return false;
+			}
+			brick.compressedSize = (uint32_t)zipStream.size();
+			return true;
+		},
+		*stream);
+	if (!encoded) {
+		Log::error("Failed to serialize the voxel data");
 		return false;
 	}
+	core::DynamicArray<Brick> bricks;
+	bricks.reserve(index.bricks.size());
+	for (Brick &brick : index.bricks) {
+		if (brick.compressedSize == 0u) {
+			continue;
+		}
+		brick.offset = offset;
+		offset += brick.compressedSize;
+		bricks.push_back(brick);
+	}
+	index.bricks = core::move(bricks);
+
+	const int64_t indexOffset = stream->pos();
+	wrapBool(saveIndex(index, *stream))
+	wrap(stream->seek(indexOffsetPos))
+	wrapBool(stream->writeUInt64((uint64_t)indexOffset))
+	wrap(stream->seek(0, SEEK_END))
 	return true;
 }
 
@@ -512,10 +1116,17 @@ bool VENGIFormat::loadGroups(const core::String &filename, const io::ArchivePtr
 		Log::error("Invalid magic");
 		return false;
 	}
+	uint32_t layout;
+	wrap(stream->readUInt32(layout))
+	if (layout == FourCC('V', 'I', 'D', 'X')) {
+		return loadIndexed(*stream, sceneGraph);
+	}
+	// the older versions are one zlib stream - the layout magic is the zlib header
+	wrap(stream->seek(-4, SEEK_CUR))
 	io::ZipReadStream zipStream(*stream, stream->size());
 	uint32_t version;
 	wrap(zipStream.readUInt32(version))
-	if (version > 4) {
+	if (version > MaxStreamVersion) {
 		Log::error("Unsupported version %u", version);
 		return false;
 	}
@@ -526,17 +1137,7 @@ bool VENGIFormat::loadGroups(const core::String &filename, const io::ArchivePtr
 		if (!loadNode(sceneGraph, sceneGraph.root().id(), version, zipStream, nodeMapping)) {
 			return false;
 		}
-		for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::ModelReference); iter != sceneGraph.end();
-			 ++iter) {
-			scenegraph::SceneGraphNode &node = *iter;
-			int nodeId;
-			if (!nodeMapping.get(node.reference(), nodeId)) {
-				Log::error("Failed to perform node id mapping for references");
-				return false;
-			}
-			Log::debug("Update node reference for node %i to: %i", node.id(), nodeId);
-			node.setReference(nodeId);
-		}
+		wrapBool(updateReferences(sceneGraph, nodeMapping))
 		sceneGraph.updateTransforms();
 		return true;
 	}
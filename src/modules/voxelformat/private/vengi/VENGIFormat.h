@@ -5,6 +5,7 @@
 #pragma once
 
 #include "voxelformat/Format.h"
+#include "core/collection/DynamicArray.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/RawVolume.h"
 
@@ -16,16 +17,57 @@ namespace voxelformat {
  *
  * It's a RIFF header based format. It stores one palette per model node.
  *
+ * Up to version 4 the whole file is one zlib stream. Since version 5 the scene graph and the voxels are stored in
+ * independently compressed blobs: the node hierarchy only contains the regions of the model nodes and the voxels are
+ * split into bricks of @c BrickSize. An index table at the end of the file stores the offsets of the scene graph blob
+ * and of all the bricks - this allows to read the scene graph without touching the voxels and to decompress the
+ * bricks in parallel. Since version 6 the voxels of the bricks are run length encoded.
+ *
  * @ingroup Formats
  */
 class VENGIFormat : public Format {
 private:
 	using NodeMapping = core::Map<int, int>;
 
+	/**
+	 * @brief The side length of the independently compressed parts of a model volume
+	 */
+	static constexpr int BrickSize = 64;
+	/**
+	 * @brief The index table entry of a compressed part of the voxels of a model node
+	 */
+	struct Brick {
+		/** the id of the node at the time the file was saved */
+		int fileNodeId = InvalidNodeId;
+		voxel::Region region;
+		/** the absolute offset of the compressed data in the file */
+		uint64_t offset = 0u;
+		uint32_t compressedSize = 0u;
+	};
+	struct Index {
+		uint64_t sceneOffset = 0u;
+		uint32_t sceneSize = 0u;
+		core::DynamicArray<Brick> bricks;
+	};
+	/**
+	 * @brief Keeps the compressed bricks of a model node in memory and decodes them on first access of the volume
+	 * @sa FormatConfig::vengiLazyLoad
+	 */
+	class LazyBrickVolume;
+
 	bool saveNodeProperties(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
 							io::WriteStream &stream);
-	bool saveNodeData(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
-					  io::WriteStream &stream);
+	bool saveNodeRegion(const scenegraph::SceneGraphNode &node, io::WriteStream &stream);
+	/**
+	 * @brief Writes the voxels of the given region of the model node in z, y, x order as runs of equal voxels
+	 *
+	 * A run starts with the run length minus one as uint16 - the highest bit marks a run of air voxels. The other
+	 * runs are followed by the color and the normal index.
+	 * @param replacement The color index that is used for the voxels with the empty palette index
+	 */
+	bool saveBrick(const scenegraph::SceneGraphNode &node, const voxel::Region &region, int replacement,
+				   io::WriteStream &stream);
+	bool saveIndex(const Index &index, io::WriteStream &stream);
 	bool saveAnimation(const scenegraph::SceneGraphNode &node, const core::String &animation, io::WriteStream &stream);
 	bool saveNodeKeyFrame(const scenegraph::SceneGraphKeyFrame &keyframe, io::WriteStream &stream);
 	bool saveNodePaletteColors(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
@@ -41,6 +83,28 @@ private:
 							io::ReadStream &stream);
 	bool loadNodeData(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version,
 					  io::ReadStream &stream);
+	bool loadNodeRegion(io::ReadStream &stream, voxel::Region &region);
+	/**
+	 * @brief Decodes the voxels of a brick into the voxel data of a fresh volume
+	 *
+	 * The bricks of a volume don't overlap - so they can be decoded in parallel.
+	 * @param data The voxel data of the volume - see voxel::RawVolume::writableRow()
+	 * @param volumeRegion The region of the volume the data belongs to
+	 * @param region The region of the brick
+	 */
+	static bool loadBrick(voxel::Voxel *data, const voxel::Region &volumeRegion, const palette::Palette &palette,
+						  const voxel::Region &region, uint32_t version, io::ReadStream &stream);
+	/**
+	 * @brief Reads the version and the index table of the indexed layout - the stream must be located behind the
+	 * layout magic
+	 */
+	bool loadIndex(io::SeekableReadStream &stream, uint32_t &version, Index &index);
+	/**
+	 * @brief Loads the scene graph blob and decodes the bricks of the models in parallel - or hands the compressed
+	 * bricks over to the nodes if @c FormatConfig::vengiLazyLoad is set
+	 */
+	bool loadIndexed(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph);
+	bool updateReferences(scenegraph::SceneGraph &sceneGraph, const NodeMapping &nodeMapping);
 	bool loadAnimation(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version,
 					   io::ReadStream &stream);
 	bool loadNodeKeyFrame(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version,
@@ -54,12 +118,26 @@ private:
 	bool loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint32_t version, io::ReadStream &stream,
 				  NodeMapping &nodeMapping);
 
+	/**
+	 * @brief Reads the region of a data chunk and skips the voxels
+	 */
+	bool skipNodeData(uint32_t version, io::ReadStream &stream, voxel::Region &region);
+	/**
+	 * @brief Reads a node like @c loadNode() - but without the voxels. The other chunks are loaded into a temporary
+	 * node of the given scene graph.
+	 */
+	bool probeNode(scenegraph::SceneGraph &sceneGraph, ProbeInfo &info, int parent, uint32_t version,
+				   io::ReadStream &stream);
+
 protected:
 	bool saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
 					const io::ArchivePtr &archive, const SaveContext &ctx) override;
 	bool loadGroups(const core::String &filename, const io::ArchivePtr &archive, scenegraph::SceneGraph &sceneGraph,
 					const LoadContext &ctx) override;
 public:
+	bool probe(const core::String &filename, const io::ArchivePtr &archive, ProbeInfo &info,
+			   const LoadContext &ctx) override;
+
 	static const io::FormatDescription &format() {
 		static io::FormatDescription f{
 			"Vengi", {"vengi"}, {"VENG"}, VOX_FORMAT_FLAG_PALETTE_EMBEDDED | VOX_FORMAT_FLAG_ANIMATION | FORMAT_FLAG_SAVE};
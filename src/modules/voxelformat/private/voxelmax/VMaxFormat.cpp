@@ -4,6 +4,8 @@
 
 #include "VMaxFormat.h"
 #include "BinaryPList.h"
+#include "app/App.h"
+#include "core/Algorithm.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
@@ -179,6 +181,21 @@ bool VMaxFormat::loadGroupsPalette(const core::String &filename, const io::Archi
 	const core::String &ext = core::string::extractExtension(filename);
 	const core::String &objName = core::string::extractFilenameWithExtension(filename);
 	const bool onlyOneObject = ext == "vmaxb";
+	if (!onlyOneObject && scene.objects.size() > 1u) {
+		// openZipArchive() always returns a ZipArchive - decompress the entries of all objects in parallel
+		io::ZipArchive *zip = (io::ZipArchive *)zipArchive.get();
+		core::DynamicArray<core::String> entries;
+		entries.reserve(scene.objects.size() * 2);
+		for (const VMaxObject &obj : scene.objects) {
+			if (core::find(entries.begin(), entries.end(), obj.data) == entries.end()) {
+				entries.push_back(obj.data);
+			}
+			if (!obj.pal.empty() && core::find(entries.begin(), entries.end(), obj.pal) == entries.end()) {
+				entries.push_back(obj.pal);
+			}
+		}
+		zip->prefetch(entries, &app::App::getInstance()->threadPool());
+	}
 	for (size_t i = 0; i < scene.objects.size(); ++i) {
 		if (stopExecution()) {
 			return false;
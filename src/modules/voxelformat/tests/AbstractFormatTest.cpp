@@ -26,6 +26,7 @@
 #include "voxel/Voxel.h"
 #include "voxelformat/Format.h"
 #include "voxelformat/FormatConfig.h"
+#include "voxelformat/FormatProbe.h"
 #include "voxelformat/FormatThumbnail.h"
 #include "voxelformat/VolumeFormat.h"
 #include "voxelformat/tests/TestHelper.h"
@@ -152,6 +153,80 @@ void AbstractFormatTest::testLoad(scenegraph::SceneGraph &sceneGraph, const core
 	}
 }
 
+namespace {
+struct ProbeModel {
+	core::String name;
+	glm::ivec3 dimensions;
+};
+} // namespace
+
+static bool sortProbeModels(const ProbeModel &a, const ProbeModel &b) {
+	if (a.name != b.name) {
+		return a.name < b.name;
+	}
+	if (a.dimensions.x != b.dimensions.x) {
+		return a.dimensions.x < b.dimensions.x;
+	}
+	if (a.dimensions.y != b.dimensions.y) {
+		return a.dimensions.y < b.dimensions.y;
+	}
+	return a.dimensions.z < b.dimensions.z;
+}
+
+void AbstractFormatTest::testProbe(const core::String &filename, bool exactRegions) {
+	const io::ArchivePtr &archive = helper_filesystemarchive();
+	if (!archive->exists(filename)) {
+		GTEST_SKIP() << "Could not open " << filename;
+		return;
+	}
+	SCOPED_TRACE(filename.c_str());
+	io::FileDescription fileDesc;
+	fileDesc.set(filename);
+	scenegraph::SceneGraph sceneGraph;
+	ASSERT_TRUE(voxelformat::loadFormat(fileDesc, archive, sceneGraph, testLoadCtx)) << "Could not load " << filename;
+	ProbeInfo info;
+	ASSERT_TRUE(voxelformat::probeFormat(fileDesc, archive, info, testLoadCtx)) << "Could not probe " << filename;
+
+	core::DynamicArray<ProbeModel> loaded;
+	for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
+		loaded.push_back({(*iter).name(), (*iter).region().getDimensionsInVoxels()});
+	}
+	core::DynamicArray<ProbeModel> probed;
+	for (const ProbeNode &node : info.nodes) {
+		if (node.type == scenegraph::SceneGraphNodeType::Model) {
+			probed.push_back({node.name, node.region.getDimensionsInVoxels()});
+		}
+	}
+	ASSERT_EQ(loaded.size(), probed.size());
+	loaded.sort(sortProbeModels);
+	probed.sort(sortProbeModels);
+	for (size_t i = 0; i < loaded.size(); ++i) {
+		EXPECT_EQ(loaded[i].name, probed[i].name);
+		if (exactRegions) {
+			EXPECT_EQ(loaded[i].dimensions, probed[i].dimensions) << "model " << loaded[i].name.c_str();
+		} else {
+			EXPECT_GE(probed[i].dimensions.x, loaded[i].dimensions.x) << "model " << loaded[i].name.c_str();
+			EXPECT_GE(probed[i].dimensions.y, loaded[i].dimensions.y) << "model " << loaded[i].name.c_str();
+			EXPECT_GE(probed[i].dimensions.z, loaded[i].dimensions.z) << "model " << loaded[i].name.c_str();
+		}
+	}
+
+	if (info.paletteHash == 0u) {
+		return;
+	}
+	const scenegraph::SceneGraphNode *node = sceneGraph.firstModelNode();
+	ASSERT_NE(nullptr, node);
+	const palette::Palette &palette = node->palette();
+	ASSERT_EQ(palette.colorCount(), info.palette.colorCount());
+	for (int i = 0; i < palette.colorCount(); ++i) {
+		const core::RGBA expected = palette.color(i);
+		const core::RGBA actual = info.palette.color(i);
+		EXPECT_EQ(expected.r, actual.r) << "color " << i;
+		EXPECT_EQ(expected.g, actual.g) << "color " << i;
+		EXPECT_EQ(expected.b, actual.b) << "color " << i;
+	}
+}
+
 void AbstractFormatTest::checkColor(core::RGBA c1, const palette::Palette &palette, uint8_t index, float maxDelta) {
 	const core::RGBA c2 = palette.color(index);
 	const float delta = core::Color::getDistance(c1, c2, core::Color::Distance::HSB);
@@ -49,6 +49,11 @@ protected:
 		scenegraph::SceneGraph sceneGraph;
 		testLoad(sceneGraph, filename, expectedVolumes);
 	}
+	/**
+	 * @brief Compares the result of @c probeFormat() with the scene graph of @c loadFormat()
+	 * @param exactRegions If @c false the probed regions are only upper bounds of the loaded regions
+	 */
+	void testProbe(const core::String &filename, bool exactRegions = true);
 	void testRGB(const core::String &filename, float maxDelta = 0.001f);
 	void testRGBSmall(const core::String &filename);
 	// save as the same format
@@ -0,0 +1,55 @@
+/**
+ * @file
+ */
+
+#include "voxelformat/FormatConfig.h"
+#include "app/tests/AbstractTest.h"
+#include "core/ConfigVar.h"
+#include "util/VarUtil.h"
+#include "voxelformat/Format.h"
+
+namespace voxelformat {
+
+class FormatConfigTest : public app::AbstractTest {
+public:
+	bool onInitApp() override {
+		if (!app::AbstractTest::onInitApp()) {
+			return false;
+		}
+		FormatConfig::init();
+		return true;
+	}
+};
+
+TEST_F(FormatConfigTest, testDefaults) {
+	const FormatConfig defaults;
+	const FormatConfig config = FormatConfig::fromVars();
+	EXPECT_EQ(defaults.merge, config.merge);
+	EXPECT_EQ(defaults.createPalette, config.createPalette);
+	EXPECT_EQ(defaults.emptyPaletteIndex, config.emptyPaletteIndex);
+	EXPECT_EQ(defaults.rgbFlattenFactor, config.rgbFlattenFactor);
+	EXPECT_FLOAT_EQ(defaults.scale, config.scale);
+	EXPECT_EQ(defaults.voxelizeMode, config.voxelizeMode);
+	EXPECT_EQ(defaults.normalPalette, config.normalPalette);
+	EXPECT_EQ(defaults.meshMode, config.meshMode);
+	EXPECT_EQ(defaults.optimize, config.optimize);
+	EXPECT_FLOAT_EQ(defaults.simplifyError, config.simplifyError);
+	EXPECT_EQ(defaults.gltfKHRMeshQuantization, config.gltfKHRMeshQuantization);
+	EXPECT_EQ(defaults.qbtPaletteMode, config.qbtPaletteMode);
+	EXPECT_EQ(defaults.voxCreateLayers, config.voxCreateLayers);
+	EXPECT_EQ(defaults.imageImportType, config.imageImportType);
+	EXPECT_EQ(defaults.imageVolumeMaxDepth, config.imageVolumeMaxDepth);
+}
+
+TEST_F(FormatConfigTest, testSnapshot) {
+	LoadContext before;
+	{
+		util::ScopedVarChange scoped(cfg::VoxformatScale, "4");
+		LoadContext during;
+		EXPECT_FLOAT_EQ(4.0f, during.config.scale);
+	}
+	// changing the cvar doesn't affect the contexts that were already created
+	EXPECT_FLOAT_EQ(1.0f, before.config.scale);
+}
+
+} // namespace voxelformat
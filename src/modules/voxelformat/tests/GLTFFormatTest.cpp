@@ -54,6 +54,13 @@ TEST_F(GLTFFormatTest, testSaveLoadVoxel) {
 	testSaveLoadVoxel("bv-smallvolumesavetest.gltf", &f, 0, 10, flags);
 }
 
+TEST_F(GLTFFormatTest, testSaveLoadVoxelQuantized) {
+	GLTFFormat f;
+	testSaveCtx.config.gltfKHRMeshQuantization = true;
+	const voxel::ValidateFlags flags = voxel::ValidateFlags::All & ~voxel::ValidateFlags::Palette;
+	testSaveLoadVoxel("bv-smallvolumesavetest-quantized.gltf", &f, 0, 10, flags);
+}
+
 TEST_F(GLTFFormatTest, testVoxelizeLantern) {
 	scenegraph::SceneGraph sceneGraph;
 	testLoad(sceneGraph, "glTF/lantern/Lantern.gltf", 3u);
@@ -22,6 +22,11 @@ TEST_F(GoxFormatTest, testLoadRGB) {
 	testRGB("rgb.gox");
 }
 
+TEST_F(GoxFormatTest, testProbe) {
+	// the regions of the probe are only upper bounds of the loaded regions
+	testProbe("chr_knight.gox", false);
+}
+
 TEST_F(GoxFormatTest, testLoadScreenshot) {
 	testLoadScreenshot("chr_knight.gox", 128, 128, core::RGBA(158, 59, 59), 65, 27);
 }
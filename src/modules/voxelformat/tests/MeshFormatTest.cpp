@@ -4,6 +4,7 @@
 
 #include "voxelformat/private/mesh/MeshFormat.h"
 #include "core/Color.h"
+#include "core/GLM.h"
 #include "core/tests/TestColorHelper.h"
 #include "image/Image.h"
 #include "io/Archive.h"
@@ -16,6 +17,7 @@
 #include "voxelformat/private/mesh/MeshMaterial.h"
 #include "voxelformat/private/mesh/TextureLookup.h"
 #include "voxelformat/tests/AbstractFormatTest.h"
+#include <glm/ext/scalar_constants.hpp>
 
 namespace voxelformat {
 
@@ -50,6 +52,26 @@ TEST_F(MeshFormatTest, testColorAt) {
 	}
 }
 
+TEST_F(MeshFormatTest, testColorAtMipmap) {
+	const image::ImagePtr &texture = image::createEmptyImage("checkerboard");
+	ASSERT_TRUE(texture->load(4, 4, [](int x, int y, core::RGBA &rgba) {
+		rgba = ((x + y) % 2) == 0 ? core::RGBA(0, 0, 0, 255) : core::RGBA(255, 255, 255, 255);
+	}));
+	MeshMaterialPtr material = createMaterial(texture);
+	material->generateMipmaps();
+	ASSERT_EQ(2u, material->mipmaps.size());
+	EXPECT_EQ(2, material->mipmaps[0]->width());
+	EXPECT_EQ(1, material->mipmaps[1]->width());
+
+	const glm::vec2 uv = texture->uv(0, 0);
+	core::RGBA color;
+	ASSERT_TRUE(material->colorAt(color, uv));
+	EXPECT_EQ(core::RGBA(0, 0, 0, 255), color);
+	// the whole texture is covered - the colors are averaged
+	ASSERT_TRUE(material->colorAt(color, uv, false, 1.0f));
+	EXPECT_EQ(core::RGBA(128, 128, 128, 255), color);
+}
+
 TEST_F(MeshFormatTest, testCalculateAABB) {
 	MeshFormat::MeshTriCollection tris;
 	voxelformat::MeshTri meshTri;
@@ -165,4 +187,318 @@ TEST_F(MeshFormatTest, testVoxelizeColor) {
 	EXPECT_COLOR_NEAR(nipponGreen, node->palette().color(v->voxel(size - 1, size - 1, size - 1).getColor()), 0.01f);
 }
 
+TEST_F(MeshFormatTest, testTransformTrisParallel) {
+	class TestMesh : public MeshFormat {
+	public:
+		using MeshFormat::PosMap;
+		using MeshFormat::PosMaps;
+		using MeshFormat::PosMapShards;
+		using MeshFormat::TrisPerTask;
+		using MeshFormat::transformTris;
+		using MeshFormat::transformTrisParallel;
+		bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &,
+						const core::String &, const io::ArchivePtr &, const glm::vec3 &, bool, bool, bool) override {
+			return false;
+		}
+	};
+
+	// a uv sphere
+	const int segments = 24;
+	const float radius = 20.0f;
+	auto spherePos = [&](int slice, int stack) {
+		const float theta = (float)stack / (float)segments * glm::pi<float>();
+		const float phi = (float)slice / (float)segments * glm::two_pi<float>();
+		return glm::vec3(glm::sin(theta) * glm::cos(phi), glm::cos(theta), glm::sin(theta) * glm::sin(phi)) * radius;
+	};
+	MeshFormat::MeshTriCollection tris;
+	for (int stack = 0; stack < segments; ++stack) {
+		for (int slice = 0; slice < segments; ++slice) {
+			voxelformat::MeshTri meshTri;
+			meshTri.vertices[0] = spherePos(slice, stack);
+			meshTri.vertices[1] = spherePos(slice, stack + 1);
+			meshTri.vertices[2] = spherePos(slice + 1, stack);
+			meshTri.color[0] = core::RGBA(255, 0, 0, 255);
+			meshTri.color[1] = core::RGBA(0, (uint8_t)(stack * 10), 0, 255);
+			meshTri.color[2] = core::RGBA(0, 0, (uint8_t)(slice * 10), 255);
+			tris.push_back(meshTri);
+			meshTri.vertices[0] = spherePos(slice + 1, stack);
+			meshTri.vertices[1] = spherePos(slice, stack + 1);
+			meshTri.vertices[2] = spherePos(slice + 1, stack + 1);
+			tris.push_back(meshTri);
+		}
+	}
+	// more than one task is needed
+	ASSERT_GT(tris.size(), (size_t)TestMesh::TrisPerTask);
+
+	glm::vec3 mins;
+	glm::vec3 maxs;
+	ASSERT_TRUE(MeshFormat::calculateAABB(tris, mins, maxs));
+	// see voxelizeNode()
+	const voxel::Region region(glm::floor(mins) - 1.0f, glm::ceil(maxs));
+	palette::NormalPalette normalPalette;
+	normalPalette.redAlert2();
+
+	MeshFormat::MeshTriCollection subdivided;
+	for (const voxelformat::MeshTri &meshTri : tris) {
+		MeshFormat::subdivideTri(meshTri, subdivided);
+	}
+	TestMesh::PosMap expected(region);
+	TestMesh::transformTris(region, subdivided, expected, normalPalette);
+
+	TestMesh::PosMaps posMaps;
+	EXPECT_EQ(subdivided.size(), TestMesh::transformTrisParallel(region, tris, posMaps, normalPalette));
+	ASSERT_EQ(TestMesh::PosMapShards, (int)posMaps.size());
+	size_t positions = 0;
+	for (const TestMesh::PosMap &posMap : posMaps) {
+		positions += posMap.size();
+		for (const voxelformat::PosSamplingGrid::Entry &entry : posMap) {
+			const voxelformat::PosSampling *sampling = expected.find(entry.pos);
+			ASSERT_NE(nullptr, sampling);
+			EXPECT_EQ(sampling->getColor(0, true), entry.sampling.getColor(0, true));
+			EXPECT_EQ(sampling->getNormal(), entry.sampling.getNormal());
+		}
+	}
+	EXPECT_EQ(expected.size(), positions);
+}
+
+TEST_F(MeshFormatTest, testRasterizeTrisParallel) {
+	class TestMesh : public MeshFormat {
+	public:
+		using MeshFormat::PosMaps;
+		using MeshFormat::PosMapShards;
+		using MeshFormat::rasterizeTrisParallel;
+		bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &,
+						const core::String &, const io::ArchivePtr &, const glm::vec3 &, bool, bool, bool) override {
+			return false;
+		}
+	};
+
+	// large triangles that are not axis aligned
+	MeshFormat::MeshTriCollection tris;
+	voxelformat::MeshTri meshTri;
+	meshTri.setColor(core::RGBA(255, 0, 0, 255));
+	meshTri.vertices[0] = glm::vec3(0.3f, 1.7f, 2.1f);
+	meshTri.vertices[1] = glm::vec3(40.6f, 9.2f, 30.4f);
+	meshTri.vertices[2] = glm::vec3(12.9f, 35.3f, 5.8f);
+	tris.push_back(meshTri);
+	meshTri.vertices[0] = glm::vec3(3.4f, 30.1f, 33.2f);
+	meshTri.vertices[1] = glm::vec3(38.2f, 2.7f, 1.9f);
+	meshTri.vertices[2] = glm::vec3(20.5f, 4.3f, 36.6f);
+	tris.push_back(meshTri);
+
+	const voxel::Region region(0, 0, 0, 41, 41, 41);
+	palette::NormalPalette normalPalette;
+	normalPalette.redAlert2();
+
+	TestMesh::PosMaps posMaps;
+	const size_t voxels = TestMesh::rasterizeTrisParallel(region, tris, posMaps, normalPalette);
+
+	// every voxel that overlaps a triangle is touched exactly once per triangle
+	const glm::vec3 voxelHalf(0.5f);
+	size_t expectedVoxels = 0;
+	size_t expectedPositions = 0;
+	for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+				const glm::ivec3 p(x, y, z);
+				const glm::vec3 center = glm::vec3(p) + voxelHalf;
+				int hits = 0;
+				for (const voxelformat::MeshTri &tri : tris) {
+					if (glm::intersectTriangleAABB(center, voxelHalf, tri.vertices[0], tri.vertices[1],
+												   tri.vertices[2])) {
+						++hits;
+					}
+				}
+				expectedVoxels += hits;
+				const PosSampling *sampling = posMaps[(x - region.getLowerX()) * TestMesh::PosMapShards /
+													  region.getWidthInVoxels()]
+												  .find(p);
+				if (hits > 0) {
+					++expectedPositions;
+					ASSERT_NE(nullptr, sampling) << x << ":" << y << ":" << z;
+					EXPECT_EQ(core::RGBA(255, 0, 0, 255), sampling->getColor(0, true));
+				} else {
+					ASSERT_EQ(nullptr, sampling) << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+	EXPECT_EQ(expectedVoxels, voxels);
+	size_t positions = 0;
+	for (const PosSamplingGrid &posMap : posMaps) {
+		positions += posMap.size();
+	}
+	EXPECT_EQ(expectedPositions, positions);
+}
+
+TEST_F(MeshFormatTest, testMeshTriSource) {
+	class TestSource : public MeshFormat::MeshTriSource {
+	private:
+		const size_t _amount;
+
+	protected:
+		bool produce(MeshFormat::MeshTriCollection &tris, const std::function<bool()> &flush) override {
+			++produced;
+			for (size_t i = 0; i < _amount; ++i) {
+				voxelformat::MeshTri meshTri;
+				meshTri.vertices[0] = glm::vec3((float)i);
+				tris.push_back(meshTri);
+				if (tris.size() >= BatchSize && !flush()) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+	public:
+		int produced = 0;
+		TestSource(size_t amount) : _amount(amount) {
+		}
+	};
+
+	// the triangles of a single batch are only produced once
+	TestSource small(10);
+	for (int i = 0; i < 2; ++i) {
+		size_t tris = 0;
+		EXPECT_TRUE(small.visit([&](const MeshFormat::MeshTriCollection &batch) {
+			tris += batch.size();
+			return true;
+		}));
+		EXPECT_EQ(10u, tris);
+	}
+	EXPECT_EQ(1, small.produced);
+
+	const size_t amount = TestSource::BatchSize * 2 + 5;
+	TestSource large(amount);
+	for (int i = 0; i < 2; ++i) {
+		size_t tris = 0;
+		int batches = 0;
+		EXPECT_TRUE(large.visit([&](const MeshFormat::MeshTriCollection &batch) {
+			EXPECT_LE(batch.size(), TestSource::BatchSize);
+			EXPECT_FLOAT_EQ((float)tris, batch[0].vertices[0].x);
+			tris += batch.size();
+			++batches;
+			return true;
+		}));
+		EXPECT_EQ(amount, tris);
+		EXPECT_EQ(3, batches);
+	}
+	EXPECT_EQ(2, large.produced);
+
+	// stop producing if the batch function fails
+	EXPECT_FALSE(large.visit([&](const MeshFormat::MeshTriCollection &) { return false; }));
+}
+
+TEST_F(MeshFormatTest, testVoxelizeBuckets) {
+	class TestMesh : public MeshFormat {
+	public:
+		bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &,
+						const core::String &, const io::ArchivePtr &, const glm::vec3 &, bool, bool, bool) override {
+			return false;
+		}
+		int voxelize(scenegraph::SceneGraph &sceneGraph, const MeshFormat::MeshTriCollection &tris) {
+			return voxelizeBuckets("level", sceneGraph, tris);
+		}
+	};
+
+	MeshFormat::MeshTriCollection tris;
+	voxelformat::MeshTri meshTri;
+	meshTri.color[0] = meshTri.color[1] = meshTri.color[2] = core::RGBA(255, 0, 0, 255);
+	meshTri.vertices[0] = glm::vec3(0.0f, 0.0f, 0.0f);
+	meshTri.vertices[1] = glm::vec3(4.0f, 0.0f, 0.0f);
+	meshTri.vertices[2] = glm::vec3(0.0f, 0.0f, 4.0f);
+	tris.push_back(meshTri);
+	meshTri.vertices[0] = glm::vec3(40.0f, 0.0f, 0.0f);
+	meshTri.vertices[1] = glm::vec3(44.0f, 0.0f, 0.0f);
+	meshTri.vertices[2] = glm::vec3(40.0f, 0.0f, 4.0f);
+	tris.push_back(meshTri);
+
+	FormatConfig config = testLoadCtx.config;
+	{
+		// the two triangles are far apart and end up in their own model nodes
+		config.meshBucketSize = 16;
+		TestMesh mesh;
+		mesh.setConfig(config);
+		scenegraph::SceneGraph sceneGraph;
+		const int nodeId = mesh.voxelize(sceneGraph, tris);
+		ASSERT_NE(InvalidNodeId, nodeId);
+		EXPECT_EQ(scenegraph::SceneGraphNodeType::Group, sceneGraph.node(nodeId).type());
+		EXPECT_EQ(2u, sceneGraph.size());
+	}
+	{
+		// everything fits into one bucket
+		config.meshBucketSize = 64;
+		TestMesh mesh;
+		mesh.setConfig(config);
+		scenegraph::SceneGraph sceneGraph;
+		const int nodeId = mesh.voxelize(sceneGraph, tris);
+		ASSERT_NE(InvalidNodeId, nodeId);
+		EXPECT_EQ(scenegraph::SceneGraphNodeType::Model, sceneGraph.node(nodeId).type());
+		EXPECT_EQ(1u, sceneGraph.size());
+	}
+	{
+		// disabled
+		config.meshBucketSize = 0;
+		TestMesh mesh;
+		mesh.setConfig(config);
+		scenegraph::SceneGraph sceneGraph;
+		EXPECT_NE(InvalidNodeId, mesh.voxelize(sceneGraph, tris));
+		EXPECT_EQ(1u, sceneGraph.size());
+	}
+	{
+		// a triangle that is bigger than a bucket is split
+		MeshFormat::MeshTriCollection bigTris;
+		meshTri.vertices[0] = glm::vec3(0.0f, 0.0f, 0.0f);
+		meshTri.vertices[1] = glm::vec3(32.0f, 0.0f, 0.0f);
+		meshTri.vertices[2] = glm::vec3(0.0f, 0.0f, 32.0f);
+		bigTris.push_back(meshTri);
+		config.meshBucketSize = 8;
+		TestMesh mesh;
+		mesh.setConfig(config);
+		scenegraph::SceneGraph sceneGraph;
+		EXPECT_NE(InvalidNodeId, mesh.voxelize(sceneGraph, bigTris));
+		EXPECT_LT(1u, sceneGraph.size());
+	}
+}
+
+TEST_F(MeshFormatTest, testMeshStreamReference) {
+	class TestMesh : public MeshFormat {
+	public:
+		using MeshFormat::MeshStream;
+	};
+
+	voxel::RawVolume volume(voxel::Region(0, 3));
+	volume.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	scenegraph::SceneGraph sceneGraph;
+	int modelId;
+	{
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(&volume, false);
+		modelId = sceneGraph.emplace(core::move(node));
+		ASSERT_NE(InvalidNodeId, modelId);
+	}
+	int referenceId;
+	{
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::ModelReference);
+		node.setReference(modelId);
+		node.setPalette(sceneGraph.node(modelId).palette());
+		referenceId = sceneGraph.emplace(core::move(node));
+		ASSERT_NE(InvalidNodeId, referenceId);
+	}
+	const scenegraph::SceneGraphNode &model = sceneGraph.node(modelId);
+	const scenegraph::SceneGraphNode &reference = sceneGraph.node(referenceId);
+
+	FormatConfig config;
+	TestMesh::MeshStream meshStream(sceneGraph, config);
+	EXPECT_EQ(meshStream.key(model), meshStream.key(reference));
+	voxel::ChunkMesh *modelMesh = meshStream.acquire(model);
+	ASSERT_NE(nullptr, modelMesh);
+	meshStream.release(model);
+	// the mesh is kept until the reference released it, too
+	EXPECT_EQ(modelMesh, meshStream.acquire(reference));
+	meshStream.release(reference);
+	EXPECT_EQ(2u, meshStream.nonEmpty());
+	EXPECT_EQ(glm::vec3(4.0f), meshStream.createMeshExt(modelMesh, reference).size);
+}
+
 } // namespace voxelformat
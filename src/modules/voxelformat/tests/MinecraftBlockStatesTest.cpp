@@ -0,0 +1,67 @@
+/**
+ * @file
+ */
+
+#include "voxelformat/private/minecraft/MinecraftBlockStates.h"
+#include "app/tests/AbstractTest.h"
+#include "core/collection/Buffer.h"
+
+namespace voxelformat {
+
+class MinecraftBlockStatesTest : public app::AbstractTest {
+protected:
+	void testRoundTrip(int bits, bool padded) {
+		constexpr int count = 16 * 16 * 16;
+		uint16_t indices[count];
+		for (int i = 0; i < count; ++i) {
+			indices[i] = (uint16_t)((i * 7 + i / 13) & ((1 << bits) - 1));
+		}
+		core::DynamicArray<int64_t> words;
+		ASSERT_TRUE(packBlockStates(indices, count, bits, padded, words));
+		ASSERT_EQ(blockStatesLongs(count, bits, padded), words.size());
+
+		// the nbt data is big endian
+		core::Buffer<uint8_t> data;
+		data.resize(words.size() * sizeof(int64_t));
+		for (size_t i = 0; i < words.size(); ++i) {
+			const uint64_t val = (uint64_t)words[i];
+			for (int b = 0; b < 8; ++b) {
+				data[i * 8 + b] = (uint8_t)(val >> (56 - b * 8));
+			}
+		}
+		const priv::NBTArrayView<int64_t> view(data.data(), (uint32_t)words.size());
+		uint16_t unpacked[count];
+		ASSERT_TRUE(unpackBlockStates(view, bits, padded, unpacked, count));
+		for (int i = 0; i < count; ++i) {
+			ASSERT_EQ(indices[i], unpacked[i]) << "index " << i << " bits " << bits << " padded " << padded;
+		}
+	}
+};
+
+TEST_F(MinecraftBlockStatesTest, testPadded) {
+	for (int bits = 1; bits <= 16; ++bits) {
+		testRoundTrip(bits, true);
+	}
+}
+
+TEST_F(MinecraftBlockStatesTest, testSpanning) {
+	for (int bits = 1; bits <= 16; ++bits) {
+		testRoundTrip(bits, false);
+	}
+}
+
+TEST_F(MinecraftBlockStatesTest, testLongs) {
+	// 4096 indices with 5 bits: 12 per long with padding, 320 longs without
+	EXPECT_EQ(342u, blockStatesLongs(4096, 5, true));
+	EXPECT_EQ(320u, blockStatesLongs(4096, 5, false));
+	EXPECT_EQ(256u, blockStatesLongs(4096, 4, true));
+}
+
+TEST_F(MinecraftBlockStatesTest, testTooSmall) {
+	const uint8_t data[8] = {};
+	const priv::NBTArrayView<int64_t> view(data, 1);
+	uint16_t unpacked[4096];
+	EXPECT_FALSE(unpackBlockStates(view, 4, true, unpacked, 4096));
+}
+
+} // namespace voxelformat
@@ -21,6 +21,22 @@ TEST_F(MinecraftPaletteMapTest, testParse) {
 				  "minecraft:dark_oak_stairs[facing=east,half=bottom,shape=outer_left,waterlogged=false][INT] = 554"));
 }
 
+TEST_F(MinecraftPaletteMapTest, testLookupMatchesMap) {
+	const PaletteMap &map = getPaletteMap();
+	for (const McColorScheme &entry : getPaletteArray()) {
+		auto iter = map.find(entry.name);
+		ASSERT_NE(map.end(), iter) << entry.name;
+		EXPECT_EQ(iter->value.palIdx, findPaletteIndex(core::String("minecraft:") + entry.name)) << entry.name;
+	}
+	EXPECT_EQ(-1, findPaletteIndex("minecraft:unknown_block"));
+	EXPECT_EQ(7, findPaletteIndex("minecraft:unknown_block[axis=y]", 7));
+}
+
+TEST_F(MinecraftPaletteMapTest, testLookupNotTerminated) {
+	const char *name = "minecraft:airxyz";
+	EXPECT_EQ(0, findPaletteIndex(name, 13, -1));
+}
+
 // parses a blocks.json file to find new colors
 // disabled because the blocks.json file is not available in the repository and was parsed already
 TEST_F(MinecraftPaletteMapTest, DISABLED_testNewColors) {
@@ -3,6 +3,7 @@
  */
 
 #include "voxelformat/private/minecraft/NamedBinaryTag.h"
+#include "voxelformat/private/minecraft/NamedBinaryTagReader.h"
 #include "app/tests/AbstractTest.h"
 #include "io/BufferedReadWriteStream.h"
 
@@ -29,4 +30,83 @@ TEST_F(NamedBinaryTagTest, testWriteRead) {
 	}
 }
 
+class CountingVisitor : public priv::NamedBinaryTagVisitor {
+public:
+	int compounds = 0;
+	int lists = 0;
+	int32_t intVal = 0;
+	core::String name;
+	size_t byteArraySize = 0u;
+	int8_t lastByte = 0;
+
+	bool enterCompound(const priv::NBTStringView &tagName) override {
+		++compounds;
+		return tagName != "Skipped";
+	}
+
+	bool enterList(const priv::NBTStringView &tagName, priv::TagType type, uint32_t length) override {
+		++lists;
+		return true;
+	}
+
+	void visit(const priv::NBTStringView &tagName, const priv::NBTValue &value) override {
+		if (tagName == "Int") {
+			intVal = value.int32();
+		} else if (tagName == "Name") {
+			name = value.string().str();
+		} else if (tagName == "Bytes") {
+			const priv::NBTArrayView<int8_t> &bytes = value.byteArray();
+			byteArraySize = bytes.size();
+			lastByte = bytes[bytes.size() - 1];
+		} else if (tagName == "Hidden") {
+			intVal = -1;
+		}
+	}
+};
+
+TEST_F(NamedBinaryTagTest, testReader) {
+	io::BufferedReadWriteStream stream;
+	{
+		priv::NBTCompound skipped;
+		skipped.put("Hidden", priv::NamedBinaryTag((int32_t)1));
+		priv::NBTCompound entry;
+		entry.put("Name", priv::NamedBinaryTag(core::String("minecraft:stone")));
+		priv::NBTList list;
+		list.emplace_back(core::move(entry));
+		core::DynamicArray<int8_t> bytes;
+		bytes.push_back(1);
+		bytes.push_back(2);
+		bytes.push_back(3);
+		priv::NBTCompound compound;
+		compound.put("Skipped", priv::NamedBinaryTag(core::move(skipped)));
+		compound.put("List", priv::NamedBinaryTag(core::move(list)));
+		compound.put("Bytes", priv::NamedBinaryTag(core::move(bytes)));
+		compound.put("Int", priv::NamedBinaryTag((int32_t)42));
+		priv::NamedBinaryTag root(core::move(compound));
+		ASSERT_TRUE(priv::NamedBinaryTag::write(root, "rootTagName", stream));
+	}
+	priv::NamedBinaryTagReader reader(stream.getBuffer(), (size_t)stream.size());
+	CountingVisitor visitor;
+	ASSERT_TRUE(reader.parse(visitor));
+	// root, skipped and the list entry
+	EXPECT_EQ(3, visitor.compounds);
+	EXPECT_EQ(1, visitor.lists);
+	EXPECT_EQ(42, visitor.intVal);
+	EXPECT_EQ("minecraft:stone", visitor.name);
+	EXPECT_EQ(3u, visitor.byteArraySize);
+	EXPECT_EQ(3, visitor.lastByte);
+
+	priv::NamedBinaryTagReader truncated(stream.getBuffer(), (size_t)stream.size() - 1);
+	EXPECT_FALSE(truncated.parse(visitor));
+}
+
+TEST_F(NamedBinaryTagTest, testArrayView) {
+	const uint8_t data[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02,
+							0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe};
+	const priv::NBTArrayView<int64_t> view(data, 2);
+	ASSERT_EQ(2u, view.size());
+	EXPECT_EQ(0x0102, view[0]);
+	EXPECT_EQ(-2, view[1]);
+}
+
 } // namespace voxelformat
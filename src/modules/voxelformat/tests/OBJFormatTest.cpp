@@ -3,9 +3,7 @@
  */
 
 #include "AbstractFormatTest.h"
-#include "core/ConfigVar.h"
 #include "scenegraph/SceneGraphNode.h"
-#include "util/VarUtil.h"
 #include "voxel/Voxel.h"
 #include "voxelformat/tests/TestHelper.h"
 #include "voxelutil/VoxelUtil.h"
@@ -20,8 +18,8 @@ TEST_F(OBJFormatTest, testVoxelize) {
 
 // https://github.com/vengi-voxel/vengi/issues/393
 TEST_F(OBJFormatTest, testVoxelizeUVSphereObj) {
-	util::ScopedVarChange scoped1(cfg::VoxformatScale, "4");
-	util::ScopedVarChange scoped2(cfg::VoxformatFillHollow, "false");
+	testLoadCtx.config.scale = 4.0f;
+	testLoadCtx.config.fillHollow = false;
 	scenegraph::SceneGraph sceneGraph;
 	testLoad(sceneGraph, "bug393.obj");
 	const scenegraph::SceneGraphNode *node = sceneGraph.firstModelNode();
@@ -4,9 +4,10 @@
 
 #include "voxelformat/private/image/PNGFormat.h"
 #include "AbstractFormatTest.h"
+#include "core/StringUtil.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
-#include "util/VarUtil.h"
+#include "voxel/RawVolume.h"
 
 namespace voxelformat {
 
@@ -22,7 +23,7 @@ TEST_F(PNGFormatTest, testLoadPlane) {
 }
 
 TEST_F(PNGFormatTest, testLoadVolume) {
-	util::ScopedVarChange scped(cfg::VoxformatImageImportType, PNGFormat::ImportType::Volume);
+	testLoadCtx.config.imageImportType = PNGFormat::ImportType::Volume;
 	scenegraph::SceneGraph sceneGraph;
 	testLoad(sceneGraph, "test-heightmap.png", 1);
 	scenegraph::SceneGraphNode *node = sceneGraph.firstModelNode();
@@ -32,7 +33,7 @@ TEST_F(PNGFormatTest, testLoadVolume) {
 }
 
 TEST_F(PNGFormatTest, testLoadHeightmap) {
-	util::ScopedVarChange scped(cfg::VoxformatImageImportType, PNGFormat::ImportType::Heightmap);
+	testLoadCtx.config.imageImportType = PNGFormat::ImportType::Heightmap;
 	scenegraph::SceneGraph sceneGraph;
 	testLoad(sceneGraph, "test-heightmap.png", 1);
 	scenegraph::SceneGraphNode *node = sceneGraph.firstModelNode();
@@ -41,4 +42,42 @@ TEST_F(PNGFormatTest, testLoadHeightmap) {
 	EXPECT_EQ(region.getDimensionsInVoxels(), glm::ivec3(8, 255, 8));
 }
 
+TEST_F(PNGFormatTest, testSaveLoadSlices) {
+	palette::Palette pal;
+	pal.nippon();
+	const voxel::Region region(0, 0, 0, 3, 2, 9);
+	voxel::RawVolume original(region);
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		ASSERT_TRUE(original.setVoxel(z % 4, 1, z, voxel::createVoxel(pal, 1 + z)));
+	}
+	scenegraph::SceneGraph sceneGraphSave;
+	int nodeId;
+	{
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(&original, false);
+		node.setPalette(pal);
+		nodeId = sceneGraphSave.emplace(core::move(node));
+	}
+	ASSERT_NE(InvalidNodeId, nodeId);
+	PNGFormat format;
+	io::ArchivePtr archive = helper_archive();
+	ASSERT_TRUE(format.save(sceneGraphSave, "slices.png", archive, testSaveCtx));
+
+	// every slice is a png - any of them can be used to load the whole stack
+	const core::String &uuid = sceneGraphSave.node(nodeId).uuid().str();
+	const core::String &sliceFilename = core::string::format("slices-%s-3.png", uuid.c_str());
+	scenegraph::SceneGraph sceneGraph;
+	ASSERT_TRUE(format.load(sliceFilename, archive, sceneGraph, testLoadCtx));
+	scenegraph::SceneGraphNode *node = sceneGraph.firstModelNode();
+	ASSERT_TRUE(node != nullptr);
+	ASSERT_EQ(region, node->region());
+	const voxel::RawVolume *v = node->volume();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			const bool solid = x == z % 4;
+			EXPECT_EQ(solid, !voxel::isAir(v->voxel(x, 1, z).getMaterial())) << x << ":1:" << z;
+		}
+	}
+}
+
 } // namespace voxelformat
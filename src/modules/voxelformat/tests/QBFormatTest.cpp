@@ -15,6 +15,11 @@ TEST_F(QBFormatTest, testLoad) {
 	testLoad("qubicle.qb", 10);
 }
 
+TEST_F(QBFormatTest, testProbe) {
+	testProbe("qubicle.qb");
+	testProbe("chr_knight.qb");
+}
+
 TEST_F(QBFormatTest, testLoadRGB) {
 	testRGB("rgb.qb");
 }
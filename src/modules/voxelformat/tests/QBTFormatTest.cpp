@@ -14,6 +14,10 @@ TEST_F(QBTFormatTest, testLoad) {
 	testLoad("qubicle.qbt", 17);
 }
 
+TEST_F(QBTFormatTest, testProbe) {
+	testProbe("qubicle.qbt");
+}
+
 TEST_F(QBTFormatTest, testLoadRGBSmall) {
 	testRGBSmall("rgb_small.qbt");
 }
@@ -4,6 +4,9 @@
 
 #include "voxelformat/private/vengi/VENGIFormat.h"
 #include "AbstractFormatTest.h"
+#include "voxel/RawVolume.h"
+#include "voxelformat/FormatProbe.h"
+#include <future>
 
 namespace voxelformat {
 
@@ -19,4 +22,142 @@ TEST_F(VENGIFormatTest, testSaveLoadVoxel) {
 	testSaveLoadVoxel("testSaveLoadVoxel.vengi", &f);
 }
 
+TEST_F(VENGIFormatTest, testSaveMultipleModels) {
+	VENGIFormat f;
+	testSaveMultipleModels("testSaveMultipleModels.vengi", &f);
+}
+
+TEST_F(VENGIFormatTest, testSaveLoadBricks) {
+	VENGIFormat f;
+	// the corners are in different bricks - the bricks at the upper borders are smaller and the others are empty
+	testSaveLoadVoxel("testSaveLoadBricks.vengi", &f, -10, 130);
+}
+
+TEST_F(VENGIFormatTest, testProbeBricks) {
+	VENGIFormat f;
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(99, 10, 70));
+	voxel::RawVolume volume(region);
+	volume.setVoxel(99, 10, 70, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setName("model");
+	node.setVolume(&volume);
+	sceneGraph.emplace(core::move(node));
+	io::ArchivePtr archive = helper_archive();
+	ASSERT_TRUE(f.save(sceneGraph, "testProbeBricks.vengi", archive, testSaveCtx));
+	ProbeInfo info;
+	ASSERT_TRUE(f.probe("testProbeBricks.vengi", archive, info, testLoadCtx));
+	ASSERT_EQ(1u, info.nodes.size());
+	EXPECT_EQ("model", info.nodes[0].name);
+	EXPECT_EQ(region, info.nodes[0].region);
+}
+
+TEST_F(VENGIFormatTest, testSaveLoadRuns) {
+	VENGIFormat f;
+	// the solid runs of the first brick are longer than the max run length - and the runs span several rows
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(79, 69, 19));
+	voxel::RawVolume volume(region);
+	for (int z = 0; z <= 19; ++z) {
+		for (int y = 0; y <= 69; ++y) {
+			for (int x = 0; x <= 79; ++x) {
+				if (z < 10) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+				} else if ((x + y) % 7 == 0) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (x % 3) + 2, x % 5));
+				}
+			}
+		}
+	}
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(&volume);
+	sceneGraph.emplace(core::move(node));
+	io::ArchivePtr archive = helper_archive();
+	ASSERT_TRUE(f.save(sceneGraph, "testSaveLoadRuns.vengi", archive, testSaveCtx));
+
+	scenegraph::SceneGraph loadedSceneGraph;
+	ASSERT_TRUE(f.load("testSaveLoadRuns.vengi", archive, loadedSceneGraph, testLoadCtx));
+	scenegraph::SceneGraphNode *loadedNode = loadedSceneGraph.firstModelNode();
+	ASSERT_NE(nullptr, loadedNode);
+	const voxel::RawVolume *loadedVolume = loadedNode->volume();
+	ASSERT_NE(nullptr, loadedVolume);
+	ASSERT_EQ(region, loadedVolume->region());
+	for (int z = 0; z <= 19; ++z) {
+		for (int y = 0; y <= 69; ++y) {
+			for (int x = 0; x <= 79; ++x) {
+				const voxel::Voxel &expected = volume.voxel(x, y, z);
+				const voxel::Voxel &loaded = loadedVolume->voxel(x, y, z);
+				ASSERT_EQ(expected.getMaterial(), loaded.getMaterial()) << x << ":" << y << ":" << z;
+				ASSERT_EQ(expected.getColor(), loaded.getColor()) << x << ":" << y << ":" << z;
+				ASSERT_EQ(expected.getNormal(), loaded.getNormal()) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
+TEST_F(VENGIFormatTest, testLazyLoad) {
+	VENGIFormat f;
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(99, 10, 70));
+	voxel::RawVolume volume(region);
+	volume.setVoxel(99, 10, 70, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(&volume);
+	sceneGraph.emplace(core::move(node));
+	io::ArchivePtr archive = helper_archive();
+	ASSERT_TRUE(f.save(sceneGraph, "testLazyLoad.vengi", archive, testSaveCtx));
+
+	LoadContext ctx;
+	ctx.config.vengiLazyLoad = true;
+	scenegraph::SceneGraph loadedSceneGraph;
+	ASSERT_TRUE(f.load("testLazyLoad.vengi", archive, loadedSceneGraph, ctx));
+	scenegraph::SceneGraphNode *loadedNode = loadedSceneGraph.firstModelNode();
+	ASSERT_NE(nullptr, loadedNode);
+	EXPECT_FALSE(loadedNode->isVolumeLoaded());
+	EXPECT_EQ(region, loadedNode->region());
+	const voxel::RawVolume *loadedVolume = loadedNode->volume();
+	ASSERT_NE(nullptr, loadedVolume);
+	EXPECT_TRUE(loadedNode->isVolumeLoaded());
+	EXPECT_EQ(voxel::VoxelType::Generic, loadedVolume->voxel(99, 10, 70).getMaterial());
+	EXPECT_EQ(voxel::VoxelType::Air, loadedVolume->voxel(0, 0, 0).getMaterial());
+}
+
+TEST_F(VENGIFormatTest, testLazyLoadConcurrentReaders) {
+	VENGIFormat f;
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(99, 10, 70));
+	voxel::RawVolume volume(region);
+	volume.setVoxel(99, 10, 70, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(&volume);
+	sceneGraph.emplace(core::move(node));
+	io::ArchivePtr archive = helper_archive();
+	ASSERT_TRUE(f.save(sceneGraph, "testLazyLoadConcurrentReaders.vengi", archive, testSaveCtx));
+
+	LoadContext ctx;
+	ctx.config.vengiLazyLoad = true;
+	scenegraph::SceneGraph loadedSceneGraph;
+	ASSERT_TRUE(f.load("testLazyLoadConcurrentReaders.vengi", archive, loadedSceneGraph, ctx));
+	const scenegraph::SceneGraphNode *loadedNode = loadedSceneGraph.firstModelNode();
+	ASSERT_NE(nullptr, loadedNode);
+	ASSERT_FALSE(loadedNode->isVolumeLoaded());
+	// the bricks are decoded by the first of the const readers - the others get the same volume
+	std::future<const voxel::RawVolume *> readers[4];
+	for (int i = 0; i < (int)lengthof(readers); ++i) {
+		readers[i] = std::async(std::launch::async, [loadedNode]() { return loadedNode->volume(); });
+	}
+	const voxel::RawVolume *loadedVolume = readers[0].get();
+	ASSERT_NE(nullptr, loadedVolume);
+	for (int i = 1; i < (int)lengthof(readers); ++i) {
+		EXPECT_EQ(loadedVolume, readers[i].get());
+	}
+	EXPECT_TRUE(loadedNode->isVolumeLoaded());
+	EXPECT_EQ(voxel::VoxelType::Generic, loadedVolume->voxel(99, 10, 70).getMaterial());
+}
+
+TEST_F(VENGIFormatTest, testProbe) {
+	testProbe("bat_anim.vengi");
+	testProbe("testkv6-multiple-slots.vengi");
+}
+
 } // namespace voxelformat
@@ -29,6 +29,11 @@ TEST_F(VXMFormatTest, testLoadVersion12) {
 	testLoad("test2.vxm");
 }
 
+TEST_F(VXMFormatTest, testProbe) {
+	testProbe("test.vxm");
+	testProbe("test2.vxm");
+}
+
 TEST_F(VXMFormatTest, testSaveSmallVolume) {
 	VXMFormat f;
 	testSaveSmallVolume("testSaveSmallVolume.vxm", &f);
@@ -24,6 +24,12 @@ TEST_F(VoxFormatTest, testLoad) {
 	testLoad("magicavoxel.vox");
 }
 
+TEST_F(VoxFormatTest, testProbe) {
+	testProbe("magicavoxel.vox");
+	testProbe("robo.vox");
+	testProbe("vox_character.vox");
+}
+
 TEST_F(VoxFormatTest, testLoadMaterials) {
 	VoxFormat f;
 	scenegraph::SceneGraph mvSceneGraph;
@@ -8,6 +8,7 @@
 #include "commonlua/LUAFunctions.h"
 #include "core/Color.h"
 #include "core/StringUtil.h"
+#include "core/TimeProvider.h"
 #include "core/UTF8.h"
 #include "image/Image.h"
 #include "io/FilesystemArchive.h"
@@ -35,6 +36,7 @@
 #include "voxelformat/Format.h"
 #include "voxelformat/VolumeFormat.h"
 #include "voxelgenerator/ShapeGenerator.h"
+#include "voxelutil/DistanceField.h"
 #include "voxelutil/ImageUtils.h"
 #include "voxelutil/VolumeCropper.h"
 #include "voxelutil/VolumeMover.h"
@@ -102,10 +104,18 @@ static const char *luaVoxel_globalnoise() {
 	return "__global_noise";
 }
 
+static const char *luaVoxel_globalfont() {
+	return "__global_font";
+}
+
 static const char *luaVoxel_globaldirtyregion() {
 	return "__global_region";
 }
 
+static const char *luaVoxel_globalrunstate() {
+	return "__global_runstate";
+}
+
 static const char *luaVoxel_metascenegraphnode() {
 	return "__meta_scenegraphnode";
 }
@@ -154,6 +164,10 @@ static const char *luaVoxel_metaimporter() {
 	return "__meta_importer";
 }
 
+static const char *luaVoxel_metascript() {
+	return "__meta_script";
+}
+
 static inline const char *luaVoxel_metaregion() {
 	return "__meta_region";
 }
@@ -366,6 +380,21 @@ static int luaVoxel_volumewrapper_hollow(lua_State *s) {
 	return 0;
 }
 
+static int luaVoxel_volumewrapper_erode(lua_State *s) {
+	LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
+	const int radius = (int)luaL_optinteger(s, 2, 1);
+	lua_pushinteger(s, voxelutil::erode(*volume, radius, &app::App::getInstance()->threadPool()));
+	return 1;
+}
+
+static int luaVoxel_volumewrapper_dilate(lua_State *s) {
+	LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
+	const int radius = (int)luaL_optinteger(s, 2, 1);
+	const voxel::Voxel voxel = luaVoxel_getVoxel(s, 3);
+	lua_pushinteger(s, voxelutil::dilate(*volume, radius, voxel, &app::App::getInstance()->threadPool()));
+	return 1;
+}
+
 static int luaVoxel_volumewrapper_importimageasvolume(lua_State *s) {
 	int idx = 1;
 	LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, idx++);
@@ -398,7 +427,7 @@ static int luaVoxel_volumewrapper_importheightmap(lua_State *s) {
 	const voxel::Voxel underground = luaVoxel_getVoxel(s, 3, dirt.getColor());
 	const voxel::Voxel grass = voxel::createVoxel(voxel::VoxelType::Generic, 0);
 	const voxel::Voxel surface = luaVoxel_getVoxel(s, 4, grass.getColor());
-	voxelutil::importHeightmap(*volume, image, underground, surface);
+	voxelutil::importHeightmap(*volume, image, underground, surface, 0, true, &app::App::getInstance()->threadPool());
 	return 0;
 }
 
@@ -412,7 +441,8 @@ static int luaVoxel_volumewrapper_importcoloredheightmap(lua_State *s) {
 	palette::PaletteLookup palLookup(volume->node()->palette());
 	const voxel::Voxel dirt = voxel::createVoxel(voxel::VoxelType::Generic, 0);
 	const voxel::Voxel underground = luaVoxel_getVoxel(s, 3, dirt.getColor());
-	voxelutil::importColoredHeightmap(*volume, palLookup, image, underground);
+	voxelutil::importColoredHeightmap(*volume, palLookup, image, underground, 0, true,
+									  &app::App::getInstance()->threadPool());
 	return 0;
 }
 
@@ -437,18 +467,18 @@ static int luaVoxel_volumewrapper_text(lua_State *s) {
 	const int size = (int)luaL_optinteger(s, 7, 16);
 	const int thickness = (int)luaL_optinteger(s, 8, 1);
 	const int spacing = (int)luaL_optinteger(s, 9, 0);
-	voxelfont::VoxelFont font;
-	if (!font.init(ttffont)) {
+	// the font is only loaded again if another font is used - the rasterized glyphs are reused
+	voxelfont::VoxelFont *font = luaVoxel_globalData<voxelfont::VoxelFont>(s, luaVoxel_globalfont());
+	if (!font->init(ttffont)) {
 		clua_error(s, "Could not initialize font %s", ttffont);
 	}
 	const char **str = &text;
 	glm::ivec3 pos(x, y, z);
 	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 0);
 	for (int c = core::utf8::next(str); c != -1; c = core::utf8::next(str)) {
-		pos.x += font.renderCharacter(c, size, thickness, pos, *volume, voxel);
+		pos.x += font->renderCharacter(c, size, thickness, pos, *volume, voxel);
 		pos.x += spacing;
 	}
-	font.shutdown();
 	return 0;
 }
 
@@ -463,6 +493,120 @@ static int luaVoxel_volumewrapper_setvoxel(lua_State* s) {
 	return 1;
 }
 
+/**
+ * @return The region that was given at the stack index - or the region of the volume if there is no region
+ */
+static voxel::Region luaVoxel_volumewrapper_optregion(lua_State *s, int n, const LuaRawVolumeWrapper *volume) {
+	if (lua_isnoneornil(s, n)) {
+		return volume->region();
+	}
+	return *luaVoxel_toregion(s, n);
+}
+
+static int luaVoxel_volumewrapper_fillregion(lua_State *s) {
+	LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
+	const voxel::Region region = luaVoxel_volumewrapper_optregion(s, 2, volume);
+	const voxel::Voxel voxel = luaVoxel_getVoxel(s, 3);
+	int filled = 0;
+	if (region.isValid()) {
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				filled += volume->setRow(region.getLowerX(), region.getUpperX(), y, z, voxel);
+			}
+		}
+	}
+	lua_pushinteger(s, filled);
+	return 1;
+}
+
+static int luaVoxel_volumewrapper_getregionbuffer(lua_State *s) {
+	const LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
+	const voxel::Region region = luaVoxel_volumewrapper_optregion(s, 2, volume);
+	if (!region.isValid()) {
+		return clua_error(s, "Invalid region given");
+	}
+	const voxel::RawVolume *v = volume->volume();
+	const voxel::Region &volumeRegion = v->region();
+	const int lowerX = core_max(region.getLowerX(), volumeRegion.getLowerX());
+	const int upperX = core_min(region.getUpperX(), volumeRegion.getUpperX());
+	lua_createtable(s, region.voxels(), 0);
+	lua_Integer idx = 1;
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			const bool rowInside =
+				lowerX <= upperX && volumeRegion.containsPointInY(y) && volumeRegion.containsPointInZ(z);
+			const voxel::Voxel *row = rowInside ? v->row(glm::ivec3(lowerX, y, z)) : nullptr;
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x, ++idx) {
+				if (row == nullptr || x < lowerX || x > upperX || voxel::isAir(row[x - lowerX].getMaterial())) {
+					lua_pushinteger(s, -1);
+				} else {
+					lua_pushinteger(s, row[x - lowerX].getColor());
+				}
+				lua_rawseti(s, -2, idx);
+			}
+		}
+	}
+	return 1;
+}
+
+static int luaVoxel_volumewrapper_setregionbuffer(lua_State *s) {
+	LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
+	const voxel::Region region = luaVoxel_volumewrapper_optregion(s, 2, volume);
+	luaL_checktype(s, 3, LUA_TTABLE);
+	if (!region.isValid()) {
+		return clua_error(s, "Invalid region given");
+	}
+	lua_Integer idx = 1;
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x, ++idx) {
+				lua_rawgeti(s, 3, idx);
+				int isnum = 0;
+				const lua_Integer color = lua_tointegerx(s, -1, &isnum);
+				lua_pop(s, 1);
+				if (!isnum) {
+					return clua_error(s, "Expected a color at buffer index %d", (int)idx);
+				}
+				if (color == -1) {
+					volume->setVoxel(x, y, z, voxel::Voxel());
+				} else {
+					volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (uint8_t)color));
+				}
+			}
+		}
+	}
+	return 0;
+}
+
+static int luaVoxel_volumewrapper_visit(lua_State *s) {
+	const LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
+	const voxel::Region region = luaVoxel_volumewrapper_optregion(s, 2, volume);
+	luaL_checktype(s, 3, LUA_TFUNCTION);
+	const bool skipAir = clua_optboolean(s, 4, true);
+	if (!region.isValid()) {
+		return 0;
+	}
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				// the callback might modify the volume - so don't keep pointers to the voxel data
+				const voxel::Voxel &voxel = volume->voxel(x, y, z);
+				const bool air = voxel::isAir(voxel.getMaterial());
+				if (air && skipAir) {
+					continue;
+				}
+				lua_pushvalue(s, 3);
+				lua_pushinteger(s, x);
+				lua_pushinteger(s, y);
+				lua_pushinteger(s, z);
+				lua_pushinteger(s, air ? -1 : voxel.getColor());
+				lua_call(s, 4, 0);
+			}
+		}
+	}
+	return 0;
+}
+
 static int luaVoxel_volumewrapper_gc(lua_State *s) {
 	LuaRawVolumeWrapper* volume = luaVoxel_tovolumewrapper(s, 1);
 	if (volume->dirtyRegion().isValid()) {
@@ -602,7 +746,8 @@ static int luaVoxel_import_imageasplane(lua_State *s) {
 	const image::Image* image = clua_toimage(s, 1);
 	const palette::Palette *palette = luaVoxel_toPalette(s, 2);
 	const int thickness = (int)luaL_optinteger(s, 3, 1);
-	voxel::RawVolume* v = voxelutil::importAsPlane(image, *palette, thickness);
+	const bool dither = clua_optboolean(s, 4, false);
+	voxel::RawVolume* v = voxelutil::importAsPlane(image, *palette, thickness, dither, &app::App::getInstance()->threadPool());
 	if (v == nullptr) {
 		return clua_error(s, "Failed to import image as plane");
 	}
@@ -1055,6 +1200,60 @@ static int luaVoxel_noise_worley3(lua_State* s) {
 	return 1;
 }
 
+static noise::NoiseFieldParams luaVoxel_noise_fieldparams(lua_State* s, int n) {
+	static const char *types[] = {"simplex", "fbm", "ridgedmf", "worley"};
+	static_assert(lengthof(types) == (int)noise::NoiseType::Max, "Array size doesn't match enum values");
+	noise::NoiseFieldParams params;
+	const char *type = luaL_optstring(s, n, types[(int)params.type]);
+	params.type = noise::NoiseType::Max;
+	for (int i = 0; i < lengthof(types); ++i) {
+		if (core::string::iequals(type, types[i])) {
+			params.type = (noise::NoiseType)i;
+			break;
+		}
+	}
+	if (params.type == noise::NoiseType::Max) {
+		clua_error(s, "Unknown noise type %s - expected simplex, fbm, ridgedmf or worley", type);
+	}
+	params.frequency = (float)luaL_optnumber(s, n + 1, params.frequency);
+	params.octaves = (uint8_t)luaL_optinteger(s, n + 2, params.octaves);
+	params.lacunarity = (float)luaL_optnumber(s, n + 3, params.lacunarity);
+	params.gain = (float)luaL_optnumber(s, n + 4, params.gain);
+	params.ridgeOffset = (float)luaL_optnumber(s, n + 5, params.ridgeOffset);
+	return params;
+}
+
+static void luaVoxel_noise_pushfield(lua_State* s, const core::DynamicArray<float> &field) {
+	lua_createtable(s, (int)field.size(), 0);
+	for (size_t i = 0; i < field.size(); ++i) {
+		lua_pushnumber(s, field[i]);
+		lua_rawseti(s, -2, (lua_Integer)i + 1);
+	}
+}
+
+static int luaVoxel_noise_field2(lua_State* s) {
+	noise::Noise* noise = luaVoxel_globalnoise(s);
+	const voxel::Region *region = luaVoxel_toregion(s, 1);
+	const noise::NoiseFieldParams &params = luaVoxel_noise_fieldparams(s, 2);
+	core::DynamicArray<float> field;
+	noise->fillHeightmap(glm::ivec2(region->getLowerX(), region->getLowerZ()),
+						 glm::ivec2(region->getWidthInVoxels(), region->getDepthInVoxels()), params, field,
+						 &app::App::getInstance()->threadPool());
+	luaVoxel_noise_pushfield(s, field);
+	return 1;
+}
+
+static int luaVoxel_noise_field3(lua_State* s) {
+	noise::Noise* noise = luaVoxel_globalnoise(s);
+	const voxel::Region *region = luaVoxel_toregion(s, 1);
+	const noise::NoiseFieldParams &params = luaVoxel_noise_fieldparams(s, 2);
+	core::DynamicArray<float> field;
+	noise->fillVolume(region->getLowerCorner(), region->getDimensionsInVoxels(), params, field,
+					  &app::App::getInstance()->threadPool());
+	luaVoxel_noise_pushfield(s, field);
+	return 1;
+}
+
 static int luaVoxel_region_new(lua_State* s) {
 	const int minsx = (int)luaL_checkinteger(s, 1);
 	const int minsy = (int)luaL_checkinteger(s, 2);
@@ -1302,7 +1501,7 @@ static int luaVoxel_scenegraphnode_clone(lua_State* s) {
 
 static int luaVoxel_scenegraphnode_uuid(lua_State* s) {
 	LuaSceneGraphNode* node = luaVoxel_toscenegraphnode(s, 1);
-	lua_pushstring(s, node->node->uuid().c_str());
+	lua_pushstring(s, node->node->uuid().str().c_str());
 	return 1;
 }
 
@@ -1602,6 +1801,31 @@ static int luaVoxel_scenegraphnode_gc(lua_State *s) {
 	return 0;
 }
 
+static LUAScriptRunState *luaVoxel_globalrunstate(lua_State *s) {
+	return luaVoxel_globalData<LUAScriptRunState>(s, luaVoxel_globalrunstate());
+}
+
+static int luaVoxel_script_setprogress(lua_State *s) {
+	const float progress = (float)luaL_checknumber(s, 1);
+	if (LUAScriptRunState *runState = luaVoxel_globalrunstate(s)) {
+		runState->progress = glm::clamp(progress, 0.0f, 1.0f);
+	}
+	return 0;
+}
+
+/**
+ * @brief Instruction count hook that pauses the script if the frame budget is used up
+ */
+static void luaVoxel_runstatehook(lua_State *s, lua_Debug *ar) {
+	const LUAScriptRunState *runState = luaVoxel_globalrunstate(s);
+	if (runState == nullptr || runState->yieldMillis == 0u || !lua_isyieldable(s)) {
+		return;
+	}
+	if (core::TimeProvider::systemMillis() >= runState->yieldMillis) {
+		lua_yield(s, 0);
+	}
+}
+
 static void prepareState(lua_State* s) {
 	static const luaL_Reg volumeFuncs[] = {
 		{"voxel", luaVoxel_volumewrapper_voxel},
@@ -1613,12 +1837,18 @@ static void prepareState(lua_State* s) {
 		{"text", luaVoxel_volumewrapper_text},
 		{"fillHollow", luaVoxel_volumewrapper_fillhollow},
 		{"hollow", luaVoxel_volumewrapper_hollow},
+		{"erode", luaVoxel_volumewrapper_erode},
+		{"dilate", luaVoxel_volumewrapper_dilate},
 		{"importHeightmap", luaVoxel_volumewrapper_importheightmap},
 		{"importColoredHeightmap", luaVoxel_volumewrapper_importcoloredheightmap},
 		{"importImageAsVolume", luaVoxel_volumewrapper_importimageasvolume},
 		{"mirrorAxis", luaVoxel_volumewrapper_mirroraxis},
 		{"rotateAxis", luaVoxel_volumewrapper_rotateaxis},
 		{"setVoxel", luaVoxel_volumewrapper_setvoxel},
+		{"fillRegion", luaVoxel_volumewrapper_fillregion},
+		{"getRegionBuffer", luaVoxel_volumewrapper_getregionbuffer},
+		{"setRegionBuffer", luaVoxel_volumewrapper_setregionbuffer},
+		{"visit", luaVoxel_volumewrapper_visit},
 		{"__gc", luaVoxel_volumewrapper_gc},
 		{nullptr, nullptr}
 	};
@@ -1790,6 +2020,8 @@ static void prepareState(lua_State* s) {
 		{"ridgedMF4", luaVoxel_noise_ridgedMF4},
 		{"worley2", luaVoxel_noise_worley2},
 		{"worley3", luaVoxel_noise_worley3},
+		{"field2", luaVoxel_noise_field2},
+		{"field3", luaVoxel_noise_field3},
 		{nullptr, nullptr}
 	};
 	clua_registerfuncsglobal(s, noiseFuncs, luaVoxel_metanoise(), "g_noise");
@@ -1816,6 +2048,12 @@ static void prepareState(lua_State* s) {
 	};
 	clua_registerfuncsglobal(s, importerFuncs, luaVoxel_metaimporter(), "g_import");
 
+	static const luaL_Reg scriptFuncs[] = {
+		{"setProgress", luaVoxel_script_setprogress},
+		{nullptr, nullptr}
+	};
+	clua_registerfuncsglobal(s, scriptFuncs, luaVoxel_metascript(), "g_script");
+
 	clua_imageregister(s);
 	clua_streamregister(s);
 	clua_httpregister(s);
@@ -1830,25 +2068,51 @@ bool LUAApi::init() {
 		Log::warn("Failed to initialize noise");
 	}
 	luaVoxel_newGlobalData(_lua, luaVoxel_globalnoise(), &_noise);
+	luaVoxel_newGlobalData(_lua, luaVoxel_globalfont(), &_font);
 	luaVoxel_newGlobalData(_lua, luaVoxel_globaldirtyregion(), &_dirtyRegion);
+	luaVoxel_newGlobalData(_lua, luaVoxel_globalrunstate(), &_runState);
 	prepareState(_lua);
+	// don't replace the debug hook of the lua state
+	if (lua_gethookmask(_lua) == 0) {
+		lua_sethook(_lua, luaVoxel_runstatehook, LUA_MASKCOUNT, 10000);
+	}
 	return true;
 }
 
+void LUAApi::cancel() {
+	if (_scriptStillRunning) {
+		_cancel = true;
+	}
+}
+
 ScriptState LUAApi::update(double nowSeconds) {
 	if (_scriptStillRunning) {
+		if (_cancel) {
+			// the script is suspended between two update() calls - just drop its call stack
+			lua_closethread(_lua, nullptr);
+			_cancel = false;
+			_scriptStillRunning = false;
+			_nargs = 0;
+			Log::info("Script was cancelled");
+			lua_gc(_lua, LUA_GCCOLLECT, 0);
+			return ScriptState::Cancelled;
+		}
+		if (_frameBudgetMillis > 0u) {
+			_runState.yieldMillis = core::TimeProvider::systemMillis() + _frameBudgetMillis;
+		}
 		int nres = 0;
 		const int error = lua_resume(_lua, nullptr, _nargs, &nres);
 		_nargs = 0;
+		_runState.yieldMillis = 0u;
 		if (error == LUA_OK) {
 			_scriptStillRunning = false;
 			lua_gc(_lua, LUA_GCCOLLECT, 0);
 			return ScriptState::Finished;
 		} else if (error != LUA_YIELD) {
+			_scriptStillRunning = false;
 			const char *msg = lua_tostring(_lua, -1);
 			luaL_traceback(_lua, _lua, msg, 1);
 			Log::error("Error running script: %s", lua_tostring(_lua, -1));
-			_scriptStillRunning = false;
 			lua_gc(_lua, LUA_GCCOLLECT, 0);
 			return ScriptState::Error;
 		}
@@ -1858,16 +2122,63 @@ ScriptState LUAApi::update(double nowSeconds) {
 }
 
 void LUAApi::shutdown() {
+	_bytecodeCache.clear();
+	_argumentInfoCache.clear();
+	_validScriptCache.clear();
 	lua_gc(_lua, LUA_GCCOLLECT, 0);
 	_noise.shutdown();
+	_font.shutdown();
 	_lua.resetState();
 }
 
-bool LUAApi::argumentInfo(const core::String& luaScript, core::DynamicArray<LUAParameterDescription>& params) {
+static int luaVoxel_bytecodewriter(lua_State *s, const void *p, size_t size, void *userData) {
+	core::Buffer<uint8_t> *bytecode = (core::Buffer<uint8_t> *)userData;
+	bytecode->append((const uint8_t *)p, size);
+	return 0;
+}
+
+bool LUAApi::loadScript(lua_State *s, const core::String &luaScript) {
+	auto iter = _bytecodeCache.find(luaScript);
+	if (iter != _bytecodeCache.end()) {
+		const core::Buffer<uint8_t> &bytecode = iter->value;
+		if (luaL_loadbufferx(s, (const char *)bytecode.data(), bytecode.size(), "script", "b") == LUA_OK) {
+			return true;
+		}
+		Log::warn("Failed to load the cached bytecode: %s", lua_tostring(s, -1));
+		lua_pop(s, 1);
+	}
+	// use the source as chunk name like luaL_dostring() does - the error messages are the same then
+	if (luaL_loadbufferx(s, luaScript.c_str(), luaScript.size(), luaScript.c_str(), "t") != LUA_OK) {
+		return false;
+	}
+	// keep the debug information - otherwise the error messages wouldn't contain line numbers
+	core::Buffer<uint8_t> bytecode;
+	if (lua_dump(s, luaVoxel_bytecodewriter, &bytecode, 0) == 0) {
+		_bytecodeCache.put(luaScript, bytecode);
+	}
+	return true;
+}
+
+bool LUAApi::argumentInfo(const core::String &luaScript, core::DynamicArray<LUAParameterDescription> &params) {
+	auto iter = _argumentInfoCache.find(luaScript);
+	if (iter != _argumentInfoCache.end()) {
+		params.append(iter->value);
+		return true;
+	}
+	core::DynamicArray<LUAParameterDescription> parsed;
+	if (!parseArgumentInfo(luaScript, parsed)) {
+		return false;
+	}
+	_argumentInfoCache.put(luaScript, parsed);
+	params.append(parsed);
+	return true;
+}
+
+bool LUAApi::parseArgumentInfo(const core::String& luaScript, core::DynamicArray<LUAParameterDescription>& params) {
 	lua::LUA lua;
 
 	// load and run once to initialize the global variables
-	if (luaL_dostring(lua, luaScript.c_str())) {
+	if (!loadScript(lua, luaScript) || lua_pcall(lua, 0, LUA_MULTRET, 0)) {
 		Log::error("%s", lua_tostring(lua, -1));
 		return false;
 	}
@@ -2050,19 +2361,24 @@ core::DynamicArray<LUAScript> LUAApi::listScripts() const {
 	scripts.reserve(entities.size());
 	for (const auto& e : entities) {
 		const core::String path = core::string::path("scripts", e.name);
-		lua::LUA lua;
-		if (!lua.load(_filesystem->load(path))) {
-			Log::warn("Failed to load %s", path.c_str());
-			scripts.push_back({e.name, false});
+		const core::String &luaScript = _filesystem->load(path);
+		bool valid = false;
+		if (_validScriptCache.get(luaScript, valid)) {
+			scripts.push_back({e.name, valid});
 			continue;
 		}
-		lua_getglobal(lua, "main");
-		if (!lua_isfunction(lua, -1)) {
-			Log::debug("No main() function found in %s", path.c_str());
-			scripts.push_back({e.name, false});
-			continue;
+		lua::LUA lua;
+		if (!lua.load(luaScript)) {
+			Log::warn("Failed to load %s", path.c_str());
+		} else {
+			lua_getglobal(lua, "main");
+			valid = lua_isfunction(lua, -1);
+			if (!valid) {
+				Log::debug("No main() function found in %s", path.c_str());
+			}
 		}
-		scripts.push_back({e.name, true});
+		_validScriptCache.put(luaScript, valid);
+		scripts.push_back({e.name, valid});
 	}
 	return scripts;
 }
@@ -2076,6 +2392,8 @@ bool LUAApi::exec(const core::String &luaScript, scenegraph::SceneGraph &sceneGr
 	}
 
 	_dirtyRegion = voxel::Region::InvalidRegion;
+	_runState = LUAScriptRunState();
+	_cancel = false;
 
 	_argsInfo.clear();
 	if (!argumentInfo(luaScript, _argsInfo)) {
@@ -2105,7 +2423,7 @@ bool LUAApi::exec(const core::String &luaScript, scenegraph::SceneGraph &sceneGr
 	lua_setglobal(s, luaVoxel_globalnodeid());
 
 	// load and run once to initialize the global variables
-	if (luaL_dostring(s, luaScript.c_str())) {
+	if (!loadScript(s, luaScript) || lua_pcall(s, 0, LUA_MULTRET, 0)) {
 		Log::error("%s", lua_tostring(s, -1));
 		return false;
 	}
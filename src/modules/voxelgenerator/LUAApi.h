@@ -8,10 +8,13 @@
 #include "commonlua/LUA.h"
 #include "core/IComponent.h"
 #include "core/String.h"
+#include "core/collection/Buffer.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/StringMap.h"
 #include "io/Filesystem.h"
 #include "noise/Noise.h"
 #include "voxel/Region.h"
+#include "voxelfont/VoxelFont.h"
 
 struct lua_State;
 
@@ -70,17 +73,45 @@ struct LUAScript {
 	}
 };
 
-enum class ScriptState { Running, Finished, Inactive, Error };
+enum class ScriptState { Running, Finished, Inactive, Error, Cancelled };
+
+/**
+ * @brief The state of a running script that is shared with the lua instruction hook
+ */
+struct LUAScriptRunState {
+	/** the system millis at which the script yields back to the caller of @c LUAApi::update() - @c 0 to never yield */
+	uint64_t yieldMillis = 0u;
+	/** set by the script via @c g_script.setProgress() - negative if the script didn't report any progress */
+	float progress = -1.0f;
+};
 
 class LUAApi : public core::IComponent {
 private:
 	noise::Noise _noise;
+	// kept between the script runs to reuse the rasterized glyphs
+	voxelfont::VoxelFont _font;
 	io::FilesystemPtr _filesystem;
 	lua::LUA _lua;
 	core::DynamicArray<LUAParameterDescription> _argsInfo;
 	voxel::Region _dirtyRegion = voxel::Region::InvalidRegion;
 	bool _scriptStillRunning = false;
 	int _nargs = 0;
+	LUAScriptRunState _runState;
+	bool _cancel = false;
+	uint64_t _frameBudgetMillis = 0u;
+	// the compiled scripts and their arguments - keyed by the script source
+	core::StringMap<core::Buffer<uint8_t>> _bytecodeCache;
+	core::StringMap<core::DynamicArray<LUAParameterDescription>> _argumentInfoCache;
+	mutable core::StringMap<bool> _validScriptCache;
+
+	/**
+	 * @brief Pushes the compiled chunk of the given script source onto the stack of the given state
+	 *
+	 * The bytecode of the script is cached - loading the same script again doesn't compile it again.
+	 * @return @c false if the script couldn't get compiled - the error message is pushed onto the stack then
+	 */
+	bool loadScript(lua_State *s, const core::String &luaScript);
+	bool parseArgumentInfo(const core::String &luaScript, core::DynamicArray<LUAParameterDescription> &params);
 
 public:
 	LUAApi(const io::FilesystemPtr &filesystem);
@@ -94,10 +125,39 @@ public:
 		return _scriptStillRunning;
 	}
 
+	/**
+	 * @brief Limits the time a script may run in one @c update() call
+	 *
+	 * The script is paused after the given amount of milliseconds and continued in the next @c update() call - even if
+	 * the script never calls @c coroutine.yield(). This keeps the caller responsive while long running scripts are
+	 * executed. @c 0 runs the script until it finishes or yields on its own.
+	 */
+	void setFrameBudget(uint64_t millis) {
+		_frameBudgetMillis = millis;
+	}
+
+	/**
+	 * @brief Aborts the running script - the next @c update() call returns @c ScriptState::Cancelled
+	 * @note The modifications the script already did are not reverted
+	 */
+	void cancel();
+
+	/**
+	 * @return The progress in the range @c [0,1] that the running script reported or a negative value if the script
+	 * didn't report any progress
+	 */
+	float progress() const {
+		return _runState.progress;
+	}
+
 	const core::String &error() const;
 
 	core::String load(const core::String &scriptName) const;
 	core::DynamicArray<LUAScript> listScripts() const;
+	/**
+	 * @brief Executes the @c arguments() function of the script to get the parameter descriptions
+	 * @note The result is cached for the script source
+	 */
 	bool argumentInfo(const core::String &luaScript, core::DynamicArray<LUAParameterDescription> &params);
 	/**
 	 * @note The real execution happens in the @c update() method
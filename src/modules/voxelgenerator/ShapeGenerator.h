@@ -4,7 +4,6 @@
 
 #pragma once
 
-#include "core/collection/Vector.h"
 #include "voxel/Voxel.h"
 #include "core/Common.h"
 #include "math/Bezier.h"
@@ -33,62 +32,89 @@ template<class Volume, class VoxelType>
 void createCirclePlane(Volume& volume, const glm::ivec3& center, math::Axis axis, int width, int depth, double radius, const VoxelType& voxel) {
 	const double xRadius = width / 2.0;
 	const double zRadius = depth / 2.0;
+	const double radiusSquared = radius * radius;
 
 	for (double z = -zRadius; z <= zRadius; ++z) {
 		const double distanceZ = glm::pow(z, 2.0);
-		for (double x = -xRadius; x <= xRadius; ++x) {
-			const double distance = glm::sqrt(glm::pow(x, 2.0) + distanceZ);
-			if (distance > radius) {
-				continue;
-			}
-			if (axis == math::Axis::X) {
+		// the x values are -xRadius + i for i in [0, width] - the ones inside the circle are one contiguous span
+		auto inside = [&](int i) {
+			const double x = -xRadius + i;
+			return glm::sqrt(glm::pow(x, 2.0) + distanceZ) <= radius;
+		};
+		const int centerIdx = width / 2;
+		if (!inside(centerIdx)) {
+			continue;
+		}
+		// estimate the span analytically and fix the rounding with the exact test
+		const double extent = glm::sqrt(core_max(radiusSquared - distanceZ, 0.0));
+		int lower = core_min(core_max((int)glm::ceil(xRadius - extent), 0), centerIdx);
+		int upper = core_max(core_min((int)glm::floor(xRadius + extent), width), centerIdx);
+		while (lower > 0 && inside(lower - 1)) {
+			--lower;
+		}
+		while (!inside(lower)) {
+			++lower;
+		}
+		while (upper < width && inside(upper + 1)) {
+			++upper;
+		}
+		while (!inside(upper)) {
+			--upper;
+		}
+		const double xLower = -xRadius + lower;
+		const double xUpper = -xRadius + upper;
+		if (axis == math::Axis::X) {
+			for (double x = xLower; x <= xUpper; ++x) {
 				volume.setVoxel(center.x, center.y + x, center.z + z, voxel);
-			} else if (axis == math::Axis::Y) {
-				volume.setVoxel(center.x + x, center.y, center.z + z, voxel);
-			} else {
-				volume.setVoxel(center.x + x, center.y + z, center.z, voxel);
 			}
+		} else if (axis == math::Axis::Y) {
+			volume.setRow((int)(center.x + xLower), (int)(center.x + xUpper), center.y, (int)(center.z + z), voxel);
+		} else {
+			volume.setRow((int)(center.x + xLower), (int)(center.x + xUpper), (int)(center.y + z), center.z, voxel);
 		}
 	}
 }
 
 /**
- * @brief Creates a cube with the given position being the center of the cube
+ * @brief Creates a cube with the ground surface starting exactly on the given y coordinate, x and z are the lower left
+ * corner here.
  * @param[in,out] volume The volume (RawVolume) to place the voxels into
- * @param[in] center The position to place the object at
+ * @param[in] pos The position to place the object at (lower left corner)
  * @param[in] width The width (x-axis) of the object
  * @param[in] height The height (y-axis) of the object
  * @param[in] depth The height (z-axis) of the object
  * @param[in] voxel The Voxel to build the object with
- * @sa createCubeNoCenter()
+ * @sa createCube()
  */
 template<class Volume, class VoxelType>
-void createCube(Volume& volume, const glm::ivec3& center, int width, int height, int depth, const VoxelType& voxel) {
-	const int heightLow = height / 2;
-	const int widthLow = width / 2;
-	const int depthLow = depth / 2;
-	core::Vector<voxel::Voxel, MAX_HEIGHT> voxels;
-	voxels.assign(voxel, height);
-	volume.setVoxels(center.x - widthLow, center.y - heightLow, center.z - depthLow,
-			width, depth, &voxels.front(), height);
+void createCubeNoCenter(Volume& volume, const glm::ivec3& pos, int width, int height, int depth, const VoxelType& voxel) {
+	if (width <= 0) {
+		return;
+	}
+	for (int z = pos.z; z < pos.z + depth; ++z) {
+		for (int y = pos.y; y < pos.y + height; ++y) {
+			volume.setRow(pos.x, pos.x + width - 1, y, z, voxel);
+		}
+	}
 }
 
 /**
- * @brief Creates a cube with the ground surface starting exactly on the given y coordinate, x and z are the lower left
- * corner here.
+ * @brief Creates a cube with the given position being the center of the cube
  * @param[in,out] volume The volume (RawVolume) to place the voxels into
- * @param[in] pos The position to place the object at (lower left corner)
+ * @param[in] center The position to place the object at
  * @param[in] width The width (x-axis) of the object
  * @param[in] height The height (y-axis) of the object
  * @param[in] depth The height (z-axis) of the object
  * @param[in] voxel The Voxel to build the object with
- * @sa createCube()
+ * @sa createCubeNoCenter()
  */
 template<class Volume, class VoxelType>
-void createCubeNoCenter(Volume& volume, const glm::ivec3& pos, int width, int height, int depth, const VoxelType& voxel) {
-	core::Vector<voxel::Voxel, MAX_HEIGHT> voxels;
-	voxels.assign(voxel, height);
-	volume.setVoxels(pos.x, pos.y, pos.z, width, depth, &voxels.front(), height);
+void createCube(Volume& volume, const glm::ivec3& center, int width, int height, int depth, const VoxelType& voxel) {
+	const int heightLow = height / 2;
+	const int widthLow = width / 2;
+	const int depthLow = depth / 2;
+	createCubeNoCenter(volume, glm::ivec3(center.x - widthLow, center.y - heightLow, center.z - depthLow), width, height,
+					   depth, voxel);
 }
 
 template<class Volume, class VoxelType>
@@ -5,6 +5,7 @@
 #include "SpaceColonization.h"
 #include "core/Common.h"
 #include "core/Log.h"
+#include <float.h>
 
 namespace voxelgenerator {
 namespace tree {
@@ -31,9 +32,9 @@ SpaceColonization::SpaceColonization(const glm::ivec3& position, int branchLengt
 		_position(position), _attractionPointCount(attractionPointCount), _attractionPointWidth(attractionPointWidth),
 		_attractionPointDepth(attractionPointDepth), _attractionPointHeight(attractionPointHeight),
 		_minDistance2(minDistance * minDistance), _maxDistance2(maxDistance * maxDistance),
-		_branchLength(branchLength), _branchSize(branchSize), _random(seed) {
+		_branchLength(branchLength), _branchSize(branchSize), _random(seed), _cellSize((float)core_max(1, maxDistance)) {
 	_root = new Branch(nullptr, _position, glm::up(), _branchSize);
-	_branches.put(_root->_position, _root);
+	addBranch(_root);
 
 	fillAttractionPoints();
 }
@@ -44,9 +45,73 @@ SpaceColonization::~SpaceColonization() {
 	}
 	_root = nullptr;
 	_branches.clear();
+	_cellIndices.clear();
+	_cells.clear();
 	_attractionPoints.clear();
 }
 
+void SpaceColonization::addBranch(Branch* branch) {
+	_branches.put(branch->_position, branch);
+	const glm::ivec3& c = cell(branch->_position);
+	int idx;
+	if (!_cellIndices.get(c, idx)) {
+		idx = (int)_cells.size();
+		_cells.emplace_back();
+		_cellIndices.put(c, idx);
+		if (idx == 0) {
+			_cellMins = _cellMaxs = c;
+		} else {
+			_cellMins = glm::min(_cellMins, c);
+			_cellMaxs = glm::max(_cellMaxs, c);
+		}
+	}
+	_cells[idx].push_back(branch);
+}
+
+Branch* SpaceColonization::findClosestBranch(const glm::vec3& position, float& distance2) const {
+	Branch* closest = nullptr;
+	distance2 = FLT_MAX;
+	if (_cells.empty()) {
+		return nullptr;
+	}
+	const glm::ivec3& center = cell(position);
+	const glm::ivec3& maxRings = glm::max(glm::abs(center - _cellMins), glm::abs(_cellMaxs - center));
+	const int maxRing = core_max(maxRings.x, core_max(maxRings.y, maxRings.z));
+	// search the cells ring by ring around the cell of the position - the branches of the cells in ring n+1 are at
+	// least n cells away, so we can stop as soon as we found a branch that is nearer
+	for (int ring = 0; ring <= maxRing; ++ring) {
+		const glm::ivec3& mins = glm::max(center - ring, _cellMins);
+		const glm::ivec3& maxs = glm::min(center + ring, _cellMaxs);
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					const glm::ivec3 c(x, y, z);
+					const glm::ivec3& d = glm::abs(c - center);
+					if (core_max(d.x, core_max(d.y, d.z)) != ring) {
+						continue;
+					}
+					int idx;
+					if (!_cellIndices.get(c, idx)) {
+						continue;
+					}
+					for (Branch* branch : _cells[idx]) {
+						const float length2 = glm::distance2(branch->_position, position);
+						if (length2 < distance2) {
+							distance2 = length2;
+							closest = branch;
+						}
+					}
+				}
+			}
+		}
+		const float searched = (float)ring * _cellSize;
+		if (closest != nullptr && distance2 <= searched * searched) {
+			break;
+		}
+	}
+	return closest;
+}
+
 void SpaceColonization::fillAttractionPoints() {
 	const float radius = core_max(_attractionPointHeight, core_max(_attractionPointDepth, _attractionPointWidth)) / 2.0f;
 	const glm::ivec3 mins(_position.x - (_attractionPointWidth / 2), _position.y, _position.z - (_attractionPointDepth / 2));
@@ -93,33 +158,15 @@ bool SpaceColonization::step() {
 
 	// process the attraction points
 	for (auto pi = _attractionPoints.begin(); pi != _attractionPoints.end();) {
-		bool attractionPointRemoved = false;
 		AttractionPoint& attractionPoint = *pi;
 
-		attractionPoint._closestBranch = nullptr;
-
 		// Find the nearest branch for this attraction point
-		for (auto bi = _branches.begin(); bi != _branches.end(); ++bi) {
-			Branch* branch = bi->second;
-			const float length2 = (float) glm::round(glm::distance2(branch->_position, attractionPoint._position));
-
-			// Min attraction point distance reached, we remove it
-			if (attractionPoint._closestBranch == nullptr) {
-				attractionPoint._closestBranch = branch;
-			} else if (length2 <= _minDistance2) {
-				pi = _attractionPoints.erase(pi);
-				attractionPointRemoved = true;
-				break;
-			} else if (length2 <= _maxDistance2) {
-				// branch in range, determine if it is the nearest
-				if (glm::distance2(attractionPoint._closestBranch->_position, attractionPoint._position) > length2) {
-					attractionPoint._closestBranch = branch;
-				}
-			}
-		}
+		float length2;
+		attractionPoint._closestBranch = findClosestBranch(attractionPoint._position, length2);
 
-		// if the attraction point was removed, skip
-		if (attractionPointRemoved) {
+		// Min attraction point distance reached, we remove it
+		if (attractionPoint._closestBranch != nullptr && glm::round(length2) <= (float)_minDistance2) {
+			pi = _attractionPoints.erase(pi);
 			continue;
 		}
 
@@ -174,7 +221,7 @@ bool SpaceColonization::step() {
 			delete branch;
 			continue;
 		}
-		_branches.put(branch->_position, branch);
+		addBranch(branch);
 		branchAdded = true;
 	}
 	newBranches.clear();
@@ -9,6 +9,7 @@
 #include "core/Log.h"
 #include "core/GLM.h"
 #include "core/collection/Map.h"
+#include "core/collection/FlatMap.h"
 #include "core/collection/DynamicArray.h"
 #include <glm/gtc/epsilon.hpp>
 #ifndef GLM_ENABLE_EXPERIMENTAL
@@ -76,6 +77,31 @@ protected:
 	Branches _branches;
 	math::Random _random;
 
+	/**
+	 * Uniform grid with a cell size of the max attraction distance - the nearest branch lookup of an attraction point
+	 * only has to check the branches of the neighbouring cells instead of all branches
+	 */
+	float _cellSize;
+	core::FlatMap<glm::ivec3, int, glm::hash<glm::ivec3>> _cellIndices;
+	std::vector<std::vector<Branch*>> _cells;
+	glm::ivec3 _cellMins{0};
+	glm::ivec3 _cellMaxs{0};
+
+	inline glm::ivec3 cell(const glm::vec3& position) const {
+		return glm::ivec3(glm::floor(position / _cellSize));
+	}
+
+	/**
+	 * @brief Adds the branch to the branches map and the lookup grid
+	 */
+	void addBranch(Branch* branch);
+
+	/**
+	 * @return The branch that is nearest to the given attraction point or @c nullptr if there are no branches
+	 * @param[out] distance2 The squared distance of the returned branch
+	 */
+	Branch* findClosestBranch(const glm::vec3& position, float& distance2) const;
+
 	/**
 	 * Generate the attraction points for the crown
 	 */
@@ -0,0 +1,152 @@
+/**
+ * @file
+ */
+
+#include "TileGenerator.h"
+#include "core/Common.h"
+#include "core/Hash.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Parallel.h"
+#include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
+#include "voxel/Voxel.h"
+#include <glm/common.hpp>
+
+namespace voxelgenerator {
+
+namespace priv {
+
+/**
+ * @brief A solid voxel that a tile generated into its margin
+ */
+struct MarginVoxel {
+	glm::ivec3 pos;
+	voxel::Voxel voxel;
+};
+
+static inline int floorDiv(int value, int divisor) {
+	return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+static inline glm::ivec3 floorDiv(const glm::ivec3 &value, const glm::ivec3 &divisor) {
+	return glm::ivec3(floorDiv(value.x, divisor.x), floorDiv(value.y, divisor.y), floorDiv(value.z, divisor.z));
+}
+
+/**
+ * @brief Collects the solid voxels the tile generated outside of its own region
+ */
+static void collectMargin(const Tile &tile, const voxel::RawVolume &tileVolume,
+						  core::DynamicArray<MarginVoxel> &margin) {
+	const voxel::Region &region = tile.generationRegion;
+	const int width = region.getWidthInVoxels();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			const glm::ivec3 start(region.getLowerX(), y, z);
+			const voxel::Voxel *voxels = tileVolume.row(start);
+			const bool insideRow = tile.region.containsPointInY(y) && tile.region.containsPointInZ(z);
+			for (int i = 0; i < width; ++i) {
+				if (voxel::isAir(voxels[i].getMaterial())) {
+					continue;
+				}
+				const int x = start.x + i;
+				if (insideRow && tile.region.containsPointInX(x)) {
+					continue;
+				}
+				margin.push_back({glm::ivec3(x, y, z), voxels[i]});
+			}
+		}
+	}
+}
+
+/**
+ * @brief Writes the solid voxels of the tile region into the target volume
+ */
+static void copyTileRegion(const Tile &tile, const voxel::RawVolume &tileVolume, voxel::RawVolumeWrapper &volume) {
+	const voxel::Region &region = tile.region;
+	const int width = region.getWidthInVoxels();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			const glm::ivec3 start(region.getLowerX(), y, z);
+			const voxel::Voxel *voxels = tileVolume.row(start);
+			for (int i = 0; i < width; ++i) {
+				if (!voxel::isAir(voxels[i].getMaterial())) {
+					volume.setVoxel(start.x + i, y, z, voxels[i]);
+				}
+			}
+		}
+	}
+}
+
+} // namespace priv
+
+uint32_t tileSeed(uint32_t seed, const glm::ivec3 &coord) {
+	const int32_t key[3] = {coord.x, coord.y, coord.z};
+	return core::hash(key, (int)sizeof(key), seed);
+}
+
+void generateTiles(voxel::RawVolumeWrapper &volume, const glm::ivec3 &tileSize, int margin, uint32_t seed,
+				   const TileGeneratorFunc &func, core::ThreadPool *threadPool) {
+	core_trace_scoped(GenerateTiles);
+	const voxel::Region &region = volume.region();
+	if (!region.isValid()) {
+		return;
+	}
+	const glm::ivec3 size = glm::max(tileSize, glm::ivec3(1));
+	margin = core_max(0, margin);
+	const glm::ivec3 firstTile = priv::floorDiv(region.getLowerCorner(), size);
+	const glm::ivec3 lastTile = priv::floorDiv(region.getUpperCorner(), size);
+
+	core::DynamicArray<Tile> tiles;
+	for (int z = firstTile.z; z <= lastTile.z; ++z) {
+		for (int y = firstTile.y; y <= lastTile.y; ++y) {
+			for (int x = firstTile.x; x <= lastTile.x; ++x) {
+				Tile tile;
+				tile.coord = glm::ivec3(x, y, z);
+				const glm::ivec3 mins = tile.coord * size;
+				tile.region = voxel::Region(mins, mins + size - 1);
+				tile.region.cropTo(region);
+				tile.generationRegion =
+					voxel::Region(tile.region.getLowerCorner() - margin, tile.region.getUpperCorner() + margin);
+				tile.generationRegion.cropTo(region);
+				tile.seed = tileSeed(seed, tile.coord);
+				tiles.push_back(tile);
+			}
+		}
+	}
+
+	const int n = (int)tiles.size();
+	core::DynamicArray<core::DynamicArray<priv::MarginVoxel>> margins;
+	margins.resize(n);
+	// only a few tile volumes exist at the same time - the tile regions are written in between
+	const int batchSize = core_min(n, core::parallelSliceCount(threadPool, n) * 2);
+	core::DynamicArray<voxel::RawVolume *> tileVolumes;
+	tileVolumes.resize(batchSize);
+	for (int first = 0; first < n; first += batchSize) {
+		const int count = core_min(batchSize, n - first);
+		core::parallelSlices(threadPool, count, [&](int slice) {
+			const Tile &tile = tiles[first + slice];
+			voxel::RawVolume *tileVolume = new voxel::RawVolume(tile.generationRegion);
+			voxel::RawVolumeWrapper wrapper(tileVolume);
+			math::Random random(tile.seed);
+			func(tile, random, wrapper);
+			priv::collectMargin(tile, *tileVolume, margins[first + slice]);
+			tileVolumes[slice] = tileVolume;
+		});
+		for (int i = 0; i < count; ++i) {
+			priv::copyTileRegion(tiles[first + i], *tileVolumes[i], volume);
+			delete tileVolumes[i];
+			tileVolumes[i] = nullptr;
+		}
+	}
+
+	for (const core::DynamicArray<priv::MarginVoxel> &tileMargin : margins) {
+		for (const priv::MarginVoxel &entry : tileMargin) {
+			if (voxel::isAir(volume.voxel(entry.pos).getMaterial())) {
+				volume.setVoxel(entry.pos, entry.voxel);
+			}
+		}
+	}
+}
+
+} // namespace voxelgenerator
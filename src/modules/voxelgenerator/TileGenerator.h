@@ -0,0 +1,70 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "math/Random.h"
+#include "voxel/Region.h"
+#include <functional>
+#include <glm/vec3.hpp>
+#include <stdint.h>
+
+namespace core {
+class ThreadPool;
+}
+
+namespace voxel {
+class RawVolumeWrapper;
+}
+
+namespace voxelgenerator {
+
+/**
+ * @brief One tile of a region that is generated with @c generateTiles()
+ */
+struct Tile {
+	/** the lower corner of the tile (without the margin) divided by the tile size */
+	glm::ivec3 coord{0};
+	/** the part of the region the tile is responsible for */
+	voxel::Region region;
+	/** @c region with the overlap margin - cropped to the generated region */
+	voxel::Region generationRegion;
+	/** derived from the seed of the generation and the tile coordinate - see @c tileSeed() */
+	uint32_t seed = 0u;
+};
+
+/**
+ * @brief Generates the content of one tile into a volume of the size of @c Tile::generationRegion
+ *
+ * Voxels outside of the generation region are ignored by the volume wrapper. The given random number generator is seeded with @c Tile::seed. The function is called from several threads at
+ * once - it must not touch any shared state that isn't read only.
+ */
+using TileGeneratorFunc =
+	std::function<void(const Tile &tile, math::Random &random, voxel::RawVolumeWrapper &volume)>;
+
+/**
+ * @return The seed for the tile at the given tile coordinate - the same for every run and every tile size
+ */
+uint32_t tileSeed(uint32_t seed, const glm::ivec3 &coord);
+
+/**
+ * @brief Splits the region of the volume into tiles and generates them in parallel
+ *
+ * The tiles are aligned to multiples of the tile size in volume coordinates - so the same position always belongs to
+ * the same tile and gets the same seed, no matter which region is generated. Every tile is generated into its own
+ * volume and its own random number generator - the result doesn't depend on the amount of threads or on the order in
+ * which the tiles are finished.
+ *
+ * Features like trees that are anchored in a tile may grow up to @c margin voxels into the neighbouring tiles: the
+ * solid voxels of the tile region are written into the target volume, the solid voxels in the margin are added in
+ * the order of the tiles afterwards - but only where the neighbouring tiles left air. So continuous content like
+ * terrain should only be generated for @c Tile::region and the margin is only used for features that cross the seam.
+ *
+ * @note The results are reproducible with the same build - @c math::Random uses the random engine of the standard
+ * library which is not the same on all platforms.
+ */
+void generateTiles(voxel::RawVolumeWrapper &volume, const glm::ivec3 &tileSize, int margin, uint32_t seed,
+				   const TileGeneratorFunc &func, core::ThreadPool *threadPool = nullptr);
+
+} // namespace voxelgenerator
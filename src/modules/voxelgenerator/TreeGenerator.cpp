@@ -14,18 +14,18 @@ Tree::Tree(const glm::ivec3& position, int trunkHeight, int branchLength,
 			_trunkHeight(trunkHeight), _trunkSizeFactor(trunkSizeFactor) {
 	_root->_position.y -= (float)trunkHeight;
 	_position.y -= (float)trunkHeight;
-	generateBranches(_branches, glm::up(), (float)_trunkHeight, (float)_branchLength);
+	generateBranches(glm::up(), (float)_trunkHeight, (float)_branchLength);
 }
 
 // TODO: use the PoolAllocator here
-void Tree::generateBranches(Branches& branches, const glm::vec3& direction, float maxSize, float branchLength) const {
+void Tree::generateBranches(const glm::vec3& direction, float maxSize, float branchLength) {
 	float branchSize = _branchSize;
 	const float deviation = 0.5f;
 	const float random1 = _random.randomBinomial(deviation);
 	const glm::vec3 d1 = direction + random1;
 	const glm::vec3& branchPos1 = _position + d1 * branchLength;
 	Branch* current = new Branch(_root, branchPos1, d1, branchSize);
-	branches.put(current->_position, current);
+	addBranch(current);
 
 	// grow until the max distance between root and branch is reached
 	const float size2 = maxSize * maxSize;
@@ -34,7 +34,7 @@ void Tree::generateBranches(Branches& branches, const glm::vec3& direction, floa
 		const glm::vec3 d2 = direction + random2;
 		const glm::vec3& branchPos2 = current->_position + d2 * branchLength;
 		Branch *branch = new Branch(current, branchPos2, d2, branchSize);
-		branches.put(branch->_position, branch);
+		addBranch(branch);
 		current = branch;
 		branchSize *= _trunkSizeFactor;
 		branchLength *= _branchSizeFactor;
@@ -6,11 +6,15 @@
 
 #include "math/Random.h"
 #include "TreeContext.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Parallel.h"
 #include "Spiral.h"
 #include "ShapeGenerator.h"
 #include "SpaceColonization.h"
 #include "voxel/MaterialColor.h"
 #include "palette/Palette.h"
+#include "voxel/SparseVolume.h"
 #include "voxel/Voxel.h"
 
 namespace voxelgenerator {
@@ -27,7 +31,7 @@ private:
 	const int _trunkHeight;
 	const float _trunkSizeFactor;
 
-	void generateBranches(Branches& branches, const glm::vec3& direction, float maxSize, float branchLength) const;
+	void generateBranches(const glm::vec3& direction, float maxSize, float branchLength);
 
 public:
 	/**
@@ -342,12 +346,7 @@ void createSpaceColonizationTree(Volume& volume, const voxelgenerator::TreeSpace
  * @brief Delegates to the corresponding create method for the given TreeType in the TreeContext
  */
 template<class Volume>
-void createTree(Volume& volume, const voxelgenerator::TreeContext& ctx, math::Random& random) {
-	const palette::Palette &palette = voxel::getPalette();
-	const uint8_t green = palette.getClosestMatch(core::RGBA(123, 162, 63));
-	const uint8_t brown = palette.getClosestMatch(core::RGBA(143, 90, 60));
-	const voxel::Voxel trunkVoxel = voxel::createVoxel(palette, brown);
-	const voxel::Voxel leavesVoxel = voxel::createVoxel(palette, green);
+void createTree(Volume& volume, const voxelgenerator::TreeContext& ctx, math::Random& random, const voxel::Voxel &trunkVoxel, const voxel::Voxel &leavesVoxel) {
 	if (ctx.cfg.type == TreeType::BranchesEllipsis) {
 		createTreeBranchEllipsis(volume, ctx.branchellipsis, random, trunkVoxel, leavesVoxel);
 	} else if (ctx.cfg.type == TreeType::Ellipsis) {
@@ -373,5 +372,77 @@ void createTree(Volume& volume, const voxelgenerator::TreeContext& ctx, math::Ra
 	}
 }
 
+inline voxel::Voxel trunkVoxel() {
+	const palette::Palette &palette = voxel::getPalette();
+	return voxel::createVoxel(palette, palette.getClosestMatch(core::RGBA(143, 90, 60)));
+}
+
+inline voxel::Voxel leavesVoxel() {
+	const palette::Palette &palette = voxel::getPalette();
+	return voxel::createVoxel(palette, palette.getClosestMatch(core::RGBA(123, 162, 63)));
+}
+
+/**
+ * @brief Creates the tree with the trunk and leaves colors of the global palette
+ */
+template<class Volume>
+void createTree(Volume& volume, const voxelgenerator::TreeContext& ctx, math::Random& random) {
+	createTree(volume, ctx, random, trunkVoxel(), leavesVoxel());
+}
+
+namespace priv {
+
+/**
+ * @brief The private volume a tree of a forest is generated into
+ */
+class TreeVolume : public voxel::SparseVolume {
+public:
+	TreeVolume(const voxel::Region &limitRegion) : voxel::SparseVolume(limitRegion) {
+	}
+
+	// the line rasterization of the shape generator expects a volume pointer
+	inline operator voxel::SparseVolume *() {
+		return this;
+	}
+};
+
+} // namespace priv
+
+/**
+ * @brief Creates all the given trees - every tree is seeded with its @c TreeConfig::seed
+ *
+ * The trees are generated in parallel into their own sparse volumes if a thread pool is given. Those are merged into
+ * the target volume in the order of the given trees afterwards - so the result is the same as creating the trees one
+ * after another.
+ */
+template<class Volume>
+void createForest(Volume& volume, const core::DynamicArray<voxelgenerator::TreeContext>& trees, core::ThreadPool* threadPool = nullptr) {
+	core_trace_scoped(CreateForest);
+	const int n = (int)trees.size();
+	if (n == 0) {
+		return;
+	}
+	const voxel::Voxel trunk = trunkVoxel();
+	const voxel::Voxel leaves = leavesVoxel();
+	const voxel::Region& region = volume.region();
+	core::DynamicArray<priv::TreeVolume*> treeVolumes;
+	treeVolumes.resize(n);
+	const int slices = core::parallelSliceCount(threadPool, n);
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		const int lower = n * slice / slices;
+		const int upper = n * (slice + 1) / slices;
+		for (int i = lower; i < upper; ++i) {
+			const voxelgenerator::TreeContext& ctx = trees[i];
+			math::Random random(ctx.cfg.seed);
+			treeVolumes[i] = new priv::TreeVolume(region);
+			createTree(*treeVolumes[i], ctx, random, trunk, leaves);
+		}
+	});
+	for (priv::TreeVolume* treeVolume : treeVolumes) {
+		treeVolume->copyTo(volume);
+		delete treeVolume;
+	}
+}
+
 }
 }
@@ -159,6 +159,45 @@ TEST_F(LUAApiTest, testArgumentInfo) {
 	g.shutdown();
 }
 
+TEST_F(LUAApiTest, testCachedScript) {
+	const core::String script = R"(
+		function arguments()
+			return {
+					{ name = 'color', desc = 'desc', type = 'colorindex' }
+				}
+		end
+
+		function main(node, region, color, argcolor)
+			local volume = node:volume()
+			local x = volume:voxel(1, 1, 1) + 2
+			volume:setVoxel(1, 1, 1, x)
+		end
+	)";
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(new voxel::RawVolume(_region), true);
+	const int nodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(nodeId, InvalidNodeId);
+
+	LUAApi g(_testApp->filesystem());
+	ASSERT_TRUE(g.init());
+	for (int i = 0; i < 2; ++i) {
+		core::DynamicArray<LUAParameterDescription> params;
+		ASSERT_TRUE(g.argumentInfo(script, params));
+		ASSERT_EQ(1u, params.size());
+		EXPECT_EQ(LUAParameterType::ColorIndex, params[0].type);
+
+		// the second run executes the cached bytecode
+		ASSERT_TRUE(g.exec(script, sceneGraph, nodeId, _region, voxel::Voxel()));
+		while (g.scriptStillRunning()) {
+			EXPECT_NE(ScriptState::Error, g.update(0.0));
+		}
+	}
+	// the first run placed color 1 (the air voxel returns -1) - the second run color 3
+	EXPECT_EQ(3u, sceneGraph.node(nodeId).volume()->voxel(1, 1, 1).getColor());
+	g.shutdown();
+}
+
 TEST_F(LUAApiTest, testArguments) {
 	const core::String script = R"(
 		function arguments()
@@ -185,6 +224,128 @@ TEST_F(LUAApiTest, testArguments) {
 	run(sceneGraph, script, args);
 }
 
+TEST_F(LUAApiTest, testVolumeBulkAccess) {
+	const core::String script = R"(
+		function main(node, region, color)
+			local volume = node:volume()
+			local fillRegion = g_region.new(4, 4, 4, 5, 5, 5)
+			if volume:fillRegion(fillRegion, 1) ~= 8 then
+				error('Expected 8 filled voxels')
+			end
+			local visited = 0
+			volume:visit(region, function(x, y, z, c)
+				visited = visited + 1
+			end)
+			-- the six voxels of the test setup and the filled region
+			if visited ~= 14 then
+				error('Expected 14 solid voxels, got ' .. visited)
+			end
+			local buffer = volume:getRegionBuffer(fillRegion)
+			if #buffer ~= 8 then
+				error('Unexpected buffer size ' .. #buffer)
+			end
+			for i = 1, #buffer do
+				if buffer[i] ~= 1 then
+					error('Unexpected color ' .. buffer[i] .. ' at index ' .. i)
+				end
+			end
+			-- remove the voxel at 5, 4, 4 and recolor the others
+			for i = 1, #buffer do
+				buffer[i] = 2
+			end
+			buffer[2] = -1
+			volume:setRegionBuffer(fillRegion, buffer)
+		end
+	)";
+	scenegraph::SceneGraph sceneGraph;
+	run(sceneGraph, script, {}, true);
+	const voxel::RawVolume *volume = sceneGraph.node(sceneGraph.activeNode()).volume();
+	EXPECT_EQ(2u, volume->voxel(4, 4, 4).getColor());
+	EXPECT_TRUE(voxel::isAir(volume->voxel(5, 4, 4).getMaterial()));
+	EXPECT_EQ(2u, volume->voxel(5, 5, 5).getColor());
+}
+
+TEST_F(LUAApiTest, testNoiseField) {
+	const core::String script = R"(
+		function main(node, region, color)
+			local fieldRegion = g_region.new(0, 0, 0, 3, 2, 1)
+			local field = g_noise.field3(fieldRegion, 'fbm', 0.1)
+			if #field ~= 24 then
+				error('Unexpected field size ' .. #field)
+			end
+			local expected = g_noise.fBm3(g_vec3.new(0.3, 0.2, 0.1))
+			if math.abs(field[24] - expected) > 0.0001 then
+				error('Unexpected noise value ' .. field[24] .. ' - expected ' .. expected)
+			end
+			local heightmap = g_noise.field2(fieldRegion)
+			if #heightmap ~= 8 then
+				error('Unexpected heightmap size ' .. #heightmap)
+			end
+		end
+	)";
+	scenegraph::SceneGraph sceneGraph;
+	run(sceneGraph, script);
+}
+
+TEST_F(LUAApiTest, testFrameBudget) {
+	// the script never yields on its own - the frame budget must pause it
+	const core::String script = R"(
+		function main(node, region, color)
+			local start = os.clock()
+			local i = 0
+			while os.clock() - start < 0.1 do
+				i = i + 1
+			end
+			g_script.setProgress(1.0)
+		end
+	)";
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(new voxel::RawVolume(_region), true);
+	const int nodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(nodeId, InvalidNodeId);
+
+	LUAApi g(_testApp->filesystem());
+	ASSERT_TRUE(g.init());
+	g.setFrameBudget(1u);
+	ASSERT_TRUE(g.exec(script, sceneGraph, nodeId, _region, voxel::Voxel()));
+	int updates = 0;
+	ScriptState state;
+	do {
+		state = g.update(0.0);
+		++updates;
+	} while (state == ScriptState::Running);
+	EXPECT_EQ(ScriptState::Finished, state);
+	EXPECT_GT(updates, 2);
+	EXPECT_FLOAT_EQ(1.0f, g.progress());
+	g.shutdown();
+}
+
+TEST_F(LUAApiTest, testCancel) {
+	const core::String script = R"(
+		function main(node, region, color)
+			while true do
+				coroutine.yield()
+			end
+		end
+	)";
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(new voxel::RawVolume(_region), true);
+	const int nodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(nodeId, InvalidNodeId);
+
+	LUAApi g(_testApp->filesystem());
+	ASSERT_TRUE(g.init());
+	ASSERT_TRUE(g.exec(script, sceneGraph, nodeId, _region, voxel::Voxel()));
+	EXPECT_EQ(ScriptState::Running, g.update(0.0));
+	EXPECT_LT(g.progress(), 0.0f);
+	g.cancel();
+	EXPECT_EQ(ScriptState::Cancelled, g.update(0.0));
+	EXPECT_FALSE(g.scriptStillRunning());
+	g.shutdown();
+}
+
 TEST_F(LUAApiTest, testSceneGraph) {
 	const core::String script = R"(
 		function main(node, region, color)
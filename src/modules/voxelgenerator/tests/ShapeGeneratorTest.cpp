@@ -165,6 +165,61 @@ TEST_F(ShapeGeneratorTest, testCreateCube) {
 	ASSERT_EQ((_width - 1) * (_height - 1) * (_depth - 1), count);
 }
 
+TEST_F(ShapeGeneratorTest, testCreateCubeClipped) {
+	voxel::RawVolumeWrapper wrapper(_volume);
+	shape::createCubeNoCenter(wrapper, glm::ivec3(-5, 20, 28), 10, 4, 10, _voxel);
+	int count = 0;
+	voxelutil::visitVolume(*_volume, [&count] (int, int, int, const voxel::Voxel&) {
+		++count;
+	});
+	EXPECT_EQ(5 * 4 * 4, count);
+	EXPECT_EQ(voxel::Region(0, 20, 28, 4, 23, 31), wrapper.dirtyRegion());
+}
+
+TEST_F(ShapeGeneratorTest, testCreateCirclePlaneSpans) {
+	// compare the rows of the circle with the voxel by voxel rasterization
+	const int sizes[] = {1, 2, 5, 10, 15, 20};
+	const double radii[] = {0.5, 3.0, 4.5, 10.0, 12.7};
+	for (math::Axis axis : {math::Axis::Y, math::Axis::Z}) {
+		for (int width : sizes) {
+			for (int depth : sizes) {
+				for (double radius : radii) {
+					voxel::RawVolume expected(_region);
+					voxel::RawVolume actual(_region);
+					const double xRadius = width / 2.0;
+					const double zRadius = depth / 2.0;
+					for (double z = -zRadius; z <= zRadius; ++z) {
+						for (double x = -xRadius; x <= xRadius; ++x) {
+							if (glm::sqrt(glm::pow(x, 2.0) + glm::pow(z, 2.0)) > radius) {
+								continue;
+							}
+							if (axis == math::Axis::Y) {
+								expected.setVoxel(_center.x + x, _center.y, _center.z + z, _voxel);
+							} else {
+								expected.setVoxel(_center.x + x, _center.y + z, _center.z, _voxel);
+							}
+						}
+					}
+					voxel::RawVolumeWrapper wrapper(&actual);
+					shape::createCirclePlane(wrapper, _center, axis, width, depth, radius, _voxel);
+					int differences = 0;
+					voxelutil::visitVolume(expected, [&](int x, int y, int z, const voxel::Voxel &) {
+						if (voxel::isAir(actual.voxel(x, y, z).getMaterial())) {
+							++differences;
+						}
+					});
+					voxelutil::visitVolume(actual, [&](int x, int y, int z, const voxel::Voxel &) {
+						if (voxel::isAir(expected.voxel(x, y, z).getMaterial())) {
+							++differences;
+						}
+					});
+					EXPECT_EQ(0, differences) << "width: " << width << ", depth: " << depth << ", radius: " << radius;
+				}
+			}
+		}
+	}
+}
+
 TEST_F(ShapeGeneratorTest, testCreateEllipseX) {
 	testCreateEllipse(math::Axis::X);
 	save("ellipseX.qb");
@@ -0,0 +1,119 @@
+/**
+ * @file
+ */
+
+#include "voxelgenerator/TileGenerator.h"
+#include "app/tests/AbstractTest.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
+#include "voxel/Region.h"
+
+namespace voxelgenerator {
+
+class TileGeneratorTest : public app::AbstractTest {
+protected:
+	/**
+	 * @brief Random pillars with a roof that may cross the border of the tile
+	 */
+	static void pillars(const Tile &tile, math::Random &random, voxel::RawVolumeWrapper &volume) {
+		const voxel::Region &region = tile.region;
+		const int amount = random.random(1, 4);
+		for (int i = 0; i < amount; ++i) {
+			const int x = random.random(region.getLowerX(), region.getUpperX());
+			const int z = random.random(region.getLowerZ(), region.getUpperZ());
+			const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, random.random(1, 255));
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				volume.setVoxel(x, y, z, voxel);
+			}
+			for (int dz = -2; dz <= 2; ++dz) {
+				for (int dx = -2; dx <= 2; ++dx) {
+					volume.setVoxel(x + dx, region.getUpperY(), z + dz, voxel);
+				}
+			}
+		}
+	}
+
+	static bool equal(const voxel::RawVolume &a, const voxel::RawVolume &b) {
+		const voxel::Region &region = a.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if (!a.voxel(x, y, z).isSame(b.voxel(x, y, z))) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+};
+
+TEST_F(TileGeneratorTest, testTileSeed) {
+	EXPECT_EQ(tileSeed(42u, glm::ivec3(1, 2, 3)), tileSeed(42u, glm::ivec3(1, 2, 3)));
+	EXPECT_NE(tileSeed(42u, glm::ivec3(1, 2, 3)), tileSeed(42u, glm::ivec3(3, 2, 1)));
+	EXPECT_NE(tileSeed(42u, glm::ivec3(1, 2, 3)), tileSeed(43u, glm::ivec3(1, 2, 3)));
+}
+
+TEST_F(TileGeneratorTest, testTiles) {
+	voxel::RawVolume volume(voxel::Region(-5, 0, -5, 20, 7, 20));
+	voxel::RawVolumeWrapper wrapper(&volume);
+	core::DynamicArray<Tile> tiles;
+	generateTiles(wrapper, glm::ivec3(8), 2, 1u, [&](const Tile &tile, math::Random &, voxel::RawVolumeWrapper &tileVolume) {
+		EXPECT_EQ(tile.generationRegion, tileVolume.region());
+		tiles.push_back(tile);
+	});
+	// the tiles are aligned to multiples of the tile size
+	ASSERT_EQ(4u * 4u, tiles.size());
+	EXPECT_EQ(glm::ivec3(-1, 0, -1), tiles[0].coord);
+	EXPECT_EQ(voxel::Region(-5, 0, -5, -1, 7, -1), tiles[0].region);
+	EXPECT_EQ(voxel::Region(-5, 0, -5, 1, 7, 1), tiles[0].generationRegion);
+	EXPECT_EQ(voxel::Region(0, 0, -5, 7, 7, -1), tiles[1].region);
+	EXPECT_EQ(voxel::Region(-2, 0, -5, 9, 7, 1), tiles[1].generationRegion);
+	EXPECT_EQ(tileSeed(1u, tiles[1].coord), tiles[1].seed);
+}
+
+TEST_F(TileGeneratorTest, testMarginIsMerged) {
+	voxel::RawVolume volume(voxel::Region(0, 0, 0, 15, 0, 7));
+	voxel::RawVolumeWrapper wrapper(&volume);
+	const voxel::Voxel left = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	const voxel::Voxel right = voxel::createVoxel(voxel::VoxelType::Generic, 2);
+	generateTiles(wrapper, glm::ivec3(8), 2, 0u, [&](const Tile &tile, math::Random &, voxel::RawVolumeWrapper &tileVolume) {
+		if (tile.coord.x == 0) {
+			// crosses the seam into the margin
+			tileVolume.setVoxel(7, 0, 0, left);
+			tileVolume.setVoxel(8, 0, 0, left);
+			tileVolume.setVoxel(9, 0, 1, left);
+		} else {
+			tileVolume.setVoxel(9, 0, 0, right);
+		}
+	});
+	EXPECT_TRUE(volume.voxel(7, 0, 0).isSame(left));
+	EXPECT_TRUE(volume.voxel(8, 0, 0).isSame(left));
+	EXPECT_TRUE(volume.voxel(9, 0, 1).isSame(left));
+	// the voxels of the tile itself are not replaced by the margin of the neighbour
+	EXPECT_TRUE(volume.voxel(9, 0, 0).isSame(right));
+}
+
+TEST_F(TileGeneratorTest, testSameResultWithThreads) {
+	const voxel::Region region(-13, 0, -7, 40, 9, 35);
+	voxel::RawVolume serial(region);
+	voxel::RawVolumeWrapper serialWrapper(&serial);
+	generateTiles(serialWrapper, glm::ivec3(8, 10, 8), 2, 1234u, pillars);
+
+	core::ThreadPool threadPool(4, "TileGenerator");
+	threadPool.init();
+	voxel::RawVolume parallel(region);
+	voxel::RawVolumeWrapper parallelWrapper(&parallel);
+	generateTiles(parallelWrapper, glm::ivec3(8, 10, 8), 2, 1234u, pillars, &threadPool);
+
+	EXPECT_TRUE(serialWrapper.dirtyRegion().isValid());
+	EXPECT_TRUE(equal(serial, parallel));
+
+	voxel::RawVolume otherSeed(region);
+	voxel::RawVolumeWrapper otherSeedWrapper(&otherSeed);
+	generateTiles(otherSeedWrapper, glm::ivec3(8, 10, 8), 2, 4321u, pillars, &threadPool);
+	EXPECT_FALSE(equal(serial, otherSeed));
+}
+
+} // namespace voxelgenerator
@@ -0,0 +1,111 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
+#include "voxel/Region.h"
+#include "voxelgenerator/TreeGenerator.h"
+#include "voxelutil/VolumeVisitor.h"
+
+namespace voxelgenerator {
+namespace tree {
+
+class TreeGeneratorTest : public app::AbstractTest {
+protected:
+	static int countVoxels(const voxel::RawVolume &volume) {
+		return voxelutil::visitVolume(volume, [](int, int, int, const voxel::Voxel &) {});
+	}
+
+	static TreeContext treeContext(TreeType type) {
+		TreeContext ctx;
+		switch (type) {
+		case TreeType::Dome:
+			ctx.dome = TreeDome();
+			break;
+		case TreeType::DomeHangingLeaves:
+			ctx.domehanging = TreeDomeHanging();
+			break;
+		case TreeType::Cone:
+			ctx.cone = TreeCone();
+			break;
+		case TreeType::Ellipsis:
+			ctx.ellipsis = TreeEllipsis();
+			break;
+		case TreeType::BranchesEllipsis:
+			ctx.branchellipsis = TreeBranchEllipsis();
+			break;
+		case TreeType::Cube:
+		case TreeType::CubeSideCubes:
+			ctx.cube = TreeCube();
+			break;
+		case TreeType::Pine:
+			ctx.pine = TreePine();
+			break;
+		case TreeType::Fir:
+			ctx.fir = TreeFir();
+			break;
+		case TreeType::Palm:
+			ctx.palm = TreePalm();
+			break;
+		case TreeType::SpaceColonization:
+		case TreeType::Max:
+			ctx.spacecolonization = TreeSpaceColonization();
+			break;
+		}
+		ctx.cfg.type = type;
+		return ctx;
+	}
+
+	void createForest(core::DynamicArray<TreeContext> &trees) {
+		unsigned int seed = 1u;
+		for (int i = 0; i < (int)TreeType::Max; ++i) {
+			TreeContext ctx = treeContext((TreeType)i);
+			ctx.cfg.seed = seed++;
+			ctx.cfg.pos = glm::ivec3(10 + (i % 4) * 25, 0, 10 + (i / 4) * 25);
+			trees.push_back(ctx);
+		}
+	}
+};
+
+TEST_F(TreeGeneratorTest, testSpaceColonization) {
+	Tree tree(glm::ivec3(32, 0, 32), 10, 5, 20, 20, 20, 2.0f, 42u, 0.8f);
+	tree.grow();
+	voxel::RawVolume volume(voxel::Region(0, 63));
+	voxel::RawVolumeWrapper wrapper(&volume);
+	tree.generate(wrapper, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	EXPECT_GT(countVoxels(volume), 0);
+	// the crown must have grown above the trunk
+	EXPECT_GT(wrapper.dirtyRegion().getUpperY(), 10);
+}
+
+TEST_F(TreeGeneratorTest, testForestMatchesSingleTrees) {
+	core::DynamicArray<TreeContext> trees;
+	createForest(trees);
+	const voxel::Region region(0, 0, 0, 99, 63, 99);
+
+	voxel::RawVolume expected(region);
+	voxel::RawVolumeWrapper expectedWrapper(&expected);
+	for (const TreeContext &ctx : trees) {
+		math::Random random(ctx.cfg.seed);
+		createTree(expectedWrapper, ctx, random);
+	}
+
+	voxel::RawVolume forest(region);
+	voxel::RawVolumeWrapper forestWrapper(&forest);
+	tree::createForest(forestWrapper, trees);
+
+	EXPECT_GT(countVoxels(expected), 0);
+	EXPECT_EQ(forestWrapper.dirtyRegion(), expectedWrapper.dirtyRegion());
+	int differences = 0;
+	voxelutil::visitVolume(expected, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+		if (!forest.voxel(x, y, z).isSame(voxel)) {
+			++differences;
+		}
+	}, voxelutil::VisitAll());
+	EXPECT_EQ(0, differences);
+}
+
+} // namespace tree
+} // namespace voxelgenerator
@@ -3,6 +3,8 @@
  */
 
 #include "PathTracer.h"
+#include "app/Async.h"
+#include "core/Algorithm.h"
 #include "core/Color.h"
 #include "core/Log.h"
 #include "core/Var.h"
@@ -28,6 +30,10 @@ static inline yocto::vec3f toVec3f(const glm::vec3 &in) {
 	return yocto::vec3f{in.x, in.y, in.z};
 }
 
+static inline float luminance(const yocto::vec4f &in) {
+	return 0.2126f * in.x + 0.7152f * in.y + 0.0722f * in.z;
+}
+
 /**
  * Simplified read stream that knows how image::Image::loadRGBA() works.
  *
@@ -68,41 +74,46 @@ public:
 
 } // namespace priv
 
+PathTracer::PathTracer() {
+	_voxelIntersect = [this](const yocto::ray3f &ray) { return _voxelTracer.intersect(ray); };
+#ifdef YOCTO_DENOISE
+	_denoiser = [](int width, int height, const std::vector<yocto::vec4f> &color,
+				   const std::vector<yocto::vec3f> &albedo, const std::vector<yocto::vec3f> &normal,
+				   std::vector<yocto::vec4f> &denoised) {
+		yocto::denoise_image(denoised, width, height, color, albedo, normal);
+		return true;
+	};
+#endif
+}
+
 PathTracer::~PathTracer() {
 	stop();
 }
 
-bool PathTracer::createScene(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
-							 const voxel::Mesh &mesh, bool opaque) {
-	// const palette::Palette &palette = node.palette();
-	scenegraph::KeyFrameIndex keyFrameIdx = 0;
-	const scenegraph::SceneGraphTransform &transform = node.transform(keyFrameIdx);
+void PathTracer::setDenoiser(const DenoiseFunc &denoiser) {
+	_denoiser = denoiser;
+}
+
+static void addShapes(const voxel::Mesh &mesh, std::vector<yocto::shape_data> &shapes, core::DynamicArray<int> &colors) {
 	const voxel::IndexArray &indices = mesh.getIndexVector();
 	if (indices.empty()) {
-		return true;
+		return;
 	}
 	core_assert((int)indices.size() % 3 == 0);
 	const int tris = (int)indices.size() / 3;
-	yocto::shape_data shapes[palette::PaletteMaxColors];
+	std::vector<yocto::shape_data> colorShapes(palette::PaletteMaxColors);
 	const voxel::VertexArray &vertices = mesh.getVertexVector();
 	const voxel::NormalArray &normals = mesh.getNormalVector();
 	const bool useNormals = normals.size() == vertices.size();
 
-	const voxel::Region &region = sceneGraph.resolveRegion(node);
-	const glm::vec3 size = glm::vec3(region.getDimensionsInVoxels());
-	const glm::vec3 pivot = node.pivot();
-
 	for (int i = 0; i < tris; i++) {
 		const voxel::VoxelVertex &vertex0 = vertices[indices[i * 3 + 0]];
 		const voxel::VoxelVertex &vertex1 = vertices[indices[i * 3 + 1]];
 		const voxel::VoxelVertex &vertex2 = vertices[indices[i * 3 + 2]];
 
-		const glm::vec3 pos0 = transform.apply(vertex0.position, pivot * size);
-		const glm::vec3 pos1 = transform.apply(vertex1.position, pivot * size);
-		const glm::vec3 pos2 = transform.apply(vertex2.position, pivot * size);
 		// uv is the same for all three vertices
 		// const glm::vec2 &uv = image::Image::uv(vertex0.colorIndex, 0, palette::PaletteMaxColors, 1);
-		yocto::shape_data *shape = &shapes[vertex0.colorIndex];
+		yocto::shape_data *shape = &colorShapes[vertex0.colorIndex];
 
 		// const core::RGBA rgba = palette.color(vertex0.colorIndex);
 		// const glm::vec4 &color = core::Color::fromRGBA(rgba);
@@ -110,9 +121,9 @@ bool PathTracer::createScene(const scenegraph::SceneGraph &sceneGraph, const sce
 		// shape->colors.push_back(priv::toColor(color, vertex1.ambientOcclusion));
 		// shape->colors.push_back(priv::toColor(color, vertex2.ambientOcclusion));
 
-		shape->positions.push_back(priv::toVec3f(pos0));
-		shape->positions.push_back(priv::toVec3f(pos1));
-		shape->positions.push_back(priv::toVec3f(pos2));
+		shape->positions.push_back(priv::toVec3f(vertex0.position));
+		shape->positions.push_back(priv::toVec3f(vertex1.position));
+		shape->positions.push_back(priv::toVec3f(vertex2.position));
 		// shape->texcoords.push_back({uv[0], uv[1]});
 		// shape->texcoords.push_back({uv[0], uv[1]});
 		// shape->texcoords.push_back({uv[0], uv[1]});
@@ -126,23 +137,53 @@ bool PathTracer::createScene(const scenegraph::SceneGraph &sceneGraph, const sce
 		const yocto::vec3i vidx{offsetStart + 0, offsetStart + 1, offsetStart + 2};
 		shape->triangles.push_back(vidx);
 	}
-	// const glm::vec3 &mins = mesh.getOffset();
-	_state.scene.shapes.reserve(palette::PaletteMaxColors);
 	for (int i = 0; i < palette::PaletteMaxColors; ++i) {
-		yocto::shape_data &shape = shapes[i];
+		yocto::shape_data &shape = colorShapes[i];
 		if (shape.triangles.empty()) {
 			continue;
 		}
-		_state.scene.shapes.push_back(shape);
-
-		yocto::instance_data instance_data;
-		// instance_data.frame = yocto::translation_frame(priv::toVec3f(mins));
-		instance_data.material = _state.scene.materials.size() + i;
-		instance_data.shape = (int)_state.scene.shapes.size() - 1;
-		_state.scene.instances.push_back(instance_data);
+		shapes.push_back(std::move(shape));
+		colors.push_back(i);
 	}
+}
 
-	return true;
+glm::mat4 toModelMatrix(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node) {
+	scenegraph::KeyFrameIndex keyFrameIdx = 0;
+	const scenegraph::SceneGraphTransform &transform = node.transform(keyFrameIdx);
+	const voxel::Region &region = sceneGraph.resolveRegion(node);
+	const glm::vec3 size = glm::vec3(region.getDimensionsInVoxels());
+	// see SceneGraphTransform::apply()
+	return glm::translate(transform.worldMatrix(), -node.pivot() * size);
+}
+
+static yocto::frame3f toFrame(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node) {
+	const glm::mat4 &model = toModelMatrix(sceneGraph, node);
+	yocto::frame3f frame;
+	frame.x = priv::toVec3f(glm::vec3(model[0]));
+	frame.y = priv::toVec3f(glm::vec3(model[1]));
+	frame.z = priv::toVec3f(glm::vec3(model[2]));
+	frame.o = priv::toVec3f(glm::vec3(model[3]));
+	return frame;
+}
+
+void PathTracer::createShapes(const scenegraph::SceneGraphNode &node, voxel::SurfaceExtractionType type) {
+	core_trace_scoped(PathTracerCreateShapes);
+	const voxel::RawVolume *v = node.volume();
+	voxel::ChunkMesh mesh(65536, 65536, true);
+	voxel::Region region = v->region();
+
+	const palette::Palette &palette = node.palette();
+	voxel::SurfaceExtractionContext ctx = voxel::createContext(type, v, region, palette, mesh, region.getLowerCorner());
+	voxel::extractSurface(ctx);
+
+	core::DynamicArray<int> colors;
+	addShapes(mesh.mesh[0], _state.scene.shapes, colors);
+	addShapes(mesh.mesh[1], _state.scene.shapes, colors);
+	for (int color : colors) {
+		yocto::instance_data &instance = _state.scene.instances.emplace_back();
+		instance.material = color;
+		instance.shape = (int)_state.scene.instances.size() - 1;
+	}
 }
 
 void PathTracer::addCamera(const scenegraph::SceneGraphNodeCamera &node) {
@@ -203,7 +244,7 @@ static yocto::material_type mapMaterialType(palette::MaterialType type) {
 	return yocto::material_type::matte;
 }
 
-static void setupMaterial(yocto::scene_data &scene, const palette::Palette &palette, int i) {
+yocto::material_data toMaterial(const palette::Palette &palette, int i) {
 	const palette::Material &ownMaterial = palette.material(i);
 
 	yocto::material_data material;
@@ -230,7 +271,11 @@ static void setupMaterial(yocto::scene_data &scene, const palette::Palette &pale
 	// material.emission
 	// material.scanisotropy
 	// material.trdepth
-	scene.materials.push_back(material);
+	return material;
+}
+
+static void setupMaterial(yocto::scene_data &scene, const palette::Palette &palette, int i) {
+	scene.materials.push_back(toMaterial(palette, i));
 }
 
 #if 0
@@ -263,11 +308,96 @@ static void addPaletteTexture(yocto::scene_data &scene, const palette::Palette &
 }
 #endif
 
-bool PathTracer::createScene(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera) {
-	_state.scene = {};
-	_state.lights = {};
+void PathTracer::updateInstances(core::DynamicArray<NodeShapes> &nodes) {
+	yocto::scene_data &scene = _state.scene;
+	bool moved = false;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		NodeShapes &node = nodes[i];
+		const NodeShapes &old = _nodeShapes[i];
+		node.firstShape = old.firstShape;
+		node.shapes = old.shapes;
+		for (int k = node.firstShape; k < node.firstShape + node.shapes; ++k) {
+			yocto::instance_data &instance = scene.instances[k];
+			instance.material = node.firstMaterial + (instance.material - old.firstMaterial);
+			instance.frame = node.frame;
+		}
+		moved |= !(node.frame == old.frame);
+	}
+	if (moved) {
+		Log::debug("Refit the bvh of %i nodes", (int)nodes.size());
+		yocto::update_scene_bvh(_state.bvh.bvh, scene, {}, {});
+	}
+}
+
+void PathTracer::rebuildShapes(const scenegraph::SceneGraph &sceneGraph, core::DynamicArray<NodeShapes> &nodes) {
+	yocto::scene_data &scene = _state.scene;
+	const yocto::trace_params &params = _state.params;
+	std::vector<yocto::shape_data> oldShapes = std::move(scene.shapes);
+	std::vector<yocto::instance_data> oldInstances = std::move(scene.instances);
+	std::vector<yocto::shape_bvh> oldBvhs = std::move(_state.bvh.bvh.shapes);
+	const bool reuseBvhs = oldBvhs.size() == oldShapes.size() && _bvhHighQuality == params.highqualitybvh;
+	scene.shapes.clear();
+	scene.instances.clear();
+
+	std::vector<yocto::shape_bvh> bvhs;
+	int extracted = 0;
+	for (NodeShapes &node : nodes) {
+		node.firstShape = (int)scene.shapes.size();
+		const NodeShapes *cached = nullptr;
+		for (const NodeShapes &old : _nodeShapes) {
+			if (node.sameGeometry(old)) {
+				cached = &old;
+				break;
+			}
+		}
+		if (cached != nullptr) {
+			for (int k = cached->firstShape; k < cached->firstShape + cached->shapes; ++k) {
+				scene.shapes.push_back(std::move(oldShapes[k]));
+				yocto::instance_data &instance = scene.instances.emplace_back();
+				instance.material = oldInstances[k].material - cached->firstMaterial;
+				instance.shape = (int)scene.shapes.size() - 1;
+				bvhs.push_back(reuseBvhs ? std::move(oldBvhs[k]) : yocto::shape_bvh{});
+			}
+		} else {
+			const scenegraph::SceneGraphNode &sceneGraphNode = sceneGraph.node(node.nodeId);
+			createShapes(sceneGraphNode, (voxel::SurfaceExtractionType)node.meshMode);
+			bvhs.resize(scene.shapes.size());
+			++extracted;
+		}
+		node.shapes = (int)scene.shapes.size() - node.firstShape;
+		for (int k = node.firstShape; k < node.firstShape + node.shapes; ++k) {
+			yocto::instance_data &instance = scene.instances[k];
+			instance.material += node.firstMaterial;
+			instance.frame = node.frame;
+		}
+	}
+
+	core::DynamicArray<std::shared_future<void>> futures;
+	for (size_t i = 0; i < bvhs.size(); ++i) {
+		if (!bvhs[i].bvh.nodes.empty()) {
+			continue;
+		}
+		futures.push_back(app::async([&bvhs, &scene, &params, i]() {
+			bvhs[i] = yocto::make_shape_bvh(scene.shapes[i], params.highqualitybvh);
+		}).share());
+	}
+	for (const std::shared_future<void> &future : futures) {
+		future.wait();
+	}
+	Log::debug("Extracted %i of %i nodes and built %i of %i shape bvhs", extracted, (int)nodes.size(),
+			   (int)futures.size(), (int)bvhs.size());
+	_state.bvh.bvh = yocto::make_scene_bvh(scene, std::move(bvhs), params.highqualitybvh);
+	_state.bvh.ebvh = {};
+	_bvhHighQuality = params.highqualitybvh;
+}
+
+void PathTracer::updateShapes(const scenegraph::SceneGraph &sceneGraph) {
+	yocto::scene_data &scene = _state.scene;
+	const int meshMode = core::Var::getSafe(cfg::VoxelMeshMode)->intVal();
 
-	voxel::SurfaceExtractionType type = (voxel::SurfaceExtractionType)core::Var::getSafe(cfg::VoxelMeshMode)->intVal();
+	// the materials are cheap to create - the palettes might have changed without changing the colors
+	scene.materials.clear();
+	core::DynamicArray<NodeShapes> nodes;
 	// TODO: support references
 	for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
 		const scenegraph::SceneGraphNode &node = *iter;
@@ -278,33 +408,59 @@ bool PathTracer::createScene(const scenegraph::SceneGraph &sceneGraph, const vid
 		if (v == nullptr) {
 			continue;
 		}
-
-		voxel::ChunkMesh mesh(65536, 65536, true);
-		voxel::Region region = v->region();
-
 		const palette::Palette &palette = node.palette();
-		voxel::SurfaceExtractionContext ctx =
-			voxel::createContext(type, v, region, palette, mesh, region.getLowerCorner());
-
-		voxel::extractSurface(ctx);
-
-		// scenegraph::KeyFrameIndex keyFrameIdx = 0;
-		// const scenegraph::SceneGraphTransform &transform = node.transform(keyFrameIdx);
-		if (!createScene(sceneGraph, node, mesh.mesh[0], true)) {
-			return false;
-		}
-		if (!createScene(sceneGraph, node, mesh.mesh[1], false)) {
-			return false;
-		}
+		NodeShapes nodeShapes;
+		nodeShapes.nodeId = node.id();
+		nodeShapes.volume = v;
+		nodeShapes.volumeVersion = v->version();
+		nodeShapes.paletteHash = palette.hash();
+		nodeShapes.meshMode = meshMode;
+		nodeShapes.firstMaterial = (int)scene.materials.size();
+		nodeShapes.frame = toFrame(sceneGraph, node);
+		nodes.push_back(nodeShapes);
 
 		// addPaletteTexture(_state.scene, palette);
 		// addEmissiveTexture(_state.scene, palette);
 
 		for (int i = 0; i < palette.colorCount(); ++i) {
-			setupMaterial(_state.scene, palette, i);
+			setupMaterial(scene, palette, i);
 		}
 	}
 
+	bool sameGeometry = nodes.size() == _nodeShapes.size() && !_state.bvh.bvh.bvh.nodes.empty() &&
+						_bvhHighQuality == _state.params.highqualitybvh;
+	for (size_t i = 0; sameGeometry && i < nodes.size(); ++i) {
+		sameGeometry = nodes[i].sameGeometry(_nodeShapes[i]);
+	}
+	if (sameGeometry) {
+		updateInstances(nodes);
+	} else {
+		rebuildShapes(sceneGraph, nodes);
+	}
+	_nodeShapes = nodes;
+	if (_state.params.embreebvh) {
+		_state.bvh = yocto::make_trace_bvh(scene, _state.params);
+	}
+}
+
+bool PathTracer::createScene(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera) {
+	core_trace_scoped(PathTracerCreateScene);
+	yocto::scene_data &scene = _state.scene;
+	if (_state.voxelTracing) {
+		// the voxels are traced directly - free the triangles and the bvh
+		scene.materials.clear();
+		scene.shapes.clear();
+		scene.instances.clear();
+		_state.bvh = {};
+		_nodeShapes.clear();
+		_voxelTracer.update(sceneGraph);
+	} else {
+		_voxelTracer.clear();
+		updateShapes(sceneGraph);
+	}
+
+	scene.cameras.clear();
+	scene.camera_names.clear();
 	if (camera) {
 		addCamera("default", *camera);
 	}
@@ -314,23 +470,206 @@ bool PathTracer::createScene(const scenegraph::SceneGraph &sceneGraph, const vid
 		addCamera(scenegraph::toCameraNode(node));
 	}
 
-	if (_state.scene.cameras.size() <= 1) {
-		yocto::add_camera(_state.scene);
+	if (scene.cameras.size() <= 1) {
+		if (_state.voxelTracing) {
+			yocto::add_camera(scene, _voxelTracer.bounds());
+		} else {
+			yocto::add_camera(scene);
+		}
+	}
+	// the sky doesn't depend on the scene graph
+	if (scene.environments.empty()) {
+		yocto::add_sky(scene);
 	}
-	yocto::add_sky(_state.scene);
 
 	return true;
 }
 
+void PathTracer::createTiles() {
+	const int width = _state.state.width;
+	const int height = _state.state.height;
+	const int tileSize = core_max(8, _state.tileSize);
+	_state.tiles.clear();
+	_state.tiles.reserve(((width + tileSize - 1) / tileSize) * ((height + tileSize - 1) / tileSize));
+	for (int y = 0; y < height; y += tileSize) {
+		for (int x = 0; x < width; x += tileSize) {
+			PathTracerTile tile;
+			tile.x = x;
+			tile.y = y;
+			tile.width = core_min(tileSize, width - x);
+			tile.height = core_min(tileSize, height - y);
+			_state.tiles.push_back(tile);
+		}
+	}
+	const glm::ivec2 center(width / 2, height / 2);
+	auto distance = [&center](const PathTracerTile &tile) {
+		const glm::ivec2 delta = glm::ivec2(tile.x + tile.width / 2, tile.y + tile.height / 2) - center;
+		return delta.x * delta.x + delta.y * delta.y;
+	};
+	core::sort(_state.tiles.begin(), _state.tiles.end(),
+			   [&distance](const PathTracerTile &lhs, const PathTracerTile &rhs) {
+				   return distance(lhs) < distance(rhs);
+			   });
+}
+
+bool PathTracer::claimTile(int &idx, PathTracerTile &tile) {
+	core::ScopedLock lock(_tileLock);
+	const int n = (int)_state.tiles.size();
+	for (int i = 0; i < n; ++i) {
+		const int candidate = (_nextTile + i) % n;
+		PathTracerTile &t = _state.tiles[candidate];
+		if (t.busy || t.done) {
+			continue;
+		}
+		t.busy = true;
+		_nextTile = (candidate + 1) % n;
+		idx = candidate;
+		tile = t;
+		return true;
+	}
+	return false;
+}
+
+void PathTracer::finishTile(int idx, const PathTracerTile &tile) {
+	core::ScopedLock lock(_tileLock);
+	PathTracerTile &t = _state.tiles[idx];
+	t = tile;
+	t.busy = false;
+	_imageVersion.fetch_add(1);
+}
+
+void PathTracer::traceSample(int x, int y, int sample) {
+	if (_state.voxelTracing) {
+		yocto::trace_sample(_state.state, _state.scene, _voxelIntersect, x, y, sample, _state.params);
+	} else {
+		yocto::trace_sample(_state.state, _state.scene, _state.bvh, _state.lights, x, y, sample, _state.params);
+	}
+}
+
+void PathTracer::tracePreview(PathTracerTile &tile) {
+	yocto::trace_state &state = _state.state;
+	const yocto::trace_params &params = _state.params;
+	const int ratio = params.pratio;
+	for (int y = tile.y; y < tile.y + tile.height; y += ratio) {
+		for (int x = tile.x; x < tile.x + tile.width; x += ratio) {
+			// the real first sample overrides the preview values because it has the weight 1
+			traceSample(x, y, 0);
+			const yocto::vec4f color = state.image[state.width * y + x];
+			const int maxY = core_min(y + ratio, tile.y + tile.height);
+			const int maxX = core_min(x + ratio, tile.x + tile.width);
+			for (int py = y; py < maxY; ++py) {
+				for (int px = x; px < maxX; ++px) {
+					state.image[state.width * py + px] = color;
+				}
+			}
+		}
+	}
+	tile.preview = true;
+}
+
+void PathTracer::traceTile(PathTracerTile &tile) {
+	core_trace_scoped(PathTracerTile);
+	const yocto::trace_params &params = _state.params;
+	if (!tile.preview && params.pratio > 1 && tile.samples == 0) {
+		tracePreview(tile);
+		return;
+	}
+	yocto::trace_state &state = _state.state;
+	const int batch = core_min(core_max(1, params.batch), params.samples - tile.samples);
+	float delta = 0.0f;
+	float brightness = 0.0f;
+	for (int y = tile.y; y < tile.y + tile.height; ++y) {
+		for (int x = tile.x; x < tile.x + tile.width; ++x) {
+			const yocto::vec4f &pixel = state.image[state.width * y + x];
+			for (int s = 0; s < batch; ++s) {
+				const float before = priv::luminance(pixel);
+				traceSample(x, y, tile.samples + s);
+				delta += glm::abs(priv::luminance(pixel) - before);
+			}
+			brightness += priv::luminance(pixel);
+		}
+	}
+	tile.samples += batch;
+	if (tile.samples >= params.samples) {
+		tile.done = true;
+		return;
+	}
+	if (_state.adaptiveThreshold <= 0.0f || tile.samples < _state.adaptiveMinSamples) {
+		return;
+	}
+	// a new sample moves the mean by (sample - mean) / n - so the average change of a sample times sqrt(n) estimates
+	// the standard error of the mean
+	const float pixels = (float)(tile.width * tile.height);
+	const float error = delta / (pixels * (float)batch) * glm::sqrt((float)tile.samples);
+	const float relativeError = error / (brightness / pixels + 0.01f);
+	if (relativeError < _state.adaptiveThreshold) {
+		Log::debug("Tile %i:%i converged after %i samples", tile.x, tile.y, tile.samples);
+		tile.done = true;
+	}
+}
+
+void PathTracer::denoise() {
+	yocto::trace_state &state = _state.state;
+	if (!_state.params.denoise || !_denoiser) {
+		state.denoised.clear();
+		return;
+	}
+	core_trace_scoped(PathTracerDenoise);
+	if (!_denoiser(state.width, state.height, state.image, state.albedo, state.normal, state.denoised)) {
+		Log::warn("Failed to denoise the path tracer image");
+		state.denoised.clear();
+	}
+}
+
+void PathTracer::worker() {
+	int idx = -1;
+	PathTracerTile tile;
+	while (!_cancel && claimTile(idx, tile)) {
+		traceTile(tile);
+		finishTile(idx, tile);
+	}
+	// the last worker is only out of work if all tiles are done - the others might still get new samples
+	if (_runningWorkers.fetch_sub(1) == 1 && !_cancel) {
+		denoise();
+		_imageVersion.fetch_add(1);
+	}
+}
+
+int PathTracer::minSamples() {
+	core::ScopedLock lock(_tileLock);
+	int samples = _state.params.samples;
+	for (const PathTracerTile &tile : _state.tiles) {
+		if (!tile.done) {
+			samples = core_min(samples, tile.samples);
+		}
+	}
+	return samples;
+}
+
 bool PathTracer::start(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera) {
+	stop();
 	Log::debug("Create scene");
 	createScene(sceneGraph, camera);
-	_state.bvh = yocto::make_trace_bvh(_state.scene, _state.params);
 	_state.lights = yocto::make_trace_lights(_state.scene, _state.params);
 	_state.state = yocto::make_trace_state(_state.scene, _state.params);
-	yocto::trace_start(_state.context, _state.state, _state.scene, _state.bvh, _state.lights, _state.params);
+	// filled by the denoiser once all tiles are done - get_image() would return the empty buffer before
+	_state.state.denoised.clear();
+	createTiles();
+	_nextTile = 0;
+	_cancel = false;
+	_cachedImage = {};
+	_cachedImageVersion = -1;
+	_imageVersion = 0;
+
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	const int workers = core_max(1, core_min((int)threadPool.size(), (int)_state.tiles.size()));
+	_runningWorkers = workers;
+	_workers.reserve(workers);
+	for (int i = 0; i < workers; ++i) {
+		_workers.push_back(app::async([this]() { worker(); }).share());
+	}
 	_state.started = true;
-	Log::debug("Started pathtracer");
+	Log::debug("Started pathtracer with %i workers for %i tiles", workers, (int)_state.tiles.size());
 	return true;
 }
 
@@ -344,7 +683,11 @@ bool PathTracer::restart(const scenegraph::SceneGraph &sceneGraph, const video::
 }
 
 bool PathTracer::stop() {
-	yocto::trace_cancel(_state.context);
+	_cancel = true;
+	for (const std::shared_future<void> &future : _workers) {
+		future.wait();
+	}
+	_workers.clear();
 	_state.started = false;
 	return true;
 }
@@ -360,21 +703,26 @@ bool PathTracer::update(int *currentSample) {
 		}
 		return true;
 	}
-	if (yocto::trace_done(_state.context)) {
-		if (_state.state.samples >= _state.params.samples) {
-			_state.started = false;
-			return true;
-		}
-		if (currentSample) {
-			*currentSample = _state.state.samples;
+	_state.state.samples = minSamples();
+	if (currentSample) {
+		*currentSample = _state.state.samples;
+	}
+	for (const std::shared_future<void> &future : _workers) {
+		if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			return false;
 		}
-		Log::debug("PathTracer sample: %i", _state.state.samples);
-		yocto::trace_start(_state.context, _state.state, _state.scene, _state.bvh, _state.lights, _state.params);
 	}
-	return false;
+	Log::debug("PathTracer finished with %i samples", _state.state.samples);
+	_workers.clear();
+	_state.started = false;
+	return true;
 }
 
 image::ImagePtr PathTracer::image() {
+	const int version = _imageVersion;
+	if (_cachedImage && version == _cachedImageVersion) {
+		return _cachedImage;
+	}
 	yocto::image_data image;
 	image = yocto::get_image(_state.state);
 
@@ -383,6 +731,8 @@ image::ImagePtr PathTracer::image() {
 	if (!i->loadRGBA(stream, image.width, image.height)) {
 		return {};
 	}
+	_cachedImage = i;
+	_cachedImageVersion = version;
 	return i;
 }
 
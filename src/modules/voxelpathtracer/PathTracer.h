@@ -6,8 +6,15 @@
 
 #include "core/SharedPtr.h"
 #include "core/GLM.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Lock.h"
+#include "voxelpathtracer/VoxelTracer.h"
 #include <yocto_scene.h>
 #include <yocto_trace.h>
+#include <atomic>
+#include <functional>
+#include <future>
 
 namespace video {
 class Camera;
@@ -24,6 +31,8 @@ class Palette;
 
 namespace voxel {
 class Mesh;
+class RawVolume;
+enum class SurfaceExtractionType;
 } // namespace voxel
 
 namespace scenegraph {
@@ -34,48 +43,182 @@ class SceneGraphNodeCamera;
 
 namespace voxelpathtracer {
 
+/**
+ * @brief Converts the color and the material of the palette entry into a yocto material
+ */
+yocto::material_data toMaterial(const palette::Palette &palette, int colorIndex);
+
+/**
+ * @brief The transform of the voxel coordinates of the node into world space
+ */
+glm::mat4 toModelMatrix(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node);
+
+/**
+ * @brief A part of the image that is rendered by one worker of the thread pool
+ */
+struct PathTracerTile {
+	int x = 0;
+	int y = 0;
+	int width = 0;
+	int height = 0;
+	// the samples that were accumulated for this tile
+	int samples = 0;
+	// the low resolution preview was rendered
+	bool preview = false;
+	// a worker is rendering this tile right now
+	bool busy = false;
+	// all samples were rendered or the tile converged
+	bool done = false;
+};
+
 struct PathTracerState {
-	yocto::trace_context context;
 	yocto::scene_data scene;
 	yocto::trace_bvh bvh;
 	yocto::trace_params params;
 	yocto::trace_lights lights;
 	yocto::trace_state state;
+	/**
+	 * The tiles are sorted by their distance to the center of the image - that's where the user is looking at and
+	 * these tiles get their samples first.
+	 */
+	core::DynamicArray<PathTracerTile> tiles;
+	int tileSize = 32;
+	/**
+	 * A tile doesn't get any further samples once the estimated relative error of its pixels is below this value -
+	 * @c 0 disables the adaptive sampling and all tiles get @c trace_params::samples samples
+	 */
+	float adaptiveThreshold = 0.01f;
+	// the samples a tile gets before it is checked for convergence
+	int adaptiveMinSamples = 16;
+	/**
+	 * Trace the rays through the voxels of the volumes instead of converting them into triangles - there is no bvh to
+	 * build, but only the naive path tracer is supported (see VoxelTracer)
+	 */
+	bool voxelTracing = false;
 	bool started = false;
-
-	PathTracerState() : context(yocto::make_trace_context({})) {
-	}
 };
 
+/**
+ * @brief Hook for denoisers like OIDN - gets the noisy color and the albedo and normal feature buffers of the
+ * rendered image and writes the denoised color. Executed once after all tiles were rendered if
+ * @c trace_params::denoise is set.
+ * @return @c false if the image couldn't get denoised
+ */
+using DenoiseFunc = std::function<bool(int width, int height, const std::vector<yocto::vec4f> &color,
+									   const std::vector<yocto::vec3f> &albedo,
+									   const std::vector<yocto::vec3f> &normal, std::vector<yocto::vec4f> &denoised)>;
+
+/**
+ * @brief Progressive path tracer that renders the image in tiles on the app thread pool.
+ *
+ * The first pass renders a low resolution preview (see @c trace_params::pratio) of every tile to get a quick first
+ * image. Each further pass adds @c trace_params::batch samples to a tile until it either reached
+ * @c trace_params::samples or converged (see @c PathTracerState::adaptiveThreshold).
+ */
 class PathTracer {
 private:
 	PathTracerState _state;
+	DenoiseFunc _denoiser;
+	VoxelTracer _voxelTracer;
+	yocto::trace_intersect_func _voxelIntersect;
+
+	/**
+	 * @brief The shapes of a model node in the scene - they are kept across restarts and are only extracted again if
+	 * the volume, the palette or the mesh mode changed. A transform change only updates the instances.
+	 */
+	struct NodeShapes {
+		int nodeId = -1;
+		const voxel::RawVolume *volume = nullptr;
+		uint64_t volumeVersion = 0u;
+		uint64_t paletteHash = 0u;
+		int meshMode = 0;
+		// the shapes of the node are stored consecutively - the instance of a shape has the same index
+		int firstShape = 0;
+		int shapes = 0;
+		// the material of the first palette color
+		int firstMaterial = 0;
+		yocto::frame3f frame;
+
+		bool sameGeometry(const NodeShapes &other) const {
+			return nodeId == other.nodeId && volume == other.volume && volumeVersion == other.volumeVersion &&
+				   paletteHash == other.paletteHash && meshMode == other.meshMode;
+		}
+	};
+	core::DynamicArray<NodeShapes> _nodeShapes;
+	bool _bvhHighQuality = false;
+
+	core_trace_mutex(core::Lock, _tileLock, "PathTracerTiles");
+	// the tile where the workers continue to search for work - guarded by _tileLock
+	int _nextTile = 0;
+	core::DynamicArray<std::shared_future<void>> _workers;
+	std::atomic_int _runningWorkers{0};
+	std::atomic_bool _cancel{false};
+	// increased whenever a tile got new samples
+	std::atomic_int _imageVersion{0};
+	int _cachedImageVersion = -1;
+	image::ImagePtr _cachedImage;
+
+	void createTiles();
+	bool claimTile(int &idx, PathTracerTile &tile);
+	void finishTile(int idx, const PathTracerTile &tile);
+	void traceSample(int x, int y, int sample);
+	void traceTile(PathTracerTile &tile);
+	void tracePreview(PathTracerTile &tile);
+	void denoise();
+	void worker();
+	int minSamples();
 
 	void addCamera(const scenegraph::SceneGraphNodeCamera &node);
 	void addCamera(const char *name, const video::Camera &cam);
 
-	bool createScene(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
-					 const voxel::Mesh &mesh, bool opaque);
+	/**
+	 * @brief Adds the extracted shapes of the node to the scene - the vertices are in model space
+	 */
+	void createShapes(const scenegraph::SceneGraphNode &node, voxel::SurfaceExtractionType type);
+	/**
+	 * @brief Only updates the frames and materials of the instances and refits the bvh if needed
+	 */
+	void updateInstances(core::DynamicArray<NodeShapes> &nodes);
+	/**
+	 * @brief Reuses the shapes and shape bvhs of the unchanged nodes and builds the others
+	 */
+	void rebuildShapes(const scenegraph::SceneGraph &sceneGraph, core::DynamicArray<NodeShapes> &nodes);
+	void updateShapes(const scenegraph::SceneGraph &sceneGraph);
 	bool createScene(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera);
 
 public:
+	PathTracer();
 	~PathTracer();
 	PathTracerState &state() {
 		return _state;
 	}
+	const VoxelTracer &voxelTracer() const {
+		return _voxelTracer;
+	}
 	bool start(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera = nullptr);
 	bool restart(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera = nullptr);
 	bool stop();
 	bool started() const;
 
 	/**
-	 * @brief Update the path tracer. This will render a batch of samples and must get called until either stop() was
-	 * called or @c false is returned.
+	 * @brief Replace the denoiser - by default OIDN is used if yocto was compiled with @c YOCTO_DENOISE
+	 * @note Must not get called while the path tracer is running
+	 */
+	void setDenoiser(const DenoiseFunc &denoiser);
+
+	/**
+	 * @brief Update the path tracer. The tiles are rendered in the background and this must get called until either
+	 * stop() was called or @c true is returned.
+	 * @param[out] currentSample The samples all unfinished tiles have at least
 	 * @return @c true if rendering is done, @c false otherwise
 	 * @sa image()
 	 */
 	bool update(int *currentSample = nullptr);
 
+	/**
+	 * @return The current state of the rendered image - the same instance is returned as long as no tile got new
+	 * samples
+	 */
 	image::ImagePtr image();
 };
 
@@ -0,0 +1,216 @@
+/**
+ * @file
+ */
+
+#include "VoxelTracer.h"
+#include "PathTracer.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "palette/Palette.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/Raycast.h"
+#include <float.h>
+#include <glm/matrix.hpp>
+
+namespace voxelpathtracer {
+
+namespace priv {
+
+static inline glm::vec3 toVec3(const yocto::vec3f &in) {
+	return glm::vec3(in.x, in.y, in.z);
+}
+
+static inline yocto::vec3f toVec3f(const glm::vec3 &in) {
+	return yocto::vec3f{in.x, in.y, in.z};
+}
+
+static yocto::material_point toMaterialPoint(const palette::Palette &palette, int i) {
+	static const yocto::scene_data empty;
+	const yocto::material_data &material = toMaterial(palette, i);
+	yocto::material_point point = yocto::eval_material(empty, material, {0.0f, 0.0f});
+	// the naive path tracer doesn't support volumes - emissive voxels are mapped to volumetric materials
+	if (point.type == yocto::material_type::volumetric) {
+		point.type = yocto::material_type::matte;
+		point.emission = point.scattering;
+		point.roughness = 1.0f;
+	} else if (point.type == yocto::material_type::refractive || point.type == yocto::material_type::subsurface) {
+		point.type = yocto::material_type::transparent;
+	}
+	return point;
+}
+
+} // namespace priv
+
+VoxelTracer::~VoxelTracer() {
+	clear();
+}
+
+void VoxelTracer::clear() {
+	for (Model &model : _models) {
+		delete model.volume;
+	}
+	_models.clear();
+}
+
+void VoxelTracer::update(const scenegraph::SceneGraph &sceneGraph) {
+	core_trace_scoped(VoxelTracerUpdate);
+	core::DynamicArray<Model> models;
+	int copied = 0;
+	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
+		const scenegraph::SceneGraphNode &node = *iter;
+		if (!node.visible()) {
+			continue;
+		}
+		// reference nodes share the volume of their model node - but keep their own transform and palette
+		const voxel::RawVolume *v = sceneGraph.resolveVolume(node);
+		if (v == nullptr) {
+			continue;
+		}
+		Model model;
+		model.nodeId = node.id();
+		model.source = v;
+		model.version = v->version();
+		for (Model &old : _models) {
+			if (old.nodeId == model.nodeId && old.source == v && old.version == model.version) {
+				// take the ownership
+				model.volume = old.volume;
+				old.volume = nullptr;
+				break;
+			}
+		}
+		if (model.volume == nullptr) {
+			model.volume = voxel::RawVolume::createShared(*v);
+			model.volume->setOccupancyTracking(true);
+			++copied;
+		}
+		model.model = toModelMatrix(sceneGraph, node);
+		model.inverseModel = glm::inverse(model.model);
+		model.normalMatrix = glm::transpose(glm::mat3(model.inverseModel));
+		const palette::Palette &palette = node.palette();
+		model.materials.reserve(palette::PaletteMaxColors);
+		for (int i = 0; i < palette::PaletteMaxColors; ++i) {
+			model.materials.push_back(priv::toMaterialPoint(palette, i));
+		}
+		models.push_back(model);
+	}
+	clear();
+	_models = models;
+	Log::debug("Voxel tracer uses %i models - %i volumes were updated", (int)_models.size(), copied);
+}
+
+bool VoxelTracer::intersect(const Model &model, const yocto::ray3f &ray, Hit &hit) const {
+	const glm::vec3 origin = glm::vec3(model.inverseModel * glm::vec4(priv::toVec3(ray.o), 1.0f));
+	const glm::vec3 dir = glm::vec3(model.inverseModel * glm::vec4(priv::toVec3(ray.d), 0.0f));
+	const voxel::Region &region = model.volume->region();
+	const glm::vec3 mins(region.getLowerCorner());
+	const glm::vec3 maxs = glm::vec3(region.getUpperCorner()) + 1.0f;
+
+	// clip the ray to the region - the affine transform keeps the ray parameter
+	float tEnter = ray.tmin;
+	float tLeave = core_min(ray.tmax, hit.distance);
+	for (int a = 0; a < 3; ++a) {
+		if (dir[a] == 0.0f) {
+			if (origin[a] < mins[a] || origin[a] > maxs[a]) {
+				return false;
+			}
+			continue;
+		}
+		float t0 = (mins[a] - origin[a]) / dir[a];
+		float t1 = (maxs[a] - origin[a]) / dir[a];
+		if (t0 > t1) {
+			core::exchange(t0, t1);
+		}
+		tEnter = core_max(tEnter, t0);
+		tLeave = core_min(tLeave, t1);
+	}
+	if (tEnter > tLeave) {
+		return false;
+	}
+
+	const glm::vec3 start = origin + dir * tEnter;
+	// a ray that starts in a solid voxel (e.g. the continuation of a ray through a transparent voxel) leaves it
+	const bool startsInside = tEnter == ray.tmin;
+	const glm::ivec3 startVoxel(glm::floor(start));
+	glm::ivec3 hitPos;
+	bool found = false;
+	voxelutil::raycastSkipEmpty(model.volume, start, origin + dir * tLeave, [&](const glm::ivec3 &pos) {
+		if (startsInside && pos == startVoxel) {
+			return true;
+		}
+		if (voxel::isAir(model.volume->voxel(pos).getMaterial())) {
+			return true;
+		}
+		hitPos = pos;
+		found = true;
+		return false;
+	});
+	if (!found) {
+		return false;
+	}
+
+	// the face of the voxel where the ray enters
+	float distance = -FLT_MAX;
+	int axis = 0;
+	for (int a = 0; a < 3; ++a) {
+		if (dir[a] == 0.0f) {
+			continue;
+		}
+		const float t0 = ((float)hitPos[a] - origin[a]) / dir[a];
+		const float t1 = ((float)hitPos[a] + 1.0f - origin[a]) / dir[a];
+		const float tNear = core_min(t0, t1);
+		if (tNear > distance) {
+			distance = tNear;
+			axis = a;
+		}
+	}
+	distance = core_max(distance, tEnter);
+	if (distance >= hit.distance) {
+		return false;
+	}
+	glm::vec3 normal(0.0f);
+	normal[axis] = dir[axis] > 0.0f ? -1.0f : 1.0f;
+	// move the position out of the voxel to not hit it again with the next ray
+	const glm::vec3 position = origin + dir * distance + normal * 0.001f;
+
+	hit.distance = distance;
+	hit.position = glm::vec3(model.model * glm::vec4(position, 1.0f));
+	hit.normal = glm::normalize(model.normalMatrix * normal);
+	hit.material = &model.materials[model.volume->voxel(hitPos).getColor()];
+	return true;
+}
+
+yocto::trace_point VoxelTracer::intersect(const yocto::ray3f &ray) const {
+	Hit hit;
+	hit.distance = ray.tmax;
+	bool found = false;
+	for (const Model &model : _models) {
+		found |= intersect(model, ray, hit);
+	}
+	yocto::trace_point point;
+	if (!found) {
+		return point;
+	}
+	point.hit = true;
+	point.position = priv::toVec3f(hit.position);
+	point.normal = priv::toVec3f(hit.normal);
+	point.material = *hit.material;
+	return point;
+}
+
+yocto::bbox3f VoxelTracer::bounds() const {
+	yocto::bbox3f bbox = yocto::invalidb3f;
+	for (const Model &model : _models) {
+		const voxel::Region &region = model.volume->region();
+		const glm::vec3 mins(region.getLowerCorner());
+		const glm::vec3 maxs = glm::vec3(region.getUpperCorner()) + 1.0f;
+		for (int i = 0; i < 8; ++i) {
+			const glm::vec3 corner((i & 1) ? maxs.x : mins.x, (i & 2) ? maxs.y : mins.y, (i & 4) ? maxs.z : mins.z);
+			bbox = yocto::merge(bbox, priv::toVec3f(glm::vec3(model.model * glm::vec4(corner, 1.0f))));
+		}
+	}
+	return bbox;
+}
+
+} // namespace voxelpathtracer
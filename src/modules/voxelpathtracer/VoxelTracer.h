@@ -0,0 +1,86 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/GLM.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <yocto_trace.h>
+
+namespace scenegraph {
+class SceneGraph;
+} // namespace scenegraph
+
+namespace voxel {
+class RawVolume;
+} // namespace voxel
+
+namespace voxelpathtracer {
+
+/**
+ * @brief Intersects the rays with the voxels of the model nodes - without converting the volumes into triangles and
+ * without building a bvh
+ *
+ * The rays are traversed through the volumes with a 3d DDA that skips the empty bricks of the occupancy masks (see
+ * voxelutil::raycastSkipEmpty()). The tracer keeps copy on write copies of the volumes - so the memory is shared with
+ * the scene graph as long as the volumes are not modified while rendering.
+ *
+ * @note Refractive materials are rendered as transparent materials, because the faces between two voxels of the same
+ * material are not skipped.
+ */
+class VoxelTracer {
+private:
+	struct Model {
+		int nodeId = -1;
+		const voxel::RawVolume *source = nullptr;
+		uint64_t version = 0u;
+		// shares the voxel data with the source volume - with occupancy tracking
+		voxel::RawVolume *volume = nullptr;
+		glm::mat4 model{1.0f};
+		glm::mat4 inverseModel{1.0f};
+		glm::mat3 normalMatrix{1.0f};
+		// one material per palette color
+		core::DynamicArray<yocto::material_point> materials;
+	};
+	core::DynamicArray<Model> _models;
+
+	struct Hit {
+		float distance = 0.0f;
+		glm::vec3 position{0.0f};
+		glm::vec3 normal{0.0f};
+		const yocto::material_point *material = nullptr;
+	};
+	bool intersect(const Model &model, const yocto::ray3f &ray, Hit &hit) const;
+
+public:
+	VoxelTracer() = default;
+	VoxelTracer(const VoxelTracer &) = delete;
+	VoxelTracer &operator=(const VoxelTracer &) = delete;
+	~VoxelTracer();
+
+	/**
+	 * @brief Sync the models with the visible model and reference nodes - only the modified volumes are copied again
+	 */
+	void update(const scenegraph::SceneGraph &sceneGraph);
+	void clear();
+
+	/**
+	 * @brief Find the closest voxel along the ray
+	 * @note Thread safe - see yocto::trace_intersect_func
+	 */
+	yocto::trace_point intersect(const yocto::ray3f &ray) const;
+
+	/**
+	 * @return The world space bounds of all models
+	 */
+	yocto::bbox3f bounds() const;
+
+	int models() const {
+		return (int)_models.size();
+	}
+};
+
+} // namespace voxelpathtracer
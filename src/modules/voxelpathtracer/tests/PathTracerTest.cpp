@@ -10,6 +10,7 @@
 #include "io/FormatDescription.h"
 #include "scenegraph/SceneGraph.h"
 #include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
 #include "voxelformat/FormatConfig.h"
 #include "voxelformat/VolumeFormat.h"
 #include "core/GLM.h"
@@ -19,6 +20,16 @@ class PathTracerTest : public app::AbstractTest {
 private:
 	using Super = app::AbstractTest;
 
+protected:
+	void load(scenegraph::SceneGraph &sceneGraph) {
+		const io::ArchivePtr &archive = io::openFilesystemArchive(_testApp->filesystem());
+		io::FileDescription fileDesc;
+		fileDesc.set("hmec.vxl");
+		voxelformat::LoadContext testLoadCtx;
+		ASSERT_TRUE(voxelformat::loadFormat(fileDesc, archive, sceneGraph, testLoadCtx))
+			<< "Could not load " << fileDesc.name.c_str();
+	}
+
 public:
 	bool onInitApp() override {
 		if (!Super::onInitApp()) {
@@ -54,3 +65,187 @@ TEST_F(PathTracerTest, testHMec) {
 	image::writeImage(img, "hmec.vxl.png");
 	ASSERT_TRUE(pathTracer.stop());
 }
+
+TEST_F(PathTracerTest, testAdaptiveSampling) {
+	scenegraph::SceneGraph sceneGraph;
+	load(sceneGraph);
+
+	voxelpathtracer::PathTracer pathTracer;
+	voxelpathtracer::PathTracerState &state = pathTracer.state();
+	state.params.resolution = 128;
+	state.params.samples = 1024;
+	state.params.sampler = yocto::trace_sampler_type::eyelight;
+	state.adaptiveMinSamples = 4;
+	ASSERT_TRUE(pathTracer.start(sceneGraph));
+	int currentSample = 0;
+	while (!pathTracer.update(&currentSample)) {
+		_testApp->wait(10);
+	}
+	EXPECT_EQ(state.params.samples, currentSample);
+	int converged = 0;
+	for (const voxelpathtracer::PathTracerTile &tile : state.tiles) {
+		EXPECT_TRUE(tile.done);
+		EXPECT_FALSE(tile.busy);
+		if (tile.samples < state.params.samples) {
+			++converged;
+		}
+	}
+	EXPECT_GT(converged, 0) << "No tile stopped early";
+}
+
+TEST_F(PathTracerTest, testDenoiseHook) {
+	scenegraph::SceneGraph sceneGraph;
+	load(sceneGraph);
+
+	voxelpathtracer::PathTracer pathTracer;
+	int calls = 0;
+	pathTracer.setDenoiser([&calls](int width, int height, const std::vector<yocto::vec4f> &color,
+									const std::vector<yocto::vec3f> &albedo, const std::vector<yocto::vec3f> &normal,
+									std::vector<yocto::vec4f> &denoised) {
+		++calls;
+		EXPECT_EQ((size_t)(width * height), color.size());
+		EXPECT_EQ(color.size(), albedo.size());
+		EXPECT_EQ(color.size(), normal.size());
+		denoised = color;
+		return true;
+	});
+	pathTracer.state().params.resolution = 64;
+	pathTracer.state().params.samples = 2;
+	pathTracer.state().params.denoise = true;
+	ASSERT_TRUE(pathTracer.start(sceneGraph));
+	while (!pathTracer.update()) {
+		_testApp->wait(10);
+	}
+	EXPECT_EQ(1, calls);
+	EXPECT_FALSE(pathTracer.state().state.denoised.empty());
+	const image::ImagePtr &img = pathTracer.image();
+	ASSERT_TRUE(img);
+	ASSERT_TRUE(img->isLoaded());
+}
+
+TEST_F(PathTracerTest, testRestartKeepsShapes) {
+	scenegraph::SceneGraph sceneGraph;
+	load(sceneGraph);
+
+	voxelpathtracer::PathTracer pathTracer;
+	voxelpathtracer::PathTracerState &state = pathTracer.state();
+	state.params.resolution = 32;
+	state.params.samples = 1;
+	ASSERT_TRUE(pathTracer.start(sceneGraph));
+	ASSERT_FALSE(state.scene.shapes.empty());
+	std::vector<const yocto::vec3f *> positions;
+	for (const yocto::shape_data &shape : state.scene.shapes) {
+		positions.push_back(shape.positions.data());
+	}
+
+	// a camera change or restart keeps the shapes
+	ASSERT_TRUE(pathTracer.restart(sceneGraph));
+	ASSERT_EQ(positions.size(), state.scene.shapes.size());
+	for (size_t i = 0; i < positions.size(); ++i) {
+		EXPECT_EQ(positions[i], state.scene.shapes[i].positions.data());
+	}
+
+	// a transform change only updates the instances
+	scenegraph::SceneGraphNode *node = sceneGraph.firstModelNode();
+	ASSERT_NE(nullptr, node);
+	scenegraph::SceneGraphTransform &transform = node->transform(0);
+	transform.setWorldTranslation(transform.worldTranslation() + glm::vec3(10.0f));
+	transform.update(sceneGraph, *node, 0, true);
+	const std::vector<yocto::instance_data> instances = state.scene.instances;
+	ASSERT_TRUE(pathTracer.restart(sceneGraph));
+	ASSERT_EQ(positions.size(), state.scene.shapes.size());
+	int moved = 0;
+	for (size_t i = 0; i < positions.size(); ++i) {
+		EXPECT_EQ(positions[i], state.scene.shapes[i].positions.data());
+		if (!(instances[i].frame == state.scene.instances[i].frame)) {
+			++moved;
+		}
+	}
+	EXPECT_GT(moved, 0);
+
+	// a volume change extracts the shapes of the node again
+	const voxel::Region &region = node->region();
+	node->volume()->setVoxel(region.getLowerCorner(), voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	ASSERT_TRUE(pathTracer.restart(sceneGraph));
+	int changed = 0;
+	for (size_t i = 0; i < positions.size() && i < state.scene.shapes.size(); ++i) {
+		if (positions[i] != state.scene.shapes[i].positions.data()) {
+			++changed;
+		}
+	}
+	EXPECT_GT(changed, 0);
+	ASSERT_TRUE(pathTracer.stop());
+}
+
+TEST_F(PathTracerTest, testVoxelTracing) {
+	scenegraph::SceneGraph sceneGraph;
+	load(sceneGraph);
+
+	voxelpathtracer::PathTracer pathTracer;
+	voxelpathtracer::PathTracerState &state = pathTracer.state();
+	state.params.resolution = 64;
+	state.params.samples = 2;
+	state.voxelTracing = true;
+	ASSERT_TRUE(pathTracer.start(sceneGraph));
+	EXPECT_TRUE(state.scene.shapes.empty());
+	int currentSample = 0;
+	while (!pathTracer.update(&currentSample)) {
+		_testApp->wait(10);
+	}
+	EXPECT_EQ(state.params.samples, currentSample);
+
+	EXPECT_GT(pathTracer.voxelTracer().models(), 0);
+	ASSERT_TRUE(pathTracer.stop());
+}
+
+TEST_F(PathTracerTest, testVoxelTracerIntersect) {
+	voxel::RawVolume volume(voxel::Region(0, 3));
+	volume.fill(voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(&volume, false);
+	ASSERT_NE(InvalidNodeId, sceneGraph.emplace(core::move(node)));
+
+	voxelpathtracer::VoxelTracer tracer;
+	tracer.update(sceneGraph);
+	ASSERT_EQ(1, tracer.models());
+
+	yocto::ray3f ray{{2.5f, 2.5f, -10.0f}, {0.0f, 0.0f, 1.0f}};
+	yocto::trace_point point = tracer.intersect(ray);
+	ASSERT_TRUE(point.hit);
+	EXPECT_NEAR(0.0f, point.position.z, 0.01f);
+	EXPECT_FLOAT_EQ(-1.0f, point.normal.z);
+
+	ray = yocto::ray3f{{2.5f, 10.0f, 2.5f}, {1.0f, 0.0f, 0.0f}};
+	point = tracer.intersect(ray);
+	EXPECT_FALSE(point.hit);
+}
+
+TEST_F(PathTracerTest, testVoxelTracerReference) {
+	voxel::RawVolume volume(voxel::Region(0, 3));
+	volume.fill(voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(&volume, false);
+	const int modelNodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(InvalidNodeId, modelNodeId);
+
+	scenegraph::SceneGraphNode reference(scenegraph::SceneGraphNodeType::ModelReference);
+	reference.setReference(modelNodeId);
+	scenegraph::SceneGraphTransform transform;
+	transform.setWorldTranslation(glm::vec3(10.0f, 0.0f, 0.0f));
+	reference.setTransform(0, transform);
+	ASSERT_NE(InvalidNodeId, sceneGraph.emplace(core::move(reference)));
+	sceneGraph.updateTransforms();
+
+	voxelpathtracer::VoxelTracer tracer;
+	tracer.update(sceneGraph);
+	ASSERT_EQ(2, tracer.models());
+
+	// the ray misses the model node and only hits the translated reference node
+	yocto::ray3f ray{{12.5f, 2.5f, -10.0f}, {0.0f, 0.0f, 1.0f}};
+	yocto::trace_point point = tracer.intersect(ray);
+	ASSERT_TRUE(point.hit);
+	EXPECT_NEAR(0.0f, point.position.z, 0.01f);
+	EXPECT_FLOAT_EQ(-1.0f, point.normal.z);
+}
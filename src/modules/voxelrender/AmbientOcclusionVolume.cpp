@@ -0,0 +1,159 @@
+/**
+ * @file
+ */
+
+#include "AmbientOcclusionVolume.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Voxel.h"
+
+namespace voxelrender {
+
+static constexpr int BoxSize = 2 * AmbientOcclusionVolume::Radius + 1;
+static constexpr int BoxVoxels = BoxSize * BoxSize * BoxSize;
+
+static inline size_t texelIndex(const glm::ivec3 &pos, const glm::ivec3 &dim) {
+	return (size_t)pos.x + (size_t)dim.x * ((size_t)pos.y + (size_t)dim.y * (size_t)pos.z);
+}
+
+/**
+ * @brief Sums up the values in a window of @c BoxSize along the given axis - the output is @c BoxSize - 1 values
+ * smaller than the input along this axis
+ */
+static void boxSum(const uint16_t *in, const glm::ivec3 &inDim, int axis, uint16_t *out) {
+	glm::ivec3 outDim = inDim;
+	outDim[axis] -= BoxSize - 1;
+	const size_t inStride = axis == 0 ? 1u : (axis == 1 ? (size_t)inDim.x : (size_t)inDim.x * inDim.y);
+	const size_t outStride = axis == 0 ? 1u : (axis == 1 ? (size_t)outDim.x : (size_t)outDim.x * outDim.y);
+	const int a = (axis + 1) % 3;
+	const int b = (axis + 2) % 3;
+	glm::ivec3 pos(0);
+	for (pos[b] = 0; pos[b] < outDim[b]; ++pos[b]) {
+		for (pos[a] = 0; pos[a] < outDim[a]; ++pos[a]) {
+			pos[axis] = 0;
+			const uint16_t *src = in + texelIndex(pos, inDim);
+			uint16_t *dst = out + texelIndex(pos, outDim);
+			uint32_t sum = 0u;
+			for (int i = 0; i < BoxSize; ++i) {
+				sum += src[i * inStride];
+			}
+			dst[0] = (uint16_t)sum;
+			for (int i = 1; i < outDim[axis]; ++i) {
+				sum += src[(i + BoxSize - 1) * inStride];
+				sum -= src[(i - 1) * inStride];
+				dst[i * outStride] = (uint16_t)sum;
+			}
+		}
+	}
+}
+
+bool AmbientOcclusionVolume::init(const voxel::Region &volumeRegion) {
+	shutdown();
+	if (!volumeRegion.isValid()) {
+		return false;
+	}
+	_volumeRegion = volumeRegion;
+	_region = voxel::Region(volumeRegion.getLowerCorner() - 1, volumeRegion.getUpperCorner() + 1);
+	const glm::ivec3 &dim = _region.getDimensionsInVoxels();
+	_occlusion.resize((size_t)dim.x * dim.y * dim.z);
+	_occlusion.fill(0u);
+	_dirtyRegion = _region;
+	return true;
+}
+
+void AmbientOcclusionVolume::shutdown() {
+	_volumeRegion = voxel::Region::InvalidRegion;
+	_region = voxel::Region::InvalidRegion;
+	_occlusion.release();
+	_dirtyRegion = voxel::Region::InvalidRegion;
+}
+
+uint8_t AmbientOcclusionVolume::occlusion(const glm::ivec3 &pos) const {
+	if (!_region.containsPoint(pos.x, pos.y, pos.z)) {
+		return 0u;
+	}
+	return _occlusion[texelIndex(pos - _region.getLowerCorner(), _region.getDimensionsInVoxels())];
+}
+
+bool AmbientOcclusionVolume::update(const voxel::RawVolume &volume, const voxel::Region &region) {
+	core_trace_scoped(AmbientOcclusionVolumeUpdate);
+	if (!_region.isValid() || volume.region() != _volumeRegion) {
+		return false;
+	}
+	// the texels that have any of the changed voxels in their box
+	voxel::Region affected(region.getLowerCorner() - Radius, region.getUpperCorner() + Radius);
+	if (!affected.cropTo(_region)) {
+		return true;
+	}
+	const glm::ivec3 &dim = affected.getDimensionsInVoxels();
+	const glm::ivec3 srcMins = affected.getLowerCorner() - Radius;
+	const glm::ivec3 srcDim = dim + 2 * Radius;
+
+	// the solid voxels around the affected texels - everything outside of the volume is air
+	core::DynamicArray<uint16_t> solid;
+	solid.resize((size_t)srcDim.x * srcDim.y * srcDim.z);
+	solid.fill(0u);
+	voxel::Region srcRegion(srcMins, srcMins + srcDim - 1);
+	if (srcRegion.cropTo(_volumeRegion)) {
+		const int width = srcRegion.getWidthInVoxels();
+		for (int z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
+			for (int y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
+				const voxel::Voxel *row = volume.row(glm::ivec3(srcRegion.getLowerX(), y, z));
+				uint16_t *dst = &solid[texelIndex(glm::ivec3(srcRegion.getLowerX(), y, z) - srcMins, srcDim)];
+				for (int x = 0; x < width; ++x) {
+					const voxel::VoxelType material = row[x].getMaterial();
+					// the transparent voxels don't occlude - just like for the ambient occlusion of the vertices
+					dst[x] = !voxel::isAir(material) && !voxel::isTransparent(material) ? 1u : 0u;
+				}
+			}
+		}
+	}
+
+	// the box is separable - sum up the axes one after another
+	core::DynamicArray<uint16_t> sumX;
+	sumX.resize((size_t)dim.x * srcDim.y * srcDim.z);
+	boxSum(solid.data(), srcDim, 0, sumX.data());
+	solid.resize((size_t)dim.x * dim.y * srcDim.z);
+	boxSum(sumX.data(), glm::ivec3(dim.x, srcDim.y, srcDim.z), 1, solid.data());
+	sumX.resize((size_t)dim.x * dim.y * dim.z);
+	boxSum(solid.data(), glm::ivec3(dim.x, dim.y, srcDim.z), 2, sumX.data());
+
+	const glm::ivec3 &texelDim = _region.getDimensionsInVoxels();
+	const glm::ivec3 offset = affected.getLowerCorner() - _region.getLowerCorner();
+	for (int z = 0; z < dim.z; ++z) {
+		for (int y = 0; y < dim.y; ++y) {
+			const uint16_t *src = &sumX[texelIndex(glm::ivec3(0, y, z), dim)];
+			uint8_t *dst = &_occlusion[texelIndex(offset + glm::ivec3(0, y, z), texelDim)];
+			for (int x = 0; x < dim.x; ++x) {
+				dst[x] = (uint8_t)((src[x] * 255u + BoxVoxels / 2) / BoxVoxels);
+			}
+		}
+	}
+	if (_dirtyRegion.isValid()) {
+		_dirtyRegion.accumulate(affected);
+	} else {
+		_dirtyRegion = affected;
+	}
+	return true;
+}
+
+void AmbientOcclusionVolume::copyTexels(const voxel::Region &region, core::DynamicArray<uint8_t> &out) const {
+	voxel::Region copyRegion = region;
+	if (!copyRegion.cropTo(_region)) {
+		out.clear();
+		return;
+	}
+	const glm::ivec3 &dim = copyRegion.getDimensionsInVoxels();
+	const glm::ivec3 &texelDim = _region.getDimensionsInVoxels();
+	const glm::ivec3 offset = copyRegion.getLowerCorner() - _region.getLowerCorner();
+	out.resize((size_t)dim.x * dim.y * dim.z);
+	for (int z = 0; z < dim.z; ++z) {
+		for (int y = 0; y < dim.y; ++y) {
+			const uint8_t *src = &_occlusion[texelIndex(offset + glm::ivec3(0, y, z), texelDim)];
+			core_memcpy(&out[texelIndex(glm::ivec3(0, y, z), dim)], src, dim.x);
+		}
+	}
+}
+
+} // namespace voxelrender
@@ -0,0 +1,107 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/DynamicArray.h"
+#include "voxel/Region.h"
+#include <glm/vec3.hpp>
+
+namespace voxel {
+class RawVolume;
+}
+
+namespace voxelrender {
+
+/**
+ * @brief The ambient occlusion of a volume in a 3d texture for the fragment shader
+ *
+ * Each texel holds the fraction of solid voxels in the box of @c Radius voxels around the voxel. The shader samples
+ * the texel in front of a face - the neighbourhood is much larger than the direct neighbours that are used for the
+ * ambient occlusion of the vertices of the cubic extractor, and the meshes can be extracted without it.
+ *
+ * The texture is one voxel larger than the volume on each side - the faces at the volume borders have their air
+ * voxels in the texture, too.
+ *
+ * @sa cfg::VoxelAOVolume
+ * @sa voxel.frag
+ */
+class AmbientOcclusionVolume {
+public:
+	static constexpr int Radius = 3;
+
+private:
+	// the region of the volume the occlusion is computed for
+	voxel::Region _volumeRegion = voxel::Region::InvalidRegion;
+	// the region of the texels - the volume region plus one voxel on each side
+	voxel::Region _region = voxel::Region::InvalidRegion;
+	core::DynamicArray<uint8_t> _occlusion;
+	// the texels that changed since the last markClean() call
+	voxel::Region _dirtyRegion = voxel::Region::InvalidRegion;
+
+public:
+	/**
+	 * @brief Sets up the texels for the given volume region - nothing is occluded until @c update() was called
+	 */
+	bool init(const voxel::Region &volumeRegion);
+	void shutdown();
+
+	/**
+	 * @brief Computes the occlusion of the texels that are affected by changes in the given region of the volume
+	 * @note The volume region must match the region the occlusion volume was initialized with
+	 */
+	bool update(const voxel::RawVolume &volume, const voxel::Region &region);
+
+	/**
+	 * @return The region of the texels in volume coordinates
+	 */
+	const voxel::Region &region() const;
+	const voxel::Region &volumeRegion() const;
+	/**
+	 * @return The occlusion of the texel at the given volume position - @c 0 is not occluded at all, @c 255 is
+	 * fully occluded
+	 */
+	uint8_t occlusion(const glm::ivec3 &pos) const;
+	const core::DynamicArray<uint8_t> &data() const;
+	/**
+	 * @brief Copies the texels of the given region (in volume coordinates) into a tightly packed buffer
+	 */
+	void copyTexels(const voxel::Region &region, core::DynamicArray<uint8_t> &out) const;
+
+	/**
+	 * @return @c true if the data changed since the last call of @c markClean() and must be uploaded again
+	 */
+	bool dirty() const;
+	/**
+	 * @return The texels (in volume coordinates) that changed since the last call of @c markClean()
+	 */
+	const voxel::Region &dirtyRegion() const;
+	void markClean();
+};
+
+inline const voxel::Region &AmbientOcclusionVolume::region() const {
+	return _region;
+}
+
+inline const voxel::Region &AmbientOcclusionVolume::volumeRegion() const {
+	return _volumeRegion;
+}
+
+inline const core::DynamicArray<uint8_t> &AmbientOcclusionVolume::data() const {
+	return _occlusion;
+}
+
+inline bool AmbientOcclusionVolume::dirty() const {
+	return _dirtyRegion.isValid();
+}
+
+inline const voxel::Region &AmbientOcclusionVolume::dirtyRegion() const {
+	return _dirtyRegion;
+}
+
+inline void AmbientOcclusionVolume::markClean() {
+	_dirtyRegion = voxel::Region::InvalidRegion;
+}
+
+} // namespace voxelrender
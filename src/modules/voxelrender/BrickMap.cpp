@@ -0,0 +1,221 @@
+/**
+ * @file
+ */
+
+#include "BrickMap.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Voxel.h"
+#include <glm/vector_relational.hpp>
+
+namespace voxelrender {
+
+static void accumulateRegion(voxel::Region &target, const voxel::Region &region) {
+	if (target.isValid()) {
+		target.accumulate(region);
+	} else {
+		target = region;
+	}
+}
+
+static void copyBox(const core::DynamicArray<uint8_t> &data, const glm::ivec3 &dim, int components,
+					const voxel::Region &box, core::DynamicArray<uint8_t> &out) {
+	const glm::ivec3 &boxDim = box.getDimensionsInVoxels();
+	const size_t rowBytes = (size_t)boxDim.x * components;
+	out.resize(rowBytes * boxDim.y * boxDim.z);
+	uint8_t *target = out.data();
+	for (int z = box.getLowerZ(); z <= box.getUpperZ(); ++z) {
+		for (int y = box.getLowerY(); y <= box.getUpperY(); ++y) {
+			const size_t offset = (((size_t)z * dim.y + y) * dim.x + box.getLowerX()) * components;
+			core_memcpy(target, &data[offset], rowBytes);
+			target += rowBytes;
+		}
+	}
+}
+
+bool BrickMap::init(const voxel::Region &region) {
+	shutdown();
+	if (!region.isValid()) {
+		return false;
+	}
+	_region = region;
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	_bricks = (dim + BrickSize - 1) / BrickSize;
+	const int brickCount = _bricks.x * _bricks.y * _bricks.z;
+	// small volumes get a small atlas - the layers of slots are added on demand
+	_atlasSlots.x = core_min(brickCount, MaxAtlasSlots);
+	_atlasSlots.y = core_min((brickCount + _atlasSlots.x - 1) / _atlasSlots.x, MaxAtlasSlots);
+	_atlasSlots.z = 0;
+	_brickSlots.resize(brickCount);
+	_brickSlots.fill(-1);
+	_indirection.resize((size_t)brickCount * IndirectionComponents);
+	_indirection.fill(0u);
+	_dirtyBricks = voxel::Region(glm::ivec3(0), _bricks - 1);
+	_dirtySlots = voxel::Region::InvalidRegion;
+	return true;
+}
+
+void BrickMap::shutdown() {
+	_region = voxel::Region::InvalidRegion;
+	_bricks = glm::ivec3(0);
+	_atlasSlots = glm::ivec3(0);
+	_brickSlots.release();
+	_freeSlots.release();
+	_usedSlots = 0;
+	_indirection.release();
+	_atlas.release();
+	markClean();
+}
+
+int BrickMap::brickIndex(int x, int y, int z) const {
+	return x + _bricks.x * (y + _bricks.y * z);
+}
+
+glm::ivec3 BrickMap::slotPosition(int slot) const {
+	const int layer = _atlasSlots.x * _atlasSlots.y;
+	return glm::ivec3(slot % _atlasSlots.x, (slot / _atlasSlots.x) % _atlasSlots.y, slot / layer);
+}
+
+int BrickMap::brickSlot(const glm::ivec3 &brick) const {
+	if (glm::any(glm::lessThan(brick, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(brick, _bricks))) {
+		return -1;
+	}
+	return _brickSlots[brickIndex(brick.x, brick.y, brick.z)];
+}
+
+int BrickMap::allocateSlot() {
+	if (!_freeSlots.empty()) {
+		const int slot = _freeSlots.back();
+		_freeSlots.pop();
+		return slot;
+	}
+	const int slot = _usedSlots;
+	const glm::ivec3 &pos = slotPosition(slot);
+	// the slot coordinates are stored in 8 bit
+	if (pos.z > 255) {
+		return -1;
+	}
+	if (pos.z >= _atlasSlots.z) {
+		// the layers are the slowest axis of the 3d texture - a new layer is appended to the data
+		_atlasSlots.z = pos.z + 1;
+		const glm::ivec3 &dim = atlasDimension();
+		_atlas.resize((size_t)dim.x * dim.y * dim.z * AtlasComponents);
+		// the new layer is uploaded with the rest of the atlas because the texture storage grows
+	}
+	++_usedSlots;
+	return slot;
+}
+
+bool BrickMap::updateBrick(const voxel::RawVolume &volume, const glm::ivec3 &brick) {
+	const glm::ivec3 &lower = _region.getLowerCorner() + brick * BrickSize;
+	voxel::Region brickRegion(lower, lower + BrickSize - 1);
+	brickRegion.cropTo(_region);
+
+	uint8_t colors[BrickSize * BrickSize * BrickSize];
+	bool solid[BrickSize * BrickSize * BrickSize];
+	core_memset(solid, 0, sizeof(solid));
+	bool empty = true;
+	const int width = brickRegion.getWidthInVoxels();
+	for (int z = brickRegion.getLowerZ(); z <= brickRegion.getUpperZ(); ++z) {
+		for (int y = brickRegion.getLowerY(); y <= brickRegion.getUpperY(); ++y) {
+			const voxel::Voxel *row = volume.row(glm::ivec3(brickRegion.getLowerX(), y, z));
+			const int offset = ((z - lower.z) * BrickSize + (y - lower.y)) * BrickSize + (brickRegion.getLowerX() - lower.x);
+			for (int x = 0; x < width; ++x) {
+				const voxel::Voxel &voxel = row[x];
+				if (voxel::isAir(voxel.getMaterial())) {
+					continue;
+				}
+				colors[offset + x] = voxel.getColor();
+				solid[offset + x] = true;
+				empty = false;
+			}
+		}
+	}
+
+	const int idx = brickIndex(brick.x, brick.y, brick.z);
+	uint8_t *indirection = &_indirection[(size_t)idx * IndirectionComponents];
+	int32_t &slot = _brickSlots[idx];
+	if (empty) {
+		if (slot != -1) {
+			_freeSlots.push_back(slot);
+			slot = -1;
+		}
+		indirection[3] = 0u;
+		return true;
+	}
+	if (slot == -1) {
+		slot = allocateSlot();
+		if (slot == -1) {
+			Log::error("The brick map atlas is full");
+			return false;
+		}
+	}
+	const glm::ivec3 &pos = slotPosition(slot);
+	indirection[0] = (uint8_t)pos.x;
+	indirection[1] = (uint8_t)pos.y;
+	indirection[2] = (uint8_t)pos.z;
+	indirection[3] = 255u;
+
+	accumulateRegion(_dirtySlots, voxel::Region(pos, pos));
+	const glm::ivec3 &dim = atlasDimension();
+	const glm::ivec3 base = pos * BrickSize;
+	for (int z = 0; z < BrickSize; ++z) {
+		for (int y = 0; y < BrickSize; ++y) {
+			uint8_t *texel = &_atlas[(((size_t)(base.z + z) * dim.y + (base.y + y)) * dim.x + base.x) * AtlasComponents];
+			for (int x = 0; x < BrickSize; ++x) {
+				const int i = (z * BrickSize + y) * BrickSize + x;
+				texel[x * AtlasComponents + 0] = solid[i] ? colors[i] : 0u;
+				texel[x * AtlasComponents + 1] = solid[i] ? 255u : 0u;
+			}
+		}
+	}
+	return true;
+}
+
+bool BrickMap::update(const voxel::RawVolume &volume, const voxel::Region &region) {
+	core_trace_scoped(BrickMapUpdate);
+	if (!_region.isValid() || volume.region() != _region) {
+		return false;
+	}
+	voxel::Region cropped = region;
+	if (!cropped.cropTo(_region)) {
+		return true;
+	}
+	const glm::ivec3 mins = (cropped.getLowerCorner() - _region.getLowerCorner()) / BrickSize;
+	const glm::ivec3 maxs = (cropped.getUpperCorner() - _region.getLowerCorner()) / BrickSize;
+	bool success = true;
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			for (int x = mins.x; x <= maxs.x; ++x) {
+				if (!updateBrick(volume, glm::ivec3(x, y, z))) {
+					success = false;
+				}
+			}
+		}
+	}
+	accumulateRegion(_dirtyBricks, voxel::Region(mins, maxs));
+	return success;
+}
+
+void BrickMap::copyIndirection(const voxel::Region &bricks, core::DynamicArray<uint8_t> &out) const {
+	voxel::Region box = bricks;
+	if (!box.cropTo(voxel::Region(glm::ivec3(0), _bricks - 1))) {
+		out.clear();
+		return;
+	}
+	copyBox(_indirection, _bricks, IndirectionComponents, box, out);
+}
+
+void BrickMap::copyAtlas(const voxel::Region &slots, core::DynamicArray<uint8_t> &out) const {
+	voxel::Region box = slots;
+	if (_atlasSlots.z <= 0 || !box.cropTo(voxel::Region(glm::ivec3(0), _atlasSlots - 1))) {
+		out.clear();
+		return;
+	}
+	const voxel::Region texels(box.getLowerCorner() * BrickSize, (box.getUpperCorner() + 1) * BrickSize - 1);
+	copyBox(_atlas, atlasDimension(), AtlasComponents, texels, out);
+}
+
+} // namespace voxelrender
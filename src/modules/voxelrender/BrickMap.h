@@ -0,0 +1,158 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/DynamicArray.h"
+#include "voxel/Region.h"
+#include <glm/vec3.hpp>
+
+namespace voxel {
+class RawVolume;
+}
+
+namespace voxelrender {
+
+/**
+ * @brief A sparse representation of a volume for the ray marching in the shader
+ *
+ * The volume is split into bricks of @c BrickSize voxels per axis. Only the bricks that contain any voxels are stored
+ * in the atlas - the indirection grid has one texel per brick with the slot of the brick in the atlas. The ray
+ * marcher skips the empty bricks at once.
+ *
+ * The indirection texels are RGBA8 - the slot coordinates in rgb and the alpha is set for non empty bricks. The atlas
+ * texels are RG8 - the palette color index and whether the voxel is solid.
+ *
+ * @sa raymarch.frag
+ */
+class BrickMap {
+public:
+	static constexpr int BrickSize = 8;
+	// the maximum amount of atlas slots in x and y - the slots are stacked in z
+	static constexpr int MaxAtlasSlots = 32;
+	static constexpr int IndirectionComponents = 4;
+	static constexpr int AtlasComponents = 2;
+
+private:
+	voxel::Region _region = voxel::Region::InvalidRegion;
+	glm::ivec3 _bricks{0};
+	// the slots per axis of the atlas - z grows with the amount of non empty bricks
+	glm::ivec3 _atlasSlots{0};
+	// the atlas slot for each brick - -1 for empty bricks
+	core::DynamicArray<int32_t> _brickSlots;
+	core::DynamicArray<int32_t> _freeSlots;
+	int _usedSlots = 0;
+	core::DynamicArray<uint8_t> _indirection;
+	core::DynamicArray<uint8_t> _atlas;
+	// the bricks whose indirection texels changed since the last markClean() call - in brick coordinates
+	voxel::Region _dirtyBricks = voxel::Region::InvalidRegion;
+	// the atlas slots that were written since the last markClean() call - in slot coordinates
+	voxel::Region _dirtySlots = voxel::Region::InvalidRegion;
+
+	int brickIndex(int x, int y, int z) const;
+	glm::ivec3 slotPosition(int slot) const;
+	int allocateSlot();
+	bool updateBrick(const voxel::RawVolume &volume, const glm::ivec3 &brick);
+
+public:
+	/**
+	 * @brief Sets up an empty brick map for the given volume region
+	 */
+	bool init(const voxel::Region &region);
+	void shutdown();
+
+	/**
+	 * @brief Rebuilds the bricks that intersect the given region of the volume
+	 * @note The volume region must match the region the brick map was initialized with
+	 */
+	bool update(const voxel::RawVolume &volume, const voxel::Region &region);
+
+	const voxel::Region &region() const;
+	/**
+	 * @return The size of the indirection grid in bricks
+	 */
+	const glm::ivec3 &bricks() const;
+	/**
+	 * @return The size of the atlas in voxels
+	 */
+	glm::ivec3 atlasDimension() const;
+	/**
+	 * @return The amount of non empty bricks
+	 */
+	int usedBricks() const;
+	/**
+	 * @return The atlas slot of the brick or @c -1 if the brick is empty
+	 */
+	int brickSlot(const glm::ivec3 &brick) const;
+
+	const core::DynamicArray<uint8_t> &indirection() const;
+	const core::DynamicArray<uint8_t> &atlas() const;
+
+	/**
+	 * @return @c true if the data changed since the last call of @c markClean() and must be uploaded again
+	 */
+	bool dirty() const;
+	/**
+	 * @return The box of bricks (in brick coordinates) whose indirection texels changed since the last call of
+	 * @c markClean() - invalid if none changed
+	 */
+	const voxel::Region &dirtyBricks() const;
+	/**
+	 * @return The box of atlas slots (in slot coordinates - multiply by @c BrickSize for the texels) that changed since
+	 * the last call of @c markClean() - invalid if none changed
+	 */
+	const voxel::Region &dirtySlots() const;
+	/**
+	 * @brief Copies the indirection texels of the given box of bricks into a tightly packed buffer
+	 */
+	void copyIndirection(const voxel::Region &bricks, core::DynamicArray<uint8_t> &out) const;
+	/**
+	 * @brief Copies the atlas texels of the given box of slots into a tightly packed buffer
+	 */
+	void copyAtlas(const voxel::Region &slots, core::DynamicArray<uint8_t> &out) const;
+	void markClean();
+};
+
+inline const voxel::Region &BrickMap::region() const {
+	return _region;
+}
+
+inline const glm::ivec3 &BrickMap::bricks() const {
+	return _bricks;
+}
+
+inline glm::ivec3 BrickMap::atlasDimension() const {
+	return _atlasSlots * BrickSize;
+}
+
+inline int BrickMap::usedBricks() const {
+	return _usedSlots - (int)_freeSlots.size();
+}
+
+inline const core::DynamicArray<uint8_t> &BrickMap::indirection() const {
+	return _indirection;
+}
+
+inline const core::DynamicArray<uint8_t> &BrickMap::atlas() const {
+	return _atlas;
+}
+
+inline bool BrickMap::dirty() const {
+	return _dirtyBricks.isValid() || _dirtySlots.isValid();
+}
+
+inline const voxel::Region &BrickMap::dirtyBricks() const {
+	return _dirtyBricks;
+}
+
+inline const voxel::Region &BrickMap::dirtySlots() const {
+	return _dirtySlots;
+}
+
+inline void BrickMap::markClean() {
+	_dirtyBricks = voxel::Region::InvalidRegion;
+	_dirtySlots = voxel::Region::InvalidRegion;
+}
+
+} // namespace voxelrender
@@ -0,0 +1,130 @@
+/**
+ * @file
+ */
+
+#include "ComputeNoise.h"
+#include "NoisefieldShaderConstants.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "noise/Noise.h"
+#include "noise/Simplex.h"
+#include "video/Renderer.h"
+#include "video/Shader.h"
+#include <glm/common.hpp>
+
+namespace voxelrender {
+
+// see noise::details::perm
+static constexpr int PermSize = 512;
+
+ComputeNoise::ComputeNoise() : _shader(shader::NoisefieldShader::getInstance()) {
+}
+
+bool ComputeNoise::init() {
+	if (!video::hasFeature(video::Feature::ComputeShaders) ||
+		!video::hasFeature(video::Feature::ShaderStorageBufferObject)) {
+		Log::debug("No compute shader support - the noise is computed on the cpu");
+		return false;
+	}
+	if (!_shader.setup()) {
+		Log::warn("Failed to initialize the noisefield shader - the noise is computed on the cpu");
+		return false;
+	}
+	alignas(16) shader::NoisefieldData::BlockData var;
+	_uniformBlock.create(var);
+	int32_t perm[PermSize];
+	core_memset(perm, 0, sizeof(perm));
+	_perm.create(perm, sizeof(perm));
+	const float cell = 0.0f;
+	_field.create(&cell, sizeof(cell));
+	_fieldSize = sizeof(cell);
+	_supported = true;
+	return true;
+}
+
+void ComputeNoise::shutdown() {
+	if (_supported) {
+		_shader.shutdown();
+	}
+	_uniformBlock.shutdown();
+	_perm.shutdown();
+	_field.shutdown();
+	_fieldSize = 0u;
+	_supported = false;
+}
+
+bool ComputeNoise::run(const glm::ivec3 &mins, const glm::ivec3 &dimensions, int axes,
+					   const noise::NoiseFieldParams &params, core::DynamicArray<float> &field) {
+	if (!_supported) {
+		return false;
+	}
+	const glm::ivec3 dim = glm::max(dimensions, glm::ivec3(0));
+	const size_t cells = (size_t)dim.x * dim.y * dim.z;
+	if (cells == 0u) {
+		field.clear();
+		return true;
+	}
+	const size_t size = cells * sizeof(float);
+	const int maxSize = video::limit(video::Limit::MaxShaderStorageBufferSize);
+	if (maxSize > 0 && size > (size_t)maxSize) {
+		return false;
+	}
+	core_trace_scoped(ComputeNoiseField);
+	if (size > _fieldSize) {
+		if (!_field.update(nullptr, size)) {
+			return false;
+		}
+		_fieldSize = size;
+	}
+	int32_t perm[PermSize];
+	for (int i = 0; i < PermSize; ++i) {
+		perm[i] = noise::details::perm[i];
+	}
+	_perm.updateSubData(0, perm, sizeof(perm));
+
+	alignas(16) shader::NoisefieldData::BlockData var;
+	var.mins = mins;
+	var.type = (int)params.type;
+	var.size = dim;
+	var.dimensions = axes;
+	var.offset = params.offset;
+	var.frequency = params.frequency;
+	var.octaves = params.octaves;
+	var.lacunarity = params.lacunarity;
+	var.gain = params.gain;
+	var.ridgeoffset = params.ridgeOffset;
+	_uniformBlock.update(var);
+
+	const int workGroupSize = shader::NoisefieldShaderConstants::getWorkGroupSize();
+	const glm::uvec3 workGroups((dim.x + workGroupSize - 1) / workGroupSize, (dim.y + workGroupSize - 1) / workGroupSize,
+								dim.z);
+	video::ScopedShader scoped(_shader);
+	_shader.setBlock(_uniformBlock.getBlockUniformBuffer());
+	_perm.bind(_shader.getBindingPermbuffer());
+	_field.bind(_shader.getBindingFieldbuffer());
+	if (!_shader.run(workGroups, true)) {
+		Log::debug("Failed to run the noisefield shader");
+		return false;
+	}
+	const float *data = (const float *)_field.map(video::AccessMode::Read);
+	if (data == nullptr) {
+		return false;
+	}
+	field.resize(cells);
+	core_memcpy(field.data(), data, size);
+	_field.unmap();
+	return true;
+}
+
+bool ComputeNoise::fillVolume(const glm::ivec3 &mins, const glm::ivec3 &dimensions,
+							  const noise::NoiseFieldParams &params, core::DynamicArray<float> &field) {
+	return run(mins, dimensions, 3, params, field);
+}
+
+bool ComputeNoise::fillHeightmap(const glm::ivec2 &mins, const glm::ivec2 &dimensions,
+								 const noise::NoiseFieldParams &params, core::DynamicArray<float> &field) {
+	return run(glm::ivec3(mins, 0), glm::ivec3(dimensions, 1), 2, params, field);
+}
+
+} // namespace voxelrender
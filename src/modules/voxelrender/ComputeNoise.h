@@ -0,0 +1,75 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "NoisefieldData.h"
+#include "NoisefieldShader.h"
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+#include "video/ShaderStorageBuffer.h"
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+namespace noise {
+struct NoiseFieldParams;
+}
+
+namespace voxelrender {
+
+/**
+ * @brief Samples the noise fields of @c noise::Noise::fillVolume() and @c noise::Noise::fillHeightmap() with a compute
+ * shader
+ *
+ * The permutation table of the simplex noise of the calling thread is uploaded for every call - the cells are written
+ * into a shader storage buffer and read back into the same layout as the cpu version uses. All @c noise::NoiseType
+ * values are supported.
+ *
+ * @note The simplex grid is skewed with double precision like on the cpu - but the results are still not guaranteed
+ * to be bitwise identical as the gpu may contract multiplications and additions. Use the cpu version if the results
+ * must be reproducible across machines.
+ * @note Needs a current gl context - this is also true for a hidden window of the command line tools
+ * @sa noisefield.comp
+ */
+class ComputeNoise : public core::NonCopyable {
+private:
+	shader::NoisefieldShader &_shader;
+	shader::NoisefieldData _uniformBlock;
+	video::ShaderStorageBuffer _perm;
+	video::ShaderStorageBuffer _field;
+	size_t _fieldSize = 0u;
+	bool _supported = false;
+
+	bool run(const glm::ivec3 &mins, const glm::ivec3 &dimensions, int axes, const noise::NoiseFieldParams &params,
+			 core::DynamicArray<float> &field);
+
+public:
+	ComputeNoise();
+
+	/**
+	 * @return @c false if compute shaders are not supported - the fill functions always fail then
+	 */
+	bool init();
+	void shutdown();
+
+	inline bool supported() const {
+		return _supported;
+	}
+
+	/**
+	 * @brief Same as @c noise::Noise::fillVolume()
+	 * @return @c false if the field couldn't get computed on the gpu - use the cpu version then
+	 */
+	bool fillVolume(const glm::ivec3 &mins, const glm::ivec3 &dimensions, const noise::NoiseFieldParams &params,
+					core::DynamicArray<float> &field);
+
+	/**
+	 * @brief Same as @c noise::Noise::fillHeightmap()
+	 * @return @c false if the field couldn't get computed on the gpu - use the cpu version then
+	 */
+	bool fillHeightmap(const glm::ivec2 &mins, const glm::ivec2 &dimensions, const noise::NoiseFieldParams &params,
+					   core::DynamicArray<float> &field);
+};
+
+} // namespace voxelrender
@@ -0,0 +1,218 @@
+/**
+ * @file
+ */
+
+#include "ComputeSurfaceExtractor.h"
+#include "CubicfacesShaderConstants.h"
+#include "core/Assert.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "video/Renderer.h"
+#include "video/Shader.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/Face.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+#include "voxel/VoxelVertex.h"
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
+
+namespace voxelrender {
+
+// the corners of the faces in the vertex order of the quads of the cpu extractor - indexed by voxel::FaceNames
+static const glm::ivec3 FaceCorners[(int)voxel::FaceNames::Max][4] = {
+	{{0, 0, 0}, {0, 1, 0}, {0, 1, 1}, {0, 0, 1}}, // PositiveX
+	{{0, 0, 0}, {0, 0, 1}, {1, 0, 1}, {1, 0, 0}}, // PositiveY
+	{{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}}, // PositiveZ
+	{{0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0}}, // NegativeX
+	{{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}}, // NegativeY
+	{{0, 0, 0}, {0, 1, 0}, {1, 1, 0}, {1, 0, 0}}  // NegativeZ
+};
+
+static inline uint32_t packVoxel(const voxel::Voxel &voxel) {
+	return (uint32_t)voxel.getMaterial() | ((uint32_t)voxel.getFlags() << 2u) | ((uint32_t)voxel.getColor() << 8u) |
+		   ((uint32_t)voxel.getNormal() << 16u);
+}
+
+ComputeSurfaceExtractor::ComputeSurfaceExtractor() : _shader(shader::CubicfacesShader::getInstance()) {
+}
+
+bool ComputeSurfaceExtractor::init() {
+	if (!video::hasFeature(video::Feature::ComputeShaders) ||
+		!video::hasFeature(video::Feature::ShaderStorageBufferObject)) {
+		Log::debug("No compute shader support - the meshes are extracted on the cpu");
+		return false;
+	}
+	if (!_shader.setup()) {
+		Log::warn("Failed to initialize the cubicfaces shader - the meshes are extracted on the cpu");
+		return false;
+	}
+	alignas(16) shader::CubicfacesData::BlockData var;
+	_uniformBlock.create(var);
+	const uint32_t counter = 0u;
+	_voxels.create(&counter, sizeof(counter));
+	_faces.create(&counter, sizeof(counter));
+	_maxFaces = 0u;
+	_supported = true;
+	return true;
+}
+
+void ComputeSurfaceExtractor::shutdown() {
+	if (_supported) {
+		_shader.shutdown();
+	}
+	_uniformBlock.shutdown();
+	_voxels.shutdown();
+	_faces.shutdown();
+	_voxelData.release();
+	_maxFaces = 0u;
+	_supported = false;
+}
+
+bool ComputeSurfaceExtractor::reserveFaces(uint32_t faces) {
+	if (faces <= _maxFaces) {
+		return true;
+	}
+	const size_t size = sizeof(uint32_t) + (size_t)faces * 2u * sizeof(uint32_t);
+	const int maxSize = video::limit(video::Limit::MaxShaderStorageBufferSize);
+	if (maxSize > 0 && size > (size_t)maxSize) {
+		return false;
+	}
+	if (!_faces.update(nullptr, size)) {
+		return false;
+	}
+	_maxFaces = faces;
+	return true;
+}
+
+void ComputeSurfaceExtractor::packVoxels(const voxel::RawVolume &volume, const voxel::Region &region,
+										 core::DynamicArray<uint32_t> &out) {
+	core_trace_scoped(PackVoxels);
+	const glm::ivec3 lower = region.getLowerCorner() - 1;
+	const glm::ivec3 upper = region.getUpperCorner() + 1;
+	const voxel::Region &volumeRegion = volume.region();
+	const uint32_t border = packVoxel(volume.voxel(volumeRegion.getUpperCorner() + 1));
+	const int lowerX = glm::max(lower.x, volumeRegion.getLowerX());
+	const int upperX = glm::min(upper.x, volumeRegion.getUpperX());
+	const glm::ivec3 dim = upper - lower + 1;
+	out.resize((size_t)dim.x * dim.y * dim.z);
+	uint32_t *target = out.data();
+	for (int z = lower.z; z <= upper.z; ++z) {
+		for (int y = lower.y; y <= upper.y; ++y) {
+			if (lowerX > upperX || !volumeRegion.containsPoint(lowerX, y, z)) {
+				for (int x = 0; x < dim.x; ++x) {
+					*target++ = border;
+				}
+				continue;
+			}
+			for (int x = lower.x; x < lowerX; ++x) {
+				*target++ = border;
+			}
+			const voxel::Voxel *row = volume.row(glm::ivec3(lowerX, y, z));
+			for (int x = lowerX; x <= upperX; ++x) {
+				*target++ = packVoxel(row[x - lowerX]);
+			}
+			for (int x = upperX + 1; x <= upper.x; ++x) {
+				*target++ = border;
+			}
+		}
+	}
+	core_assert(target == out.data() + out.size());
+}
+
+void ComputeSurfaceExtractor::addFaces(const uint32_t *faces, uint32_t count, const glm::ivec3 &translate,
+									   voxel::ChunkMesh &result) {
+	core_trace_scoped(AddFaces);
+	for (uint32_t i = 0u; i < count; ++i) {
+		const uint32_t position = faces[i * 2u];
+		const uint32_t info = faces[i * 2u + 1u];
+		const uint32_t face = info & 7u;
+		core_assert(face < (uint32_t)voxel::FaceNames::Max);
+		voxel::Mesh &mesh = result.mesh[(info >> 3u) & 1u];
+		const glm::ivec3 pos(position & 1023u, (position >> 10u) & 1023u, (position >> 20u) & 1023u);
+
+		voxel::VoxelVertex vertex;
+		vertex.info = 0u;
+		vertex.flags = (info >> 12u) & 1u;
+		vertex.colorIndex = (info >> 16u) & 255u;
+		vertex.normalIndex = (info >> 24u) & 255u;
+		vertex.padding2 = 0u;
+		uint8_t ao[4];
+		voxel::IndexType indices[4];
+		for (int v = 0; v < 4; ++v) {
+			ao[v] = (info >> (4u + v * 2u)) & 3u;
+			vertex.position = glm::vec3(pos + FaceCorners[face][v] + translate);
+			vertex.ambientOcclusion = ao[v];
+			indices[v] = mesh.addVertex(vertex);
+		}
+		// see isQuadFlipped() of the cpu extractor
+		if (ao[3] + ao[1] > ao[0] + ao[2]) {
+			mesh.addTriangle(indices[1], indices[2], indices[3]);
+			mesh.addTriangle(indices[1], indices[3], indices[0]);
+		} else {
+			mesh.addTriangle(indices[0], indices[1], indices[2]);
+			mesh.addTriangle(indices[0], indices[2], indices[3]);
+		}
+	}
+}
+
+bool ComputeSurfaceExtractor::extract(const voxel::RawVolume &volume, const voxel::Region &region,
+									  voxel::ChunkMesh &result, const glm::ivec3 &translate) {
+	if (!_supported) {
+		return false;
+	}
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	if (glm::any(glm::greaterThan(dim, glm::ivec3(MaxRegionSize)))) {
+		return false;
+	}
+	core_trace_scoped(ComputeSurfaceExtraction);
+	packVoxels(volume, region, _voxelData);
+	const size_t voxelSize = _voxelData.size() * sizeof(uint32_t);
+	const int maxSize = video::limit(video::Limit::MaxShaderStorageBufferSize);
+	if (maxSize > 0 && voxelSize > (size_t)maxSize) {
+		return false;
+	}
+	_voxels.update(_voxelData.data(), voxelSize);
+
+	// enough for the hull of the region - a second run is done with the exact amount if this isn't enough
+	uint32_t maxFaces = (uint32_t)glm::max(4096, 2 * (dim.x * dim.y + dim.x * dim.z + dim.y * dim.z));
+	const int workGroupSize = shader::CubicfacesShaderConstants::getWorkGroupSize();
+	const glm::uvec3 workGroups((dim + workGroupSize - 1) / workGroupSize);
+	const uint32_t counter = 0u;
+	for (int run = 0; run < 2; ++run) {
+		if (!reserveFaces(maxFaces)) {
+			return false;
+		}
+		_faces.updateSubData(0, &counter, sizeof(counter));
+		alignas(16) shader::CubicfacesData::BlockData var;
+		var.size = dim;
+		var.maxfaces = _maxFaces;
+		_uniformBlock.update(var);
+		video::ScopedShader scoped(_shader);
+		_shader.setBlock(_uniformBlock.getBlockUniformBuffer());
+		_voxels.bind(_shader.getBindingVoxelbuffer());
+		_faces.bind(_shader.getBindingFacebuffer());
+		if (!_shader.run(workGroups, true)) {
+			Log::debug("Failed to run the cubicfaces shader");
+			return false;
+		}
+		const uint32_t *data = (const uint32_t *)_faces.map(video::AccessMode::Read);
+		if (data == nullptr) {
+			return false;
+		}
+		const uint32_t faces = data[0];
+		if (faces <= _maxFaces) {
+			result.clear();
+			result.setOffset(region.getLowerCorner());
+			addFaces(data + 1, faces, translate, result);
+			_faces.unmap();
+			result.compressIndices();
+			return true;
+		}
+		_faces.unmap();
+		maxFaces = faces;
+	}
+	return false;
+}
+
+} // namespace voxelrender
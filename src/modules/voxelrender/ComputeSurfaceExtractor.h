@@ -0,0 +1,88 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "CubicfacesData.h"
+#include "CubicfacesShader.h"
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+#include "video/ShaderStorageBuffer.h"
+#include <glm/vec3.hpp>
+#include <stdint.h>
+
+namespace voxel {
+class RawVolume;
+class Region;
+struct ChunkMesh;
+} // namespace voxel
+
+namespace voxelrender {
+
+/**
+ * @brief Finds the faces of the cubic meshes with a compute shader
+ *
+ * The voxels of the region (with a border of one voxel) are uploaded into a shader storage buffer - one word per
+ * voxel. The shader applies the same face and ambient occlusion rules as @c voxel::extractCubicMesh() and writes one
+ * entry of two words for each visible face. The faces are expanded into the vertices and indices of the chunk mesh
+ * afterwards. There is no merging of quads and no vertex sharing.
+ *
+ * @li voxel: material (bits 0-1), flags (bit 2), color (bits 8-15), normal (bits 16-23)
+ * @li face word 0: the region local position - x (bits 0-9), y (bits 10-19), z (bits 20-29)
+ * @li face word 1: @c voxel::FaceNames (bits 0-2), transparent (bit 3), the ambient occlusion of the four vertices
+ * (bits 4-11), flags (bit 12), color (bits 16-23), normal (bits 24-31)
+ *
+ * @note Needs a current gl context - it can't be used from the extraction threads of the @c voxel::MeshState
+ * @sa cubicfaces.comp
+ */
+class ComputeSurfaceExtractor : public core::NonCopyable {
+public:
+	// the positions of the faces are stored with 10 bits per axis
+	static constexpr int MaxRegionSize = 1024;
+
+private:
+	shader::CubicfacesShader &_shader;
+	shader::CubicfacesData _uniformBlock;
+	video::ShaderStorageBuffer _voxels;
+	video::ShaderStorageBuffer _faces;
+	core::DynamicArray<uint32_t> _voxelData;
+	uint32_t _maxFaces = 0u;
+	bool _supported = false;
+
+	bool reserveFaces(uint32_t faces);
+
+public:
+	ComputeSurfaceExtractor();
+
+	/**
+	 * @return @c false if compute shaders are not supported - @c extract() always fails then
+	 */
+	bool init();
+	void shutdown();
+
+	inline bool supported() const {
+		return _supported;
+	}
+
+	/**
+	 * @brief Same as @c voxel::extractCubicMesh() without merging the quads
+	 * @return @c false if the region couldn't get extracted - use the cpu extractor then
+	 */
+	bool extract(const voxel::RawVolume &volume, const voxel::Region &region, voxel::ChunkMesh &result,
+				 const glm::ivec3 &translate);
+
+	/**
+	 * @brief Encode the voxels of the region and a border of one voxel - see the class documentation
+	 */
+	static void packVoxels(const voxel::RawVolume &volume, const voxel::Region &region,
+						   core::DynamicArray<uint32_t> &out);
+	/**
+	 * @brief Add the vertices and triangles of the given faces to the (opaque or transparent) meshes
+	 * @param faces Two words per face - see the class documentation
+	 */
+	static void addFaces(const uint32_t *faces, uint32_t count, const glm::ivec3 &translate,
+						 voxel::ChunkMesh &result);
+};
+
+} // namespace voxelrender
@@ -14,32 +14,15 @@
 #include "video/Camera.h"
 #include "video/FrameBuffer.h"
 #include "video/Texture.h"
+#include "video/TextureReadback.h"
 #include "voxelformat/Format.h"
 #include "voxelrender/SceneGraphRenderer.h"
+#include "voxelrender/SoftwareRenderer.h"
 #include "scenegraph/SceneGraph.h"
 
 namespace voxelrender {
 
-static image::ImagePtr volumeThumbnail(const voxel::MeshStatePtr &meshState, RenderContext &renderContext, voxelrender::SceneGraphRenderer &volumeRenderer, const voxelformat::ThumbnailContext &ctx) {
-	if (!renderContext.sceneGraph) {
-		Log::error("No scene graph set");
-		return image::ImagePtr();
-	}
-	const scenegraph::SceneGraph &sceneGraph = *renderContext.sceneGraph;
-	video::clearColor(ctx.clearColor);
-	video::enable(video::State::DepthTest);
-	video::depthFunc(video::CompareFunc::LessEqual);
-	video::enable(video::State::CullFace);
-	video::enable(video::State::DepthMask);
-	video::enable(video::State::Blend);
-	video::blendFunc(video::BlendMode::SourceAlpha, video::BlendMode::OneMinusSourceAlpha);
-
-	video::TextureConfig textureCfg;
-	textureCfg.wrap(video::TextureWrap::ClampToEdge);
-	textureCfg.format(video::TextureFormat::RGBA);
-
-	core_trace_scoped(EditorSceneRenderFramebuffer);
-
+static video::Camera thumbnailCamera(const scenegraph::SceneGraph &sceneGraph, const voxelformat::ThumbnailContext &ctx) {
 	video::Camera camera;
 
 	if (ctx.useSceneCamera && sceneGraph.size(scenegraph::SceneGraphNodeType::Camera) > 0) {
@@ -74,36 +57,93 @@ static image::ImagePtr volumeThumbnail(const voxel::MeshStatePtr &meshState, Ren
 		}
 	}
 	camera.update(ctx.deltaFrameSeconds);
+	return camera;
+}
+
+static bool renderThumbnail(const voxel::MeshStatePtr &meshState, RenderContext &renderContext, voxelrender::SceneGraphRenderer &volumeRenderer, const voxelformat::ThumbnailContext &ctx) {
+	if (!renderContext.sceneGraph) {
+		Log::error("No scene graph set");
+		return false;
+	}
+	const scenegraph::SceneGraph &sceneGraph = *renderContext.sceneGraph;
+	video::clearColor(ctx.clearColor);
+	video::enable(video::State::DepthTest);
+	video::depthFunc(video::CompareFunc::LessEqual);
+	video::enable(video::State::CullFace);
+	video::enable(video::State::DepthMask);
+	video::enable(video::State::Blend);
+	video::blendFunc(video::BlendMode::SourceAlpha, video::BlendMode::OneMinusSourceAlpha);
+
+	video::TextureConfig textureCfg;
+	textureCfg.wrap(video::TextureWrap::ClampToEdge);
+	textureCfg.format(video::TextureFormat::RGBA);
+
+	core_trace_scoped(EditorSceneRenderFramebuffer);
+
+	const video::Camera &camera = thumbnailCamera(sceneGraph, ctx);
 
 	renderContext.frameBuffer.bind(true);
 	volumeRenderer.render(meshState, renderContext, camera, true, true);
 	renderContext.frameBuffer.unbind();
+	return true;
+}
 
+static image::ImagePtr volumeThumbnail(const voxel::MeshStatePtr &meshState, RenderContext &renderContext, voxelrender::SceneGraphRenderer &volumeRenderer, const voxelformat::ThumbnailContext &ctx) {
+	if (!renderThumbnail(meshState, renderContext, volumeRenderer, ctx)) {
+		return image::ImagePtr();
+	}
 	return renderContext.frameBuffer.image("thumbnail", video::FrameBufferAttachment::Color0);
 }
 
 image::ImagePtr volumeThumbnail(const scenegraph::SceneGraph &sceneGraph, const voxelformat::ThumbnailContext &ctx) {
+	const core::DynamicArray<image::ImagePtr> &images = volumeThumbnails({&sceneGraph}, ctx);
+	if (images.empty()) {
+		return image::ImagePtr();
+	}
+	return images[0];
+}
+
+core::DynamicArray<image::ImagePtr>
+volumeThumbnails(const core::DynamicArray<const scenegraph::SceneGraph *> &sceneGraphs,
+				 const voxelformat::ThumbnailContext &ctx) {
+	core::DynamicArray<image::ImagePtr> images;
+	if (sceneGraphs.empty()) {
+		return images;
+	}
 	voxelrender::SceneGraphRenderer sceneGraphRenderer;
 	sceneGraphRenderer.construct();
 	RenderContext renderContext;
 	renderContext.init(ctx.outputSize);
 	renderContext.renderMode = RenderMode::Scene;
-	renderContext.sceneGraph = &sceneGraph;
 	renderContext.onlyModels = true;
 	const voxel::MeshStatePtr meshState = core::make_shared<voxel::MeshState>();
 	meshState->construct();
 	meshState->init();
 	if (!sceneGraphRenderer.init(meshState->hasNormals())) {
 		Log::error("Failed to initialize the renderer");
-		return image::ImagePtr();
+		return images;
 	}
 
-	const image::ImagePtr &image = volumeThumbnail(meshState, renderContext, sceneGraphRenderer, ctx);
+	images.reserve(sceneGraphs.size());
+	for (const scenegraph::SceneGraph *sceneGraph : sceneGraphs) {
+		renderContext.sceneGraph = sceneGraph;
+		images.push_back(volumeThumbnail(meshState, renderContext, sceneGraphRenderer, ctx));
+		// the next scene must not render the volumes of this one
+		sceneGraphRenderer.clear(meshState);
+	}
+	renderContext.sceneGraph = nullptr;
 	sceneGraphRenderer.shutdown();
 	renderContext.shutdown();
-	// don't free the volumes here, they belong to the scene graph
+	// don't free the volumes here, they belong to the scene graphs
 	(void)meshState->shutdown();
-	return image;
+	return images;
+}
+
+image::ImagePtr softwareVolumeThumbnail(const scenegraph::SceneGraph &sceneGraph,
+										const voxelformat::ThumbnailContext &ctx) {
+	const video::Camera &camera = thumbnailCamera(sceneGraph, ctx);
+	SoftwareRenderer renderer;
+	return renderer.render(sceneGraph, camera, ctx.outputSize, ctx.clearColor);
 }
 
 bool volumeTurntable(const scenegraph::SceneGraph &sceneGraph, const core::String &imageFile, voxelformat::ThumbnailContext ctx, int loops) {
@@ -123,40 +163,50 @@ bool volumeTurntable(const scenegraph::SceneGraph &sceneGraph, const core::Strin
 		return image::ImagePtr();
 	}
 
+	// the frames are read back while the next frames are rendered - and written in the order they were rendered
+	bool success = true;
+	const auto writeFrame = [&success](const image::ImagePtr &image) {
+		if (!image || !image->isLoaded()) {
+			success = false;
+			return;
+		}
+		const io::FilePtr &outfile = io::filesystem()->open(image->name(), io::FileMode::SysWrite);
+		io::FileStream outStream(outfile);
+		if (!image::Image::writePng(outStream, image->data(), image->width(), image->height(), image->depth())) {
+			Log::error("Failed to write image %s", image->name().c_str());
+			success = false;
+		} else {
+			Log::info("Write image %s", image->name().c_str());
+		}
+	};
+	video::TextureReadback readback;
 	const core::String ext = core::string::extractExtension(imageFile);
 	const core::String baseFilePath = core::string::stripExtension(imageFile);
-	for (int i = 0; i < loops; ++i) {
+	for (int i = 0; i < loops && success; ++i) {
 		const core::String &filepath = core::string::format("%s_%i.%s", baseFilePath.c_str(), i, ext.c_str());
-		const io::FilePtr &outfile = io::filesystem()->open(filepath, io::FileMode::SysWrite);
-		io::FileStream outStream(outfile);
-		const image::ImagePtr &image = volumeThumbnail(meshState, renderContext, sceneGraphRenderer, ctx);
-		if (image) {
-			if (!image::Image::writePng(outStream, image->data(), image->width(), image->height(), image->depth())) {
-				Log::error("Failed to write image %s", filepath.c_str());
-				sceneGraphRenderer.shutdown();
-				renderContext.shutdown();
-				// don't free the volumes here, they belong to the scene graph
-				(void)meshState->shutdown();
-				return false;
-			} else {
-				Log::info("Write image %s", filepath.c_str());
-			}
-		} else {
-			Log::error("Failed to create thumbnail for %s", imageFile.c_str());
-			sceneGraphRenderer.shutdown();
-			renderContext.shutdown();
-			// don't free the volumes here, they belong to the scene graph
-			(void)meshState->shutdown();
-			return false;
+		if (!renderThumbnail(meshState, renderContext, sceneGraphRenderer, ctx)) {
+			success = false;
+			break;
+		}
+		const video::TexturePtr &texture = renderContext.frameBuffer.texture(video::FrameBufferAttachment::Color0);
+		if (!readback.read(texture, filepath, writeFrame)) {
+			success = false;
+			break;
 		}
+		readback.update();
 		ctx.omega = glm::vec3(0.0f, glm::two_pi<float>() / (float)loops, 0.0f);
 		ctx.deltaFrameSeconds += 1000.0 / (double)loops;
 	}
+	readback.flush();
+	readback.shutdown();
+	if (!success) {
+		Log::error("Failed to create the turntable images for %s", imageFile.c_str());
+	}
 	sceneGraphRenderer.shutdown();
 	renderContext.shutdown();
 	// don't free the volumes here, they belong to the scene graph
 	(void)meshState->shutdown();
-	return true;
+	return success;
 }
 
 } // namespace voxelrender
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "core/String.h"
+#include "core/collection/DynamicArray.h"
 #include "voxelformat/FormatThumbnail.h"
 #include "io/Stream.h"
 
@@ -15,6 +16,20 @@ class SceneGraph;
 namespace voxelrender {
 
 image::ImagePtr volumeThumbnail(const scenegraph::SceneGraph &sceneGraph, const voxelformat::ThumbnailContext &ctx);
+/**
+ * @brief Renders the thumbnails of several scenes with one renderer and frame buffer - the shaders and buffers are only
+ * set up once for the whole batch
+ * @return The images in the order of the given scene graphs (an entry is empty if the scene couldn't get rendered) or
+ * an empty array if the renderer couldn't get initialized
+ */
+core::DynamicArray<image::ImagePtr>
+volumeThumbnails(const core::DynamicArray<const scenegraph::SceneGraph *> &sceneGraphs,
+				 const voxelformat::ThumbnailContext &ctx);
+/**
+ * @brief Renders the thumbnail on the cpu - this doesn't need a gl context and can be called from any thread
+ * @sa SoftwareRenderer
+ */
+image::ImagePtr softwareVolumeThumbnail(const scenegraph::SceneGraph &sceneGraph, const voxelformat::ThumbnailContext &ctx);
 bool volumeTurntable(const scenegraph::SceneGraph &sceneGraph, const core::String &imageFile, voxelformat::ThumbnailContext ctx, int loops);
 
 
@@ -0,0 +1,86 @@
+/**
+ * @file
+ */
+
+#include "PaletteAtlas.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "palette/Palette.h"
+#include "video/TextureConfig.h"
+
+namespace voxelrender {
+
+int PaletteAtlas::find(const palette::Palette &palette) const {
+	int layer = -1;
+	if (!_layers.get(palette.hash(), layer)) {
+		return -1;
+	}
+	return layer;
+}
+
+int PaletteAtlas::add(const palette::Palette &palette) {
+	if ((int)_layers.size() >= MaxLayers) {
+		Log::debug("All palette layers are used - clear the palette atlas");
+		_layers.clear();
+		_data.clear();
+	}
+	const int layer = (int)_layers.size();
+	core::DynamicArray<glm::vec4> colors;
+	palette.toVec4f(colors);
+	core::DynamicArray<glm::vec4> glowColors;
+	palette.emitToVec4f(glowColors);
+	core_assert((int)colors.size() == palette::PaletteMaxColors);
+	core_assert((int)glowColors.size() == palette::PaletteMaxColors);
+	_data.append(colors.data(), colors.size());
+	_data.append(glowColors.data(), glowColors.size());
+	_layers.put(palette.hash(), layer);
+	_dirty = true;
+	return layer;
+}
+
+int PaletteAtlas::layer(const palette::Palette &palette) {
+	const int layer = find(palette);
+	if (layer != -1) {
+		return layer;
+	}
+	return add(palette);
+}
+
+bool PaletteAtlas::upload() {
+	if (!_dirty) {
+		return true;
+	}
+	core_trace_scoped(PaletteAtlasUpload);
+	if (!_texture) {
+		video::TextureConfig cfg;
+		cfg.type(video::TextureType::Texture2DArray);
+		cfg.format(video::TextureFormat::RGBA32F);
+		cfg.filter(video::TextureFilter::Nearest);
+		cfg.wrap(video::TextureWrap::ClampToEdge);
+		_texture = video::createTexture(cfg, palette::PaletteMaxColors, Rows, "palettes");
+	}
+	_texture->upload(palette::PaletteMaxColors, Rows, (const uint8_t *)_data.data(), layers());
+	_dirty = false;
+	++_uploads;
+	return true;
+}
+
+bool PaletteAtlas::bind(video::TextureUnit unit) const {
+	if (!_texture) {
+		return false;
+	}
+	_texture->bind(unit);
+	return true;
+}
+
+void PaletteAtlas::shutdown() {
+	if (_texture) {
+		_texture->shutdown();
+	}
+	_texture = video::TexturePtr();
+	_layers.clear();
+	_data.release();
+	_dirty = false;
+}
+
+} // namespace voxelrender
@@ -0,0 +1,87 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/Map.h"
+#include "video/Texture.h"
+#include "video/Types.h"
+#include <glm/vec4.hpp>
+
+namespace palette {
+class Palette;
+}
+
+namespace voxelrender {
+
+/**
+ * @brief The palettes of the rendered volumes in the layers of a texture array
+ *
+ * The layers are keyed by the palette hash - the volumes that share a palette also share the layer. A palette is only
+ * uploaded once and the draws only differ in the layer index instead of uploading and binding the palette colors for
+ * each of them.
+ *
+ * Each layer has two rows: the colors and the glow colors of the palette.
+ */
+class PaletteAtlas : public core::NonCopyable {
+public:
+	// the minimum value of GL_MAX_ARRAY_TEXTURE_LAYERS
+	static constexpr int MaxLayers = 256;
+	static constexpr int Rows = 2;
+
+private:
+	core::Map<uint64_t, int, 64> _layers;
+	// the colors of all layers - uploaded at once if a palette was added
+	core::DynamicArray<glm::vec4> _data;
+	video::TexturePtr _texture;
+	bool _dirty = false;
+	int _uploads = 0;
+
+	int add(const palette::Palette &palette);
+
+public:
+	/**
+	 * @return The layer of the palette - the palette is added if it doesn't have a layer yet
+	 * @note If all layers are used, the atlas is cleared and the layers of the previous lookups are invalid
+	 */
+	int layer(const palette::Palette &palette);
+	/**
+	 * @return The layer of the palette or @c -1 if it wasn't added yet
+	 */
+	int find(const palette::Palette &palette) const;
+	/**
+	 * @brief Uploads the texture array if palettes were added since the last upload
+	 */
+	bool upload();
+	bool bind(video::TextureUnit unit) const;
+	void shutdown();
+
+	int layers() const;
+	/**
+	 * @return The amount of texture array uploads since the creation
+	 */
+	int uploads() const;
+	bool dirty() const;
+	const core::DynamicArray<glm::vec4> &data() const;
+};
+
+inline int PaletteAtlas::layers() const {
+	return (int)_layers.size();
+}
+
+inline int PaletteAtlas::uploads() const {
+	return _uploads;
+}
+
+inline bool PaletteAtlas::dirty() const {
+	return _dirty;
+}
+
+inline const core::DynamicArray<glm::vec4> &PaletteAtlas::data() const {
+	return _data;
+}
+
+} // namespace voxelrender
@@ -3,14 +3,19 @@
  */
 
 #include "RawVolumeRenderer.h"
+#include "RaymarchShaderConstants.h"
 #include "ShaderAttribute.h"
 #include "VoxelShaderConstants.h"
 #include "core/Algorithm.h"
 #include "core/ArrayLength.h"
 #include "core/Color.h"
+#include "core/GLM.h"
 #include "core/ConfigVar.h"
+#include "core/Hash.h"
 #include "core/Log.h"
+#include "core/PerfStats.h"
 #include "core/StandardLib.h"
+#include "core/TimeProvider.h"
 #include "core/Trace.h"
 #include "core/Var.h"
 #include "core/collection/DynamicArray.h"
@@ -19,6 +24,7 @@
 #include "scenegraph/SceneGraphNode.h"
 #include "video/Camera.h"
 #include "video/FrameBufferConfig.h"
+#include "video/GPUTimer.h"
 #include "video/Renderer.h"
 #include "video/ScopedFaceCull.h"
 #include "video/ScopedFrameBuffer.h"
@@ -32,13 +38,17 @@
 #include "voxel/MeshState.h"
 #include "voxel/RawVolume.h"
 #include "voxel/SurfaceExtractor.h"
+#include "voxelutil/VolumeRescaler.h"
 #include "voxelutil/VolumeVisitor.h"
 #include <glm/ext/scalar_constants.hpp>
 #include <glm/gtc/epsilon.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #ifndef GLM_ENABLE_EXPERIMENTAL
 #define GLM_ENABLE_EXPERIMENTAL
 #endif
 #include <glm/gtx/norm.hpp>
+#include <glm/vector_relational.hpp>
 
 namespace voxelrender {
 
@@ -87,89 +97,178 @@ bool RenderContext::resize(const glm::ivec2 &size) {
 
 void RenderContext::shutdown() {
 	frameBuffer.shutdown();
+	oitFrameBuffer.shutdown();
 	bloomRenderer.shutdown();
+	for (OcclusionQuery &query : occlusionQueries) {
+		video::deleteQuery(query.query);
+	}
+	occlusionQueries.release();
+	occlusionStats = OcclusionStats();
+	shadow.shutdown();
+	shadowCasterHash = 0u;
+	shadowInvalidation = 0u;
 }
 
 RawVolumeRenderer::RawVolumeRenderer()
 	: _voxelShader(shader::VoxelShader::getInstance()), _voxelNormShader(shader::VoxelnormShader::getInstance()),
-	  _shadowMapShader(shader::ShadowmapShader::getInstance()) {
+	  _shadowMapShader(shader::ShadowmapShader::getInstance()),
+	  _oitCompositeShader(shader::OitcompositeShader::getInstance()),
+	  _rayMarchShader(shader::RaymarchShader::getInstance()) {
 }
 
 void RawVolumeRenderer::construct() {
+	core::Var::get(cfg::VoxelComputeExtraction, "true", core::CV_NOPERSIST);
+	core::Var::get(cfg::VoxelUploadBudget, "4", 0,
+				   "Milliseconds per frame to upload the extracted meshes - 0 uploads them all in the same frame");
+	core::Var::get(cfg::VoxelOcclusionCulling, "false", 0, "Skip the rendering of volumes that are hidden behind others",
+				   core::Var::boolValidator);
+	core::Var::get(cfg::VoxelOrderIndependentTransparency, "true", 0,
+				   "Render the transparent voxels without sorting them - the blending is an approximation",
+				   core::Var::boolValidator);
+	core::Var::get(cfg::VoxelRayMarch, "false", 0,
+				   "Ray march the volumes instead of extracting meshes - the transparent voxels are rendered opaque",
+				   core::Var::boolValidator);
+	core::Var::get(cfg::VoxelAOVolume, "false", core::CV_SHADER,
+				   "Sample the ambient occlusion of the cubic meshes from a volume texture that also takes the voxels "
+				   "around the direct neighbours into account",
+				   core::Var::boolValidator);
 }
 
 bool RawVolumeRenderer::initStateBuffers(bool normals) {
-	for (int idx = 0; idx < voxel::MAX_VOLUMES; ++idx) {
-		RenderState &state = _state[idx];
-		for (int i = 0; i < voxel::MeshType_Max; ++i) {
-			state._vertexBufferIndex[i] = state._vertexBuffer[i].create();
-			if (state._vertexBufferIndex[i] == -1) {
-				Log::error("Could not create the vertex buffer object");
-				return false;
-			}
+	_normals = normals;
+	// the cubic meshes only have integral positions - the marching cubes meshes are uploaded with normals and keep
+	// the float layout. This must be reset for every init, the renderer is initialized again if the mesh mode changes.
+	_packedVertices = !normals;
+	for (RenderState *state : _state) {
+		if (state != nullptr && !initStateBuffers(*state)) {
+			return false;
+		}
+	}
+	return true;
+}
 
-			if (normals) {
-				state._normalBufferIndex[i] = state._vertexBuffer[i].create();
-				if (state._normalBufferIndex[i] == -1) {
-					Log::error("Could not create the normal buffer object");
-					return false;
-				}
-			}
+bool RawVolumeRenderer::initStateBuffers(RenderState &state) {
+	for (int i = 0; i < voxel::MeshType_Max; ++i) {
+		state._vertexBufferIndex[i] = state._vertexBuffer[i].create();
+		if (state._vertexBufferIndex[i] == -1) {
+			Log::error("Could not create the vertex buffer object");
+			return false;
+		}
 
-			state._indexBufferIndex[i] = state._vertexBuffer[i].create(nullptr, 0, video::BufferType::IndexBuffer);
-			if (state._indexBufferIndex[i] == -1) {
-				Log::error("Could not create the vertex buffer object for the indices");
+		if (_normals) {
+			state._normalBufferIndex[i] = state._vertexBuffer[i].create();
+			if (state._normalBufferIndex[i] == -1) {
+				Log::error("Could not create the normal buffer object");
 				return false;
 			}
 		}
+
+		state._indexBufferIndex[i] = state._vertexBuffer[i].create(nullptr, 0, video::BufferType::IndexBuffer);
+		if (state._indexBufferIndex[i] == -1) {
+			Log::error("Could not create the vertex buffer object for the indices");
+			return false;
+		}
 	}
 
-	if (normals) {
-		for (int idx = 0; idx < voxel::MAX_VOLUMES; ++idx) {
-			RenderState &state = _state[idx];
-			for (int i = 0; i < voxel::MeshType_Max; ++i) {
-				const video::Attribute &attributePos =
-					getPositionVertexAttribute(state._vertexBufferIndex[i], _voxelNormShader.getLocationPos(),
-											   _voxelNormShader.getComponentsPos());
-				state._vertexBuffer[i].addAttribute(attributePos);
-
-				const video::Attribute &attributeInfo =
-					getInfoVertexAttribute(state._vertexBufferIndex[i], _voxelNormShader.getLocationInfo(),
-										   _voxelNormShader.getComponentsInfo());
-				state._vertexBuffer[i].addAttribute(attributeInfo);
-
-				const video::Attribute &attributeNormal =
-					getNormalVertexAttribute(state._normalBufferIndex[i], _voxelNormShader.getLocationNormal(),
-											 _voxelNormShader.getComponentsNormal());
-				state._vertexBuffer[i].addAttribute(attributeNormal);
+	// the per instance attributes are also fetched for the draws that are not instanced - so there is always one
+	alignas(16) static const glm::mat4 identity(1.0f);
+	video::Buffer &opaqueBuffer = state._vertexBuffer[voxel::MeshType_Opaque];
+	state._instanceBufferIndex = opaqueBuffer.create(&identity, sizeof(identity));
+	if (state._instanceBufferIndex == -1) {
+		Log::error("Could not create the instance buffer object");
+		return false;
+	}
+	// the instances are written every frame
+	opaqueBuffer.setMode(state._instanceBufferIndex, video::BufferMode::Persistent);
+
+	for (int i = 0; i < voxel::MeshType_Max; ++i) {
+		initVertexAttributes(state, (voxel::MeshType)i, _packedVertices);
+	}
+
+	return true;
+}
+
+void RawVolumeRenderer::initVertexAttributes(RenderState &state, voxel::MeshType type, bool packed) {
+	video::Buffer &buffer = state._vertexBuffer[type];
+	buffer.clearAttributes();
+	state._packed[type] = packed;
+
+	if (type == voxel::MeshType_Opaque) {
+		const int instanceLocation =
+			_normals ? _voxelNormShader.getLocationInstance() : _voxelShader.getLocationInstance();
+		if (instanceLocation != -1) {
+			for (int column = 0; column < 4; ++column) {
+				buffer.addAttribute(getInstanceVertexAttribute(state._instanceBufferIndex, instanceLocation, column));
 			}
 		}
+	}
+
+	if (_normals) {
+		const video::Attribute &attributePos = getPositionVertexAttribute(
+			state._vertexBufferIndex[type], _voxelNormShader.getLocationPos(), _voxelNormShader.getComponentsPos());
+		buffer.addAttribute(attributePos);
+
+		const video::Attribute &attributeInfo = getInfoVertexAttribute(
+			state._vertexBufferIndex[type], _voxelNormShader.getLocationInfo(), _voxelNormShader.getComponentsInfo());
+		buffer.addAttribute(attributeInfo);
+
+		const video::Attribute &attributeNormal =
+			getNormalVertexAttribute(state._normalBufferIndex[type], _voxelNormShader.getLocationNormal(),
+									 _voxelNormShader.getComponentsNormal());
+		buffer.addAttribute(attributeNormal);
+	} else if (packed) {
+		const video::Attribute &attributePos = getPositionVertexAttribute<voxel::PackedVoxelVertex>(
+			state._vertexBufferIndex[type], _voxelShader.getLocationPos(), _voxelShader.getComponentsPos());
+		buffer.addAttribute(attributePos);
+
+		const video::Attribute &attributeInfo = getInfoVertexAttribute<voxel::PackedVoxelVertex>(
+			state._vertexBufferIndex[type], _voxelShader.getLocationInfo(), _voxelShader.getComponentsInfo());
+		buffer.addAttribute(attributeInfo);
+
+		const video::Attribute &attributeInfo2 = getInfo2VertexAttribute<voxel::PackedVoxelVertex>(
+			state._vertexBufferIndex[type], _voxelShader.getLocationInfo2(), _voxelShader.getComponentsInfo2());
+		buffer.addAttribute(attributeInfo2);
 	} else {
-		for (int idx = 0; idx < voxel::MAX_VOLUMES; ++idx) {
-			RenderState &state = _state[idx];
-			for (int i = 0; i < voxel::MeshType_Max; ++i) {
-				const video::Attribute &attributePos = getPositionVertexAttribute(
-					state._vertexBufferIndex[i], _voxelShader.getLocationPos(), _voxelShader.getComponentsPos());
-				state._vertexBuffer[i].addAttribute(attributePos);
-
-				const video::Attribute &attributeInfo = getInfoVertexAttribute(
-					state._vertexBufferIndex[i], _voxelShader.getLocationInfo(), _voxelShader.getComponentsInfo());
-				state._vertexBuffer[i].addAttribute(attributeInfo);
-
-				const video::Attribute &attributeInfo2 =
-					getInfo2VertexAttribute(state._vertexBufferIndex[i], _voxelShader.getLocationInfo2(),
-										   _voxelShader.getComponentsInfo2());
-				state._vertexBuffer[i].addAttribute(attributeInfo2);
-			}
-		}
+		const video::Attribute &attributePos = getPositionVertexAttribute(
+			state._vertexBufferIndex[type], _voxelShader.getLocationPos(), _voxelShader.getComponentsPos());
+		buffer.addAttribute(attributePos);
+
+		const video::Attribute &attributeInfo = getInfoVertexAttribute(
+			state._vertexBufferIndex[type], _voxelShader.getLocationInfo(), _voxelShader.getComponentsInfo());
+		buffer.addAttribute(attributeInfo);
+
+		const video::Attribute &attributeInfo2 = getInfo2VertexAttribute(
+			state._vertexBufferIndex[type], _voxelShader.getLocationInfo2(), _voxelShader.getComponentsInfo2());
+		buffer.addAttribute(attributeInfo2);
 	}
+}
 
-	return true;
+RawVolumeRenderer::RenderState &RawVolumeRenderer::createRenderState(int idx) {
+	core_assert(idx >= 0);
+	if (idx >= (int)_state.size()) {
+		_state.resize(idx + 1);
+	}
+	if (_state[idx] == nullptr) {
+		_state[idx] = new RenderState();
+		if (!initStateBuffers(*_state[idx])) {
+			Log::error("Failed to initialize the state buffers for volume %i", idx);
+		}
+	}
+	return *_state[idx];
 }
 
+static_assert(shader::RaymarchShaderConstants::getBrickSize() == BrickMap::BrickSize,
+			  "The brick size of the ray march shader doesn't match");
+
 bool RawVolumeRenderer::init(bool normals) {
 	_shadowMap = core::Var::getSafe(cfg::ClientShadowMap);
 	_bloom = core::Var::getSafe(cfg::ClientBloom);
+	_computeExtraction = core::Var::getSafe(cfg::VoxelComputeExtraction);
+	_uploadBudget = core::Var::getSafe(cfg::VoxelUploadBudget);
+	_occlusionCulling = core::Var::getSafe(cfg::VoxelOcclusionCulling);
+	_oit = core::Var::getSafe(cfg::VoxelOrderIndependentTransparency);
+	_rayMarch = core::Var::getSafe(cfg::VoxelRayMarch)->boolVal();
+	_aoVolume = core::Var::getSafe(cfg::VoxelAOVolume);
 
 	if (!_voxelShader.setup()) {
 		Log::error("Failed to initialize the voxel shader");
@@ -183,18 +282,29 @@ bool RawVolumeRenderer::init(bool normals) {
 		Log::error("Failed to init shadowmap shader");
 		return false;
 	}
+	if (!_oitCompositeShader.setup()) {
+		Log::error("Failed to init the oit composite shader");
+		return false;
+	}
+	_oitCompositeBufferIndex = _oitCompositeBuffer.createFullscreenQuad();
+	core_assert_always(_oitCompositeBuffer.addAttribute(
+		_oitCompositeShader.getPosAttribute(_oitCompositeBufferIndex, &glm::vec2::x)));
 	alignas(16) shader::ShadowmapData::BlockData var;
-	_shadowMapUniformBlock.create(var);
+	_shadowMapUniformBlock.create(var, ObjectDataSlots);
 
-	if (!initStateBuffers(normals)) {
-		Log::error("Failed to initialize the state buffers");
-		return false;
+	if (_rayMarch) {
+		if (!_rayMarchShader.setup()) {
+			Log::error("Failed to init the ray march shader");
+			return false;
+		}
+		_rayMarchBufferIndex = _rayMarchBuffer.createSkyboxQuad();
+		core_assert_always(
+			_rayMarchBuffer.addAttribute(_rayMarchShader.getPosAttribute(_rayMarchBufferIndex, &glm::vec3::x)));
+		_rayMarchData.create(_rayMarchVolumeData, ObjectDataSlots);
 	}
 
-	const int shaderMaterialColorsArraySize = lengthof(shader::VoxelData::VertData::materialcolor);
-	if constexpr (shaderMaterialColorsArraySize != palette::PaletteMaxColors) {
-		Log::error("Shader parameters and material colors don't match in their size: %i - %i",
-				   shaderMaterialColorsArraySize, palette::PaletteMaxColors);
+	if (!initStateBuffers(normals)) {
+		Log::error("Failed to initialize the state buffers");
 		return false;
 	}
 
@@ -210,67 +320,189 @@ bool RawVolumeRenderer::init(bool normals) {
 		return false;
 	}
 
-	voxelrender::ShadowParameters shadowParams;
-	shadowParams.maxDepthBuffers = shader::VoxelShaderConstants::getMaxDepthBuffers();
-	if (!_shadow.init(shadowParams)) {
-		Log::error("Failed to initialize the shadow object");
-		return false;
-	}
+	// the shadows are initialized for each render context once they are rendered - see prepareShadow()
+	_shadowParameters = voxelrender::ShadowParameters();
+	_shadowParameters.maxDepthBuffers = shader::VoxelShaderConstants::getMaxDepthBuffers();
+	setSunPosition(glm::vec3(25.0f, 100.0f, 25.0f), glm::vec3(0.0f), glm::up());
 
 	_voxelShaderFragData.diffuseColor = glm::vec3(0.0f, 0.0f, 0.0f);
 	_voxelShaderFragData.ambientColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	_voxelShaderFragData.oit = 0;
 
 	_voxelData.create(_voxelShaderFragData);
 	_voxelData.create(_voxelShaderVertData);
+	_voxelData.create(_voxelShaderObjectData, ObjectDataSlots);
+	_dirtyVertData = false;
+
+	_multiDrawIndirect = video::hasFeature(video::Feature::MultiDrawIndirect);
+	_instancing = video::hasFeature(video::Feature::InstancedArrays);
 
 	_shapeRenderer.init();
+	_shapeBuilder.clear();
+	_shapeBuilder.cube(glm::vec3(0.0f), glm::vec3(1.0f));
+	_occlusionBoxMesh = _shapeRenderer.create(_shapeBuilder);
+	_shapeBuilder.clear();
+	// the cpu extractor is used as fallback
+	_computeExtractor.init();
 
 	return true;
 }
 
 void RawVolumeRenderer::scheduleRegionExtraction(const voxel::MeshStatePtr &meshState, int idx, const voxel::Region &region) {
+	if (_rayMarch) {
+		// there are no meshes to extract - only the bricks of the region are rebuilt
+		RayMarchState *state = idx < (int)_rayMarchStates.size() ? _rayMarchStates[idx] : nullptr;
+		const voxel::RawVolume *volume = meshState->volume(idx);
+		if (state != nullptr && volume != nullptr && state->_volume == volume) {
+			state->_brickMap.update(*volume, region);
+		}
+		return;
+	}
+	AmbientOcclusionState *aoState = idx < (int)_aoStates.size() ? _aoStates[idx] : nullptr;
+	if (aoState != nullptr) {
+		const voxel::RawVolume *volume = meshState->volume(idx);
+		if (volume != nullptr && aoState->_volume == volume) {
+			aoState->_aoVolume.update(*volume, region);
+		}
+	}
 	if (meshState->scheduleRegionExtraction(idx, region)) {
 		deleteMeshes(idx);
 	}
 }
 
-void RawVolumeRenderer::update(const voxel::MeshStatePtr &meshState) {
+void RawVolumeRenderer::extractAllPending(const voxel::MeshStatePtr &meshState) {
+	// the compute shader always applies the ambient occlusion of the vertices
+	if (!_computeExtractor.supported() || !_computeExtraction->boolVal() || _aoVolume->boolVal()) {
+		meshState->extractAllPending();
+		return;
+	}
+	meshState->extractAllPending(
+		[this](const voxel::RawVolume &volume, const voxel::Region &region, voxel::ChunkMesh &mesh) {
+			return _computeExtractor.extract(volume, region, mesh, region.getLowerCorner());
+		});
+}
+
+void RawVolumeRenderer::update(const voxel::MeshStatePtr &meshState, bool uploadAll) {
 	if (meshState->update()) {
 		resetStateBuffers(meshState->hasNormals());
 	}
 
-	int cnt = 0;
 	for (;;) {
 		const int idx = meshState->pop();
 		if (idx == -1) {
 			break;
 		}
-		if (!updateBufferForVolume(meshState, idx, voxel::MeshType_Opaque)) {
-			Log::error("Failed to update the mesh at index %i", idx);
+		// the buffers contain all chunks of the volume - they are uploaded once for all the extracted chunks
+		RenderState &state = createRenderState(idx);
+		if (!state._pendingUpload) {
+			state._pendingUpload = true;
+			_pendingUploads.push_back(idx);
 		}
-		if (!updateBufferForVolume(meshState, idx, voxel::MeshType_Transparency)) {
+	}
+	uploadPending(meshState, uploadAll);
+}
+
+void RawVolumeRenderer::uploadPending(const voxel::MeshStatePtr &meshState, bool uploadAll) {
+	if (_pendingUploads.empty()) {
+		return;
+	}
+	core_trace_scoped(RawVolumeRendererUploadPending);
+	const double budgetMillis = uploadAll ? 0.0 : (double)_uploadBudget->floatVal();
+	const double ticksPerMillis = (double)core::TimeProvider::highResTimeResolution() / 1000.0;
+	const uint64_t start = core::TimeProvider::highResTime();
+	size_t uploaded = 0u;
+	while (uploaded < _pendingUploads.size()) {
+		const int idx = _pendingUploads[uploaded++];
+		createRenderState(idx)._pendingUpload = false;
+		if (!updateBufferForVolume(meshState, idx)) {
 			Log::error("Failed to update the mesh at index %i", idx);
 		}
-		++cnt;
+		// at least one volume is uploaded per frame
+		const double elapsedMillis = (double)(core::TimeProvider::highResTime() - start) / ticksPerMillis;
+		if (budgetMillis > 0.0 && elapsedMillis >= budgetMillis) {
+			break;
+		}
 	}
-	if (cnt > 0) {
-		Log::debug("Perform %i mesh updates in this frame", cnt);
+	_pendingUploads.erase(0, uploaded);
+	Log::debug("Perform %i mesh updates in this frame - %i are deferred", (int)uploaded, (int)_pendingUploads.size());
+	core_trace_plot("RawVolumeRendererPendingUploads", (int64_t)_pendingUploads.size());
+}
+
+uint8_t *RawVolumeRenderer::stagingBuffer(size_t size) {
+	if (size > _stagingBufferSize) {
+		core_free(_stagingBuffer);
+		// grow in bigger steps to not reallocate the buffer for every slightly bigger mesh
+		_stagingBufferSize = core_max(size, _stagingBufferSize * 2u);
+		_stagingBuffer = (uint8_t *)core_malloc(_stagingBufferSize);
 	}
+	return _stagingBuffer;
 }
 
 bool RawVolumeRenderer::updateBufferForVolume(const voxel::MeshStatePtr &meshState, int idx, voxel::MeshType type) {
-	if (idx < 0 || idx >= voxel::MAX_VOLUMES) {
+	if (idx < 0) {
 		return false;
 	}
 	core_trace_scoped(RawVolumeRendererUpdate);
 
 	const int bufferIndex = meshState->resolveIdx(idx);
+	RenderState &state = createRenderState(bufferIndex);
+	if (type == voxel::MeshType_Opaque) {
+		markShadowDirty(meshState, bufferIndex);
+	}
+
+	// the meshes in the order of the buffer - the levels of detail follow the full resolution meshes level by level.
+	// This way neighbouring chunks of the same level are rendered with one draw call.
+	core::DynamicArray<const voxel::Mesh *> meshes;
 	size_t vertCount = 0u;
 	size_t normalsCount = 0u;
 	size_t indCount = 0u;
-	meshState->count(type, bufferIndex, vertCount, normalsCount, indCount);
+	auto addMesh = [&](const voxel::Mesh *mesh) {
+		meshes.push_back(mesh);
+		vertCount += mesh->getNoOfVertices();
+		normalsCount += mesh->getNormalVector().size();
+		indCount += mesh->getNoOfIndices();
+	};
+	const bool opaque = type == voxel::MeshType_Opaque;
+	if (opaque) {
+		state._chunks.clear();
+	}
+	for (const auto &i : meshState->meshes(type, bufferIndex)) {
+		const voxel::Mesh *mesh = i->value;
+		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
+			continue;
+		}
+		if (opaque) {
+			ChunkLODs chunk;
+			chunk.mins = i->key;
+			chunk.ranges[0] = {(uint32_t)indCount, (uint32_t)mesh->getNoOfIndices()};
+			state._chunks.push_back(chunk);
+		}
+		addMesh(mesh);
+	}
+	if (opaque) {
+		state._opaqueIndices = (uint32_t)indCount;
+		bool lods = false;
+		for (int lod = 1; lod < voxel::LODLevels; ++lod) {
+			const voxel::MeshState::MeshesMap &lodMeshes = meshState->lodMeshes(lod, bufferIndex);
+			for (ChunkLODs &chunk : state._chunks) {
+				auto iter = lodMeshes.find(chunk.mins);
+				if (iter == lodMeshes.end()) {
+					continue;
+				}
+				const voxel::Mesh *mesh = iter->value;
+				if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
+					continue;
+				}
+				chunk.ranges[lod] = {(uint32_t)indCount, (uint32_t)mesh->getNoOfIndices()};
+				addMesh(mesh);
+				lods = true;
+			}
+		}
+		if (!lods) {
+			state._chunks.clear();
+		}
+	}
 
-	RenderState &state = _state[bufferIndex];
 	if (indCount == 0u || vertCount == 0u) {
 		Log::debug("clear vertexbuffer: %i", idx);
 		video::Buffer &buffer = state._vertexBuffer[type];
@@ -281,70 +513,118 @@ bool RawVolumeRenderer::updateBufferForVolume(const voxel::MeshStatePtr &meshSta
 		return true;
 	}
 
-	const size_t verticesBufSize = vertCount * sizeof(voxel::VoxelVertex);
-	voxel::VoxelVertex *verticesBuf = (voxel::VoxelVertex *)core_malloc(verticesBufSize);
-	const size_t normalsBufSize = normalsCount * sizeof(glm::vec3);
-	glm::vec3 *normalsBuf = (glm::vec3 *)core_malloc(normalsBufSize);
-	const size_t indicesBufSize = indCount * sizeof(voxel::IndexType);
-	voxel::IndexType *indicesBuf = (voxel::IndexType *)core_malloc(indicesBufSize);
+	bool packed = false;
+	if (_packedVertices) {
+		const voxel::RawVolume *volume = meshState->volume(bufferIndex);
+		if (volume != nullptr) {
+			const voxel::Region &region = volume->region();
+			state._offset = region.getLowerCorner();
+			// the vertices are on the voxel corners - so the positions relative to the lower corner are in [0, dim]
+			packed = glm::all(glm::lessThanEqual(region.getDimensionsInVoxels(), glm::ivec3(INT16_MAX)));
+			if (!packed) {
+				Log::debug("Volume %i is too big for 16 bit vertex positions - use the float layout", idx);
+			}
+		} else {
+			state._offset = glm::ivec3(0);
+		}
+	} else {
+		state._offset = glm::ivec3(0);
+	}
+	if (state._packed[type] != packed) {
+		initVertexAttributes(state, type, packed);
+	}
+	// all vertices of the volume are addressable with 16 bit indices
+	const bool shortIndices = vertCount <= (size_t)UINT16_MAX + 1u;
+	state._indexSize[type] = shortIndices ? sizeof(uint16_t) : sizeof(voxel::IndexType);
 
-	voxel::VoxelVertex *verticesPos = verticesBuf;
+	const size_t vertexSize = packed ? sizeof(voxel::PackedVoxelVertex) : sizeof(voxel::VoxelVertex);
+	const size_t verticesBufSize = vertCount * vertexSize;
+	const size_t normalsBufSize = normalsCount * sizeof(glm::vec3);
+	const size_t indicesBufSize = indCount * state._indexSize[type];
+	// the uploaded data must be 16 byte aligned
+	const size_t normalsBufOffset = (verticesBufSize + 15u) & ~(size_t)15u;
+	const size_t indicesBufOffset = (normalsBufOffset + normalsBufSize + 15u) & ~(size_t)15u;
+	uint8_t *staging = stagingBuffer(indicesBufOffset + indicesBufSize);
+	uint8_t *verticesBuf = staging;
+	glm::vec3 *normalsBuf = (glm::vec3 *)(staging + normalsBufOffset);
+	uint8_t *indicesBuf = staging + indicesBufOffset;
+
+	uint8_t *verticesPos = verticesBuf;
 	glm::vec3 *normalsPos = normalsBuf;
-	voxel::IndexType *indicesPos = indicesBuf;
+	uint16_t *shortIndicesPos = (uint16_t *)indicesBuf;
+	voxel::IndexType *indicesPos = (voxel::IndexType *)indicesBuf;
 
 	voxel::IndexType offset = (voxel::IndexType)0;
-	for (const auto &i : meshState->meshes(type)) {
-		const voxel::MeshState::Meshes &meshes = i->second;
-		const voxel::Mesh *mesh = meshes[bufferIndex];
-		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
-			continue;
-		}
+	for (const voxel::Mesh *mesh : meshes) {
 		const voxel::VertexArray &vertexVector = mesh->getVertexVector();
 		const voxel::NormalArray &normalVector = mesh->getNormalVector();
 		const voxel::IndexArray &indexVector = mesh->getIndexVector();
-		core_memcpy(verticesPos, &vertexVector[0], vertexVector.size() * sizeof(voxel::VoxelVertex));
+		if (packed) {
+			voxel::PackedVoxelVertex *packedPos = (voxel::PackedVoxelVertex *)verticesPos;
+			for (const voxel::VoxelVertex &vertex : vertexVector) {
+				const glm::ivec3 position = glm::ivec3(vertex.position) - state._offset;
+				core_assert(glm::all(glm::greaterThanEqual(position, glm::ivec3(0))) &&
+							glm::all(glm::lessThanEqual(position, glm::ivec3(INT16_MAX))));
+				packedPos->position = glm::i16vec3(position);
+				packedPos->info = vertex.info;
+				packedPos->colorIndex = vertex.colorIndex;
+				packedPos->normalIndex = vertex.normalIndex;
+				++packedPos;
+			}
+		} else if (state._offset != glm::ivec3(0)) {
+			voxel::VoxelVertex *vertexPos = (voxel::VoxelVertex *)verticesPos;
+			const glm::vec3 vertexOffset(state._offset);
+			for (const voxel::VoxelVertex &vertex : vertexVector) {
+				*vertexPos = vertex;
+				vertexPos->position -= vertexOffset;
+				++vertexPos;
+			}
+		} else {
+			core_memcpy(verticesPos, &vertexVector[0], vertexVector.size() * sizeof(voxel::VoxelVertex));
+		}
 		if (!normalVector.empty()) {
 			core_assert(vertexVector.size() == normalVector.size());
 			core_memcpy(normalsPos, &normalVector[0], normalVector.size() * sizeof(glm::vec3));
 		}
-		core_memcpy(indicesPos, &indexVector[0], indexVector.size() * sizeof(voxel::IndexType));
-
-		for (size_t j = 0; j < indexVector.size(); ++j) {
-			*indicesPos++ += offset;
+		if (shortIndices) {
+			for (size_t j = 0; j < indexVector.size(); ++j) {
+				*shortIndicesPos++ = (uint16_t)(indexVector[j] + offset);
+			}
+		} else {
+			for (size_t j = 0; j < indexVector.size(); ++j) {
+				*indicesPos++ = indexVector[j] + offset;
+			}
 		}
 
-		verticesPos += vertexVector.size();
+		verticesPos += vertexVector.size() * vertexSize;
 		normalsPos += normalVector.size();
 		offset += vertexVector.size();
 	}
 	state._dirtyNormals = true;
 
+	// the buffers are in the static mode - the data is uploaded into new storage (orphaning) instead of waiting for the
+	// draw calls that are still using the old storage
 	Log::debug("update vertexbuffer: %i (type: %i)", idx, type);
 	if (!state._vertexBuffer[type].update(state._vertexBufferIndex[type], verticesBuf, verticesBufSize)) {
 		Log::error("Failed to update the vertex buffer");
-		core_free(indicesBuf);
-		core_free(verticesBuf);
 		return false;
 	}
-	core_free(verticesBuf);
 
 	if (state._normalBufferIndex[type] != -1) {
 		Log::debug("update normalbuffer: %i (type: %i)", idx, type);
 		if (!state._vertexBuffer[type].update(state._normalBufferIndex[type], normalsBuf, normalsBufSize)) {
 			Log::error("Failed to update the normal buffer");
-			core_free(normalsBuf);
 			return false;
 		}
 	}
-	core_free(normalsBuf);
 
 	Log::debug("update indexbuffer: %i (type: %i)", idx, type);
 	if (!state._vertexBuffer[type].update(state._indexBufferIndex[type], indicesBuf, indicesBufSize)) {
 		Log::error("Failed to update the index buffer");
-		core_free(indicesBuf);
 		return false;
 	}
-	core_free(indicesBuf);
+	core::perfAdd(core::PerfStat::UploadBytes, verticesBufSize + indicesBufSize +
+												   (state._normalBufferIndex[type] != -1 ? normalsBufSize : (size_t)0u));
 	return true;
 }
 
@@ -373,7 +653,11 @@ bool RawVolumeRenderer::updateBufferForVolume(const voxel::MeshStatePtr &meshSta
 
 void RawVolumeRenderer::clear(const voxel::MeshStatePtr &meshState) {
 	meshState->clearPendingExtractions();
-	for (int i = 0; i < voxel::MAX_VOLUMES; ++i) {
+	for (int idx : _pendingUploads) {
+		_state[idx]->_pendingUpload = false;
+	}
+	_pendingUploads.clear();
+	for (int i = 0; i < meshState->volumeSlots(); ++i) {
 		// TODO: collect the old volumes and allow to let the caller delete them - they might not all be managed by a
 		// node or brush
 		voxel::RawVolume *old = resetVolume(meshState, i);
@@ -384,22 +668,27 @@ void RawVolumeRenderer::clear(const voxel::MeshStatePtr &meshState) {
 	meshState->resetReferences();
 }
 
-void RawVolumeRenderer::updatePalette(const voxel::MeshStatePtr &meshState, int idx) {
+void RawVolumeRenderer::updatePaletteAtlas(const voxel::MeshStatePtr &meshState) {
+	for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
+		if (meshState->hidden(idx) || meshState->volume(meshState->resolveIdx(idx)) == nullptr) {
+			continue;
+		}
+		_paletteAtlas.layer(meshState->palette(meshState->resolveIdx(idx)));
+	}
+	core_assert_always(_paletteAtlas.upload());
+	core_trace_plot("RawVolumeRendererPaletteLayers", (int64_t)_paletteAtlas.layers());
+}
+
+int RawVolumeRenderer::updatePalette(const voxel::MeshStatePtr &meshState, int idx) {
 	const int bufferIndex = meshState->resolveIdx(idx);
 	const palette::Palette &palette = meshState->palette(bufferIndex);
 	const palette::NormalPalette &normalsPalette = meshState->normalsPalette(bufferIndex);
 
-	if (palette.hash() != _paletteHash) {
-		_paletteHash = palette.hash();
-		core::DynamicArray<glm::vec4> materialColors;
-		palette.toVec4f(materialColors);
-		core::DynamicArray<glm::vec4> glowColors;
-		palette.emitToVec4f(glowColors);
-		static_assert(lengthof(_voxelShaderVertData.materialcolor) == palette::PaletteMaxColors);
-		for (int i = 0; i < lengthof(_voxelShaderVertData.materialcolor); ++i) {
-			_voxelShaderVertData.materialcolor[i] = materialColors[i];
-			_voxelShaderVertData.glowcolor[i] = glowColors[i];
-		}
+	int layer = _paletteAtlas.find(palette);
+	if (layer == -1) {
+		// not added by updatePaletteAtlas() - or the atlas was cleared because it ran out of layers
+		layer = _paletteAtlas.layer(palette);
+		core_assert_always(_paletteAtlas.upload());
 	}
 
 	if (normalsPalette.hash() != _normalsPaletteHash) {
@@ -410,44 +699,376 @@ void RawVolumeRenderer::updatePalette(const voxel::MeshStatePtr &meshState, int
 		for (int i = 0; i < lengthof(_voxelShaderVertData.normals); ++i) {
 			_voxelShaderVertData.normals[i] = normals[i];
 		}
+		_dirtyVertData = true;
 	}
+	return layer;
 }
 
-void RawVolumeRenderer::updateCulling(const voxel::MeshStatePtr &meshState, int idx, const video::Camera &camera) {
-	if (meshState->hidden(idx)) {
-		_state[idx]._culled = true;
+void RawVolumeRenderer::updateCulling(const voxel::MeshStatePtr &meshState, const video::Camera &camera) {
+	core_trace_scoped(UpdateCulling);
+	_cullBoxes.clear();
+	_cullBoxes.reserve(meshState->volumeSlots());
+	_cullBoxIndices.clear();
+	_cullBoxIndices.resize(meshState->volumeSlots());
+	for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
+		_cullBoxIndices[idx] = -1;
+		// check a potentially referenced mesh here
+		const int bufferIndex = meshState->resolveIdx(idx);
+		const RenderState *bufferState = renderState(bufferIndex);
+		RenderState *state = renderState(idx);
+		if (state == nullptr) {
+			if (bufferState == nullptr || meshState->hidden(idx)) {
+				// nothing was uploaded for the volume - see isVisible()
+				continue;
+			}
+			state = &createRenderState(idx);
+		}
+		if (meshState->hidden(idx)) {
+			state->_culled = true;
+			continue;
+		}
+		state->_culled = false;
+		state->_empty = false;
+		if (bufferState == nullptr || !bufferState->hasData()) {
+			state->_empty = true;
+			continue;
+		}
+		const glm::ivec3 &mins = meshState->mins(idx);
+		const glm::ivec3 &maxs = meshState->maxs(idx);
+		const glm::vec3 size = maxs - mins;
+		// if no mins/maxs were given, we can't cull
+		if (size.x >= 1.0f && size.y >= 1.0f && size.z >= 1.0f) {
+			_cullBoxIndices[idx] = _cullBoxes.add(mins, maxs);
+		}
+	}
+	if (_cullBoxes.size() == 0) {
 		return;
 	}
-	_state[idx]._culled = false;
-	_state[idx]._empty = false;
-	// check a potentially referenced mesh here
+	camera.frustum().isVisible(_cullBoxes, _cullVisible);
+	for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
+		const int box = _cullBoxIndices[idx];
+		if (box != -1) {
+			renderState(idx)->_culled = !math::Frustum::isVisible(_cullVisible, box);
+		}
+	}
+}
+
+int RawVolumeRenderer::lodLevel(float voxelPixels) {
+	int lod = 0;
+	while (lod + 1 < voxel::LODLevels && voxelPixels * (float)(1 << (lod + 1)) <= LODMaxVoxelPixels) {
+		++lod;
+	}
+	return lod;
+}
+
+void RawVolumeRenderer::downsample(const voxel::RawVolume &source, const palette::Palette &palette,
+								   const voxel::Region &sourceRegion, voxel::RawVolume &dest) {
+	// a lower resolution voxel is solid if any of its voxels is solid - the meshes of the levels of detail cover the
+	// full resolution meshes
+	voxelutil::scaleDown(source, palette, sourceRegion, dest, dest.region(), 1);
+}
+
+void RawVolumeRenderer::updateLODs(const voxel::MeshStatePtr &meshState, int idx, const video::Camera &camera) {
+	RenderState &state = createRenderState(idx);
+	state._draws.clear();
+	state._chunkLODs.clear();
 	const int bufferIndex = meshState->resolveIdx(idx);
-	if (!_state[bufferIndex].hasData()) {
-#if 0
-		if (_state[bufferIndex]._rawVolume) {
-			Log::trace("No data, but volume: %i", bufferIndex);
+	const RenderState &bufferState = createRenderState(bufferIndex);
+	if (bufferState._chunks.empty()) {
+		return;
+	}
+	core_trace_scoped(UpdateLODs);
+	const glm::mat4 &model = meshState->model(idx);
+	const glm::vec3 &pivot = meshState->pivot(idx);
+	const float scale = glm::max(glm::length(glm::vec3(model[0])),
+								 glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	// the pixels of one unit in the distance of one unit - or in any distance for the orthogonal projection
+	const float unitPixels = camera.projectionMatrix()[1][1] * 0.5f * (float)camera.size().y;
+	const bool perspective = camera.mode() == video::CameraMode::Perspective;
+	const float chunkSize = (float)meshState->meshSize();
+	const float radius = glm::length(glm::vec3(chunkSize * 0.5f)) * scale;
+	const glm::vec3 &camPos = camera.worldPosition();
+	const float voxelPixels = scale * unitPixels;
+	for (const ChunkLODs &chunk : bufferState._chunks) {
+		int lod = 0;
+		if (perspective) {
+			// the distance to the nearest point of the chunk - the camera might be inside of it
+			const glm::vec3 center = glm::vec3(chunk.mins) + chunkSize * 0.5f - pivot;
+			const float distance = glm::distance(camPos, glm::vec3(model * glm::vec4(center, 1.0f))) - radius;
+			if (distance > 0.0f) {
+				lod = lodLevel(voxelPixels / distance);
+			}
+		} else {
+			lod = lodLevel(voxelPixels);
 		}
-#endif
-		_state[idx]._empty = true;
+		while (lod > 0 && chunk.ranges[lod].indices == 0u) {
+			--lod;
+		}
+		state._chunkLODs.push_back((uint8_t)lod);
+		const IndexRange &range = chunk.ranges[lod];
+		if (!state._draws.empty() && state._draws.back().offset + state._draws.back().indices == range.offset) {
+			state._draws.back().indices += range.indices;
+		} else {
+			state._draws.push_back(range);
+		}
+	}
+}
+
+void RawVolumeRenderer::updateIndirectCommands(const voxel::MeshStatePtr &meshState) {
+	_indirectCommands.clear();
+	if (!_multiDrawIndirect) {
+		return;
+	}
+	for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
+		if (!isVisible(meshState, idx)) {
+			continue;
+		}
+		RenderState &state = *_state[idx];
+		state._indirectDraws = 0;
+		// a single range is drawn with a regular draw call
+		if (state._draws.size() <= 1u) {
+			continue;
+		}
+		state._indirectOffset = (uint32_t)(_indirectCommands.size() * sizeof(video::DrawElementsIndirectCommand));
+		state._indirectDraws = (int)state._draws.size();
+		for (const IndexRange &range : state._draws) {
+			video::DrawElementsIndirectCommand cmd;
+			cmd.count = range.indices;
+			cmd.firstIndex = range.offset;
+			_indirectCommands.push_back(cmd);
+		}
+	}
+	if (_indirectCommands.empty()) {
 		return;
 	}
-	const glm::ivec3 &mins = meshState->mins(idx);
-	const glm::ivec3 &maxs = meshState->maxs(idx);
-	const glm::vec3 size = maxs - mins;
-	// if no mins/maxs were given, we can't cull
-	if (size.x >= 1.0f && size.y >= 1.0f && size.z >= 1.0f) {
-		_state[idx]._culled = !camera.isVisible(mins, maxs);
+	core_trace_scoped(UpdateIndirectCommands);
+	if (_indirectBuffer == video::InvalidId) {
+		_indirectBuffer = video::genBuffer();
 	}
+	video::bufferData(_indirectBuffer, video::BufferType::IndirectBuffer, video::BufferMode::Stream,
+					  _indirectCommands.data(), _indirectCommands.size() * sizeof(video::DrawElementsIndirectCommand));
+}
+
+void RawVolumeRenderer::drawOpaque(int idx, int bufferIndex) const {
+	const RenderState &bufferState = *renderState(bufferIndex);
+	const size_t indexSize = bufferState._indexSize[voxel::MeshType_Opaque];
+	const RenderState &state = *renderState(idx);
+	const core::DynamicArray<IndexRange> &draws = state._draws;
+	if (draws.empty()) {
+		video::drawElements(video::Primitive::Triangles, bufferState._opaqueIndices, indexSize);
+		return;
+	}
+	if (state._indirectDraws > 0) {
+		video::bindBuffer(video::BufferType::IndirectBuffer, _indirectBuffer);
+		video::multiDrawElementsIndirect(video::Primitive::Triangles, indexSize, state._indirectOffset,
+										 state._indirectDraws);
+		return;
+	}
+	for (const IndexRange &range : draws) {
+		video::drawElements(video::Primitive::Triangles, range.indices, indexSize,
+							(void *)((uintptr_t)range.offset * indexSize));
+	}
+}
+
+void RawVolumeRenderer::addInstanceCommands(int idx, int bufferIndex, uint32_t baseInstance) {
+	video::DrawElementsIndirectCommand cmd;
+	// the model matrix of the instance is taken from this slot of the instance buffer
+	cmd.baseInstance = baseInstance;
+	const core::DynamicArray<IndexRange> &draws = renderState(idx)->_draws;
+	if (draws.empty()) {
+		cmd.count = renderState(bufferIndex)->_opaqueIndices;
+		_instanceCommands.push_back(cmd);
+		return;
+	}
+	for (const IndexRange &range : draws) {
+		cmd.count = range.indices;
+		cmd.firstIndex = range.offset;
+		_instanceCommands.push_back(cmd);
+	}
+}
+
+void RawVolumeRenderer::drawOpaqueInstanced(int idx, int bufferIndex, int instances) const {
+	const RenderState &bufferState = *renderState(bufferIndex);
+	const size_t indexSize = bufferState._indexSize[voxel::MeshType_Opaque];
+	if (!_instanceCommands.empty()) {
+		video::bindBuffer(video::BufferType::IndirectBuffer, _instanceIndirectBuffer);
+		video::multiDrawElementsIndirect(video::Primitive::Triangles, indexSize, 0u, (int)_instanceCommands.size());
+		return;
+	}
+	const core::DynamicArray<IndexRange> &draws = renderState(idx)->_draws;
+	if (draws.empty()) {
+		video::drawElementsInstanced(video::Primitive::Triangles, bufferState._opaqueIndices, indexSize, instances);
+		return;
+	}
+	for (const IndexRange &range : draws) {
+		video::drawElementsInstanced(video::Primitive::Triangles, range.indices, indexSize, instances,
+									 (void *)((uintptr_t)range.offset * indexSize));
+	}
+}
+
+void RawVolumeRenderer::drawOpaqueShadow(const voxel::MeshStatePtr &meshState, int idx, int bufferIndex,
+										 const math::Frustum &frustum) const {
+	const RenderState &bufferState = *renderState(bufferIndex);
+	const RenderState &state = *renderState(idx);
+	if (bufferState._chunks.empty() || state._chunkLODs.size() != bufferState._chunks.size()) {
+		drawOpaque(idx, bufferIndex);
+		return;
+	}
+	const size_t indexSize = bufferState._indexSize[voxel::MeshType_Opaque];
+	const glm::mat4 &model = meshState->model(idx);
+	const glm::vec3 &pivot = meshState->pivot(idx);
+	const float scale = glm::max(glm::length(glm::vec3(model[0])),
+								 glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	const float chunkSize = (float)meshState->meshSize();
+	const float radius = glm::length(glm::vec3(chunkSize * 0.5f)) * scale;
+	IndexRange draw;
+	for (size_t i = 0; i < bufferState._chunks.size(); ++i) {
+		const ChunkLODs &chunk = bufferState._chunks[i];
+		const glm::vec3 center = glm::vec3(chunk.mins) + chunkSize * 0.5f - pivot;
+		if (!frustum.isVisible(glm::vec3(model * glm::vec4(center, 1.0f)), radius)) {
+			continue;
+		}
+		const IndexRange &range = chunk.ranges[state._chunkLODs[i]];
+		if (draw.indices > 0u && draw.offset + draw.indices == range.offset) {
+			draw.indices += range.indices;
+			continue;
+		}
+		if (draw.indices > 0u) {
+			video::drawElements(video::Primitive::Triangles, draw.indices, indexSize,
+								(void *)((uintptr_t)draw.offset * indexSize));
+		}
+		draw = range;
+	}
+	if (draw.indices > 0u) {
+		video::drawElements(video::Primitive::Triangles, draw.indices, indexSize,
+							(void *)((uintptr_t)draw.offset * indexSize));
+	}
+}
+
+void RawVolumeRenderer::updateShadowCasters(const voxel::MeshStatePtr &meshState, RenderContext &renderContext) {
+	core_trace_scoped(UpdateShadowCasters);
+	uint32_t hash = 0u;
+	for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
+		if (!isVisible(meshState, idx)) {
+			continue;
+		}
+		const int bufferIndex = meshState->resolveIdx(idx);
+		const RenderState *state = renderState(idx);
+		const video::Face cullFace = meshState->cullFace(idx);
+		hash = core::hash(&idx, sizeof(idx), hash);
+		hash = core::hash(&bufferIndex, sizeof(bufferIndex), hash);
+		hash = core::hash(&cullFace, sizeof(cullFace), hash);
+		hash = core::hash(glm::value_ptr(meshState->model(idx)), sizeof(glm::mat4), hash);
+		hash = core::hash(glm::value_ptr(meshState->pivot(idx)), sizeof(glm::vec3), hash);
+		hash = core::hash(glm::value_ptr(meshState->mins(idx)), sizeof(glm::vec3), hash);
+		hash = core::hash(glm::value_ptr(meshState->maxs(idx)), sizeof(glm::vec3), hash);
+		if (state != nullptr && !state->_chunkLODs.empty()) {
+			hash = core::hash(state->_chunkLODs.data(), (int)state->_chunkLODs.size(), hash);
+		}
+	}
+	if (hash != renderContext.shadowCasterHash) {
+		renderContext.shadowCasterHash = hash;
+		renderContext.shadow.markDirty();
+	}
+}
+
+void RawVolumeRenderer::markShadowDirty(const voxel::MeshStatePtr &meshState, int bufferIndex) {
+	for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
+		if (meshState->resolveIdx(idx) != bufferIndex) {
+			continue;
+		}
+		const glm::vec3 &mins = meshState->mins(idx);
+		const glm::vec3 &maxs = meshState->maxs(idx);
+		const glm::vec3 size = maxs - mins;
+		// if no mins/maxs were given, the extent of the volume is unknown
+		if (size.x >= 1.0f && size.y >= 1.0f && size.z >= 1.0f) {
+			addShadowInvalidation(mins, maxs, false);
+		} else {
+			addShadowInvalidation(mins, maxs, true);
+			return;
+		}
+	}
+}
+
+void RawVolumeRenderer::addShadowInvalidation(const glm::vec3 &mins, const glm::vec3 &maxs, bool all) {
+	ShadowInvalidation &invalidation = _shadowInvalidations[_shadowInvalidationCount % MaxShadowInvalidations];
+	invalidation.mins = mins;
+	invalidation.maxs = maxs;
+	invalidation.all = all;
+	++_shadowInvalidationCount;
+}
+
+void RawVolumeRenderer::applyShadowInvalidations(RenderContext &renderContext) {
+	Shadow &shadow = renderContext.shadow;
+	if (_shadowInvalidationCount - renderContext.shadowInvalidation > (uint64_t)MaxShadowInvalidations) {
+		// the oldest invalidations were already overwritten
+		shadow.markDirty();
+	} else {
+		for (uint64_t i = renderContext.shadowInvalidation; i < _shadowInvalidationCount; ++i) {
+			const ShadowInvalidation &invalidation = _shadowInvalidations[i % MaxShadowInvalidations];
+			if (invalidation.all) {
+				shadow.markDirty();
+				break;
+			}
+			shadow.markDirty(invalidation.mins, invalidation.maxs);
+		}
+	}
+	renderContext.shadowInvalidation = _shadowInvalidationCount;
+}
+
+bool RawVolumeRenderer::prepareShadow(RenderContext &renderContext, const video::Camera &camera) {
+	Shadow &shadow = renderContext.shadow;
+	if (shadow.parameters().maxDepthBuffers == -1) {
+		if (!shadow.init(_shadowParameters)) {
+			Log::error("Failed to initialize the shadow object");
+			shadow.shutdown();
+			return false;
+		}
+		// the fresh cascades are rendered completely anyway
+		renderContext.shadowInvalidation = _shadowInvalidationCount;
+	}
+	shadow.setLightViewMatrix(_lightView);
+	applyShadowInvalidations(renderContext);
+	shadow.update(camera, true);
+	return true;
+}
+
+bool RawVolumeRenderer::canInstance(const voxel::MeshStatePtr &meshState, int idx, int otherIdx) const {
+	if (meshState->cullFace(idx) != meshState->cullFace(otherIdx) ||
+		meshState->grayed(idx) != meshState->grayed(otherIdx)) {
+		return false;
+	}
+	if (_multiDrawIndirect) {
+		// each instance gets its own commands for the levels of detail - see addInstanceCommands()
+		return true;
+	}
+	// the levels of detail are selected per volume
+	const core::DynamicArray<IndexRange> &draws = renderState(idx)->_draws;
+	const core::DynamicArray<IndexRange> &otherDraws = renderState(otherIdx)->_draws;
+	if (draws.size() != otherDraws.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < draws.size(); ++i) {
+		if (draws[i].offset != otherDraws[i].offset || draws[i].indices != otherDraws[i].indices) {
+			return false;
+		}
+	}
+	return true;
 }
 
 bool RawVolumeRenderer::isVisible(const voxel::MeshStatePtr &meshState, int idx, bool hideEmpty) const {
 	if (meshState->hidden(idx)) {
 		return false;
 	}
-	if (_state[idx]._culled) {
+	const RenderState *state = renderState(idx);
+	if (state == nullptr) {
+		// there is nothing to render yet - but the volume was not culled either
+		return !hideEmpty;
+	}
+	if (state->_culled) {
 		return false;
 	}
-	if (hideEmpty && _state[idx]._empty) {
+	if (hideEmpty && state->_empty) {
 		return false;
 	}
 	return true;
@@ -461,7 +1082,8 @@ void RawVolumeRenderer::renderNormals(const voxel::MeshStatePtr &meshState, cons
 	}
 
 	core_trace_scoped(RenderNormals);
-	for (int idx = 0; idx < voxel::MAX_VOLUMES; ++idx) {
+	video_pass_scoped(RenderNormals);
+	for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
 		if (!isVisible(meshState, idx)) {
 			continue;
 		}
@@ -469,7 +1091,8 @@ void RawVolumeRenderer::renderNormals(const voxel::MeshStatePtr &meshState, cons
 		if (normalPalette.size() == 0u) {
 			continue;
 		}
-		if (_state[idx]._dirtyNormals) {
+		RenderState &state = *_state[idx];
+		if (state._dirtyNormals) {
 			_shapeBuilder.clear();
 			_shapeBuilder.setColor(core::Color::Red());
 			if (const voxel::RawVolume *v = meshState->volume(idx)) {
@@ -484,70 +1107,343 @@ void RawVolumeRenderer::renderNormals(const voxel::MeshStatePtr &meshState, cons
 					Log::debug("Don't create normals for large volumes");
 				}
 			}
-			_shapeRenderer.createOrUpdate(_state[idx]._normalPreviewBufferIndex, _shapeBuilder);
-			_state[idx]._dirtyNormals = false;
+			_shapeRenderer.createOrUpdate(state._normalPreviewBufferIndex, _shapeBuilder);
+			state._dirtyNormals = false;
 		}
-		_shapeRenderer.render(_state[idx]._normalPreviewBufferIndex, camera);
+		_shapeRenderer.render(state._normalPreviewBufferIndex, camera);
 	}
 }
 
-void RawVolumeRenderer::renderOpaque(const voxel::MeshStatePtr &meshState, const video::Camera &camera, bool normals) {
+bool RawVolumeRenderer::occlusionBox(const voxel::MeshStatePtr &meshState, int idx, const video::Camera &camera,
+									 glm::mat4 &model) const {
+	const voxel::RawVolume *volume = meshState->volume(meshState->resolveIdx(idx));
+	if (volume == nullptr) {
+		return false;
+	}
+	// the box is a bit bigger than the region to not be occluded by the faces of the volume itself
+	const voxel::Region &region = volume->region();
+	const glm::vec3 &pivot = meshState->pivot(idx);
+	const glm::vec3 mins = glm::vec3(region.getLowerCorner()) - pivot - 1.0f;
+	const glm::vec3 maxs = glm::vec3(region.getUpperCorner()) - pivot + 2.0f;
+	const glm::mat4 &volumeModel = meshState->model(idx);
+	// the near plane would clip the box if the camera is inside of it
+	const glm::vec3 camPos = glm::inverse(volumeModel) * glm::vec4(camera.worldPosition(), 1.0f);
+	const float nearPlane = camera.nearPlane();
+	if (glm::all(glm::greaterThanEqual(camPos, mins - nearPlane)) &&
+		glm::all(glm::lessThanEqual(camPos, maxs + nearPlane))) {
+		return false;
+	}
+	model = glm::scale(glm::translate(volumeModel, mins), maxs - mins);
+	return true;
+}
+
+bool RawVolumeRenderer::isOccluded(const RenderContext &renderContext, int idx) const {
+	if (idx < 0 || idx >= (int)renderContext.occlusionQueries.size()) {
+		return false;
+	}
+	return renderContext.occlusionQueries[idx].occluded;
+}
+
+void RawVolumeRenderer::updateOcclusion(const voxel::MeshStatePtr &meshState, RenderContext &renderContext,
+										const video::Camera &camera) {
+	OcclusionStats &stats = renderContext.occlusionStats;
+	stats = OcclusionStats();
+	core::DynamicArray<OcclusionQuery> &queries = renderContext.occlusionQueries;
+	const bool enabled = _occlusionCulling->boolVal();
+	if (enabled && (int)queries.size() < meshState->volumeSlots()) {
+		queries.resize(meshState->volumeSlots());
+	}
+	for (int idx = 0; idx < (int)queries.size(); ++idx) {
+		OcclusionQuery &query = queries[idx];
+		if (!enabled || !isVisible(meshState, idx)) {
+			// a volume that gets visible again is rendered until a query says otherwise
+			query.occluded = false;
+			continue;
+		}
+		if (query.pending && video::isQueryResultAvailable(query.query)) {
+			query.occluded = video::queryResult(query.query) == 0u;
+			query.pending = false;
+		}
+		glm::mat4 model;
+		if (!occlusionBox(meshState, idx, camera, model)) {
+			query.occluded = false;
+		}
+		++stats.tested;
+		if (query.occluded) {
+			++stats.occluded;
+		}
+	}
+	core_trace_plot("RawVolumeRendererOccluded", (int64_t)stats.occluded);
+}
+
+void RawVolumeRenderer::renderOcclusionQueries(const voxel::MeshStatePtr &meshState, RenderContext &renderContext,
+											   const video::Camera &camera) {
+	if (!_occlusionCulling->boolVal() || _occlusionBoxMesh == -1) {
+		return;
+	}
+	core_trace_scoped(RenderOcclusionQueries);
+	video_pass_scoped(RenderOcclusionQueries);
+	core::DynamicArray<OcclusionQuery> &queries = renderContext.occlusionQueries;
+	// only the depth test is needed - the boxes are not visible
+	video::ScopedState scopedDepthMask(video::State::DepthMask, false);
+	video::ScopedState scopedCullFace(video::State::CullFace, false);
+	video::colorMask(false, false, false, false);
+	for (int idx = 0; idx < (int)queries.size(); ++idx) {
+		OcclusionQuery &query = queries[idx];
+		if (query.pending || !isVisible(meshState, idx)) {
+			continue;
+		}
+		glm::mat4 model;
+		if (!occlusionBox(meshState, idx, camera, model)) {
+			continue;
+		}
+		if (query.query == video::InvalidId) {
+			query.query = video::genQuery();
+		}
+		video::beginQuery(video::QueryType::AnySamplesPassed, query.query);
+		_shapeRenderer.render(_occlusionBoxMesh, camera, model);
+		video::endQuery(video::QueryType::AnySamplesPassed);
+		query.pending = true;
+	}
+	video::colorMask(true, true, true, true);
+}
+
+void RawVolumeRenderer::setViewProjection(const video::Camera &camera) {
+	const glm::mat4 &viewProjection = camera.viewProjectionMatrix();
+	if (_voxelShaderVertData.viewprojection != viewProjection) {
+		_voxelShaderVertData.viewprojection = viewProjection;
+		_dirtyVertData = true;
+	}
+}
+
+void RawVolumeRenderer::updateFragData(const Shadow &shadow) {
+	_voxelShaderFragData.depthsize = shadow.dimension();
+	for (int i = 0; i < shader::VoxelShaderConstants::getMaxDepthBuffers(); ++i) {
+		_voxelShaderFragData.cascades[i] = shadow.cascades()[i];
+		_voxelShaderFragData.distances[i] = shadow.distances()[i];
+	}
+	_voxelShaderFragData.lightdir = shadow.sunDirection();
+	core_assert_always(_voxelData.update(_voxelShaderFragData));
+}
+
+void RawVolumeRenderer::clearShadow(Shadow &shadow) {
+	// the cleared cascades don't contain any shadow casters
+	shadow.markDirty();
+	shadow.render([](int i, const glm::mat4 &lightViewProjection) {
+		video::clear(video::ClearFlag::Depth);
+		return true;
+	});
+	shadow.markDirty();
+}
+
+void RawVolumeRenderer::setVoxelShaderUniforms(bool normals) {
+	if (_dirtyVertData) {
+		core_assert_always(_voxelData.update(_voxelShaderVertData));
+		_dirtyVertData = false;
+	}
+	core_assert_always(_voxelData.update(_voxelShaderObjectData));
+	if (normals) {
+		core_assert_always(_voxelNormShader.setFrag(_voxelData.getFragUniformBuffer()));
+		core_assert_always(_voxelNormShader.setVert(_voxelData.getVertUniformBuffer()));
+		core_assert_always(_voxelNormShader.setObject(_voxelData.getObjectUniformBuffer()));
+		if (_shadowMap->boolVal()) {
+			_voxelNormShader.setShadowmap(video::TextureUnit::One);
+		}
+		_voxelNormShader.setPalettes(video::TextureUnit::Four);
+	} else {
+		core_assert_always(_voxelShader.setFrag(_voxelData.getFragUniformBuffer()));
+		core_assert_always(_voxelShader.setVert(_voxelData.getVertUniformBuffer()));
+		core_assert_always(_voxelShader.setObject(_voxelData.getObjectUniformBuffer()));
+		if (_shadowMap->boolVal()) {
+			_voxelShader.setShadowmap(video::TextureUnit::One);
+		}
+		_voxelShader.setPalettes(video::TextureUnit::Four);
+	}
+}
+
+void RawVolumeRenderer::renderOpaque(const voxel::MeshStatePtr &meshState, const RenderContext &renderContext,
+									 const video::Camera &camera, bool normals) {
 	core_trace_scoped(RenderOpaque);
+	video_pass_scoped(RenderOpaque);
 	const video::PolygonMode mode = camera.polygonMode();
-	for (int idx = 0; idx < voxel::MAX_VOLUMES; ++idx) {
-		if (!isVisible(meshState, idx)) {
+	setViewProjection(camera);
+	_opaqueDraws.clear();
+	for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
+		if (!isVisible(meshState, idx) || isOccluded(renderContext, idx)) {
 			continue;
 		}
 		const int bufferIndex = meshState->resolveIdx(idx);
-		const uint32_t indices = _state[bufferIndex].indices(voxel::MeshType_Opaque);
-		if (indices == 0u) {
+		if (renderState(bufferIndex)->indices(voxel::MeshType_Opaque) == 0u) {
 			if (meshState->volume(bufferIndex)) {
 				Log::debug("No indices but volume for idx %d: %d", idx, bufferIndex);
 			}
 			continue;
 		}
+		_opaqueDraws.push_back(idx);
+	}
+	if (_instancing) {
+		// the references are sorted next to the volume they are using the buffers from
+		core::sort(_opaqueDraws.begin(), _opaqueDraws.end(), [&meshState](int a, int b) {
+			const int bufferIndexA = meshState->resolveIdx(a);
+			const int bufferIndexB = meshState->resolveIdx(b);
+			if (bufferIndexA != bufferIndexB) {
+				return bufferIndexA < bufferIndexB;
+			}
+			return a < b;
+		});
+	}
 
-		updatePalette(meshState, bufferIndex);
-		_voxelShaderVertData.viewprojection = camera.viewProjectionMatrix();
-		_voxelShaderVertData.model = meshState->model(idx);
-		_voxelShaderVertData.pivot = meshState->pivot(idx);
-		_voxelShaderVertData.gray = meshState->grayed(idx);
-		core_assert_always(_voxelData.update(_voxelShaderVertData));
+	int drawCalls = 0;
+	for (size_t i = 0; i < _opaqueDraws.size(); ++i) {
+		const int idx = _opaqueDraws[i];
+		if (idx == -1) {
+			// already rendered as an instance of another volume
+			continue;
+		}
+		const int bufferIndex = meshState->resolveIdx(idx);
+		RenderState &state = *renderState(bufferIndex);
+		int instances = 1;
+		if (_instancing) {
+			_instanceModels.clear();
+			_instanceCommands.clear();
+			for (size_t j = i; j < _opaqueDraws.size(); ++j) {
+				const int otherIdx = _opaqueDraws[j];
+				if (otherIdx == -1) {
+					continue;
+				}
+				if (meshState->resolveIdx(otherIdx) != bufferIndex) {
+					break;
+				}
+				if (!canInstance(meshState, idx, otherIdx)) {
+					continue;
+				}
+				const glm::vec3 pivot = meshState->pivot(otherIdx) - glm::vec3(state._offset);
+				if (_multiDrawIndirect) {
+					addInstanceCommands(otherIdx, bufferIndex, (uint32_t)_instanceModels.size());
+				}
+				_instanceModels.push_back(glm::translate(meshState->model(otherIdx), -pivot));
+				_opaqueDraws[j] = -1;
+			}
+			instances = (int)_instanceModels.size();
+			if (instances > 1) {
+				// must be updated before the vertex array is bound
+				state._vertexBuffer[voxel::MeshType_Opaque].update(
+					state._instanceBufferIndex, _instanceModels.data(), _instanceModels.size() * sizeof(glm::mat4),
+					true);
+				if (!_instanceCommands.empty()) {
+					if (_instanceIndirectBuffer == video::InvalidId) {
+						_instanceIndirectBuffer = video::genBuffer();
+					}
+					video::bufferData(_instanceIndirectBuffer, video::BufferType::IndirectBuffer,
+									  video::BufferMode::Stream, _instanceCommands.data(),
+									  _instanceCommands.size() * sizeof(video::DrawElementsIndirectCommand));
+				}
+			} else {
+				_instanceCommands.clear();
+			}
+		}
+
+		_voxelShaderObjectData.palettelayer = updatePalette(meshState, bufferIndex);
+		_voxelShaderObjectData.model = meshState->model(idx);
+		_voxelShaderObjectData.pivot = meshState->pivot(idx) - glm::vec3(state._offset);
+		_voxelShaderObjectData.gray = meshState->grayed(idx);
+		_voxelShaderObjectData.instanced = instances > 1;
+		if (!normals && _aoVolume->boolVal()) {
+			setAmbientOcclusionUniforms(meshState, bufferIndex, state);
+		}
 
 		video::ScopedPolygonMode polygonMode(mode);
 		video::ScopedFaceCull scopedFaceCull(meshState->cullFace(idx));
-		video::ScopedBuffer scopedBuf(_state[bufferIndex]._vertexBuffer[voxel::MeshType_Opaque]);
+		video::ScopedBuffer scopedBuf(state._vertexBuffer[voxel::MeshType_Opaque]);
 		core_assert(scopedBuf.success());
-		if (normals) {
-			core_assert_always(_voxelNormShader.setFrag(_voxelData.getFragUniformBuffer()));
-			core_assert_always(_voxelNormShader.setVert(_voxelData.getVertUniformBuffer()));
-			if (_shadowMap->boolVal()) {
-				_voxelNormShader.setShadowmap(video::TextureUnit::One);
-			}
+		setVoxelShaderUniforms(normals);
+		if (instances > 1) {
+			drawOpaqueInstanced(idx, bufferIndex, instances);
 		} else {
-			core_assert_always(_voxelShader.setFrag(_voxelData.getFragUniformBuffer()));
-			core_assert_always(_voxelShader.setVert(_voxelData.getVertUniformBuffer()));
-			if (_shadowMap->boolVal()) {
-				_voxelShader.setShadowmap(video::TextureUnit::One);
-			}
+			drawOpaque(idx, bufferIndex);
+		}
+		++drawCalls;
+	}
+	core_trace_plot("RawVolumeRendererOpaqueDraws", (int64_t)drawCalls);
+}
+
+bool RawVolumeRenderer::useOIT(const RenderContext &renderContext) const {
+	if (!_oit->boolVal()) {
+		return false;
+	}
+	// the depth of the opaque pass is copied from the framebuffer of the context
+	const video::FrameBuffer &frameBuffer = renderContext.frameBuffer;
+	return frameBuffer.handle() != video::InvalidId && video::currentFramebuffer() == frameBuffer.handle();
+}
+
+bool RawVolumeRenderer::prepareOIT(RenderContext &renderContext) {
+	video::FrameBuffer &oitFrameBuffer = renderContext.oitFrameBuffer;
+	const glm::ivec2 &size = renderContext.frameBuffer.dimension();
+	if (oitFrameBuffer.handle() == video::InvalidId || oitFrameBuffer.dimension() != size) {
+		oitFrameBuffer.shutdown();
+		video::TextureConfig textureCfg = video::createDefaultTextureConfig();
+		textureCfg.format(video::TextureFormat::RGBA16F);
+		textureCfg.filter(video::TextureFilter::Nearest);
+		video::FrameBufferConfig cfg;
+		cfg.dimension(size);
+		cfg.addTextureAttachment(textureCfg, video::FrameBufferAttachment::Color0); // accumulated colors
+		cfg.addTextureAttachment(textureCfg, video::FrameBufferAttachment::Color1); // accumulated weights
+		cfg.depthBuffer(true);
+		if (!oitFrameBuffer.init(cfg)) {
+			Log::error("Failed to initialize the order independent transparency framebuffer");
+			oitFrameBuffer.shutdown();
+			return false;
 		}
-		video::drawElements<voxel::IndexType>(video::Primitive::Triangles, indices);
 	}
+	oitFrameBuffer.bind(false);
+	// the transparent fragments are tested against the depth of the opaque pass
+	video::blitFramebuffer(renderContext.frameBuffer.handle(), oitFrameBuffer.handle(), video::ClearFlag::Depth,
+						   size.x, size.y);
+	const glm::vec4 clearColor = video::currentClearColor();
+	video::clearColor(glm::vec4(0.0f));
+	video::clear(video::ClearFlag::Color);
+	video::clearColor(clearColor);
+	return true;
+}
+
+void RawVolumeRenderer::compositeOIT(RenderContext &renderContext) {
+	core_trace_scoped(CompositeOIT);
+	video_pass_scoped(CompositeOIT);
+	video::FrameBuffer &oitFrameBuffer = renderContext.oitFrameBuffer;
+	oitFrameBuffer.unbind();
+	video::ScopedShader scoped(_oitCompositeShader);
+	video::ScopedState scopedDepth(video::State::DepthTest, false);
+	video::ScopedState scopedCullFace(video::State::CullFace, false);
+	video::ScopedState scopedBlend(video::State::Blend, true);
+	video::blendFunc(video::BlendMode::SourceAlpha, video::BlendMode::OneMinusSourceAlpha);
+	core_assert_always(_oitCompositeShader.setAccum(video::TextureUnit::Zero));
+	core_assert_always(_oitCompositeShader.setWeight(video::TextureUnit::Two));
+	video::bindTexture(video::TextureUnit::Zero, oitFrameBuffer.texture(video::FrameBufferAttachment::Color0));
+	video::bindTexture(video::TextureUnit::Two, oitFrameBuffer.texture(video::FrameBufferAttachment::Color1));
+	video::ScopedPolygonMode polygonMode(video::PolygonMode::Solid);
+	video::ScopedBuffer scopedBuf(_oitCompositeBuffer);
+	video::drawArrays(video::Primitive::Triangles, 6);
+	video::blendFuncSeparate(video::BlendMode::SourceAlpha, video::BlendMode::OneMinusSourceAlpha,
+							 video::BlendMode::One, video::BlendMode::OneMinusSourceAlpha);
 }
 
 void RawVolumeRenderer::renderTransparency(const voxel::MeshStatePtr &meshState, RenderContext &renderContext, const video::Camera &camera, bool normals) {
 	core_trace_scoped(RenderTransparency);
+	video_pass_scoped(RenderTransparency);
 	const video::PolygonMode mode = camera.polygonMode();
+	setViewProjection(camera);
+	// the weighted blended transparency doesn't depend on the order of the fragments
+	const bool oit = useOIT(renderContext);
 	core::DynamicArray<int> sorted;
 	{
 		core_trace_scoped(Sort);
-		sorted.reserve(voxel::MAX_VOLUMES);
-		for (int idx = 0; idx < voxel::MAX_VOLUMES; ++idx) {
-			if (!isVisible(meshState, idx)) {
+		sorted.reserve(meshState->volumeSlots());
+		for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
+			if (!isVisible(meshState, idx) || isOccluded(renderContext, idx)) {
 				continue;
 			}
 			const int bufferIndex = meshState->resolveIdx(idx);
-			const uint32_t indices = _state[bufferIndex].indices(voxel::MeshType_Transparency);
+			const uint32_t indices = renderState(bufferIndex)->indices(voxel::MeshType_Transparency);
 			if (indices == 0u) {
 				continue;
 			}
@@ -555,77 +1451,350 @@ void RawVolumeRenderer::renderTransparency(const voxel::MeshStatePtr &meshState,
 			sorted.push_back(idx);
 		}
 
-		const glm::vec3 &camPos = camera.worldPosition();
-		core::sort(sorted.begin(), sorted.end(), [&camPos, &meshState](int a, int b) {
-			const glm::vec3 &posA = meshState->centerPos(a);
-			const glm::vec3 &posB = meshState->centerPos(b);
-			const float d1 = glm::distance2(camPos, posA);
-			const float d2 = glm::distance2(camPos, posB);
-			return d1 > d2;
-		});
+		if (!oit) {
+			const glm::vec3 &camPos = camera.worldPosition();
+			core::sort(sorted.begin(), sorted.end(), [&camPos, &meshState](int a, int b) {
+				const glm::vec3 &posA = meshState->centerPos(a);
+				const glm::vec3 &posB = meshState->centerPos(b);
+				const float d1 = glm::distance2(camPos, posA);
+				const float d2 = glm::distance2(camPos, posB);
+				return d1 > d2;
+			});
+		}
+	}
+	if (sorted.empty()) {
+		return;
+	}
+
+	const bool accumulate = oit && prepareOIT(renderContext);
+	if (accumulate) {
+		// accumulate the weighted colors and the coverage - see oitOutput() in _sharedfrag.glsl
+		video::blendFuncSeparate(video::BlendMode::One, video::BlendMode::One, video::BlendMode::One,
+								 video::BlendMode::OneMinusSourceAlpha);
+		video::disable(video::State::DepthMask);
+		_voxelShaderFragData.oit = 1;
+		core_assert_always(_voxelData.update(_voxelShaderFragData));
 	}
 
 	video::ScopedState scopedBlendTrans(video::State::Blend, true);
 	for (int idx : sorted) {
 		const int bufferIndex = meshState->resolveIdx(idx);
-		const uint32_t indices = _state[bufferIndex].indices(voxel::MeshType_Transparency);
-		updatePalette(meshState, idx);
-		_voxelShaderVertData.viewprojection = camera.viewProjectionMatrix();
-		_voxelShaderVertData.model = meshState->model(idx);
-		_voxelShaderVertData.pivot = meshState->pivot(idx);
-		_voxelShaderVertData.gray = meshState->grayed(idx);
-		core_assert_always(_voxelData.update(_voxelShaderVertData));
+		const RenderState &state = *renderState(bufferIndex);
+		const uint32_t indices = state.indices(voxel::MeshType_Transparency);
+		_voxelShaderObjectData.palettelayer = updatePalette(meshState, idx);
+		_voxelShaderObjectData.model = meshState->model(idx);
+		_voxelShaderObjectData.pivot = meshState->pivot(idx) - glm::vec3(state._offset);
+		_voxelShaderObjectData.gray = meshState->grayed(idx);
+		// the transparent meshes are rendered back to front without oit - they are not instanced
+		_voxelShaderObjectData.instanced = 0;
+		if (!normals && _aoVolume->boolVal()) {
+			setAmbientOcclusionUniforms(meshState, bufferIndex, state);
+		}
 
 		video::ScopedPolygonMode polygonMode(mode);
 		video::ScopedFaceCull scopedFaceCull(meshState->cullFace(idx));
-		video::ScopedBuffer scopedBuf(_state[bufferIndex]._vertexBuffer[voxel::MeshType_Transparency]);
-		if (normals) {
-			core_assert_always(_voxelNormShader.setFrag(_voxelData.getFragUniformBuffer()));
-			core_assert_always(_voxelNormShader.setVert(_voxelData.getVertUniformBuffer()));
-			if (_shadowMap->boolVal()) {
-				_voxelNormShader.setShadowmap(video::TextureUnit::One);
-			}
-		} else {
-			core_assert_always(_voxelShader.setFrag(_voxelData.getFragUniformBuffer()));
-			core_assert_always(_voxelShader.setVert(_voxelData.getVertUniformBuffer()));
-			if (_shadowMap->boolVal()) {
-				_voxelShader.setShadowmap(video::TextureUnit::One);
+		video::ScopedBuffer scopedBuf(state._vertexBuffer[voxel::MeshType_Transparency]);
+		setVoxelShaderUniforms(normals);
+		video::drawElements(video::Primitive::Triangles, indices, state._indexSize[voxel::MeshType_Transparency]);
+	}
+
+	if (accumulate) {
+		_voxelShaderFragData.oit = 0;
+		core_assert_always(_voxelData.update(_voxelShaderFragData));
+		video::enable(video::State::DepthMask);
+		compositeOIT(renderContext);
+	}
+}
+
+RawVolumeRenderer::RayMarchState *RawVolumeRenderer::updateRayMarchState(const voxel::MeshStatePtr &meshState,
+																		 int idx) {
+	const voxel::RawVolume *volume = meshState->volume(idx);
+	if (volume == nullptr) {
+		return nullptr;
+	}
+	if (idx >= (int)_rayMarchStates.size()) {
+		_rayMarchStates.resize(idx + 1);
+	}
+	if (_rayMarchStates[idx] == nullptr) {
+		_rayMarchStates[idx] = new RayMarchState();
+	}
+	RayMarchState &state = *_rayMarchStates[idx];
+	BrickMap &brickMap = state._brickMap;
+	if (state._volume != volume || brickMap.region() != volume->region()) {
+		state._volume = volume;
+		if (!brickMap.init(volume->region())) {
+			return nullptr;
+		}
+		brickMap.update(*volume, volume->region());
+	}
+	if (!brickMap.dirty()) {
+		return &state;
+	}
+	core_trace_scoped(UploadBrickMap);
+	video::TextureConfig cfg;
+	cfg.type(video::TextureType::Texture3D);
+	cfg.filter(video::TextureFilter::Nearest);
+	cfg.wrap(video::TextureWrap::ClampToEdge);
+	cfg.alignment(1);
+	if (!state._bricks) {
+		cfg.format(video::TextureFormat::RGBA);
+		state._bricks = video::createTexture(cfg, 1, 1, "brickmap");
+	}
+	if (!state._atlas) {
+		cfg.format(video::TextureFormat::RG8);
+		state._atlas = video::createTexture(cfg, 1, 1, "brickatlas");
+	}
+	core::DynamicArray<uint8_t> texels;
+	const glm::ivec3 &bricks = brickMap.bricks();
+	if (state._bricksDim != bricks) {
+		state._bricks->upload(bricks.x, bricks.y, brickMap.indirection().data(), bricks.z);
+		state._bricksDim = bricks;
+	} else if (brickMap.dirtyBricks().isValid()) {
+		const voxel::Region &dirtyBricks = brickMap.dirtyBricks();
+		brickMap.copyIndirection(dirtyBricks, texels);
+		const glm::ivec3 &mins = dirtyBricks.getLowerCorner();
+		const glm::ivec3 &dim = dirtyBricks.getDimensionsInVoxels();
+		state._bricks->uploadRegion(mins.x, mins.y, mins.z, dim.x, dim.y, dim.z, texels.data());
+	}
+	const glm::ivec3 &atlasDim = brickMap.atlasDimension();
+	if (atlasDim.z > 0) {
+		if (state._atlasDim != atlasDim) {
+			// the atlas got a new layer of slots
+			state._atlas->upload(atlasDim.x, atlasDim.y, brickMap.atlas().data(), atlasDim.z);
+			state._atlasDim = atlasDim;
+		} else if (brickMap.dirtySlots().isValid()) {
+			const voxel::Region &dirtySlots = brickMap.dirtySlots();
+			brickMap.copyAtlas(dirtySlots, texels);
+			const glm::ivec3 mins = dirtySlots.getLowerCorner() * BrickMap::BrickSize;
+			const glm::ivec3 dim = dirtySlots.getDimensionsInVoxels() * BrickMap::BrickSize;
+			state._atlas->uploadRegion(mins.x, mins.y, mins.z, dim.x, dim.y, dim.z, texels.data());
+		}
+	}
+	brickMap.markClean();
+	return &state;
+}
+
+RawVolumeRenderer::AmbientOcclusionState *
+RawVolumeRenderer::updateAmbientOcclusionState(const voxel::MeshStatePtr &meshState, int idx) {
+	const voxel::RawVolume *volume = meshState->volume(idx);
+	if (volume == nullptr) {
+		return nullptr;
+	}
+	if (idx >= (int)_aoStates.size()) {
+		_aoStates.resize(idx + 1);
+	}
+	if (_aoStates[idx] == nullptr) {
+		_aoStates[idx] = new AmbientOcclusionState();
+	}
+	AmbientOcclusionState &state = *_aoStates[idx];
+	AmbientOcclusionVolume &aoVolume = state._aoVolume;
+	if (state._volume != volume || aoVolume.volumeRegion() != volume->region()) {
+		state._volume = volume;
+		if (!aoVolume.init(volume->region())) {
+			return nullptr;
+		}
+		aoVolume.update(*volume, volume->region());
+	}
+	if (!aoVolume.dirty()) {
+		return &state;
+	}
+	core_trace_scoped(UploadAmbientOcclusionVolume);
+	if (!state._texture) {
+		video::TextureConfig cfg;
+		cfg.type(video::TextureType::Texture3D);
+		// the occlusion is interpolated between the voxels
+		cfg.filter(video::TextureFilter::Linear);
+		cfg.wrap(video::TextureWrap::ClampToEdge);
+		cfg.alignment(1);
+		cfg.format(video::TextureFormat::R8);
+		state._texture = video::createTexture(cfg, 1, 1, "aovolume");
+	}
+	const glm::ivec3 &dim = aoVolume.region().getDimensionsInVoxels();
+	if (state._textureDim != dim) {
+		state._texture->upload(dim.x, dim.y, aoVolume.data().data(), dim.z);
+		state._textureDim = dim;
+	} else {
+		const voxel::Region &dirtyRegion = aoVolume.dirtyRegion();
+		core::DynamicArray<uint8_t> texels;
+		aoVolume.copyTexels(dirtyRegion, texels);
+		const glm::ivec3 offset = dirtyRegion.getLowerCorner() - aoVolume.region().getLowerCorner();
+		const glm::ivec3 &dirtyDim = dirtyRegion.getDimensionsInVoxels();
+		state._texture->uploadRegion(offset.x, offset.y, offset.z, dirtyDim.x, dirtyDim.y, dirtyDim.z, texels.data());
+	}
+	aoVolume.markClean();
+	return &state;
+}
+
+void RawVolumeRenderer::setAmbientOcclusionUniforms(const voxel::MeshStatePtr &meshState, int bufferIndex,
+													 const RenderState &state) {
+	const AmbientOcclusionState *aoState = updateAmbientOcclusionState(meshState, bufferIndex);
+	if (aoState == nullptr || !aoState->_texture) {
+		return;
+	}
+	const voxel::Region &region = aoState->_aoVolume.region();
+	// the vertex positions are relative to the offset of the meshes
+	_voxelShaderObjectData.aooffset = glm::vec4(state._offset - region.getLowerCorner(), 0.0f);
+	_voxelShaderObjectData.aoscale = glm::vec4(1.0f / glm::vec3(region.getDimensionsInVoxels()), 0.0f);
+	aoState->_texture->bind(video::TextureUnit::Two);
+	_voxelShader.setAovolume(video::TextureUnit::Two);
+}
+
+void RawVolumeRenderer::shutdownAmbientOcclusion() {
+	for (AmbientOcclusionState *state : _aoStates) {
+		delete state;
+	}
+	_aoStates.release();
+}
+
+void RawVolumeRenderer::renderRayMarch(const voxel::MeshStatePtr &meshState, RenderContext &renderContext,
+									   const video::Camera &camera) {
+	core_trace_scoped(RenderRayMarch);
+	video_pass_scoped(RenderRayMarch);
+	_rayMarchDraws.clear();
+	for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
+		if (meshState->hidden(idx)) {
+			continue;
+		}
+		const glm::ivec3 &mins = meshState->mins(idx);
+		const glm::ivec3 &maxs = meshState->maxs(idx);
+		const glm::vec3 size = maxs - mins;
+		if (size.x >= 1.0f && size.y >= 1.0f && size.z >= 1.0f && !camera.isVisible(mins, maxs)) {
+			continue;
+		}
+		const RayMarchState *state = updateRayMarchState(meshState, meshState->resolveIdx(idx));
+		if (state == nullptr || state->_brickMap.usedBricks() == 0) {
+			continue;
+		}
+		_rayMarchDraws.push_back(idx);
+	}
+	if (_rayMarchDraws.empty()) {
+		return;
+	}
+
+	video::ScopedState scopedDepth(video::State::DepthTest);
+	video::depthFunc(video::CompareFunc::LessEqual);
+	video::ScopedState scopedCullFace(video::State::CullFace);
+	video::ScopedState scopedScissor(video::State::Scissor, false);
+	video::ScopedState scopedBlend(video::State::Blend, false);
+	video::ScopedState scopedDepthMask(video::State::DepthMask);
+	const bool shadowMap = _shadowMap->boolVal() && prepareShadow(renderContext, camera);
+	if (shadowMap) {
+		// the ray marched volumes receive shadows but don't cast them
+		clearShadow(renderContext.shadow);
+	}
+	_voxelShaderFragData.oit = 0;
+	updateFragData(renderContext.shadow);
+	setViewProjection(camera);
+	updatePaletteAtlas(meshState);
+
+	{
+		video::ScopedShader scoped(_rayMarchShader);
+		if (shadowMap) {
+			core_assert_always(renderContext.shadow.bind(video::TextureUnit::One));
+			_rayMarchShader.setShadowmap(video::TextureUnit::One);
+		}
+		_rayMarchShader.setBricks(video::TextureUnit::Two);
+		_rayMarchShader.setAtlas(video::TextureUnit::Three);
+		video::ScopedPolygonMode polygonMode(video::PolygonMode::Solid);
+		video::ScopedBuffer scopedBuf(_rayMarchBuffer);
+		core_assert_always(_paletteAtlas.bind(video::TextureUnit::Four));
+		_rayMarchShader.setPalettes(video::TextureUnit::Four);
+		for (int idx : _rayMarchDraws) {
+			const int bufferIndex = meshState->resolveIdx(idx);
+			const RayMarchState &state = *_rayMarchStates[bufferIndex];
+			_rayMarchVolumeData.volumepalette = updatePalette(meshState, bufferIndex);
+			if (_dirtyVertData) {
+				core_assert_always(_voxelData.update(_voxelShaderVertData));
+				_dirtyVertData = false;
 			}
+			// the brick map starts at the lower corner of the volume region
+			const glm::vec3 offset = glm::vec3(state._brickMap.region().getLowerCorner()) - meshState->pivot(idx);
+			const glm::mat4 &model = glm::translate(meshState->model(idx), offset);
+			_rayMarchVolumeData.volumemodel = model;
+			_rayMarchVolumeData.volumeeye = glm::inverse(model) * glm::vec4(camera.worldPosition(), 1.0f);
+			_rayMarchVolumeData.volumegray = meshState->grayed(idx);
+			_rayMarchVolumeData.volumesize = state._brickMap.region().getDimensionsInVoxels();
+			core_assert_always(_rayMarchData.update(_rayMarchVolumeData));
+			core_assert_always(_rayMarchShader.setVert(_voxelData.getVertUniformBuffer()));
+			core_assert_always(_rayMarchShader.setFrag(_voxelData.getFragUniformBuffer()));
+			core_assert_always(_rayMarchShader.setVolume(_rayMarchData.getVolumeUniformBuffer()));
+			state._bricks->bind(video::TextureUnit::Two);
+			state._atlas->bind(video::TextureUnit::Three);
+			// the cube faces point inwards - the far side of the bounding box is rasterized
+			video::ScopedFaceCull scopedFaceCull(meshState->cullFace(idx));
+			video::drawArrays(video::Primitive::Triangles, _rayMarchBuffer.elements(_rayMarchBufferIndex, 3));
 		}
-		video::drawElements<voxel::IndexType>(video::Primitive::Triangles, indices);
 	}
+	core_trace_plot("RawVolumeRendererRayMarchDraws", (int64_t)_rayMarchDraws.size());
+
+	if (_bloom->boolVal()) {
+		video::FrameBuffer &frameBuffer = renderContext.frameBuffer;
+		const video::TexturePtr &color0 = frameBuffer.texture(video::FrameBufferAttachment::Color0);
+		const video::TexturePtr &color1 = frameBuffer.texture(video::FrameBufferAttachment::Color1);
+		renderContext.bloomRenderer.render(color0, color1);
+	}
+}
+
+void RawVolumeRenderer::shutdownRayMarch() {
+	_rayMarchShader.shutdown();
+	_rayMarchData.shutdown();
+	_rayMarchBuffer.shutdown();
+	_rayMarchBufferIndex = -1;
+	for (RayMarchState *state : _rayMarchStates) {
+		delete state;
+	}
+	_rayMarchStates.release();
+	_rayMarchDraws.release();
 }
 
 void RawVolumeRenderer::render(const voxel::MeshStatePtr &meshState, RenderContext &renderContext, const video::Camera &camera, bool shadow) {
 	core_trace_scoped(RawVolumeRendererRender);
+	if (_rayMarch) {
+		renderRayMarch(meshState, renderContext, camera);
+		return;
+	}
+	if (!_aoVolume->boolVal() && !_aoStates.empty()) {
+		shutdownAmbientOcclusion();
+	}
+	// the chunks on the screen are extracted first
+	meshState->setCamera(camera.worldPosition(), camera.viewMatrix(), camera.projectionMatrix());
 
+	updateCulling(meshState, camera);
 	bool visible = false;
-	for (int idx = 0; idx < voxel::MAX_VOLUMES; ++idx) {
-		updateCulling(meshState, idx, camera);
+	for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
 		if (!isVisible(meshState, idx)) {
 			continue;
 		}
+		updateLODs(meshState, idx, camera);
 		visible = true;
 	}
 	if (!visible) {
 		return;
 	}
-	for (const auto &i : meshState->meshes(voxel::MeshType_Transparency)) {
-		for (int idx = 0; idx < voxel::MAX_VOLUMES; ++idx) {
-			if (!isVisible(meshState, idx)) {
-				continue;
-			}
-			const int bufferIndex = meshState->resolveIdx(idx);
+	updateIndirectCommands(meshState);
+	updateOcclusion(meshState, renderContext, camera);
+	updatePaletteAtlas(meshState);
+	for (int idx = 0; idx < meshState->volumeSlots() && !useOIT(renderContext); ++idx) {
+		if (!isVisible(meshState, idx)) {
+			continue;
+		}
+		const int bufferIndex = meshState->resolveIdx(idx);
+		bool sorted = false;
+		for (const auto &i : meshState->meshes(voxel::MeshType_Transparency, bufferIndex)) {
 			// TODO: transform - vertices are in object space - eye in world space
 			// inverse of state._model - but take pivot into account
-			voxel::Mesh *mesh = i->second[bufferIndex];
+			voxel::Mesh *mesh = i->value;
 			if (!mesh || mesh->isEmpty()) {
 				continue;
 			}
 			if (mesh->sort(camera.worldPosition())) {
-				updateBufferForVolume(meshState, bufferIndex, voxel::MeshType_Transparency);
+				sorted = true;
 			}
 		}
+		// the buffer contains all the chunks of the volume - it's uploaded once for all the sorted chunks
+		if (sorted) {
+			updateBufferForVolume(meshState, bufferIndex, voxel::MeshType_Transparency);
+		}
 	}
 
 	video::ScopedState scopedDepth(video::State::DepthTest);
@@ -634,31 +1803,42 @@ void RawVolumeRenderer::render(const voxel::MeshStatePtr &meshState, RenderConte
 	video::ScopedState scopedScissor(video::State::Scissor, false);
 	video::ScopedState scopedBlend(video::State::Blend, false);
 	video::ScopedState scopedDepthMask(video::State::DepthMask);
-	if (_shadowMap->boolVal()) {
-		_shadow.update(camera, true);
+	const bool shadowMap = _shadowMap->boolVal() && prepareShadow(renderContext, camera);
+	if (shadowMap) {
 		if (shadow) {
+			// the cascades are cached - only the ones that moved or contain changed shadow casters are rendered
+			updateShadowCasters(meshState, renderContext);
 			video::ScopedShader scoped(_shadowMapShader);
-			_shadow.render(
+			renderContext.shadow.render(
 				[this, &meshState](int depthBufferIndex, const glm::mat4 &lightViewProjection) {
 					alignas(16) shader::ShadowmapData::BlockData var;
 					var.lightviewprojection = lightViewProjection;
+					math::Frustum frustum;
+					frustum.updatePlanes(lightViewProjection, glm::mat4(1.0f));
+					// the boxes of the camera culling are reused for the cascades
+					core::DynamicArray<uint32_t> cascadeVisible;
+					frustum.isVisible(_cullBoxes, cascadeVisible);
 
-					for (int idx = 0; idx < voxel::MAX_VOLUMES; ++idx) {
+					for (int idx = 0; idx < meshState->volumeSlots(); ++idx) {
 						if (!isVisible(meshState, idx)) {
 							continue;
 						}
+						const int box = _cullBoxIndices[idx];
+						if (box != -1 && !math::Frustum::isVisible(cascadeVisible, box)) {
+							continue;
+						}
 						const int bufferIndex = meshState->resolveIdx(idx);
+						const RenderState &state = *renderState(bufferIndex);
 						for (int i = 0; i < voxel::MeshType_Transparency; ++i) { // TODO: do we want this for the transparent voxels, too?
-							const uint32_t indices = _state[bufferIndex].indices((voxel::MeshType)i);
+							const uint32_t indices = state.indices((voxel::MeshType)i);
 							if (indices > 0u) {
-								video::ScopedBuffer scopedBuf(_state[bufferIndex]._vertexBuffer[i]);
+								video::ScopedBuffer scopedBuf(state._vertexBuffer[i]);
 								var.model = meshState->model(idx);
-								var.pivot = meshState->pivot(idx);
+								var.pivot = meshState->pivot(idx) - glm::vec3(state._offset);
 								_shadowMapUniformBlock.update(var);
 								_shadowMapShader.setBlock(_shadowMapUniformBlock.getBlockUniformBuffer());
 								video::ScopedFaceCull scopedFaceCull(meshState->cullFace(idx));
-								static_assert(sizeof(voxel::IndexType) == sizeof(uint32_t), "Index type doesn't match");
-								video::drawElements<voxel::IndexType>(video::Primitive::Triangles, indices);
+								drawOpaqueShadow(meshState, idx, bufferIndex, frustum);
 							}
 						}
 					}
@@ -666,20 +1846,10 @@ void RawVolumeRenderer::render(const voxel::MeshStatePtr &meshState, RenderConte
 				},
 				true);
 		} else {
-			_shadow.render([](int i, const glm::mat4 &lightViewProjection) {
-				video::clear(video::ClearFlag::Depth);
-				return true;
-			});
+			clearShadow(renderContext.shadow);
 		}
 	}
-
-	_voxelShaderFragData.depthsize = _shadow.dimension();
-	for (int i = 0; i < shader::VoxelShaderConstants::getMaxDepthBuffers(); ++i) {
-		_voxelShaderFragData.cascades[i] = _shadow.cascades()[i];
-		_voxelShaderFragData.distances[i] = _shadow.distances()[i];
-	}
-	_voxelShaderFragData.lightdir = _shadow.sunDirection();
-	core_assert_always(_voxelData.update(_voxelShaderFragData));
+	updateFragData(renderContext.shadow);
 
 	const voxel::SurfaceExtractionType meshMode = meshState->meshMode();
 	const bool normals = meshMode != voxel::SurfaceExtractionType::Cubic;
@@ -689,8 +1859,8 @@ void RawVolumeRenderer::render(const voxel::MeshStatePtr &meshState, RenderConte
 	} else {
 		_voxelShader.activate();
 	}
-	if (_shadowMap->boolVal()) {
-		core_assert_always(_shadow.bind(video::TextureUnit::One));
+	if (shadowMap) {
+		core_assert_always(renderContext.shadow.bind(video::TextureUnit::One));
 	}
 
 	const video::PolygonMode mode = camera.polygonMode();
@@ -702,10 +1872,20 @@ void RawVolumeRenderer::render(const voxel::MeshStatePtr &meshState, RenderConte
 		video::enable(video::State::PolygonOffsetFill);
 	}
 
-	_paletteHash = 0;
+	core_assert_always(_paletteAtlas.bind(video::TextureUnit::Four));
 
 	// --- opaque pass
-	renderOpaque(meshState, camera, normals);
+	renderOpaque(meshState, renderContext, camera, normals);
+
+	// the queries are tested against the depth of the opaque pass - the results are used in one of the next frames
+	if (_occlusionCulling->boolVal()) {
+		renderOcclusionQueries(meshState, renderContext, camera);
+		if (normals) {
+			_voxelNormShader.activate();
+		} else {
+			_voxelShader.activate();
+		}
+	}
 
 	// --- transparency pass
 	renderTransparency(meshState, renderContext, camera, normals);
@@ -729,24 +1909,37 @@ void RawVolumeRenderer::render(const voxel::MeshStatePtr &meshState, RenderConte
 		_voxelShader.deactivate();
 	}
 
+	if (_multiDrawIndirect) {
+		video::unbindBuffer(video::BufferType::IndirectBuffer);
+	}
 	renderNormals(meshState, renderContext, camera);
 	video::useProgram(oldShader);
 }
 
 void RawVolumeRenderer::setVolume(const voxel::MeshStatePtr &meshState, int idx, scenegraph::SceneGraphNode &node, bool deleteMesh) {
+	// the palettes are only read - don't detach them from the palettes that are shared with other nodes
+	const scenegraph::SceneGraphNode &constNode = node;
 	// ignore the return value because the volume is owned by the node
-	(void)setVolume(meshState, idx, node.volume(), &node.palette(), &node.normalPalette(), deleteMesh);
+	(void)setVolume(meshState, idx, node.volume(), &constNode.palette(), &constNode.normalPalette(), deleteMesh);
 }
 
-voxel::RawVolume *RawVolumeRenderer::setVolume(const voxel::MeshStatePtr &meshState, int idx, voxel::RawVolume *volume, palette::Palette *palette,
-											   palette::NormalPalette *normalPalette, bool meshDelete) {
+voxel::RawVolume *RawVolumeRenderer::setVolume(const voxel::MeshStatePtr &meshState, int idx, voxel::RawVolume *volume, const palette::Palette *palette,
+											   const palette::NormalPalette *normalPalette, bool meshDelete) {
 	bool meshDeleted = false;
 	if (!meshState->sameNormalPalette(idx, normalPalette)) {
-		if (idx >= 0 && idx < voxel::MAX_VOLUMES) {
-			_state[idx]._dirtyNormals = true;
+		if (RenderState *state = renderState(idx)) {
+			state->_dirtyNormals = true;
 		}
 	}
 	voxel::RawVolume *v = meshState->setVolume(idx, volume, palette, normalPalette, meshDelete, meshDeleted);
+	if (idx < (int)_rayMarchStates.size() && _rayMarchStates[idx] != nullptr) {
+		// the brick map is rebuilt for the new volume in the next frame
+		_rayMarchStates[idx]->_volume = nullptr;
+	}
+	if (idx < (int)_aoStates.size() && _aoStates[idx] != nullptr) {
+		// the occlusion is computed for the new volume in the next frame
+		_aoStates[idx]->_volume = nullptr;
+	}
 	if (meshDeleted) {
 		deleteMeshes(idx);
 	}
@@ -754,14 +1947,19 @@ voxel::RawVolume *RawVolumeRenderer::setVolume(const voxel::MeshStatePtr &meshSt
 }
 
 void RawVolumeRenderer::deleteMeshes(int idx) {
+	RenderState *state = renderState(idx);
+	if (state == nullptr) {
+		// nothing was uploaded for the volume
+		return;
+	}
 	for (int i = 0; i < voxel::MeshType_Max; ++i) {
 		deleteMesh(idx, (voxel::MeshType)i);
 	}
-	_state[idx]._dirtyNormals = true;
+	state->_dirtyNormals = true;
 }
 
 void RawVolumeRenderer::deleteMesh(int idx, voxel::MeshType meshType) {
-	RenderState &state = _state[idx];
+	RenderState &state = *_state[idx];
 	video::Buffer &vertexBuffer = state._vertexBuffer[meshType];
 	Log::debug("clear vertexbuffer: %i", idx);
 
@@ -773,6 +1971,10 @@ void RawVolumeRenderer::deleteMesh(int idx, voxel::MeshType meshType) {
 	}
 	vertexBuffer.update(state._indexBufferIndex[meshType], nullptr, 0);
 	core_assert(vertexBuffer.size(state._indexBufferIndex[meshType]) == 0);
+	if (meshType == voxel::MeshType_Opaque) {
+		state._opaqueIndices = 0u;
+		state._chunks.clear();
+	}
 
 	if (state._normalPreviewBufferIndex != -1) {
 		vertexBuffer.update(state._normalPreviewBufferIndex, nullptr, 0);
@@ -781,12 +1983,15 @@ void RawVolumeRenderer::deleteMesh(int idx, voxel::MeshType meshType) {
 }
 
 void RawVolumeRenderer::setSunPosition(const glm::vec3 &eye, const glm::vec3 &center, const glm::vec3 &up) {
-	_shadow.setPosition(eye, center, up);
+	_lightView = glm::lookAt(eye, center, up);
 }
 
 void RawVolumeRenderer::shutdownStateBuffers() {
-	for (int idx = 0; idx < voxel::MAX_VOLUMES; ++idx) {
-		RenderState &state = _state[idx];
+	for (RenderState *s : _state) {
+		if (s == nullptr) {
+			continue;
+		}
+		RenderState &state = *s;
 		for (int i = 0; i < voxel::MeshType_Max; ++i) {
 			state._vertexBuffer[i].shutdown();
 			state._vertexBufferIndex[i] = -1;
@@ -794,6 +1999,9 @@ void RawVolumeRenderer::shutdownStateBuffers() {
 			state._indexBufferIndex[i] = -1;
 		}
 		state._normalPreviewBufferIndex = -1;
+		state._opaqueIndices = 0u;
+		state._chunks.clear();
+		state._draws.clear();
 	}
 }
 
@@ -806,12 +2014,33 @@ void RawVolumeRenderer::shutdown() {
 	_voxelShader.shutdown();
 	_voxelNormShader.shutdown();
 	_shadowMapShader.shutdown();
+	_oitCompositeShader.shutdown();
+	_oitCompositeBuffer.shutdown();
+	_oitCompositeBufferIndex = -1;
 	_voxelData.shutdown();
 	_shadowMapUniformBlock.shutdown();
-	_shadow.shutdown();
 	shutdownStateBuffers();
 	_shapeRenderer.shutdown();
+	_occlusionBoxMesh = -1;
 	_shapeBuilder.shutdown();
+	_computeExtractor.shutdown();
+	shutdownRayMarch();
+	shutdownAmbientOcclusion();
+	_paletteAtlas.shutdown();
+	_pendingUploads.clear();
+	_indirectCommands.release();
+	_opaqueDraws.release();
+	_instanceModels.release();
+	_instanceCommands.release();
+	video::deleteBuffer(_indirectBuffer);
+	video::deleteBuffer(_instanceIndirectBuffer);
+	for (RenderState *state : _state) {
+		delete state;
+	}
+	_state.release();
+	core_free(_stagingBuffer);
+	_stagingBuffer = nullptr;
+	_stagingBufferSize = 0u;
 }
 
 } // namespace voxelrender
@@ -8,15 +8,25 @@
 #include "voxel/MeshState.h"
 #include "ShadowmapData.h"
 #include "ShadowmapShader.h"
+#include "OitcompositeShader.h"
+#include "RaymarchData.h"
+#include "RaymarchShader.h"
 #include "VoxelShader.h"
 #include "VoxelnormShader.h"
+#include "ComputeSurfaceExtractor.h"
 #include "core/NonCopyable.h"
 #include "core/Var.h"
 #include "core/collection/Array.h"
+#include "core/collection/DynamicArray.h"
+#include "math/Frustum.h"
 #include "render/BloomRenderer.h"
 #include "scenegraph/SceneGraphAnimation.h"
 #include "video/Buffer.h"
 #include "video/FrameBuffer.h"
+#include "video/Texture.h"
+#include "voxelrender/AmbientOcclusionVolume.h"
+#include "voxelrender/BrickMap.h"
+#include "voxelrender/PaletteAtlas.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Region.h"
 #include "voxelrender/Shadow.h"
@@ -43,8 +53,27 @@ enum class RenderMode {
 	Edit, Scene, Max
 };
 
+// the occlusion query of a volume - the result is read in one of the next frames to not wait for the gpu
+struct OcclusionQuery {
+	video::Id query = video::InvalidId;
+	// the query was issued but its result was not yet read
+	bool pending = false;
+	// no sample of the bounding box of the volume passed the depth test
+	bool occluded = false;
+};
+
+struct OcclusionStats {
+	// the amount of visible volumes in the view frustum
+	int tested = 0;
+	// the amount of them that were skipped because they are hidden behind other volumes
+	int occluded = 0;
+};
+
 struct RenderContext : public core::NonCopyable {
 	video::FrameBuffer frameBuffer;
+	// the accumulation targets of the order independent transparency - created on demand in the size of the
+	// framebuffer - see cfg::VoxelOrderIndependentTransparency
+	video::FrameBuffer oitFrameBuffer;
 	render::BloomRenderer bloomRenderer;
 	const scenegraph::SceneGraph *sceneGraph = nullptr;
 	scenegraph::FrameIndex frame = 0;
@@ -56,6 +85,21 @@ struct RenderContext : public core::NonCopyable {
 	// render the built-in normals
 	bool renderNormals = false;
 
+	// the occlusion queries of the volumes - they depend on the camera and are kept for each render context
+	core::DynamicArray<OcclusionQuery> occlusionQueries;
+	// the occlusion culling results of the last rendered frame - see cfg::VoxelOcclusionCulling
+	OcclusionStats occlusionStats;
+
+	// the shadow cascades depend on the camera - they are kept for each render context, so a view that doesn't move
+	// doesn't render its cascades again just because another view was rendered in between
+	Shadow shadow;
+	// the transforms and draws of the shadow casters the cascades were rendered with - see
+	// RawVolumeRenderer::updateShadowCasters()
+	uint32_t shadowCasterHash = 0u;
+	// the shadow invalidations of the renderer that were already applied to the cascades - see
+	// RawVolumeRenderer::applyShadowInvalidations()
+	uint64_t shadowInvalidation = 0u;
+
 	bool init(const glm::ivec2 &size);
 	void shutdown();
 	bool resize(const glm::ivec2 &size);
@@ -67,66 +111,374 @@ struct RenderContext : public core::NonCopyable {
  * @sa voxel::RawVolume
  */
 class RawVolumeRenderer : public core::NonCopyable {
+public:
+	/**
+	 * @brief A chunk is rendered in the lowest resolution whose voxels are not bigger than this (in pixels)
+	 */
+	static constexpr float LODMaxVoxelPixels = 1.0f;
+
 protected:
+	// a part of the opaque index buffer of a volume
+	struct IndexRange {
+		uint32_t offset = 0u;
+		uint32_t indices = 0u;
+	};
+	// the parts of the opaque index buffer with the meshes of a chunk - one for each level of detail
+	struct ChunkLODs {
+		glm::ivec3 mins{0};
+		IndexRange ranges[voxel::LODLevels];
+	};
 	struct RenderState : public core::NonCopyable {
 		bool _culled = false;
 		bool _empty = false; // this is only updated for non hidden nodes
 		bool _dirtyNormals = false;
+		// the meshes were extracted but not yet uploaded - see uploadPending()
+		bool _pendingUpload = false;
 		int32_t _vertexBufferIndex[voxel::MeshType_Max]{-1, -1};
 		int32_t _normalBufferIndex[voxel::MeshType_Max]{-1, -1};
 		int32_t _normalPreviewBufferIndex = -1;
 		int32_t _indexBufferIndex[voxel::MeshType_Max]{-1, -1};
+		// the per instance model matrices of the opaque mesh - see renderOpaque()
+		int32_t _instanceBufferIndex = -1;
+		// 2 or 4 bytes - depending on the amount of vertices
+		uint8_t _indexSize[voxel::MeshType_Max]{sizeof(voxel::IndexType), sizeof(voxel::IndexType)};
 		video::Buffer _vertexBuffer[voxel::MeshType_Max];
+		// the uploaded positions of the cubic meshes are relative to this offset
+		glm::ivec3 _offset{0};
+		// the vertices are uploaded as voxel::PackedVoxelVertex - see initVertexAttributes()
+		bool _packed[voxel::MeshType_Max]{false, false};
+		// the opaque indices of the full resolution meshes - the levels of detail are appended to them
+		uint32_t _opaqueIndices = 0u;
+		// empty if there are no levels of detail in the opaque buffer
+		core::DynamicArray<ChunkLODs> _chunks;
+		// the parts of the opaque buffer to render for the current camera - empty to render the full resolution
+		// see updateLODs()
+		core::DynamicArray<IndexRange> _draws;
+		// the picked level of detail for each of the chunks of the buffer state - see updateLODs()
+		core::DynamicArray<uint8_t> _chunkLODs;
+		// the commands of the draws in the indirect buffer - see updateIndirectCommands()
+		uint32_t _indirectOffset = 0u;
+		int _indirectDraws = 0;
 
 		uint32_t indices(voxel::MeshType type) const {
-			return _vertexBuffer[type].elements(_indexBufferIndex[type], 1, sizeof(voxel::IndexType));
+			if (_indexBufferIndex[type] == -1) {
+				return 0u;
+			}
+			return _vertexBuffer[type].elements(_indexBufferIndex[type], 1, _indexSize[type]);
 		}
 
 		bool hasData() const {
 			return indices(voxel::MeshType_Opaque) > 0 || indices(voxel::MeshType_Transparency) > 0;
 		}
 	};
-	core::Array<RenderState, voxel::MAX_VOLUMES> _state{};
+	// the states of the volumes - they are allocated once there is something to upload or render for the volume
+	core::DynamicArray<RenderState *> _state;
+	// the cubic meshes are uploaded as voxel::PackedVoxelVertex - unless the volume is too big for 16 bit positions
+	bool _packedVertices = false;
+	// the state buffers are created with a normal buffer - see initStateBuffers()
+	bool _normals = false;
 
-	uint64_t _paletteHash = 0;
+	/**
+	 * @return The state of the volume or @c nullptr if it wasn't allocated yet
+	 */
+	RenderState *renderState(int idx) const;
+	/**
+	 * @brief Allocates the state of the volume and its buffers if needed
+	 */
+	RenderState &createRenderState(int idx);
+
+	// the palettes of the volumes - the draws select their palette by the layer index
+	PaletteAtlas _paletteAtlas;
+	// the changed shadow casters - every render context applies the ones it didn't see yet to its own cascades. A
+	// context that fell behind by more than the ring can hold renders all its cascades again.
+	struct ShadowInvalidation {
+		glm::vec3 mins{0.0f};
+		glm::vec3 maxs{0.0f};
+		// the extent of the shadow caster is unknown
+		bool all = false;
+	};
+	static constexpr int MaxShadowInvalidations = 64;
+	core::Array<ShadowInvalidation, MaxShadowInvalidations> _shadowInvalidations;
+	uint64_t _shadowInvalidationCount = 0u;
+	// the parameters and the sun the shadows of the render contexts are set up with
+	ShadowParameters _shadowParameters;
+	glm::mat4 _lightView{1.0f};
 	uint32_t _normalsPaletteHash = 0;
 
 	shader::VoxelData _voxelData;
 
 	alignas(16) shader::VoxelData::FragData _voxelShaderFragData;
+	// the palette and the camera - only uploaded if they changed
 	alignas(16) shader::VoxelData::VertData _voxelShaderVertData;
+	bool _dirtyVertData = true;
+	// the amount of draws whose object data can be uploaded without reallocating the uniform buffer
+	static constexpr int ObjectDataSlots = 512;
+	alignas(16) shader::VoxelData::ObjectData _voxelShaderObjectData;
 
 	shader::VoxelShader &_voxelShader;
 	shader::VoxelnormShader &_voxelNormShader;
 	shader::ShadowmapData _shadowMapUniformBlock;
 	shader::ShadowmapShader &_shadowMapShader;
-	voxelrender::Shadow _shadow;
+	shader::OitcompositeShader &_oitCompositeShader;
 
 	render::ShapeRenderer _shapeRenderer;
 	video::ShapeBuilder _shapeBuilder;
 
+	ComputeSurfaceExtractor _computeExtractor;
+
 	core::VarPtr _shadowMap;
 	core::VarPtr _bloom;
+	core::VarPtr _computeExtraction;
+	core::VarPtr _uploadBudget;
+	core::VarPtr _occlusionCulling;
+	// a unit cube to render the bounding boxes of the volumes for the occlusion queries
+	int32_t _occlusionBoxMesh = -1;
+	core::VarPtr _oit;
+	// the fullscreen quad to composite the order independent transparency onto the scene
+	video::Buffer _oitCompositeBuffer;
+	int32_t _oitCompositeBufferIndex = -1;
+
+	// the brick map of a volume and its textures - see cfg::VoxelRayMarch
+	struct RayMarchState : public core::NonCopyable {
+		BrickMap _brickMap;
+		// the volume the brick map was built for - it's rebuilt if the volume was exchanged
+		const voxel::RawVolume *_volume = nullptr;
+		// rgba8 - the indirection grid with one texel for each brick
+		video::TexturePtr _bricks;
+		// rg8 - the voxels of the non empty bricks
+		video::TexturePtr _atlas;
+		// the sizes the texture storages were allocated with - only the changed texels are uploaded if they match
+		glm::ivec3 _bricksDim{0};
+		glm::ivec3 _atlasDim{0};
+	};
+	// the bounds of the volumes that are culled in the current frame - tested in one batch against the camera and
+	// the shadow cascades
+	math::FrustumBoxes _cullBoxes;
+	// the box index in _cullBoxes for each volume slot or -1 if the volume isn't culled
+	core::DynamicArray<int> _cullBoxIndices;
+	core::DynamicArray<uint32_t> _cullVisible;
 
-	void updatePalette(const voxel::MeshStatePtr &meshState, int idx);
+	// the volumes are ray marched in the shader instead of extracting and uploading meshes
+	bool _rayMarch = false;
+	core::DynamicArray<RayMarchState *> _rayMarchStates;
+	// the volumes to ray march in the current frame
+	core::DynamicArray<int> _rayMarchDraws;
+	shader::RaymarchShader &_rayMarchShader;
+	shader::RaymarchData _rayMarchData;
+	alignas(16) shader::RaymarchData::VolumeData _rayMarchVolumeData;
+	// the bounding box that is rasterized to start the rays
+	video::Buffer _rayMarchBuffer;
+	int32_t _rayMarchBufferIndex = -1;
+	/**
+	 * @brief Updates the brick map of the volume and uploads its textures if they changed
+	 * @return The state of the volume or @c nullptr if there is no volume at the given index
+	 */
+	RayMarchState *updateRayMarchState(const voxel::MeshStatePtr &meshState, int idx);
+	/**
+	 * @brief Renders the brick maps of the visible volumes with the ray marching shader
+	 * @sa cfg::VoxelRayMarch
+	 */
+	void renderRayMarch(const voxel::MeshStatePtr &meshState, RenderContext &renderContext,
+						const video::Camera &camera);
+	void shutdownRayMarch();
+
+	// the ambient occlusion of a volume and its texture - see cfg::VoxelAOVolume
+	struct AmbientOcclusionState : public core::NonCopyable {
+		AmbientOcclusionVolume _aoVolume;
+		// the volume the occlusion was computed for - it's computed again if the volume was exchanged
+		const voxel::RawVolume *_volume = nullptr;
+		// r8 - the occlusion of the voxels
+		video::TexturePtr _texture;
+		// the size the texture storage was allocated with - only the changed texels are uploaded if it matches
+		glm::ivec3 _textureDim{0};
+	};
+	core::VarPtr _aoVolume;
+	core::DynamicArray<AmbientOcclusionState *> _aoStates;
+	/**
+	 * @brief Updates the ambient occlusion of the volume and uploads its texture if it changed
+	 * @return The state of the volume or @c nullptr if there is no volume at the given index
+	 */
+	AmbientOcclusionState *updateAmbientOcclusionState(const voxel::MeshStatePtr &meshState, int idx);
+	/**
+	 * @brief Binds the ambient occlusion texture of the volume and sets the uniforms to sample it
+	 * @note Only for the cubic meshes - the uniforms must be updated afterwards
+	 */
+	void setAmbientOcclusionUniforms(const voxel::MeshStatePtr &meshState, int bufferIndex, const RenderState &state);
+	void shutdownAmbientOcclusion();
+
+	// the draws of the opaque meshes of all the visible volumes in the current frame
+	core::DynamicArray<video::DrawElementsIndirectCommand> _indirectCommands;
+	video::Id _indirectBuffer = video::InvalidId;
+	bool _multiDrawIndirect = false;
+	/**
+	 * @brief Uploads the draws of the opaque meshes into the indirect buffer - a volume whose chunks are rendered in
+	 * different levels of detail is then drawn with one call instead of one call per part of its index buffer
+	 * @note Only used if @c video::Feature::MultiDrawIndirect is supported
+	 */
+	void updateIndirectCommands(const voxel::MeshStatePtr &meshState);
+
+	// the references of a volume are drawn instanced with the buffers of the referenced volume
+	bool _instancing = false;
+	// the opaque draws of the current frame - sorted by the volume whose buffers are used
+	core::DynamicArray<int> _opaqueDraws;
+	core::DynamicArray<glm::mat4> _instanceModels;
+	// with multi draw indirect the instances are drawn in their own levels of detail - one command per range and
+	// instance, the base instance selects the model matrix
+	core::DynamicArray<video::DrawElementsIndirectCommand> _instanceCommands;
+	video::Id _instanceIndirectBuffer = video::InvalidId;
+	/**
+	 * @return @c true if the volumes can be rendered with the same instanced draw call
+	 * @note Without @c video::Feature::MultiDrawIndirect the volumes must use the same levels of detail
+	 */
+	bool canInstance(const voxel::MeshStatePtr &meshState, int idx, int otherIdx) const;
+	/**
+	 * @brief Adds the commands to draw the levels of detail of the given volume with the model matrix at
+	 * @c baseInstance of the instance buffer
+	 */
+	void addInstanceCommands(int idx, int bufferIndex, uint32_t baseInstance);
+
+	// the volumes whose meshes are not yet uploaded - in the order of their extraction
+	core::DynamicArray<int> _pendingUploads;
+	// the vertices, normals and indices are assembled here before they are uploaded. The buffer is kept to not
+	// allocate memory for every upload.
+	uint8_t *_stagingBuffer = nullptr;
+	size_t _stagingBufferSize = 0u;
+	uint8_t *stagingBuffer(size_t size);
+	/**
+	 * @brief Uploads the meshes of the pending volumes until the upload budget of the frame is spent
+	 * @sa cfg::VoxelUploadBudget
+	 */
+	void uploadPending(const voxel::MeshStatePtr &meshState, bool uploadAll);
+
+	/**
+	 * @brief Adds the palettes of the visible volumes to the palette atlas and uploads it once for the frame
+	 */
+	void updatePaletteAtlas(const voxel::MeshStatePtr &meshState);
+	/**
+	 * @brief Updates the normals of the volume if they changed
+	 * @return The layer of the palette of the volume in the palette atlas
+	 */
+	int updatePalette(const voxel::MeshStatePtr &meshState, int idx);
 	bool updateBufferForVolume(const voxel::MeshStatePtr &meshState, int idx, voxel::MeshType type);
 	void deleteMesh(int idx, voxel::MeshType meshType);
 	void deleteMeshes(int idx);
-	void updateCulling(const voxel::MeshStatePtr &meshState, int idx, const video::Camera &camera);
+	/**
+	 * @brief Culls the volumes against the camera frustum - the bounds of all volumes are tested in one batch
+	 */
+	void updateCulling(const voxel::MeshStatePtr &meshState, const video::Camera &camera);
+	/**
+	 * @brief Pick the level of detail for each chunk of the volume by its size on the screen
+	 */
+	void updateLODs(const voxel::MeshStatePtr &meshState, int idx, const video::Camera &camera);
+	/**
+	 * @brief Draw the opaque meshes of the volume in the levels of detail that were picked by @c updateLODs()
+	 * @note The vertex buffer must be bound
+	 * @sa updateIndirectCommands()
+	 */
+	void drawOpaque(int idx, int bufferIndex) const;
+	/**
+	 * @brief Draws the opaque mesh of the given buffer once for each of the uploaded instance model matrices
+	 * @note If instance commands were collected, all the instances are drawn with one indirect multi draw
+	 * @sa canInstance(), addInstanceCommands()
+	 */
+	void drawOpaqueInstanced(int idx, int bufferIndex, int instances) const;
+	/**
+	 * @brief Draws the chunks of the opaque mesh that are inside the given shadow cascade
+	 * @note The vertex buffer must be bound
+	 */
+	void drawOpaqueShadow(const voxel::MeshStatePtr &meshState, int idx, int bufferIndex,
+						  const math::Frustum &frustum) const;
+	/**
+	 * @brief Marks all cascades as dirty if the transforms, the bounds or the levels of detail of the shadow casters
+	 * changed
+	 */
+	void updateShadowCasters(const voxel::MeshStatePtr &meshState, RenderContext &renderContext);
+	/**
+	 * @brief Marks the cascades of all render contexts as dirty that contain a volume that uses the given buffer
+	 */
+	void markShadowDirty(const voxel::MeshStatePtr &meshState, int bufferIndex);
+	void addShadowInvalidation(const glm::vec3 &mins, const glm::vec3 &maxs, bool all);
+	/**
+	 * @brief Marks the cascades of the render context as dirty for the shadow casters that changed since it was
+	 * rendered the last time
+	 */
+	void applyShadowInvalidations(RenderContext &renderContext);
+	/**
+	 * @brief Initializes the shadow of the render context on first use and updates its cascades for the camera
+	 * @return @c false if the shadow couldn't get initialized - the volumes are rendered without shadows then
+	 */
+	bool prepareShadow(RenderContext &renderContext, const video::Camera &camera);
+	void setViewProjection(const video::Camera &camera);
+	/**
+	 * @brief Uploads the light direction and the shadow cascades for the fragment shaders
+	 */
+	void updateFragData(const Shadow &shadow);
+	/**
+	 * @brief Clears the cascades of the shadow map - nothing casts a shadow then
+	 */
+	void clearShadow(Shadow &shadow);
+	void setVoxelShaderUniforms(bool normals);
 
 	bool initStateBuffers(bool normals);
+	bool initStateBuffers(RenderState &state);
+	/**
+	 * @brief Sets up the vertex layout of the buffer for the given mesh type
+	 * @param packed Use voxel::PackedVoxelVertex instead of voxel::VoxelVertex
+	 */
+	void initVertexAttributes(RenderState &state, voxel::MeshType type, bool packed);
 	void shutdownStateBuffers();
 	bool resetStateBuffers(bool normals);
 	/**
 	 * @brief Updates the vertex buffers manually
 	 */
 	bool updateBufferForVolume(const voxel::MeshStatePtr &meshState, int idx);
-	void renderOpaque(const voxel::MeshStatePtr &meshState, const video::Camera &camera, bool normals);
+	/**
+	 * @brief Reads the available results of the occlusion queries of the last frames
+	 * @sa cfg::VoxelOcclusionCulling
+	 */
+	void updateOcclusion(const voxel::MeshStatePtr &meshState, RenderContext &renderContext,
+						 const video::Camera &camera);
+	/**
+	 * @brief Issues the occlusion queries for the bounding boxes of the visible volumes against the depth of the
+	 * opaque pass
+	 */
+	void renderOcclusionQueries(const voxel::MeshStatePtr &meshState, RenderContext &renderContext,
+								const video::Camera &camera);
+	/**
+	 * @param[out] model The transform of a unit cube to the bounding box of the volume
+	 * @return @c false if the camera is inside of the bounding box - the volume can't be occluded then
+	 */
+	bool occlusionBox(const voxel::MeshStatePtr &meshState, int idx, const video::Camera &camera,
+					  glm::mat4 &model) const;
+	bool isOccluded(const RenderContext &renderContext, int idx) const;
+	void renderOpaque(const voxel::MeshStatePtr &meshState, const RenderContext &renderContext,
+					  const video::Camera &camera, bool normals);
+	/**
+	 * @return @c true if the transparent meshes are rendered with weighted blended order independent transparency
+	 * - they don't have to be sorted then
+	 * @note The caller must have bound the framebuffer of the render context
+	 */
+	bool useOIT(const RenderContext &renderContext) const;
+	bool prepareOIT(RenderContext &renderContext);
+	void compositeOIT(RenderContext &renderContext);
 	void renderTransparency(const voxel::MeshStatePtr &meshState, RenderContext &renderContext, const video::Camera &camera, bool normals);
 	void renderNormals(const voxel::MeshStatePtr &meshState, const RenderContext &renderContext, const video::Camera &camera);
 public:
 	RawVolumeRenderer();
 
+	/**
+	 * @param[in] voxelPixels The size of a full resolution voxel on the screen in pixels
+	 * @return The level of detail to render a chunk in
+	 * @sa LODMaxVoxelPixels
+	 */
+	static int lodLevel(float voxelPixels);
+	/**
+	 * @brief Downsamples the chunks for the level of detail meshes of the @c voxel::MeshState
+	 * @sa voxel::MeshState::setDownsampler()
+	 */
+	static void downsample(const voxel::RawVolume &source, const palette::Palette &palette,
+						   const voxel::Region &sourceRegion, voxel::RawVolume &dest);
+
 	void render(const voxel::MeshStatePtr &meshState, RenderContext &renderContext, const video::Camera &camera, bool shadow);
 	void clear(const voxel::MeshStatePtr &meshState);
 	/**
@@ -144,7 +496,7 @@ public:
 	 * @return The old volume that was managed by the class, @c nullptr if there was none
 	 */
 	[[nodiscard]] voxel::RawVolume *setVolume(const voxel::MeshStatePtr &meshState, int idx, voxel::RawVolume *volume,
-											  palette::Palette *palette, palette::NormalPalette *normalPalette,
+											  const palette::Palette *palette, const palette::NormalPalette *normalPalette,
 											  bool meshDelete);
 	void setVolume(const voxel::MeshStatePtr &meshState, int idx, scenegraph::SceneGraphNode &node, bool deleteMesh);
 
@@ -164,7 +516,23 @@ public:
 	 */
 	bool init(bool normals);
 
-	void update(const voxel::MeshStatePtr &meshState);
+	/**
+	 * @brief Transfers the extracted meshes and uploads them
+	 * @param uploadAll Ignore the upload budget and upload all the extracted meshes in this frame
+	 * @sa cfg::VoxelUploadBudget
+	 */
+	void update(const voxel::MeshStatePtr &meshState, bool uploadAll = false);
+	/**
+	 * @return The amount of volumes whose extracted meshes are not yet uploaded
+	 */
+	int pendingUploads() const;
+	/**
+	 * @brief Extracts all pending regions and waits for them - the cubic meshes are extracted with a compute shader
+	 * if this is supported and enabled
+	 * @sa cfg::VoxelComputeExtraction
+	 * @note Call @c update() afterwards to upload the meshes
+	 */
+	void extractAllPending(const voxel::MeshStatePtr &meshState);
 
 	/**
 	 * @sa init()
@@ -172,4 +540,15 @@ public:
 	void shutdown();
 };
 
+inline int RawVolumeRenderer::pendingUploads() const {
+	return (int)_pendingUploads.size();
+}
+
+inline RawVolumeRenderer::RenderState *RawVolumeRenderer::renderState(int idx) const {
+	if (idx < 0 || idx >= (int)_state.size()) {
+		return nullptr;
+	}
+	return _state[idx];
+}
+
 } // namespace voxelrender
@@ -153,7 +153,7 @@ bool SceneGraphRenderer::isSliceModeActive() const {
 
 void SceneGraphRenderer::nodeRemove(const voxel::MeshStatePtr &meshState, int nodeId) {
 	const int idx = getVolumeIdx(nodeId);
-	if (idx < 0 || idx >= voxel::MAX_VOLUMES) {
+	if (idx < 0) {
 		return;
 	}
 	// ignore the return value because the volume is owned by the node
@@ -162,13 +162,27 @@ void SceneGraphRenderer::nodeRemove(const voxel::MeshStatePtr &meshState, int no
 
 bool SceneGraphRenderer::isVisible(const voxel::MeshStatePtr &meshState, int nodeId, bool hideEmpty) const {
 	const int idx = getVolumeIdx(nodeId);
-	if (idx < 0 || idx >= voxel::MAX_VOLUMES) {
+	if (idx < 0) {
 		return false;
 	}
 	return _volumeRenderer.isVisible(meshState, idx, hideEmpty);
 }
 
-void SceneGraphRenderer::prepare(const voxel::MeshStatePtr &meshState, const RenderContext &renderContext) {
+bool SceneGraphRenderer::isInView(const RenderContext &renderContext, const video::Camera &camera,
+								  const scenegraph::SceneGraphNode &node, const voxel::Region &region) const {
+	if (renderContext.renderMode != RenderMode::Scene) {
+		return camera.isVisible(region.getLowerCornerf(), region.getUpperCornerf());
+	}
+	const scenegraph::FrameTransform &transform = renderContext.sceneGraph->transformForFrame(node, renderContext.frame);
+	const glm::mat4 &worldMatrix = transform.worldMatrix();
+	const glm::vec3 pivot = transform.scale() * node.pivot() * glm::vec3(region.getDimensionsInVoxels());
+	const glm::vec3 corner1 = worldMatrix * glm::vec4(region.getLowerCornerf() - pivot, 1.0f);
+	const glm::vec3 corner2 = worldMatrix * glm::vec4(region.getUpperCornerf() - pivot, 1.0f);
+	return camera.isVisible(glm::min(corner1, corner2), glm::max(corner1, corner2));
+}
+
+void SceneGraphRenderer::prepare(const voxel::MeshStatePtr &meshState, const RenderContext &renderContext,
+								 const video::Camera &camera) {
 	core_trace_scoped(Prepare);
 	core_assert_always(renderContext.sceneGraph != nullptr);
 	const scenegraph::SceneGraph &sceneGraph = *renderContext.sceneGraph;
@@ -176,7 +190,7 @@ void SceneGraphRenderer::prepare(const voxel::MeshStatePtr &meshState, const Ren
 	const bool hideInactive = renderContext.hideInactive;
 	const bool grayInactive = renderContext.grayInactive;
 	// remove those volumes that are no longer part of the scene graph
-	for (int i = 0; i < voxel::MAX_VOLUMES; ++i) {
+	for (int i = 0; i < meshState->volumeSlots(); ++i) {
 		const int nodeId = getNodeId(i);
 		if (!sceneGraph.hasNode(nodeId)) {
 			// ignore the return value because the volume is owned by the node
@@ -207,15 +221,28 @@ void SceneGraphRenderer::prepare(const voxel::MeshStatePtr &meshState, const Ren
 		}
 
 		const int idx = getVolumeIdx(node);
-		if (idx >= voxel::MAX_VOLUMES) {
+		if (idx < 0) {
 			continue;
 		}
 		const voxel::RawVolume *v = meshState->volume(idx);
-		const voxel::RawVolume *nodeVolume = sceneGraph.resolveVolume(node);
+		const scenegraph::SceneGraphNode &modelNode = node.isReferenceNode() ? sceneGraph.node(node.reference()) : node;
+		// the palettes are only read - don't detach them from the palettes that are shared with other nodes
+		const scenegraph::SceneGraphNode &constNode = node;
+		// don't inflate compressed volumes here - the meshes are still valid
+		bool compressed = modelNode.isVolumeCompressed() && node.id() != activeNodeId;
+		if (compressed && !modelNode.isVolumeLoaded() && node.visible()) {
+			// there are no meshes for volumes that were never loaded - only decode those that are in view
+			compressed = !isInView(renderContext, camera, node, modelNode.region());
+		}
+		const voxel::RawVolume *nodeVolume = compressed ? nullptr : sceneGraph.resolveVolume(node);
 
 		bool sliceView = false;
 		voxel::Region region;
-		if (node.id() == activeNodeId) {
+		if (compressed) {
+			// the old volume pointer is no longer valid - but keep the meshes
+			(void)_volumeRenderer.setVolume(meshState, idx, nullptr, &constNode.palette(), &constNode.normalPalette(), false);
+			region = modelNode.region();
+		} else if (node.id() == activeNodeId) {
 			if (_sliceRegion.isValid()) {
 				sliceView = true;
 				// check several things to re-create the slice volume
@@ -228,7 +255,7 @@ void SceneGraphRenderer::prepare(const voxel::MeshStatePtr &meshState, const Ren
 				}
 				// either node or slice volume (nodes get their volume managed - and here we have a smart pointer)
 				// if the old volume was not the slice volume, the return value is not null
-				const voxel::RawVolume *oldV = _volumeRenderer.setVolume(meshState, idx, _sliceVolume.get(), &node.palette(), &node.normalPalette(), !_sliceVolumeDirty);
+				const voxel::RawVolume *oldV = _volumeRenderer.setVolume(meshState, idx, _sliceVolume.get(), &constNode.palette(), &constNode.normalPalette(), !_sliceVolumeDirty);
 				if (_sliceVolumeDirty || oldV != nullptr) {
 					_volumeRenderer.scheduleRegionExtraction(meshState, idx, _sliceVolume->region());
 				}
@@ -243,7 +270,7 @@ void SceneGraphRenderer::prepare(const voxel::MeshStatePtr &meshState, const Ren
 			}
 		}
 
-		if (!sliceView) {
+		if (!sliceView && !compressed) {
 			_volumeRenderer.setVolume(meshState, idx, node, true);
 			region = node.region();
 			if (v != nodeVolume) {
@@ -300,7 +327,7 @@ void SceneGraphRenderer::prepare(const voxel::MeshStatePtr &meshState, const Ren
 				continue;
 			}
 			const int idx = getVolumeIdx(node);
-			if (idx >= voxel::MAX_VOLUMES) {
+			if (idx < 0) {
 				continue;
 			}
 			const int referencedIdx = getVolumeIdx(node.reference());
@@ -340,10 +367,10 @@ void SceneGraphRenderer::prepare(const voxel::MeshStatePtr &meshState, const Ren
 void SceneGraphRenderer::render(const voxel::MeshStatePtr &meshState, RenderContext &renderContext, const video::Camera &camera, bool shadow,
 								bool waitPending) {
 	core_trace_scoped(SceneGraphRenderer);
-	prepare(meshState, renderContext);
+	prepare(meshState, renderContext, camera);
 	if (waitPending) {
-		meshState->extractAllPending();
-		_volumeRenderer.update(meshState);
+		_volumeRenderer.extractAllPending(meshState);
+		_volumeRenderer.update(meshState, true);
 	}
 
 	_volumeRenderer.render(meshState, renderContext, camera, shadow);
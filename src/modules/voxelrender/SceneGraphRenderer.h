@@ -42,7 +42,12 @@ protected:
 	RawVolumeRenderer _volumeRenderer;
 	render::CameraFrustum _cameraRenderer;
 	core::DynamicArray<video::Camera> _cameras;
-	void prepare(const voxel::MeshStatePtr &meshState, const RenderContext &renderContext);
+	void prepare(const voxel::MeshStatePtr &meshState, const RenderContext &renderContext, const video::Camera &camera);
+	/**
+	 * @brief Checks whether the bounds of the given node are inside the view of the camera
+	 */
+	bool isInView(const RenderContext &renderContext, const video::Camera &camera, const scenegraph::SceneGraphNode &node,
+				  const voxel::Region &region) const;
 
 	core::SharedPtr<voxel::RawVolume> _sliceVolume;
 	voxel::Region _sliceRegion = voxel::Region::InvalidRegion;
@@ -80,6 +85,10 @@ public:
 	const voxel::Region &sliceRegion() const;
 	void setSliceRegion(const voxel::Region &region);
 	bool isSliceModeActive() const;
+	/**
+	 * @return the amount of extracted meshes that are not yet uploaded to the gpu
+	 */
+	int pendingUploads() const;
 
 	static inline int getVolumeIdx(int nodeId) {
 		// TODO: using the node id here is not good as they are increasing when you modify the scene graph
@@ -96,4 +105,8 @@ public:
 	}
 };
 
+inline int SceneGraphRenderer::pendingUploads() const {
+	return _volumeRenderer.pendingUploads();
+}
+
 } // namespace voxelrender
@@ -7,17 +7,19 @@
 #include "video/Types.h"
 #include "video/Renderer.h"
 #include "voxel/VoxelVertex.h"
+#include <glm/mat4x4.hpp>
 
 namespace voxelrender {
 
+template<class VERTEX = voxel::VoxelVertex>
 inline video::Attribute getPositionVertexAttribute(uint32_t bufferIndex, uint32_t attributeLocation, int components) {
 	video::Attribute attrib;
 	attrib.bufferIndex = (int32_t)bufferIndex;
 	attrib.location = (int32_t)attributeLocation;
-	attrib.stride = sizeof(voxel::VoxelVertex);
+	attrib.stride = sizeof(VERTEX);
 	attrib.size = components;
-	attrib.type = video::mapType<decltype(voxel::VoxelVertex::position)::value_type>();
-	attrib.offset = offsetof(voxel::VoxelVertex, position);
+	attrib.type = video::mapType<typename decltype(VERTEX::position)::value_type>();
+	attrib.offset = offsetof(VERTEX, position);
 	return attrib;
 }
 
@@ -32,39 +34,55 @@ inline video::Attribute getNormalVertexAttribute(uint32_t bufferIndex, uint32_t
 	return attrib;
 }
 
+/**
+ * @brief A mat4 attribute occupies four locations - one for each column
+ */
+inline video::Attribute getInstanceVertexAttribute(uint32_t bufferIndex, uint32_t attributeLocation, int column) {
+	video::Attribute attrib;
+	attrib.bufferIndex = (int32_t)bufferIndex;
+	attrib.location = (int32_t)attributeLocation + column;
+	attrib.stride = sizeof(glm::mat4);
+	attrib.size = 4;
+	attrib.type = video::mapType<glm::mat4::value_type>();
+	attrib.offset = sizeof(glm::vec4) * column;
+	attrib.divisor = 1;
+	return attrib;
+}
+
 /**
  * @note we are uploading multiple bytes at once here
  */
+template<class VERTEX = voxel::VoxelVertex>
 inline video::Attribute getInfoVertexAttribute(uint32_t bufferIndex, uint32_t attributeLocation, int components) {
-	static_assert(sizeof(voxel::VoxelVertex::colorIndex) == sizeof(uint8_t), "Voxel color size doesn't match");
-	static_assert(sizeof(voxel::VoxelVertex::info) == sizeof(uint8_t), "AO type size doesn't match");
-	static_assert(offsetof(voxel::VoxelVertex, info) < offsetof(voxel::VoxelVertex, colorIndex), "Layout change of VoxelVertex without change in upload");
+	static_assert(sizeof(VERTEX::colorIndex) == sizeof(uint8_t), "Voxel color size doesn't match");
+	static_assert(sizeof(VERTEX::info) == sizeof(uint8_t), "AO type size doesn't match");
+	static_assert(offsetof(VERTEX, info) < offsetof(VERTEX, colorIndex), "Layout change of the vertex without change in upload");
 	video::Attribute attrib;
 	attrib.bufferIndex = (int32_t)bufferIndex;
 	attrib.location = (int32_t)attributeLocation;
-	attrib.stride = sizeof(voxel::VoxelVertex);
+	attrib.stride = sizeof(VERTEX);
 	attrib.size = components;
-	attrib.type = video::mapType<decltype(voxel::VoxelVertex::info)>();
+	attrib.type = video::mapType<decltype(VERTEX::info)>();
 	attrib.typeIsInt = true;
-	attrib.offset = offsetof(voxel::VoxelVertex, info);
+	attrib.offset = offsetof(VERTEX, info);
 	return attrib;
 }
 
 /**
  * @note we are uploading multiple bytes at once here
  */
+template<class VERTEX = voxel::VoxelVertex>
 inline video::Attribute getInfo2VertexAttribute(uint32_t bufferIndex, uint32_t attributeLocation, int components) {
-	static_assert(sizeof(voxel::VoxelVertex::padding2) == sizeof(uint8_t), "Unused padding size doesn't match");
-	static_assert(sizeof(voxel::VoxelVertex::normalIndex) == sizeof(uint8_t), "Voxel normal size doesn't match");
-	static_assert(offsetof(voxel::VoxelVertex, normalIndex) < offsetof(voxel::VoxelVertex, padding2), "Layout change of VoxelVertex without change in upload");
+	static_assert(sizeof(VERTEX::normalIndex) == sizeof(uint8_t), "Voxel normal size doesn't match");
+	static_assert(offsetof(VERTEX, normalIndex) + 1 < sizeof(VERTEX), "Layout change of the vertex without change in upload");
 	video::Attribute attrib;
 	attrib.bufferIndex = (int32_t)bufferIndex;
 	attrib.location = (int32_t)attributeLocation;
-	attrib.stride = sizeof(voxel::VoxelVertex);
+	attrib.stride = sizeof(VERTEX);
 	attrib.size = components;
-	attrib.type = video::mapType<decltype(voxel::VoxelVertex::normalIndex)>();
+	attrib.type = video::mapType<decltype(VERTEX::normalIndex)>();
 	attrib.typeIsInt = true;
-	attrib.offset = offsetof(voxel::VoxelVertex, normalIndex);
+	attrib.offset = offsetof(VERTEX, normalIndex);
 	return attrib;
 }
 
@@ -5,11 +5,13 @@
 #include "Shadow.h"
 #include "video/Camera.h"
 #include "core/GLM.h"
-#include "video/Trace.h"
+#include "video/GPUTimer.h"
 #include "core/Var.h"
 #include "core/collection/Array.h"
 #include "video/Renderer.h"
 #include "core/Log.h"
+#include "core/Trace.h"
+#include "math/Frustum.h"
 #include <glm/gtc/matrix_access.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/constants.hpp>
@@ -32,6 +34,7 @@ bool Shadow::init(const ShadowParameters& parameters) {
 		return false;
 	}
 	_parameters = parameters;
+	markDirty();
 	const glm::vec3 sunPos(25.0f, 100.0f, 25.0f);
 	setPosition(sunPos, glm::vec3(0.0f), glm::up());
 
@@ -153,20 +156,28 @@ bool Shadow::bind(video::TextureUnit unit) {
 }
 
 void Shadow::render(const funcRender& renderCallback, bool clearDepthBuffer) {
-	video_trace_scoped(ShadowRender);
+	video_pass_scoped(ShadowRender);
 	const bool oldBlend = video::disable(video::State::Blend);
 	// put shadow acne into the dark
 	video::enable(video::State::CullFace);
 	video::cullFace(video::Face::Front);
 	video::colorMask(false, false, false, false);
 	_depthBuffer.bind(false);
+	int renderedCascades = 0;
 	for (int i = 0; i < _parameters.maxDepthBuffers; ++i) {
+		if (!isDirty(i)) {
+			continue;
+		}
 		_depthBuffer.bindTextureAttachment(video::FrameBufferAttachment::Depth, i, clearDepthBuffer);
+		++renderedCascades;
 		if (!renderCallback(i, _cascades[i])) {
 			break;
 		}
+		_renderedCascades[i] = _cascades[i];
+		_dirty[i] = false;
 	}
 	_depthBuffer.unbind();
+	core_trace_plot("ShadowRenderedCascades", (int64_t)renderedCascades);
 	video::colorMask(true, true, true, true);
 	video::cullFace(video::Face::Back);
 	if (oldBlend) {
@@ -174,6 +185,30 @@ void Shadow::render(const funcRender& renderCallback, bool clearDepthBuffer) {
 	}
 }
 
+void Shadow::markDirty() {
+	for (size_t i = 0; i < _dirty.size(); ++i) {
+		_dirty[i] = true;
+	}
+}
+
+void Shadow::markDirty(const glm::vec3& mins, const glm::vec3& maxs) {
+	for (int i = 0; i < _parameters.maxDepthBuffers; ++i) {
+		if (_dirty[i]) {
+			continue;
+		}
+		// the bounds are tested against the cascade that is in the depth buffer
+		math::Frustum frustum;
+		frustum.updatePlanes(_renderedCascades[i], glm::mat4(1.0f));
+		if (frustum.isVisible(mins, maxs)) {
+			_dirty[i] = true;
+		}
+	}
+}
+
+bool Shadow::isDirty(int cascade) const {
+	return _dirty[cascade] || _renderedCascades[cascade] != _cascades[cascade];
+}
+
 const glm::ivec2& Shadow::dimension() const {
 	return _depthBuffer.dimension();
 }
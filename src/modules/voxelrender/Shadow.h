@@ -51,6 +51,9 @@ private:
 	glm::mat4 _lightView;
 	Cascades _cascades;
 	Distances _distances;
+	// the cascades that are in the depth buffer - a cascade is only rendered again if it moved or is dirty
+	Cascades _renderedCascades;
+	core::Array<bool, shader::VoxelShaderConstants::getMaxDepthBuffers()> _dirty;
 	video::FrameBuffer _depthBuffer;
 	ShadowParameters _parameters;
 	float _shadowRangeZ = 0.0f;
@@ -69,8 +72,22 @@ public:
 
 	bool bind(video::TextureUnit unit);
 
+	/**
+	 * @brief Renders the cascades that changed since they were rendered the last time
+	 * @sa markDirty()
+	 */
 	void render(const funcRender& renderCallback, bool clearDepthBuffer = true);
 
+	/**
+	 * @brief Render all cascades again with the next @c render() call - e.g. because the shadow casters changed
+	 */
+	void markDirty();
+	/**
+	 * @brief Render the cascades again whose volume intersects the given world space bounds
+	 */
+	void markDirty(const glm::vec3& mins, const glm::vec3& maxs);
+	bool isDirty(int cascade) const;
+
 	void setPosition(const glm::vec3& eye, const glm::vec3& center, const glm::vec3& up);
 	void setLightViewMatrix(const glm::mat4& lightView);
 
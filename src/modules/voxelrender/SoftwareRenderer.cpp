@@ -0,0 +1,249 @@
+/**
+ * @file
+ */
+
+#include "SoftwareRenderer.h"
+#include "core/Color.h"
+#include "core/Trace.h"
+#include "core/collection/Map.h"
+#include "palette/Palette.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "video/Camera.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/Mesh.h"
+#include "voxel/MeshState.h"
+#include "voxel/RawVolume.h"
+#include "voxel/SurfaceExtractor.h"
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+
+namespace voxelrender {
+
+// see aovalues in voxel.vert
+static const float AmbientOcclusionValues[] = {0.15f, 0.6f, 0.8f, 1.0f};
+
+SoftwareRenderer::SoftwareRenderer() : _lightDir(glm::normalize(glm::vec3(0.4f, 1.0f, 0.6f))) {
+}
+
+void SoftwareRenderer::setAmbientColor(const glm::vec3 &color) {
+	_ambientColor = color;
+}
+
+void SoftwareRenderer::setDiffuseColor(const glm::vec3 &color) {
+	_diffuseColor = color;
+}
+
+void SoftwareRenderer::setLightDirection(const glm::vec3 &dir) {
+	_lightDir = glm::normalize(dir);
+}
+
+static inline float edge(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &p) {
+	return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+void SoftwareRenderer::drawTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2,
+									const glm::vec4 &color, bool transparent) {
+	const ClipVertex *vertices[3] = {&v0, &v1, &v2};
+	glm::vec2 screen[3];
+	float depth[3];
+	float invW[3];
+	for (int i = 0; i < 3; ++i) {
+		const glm::vec4 &pos = vertices[i]->pos;
+		invW[i] = 1.0f / pos.w;
+		const glm::vec3 ndc = glm::vec3(pos) * invW[i];
+		// the rows of the image start at the top
+		screen[i] = glm::vec2((ndc.x * 0.5f + 0.5f) * (float)_size.x, (0.5f - ndc.y * 0.5f) * (float)_size.y);
+		depth[i] = ndc.z;
+	}
+	const float area = edge(screen[0], screen[1], screen[2]);
+	if (glm::abs(area) < 1.0e-8f) {
+		return;
+	}
+	const glm::vec2 mins = glm::min(screen[0], glm::min(screen[1], screen[2]));
+	const glm::vec2 maxs = glm::max(screen[0], glm::max(screen[1], screen[2]));
+	const int minX = glm::max(0, (int)floorf(mins.x));
+	const int minY = glm::max(0, (int)floorf(mins.y));
+	const int maxX = glm::min(_size.x - 1, (int)ceilf(maxs.x));
+	const int maxY = glm::min(_size.y - 1, (int)ceilf(maxs.y));
+	const float invArea = 1.0f / area;
+	for (int y = minY; y <= maxY; ++y) {
+		for (int x = minX; x <= maxX; ++x) {
+			const glm::vec2 p((float)x + 0.5f, (float)y + 0.5f);
+			// the barycentric coordinates are positive for both windings
+			const float b0 = edge(screen[1], screen[2], p) * invArea;
+			const float b1 = edge(screen[2], screen[0], p) * invArea;
+			const float b2 = edge(screen[0], screen[1], p) * invArea;
+			if (b0 < 0.0f || b1 < 0.0f || b2 < 0.0f) {
+				continue;
+			}
+			const float z = b0 * depth[0] + b1 * depth[1] + b2 * depth[2];
+			const size_t idx = (size_t)y * _size.x + x;
+			if (z < -1.0f || z >= _depth[idx]) {
+				continue;
+			}
+			// the ambient occlusion is interpolated perspective correct
+			const float w = b0 * invW[0] + b1 * invW[1] + b2 * invW[2];
+			const float ao = (b0 * invW[0] * v0.ambientOcclusion + b1 * invW[1] * v1.ambientOcclusion +
+							  b2 * invW[2] * v2.ambientOcclusion) /
+							 w;
+			const glm::vec3 rgb = glm::vec3(color) * ao;
+			glm::vec4 &target = _colors[idx];
+			if (transparent) {
+				target = glm::vec4(rgb * color.a + glm::vec3(target) * (1.0f - color.a),
+								   color.a + target.a * (1.0f - color.a));
+			} else {
+				target = glm::vec4(rgb, 1.0f);
+				_depth[idx] = z;
+			}
+		}
+	}
+}
+
+void SoftwareRenderer::rasterize(const ClipVertex *vertices, const glm::vec4 &color, bool transparent) {
+	// clip against the near plane - the other planes are handled by the bounding box of the triangle
+	ClipVertex clipped[4];
+	int n = 0;
+	for (int i = 0; i < 3; ++i) {
+		const ClipVertex &a = vertices[i];
+		const ClipVertex &b = vertices[(i + 1) % 3];
+		const float da = a.pos.z + a.pos.w;
+		const float db = b.pos.z + b.pos.w;
+		if (da >= 0.0f) {
+			clipped[n++] = a;
+		}
+		if ((da >= 0.0f) != (db >= 0.0f)) {
+			const float t = da / (da - db);
+			clipped[n].pos = glm::mix(a.pos, b.pos, t);
+			clipped[n].ambientOcclusion = glm::mix(a.ambientOcclusion, b.ambientOcclusion, t);
+			++n;
+		}
+	}
+	for (int i = 2; i < n; ++i) {
+		if (clipped[0].pos.w <= 0.0f || clipped[i - 1].pos.w <= 0.0f || clipped[i].pos.w <= 0.0f) {
+			continue;
+		}
+		drawTriangle(clipped[0], clipped[i - 1], clipped[i], color, transparent);
+	}
+}
+
+void SoftwareRenderer::drawMesh(const voxel::Mesh &mesh, const palette::Palette &palette, const glm::mat4 &model,
+								const glm::mat4 &viewProjection, bool frontFaces, bool transparent) {
+	core_trace_scoped(SoftwareRendererDrawMesh);
+	const voxel::VertexArray &vertices = mesh.getVertexVector();
+	const voxel::IndexArray &indices = mesh.getIndexVector();
+	const glm::mat4 mvp = viewProjection * model;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		const voxel::VoxelVertex *tri[3] = {&vertices[indices[i]], &vertices[indices[i + 1]],
+											&vertices[indices[i + 2]]};
+		ClipVertex clip[3];
+		for (int j = 0; j < 3; ++j) {
+			clip[j].pos = mvp * glm::vec4(tri[j]->position, 1.0f);
+			clip[j].ambientOcclusion = AmbientOcclusionValues[tri[j]->ambientOcclusion];
+		}
+		// cull the faces just like the gl renderer - counter clockwise is the front
+		if (clip[0].pos.w > 0.0f && clip[1].pos.w > 0.0f && clip[2].pos.w > 0.0f) {
+			const glm::vec2 a = glm::vec2(clip[0].pos) / clip[0].pos.w;
+			const glm::vec2 b = glm::vec2(clip[1].pos) / clip[1].pos.w;
+			const glm::vec2 c = glm::vec2(clip[2].pos) / clip[2].pos.w;
+			const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+			if ((area > 0.0f) != frontFaces) {
+				continue;
+			}
+		}
+		const glm::vec3 p0 = model * glm::vec4(tri[0]->position, 1.0f);
+		const glm::vec3 p1 = model * glm::vec4(tri[1]->position, 1.0f);
+		const glm::vec3 p2 = model * glm::vec4(tri[2]->position, 1.0f);
+		const glm::vec3 normal = glm::normalize(glm::cross(p1 - p0, p2 - p0));
+		const float ndotl = glm::abs(glm::dot(normal, _lightDir));
+		const glm::vec4 paletteColor = core::Color::fromRGBA(palette.color(tri[0]->colorIndex));
+		const glm::vec3 light = _ambientColor + _diffuseColor * ndotl;
+		const glm::vec4 color(glm::min(glm::vec3(paletteColor) * light, glm::vec3(1.0f)), paletteColor.a);
+		rasterize(clip, color, transparent);
+	}
+}
+
+image::ImagePtr SoftwareRenderer::render(const scenegraph::SceneGraph &sceneGraph, const video::Camera &camera,
+										 const glm::ivec2 &size, const glm::vec4 &clearColor,
+										 scenegraph::FrameIndex frame) {
+	core_trace_scoped(SoftwareRendererRender);
+	if (size.x <= 0 || size.y <= 0) {
+		return image::ImagePtr();
+	}
+	_size = size;
+	const size_t pixels = (size_t)size.x * size.y;
+	_depth.resize(pixels);
+	_depth.fill(1.0f);
+	_colors.resize(pixels);
+	_colors.fill(clearColor);
+
+	struct Draw {
+		const scenegraph::SceneGraphNode *node;
+		core::SharedPtr<voxel::ChunkMesh> mesh;
+	};
+	core::DynamicArray<Draw> draws;
+	// the references share the meshes of their models
+	core::Map<int, core::SharedPtr<voxel::ChunkMesh>> meshes;
+	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
+		const scenegraph::SceneGraphNode &node = *iter;
+		if (!node.visible()) {
+			continue;
+		}
+		const scenegraph::SceneGraphNode &modelNode = node.isReferenceNode() ? sceneGraph.node(node.reference()) : node;
+		core::SharedPtr<voxel::ChunkMesh> mesh;
+		if (!meshes.get(modelNode.id(), mesh)) {
+			const voxel::RawVolume *volume = sceneGraph.resolveVolume(modelNode);
+			if (volume == nullptr) {
+				continue;
+			}
+			core_trace_scoped(SoftwareRendererExtract);
+			mesh = core::make_shared<voxel::ChunkMesh>(0, 0, true);
+			const voxel::Region &region = volume->region();
+			voxel::SurfaceExtractionContext ctx =
+				voxel::createContext(voxel::SurfaceExtractionType::Cubic, volume, region, modelNode.palette(), *mesh.get(),
+									 region.getLowerCorner());
+			voxel::extractSurface(ctx);
+			meshes.put(modelNode.id(), mesh);
+		}
+		draws.push_back({&node, mesh});
+	}
+
+	const glm::mat4 &viewProjection = camera.viewProjectionMatrix();
+	for (int meshType = 0; meshType < voxel::ChunkMesh::Meshes; ++meshType) {
+		const bool transparent = meshType == voxel::MeshType_Transparency;
+		for (const Draw &draw : draws) {
+			const voxel::Mesh &mesh = draw.mesh->mesh[meshType];
+			if (mesh.isEmpty()) {
+				continue;
+			}
+			const scenegraph::SceneGraphNode &node = *draw.node;
+			const scenegraph::SceneGraphNode &modelNode =
+				node.isReferenceNode() ? sceneGraph.node(node.reference()) : node;
+			// see SceneGraphRenderer::prepare() and voxel.vert
+			const scenegraph::FrameTransform &transform = sceneGraph.transformForFrame(node, frame);
+			const glm::vec3 scale = transform.scale();
+			const voxel::Region region = sceneGraph.resolveRegion(node);
+			const glm::vec3 pivot = scale * node.pivot() * glm::vec3(region.getDimensionsInVoxels());
+			const glm::mat4 model = glm::translate(transform.worldMatrix(), -pivot);
+			const int negative =
+				(int)std::signbit(scale.x) + (int)std::signbit(scale.y) + (int)std::signbit(scale.z);
+			const bool frontFaces = negative != 1 && negative != 3;
+			drawMesh(mesh, modelNode.palette(), model, viewProjection, frontFaces, transparent);
+		}
+	}
+
+	core::DynamicArray<core::RGBA> rgba;
+	rgba.resize(pixels);
+	for (size_t i = 0; i < pixels; ++i) {
+		rgba[i] = core::Color::getRGBA(glm::clamp(_colors[i], 0.0f, 1.0f));
+	}
+	image::ImagePtr image = image::createEmptyImage("thumbnail");
+	if (!image->loadRGBA((const uint8_t *)rgba.data(), size.x, size.y)) {
+		return image::ImagePtr();
+	}
+	return image;
+}
+
+} // namespace voxelrender
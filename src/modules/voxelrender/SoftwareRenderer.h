@@ -0,0 +1,80 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/RGBA.h"
+#include "core/collection/DynamicArray.h"
+#include "image/Image.h"
+#include "scenegraph/SceneGraphAnimation.h"
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace palette {
+class Palette;
+}
+
+namespace scenegraph {
+class SceneGraph;
+}
+
+namespace video {
+class Camera;
+}
+
+namespace voxel {
+class Mesh;
+}
+
+namespace voxelrender {
+
+/**
+ * @brief Rasterizes the cubic meshes of the model nodes on the cpu
+ *
+ * No gl context or window is needed - this allows to render thumbnails on machines without a gpu. The meshes are
+ * extracted with the same cubic surface extractor that is used for the @c RawVolumeRenderer, the references share the
+ * meshes of their models. The lighting is a simplified version of voxel.frag: the ambient and the diffuse light and
+ * the ambient occlusion of the vertices. There are no shadows and the transparent faces are blended in the order of
+ * the nodes.
+ *
+ * @note An instance is not thread safe - but any amount of instances can render in parallel
+ * @sa softwareVolumeThumbnail()
+ */
+class SoftwareRenderer {
+private:
+	glm::ivec2 _size{0};
+	core::DynamicArray<float> _depth;
+	core::DynamicArray<glm::vec4> _colors;
+	glm::vec3 _ambientColor{0.7f};
+	glm::vec3 _diffuseColor{0.3f};
+	glm::vec3 _lightDir;
+
+	struct ClipVertex {
+		glm::vec4 pos;
+		float ambientOcclusion;
+	};
+	void rasterize(const ClipVertex *vertices, const glm::vec4 &color, bool transparent);
+	void drawTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2, const glm::vec4 &color,
+					  bool transparent);
+	void drawMesh(const voxel::Mesh &mesh, const palette::Palette &palette, const glm::mat4 &model,
+				  const glm::mat4 &viewProjection, bool frontFaces, bool transparent);
+
+public:
+	SoftwareRenderer();
+
+	void setAmbientColor(const glm::vec3 &color);
+	void setDiffuseColor(const glm::vec3 &color);
+	void setLightDirection(const glm::vec3 &dir);
+
+	/**
+	 * @brief Renders the visible model nodes of the scene graph with the transforms of the given frame
+	 * @return A rgba image of the given size or an empty pointer if the size is invalid
+	 */
+	image::ImagePtr render(const scenegraph::SceneGraph &sceneGraph, const video::Camera &camera,
+						   const glm::ivec2 &size, const glm::vec4 &clearColor, scenegraph::FrameIndex frame = 0);
+};
+
+} // namespace voxelrender
@@ -6,6 +6,8 @@ layout(std140) uniform u_frag {
 	vec2 u_depthsize;
 	vec4 u_distances;
 	mat4 u_cascades[4];
+	// render into the accumulation targets of the weighted blended order independent transparency
+	int u_oit;
 };
 
 layout(location = 0) $out vec4 o_color;
@@ -128,3 +130,19 @@ vec3 checkerBoardColor(in vec3 normal, in vec3 pos, in vec3 color) {
 }
 
 #endif // r_checkerboard == 1
+
+/**
+ * weighted blended order independent transparency
+ * http://jcgt.org/published/0002/02/09/
+ * the color target accumulates the weighted premultiplied colors - the glow target the weights. The alpha of both
+ * targets is the coverage, the weights depend on the depth to give closer fragments more influence.
+ */
+void oitOutput(inout vec4 color, inout vec4 glow) {
+	if (u_oit == 0) {
+		return;
+	}
+	float a = color.a;
+	float w = a * max(1e-2, 3e3 * pow(1.0 - gl_FragCoord.z, 3.0));
+	color = vec4(color.rgb * a * w, a);
+	glow = vec4(a * w, 0.0, 0.0, a);
+}
@@ -0,0 +1,17 @@
+// the normals and the camera - shared by the meshes and the ray marched volumes
+#define NORMALS 255
+layout(std140) uniform u_vert {
+	vec4 u_normals[NORMALS];
+	mat4 u_viewprojection;
+};
+
+// one layer for each palette - the first row are the colors, the second row the glow colors (see PaletteAtlas)
+uniform sampler2DArray u_palettes;
+
+vec4 paletteColor(in int colorIndex, in int paletteLayer) {
+	return texelFetch(u_palettes, ivec3(colorIndex, 0, paletteLayer), 0);
+}
+
+vec4 paletteGlowColor(in int colorIndex, in int paletteLayer) {
+	return texelFetch(u_palettes, ivec3(colorIndex, 1, paletteLayer), 0);
+}
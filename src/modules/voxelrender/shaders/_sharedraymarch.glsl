@@ -0,0 +1,12 @@
+// the data of the ray marched volume - changes with every draw call
+layout(std140) uniform u_volume {
+	// the transform from the voxel space of the brick map to the world
+	mat4 u_volumemodel;
+	// the camera position in the voxel space of the brick map
+	vec3 u_volumeeye;
+	int u_volumegray;
+	// the size of the volume in voxels
+	vec3 u_volumesize;
+	// the layer of the palette texture array
+	int u_volumepalette;
+};
@@ -1,14 +1,19 @@
 
-#define MATERIALCOLORS 256
-#define NORMALS 255
-layout(std140) uniform u_vert {
-	vec4 u_materialcolor[MATERIALCOLORS];
-	vec4 u_normals[NORMALS];
-	vec4 u_glowcolor[MATERIALCOLORS];
-	mat4 u_viewprojection;
+#include "_sharedpalette.glsl"
+
+// the data that changes with every draw call
+layout(std140) uniform u_object {
 	mat4 u_model;
 	vec3 u_pivot;
 	int u_gray;
+	// the model matrix is taken from a_instance - the pivot is already applied
+	int u_instanced;
+	// the layer of the palette texture array
+	int u_palettelayer;
+	// the offset of the vertex positions to the texels of the ambient occlusion volume - see cfg::VoxelAOVolume
+	vec4 u_aooffset;
+	// one over the dimensions of the ambient occlusion volume
+	vec4 u_aoscale;
 };
 
 $out vec4 v_pos;
@@ -0,0 +1,16 @@
+// the accumulation targets of the weighted blended order independent transparency
+uniform sampler2D u_accum;
+uniform sampler2D u_weight;
+layout(location = 0) $out vec4 o_color;
+layout(location = 1) $out vec4 o_glow;
+
+void main(void) {
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	vec4 accum = texelFetch(u_accum, texel, 0);
+	if (accum.a <= 0.0) {
+		discard;
+	}
+	float weight = texelFetch(u_weight, texel, 0).r;
+	o_color = vec4(accum.rgb / max(weight, 1e-5), accum.a);
+	o_glow = vec4(0.0);
+}
@@ -0,0 +1,109 @@
+$in vec3 v_volumepos;
+
+#include "_sharedpalette.glsl"
+#include "_sharedraymarch.glsl"
+#include "_shared.glsl"
+#include "_sharedfrag.glsl"
+#include "_tonemapping.glsl"
+
+#define BRICKSIZE 8 // see BrickMap::BrickSize
+$constant BrickSize BRICKSIZE
+
+// rgba8 - the slot of the brick in the atlas and the alpha is set if the brick contains any voxels
+uniform sampler3D u_bricks;
+// rg8 - the palette color index and whether the voxel is solid
+uniform sampler3D u_atlas;
+
+/**
+ * @return the voxel at the given position - negative for air
+ */
+int voxelColor(in ivec3 voxel, in ivec3 slot) {
+	vec2 texel = texelFetch(u_atlas, slot * BRICKSIZE + (voxel - (voxel / BRICKSIZE) * BRICKSIZE), 0).rg;
+	if (texel.g < 0.5) {
+		return -1;
+	}
+	return int(texel.r * 255.0 + 0.5);
+}
+
+/**
+ * Amanatides & Woo: A Fast Voxel Traversal Algorithm for Ray Tracing
+ * The empty bricks are skipped at once - the ray is advanced to the exit of the brick then.
+ */
+void main(void) {
+	vec3 dir = normalize(v_volumepos - u_volumeeye);
+	// a direction component of zero would divide by zero below
+	dir = mix(dir, vec3(1e-6), lessThan(abs(dir), vec3(1e-6)));
+	vec3 invdir = 1.0 / dir;
+	vec3 t0 = -u_volumeeye * invdir;
+	vec3 t1 = (u_volumesize - u_volumeeye) * invdir;
+	vec3 tmin = min(t0, t1);
+	vec3 tmax = max(t0, t1);
+	float tenter = max(max(tmin.x, tmin.y), max(tmin.z, 0.0));
+	float texit = min(min(tmax.x, tmax.y), tmax.z);
+	if (tenter >= texit) {
+		discard;
+	}
+
+	ivec3 size = ivec3(u_volumesize);
+	ivec3 stepdir = ivec3(sign(dir));
+	vec3 tdelta = abs(invdir);
+	// the axis that was crossed last - the normal of the hit face
+	vec3 mask = vec3(equal(vec3(tenter), tmin));
+	float t = tenter;
+	ivec3 voxel = clamp(ivec3(floor(u_volumeeye + dir * (t + 1e-4))), ivec3(0), size - 1);
+	vec3 tnext = (vec3(voxel) + max(vec3(stepdir), vec3(0.0)) - u_volumeeye) * invdir;
+
+	int colorIndex = -1;
+	int maxSteps = size.x + size.y + size.z;
+	for (int i = 0; i < maxSteps; ++i) {
+		if (any(lessThan(voxel, ivec3(0))) || any(greaterThanEqual(voxel, size))) {
+			break;
+		}
+		ivec3 brick = voxel / BRICKSIZE;
+		vec4 indirection = texelFetch(u_bricks, brick, 0);
+		if (indirection.a < 0.5) {
+			vec3 bmin = vec3(brick * BRICKSIZE);
+			vec3 bexit = (mix(bmin, bmin + float(BRICKSIZE), step(0.0, dir)) - u_volumeeye) * invdir;
+			t = min(min(bexit.x, bexit.y), bexit.z);
+			mask = vec3(equal(vec3(t), bexit));
+			voxel = ivec3(floor(u_volumeeye + dir * (t + 1e-4)));
+			tnext = (vec3(voxel) + max(vec3(stepdir), vec3(0.0)) - u_volumeeye) * invdir;
+			continue;
+		}
+		colorIndex = voxelColor(voxel, ivec3(indirection.xyz * 255.0 + 0.5));
+		if (colorIndex >= 0) {
+			break;
+		}
+		t = min(min(tnext.x, tnext.y), tnext.z);
+		mask = vec3(equal(vec3(t), tnext));
+		voxel += ivec3(mask) * stepdir;
+		tnext += mask * tdelta;
+	}
+	if (colorIndex < 0) {
+		discard;
+	}
+
+	vec3 volumepos = u_volumeeye + dir * t;
+	vec4 worldpos = u_volumemodel * vec4(volumepos, 1.0);
+	vec4 clippos = u_viewprojection * worldpos;
+	gl_FragDepth = (clippos.z / clippos.w) * 0.5 + 0.5;
+
+	// the camera is inside of a solid voxel if no axis was crossed
+	vec3 facenormal = dot(mask, mask) > 0.0 ? -mask * vec3(stepdir) : -dir;
+	vec3 normal = normalize(mat3(u_volumemodel) * facenormal);
+	vec4 materialColor = paletteColor(colorIndex, u_volumepalette);
+	if (u_volumegray != 0) {
+		float gray = (0.21 * materialColor.r + 0.72 * materialColor.g + 0.07 * materialColor.b) / 3.0;
+		materialColor.rgb = vec3(gray);
+	}
+	float ndotl1 = dot(normal, u_lightdir);
+	float ndotl2 = dot(normal, -u_lightdir);
+	vec3 diffuse = u_diffuse_color * max(0.0, max(ndotl1, ndotl2));
+	float bias = max(0.05 * (1.0 - ndotl1), 0.005);
+	// the cascade is picked by the depth of the bounding box - see v_viewz
+	vec3 shadowColor = shadow(vec4(worldpos.xyz, 1.0), bias, materialColor.rgb, diffuse, u_ambient_color);
+	vec3 color = checkerBoardColor(normal, worldpos.xyz, tonemapping(shadowColor));
+	// the voxels are rendered opaque - even the transparent ones
+	o_color = vec4(pow(color, vec3(1.0 / cl_gamma)), 1.0);
+	o_glow = paletteGlowColor(colorIndex, u_volumepalette);
+}
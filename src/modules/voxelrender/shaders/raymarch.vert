@@ -0,0 +1,25 @@
+// attributes from the VAOs - a cube from -1 to 1
+$in vec3 a_pos;
+
+#include "_sharedpalette.glsl"
+#include "_sharedraymarch.glsl"
+
+// the position on the bounding box in the voxel space of the brick map
+$out vec3 v_volumepos;
+
+#if cl_shadowmap == 1
+$out vec3 v_lightspacepos;
+$out float v_viewz;
+#endif
+
+void main(void) {
+	v_volumepos = (a_pos * 0.5 + 0.5) * u_volumesize;
+	vec4 pos = u_volumemodel * vec4(v_volumepos, 1.0);
+
+#if cl_shadowmap == 1
+	v_lightspacepos = pos.xyz;
+	v_viewz = (u_viewprojection * pos).w;
+#endif // cl_shadowmap
+
+	gl_Position = u_viewprojection * pos;
+}
@@ -3,11 +3,32 @@ $in vec3 v_normal;
 $in vec4 v_color;
 $in vec4 v_glow;
 $in float v_ambientocclusion;
+#if voxel_aovolume == 1
+$in vec3 v_aopos;
+flat $in vec3 v_aoscale;
+uniform sampler3D u_aovolume;
+#endif
 flat $in uint v_flags;
 #include "_shared.glsl"
 #include "_sharedfrag.glsl"
 #include "_tonemapping.glsl"
 
+#if voxel_aovolume == 1
+/**
+ * the occlusion of the voxel in front of the face - the texels hold the fraction of the solid voxels around the voxel
+ * and are interpolated along the face
+ */
+float volumeAmbientOcclusion(void) {
+	vec3 n = normalize(cross(dFdx(v_aopos), dFdy(v_aopos)));
+	if (!gl_FrontFacing) {
+		n = -n;
+	}
+	float occlusion = texture(u_aovolume, (v_aopos + n * 0.5) * v_aoscale).r;
+	// an air voxel on a flat floor has three of seven solid layers around it - this is not occluded
+	return 1.0 - clamp((occlusion - 3.0 / 7.0) * 1.75, 0.0, 0.85);
+}
+#endif
+
 vec4 calcColor(void) {
 	vec3 normal;
 	if ((v_flags & FLAGHASNORMALPALETTECOLOR) != 0u) {
@@ -29,7 +50,11 @@ vec4 calcColor(void) {
 	vec3 color3 = v_normal;
 #endif
 	vec3 shadowColor = shadow(bias, color3, diffuse, u_ambient_color);
-	vec3 color = checkerBoardColor(normal, v_pos.xyz, tonemapping(shadowColor * v_ambientocclusion));
+	float ambientOcclusion = v_ambientocclusion;
+#if voxel_aovolume == 1
+	ambientOcclusion *= volumeAmbientOcclusion();
+#endif
+	vec3 color = checkerBoardColor(normal, v_pos.xyz, tonemapping(shadowColor * ambientOcclusion));
 	return vec4(color, v_color.a);
 }
 
@@ -57,4 +82,5 @@ void main(void) {
 	}
 	o_color.rgb = pow(o_color.rgb, vec3(1.0 / cl_gamma));
 	o_glow = v_glow;
+	oitOutput(o_color, o_glow);
 }
@@ -2,7 +2,14 @@
 layout (location = 0) $in vec3 a_pos;
 layout (location = 1) $in uvec2 a_info;
 layout (location = 2) $in uvec2 a_info2;
+// per instance attribute - for the references of a volume
+layout (location = 3) $in mat4 a_instance;
 $out float v_ambientocclusion;
+#if voxel_aovolume == 1
+// the position in the texels of the ambient occlusion volume
+$out vec3 v_aopos;
+flat $out vec3 v_aoscale;
+#endif
 
 #include "_sharedvert.glsl"
 #include "_shared.glsl"
@@ -12,11 +19,15 @@ void main(void) {
 	uint a_flags = ((a_info[0] & ~3u) >> 2u);
 	uint a_colorindex = a_info[1];
 	uint a_normalindex = a_info2[0];
-	v_pos = u_model * vec4(a_pos - u_pivot, 1.0);
+	if (u_instanced != 0) {
+		v_pos = a_instance * vec4(a_pos, 1.0);
+	} else {
+		v_pos = u_model * vec4(a_pos - u_pivot, 1.0);
+	}
 
 	int materialColorIndex = int(a_colorindex);
-	vec4 materialColor = u_materialcolor[materialColorIndex];
-	vec4 glowColor = u_glowcolor[materialColorIndex];
+	vec4 materialColor = paletteColor(materialColorIndex, u_palettelayer);
+	vec4 glowColor = paletteGlowColor(materialColorIndex, u_palettelayer);
 
 	int normalIndex = int(a_normalindex);
 	vec4 normal = u_normals[normalIndex];
@@ -41,6 +52,10 @@ void main(void) {
 	}
 	v_glow = glowColor;
 	v_ambientocclusion = aovalues[a_ao];
+#if voxel_aovolume == 1
+	v_aopos = a_pos + u_aooffset.xyz;
+	v_aoscale = u_aoscale.xyz;
+#endif
 
 #if cl_shadowmap == 1
 	v_lightspacepos = v_pos.xyz;
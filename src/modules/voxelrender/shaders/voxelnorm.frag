@@ -42,4 +42,5 @@ void main(void) {
 	}
 	o_color.rgb = pow(o_color.rgb, vec3(1.0 / cl_gamma));
 	o_glow = v_glow;
+	oitOutput(o_color, o_glow);
 }
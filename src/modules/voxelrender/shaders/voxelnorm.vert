@@ -4,6 +4,8 @@
 layout (location = 0) $in vec3 a_pos;
 layout (location = 1) $in uvec2 a_info;
 layout (location = 2) $in vec3 a_normal;
+// per instance attribute - for the references of a volume
+layout (location = 3) $in mat4 a_instance;
 
 #include "_sharedvert.glsl"
 #include "_shared.glsl"
@@ -11,12 +13,16 @@ layout (location = 2) $in vec3 a_normal;
 void main(void) {
 	uint a_flags = ((a_info[0] & ~3u) >> 2u);
 	uint a_colorindex = a_info[1];
-	v_pos = u_model * vec4(a_pos - u_pivot, 1.0);
+	if (u_instanced != 0) {
+		v_pos = a_instance * vec4(a_pos, 1.0);
+	} else {
+		v_pos = u_model * vec4(a_pos - u_pivot, 1.0);
+	}
 	v_normal = a_normal;
 
 	int materialColorIndex = int(a_colorindex);
-	vec4 materialColor = u_materialcolor[materialColorIndex];
-	vec4 glowColor = u_glowcolor[materialColorIndex];
+	vec4 materialColor = paletteColor(materialColorIndex, u_palettelayer);
+	vec4 glowColor = paletteGlowColor(materialColorIndex, u_palettelayer);
 	v_flags = 0u;
 #if r_renderoutline == 0
 	if ((a_flags & FLAGOUTLINE) != 0u)
@@ -0,0 +1,103 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/AmbientOcclusionVolume.h"
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Voxel.h"
+
+namespace voxelrender {
+
+class AmbientOcclusionVolumeTest : public app::AbstractTest {
+protected:
+	static constexpr int BoxVoxels = 7 * 7 * 7;
+
+	static uint8_t expected(int solidVoxels) {
+		return (uint8_t)((solidVoxels * 255 + BoxVoxels / 2) / BoxVoxels);
+	}
+
+	void fillFloor(voxel::RawVolume &volume, int height) {
+		const voxel::Region &region = volume.region();
+		const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y < region.getLowerY() + height; ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					volume.setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+	}
+};
+
+TEST_F(AmbientOcclusionVolumeTest, testInit) {
+	AmbientOcclusionVolume aoVolume;
+	ASSERT_TRUE(aoVolume.init(voxel::Region(glm::ivec3(-4), glm::ivec3(12, 3, 20))));
+	EXPECT_EQ(voxel::Region(glm::ivec3(-5), glm::ivec3(13, 4, 21)), aoVolume.region());
+	EXPECT_EQ((size_t)19 * 10 * 27, aoVolume.data().size());
+	EXPECT_TRUE(aoVolume.dirty());
+	EXPECT_EQ(aoVolume.region(), aoVolume.dirtyRegion());
+	EXPECT_FALSE(aoVolume.init(voxel::Region::InvalidRegion));
+}
+
+TEST_F(AmbientOcclusionVolumeTest, testFloor) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	fillFloor(volume, 4);
+	AmbientOcclusionVolume aoVolume;
+	ASSERT_TRUE(aoVolume.init(volume.region()));
+	ASSERT_TRUE(aoVolume.update(volume, volume.region()));
+	// the air right above the floor has three solid layers in its box
+	EXPECT_EQ(expected(3 * 7 * 7), aoVolume.occlusion(glm::ivec3(8, 4, 8)));
+	EXPECT_EQ(expected(1 * 7 * 7), aoVolume.occlusion(glm::ivec3(8, 6, 8)));
+	EXPECT_EQ(0u, aoVolume.occlusion(glm::ivec3(8, 7, 8)));
+	// the voxels outside of the volume are air
+	EXPECT_EQ(expected(4 * 7 * 7), aoVolume.occlusion(glm::ivec3(8, 0, 8)));
+	EXPECT_EQ(expected(3 * 3 * 7), aoVolume.occlusion(glm::ivec3(-1, 4, 8)));
+	EXPECT_EQ(expected(3 * 4 * 4), aoVolume.occlusion(glm::ivec3(0, 4, 0)));
+}
+
+TEST_F(AmbientOcclusionVolumeTest, testUpdateRegion) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	fillFloor(volume, 4);
+	AmbientOcclusionVolume aoVolume;
+	ASSERT_TRUE(aoVolume.init(volume.region()));
+	ASSERT_TRUE(aoVolume.update(volume, volume.region()));
+	aoVolume.markClean();
+
+	const voxel::Region changed(glm::ivec3(5, 4, 6), glm::ivec3(6, 5, 6));
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	for (int y = changed.getLowerY(); y <= changed.getUpperY(); ++y) {
+		for (int x = changed.getLowerX(); x <= changed.getUpperX(); ++x) {
+			volume.setVoxel(x, y, changed.getLowerZ(), voxel);
+		}
+	}
+	ASSERT_TRUE(aoVolume.update(volume, changed));
+	EXPECT_TRUE(aoVolume.dirty());
+	// only the texels around the changed voxels have to be uploaded
+	EXPECT_EQ(voxel::Region(glm::ivec3(2, 1, 3), glm::ivec3(9, 8, 9)), aoVolume.dirtyRegion());
+	EXPECT_EQ(expected(3 * 7 * 7 + 4), aoVolume.occlusion(glm::ivec3(8, 4, 8)));
+	core::DynamicArray<uint8_t> texels;
+	aoVolume.copyTexels(aoVolume.dirtyRegion(), texels);
+	ASSERT_EQ((size_t)8 * 8 * 7, texels.size());
+	EXPECT_EQ(aoVolume.occlusion(glm::ivec3(8, 4, 8)), texels[(8 - 2) + 8 * ((4 - 1) + 8 * (8 - 3))]);
+
+	// the incremental update must match a full update
+	AmbientOcclusionVolume full;
+	ASSERT_TRUE(full.init(volume.region()));
+	ASSERT_TRUE(full.update(volume, volume.region()));
+	ASSERT_EQ(full.data().size(), aoVolume.data().size());
+	for (size_t i = 0; i < full.data().size(); ++i) {
+		ASSERT_EQ(full.data()[i], aoVolume.data()[i]) << "texel " << i;
+	}
+}
+
+TEST_F(AmbientOcclusionVolumeTest, testTransparent) {
+	voxel::RawVolume volume(voxel::Region(0, 7));
+	volume.setVoxel(4, 4, 4, voxel::createVoxel(voxel::VoxelType::Transparent, 1));
+	AmbientOcclusionVolume aoVolume;
+	ASSERT_TRUE(aoVolume.init(volume.region()));
+	ASSERT_TRUE(aoVolume.update(volume, volume.region()));
+	EXPECT_EQ(0u, aoVolume.occlusion(glm::ivec3(4, 5, 4)));
+}
+
+} // namespace voxelrender
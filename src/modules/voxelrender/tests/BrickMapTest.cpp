@@ -0,0 +1,121 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/BrickMap.h"
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Voxel.h"
+
+namespace voxelrender {
+
+class BrickMapTest : public app::AbstractTest {
+protected:
+	// the voxel of the atlas at the given position of the volume
+	const uint8_t *atlasVoxel(const BrickMap &brickMap, const glm::ivec3 &pos) const {
+		const glm::ivec3 local = pos - brickMap.region().getLowerCorner();
+		const glm::ivec3 brick = local / BrickMap::BrickSize;
+		const int brickIdx = brick.x + brickMap.bricks().x * (brick.y + brickMap.bricks().y * brick.z);
+		const uint8_t *indirection = &brickMap.indirection()[brickIdx * BrickMap::IndirectionComponents];
+		if (indirection[3] == 0u) {
+			return nullptr;
+		}
+		const glm::ivec3 texel =
+			glm::ivec3(indirection[0], indirection[1], indirection[2]) * BrickMap::BrickSize + local % BrickMap::BrickSize;
+		const glm::ivec3 &dim = brickMap.atlasDimension();
+		return &brickMap.atlas()[((texel.z * dim.y + texel.y) * dim.x + texel.x) * BrickMap::AtlasComponents];
+	}
+};
+
+TEST_F(BrickMapTest, testInit) {
+	BrickMap brickMap;
+	ASSERT_TRUE(brickMap.init(voxel::Region(glm::ivec3(-4), glm::ivec3(12, 3, 20))));
+	EXPECT_EQ(glm::ivec3(3, 1, 4), brickMap.bricks());
+	EXPECT_EQ(0, brickMap.usedBricks());
+	EXPECT_EQ(0, brickMap.atlasDimension().z);
+	EXPECT_TRUE(brickMap.dirty());
+	EXPECT_FALSE(brickMap.init(voxel::Region::InvalidRegion));
+}
+
+TEST_F(BrickMapTest, testUpdate) {
+	voxel::RawVolume volume(voxel::Region(glm::ivec3(-4), glm::ivec3(27)));
+	volume.setVoxel(-4, -4, -4, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	volume.setVoxel(20, 10, 5, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+	BrickMap brickMap;
+	ASSERT_TRUE(brickMap.init(volume.region()));
+	ASSERT_TRUE(brickMap.update(volume, volume.region()));
+	EXPECT_EQ(2, brickMap.usedBricks());
+	EXPECT_EQ(glm::ivec3(4), brickMap.bricks());
+	EXPECT_EQ(-1, brickMap.brickSlot(glm::ivec3(1, 0, 0)));
+	EXPECT_NE(-1, brickMap.brickSlot(glm::ivec3(0, 0, 0)));
+
+	const uint8_t *voxel = atlasVoxel(brickMap, glm::ivec3(20, 10, 5));
+	ASSERT_NE(nullptr, voxel);
+	EXPECT_EQ(42u, voxel[0]);
+	EXPECT_EQ(255u, voxel[1]);
+	voxel = atlasVoxel(brickMap, glm::ivec3(21, 10, 5));
+	ASSERT_NE(nullptr, voxel);
+	EXPECT_EQ(0u, voxel[1]);
+	EXPECT_EQ(nullptr, atlasVoxel(brickMap, glm::ivec3(10, 10, 10)));
+	brickMap.markClean();
+	EXPECT_FALSE(brickMap.dirty());
+}
+
+TEST_F(BrickMapTest, testUpdateRegion) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	volume.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	BrickMap brickMap;
+	ASSERT_TRUE(brickMap.init(volume.region()));
+	ASSERT_TRUE(brickMap.update(volume, volume.region()));
+	const int slot = brickMap.brickSlot(glm::ivec3(0));
+	ASSERT_NE(-1, slot);
+
+	// the slot of the brick that got empty is reused
+	volume.setVoxel(1, 1, 1, voxel::Voxel());
+	volume.setVoxel(9, 9, 9, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	ASSERT_TRUE(brickMap.update(volume, voxel::Region(1, 1)));
+	EXPECT_EQ(0, brickMap.usedBricks());
+	ASSERT_TRUE(brickMap.update(volume, voxel::Region(9, 9)));
+	EXPECT_EQ(1, brickMap.usedBricks());
+	EXPECT_EQ(slot, brickMap.brickSlot(glm::ivec3(1)));
+	EXPECT_EQ(-1, brickMap.brickSlot(glm::ivec3(0)));
+	const uint8_t *voxel = atlasVoxel(brickMap, glm::ivec3(9, 9, 9));
+	ASSERT_NE(nullptr, voxel);
+	EXPECT_EQ(2u, voxel[0]);
+
+	voxel::RawVolume other(voxel::Region(0, 7));
+	EXPECT_FALSE(brickMap.update(other, other.region()));
+}
+
+TEST_F(BrickMapTest, testDirtyRegions) {
+	voxel::RawVolume volume(voxel::Region(0, 31));
+	volume.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	volume.setVoxel(30, 30, 30, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	BrickMap brickMap;
+	ASSERT_TRUE(brickMap.init(volume.region()));
+	EXPECT_EQ(voxel::Region(glm::ivec3(0), glm::ivec3(3)), brickMap.dirtyBricks());
+	ASSERT_TRUE(brickMap.update(volume, volume.region()));
+	brickMap.markClean();
+	EXPECT_FALSE(brickMap.dirtyBricks().isValid());
+	EXPECT_FALSE(brickMap.dirtySlots().isValid());
+
+	// only the changed brick and its atlas slot have to be uploaded
+	volume.setVoxel(17, 9, 9, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+	ASSERT_TRUE(brickMap.update(volume, voxel::Region(glm::ivec3(17, 9, 9), glm::ivec3(17, 9, 9))));
+	EXPECT_EQ(voxel::Region(glm::ivec3(2, 1, 1), glm::ivec3(2, 1, 1)), brickMap.dirtyBricks());
+	ASSERT_TRUE(brickMap.dirtySlots().isValid());
+	EXPECT_EQ(glm::ivec3(1), brickMap.dirtySlots().getDimensionsInVoxels());
+
+	core::DynamicArray<uint8_t> texels;
+	brickMap.copyIndirection(brickMap.dirtyBricks(), texels);
+	ASSERT_EQ((size_t)BrickMap::IndirectionComponents, texels.size());
+	EXPECT_EQ(255u, texels[3]);
+	brickMap.copyAtlas(brickMap.dirtySlots(), texels);
+	constexpr int BrickVoxels = BrickMap::BrickSize * BrickMap::BrickSize * BrickMap::BrickSize;
+	ASSERT_EQ((size_t)BrickVoxels * BrickMap::AtlasComponents, texels.size());
+	const int local = ((9 - 8) * BrickMap::BrickSize + (9 - 8)) * BrickMap::BrickSize + (17 - 16);
+	EXPECT_EQ(42u, texels[local * BrickMap::AtlasComponents + 0]);
+	EXPECT_EQ(255u, texels[local * BrickMap::AtlasComponents + 1]);
+}
+
+} // namespace voxelrender
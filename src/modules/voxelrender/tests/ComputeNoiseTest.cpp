@@ -0,0 +1,67 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/ComputeNoise.h"
+#include "noise/Noise.h"
+#include "video/tests/AbstractGLTest.h"
+
+namespace voxelrender {
+
+class ComputeNoiseTest : public video::AbstractGLTest {
+protected:
+	// the gpu may contract the multiplications and additions - the results are not bitwise identical
+	static constexpr float Epsilon = 0.001f;
+
+	static void compare(const core::DynamicArray<float> &cpu, const core::DynamicArray<float> &gpu) {
+		ASSERT_EQ(cpu.size(), gpu.size());
+		for (size_t i = 0; i < cpu.size(); ++i) {
+			ASSERT_NEAR(cpu[i], gpu[i], Epsilon) << "cell " << i;
+		}
+	}
+};
+
+TEST_F(ComputeNoiseTest, testFillVolume) {
+	ComputeNoise computeNoise;
+	if (!computeNoise.init()) {
+		GTEST_SKIP() << "No compute shader support";
+	}
+	noise::Noise noise;
+	noise::NoiseFieldParams params;
+	params.frequency = 0.07f;
+	params.offset = glm::vec3(0.5f, 1.5f, 2.5f);
+	const glm::ivec3 mins(-3, 2, 5);
+	const glm::ivec3 dim(13, 9, 7);
+	for (int type = 0; type < (int)noise::NoiseType::Max; ++type) {
+		params.type = (noise::NoiseType)type;
+		core::DynamicArray<float> cpu;
+		noise.fillVolume(mins, dim, params, cpu);
+		core::DynamicArray<float> gpu;
+		ASSERT_TRUE(computeNoise.fillVolume(mins, dim, params, gpu)) << "type " << type;
+		compare(cpu, gpu);
+	}
+	computeNoise.shutdown();
+}
+
+TEST_F(ComputeNoiseTest, testFillHeightmap) {
+	ComputeNoise computeNoise;
+	if (!computeNoise.init()) {
+		GTEST_SKIP() << "No compute shader support";
+	}
+	noise::Noise noise;
+	noise::NoiseFieldParams params;
+	params.frequency = 0.05f;
+	const glm::ivec2 mins(10, -4);
+	const glm::ivec2 dim(17, 11);
+	for (int type = 0; type < (int)noise::NoiseType::Max; ++type) {
+		params.type = (noise::NoiseType)type;
+		core::DynamicArray<float> cpu;
+		noise.fillHeightmap(mins, dim, params, cpu);
+		core::DynamicArray<float> gpu;
+		ASSERT_TRUE(computeNoise.fillHeightmap(mins, dim, params, gpu)) << "type " << type;
+		compare(cpu, gpu);
+	}
+	computeNoise.shutdown();
+}
+
+} // namespace voxelrender
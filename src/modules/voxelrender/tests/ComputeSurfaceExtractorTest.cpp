@@ -0,0 +1,145 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/ComputeSurfaceExtractor.h"
+#include "app/tests/AbstractTest.h"
+#include "video/tests/AbstractGLTest.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/Face.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+#include "voxel/SurfaceExtractor.h"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace voxelrender {
+
+class ComputeSurfaceExtractorTest : public app::AbstractTest {
+protected:
+	static uint32_t face(voxel::FaceNames faceName, bool transparent, const uint8_t ao[4],
+						 uint8_t color) {
+		return (uint32_t)faceName | ((uint32_t)transparent << 3u) | ((uint32_t)ao[0] << 4u) |
+			   ((uint32_t)ao[1] << 6u) | ((uint32_t)ao[2] << 8u) | ((uint32_t)ao[3] << 10u) |
+			   ((uint32_t)color << 16u) | (NO_NORMAL << 24u);
+	}
+
+	static uint32_t position(const glm::ivec3 &pos) {
+		return (uint32_t)pos.x | ((uint32_t)pos.y << 10u) | ((uint32_t)pos.z << 20u);
+	}
+};
+
+TEST_F(ComputeSurfaceExtractorTest, testPackVoxels) {
+	voxel::RawVolume volume(voxel::Region(0, 0, 0, 1, 0, 0));
+	volume.setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 5, 7, 1));
+	volume.setVoxel(1, 0, 0, voxel::createVoxel(voxel::VoxelType::Transparent, 9));
+	core::DynamicArray<uint32_t> packed;
+	ComputeSurfaceExtractor::packVoxels(volume, volume.region(), packed);
+	// the region with a border of one voxel
+	ASSERT_EQ(4u * 3u * 3u, packed.size());
+	const uint32_t air = NO_NORMAL << 16u;
+	EXPECT_EQ(2u | 4u | (5u << 8u) | (7u << 16u), packed[17]);
+	EXPECT_EQ(1u | (9u << 8u), packed[18]);
+	EXPECT_EQ(air, packed[0]);
+	EXPECT_EQ(air, packed[16]);
+	EXPECT_EQ(air, packed[19]);
+	EXPECT_EQ(air, packed[35]);
+}
+
+TEST_F(ComputeSurfaceExtractorTest, testAddFaces) {
+	const uint8_t flippedAO[4] = {0, 3, 0, 3};
+	const uint8_t ao[4] = {3, 3, 3, 3};
+	const uint32_t faces[] = {
+		position(glm::ivec3(1, 2, 3)), face(voxel::FaceNames::PositiveY, false, flippedAO, 4),
+		position(glm::ivec3(0, 0, 0)), face(voxel::FaceNames::NegativeX, true, ao, 6)};
+	voxel::ChunkMesh mesh;
+	ComputeSurfaceExtractor::addFaces(faces, 2u, glm::ivec3(10, 0, 0), mesh);
+
+	const voxel::Mesh &opaque = mesh.mesh[0];
+	ASSERT_EQ(4u, opaque.getNoOfVertices());
+	ASSERT_EQ(6u, opaque.getNoOfIndices());
+	EXPECT_EQ(glm::vec3(11, 2, 3), opaque.getVertexVector()[0].position);
+	EXPECT_EQ(glm::vec3(11, 2, 4), opaque.getVertexVector()[1].position);
+	EXPECT_EQ(glm::vec3(12, 2, 4), opaque.getVertexVector()[2].position);
+	EXPECT_EQ(glm::vec3(12, 2, 3), opaque.getVertexVector()[3].position);
+	EXPECT_EQ(4u, opaque.getVertexVector()[0].colorIndex);
+	EXPECT_EQ(3u, opaque.getVertexVector()[1].ambientOcclusion);
+	// the quad is flipped because of the ambient occlusion
+	EXPECT_EQ(1u, opaque.getIndexVector()[0]);
+	EXPECT_EQ(2u, opaque.getIndexVector()[1]);
+	EXPECT_EQ(3u, opaque.getIndexVector()[2]);
+
+	const voxel::Mesh &transparent = mesh.mesh[1];
+	ASSERT_EQ(4u, transparent.getNoOfVertices());
+	ASSERT_EQ(6u, transparent.getNoOfIndices());
+	EXPECT_EQ(glm::vec3(10, 1, 1), transparent.getVertexVector()[2].position);
+	EXPECT_EQ(6u, transparent.getVertexVector()[2].colorIndex);
+	EXPECT_EQ(0u, transparent.getIndexVector()[0]);
+}
+
+class ComputeSurfaceExtractorGLTest : public video::AbstractGLTest {
+protected:
+	// the vertices of a triangle - sorted to not depend on the order of the vertices and triangles
+	typedef std::array<int, 3 * 6> Triangle;
+
+	static std::vector<Triangle> triangles(const voxel::Mesh &mesh) {
+		std::vector<Triangle> result;
+		const voxel::IndexArray &indices = mesh.getIndexVector();
+		const voxel::VertexArray &vertices = mesh.getVertexVector();
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			std::array<std::array<int, 6>, 3> v;
+			for (int n = 0; n < 3; ++n) {
+				const voxel::VoxelVertex &vertex = vertices[indices[i + n]];
+				v[n] = {(int)vertex.position.x, (int)vertex.position.y, (int)vertex.position.z,
+						(int)vertex.ambientOcclusion, (int)vertex.colorIndex, (int)vertex.flags};
+			}
+			std::sort(v.begin(), v.end());
+			Triangle triangle;
+			for (int n = 0; n < 3; ++n) {
+				std::copy(v[n].begin(), v[n].end(), triangle.begin() + n * 6);
+			}
+			result.push_back(triangle);
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+};
+
+TEST_F(ComputeSurfaceExtractorGLTest, testSameFacesAsCpuExtractor) {
+	ComputeSurfaceExtractor extractor;
+	if (!extractor.init()) {
+		GTEST_SKIP() << "No compute shader support";
+	}
+	voxel::RawVolume volume(voxel::Region(0, 0, 0, 11, 9, 8));
+	for (int z = 0; z <= 8; ++z) {
+		for (int y = 0; y <= 9; ++y) {
+			for (int x = 0; x <= 11; ++x) {
+				const int n = (x * 7 + y * 13 + z * 5) % 11;
+				if (n < 5) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, n + 1));
+				} else if (n == 5) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Transparent, 8));
+				}
+			}
+		}
+	}
+	// a region in the inside of the volume and one at its border
+	const voxel::Region regions[] = {voxel::Region(2, 1, 3, 8, 7, 6), volume.region()};
+	for (const voxel::Region &region : regions) {
+		voxel::ChunkMesh cpu;
+		voxel::SurfaceExtractionContext ctx =
+			voxel::buildCubicContext(&volume, region, cpu, region.getLowerCorner(), false);
+		voxel::extractSurface(ctx);
+		voxel::ChunkMesh gpu;
+		EXPECT_TRUE(extractor.extract(volume, region, gpu, region.getLowerCorner()));
+		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+			EXPECT_GT(cpu.mesh[i].getNoOfIndices(), 0u);
+			EXPECT_EQ(triangles(cpu.mesh[i]), triangles(gpu.mesh[i]))
+				<< "mesh " << i << " of " << region.toString().c_str();
+		}
+	}
+	extractor.shutdown();
+}
+
+} // namespace voxelrender
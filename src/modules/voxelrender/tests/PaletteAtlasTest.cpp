@@ -0,0 +1,51 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/PaletteAtlas.h"
+#include "app/tests/AbstractTest.h"
+#include "core/Color.h"
+#include "palette/Palette.h"
+
+namespace voxelrender {
+
+class PaletteAtlasTest : public app::AbstractTest {};
+
+TEST_F(PaletteAtlasTest, testSharedLayer) {
+	palette::Palette nippon;
+	nippon.nippon();
+	palette::Palette copy = nippon;
+	palette::Palette magicaVoxel;
+	magicaVoxel.magicaVoxel();
+
+	PaletteAtlas atlas;
+	EXPECT_EQ(-1, atlas.find(nippon));
+	const int layer = atlas.layer(nippon);
+	EXPECT_EQ(0, layer);
+	EXPECT_TRUE(atlas.dirty());
+	EXPECT_EQ(layer, atlas.layer(copy));
+	EXPECT_EQ(1, atlas.layer(magicaVoxel));
+	EXPECT_EQ(2, atlas.layers());
+	ASSERT_EQ((size_t)(2 * PaletteAtlas::Rows * palette::PaletteMaxColors), atlas.data().size());
+	EXPECT_EQ(core::Color::fromRGBA(magicaVoxel.color(1)),
+			  atlas.data()[PaletteAtlas::Rows * palette::PaletteMaxColors + 1]);
+	atlas.shutdown();
+}
+
+TEST_F(PaletteAtlasTest, testFull) {
+	PaletteAtlas atlas;
+	palette::Palette palette;
+	palette.nippon();
+	for (int i = 0; i < PaletteAtlas::MaxLayers; ++i) {
+		palette.setColor(0, core::RGBA(i, 0, 0, 255));
+		ASSERT_EQ(i, atlas.layer(palette));
+	}
+	EXPECT_EQ(PaletteAtlas::MaxLayers, atlas.layers());
+	// the atlas is cleared if there is no free layer anymore
+	palette.setColor(0, core::RGBA(0, 255, 0, 255));
+	EXPECT_EQ(0, atlas.layer(palette));
+	EXPECT_EQ(1, atlas.layers());
+	atlas.shutdown();
+}
+
+} // namespace voxelrender
@@ -0,0 +1,21 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/RawVolumeRenderer.h"
+#include "app/tests/AbstractTest.h"
+
+namespace voxelrender {
+
+class RawVolumeRendererTest : public app::AbstractTest {};
+
+TEST_F(RawVolumeRendererTest, testLodLevel) {
+	EXPECT_EQ(0, RawVolumeRenderer::lodLevel(4.0f));
+	EXPECT_EQ(0, RawVolumeRenderer::lodLevel(0.6f));
+	// the voxels of the next level are not bigger than a pixel
+	EXPECT_EQ(1, RawVolumeRenderer::lodLevel(0.5f));
+	EXPECT_EQ(2, RawVolumeRenderer::lodLevel(0.25f));
+	EXPECT_EQ(voxel::LODLevels - 1, RawVolumeRenderer::lodLevel(0.001f));
+}
+
+} // namespace voxelrender
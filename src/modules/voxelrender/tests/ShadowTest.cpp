@@ -0,0 +1,67 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/Shadow.h"
+#include "video/Camera.h"
+#include "video/tests/AbstractGLTest.h"
+
+namespace voxelrender {
+
+class ShadowTest : public video::AbstractGLTest {
+protected:
+	Shadow _shadow;
+	video::Camera _camera;
+
+	void SetUp() override {
+		video::AbstractGLTest::SetUp();
+		if (IsSkipped()) {
+			return;
+		}
+		core::Var::get(cfg::ClientShadowMapSize, "128");
+		ShadowParameters parameters;
+		parameters.maxDepthBuffers = shader::VoxelShaderConstants::getMaxDepthBuffers();
+		ASSERT_TRUE(_shadow.init(parameters));
+		_camera.setSize(glm::ivec2(640, 480));
+		_camera.setWorldPosition(glm::vec3(0.0f, 10.0f, 50.0f));
+		_camera.lookAt(glm::vec3(0.0f));
+		_camera.update(0.0);
+	}
+
+	void TearDown() override {
+		_shadow.shutdown();
+		video::AbstractGLTest::TearDown();
+	}
+
+	int render() {
+		_shadow.update(_camera, true);
+		int cascades = 0;
+		_shadow.render([&cascades](int, const glm::mat4 &) {
+			++cascades;
+			return true;
+		});
+		return cascades;
+	}
+};
+
+TEST_F(ShadowTest, testCachedCascades) {
+	const int maxDepthBuffers = _shadow.parameters().maxDepthBuffers;
+	EXPECT_EQ(maxDepthBuffers, render());
+	EXPECT_EQ(0, render()) << "Nothing changed - the cascades should be cached";
+
+	_shadow.markDirty();
+	EXPECT_EQ(maxDepthBuffers, render());
+
+	// far away from all the cascades
+	_shadow.markDirty(glm::vec3(100000.0f), glm::vec3(100001.0f));
+	EXPECT_EQ(0, render());
+
+	// the first cascade starts at the camera
+	_shadow.markDirty(glm::vec3(-1.0f, 9.0f, 49.0f), glm::vec3(1.0f, 11.0f, 51.0f));
+	EXPECT_GE(render(), 1);
+
+	_shadow.setPosition(glm::vec3(-25.0f, 100.0f, 25.0f), glm::vec3(0.0f), glm::up());
+	EXPECT_EQ(maxDepthBuffers, render()) << "The light moved - all cascades must be rendered again";
+}
+
+} // namespace voxelrender
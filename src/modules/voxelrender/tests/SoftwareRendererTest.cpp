@@ -0,0 +1,75 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/SoftwareRenderer.h"
+#include "app/tests/AbstractTest.h"
+#include "core/Color.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "video/Camera.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Voxel.h"
+#include "voxelformat/FormatThumbnail.h"
+#include "voxelrender/ImageGenerator.h"
+
+namespace voxelrender {
+
+class SoftwareRendererTest : public app::AbstractTest {
+protected:
+	const glm::vec4 _clearColor{0.0f, 0.0f, 1.0f, 1.0f};
+
+	void createScene(scenegraph::SceneGraph &sceneGraph) {
+		voxel::RawVolume *volume = new voxel::RawVolume(voxel::Region(0, 7));
+		const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+		for (int z = 0; z < 8; ++z) {
+			for (int y = 0; y < 8; ++y) {
+				for (int x = 0; x < 8; ++x) {
+					volume->setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(volume, true);
+		ASSERT_NE(InvalidNodeId, sceneGraph.emplace(core::move(node)));
+	}
+};
+
+TEST_F(SoftwareRendererTest, testThumbnail) {
+	scenegraph::SceneGraph sceneGraph;
+	createScene(sceneGraph);
+	voxelformat::ThumbnailContext ctx;
+	ctx.outputSize = glm::ivec2(64, 48);
+	ctx.clearColor = _clearColor;
+	const image::ImagePtr &image = softwareVolumeThumbnail(sceneGraph, ctx);
+	ASSERT_TRUE(image);
+	ASSERT_EQ(64, image->width());
+	ASSERT_EQ(48, image->height());
+	const core::RGBA clear = core::Color::getRGBA(_clearColor);
+	EXPECT_NE(clear, image->colorAt(32, 24));
+	EXPECT_EQ(255, image->colorAt(32, 24).a);
+	EXPECT_EQ(clear, image->colorAt(0, 0));
+	EXPECT_EQ(clear, image->colorAt(63, 47));
+}
+
+TEST_F(SoftwareRendererTest, testHiddenNode) {
+	scenegraph::SceneGraph sceneGraph;
+	createScene(sceneGraph);
+	sceneGraph.firstModelNode()->setVisible(false);
+	voxelformat::ThumbnailContext ctx;
+	ctx.outputSize = glm::ivec2(32);
+	ctx.clearColor = _clearColor;
+	const image::ImagePtr &image = softwareVolumeThumbnail(sceneGraph, ctx);
+	ASSERT_TRUE(image);
+	EXPECT_EQ(core::Color::getRGBA(_clearColor), image->colorAt(16, 16));
+}
+
+TEST_F(SoftwareRendererTest, testInvalidSize) {
+	scenegraph::SceneGraph sceneGraph;
+	createScene(sceneGraph);
+	video::Camera camera;
+	SoftwareRenderer renderer;
+	EXPECT_FALSE(renderer.render(sceneGraph, camera, glm::ivec2(0, 16), _clearColor));
+}
+
+} // namespace voxelrender
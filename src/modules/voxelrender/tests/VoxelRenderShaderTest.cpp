@@ -5,6 +5,9 @@
 #include "video/tests/AbstractGLTest.h"
 #include "VoxelShader.h"
 #include "VoxelnormShader.h"
+#include "CubicfacesShader.h"
+#include "OitcompositeShader.h"
+#include "RaymarchShader.h"
 
 namespace voxelrender {
 
@@ -23,6 +26,27 @@ TEST_P(VoxelRenderShaderTest, testVoxelNormShader) {
 	shader.shutdown();
 }
 
+TEST_P(VoxelRenderShaderTest, testCubicfacesShader) {
+	if (!video::hasFeature(video::Feature::ComputeShaders)) {
+		GTEST_SKIP() << "No compute shader support";
+	}
+	shader::CubicfacesShader shader;
+	EXPECT_TRUE(shader.setup());
+	shader.shutdown();
+}
+
+TEST_P(VoxelRenderShaderTest, testOitcompositeShader) {
+	shader::OitcompositeShader shader;
+	EXPECT_TRUE(shader.setup());
+	shader.shutdown();
+}
+
+TEST_P(VoxelRenderShaderTest, testRaymarchShader) {
+	shader::RaymarchShader shader;
+	EXPECT_TRUE(shader.setup());
+	shader.shutdown();
+}
+
 VIDEO_SHADERTEST(VoxelRenderShaderTest)
 
 }
@@ -90,6 +90,7 @@ static void saveOptionsMesh(const io::FormatDescription *desc) {
 	ImGui::CheckboxVar(_("Ambient occlusion"), cfg::VoxformatAmbientocclusion);
 	ImGui::CheckboxVar(_("Apply transformations"), cfg::VoxformatTransform);
 	ImGui::CheckboxVar(_("Apply optimizations"), cfg::VoxformatOptimize);
+	ImGui::InputVarFloat(_("Simplification error"), cfg::VoxformatSimplifyError);
 	ImGui::CheckboxVar(_("Exports quads"), cfg::VoxformatQuads);
 	ImGui::CheckboxVar(_("Vertex colors"), cfg::VoxformatWithColor);
 	ImGui::CheckboxVar(_("Normals"), cfg::VoxformatWithNormals);
@@ -101,6 +102,7 @@ static void saveOptionsMesh(const io::FormatDescription *desc) {
 		ImGui::CheckboxVar("KHR_materials_pbrSpecularGlossiness",
 						   cfg::VoxFormatGLTF_KHR_materials_pbrSpecularGlossiness);
 		ImGui::CheckboxVar("KHR_materials_specular", cfg::VoxFormatGLTF_KHR_materials_specular);
+		ImGui::CheckboxVar("KHR_mesh_quantization", cfg::VoxFormatGLTF_KHR_mesh_quantization);
 	}
 	ImGui::CheckboxVar(_("Export materials"), cfg::VoxFormatWithMaterials);
 
@@ -140,6 +142,7 @@ bool saveOptions(const io::FormatDescription *desc, const io::FilesystemEntry &e
 
 	if (*desc == voxelformat::VENGIFormat::format()) {
 		ImGui::InputVarInt(_("Empty palette index"), cfg::VoxformatEmptyPaletteIndex);
+		ImGui::InputVarInt(_("Compression level"), cfg::VoxformatVENGICompressionLevel);
 	}
 
 	return true;
@@ -191,6 +194,7 @@ static void loadOptionsMesh() {
 	ImGui::InputVarString(_("Texture search path"), cfg::VoxformatTexturePath);
 	ImGui::CheckboxVar(_("Fill hollow"), cfg::VoxformatFillHollow);
 	ImGui::InputVarInt(_("Point cloud size"), cfg::VoxformatPointCloudSize);
+	ImGui::InputVarInt(_("Level bucket size"), cfg::VoxformatMeshBucketSize);
 
 	const core::VarPtr &normalPaletteVar = core::Var::getSafe(cfg::NormalPalette);
 	if (ImGui::BeginCombo(_("Normal palette"), normalPaletteVar->strVal().c_str(), 0)) {
@@ -203,9 +207,10 @@ static void loadOptionsMesh() {
 		// TODO: allow other normal palettes to be loaded
 	}
 
-	const char *voxelizationModes[] = {_("high quality"), _("faster and less memory")};
+	const char *voxelizationModes[] = {_("high quality"), _("faster and less memory"), _("rasterize")};
 	static_assert(voxelformat::MeshFormat::VoxelizeMode::HighQuality == 0, "HighQuality must be at index 0");
 	static_assert(voxelformat::MeshFormat::VoxelizeMode::Fast == 1, "Fast must be at index 1");
+	static_assert(voxelformat::MeshFormat::VoxelizeMode::Rasterize == 2, "Rasterize must be at index 2");
 	const core::VarPtr &voxelizationVar = core::Var::getSafe(cfg::VoxformatVoxelizeMode);
 	const int currentVoxelizationMode = voxelizationVar->intVal();
 
@@ -28,7 +28,16 @@ bool LUAApiWidget::updateScriptExecutionPanel(voxelgenerator::LUAApi &luaApi, co
 	}
 
 	if (ctx.isRunning) {
-		ImGui::Spinner("running_scripts", ImGui::Size(1.0f));
+		if (ctx.progress >= 0.0f) {
+			ImGui::ProgressBar(ctx.progress, ImVec2(ImGui::Size(10.0f), 0.0f));
+		} else {
+			ImGui::Spinner("running_scripts", ImGui::Size(1.0f));
+		}
+		ImGui::SameLine();
+		if (ImGui::Button(_("Cancel"))) {
+			ctx.cancelScript();
+		}
+		ImGui::TooltipTextUnformatted(_("Abort the running script"));
 		return true;
 	}
 
@@ -17,12 +17,17 @@ struct LUAApiExecutorContext {
 
 	// set to true if another script is currently running
 	bool isRunning = false;
+	// the progress of the running script in the range [0,1] - negative if the script doesn't report its progress
+	float progress = -1.0f;
 	// set to the listener to receive the command execution event for the script
 	command::CommandExecutionListener *listener = nullptr;
 	virtual void notify(const core::String &scriptFilename, const core::DynamicArray<core::String> &args) {
 	}
 	virtual void runScript(const core::String &script, const core::DynamicArray<core::String> &args) {
 	}
+	// called if the user wants to abort the running script
+	virtual void cancelScript() {
+	}
 };
 
 enum LUAApiWidgetFlags {
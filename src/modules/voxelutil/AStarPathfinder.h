@@ -5,6 +5,7 @@
 #pragma once
 
 #include "AStarPathfinderImpl.h"
+#include "core/ArrayLength.h"
 #include "core/Common.h"
 #include "core/Assert.h"
 #include "core/GLM.h"
@@ -129,10 +130,9 @@ private:
 	// Node containers
 	AllNodesContainer _allNodes;
 	OpenNodesContainer _openNodes;
-	ClosedNodesContainer _closedNodes;
 
-	// The current node
-	AllNodesContainer::iterator _current;
+	// The index of the current node
+	int _current = -1;
 
 	float _progress = 0.0f;
 
@@ -152,45 +152,47 @@ bool AStarPathfinder<VolumeType>::execute() {
 	//Clear any existing nodes
 	_allNodes.clear();
 	_openNodes.clear();
-	_closedNodes.clear();
 
 	//Clear the result
 	_params.result->clear();
 
-	//Iterators to start and end node.
-	AllNodesContainer::iterator startNode = _allNodes.insert(Node(_params.start.x, _params.start.y, _params.start.z)).first;
-	AllNodesContainer::iterator endNode = _allNodes.insert(Node(_params.end.x, _params.end.y, _params.end.z)).first;
-
-	//Regarding the const_cast - normally you should not modify an object which is in an std::set.
-	//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-	//and changing the object directly can break the sorting. However, in our case we have provided a
-	//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-	//modify other properties of the object while it is in the set.
-	Node* tempStart = const_cast<Node*>(&(*startNode));
-	tempStart->gVal = 0;
-	tempStart->hVal = computeH(startNode->position, endNode->position);
+	if (_params.start == _params.end) {
+		_params.result->insert_front(_params.start);
+		return true;
+	}
 
-	Node* tempEnd = const_cast<Node*>(&(*endNode));
-	tempEnd->hVal = 0.0f;
+	bool inserted;
+	const int startNode = _allNodes.insert(_params.start, inserted);
+	_allNodes[startNode].gVal = 0;
+	_allNodes[startNode].hVal = computeH(_params.start, _params.end);
 
-	_openNodes.insert(startNode);
+	_openNodes.insert(_allNodes, startNode);
 
-	float fDistStartToEnd = glm::length(glm::vec3(endNode->position) - glm::vec3(startNode->position));
+	float fDistStartToEnd = glm::length(glm::vec3(_params.end) - glm::vec3(_params.start));
 	_progress = 0.0f;
 	if (_params.progressCallback) {
 		_params.progressCallback(_progress);
 	}
 
-	while (!_openNodes.empty() && _openNodes.getFirst() != endNode) {
+	int endNode = -1;
+	for (;;) {
 		//Move the first node from open to closed.
-		_current = _openNodes.getFirst();
-		_openNodes.removeFirst();
-		_closedNodes.insert(_current);
+		_current = _openNodes.pop(_allNodes);
+		if (_current == -1) {
+			break;
+		}
+		if (_allNodes[_current].position == _params.end) {
+			endNode = _current;
+			break;
+		}
+		_allNodes[_current].closed = true;
+		const glm::ivec3 currentPos = _allNodes[_current].position;
+		const float currentGVal = _allNodes[_current].gVal;
 
 		//Update the user on our progress
 		if (_params.progressCallback) {
 			const float fMinProgresIncreament = 0.001f;
-			float fDistCurrentToEnd = glm::length(glm::vec3(endNode->position) - glm::vec3(_current->position));
+			float fDistCurrentToEnd = glm::length(glm::vec3(_params.end) - glm::vec3(currentPos));
 			float fDistNormalised = fDistCurrentToEnd / fDistStartToEnd;
 			float fProgress = 1.0f - fDistNormalised;
 			if (fProgress >= _progress + fMinProgresIncreament) {
@@ -208,38 +210,21 @@ bool AStarPathfinder<VolumeType>::execute() {
 		//statements, larger connectivities include smaller ones.
 		switch (_params.connectivity) {
 		case voxel::Connectivity::TwentySixConnected:
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[0], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[1], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[2], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[3], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[4], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[5], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[6], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[7], _current->gVal + fCornerCost);
+			for (int i = 0; i < lengthof(voxel::arrayPathfinderCorners); ++i) {
+				processNeighbour(currentPos + voxel::arrayPathfinderCorners[i], currentGVal + fCornerCost);
+			}
 			/* fallthrough */
 
 		case voxel::Connectivity::EighteenConnected:
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[0], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[1], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[2], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[3], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[4], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[5], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[6], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[7], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[8], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[9], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[10], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[11], _current->gVal + fEdgeCost);
+			for (int i = 0; i < lengthof(voxel::arrayPathfinderEdges); ++i) {
+				processNeighbour(currentPos + voxel::arrayPathfinderEdges[i], currentGVal + fEdgeCost);
+			}
 			/* fallthrough */
 
 		case voxel::Connectivity::SixConnected:
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[0], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[1], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[2], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[3], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[4], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[5], _current->gVal + fFaceCost);
+			for (int i = 0; i < lengthof(voxel::arrayPathfinderFaces); ++i) {
+				processNeighbour(currentPos + voxel::arrayPathfinderFaces[i], currentGVal + fFaceCost);
+			}
 			break;
 		}
 
@@ -249,19 +234,12 @@ bool AStarPathfinder<VolumeType>::execute() {
 		}
 	}
 
-	if (_openNodes.empty() || _openNodes.getFirst() != endNode) {
+	if (endNode == -1) {
 		Log::debug("We've failed to find a valid path.");
 		return false;
 	}
-	//Regarding the const_cast - normally you should not modify an object which is in an std::set.
-	//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-	//and changing the object directly can break the sorting. However, in our case we have provided a
-	//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-	//modify other properties of the object while it is in the set.
-	Node* n = const_cast<Node*>(&(*endNode));
-	while (n != 0) {
-		_params.result->insert_front(n->position);
-		n = n->parent;
+	for (int n = endNode; n != -1; n = _allNodes[n].parent) {
+		_params.result->insert_front(_allNodes[n].position);
 	}
 
 	if (_params.progressCallback) {
@@ -273,51 +251,31 @@ bool AStarPathfinder<VolumeType>::execute() {
 
 template<typename VolumeType>
 void AStarPathfinder<VolumeType>::processNeighbour(const glm::ivec3& neighbourPos, float neighbourGVal) {
-	bool bIsVoxelValidForPath = _params.isVoxelValidForPath(_params.volume, neighbourPos);
-	if (!bIsVoxelValidForPath) {
-		return;
-	}
-
-	float cost = neighbourGVal;
-
-	std::pair<AllNodesContainer::iterator, bool> insertResult = _allNodes.insert(Node(neighbourPos.x, neighbourPos.y, neighbourPos.z));
-	AllNodesContainer::iterator neighbour = insertResult.first;
-
-	if (insertResult.second) {
-		//New node, compute h.
-		Node* tempNeighbour = const_cast<Node*>(&(*neighbour));
-		tempNeighbour->hVal = computeH(neighbour->position, _params.end);
-	}
-
-	OpenNodesContainer::iterator openIter = _openNodes.find(neighbour);
-	if (openIter != _openNodes.end()) {
-		if (cost < neighbour->gVal) {
-			_openNodes.remove(openIter);
-			openIter = _openNodes.end();
-		}
-	}
-
-	//TODO - Nodes could keep track of if they are in open or closed? And a pointer to where they are?
-	ClosedNodesContainer::iterator closedIter = _closedNodes.find(neighbour);
-	if (closedIter != _closedNodes.end()) {
-		if (cost < neighbour->gVal) {
-			//Probably shouldn't happen?
-			_closedNodes.remove(closedIter);
-			closedIter = _closedNodes.end();
+	bool inserted;
+	const int neighbour = _allNodes.insert(neighbourPos, inserted);
+	Node &node = _allNodes[neighbour];
+	if (inserted) {
+		//New node - the validity is checked only once per position
+		if (!_params.isVoxelValidForPath(_params.volume, neighbourPos)) {
+			node.closed = true;
+			node.gVal = -1.0f;
+			return;
 		}
+		node.hVal = computeH(neighbourPos, _params.end);
+	} else if (node.gVal < 0.0f) {
+		// invalid position
+		return;
+	} else if (!(neighbourGVal < node.gVal)) {
+		// the node is already open or closed with a lower cost
+		return;
+	} else if (node.closed) {
+		//Probably shouldn't happen? Only with an inconsistent heuristic - e.g. a hBias > 1
+		node.closed = false;
 	}
 
-	if (openIter == _openNodes.end() && closedIter == _closedNodes.end()) {
-		//Regarding the const_cast - normally you should not modify an object which is in an std::set.
-		//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-		//and changing the object directly can break the sorting. However, in our case we have provided a
-		//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-		//modify other properties of the object while it is in the set.
-		Node* temp = const_cast<Node*>(&(*neighbour));
-		temp->gVal = cost;
-		_openNodes.insert(neighbour);
-		temp->parent = const_cast<Node*>(&(*_current));
-	}
+	node.gVal = neighbourGVal;
+	node.parent = _current;
+	_openNodes.insert(_allNodes, neighbour);
 }
 
 template<typename VolumeType>
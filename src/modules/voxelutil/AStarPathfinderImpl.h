@@ -5,148 +5,131 @@
 #pragma once
 
 #include "core/Common.h"
+#include "core/GLM.h"
+#include "core/collection/FlatMap.h"
 #include <glm/vec3.hpp>
 #include <algorithm>
 #include <limits> //For numeric_limits
-#include <set>
 #include <vector>
 
 namespace voxelutil {
 
-class OpenNodesContainer;
-class ClosedNodesContainer;
-
 struct Node {
-	Node(int x, int y, int z) :
+	Node(const glm::ivec3 &pos) :
 			// Initialise with NaNs so that we will know if we forget to set these properly.
-			gVal(std::numeric_limits<float>::quiet_NaN()), hVal(std::numeric_limits<float>::quiet_NaN()), parent(nullptr) {
-		position = {x, y, z};
-	}
-
-	bool operator==(const Node& rhs) const {
-		return position == rhs.position;
-	}
-
-	bool operator<(const Node& rhs) const {
-		if (position.x < rhs.position.x)
-			return true;
-		if (rhs.position.x < position.x)
-			return false;
-
-		if (position.y < rhs.position.y)
-			return true;
-		if (rhs.position.y < position.y)
-			return false;
-
-		if (position.z < rhs.position.z)
-			return true;
-		if (rhs.position.z < position.z)
-			return false;
-
-		return false;
+			position(pos), gVal(std::numeric_limits<float>::quiet_NaN()), hVal(std::numeric_limits<float>::quiet_NaN()) {
 	}
 
 	glm::ivec3 position;
 	float gVal;
 	float hVal;
-	Node* parent;
+	/** index of the parent node in the @c AllNodesContainer or @c -1 */
+	int parent = -1;
+	/** the node was already expanded */
+	bool closed = false;
 
 	inline float f() const {
 		return gVal + hVal;
 	}
 };
 
-typedef std::set<Node> AllNodesContainer;
-
-class AllNodesContainerIteratorComparator {
-public:
-	bool operator()(const AllNodesContainer::iterator& lhs, const AllNodesContainer::iterator& rhs) const {
-		return (&(*lhs)) < (&(*rhs));
-	}
-};
-
-class NodeSort {
-public:
-	bool operator()(const AllNodesContainer::iterator& lhs, const AllNodesContainer::iterator& rhs) const {
-		return lhs->f() > rhs->f();
-	}
-};
-
-class OpenNodesContainer {
-public:
-	typedef std::vector<AllNodesContainer::iterator>::iterator iterator;
+/**
+ * @brief All nodes that were touched by the search - looked up by their position in a hash map
+ * @note The node indices stay valid until @c clear() is called - node references don't
+ */
+class AllNodesContainer {
+private:
+	std::vector<Node> _nodes;
+	core::FlatMap<glm::ivec3, int, glm::hash<glm::ivec3>> _indices;
 
 public:
 	inline void clear() {
-		open.clear();
+		_nodes.clear();
+		_indices.clear();
 	}
 
-	inline bool empty() const {
-		return open.empty();
+	inline size_t size() const {
+		return _nodes.size();
 	}
 
-	void insert(AllNodesContainer::iterator node) {
-		open.push_back(node);
-		std::push_heap(open.begin(), open.end(), NodeSort());
+	/**
+	 * @param[out] inserted @c true if the node didn't exist yet
+	 * @return The index of the node for the given position
+	 */
+	int insert(const glm::ivec3 &pos, bool &inserted) {
+		int idx;
+		if (_indices.get(pos, idx)) {
+			inserted = false;
+			return idx;
+		}
+		idx = (int)_nodes.size();
+		_nodes.emplace_back(pos);
+		_indices.put(pos, idx);
+		inserted = true;
+		return idx;
 	}
 
-	inline AllNodesContainer::iterator getFirst() {
-		return open[0];
+	inline Node &operator[](int idx) {
+		return _nodes[idx];
 	}
 
-	void removeFirst() {
-		std::pop_heap(open.begin(), open.end(), NodeSort());
-		open.pop_back();
-	}
-
-	void remove(iterator iterToRemove) {
-		open.erase(iterToRemove);
-		std::make_heap(open.begin(), open.end(), NodeSort());
-	}
-
-	inline iterator begin() {
-		return open.begin();
-	}
-
-	inline iterator end() {
-		return open.end();
-	}
-
-	iterator find(AllNodesContainer::iterator node) {
-		return std::find(open.begin(), open.end(), node);
+	inline const Node &operator[](int idx) const {
+		return _nodes[idx];
 	}
+};
 
+/**
+ * @brief Binary heap of the nodes that should get expanded next
+ *
+ * Nodes are not removed from the heap if their cost improves - they are just added again. The outdated entries are
+ * skipped in @c pop() - this avoids searching the heap for a node.
+ */
+class OpenNodesContainer {
 private:
-	std::vector<AllNodesContainer::iterator> open;
-};
+	struct Entry {
+		float f;
+		int node;
+	};
 
-class ClosedNodesContainer {
-public:
-	typedef std::set<AllNodesContainer::iterator, AllNodesContainerIteratorComparator>::iterator iterator;
+	struct EntrySort {
+		inline bool operator()(const Entry &lhs, const Entry &rhs) const {
+			return lhs.f > rhs.f;
+		}
+	};
+
+	std::vector<Entry> _open;
 
 public:
 	inline void clear() {
-		closed.clear();
-	}
-
-	inline void insert(AllNodesContainer::iterator node) {
-		closed.insert(node);
-	}
-
-	inline void remove(iterator iterToRemove) {
-		closed.erase(iterToRemove);
+		_open.clear();
 	}
 
-	inline iterator end() {
-		return closed.end();
-	}
-
-	inline iterator find(AllNodesContainer::iterator node) {
-		return closed.find(node);
+	inline bool empty() const {
+		return _open.empty();
+	}
+
+	void insert(const AllNodesContainer &allNodes, int node) {
+		_open.push_back({allNodes[node].f(), node});
+		std::push_heap(_open.begin(), _open.end(), EntrySort());
+	}
+
+	/**
+	 * @return The index of the open node with the lowest cost or @c -1 if there are no open nodes left
+	 */
+	int pop(const AllNodesContainer &allNodes) {
+		while (!_open.empty()) {
+			const Entry entry = _open.front();
+			std::pop_heap(_open.begin(), _open.end(), EntrySort());
+			_open.pop_back();
+			const Node &node = allNodes[entry.node];
+			if (node.closed || node.f() != entry.f) {
+				// outdated entry
+				continue;
+			}
+			return entry.node;
+		}
+		return -1;
 	}
-
-private:
-	std::set<AllNodesContainer::iterator, AllNodesContainerIteratorComparator> closed;
 };
 
 }
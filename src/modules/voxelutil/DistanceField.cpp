@@ -0,0 +1,243 @@
+/**
+ * @file
+ */
+
+#include "DistanceField.h"
+#include "core/Assert.h"
+#include "core/Trace.h"
+#include "core/concurrent/Parallel.h"
+#include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
+#include "voxel/Voxel.h"
+#include <float.h>
+#include <glm/exponential.hpp>
+
+namespace voxelutil {
+
+DistanceField::DistanceField(const voxel::Region &region) : _region(region) {
+	_squaredDistances.resize((size_t)region.voxels());
+}
+
+float DistanceField::distance(int x, int y, int z) const {
+	return glm::sqrt((float)squaredDistance(x, y, z));
+}
+
+namespace priv {
+
+static constexpr int32_t Infinite = INT32_MAX;
+
+/**
+ * @brief Scratch buffers for the distance transform of one row
+ */
+struct EDTRow {
+	core::DynamicArray<int32_t> f;
+	core::DynamicArray<int32_t> d;
+	core::DynamicArray<int> v;
+	core::DynamicArray<float> z;
+
+	EDTRow(int n) {
+		f.resize(n);
+		d.resize(n);
+		v.resize(n);
+		z.resize(n + 1);
+	}
+
+	inline float intersect(int q, int p) const {
+		return (float)(((int64_t)f[q] + (int64_t)q * q) - ((int64_t)f[p] + (int64_t)p * p)) / (float)(2 * q - 2 * p);
+	}
+
+	/**
+	 * @brief One dimensional squared distance transform of the sampled function @c f into @c d
+	 *
+	 * Computes the lower envelope of the parabolas rooted at the finite samples. Infinite samples don't add a
+	 * parabola - if all samples are infinite, all distances are infinite.
+	 */
+	void transform(int n) {
+		int k = -1;
+		for (int q = 0; q < n; ++q) {
+			if (f[q] == Infinite) {
+				continue;
+			}
+			float s = 0.0f;
+			while (k >= 0) {
+				s = intersect(q, v[k]);
+				if (s > z[k]) {
+					break;
+				}
+				--k;
+			}
+			++k;
+			v[k] = q;
+			z[k] = k == 0 ? -FLT_MAX : s;
+			z[k + 1] = FLT_MAX;
+		}
+		if (k == -1) {
+			for (int q = 0; q < n; ++q) {
+				d[q] = Infinite;
+			}
+			return;
+		}
+		k = 0;
+		for (int q = 0; q < n; ++q) {
+			while (z[k + 1] < (float)q) {
+				++k;
+			}
+			const int64_t dist = (int64_t)(q - v[k]) * (q - v[k]) + f[v[k]];
+			d[q] = (int32_t)glm::min(dist, (int64_t)Infinite - 1);
+		}
+	}
+};
+
+/**
+ * @brief Transforms all rows along one axis of the grid
+ * @param n The amount of cells in a row
+ * @param stride The distance of two cells of a row in the grid
+ * @param outer The amount of rows along the first of the two other axes - the work is split along this axis
+ * @param inner The amount of rows along the second of the two other axes
+ */
+static void transformAxis(core::DynamicArray<int32_t> &grid, int n, size_t stride, int outer, size_t outerStride,
+						  int inner, size_t innerStride, core::ThreadPool *threadPool) {
+	const int slices = core::parallelSliceCount(threadPool, outer);
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		EDTRow row(n);
+		const int lower = outer * slice / slices;
+		const int upper = outer * (slice + 1) / slices;
+		for (int o = lower; o < upper; ++o) {
+			for (int i = 0; i < inner; ++i) {
+				int32_t *cells = grid.data() + o * outerStride + i * innerStride;
+				for (int q = 0; q < n; ++q) {
+					row.f[q] = cells[q * stride];
+				}
+				row.transform(n);
+				for (int q = 0; q < n; ++q) {
+					cells[q * stride] = row.d[q];
+				}
+			}
+		}
+	});
+}
+
+} // namespace priv
+
+void computeDistanceField(const voxel::RawVolume &volume, const voxel::Region &region, DistanceField &field,
+						  bool toAir, core::ThreadPool *threadPool) {
+	core_trace_scoped(ComputeDistanceField);
+	core_assert(field.region() == region);
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	const int width = region.getWidthInVoxels();
+	const int height = region.getHeightInVoxels();
+	const int depth = region.getDepthInVoxels();
+	const size_t sliceSize = (size_t)width * height;
+
+	// the target voxels get a distance of 0
+	core::DynamicArray<int32_t> grid;
+	grid.resize(sliceSize * depth);
+	const voxel::Region &volumeRegion = volume.region();
+	const int lowerX = glm::max(mins.x, volumeRegion.getLowerX());
+	const int upperX = glm::min(maxs.x, volumeRegion.getUpperX());
+	const int32_t airValue = toAir ? 0 : priv::Infinite;
+	const int32_t solidValue = toAir ? priv::Infinite : 0;
+	const int slices = core::parallelSliceCount(threadPool, depth);
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		const int lowerZ = depth * slice / slices;
+		const int upperZ = depth * (slice + 1) / slices;
+		for (int z = lowerZ; z < upperZ; ++z) {
+			for (int y = 0; y < height; ++y) {
+				int32_t *cells = grid.data() + z * sliceSize + (size_t)y * width;
+				for (int x = 0; x < width; ++x) {
+					cells[x] = airValue;
+				}
+				const glm::ivec3 pos(lowerX, mins.y + y, mins.z + z);
+				if (lowerX > upperX || !volumeRegion.containsPointInY(pos.y) || !volumeRegion.containsPointInZ(pos.z)) {
+					continue;
+				}
+				const voxel::Voxel *voxels = volume.row(pos);
+				for (int x = lowerX; x <= upperX; ++x) {
+					if (!voxel::isAir(voxels[x - lowerX].getMaterial())) {
+						cells[x - mins.x] = solidValue;
+					}
+				}
+			}
+		}
+	});
+
+	priv::transformAxis(grid, width, 1, depth, sliceSize, height, width, threadPool);
+	priv::transformAxis(grid, height, width, depth, sliceSize, width, 1, threadPool);
+	priv::transformAxis(grid, depth, sliceSize, height, width, width, 1, threadPool);
+
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		const int lowerZ = depth * slice / slices;
+		const int upperZ = depth * (slice + 1) / slices;
+		for (int z = lowerZ; z < upperZ; ++z) {
+			for (int y = 0; y < height; ++y) {
+				const int32_t *cells = grid.data() + z * sliceSize + (size_t)y * width;
+				for (int x = 0; x < width; ++x) {
+					uint32_t squared = (uint32_t)cells[x];
+					if (toAir) {
+						// the nearest voxel outside of the region is always straight along one of the axes
+						const int border = glm::min(glm::min(glm::min(x + 1, width - x), glm::min(y + 1, height - y)),
+													glm::min(z + 1, depth - z));
+						squared = glm::min(squared, (uint32_t)(border * border));
+					}
+					field.setSquaredDistance(mins.x + x, mins.y + y, mins.z + z, squared);
+				}
+			}
+		}
+	});
+}
+
+int erode(voxel::RawVolumeWrapper &volume, int radius, core::ThreadPool *threadPool) {
+	core_trace_scoped(Erode);
+	if (radius <= 0) {
+		return 0;
+	}
+	const voxel::Region &region = volume.region();
+	DistanceField field(region);
+	computeDistanceField(*volume.volume(), region, field, true, threadPool);
+	const uint32_t maxSquared = (uint32_t)(radius * radius);
+	const voxel::Voxel air;
+	int removed = 0;
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const uint32_t squared = field.squaredDistance(x, y, z);
+				if (squared == 0u || squared > maxSquared) {
+					continue;
+				}
+				if (volume.setVoxel(x, y, z, air)) {
+					++removed;
+				}
+			}
+		}
+	}
+	return removed;
+}
+
+int dilate(voxel::RawVolumeWrapper &volume, int radius, const voxel::Voxel &voxel, core::ThreadPool *threadPool) {
+	core_trace_scoped(Dilate);
+	if (radius <= 0) {
+		return 0;
+	}
+	const voxel::Region &region = volume.region();
+	DistanceField field(region);
+	computeDistanceField(*volume.volume(), region, field, false, threadPool);
+	const uint32_t maxSquared = (uint32_t)(radius * radius);
+	int added = 0;
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const uint32_t squared = field.squaredDistance(x, y, z);
+				if (squared == 0u || squared > maxSquared) {
+					continue;
+				}
+				if (volume.setVoxel(x, y, z, voxel)) {
+					++added;
+				}
+			}
+		}
+	}
+	return added;
+}
+
+} // namespace voxelutil
@@ -0,0 +1,99 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/GLM.h"
+#include "core/collection/DynamicArray.h"
+#include "voxel/Region.h"
+#include <stdint.h>
+
+namespace core {
+class ThreadPool;
+}
+
+namespace voxel {
+class RawVolume;
+class RawVolumeWrapper;
+class Voxel;
+} // namespace voxel
+
+namespace voxelutil {
+
+/**
+ * @brief The squared euclidean distance of every voxel of a region to the nearest target voxel
+ *
+ * The distances are stored as @c uint16_t - squared distances above @c MaxSquaredDistance (a distance of 255 voxels)
+ * are clamped.
+ *
+ * @sa computeDistanceField()
+ */
+class DistanceField {
+public:
+	static constexpr uint32_t MaxSquaredDistance = UINT16_MAX;
+
+private:
+	voxel::Region _region;
+	core::DynamicArray<uint16_t> _squaredDistances;
+
+	inline size_t index(int x, int y, int z) const {
+		const glm::ivec3 &mins = _region.getLowerCorner();
+		const glm::ivec3 &dim = _region.getDimensionsInVoxels();
+		return (size_t)(x - mins.x) + ((size_t)(y - mins.y) + (size_t)(z - mins.z) * dim.y) * dim.x;
+	}
+
+public:
+	DistanceField(const voxel::Region &region);
+
+	inline const voxel::Region &region() const {
+		return _region;
+	}
+
+	/**
+	 * @return The squared distance to the nearest target voxel - @c 0 for the target voxels themselves
+	 * @note The position must be inside the region
+	 */
+	inline uint32_t squaredDistance(int x, int y, int z) const {
+		return _squaredDistances[index(x, y, z)];
+	}
+
+	inline uint32_t squaredDistance(const glm::ivec3 &pos) const {
+		return squaredDistance(pos.x, pos.y, pos.z);
+	}
+
+	float distance(int x, int y, int z) const;
+
+	inline void setSquaredDistance(int x, int y, int z, uint32_t squaredDistance) {
+		_squaredDistances[index(x, y, z)] = (uint16_t)glm::min(squaredDistance, MaxSquaredDistance);
+	}
+};
+
+/**
+ * @brief Computes the euclidean distance transform (Felzenszwalb and Huttenlocher) of the volume region
+ *
+ * One pass per axis computes the lower envelope of parabolas for every row of voxels - the amount of work is linear in
+ * the amount of voxels and doesn't depend on the distances. The rows of a pass are processed in parallel if a thread
+ * pool is given.
+ *
+ * @param toAir If @c false the distances of the voxels to the nearest solid voxel are computed, if @c true the
+ * distances to the nearest air voxel. The voxels outside of the region are treated as air.
+ */
+void computeDistanceField(const voxel::RawVolume &volume, const voxel::Region &region, DistanceField &field,
+						  bool toAir = false, core::ThreadPool *threadPool = nullptr);
+
+/**
+ * @brief Removes all solid voxels that are closer than or equal to the given radius to an air voxel
+ * @note The voxels outside of the volume region are treated as air
+ * @return The amount of removed voxels
+ */
+int erode(voxel::RawVolumeWrapper &volume, int radius, core::ThreadPool *threadPool = nullptr);
+
+/**
+ * @brief Fills all air voxels that are closer than or equal to the given radius to a solid voxel
+ * @return The amount of added voxels
+ */
+int dilate(voxel::RawVolumeWrapper &volume, int radius, const voxel::Voxel &voxel,
+		   core::ThreadPool *threadPool = nullptr);
+
+} // namespace voxelutil
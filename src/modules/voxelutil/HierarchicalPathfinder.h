@@ -0,0 +1,536 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/ArrayLength.h"
+#include "core/GLM.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/FlatMap.h"
+#include "core/collection/List.h"
+#include "voxel/Connectivity.h"
+#include "voxel/Region.h"
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <float.h>
+#include <functional>
+#include <vector>
+
+namespace voxelutil {
+
+/**
+ * @brief Hierarchical path finding (HPA*) for long paths in large volumes
+ *
+ * The volume region is split into bricks. For every pair of face neighbouring bricks the connected areas on the
+ * shared face get one transition voxel on both sides. Inside a brick the transitions are connected by the costs of the
+ * shortest paths that stay inside the brick. A path query runs A* on this graph of transitions and only searches the
+ * voxels of the bricks the path goes through to build the final path.
+ *
+ * The graph is built lazily for the bricks that are reached by a query and kept for the following queries - call
+ * @c clear() if the volume was modified.
+ *
+ * @note The paths are not always the shortest possible ones - they pass the bricks through the transition voxels
+ * and two bricks are only connected through their shared face. Use the @c AStarPathfinder if the exact shortest path
+ * is needed.
+ * @sa AStarPathfinder
+ */
+template<typename VolumeType>
+class HierarchicalPathfinder {
+public:
+	using IsVoxelValidForPath = std::function<bool(const VolumeType *, const glm::ivec3 &)>;
+
+private:
+	struct Edge {
+		int node;
+		float cost;
+	};
+
+	/**
+	 * @brief A transition voxel on a brick face
+	 */
+	struct Node {
+		glm::ivec3 pos;
+		core::DynamicArray<Edge> edges;
+	};
+
+	struct Brick {
+		/** the transition nodes inside this brick */
+		core::DynamicArray<int> nodes;
+		/** bit n is set if the face to the brick in positive direction of axis n was already processed */
+		uint8_t faces = 0u;
+		/** the edges between the transition nodes of this brick were computed */
+		bool built = false;
+	};
+
+	struct Step {
+		glm::ivec3 offset;
+		float cost;
+	};
+
+	struct OpenEntry {
+		float f;
+		int id;
+		inline bool operator<(const OpenEntry &rhs) const {
+			return f > rhs.f;
+		}
+	};
+
+	static constexpr int StartId = -2;
+
+	const VolumeType *_volume;
+	IsVoxelValidForPath _isVoxelValidForPath;
+	const voxel::Connectivity _connectivity;
+	const voxel::Region _region;
+	const int _brickSize;
+	glm::ivec3 _bricksPerAxis;
+	std::vector<Brick> _bricks;
+	std::vector<Node> _nodes;
+	core::FlatMap<glm::ivec3, int, glm::hash<glm::ivec3>> _nodeIndices;
+	core::DynamicArray<Step> _steps;
+
+	// scratch buffers for the search inside a brick - they are indexed by the voxel index inside the brick
+	std::vector<float> _dist;
+	std::vector<int> _parent;
+	std::vector<uint32_t> _visited;
+	std::vector<uint8_t> _valid;
+	std::vector<OpenEntry> _brickOpen;
+	uint32_t _generation = 0u;
+	int _validBrick = -1;
+
+	inline glm::ivec3 brickPos(const glm::ivec3 &pos) const {
+		return (pos - _region.getLowerCorner()) / _brickSize;
+	}
+
+	inline int brickIndex(const glm::ivec3 &bpos) const {
+		return bpos.x + (bpos.y + bpos.z * _bricksPerAxis.y) * _bricksPerAxis.x;
+	}
+
+	inline voxel::Region brickRegion(const glm::ivec3 &bpos) const {
+		const glm::ivec3 mins = _region.getLowerCorner() + bpos * _brickSize;
+		const glm::ivec3 maxs = glm::min(mins + _brickSize - 1, _region.getUpperCorner());
+		return voxel::Region(mins, maxs);
+	}
+
+	inline int localIndex(const glm::ivec3 &brickMins, const glm::ivec3 &pos) const {
+		const glm::ivec3 p = pos - brickMins;
+		return p.x + (p.y + p.z * _brickSize) * _brickSize;
+	}
+
+	inline bool isValid(const glm::ivec3 &pos) const {
+		return _isVoxelValidForPath(_volume, pos);
+	}
+
+	/**
+	 * @brief Lower bound of the path costs between the two positions
+	 */
+	float heuristic(const glm::ivec3 &a, const glm::ivec3 &b) const {
+		const glm::ivec3 d = glm::abs(a - b);
+		if (_connectivity == voxel::Connectivity::SixConnected) {
+			return (float)(d.x + d.y + d.z);
+		}
+		int s[3] = {d.x, d.y, d.z};
+		std::sort(&s[0], &s[3]);
+		return (float)s[0] * glm::root_three<float>() + (float)(s[1] - s[0]) * glm::root_two<float>() +
+			   (float)(s[2] - s[1]);
+	}
+
+	int addNode(const glm::ivec3 &pos) {
+		int idx;
+		if (_nodeIndices.get(pos, idx)) {
+			return idx;
+		}
+		idx = (int)_nodes.size();
+		_nodes.push_back(Node{pos, {}});
+		_nodeIndices.put(pos, idx);
+		_bricks[brickIndex(brickPos(pos))].nodes.push_back(idx);
+		return idx;
+	}
+
+	/**
+	 * @brief Adds one transition for every connected area on the face between the given brick and its neighbour in
+	 * positive direction of the given axis
+	 */
+	void buildFace(const glm::ivec3 &bpos, int axis) {
+		Brick &brick = _bricks[brickIndex(bpos)];
+		if (brick.faces & (1u << axis)) {
+			return;
+		}
+		brick.faces |= (uint8_t)(1u << axis);
+		const voxel::Region region = brickRegion(bpos);
+		const int u = (axis + 1) % 3;
+		const int v = (axis + 2) % 3;
+		const int width = region.getDimensionsInVoxels()[u];
+		const int height = region.getDimensionsInVoxels()[v];
+		glm::ivec3 step(0);
+		step[axis] = 1;
+
+		// 0 = blocked, 1 = open and not yet assigned to an area
+		std::vector<uint8_t> open(width * height, 0u);
+		for (int j = 0; j < height; ++j) {
+			for (int i = 0; i < width; ++i) {
+				glm::ivec3 pos = region.getLowerCorner();
+				pos[axis] = region.getUpperCorner()[axis];
+				pos[u] += i;
+				pos[v] += j;
+				if (isValid(pos) && isValid(pos + step)) {
+					open[i + j * width] = 1u;
+				}
+			}
+		}
+
+		core::DynamicArray<int> area;
+		for (int start = 0; start < width * height; ++start) {
+			if (open[start] != 1u) {
+				continue;
+			}
+			// flood fill the connected area and use the cell closest to its center as transition
+			area.clear();
+			area.push_back(start);
+			open[start] = 2u;
+			glm::vec2 center(0.0f);
+			for (size_t n = 0; n < area.size(); ++n) {
+				const int cell = area[n];
+				const int i = cell % width;
+				const int j = cell / width;
+				center += glm::vec2(i, j);
+				const int neighbours[4][2] = {{i - 1, j}, {i + 1, j}, {i, j - 1}, {i, j + 1}};
+				for (int k = 0; k < lengthof(neighbours); ++k) {
+					const int ni = neighbours[k][0];
+					const int nj = neighbours[k][1];
+					if (ni < 0 || nj < 0 || ni >= width || nj >= height || open[ni + nj * width] != 1u) {
+						continue;
+					}
+					open[ni + nj * width] = 2u;
+					area.push_back(ni + nj * width);
+				}
+			}
+			center /= (float)area.size();
+			int best = area[0];
+			float bestDist = FLT_MAX;
+			for (const int cell : area) {
+				const glm::vec2 delta = glm::vec2(cell % width, cell / width) - center;
+				const float dist = glm::dot(delta, delta);
+				if (dist < bestDist) {
+					bestDist = dist;
+					best = cell;
+				}
+			}
+			glm::ivec3 pos = region.getLowerCorner();
+			pos[axis] = region.getUpperCorner()[axis];
+			pos[u] += best % width;
+			pos[v] += best / width;
+			const int a = addNode(pos);
+			const int b = addNode(pos + step);
+			_nodes[a].edges.push_back(Edge{b, 1.0f});
+			_nodes[b].edges.push_back(Edge{a, 1.0f});
+		}
+	}
+
+	/**
+	 * @brief Dijkstra search from the given source that doesn't leave the brick
+	 *
+	 * The costs of the reached voxels are in @c _dist - if the entry in @c _visited matches @c _generation.
+	 * @param goal stop the search once this voxel is reached - @c nullptr to search the whole brick
+	 */
+	void searchBrick(const glm::ivec3 &bpos, const glm::ivec3 &source, const glm::ivec3 *goal) {
+		const int bidx = brickIndex(bpos);
+		const voxel::Region region = brickRegion(bpos);
+		const glm::ivec3 &mins = region.getLowerCorner();
+		if (_validBrick != bidx) {
+			// 0 = unknown, 1 = valid, 2 = invalid
+			std::fill(_valid.begin(), _valid.end(), 0u);
+			_validBrick = bidx;
+		}
+		++_generation;
+		_brickOpen.clear();
+		const int sourceIdx = localIndex(mins, source);
+		const int goalIdx = goal != nullptr ? localIndex(mins, *goal) : -1;
+		_dist[sourceIdx] = 0.0f;
+		_parent[sourceIdx] = -1;
+		_visited[sourceIdx] = _generation;
+		_brickOpen.push_back(OpenEntry{0.0f, sourceIdx});
+		while (!_brickOpen.empty()) {
+			std::pop_heap(_brickOpen.begin(), _brickOpen.end());
+			const OpenEntry entry = _brickOpen.back();
+			_brickOpen.pop_back();
+			if (entry.f != _dist[entry.id]) {
+				// outdated entry
+				continue;
+			}
+			if (entry.id == goalIdx) {
+				return;
+			}
+			const glm::ivec3 pos = mins + glm::ivec3(entry.id % _brickSize, (entry.id / _brickSize) % _brickSize,
+													 entry.id / (_brickSize * _brickSize));
+			for (const Step &s : _steps) {
+				const glm::ivec3 next = pos + s.offset;
+				if (!region.containsPoint(next)) {
+					continue;
+				}
+				const int nidx = localIndex(mins, next);
+				const float cost = entry.f + s.cost;
+				if (_visited[nidx] == _generation && _dist[nidx] <= cost) {
+					continue;
+				}
+				if (_valid[nidx] == 0u) {
+					_valid[nidx] = isValid(next) ? 1u : 2u;
+				}
+				if (_valid[nidx] != 1u) {
+					continue;
+				}
+				_visited[nidx] = _generation;
+				_dist[nidx] = cost;
+				_parent[nidx] = entry.id;
+				_brickOpen.push_back(OpenEntry{cost, nidx});
+				std::push_heap(_brickOpen.begin(), _brickOpen.end());
+			}
+		}
+	}
+
+	inline bool reached(const glm::ivec3 &bpos, const glm::ivec3 &pos, float &cost) const {
+		const int idx = localIndex(brickRegion(bpos).getLowerCorner(), pos);
+		if (_visited[idx] != _generation) {
+			return false;
+		}
+		cost = _dist[idx];
+		return true;
+	}
+
+	/**
+	 * @brief Computes the transitions of the brick and the costs between them
+	 */
+	void buildBrick(const glm::ivec3 &bpos) {
+		if (_bricks[brickIndex(bpos)].built) {
+			return;
+		}
+		core_trace_scoped(HierarchicalPathfinderBuildBrick);
+		for (int axis = 0; axis < 3; ++axis) {
+			if (bpos[axis] + 1 < _bricksPerAxis[axis]) {
+				buildFace(bpos, axis);
+			}
+			if (bpos[axis] > 0) {
+				glm::ivec3 neighbour = bpos;
+				--neighbour[axis];
+				buildFace(neighbour, axis);
+			}
+		}
+		Brick &brick = _bricks[brickIndex(bpos)];
+		brick.built = true;
+		for (const int a : brick.nodes) {
+			searchBrick(bpos, _nodes[a].pos, nullptr);
+			for (const int b : brick.nodes) {
+				float cost;
+				if (a != b && reached(bpos, _nodes[b].pos, cost)) {
+					_nodes[a].edges.push_back(Edge{b, cost});
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Appends the voxels of the path inside the brick from @c from (exclusive) to @c to (inclusive)
+	 */
+	bool appendBrickPath(const glm::ivec3 &from, const glm::ivec3 &to, core::List<glm::ivec3> &result) {
+		const glm::ivec3 bpos = brickPos(from);
+		searchBrick(bpos, from, &to);
+		const glm::ivec3 mins = brickRegion(bpos).getLowerCorner();
+		const int toIdx = localIndex(mins, to);
+		if (_visited[toIdx] != _generation) {
+			return false;
+		}
+		core::List<glm::ivec3> path(_brickSize * _brickSize * _brickSize);
+		for (int idx = toIdx; _parent[idx] != -1; idx = _parent[idx]) {
+			path.insert_front(mins + glm::ivec3(idx % _brickSize, (idx / _brickSize) % _brickSize,
+												idx / (_brickSize * _brickSize)));
+		}
+		for (const glm::ivec3 &p : path) {
+			if (!result.insert(p)) {
+				Log::warn("The path doesn't fit into the result list");
+				return false;
+			}
+		}
+		return true;
+	}
+
+public:
+	/**
+	 * @param isVoxelValidForPath Tells whether the path can pass the given voxel - see
+	 * @c AStarPathfinderParams::isVoxelValidForPath
+	 * @param brickSize The edge length of the bricks in voxels
+	 */
+	HierarchicalPathfinder(const VolumeType *volume, IsVoxelValidForPath isVoxelValidForPath,
+						   voxel::Connectivity connectivity = voxel::Connectivity::TwentySixConnected,
+						   int brickSize = 16)
+		: _volume(volume), _isVoxelValidForPath(core::move(isVoxelValidForPath)), _connectivity(connectivity),
+		  _region(volume->region()), _brickSize(brickSize) {
+		_bricksPerAxis = (_region.getDimensionsInVoxels() + _brickSize - 1) / _brickSize;
+		const size_t brickVoxels = (size_t)_brickSize * _brickSize * _brickSize;
+		_dist.resize(brickVoxels);
+		_parent.resize(brickVoxels);
+		_visited.resize(brickVoxels, 0u);
+		_valid.resize(brickVoxels, 0u);
+
+		// larger connectivities include smaller ones
+		switch (_connectivity) {
+		case voxel::Connectivity::TwentySixConnected:
+			for (int i = 0; i < lengthof(voxel::arrayPathfinderCorners); ++i) {
+				_steps.push_back(Step{voxel::arrayPathfinderCorners[i], glm::root_three<float>()});
+			}
+			/* fallthrough */
+		case voxel::Connectivity::EighteenConnected:
+			for (int i = 0; i < lengthof(voxel::arrayPathfinderEdges); ++i) {
+				_steps.push_back(Step{voxel::arrayPathfinderEdges[i], glm::root_two<float>()});
+			}
+			/* fallthrough */
+		case voxel::Connectivity::SixConnected:
+			for (int i = 0; i < lengthof(voxel::arrayPathfinderFaces); ++i) {
+				_steps.push_back(Step{voxel::arrayPathfinderFaces[i], 1.0f});
+			}
+			break;
+		}
+		clear();
+	}
+
+	/**
+	 * @brief Drops the cached transitions - must be called if the volume was modified
+	 */
+	void clear() {
+		_bricks.clear();
+		_bricks.resize((size_t)_bricksPerAxis.x * _bricksPerAxis.y * _bricksPerAxis.z);
+		_nodes.clear();
+		_nodeIndices.clear();
+		_validBrick = -1;
+	}
+
+	/**
+	 * @return The amount of transition voxels that were computed so far
+	 */
+	inline size_t transitions() const {
+		return _nodes.size();
+	}
+
+	/**
+	 * @param[out] result The voxels of the path including the start and the end position - make sure the max size of
+	 * the list is big enough for the path
+	 * @return @c false if no path was found
+	 */
+	bool execute(const glm::ivec3 &start, const glm::ivec3 &end, core::List<glm::ivec3> &result) {
+		core_trace_scoped(HierarchicalPathfinder);
+		result.clear();
+		if (!_region.containsPoint(start) || !_region.containsPoint(end) || !isValid(end)) {
+			return false;
+		}
+		if (start == end) {
+			result.insert(start);
+			return true;
+		}
+		const glm::ivec3 startBrick = brickPos(start);
+		const glm::ivec3 endBrick = brickPos(end);
+		buildBrick(startBrick);
+		buildBrick(endBrick);
+
+		// the costs from the transitions of the end brick to the end position
+		core::FlatMap<int, float> goalCosts;
+		searchBrick(endBrick, end, nullptr);
+		for (const int n : _bricks[brickIndex(endBrick)].nodes) {
+			float cost;
+			if (reached(endBrick, _nodes[n].pos, cost)) {
+				goalCosts.put(n, cost);
+			}
+		}
+
+		std::vector<float> g;
+		std::vector<int> parent;
+		std::vector<OpenEntry> open;
+		float bestCost = FLT_MAX;
+		int bestParent = -1;
+		auto relax = [&](int node, float cost, int from) {
+			if (g.size() < _nodes.size()) {
+				g.resize(_nodes.size(), FLT_MAX);
+				parent.resize(_nodes.size(), -1);
+			}
+			if (cost >= g[node]) {
+				return;
+			}
+			g[node] = cost;
+			parent[node] = from;
+			open.push_back(OpenEntry{cost + heuristic(_nodes[node].pos, end), node});
+			std::push_heap(open.begin(), open.end());
+		};
+
+		searchBrick(startBrick, start, nullptr);
+		float cost;
+		if (startBrick == endBrick && reached(startBrick, end, cost)) {
+			bestCost = cost;
+			bestParent = StartId;
+		}
+		core::DynamicArray<Edge> startEdges;
+		for (const int n : _bricks[brickIndex(startBrick)].nodes) {
+			if (reached(startBrick, _nodes[n].pos, cost)) {
+				startEdges.push_back(Edge{n, cost});
+			}
+		}
+		for (const Edge &e : startEdges) {
+			relax(e.node, e.cost, StartId);
+		}
+
+		while (!open.empty()) {
+			std::pop_heap(open.begin(), open.end());
+			const OpenEntry entry = open.back();
+			open.pop_back();
+			if (entry.f >= bestCost) {
+				break;
+			}
+			const int n = entry.id;
+			if (entry.f != g[n] + heuristic(_nodes[n].pos, end)) {
+				// outdated entry
+				continue;
+			}
+			if (const float *goalCost = goalCosts.ptr(n)) {
+				if (g[n] + *goalCost < bestCost) {
+					bestCost = g[n] + *goalCost;
+					bestParent = n;
+				}
+			}
+			buildBrick(brickPos(_nodes[n].pos));
+			const float gn = g[n];
+			for (size_t i = 0; i < _nodes[n].edges.size(); ++i) {
+				const Edge e = _nodes[n].edges[i];
+				relax(e.node, gn + e.cost, n);
+			}
+		}
+		if (bestParent == -1) {
+			return false;
+		}
+
+		core::List<glm::ivec3> waypoints((int)_nodes.size() + 1);
+		waypoints.insert_front(end);
+		for (int n = bestParent; n != StartId; n = parent[n]) {
+			waypoints.insert_front(_nodes[n].pos);
+		}
+		result.insert(start);
+		glm::ivec3 from = start;
+		for (const glm::ivec3 &to : waypoints) {
+			if (brickPos(from) != brickPos(to)) {
+				// transition to the neighbour brick
+				if (!result.insert(to)) {
+					Log::warn("The path doesn't fit into the result list");
+					result.clear();
+					return false;
+				}
+			} else if (!appendBrickPath(from, to, result)) {
+				result.clear();
+				return false;
+			}
+			from = to;
+		}
+		return true;
+	}
+};
+
+} // namespace voxelutil
@@ -8,9 +8,13 @@
 #include "core/GLM.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Parallel.h"
 #include "image/Image.h"
 #include "palette/Palette.h"
 #include "palette/PaletteLookup.h"
+#include "palette/PaletteRemap.h"
 #include "voxel/Face.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/RawVolume.h"
@@ -21,8 +25,124 @@
 
 namespace voxelutil {
 
+namespace priv {
+
+/**
+ * @brief Samples the image pixel for every column of the volume region
+ * @param[out] pixels The pixels in x-major order - @c x + @c z * @c width
+ */
+static void sampleColumns(const image::ImagePtr &image, const voxel::Region &region,
+						  core::DynamicArray<core::RGBA> &pixels, core::ThreadPool *threadPool) {
+	core_trace_scoped(SampleColumns);
+	const int volumeWidth = region.getWidthInVoxels();
+	const int volumeDepth = region.getDepthInVoxels();
+	const float stepWidthY = (float)image->height() / (float)volumeDepth;
+	const float stepWidthX = (float)image->width() / (float)volumeWidth;
+	Log::debug("stepwidth: %f %f", stepWidthX, stepWidthY);
+	pixels.resize((size_t)volumeWidth * volumeDepth);
+	const int slices = core::parallelSliceCount(threadPool, volumeDepth);
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		const int lowerZ = volumeDepth * slice / slices;
+		const int upperZ = volumeDepth * (slice + 1) / slices;
+		for (int z = lowerZ; z < upperZ; ++z) {
+			const int imageY = (int)((float)z * stepWidthY);
+			core::RGBA *row = &pixels[(size_t)z * volumeWidth];
+			float imageX = 0.0f;
+			for (int x = 0; x < volumeWidth; ++x, imageX += stepWidthX) {
+				row[x] = image->colorAt((int)imageX, imageY);
+			}
+		}
+	});
+}
+
+/**
+ * @brief Fills the columns of the volume region from the bottom up to the given heights
+ *
+ * The voxels are written directly into the volume - every thread fills a band of columns along the z axis.
+ *
+ * @param heightFunc Returns the height of the column with the given index (@c x + @c z * @c width)
+ * @param surfaceFunc Returns the top voxel of the column with the given index
+ * @param underground The voxel below the top voxel - if this is air, only the top voxels are placed
+ */
+template<class HEIGHTFUNC, class SURFACEFUNC>
+static void fillColumns(voxel::RawVolumeWrapper &wrapper, HEIGHTFUNC &&heightFunc, SURFACEFUNC &&surfaceFunc,
+						const voxel::Voxel &underground, core::ThreadPool *threadPool) {
+	core_trace_scoped(FillColumns);
+	const voxel::Region &region = wrapper.region();
+	voxel::RawVolume *volume = wrapper.volume();
+	const int volumeWidth = region.getWidthInVoxels();
+	const int volumeHeight = region.getHeightInVoxels();
+	const int volumeDepth = region.getDepthInVoxels();
+	const int width = volume->region().getWidthInVoxels();
+	const int stride = volume->region().stride();
+	voxel::Voxel *data = volume->writableRow(region.getLowerCorner());
+	const bool surfaceOnly = voxel::isAir(underground.getMaterial());
+
+	const int slices = core::parallelSliceCount(threadPool, volumeDepth);
+	// the lowest and highest modified y of every slice
+	core::DynamicArray<glm::ivec2> modifiedY;
+	modifiedY.resize(slices);
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		const int lowerZ = volumeDepth * slice / slices;
+		const int upperZ = volumeDepth * (slice + 1) / slices;
+		glm::ivec2 &modified = modifiedY[slice];
+		modified = glm::ivec2(volumeHeight, -1);
+		for (int z = lowerZ; z < upperZ; ++z) {
+			for (int x = 0; x < volumeWidth; ++x) {
+				const int idx = x + z * volumeWidth;
+				const int heightValue = heightFunc(idx);
+				if (heightValue <= 0) {
+					continue;
+				}
+				voxel::Voxel *column = data + x + z * stride;
+				const int surfaceY = heightValue - 1;
+				if (!surfaceOnly) {
+					const int undergroundHeight = glm::min(surfaceY, volumeHeight);
+					for (int y = 0; y < undergroundHeight; ++y) {
+						column[y * width] = underground;
+					}
+					if (undergroundHeight > 0) {
+						modified.x = 0;
+						modified.y = glm::max(modified.y, undergroundHeight - 1);
+					}
+				}
+				if (surfaceY < volumeHeight) {
+					column[surfaceY * width] = surfaceFunc(idx);
+					modified.x = glm::min(modified.x, surfaceY);
+					modified.y = glm::max(modified.y, surfaceY);
+				}
+			}
+		}
+	});
+
+	glm::ivec2 modified(volumeHeight, -1);
+	for (const glm::ivec2 &m : modifiedY) {
+		modified.x = glm::min(modified.x, m.x);
+		modified.y = glm::max(modified.y, m.y);
+	}
+	if (modified.y < modified.x) {
+		return;
+	}
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	const voxel::Region dirtyRegion(mins.x, mins.y + modified.x, mins.z, maxs.x, mins.y + modified.y, maxs.z);
+	wrapper.addDirtyRegion(dirtyRegion);
+	if (volume->occupancy() == nullptr) {
+		return;
+	}
+	for (int z = dirtyRegion.getLowerZ(); z <= dirtyRegion.getUpperZ(); ++z) {
+		for (int y = dirtyRegion.getLowerY(); y <= dirtyRegion.getUpperY(); ++y) {
+			volume->updateOccupancy(glm::ivec3(volume->region().getLowerX(), y, z));
+		}
+	}
+}
+
+} // namespace priv
+
 bool importFace(voxel::RawVolumeWrapper &volume, const voxel::Region &region, const palette::Palette &palette, voxel::FaceNames faceName,
-				const image::ImagePtr &image, const glm::vec2 &uv0, const glm::vec2 &uv1, uint8_t replacementPalIdx) {
+				const image::ImagePtr &image, const glm::vec2 &uv0, const glm::vec2 &uv1, uint8_t replacementPalIdx,
+				core::ThreadPool *threadPool) {
+	core_trace_scoped(ImportFace);
 	const glm::ivec3 &mins = region.getLowerCorner();
 	const glm::ivec3 &maxs = region.getUpperCorner();
 	const math::Axis axis = faceToAxis(faceName);
@@ -43,20 +163,39 @@ bool importFace(voxel::RawVolumeWrapper &volume, const voxel::Region &region, co
 	const bool flipV = false;
 	const image::TextureWrap wrapS = flipU ? image::TextureWrap::MirroredRepeat : image::Repeat;
 	const image::TextureWrap wrapT = flipV ? image::TextureWrap::MirroredRepeat : image::Repeat;
+	const int size1 = axisMaxs1 - axisMins1 + 1;
+	const int size2 = axisMaxs2 - axisMins2 + 1;
+
+	core::DynamicArray<int> palIndices;
+	if (image) {
+		core::DynamicArray<core::RGBA> colors;
+		colors.resize((size_t)size1 * size2);
+		const int slices = core::parallelSliceCount(threadPool, size1);
+		core::parallelSlices(threadPool, slices, [&](int slice) {
+			const int lower = size1 * slice / slices;
+			const int upper = size1 * (slice + 1) / slices;
+			for (int i1 = lower; i1 < upper; ++i1) {
+				const float axis1Factor = ((float)i1 + 0.5f) / (float)size[axisIdx1];
+				for (int i2 = 0; i2 < size2; ++i2) {
+					const float axis2Factor = ((float)i2 + 0.5f) / (float)size[axisIdx2];
+					glm::vec2 uv;
+					uv[axisIdxUV1] = glm::mix(flipU ? -uv0[axisIdxUV1] : uv0[axisIdxUV1],
+											  flipV ? -uv1[axisIdxUV1] : uv1[axisIdxUV1], axis1Factor);
+					uv[axisIdxUV2] = glm::mix(flipU ? -uv0[axisIdxUV2] : uv0[axisIdxUV2],
+											  flipV ? -uv1[axisIdxUV2] : uv1[axisIdxUV2], axis2Factor);
+					colors[(size_t)i1 * size2 + i2] = image->colorAt(uv, wrapS, wrapT);
+				}
+			}
+		});
+		palIndices.resize(colors.size());
+		palette::remapColors(palette, colors.data(), colors.size(), palIndices.data(), threadPool);
+	}
 
 	for (int axis1 = axisMins1; axis1 <= axisMaxs1; ++axis1) {
-		const float axis1Factor = ((float)(axis1 - axisMins1) + 0.5f) / (float)size[axisIdx1];
 		for (int axis2 = axisMins2; axis2 <= axisMaxs2; ++axis2) {
 			int palIdx = replacementPalIdx;
 			if (image) {
-				const float axis2Factor = ((float)(axis2 - axisMins2) + 0.5f) / (float)size[axisIdx2];
-				glm::vec2 uv;
-				uv[axisIdxUV1] = glm::mix(flipU ? -uv0[axisIdxUV1] : uv0[axisIdxUV1],
-										  flipV ? -uv1[axisIdxUV1] : uv1[axisIdxUV1], axis1Factor);
-				uv[axisIdxUV2] = glm::mix(flipU ? -uv0[axisIdxUV2] : uv0[axisIdxUV2],
-										  flipV ? -uv1[axisIdxUV2] : uv1[axisIdxUV2], axis2Factor);
-				const core::RGBA color = image->colorAt(uv, wrapS, wrapT);
-				palIdx = palette.getClosestMatch(color);
+				palIdx = palIndices[(size_t)(axis1 - axisMins1) * size2 + (axis2 - axisMins2)];
 				if (palIdx == palette::PaletteColorNotFound) {
 					palIdx = replacementPalIdx;
 				}
@@ -71,27 +210,34 @@ bool importFace(voxel::RawVolumeWrapper &volume, const voxel::Region &region, co
 	return true;
 }
 
-int importHeightMaxHeight(const image::ImagePtr &image, bool alphaAsHeight) {
+int importHeightMaxHeight(const image::ImagePtr &image, bool alphaAsHeight, core::ThreadPool *threadPool) {
+	core_trace_scoped(ImportHeightMaxHeight);
 	const int w = image->width();
 	const int h = image->height();
-	int maxHeight = 0;
-	int minHeight = 255;
-	if (alphaAsHeight) {
-		for (int x = 0; x < w; ++x) {
-			for (int y = 0; y < h; ++y) {
-				const uint8_t alphaVal = image->colorAt(x, y).a;
-				maxHeight = core_max(maxHeight, alphaVal);
-				minHeight = core_min(minHeight, alphaVal);
-			}
-		}
-	} else {
-		for (int x = 0; x < w; ++x) {
-			for (int y = 0; y < h; ++y) {
-				const uint8_t redVal = image->colorAt(x, y).r;
-				maxHeight = core_max(maxHeight, redVal);
-				minHeight = core_min(minHeight, redVal);
+	const int slices = core::parallelSliceCount(threadPool, h);
+	// the lowest and highest height of every slice
+	core::DynamicArray<glm::ivec2> heights;
+	heights.resize(slices);
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		const int lowerY = h * slice / slices;
+		const int upperY = h * (slice + 1) / slices;
+		int maxHeight = 0;
+		int minHeight = 255;
+		for (int y = lowerY; y < upperY; ++y) {
+			for (int x = 0; x < w; ++x) {
+				const core::RGBA color = image->colorAt(x, y);
+				const uint8_t heightVal = alphaAsHeight ? color.a : color.r;
+				maxHeight = core_max(maxHeight, heightVal);
+				minHeight = core_min(minHeight, heightVal);
 			}
 		}
+		heights[slice] = glm::ivec2(minHeight, maxHeight);
+	});
+	int maxHeight = 0;
+	int minHeight = 255;
+	for (const glm::ivec2 &height : heights) {
+		minHeight = core_min(minHeight, height.x);
+		maxHeight = core_max(maxHeight, height.y);
 	}
 	if (maxHeight == minHeight) {
 		return 1;
@@ -101,109 +247,60 @@ int importHeightMaxHeight(const image::ImagePtr &image, bool alphaAsHeight) {
 
 void importColoredHeightmap(voxel::RawVolumeWrapper &volume, palette::PaletteLookup &palLookup,
 							const image::ImagePtr &image, const voxel::Voxel &underground, uint8_t minHeight,
-							bool adoptHeight) {
-	const int imageWidth = image->width();
-	const int imageHeight = image->height();
+							bool adoptHeight, core::ThreadPool *threadPool) {
+	core_trace_scoped(ImportColoredHeightmap);
 	const voxel::Region &region = volume.region();
 	const int volumeHeight = region.getHeightInVoxels();
-	const int volumeWidth = region.getWidthInVoxels();
-	const int volumeDepth = region.getDepthInVoxels();
-	const glm::ivec3 &mins = region.getLowerCorner();
-	const float stepWidthY = (float)imageHeight / (float)volumeDepth;
-	const float stepWidthX = (float)imageWidth / (float)volumeWidth;
 	const float scaleHeight = adoptHeight ? (float)volumeHeight / (float)255.0f : 1.0f;
-	float imageY = 0.0f;
-	for (int z = 0; z < volumeDepth; ++z, imageY += stepWidthY) {
-		float imageX = 0.0f;
-		for (int x = 0; x < volumeWidth; ++x, imageX += stepWidthX) {
-			const core::RGBA heightmapPixel = image->colorAt((int)imageX, (int)imageY);
-			uint8_t heightValue = (uint8_t)(glm::round((float)(heightmapPixel.a) * scaleHeight));
-			if (heightValue < minHeight) {
-				heightValue = minHeight;
-			}
+	core::DynamicArray<core::RGBA> pixels;
+	priv::sampleColumns(image, region, pixels, threadPool);
 
-			if (voxel::isAir(underground.getMaterial())) {
-				const glm::ivec3 pos(x, heightValue - 1, z);
-				const glm::ivec3 regionPos = mins + pos;
-				if (!region.containsPoint(regionPos)) {
-					continue;
-				}
-				const uint8_t palidx =
-					palLookup.findClosestIndex(core::RGBA(heightmapPixel.r, heightmapPixel.g, heightmapPixel.b));
-				const voxel::Voxel voxel = voxel::createVoxel(palLookup.palette(), palidx);
-				volume.setVoxel(regionPos, voxel);
-			} else {
-				for (int y = 0; y < heightValue; ++y) {
-					const glm::ivec3 pos(x, y, z);
-					const glm::ivec3 regionPos = mins + pos;
-					if (!region.containsPoint(regionPos)) {
-						continue;
-					}
-					voxel::Voxel voxel;
-					if (y < heightValue - 1) {
-						voxel = underground;
-					} else {
-						const uint8_t palidx = palLookup.findClosestIndex(
-							core::RGBA(heightmapPixel.r, heightmapPixel.g, heightmapPixel.b));
-						voxel = voxel::createVoxel(palLookup.palette(), palidx);
-					}
-					volume.setVoxel(regionPos, voxel);
-				}
-			}
+	auto heightFunc = [&](int idx) {
+		const uint8_t heightValue = (uint8_t)(glm::round((float)(pixels[idx].a) * scaleHeight));
+		return (int)core_max(heightValue, minHeight);
+	};
+
+	// only the colors of the top voxels that are inside the region are needed
+	core::DynamicArray<core::RGBA> colors;
+	core::DynamicArray<int> colorIndices;
+	colors.reserve(pixels.size());
+	colorIndices.resize(pixels.size());
+	for (size_t i = 0; i < pixels.size(); ++i) {
+		const int heightValue = heightFunc((int)i);
+		if (heightValue <= 0 || heightValue > volumeHeight) {
+			colorIndices[i] = -1;
+			continue;
 		}
+		colorIndices[i] = (int)colors.size();
+		colors.push_back(core::RGBA(pixels[i].r, pixels[i].g, pixels[i].b));
 	}
+	core::DynamicArray<int> palIndices;
+	palIndices.resize(colors.size());
+	palette::remapColors(palLookup.palette(), colors.data(), colors.size(), palIndices.data(), threadPool);
+
+	const palette::Palette &palette = palLookup.palette();
+	auto surfaceFunc = [&](int idx) {
+		return voxel::createVoxel(palette, (uint8_t)palIndices[colorIndices[idx]]);
+	};
+	priv::fillColumns(volume, heightFunc, surfaceFunc, underground, threadPool);
 }
 
 void importHeightmap(voxel::RawVolumeWrapper &volume, const image::ImagePtr &image, const voxel::Voxel &underground,
-					 const voxel::Voxel &surface, uint8_t minHeight, bool adoptHeight) {
-	const int imageWidth = image->width();
-	const int imageHeight = image->height();
+					 const voxel::Voxel &surface, uint8_t minHeight, bool adoptHeight, core::ThreadPool *threadPool) {
+	core_trace_scoped(ImportHeightmap);
 	const voxel::Region &region = volume.region();
 	const int volumeHeight = region.getHeightInVoxels();
-	const int volumeWidth = region.getWidthInVoxels();
-	const int volumeDepth = region.getDepthInVoxels();
-	const glm::ivec3 &mins = region.getLowerCorner();
-	const float stepWidthY = (float)imageHeight / (float)volumeDepth;
-	const float stepWidthX = (float)imageWidth / (float)volumeWidth;
-	Log::debug("stepwidth: %f %f", stepWidthX, stepWidthY);
-	const int maxImageHeight = importHeightMaxHeight(image, true);
+	const int maxImageHeight = importHeightMaxHeight(image, true, threadPool);
 	const float scaleHeight = adoptHeight ? (float)volumeHeight / (float)maxImageHeight : 1.0f;
-	float imageY = 0.0f;
-	// TODO: use a volume sampler
-	for (int z = 0; z < volumeDepth; ++z, imageY += stepWidthY) {
-		float imageX = 0.0f;
-		for (int x = 0; x < volumeWidth; ++x, imageX += stepWidthX) {
-			const core::RGBA heightmapPixel = image->colorAt((int)imageX, (int)imageY);
-			uint8_t heightValue = (uint8_t)(glm::round((float)(heightmapPixel.r) * scaleHeight));
-			if (heightValue < minHeight) {
-				heightValue = minHeight;
-			}
+	core::DynamicArray<core::RGBA> pixels;
+	priv::sampleColumns(image, region, pixels, threadPool);
 
-			if (voxel::isAir(underground.getMaterial())) {
-				const glm::ivec3 pos(x, heightValue - 1, z);
-				const glm::ivec3 regionPos = mins + pos;
-				if (!region.containsPoint(regionPos)) {
-					continue;
-				}
-				volume.setVoxel(regionPos, surface);
-			} else {
-				for (int y = 0; y < heightValue; ++y) {
-					const glm::ivec3 pos(x, y, z);
-					const glm::ivec3 regionPos = mins + pos;
-					if (!region.containsPoint(regionPos)) {
-						continue;
-					}
-					voxel::Voxel voxel;
-					if (y < heightValue - 1) {
-						voxel = underground;
-					} else {
-						voxel = surface;
-					}
-					volume.setVoxel(regionPos, voxel);
-				}
-			}
-		}
-	}
+	auto heightFunc = [&](int idx) {
+		const uint8_t heightValue = (uint8_t)(glm::round((float)(pixels[idx].r) * scaleHeight));
+		return (int)core_max(heightValue, minHeight);
+	};
+	auto surfaceFunc = [&](int) { return surface; };
+	priv::fillColumns(volume, heightFunc, surfaceFunc, underground, threadPool);
 }
 
 voxel::RawVolume *importAsPlane(const image::ImagePtr &image, uint8_t thickness) {
@@ -215,11 +312,14 @@ voxel::RawVolume *importAsPlane(const image::Image *image, uint8_t thickness) {
 	return importAsPlane(image, palette, thickness);
 }
 
-voxel::RawVolume *importAsPlane(const image::ImagePtr &image, const palette::Palette &palette, uint8_t thickness) {
-	return importAsPlane(image.get(), palette, thickness);
+voxel::RawVolume *importAsPlane(const image::ImagePtr &image, const palette::Palette &palette, uint8_t thickness,
+							   bool dither, core::ThreadPool *threadPool) {
+	return importAsPlane(image.get(), palette, thickness, dither, threadPool);
 }
 
-voxel::RawVolume *importAsPlane(const image::Image *image, const palette::Palette &palette, uint8_t thickness) {
+voxel::RawVolume *importAsPlane(const image::Image *image, const palette::Palette &palette, uint8_t thickness,
+							   bool dither, core::ThreadPool *threadPool) {
+	core_trace_scoped(ImportAsPlane);
 	if (thickness <= 0) {
 		Log::error("Thickness can't be 0");
 		return nullptr;
@@ -241,14 +341,23 @@ voxel::RawVolume *importAsPlane(const image::Image *image, const palette::Palett
 	}
 	Log::debug("Import image as plane: w(%i), h(%i), d(%i)", imageWidth, imageHeight, thickness);
 	const voxel::Region region(0, 0, 0, imageWidth - 1, imageHeight - 1, thickness - 1);
+	// the image is rgba - the pixels can be remapped as one stream
+	const core::RGBA *pixels = (const core::RGBA *)image->data();
+	core::DynamicArray<int> palIndices;
+	palIndices.resize((size_t)imageWidth * imageHeight);
+	if (dither) {
+		palette::remapColorsDithered(palette, pixels, imageWidth, imageHeight, palIndices.data(), threadPool);
+	} else {
+		palette::remapColors(palette, pixels, palIndices.size(), palIndices.data(), threadPool);
+	}
 	voxel::RawVolume *volume = new voxel::RawVolume(region);
 	for (int x = 0; x < imageWidth; ++x) {
 		for (int y = 0; y < imageHeight; ++y) {
-			const core::RGBA data = image->colorAt(x, y);
-			if (data.a == 0) {
+			const size_t pixelIdx = (size_t)y * imageWidth + x;
+			if (pixels[pixelIdx].a == 0) {
 				continue;
 			}
-			const uint8_t index = palette.getClosestMatch(data);
+			const uint8_t index = palIndices[pixelIdx];
 			const voxel::Voxel voxel = voxel::createVoxel(palette, index);
 			for (int z = 0; z < thickness; ++z) {
 				volume->setVoxel(x, (imageHeight - 1) - y, z, voxel);
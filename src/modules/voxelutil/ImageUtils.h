@@ -7,6 +7,10 @@
 #include "image/Image.h"
 #include "voxel/Face.h"
 
+namespace core {
+class ThreadPool;
+}
+
 namespace voxel {
 class RawVolumeWrapper;
 class RawVolume;
@@ -23,22 +27,29 @@ namespace voxelutil {
 
 /**
  * @brief Import a heightmap with rgb being the surface color and alpha channel being the height
+ *
+ * The colors are matched against the palette once per unique color. The columns are filled in bands along the z axis
+ * on the given thread pool.
  */
-void importColoredHeightmap(voxel::RawVolumeWrapper& volume, palette::PaletteLookup &palLookup, const image::ImagePtr& image, const voxel::Voxel &underground, uint8_t minHeight = 0, bool adoptHeight = true);
-void importHeightmap(voxel::RawVolumeWrapper& volume, const image::ImagePtr& image, const voxel::Voxel &underground, const voxel::Voxel &surface, uint8_t minHeight = 0, bool adoptHeight = true);
+void importColoredHeightmap(voxel::RawVolumeWrapper& volume, palette::PaletteLookup &palLookup, const image::ImagePtr& image, const voxel::Voxel &underground, uint8_t minHeight = 0, bool adoptHeight = true, core::ThreadPool *threadPool = nullptr);
+void importHeightmap(voxel::RawVolumeWrapper& volume, const image::ImagePtr& image, const voxel::Voxel &underground, const voxel::Voxel &surface, uint8_t minHeight = 0, bool adoptHeight = true, core::ThreadPool *threadPool = nullptr);
 /**
  * @param alphaAsHeight If this is @c true, the rgb color is used for the colors - otherwise the red channel is used
  * (because a gray scale image is expected)
  */
-int importHeightMaxHeight(const image::ImagePtr &image, bool alphaAsHeight);
-[[nodiscard]] voxel::RawVolume* importAsPlane(const image::ImagePtr& image, const palette::Palette &palette, uint8_t thickness = 1);
+int importHeightMaxHeight(const image::ImagePtr &image, bool alphaAsHeight, core::ThreadPool *threadPool = nullptr);
+/**
+ * @param dither Distribute the color error to the neighbouring pixels (Floyd-Steinberg) - useful for images with
+ * gradients and palettes with only a few colors
+ */
+[[nodiscard]] voxel::RawVolume* importAsPlane(const image::ImagePtr& image, const palette::Palette &palette, uint8_t thickness = 1, bool dither = false, core::ThreadPool *threadPool = nullptr);
 [[nodiscard]] voxel::RawVolume* importAsPlane(const image::ImagePtr& image, uint8_t thickness = 1);
-[[nodiscard]] voxel::RawVolume* importAsPlane(const image::Image *image, const palette::Palette &palette, uint8_t thickness = 1);
+[[nodiscard]] voxel::RawVolume* importAsPlane(const image::Image *image, const palette::Palette &palette, uint8_t thickness = 1, bool dither = false, core::ThreadPool *threadPool = nullptr);
 [[nodiscard]] voxel::RawVolume* importAsPlane(const image::Image *image, uint8_t thickness = 1);
 core::String getDefaultDepthMapFile(const core::String &imageName, const core::String &postfix = "-dm");
 [[nodiscard]] voxel::RawVolume* importAsVolume(const image::ImagePtr& image, const palette::Palette &palette, uint8_t maxDepth, bool bothSides = false);
 [[nodiscard]] voxel::RawVolume* importAsVolume(const image::ImagePtr& image, const image::ImagePtr& depthMap, const palette::Palette &palette, uint8_t maxDepth, bool bothSides = false);
 [[nodiscard]] voxel::RawVolume* importAsVolume(const image::ImagePtr& image, uint8_t maxDepth, bool bothSides = false);
-bool importFace(voxel::RawVolumeWrapper &volume, const voxel::Region &region, const palette::Palette &palette, voxel::FaceNames faceName, const image::ImagePtr &image, const glm::vec2 &uv0, const glm::vec2 &uv1, uint8_t replacementPalIdx = 0);
+bool importFace(voxel::RawVolumeWrapper &volume, const voxel::Region &region, const palette::Palette &palette, voxel::FaceNames faceName, const image::ImagePtr &image, const glm::vec2 &uv0, const glm::vec2 &uv1, uint8_t replacementPalIdx = 0, core::ThreadPool *threadPool = nullptr);
 
 }
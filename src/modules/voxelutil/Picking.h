@@ -9,6 +9,7 @@
 #include "voxel/Voxel.h"
 #include "Raycast.h"
 #include "voxel/Face.h"
+#include "voxel/RawVolume.h"
 
 namespace voxelutil {
 
@@ -87,4 +88,43 @@ PickResult pickVoxel(const VolumeType* volData, const glm::vec3& v3dStart, const
 	return functor._result;
 }
 
+/**
+ * @brief Pick the first solid voxel along a vector - the empty bricks of volumes with an occupancy mask are skipped
+ * @note Only the positions inside the region of the volume are reported as @c previousPosition
+ * @sa raycastSkipEmpty()
+ */
+inline PickResult pickVoxel(const voxel::RawVolume *volData, const glm::vec3 &v3dStart,
+							const glm::vec3 &v3dDirectionAndLength, const voxel::Voxel &emptyVoxelExample) {
+	if (volData->occupancy() == nullptr || emptyVoxelExample != voxel::Voxel()) {
+		return pickVoxel<voxel::RawVolume>(volData, v3dStart, v3dDirectionAndLength, emptyVoxelExample);
+	}
+	core_trace_scoped(pickVoxelSkipEmpty);
+	PickResult result;
+	raycastSkipEmpty(volData, v3dStart, v3dStart + v3dDirectionAndLength, [&](const glm::ivec3 &pos) {
+		if (volData->voxel(pos) != emptyVoxelExample) {
+			result.didHit = true;
+			result.hitVoxel = pos;
+			return false;
+		}
+		result.validPreviousPosition = true;
+		result.previousPosition = pos;
+		return true;
+	});
+	return result;
+}
+
+/**
+ * @brief Pick the first solid voxel for several rays - e.g. for the pixels of a selection rectangle
+ * @note The volume is only read - so the rays can get split into ranges that are picked in parallel
+ * @param[out] results Must have space for @c amount entries
+ */
+inline void pickVoxels(const voxel::RawVolume *volData, const glm::vec3 *starts,
+					   const glm::vec3 *directionsAndLengths, size_t amount, const voxel::Voxel &emptyVoxelExample,
+					   PickResult *results) {
+	core_trace_scoped(pickVoxels);
+	for (size_t i = 0; i < amount; ++i) {
+		results[i] = pickVoxel(volData, starts[i], directionsAndLengths[i], emptyVoxelExample);
+	}
+}
+
 }
@@ -5,10 +5,16 @@
 #pragma once
 
 #include "core/Trace.h"
+#include "voxel/OccupancyMask.h"
 #include "voxel/RawVolume.h"
 #include "core/Common.h"
 #include <glm/ext/scalar_constants.hpp>
 #include <glm/common.hpp>
+#include <float.h>
+
+namespace voxel {
+class SparseVolume;
+}
 
 namespace voxelutil {
 namespace RaycastResults {
@@ -193,6 +199,11 @@ inline RaycastResult raycastWithEndpointsVolume(voxel::RawVolume* volData, const
 	return raycastWithEndpoints(volData, v3dStart, v3dEnd, callback);
 }
 
+template<typename Callback>
+inline RaycastResult raycastWithEndpointsVolume(voxel::SparseVolume* volData, const glm::vec3& v3dStart, const glm::vec3& v3dEnd, Callback&& callback) {
+	return raycastWithEndpoints(volData, v3dStart, v3dEnd, callback);
+}
+
 /**
  * Cast a ray through a volume by specifying the start and a direction
  *
@@ -223,4 +234,184 @@ RaycastResult raycastWithDirection(Volume* volData, const glm::vec3& v3dStart, c
 	return raycastWithEndpoints<Callback, Volume>(volData, v3dStart, v3dEnd, core::forward<Callback>(callback));
 }
 
+/**
+ * @brief Clips the segment from @a v3dStart to @a v3dEnd to the given region grown by @a border voxels
+ *
+ * A ray that starts far outside of a volume - e.g. at the camera position - visits a lot of voxels before it reaches
+ * the volume. Passing the clipped end points to raycastWithEndpoints() skips them - the voxels that are visited inside
+ * of the grown region are the same.
+ *
+ * @return @c false if the segment doesn't touch the grown region - the end points are not modified in this case
+ */
+inline bool clipRayToRegion(const voxel::Region &region, int border, glm::vec3 &v3dStart, glm::vec3 &v3dEnd) {
+	const glm::vec3 lower = glm::vec3(region.getLowerCorner() - border);
+	const glm::vec3 upper = glm::vec3(region.getUpperCorner() + border) + 1.0f;
+	const glm::vec3 delta = v3dEnd - v3dStart;
+	float tEnter = 0.0f;
+	float tLeave = 1.0f;
+	for (int a = 0; a < 3; ++a) {
+		if (delta[a] == 0.0f) {
+			if (v3dStart[a] < lower[a] || v3dStart[a] >= upper[a]) {
+				return false;
+			}
+			continue;
+		}
+		float t0 = (lower[a] - v3dStart[a]) / delta[a];
+		float t1 = (upper[a] - v3dStart[a]) / delta[a];
+		if (t0 > t1) {
+			core::exchange(t0, t1);
+		}
+		tEnter = core_max(tEnter, t0);
+		tLeave = core_min(tLeave, t1);
+	}
+	if (tEnter > tLeave) {
+		return false;
+	}
+	const glm::vec3 start = v3dStart;
+	v3dStart = start + delta * tEnter;
+	v3dEnd = start + delta * tLeave;
+	return true;
+}
+
+/**
+ * Cast a ray through the region of a volume and skip the empty bricks of the occupancy mask of the volume at once
+ *
+ * Unlike raycastWithEndpoints() the ray is clipped to the region of the volume and the callback doesn't get every
+ * voxel along the ray: for the bricks of the mask without any solid voxel only the voxel where the ray enters the
+ * brick and the voxel where it leaves the brick are reported. This means that the last position before a solid
+ * voxel is still reported. Without an occupancy mask every voxel along the ray is reported.
+ *
+ * @param volData The volume to pass the ray though
+ * @param v3dStart The start position
+ * @param v3dEnd The end position
+ * @param callback @c bool(const glm::ivec3 &pos) - return @c false to stop the ray
+ *
+ * @return A RaycastResults designating whether the ray hit anything or not
+ * @sa voxel::RawVolume::setOccupancyTracking()
+ */
+template<typename Callback>
+RaycastResult raycastSkipEmpty(const voxel::RawVolume *volData, const glm::vec3 &v3dStart, const glm::vec3 &v3dEnd,
+							   Callback &&callback) {
+	core_trace_scoped(raycastSkipEmpty);
+	const voxel::Region &region = volData->region();
+	const glm::ivec3 &lower = region.getLowerCorner();
+	const glm::ivec3 &upper = region.getUpperCorner();
+	const glm::vec3 delta = v3dEnd - v3dStart;
+
+	glm::ivec3 step;
+	glm::vec3 deltat;
+	// clip the ray to the region
+	float tEnter = 0.0f;
+	float tLeave = 1.0f;
+	for (int a = 0; a < 3; ++a) {
+		step[a] = delta[a] > 0.0f ? 1 : (delta[a] < 0.0f ? -1 : 0);
+		if (step[a] == 0) {
+			if (v3dStart[a] < (float)lower[a] || v3dStart[a] >= (float)upper[a] + 1.0f) {
+				return RaycastResults::Completed;
+			}
+			deltat[a] = FLT_MAX;
+			continue;
+		}
+		deltat[a] = 1.0f / glm::abs(delta[a]);
+		float t0 = ((float)lower[a] - v3dStart[a]) / delta[a];
+		float t1 = ((float)upper[a] + 1.0f - v3dStart[a]) / delta[a];
+		if (t0 > t1) {
+			core::exchange(t0, t1);
+		}
+		tEnter = core_max(tEnter, t0);
+		tLeave = core_min(tLeave, t1);
+	}
+	if (tEnter > tLeave) {
+		return RaycastResults::Completed;
+	}
+
+	// the parameter of the ray where the next voxel boundary is crossed
+	auto boundaries = [&](const glm::ivec3 &pos) {
+		glm::vec3 tMax;
+		for (int a = 0; a < 3; ++a) {
+			if (step[a] == 0) {
+				tMax[a] = FLT_MAX;
+			} else {
+				const float boundary = (float)(step[a] > 0 ? pos[a] + 1 : pos[a]);
+				tMax[a] = (boundary - v3dStart[a]) / delta[a];
+			}
+		}
+		return tMax;
+	};
+
+	glm::ivec3 pos = glm::clamp(glm::ivec3(glm::floor(v3dStart + delta * tEnter)), lower, upper);
+	glm::vec3 tMax = boundaries(pos);
+	const voxel::OccupancyMask *mask = volData->occupancy();
+	for (;;) {
+		if (!callback(pos)) {
+			return RaycastResults::Interupted;
+		}
+		if (mask != nullptr) {
+			const glm::ivec3 local = pos - lower;
+			if (mask->isBrickEmpty(local.x, local.y, local.z)) {
+				const glm::ivec3 brickMins = mask->brickMins(local) + lower;
+				const glm::ivec3 brickMaxs =
+					glm::min(brickMins + glm::ivec3(voxel::OccupancyMask::BrickWidth, voxel::OccupancyMask::BrickRows,
+													voxel::OccupancyMask::BrickRows) - 1,
+							 upper);
+				float tExit = FLT_MAX;
+				int exitAxis = -1;
+				for (int a = 0; a < 3; ++a) {
+					if (step[a] == 0) {
+						continue;
+					}
+					const float boundary = (float)(step[a] > 0 ? brickMaxs[a] + 1 : brickMins[a]);
+					const float t = (boundary - v3dStart[a]) / delta[a];
+					if (t < tExit) {
+						tExit = t;
+						exitAxis = a;
+					}
+				}
+				if (exitAxis == -1) {
+					return RaycastResults::Completed;
+				}
+				// the last voxel of the brick along the ray
+				const bool leaveBrick = tExit < tLeave;
+				const glm::vec3 exitPos = v3dStart + delta * (leaveBrick ? tExit : tLeave);
+				glm::ivec3 last = glm::clamp(glm::ivec3(glm::floor(exitPos)), brickMins, brickMaxs);
+				if (leaveBrick) {
+					last[exitAxis] = step[exitAxis] > 0 ? brickMaxs[exitAxis] : brickMins[exitAxis];
+				}
+				if (last != pos && !callback(last)) {
+					return RaycastResults::Interupted;
+				}
+				if (!leaveBrick) {
+					break;
+				}
+				pos = last;
+				pos[exitAxis] += step[exitAxis];
+				if (!region.containsPoint(pos)) {
+					break;
+				}
+				tMax = boundaries(pos);
+				continue;
+			}
+		}
+
+		int axis;
+		if (tMax.x <= tMax.y && tMax.x <= tMax.z) {
+			axis = 0;
+		} else if (tMax.y <= tMax.z) {
+			axis = 1;
+		} else {
+			axis = 2;
+		}
+		if (tMax[axis] > tLeave) {
+			break;
+		}
+		pos[axis] += step[axis];
+		tMax[axis] += deltat[axis];
+		if (!region.containsPoint(pos)) {
+			break;
+		}
+	}
+
+	return RaycastResults::Completed;
+}
+
 }
@@ -0,0 +1,30 @@
+/**
+ * @file
+ */
+
+#include "ScanlineFill.h"
+
+namespace voxelutil {
+
+ScanlineFill::ScanlineFill(const voxel::Region &region)
+	: _region(region), _mins(region.getLowerCorner()), _width(region.getWidthInVoxels()),
+	  _height(region.getHeightInVoxels()), _depth(region.getDepthInVoxels()), _mask(_width * _height * _depth) {
+}
+
+void ScanlineFill::pushRuns(int x0, int x1, int y, int z) {
+	if (y < 0 || y >= _height || z < 0 || z >= _depth) {
+		return;
+	}
+	const size_t rowIdx = index(0, y, z);
+	bool inRun = false;
+	for (int x = x0; x <= x1; ++x) {
+		if (_mask[rowIdx + x]) {
+			inRun = false;
+		} else if (!inRun) {
+			_stack.emplace_back(x, y, z);
+			inRun = true;
+		}
+	}
+}
+
+} // namespace voxelutil
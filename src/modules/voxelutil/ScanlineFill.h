@@ -0,0 +1,117 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Common.h"
+#include "core/NonCopyable.h"
+#include "core/Trace.h"
+#include "core/collection/BitSet.h"
+#include "core/collection/DynamicArray.h"
+#include "voxel/Region.h"
+#include <glm/vec3.hpp>
+
+namespace voxelutil {
+
+/**
+ * @brief Span based flood fill over a bit mask of a region
+ *
+ * The voxels are filled in runs along the x axis - the work list only contains one entry per run in the neighbouring
+ * rows instead of one entry per voxel. Together with the bit mask this keeps the memory usage at a fraction of a voxel
+ * based fill for large volumes.
+ *
+ * The fill uses the 6-neighbourhood and doesn't enter voxels that are already marked. All coordinates are given in
+ * the coordinates of the region.
+ */
+class ScanlineFill : public core::NonCopyable {
+private:
+	const voxel::Region _region;
+	const glm::ivec3 _mins;
+	const int _width;
+	const int _height;
+	const int _depth;
+	core::BitSet _mask;
+	core::DynamicArray<glm::ivec3> _stack;
+
+	inline size_t index(int x, int y, int z) const {
+		return (size_t)x + (size_t)_width * ((size_t)y + (size_t)_height * (size_t)z);
+	}
+
+	/**
+	 * @brief Pushes one seed for every run of free voxels of the given row between @c x0 and @c x1 (local
+	 * coordinates)
+	 */
+	void pushRuns(int x0, int x1, int y, int z);
+
+public:
+	ScanlineFill(const voxel::Region &region);
+
+	inline const voxel::Region &region() const {
+		return _region;
+	}
+
+	/**
+	 * @brief Marks the given voxel - the fill doesn't enter marked voxels
+	 */
+	inline void mark(int x, int y, int z) {
+		_mask.set(index(x - _mins.x, y - _mins.y, z - _mins.z), true);
+	}
+
+	/**
+	 * @return @c true if the voxel was marked or already filled
+	 */
+	inline bool marked(int x, int y, int z) const {
+		return _mask[index(x - _mins.x, y - _mins.y, z - _mins.z)];
+	}
+
+	/**
+	 * @brief Fills all voxels that are connected to the given seed and not yet marked
+	 * @param func @c void(int x0, int x1, int y, int z) called for every filled run from @c x0 to @c x1 (inclusive)
+	 * @return The amount of filled voxels
+	 */
+	template<class FUNC>
+	int fill(const glm::ivec3 &seed, FUNC &&func) {
+		core_trace_scoped(ScanlineFill);
+		if (!_region.containsPoint(seed) || marked(seed.x, seed.y, seed.z)) {
+			return 0;
+		}
+		int filled = 0;
+		_stack.clear();
+		_stack.push_back(seed - _mins);
+		while (!_stack.empty()) {
+			const glm::ivec3 p = _stack.back();
+			_stack.pop();
+			if (_mask[index(p.x, p.y, p.z)]) {
+				continue;
+			}
+			int x0 = p.x;
+			while (x0 > 0 && !_mask[index(x0 - 1, p.y, p.z)]) {
+				--x0;
+			}
+			int x1 = p.x;
+			while (x1 < _width - 1 && !_mask[index(x1 + 1, p.y, p.z)]) {
+				++x1;
+			}
+			const size_t rowIdx = index(0, p.y, p.z);
+			for (int x = x0; x <= x1; ++x) {
+				_mask.set(rowIdx + x, true);
+			}
+			filled += x1 - x0 + 1;
+			func(x0 + _mins.x, x1 + _mins.x, p.y + _mins.y, p.z + _mins.z);
+
+			pushRuns(x0, x1, p.y - 1, p.z);
+			pushRuns(x0, x1, p.y + 1, p.z);
+			pushRuns(x0, x1, p.y, p.z - 1);
+			pushRuns(x0, x1, p.y, p.z + 1);
+		}
+		return filled;
+	}
+
+	template<class FUNC>
+	inline int fill(int x, int y, int z, FUNC &&func) {
+		return fill(glm::ivec3(x, y, z), core::forward<FUNC>(func));
+	}
+};
+
+} // namespace voxelutil
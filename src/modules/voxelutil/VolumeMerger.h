@@ -73,6 +73,9 @@ int mergeVolumes(Volume1 *destination, const palette::Palette &destinationPalett
 				 MergeCondition mergeCondition = MergeCondition()) {
 	core_trace_scoped(MergeRawVolumes);
 	int cnt = 0;
+	// the closest match is searched once per source palette color and not for every voxel
+	voxel::Voxel colorMapping[palette::PaletteMaxColors];
+	bool colorMapped[palette::PaletteMaxColors]{};
 	typename Volume2::Sampler sourceSampler(source);
 	typename Volume1::Sampler destSampler(destination);
 	const int relX = destReg.getLowerX();
@@ -91,11 +94,16 @@ int mergeVolumes(Volume1 *destination, const palette::Palette &destinationPalett
 					destSampler.movePositiveX();
 					continue;
 				}
-				int idx = destinationPalette.getClosestMatch(sourcePalette.color(srcVoxel.getColor()));
-				if (idx == palette::PaletteColorNotFound) {
-					idx = 0;
+				const uint8_t srcColor = srcVoxel.getColor();
+				if (!colorMapped[srcColor]) {
+					int idx = destinationPalette.getClosestMatch(sourcePalette.color(srcColor));
+					if (idx == palette::PaletteColorNotFound) {
+						idx = 0;
+					}
+					colorMapping[srcColor] = voxel::createVoxel(destinationPalette, idx);
+					colorMapped[srcColor] = true;
 				}
-				const voxel::Voxel destVoxel = voxel::createVoxel(destinationPalette, idx);
+				const voxel::Voxel destVoxel = colorMapping[srcColor];
 				if (destSampler.setVoxel(destVoxel)) {
 					++cnt;
 				}
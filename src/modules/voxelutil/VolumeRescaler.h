@@ -6,7 +6,10 @@
 #include "app/App.h"
 #include "core/Color.h"
 #include "core/Common.h"
+#include "core/StandardLib.h"
 #include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Parallel.h"
 #include "palette/Palette.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/RawVolume.h"
@@ -15,107 +18,223 @@
 
 namespace voxelutil {
 
-template<typename Sampler>
-static bool isHidden(Sampler &srcSampler) {
-	const glm::ivec3 pos = srcSampler.position();
-	for (int32_t childZ = -1; childZ <= 1; ++childZ) {
-		for (int32_t childY = -1; childY <= 1; ++childY) {
-			for (int32_t childX = -1; childX <= 1; ++childX) {
-				if (childZ == 0 && childY == 0 && childX == 0) {
-					continue;
-				}
-				srcSampler.setPosition(pos.x + childX, pos.y + childY, pos.z + childZ);
-				if (!srcSampler.currentPositionValid()) {
-					return false;
-				}
-				if (!isBlocked(srcSampler.voxel().getMaterial())) {
-					return false;
+namespace priv {
+
+/**
+ * @brief The depth of the slabs of the destination volume that are scaled down at once
+ */
+static constexpr int ScaleDownSlabDepth = 8;
+
+/**
+ * @brief Caches the closest palette colors of the averaged colors - the neighbouring output voxels often end up with
+ * the same average
+ */
+class ClosestColorCache {
+private:
+	static constexpr int Size = 1024;
+	const palette::Palette &_palette;
+	core::RGBA _rgba[Size];
+	int _index[Size];
+	bool _valid[Size];
+
+public:
+	ClosestColorCache(const palette::Palette &palette) : _palette(palette) {
+		core_memset(_valid, 0, sizeof(_valid));
+	}
+
+	int closestMatch(const glm::vec4 &color) {
+		const core::RGBA rgba = core::Color::getRGBA(color);
+		const uint32_t slot = (rgba.rgba * 2654435761u) >> 22;
+		if (!_valid[slot] || _rgba[slot] != rgba) {
+			_rgba[slot] = rgba;
+			_index[slot] = _palette.getClosestMatch(rgba);
+			_valid[slot] = true;
+		}
+		return _index[slot];
+	}
+};
+
+/**
+ * @brief Bit mask of the solid voxels of a slab of the source volume and the solid voxels that are surrounded by
+ * solid voxels
+ *
+ * The mask covers the given region plus one voxel in each direction - voxels outside of the source volume are not
+ * solid. The hidden voxels are computed by eroding the solid voxels along each axis.
+ */
+class ScaleDownMask {
+private:
+	glm::ivec3 _mins;
+	int _width;
+	int _height;
+	int _depth;
+	core::DynamicArray<uint8_t> _solid;
+	core::DynamicArray<uint8_t> _hidden;
+
+	inline int index(int x, int y, int z) const {
+		return (x - _mins.x) + ((y - _mins.y) + (z - _mins.z) * _height) * _width;
+	}
+
+public:
+	template<typename Volume>
+	ScaleDownMask(const Volume &volume, const voxel::Region &region) {
+		core_trace_scoped(ScaleDownMask);
+		_mins = region.getLowerCorner() - 1;
+		_width = region.getWidthInVoxels() + 2;
+		_height = region.getHeightInVoxels() + 2;
+		_depth = region.getDepthInVoxels() + 2;
+		const int voxels = _width * _height * _depth;
+		_solid.resize(voxels);
+		_hidden.resize(voxels);
+
+		typename Volume::Sampler sampler(volume);
+		uint8_t *solid = _solid.data();
+		for (int z = 0; z < _depth; ++z) {
+			for (int y = 0; y < _height; ++y) {
+				sampler.setPosition(_mins.x, _mins.y + y, _mins.z + z);
+				for (int x = 0; x < _width; ++x) {
+					*solid++ = sampler.currentPositionValid() && voxel::isBlocked(sampler.voxel().getMaterial());
+					sampler.movePositiveX();
 				}
 			}
 		}
+
+		// erode along x into the hidden mask, then along y and z in place - the border of the mask stays unused
+		const int plane = _width * _height;
+		const uint8_t *s = _solid.data();
+		uint8_t *h = _hidden.data();
+		for (int i = 1; i < voxels - 1; ++i) {
+			h[i] = s[i - 1] & s[i] & s[i + 1];
+		}
+		core::DynamicArray<uint8_t> tmp;
+		tmp.resize(voxels);
+		uint8_t *t = tmp.data();
+		for (int i = _width; i < voxels - _width; ++i) {
+			t[i] = h[i - _width] & h[i] & h[i + _width];
+		}
+		for (int i = plane; i < voxels - plane; ++i) {
+			h[i] = t[i - plane] & t[i] & t[i + plane];
+		}
+	}
+
+	inline bool solid(const glm::ivec3 &pos) const {
+		return _solid[index(pos.x, pos.y, pos.z)] != 0u;
 	}
-	return true;
-}
+
+	/**
+	 * @return @c true if the voxel and all of its 26 neighbours are solid
+	 * @note Only valid for the positions of the region the mask was created for
+	 */
+	inline bool hidden(const glm::ivec3 &pos) const {
+		return _hidden[index(pos.x, pos.y, pos.z)] != 0u;
+	}
+};
+
+} // namespace priv
 
 /**
  * @brief Rescales a volume by sampling two voxels to produce one output voxel.
+ *
+ * The destination is processed in slabs along the z axis. For each slab a mask of the solid and the hidden source
+ * voxels is computed first - the colors are averaged from the mask and the precomputed palette colors afterwards.
+ *
  * @param[in] sourceVolume The source volume to resample
  * @param[in] destVolume The destination volume to resample into
  * @param[in] sourceRegion The region of the source volume to resample
  * @param[in] destRegion The region of the destination volume to resample into. Usually this should
  * be exactly half of the size of the sourceRegion.
+ * @param[in] minSolidVoxels The amount of the eight corresponding voxels that must be solid to make the output voxel
+ * solid. With @c 1 the output covers all of the source voxels - used for the level of detail meshes.
+ * @param[in] threadPool Optional thread pool to scale the slabs in parallel - the calling thread takes part in the
+ * work. The destination volume is only modified by the calling thread.
  */
 template<typename SourceVolume, typename DestVolume>
 void scaleDown(const SourceVolume &sourceVolume, const palette::Palette &palette, const voxel::Region &sourceRegion,
-			   DestVolume &destVolume, const voxel::Region &destRegion) {
+			   DestVolume &destVolume, const voxel::Region &destRegion, int minSolidVoxels = 7,
+			   core::ThreadPool *threadPool = nullptr) {
 	core_trace_scoped(ScaleVolumeDown);
-	typename SourceVolume::Sampler srcSampler(sourceVolume);
-
 	const int32_t depth = destRegion.getDepthInVoxels();
 	const int32_t height = destRegion.getHeightInVoxels();
 	const int32_t width = destRegion.getWidthInVoxels();
+	const glm::ivec3 &srcMins = sourceRegion.getLowerCorner();
+	const glm::ivec3 &dstMins = destRegion.getLowerCorner();
+	const int slabs = (depth + priv::ScaleDownSlabDepth - 1) / priv::ScaleDownSlabDepth;
+
+	glm::vec4 colors[palette::PaletteMaxColors];
+	for (int i = 0; i < palette::PaletteMaxColors; ++i) {
+		colors[i] = core::Color::fromRGBA(palette.color(i));
+	}
+
 	// First of all we iterate over all destination voxels and compute their color as the
 	// avg of the colors of the eight corresponding voxels in the higher resolution version.
-	for (int32_t z = 0; z < depth; ++z) {
-		for (int32_t y = 0; y < height; ++y) {
-			for (int32_t x = 0; x < width; ++x) {
-				const glm::ivec3 curPos(x, y, z);
-				const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
-				const glm::ivec3 dstPos = destRegion.getLowerCorner() + curPos;
-
-				float colorContributors = 0.0f;
-				float solidVoxels = 0.0f;
-				float avgColorRed = 0.0f;
-				float avgColorGreen = 0.0f;
-				float avgColorBlue = 0.0f;
-				voxel::Voxel colorGuardVoxel;
-				for (int32_t childZ = 0; childZ < 2; ++childZ) {
-					for (int32_t childY = 0; childY < 2; ++childY) {
-						for (int32_t childX = 0; childX < 2; ++childX) {
-							srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
-							if (!srcSampler.currentPositionValid()) {
-								continue;
-							}
-							const voxel::Voxel &child = srcSampler.voxel();
-
-							if (isBlocked(child.getMaterial())) {
+	core::DynamicArray<core::DynamicArray<voxel::Voxel>> slabVoxels;
+	slabVoxels.resize(slabs);
+	core::parallelSlices(threadPool, slabs, [&](int slab) {
+		const int lowerZ = slab * priv::ScaleDownSlabDepth;
+		const int upperZ = core_min(lowerZ + priv::ScaleDownSlabDepth, depth);
+		const voxel::Region children(srcMins.x, srcMins.y, srcMins.z + lowerZ * 2, srcMins.x + width * 2 - 1,
+									 srcMins.y + height * 2 - 1, srcMins.z + upperZ * 2 - 1);
+		const priv::ScaleDownMask mask(sourceVolume, children);
+		priv::ClosestColorCache cache(palette);
+		typename SourceVolume::Sampler srcSampler(sourceVolume);
+		core::DynamicArray<voxel::Voxel> &voxels = slabVoxels[slab];
+		voxels.reserve((size_t)width * height * (upperZ - lowerZ));
+		for (int32_t z = lowerZ; z < upperZ; ++z) {
+			for (int32_t y = 0; y < height; ++y) {
+				for (int32_t x = 0; x < width; ++x) {
+					const glm::ivec3 srcPos = srcMins + glm::ivec3(x, y, z) * 2;
+					int colorContributors = 0;
+					int solidVoxels = 0;
+					glm::vec4 avgColor(0.0f);
+					voxel::Voxel colorGuardVoxel;
+					for (int32_t childZ = 0; childZ < 2; ++childZ) {
+						for (int32_t childY = 0; childY < 2; ++childY) {
+							for (int32_t childX = 0; childX < 2; ++childX) {
+								const glm::ivec3 childPos = srcPos + glm::ivec3(childX, childY, childZ);
+								if (!mask.solid(childPos)) {
+									continue;
+								}
+								srcSampler.setPosition(childPos);
+								const voxel::Voxel &child = srcSampler.voxel();
 								++solidVoxels;
-								if (isHidden(srcSampler)) {
+								if (mask.hidden(childPos)) {
 									colorGuardVoxel = child;
 									continue;
 								}
-								const glm::vec4 &color = core::Color::fromRGBA(palette.color(child.getColor()));
-								avgColorRed += color.r;
-								avgColorGreen += color.g;
-								avgColorBlue += color.b;
+								avgColor += colors[child.getColor()];
 								++colorContributors;
 							}
 						}
 					}
-				}
 
-				// We only make a voxel solid if the eight corresponding voxels are also all solid. This
-				// means that higher LOD meshes actually shrink away which ensures cracks aren't visible.
-				if (solidVoxels >= 7.0f) {
-					if (colorContributors <= 0.0f) {
-						const glm::vec4 &color = core::Color::fromRGBA(palette.color(colorGuardVoxel.getColor()));
-						avgColorRed += color.r;
-						avgColorGreen += color.g;
-						avgColorBlue += color.b;
-						++colorContributors;
+					// By default we only make a voxel solid if (almost) all of the eight corresponding voxels
+					// are solid, too. This means that the scaled volume shrinks away.
+					if (solidVoxels >= minSolidVoxels) {
+						if (colorContributors <= 0) {
+							avgColor += colors[colorGuardVoxel.getColor()];
+							++colorContributors;
+						}
+						avgColor /= (float)colorContributors;
+						avgColor.a = 1.0f;
+						voxels.push_back(voxel::createVoxel(palette, cache.closestMatch(avgColor)));
+					} else {
+						voxels.push_back(voxel::Voxel());
 					}
-					const glm::vec4 avgColor(avgColorRed / colorContributors, avgColorGreen / colorContributors,
-											 avgColorBlue / colorContributors, 1.0f);
-					core::RGBA avgRGBA = core::Color::getRGBA(avgColor);
-					const int index = palette.getClosestMatch(avgRGBA);
-					voxel::Voxel voxel = voxel::createVoxel(palette, index);
-					destVolume.setVoxel(dstPos, voxel);
-				} else {
-					const voxel::Voxel voxelAir;
-					destVolume.setVoxel(dstPos, voxelAir);
 				}
 			}
 		}
+	});
+	for (int slab = 0; slab < slabs; ++slab) {
+		const voxel::Voxel *voxel = slabVoxels[slab].data();
+		const int lowerZ = slab * priv::ScaleDownSlabDepth;
+		const int upperZ = core_min(lowerZ + priv::ScaleDownSlabDepth, depth);
+		for (int32_t z = lowerZ; z < upperZ; ++z) {
+			for (int32_t y = 0; y < height; ++y) {
+				for (int32_t x = 0; x < width; ++x) {
+					destVolume.setVoxel(dstMins + glm::ivec3(x, y, z), *voxel++);
+				}
+			}
+		}
+		slabVoxels[slab].release();
 	}
 
 	// At this point the results are usable, but we have a problem with thin structures disappearing.
@@ -124,100 +243,110 @@ void scaleDown(const SourceVolume &sourceVolume, const palette::Palette &palette
 	// color changes, as this is very noticeable. Our solution is to process again only those voxels
 	// which lie on a material-air boundary, and to recompute their color using a larger neighborhood
 	// while also accounting for how visible the child voxels are.
-	typename DestVolume::Sampler dstSampler(destVolume);
-	for (int32_t z = 0; z < destRegion.getDepthInVoxels(); ++z) {
-		for (int32_t y = 0; y < destRegion.getHeightInVoxels(); ++y) {
-			for (int32_t x = 0; x < destRegion.getWidthInVoxels(); ++x) {
-				const glm::ivec3 curPos(x, y, z);
-				const glm::ivec3 dstPos = destRegion.getLowerCorner() + curPos;
-
-				dstSampler.setPosition(dstPos);
-
-				// Skip empty voxels
-				if (dstSampler.voxel().getMaterial() == voxel::VoxelType::Air) {
-					continue;
-				}
-				// Only process voxels on a material-air boundary.
-				if (dstSampler.peekVoxel0px0py1nz().getMaterial() != voxel::VoxelType::Air &&
-					dstSampler.peekVoxel0px0py1pz().getMaterial() != voxel::VoxelType::Air &&
-					dstSampler.peekVoxel0px1ny0pz().getMaterial() != voxel::VoxelType::Air &&
-					dstSampler.peekVoxel0px1py0pz().getMaterial() != voxel::VoxelType::Air &&
-					dstSampler.peekVoxel1nx0py0pz().getMaterial() != voxel::VoxelType::Air &&
-					dstSampler.peekVoxel1px0py0pz().getMaterial() != voxel::VoxelType::Air) {
-					continue;
-				}
-				const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
-
-				float totalRed = 0.0f;
-				float totalGreen = 0.0f;
-				float totalBlue = 0.0f;
-				float totalExposedFaces = 0.0f;
-
-				// Look at the 64 (4x4x4) children
-				for (int32_t childZ = -1; childZ < 3; childZ++) {
-					for (int32_t childY = -1; childY < 3; childY++) {
-						for (int32_t childX = -1; childX < 3; childX++) {
-							srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
-
-							const voxel::Voxel &child = srcSampler.voxel();
-							if (child.getMaterial() == voxel::VoxelType::Air) {
-								continue;
-							}
+	struct BoundaryVoxel {
+		glm::ivec3 pos;
+		voxel::Voxel voxel;
+	};
+	core::DynamicArray<core::DynamicArray<BoundaryVoxel>> boundaryVoxels;
+	boundaryVoxels.resize(slabs);
+	core::parallelSlices(threadPool, slabs, [&](int slab) {
+		const int lowerZ = slab * priv::ScaleDownSlabDepth;
+		const int upperZ = core_min(lowerZ + priv::ScaleDownSlabDepth, depth);
+		priv::ClosestColorCache cache(palette);
+		typename SourceVolume::Sampler srcSampler(sourceVolume);
+		typename DestVolume::Sampler dstSampler(destVolume);
+		for (int32_t z = lowerZ; z < upperZ; ++z) {
+			for (int32_t y = 0; y < height; ++y) {
+				for (int32_t x = 0; x < width; ++x) {
+					const glm::ivec3 curPos(x, y, z);
+					const glm::ivec3 dstPos = dstMins + curPos;
 
-							// For each small voxel, count the exposed faces and use this
-							// to determine the importance of the color contribution.
-							float exposedFaces = 0.0f;
-							if (srcSampler.peekVoxel0px0py1nz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel0px0py1pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel0px1ny0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel0px1py0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel1nx0py0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel1px0py0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
+					dstSampler.setPosition(dstPos);
+
+					// Skip empty voxels
+					if (dstSampler.voxel().getMaterial() == voxel::VoxelType::Air) {
+						continue;
+					}
+					// Only process voxels on a material-air boundary.
+					if (dstSampler.peekVoxel0px0py1nz().getMaterial() != voxel::VoxelType::Air &&
+						dstSampler.peekVoxel0px0py1pz().getMaterial() != voxel::VoxelType::Air &&
+						dstSampler.peekVoxel0px1ny0pz().getMaterial() != voxel::VoxelType::Air &&
+						dstSampler.peekVoxel0px1py0pz().getMaterial() != voxel::VoxelType::Air &&
+						dstSampler.peekVoxel1nx0py0pz().getMaterial() != voxel::VoxelType::Air &&
+						dstSampler.peekVoxel1px0py0pz().getMaterial() != voxel::VoxelType::Air) {
+						continue;
+					}
+					const glm::ivec3 srcPos = srcMins + curPos * 2;
+
+					glm::vec4 total(0.0f);
+					float totalExposedFaces = 0.0f;
+
+					// Look at the 64 (4x4x4) children
+					for (int32_t childZ = -1; childZ < 3; childZ++) {
+						for (int32_t childY = -1; childY < 3; childY++) {
+							for (int32_t childX = -1; childX < 3; childX++) {
+								srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
 
-							const glm::vec4 &color = core::Color::fromRGBA(palette.color(child.getColor()));
-							totalRed += color.r * exposedFaces;
-							totalGreen += color.g * exposedFaces;
-							totalBlue += color.b * exposedFaces;
+								const voxel::Voxel &child = srcSampler.voxel();
+								if (child.getMaterial() == voxel::VoxelType::Air) {
+									continue;
+								}
+
+								// For each small voxel, count the exposed faces and use this
+								// to determine the importance of the color contribution.
+								float exposedFaces = 0.0f;
+								if (srcSampler.peekVoxel0px0py1nz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px0py1pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px1ny0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px1py0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel1nx0py0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel1px0py0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
 
-							totalExposedFaces += exposedFaces;
+								total += colors[child.getColor()] * exposedFaces;
+								totalExposedFaces += exposedFaces;
+							}
 						}
 					}
-				}
 
-				// Avoid divide by zero if there were no exposed faces.
-				if (totalExposedFaces <= 0.01f) {
-					++totalExposedFaces;
-				}
+					// Avoid divide by zero if there were no exposed faces.
+					if (totalExposedFaces <= 0.01f) {
+						++totalExposedFaces;
+					}
 
-				const glm::vec4 avgColor(totalRed / totalExposedFaces, totalGreen / totalExposedFaces,
-										 totalBlue / totalExposedFaces, 1.0f);
-				core::RGBA avgRGBA = core::Color::getRGBA(avgColor);
-				const int index = palette.getClosestMatch(avgRGBA);
-				const voxel::Voxel voxel = voxel::createVoxel(palette, index);
-				destVolume.setVoxel(dstPos, voxel);
+					glm::vec4 avgColor = total / totalExposedFaces;
+					avgColor.a = 1.0f;
+					const voxel::Voxel voxel = voxel::createVoxel(palette, cache.closestMatch(avgColor));
+					boundaryVoxels[slab].push_back({dstPos, voxel});
+				}
 			}
 		}
+	});
+	for (const core::DynamicArray<BoundaryVoxel> &slab : boundaryVoxels) {
+		for (const BoundaryVoxel &boundaryVoxel : slab) {
+			destVolume.setVoxel(boundaryVoxel.pos, boundaryVoxel.voxel);
+		}
 	}
 }
 
 template<typename SourceVolume, typename DestVolume>
-void scaleDown(const SourceVolume &sourceVolume, const palette::Palette &palette, DestVolume &destVolume) {
-	scaleDown(sourceVolume, palette, sourceVolume.region(), destVolume, destVolume.region());
+void scaleDown(const SourceVolume &sourceVolume, const palette::Palette &palette, DestVolume &destVolume,
+			   core::ThreadPool *threadPool = nullptr) {
+	scaleDown(sourceVolume, palette, sourceVolume.region(), destVolume, destVolume.region(), 7, threadPool);
 }
 
-[[nodiscard]] voxel::RawVolume *scaleUp(const voxel::RawVolume &sourceVolume) {
+[[nodiscard]] inline voxel::RawVolume *scaleUp(const voxel::RawVolume &sourceVolume) {
 	const voxel::Region srcRegion = sourceVolume.region();
 	const glm::ivec3 &dim = srcRegion.getDimensionsInVoxels();
 	const glm::ivec3 &mins = srcRegion.getLowerCorner();
@@ -4,22 +4,61 @@
 
 #include "VolumeRotator.h"
 #include "core/Assert.h"
+#include "core/Common.h"
 #include "core/GLM.h"
 #include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/concurrent/Parallel.h"
 #include "math/AABB.h"
 #include "math/Axis.h"
 #include "math/Math.h"
 #include "palette/Palette.h"
 #include "voxel/RawVolume.h"
-#include "voxel/RawVolumeWrapper.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #include "voxelutil/VoxelUtil.h"
+#include <stddef.h>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/euler_angles.hpp>
 
 namespace voxelutil {
 
+namespace {
+
+/**
+ * @brief The minimum depth of the slices the volume is rotated in - two voxels that are further apart than
+ * sqrt(3) can't end up at the same position after a rotation. This allows to rotate every other slice in parallel.
+ */
+static constexpr int RotateSliceDepth = 4;
+/**
+ * @brief The size of the square tiles the planes are transposed in to keep the reads and writes cache friendly
+ */
+static constexpr int TransposeTileSize = 32;
+
+} // namespace
+
+/**
+ * @brief Tiled transpose of a plane of voxels: @c dest[x * destStride + y] = @c src[y * srcStride + x]
+ * @note The strides might be negative to mirror the plane on one axis while transposing it
+ */
+static void transposePlane(const voxel::Voxel *src, ptrdiff_t srcStride, voxel::Voxel *dest, ptrdiff_t destStride,
+						   int width, int height) {
+	for (int y0 = 0; y0 < height; y0 += TransposeTileSize) {
+		const int y1 = core_min(y0 + TransposeTileSize, height);
+		for (int x0 = 0; x0 < width; x0 += TransposeTileSize) {
+			const int x1 = core_min(x0 + TransposeTileSize, width);
+			for (int x = x0; x < x1; ++x) {
+				voxel::Voxel *destRow = dest + x * destStride;
+				const voxel::Voxel *srcColumn = src + x;
+				for (int y = y0; y < y1; ++y) {
+					destRow[y] = srcColumn[y * srcStride];
+				}
+			}
+		}
+	}
+}
+
 /**
  * @param[in] srcVolume The RawVolume to rotate
  * @param[in] angles The angles for the x, y and z axis given in degrees
@@ -27,7 +66,9 @@ namespace voxelutil {
  * memory.
  */
 voxel::RawVolume *rotateVolume(const voxel::RawVolume *srcVolume, const palette::Palette &palette,
-							   const glm::ivec3 &angles, const glm::vec3 &normalizedPivot) {
+							   const glm::ivec3 &angles, const glm::vec3 &normalizedPivot,
+							   core::ThreadPool *threadPool) {
+	core_trace_scoped(RotateVolume);
 	// TODO: implement sampling http://www.leptonica.org/rotation.html
 	const float pitch = glm::radians((float)angles.x);
 	const float yaw = glm::radians((float)angles.y);
@@ -38,149 +79,171 @@ voxel::RawVolume *rotateVolume(const voxel::RawVolume *srcVolume, const palette:
 	const glm::vec3 pivot(normalizedPivot * glm::vec3(srcRegion.getDimensionsInVoxels()));
 	const voxel::Region &destRegion = srcRegion.rotate(mat, pivot);
 	voxel::RawVolume *destVolume = new voxel::RawVolume(destRegion);
-	voxel::RawVolumeWrapper destVolumeWrapper(destVolume);
-
-	voxel::RawVolume::Sampler srcSampler(srcVolume);
-	srcSampler.setPosition(srcRegion.getLowerCorner());
-	for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
-		voxel::RawVolume::Sampler srcSampler2 = srcSampler;
-		for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
-			voxel::RawVolume::Sampler srcSampler3 = srcSampler2;
-			for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
-				const voxel::Voxel voxel = srcSampler3.voxel();
-				if (!voxel::isAir(voxel.getMaterial())) {
+	voxel::Voxel *destData = destVolume->writableRow(destRegion.getLowerCorner());
+	const glm::ivec3 &destMins = destRegion.getLowerCorner();
+	const int destWidth = destRegion.getWidthInVoxels();
+	const int destStride = destRegion.stride();
+
+	auto rotateSlice = [&](int slice) {
+		const int lowerZ = srcRegion.getLowerZ() + slice * RotateSliceDepth;
+		const int upperZ = core_min(lowerZ + RotateSliceDepth - 1, srcRegion.getUpperZ());
+		for (int32_t z = lowerZ; z <= upperZ; ++z) {
+			for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
+				const voxel::Voxel *srcRow = srcVolume->row(glm::ivec3(srcRegion.getLowerX(), y, z));
+				for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
+					const voxel::Voxel &voxel = srcRow[x - srcRegion.getLowerX()];
+					if (voxel::isAir(voxel.getMaterial())) {
+						continue;
+					}
 					const glm::vec3 srcPos(x, y, z);
 					const glm::vec3 &destPos = math::transform(mat, srcPos, pivot);
 					const glm::ivec3 &destPosFloor = glm::floor(destPos);
-					destVolumeWrapper.setVoxel(destPosFloor, voxel);
+					if (!destRegion.containsPoint(destPosFloor)) {
+						continue;
+					}
+					const glm::ivec3 local = destPosFloor - destMins;
+					destData[local.x + local.y * destWidth + local.z * destStride] = voxel;
 				}
-				srcSampler3.movePositiveX();
 			}
-			srcSampler2.movePositiveY();
 		}
-		srcSampler.movePositiveZ();
+	};
+
+	const int slices = (srcRegion.getDepthInVoxels() + RotateSliceDepth - 1) / RotateSliceDepth;
+	if (threadPool == nullptr) {
+		for (int i = 0; i < slices; ++i) {
+			rotateSlice(i);
+		}
+		return destVolume;
 	}
+	// the even slices can't write to the same voxels - neither can the odd ones
+	core::parallelSlices(threadPool, (slices + 1) / 2, [&](int i) { rotateSlice(i * 2); });
+	core::parallelSlices(threadPool, slices / 2, [&](int i) { rotateSlice(i * 2 + 1); });
 	return destVolume;
 }
 
-voxel::RawVolume *rotateAxis(const voxel::RawVolume *srcVolume, math::Axis axis) {
+voxel::RawVolume *rotateAxis(const voxel::RawVolume *srcVolume, math::Axis axis, core::ThreadPool *threadPool) {
+	core_trace_scoped(RotateAxis);
 	const voxel::Region &srcRegion = srcVolume->region();
 	const glm::ivec3 srcMins = srcRegion.getLowerCorner();
 	const glm::ivec3 srcMaxs = srcRegion.getUpperCorner();
+	const int width = srcRegion.getWidthInVoxels();
+	const int height = srcRegion.getHeightInVoxels();
+	const int depth = srcRegion.getDepthInVoxels();
+	const ptrdiff_t srcStride = srcRegion.stride();
+	const voxel::Voxel *srcData = srcVolume->row(srcMins);
+
 	if (axis == math::Axis::X) {
+		// (x, y, z) => (x, z, maxs.y - y) - the rows along the x axis stay intact
 		const voxel::Region destRegion(srcMins.x, srcMins.z, srcMins.y, srcMaxs.x, srcMaxs.z, srcMaxs.y);
 		voxel::RawVolume *destVolume = new voxel::RawVolume(destRegion);
-
-		voxel::RawVolume::Sampler srcSampler(srcVolume);
-		srcSampler.setPosition(srcRegion.getLowerCorner());
-		for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
-			voxel::RawVolume::Sampler srcSampler2 = srcSampler;
-			for (int32_t y = 0; y < srcRegion.getHeightInVoxels(); ++y) {
-				voxel::RawVolume::Sampler srcSampler3 = srcSampler2;
-				for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
-					const voxel::Voxel voxel = srcSampler3.voxel();
-					if (!voxel::isAir(voxel.getMaterial())) {
-						destVolume->setVoxel(x, z, srcMaxs.y - y, voxel);
-					}
-					srcSampler3.movePositiveX();
+		voxel::Voxel *destData = destVolume->writableRow(destRegion.getLowerCorner());
+		const ptrdiff_t destStride = destRegion.stride();
+		const int slices = core::parallelSliceCount(threadPool, depth);
+		core::parallelSlices(threadPool, slices, [&](int slice) {
+			const int lowerZ = depth * slice / slices;
+			const int upperZ = depth * (slice + 1) / slices;
+			for (int z = lowerZ; z < upperZ; ++z) {
+				for (int y = 0; y < height; ++y) {
+					const voxel::Voxel *srcRow = srcData + z * srcStride + y * width;
+					voxel::Voxel *destRow = destData + (height - 1 - y) * destStride + z * width;
+					core_memcpy(destRow, srcRow, width * sizeof(voxel::Voxel));
 				}
-				srcSampler2.movePositiveY();
 			}
-			srcSampler.movePositiveZ();
-		}
+		});
 		return destVolume;
 	} else if (axis == math::Axis::Y) {
+		// (x, y, z) => (maxs.z - z, y, x) - transpose the x and z axis of every plane along the y axis
 		const voxel::Region destRegion(srcMins.z, srcMins.y, srcMins.x, srcMaxs.z, srcMaxs.y, srcMaxs.x);
 		voxel::RawVolume *destVolume = new voxel::RawVolume(destRegion);
-
-		voxel::RawVolume::Sampler srcSampler(srcVolume);
-		srcSampler.setPosition(srcRegion.getLowerCorner());
-		for (int32_t z = 0; z < srcRegion.getDepthInVoxels(); ++z) {
-			voxel::RawVolume::Sampler srcSampler2 = srcSampler;
-			for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
-				voxel::RawVolume::Sampler srcSampler3 = srcSampler2;
-				for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
-					const voxel::Voxel voxel = srcSampler3.voxel();
-					if (!voxel::isAir(voxel.getMaterial())) {
-						destVolume->setVoxel(srcMaxs.z - z, y, x, voxel);
-					}
-					srcSampler3.movePositiveX();
-				}
-				srcSampler2.movePositiveY();
+		voxel::Voxel *destData = destVolume->writableRow(destRegion.getLowerCorner());
+		const ptrdiff_t destStride = destRegion.stride();
+		const int slices = core::parallelSliceCount(threadPool, height);
+		core::parallelSlices(threadPool, slices, [&](int slice) {
+			const int lowerY = height * slice / slices;
+			const int upperY = height * (slice + 1) / slices;
+			for (int y = lowerY; y < upperY; ++y) {
+				const voxel::Voxel *srcPlane = srcData + (depth - 1) * srcStride + y * width;
+				transposePlane(srcPlane, -srcStride, destData + y * depth, destStride, width, depth);
 			}
-			srcSampler.movePositiveZ();
-		}
+		});
 		return destVolume;
 	}
+	// (x, y, z) => (y, maxs.x - x, z) - transpose the x and y axis of every plane along the z axis
 	const voxel::Region destRegion(srcMins.y, srcMins.x, srcMins.z, srcMaxs.y, srcMaxs.x, srcMaxs.z);
 	voxel::RawVolume *destVolume = new voxel::RawVolume(destRegion);
-
-	voxel::RawVolume::Sampler srcSampler(srcVolume);
-	srcSampler.setPosition(srcRegion.getLowerCorner());
-	for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
-		voxel::RawVolume::Sampler srcSampler2 = srcSampler;
-		for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
-			voxel::RawVolume::Sampler srcSampler3 = srcSampler2;
-			for (int32_t x = 0; x < srcRegion.getWidthInVoxels(); ++x) {
-				const voxel::Voxel voxel = srcSampler3.voxel();
-				if (!voxel::isAir(voxel.getMaterial())) {
-					destVolume->setVoxel(y, srcMaxs.x - x, z, voxel);
-				}
-				srcSampler3.movePositiveX();
-			}
-			srcSampler2.movePositiveY();
+	voxel::Voxel *destData = destVolume->writableRow(destRegion.getLowerCorner());
+	const ptrdiff_t destStride = destRegion.stride();
+	const int slices = core::parallelSliceCount(threadPool, depth);
+	core::parallelSlices(threadPool, slices, [&](int slice) {
+		const int lowerZ = depth * slice / slices;
+		const int upperZ = depth * (slice + 1) / slices;
+		for (int z = lowerZ; z < upperZ; ++z) {
+			voxel::Voxel *destPlane = destData + z * destStride + (width - 1) * height;
+			transposePlane(srcData + z * srcStride, width, destPlane, -height, width, height);
 		}
-		srcSampler.movePositiveZ();
-	}
+	});
 	return destVolume;
 }
 
-voxel::RawVolume *mirrorAxis(const voxel::RawVolume *source, math::Axis axis) {
-	const voxel::Region &srcRegion = source->region();
-	voxel::RawVolume *destination = new voxel::RawVolume(source);
-	voxel::RawVolume::Sampler destSampler(destination);
-	voxel::RawVolume::Sampler srcSampler(source);
+/**
+ * @brief Swap two ranges of voxels - simple enough for the compiler to vectorize it
+ */
+static void swapVoxels(voxel::Voxel *a, voxel::Voxel *b, int amount) {
+	for (int i = 0; i < amount; ++i) {
+		const voxel::Voxel tmp = a[i];
+		a[i] = b[i];
+		b[i] = tmp;
+	}
+}
 
-	const glm::ivec3 &mins = srcRegion.getLowerCorner();
-	const glm::ivec3 &maxs = srcRegion.getUpperCorner();
+void mirrorAxis(voxel::RawVolume &volume, math::Axis axis) {
+	core_trace_scoped(MirrorAxis);
+	const voxel::Region &region = volume.region();
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const int width = region.getWidthInVoxels();
+	const int height = region.getHeightInVoxels();
+	const int depth = region.getDepthInVoxels();
+	const int stride = region.stride();
+	voxel::Voxel *data = volume.writableRow(mins);
 
 	if (axis == math::Axis::X) {
-		for (int32_t z = mins.z; z <= maxs.z; ++z) {
-			for (int32_t y = mins.y; y <= maxs.y; ++y) {
-				srcSampler.setPosition(mins.x, y, z);
-				destSampler.setPosition(maxs.x, y, z);
-				for (int32_t x = mins.x; x <= maxs.x; ++x) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveX();
-					destSampler.moveNegativeX();
+		for (int z = 0; z < depth; ++z) {
+			for (int y = 0; y < height; ++y) {
+				voxel::Voxel *row = data + z * stride + y * width;
+				for (int l = 0, r = width - 1; l < r; ++l, --r) {
+					const voxel::Voxel tmp = row[l];
+					row[l] = row[r];
+					row[r] = tmp;
 				}
 			}
 		}
 	} else if (axis == math::Axis::Y) {
-		for (int32_t z = mins.z; z <= maxs.z; ++z) {
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				srcSampler.setPosition(x, mins.y, z);
-				destSampler.setPosition(x, maxs.y, z);
-				for (int32_t y = mins.y; y <= maxs.y; ++y) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveY();
-					destSampler.moveNegativeY();
-				}
+		for (int z = 0; z < depth; ++z) {
+			voxel::Voxel *plane = data + z * stride;
+			for (int l = 0, r = height - 1; l < r; ++l, --r) {
+				swapVoxels(plane + l * width, plane + r * width, width);
 			}
 		}
 	} else if (axis == math::Axis::Z) {
-		for (int32_t y = mins.y; y <= maxs.y; ++y) {
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				srcSampler.setPosition(x, y, mins.z);
-				destSampler.setPosition(x, y, maxs.z);
-				for (int32_t z = mins.z; z <= maxs.z; ++z) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveZ();
-					destSampler.moveNegativeZ();
-				}
-			}
+		for (int l = 0, r = depth - 1; l < r; ++l, --r) {
+			swapVoxels(data + l * stride, data + r * stride, stride);
 		}
+	} else {
+		return;
+	}
+	if (volume.occupancy() == nullptr) {
+		return;
 	}
+	for (int z = mins.z; z <= region.getUpperZ(); ++z) {
+		for (int y = mins.y; y <= region.getUpperY(); ++y) {
+			volume.updateOccupancy(glm::ivec3(mins.x, y, z));
+		}
+	}
+}
+
+voxel::RawVolume *mirrorAxis(const voxel::RawVolume *source, math::Axis axis) {
+	voxel::RawVolume *destination = new voxel::RawVolume(source);
+	mirrorAxis(*destination, axis);
 	return destination;
 }
 
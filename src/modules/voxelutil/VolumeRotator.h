@@ -16,21 +16,34 @@ namespace palette {
 class Palette;
 }
 
+namespace core {
+class ThreadPool;
+}
+
 namespace voxelutil {
 
 /**
  * @brief Rotate the given volume by the given angles in degree
+ * @param threadPool Optional thread pool to rotate slices along the z axis in parallel. The calling thread takes part
+ * in the work. If two voxels end up at the same position, the result might differ from the single threaded rotation.
  */
 [[nodiscard]] voxel::RawVolume *rotateVolume(const voxel::RawVolume *source, const palette::Palette &palette, const glm::ivec3 &angles,
-									  const glm::vec3 &normalizedPivot);
+									  const glm::vec3 &normalizedPivot, core::ThreadPool *threadPool = nullptr);
 /**
  * @brief Rotate the given volume on the given axis by 90 degree. This method does not lose any voxels
+ * @param threadPool Optional thread pool to transpose slices of the volume in parallel. The calling thread takes
+ * part in the work.
  * @note The volume size might differ
  */
-[[nodiscard]] voxel::RawVolume *rotateAxis(const voxel::RawVolume *source, math::Axis axis);
+[[nodiscard]] voxel::RawVolume *rotateAxis(const voxel::RawVolume *source, math::Axis axis,
+										   core::ThreadPool *threadPool = nullptr);
 /**
  * @brief Mirrors the given volume on the given axis
  */
 [[nodiscard]] voxel::RawVolume *mirrorAxis(const voxel::RawVolume *source, math::Axis axis);
+/**
+ * @brief Mirrors the given volume on the given axis in place by swapping the rows of voxels
+ */
+void mirrorAxis(voxel::RawVolume &volume, math::Axis axis);
 
 } // namespace voxelutil
@@ -5,78 +5,64 @@
 #include "VolumeSplitter.h"
 #include "core/Common.h"
 #include "core/Log.h"
+#include "core/Trace.h"
+#include "core/concurrent/Parallel.h"
+#include "voxel/OccupancyMask.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
-#include "voxelutil/VolumeCropper.h"
+#include "voxelutil/ScanlineFill.h"
 #include "voxelutil/VolumeVisitor.h"
 #include "voxelutil/VoxelUtil.h"
 
 namespace voxelutil {
 
-namespace priv {
-
-const glm::ivec3 neighbours[6] = {glm::ivec3(0, 0, -1), glm::ivec3(0, 0, +1), glm::ivec3(0, -1, 0),
-								  glm::ivec3(0, +1, 0), glm::ivec3(-1, 0, 0), glm::ivec3(+1, 0, 0)};
-
-// special voxel to mark already visited voxels
-const uint8_t visitedFlag = 1u;
-const voxel::Voxel visited(voxel::VoxelType::Air, 1, visitedFlag);
-
-} // namespace priv
-
-static void processNeighbours(voxel::RawVolume &volume, voxel::RawVolume &object, const glm::ivec3 position) {
-	if (!volume.region().containsPoint(position)) {
-		return;
-	}
-	voxel::Voxel voxel = volume.voxel(position);
-	if (voxel.getFlags() == priv::visitedFlag) {
-		return;
-	}
-	if (voxel::isAir(voxel.getMaterial())) {
-		volume.setVoxelUnsafe(position, priv::visited);
-		return;
-	}
-
-	object.setVoxel(position, voxel);
-	volume.setVoxelUnsafe(position, priv::visited);
-
-	for (int i = 0; i < 6; ++i) {
-		const glm::ivec3 p = position + priv::neighbours[i];
-		processNeighbours(volume, object, p);
-	}
-}
-
 core::DynamicArray<voxel::RawVolume *> splitObjects(const voxel::RawVolume *v, VisitorOrder order) {
-	voxel::RawVolume copy(*v);
-	copy.setBorderValue(priv::visited);
-
+	core_trace_scoped(SplitObjects);
+	// air separates the objects
+	ScanlineFill fill(v->region());
+	visitVolume(*v, [&](int x, int y, int z, const voxel::Voxel &) { fill.mark(x, y, z); }, VisitEmpty());
+
+	struct Run {
+		int x0, x1, y, z;
+	};
+	core::DynamicArray<Run> runs;
 	core::DynamicArray<voxel::RawVolume *> rawVolumes;
-
-	visitVolume(copy, [&](int x, int y, int z, const voxel::Voxel &voxel) {
-		if (voxel.getFlags() == priv::visitedFlag) {
-			return;
-		}
-		const glm::ivec3 position(x, y, z);
-		if (voxel::isAir(voxel.getMaterial())) {
-			copy.setVoxelUnsafe(position, priv::visited);
-			return;
-		}
-
-		voxel::RawVolume object(copy.region());
-		processNeighbours(copy, object, position);
-		rawVolumes.push_back(voxelutil::cropVolume(&object));
-	}, VisitAll(), order);
+	visitVolume(
+		*v,
+		[&](int x, int y, int z, const voxel::Voxel &) {
+			if (fill.marked(x, y, z)) {
+				return;
+			}
+			runs.clear();
+			glm::ivec3 mins(x, y, z);
+			glm::ivec3 maxs(x, y, z);
+			fill.fill(x, y, z, [&](int x0, int x1, int runY, int runZ) {
+				runs.push_back({x0, x1, runY, runZ});
+				mins = glm::min(mins, glm::ivec3(x0, runY, runZ));
+				maxs = glm::max(maxs, glm::ivec3(x1, runY, runZ));
+			});
+			// the object volume only covers the bounds of the object
+			voxel::RawVolume *object = new voxel::RawVolume(voxel::Region(mins, maxs));
+			for (const Run &run : runs) {
+				for (int runX = run.x0; runX <= run.x1; ++runX) {
+					object->setVoxel(runX, run.y, run.z, v->voxel(runX, run.y, run.z));
+				}
+			}
+			rawVolumes.push_back(object);
+		},
+		SkipEmpty(), order);
 
 	return rawVolumes;
 }
 
-core::DynamicArray<voxel::RawVolume *> splitVolume(const voxel::RawVolume *volume, const glm::ivec3 &maxSize, bool createEmpty) {
+core::DynamicArray<voxel::RawVolume *> splitVolume(const voxel::RawVolume *volume, const glm::ivec3 &maxSize,
+												bool createEmpty, core::ThreadPool *threadPool) {
+	core_trace_scoped(SplitVolume);
 	const voxel::Region &region = volume->region();
 	const glm::ivec3 &mins = region.getLowerCorner();
 	const glm::ivec3 &maxs = region.getUpperCorner();
 
-	core::DynamicArray<voxel::RawVolume *> rawVolumes;
-
+	core::DynamicArray<voxel::Region> innerRegions;
 	const glm::ivec3 step = glm::min(region.getDimensionsInVoxels(), maxSize);
 	Log::debug("split region: %s", region.toString().c_str());
 	for (int y = mins.y; y <= maxs.y; y += step.y) {
@@ -84,19 +70,48 @@ core::DynamicArray<voxel::RawVolume *> splitVolume(const voxel::RawVolume *volum
 			for (int x = mins.x; x <= maxs.x; x += step.x) {
 				const glm::ivec3 innerMins(x, y, z);
 				const glm::ivec3 innerMaxs = glm::min(maxs, innerMins + maxSize - 1);
-				const voxel::Region innerRegion(innerMins, innerMaxs);
+				innerRegions.emplace_back(innerMins, innerMaxs);
+			}
+		}
+	}
+
+	// the pieces don't depend on each other - empty pieces are found with the occupancy mask without copying them
+	const voxel::OccupancyMask *occupancy = volume->occupancy();
+	core::DynamicArray<voxel::RawVolume *> pieces;
+	pieces.resize(innerRegions.size());
+	core::parallelFor(
+		threadPool, 0, (int)innerRegions.size(),
+		[&](int from, int to) {
+			for (int i = from; i < to; ++i) {
+				const voxel::Region &innerRegion = innerRegions[i];
+				pieces[i] = nullptr;
+				if (occupancy != nullptr && occupancy->isEmpty(innerRegion.getLowerCorner() - mins,
+															   innerRegion.getUpperCorner() - mins)) {
+					if (createEmpty) {
+						pieces[i] = new voxel::RawVolume(innerRegion);
+					}
+					continue;
+				}
 				voxel::RawVolume *copy = new voxel::RawVolume(innerRegion);
-				if (voxelutil::copy(*volume, innerRegion, *copy, innerRegion)) {
-					Log::debug("- split %s", innerRegion.toString().c_str());
-				} else if (!createEmpty) {
-					Log::debug("- skip empty %s", innerRegion.toString().c_str());
+				if (!voxelutil::copy(*volume, innerRegion, *copy, innerRegion) && !createEmpty) {
 					delete copy;
 					continue;
 				}
-				rawVolumes.push_back(copy);
+				pieces[i] = copy;
 			}
+		},
+		1);
+
+	core::DynamicArray<voxel::RawVolume *> rawVolumes;
+	rawVolumes.reserve(pieces.size());
+	for (voxel::RawVolume *piece : pieces) {
+		if (piece == nullptr) {
+			continue;
 		}
+		Log::debug("- split %s", piece->region().toString().c_str());
+		rawVolumes.push_back(piece);
 	}
+	Log::debug("- skipped %i empty pieces", (int)(pieces.size() - rawVolumes.size()));
 
 	return rawVolumes;
 }
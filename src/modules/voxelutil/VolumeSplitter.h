@@ -8,6 +8,10 @@
 #include "voxelutil/VolumeVisitor.h"
 #include <glm/fwd.hpp>
 
+namespace core {
+class ThreadPool;
+} // namespace core
+
 namespace voxel {
 class RawVolume;
 } // namespace voxel
@@ -15,11 +19,17 @@ class RawVolume;
 namespace voxelutil {
 
 /**
+ * @brief Cut the volume into pieces of the given max size - the pieces are returned in y, z, x order
+ *
+ * The pieces are copied in parallel if a thread pool is given. If the occupancy of the source volume is tracked (see
+ * @c voxel::RawVolume::setOccupancyTracking()) the empty pieces are found without copying them.
+ *
  * @param createEmpty if @c true, for empty parts of the source volume empty volumes will be created, too. Otherwise
  * they will be ignored.
  */
 [[nodiscard]] core::DynamicArray<voxel::RawVolume *> splitVolume(const voxel::RawVolume *volume,
-																 const glm::ivec3 &maxSize, bool createEmpty = false);
+																 const glm::ivec3 &maxSize, bool createEmpty = false,
+																 core::ThreadPool *threadPool = nullptr);
 
 /**
  * @param order This defines the order in which the splitted objects are returned.
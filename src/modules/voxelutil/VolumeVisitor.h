@@ -6,6 +6,8 @@
 
 #include "core/Common.h"
 #include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Parallel.h"
 #include "math/Axis.h"
 #include "voxel/Face.h"
 #include "voxel/Region.h"
@@ -490,6 +492,80 @@ int visitVolume(const Volume &volume, const voxel::Region &region, Visitor &&vis
 	return visitVolume(volume, region, 1, 1, 1, visitor, condition, order);
 }
 
+/**
+ * @return The slab of the given region along the z axis with the given index
+ */
+inline voxel::Region slabRegion(const voxel::Region &region, int slab, int slabs) {
+	const int depth = region.getDepthInVoxels();
+	const int lowerZ = region.getLowerZ() + depth * slab / slabs;
+	const int upperZ = region.getLowerZ() + depth * (slab + 1) / slabs - 1;
+	return voxel::Region(region.getLowerX(), region.getLowerY(), lowerZ, region.getUpperX(), region.getUpperY(),
+						 upperZ);
+}
+
+/**
+ * @brief Visits the voxels of the region in slabs along the z axis on the given thread pool
+ * @note The visitor must be thread safe - it's called for several slabs at the same time and the order of the slabs
+ * is undefined. Within a slab the voxels are visited in @c VisitorOrder::ZYX. Use @c reduceVolume() to collect
+ * results without any synchronization.
+ * @param threadPool Might be @c nullptr to visit all voxels on the calling thread
+ * @return The number of voxels visited.
+ */
+template<class Volume, class Visitor, typename Condition = SkipEmpty>
+int visitVolumeParallel(const Volume &volume, const voxel::Region &region, Visitor &&visitor,
+						core::ThreadPool *threadPool, Condition condition = Condition()) {
+	core_trace_scoped(VisitVolumeParallel);
+	const int slabs = core::parallelSliceCount(threadPool, region.getDepthInVoxels());
+	core::DynamicArray<int> counts;
+	counts.resize(slabs);
+	core::parallelSlices(threadPool, slabs, [&](int slab) {
+		counts[slab] = visitVolume(volume, slabRegion(region, slab, slabs), visitor, condition);
+	});
+	int cnt = 0;
+	for (int slabCnt : counts) {
+		cnt += slabCnt;
+	}
+	return cnt;
+}
+
+template<class Volume, class Visitor, typename Condition = SkipEmpty>
+int visitVolumeParallel(const Volume &volume, Visitor &&visitor, core::ThreadPool *threadPool,
+						Condition condition = Condition()) {
+	return visitVolumeParallel(volume, volume.region(), visitor, threadPool, condition);
+}
+
+/**
+ * @brief Visits the voxels of the region in slabs along the z axis on the given thread pool - every slab has its own
+ * accumulator, so the visitor doesn't need any synchronization
+ * @param identity The value every accumulator starts with - e.g. @c 0 for a sum
+ * @param visitor @c void(T &accumulator, int x, int y, int z, const voxel::Voxel &voxel)
+ * @param reduce @c void(T &result, const T &accumulator) - called on the calling thread in the order of the slabs
+ * @param threadPool Might be @c nullptr to visit all voxels on the calling thread
+ */
+template<class T, class Volume, class Visitor, class Reduce, typename Condition = SkipEmpty>
+T reduceVolume(const Volume &volume, const voxel::Region &region, const T &identity, Visitor &&visitor,
+			   Reduce &&reduce, core::ThreadPool *threadPool, Condition condition = Condition()) {
+	core_trace_scoped(ReduceVolume);
+	const int slabs = core::parallelSliceCount(threadPool, region.getDepthInVoxels());
+	core::DynamicArray<T> accumulators;
+	accumulators.reserve(slabs);
+	for (int i = 0; i < slabs; ++i) {
+		accumulators.push_back(identity);
+	}
+	core::parallelSlices(threadPool, slabs, [&](int slab) {
+		T &accumulator = accumulators[slab];
+		visitVolume(
+			volume, slabRegion(region, slab, slabs),
+			[&](int x, int y, int z, const voxel::Voxel &voxel) { visitor(accumulator, x, y, z, voxel); },
+			condition);
+	});
+	T result = identity;
+	for (const T &accumulator : accumulators) {
+		reduce(result, accumulator);
+	}
+	return result;
+}
+
 template<class Volume, class Visitor>
 int visitSurfaceVolume(const Volume &volume, Visitor &&visitor, VisitorOrder order = VisitorOrder::ZYX) {
 	int cnt = 0;
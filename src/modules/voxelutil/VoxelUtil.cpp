@@ -5,22 +5,22 @@
 #include "VoxelUtil.h"
 #include "core/GLM.h"
 #include "core/Log.h"
-#include "core/collection/Array3DView.h"
-#include "core/collection/Buffer.h"
 #include "core/collection/DynamicArray.h"
-#include "core/collection/Set.h"
+#include "core/NonCopyable.h"
+#include "core/Trace.h"
+#include "core/collection/BitSet.h"
 #include <glm/geometric.hpp>
 #include "math/Axis.h"
 #include "palette/Palette.h"
 #include "palette/PaletteLookup.h"
 #include "voxel/Face.h"
-#include "voxel/ModificationRecorder.h"
+#include "voxel/OccupancyMask.h"
 #include "voxel/RawVolume.h"
 #include "voxel/RawVolumeWrapper.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
+#include "voxelutil/ScanlineFill.h"
 #include "voxelutil/VolumeVisitor.h"
-#include <functional>
 
 namespace voxelutil {
 
@@ -70,19 +70,12 @@ glm::vec3 calculateNormal(voxel::RawVolume::Sampler &sampler, voxel::Connectivit
 	return glm::normalize(glm::vec3(sum));
 }
 
-bool isTouching(const voxel::RawVolume &volume, const glm::ivec3 &pos, voxel::Connectivity connectivity) {
-	voxel::RawVolume::Sampler sampler(volume);
-	if (!sampler.setPosition(pos)) {
-		return false;
-	}
+template<class IsSolid>
+static bool isTouching(IsSolid &&isSolid, voxel::Connectivity connectivity) {
 	switch (connectivity) {
 	case voxel::Connectivity::TwentySixConnected:
 		for (const glm::ivec3 &offset : voxel::arrayPathfinderCorners) {
-			const glm::ivec3 &volPos = pos + offset;
-			if (!sampler.setPosition(volPos)) {
-				continue;
-			}
-			if (voxel::isBlocked(sampler.voxel().getMaterial())) {
+			if (isSolid(offset)) {
 				return true;
 			}
 		}
@@ -90,11 +83,7 @@ bool isTouching(const voxel::RawVolume &volume, const glm::ivec3 &pos, voxel::Co
 
 	case voxel::Connectivity::EighteenConnected:
 		for (const glm::ivec3 &offset : voxel::arrayPathfinderEdges) {
-			const glm::ivec3 &volPos = pos + offset;
-			if (!sampler.setPosition(volPos)) {
-				continue;
-			}
-			if (voxel::isBlocked(sampler.voxel().getMaterial())) {
+			if (isSolid(offset)) {
 				return true;
 			}
 		}
@@ -102,11 +91,7 @@ bool isTouching(const voxel::RawVolume &volume, const glm::ivec3 &pos, voxel::Co
 
 	case voxel::Connectivity::SixConnected:
 		for (const glm::ivec3 &offset : voxel::arrayPathfinderFaces) {
-			const glm::ivec3 &volPos = pos + offset;
-			if (!sampler.setPosition(volPos)) {
-				continue;
-			}
-			if (voxel::isBlocked(sampler.voxel().getMaterial())) {
+			if (isSolid(offset)) {
 				return true;
 			}
 		}
@@ -115,6 +100,35 @@ bool isTouching(const voxel::RawVolume &volume, const glm::ivec3 &pos, voxel::Co
 	return false;
 }
 
+bool isTouching(const voxel::RawVolume &volume, const glm::ivec3 &pos, voxel::Connectivity connectivity) {
+	const voxel::Region &region = volume.region();
+	if (!region.containsPoint(pos)) {
+		return false;
+	}
+	if (const voxel::OccupancyMask *mask = volume.occupancy()) {
+		const glm::ivec3 localPos = pos - region.getLowerCorner();
+		const glm::ivec3 &dim = mask->dimensions();
+		return isTouching(
+			[&](const glm::ivec3 &offset) {
+				const glm::ivec3 p = localPos + offset;
+				if (p.x < 0 || p.y < 0 || p.z < 0 || p.x >= dim.x || p.y >= dim.y || p.z >= dim.z) {
+					return false;
+				}
+				return mask->isSolid(p);
+			},
+			connectivity);
+	}
+	voxel::RawVolume::Sampler sampler(volume);
+	return isTouching(
+		[&](const glm::ivec3 &offset) {
+			if (!sampler.setPosition(pos + offset)) {
+				return false;
+			}
+			return voxel::isBlocked(sampler.voxel().getMaterial());
+		},
+		connectivity);
+}
+
 voxel::Voxel getInterpolated(const voxel::RawVolumeWrapper &volume, const glm::ivec3 &pos, const palette::Palette &palette) {
 	voxel::RawVolumeWrapper::Sampler sampler3(volume);
 	sampler3.setPosition(pos);
@@ -161,6 +175,31 @@ voxel::Voxel getInterpolated(const voxel::RawVolumeWrapper &volume, const glm::i
 }
 
 bool isEmpty(const voxel::RawVolume &v, const voxel::Region &region) {
+	const voxel::Region &volumeRegion = v.region();
+	if (const voxel::OccupancyMask *mask = v.occupancy()) {
+		// the parts outside of the volume are the border voxels
+		if (voxel::isAir(v.borderValue().getMaterial()) || volumeRegion.containsRegion(region)) {
+			const glm::ivec3 &lower = volumeRegion.getLowerCorner();
+			return mask->isEmpty(region.getLowerCorner() - lower, region.getUpperCorner() - lower);
+		}
+	}
+	if (volumeRegion.containsRegion(region)) {
+		// walk the rows in memory order
+		const int32_t width = region.getWidthInVoxels();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				const voxel::Voxel *row = v.row(glm::ivec3(region.getLowerX(), y, z));
+				bool blocked = false;
+				for (int32_t x = 0; x < width; ++x) {
+					blocked |= voxel::isBlocked(row[x].getMaterial());
+				}
+				if (blocked) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
 	voxel::RawVolume::Sampler sampler(v);
 	for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += 1) {
 		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += 1) {
@@ -178,6 +217,41 @@ bool isEmpty(const voxel::RawVolume &v, const voxel::Region &region) {
 
 bool copy(const voxel::RawVolume &volume, const voxel::Region &inRegion, voxel::RawVolume &out,
 		  const voxel::Region &outRegion) {
+	const glm::ivec3 dim = glm::min(inRegion.getDimensionsInVoxels(), outRegion.getDimensionsInVoxels());
+	const voxel::Region inCopyRegion(inRegion.getLowerCorner(), inRegion.getLowerCorner() + dim - 1);
+	const voxel::Region outCopyRegion(outRegion.getLowerCorner(), outRegion.getLowerCorner() + dim - 1);
+	if (volume.region().containsRegion(inCopyRegion) && out.region().containsRegion(outCopyRegion)) {
+		// copy row by row in memory order - no border or region checks are needed per voxel
+		bool changed = false;
+		for (int32_t z = 0; z < dim.z; ++z) {
+			for (int32_t y = 0; y < dim.y; ++y) {
+				const glm::ivec3 inPos = inCopyRegion.getLowerCorner() + glm::ivec3(0, y, z);
+				const glm::ivec3 outPos = outCopyRegion.getLowerCorner() + glm::ivec3(0, y, z);
+				const voxel::Voxel *src = volume.row(inPos);
+				if (!changed) {
+					const voxel::Voxel *dst = out.row(outPos);
+					int32_t x = 0;
+					while (x < dim.x && dst[x].isSame(src[x])) {
+						++x;
+					}
+					if (x == dim.x) {
+						// don't detach shared voxel data if nothing changes
+						continue;
+					}
+					changed = true;
+				}
+				voxel::Voxel *dst = out.writableRow(outPos);
+				for (int32_t x = 0; x < dim.x; ++x) {
+					if (!dst[x].isSame(src[x])) {
+						dst[x] = src[x];
+					}
+				}
+				out.updateOccupancy(outPos);
+			}
+		}
+		return changed;
+	}
+
 	int32_t xIn, yIn, zIn;
 	int32_t xOut, yOut, zOut;
 	voxel::RawVolumeWrapper wrapper(&out);
@@ -201,111 +275,46 @@ bool copyIntoRegion(const voxel::RawVolume &in, voxel::RawVolume &out, const vox
 }
 
 void fillHollow(voxel::RawVolumeWrapper &volume, const voxel::Voxel &voxel) {
+	core_trace_scoped(FillHollow);
 	const voxel::Region &region = volume.region();
-	const int width = region.getWidthInVoxels();
-	const int height = region.getHeightInVoxels();
-	const int depth = region.getDepthInVoxels();
-	const int size = width * height * depth;
-	const glm::ivec3 mins = volume.region().getLowerCorner();
-	core::DynamicArray<glm::ivec3> positions;
-	positions.reserve(size);
-	core::Buffer<bool> visitedData(size);
-	core::Array3DView<bool> visited(visitedData.data(), width, height, depth);
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	ScanlineFill fill(region);
 
+	// the solid voxels are the walls - transparent voxels at the border of the region let the fill leak in
 	visitVolume(
 		volume, region, 1, 1, 1,
-		[&](int x, int y, int z, const voxel::Voxel &) { visited.set(x - mins.x, y - mins.y, z - mins.z, true); },
+		[&](int x, int y, int z, const voxel::Voxel &v) {
+			if (!voxel::isTransparent(v.getMaterial()) || !region.isOnBorder(glm::ivec3(x, y, z))) {
+				fill.mark(x, y, z);
+			}
+		},
 		SkipEmpty());
 
-	for (int x = 0; x < width; ++x) {
-		for (int z = 1; z < depth - 1; ++z) {
-			const glm::ivec3 v1(x, 0, z);
-			const voxel::VoxelType m1 = volume.voxel(v1 + mins).getMaterial();
-			if (voxel::isAir(m1) || voxel::isTransparent(m1)) {
-				positions.push_back(v1);
-				visited.set(v1, true);
-			}
-			const glm::ivec3 v2(x, height - 1, z);
-			const voxel::VoxelType m2 = volume.voxel(v2 + mins).getMaterial();
-			if (voxel::isAir(m2) || voxel::isTransparent(m2)) {
-				positions.push_back(v2);
-				visited.set(v2, true);
-			}
-		}
-		for (int y = 0; y < height; ++y) {
-			const glm::ivec3 v1(x, y, 0);
-			const voxel::VoxelType m1 = volume.voxel(v1 + mins).getMaterial();
-			if (voxel::isAir(m1) || voxel::isTransparent(m1)) {
-				positions.push_back(v1);
-				visited.set(v1, true);
-			}
-			const glm::ivec3 v2(x, y, depth - 1);
-			const voxel::VoxelType m2 = volume.voxel(v2 + mins).getMaterial();
-			if (voxel::isAir(m2) || voxel::isTransparent(m2)) {
-				positions.push_back(v2);
-				visited.set(v2, true);
-			}
-		}
-	}
-	for (int y = 1; y < height - 1; ++y) {
-		for (int z = 1; z < depth - 1; ++z) {
-			const glm::ivec3 v1(0, y, z);
-			const voxel::VoxelType m1 = volume.voxel(v1 + mins).getMaterial();
-			if (voxel::isAir(m1) || voxel::isTransparent(m1)) {
-				positions.push_back(v1);
-				visited.set(v1, true);
-			}
-			const glm::ivec3 v2(width - 1, y, z);
-			const voxel::VoxelType m2 = volume.voxel(v2 + mins).getMaterial();
-			if (voxel::isAir(m2) || voxel::isTransparent(m2)) {
-				positions.push_back(v2);
-				visited.set(v2, true);
+	// everything that is reachable from the border of the region is outside
+	auto noop = [](int, int, int, int) {};
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			if (z == mins.z || z == maxs.z || y == mins.y || y == maxs.y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					fill.fill(x, y, z, noop);
+				}
+			} else {
+				fill.fill(mins.x, y, z, noop);
+				fill.fill(maxs.x, y, z, noop);
 			}
 		}
 	}
 
-	while (!positions.empty()) {
-		const glm::ivec3 v = positions.back();
-		positions.erase(positions.size() - 1);
-
-		if (v.z > 0 && !visited.get(v.x, v.y, v.z - 1)) {
-			const glm::ivec3 v1(v.x, v.y, v.z - 1);
-			visited.set(v1, true);
-			positions.push_back(v1);
-		}
-		if (v.y > 0 && !visited.get(v.x, v.y - 1, v.z)) {
-			const glm::ivec3 v1(v.x, v.y - 1, v.z);
-			visited.set(v1, true);
-			positions.push_back(v1);
-		}
-		if (v.x > 0 && !visited.get(v.x - 1, v.y, v.z)) {
-			const glm::ivec3 v1(v.x - 1, v.y, v.z);
-			visited.set(v1, true);
-			positions.push_back(v1);
-		}
-		if (v.z < depth - 1 && !visited.get(v.x, v.y, v.z + 1)) {
-			const glm::ivec3 v1(v.x, v.y, v.z + 1);
-			visited.set(v1, true);
-			positions.push_back(v1);
-		}
-		if (v.y < height - 1 && !visited.get(v.x, v.y + 1, v.z)) {
-			const glm::ivec3 v1(v.x, v.y + 1, v.z);
-			visited.set(v1, true);
-			positions.push_back(v1);
-		}
-		if (v.x < width - 1 && !visited.get(v.x + 1, v.y, v.z)) {
-			const glm::ivec3 v1(v.x + 1, v.y, v.z);
-			visited.set(v1, true);
-			positions.push_back(v1);
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			for (int x = mins.x; x <= maxs.x; ++x) {
+				if (!fill.marked(x, y, z)) {
+					volume.setVoxel(x, y, z, voxel);
+				}
+			}
 		}
 	}
-
-	auto visitor = [&](int x, int y, int z, const voxel::Voxel &) {
-		if (!visited.get(x - mins.x, y - mins.y, z - mins.z)) {
-			volume.setVoxel(x, y, z, voxel);
-		}
-	};
-	visitVolume(volume, region, 1, 1, 1, visitor, VisitAll());
 }
 
 bool fillCheckerboard(voxel::RawVolumeWrapper &volume, const palette::Palette &palette) {
@@ -349,59 +358,86 @@ void clear(voxel::RawVolumeWrapper &in) {
 	in.clear();
 }
 
-using IVec3Set = core::Set<glm::ivec3, 11, glm::hash<glm::ivec3>>;
-using WalkCheckCallback = std::function<bool(const voxel::RawVolumeWrapper &, const glm::ivec3 &, voxel::FaceNames)>;
-using WalkExecCallback = std::function<bool(voxel::RawVolumeWrapper &, const glm::ivec3 &)>;
+/**
+ * @brief Records the voxels that a plane walk places - but doesn't modify the volume
+ *
+ * All plane operations place the same voxel - so a bit mask over the region of the walk is enough to remember the
+ * placed voxels. The later layers of an extrusion check the voxels that were placed for the previous layers.
+ */
+class PlaneRecorder : public core::NonCopyable {
+private:
+	const voxel::RawVolume &_volume;
+	const voxel::Region _walkRegion;
+	const voxel::Voxel _voxel;
+	core::BitSet _placed;
+	voxel::Region _dirtyRegion = voxel::Region::InvalidRegion;
 
-template<class CHECK, class EXEC, class Volume>
-static int walkPlane_r(IVec3Set &visited, Volume &volume, const voxel::Region &region,
-					   CHECK &&check, EXEC &&exec, const glm::ivec3 &position,
-					   const glm::ivec3 &offsetForCheckCallback, voxel::FaceNames face) {
-	const glm::ivec3 checkPosition = position + offsetForCheckCallback;
-	if (visited.has(checkPosition)) {
-		return 0;
+	inline size_t index(const glm::ivec3 &pos) const {
+		const glm::ivec3 local = pos - _walkRegion.getLowerCorner();
+		const glm::ivec3 &dim = _walkRegion.getDimensionsInVoxels();
+		return (size_t)local.x + (size_t)dim.x * ((size_t)local.y + (size_t)dim.y * (size_t)local.z);
 	}
-	visited.insert(checkPosition);
-	if (!region.containsPoint(position)) {
-		return 0;
-	}
-	if (!check(volume, checkPosition, face)) {
-		return 0;
-	}
-	if (!exec(volume, position)) {
-		return 0;
-	}
-	int n = 1;
-	if (region.containsPoint(position.x + 1, position.y, position.z)) {
-		n += walkPlane_r(visited, volume, region, check, exec, glm::ivec3(position.x + 1, position.y, position.z),
-						 offsetForCheckCallback, face);
+
+public:
+	PlaneRecorder(const voxel::RawVolume &volume, const voxel::Region &walkRegion, const voxel::Voxel &voxel)
+		: _volume(volume), _walkRegion(walkRegion), _voxel(voxel),
+		  _placed(walkRegion.isValid() ? (int)walkRegion.voxels() : 0) {
 	}
-	if (region.containsPoint(position.x - 1, position.y, position.z)) {
-		n += walkPlane_r(visited, volume, region, check, exec, glm::ivec3(position.x - 1, position.y, position.z),
-						 offsetForCheckCallback, face);
+
+	inline const voxel::Region &region() const {
+		return _volume.region();
 	}
-	if (region.containsPoint(position.x, position.y + 1, position.z)) {
-		n += walkPlane_r(visited, volume, region, check, exec, glm::ivec3(position.x, position.y + 1, position.z),
-						 offsetForCheckCallback, face);
+
+	inline const voxel::Voxel &voxel(const glm::ivec3 &pos) const {
+		if (_walkRegion.containsPoint(pos) && _placed[index(pos)]) {
+			return _voxel;
+		}
+		return _volume.voxel(pos);
 	}
-	if (region.containsPoint(position.x, position.y - 1, position.z)) {
-		n += walkPlane_r(visited, volume, region, check, exec, glm::ivec3(position.x, position.y - 1, position.z),
-						 offsetForCheckCallback, face);
+
+	inline bool setVoxel(const glm::ivec3 &pos, const voxel::Voxel &voxel) {
+		core_assert(voxel.isSame(_voxel));
+		if (!_walkRegion.containsPoint(pos)) {
+			return false;
+		}
+		_placed.set(index(pos), true);
+		if (_dirtyRegion.isValid()) {
+			_dirtyRegion.accumulate(pos);
+		} else {
+			_dirtyRegion = voxel::Region(pos, pos);
+		}
+		return true;
 	}
-	if (region.containsPoint(position.x, position.y, position.z + 1)) {
-		n += walkPlane_r(visited, volume, region, check, exec, glm::ivec3(position.x, position.y, position.z + 1),
-						 offsetForCheckCallback, face);
+
+	inline const voxel::Region &dirtyRegion() const {
+		return _dirtyRegion;
 	}
-	if (region.containsPoint(position.x, position.y, position.z - 1)) {
-		n += walkPlane_r(visited, volume, region, check, exec, glm::ivec3(position.x, position.y, position.z - 1),
-						 offsetForCheckCallback, face);
+};
+
+/**
+ * @brief The region that a plane walk with the given amount of layers can touch
+ */
+static voxel::Region planeWalkRegion(const voxel::Region &region, const glm::ivec3 &position, voxel::FaceNames face,
+								int amount) {
+	const math::Axis axis = voxel::faceToAxis(face);
+	if (axis == math::Axis::None || amount <= 0) {
+		return voxel::Region::InvalidRegion;
 	}
-	return n;
+	const int idx = math::getIndexForAxis(axis);
+	glm::ivec3 mins = region.getLowerCorner();
+	glm::ivec3 maxs = region.getUpperCorner();
+	const int lastLayer = position[idx] + (voxel::isNegativeFace(face) ? 1 - amount : amount - 1);
+	mins[idx] = core_min(position[idx], lastLayer);
+	maxs[idx] = core_max(position[idx], lastLayer);
+	return voxel::Region(mins, maxs);
 }
 
 /**
  * @brief Walks a plane in a voxel volume based on the given position and face direction.
  *
+ * The connected voxels of a layer are collected with a work list - a bit mask of the layer marks the visited voxels and
+ * is reused for all layers.
+ *
  * @param volume The voxel volume to walk the plane in.
  * @param position The position in the voxel volume to start the walk from.
  * @param face The direction of the face to walk the plane in.
@@ -415,6 +451,7 @@ static int walkPlane_r(IVec3Set &visited, Volume &volume, const voxel::Region &r
 template<class CHECK, class EXEC, class Volume>
 static int walkPlane(Volume &volume, glm::ivec3 position, voxel::FaceNames face, int checkOffset,
 					 CHECK&& checkCallback, EXEC &&execCallback, int amount) {
+	core_trace_scoped(WalkPlane);
 	const math::Axis axis = voxel::faceToAxis(face);
 	if (axis == math::Axis::None) {
 		return -1;
@@ -427,6 +464,9 @@ static int walkPlane(Volume &volume, glm::ivec3 position, voxel::FaceNames face,
 	glm::ivec3 maxs = region.getUpperCorner();
 	mins[idx] = position[idx];
 	maxs[idx] = position[idx];
+	if (!voxel::Region(mins, maxs).isValid()) {
+		return 0;
+	}
 
 	// which voxel should we check on
 	glm::ivec3 offsetForCheckCallback(0);
@@ -438,16 +478,50 @@ static int walkPlane(Volume &volume, glm::ivec3 position, voxel::FaceNames face,
 
 	const int walkOffset = negativeFace ? -1 : 1;
 
+	// all layers have the same dimensions - the size along the walk axis is one
+	const glm::ivec3 dim = maxs - mins + 1;
+	core::BitSet visited(dim.x * dim.y * dim.z);
+	core::DynamicArray<glm::ivec3> frontier;
+
 	int n = 0;
 	for (int i = 0; i < amount; ++i) {
 		const voxel::Region walkRegion(mins, maxs);
-		if (!walkRegion.isValid()) {
-			return 0;
+		if (!walkRegion.containsPoint(position)) {
+			break;
+		}
+		auto visit = [&](const glm::ivec3 &p) {
+			const glm::ivec3 local = p - mins;
+			const size_t visitedIdx = (size_t)local.x + (size_t)dim.x * ((size_t)local.y + (size_t)dim.y * (size_t)local.z);
+			if (visited[visitedIdx]) {
+				return;
+			}
+			visited.set(visitedIdx, true);
+			frontier.push_back(p);
+		};
+		visited.clear();
+		frontier.clear();
+		visit(position);
+		int n0 = 0;
+		while (!frontier.empty()) {
+			const glm::ivec3 p = frontier.back();
+			frontier.pop();
+			if (!checkCallback(volume, p + offsetForCheckCallback, face)) {
+				continue;
+			}
+			if (!execCallback(volume, p)) {
+				continue;
+			}
+			++n0;
+			for (const glm::ivec3 &offset : voxel::arrayPathfinderFaces) {
+				if (offset[idx] != 0) {
+					continue;
+				}
+				const glm::ivec3 neighbour = p + offset;
+				if (walkRegion.containsPoint(neighbour)) {
+					visit(neighbour);
+				}
+			}
 		}
-		const glm::ivec3 &dim = walkRegion.getDimensionsInVoxels();
-		const int maxSize = dim.x * dim.y * dim.z;
-		IVec3Set visited(maxSize);
-		const int n0 = walkPlane_r(visited, volume, walkRegion, checkCallback, execCallback, position, offsetForCheckCallback, face);
 		if (n0 == 0) {
 			break;
 		}
@@ -506,11 +580,11 @@ voxel::Region overridePlaneRegion(const voxel::RawVolume &volume, const glm::ive
 								  const voxel::Voxel &replaceVoxel) {
 	bool firstVoxelIsAir = false;
 	bool firstVoxel = true;
-	auto check = [&](const voxel::ModificationRecorder &in, const glm::ivec3 &p, voxel::FaceNames) {
+	auto check = [&](const PlaneRecorder &in, const glm::ivec3 &p, voxel::FaceNames) {
 		return checkOverrideFunc(in, p, replaceVoxel, face, firstVoxelIsAir, firstVoxel);
 	};
-	auto exec = [=](voxel::ModificationRecorder &in, const glm::ivec3 &p) { return in.setVoxel(p, replaceVoxel); };
-	voxel::ModificationRecorder recorder(volume);
+	auto exec = [=](PlaneRecorder &in, const glm::ivec3 &p) { return in.setVoxel(p, replaceVoxel); };
+	PlaneRecorder recorder(volume, planeWalkRegion(volume.region(), pos, face, 1), replaceVoxel);
 	voxelutil::walkPlane(recorder, pos, face, -1, check, exec, 1);
 	return recorder.dirtyRegion();
 }
@@ -554,13 +628,13 @@ int erasePlane(voxel::RawVolumeWrapper &volume, const glm::ivec3 &pos, voxel::Fa
 }
 
 voxel::Region erasePlaneRegion(const voxel::RawVolume &volume, const glm::ivec3 &pos, voxel::FaceNames face, const voxel::Voxel &groundVoxel) {
-	auto check = [&](const voxel::ModificationRecorder &in, const glm::ivec3 &p, voxel::FaceNames) {
+	auto check = [&](const PlaneRecorder &in, const glm::ivec3 &p, voxel::FaceNames) {
 		return checkEraseFunc(in, p, groundVoxel, face);
 	};
-	auto exec = [](voxel::ModificationRecorder &in, const glm::ivec3 &p) {
+	auto exec = [](PlaneRecorder &in, const glm::ivec3 &p) {
 		return in.setVoxel(p, voxel::Voxel());
 	};
-	voxel::ModificationRecorder recorder(volume);
+	PlaneRecorder recorder(volume, planeWalkRegion(volume.region(), pos, face, 1), voxel::Voxel());
 	voxelutil::walkPlane(recorder, pos, face, 0, check, exec, 1);
 	return recorder.dirtyRegion();
 }
@@ -581,15 +655,15 @@ static bool checkExtrudeFunc(Volume &volume, const glm::ivec3 &callbackPos,
 
 voxel::Region extrudePlaneRegion(const voxel::RawVolume &volume, const glm::ivec3 &pos, voxel::FaceNames face,
 				 const voxel::Voxel &groundVoxel, const voxel::Voxel &newPlaneVoxel, int thickness) {
-	auto check = [&](voxel::ModificationRecorder &in, const glm::ivec3 &p, voxel::FaceNames direction) {
+	auto check = [&](const PlaneRecorder &in, const glm::ivec3 &p, voxel::FaceNames direction) {
 		return checkExtrudeFunc(in, p, direction, pos, groundVoxel, newPlaneVoxel);
 	};
 
-	auto exec = [&](voxel::ModificationRecorder &in, const glm::ivec3 &p) {
+	auto exec = [&](PlaneRecorder &in, const glm::ivec3 &p) {
 		in.setVoxel(p, newPlaneVoxel);
 		return true;
 	};
-	voxel::ModificationRecorder recorder(volume);
+	PlaneRecorder recorder(volume, planeWalkRegion(volume.region(), pos, face, thickness), newPlaneVoxel);
 	voxelutil::walkPlane(recorder, pos, face, -1, check, exec, thickness);
 	return recorder.dirtyRegion();
 }
@@ -631,22 +705,108 @@ int fillPlane(voxel::RawVolumeWrapper &volume, const image::ImagePtr &image, con
 	return walkPlane(volume, position, face, -1, check, exec, 1);
 }
 
+static constexpr int RemapNotDone = -2;
+
 voxel::Region remapToPalette(voxel::RawVolume *volume, const palette::Palette &oldPalette,
 							 const palette::Palette &newPalette, int skipColorIndex) {
 	if (volume == nullptr) {
 		return voxel::Region::InvalidRegion;
 	}
-	voxel::RawVolumeWrapper wrapper(volume);
-	voxelutil::visitVolume(
-		wrapper, [&wrapper, &newPalette, skipColorIndex, &oldPalette](int x, int y, int z, const voxel::Voxel &voxel) {
-			const core::RGBA rgba = oldPalette.color(voxel.getColor());
-			const int newColor = newPalette.getClosestMatch(rgba, skipColorIndex);
-			if (newColor != palette::PaletteColorNotFound) {
-				voxel::Voxel newVoxel(voxel::VoxelType::Generic, newColor, voxel.getNormal(), voxel.getFlags());
-				wrapper.setVoxel(x, y, z, newVoxel);
+	// the closest match is only searched once per palette color
+	int colorLookup[palette::PaletteMaxColors];
+	for (int i = 0; i < palette::PaletteMaxColors; ++i) {
+		colorLookup[i] = RemapNotDone;
+	}
+	const voxel::Region &region = volume->region();
+	const int32_t width = region.getWidthInVoxels();
+	glm::ivec3 dirtyMins(INT32_MAX);
+	glm::ivec3 dirtyMaxs(INT32_MIN);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			const glm::ivec3 rowPos(region.getLowerX(), y, z);
+			voxel::Voxel *row = nullptr;
+			const voxel::Voxel *readRow = volume->row(rowPos);
+			for (int32_t x = 0; x < width; ++x) {
+				const voxel::Voxel &voxel = row == nullptr ? readRow[x] : row[x];
+				if (voxel::isAir(voxel.getMaterial())) {
+					continue;
+				}
+				int &newColor = colorLookup[voxel.getColor()];
+				if (newColor == RemapNotDone) {
+					newColor = newPalette.getClosestMatch(oldPalette.color(voxel.getColor()), skipColorIndex);
+				}
+				if (newColor == palette::PaletteColorNotFound) {
+					continue;
+				}
+				const voxel::Voxel newVoxel(voxel::VoxelType::Generic, newColor, voxel.getNormal(), voxel.getFlags());
+				if (voxel.isSame(newVoxel)) {
+					continue;
+				}
+				if (row == nullptr) {
+					// only get exclusive access to shared voxel data if something changes
+					row = volume->writableRow(rowPos);
+				}
+				row[x] = newVoxel;
+				const glm::ivec3 pos(region.getLowerX() + x, y, z);
+				dirtyMins = glm::min(dirtyMins, pos);
+				dirtyMaxs = glm::max(dirtyMaxs, pos);
+			}
+		}
+	}
+	if (dirtyMins.x == INT32_MAX) {
+		return voxel::Region::InvalidRegion;
+	}
+	return voxel::Region(dirtyMins, dirtyMaxs);
+}
+
+voxel::Region remapColors(voxel::RawVolume *volume, const palette::Palette &palette, const uint8_t *mapping) {
+	if (volume == nullptr) {
+		return voxel::Region::InvalidRegion;
+	}
+	bool identity = true;
+	for (int i = 0; i < palette::PaletteMaxColors; ++i) {
+		if (mapping[i] != i) {
+			identity = false;
+			break;
+		}
+	}
+	if (identity) {
+		return voxel::Region::InvalidRegion;
+	}
+	const voxel::Region &region = volume->region();
+	const int32_t width = region.getWidthInVoxels();
+	glm::ivec3 dirtyMins(INT32_MAX);
+	glm::ivec3 dirtyMaxs(INT32_MIN);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			const glm::ivec3 rowPos(region.getLowerX(), y, z);
+			voxel::Voxel *row = nullptr;
+			const voxel::Voxel *readRow = volume->row(rowPos);
+			for (int32_t x = 0; x < width; ++x) {
+				const voxel::Voxel &voxel = row == nullptr ? readRow[x] : row[x];
+				if (voxel::isAir(voxel.getMaterial())) {
+					continue;
+				}
+				const uint8_t newColor = mapping[voxel.getColor()];
+				if (newColor == voxel.getColor()) {
+					continue;
+				}
+				const voxel::VoxelType type =
+					palette.color(newColor).a != 255 ? voxel::VoxelType::Transparent : voxel::VoxelType::Generic;
+				if (row == nullptr) {
+					row = volume->writableRow(rowPos);
+				}
+				row[x] = voxel::Voxel(type, newColor, voxel.getNormal(), voxel.getFlags());
+				const glm::ivec3 pos(region.getLowerX() + x, y, z);
+				dirtyMins = glm::min(dirtyMins, pos);
+				dirtyMaxs = glm::max(dirtyMaxs, pos);
 			}
-		});
-	return wrapper.dirtyRegion();
+		}
+	}
+	if (dirtyMins.x == INT32_MAX) {
+		return voxel::Region::InvalidRegion;
+	}
+	return voxel::Region(dirtyMins, dirtyMaxs);
 }
 
 voxel::RawVolume *diffVolumes(const voxel::RawVolume *v1, const voxel::RawVolume *v2) {
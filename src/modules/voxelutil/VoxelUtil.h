@@ -164,6 +164,18 @@ void clear(voxel::RawVolumeWrapper &in);
  */
 voxel::Region remapToPalette(voxel::RawVolume *v, const palette::Palette &oldPalette, const palette::Palette &newPalette, int skipColorIndex = -1);
 
+/**
+ * @brief Changes the palette color indices of all voxels by the given lookup table
+ *
+ * This is used for palette changes that only move colors to other slots. Voxels with a color index that maps to itself
+ * are not touched - the rendered result only changes for the voxels that got a new index.
+ *
+ * @param palette The palette the new color indices belong to - the voxel type of the remapped voxels is taken from it
+ * @param mapping The new color index for each of the @c palette::PaletteMaxColors old color indices
+ * @return The region of the volume that was changed - or an invalid region if no voxel changed
+ */
+voxel::Region remapColors(voxel::RawVolume *v, const palette::Palette &palette, const uint8_t *mapping);
+
 /**
  * @brief Creates a diff between the two given volumes
  * @note The caller has to free the volume
@@ -3,8 +3,14 @@
  */
 
 #include "app/benchmark/AbstractBenchmark.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
+#include "image/Image.h"
+#include "palette/Palette.h"
 #include "voxel/RawVolume.h"
+#include "voxelutil/ImageUtils.h"
 #include "voxelutil/VolumeVisitor.h"
+#include "voxelutil/VoxelUtil.h"
 
 class VoxelVisitorBenchmark : public app::AbstractBenchmark {
 protected:
@@ -36,8 +42,116 @@ BENCHMARK_DEFINE_F(VoxelVisitorBenchmark, Visit)(benchmark::State &state) {
 		const voxelutil::VisitorOrder order = (voxelutil::VisitorOrder)(state.range());
 		visitOrder(order, v);
 	}
+	addVoxelCounter(state, v.region().voxels());
 }
 
 BENCHMARK_REGISTER_F(VoxelVisitorBenchmark, Visit)->DenseRange(0, (int)(voxelutil::VisitorOrder::Max)-1);
 
+class VoxelUtilBenchmark : public app::AbstractBenchmark {
+protected:
+	voxel::RawVolume v{voxel::Region{0, 127}};
+	palette::Palette pal;
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		pal.nippon();
+		for (int z = 0; z < 128; ++z) {
+			for (int y = 0; y < 64; ++y) {
+				for (int x = 0; x < 128; ++x) {
+					v.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (x + y + z) % 255));
+				}
+			}
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, IsEmpty)(benchmark::State &state) {
+	const voxel::Region region(0, 64, 0, 127, 127, 127);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(voxelutil::isEmpty(v, region));
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, Copy)(benchmark::State &state) {
+	for (auto _ : state) {
+		voxel::RawVolume out(v.region());
+		benchmark::DoNotOptimize(voxelutil::copyIntoRegion(v, out, out.region()));
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, RemapToPalette)(benchmark::State &state) {
+	palette::Palette newPal;
+	newPal.minecraft();
+	for (auto _ : state) {
+		voxel::RawVolume copy(v);
+		benchmark::DoNotOptimize(voxelutil::remapToPalette(&copy, pal, newPal));
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, Visit)(benchmark::State &state) {
+	for (auto _ : state) {
+		int n = 0;
+		voxelutil::visitVolume(v, [&](int, int, int, const voxel::Voxel &voxel) { n += voxel.getColor(); });
+		benchmark::DoNotOptimize(n);
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, VisitParallel)(benchmark::State &state) {
+	for (auto _ : state) {
+		core::AtomicInt n{0};
+		voxelutil::visitVolumeParallel(
+			v, [&](int, int, int, const voxel::Voxel &voxel) { n.increment(voxel.getColor()); },
+			&_benchmarkApp->threadPool());
+		benchmark::DoNotOptimize((int)n);
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, Reduce)(benchmark::State &state) {
+	for (auto _ : state) {
+		const int n = voxelutil::reduceVolume(
+			v, v.region(), 0, [](int &acc, int, int, int, const voxel::Voxel &voxel) { acc += voxel.getColor(); },
+			[](int &result, const int &acc) { result += acc; }, nullptr);
+		benchmark::DoNotOptimize(n);
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, ReduceParallel)(benchmark::State &state) {
+	for (auto _ : state) {
+		const int n = voxelutil::reduceVolume(
+			v, v.region(), 0, [](int &acc, int, int, int, const voxel::Voxel &voxel) { acc += voxel.getColor(); },
+			[](int &result, const int &acc) { result += acc; }, &_benchmarkApp->threadPool());
+		benchmark::DoNotOptimize(n);
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, ImportAsPlane)(benchmark::State &state) {
+	const int size = 512;
+	core::DynamicArray<core::RGBA> pixels;
+	pixels.resize(size * size);
+	for (int y = 0; y < size; ++y) {
+		for (int x = 0; x < size; ++x) {
+			pixels[y * size + x] = core::RGBA(x / 2, y / 2, (x + y) / 4, 255);
+		}
+	}
+	image::Image image("gradient");
+	image.loadRGBA((const uint8_t *)pixels.data(), size, size);
+	const bool dither = state.range() != 0;
+	for (auto _ : state) {
+		voxel::RawVolume *volume = voxelutil::importAsPlane(&image, pal, 1, dither, &_benchmarkApp->threadPool());
+		benchmark::DoNotOptimize(volume);
+		delete volume;
+	}
+	state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, IsEmpty);
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, Copy);
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, RemapToPalette);
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, Visit);
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, VisitParallel);
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, Reduce);
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, ReduceParallel);
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, ImportAsPlane)->Arg(0)->Arg(1);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#include "voxelutil/DistanceField.h"
+#include "app/tests/AbstractTest.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
+
+namespace voxelutil {
+
+class DistanceFieldTest : public app::AbstractTest {
+protected:
+	// brute force reference implementation
+	static uint32_t nearest(const voxel::RawVolume &volume, const glm::ivec3 &pos, bool toAir) {
+		const voxel::Region &region = volume.region();
+		uint32_t best = DistanceField::MaxSquaredDistance;
+		for (int z = region.getLowerZ() - 1; z <= region.getUpperZ() + 1; ++z) {
+			for (int y = region.getLowerY() - 1; y <= region.getUpperY() + 1; ++y) {
+				for (int x = region.getLowerX() - 1; x <= region.getUpperX() + 1; ++x) {
+					const bool air = !region.containsPoint(x, y, z) || voxel::isAir(volume.voxel(x, y, z).getMaterial());
+					if (air != toAir) {
+						continue;
+					}
+					const glm::ivec3 d = glm::ivec3(x, y, z) - pos;
+					best = glm::min(best, (uint32_t)(d.x * d.x + d.y * d.y + d.z * d.z));
+				}
+			}
+		}
+		return best;
+	}
+};
+
+TEST_F(DistanceFieldTest, testDistanceToSolid) {
+	voxel::RawVolume volume(voxel::Region(glm::ivec3(-2, 0, 3), glm::ivec3(9, 7, 12)));
+	volume.setVoxel(0, 0, 3, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	volume.setVoxel(9, 7, 12, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	volume.setVoxel(4, 3, 8, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	DistanceField field(volume.region());
+	computeDistanceField(volume, volume.region(), field);
+	EXPECT_EQ(0u, field.squaredDistance(4, 3, 8));
+	EXPECT_EQ(1u, field.squaredDistance(4, 4, 8));
+	EXPECT_EQ(3u, field.squaredDistance(5, 4, 9));
+	EXPECT_FLOAT_EQ(2.0f, field.distance(-2, 0, 3));
+	const voxel::Region &region = volume.region();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				ASSERT_EQ(nearest(volume, glm::ivec3(x, y, z), false), field.squaredDistance(x, y, z))
+					<< x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
+TEST_F(DistanceFieldTest, testDistanceToAirThreadPool) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	for (int z = 0; z < 16; ++z) {
+		for (int y = 0; y < 16; ++y) {
+			for (int x = 0; x < 16; ++x) {
+				if ((x * 7 + y * 3 + z * 5) % 11 != 0) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+				}
+			}
+		}
+	}
+	core::ThreadPool threadPool(4, "DistanceField");
+	threadPool.init();
+	DistanceField field(volume.region());
+	computeDistanceField(volume, volume.region(), field, true, &threadPool);
+	for (int z = 0; z < 16; ++z) {
+		for (int y = 0; y < 16; ++y) {
+			for (int x = 0; x < 16; ++x) {
+				ASSERT_EQ(nearest(volume, glm::ivec3(x, y, z), true), field.squaredDistance(x, y, z))
+					<< x << ":" << y << ":" << z;
+			}
+		}
+	}
+	threadPool.shutdown();
+}
+
+TEST_F(DistanceFieldTest, testErodeDilate) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	voxel::RawVolumeWrapper wrapper(&volume);
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	for (int z = 2; z <= 13; ++z) {
+		for (int y = 2; y <= 13; ++y) {
+			for (int x = 2; x <= 13; ++x) {
+				volume.setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+	// 12^3 cube - the outer two layers are removed
+	EXPECT_EQ(12 * 12 * 12 - 8 * 8 * 8, erode(wrapper, 2));
+	EXPECT_FALSE(voxel::isAir(volume.voxel(4, 4, 4).getMaterial()));
+	EXPECT_TRUE(voxel::isAir(volume.voxel(3, 4, 4).getMaterial()));
+
+	// one layer around the cube - without the edges and corners
+	EXPECT_EQ(6 * 8 * 8, dilate(wrapper, 1, voxel));
+	EXPECT_FALSE(voxel::isAir(volume.voxel(3, 4, 4).getMaterial()));
+	EXPECT_TRUE(voxel::isAir(volume.voxel(3, 3, 4).getMaterial()));
+}
+
+} // namespace voxelutil
@@ -0,0 +1,117 @@
+/**
+ * @file
+ */
+
+#include "voxelutil/HierarchicalPathfinder.h"
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/AStarPathfinder.h"
+
+namespace voxelutil {
+
+class HierarchicalPathfinderTest : public app::AbstractTest {
+protected:
+	static bool isAir(const voxel::RawVolume *v, const glm::ivec3 &pos) {
+		return v->region().containsPoint(pos) && !voxel::isBlocked(v->voxel(pos).getMaterial());
+	}
+
+	static void checkPath(const voxel::RawVolume &volume, const core::List<glm::ivec3> &path, const glm::ivec3 &start,
+						  const glm::ivec3 &end) {
+		ASSERT_FALSE(path.empty());
+		glm::ivec3 prev = start;
+		bool first = true;
+		for (const glm::ivec3 &p : path) {
+			if (first) {
+				EXPECT_EQ(start, p);
+				first = false;
+			} else {
+				const glm::ivec3 d = glm::abs(p - prev);
+				EXPECT_LE(glm::max(d.x, glm::max(d.y, d.z)), 1) << "gap in the path";
+			}
+			EXPECT_TRUE(isAir(&volume, p));
+			prev = p;
+		}
+		EXPECT_EQ(end, prev);
+	}
+};
+
+TEST_F(HierarchicalPathfinderTest, testWall) {
+	voxel::RawVolume volume(voxel::Region(0, 47));
+	// a wall with a single hole
+	for (int y = 0; y < 48; ++y) {
+		for (int z = 0; z < 48; ++z) {
+			if (y == 40 && z == 5) {
+				continue;
+			}
+			volume.setVoxel(24, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		}
+	}
+	const glm::ivec3 start(1, 1, 1);
+	const glm::ivec3 end(46, 2, 46);
+	for (voxel::Connectivity connectivity : {voxel::Connectivity::SixConnected, voxel::Connectivity::EighteenConnected,
+											 voxel::Connectivity::TwentySixConnected}) {
+		HierarchicalPathfinder<voxel::RawVolume> pathfinder(&volume, isAir, connectivity);
+		core::List<glm::ivec3> path;
+		ASSERT_TRUE(pathfinder.execute(start, end, path));
+		checkPath(volume, path, start, end);
+		bool hole = false;
+		for (const glm::ivec3 &p : path) {
+			hole |= p == glm::ivec3(24, 40, 5);
+		}
+		EXPECT_TRUE(hole);
+
+		ASSERT_TRUE(pathfinder.execute(end, start, path));
+		checkPath(volume, path, end, start);
+
+		// the graph is reused for the next query
+		const size_t transitions = pathfinder.transitions();
+		ASSERT_TRUE(pathfinder.execute(start, end, path));
+		checkPath(volume, path, start, end);
+		EXPECT_EQ(transitions, pathfinder.transitions());
+	}
+}
+
+TEST_F(HierarchicalPathfinderTest, testNoPath) {
+	voxel::RawVolume volume(voxel::Region(0, 31));
+	for (int y = 0; y < 32; ++y) {
+		for (int z = 0; z < 32; ++z) {
+			volume.setVoxel(20, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		}
+	}
+	HierarchicalPathfinder<voxel::RawVolume> pathfinder(&volume, isAir);
+	core::List<glm::ivec3> path;
+	EXPECT_FALSE(pathfinder.execute(glm::ivec3(0), glm::ivec3(31), path));
+	EXPECT_TRUE(path.empty());
+	EXPECT_TRUE(pathfinder.execute(glm::ivec3(0), glm::ivec3(3), path));
+	checkPath(volume, path, glm::ivec3(0), glm::ivec3(3));
+	EXPECT_EQ(4u, path.size());
+}
+
+TEST_F(HierarchicalPathfinderTest, testCompareAStar) {
+	voxel::RawVolume volume(voxel::Region(0, 40));
+	for (int x = 0; x < 41; ++x) {
+		for (int z = 0; z < 41; ++z) {
+			volume.setVoxel(x, 0, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		}
+	}
+	auto isWalkable = [](const voxel::RawVolume *v, const glm::ivec3 &pos) {
+		const glm::ivec3 below(pos.x, pos.y - 1, pos.z);
+		return v->region().containsPoint(pos) && v->region().containsPoint(below) &&
+			   !voxel::isBlocked(v->voxel(pos).getMaterial()) && voxel::isBlocked(v->voxel(below).getMaterial());
+	};
+	const glm::ivec3 start(0, 1, 0);
+	const glm::ivec3 end(40, 1, 33);
+	core::List<glm::ivec3> astarPath;
+	AStarPathfinderParams<voxel::RawVolume> params(&volume, start, end, &astarPath, isWalkable, 1.0f, 100000,
+												   voxel::Connectivity::SixConnected);
+	AStarPathfinder<voxel::RawVolume> astar(params);
+	ASSERT_TRUE(astar.execute());
+
+	HierarchicalPathfinder<voxel::RawVolume> pathfinder(&volume, isWalkable, voxel::Connectivity::SixConnected);
+	core::List<glm::ivec3> path;
+	ASSERT_TRUE(pathfinder.execute(start, end, path));
+	// on a plane without obstacles the transitions don't force a detour for the manhattan distance
+	EXPECT_EQ(astarPath.size(), path.size());
+}
+
+} // namespace voxelutil
@@ -5,12 +5,53 @@
 #include "voxelutil/ImageUtils.h"
 #include "app/tests/AbstractTest.h"
 #include "core/ScopedPtr.h"
+#include "core/concurrent/ThreadPool.h"
 #include "image/Image.h"
+#include "palette/Palette.h"
+#include "palette/PaletteLookup.h"
 #include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
 
 namespace voxelutil {
 
-class ImageUtilsTest : public app::AbstractTest {};
+class ImageUtilsTest : public app::AbstractTest {
+protected:
+	static constexpr int HeightmapSize = 4;
+
+	image::ImagePtr createHeightmap() const {
+		// the red channel is the height for gray scale heightmaps - the alpha channel for colored heightmaps
+		const core::RGBA buffer[HeightmapSize * HeightmapSize]{
+			{0, 0, 255, 0},	 {1, 0, 255, 1},   {2, 0, 255, 2},	 {3, 0, 255, 3},
+			{4, 255, 0, 4},	 {5, 255, 0, 5},   {6, 255, 0, 6},	 {7, 255, 0, 7},
+			{8, 0, 0, 8},	 {9, 0, 0, 9},	   {10, 0, 0, 10},	 {0, 255, 0, 0},
+			{1, 255, 0, 1},	 {2, 255, 0, 2},   {3, 255, 0, 3},	 {4, 255, 0, 4}};
+		const image::ImagePtr &image = image::createEmptyImage("heightmap");
+		image->loadRGBA((const uint8_t *)buffer, HeightmapSize, HeightmapSize);
+		return image;
+	}
+
+	/**
+	 * @return The height of the column - @c -1 if the column doesn't match the expected layout
+	 */
+	int columnHeight(const voxel::RawVolume &volume, int x, int z, const voxel::Voxel &underground) const {
+		const voxel::Region &region = volume.region();
+		int height = 0;
+		while (height <= region.getUpperY() && !voxel::isAir(volume.voxel(x, height, z).getMaterial())) {
+			++height;
+		}
+		for (int y = 0; y < height - 1; ++y) {
+			if (volume.voxel(x, y, z) != underground) {
+				return -1;
+			}
+		}
+		for (int y = height; y <= region.getUpperY(); ++y) {
+			if (!voxel::isAir(volume.voxel(x, y, z).getMaterial())) {
+				return -1;
+			}
+		}
+		return height;
+	}
+};
 
 TEST_F(ImageUtilsTest, testImportAsPlane) {
 	const image::ImagePtr &img = image::loadImage("test-palette-in.png");
@@ -63,4 +104,78 @@ TEST_F(ImageUtilsTest, importHeightMaxHeightAlpha) {
 	EXPECT_EQ(129, maxHeight);
 }
 
+TEST_F(ImageUtilsTest, testImportHeightmap) {
+	const image::ImagePtr &image = createHeightmap();
+	const voxel::Region region(0, 0, 0, HeightmapSize - 1, 7, HeightmapSize - 1);
+	const voxel::Voxel underground = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	const voxel::Voxel surface = voxel::createVoxel(voxel::VoxelType::Generic, 2);
+	voxel::RawVolume volume(region);
+	voxel::RawVolumeWrapper wrapper(&volume);
+	importHeightmap(wrapper, image, underground, surface, 1, false);
+	for (int z = 0; z < HeightmapSize; ++z) {
+		for (int x = 0; x < HeightmapSize; ++x) {
+			const int expected = core_min(core_max((int)image->colorAt(x, z).r, 1), 8);
+			EXPECT_EQ(expected, columnHeight(volume, x, z, underground)) << "column " << x << ":" << z;
+		}
+	}
+	// the surface voxels above the region are skipped
+	EXPECT_EQ(surface, volume.voxel(3, 6, 1));
+	EXPECT_EQ(underground, volume.voxel(1, 7, 2));
+	EXPECT_EQ(voxel::Region(0, 0, 0, HeightmapSize - 1, 7, HeightmapSize - 1), wrapper.dirtyRegion());
+}
+
+TEST_F(ImageUtilsTest, testImportHeightmapSurfaceOnly) {
+	const image::ImagePtr &image = createHeightmap();
+	const voxel::Region region(0, 0, 0, HeightmapSize - 1, 7, HeightmapSize - 1);
+	const voxel::Voxel surface = voxel::createVoxel(voxel::VoxelType::Generic, 2);
+	voxel::RawVolume volume(region);
+	voxel::RawVolumeWrapper wrapper(&volume);
+	importHeightmap(wrapper, image, voxel::Voxel(), surface, 0, false);
+	EXPECT_TRUE(voxel::isAir(volume.voxel(0, 0, 0).getMaterial()));
+	EXPECT_EQ(surface, volume.voxel(1, 0, 0));
+	EXPECT_TRUE(voxel::isAir(volume.voxel(1, 1, 0).getMaterial()));
+	EXPECT_EQ(surface, volume.voxel(3, 6, 1));
+	EXPECT_TRUE(voxel::isAir(volume.voxel(3, 5, 1).getMaterial()));
+	EXPECT_EQ(voxel::Region(0, 0, 0, HeightmapSize - 1, 7, HeightmapSize - 1), wrapper.dirtyRegion());
+}
+
+TEST_F(ImageUtilsTest, testImportColoredHeightmapThreadPool) {
+	const image::ImagePtr &image = createHeightmap();
+	const voxel::Region region(0, 0, 0, HeightmapSize - 1, 11, HeightmapSize - 1);
+	const voxel::Voxel underground = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	palette::Palette palette;
+	palette.nippon();
+	palette::PaletteLookup palLookup(palette);
+
+	voxel::RawVolume expected(region);
+	voxel::RawVolumeWrapper expectedWrapper(&expected);
+	importColoredHeightmap(expectedWrapper, palLookup, image, underground, 0, false);
+
+	core::ThreadPool threadPool(4, "ImageUtils");
+	threadPool.init();
+	voxel::RawVolume volume(region);
+	voxel::RawVolumeWrapper wrapper(&volume);
+	importColoredHeightmap(wrapper, palLookup, image, underground, 0, false, &threadPool);
+
+	for (int z = 0; z < HeightmapSize; ++z) {
+		for (int x = 0; x < HeightmapSize; ++x) {
+			const core::RGBA pixel = image->colorAt(x, z);
+			ASSERT_EQ((int)pixel.a, columnHeight(volume, x, z, underground)) << "column " << x << ":" << z;
+			if (pixel.a == 0) {
+				continue;
+			}
+			const voxel::Voxel &top = volume.voxel(x, pixel.a - 1, z);
+			EXPECT_EQ(palette.getClosestMatch(core::RGBA(pixel.r, pixel.g, pixel.b)), (int)top.getColor());
+		}
+	}
+	for (int z = 0; z < HeightmapSize; ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = 0; x < HeightmapSize; ++x) {
+				ASSERT_EQ(expected.voxel(x, y, z), volume.voxel(x, y, z)) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+	EXPECT_EQ(voxel::Region(0, 0, 0, HeightmapSize - 1, 9, HeightmapSize - 1), wrapper.dirtyRegion());
+}
+
 } // namespace voxelutil
@@ -6,6 +6,7 @@
 #include "voxel/RawVolume.h"
 #include "voxelutil/Picking.h"
 #include "core/GLM.h"
+#include "core/collection/DynamicArray.h"
 
 namespace voxelutil {
 
@@ -21,4 +22,80 @@ TEST_F(PickingTest, testPicking) {
 	ASSERT_EQ(glm::ivec3(0, 1, 0), result.previousPosition);
 }
 
+TEST_F(PickingTest, testPickingSkipEmpty) {
+	voxel::RawVolume v(voxel::Region(glm::ivec3(-10), glm::ivec3(200, 30, 30)));
+	v.setOccupancyTracking(true);
+	v.setVoxel(glm::ivec3(150, 5, 6), voxel::createVoxel(voxel::VoxelType::Generic, 0));
+	const glm::vec3 start(-20.5f, 5.5f, 6.5f);
+	const PickResult &result = pickVoxel(&v, start, glm::vec3(300.0f, 0.0f, 0.0f), voxel::Voxel());
+	ASSERT_TRUE(result.didHit);
+	EXPECT_EQ(glm::ivec3(150, 5, 6), result.hitVoxel);
+	ASSERT_TRUE(result.validPreviousPosition);
+	EXPECT_EQ(glm::ivec3(149, 5, 6), result.previousPosition);
+
+	// the empty bricks are skipped - only the voxels where the ray enters and leaves them are reported. Only the brick
+	// with the solid voxel is visited voxel by voxel
+	int reported = 0;
+	raycastSkipEmpty(&v, start, start + glm::vec3(300.0f, 0.0f, 0.0f), [&](const glm::ivec3 &) {
+		++reported;
+		return true;
+	});
+	EXPECT_LT(reported, v.region().getWidthInVoxels() / 2);
+
+	const PickResult &miss = pickVoxel(&v, start, glm::vec3(300.0f, 0.0f, 100.0f), voxel::Voxel());
+	EXPECT_FALSE(miss.didHit);
+}
+
+TEST_F(PickingTest, testClipRayToRegion) {
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(10));
+	voxel::RawVolume v(region);
+	const glm::vec3 start(-500.3f, 5.2f, 4.7f);
+	const glm::vec3 end(600.1f, 8.9f, 3.2f);
+
+	auto validPositions = [&](const glm::vec3 &from, const glm::vec3 &to) {
+		core::DynamicArray<glm::ivec3> positions;
+		raycastWithEndpoints(&v, from, to, [&](voxel::RawVolume::Sampler &sampler) {
+			if (sampler.currentPositionValid()) {
+				positions.push_back(sampler.position());
+			}
+			return true;
+		});
+		return positions;
+	};
+
+	glm::vec3 clippedStart = start;
+	glm::vec3 clippedEnd = end;
+	ASSERT_TRUE(clipRayToRegion(region, 2, clippedStart, clippedEnd));
+	EXPECT_GT(clippedStart.x, -3.0f);
+	EXPECT_LT(clippedEnd.x, 14.0f);
+	const core::DynamicArray<glm::ivec3> &expected = validPositions(start, end);
+	const core::DynamicArray<glm::ivec3> &clipped = validPositions(clippedStart, clippedEnd);
+	ASSERT_FALSE(expected.empty());
+	ASSERT_EQ(expected.size(), clipped.size());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		EXPECT_EQ(expected[i], clipped[i]);
+	}
+
+	glm::vec3 missStart(-500.0f, 50.0f, 5.0f);
+	glm::vec3 missEnd(500.0f, 50.0f, 5.0f);
+	EXPECT_FALSE(clipRayToRegion(region, 2, missStart, missEnd));
+}
+
+TEST_F(PickingTest, testPickVoxels) {
+	voxel::RawVolume v(voxel::Region(glm::ivec3(0), glm::ivec3(10)));
+	v.setOccupancyTracking(true);
+	v.setVoxel(glm::ivec3(2, 0, 2), voxel::createVoxel(voxel::VoxelType::Generic, 0));
+	v.setVoxel(glm::ivec3(5, 0, 5), voxel::createVoxel(voxel::VoxelType::Generic, 0));
+	const glm::vec3 starts[] = {glm::vec3(2.5f, 8.5f, 2.5f), glm::vec3(5.5f, 8.5f, 5.5f), glm::vec3(7.5f, 8.5f, 7.5f)};
+	const glm::vec3 directions[] = {glm::down() * 20.0f, glm::down() * 20.0f, glm::down() * 20.0f};
+	PickResult results[3];
+	pickVoxels(&v, starts, directions, 3, voxel::Voxel(), results);
+	EXPECT_TRUE(results[0].didHit);
+	EXPECT_EQ(glm::ivec3(2, 0, 2), results[0].hitVoxel);
+	EXPECT_TRUE(results[1].didHit);
+	EXPECT_EQ(glm::ivec3(5, 0, 5), results[1].hitVoxel);
+	EXPECT_EQ(glm::ivec3(5, 1, 5), results[1].previousPosition);
+	EXPECT_FALSE(results[2].didHit);
+}
+
 }
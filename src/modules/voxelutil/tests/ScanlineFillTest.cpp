@@ -0,0 +1,75 @@
+/**
+ * @file
+ */
+
+#include "voxelutil/ScanlineFill.h"
+#include "app/tests/AbstractTest.h"
+
+namespace voxelutil {
+
+class ScanlineFillTest : public app::AbstractTest {};
+
+TEST_F(ScanlineFillTest, testFillAll) {
+	const voxel::Region region(-2, 5);
+	ScanlineFill fill(region);
+	int runs = 0;
+	const int filled = fill.fill(0, 0, 0, [&](int x0, int x1, int, int) {
+		EXPECT_EQ(region.getLowerX(), x0);
+		EXPECT_EQ(region.getUpperX(), x1);
+		++runs;
+	});
+	EXPECT_EQ(8 * 8 * 8, filled);
+	// one run per row
+	EXPECT_EQ(8 * 8, runs);
+	EXPECT_TRUE(fill.marked(5, 5, 5));
+	EXPECT_EQ(0, fill.fill(1, 1, 1, [](int, int, int, int) {}));
+}
+
+TEST_F(ScanlineFillTest, testWall) {
+	const voxel::Region region(0, 9);
+	ScanlineFill fill(region);
+	// a wall at x = 4 splits the region in two halves
+	for (int z = 0; z <= 9; ++z) {
+		for (int y = 0; y <= 9; ++y) {
+			fill.mark(4, y, z);
+		}
+	}
+	EXPECT_EQ(4 * 10 * 10, fill.fill(0, 0, 0, [](int x0, int x1, int, int) {
+		EXPECT_EQ(0, x0);
+		EXPECT_EQ(3, x1);
+	}));
+	EXPECT_FALSE(fill.marked(5, 0, 0));
+	EXPECT_EQ(5 * 10 * 10, fill.fill(9, 9, 9, [](int, int, int, int) {}));
+}
+
+TEST_F(ScanlineFillTest, testConcave) {
+	const voxel::Region region(0, 4);
+	ScanlineFill fill(region);
+	// a u-shaped hole in the plane z = 0 - all other voxels are marked
+	for (int z = 0; z <= 4; ++z) {
+		for (int y = 0; y <= 4; ++y) {
+			for (int x = 0; x <= 4; ++x) {
+				fill.mark(x, y, z);
+			}
+		}
+	}
+	ScanlineFill u(region);
+	for (int z = 0; z <= 4; ++z) {
+		for (int y = 0; y <= 4; ++y) {
+			for (int x = 0; x <= 4; ++x) {
+				const bool leftArm = x == 0 && y <= 3;
+				const bool rightArm = x == 4 && y <= 3;
+				const bool bottom = y == 0;
+				if (z != 0 || !(leftArm || rightArm || bottom)) {
+					u.mark(x, y, z);
+				}
+			}
+		}
+	}
+	// start at the top of the left arm - the fill has to go down and up again to reach the right arm
+	EXPECT_EQ(4 + 4 + 3, u.fill(0, 3, 0, [](int, int, int, int) {}));
+	EXPECT_TRUE(u.marked(4, 3, 0));
+	EXPECT_EQ(0, fill.fill(0, 3, 0, [](int, int, int, int) {}));
+}
+
+} // namespace voxelutil
@@ -51,4 +51,19 @@ TEST_F(VolumeCropperTest, testCropBiggerMultiple) {
 	delete croppedVolume;
 }
 
+TEST_F(VolumeCropperTest, testCropOccupancy) {
+	voxel::Region region = voxel::Region(-10, 100);
+	voxel::RawVolume smallVolume(region);
+	smallVolume.setOccupancyTracking(true);
+	EXPECT_EQ(nullptr, voxelutil::cropVolume(&smallVolume));
+	smallVolume.setVoxel(region.getCenter(), voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	smallVolume.setVoxel(region.getUpperCorner(), voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	voxel::RawVolume *croppedVolume = voxelutil::cropVolume(&smallVolume);
+	ASSERT_NE(nullptr, croppedVolume) << "Expected to get the cropped raw volume";
+	const voxel::Region& croppedRegion = croppedVolume->region();
+	EXPECT_EQ(croppedRegion.getUpperCorner(), region.getUpperCorner()) << croppedRegion.toString();
+	EXPECT_EQ(croppedRegion.getLowerCorner(), region.getCenter()) << croppedRegion.toString();
+	delete croppedVolume;
+}
+
 }
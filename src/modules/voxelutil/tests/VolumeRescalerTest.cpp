@@ -5,6 +5,8 @@
 #include "voxelutil/VolumeRescaler.h"
 #include "app/tests/AbstractTest.h"
 #include "core/ScopedPtr.h"
+#include "core/concurrent/ThreadPool.h"
+#include "palette/Palette.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
@@ -45,4 +47,77 @@ TEST_F(VolumeRescalerTest, testScaleUpFull) {
 	testScaleUpFull(7, 8);
 }
 
+TEST_F(VolumeRescalerTest, testScaleDownMinSolidVoxels) {
+	palette::Palette pal;
+	pal.nippon();
+	voxel::RawVolume volume({0, 3});
+	// one of the eight voxels of the first output voxel is solid
+	volume.setVoxel(1, 1, 1, voxel::createVoxel(pal, 1));
+
+	voxel::RawVolume shrunk({0, 1});
+	voxelutil::scaleDown(volume, pal, shrunk);
+	EXPECT_TRUE(voxel::isAir(shrunk.voxel(0, 0, 0).getMaterial()));
+
+	voxel::RawVolume covered({0, 1});
+	voxelutil::scaleDown(volume, pal, volume.region(), covered, covered.region(), 1);
+	EXPECT_TRUE(voxel::isBlocked(covered.voxel(0, 0, 0).getMaterial()));
+	EXPECT_TRUE(voxel::isAir(covered.voxel(1, 0, 0).getMaterial()));
+}
+
+TEST_F(VolumeRescalerTest, testScaleDownHiddenColor) {
+	palette::Palette pal;
+	pal.nippon();
+	voxel::RawVolume volume({0, 7});
+	// a solid cube with a different color for the voxels that are not visible
+	voxelutil::visitVolume(
+		volume,
+		[&](int x, int y, int z, const voxel::Voxel &) {
+			const bool inner = x > 0 && x < 7 && y > 0 && y < 7 && z > 0 && z < 7;
+			volume.setVoxel(x, y, z, voxel::createVoxel(pal, inner ? 2 : 1));
+		},
+		VisitAll());
+
+	voxel::RawVolume shrunk({0, 3});
+	voxelutil::scaleDown(volume, pal, shrunk);
+	for (int z = 0; z <= 3; ++z) {
+		for (int y = 0; y <= 3; ++y) {
+			for (int x = 0; x <= 3; ++x) {
+				const voxel::Voxel &voxel = shrunk.voxel(x, y, z);
+				ASSERT_TRUE(voxel::isBlocked(voxel.getMaterial()));
+				// the hidden voxels only contribute their color if none of the eight voxels is visible
+				const bool inner = x > 0 && x < 3 && y > 0 && y < 3 && z > 0 && z < 3;
+				EXPECT_EQ(inner ? 2 : 1, voxel.getColor()) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
+TEST_F(VolumeRescalerTest, testScaleDownThreadPool) {
+	palette::Palette pal;
+	pal.nippon();
+	voxel::RawVolume volume({-3, 40});
+	voxelutil::visitVolume(
+		volume,
+		[&](int x, int y, int z, const voxel::Voxel &) {
+			if ((x * y + z) % 3 != 0) {
+				volume.setVoxel(x, y, z, voxel::createVoxel(pal, (x + y + z + 300) % 200 + 1));
+			}
+		},
+		VisitAll());
+
+	core::ThreadPool threadPool(3, "ScaleDown");
+	threadPool.init();
+	voxel::RawVolume expected({-3, 18});
+	voxelutil::scaleDown(volume, pal, expected);
+	voxel::RawVolume shrunk({-3, 18});
+	voxelutil::scaleDown(volume, pal, shrunk, &threadPool);
+	voxelutil::visitVolume(
+		expected,
+		[&](int x, int y, int z, const voxel::Voxel &voxel) {
+			ASSERT_TRUE(voxel.isSame(shrunk.voxel(x, y, z))) << x << ":" << y << ":" << z;
+		},
+		VisitAll());
+	threadPool.shutdown();
+}
+
 } // namespace voxelutil
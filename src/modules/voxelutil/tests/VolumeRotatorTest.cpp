@@ -5,9 +5,12 @@
 #include "voxelutil/VolumeRotator.h"
 #include "app/tests/AbstractTest.h"
 #include "core/ScopedPtr.h"
+#include "core/concurrent/ThreadPool.h"
 #include "math/Axis.h"
 #include "math/Math.h"
+#include "palette/Palette.h"
 #include "voxel/MaterialColor.h"
+#include "voxel/OccupancyMask.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
 #include "voxel/tests/VoxelPrinter.h"
@@ -82,6 +85,21 @@ protected:
 																			   << smallVolume << "\nversus\n"
 																			   << *unRotated;
 	}
+
+	// fills a volume with a different color per position - the dimensions are bigger than the transpose tiles
+	static void fillPattern(voxel::RawVolume &volume) {
+		const voxel::Region &region = volume.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if ((x + y * 3 + z * 7) % 5 == 0) {
+						continue;
+					}
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (x * 7 + y * 13 + z) % 255 + 1));
+				}
+			}
+		}
+	}
 };
 
 TEST_F(VolumeRotatorTest, testRotateAxisX) {
@@ -116,4 +134,92 @@ TEST_F(VolumeRotatorTest, testRotateAxisY45) {
 									 << " " << region;
 }
 
+TEST_F(VolumeRotatorTest, testRotateAxisThreadPool) {
+	core::ThreadPool threadPool(3, "RotateAxis");
+	threadPool.init();
+	voxel::RawVolume volume(voxel::Region(glm::ivec3(-5, 2, 1), glm::ivec3(40, 37, 70)));
+	fillPattern(volume);
+	const voxel::Region &region = volume.region();
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	for (math::Axis axis : {math::Axis::X, math::Axis::Y, math::Axis::Z}) {
+		core::ScopedPtr<voxel::RawVolume> rotated(rotateAxis(&volume, axis, &threadPool));
+		ASSERT_NE(nullptr, rotated);
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					glm::ivec3 pos;
+					if (axis == math::Axis::X) {
+						pos = glm::ivec3(x, z, maxs.y - (y - mins.y));
+					} else if (axis == math::Axis::Y) {
+						pos = glm::ivec3(maxs.z - (z - mins.z), y, x);
+					} else {
+						pos = glm::ivec3(y, maxs.x - (x - mins.x), z);
+					}
+					ASSERT_EQ(volume.voxel(x, y, z).getColor(), rotated->voxel(pos).getColor())
+						<< "Rotation around axis " << (int)axis << " failed at " << glm::ivec3(x, y, z);
+				}
+			}
+		}
+	}
+	threadPool.shutdown();
+}
+
+TEST_F(VolumeRotatorTest, testRotateVolumeThreadPool) {
+	core::ThreadPool threadPool(3, "RotateVolume");
+	threadPool.init();
+	voxel::RawVolume volume(voxel::Region(0, 0, 0, 20, 10, 30));
+	fillPattern(volume);
+	const glm::ivec3 angles(0, 90, 0);
+	const palette::Palette palette;
+	core::ScopedPtr<voxel::RawVolume> expected(rotateVolume(&volume, palette, angles, glm::vec3(0.5f)));
+	core::ScopedPtr<voxel::RawVolume> rotated(rotateVolume(&volume, palette, angles, glm::vec3(0.5f), &threadPool));
+	ASSERT_EQ(expected->region(), rotated->region());
+	const voxel::Region &region = expected->region();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				ASSERT_EQ(expected->voxel(x, y, z).getColor(), rotated->voxel(x, y, z).getColor())
+					<< glm::ivec3(x, y, z);
+			}
+		}
+	}
+	threadPool.shutdown();
+}
+
+TEST_F(VolumeRotatorTest, testMirrorAxisInPlace) {
+	voxel::RawVolume volume(voxel::Region(glm::ivec3(-3, 0, 2), glm::ivec3(4, 6, 10)));
+	fillPattern(volume);
+	volume.setOccupancyTracking(true);
+	const voxel::Region &region = volume.region();
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	for (math::Axis axis : {math::Axis::X, math::Axis::Y, math::Axis::Z}) {
+		voxel::RawVolume mirrored(volume);
+		mirrored.setOccupancyTracking(true);
+		mirrorAxis(mirrored, axis);
+		const int idx = math::getIndexForAxis(axis);
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					glm::ivec3 pos(x, y, z);
+					pos[idx] = maxs[idx] - (pos[idx] - mins[idx]);
+					ASSERT_EQ(volume.voxel(x, y, z).getColor(), mirrored.voxel(pos).getColor());
+					ASSERT_EQ(voxel::isBlocked(mirrored.voxel(pos).getMaterial()),
+							  mirrored.occupancy()->isSolid(pos - mins));
+				}
+			}
+		}
+		// mirroring twice restores the volume
+		core::ScopedPtr<voxel::RawVolume> restored(mirrorAxis(&mirrored, axis));
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					ASSERT_EQ(volume.voxel(x, y, z).getColor(), restored->voxel(x, y, z).getColor());
+				}
+			}
+		}
+	}
+}
+
 } // namespace voxelutil
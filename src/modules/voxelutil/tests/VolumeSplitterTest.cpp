@@ -6,6 +6,7 @@
 #include "app/tests/AbstractTest.h"
 #include "core/ScopedPtr.h"
 #include "core/collection/Vector.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/RawVolume.h"
 #include "voxel/RawVolumeWrapper.h"
 #include "voxelutil/VolumeMerger.h"
@@ -62,6 +63,37 @@ TEST_F(VolumeSplitterTest, testSplit) {
 	EXPECT_EQ(expectedVoxelCount, foundVoxelsAfterSplitAndMerge);
 }
 
+TEST_F(VolumeSplitterTest, testSplitSkipEmpty) {
+	const voxel::Region region(-8, 0, -8, 55, 31, 55);
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	voxel::RawVolume volume(region);
+	volume.setVoxel(-8, 0, -8, voxel);
+	volume.setVoxel(40, 20, 30, voxel);
+	volume.setVoxel(55, 31, 55, voxel);
+	volume.setOccupancyTracking(true);
+
+	core::ThreadPool threadPool(4, "VolumeSplitter");
+	threadPool.init();
+	core::DynamicArray<voxel::RawVolume *> rawVolumes =
+		voxelutil::splitVolume(&volume, glm::ivec3(16), false, &threadPool);
+	ASSERT_EQ(3u, rawVolumes.size());
+	// the pieces are ordered by y, z and x
+	EXPECT_EQ(voxel::Region(-8, 0, -8, 7, 15, 7), rawVolumes[0]->region());
+	EXPECT_EQ(voxel::Region(40, 16, 24, 55, 31, 39), rawVolumes[1]->region());
+	EXPECT_EQ(voxel::Region(40, 16, 40, 55, 31, 55), rawVolumes[2]->region());
+	EXPECT_EQ(voxel, rawVolumes[1]->voxel(40, 20, 30));
+	for (voxel::RawVolume *v : rawVolumes) {
+		EXPECT_EQ(1, countVoxels(*v, voxel));
+		delete v;
+	}
+
+	rawVolumes = voxelutil::splitVolume(&volume, glm::ivec3(16), true, &threadPool);
+	EXPECT_EQ(32u, rawVolumes.size());
+	for (voxel::RawVolume *v : rawVolumes) {
+		delete v;
+	}
+}
+
 TEST_F(VolumeSplitterTest, testSplitObjects) {
 	const voxel::Region region(0, 31);
 	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
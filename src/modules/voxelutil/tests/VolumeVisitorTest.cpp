@@ -5,6 +5,8 @@
 #include "voxelutil/VolumeVisitor.h"
 #include "app/tests/AbstractTest.h"
 #include "core/ArrayLength.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
 #include "math/Axis.h"
 #include "voxel/Face.h"
 #include "voxel/RawVolume.h"
@@ -152,6 +154,52 @@ TEST_F(VolumeVisitorTest, testVisitVisibleSurface) {
 	EXPECT_EQ(3, cnt);
 }
 
+TEST_F(VolumeVisitorTest, testVisitVolumeParallel) {
+	core::ThreadPool threadPool(3, "VisitVolume");
+	threadPool.init();
+	const voxel::Region region(0, 0, 0, 15, 7, 30);
+	voxel::RawVolume volume(region);
+	int expected = 0;
+	for (int z = 0; z <= 30; ++z) {
+		for (int x = 0; x <= 15; x += 3) {
+			EXPECT_TRUE(volume.setVoxel(x, z % 8, z, voxel::createVoxel(voxel::VoxelType::Generic, 1)));
+			++expected;
+		}
+	}
+	core::AtomicInt visited{0};
+	const int cnt = visitVolumeParallel(
+		volume, [&](int, int, int, const voxel::Voxel &) { visited.increment(); }, &threadPool);
+	EXPECT_EQ(expected, cnt);
+	EXPECT_EQ(expected, (int)visited);
+	EXPECT_EQ(expected, visitVolumeParallel(volume, [](int, int, int, const voxel::Voxel &) {}, nullptr));
+	threadPool.shutdown();
+}
+
+TEST_F(VolumeVisitorTest, testReduceVolume) {
+	core::ThreadPool threadPool(3, "ReduceVolume");
+	threadPool.init();
+	const voxel::Region region(-4, 20);
+	voxel::RawVolume volume(region);
+	int64_t expectedSum = 0;
+	int expectedMaxColor = 0;
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		const uint8_t color = (uint8_t)(z + 10);
+		EXPECT_TRUE(volume.setVoxel(1, 2, z, voxel::createVoxel(voxel::VoxelType::Generic, color)));
+		expectedSum += z;
+		expectedMaxColor = glm::max(expectedMaxColor, (int)color);
+	}
+	const int64_t sum = reduceVolume(
+		volume, region, (int64_t)0, [](int64_t &acc, int, int, int z, const voxel::Voxel &) { acc += z; },
+		[](int64_t &result, const int64_t &acc) { result += acc; }, &threadPool);
+	EXPECT_EQ(expectedSum, sum);
+	const int maxColor = reduceVolume(
+		volume, region, 0,
+		[](int &acc, int, int, int, const voxel::Voxel &voxel) { acc = glm::max(acc, (int)voxel.getColor()); },
+		[](int &result, const int &acc) { result = glm::max(result, acc); }, &threadPool);
+	EXPECT_EQ(expectedMaxColor, maxColor);
+	threadPool.shutdown();
+}
+
 class VolumeVisitorParamTest : public app::AbstractTest, public ::testing::WithParamInterface<VisitorOrder> {};
 
 class VolumeVisitorOrderTest : public VolumeVisitorParamTest {};
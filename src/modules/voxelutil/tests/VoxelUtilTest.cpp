@@ -116,6 +116,35 @@ TEST_F(VoxelUtilTest, testExtrudePlaneRegion) {
 		<< extrudeRegion.getDimensionsInVoxels().z;
 }
 
+TEST_F(VoxelUtilTest, testExtrudePlaneLarge) {
+	const int size = 256;
+	const voxel::Region region(0, 0, 0, size - 1, 7, size - 1);
+	voxel::RawVolume v(region);
+	const voxel::Voxel groundVoxel = voxel::createVoxel(voxel::VoxelType::Generic, 2);
+	const voxel::Voxel newPlaneVoxel = voxel::createVoxel(voxel::VoxelType::Generic, 3);
+	for (int z = 0; z < size; ++z) {
+		for (int x = 0; x < size; ++x) {
+			v.setVoxel(x, 0, z, groundVoxel);
+		}
+	}
+	// split the ground into two areas
+	for (int z = 0; z < size; ++z) {
+		v.setVoxel(size / 2, 0, z, newPlaneVoxel);
+	}
+	const int thickness = 3;
+	const voxel::Region extrudeRegion = voxelutil::extrudePlaneRegion(
+		v, glm::ivec3(1, 1, 1), voxel::FaceNames::PositiveY, groundVoxel, newPlaneVoxel, thickness);
+	EXPECT_EQ(voxel::Region(0, 1, 0, size / 2 - 1, thickness, size - 1), extrudeRegion);
+	EXPECT_TRUE(voxel::isAir(v.voxel(1, 1, 1).getMaterial())) << "The region calculation must not modify the volume";
+
+	voxel::RawVolumeWrapper wrapper(&v);
+	EXPECT_EQ(thickness * size / 2 * size, voxelutil::extrudePlane(wrapper, glm::ivec3(1, 1, 1),
+																	voxel::FaceNames::PositiveY, groundVoxel,
+																	newPlaneVoxel, thickness));
+	EXPECT_EQ(extrudeRegion, wrapper.dirtyRegion());
+	EXPECT_TRUE(voxel::isAir(v.voxel(size / 2, 1, 0).getMaterial()));
+}
+
 TEST_F(VoxelUtilTest, testExtrudeEraseRegion) {
 	voxel::Region region(0, 2);
 	voxel::RawVolume v(region);
@@ -235,4 +264,90 @@ TEST_F(VoxelUtilTest, testFillPlaneWithImage) {
 	}
 }
 
+TEST_F(VoxelUtilTest, testIsEmpty) {
+	voxel::Region region(0, 7);
+	voxel::RawVolume v(region);
+	EXPECT_TRUE(voxelutil::isEmpty(v, region));
+	v.setVoxel(5, 6, 7, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	EXPECT_FALSE(voxelutil::isEmpty(v, region));
+	EXPECT_TRUE(voxelutil::isEmpty(v, voxel::Region(0, 4)));
+	EXPECT_FALSE(voxelutil::isEmpty(v, voxel::Region(5, 7)));
+}
+
+TEST_F(VoxelUtilTest, testIsEmptyOccupancy) {
+	voxel::Region region(-3, 70);
+	voxel::RawVolume v(region);
+	v.setOccupancyTracking(true);
+	EXPECT_TRUE(voxelutil::isEmpty(v, region));
+	v.setVoxel(65, 6, 7, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	EXPECT_FALSE(voxelutil::isEmpty(v, region));
+	EXPECT_TRUE(voxelutil::isEmpty(v, voxel::Region(-3, 64)));
+	EXPECT_FALSE(voxelutil::isEmpty(v, voxel::Region(65, 6, 7, 100, 100, 100)));
+	EXPECT_TRUE(voxelutil::isTouching(v, glm::ivec3(64, 6, 7)));
+	EXPECT_FALSE(voxelutil::isTouching(v, glm::ivec3(63, 6, 7)));
+
+	voxel::RawVolume in(voxel::Region(0, 3));
+	in.fill(voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	EXPECT_TRUE(voxelutil::copyIntoRegion(in, v, voxel::Region(-3, 0)));
+	EXPECT_FALSE(voxelutil::isEmpty(v, voxel::Region(-3, -3)));
+}
+
+TEST_F(VoxelUtilTest, testCopy) {
+	voxel::RawVolume in(voxel::Region(0, 3));
+	in.setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	in.setVoxel(3, 3, 3, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	voxel::RawVolume out(voxel::Region(-2, 5));
+	EXPECT_TRUE(voxelutil::copyIntoRegion(in, out, voxel::Region(1, 4)));
+	EXPECT_EQ(1, out.voxel(1, 1, 1).getColor());
+	EXPECT_EQ(2, out.voxel(4, 4, 4).getColor());
+	EXPECT_FALSE(voxelutil::copyIntoRegion(in, out, voxel::Region(1, 4))) << "Nothing should have changed";
+
+	// partially outside of the target volume
+	voxel::RawVolume small(voxel::Region(0, 1));
+	EXPECT_TRUE(voxelutil::copy(in, in.region(), small, voxel::Region(-2, 1)));
+	EXPECT_EQ(2, small.voxel(1, 1, 1).getColor());
+}
+
+TEST_F(VoxelUtilTest, testRemapToPalette) {
+	palette::Palette oldPalette;
+	oldPalette.nippon();
+	palette::Palette newPalette;
+	newPalette.nippon();
+	newPalette.setColor(1, oldPalette.color(2));
+	newPalette.setColor(2, core::RGBA(1, 2, 3, 255));
+	voxel::RawVolume v(voxel::Region(0, 3));
+	v.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	v.setVoxel(2, 2, 2, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	const voxel::Region dirty = voxelutil::remapToPalette(&v, oldPalette, newPalette);
+	ASSERT_TRUE(dirty.isValid());
+	EXPECT_EQ(voxel::Region(1, 2), dirty);
+	EXPECT_EQ(1, v.voxel(1, 1, 1).getColor());
+	EXPECT_EQ(1, v.voxel(2, 2, 2).getColor());
+	EXPECT_TRUE(voxel::isAir(v.voxel(0, 0, 0).getMaterial()));
+	EXPECT_FALSE(voxelutil::remapToPalette(&v, newPalette, newPalette).isValid());
+}
+
+TEST_F(VoxelUtilTest, testRemapColors) {
+	palette::Palette pal;
+	pal.nippon();
+	pal.setColor(3, core::RGBA(255, 0, 0, 128));
+	voxel::RawVolume v(voxel::Region(0, 3));
+	v.setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	v.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 2, 5));
+	v.setVoxel(2, 2, 2, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	uint8_t mapping[palette::PaletteMaxColors];
+	for (int i = 0; i < palette::PaletteMaxColors; ++i) {
+		mapping[i] = (uint8_t)i;
+	}
+	EXPECT_FALSE(voxelutil::remapColors(&v, pal, mapping).isValid()) << "The identity mapping must not change anything";
+	mapping[2] = 3;
+	const voxel::Region dirty = voxelutil::remapColors(&v, pal, mapping);
+	EXPECT_EQ(voxel::Region(1, 2), dirty);
+	EXPECT_EQ(1, v.voxel(0, 0, 0).getColor());
+	EXPECT_EQ(3, v.voxel(1, 1, 1).getColor());
+	EXPECT_EQ(5, v.voxel(1, 1, 1).getNormal());
+	EXPECT_EQ(voxel::VoxelType::Transparent, v.voxel(2, 2, 2).getMaterial());
+	EXPECT_TRUE(voxel::isAir(v.voxel(3, 3, 3).getMaterial()));
+}
+
 } // namespace voxelutil
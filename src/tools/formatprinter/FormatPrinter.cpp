@@ -323,6 +323,8 @@ void FormatPrinter::printManPage(const core::String &app) {
 		Log::printf(".PP\n");
 		Log::printf("\\fBvoxformat_gltf_khr_materials_specular\\fP: Apply KHR_materials_specular extension on saving gltf files\n");
 		Log::printf(".PP\n");
+		Log::printf("\\fBvoxformat_gltf_khr_mesh_quantization\\fP: Store the vertex attributes as integers (KHR_mesh_quantization) on saving gltf files\n");
+		Log::printf(".PP\n");
 		Log::printf("\\fBvoxformat_mergequads\\fP: Merge similar quads to optimize the mesh\n");
 		Log::printf(".PP\n");
 		Log::printf("\\fBvoxformat_reusevertices\\fP: Reuse vertices or always create new ones\n");
@@ -576,7 +576,7 @@ bool generateSrc(const core::String& templateHeader, const core::String& templat
 		if (fillBytes > 0) {
 			// the minimum alignment is 16 bytes
 			ub += core::string::format("\t\tuint32_t _padding%i[%i];\n", paddingCnt, (16 - (int)fillBytes) / 4);
-			offset += fillBytes / 4;
+			offset += (16 - fillBytes) / 4;
 		}
 		ub += "\t};\n\t#pragma pack(pop)\n";
 		ub += "\tstatic_assert(sizeof(";
@@ -612,12 +612,15 @@ bool generateSrc(const core::String& templateHeader, const core::String& templat
 		ub += uniformBufferName;
 		ub += ".update((const void*)&var, sizeof(var));\n";
 		ub += "\t}\n\n";
-		ub += "\n\tinline bool create(const ";
+		ub += "\n\t/**\n";
+		ub += "\t * @param slots See video::UniformBuffer::create()\n";
+		ub += "\t */\n";
+		ub += "\tinline bool create(const ";
 		ub += uniformBufferStructName;
-		ub += "Data& var) {\n";
+		ub += "Data& var, int slots = 1) {\n";
 		ub += "\t\treturn _";
 		ub += uniformBufferName;
-		ub += ".create((const void*)&var, sizeof(var));\n";
+		ub += ".create((const void*)&var, sizeof(var), slots);\n";
 		ub += "\t}\n\n";
 		if (uniformBlockAmount == 1) {
 			ub += "\n\tinline operator const video::UniformBuffer&() const {\n";
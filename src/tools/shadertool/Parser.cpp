@@ -65,8 +65,7 @@ static bool parseLayout(TokenIterator& tok, Layout& layout) {
 		if (token == "std140") {
 			layout.blockLayout = BlockLayout::std140;
 		} else if (token == "std430") {
-			Log::error("Unsupported alignment");
-			return false;
+			layout.blockLayout = BlockLayout::std430;
 		} else if (token == "location") {
 			if (!tok.hasNext() || tok.next() != "=") {
 				Log::error("Expected = for location");
@@ -321,8 +320,10 @@ bool parse(const core::String& filename, ShaderStruct& shaderStruct, const core:
 			v = &shaderStruct.uniforms;
 		} else if (hasLayout && token == "in") {
 			shaderStruct.in.layout = layout;
+			hasLayout = false;
 		} else if (hasLayout && token == "out") {
 			shaderStruct.out.layout = layout;
+			hasLayout = false;
 		} else if (uniformBufferActive) {
 			if (token == "}") {
 				uniformBufferActive = false;
@@ -331,7 +332,17 @@ bool parse(const core::String& filename, ShaderStruct& shaderStruct, const core:
 					uniformBuffer.layout = layout;
 				}
 				Log::trace("End of uniform block: %s", uniformBuffer.name.c_str());
-				shaderStruct.uniformBlocks.insert(uniformBuffer);
+				// a block that is shared between the shader stages is only generated once
+				bool known = false;
+				for (const auto &block : shaderStruct.uniformBlocks) {
+					if (block.name == uniformBuffer.name) {
+						known = true;
+						break;
+					}
+				}
+				if (!known) {
+					shaderStruct.uniformBlocks.insert(uniformBuffer);
+				}
 				if (tok.next() != ";") {
 					Log::error("Missing ;");
 					return false;
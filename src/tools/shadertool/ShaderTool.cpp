@@ -48,6 +48,7 @@ app::AppState ShaderTool::onConstruct() {
 	core::Var::get(cfg::ClientDebugShadowMapCascade, "false", core::CV_SHADER);
 	core::Var::get(cfg::VoxelMeshMode, core::string::toString((int)voxel::SurfaceExtractionType::MarchingCubes),
 				   core::CV_SHADER);
+	core::Var::get(cfg::VoxelAOVolume, "true", core::CV_SHADER);
 	return Super::onConstruct();
 }
 
@@ -19,7 +19,9 @@ enum PassBy {
 
 enum class BlockLayout {
 	unknown,
-	std140
+	std140,
+	// only for buffer blocks - there is no c++ structure generated for them
+	std430
 };
 
 struct Variable {
@@ -6,6 +6,9 @@
 #include "core/Log.h"
 #include "core/StringUtil.h"
 #include "core/TimeProvider.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Concurrency.h"
+#include "core/concurrent/ThreadPool.h"
 #include "image/Image.h"
 #include "io/Archive.h"
 #include "io/FileStream.h"
@@ -51,6 +54,9 @@ app::AppState Thumbnailer::onConstruct() {
 		.addFlag(ARGUMENT_FLAG_MANDATORY);
 	registerArg("--turntable").setShort("-t").setDescription("Render in different angles (16 by default)");
 	registerArg("--fallback").setShort("-f").setDescription("Create a fallback thumbnail if an error occurs");
+	registerArg("--software")
+		.setDescription("Render on the cpu without a window - this doesn't need a gpu. Multiple pairs of --input and "
+						"--output are rendered in parallel");
 	registerArg("--use-scene-camera")
 		.setShort("-c")
 		.setDescription("Use the first scene camera for rendering the thumbnail");
@@ -75,7 +81,9 @@ app::AppState Thumbnailer::onConstruct() {
 }
 
 app::AppState Thumbnailer::onInit() {
-	const app::AppState state = Super::onInit();
+	_software = hasArg("--software");
+	// the software renderer doesn't need the window and the gl context of the windowed app
+	const app::AppState state = _software ? app::App::onInit() : Super::onInit();
 
 	if (state != app::AppState::Running) {
 		const bool fallback = hasArg("--fallback");
@@ -99,7 +107,7 @@ app::AppState Thumbnailer::onInit() {
 }
 
 static image::ImagePtr volumeThumbnail(const core::String &fileName, const io::ArchivePtr &archive,
-									   voxelformat::ThumbnailContext &ctx) {
+									   const voxelformat::ThumbnailContext &ctx, bool software) {
 	voxelformat::LoadContext loadctx;
 	image::ImagePtr image = voxelformat::loadScreenshot(fileName, archive, loadctx);
 	if (image && image->isLoaded()) {
@@ -114,9 +122,32 @@ static image::ImagePtr volumeThumbnail(const core::String &fileName, const io::A
 		return image::ImagePtr();
 	}
 
+	if (software) {
+		return voxelrender::softwareVolumeThumbnail(sceneGraph, ctx);
+	}
 	return voxelrender::volumeThumbnail(sceneGraph, ctx);
 }
 
+static bool writeThumbnail(const image::ImagePtr &image, const core::String &file) {
+	if (!image) {
+		Log::error("Failed to create thumbnail");
+		return false;
+	}
+	const io::FilePtr &outfile = io::filesystem()->open(file, io::FileMode::SysWrite);
+	io::FileStream outStream(outfile);
+	if (!outStream.valid()) {
+		Log::error("Failed to open %s for writing", file.c_str());
+		return false;
+	}
+	if (!image::Image::writePng(outStream, image->data(), image->width(), image->height(), image->depth(),
+								  image::PngCompression::Fast)) {
+		Log::error("Failed to write image %s", file.c_str());
+	} else {
+		Log::info("Write image %s", file.c_str());
+	}
+	return true;
+}
+
 static bool volumeTurntable(const core::String &fileName, const core::String &imageFile,
 							voxelformat::ThumbnailContext ctx, int loops) {
 	scenegraph::SceneGraph sceneGraph;
@@ -134,9 +165,14 @@ static bool volumeTurntable(const core::String &fileName, const core::String &im
 }
 
 app::AppState Thumbnailer::onRunning() {
-	app::AppState state = Super::onRunning();
-	if (state != app::AppState::Running) {
-		return state;
+	if (_software) {
+		// the app would request the cleanup right away - just like the windowed app we ignore its state
+		app::App::onRunning();
+	} else {
+		const app::AppState state = Super::onRunning();
+		if (state != app::AppState::Running) {
+			return state;
+		}
 	}
 
 	const core::String infile = getArgVal("--input");
@@ -183,7 +219,13 @@ app::AppState Thumbnailer::onRunning() {
 	}
 
 	const int renderTurntableLoops = hasArg("--turntable") ? getArgVal("--turntable", "16").toInt() : 0;
-	if (renderTurntableLoops > 0) {
+	if (_software) {
+		if (renderTurntableLoops > 0) {
+			Log::error("The turntable is not supported by the software renderer");
+		} else {
+			renderSoftware(ctx);
+		}
+	} else if (renderTurntableLoops > 0) {
 		volumeTurntable(infile, _outfile, ctx, renderTurntableLoops);
 	} else {
 		const io::ArchivePtr &archive = io::openFilesystemArchive(_filesystem);
@@ -191,34 +233,82 @@ app::AppState Thumbnailer::onRunning() {
 			Log::error("Failed to open %s for reading", infile.c_str());
 			return app::AppState::Cleanup;
 		}
-		const image::ImagePtr &image = volumeThumbnail(infile, archive, ctx);
+		const image::ImagePtr &image = volumeThumbnail(infile, archive, ctx, false);
 		saveImage(image);
 	}
 
 	requestQuit();
-	return state;
+	return app::AppState::Running;
 }
 
-bool Thumbnailer::saveImage(const image::ImagePtr &image) {
-	if (image) {
-		const io::FilePtr &outfile = io::filesystem()->open(_outfile, io::FileMode::SysWrite);
-		io::FileStream outStream(outfile);
-		if (!outStream.valid()) {
-			Log::error("Failed to open %s for writing", _outfile.c_str());
-			return false;
+bool Thumbnailer::renderSoftware(const voxelformat::ThumbnailContext &ctx) {
+	core::DynamicArray<core::String> infiles;
+	core::DynamicArray<core::String> outfiles;
+	int argn = 0;
+	for (;;) {
+		const core::String &val = getArgVal("--input", "", &argn);
+		if (val.empty()) {
+			break;
 		}
-		if (!image::Image::writePng(outStream, image->data(), image->width(), image->height(), image->depth())) {
-			Log::error("Failed to write image %s", _outfile.c_str());
-		} else {
-			Log::info("Write image %s", _outfile.c_str());
+		infiles.push_back(val);
+	}
+	argn = 0;
+	for (;;) {
+		const core::String &val = getArgVal("--output", "", &argn);
+		if (val.empty()) {
+			break;
 		}
-		return true;
+		outfiles.push_back(val);
+	}
+	if (infiles.size() != outfiles.size()) {
+		Log::error("Each input file needs an output file - got %i input and %i output files", (int)infiles.size(),
+				   (int)outfiles.size());
+		return false;
+	}
+	const io::ArchivePtr &archive = io::openFilesystemArchive(_filesystem);
+	if (!archive) {
+		Log::error("Failed to open the filesystem for reading");
+		return false;
+	}
+	if (infiles.size() == 1u) {
+		return saveImage(volumeThumbnail(infiles[0], archive, ctx, true));
+	}
+
+	// the loaders might use the thread pool of the app - don't block it with the thumbnails
+	core::ThreadPool threadPool(core_min((size_t)core::cpus(), infiles.size()), "Thumbnailer");
+	threadPool.init();
+	core::DynamicArray<std::future<bool>> futures;
+	futures.reserve(infiles.size());
+	for (size_t i = 0; i < infiles.size(); ++i) {
+		futures.emplace_back(threadPool.enqueue([&archive, &ctx, infile = infiles[i], outfile = outfiles[i]]() {
+			if (!io::Filesystem::sysExists(infile)) {
+				Log::error("Given input file '%s' does not exist", infile.c_str());
+				return false;
+			}
+			return writeThumbnail(volumeThumbnail(infile, archive, ctx, true), outfile);
+		}));
+	}
+	bool success = true;
+	for (std::future<bool> &future : futures) {
+		success &= future.get();
+	}
+	return success;
+}
+
+bool Thumbnailer::saveImage(const image::ImagePtr &image) {
+	return writeThumbnail(image, _outfile);
+}
+
+void Thumbnailer::onAfterRunning() {
+	if (!_software) {
+		Super::onAfterRunning();
 	}
-	Log::error("Failed to create thumbnail");
-	return false;
 }
 
 app::AppState Thumbnailer::onCleanup() {
+	if (_software) {
+		return app::App::onCleanup();
+	}
 	return Super::onCleanup();
 }
 
@@ -7,6 +7,7 @@
 #include "image/Image.h"
 #include "video/WindowedApp.h"
 #include "io/File.h"
+#include "voxelformat/FormatThumbnail.h"
 
 /**
  * @brief This tool is able to generate thumbnails for all supported voxel formats
@@ -23,6 +24,13 @@ private:
 	using Super = video::WindowedApp;
 
 	core::String _outfile;
+	// render on the cpu without a window - see voxelrender::SoftwareRenderer
+	bool _software = false;
+
+	/**
+	 * @brief Renders all the given pairs of input and output files in parallel
+	 */
+	bool renderSoftware(const voxelformat::ThumbnailContext &ctx);
 
 protected:
 	virtual bool saveImage(const image::ImagePtr &image);
@@ -34,5 +42,6 @@ public:
 	app::AppState onConstruct() override;
 	app::AppState onInit() override;
 	app::AppState onRunning() override;
+	void onAfterRunning() override;
 	app::AppState onCleanup() override;
 };
@@ -6,14 +6,18 @@
 #include "core/Enum.h"
 #include "core/ConfigVar.h"
 #include "core/Log.h"
+#include "core/MemoryTracker.h"
+#include "core/PerfStats.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "core/TimeProvider.h"
+#include "core/Tokenizer.h"
 #include "core/Var.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Set.h"
 #include "core/collection/StringSet.h"
 #include "core/concurrent/Concurrency.h"
+#include "core/concurrent/ThreadPool.h"
 #include "engine-git.h"
 #include "image/Image.h"
 #include "io/Archive.h"
@@ -66,6 +70,10 @@ app::AppState VoxConvert::onConstruct() {
 	registerArg("--filter-property").setDescription("Model filter by property. For example 'name:foo'");
 	registerArg("--force").setShort("-f").setDescription("Overwrite existing files");
 	registerArg("--input").setShort("-i").setDescription("Allow to specify input files").addFlag(ARGUMENT_FLAG_FILE);
+	registerArg("--jobs")
+		.setShort("-j")
+		.setDescription("Convert each input file on its own with the given amount of parallel jobs - the output must "
+						"contain a * that is replaced by the input file name");
 	registerArg("--wildcard")
 		.setShort("-w")
 		.setDescription("Allow to specify input file filter if --input is a directory");
@@ -83,10 +91,18 @@ app::AppState VoxConvert::onConstruct() {
 	registerArg("--script")
 		.setDefaultValue("script.lua")
 		.setDescription("Apply the given lua script to the output volume");
+	registerArg("--script-jobs")
+		.setDefaultValue("1")
+		.setDescription("Execute the lua script for the models with the given amount of parallel jobs - every job only "
+						"sees the model it is executed for");
 	registerArg("--scriptcolor")
 		.setDefaultValue("1")
 		.setDescription("Set the palette index that is given to the color script parameters of the main function");
+	registerArg("--server").setDescription(
+		"Read conversion jobs from stdin - one command line per line - and answer each with a json line on stdout");
 	registerArg("--split").setDescription("Slices the models into pieces of the given size <x:y:z>");
+	registerArg("--stats").setDescription(
+		"Print the timing statistics of the format stages (load, decode, palette, validate, save) as json at the end");
 	registerArg("--surface-only")
 		.setDescription("Remove any non surface voxel. If you are meshing with this, you get also faces on the inner "
 						"side of your mesh.");
@@ -291,6 +307,19 @@ app::AppState VoxConvert::onInit() {
 		return state;
 	}
 
+	_printStats = hasArg("--stats");
+	if (hasArg("--server")) {
+		runServer();
+		return state;
+	}
+
+	if (!convert()) {
+		return app::AppState::InitFailure;
+	}
+	return state;
+}
+
+bool VoxConvert::convert() {
 	const bool hasScript = hasArg("--script");
 
 	core::String infilesstr;
@@ -315,7 +344,7 @@ app::AppState VoxConvert::onInit() {
 		}
 	} else if (!hasScript) {
 		Log::error("No input file was specified");
-		return app::AppState::InitFailure;
+		return false;
 	}
 
 	core::String outfilesstr;
@@ -375,12 +404,17 @@ app::AppState VoxConvert::onInit() {
 		Log::info("* output files:      - %s", outfilesstr.c_str());
 	}
 	core::String scriptParameters;
+	_scriptJobs = 1;
 	if (hasScript) {
 		scriptParameters = getArgVal("--script");
 		if (scriptParameters.empty()) {
 			Log::error("Missing script parameters");
 		}
 		Log::info("* script:            - %s", scriptParameters.c_str());
+		_scriptJobs = core_max(1, getArgVal("--script-jobs", "1").toInt());
+		if (_scriptJobs > 1) {
+			Log::info("* script jobs:       - %i", _scriptJobs);
+		}
 	}
 	Log::info("* show scene graph:  - %s", (_printSceneGraph ? "true" : "false"));
 	Log::info("* merge models:      - %s", (_mergeModels ? "true" : "false"));
@@ -394,6 +428,10 @@ app::AppState VoxConvert::onInit() {
 	Log::info("* export palette:    - %s", (_exportPalette ? "true" : "false"));
 	Log::info("* export models:     - %s", (_exportModels ? "true" : "false"));
 	Log::info("* resize models:     - %s", (_resizeModels ? "true" : "false"));
+	const int jobs = getArgVal("--jobs", "0").toInt();
+	if (jobs > 0) {
+		Log::info("* jobs:              - %i", jobs);
+	}
 
 	if (core::Var::getSafe(cfg::MetricFlavor)->strVal().empty()) {
 		Log::info(
@@ -401,19 +439,37 @@ app::AppState VoxConvert::onInit() {
 		Log::info("Example: '%s -set metric_flavor json --input xxx --output yyy'", fullAppname().c_str());
 	}
 
+	if (jobs > 0) {
+		if (infiles.empty() || outfiles.size() != 1u) {
+			Log::error("The batch mode needs input files and exactly one output file pattern");
+			return false;
+		}
+		if (_exportModels || _printSceneGraph) {
+			Log::error("The batch mode doesn't support --export-models or --json");
+			return false;
+		}
+		if (hasArg("--filter") || hasArg("--filter-property")) {
+			Log::warn("Don't apply model filters in batch mode");
+		}
+		if (!convertBatch(infiles, outfiles[0], scriptParameters, jobs)) {
+			return false;
+		}
+		return true;
+	}
+
 	if (!outfiles.empty()) {
 		if (!hasArg("--force")) {
 			for (const core::String &outfile : outfiles) {
 				const bool outfileExists = filesystem()->open(outfile)->exists();
 				if (outfileExists) {
 					Log::error("Given output file '%s' already exists", outfile.c_str());
-					return app::AppState::InitFailure;
+					return false;
 				}
 			}
 		}
 	} else if (!_exportModels && !_printSceneGraph) {
 		Log::error("No output specified");
-		return app::AppState::InitFailure;
+		return false;
 	}
 
 	const io::ArchivePtr &fsArchive = io::openFilesystemArchive(filesystem());
@@ -441,14 +497,14 @@ app::AppState VoxConvert::onInit() {
 			}
 			if (success == 0) {
 				Log::error("Could not find a valid input file in directory %s", infile.c_str());
-				return app::AppState::InitFailure;
+				return false;
 			}
 		} else if (io::isZipArchive(infile)) {
 			io::FileStream archiveStream(filesystem()->open(infile, io::FileMode::SysRead));
 			io::ArchivePtr archive = io::openZipArchive(&archiveStream);
 			if (!archive) {
 				Log::error("Failed to open archive %s", infile.c_str());
-				return app::AppState::InitFailure;
+				return false;
 			}
 
 			const core::String filter = getArgVal("--wildcard", "");
@@ -475,7 +531,7 @@ app::AppState VoxConvert::onInit() {
 			}
 		} else {
 			if (!handleInputFile(infile, fsArchive, sceneGraph, infiles.size() > 1)) {
-				return app::AppState::InitFailure;
+				return false;
 			}
 		}
 	}
@@ -489,10 +545,10 @@ app::AppState VoxConvert::onInit() {
 
 	if (sceneGraph.empty()) {
 		if (_exportPalette) {
-			return state;
+			return true;
 		}
 		Log::error("No valid input found in the scenegraph to operate on.");
-		return app::AppState::InitFailure;
+		return false;
 	}
 
 	const bool applyFilter = hasArg("--filter");
@@ -525,30 +581,108 @@ app::AppState VoxConvert::onInit() {
 		if (infiles.size() > 1) {
 			Log::warn("The format and path of the first input file is used for exporting all models");
 		}
+		if (_splitModels) {
+			// every piece is exported into its own file
+			split(getArgIvec3("--split"), sceneGraph);
+		}
 		for (const core::String &outfile : outfiles) {
 			io::FilePtr outputFile = filesystem()->open(outfile, io::FileMode::SysWrite);
 			if (!outputFile->validHandle()) {
 				Log::error("Could not open target file: %s", outfile.c_str());
-				return app::AppState::InitFailure;
+				return false;
 			}
 			exportModelsIntoSingleObjects(sceneGraph, infiles[0], outputFile ? outputFile->extension() : "");
 		}
-		return state;
+		return true;
+	}
+
+	if (!processSceneGraph(sceneGraph, infilesstr, scriptParameters)) {
+		return false;
+	}
+
+	for (const core::String &outfile : outfiles) {
+		if (!saveOutputFile(sceneGraph, outfile)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool readLine(FILE *file, core::String &line) {
+	line.clear();
+	char buf[1024];
+	while (fgets(buf, sizeof(buf), file) != nullptr) {
+		line.append(buf);
+		const size_t len = SDL_strlen(buf);
+		if (len > 0 && buf[len - 1] == '\n') {
+			return true;
+		}
 	}
+	return !line.empty();
+}
+
+void VoxConvert::runServer() {
+	Log::info("Waiting for conversion jobs on stdin - one command line per line, 'quit' or eof to stop");
+	const int argc = _argc;
+	char **argv = _argv;
+	core::TokenizerConfig cfg;
+	// output patterns like converted/*.vengi are no comments
+	cfg.skipComments = false;
+	core::String line;
+	int job = 0;
+	while (!shouldQuit() && readLine(stdin, line)) {
+		line = core::string::trim(line);
+		if (line.empty()) {
+			continue;
+		}
+		if (line == "quit") {
+			break;
+		}
+		const core::Tokenizer tok(cfg, line, " ");
+		core::DynamicArray<char *> jobArgv;
+		jobArgv.reserve(tok.size() + 1);
+		jobArgv.push_back(argv[0]);
+		for (const core::String &token : tok.tokens()) {
+			jobArgv.push_back(const_cast<char *>(token.c_str()));
+		}
+		_argc = (int)jobArgv.size();
+		_argv = jobArgv.data();
+		const uint64_t start = core::TimeProvider::highResTime();
+		const bool success = convert();
+		const uint64_t end = core::TimeProvider::highResTime();
+		_argc = argc;
+		_argv = argv;
+		const double millis = (double)(end - start) * 1000.0 / (double)core::TimeProvider::highResTimeResolution();
+		Log::printf("{\"job\":%i,\"success\":%s,\"millis\":%.1f}\n", job, success ? "true" : "false", millis);
+		fflush(stdout);
+		++job;
+	}
+}
+
+app::AppState VoxConvert::onCleanup() {
+	// the peak memory of the conversion
+	core::memoryLogSummary();
+	if (_printStats) {
+		Log::printf("%s\n", core::perfStatsJson().c_str());
+	}
+	return Super::onCleanup();
+}
 
+bool VoxConvert::processSceneGraph(scenegraph::SceneGraph &sceneGraph, const core::String &name,
+								   const core::String &scriptParameters) {
 	if (_mergeModels) {
 		Log::info("Merge models");
 		const scenegraph::SceneGraph::MergeResult &merged = sceneGraph.merge();
 		if (!merged.hasVolume()) {
 			Log::error("Failed to merge models");
-			return app::AppState::InitFailure;
+			return false;
 		}
 		sceneGraph.clear();
 		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
 		node.setVolume(merged.volume(), true);
 		node.setPalette(merged.palette);
 		node.setNormalPalette(merged.normalPalette);
-		node.setName(infilesstr);
+		node.setName(name);
 		sceneGraph.emplace(core::move(node));
 	}
 
@@ -588,29 +722,30 @@ app::AppState VoxConvert::onInit() {
 	if (_splitModels) {
 		split(getArgIvec3("--split"), sceneGraph);
 	}
+	return true;
+}
 
-	for (const core::String &outfile : outfiles) {
-		if (_exportPalette || (!io::isA(outfile, voxelformat::voxelSave()) && io::isA(outfile, palette::palettes()))) {
-			// if the given format is a palette only format (some voxel formats might have the same
-			// extension - so we check that here)
-			const palette::Palette &palette = sceneGraph.mergePalettes(false);
-			if (!palette.save(outfile.c_str())) {
-				Log::error("Failed to save palette to %s", outfile.c_str());
-				return app::AppState::InitFailure;
-			}
-			Log::info("Saved palette with %i colors to %s", palette.colorCount(), outfile.c_str());
-		} else {
-			Log::debug("Save %i models", (int)sceneGraph.size());
-			voxelformat::SaveContext saveCtx;
-			const io::ArchivePtr &archive = io::openFilesystemArchive(filesystem());
-			if (!voxelformat::saveFormat(sceneGraph, outfile, nullptr, archive, saveCtx)) {
-				Log::error("Failed to write to output file '%s'", outfile.c_str());
-				return app::AppState::InitFailure;
-			}
-			Log::info("Wrote output file %s", outfile.c_str());
+bool VoxConvert::saveOutputFile(scenegraph::SceneGraph &sceneGraph, const core::String &outfile) {
+	if (_exportPalette || (!io::isA(outfile, voxelformat::voxelSave()) && io::isA(outfile, palette::palettes()))) {
+		// if the given format is a palette only format (some voxel formats might have the same
+		// extension - so we check that here)
+		const palette::Palette &palette = sceneGraph.mergePalettes(false);
+		if (!palette.save(outfile.c_str())) {
+			Log::error("Failed to save palette to %s", outfile.c_str());
+			return false;
 		}
+		Log::info("Saved palette with %i colors to %s", palette.colorCount(), outfile.c_str());
+		return true;
 	}
-	return state;
+	Log::debug("Save %i models", (int)sceneGraph.size());
+	voxelformat::SaveContext saveCtx;
+	const io::ArchivePtr &archive = io::openFilesystemArchive(filesystem());
+	if (!voxelformat::saveFormat(sceneGraph, outfile, nullptr, archive, saveCtx)) {
+		Log::error("Failed to write to output file '%s'", outfile.c_str());
+		return false;
+	}
+	Log::info("Wrote output file %s", outfile.c_str());
+	return true;
 }
 
 core::String VoxConvert::getFilenameForModelName(const core::String &inputfile, const core::String &modelName,
@@ -662,6 +797,130 @@ bool VoxConvert::handleInputFile(const core::String &infile, const io::ArchivePt
 	return true;
 }
 
+bool VoxConvert::convertFile(const core::String &infile, const core::String &outfile,
+							 const core::String &scriptParameters) {
+	const io::ArchivePtr &archive = io::openFilesystemArchive(filesystem());
+	if (!archive->exists(infile)) {
+		Log::error("Given input file '%s' does not exist", infile.c_str());
+		return false;
+	}
+	scenegraph::SceneGraph sceneGraph;
+	voxelformat::LoadContext loadCtx;
+	io::FileDescription fileDesc;
+	fileDesc.set(infile);
+	if (!voxelformat::loadFormat(fileDesc, archive, sceneGraph, loadCtx)) {
+		return false;
+	}
+	if (sceneGraph.empty()) {
+		Log::error("No valid input found in %s", infile.c_str());
+		return false;
+	}
+	if (!processSceneGraph(sceneGraph, core::string::extractFilename(infile), scriptParameters)) {
+		return false;
+	}
+	return saveOutputFile(sceneGraph, outfile);
+}
+
+bool VoxConvert::convertBatch(const core::DynamicArray<core::String> &infiles, const core::String &outfilePattern,
+							  const core::String &scriptParameters, int jobs) {
+	if (!outfilePattern.contains("*")) {
+		Log::error("The output '%s' must contain a * that is replaced by the input file name", outfilePattern.c_str());
+		return false;
+	}
+	core::DynamicArray<core::String> files;
+	for (const core::String &infile : infiles) {
+		if (io::Filesystem::sysIsReadableDir(infile)) {
+			core::DynamicArray<io::FilesystemEntry> entities;
+			filesystem()->list(infile, entities, getArgVal("--wildcard", ""));
+			for (const io::FilesystemEntry &entry : entities) {
+				if (entry.type == io::FilesystemEntry::Type::file) {
+					files.push_back(core::string::path(infile, entry.name));
+				}
+			}
+		} else if (io::isZipArchive(infile)) {
+			Log::error("Archives are not supported in batch mode: %s", infile.c_str());
+			return false;
+		} else {
+			files.push_back(infile);
+		}
+	}
+	if (files.empty()) {
+		Log::error("Could not find any input file");
+		return false;
+	}
+
+	const bool force = hasArg("--force");
+	core::DynamicArray<core::String> outfiles;
+	outfiles.reserve(files.size());
+	core::StringSet uniqueOutfiles;
+	for (const core::String &file : files) {
+		const core::String &outfile =
+			core::string::replaceAll(outfilePattern, "*", core::string::extractFilename(file));
+		if (!uniqueOutfiles.insert(outfile)) {
+			Log::error("Multiple input files would be written to %s", outfile.c_str());
+			return false;
+		}
+		if (!force && filesystem()->open(outfile)->exists()) {
+			Log::error("Given output file '%s' already exists", outfile.c_str());
+			return false;
+		}
+		outfiles.push_back(outfile);
+	}
+	const core::String &outdir = core::string::extractDir(outfilePattern);
+	if (!outdir.empty()) {
+		io::Filesystem::sysCreateDir(outdir);
+	}
+
+	// the global palette is lazy loaded - don't let the workers race for it
+	voxel::getPalette();
+
+	Log::info("Convert %i files with %i jobs", (int)files.size(), jobs);
+	// the workers are using their own pool - the formats are using the pool of the app for their own parallel work
+	// and would wait for tasks that are queued behind the conversions otherwise.
+	core::ThreadPool pool(jobs, "VoxConvert");
+	pool.init();
+	// the scenes only exist while a conversion is running - the window of queued conversions keeps the workers busy
+	// while the results are waited for in the order of the input files
+	const size_t window = (size_t)jobs * 4u;
+	core::DynamicArray<std::future<bool>> futures;
+	futures.reserve(files.size());
+	auto submit = [&]() {
+		const size_t i = futures.size();
+		futures.emplace_back(
+			pool.enqueue([this, &files, &outfiles, &scriptParameters, i]() {
+				return convertFile(files[i], outfiles[i], scriptParameters);
+			}));
+	};
+	while (futures.size() < files.size() && futures.size() < window) {
+		submit();
+	}
+	core::DynamicArray<core::String> failed;
+	int converted = 0;
+	for (size_t i = 0; i < futures.size(); ++i) {
+		const bool success = futures[i].valid() && futures[i].get();
+		if (futures.size() < files.size() && !shouldQuit()) {
+			submit();
+		}
+		if (success) {
+			Log::info("[%i/%i] %s => %s", (int)i + 1, (int)files.size(), files[i].c_str(), outfiles[i].c_str());
+			++converted;
+		} else {
+			Log::error("[%i/%i] Failed to convert %s", (int)i + 1, (int)files.size(), files[i].c_str());
+			failed.push_back(files[i]);
+		}
+	}
+	pool.shutdown(true);
+
+	Log::info("Converted %i of %i files", converted, (int)files.size());
+	if (!failed.empty()) {
+		Log::error("Failed to convert %i files:", (int)failed.size());
+		for (const core::String &file : failed) {
+			Log::error(" * %s", file.c_str());
+		}
+	}
+	return failed.empty() && converted == (int)files.size();
+}
+
 static bool hasUniqueModelNames(const scenegraph::SceneGraph &sceneGraph) {
 	core::StringSet names;
 	for (const auto &entry : sceneGraph.nodes()) {
@@ -680,26 +939,60 @@ void VoxConvert::exportModelsIntoSingleObjects(scenegraph::SceneGraph &sceneGrap
 											   const core::String &ext) {
 	Log::info("Export models into single objects");
 	int id = 0;
-	voxelformat::SaveContext saveCtx;
 	const auto &nodes = sceneGraph.nodes();
 	const bool uniqueNames = hasUniqueModelNames(sceneGraph);
+	struct ExportJob {
+		scenegraph::SceneGraph sceneGraph;
+		core::String filename;
+		bool success = false;
+	};
+	core::DynamicArray<ExportJob> jobs;
+	jobs.reserve(nodes.size());
 	for (auto entry : nodes) {
 		const scenegraph::SceneGraphNode &node = entry->value;
 		if (!node.isModelNode()) {
 			continue;
 		}
-		scenegraph::SceneGraph newSceneGraph;
+		jobs.emplace_back();
+		ExportJob &job = jobs.back();
 		scenegraph::SceneGraphNode newNode;
 		scenegraph::copyNode(node, newNode, false);
-		newSceneGraph.emplace(core::move(newNode));
-		const core::String &filename = getFilenameForModelName(inputfile, node.name(), ext, id, uniqueNames);
-		const io::ArchivePtr &archive = io::openFilesystemArchive(filesystem());
-		if (voxelformat::saveFormat(newSceneGraph, filename, nullptr, archive, saveCtx)) {
-			Log::info(" .. %s", filename.c_str());
+		job.sceneGraph.emplace(core::move(newNode));
+		job.filename = getFilenameForModelName(inputfile, node.name(), ext, id, uniqueNames);
+		++id;
+	}
+	if (jobs.empty()) {
+		return;
+	}
+
+	// the global palette is lazy loaded - don't let the workers race for it
+	voxel::getPalette();
+
+	// the models are written to their own files - the formats are using the pool of the app for their own parallel
+	// work, so the exports need their own pool
+	const int threads = core_min((int)core::cpus(), (int)jobs.size());
+	core::ThreadPool pool(threads, "VoxConvertExport");
+	pool.init();
+	core::DynamicArray<std::future<void>> futures;
+	futures.reserve(jobs.size());
+	for (ExportJob &job : jobs) {
+		futures.emplace_back(pool.enqueue([this, &job]() {
+			voxelformat::SaveContext saveCtx;
+			const io::ArchivePtr &archive = io::openFilesystemArchive(filesystem());
+			job.success = voxelformat::saveFormat(job.sceneGraph, job.filename, nullptr, archive, saveCtx);
+		}));
+	}
+	for (std::future<void> &future : futures) {
+		future.wait();
+	}
+	pool.shutdown(true);
+
+	for (const ExportJob &job : jobs) {
+		if (job.success) {
+			Log::info(" .. %s", job.filename.c_str());
 		} else {
-			Log::error(" .. %s", filename.c_str());
+			Log::error(" .. %s", job.filename.c_str());
 		}
-		++id;
 	}
 }
 
@@ -715,7 +1008,9 @@ void VoxConvert::split(const glm::ivec3 &size, scenegraph::SceneGraph &sceneGrap
 	const scenegraph::SceneGraph::MergeResult &merged = sceneGraph.merge();
 	sceneGraph.clear();
 	core::ScopedPtr<voxel::RawVolume> volume(merged.volume());
-	core::DynamicArray<voxel::RawVolume *> rawVolumes = voxelutil::splitVolume(volume, size);
+	// find the empty pieces of sparse worlds without copying them
+	volume->setOccupancyTracking(true);
+	core::DynamicArray<voxel::RawVolume *> rawVolumes = voxelutil::splitVolume(volume, size, false, &threadPool());
 	for (voxel::RawVolume *v : rawVolumes) {
 		scenegraph::SceneGraphNode node;
 		node.setVolume(v, true);
@@ -929,6 +1224,138 @@ void VoxConvert::removeNonSurfaceVoxels(scenegraph::SceneGraph &sceneGraph) {
 	}
 }
 
+static bool runScript(voxelgenerator::LUAApi &script, const core::String &luaScript, scenegraph::SceneGraph &sceneGraph,
+					  int nodeId, const voxel::Voxel &voxel, const core::DynamicArray<core::String> &args) {
+	const scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+	Log::debug("execute for node: %i", nodeId);
+	if (!script.exec(luaScript, sceneGraph, node.id(), node.region(), voxel, args)) {
+		return false;
+	}
+	while (script.scriptStillRunning()) {
+		script.update(0.0);
+	}
+	return true;
+}
+
+/**
+ * @brief The scene graph a script is executed on by a worker - it only contains a copy of the node the script is
+ * executed for
+ */
+struct ScriptJob {
+	scenegraph::SceneGraph sceneGraph{64};
+	int nodeId = InvalidNodeId;
+	bool success = false;
+};
+
+static void moveScriptNodes_r(scenegraph::SceneGraph &target, scenegraph::SceneGraph &source, int sourceNodeId,
+							  int parent) {
+	scenegraph::SceneGraphNode &sourceNode = source.node(sourceNodeId);
+	const int newNodeId = scenegraph::moveNodeToSceneGraph(target, sourceNode, parent);
+	if (newNodeId == InvalidNodeId) {
+		Log::error("Failed to add the node %s of the script", sourceNode.name().c_str());
+		return;
+	}
+	for (int childId : sourceNode.children()) {
+		moveScriptNodes_r(target, source, childId, newNodeId);
+	}
+}
+
+/**
+ * @brief Applies the result of a script job to the node it was executed for and adds the nodes the script created
+ */
+static void applyScriptJob(scenegraph::SceneGraph &sceneGraph, int nodeId, ScriptJob &job) {
+	const int parent = sceneGraph.node(nodeId).parent();
+	for (const core::String &animation : job.sceneGraph.animations()) {
+		if (!sceneGraph.hasAnimation(animation)) {
+			sceneGraph.addAnimation(animation);
+		}
+	}
+	const scenegraph::SceneGraphNode &jobRoot = job.sceneGraph.root();
+	for (int childId : jobRoot.children()) {
+		if (childId != job.nodeId) {
+			moveScriptNodes_r(sceneGraph, job.sceneGraph, childId, parent);
+		}
+	}
+	if (!job.sceneGraph.hasNode(job.nodeId)) {
+		// the script removed the node
+		sceneGraph.removeNode(nodeId, true);
+		return;
+	}
+	scenegraph::SceneGraphNode &jobNode = job.sceneGraph.node(job.nodeId);
+	scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+	node.setVolume(jobNode.volume(), true);
+	jobNode.releaseOwnership();
+	node.setName(jobNode.name());
+	node.addProperties(jobNode.properties());
+	node.setPivot(jobNode.pivot());
+	node.setAllKeyFrames(jobNode.allKeyFrames(), sceneGraph.activeAnimation());
+	if (jobNode.hasPalette()) {
+		node.setPalette(jobNode.palette());
+	}
+	for (int childId : jobNode.children()) {
+		moveScriptNodes_r(sceneGraph, job.sceneGraph, childId, nodeId);
+	}
+}
+
+void VoxConvert::scriptParallel(const core::String &luaScript, const core::DynamicArray<core::String> &args,
+								scenegraph::SceneGraph &sceneGraph, const core::DynamicArray<int> &nodes,
+								const voxel::Voxel &voxel) {
+	// every job gets its own scene graph with a copy on write copy of its node - the modifications to the scene
+	// graph are applied on the calling thread after all scripts are done
+	core::DynamicArray<ScriptJob> jobs;
+	jobs.resize(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		const scenegraph::SceneGraphNode &node = sceneGraph.node(nodes[i]);
+		ScriptJob &job = jobs[i];
+		job.sceneGraph.setAnimations(sceneGraph.animations());
+		job.sceneGraph.setAnimation(sceneGraph.activeAnimation());
+		job.nodeId = scenegraph::copyNodeToSceneGraph(job.sceneGraph, node, job.sceneGraph.root().id());
+		if (job.nodeId != InvalidNodeId) {
+			job.sceneGraph.node(job.nodeId).setAllKeyFrames(node.allKeyFrames(), sceneGraph.activeAnimation());
+			job.sceneGraph.updateTransforms();
+		}
+	}
+
+	// the global palette is lazy loaded - don't let the workers race for it
+	voxel::getPalette();
+
+	const int threads = core_min(_scriptJobs, (int)nodes.size());
+	Log::info("Execute the script for %i nodes with %i jobs", (int)nodes.size(), threads);
+	// the scripts are using the pool of the app for their own parallel work - so they need their own pool
+	core::ThreadPool pool(threads, "VoxConvertScript");
+	pool.init();
+	core::DynamicArray<std::future<void>> futures;
+	futures.reserve(jobs.size());
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		ScriptJob &job = jobs[i];
+		if (job.nodeId == InvalidNodeId) {
+			continue;
+		}
+		futures.emplace_back(pool.enqueue([this, &job, &luaScript, &args, &voxel]() {
+			voxelgenerator::LUAApi script(_filesystem);
+			if (!script.init()) {
+				Log::error("Failed to initialize the script bindings");
+				return;
+			}
+			job.success = runScript(script, luaScript, job.sceneGraph, job.nodeId, voxel, args);
+			script.shutdown();
+		}));
+	}
+	for (std::future<void> &future : futures) {
+		future.wait();
+	}
+	pool.shutdown(true);
+
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		if (!jobs[i].success) {
+			Log::error("Failed to execute the script for node %i", nodes[i]);
+			continue;
+		}
+		applyScriptJob(sceneGraph, nodes[i], jobs[i]);
+	}
+	sceneGraph.updateTransforms();
+}
+
 void VoxConvert::script(const core::String &scriptParameters, scenegraph::SceneGraph &sceneGraph, uint8_t color) {
 	voxelgenerator::LUAApi script(_filesystem);
 	if (!script.init()) {
@@ -954,14 +1381,13 @@ void VoxConvert::script(const core::String &scriptParameters, scenegraph::SceneG
 			for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
 				nodes.push_back((*iter).id());
 			}
-			for (int nodeId : nodes) {
-				const scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
-				Log::debug("execute for node: %i", nodeId);
-				if (!script.exec(luaScript, sceneGraph, node.id(), node.region(), voxel, args)) {
-					break;
-				}
-				while (script.scriptStillRunning()) {
-					script.update(0.0);
+			if (_scriptJobs > 1 && nodes.size() > 1) {
+				scriptParallel(luaScript, args, sceneGraph, nodes, voxel);
+			} else {
+				for (int nodeId : nodes) {
+					if (!runScript(script, luaScript, sceneGraph, nodeId, voxel, args)) {
+						break;
+					}
 				}
 			}
 		}
@@ -979,7 +1405,7 @@ void VoxConvert::scale(scenegraph::SceneGraph &sceneGraph) {
 		const voxel::Region destRegion(srcRegion.getLowerCorner(), srcRegion.getLowerCorner() + targetDimensionsHalf);
 		if (destRegion.isValid()) {
 			voxel::RawVolume *destVolume = new voxel::RawVolume(destRegion);
-			voxelutil::scaleDown(*node.volume(), node.palette(), *destVolume);
+			voxelutil::scaleDown(*node.volume(), node.palette(), *destVolume, &threadPool());
 			node.setVolume(destVolume, true);
 		}
 	}
@@ -1073,7 +1499,9 @@ void VoxConvert::mirror(const core::String &axisStr, scenegraph::SceneGraph &sce
 	Log::info("Mirror on axis %c", axisStr[0]);
 	for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
 		scenegraph::SceneGraphNode &node = *iter;
-		node.setVolume(voxelutil::mirrorAxis(node.volume(), axis), true);
+		if (voxel::RawVolume *v = node.volume()) {
+			voxelutil::mirrorAxis(*v, axis);
+		}
 	}
 }
 
@@ -1095,7 +1523,8 @@ void VoxConvert::rotate(const core::String &axisStr, scenegraph::SceneGraph &sce
 		scenegraph::SceneGraphNode &node = *iter;
 		glm::vec3 rotVec{0.0f};
 		rotVec[math::getIndexForAxis(axis)] = degree;
-		node.setVolume(voxelutil::rotateVolume(node.volume(), node.palette(), rotVec, glm::vec3(0.5f)), true);
+		node.setVolume(voxelutil::rotateVolume(node.volume(), node.palette(), rotVec, glm::vec3(0.5f), &threadPool()),
+					   true);
 	}
 }
 
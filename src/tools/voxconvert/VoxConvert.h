@@ -5,9 +5,14 @@
 #pragma once
 
 #include "app/CommandlineApp.h"
+#include "core/collection/DynamicArray.h"
 #include "io/Archive.h"
 #include "scenegraph/SceneGraph.h"
 
+namespace voxel {
+class Voxel;
+}
+
 /**
  * @brief This tool is able to convert voxel volumes between different formats
  *
@@ -39,6 +44,8 @@ private:
 	bool _splitModels = false;
 	bool _printSceneGraph = false;
 	bool _resizeModels = false;
+	bool _printStats = false;
+	int _scriptJobs = 1;
 
 	struct NodeStats {
 		int voxels = 0;
@@ -66,6 +73,37 @@ protected:
 										 const core::String &outExt, int id, bool uniqueNames);
 	bool handleInputFile(const core::String &infile, const io::ArchivePtr &archive, scenegraph::SceneGraph &sceneGraph,
 						 bool multipleInputs);
+	/**
+	 * @brief Applies the operations that were given on the command line - like merge, scale or crop
+	 */
+	bool processSceneGraph(scenegraph::SceneGraph &sceneGraph, const core::String &name,
+						   const core::String &scriptParameters);
+	bool saveOutputFile(scenegraph::SceneGraph &sceneGraph, const core::String &outfile);
+	/**
+	 * @brief Loads, processes and saves a single input file on its own - this is what a worker of the batch mode does
+	 */
+	bool convertFile(const core::String &infile, const core::String &outfile, const core::String &scriptParameters);
+	/**
+	 * @brief Converts each input file into its own output file with the given amount of parallel jobs
+	 *
+	 * The @c * in the output pattern is replaced with the name of the input file. Only as many scenes as there are
+	 * jobs are in memory at the same time. The results are reported in the order of the input files.
+	 */
+	bool convertBatch(const core::DynamicArray<core::String> &infiles, const core::String &outfilePattern,
+					  const core::String &scriptParameters, int jobs);
+
+	/**
+	 * @brief Applies the conversion that is described by the current command line arguments
+	 */
+	bool convert();
+	/**
+	 * @brief Executes the command lines that are read from stdin as conversion jobs in this process
+	 *
+	 * This avoids the startup costs of a new process for every file and keeps the caches warm. The jobs are executed
+	 * one after another - use @c --jobs in a job to convert its files in parallel. Every job is answered with a json
+	 * line like @c {"job":0,"success":true,"millis":12.3} on stdout.
+	 */
+	void runServer();
 
 	void usage() const override;
 	void printUsageHeader() const override;
@@ -75,6 +113,13 @@ protected:
 	bool slice(const scenegraph::SceneGraph& sceneGraph, const core::String &outfile);
 	void resize(const glm::ivec3 &size, scenegraph::SceneGraph& sceneGraph);
 	void script(const core::String &scriptParameters, scenegraph::SceneGraph& sceneGraph, uint8_t color);
+	/**
+	 * @brief Executes the script for the given nodes in parallel - every job is working on its own copy of the node
+	 * and the results are applied to the given scene graph afterwards
+	 */
+	void scriptParallel(const core::String &luaScript, const core::DynamicArray<core::String> &args,
+						scenegraph::SceneGraph &sceneGraph, const core::DynamicArray<int> &nodes,
+						const voxel::Voxel &voxel);
 	void translate(const glm::ivec3& pos, scenegraph::SceneGraph& sceneGraph);
 	void crop(scenegraph::SceneGraph& sceneGraph);
 	void removeNonSurfaceVoxels(scenegraph::SceneGraph& sceneGraph);
@@ -89,4 +134,5 @@ public:
 
 	app::AppState onConstruct() override;
 	app::AppState onInit() override;
+	app::AppState onCleanup() override;
 };
@@ -51,7 +51,8 @@ app::AppState VoxConvertUI::onInit() {
 	}
 	_voxconvertBinary = _filesystem->sysFindBinary("vengi-voxconvert");
 
-	_paletteCache.detectPalettes();
+	// the palette files are searched in the background to not delay the startup
+	_paletteCache.detectPalettes(true, &threadPool());
 
 	if (_argc >= 2) {
 		_sourceFile = _argv[_argc - 1];
@@ -121,6 +121,9 @@ app::AppState VoxEdit::onConstruct() {
 	core::Var::get(cfg::VoxEditGrayInactive, "false", _("Render the inactive nodes in gray scale mode"), core::Var::boolValidator);
 	core::Var::get(cfg::VoxEditHideInactive, "false", _("Hide the inactive nodes"), core::Var::boolValidator);
 	core::Var::get(cfg::VoxEditViewdistance, "5000");
+	core::Var::get(cfg::VoxEditDynamicResolution, "true", _("Render the viewports in a lower resolution while the camera is moving and the gpu time exceeds the frame budget"), core::Var::boolValidator);
+	core::Var::get(cfg::VoxEditFrameBudget, "12", _("The gpu time in milliseconds a viewport may take for a frame with dynamic resolution"));
+	core::Var::get(cfg::VoxEditSkipIdleRedraw, "true", _("Only render the viewports again if the camera or the scene changed"), core::Var::boolValidator);
 	core::Var::get(cfg::VoxEditShowaxis, "true", _("Show the axis"), core::Var::boolValidator);
 	core::Var::get(cfg::VoxEditCursorDetails, "1", _("Print cursor details in edit mode"), core::Var::minMaxValidator<0, 2>);
 	core::Var::get(cfg::VoxEditAutoKeyFrame, "true", _("Automatically create keyframes when changing transforms"), core::Var::boolValidator);
@@ -480,7 +483,8 @@ app::AppState VoxEdit::onInit() {
 	_mainWindow->registerUITests(_imguiTestEngine, "###app");
 #endif
 
-	_paletteCache.detectPalettes();
+	// the palette files are searched in the background to not delay the startup
+	_paletteCache.detectPalettes(true, &threadPool());
 
 	return state;
 }
@@ -508,6 +512,7 @@ app::AppState VoxEdit::onRunning() {
 	}
 
 	_collectionMgr->update(_nowSeconds);
+	_texturePool->update();
 	const voxedit::Viewport *viewport = _mainWindow->hoveredViewport();
 	if (viewport) {
 		if (viewport->isSceneMode()) {
@@ -14,6 +14,17 @@ public:
 		_showWindow = false;
 		_wantCrashLogs = false;
 	}
+
+	app::AppState onConstruct() override {
+		const app::AppState state = Super::onConstruct();
+		registerArg("--perf").setDescription("Run the performance scenarios instead of the ui tests");
+		return state;
+	}
+
+	app::AppState onInit() override {
+		_runPerfTests = hasArg("--perf");
+		return Super::onInit();
+	}
 };
 
 int main(int argc, char *argv[]) {
@@ -44,6 +44,9 @@ void AnimationTimeline::header(scenegraph::FrameIndex currentFrame, scenegraph::
 		if (ImGui::DisabledButton(ICON_LC_PLAY, maxFrame <= 0)) {
 			_play = true;
 			_frameTimeSeconds = 0.0;
+			// the key frames can't get modified while playing - evaluate the transforms of all frames only once
+			const scenegraph::SceneGraph &sceneGraph = _sceneMgr->sceneGraph();
+			sceneGraph.bakeTransforms(sceneGraph.activeAnimation());
 			if (!_loop && currentFrame >= maxFrame) {
 				_sceneMgr->setCurrentFrame(0);
 			}
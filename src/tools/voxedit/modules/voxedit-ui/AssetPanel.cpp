@@ -6,6 +6,7 @@
 #include "ui/IconsLucide.h"
 #include "app/Async.h"
 #include "core/StringUtil.h"
+#include "core/collection/DynamicArray.h"
 #include "image/Image.h"
 #include "io/File.h"
 #include "io/Filesystem.h"
@@ -69,33 +70,44 @@ void AssetPanel::update(const char *id, command::CommandExecutionListener &liste
 				image::ImagePtr loadImage;
 				while (_images.pop(loadImage)) {
 					if (loadImage->isLoaded()) {
-						_texturePool->addImage(loadImage);
+						_texturePool->addImageAsync(loadImage);
 					}
 				}
-				int n = 1;
-				ImGuiStyle &style = ImGui::GetStyle();
-				const int maxImages = core_max(1, ImGui::GetWindowSize().x / (50 + style.ItemSpacing.x) - 1);
+				using TextureEntry = core::DynamicStringMap<video::TexturePtr>::KeyValue;
+				core::DynamicArray<const TextureEntry *> entries;
 				for (const auto &e : _texturePool->cache()) {
 					if (!e->second || !e->second->isLoaded()) {
 						continue;
 					}
-					const video::Id handle = e->second->handle();
-					const image::ImagePtr &image = _texturePool->loadImage(e->first);
-					core::String imgId = core::string::format("%i", n - 1);
-					ImGui::ImageButton(imgId.c_str(), handle, ImVec2(50, 50));
-					ImGui::TooltipText("%s: %i:%i", image->name().c_str(), image->width(), image->height());
-					if (n % maxImages == 0) {
-						ImGui::NewLine();
-					} else {
-						ImGui::SameLine();
-					}
-					if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID)) {
-						ImGui::ImageButton(imgId.c_str(), handle, ImVec2(50, 50));
-						ImGui::SetDragDropPayload(voxelui::dragdrop::ImagePayload, (const void *)&image, sizeof(image),
-												  ImGuiCond_Always);
-						ImGui::EndDragDropSource();
+					entries.push_back(e);
+				}
+				ImGuiStyle &style = ImGui::GetStyle();
+				const int maxImages = core_max(1, ImGui::GetWindowSize().x / (50 + style.ItemSpacing.x) - 1);
+				const int rows = ((int)entries.size() + maxImages - 1) / maxImages;
+				// only the rows that are visible are submitted
+				ImGuiListClipper clipper;
+				clipper.Begin(rows);
+				while (clipper.Step()) {
+					for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+						const int end = core_min((int)entries.size(), (row + 1) * maxImages);
+						for (int i = row * maxImages; i < end; ++i) {
+							const TextureEntry *e = entries[i];
+							const video::Id handle = e->second->handle();
+							const image::ImagePtr &image = _texturePool->loadImage(e->first);
+							core::String imgId = core::string::format("%i", i);
+							if (i != row * maxImages) {
+								ImGui::SameLine();
+							}
+							ImGui::ImageButton(imgId.c_str(), handle, ImVec2(50, 50));
+							ImGui::TooltipText("%s: %i:%i", image->name().c_str(), image->width(), image->height());
+							if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID)) {
+								ImGui::ImageButton(imgId.c_str(), handle, ImVec2(50, 50));
+								ImGui::SetDragDropPayload(voxelui::dragdrop::ImagePayload, (const void *)&image,
+														  sizeof(image), ImGuiCond_Always);
+								ImGui::EndDragDropSource();
+							}
+						}
 					}
-					++n;
 				}
 				ImGui::EndTabItem();
 			}
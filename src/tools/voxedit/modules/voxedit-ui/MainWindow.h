@@ -142,6 +142,10 @@ private:
 	void registerPopups();
 	void addTemplate(const TemplateModel &model);
 	void updateViewMode();
+#ifdef IMGUI_ENABLE_TEST_ENGINE
+	// the end-to-end performance scenarios - see tests/PerfTest.cpp
+	void registerPerfTests(ImGuiTestEngine *engine);
+#endif
 public:
 	MainWindow(ui::IMGUIApp *app, const SceneManagerPtr &sceneMgr, const video::TexturePoolPtr &texturePool,
 			   const voxelcollection::CollectionManagerPtr &collectionMgr, const io::FilesystemPtr &filesystem, palette::PaletteCache &paletteCache);
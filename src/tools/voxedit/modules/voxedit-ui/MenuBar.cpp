@@ -39,6 +39,7 @@ void MenuBar::viewportOptions() {
 	ImGui::IconCheckboxVar(ICON_LC_SUNSET, _("Shadow"), cfg::VoxEditRendershadow);
 	ImGui::IconCheckboxVar(ICON_LC_SUN, _("Bloom"), cfg::ClientBloom);
 	ImGui::IconSliderVarInt(ICON_LC_ECLIPSE, _("Tone mapping"), cfg::ToneMapping, 0, 3);
+	ImGui::IconCheckboxVar(ICON_LC_GAUGE, _("Dynamic resolution"), cfg::VoxEditDynamicResolution);
 }
 
 void MenuBar::init() {
@@ -173,6 +174,9 @@ bool MenuBar::update(ui::IMGUIApp *app, command::CommandExecutionListener &liste
 			if (ImGui::IconMenuItem(ICON_LC_SETTINGS, _("Show all cvars"))) {
 				app->showCvarDialog();
 			}
+			if (ImGui::IconMenuItem(ICON_LC_GAUGE, _("Performance statistics"))) {
+				app->showStatsDialog();
+			}
 			if (ImGui::IconMenuItem(ICON_LC_LIGHTBULB, _("Tip of the day"))) {
 				core::Var::getSafe(cfg::VoxEditPopupTipOfTheDay)->setVal(true);
 			}
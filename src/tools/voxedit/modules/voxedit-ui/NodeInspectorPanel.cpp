@@ -276,7 +276,7 @@ void NodeInspectorPanel::sceneView(command::CommandExecutionListener &listener)
 }
 
 void NodeInspectorPanel::detailView(scenegraph::SceneGraphNode &node) {
-	ImGui::Text(_("UUID: %s"), node.uuid().c_str());
+	ImGui::Text(_("UUID: %s"), node.uuid().str().c_str());
 
 	core::String deleteKey;
 	static const uint32_t tableFlags = ImGuiTableFlags_Reorderable | ImGuiTableFlags_Resizable |
@@ -38,9 +38,13 @@ void RenderPanel::renderMenuBar(const scenegraph::SceneGraph &sceneGraph) {
 			const yocto::trace_params &params = state.params;
 			ImGui::TooltipText(_("Sample %i / %i"), _currentSample, params.samples);
 			_pathTracer.update(&_currentSample);
-			_image = _pathTracer.image();
-			if (_image->isLoaded()) {
-				_texture->upload(_image);
+			// only upload if a tile got new samples
+			const image::ImagePtr &image = _pathTracer.image();
+			if (image && image != _image) {
+				_image = image;
+				if (_image->isLoaded()) {
+					_texture->upload(_image);
+				}
 			}
 		} else {
 			if (ImGui::Button(_("Start path tracer"))) {
@@ -58,9 +62,18 @@ void RenderPanel::update(const char *id, const scenegraph::SceneGraph &sceneGrap
 		if (_pathTracer.started()) {
 			voxelpathtracer::PathTracerState &state = _pathTracer.state();
 			yocto::trace_params &params = state.params;
+			const video::Camera *camera = _sceneMgr->activeCamera();
+			bool restart = false;
 			if (params.resolution != ImGui::GetContentRegionAvail().x) {
 				params.resolution = ImGui::GetContentRegionAvail().x;
-				_pathTracer.restart(sceneGraph, _sceneMgr->activeCamera());
+				restart = true;
+			}
+			if (camera != nullptr && camera->viewMatrix() != _cameraView) {
+				_cameraView = camera->viewMatrix();
+				restart = true;
+			}
+			if (restart) {
+				_pathTracer.restart(sceneGraph, camera);
 			}
 		}
 		renderMenuBar(sceneGraph);
@@ -102,6 +115,9 @@ void RenderPanel::updateSettings(const char *id, const scenegraph::SceneGraph &s
 		changed += ImGui::Checkbox(_("High Quality BVH"), &params.highqualitybvh);
 		ImGui::TooltipTextUnformatted(_("High quality bounding volume hierarchy"));
 		changed += ImGui::Checkbox(_("Denoise"), &params.denoise);
+		changed += ImGui::Checkbox(_("Voxel tracing"), &state.voxelTracing);
+		ImGui::TooltipTextUnformatted(_("Trace the voxels directly without converting them into triangles - only "
+										"supports the naive sampler"));
 
 		if (ImGui::Button(_("Reset all"))) {
 			params = yocto::trace_params();
@@ -6,6 +6,7 @@
 
 #include "ui/Panel.h"
 #include "video/Texture.h"
+#include <glm/mat4x4.hpp>
 #include "voxelpathtracer/PathTracer.h"
 
 namespace ui {
@@ -25,6 +26,8 @@ private:
 	image::ImagePtr _image;
 	SceneManagerPtr _sceneMgr;
 	int _currentSample = 0;
+	// the path tracer is restarted if the camera is moved - the scene is kept and only the camera is updated
+	glm::mat4 _cameraView{1.0f};
 
 	void renderMenuBar(const scenegraph::SceneGraph &sceneGraph);
 
@@ -10,6 +10,7 @@
 #include "core/Optional.h"
 #include "core/StringUtil.h"
 #include "imgui.h"
+#include "dearimgui/imgui_internal.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "ui/IMGUIEx.h"
 #include "ui/IconsLucide.h"
@@ -104,19 +105,47 @@ bool SceneGraphPanel::isFiltered(const scenegraph::SceneGraphNode &node) const {
 	return false;
 }
 
-void SceneGraphPanel::recursiveAddNodes(video::Camera &camera, const scenegraph::SceneGraph &sceneGraph,
-							  scenegraph::SceneGraphNode &node, command::CommandExecutionListener &listener,
-							  int depth, int referencedNodeId) {
+static inline core::String treeNodeLabel(const scenegraph::SceneGraphNode &node) {
+	return core::string::format("%s##%i", node.name().c_str(), node.id());
+}
+
+void SceneGraphPanel::collectRows(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
+								  int depth) {
+	if (isFiltered(node)) {
+		// the children of filtered nodes are still shown
+		for (int nodeIdx : node.children()) {
+			collectRows(sceneGraph, sceneGraph.node(nodeIdx), depth + 1);
+		}
+		return;
+	}
+	_rows.push_back({node.id(), depth, ImGui::GetCurrentWindow()->IDStack.back()});
+	if (node.isLeaf()) {
+		return;
+	}
+	// the open state of the tree node from the last frame - the tree nodes are open by default
+	const ImGuiID storageId = ImGui::GetID(treeNodeLabel(node).c_str());
+	if (ImGui::GetStateStorage()->GetInt(storageId, 1) == 0) {
+		return;
+	}
+	ImGui::PushOverrideID(storageId);
+	for (int nodeIdx : node.children()) {
+		collectRows(sceneGraph, sceneGraph.node(nodeIdx), depth + 1);
+	}
+	ImGui::PopID();
+}
+
+void SceneGraphPanel::addNode(video::Camera &camera, const scenegraph::SceneGraph &sceneGraph, const NodeRow &row,
+							  command::CommandExecutionListener &listener, int referencedNodeId) {
+	scenegraph::SceneGraphNode &node = sceneGraph.node(row.nodeId);
 	const int nodeId = node.id();
-	bool open = false;
+	const int depth = row.depth;
 	const int activeNode = sceneGraph.activeNode();
 	const bool referenceNode = node.reference() == activeNode;
 	const bool referencedNode = referencedNodeId == nodeId;
 	const bool referenceHighlight = referenceNode || referencedNode;
 
-	const bool filtered = isFiltered(node);
-
-	if (!filtered) {
+	ImGui::PushOverrideID(row.idScope);
+	{
 		ImGui::TableNextRow();
 		{ // column 1
 			ImGui::TableNextColumn();
@@ -185,11 +214,12 @@ void SceneGraphPanel::recursiveAddNodes(video::Camera &camera, const scenegraph:
 			case scenegraph::SceneGraphNodeType::Max:
 				break;
 			}
-			const core::String &name = core::string::format("%s##%i", node.name().c_str(), nodeId);
+			const core::String &name = treeNodeLabel(node);
 			const bool selected = nodeId == sceneGraph.activeNode();
-			ImGuiTreeNodeFlags treeFlags = ImGuiTreeNodeFlags_SpanFullWidth;
+			// the children are collected as rows on their own - see collectRows()
+			ImGuiTreeNodeFlags treeFlags = ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen;
 			if (node.isLeaf()) {
-				treeFlags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+				treeFlags |= ImGuiTreeNodeFlags_Leaf;
 			} else {
 				treeFlags |= ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_OpenOnDoubleClick;
 			}
@@ -199,11 +229,7 @@ void SceneGraphPanel::recursiveAddNodes(video::Camera &camera, const scenegraph:
 
 			const float indent = (float)depth * (ImGui::GetStyle().FramePadding.x + 4.0f);
 			ImGui::Indent(indent);
-			if (node.isLeaf()) {
-				ImGui::IconTreeNodeEx(icon, name.c_str(), treeFlags);
-			} else {
-				open = ImGui::IconTreeNodeEx(icon, name.c_str(), treeFlags);
-			}
+			ImGui::IconTreeNodeEx(icon, name.c_str(), treeFlags);
 			ImGui::Unindent(indent);
 
 			if (activeNode != _lastActivedNodeId && nodeId == activeNode) {
@@ -249,15 +275,7 @@ void SceneGraphPanel::recursiveAddNodes(video::Camera &camera, const scenegraph:
 			ImGui::TooltipTextUnformatted(_("Delete this model"));
 		}
 	}
-
-	if (open || filtered) {
-		for (int nodeIdx : node.children()) {
-			recursiveAddNodes(camera, sceneGraph, sceneGraph.node(nodeIdx), listener, depth + 1, referencedNodeId);
-		}
-		if (open) {
-			ImGui::TreePop();
-		}
-	}
+	ImGui::PopID();
 }
 
 bool SceneGraphPanel::init() {
@@ -381,7 +399,26 @@ void SceneGraphPanel::update(video::Camera& camera, const char *id, ModelNodeSet
 				referencedNode = activeNode.reference();
 			}
 
-			recursiveAddNodes(camera, sceneGraph, sceneGraph.node(sceneGraph.root().id()), listener, 0, referencedNode);
+			_rows.clear();
+			collectRows(sceneGraph, sceneGraph.root(), 0);
+
+			// only the rows in the visible part of the table are submitted - the row of a newly activated node is
+			// always submitted to scroll to it
+			ImGuiListClipper clipper;
+			clipper.Begin((int)_rows.size());
+			if (sceneGraph.activeNode() != _lastActivedNodeId) {
+				for (int i = 0; i < (int)_rows.size(); ++i) {
+					if (_rows[i].nodeId == sceneGraph.activeNode()) {
+						clipper.IncludeItemByIndex(i);
+						break;
+					}
+				}
+			}
+			while (clipper.Step()) {
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+					addNode(camera, sceneGraph, _rows[i], listener, referencedNode);
+				}
+			}
 			ImGui::EndTable();
 		}
 	}
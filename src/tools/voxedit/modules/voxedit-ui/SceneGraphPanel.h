@@ -7,6 +7,7 @@
 #include "ui/Panel.h"
 #include "command/CommandHandler.h"
 #include "core/Var.h"
+#include "core/collection/DynamicArray.h"
 #include "scenegraph/SceneGraphNode.h"
 
 namespace video {
@@ -41,11 +42,23 @@ private:
 	int _filterType = 0;
 	bool isFiltered(const scenegraph::SceneGraphNode &node) const;
 
+	// a row of the node list - the tree is flattened to only submit the rows that are visible in the table
+	struct NodeRow {
+		int nodeId;
+		int depth;
+		// the ImGuiID of the parent tree node - the rows get the same ids as nested tree nodes would get
+		uint32_t idScope;
+	};
+	core::DynamicArray<NodeRow> _rows;
+
 	void registerPopups();
 	void detailView(scenegraph::SceneGraphNode &node);
-	void recursiveAddNodes(video::Camera &camera, const scenegraph::SceneGraph &sceneGraph,
-							  scenegraph::SceneGraphNode &node, command::CommandExecutionListener &listener,
-							  int depth, int referencedNodeId);
+	/**
+	 * @brief Collects the rows of the node and its children that are not filtered and not collapsed
+	 */
+	void collectRows(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node, int depth);
+	void addNode(video::Camera &camera, const scenegraph::SceneGraph &sceneGraph, const NodeRow &row,
+				 command::CommandExecutionListener &listener, int referencedNodeId);
 	void contextMenu(video::Camera& camera, const scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, command::CommandExecutionListener &listener);
 public:
 	SceneGraphPanel(ui::IMGUIApp *app, const SceneManagerPtr &sceneMgr) : Super(app, "scenegraph"), _sceneMgr(sceneMgr) {
@@ -27,10 +27,14 @@ struct ScriptPanelExecutorContext : public voxelui::LUAApiExecutorContext {
 		: _sceneMgr(sceneMgr) {
 		listener = &listenerRef;
 		isRunning = _sceneMgr->isScriptRunning();
+		progress = _sceneMgr->luaApi().progress();
 	}
 	virtual void runScript(const core::String &script, const core::DynamicArray<core::String> &args) {
 		_sceneMgr->runScript(script, args);
 	}
+	virtual void cancelScript() {
+		_sceneMgr->cancelScript();
+	}
 };
 } // namespace priv
 
@@ -35,6 +35,7 @@
 #include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
 #include "voxelrender/SceneGraphRenderer.h"
+#include "dearimgui/imgui_internal.h"
 
 #include <glm/ext/scalar_constants.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -48,6 +49,8 @@
 namespace voxedit {
 
 static bool s_hideAxis[3] {false, false, false};
+// the amount of frames that are rendered after the last change
+static constexpr int RedrawFrames = 3;
 
 core::String Viewport::viewportId(int id, bool printable) {
 	if (printable)
@@ -82,9 +85,16 @@ bool Viewport::init() {
 	_autoKeyFrame = core::Var::getSafe(cfg::VoxEditAutoKeyFrame);
 	_localSpace = core::Var::getSafe(cfg::VoxEditLocalSpace);
 	_renderNormals = core::Var::getSafe(cfg::RenderNormals);
+	_occlusionCulling = core::Var::getSafe(cfg::VoxelOcclusionCulling);
+	_dynamicResolutionVar = core::Var::getSafe(cfg::VoxEditDynamicResolution);
+	_frameBudget = core::Var::getSafe(cfg::VoxEditFrameBudget);
+	_skipIdleRedraw = core::Var::getSafe(cfg::VoxEditSkipIdleRedraw);
 	if (!_renderContext.init(video::getWindowSize())) {
 		return false;
 	}
+	if (!_dynamicResolution.init()) {
+		Log::warn("Failed to initialize the gpu timer queries for the dynamic resolution");
+	}
 
 	_camera.setRotationType(video::CameraRotationType::Target);
 	resetCamera();
@@ -98,7 +108,48 @@ void Viewport::resize(const glm::ivec2 &frameBufferSize) {
 	const glm::vec2 scale = windowFrameBufferSize / windowSize;
 	const glm::ivec2 cameraSize((float)frameBufferSize.x * scale.x, (float)frameBufferSize.y * scale.y);
 	_camera.setSize(cameraSize);
-	_renderContext.resize(frameBufferSize);
+	_frameBufferSize = frameBufferSize;
+	_renderContext.resize(_dynamicResolution.resolution(frameBufferSize));
+}
+
+void Viewport::updateResolution() {
+	const glm::mat4 &viewProjection = camera().viewProjectionMatrix();
+	const bool moving = _prevViewProjection != viewProjection;
+	_prevViewProjection = viewProjection;
+	// the frames of a video must keep the size the recording was started with
+	const bool dynamic = _dynamicResolutionVar->boolVal() && !_captureTool.isRecording();
+	_dynamicResolution.update(moving, dynamic ? _frameBudget->floatVal() : 0.0);
+	_renderContext.resize(_dynamicResolution.resolution(_frameBufferSize));
+}
+
+// any input event in this frame or a pressed key or mouse button might change the scene or the ui state
+static bool hasInput() {
+	const ImGuiContext &g = *ImGui::GetCurrentContext();
+	if (!g.InputEventsTrail.empty()) {
+		return true;
+	}
+	for (int key = ImGuiKey_NamedKey_BEGIN; key < ImGuiKey_NamedKey_END; ++key) {
+		if (ImGui::IsKeyDown((ImGuiKey)key)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Viewport::needsRedraw() {
+	bool changed = !_skipIdleRedraw->boolVal() || _captureTool.isRecording() || _sceneMgr->isBusy() || hasInput();
+	changed |= _renderedState.viewProjection != camera().viewProjectionMatrix();
+	changed |= _renderedState.resolution != _renderContext.frameBuffer.dimension();
+	changed |= _renderedState.frame != _sceneMgr->currentFrame();
+	if (changed) {
+		_redrawFrames = RedrawFrames;
+		return true;
+	}
+	if (_redrawFrames > 0) {
+		--_redrawFrames;
+		return true;
+	}
+	return false;
 }
 
 bool Viewport::isFixedCamera() const {
@@ -293,8 +344,11 @@ void Viewport::renderViewport() {
 	const float headerSize = cursorPos.y;
 	if (setupFrameBuffer(contentSize)) {
 		_camera.update(_app->deltaFrameSeconds());
+		updateResolution();
 
-		renderToFrameBuffer();
+		if (needsRedraw()) {
+			renderToFrameBuffer();
+		}
 		renderSlicer(contentSize);
 		ImGui::SetCursorPos(cursorPos);
 		renderViewportImage(contentSize);
@@ -310,6 +364,13 @@ void Viewport::renderViewport() {
 		}
 
 		dragAndDrop(headerSize);
+
+		if (_occlusionCulling->boolVal()) {
+			const voxelrender::OcclusionStats &stats = _renderContext.occlusionStats;
+			const float padding = ImGui::GetStyle().WindowPadding.x;
+			ImGui::SetCursorPos(ImVec2(cursorPos.x + padding, cursorPos.y + padding));
+			ImGui::Text(_("Occluded volumes: %i/%i"), stats.occluded, stats.tested);
+		}
 	}
 }
 
@@ -374,11 +435,13 @@ void Viewport::setRenderMode(voxelrender::RenderMode renderMode) {
 void Viewport::toggleVideoRecording() {
 	if (_captureTool.isRecording()) {
 		Log::debug("Stop recording");
+		// deliver the frames that are still in flight on the gpu
+		_videoReadback.flush();
 		_captureTool.stopRecording();
 		return;
 	}
 	auto callback = [this](const core::String &file, const io::FormatDescription *desc) {
-		const glm::ivec2 &dim = _renderContext.frameBuffer.dimension();
+		const glm::ivec2 &dim = _frameBufferSize;
 		_captureTool.startRecording(file.c_str(), dim.x, dim.y);
 	};
 	const char *filename = _captureTool.type() == image::CaptureType::AVI ? "video.avi" : "video.mpeg2";
@@ -540,20 +603,33 @@ void Viewport::update(command::CommandExecutionListener *listener) {
 	}
 	ImGui::End();
 
+	_videoReadback.update();
 	if (_captureTool.isRecording()) {
-		_captureTool.enqueueFrame(renderToImage("**video**"));
+		renderFullResolution();
+		const video::TexturePtr &texture = _renderContext.frameBuffer.texture(video::FrameBufferAttachment::Color0);
+		_videoReadback.read(texture, "**video**", [this](const image::ImagePtr &image) { _captureTool.enqueueFrame(image); });
 	} else if (_captureTool.hasFinished()) {
 		_captureTool.flush();
 	}
 }
 
 void Viewport::shutdown() {
+	_dynamicResolution.shutdown();
+	_videoReadback.shutdown();
 	_renderContext.shutdown();
 	_captureTool.abort();
 }
 
-image::ImagePtr Viewport::renderToImage(const char *imageName) {
+void Viewport::renderFullResolution() {
+	// the images are always rendered in the full resolution
+	if (_frameBufferSize.x > 0 && _frameBufferSize.y > 0) {
+		_renderContext.resize(_frameBufferSize);
+	}
 	_sceneMgr->render(_renderContext, camera(), SceneManager::RenderScene);
+}
+
+image::ImagePtr Viewport::renderToImage(const char *imageName) {
+	renderFullResolution();
 	return _renderContext.frameBuffer.image(imageName, video::FrameBufferAttachment::Color0);
 }
 
@@ -603,7 +679,7 @@ bool Viewport::setupFrameBuffer(const glm::ivec2 &frameBufferSize) {
 	if (frameBufferSize.x <= 0 || frameBufferSize.y <= 0) {
 		return false;
 	}
-	if (_renderContext.frameBuffer.dimension() == frameBufferSize) {
+	if (_frameBufferSize == frameBufferSize) {
 		return true;
 	}
 	resize(frameBufferSize);
@@ -940,7 +1016,12 @@ bool Viewport::renderGizmo(video::Camera &camera, float headerSize, const ImVec2
 void Viewport::renderToFrameBuffer() {
 	core_trace_scoped(RenderFramebuffer);
 	video::clearColor(core::Color::Clear());
+	_dynamicResolution.begin();
 	_sceneMgr->render(_renderContext, camera());
+	_dynamicResolution.end();
+	_renderedState.viewProjection = camera().viewProjectionMatrix();
+	_renderedState.resolution = _renderContext.frameBuffer.dimension();
+	_renderedState.frame = _sceneMgr->currentFrame();
 }
 
 } // namespace voxedit
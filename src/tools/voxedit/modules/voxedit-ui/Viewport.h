@@ -6,9 +6,11 @@
 
 #include "ui/Panel.h"
 #include "image/CaptureTool.h"
+#include "render/DynamicResolution.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "ui/IMGUIEx.h"
 #include "video/Camera.h"
+#include "video/TextureReadback.h"
 #include "voxelrender/RawVolumeRenderer.h"
 #include "voxelrender/SceneGraphRenderer.h"
 
@@ -49,6 +51,8 @@ private:
 
 	voxelrender::SceneCameraMode _camMode = voxelrender::SceneCameraMode::Free;
 	image::CaptureTool _captureTool;
+	/** the video frames are read back asynchronously to not stall the gpu every frame */
+	video::TextureReadback _videoReadback;
 	SceneManagerPtr _sceneMgr;
 
 	/**
@@ -83,6 +87,25 @@ private:
 
 	voxelrender::RenderContext _renderContext;
 	video::Camera _camera;
+	// the framebuffer is rendered in a lower resolution while the camera is moving - see cfg::VoxEditDynamicResolution
+	render::DynamicResolution _dynamicResolution;
+	// the size of the viewport image - the framebuffer might be smaller
+	glm::ivec2 _frameBufferSize{0};
+	// the view projection matrix of the previous frame to detect the camera movement
+	glm::mat4 _prevViewProjection{0.0f};
+
+	/**
+	 * @brief The state of the last rendered frame - the framebuffer is only rendered again if anything changed
+	 * @sa needsRedraw()
+	 */
+	struct RenderedState {
+		glm::mat4 viewProjection{0.0f};
+		glm::ivec2 resolution{0};
+		scenegraph::FrameIndex frame = -1;
+	};
+	RenderedState _renderedState;
+	// the amount of frames that are still rendered after the last change - e.g. for the occlusion query results
+	int _redrawFrames = 0;
 
 	core::VarPtr _showAxisVar;
 	core::VarPtr _gizmoOperations;
@@ -99,6 +122,10 @@ private:
 	core::VarPtr _autoKeyFrame;
 	core::VarPtr _localSpace;
 	core::VarPtr _renderNormals;
+	core::VarPtr _occlusionCulling;
+	core::VarPtr _dynamicResolutionVar;
+	core::VarPtr _frameBudget;
+	core::VarPtr _skipIdleRedraw;
 
 	bool wantGizmo() const;
 	/**
@@ -114,6 +141,14 @@ private:
 	uint32_t gizmoOperation(const scenegraph::SceneGraphNode &node) const;
 	void renderToFrameBuffer();
 	bool setupFrameBuffer(const glm::ivec2 &frameBufferSize);
+	/**
+	 * @brief Scales the resolution of the framebuffer by the measured gpu time while the camera is moving
+	 */
+	void updateResolution();
+	/**
+	 * @return @c true if the camera, the scene or the ui state changed since the last rendered frame
+	 */
+	bool needsRedraw();
 	void updateGizmoValues(const scenegraph::SceneGraphNode &node, scenegraph::KeyFrameIndex keyFrameIdx,
 						   const glm::mat4 &matrix);
 	/**
@@ -151,6 +186,7 @@ private:
 	void renderMenuBar(command::CommandExecutionListener *listener);
 	void resize(const glm::ivec2 &frameBufferSize);
 	void move(bool pan, bool rotate, int x, int y);
+	void renderFullResolution();
 	image::ImagePtr renderToImage(const char *imageName);
 	void setRenderMode(voxelrender::RenderMode renderMode);
 
@@ -0,0 +1,266 @@
+/**
+ * @file
+ * @brief End-to-end performance scenarios for the perf tool of the imgui test engine
+ *
+ * The scenarios are in the @c ImGuiTestGroup_Perfs group - they are not executed with the normal ui tests. Run them
+ * with @c tests-voxedit @c --perf (or @c make @c perf-voxedit) - every scenario appends the frame time percentiles,
+ * the duration and the peak memory to @c voxedit-perf.csv. This file can be loaded into the perf tool of the test
+ * engine to compare a build against a baseline.
+ */
+
+#include "../MainWindow.h"
+#include "../Viewport.h"
+#include "TestUtil.h"
+#include "core/MemoryTracker.h"
+#include "core/PerfStats.h"
+#include "core/TimeProvider.h"
+#include "ui/dearimgui/imgui_test_engine/imgui_te_internal.h"
+#include "ui/dearimgui/imgui_test_engine/imgui_te_perftool.h"
+#include "ui/dearimgui/imgui_test_engine/imgui_te_utils.h"
+#include "voxedit-util/SceneManager.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Voxel.h"
+#include <glm/trigonometric.hpp>
+
+namespace voxedit {
+
+static const char *PerfCSVFile = "voxedit-perf.csv";
+static const char *PerfSceneFile = "voxedit-perf.vengi";
+// the amount of frames to wait for the scene manager to finish loading, scripts or extractions
+static const int PerfMaxBusyFrames = 10000;
+
+// the perf tool keeps the name pointers of the entries - they must stay valid
+struct PerfScenario {
+	const char *name;
+	const char *duration;
+	const char *p50;
+	const char *p90;
+	const char *p99;
+	const char *memory;
+};
+
+#define PERF_SCENARIO(name)                                                                                           \
+	{ name, name " (duration)", name " (frame p50)", name " (frame p90)", name " (frame p99)", name " (peak MB)" }
+
+static const PerfScenario PerfLoadScene = PERF_SCENARIO("load scene");
+static const PerfScenario PerfOrbitCamera = PERF_SCENARIO("orbit camera");
+static const PerfScenario PerfShapeBrush = PERF_SCENARIO("shape brush path");
+static const PerfScenario PerfPaintBrush = PERF_SCENARIO("paint brush path");
+static const PerfScenario PerfUndoRedo = PERF_SCENARIO("undo redo");
+static const PerfScenario PerfLuaScript = PERF_SCENARIO("lua script");
+
+#undef PERF_SCENARIO
+
+static void perfEntry(ImGuiTestContext *ctx, const char *name, double value) {
+	const ImBuildInfo *buildInfo = ImBuildGetCompilationInfo();
+	ImGuiPerfToolEntry entry;
+	entry.Timestamp = ctx->Engine->BatchStartTime;
+	entry.Category = ctx->Test->Category;
+	entry.TestName = name;
+	// the perf tool shows every value as milliseconds - the memory is given in MB
+	entry.DtDeltaMs = value;
+	entry.PerfStressAmount = ctx->PerfStressAmount;
+	entry.GitBranchName = ctx->EngineIO->GitBranchName;
+	entry.BuildType = buildInfo->Type;
+	entry.Cpu = buildInfo->Cpu;
+	entry.OS = buildInfo->OS;
+	entry.Compiler = buildInfo->Compiler;
+	entry.Date = buildInfo->Date;
+	ImGuiTestEngine_PerfToolAppendToCSV(ImGuiTestEngine_GetPerfTool(ctx->Engine), &entry, PerfCSVFile);
+}
+
+static uint64_t perfNow() {
+	return core::TimeProvider::highResTime();
+}
+
+static double perfMillis(uint64_t start) {
+	return (double)(perfNow() - start) * 1000.0 / (double)core::TimeProvider::highResTimeResolution();
+}
+
+static void perfBegin() {
+	core::perfReset();
+}
+
+static void perfEnd(ImGuiTestContext *ctx, const PerfScenario &scenario, uint64_t start) {
+	const double duration = perfMillis(start);
+	const core::PerfStats &frame = core::perfStats(core::PerfStat::Frame);
+	int64_t peak = 0;
+	for (int i = 0; i < (int)core::MemoryTag::Max; ++i) {
+		peak += core::memoryStats((core::MemoryTag)i).peak;
+	}
+	const double peakMB = (double)peak / (1024.0 * 1024.0);
+	ctx->LogInfo("[PERF] %s: %.1f ms, %i frames, frame p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, peak memory %.1f MB",
+				 scenario.name, duration, (int)frame.count, (double)frame.p50 / 1000.0, (double)frame.p90 / 1000.0,
+				 (double)frame.p99 / 1000.0, peakMB);
+	perfEntry(ctx, scenario.duration, duration);
+	perfEntry(ctx, scenario.p50, (double)frame.p50 / 1000.0);
+	perfEntry(ctx, scenario.p90, (double)frame.p90 / 1000.0);
+	perfEntry(ctx, scenario.p99, (double)frame.p99 / 1000.0);
+	// only available with memory tracking
+	if (peak > 0) {
+		perfEntry(ctx, scenario.memory, peakMB);
+	}
+	ctx->RunFlags |= ImGuiTestRunFlags_NoSuccessMsg;
+}
+
+static bool waitUntilIdle(ImGuiTestContext *ctx, const SceneManagerPtr &sceneMgr) {
+	for (int i = 0; i < PerfMaxBusyFrames && !ctx->Abort; ++i) {
+		if (!sceneMgr->isBusy()) {
+			return true;
+		}
+		ctx->Yield();
+	}
+	IM_CHECK_RETV(!sceneMgr->isBusy(), false);
+	return true;
+}
+
+// a terrain like height map - the surface is big enough to keep the extraction busy
+static bool createPerfScene(ImGuiTestContext *ctx, const SceneManagerPtr &sceneMgr) {
+	const voxel::Region region(0, 0, 0, 255, 127, 255);
+	IM_CHECK_RETV(sceneMgr->newScene(true, ctx->Test->Name, region), false);
+	const int activeNode = sceneMgr->sceneGraph().activeNode();
+	scenegraph::SceneGraphNode *model = sceneMgr->sceneGraphModelNode(activeNode);
+	IM_CHECK_RETV(model != nullptr, false);
+	voxel::RawVolume *volume = model->volume();
+	for (int z = 0; z <= region.getUpperZ(); ++z) {
+		for (int x = 0; x <= region.getUpperX(); ++x) {
+			const float h = 0.5f + 0.25f * glm::sin((float)x * 0.05f) * glm::cos((float)z * 0.07f);
+			const int height = (int)(h * (float)region.getUpperY());
+			const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, (x / 16 + z / 16) % 16);
+			for (int y = 0; y <= height; ++y) {
+				volume->setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+	sceneMgr->modified(activeNode, region);
+	return waitUntilIdle(ctx, sceneMgr);
+}
+
+// move the cursor with the pressed action button along a line over the viewport
+static bool brushPath(ImGuiTestContext *ctx, const SceneManagerPtr &sceneMgr, int viewportId) {
+	const int steps = 32;
+	IM_CHECK_RETV(centerOnViewport(ctx, sceneMgr, viewportId, ImVec2(-128.0f, 0.0f)), false);
+	for (int i = 0; i < steps; ++i) {
+		const ImVec2 offset(-128.0f + 256.0f * (float)i / (float)(steps - 1), 32.0f * glm::sin((float)i * 0.5f));
+		IM_CHECK_RETV(centerOnViewport(ctx, sceneMgr, viewportId, offset), false);
+		executeViewportClick();
+		ctx->Yield();
+	}
+	return waitUntilIdle(ctx, sceneMgr);
+}
+
+static bool runBrushScenario(ImGuiTestContext *ctx, ui::IMGUIApp *app, const SceneManagerPtr &sceneMgr,
+							 const PerfScenario &scenario, BrushType brushType, ModifierType modifierType) {
+	IM_CHECK_RETV(createPerfScene(ctx, sceneMgr), false);
+	IM_CHECK_RETV(activateViewportEditMode(ctx, app), false);
+	const int viewportId = viewportEditMode(ctx, app);
+	IM_CHECK_RETV(viewportId != -1, false);
+	ModifierFacade &modifier = sceneMgr->modifier();
+	modifier.setBrushType(brushType);
+	modifier.setModifierType(modifierType);
+	modifier.setCursorVoxel(voxel::createVoxel(voxel::VoxelType::Generic, 2));
+
+	perfBegin();
+	const uint64_t start = perfNow();
+	IM_CHECK_RETV(brushPath(ctx, sceneMgr, viewportId), false);
+	perfEnd(ctx, scenario, start);
+	return true;
+}
+
+void MainWindow::registerPerfTests(ImGuiTestEngine *engine) {
+	ImGuiTest *test = IM_REGISTER_TEST(engine, testCategory(), "perf load scene");
+	test->Group = ImGuiTestGroup_Perfs;
+	test->TestFunc = [=](ImGuiTestContext *ctx) {
+		IM_CHECK(createPerfScene(ctx, _sceneMgr));
+		io::FileDescription file;
+		file.set(PerfSceneFile);
+		IM_CHECK(_sceneMgr->save(file));
+		IM_CHECK(_sceneMgr->newScene(true, ctx->Test->Name, voxel::Region(0, 1)));
+		IM_CHECK(waitUntilIdle(ctx, _sceneMgr));
+
+		perfBegin();
+		const uint64_t start = perfNow();
+		IM_CHECK(_sceneMgr->load(file));
+		// includes the extraction of the meshes
+		IM_CHECK(waitUntilIdle(ctx, _sceneMgr));
+		perfEnd(ctx, PerfLoadScene, start);
+	};
+
+	test = IM_REGISTER_TEST(engine, testCategory(), "perf orbit camera");
+	test->Group = ImGuiTestGroup_Perfs;
+	test->TestFunc = [=](ImGuiTestContext *ctx) {
+		IM_CHECK(createPerfScene(ctx, _sceneMgr));
+		IM_CHECK(activateViewportSceneMode(ctx, _app));
+		const int viewportId = viewportSceneMode(ctx, _app);
+		IM_CHECK_SILENT(viewportId != -1);
+		Viewport *viewport = (Viewport *)_app->getPanel(Viewport::viewportId(viewportId, true));
+		IM_CHECK_SILENT(viewport != nullptr);
+
+		perfBegin();
+		const uint64_t start = perfNow();
+		// two full turns around the scene
+		const int frames = 360;
+		for (int i = 0; i < frames && !ctx->Abort; ++i) {
+			viewport->camera().rotate(glm::vec3(0.0f, glm::radians(2.0f), 0.0f));
+			ctx->Yield();
+		}
+		perfEnd(ctx, PerfOrbitCamera, start);
+	};
+
+	test = IM_REGISTER_TEST(engine, testCategory(), "perf shape brush path");
+	test->Group = ImGuiTestGroup_Perfs;
+	test->TestFunc = [=](ImGuiTestContext *ctx) {
+		IM_CHECK(runBrushScenario(ctx, _app, _sceneMgr, PerfShapeBrush, BrushType::Shape, ModifierType::Place));
+	};
+
+	test = IM_REGISTER_TEST(engine, testCategory(), "perf paint brush path");
+	test->Group = ImGuiTestGroup_Perfs;
+	test->TestFunc = [=](ImGuiTestContext *ctx) {
+		IM_CHECK(runBrushScenario(ctx, _app, _sceneMgr, PerfPaintBrush, BrushType::Paint, ModifierType::Override));
+	};
+
+	test = IM_REGISTER_TEST(engine, testCategory(), "perf undo redo");
+	test->Group = ImGuiTestGroup_Perfs;
+	test->TestFunc = [=](ImGuiTestContext *ctx) {
+		IM_CHECK(createPerfScene(ctx, _sceneMgr));
+		IM_CHECK(activateViewportEditMode(ctx, _app));
+		const int viewportId = viewportEditMode(ctx, _app);
+		IM_CHECK_SILENT(viewportId != -1);
+		_sceneMgr->modifier().setBrushType(BrushType::Shape);
+		_sceneMgr->modifier().setModifierType(ModifierType::Place);
+		// every click of the path is an undo state
+		IM_CHECK(brushPath(ctx, _sceneMgr, viewportId));
+
+		perfBegin();
+		const uint64_t start = perfNow();
+		const int n = 50;
+		for (int i = 0; i < n && !ctx->Abort; ++i) {
+			IM_CHECK(_sceneMgr->undo());
+			ctx->Yield();
+		}
+		for (int i = 0; i < n && !ctx->Abort; ++i) {
+			IM_CHECK(_sceneMgr->redo());
+			ctx->Yield();
+		}
+		IM_CHECK(waitUntilIdle(ctx, _sceneMgr));
+		perfEnd(ctx, PerfUndoRedo, start);
+	};
+
+	test = IM_REGISTER_TEST(engine, testCategory(), "perf lua script");
+	test->Group = ImGuiTestGroup_Perfs;
+	test->TestFunc = [=](ImGuiTestContext *ctx) {
+		IM_CHECK(_sceneMgr->newScene(true, ctx->Test->Name, voxel::Region(0, 0, 0, 255, 127, 255)));
+		IM_CHECK(waitUntilIdle(ctx, _sceneMgr));
+		const core::String &script = _sceneMgr->luaApi().load("noise-builtin");
+		IM_CHECK(!script.empty());
+
+		perfBegin();
+		const uint64_t start = perfNow();
+		IM_CHECK(_sceneMgr->runScript(script, {}));
+		// the script is executed in the frames - wait for the script and the extraction of the result
+		IM_CHECK(waitUntilIdle(ctx, _sceneMgr));
+		perfEnd(ctx, PerfLuaScript, start);
+	};
+}
+
+} // namespace voxedit
@@ -3,7 +3,16 @@
  */
 
 #include "Clipboard.h"
+#include "core/ArrayLength.h"
+#include "core/FourCC.h"
 #include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/StringUtil.h"
+#include "io/Base64.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/LZ4ReadStream.h"
+#include "io/LZ4WriteStream.h"
+#include "io/MemoryReadStream.h"
 #include "voxedit-util/modifier/Selection.h"
 #include "voxel/RawVolumeWrapper.h"
 #include "voxelutil/VolumeMerger.h"
@@ -22,7 +31,7 @@ voxel::VoxelData copy(const voxel::VoxelData &voxelData, const Selections &selec
 		return {};
 	}
 
-	voxel::RawVolume *v = new voxel::RawVolume(voxelData.volume, selections);
+	voxel::RawVolume *v = new voxel::RawVolume(*voxelData.volume, selections.data(), selections.size());
 	return voxel::VoxelData(v, voxelData.palette, true);
 }
 
@@ -37,7 +46,7 @@ voxel::VoxelData cut(voxel::VoxelData &voxelData, const Selections &selections,
 		return {};
 	}
 
-	voxel::RawVolume *v = new voxel::RawVolume(voxelData.volume, selections);
+	voxel::RawVolume *v = new voxel::RawVolume(*voxelData.volume, selections.data(), selections.size());
 	for (const Selection &selection : selections) {
 		const glm::ivec3 &mins = selection.getLowerCorner();
 		const glm::ivec3 &maxs = selection.getUpperCorner();
@@ -81,5 +90,133 @@ void paste(voxel::VoxelData &out, const voxel::VoxelData &in, const glm::ivec3 &
 	Log::debug("Pasted %s", modifiedRegion.toString().c_str());
 }
 
+static constexpr uint32_t ClipboardMagic = FourCC('V', 'C', 'L', 'P');
+static constexpr uint8_t ClipboardVersion = 1;
+static constexpr char ClipboardTextPrefix[] = "vengi-voxels:";
+static constexpr size_t ClipboardTextPrefixLength = lengthof(ClipboardTextPrefix) - 1;
+
+#define wrapBool(write)                                                                                                \
+	if (!(write)) {                                                                                                    \
+		Log::debug("Failed to write the clipboard payload: " CORE_STRINGIFY(write));                                  \
+		return false;                                                                                                  \
+	}
+
+#define wrap(read)                                                                                                     \
+	if ((read) != 0) {                                                                                                 \
+		Log::debug("Failed to read the clipboard payload: " CORE_STRINGIFY(read));                                    \
+		return {};                                                                                                     \
+	}
+
+bool serialize(const voxel::VoxelData &voxelData, io::WriteStream &stream) {
+	if (!voxelData) {
+		return false;
+	}
+	const voxel::Region &region = voxelData.volume->region();
+	const palette::Palette &palette = *voxelData.palette;
+	wrapBool(stream.writeUInt32(ClipboardMagic))
+	wrapBool(stream.writeUInt8(ClipboardVersion))
+	wrapBool(stream.writeUInt8((uint8_t)sizeof(voxel::Voxel)))
+	wrapBool(stream.writeInt32(region.getLowerX()))
+	wrapBool(stream.writeInt32(region.getLowerY()))
+	wrapBool(stream.writeInt32(region.getLowerZ()))
+	wrapBool(stream.writeInt32(region.getUpperX()))
+	wrapBool(stream.writeInt32(region.getUpperY()))
+	wrapBool(stream.writeInt32(region.getUpperZ()))
+	wrapBool(stream.writeUInt16((uint16_t)palette.colorCount()))
+	for (int i = 0; i < palette.colorCount(); ++i) {
+		wrapBool(stream.writeUInt32(palette.color(i).rgba))
+	}
+	// runs of equal voxels are compressed well - the payload of sparse selections is small
+	io::LZ4WriteStream lz4Stream(stream);
+	const size_t size = (size_t)region.voxels() * sizeof(voxel::Voxel);
+	if (lz4Stream.write(voxelData.volume->data(), size) == -1) {
+		Log::debug("Failed to write the clipboard payload: voxel data");
+		return false;
+	}
+	return lz4Stream.flush();
+}
+
+voxel::VoxelData deserialize(io::SeekableReadStream &stream) {
+	uint32_t magic;
+	wrap(stream.readUInt32(magic))
+	if (magic != ClipboardMagic) {
+		Log::debug("No clipboard payload");
+		return {};
+	}
+	uint8_t version;
+	wrap(stream.readUInt8(version))
+	uint8_t voxelSize;
+	wrap(stream.readUInt8(voxelSize))
+	if (version != ClipboardVersion || voxelSize != (uint8_t)sizeof(voxel::Voxel)) {
+		Log::warn("Unsupported clipboard payload version %i (voxel size %i)", (int)version, (int)voxelSize);
+		return {};
+	}
+	glm::ivec3 mins;
+	glm::ivec3 maxs;
+	wrap(stream.readInt32(mins.x))
+	wrap(stream.readInt32(mins.y))
+	wrap(stream.readInt32(mins.z))
+	wrap(stream.readInt32(maxs.x))
+	wrap(stream.readInt32(maxs.y))
+	wrap(stream.readInt32(maxs.z))
+	const voxel::Region region(mins, maxs);
+	if (!region.isValid()) {
+		Log::warn("Invalid region in the clipboard payload");
+		return {};
+	}
+	uint16_t colorCount;
+	wrap(stream.readUInt16(colorCount))
+	if (colorCount > palette::PaletteMaxColors) {
+		Log::warn("Invalid color count in the clipboard payload: %i", (int)colorCount);
+		return {};
+	}
+	palette::Palette palette;
+	palette.setSize(colorCount);
+	for (int i = 0; i < (int)colorCount; ++i) {
+		uint32_t rgba;
+		wrap(stream.readUInt32(rgba))
+		palette.setColor(i, core::RGBA(rgba));
+	}
+	io::LZ4ReadStream lz4Stream(stream, (int)stream.remaining());
+	const size_t size = (size_t)region.voxels() * sizeof(voxel::Voxel);
+	uint8_t *voxels = (uint8_t *)core_malloc(size);
+	if (lz4Stream.read(voxels, size) != (int)size) {
+		Log::warn("Failed to read the voxels of the clipboard payload");
+		core_free(voxels);
+		return {};
+	}
+	// the volume takes the ownership of the buffer
+	voxel::RawVolume *v = voxel::RawVolume::createRaw((voxel::Voxel *)voxels, region);
+	return {v, palette, true};
+}
+
+#undef wrap
+#undef wrapBool
+
+core::String toClipboardText(const voxel::VoxelData &voxelData) {
+	io::BufferedReadWriteStream stream;
+	if (!serialize(voxelData, stream)) {
+		return "";
+	}
+	stream.seek(0);
+	return ClipboardTextPrefix + io::Base64::encode(stream);
+}
+
+bool isClipboardText(const core::String &text) {
+	return text.size() > ClipboardTextPrefixLength && core::string::startsWith(text, ClipboardTextPrefix);
+}
+
+voxel::VoxelData fromClipboardText(const core::String &text) {
+	if (!isClipboardText(text)) {
+		return {};
+	}
+	io::BufferedReadWriteStream stream;
+	if (!io::Base64::decode(stream, text.substr(ClipboardTextPrefixLength))) {
+		return {};
+	}
+	stream.seek(0);
+	return deserialize(stream);
+}
+
 } // namespace tool
 } // namespace voxedit
@@ -4,12 +4,34 @@
 
 #pragma once
 
+#include "core/String.h"
+#include "io/Stream.h"
 #include "modifier/Selection.h"
 #include "voxel/VoxelData.h"
 
 namespace voxedit {
 namespace tool {
 
+/**
+ * @brief Writes the voxel data as a compact binary payload - the palette colors, the region and the lz4 compressed
+ * voxels
+ * @sa deserialize()
+ */
+bool serialize(const voxel::VoxelData &voxelData, io::WriteStream &stream);
+/**
+ * @return Invalid voxel data if the stream doesn't contain a payload that was written by @c serialize()
+ */
+voxel::VoxelData deserialize(io::SeekableReadStream &stream);
+/**
+ * @brief The serialized payload as text for the system clipboard - this allows to paste into other instances
+ */
+core::String toClipboardText(const voxel::VoxelData &voxelData);
+/**
+ * @return @c true if the given text was created by @c toClipboardText()
+ */
+bool isClipboardText(const core::String &text);
+voxel::VoxelData fromClipboardText(const core::String &text);
+
 voxel::VoxelData copy(const voxel::VoxelData &voxelData, const Selections &selections);
 voxel::VoxelData cut(voxel::VoxelData &voxelData, const Selections &selections, voxel::Region &modifiedRegion);
 void paste(voxel::VoxelData &out, const voxel::VoxelData &in, const glm::ivec3 &referencePosition,
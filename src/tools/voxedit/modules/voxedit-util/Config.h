@@ -15,6 +15,11 @@ constexpr const char *VoxEditHideInactive = "ve_hideinactive";
 constexpr const char *VoxEditLastFile = "ve_lastfile";
 constexpr const char *VoxEditLastFiles = "ve_lastfiles";
 constexpr const char *VoxEditAutoSaveSeconds = "ve_autosaveseconds";
+constexpr const char *VoxEditCompressInactiveSeconds = "ve_compressinactiveseconds";
+constexpr const char *VoxEditSystemClipboard = "ve_systemclipboard";
+constexpr const char *VoxEditUndoMemory = "ve_undomemory";
+constexpr const char *VoxEditUndoSteps = "ve_undosteps";
+constexpr const char *VoxEditSyncStream = "ve_syncstream";
 constexpr const char *VoxEditMovementSpeed = "ve_movementspeed";
 constexpr const char *VoxEditTransformUpdateChildren = "ve_transformupdatechildren";
 constexpr const char *VoxEditAmbientColor = "ve_ambientcolor";
@@ -48,6 +53,9 @@ constexpr const char *VoxEditGizmoAllowAxisFlip = "ve_gizmoallowaxisflip";
 constexpr const char *VoxEditGizmoSnap = "ve_gizmosnap";
 constexpr const char *VoxEditModelGizmo = "ve_modelgizmo";
 constexpr const char *VoxEditViewdistance = "ve_viewdistance";
+constexpr const char *VoxEditDynamicResolution = "ve_dynamicresolution";
+constexpr const char *VoxEditFrameBudget = "ve_framebudget";
+constexpr const char *VoxEditSkipIdleRedraw = "ve_skipidleredraw";
 constexpr const char *VoxEditShowlockedaxis = "ve_showlockedaxis";
 constexpr const char *VoxEditRendershadow = "ve_rendershadow";
 constexpr const char *VoxEditAnimationSpeed = "ve_animspeed";
@@ -57,6 +57,13 @@ public:
 	virtual bool isSliceModeActive() const {
 		return sliceRegion().isValid();
 	}
+	/**
+	 * @return @c true if the rendered scene still changes without any further modification - e.g. while meshes
+	 * are extracted
+	 */
+	virtual bool isBusy() const {
+		return false;
+	}
 };
 
 using SceneRendererPtr = core::SharedPtr<ISceneRenderer>;
@@ -0,0 +1,31 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "memento/MementoHandler.h"
+#include "scenegraph/SceneGraphListener.h"
+
+namespace voxedit {
+
+/**
+ * @brief Records the voxels of the nodes whose volumes were not yet loaded when the initial undo state was created.
+ * @note The volumes are loaded on first access - this might happen on any thread (e.g. the mesh extraction).
+ */
+class LazyVolumeListener : public scenegraph::SceneGraphListener {
+private:
+	memento::MementoHandler &_mementoHandler;
+	const scenegraph::SceneGraph &_sceneGraph;
+
+public:
+	LazyVolumeListener(memento::MementoHandler &mementoHandler, const scenegraph::SceneGraph &sceneGraph)
+		: _mementoHandler(mementoHandler), _sceneGraph(sceneGraph) {
+	}
+
+	void onNodeVolumeLoaded(int nodeId) override {
+		_mementoHandler.markNodeVolumeLoaded(_sceneGraph.node(nodeId));
+	}
+};
+
+} // namespace voxedit
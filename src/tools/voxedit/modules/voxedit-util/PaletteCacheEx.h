@@ -18,8 +18,8 @@ public:
 	virtual ~PaletteCacheEx() {
 	}
 
-	void detectPalettes(bool includeBuiltIn = true) override {
-		Super::detectPalettes(includeBuiltIn);
+protected:
+	void onDetectPalettes() override {
 		const scenegraph::SceneGraph &sceneGraph = _sceneMgr->sceneGraph();
 		for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
 			const scenegraph::SceneGraphNode &node = *iter;
@@ -11,11 +11,13 @@
 #include "core/Color.h"
 #include "core/Common.h"
 #include "core/GLM.h"
+#include "core/Hash.h"
 #include "app/I18N.h"
 #include "core/Log.h"
 #include "core/String.h"
 #include "core/StringUtil.h"
 #include "core/TimeProvider.h"
+#include "core/collection/Array.h"
 #include "core/collection/DynamicArray.h"
 #include "io/Archive.h"
 #include "io/File.h"
@@ -74,6 +76,9 @@
 #endif
 #include <glm/gtx/transform.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
+#include <SDL_clipboard.h>
+#include <SDL_error.h>
+#include <inttypes.h>
 
 namespace voxedit {
 
@@ -94,7 +99,8 @@ inline auto nodeCompleter(const scenegraph::SceneGraph &sceneGraph) {
 SceneManager::SceneManager(const core::TimeProviderPtr &timeProvider, const io::FilesystemPtr &filesystem,
 						   const SceneRendererPtr &sceneRenderer, const ModifierRendererPtr &modifierRenderer)
 	: _timeProvider(timeProvider), _sceneRenderer(sceneRenderer), _modifierFacade(this, modifierRenderer),
-	  _luaApi(filesystem), _luaApiListener(_mementoHandler, _sceneGraph), _filesystem(filesystem) {
+	  _luaApi(filesystem), _luaApiListener(_mementoHandler, _sceneGraph),
+	  _lazyVolumeListener(_mementoHandler, _sceneGraph), _filesystem(filesystem) {
 }
 
 SceneManager::~SceneManager() {
@@ -187,7 +193,80 @@ bool SceneManager::calculateNormals(int nodeId, voxel::Connectivity connectivity
 	return false;
 }
 
+void SceneManager::compressInactiveNodes(double nowSeconds) {
+	const int inactiveSeconds = _compressInactiveSeconds->intVal();
+	if (inactiveSeconds <= 0) {
+		return;
+	}
+	// there is no need to check this every frame
+	if (_lastCompressInactive + 1.0 > nowSeconds) {
+		return;
+	}
+	_lastCompressInactive = nowSeconds;
+	const uint64_t nowMillis = (uint64_t)(nowSeconds * 1000.0);
+	const int n = _sceneGraph.compressInactiveNodes(nowMillis, (uint64_t)inactiveSeconds * 1000u);
+	if (n > 0) {
+		Log::debug("Compressed the volumes of %i inactive nodes", n);
+	}
+}
+
+void SceneManager::updateMementoBudget() {
+	if (_undoSpillFile.empty()) {
+		_undoSpillFile = _filesystem->homeWritePath(
+			core::String::format("undo-%" PRIu64 ".tmp", core::TimeProvider::systemMillis()));
+	}
+	const size_t budget = (size_t)core_max(0, _undoMemory->intVal()) * 1024u * 1024u;
+	_mementoHandler.setMemoryBudget(budget, _undoSpillFile);
+	_mementoHandler.setMaxStates(_undoSteps->intVal());
+	_undoMemory->markClean();
+	_undoSteps->markClean();
+}
+
+void SceneManager::updateSyncStream() {
+	const core::String &path = _syncStream->strVal();
+	_syncStream->markClean();
+	if (path.empty()) {
+		if (_mementoHandler.isRegistered(&_mementoStream)) {
+			_mementoHandler.unregisterListener(&_mementoStream);
+		}
+		_mementoStream.clear();
+		return;
+	}
+	if (!_mementoHandler.isRegistered(&_mementoStream)) {
+		_mementoHandler.registerListener(&_mementoStream);
+	}
+	// the receiver doesn't know the node uuids yet - start with the whole scene
+	_mementoStream.addScene(_sceneGraph);
+	Log::info("Write the scene changes into %s", path.c_str());
+}
+
+void SceneManager::flushSyncStream() {
+	if (_mementoStream.empty()) {
+		return;
+	}
+	const io::FilePtr &file = _filesystem->open(_syncStream->strVal(), io::FileMode::Append);
+	io::FileStream stream(file);
+	if (!stream.valid()) {
+		Log::warn("Failed to open the scene sync stream %s", _syncStream->strVal().c_str());
+		_mementoStream.clear();
+		return;
+	}
+	if (!_mementoStream.flush(stream)) {
+		Log::warn("Failed to write the scene changes into %s", _syncStream->strVal().c_str());
+	}
+}
+
 void SceneManager::autosave() {
+	if (_autosaveFuture.valid()) {
+		if (_autosaveFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			// the previous autosave is still written
+			return;
+		}
+		if (!_autosaveFuture.get()) {
+			Log::warn("Failed to autosave");
+			_needAutoSave = true;
+		}
+	}
 	if (!_needAutoSave) {
 		return;
 	}
@@ -195,6 +274,9 @@ void SceneManager::autosave() {
 	if (delay <= 0 || _lastAutoSave + (double)delay > _timeProvider->tickSeconds()) {
 		return;
 	}
+	if (_sceneGraph.empty()) {
+		return;
+	}
 	// autosaves go into the write path directory (which is usually the home directory of the user)
 	io::FileDescription autoSaveFilename;
 	if (_lastFilename.empty()) {
@@ -208,12 +290,25 @@ void SceneManager::autosave() {
 			core::string::format("%s%s.%s", prefix.c_str(), filename.c_str(), ext.c_str());
 		autoSaveFilename.set(_filesystem->homeWritePath(autosaveFilename), &_lastFilename.desc);
 	}
-	if (save(autoSaveFilename, true)) {
-		Log::info("Autosave file %s", autoSaveFilename.c_str());
-	} else {
+	_lastAutoSave = _timeProvider->tickSeconds();
+	scenegraph::SceneGraph snapshot;
+	if (!scenegraph::snapshotSceneGraph(snapshot, _sceneGraph)) {
 		Log::warn("Failed to autosave");
+		return;
 	}
-	_lastAutoSave = _timeProvider->tickSeconds();
+	_needAutoSave = false;
+	const io::ArchivePtr &archive = io::openFilesystemArchive(_filesystem);
+	_autosaveFuture = app::async([archive, autoSaveFilename, snapshot = core::move(snapshot)]() mutable {
+		voxelformat::SaveContext saveCtx;
+		// autosaves are written while the user is editing - favour speed over size. The thumbnails are rendered
+		// and thus can't be created outside of the main thread.
+		saveCtx.config.vengiCompressionLevel = 1;
+		if (!voxelformat::saveFormat(snapshot, autoSaveFilename.name, &autoSaveFilename.desc, archive, saveCtx)) {
+			return false;
+		}
+		Log::info("Autosave file %s", autoSaveFilename.c_str());
+		return true;
+	});
 }
 
 bool SceneManager::saveNode(int nodeId, const core::String& file) {
@@ -245,6 +340,7 @@ bool SceneManager::saveNode(int nodeId, const core::String& file) {
 }
 
 void SceneManager::fillHollow() {
+	ScopedModificationBatch modificationBatch(*this);
 	nodeForeachGroup([&] (int groupNodeId) {
 		scenegraph::SceneGraphNode *node = sceneGraphModelNode(groupNodeId);
 		if (node == nullptr) {
@@ -261,6 +357,7 @@ void SceneManager::fillHollow() {
 }
 
 void SceneManager::fill() {
+	ScopedModificationBatch modificationBatch(*this);
 	nodeForeachGroup([&](int groupNodeId) {
 		scenegraph::SceneGraphNode *node = sceneGraphModelNode(groupNodeId);
 		if (node == nullptr) {
@@ -277,6 +374,7 @@ void SceneManager::fill() {
 }
 
 void SceneManager::clear() {
+	ScopedModificationBatch modificationBatch(*this);
 	nodeForeachGroup([&](int groupNodeId) {
 		scenegraph::SceneGraphNode *node = sceneGraphModelNode(groupNodeId);
 		if (node == nullptr) {
@@ -293,6 +391,7 @@ void SceneManager::clear() {
 }
 
 void SceneManager::hollow() {
+	ScopedModificationBatch modificationBatch(*this);
 	nodeForeachGroup([&](int groupNodeId) {
 		scenegraph::SceneGraphNode *node = sceneGraphModelNode(groupNodeId);
 		if (node == nullptr) {
@@ -362,6 +461,10 @@ bool SceneManager::save(const io::FileDescription& file, bool autosave) {
 	}
 	voxelformat::SaveContext saveCtx;
 	saveCtx.thumbnailCreator = voxelrender::volumeThumbnail;
+	if (autosave) {
+		// autosaves are written while the user is editing - favour speed over size
+		saveCtx.config.vengiCompressionLevel = 1;
+	}
 	const io::ArchivePtr &archive = io::openFilesystemArchive(_filesystem);
 	if (voxelformat::saveFormat(_sceneGraph, file.name, &file.desc, archive, saveCtx)) {
 		if (!autosave) {
@@ -378,18 +481,6 @@ bool SceneManager::save(const io::FileDescription& file, bool autosave) {
 	return false;
 }
 
-static void mergeIfNeeded(scenegraph::SceneGraph &newSceneGraph) {
-	if (newSceneGraph.size() > voxel::MAX_VOLUMES) {
-		const scenegraph::SceneGraph::MergeResult &merged = newSceneGraph.merge();
-		newSceneGraph.clear();
-		scenegraph::SceneGraphNode newNode;
-		newNode.setVolume(merged.volume(), true);
-		newNode.setPalette(merged.palette);
-		newNode.setNormalPalette(merged.normalPalette);
-		newSceneGraph.emplace(core::move(newNode));
-	}
-}
-
 bool SceneManager::import(const core::String& file) {
 	if (file.empty()) {
 		Log::error("Can't import model: No file given");
@@ -404,7 +495,6 @@ bool SceneManager::import(const core::String& file) {
 		Log::error("Failed to load %s", file.c_str());
 		return false;
 	}
-	mergeIfNeeded(newSceneGraph);
 
 	scenegraph::SceneGraphNode groupNode(scenegraph::SceneGraphNodeType::Group);
 	groupNode.setName(core::string::extractFilename(file));
@@ -444,7 +534,6 @@ bool SceneManager::importDirectory(const core::String& directory, const io::Form
 		if (!voxelformat::loadFormat(fileDesc, archive, newSceneGraph, loadCtx)) {
 			Log::error("Failed to load %s", e.fullPath.c_str());
 		} else {
-			mergeIfNeeded(newSceneGraph);
 			state |= scenegraph::addSceneGraphNodes(_sceneGraph, newSceneGraph, importGroupNodeId, [this] (int nodeId) {
 				onNewNodeAdded(nodeId, false);
 			}) > 0;
@@ -465,8 +554,9 @@ bool SceneManager::load(const io::FileDescription& file) {
 	_loadingFuture = app::async([archive, file] () {
 		scenegraph::SceneGraph newSceneGraph;
 		voxelformat::LoadContext loadCtx;
+		// the models are decoded on first access - only the visible ones are needed to show the scene
+		loadCtx.config.vengiLazyLoad = true;
 		voxelformat::loadFormat(file, archive, newSceneGraph, loadCtx);
-		mergeIfNeeded(newSceneGraph);
 		/**
 		 * TODO: stuff that happens in MeshState::scheduleRegionExtraction() and
 		 * MeshState::runScheduledExtractions() should happen here
@@ -484,7 +574,6 @@ bool SceneManager::load(const io::FileDescription& file, const uint8_t *data, si
 	archive->add(file.name, data, size);
 	voxelformat::LoadContext loadCtx;
 	voxelformat::loadFormat(file, archive, newSceneGraph, loadCtx);
-	mergeIfNeeded(newSceneGraph);
 	if (loadSceneGraph(core::move(newSceneGraph))) {
 		_needAutoSave = false;
 		_dirty = false;
@@ -510,9 +599,80 @@ bool SceneManager::supportsEditMode() const {
 	return node.isModelNode();
 }
 
+void SceneManager::beginModificationBatch() {
+	++_modificationBatch;
+}
+
+void SceneManager::endModificationBatch() {
+	core_assert(_modificationBatch > 0);
+	if (--_modificationBatch == 0) {
+		flushModifications();
+	}
+}
+
+void SceneManager::flushModifications() {
+	if (_pendingModifications.empty()) {
+		return;
+	}
+	core_trace_scoped(FlushModifications);
+	core::DynamicArray<PendingModification> pending = core::move(_pendingModifications);
+	_pendingModifications.clear();
+	bool markUndo = false;
+	for (const PendingModification &m : pending) {
+		markUndo |= m.markUndo;
+	}
+	// the group is only opened if there are undo states - opening a group discards the redo states
+	if (markUndo) {
+		_mementoHandler.beginGroup("modifications");
+	}
+	for (const PendingModification &m : pending) {
+		if (!_sceneGraph.hasNode(m.nodeId)) {
+			continue;
+		}
+		if (m.markUndo) {
+			scenegraph::SceneGraphNode &node = _sceneGraph.node(m.nodeId);
+			_mementoHandler.markModification(_sceneGraph, node, m.wholeVolume ? voxel::Region::InvalidRegion : m.region);
+		}
+		if (m.region.isValid()) {
+			_sceneRenderer->updateNodeRegion(m.nodeId, m.region, m.renderRegionMillis);
+		}
+	}
+	if (markUndo) {
+		_mementoHandler.endGroup();
+	}
+	markDirty();
+	resetLastTrace();
+}
+
 void SceneManager::modified(int nodeId, const voxel::Region& modifiedRegion, bool markUndo, uint64_t renderRegionMillis) {
 	Log::debug("Modified node %i, record undo state: %s", nodeId, markUndo ? "true" : "false");
 	voxel::logRegion("Modified", modifiedRegion);
+	if (_modificationBatch > 0) {
+		PendingModification *pending = nullptr;
+		for (PendingModification &m : _pendingModifications) {
+			if (m.nodeId == nodeId) {
+				pending = &m;
+				break;
+			}
+		}
+		if (pending == nullptr) {
+			_pendingModifications.emplace_back();
+			pending = &_pendingModifications.back();
+			pending->nodeId = nodeId;
+		}
+		if (modifiedRegion.isValid()) {
+			if (pending->region.isValid()) {
+				pending->region.accumulate(modifiedRegion);
+			} else {
+				pending->region = modifiedRegion;
+			}
+		} else if (markUndo) {
+			pending->wholeVolume = true;
+		}
+		pending->markUndo |= markUndo;
+		pending->renderRegionMillis = core_max(pending->renderRegionMillis, renderRegionMillis);
+		return;
+	}
 	if (markUndo) {
 		scenegraph::SceneGraphNode &node = _sceneGraph.node(nodeId);
 		_mementoHandler.markModification(_sceneGraph, node, modifiedRegion);
@@ -578,7 +738,7 @@ void SceneManager::scaleDown(int nodeId) {
 	}
 	const voxel::Region destRegion(srcRegion.getLowerCorner(), srcRegion.getLowerCorner() + targetDimensionsHalf);
 	voxel::RawVolume* destVolume = new voxel::RawVolume(destRegion);
-	voxelutil::scaleDown(*v, _sceneGraph.node(nodeId).palette(), *destVolume);
+	voxelutil::scaleDown(*v, _sceneGraph.node(nodeId).palette(), *destVolume, &app::App::getInstance()->threadPool());
 	if (!setNewVolume(nodeId, destVolume, true)) {
 		delete destVolume;
 		return;
@@ -722,12 +882,11 @@ bool SceneManager::setActivePalette(const palette::Palette &palette, bool search
 	}
 	memento::ScopedMementoGroup mementoGroup(_mementoHandler, "palette");
 	if (searchBestColors) {
+		// an invalid region means that all voxels already have the best matching color index
 		const voxel::Region dirtyRegion = node.remapToPalette(palette);
-		if (!dirtyRegion.isValid()) {
-			Log::warn("Remapping palette indices failed");
-			return false;
+		if (dirtyRegion.isValid()) {
+			modified(nodeId, dirtyRegion);
 		}
-		modified(nodeId, dirtyRegion);
 	}
 	node.setPalette(palette);
 	_mementoHandler.markPaletteChange(_sceneGraph, node);
@@ -744,16 +903,16 @@ voxel::RawVolume* SceneManager::activeVolume() {
 }
 
 bool SceneManager::mementoRename(const memento::MementoState& s) {
-	Log::debug("Memento: rename of node %s (%s)", s.nodeUUID.c_str(), s.name.c_str());
+	Log::debug("Memento: rename of node %s (%s)", s.nodeUUID.str().c_str(), s.name.c_str());
 	if (scenegraph::SceneGraphNode *node = sceneGraphNodeByUUID(s.nodeUUID)) {
 		return nodeRename(*node, s.name);
 	}
-	Log::warn("Failed to handle memento state - node id %s not found (%s)", s.nodeUUID.c_str(), s.name.c_str());
+	Log::warn("Failed to handle memento state - node id %s not found (%s)", s.nodeUUID.str().c_str(), s.name.c_str());
 	return false;
 }
 
 bool SceneManager::mementoProperties(const memento::MementoState& s) {
-	Log::debug("Memento: properties of node %s (%s)", s.nodeUUID.c_str(), s.name.c_str());
+	Log::debug("Memento: properties of node %s (%s)", s.nodeUUID.str().c_str(), s.name.c_str());
 	if (scenegraph::SceneGraphNode *node = sceneGraphNodeByUUID(s.nodeUUID)) {
 		node->properties().clear();
 		node->addProperties(s.properties);
@@ -773,7 +932,7 @@ bool SceneManager::mementoAnimations(const memento::MementoState &s) {
 }
 
 bool SceneManager::mementoKeyFrames(const memento::MementoState& s) {
-	Log::debug("Memento: keyframes of node %s (%s)", s.nodeUUID.c_str(), s.name.c_str());
+	Log::debug("Memento: keyframes of node %s (%s)", s.nodeUUID.str().c_str(), s.name.c_str());
 	if (scenegraph::SceneGraphNode *node = sceneGraphNodeByUUID(s.nodeUUID)) {
 		_sceneGraph.setAllKeyFramesForNode(*node, s.keyFrames);
 		node->setPivot(s.pivot);
@@ -784,7 +943,7 @@ bool SceneManager::mementoKeyFrames(const memento::MementoState& s) {
 }
 
 bool SceneManager::mementoPaletteChange(const memento::MementoState &s) {
-	Log::debug("Memento: palette change of node %s to %s", s.nodeUUID.c_str(), s.name.c_str());
+	Log::debug("Memento: palette change of node %s to %s", s.nodeUUID.str().c_str(), s.name.c_str());
 	if (scenegraph::SceneGraphNode* node = sceneGraphNodeByUUID(s.nodeUUID)) {
 		node->setPalette(s.palette);
 		return true;
@@ -793,7 +952,7 @@ bool SceneManager::mementoPaletteChange(const memento::MementoState &s) {
 }
 
 bool SceneManager::mementoNormalPaletteChange(const memento::MementoState &s) {
-	Log::debug("Memento: normal palette change of node %s to %s", s.nodeUUID.c_str(), s.name.c_str());
+	Log::debug("Memento: normal palette change of node %s to %s", s.nodeUUID.str().c_str(), s.name.c_str());
 	if (scenegraph::SceneGraphNode* node = sceneGraphNodeByUUID(s.nodeUUID)) {
 		node->setNormalPalette(s.normalPalette);
 		return true;
@@ -802,20 +961,20 @@ bool SceneManager::mementoNormalPaletteChange(const memento::MementoState &s) {
 }
 
 bool SceneManager::mementoModification(const memento::MementoState& s) {
-	Log::debug("Memento: modification in volume of node %s (%s)", s.nodeUUID.c_str(), s.name.c_str());
+	Log::debug("Memento: modification in volume of node %s (%s)", s.nodeUUID.str().c_str(), s.name.c_str());
 	if (scenegraph::SceneGraphNode *node = sceneGraphNodeByUUID(s.nodeUUID)) {
 		if (node->type() == scenegraph::SceneGraphNodeType::Model && s.nodeType == scenegraph::SceneGraphNodeType::ModelReference) {
 			if (scenegraph::SceneGraphNode* referenceNode = sceneGraphNodeByUUID(s.referenceUUID)) {
 				node->setReference(referenceNode->id(), true);
 			} else {
-				Log::warn("Failed to handle memento state - reference node id %s not found", s.referenceUUID.c_str());
+				Log::warn("Failed to handle memento state - reference node id %s not found", s.referenceUUID.str().c_str());
 			}
 		} else {
 			if (node->type() == scenegraph::SceneGraphNodeType::ModelReference && s.nodeType == scenegraph::SceneGraphNodeType::Model) {
 				node->unreferenceModelNode(_sceneGraph.node(node->reference()));
 			}
-			if (node->region() != s.dataRegion()) {
-				voxel::RawVolume *v = new voxel::RawVolume(s.dataRegion());
+			if (node->region() != s.data.volumeRegion()) {
+				voxel::RawVolume *v = new voxel::RawVolume(s.data.volumeRegion());
 				if (!setSceneGraphNodeVolume(*node, v)) {
 					delete v;
 				}
@@ -829,7 +988,7 @@ bool SceneManager::mementoModification(const memento::MementoState& s) {
 		modified(node->id(), s.data.region(), false);
 		return true;
 	}
-	Log::warn("Failed to handle memento state - node id %s not found (%s)", s.nodeUUID.c_str(), s.name.c_str());
+	Log::warn("Failed to handle memento state - node id %s not found (%s)", s.nodeUUID.str().c_str(), s.name.c_str());
 	return false;
 }
 
@@ -847,7 +1006,7 @@ bool SceneManager::mementoStateToNode(const memento::MementoState &s) {
 		if (scenegraph::SceneGraphNode* referenceNode = sceneGraphNodeByUUID(s.referenceUUID)) {
 			newNode.setReference(referenceNode->id());
 		} else {
-			Log::warn("Failed to handle memento state - reference node id %s not found", s.referenceUUID.c_str());
+			Log::warn("Failed to handle memento state - reference node id %s not found", s.referenceUUID.str().c_str());
 		}
 	}
 	_sceneGraph.setAllKeyFramesForNode(newNode, s.keyFrames);
@@ -886,13 +1045,13 @@ bool SceneManager::mementoStateExecute(const memento::MementoState &s, bool isRe
 		return mementoNormalPaletteChange(s);
 	}
 	if (s.type == memento::MementoType::SceneNodeMove) {
-		Log::debug("Memento: move of node %s (%s) (new parent %s)", s.nodeUUID.c_str(), s.name.c_str(), s.parentUUID.c_str());
+		Log::debug("Memento: move of node %s (%s) (new parent %s)", s.nodeUUID.str().c_str(), s.name.c_str(), s.parentUUID.str().c_str());
 		scenegraph::SceneGraphNode *node = sceneGraphNodeByUUID(s.nodeUUID);
 		scenegraph::SceneGraphNode *nodeParent = sceneGraphNodeByUUID(s.parentUUID);
 		if (node && nodeParent) {
 			return nodeMove(node->id(), nodeParent->id());
 		}
-		Log::warn("Failed to handle memento move state - node id %s not found (%s)", s.nodeUUID.c_str(), s.name.c_str());
+		Log::warn("Failed to handle memento move state - node id %s not found (%s)", s.nodeUUID.str().c_str(), s.name.c_str());
 		return false;
 	}
 	if (s.type == memento::MementoType::Modification) {
@@ -900,28 +1059,28 @@ bool SceneManager::mementoStateExecute(const memento::MementoState &s, bool isRe
 	}
 	if (isRedo) {
 		if (s.type == memento::MementoType::SceneNodeRemoved) {
-			Log::debug("Memento: remove of node %s (%s) from parent %s", s.nodeUUID.c_str(), s.name.c_str(), s.parentUUID.c_str());
+			Log::debug("Memento: remove of node %s (%s) from parent %s", s.nodeUUID.str().c_str(), s.name.c_str(), s.parentUUID.str().c_str());
 			if (scenegraph::SceneGraphNode *node = sceneGraphNodeByUUID(s.nodeUUID)) {
 				return nodeRemove(*node, true);
 			}
-			Log::warn("Failed to handle redo memento remove state - node id %s not found (%s)", s.nodeUUID.c_str(), s.name.c_str());
+			Log::warn("Failed to handle redo memento remove state - node id %s not found (%s)", s.nodeUUID.str().c_str(), s.name.c_str());
 			return false;
 		}
 		if (s.type == memento::MementoType::SceneNodeAdded) {
-			Log::debug("Memento: add node (%s) to parent %s", s.name.c_str(), s.parentUUID.c_str());
+			Log::debug("Memento: add node (%s) to parent %s", s.name.c_str(), s.parentUUID.str().c_str());
 			return mementoStateToNode(s);
 		}
 	} else {
 		if (s.type == memento::MementoType::SceneNodeRemoved) {
-			Log::debug("Memento: remove of node (%s) from parent %s", s.name.c_str(), s.parentUUID.c_str());
+			Log::debug("Memento: remove of node (%s) from parent %s", s.name.c_str(), s.parentUUID.str().c_str());
 			return mementoStateToNode(s);
 		}
 		if (s.type == memento::MementoType::SceneNodeAdded) {
-			Log::debug("Memento: add node (%s) to parent %s", s.name.c_str(), s.parentUUID.c_str());
+			Log::debug("Memento: add node (%s) to parent %s", s.name.c_str(), s.parentUUID.str().c_str());
 			if (scenegraph::SceneGraphNode *node = sceneGraphNodeByUUID(s.nodeUUID)) {
 				return nodeRemove(*node, true);
 			}
-			Log::warn("Failed to handle undo memento add state - node id %s not found (%s)", s.nodeUUID.c_str(), s.name.c_str());
+			Log::warn("Failed to handle undo memento add state - node id %s not found (%s)", s.nodeUUID.str().c_str(), s.name.c_str());
 		}
 	}
 	return true;
@@ -1034,10 +1193,55 @@ bool SceneManager::copy() {
 	voxel::VoxelData voxelData(node->volume(), node->palette(), false);
 	const Selections& selections = _modifierFacade.selectionMgr().selections();
 	_copy = voxedit::tool::copy(voxelData, selections);
+	copyToSystemClipboard();
 	return _copy;
 }
 
+void SceneManager::copyToSystemClipboard() {
+	if (!_systemClipboard->boolVal() || !_copy) {
+		return;
+	}
+	const core::String &text = voxedit::tool::toClipboardText(_copy);
+	if (text.empty()) {
+		return;
+	}
+	if (SDL_SetClipboardText(text.c_str()) != 0) {
+		Log::debug("Failed to put the copied voxels into the system clipboard: %s", SDL_GetError());
+		return;
+	}
+	_clipboardTextHash = core::hash((const void *)text.c_str(), (int)text.size());
+}
+
+void SceneManager::pasteFromSystemClipboard() {
+	if (!_systemClipboard->boolVal() || !SDL_HasClipboardText()) {
+		return;
+	}
+	char *clipboardText = SDL_GetClipboardText();
+	if (clipboardText == nullptr) {
+		return;
+	}
+	const core::String text(clipboardText);
+	SDL_free(clipboardText);
+	if (!voxedit::tool::isClipboardText(text)) {
+		return;
+	}
+	const uint32_t hash = core::hash((const void *)text.c_str(), (int)text.size());
+	if (hash == _clipboardTextHash) {
+		// this is the payload of our own copy
+		return;
+	}
+	voxel::VoxelData voxelData = voxedit::tool::fromClipboardText(text);
+	if (!voxelData) {
+		Log::warn("Failed to decode the voxels of the system clipboard");
+		return;
+	}
+	Log::debug("Use the voxels of the system clipboard");
+	_copy = core::move(voxelData);
+	_clipboardTextHash = hash;
+}
+
 bool SceneManager::pasteAsNewNode() {
+	pasteFromSystemClipboard();
 	if (!_copy) {
 		Log::debug("Nothing copied yet - failed to paste");
 		return false;
@@ -1049,12 +1253,13 @@ bool SceneManager::pasteAsNewNode() {
 	}
 	scenegraph::SceneGraphNode newNode(scenegraph::SceneGraphNodeType::Model);
 	scenegraph::copyNode(*node, newNode, false);
-	newNode.setVolume(new voxel::RawVolume(*_copy.volume), true);
+	newNode.setVolume(voxel::RawVolume::createShared(*_copy.volume), true);
 	newNode.setPalette(*_copy.palette);
 	return moveNodeToSceneGraph(newNode, node->parent()) != InvalidNodeId;
 }
 
 bool SceneManager::paste(const glm::ivec3& pos) {
+	pasteFromSystemClipboard();
 	if (!_copy) {
 		Log::debug("Nothing copied yet - failed to paste");
 		return false;
@@ -1099,6 +1304,7 @@ bool SceneManager::cut() {
 		_copy = {};
 		return false;
 	}
+	copyToSystemClipboard();
 	const int64_t dismissMillis = core::Var::getSafe(cfg::VoxEditModificationDismissMillis)->intVal();
 	modified(nodeId, modifiedRegion, true, dismissMillis);
 	return true;
@@ -1240,7 +1446,7 @@ void SceneManager::onNewNodeAdded(int newNodeId, bool isChildren) {
 		const core::String &name = node->name();
 		const scenegraph::SceneGraphNodeType type = node->type();
 		Log::debug("Adding node %i with name %s (type: %s, uuid: %s)", newNodeId, name.c_str(),
-				   scenegraph::SceneGraphNodeTypeStr[(int)type], node->uuid().c_str());
+				   scenegraph::SceneGraphNodeTypeStr[(int)type], node->uuid().str().c_str());
 
 		_mementoHandler.markNodeAdded(_sceneGraph, *node);
 
@@ -1346,7 +1552,7 @@ scenegraph::SceneGraphNode *SceneManager::sceneGraphNode(int nodeId) {
 	return nullptr;
 }
 
-scenegraph::SceneGraphNode *SceneManager::sceneGraphNodeByUUID(const core::String &uuid) {
+scenegraph::SceneGraphNode *SceneManager::sceneGraphNodeByUUID(const core::UUID &uuid) {
 	return _sceneGraph.findNodeByUUID(uuid);
 }
 
@@ -1465,7 +1671,7 @@ void SceneManager::rotate(math::Axis axis) {
 		if (v == nullptr) {
 			return;
 		}
-		voxel::RawVolume *newVolume = voxelutil::rotateAxis(v, axis);
+		voxel::RawVolume *newVolume = voxelutil::rotateAxis(v, axis, &app::App::getInstance()->threadPool());
 		if (newVolume == nullptr) {
 			return;
 		}
@@ -1518,6 +1724,7 @@ void SceneManager::nodeShift(int nodeId, const glm::ivec3& m) {
 	}
 	voxel::Region region = v->region();
 	v->translate(m);
+	_sceneGraph.markBoundsDirty(nodeId);
 	region.accumulate(v->region());
 	_dirtyRenderer = DirtyRendererLockedAxis | DirtyRendererGridRenderer;
 	modified(nodeId, region);
@@ -1567,9 +1774,14 @@ void SceneManager::construct() {
 	_movement.construct();
 
 	_autoSaveSecondsDelay = core::Var::get(cfg::VoxEditAutoSaveSeconds, "180", -1, _("Delay in second between autosaves - 0 disables autosaves"));
+	_compressInactiveSeconds = core::Var::get(cfg::VoxEditCompressInactiveSeconds, "0", -1, _("Compress the volumes of nodes that were not touched for the given amount of seconds - 0 disables the compression"));
 	_movementSpeed = core::Var::get(cfg::VoxEditMovementSpeed, "180.0f");
 	_transformUpdateChildren = core::Var::get(cfg::VoxEditTransformUpdateChildren, "true", -1, _("Update the children of a node when the transform of the node changes"));
 	_maxSuggestedVolumeSize = core::Var::getSafe(cfg::VoxEditMaxSuggestedVolumeSize);
+	_systemClipboard = core::Var::get(cfg::VoxEditSystemClipboard, "true", -1, _("Exchange copied voxels with other instances via the system clipboard"));
+	_undoMemory = core::Var::get(cfg::VoxEditUndoMemory, "256", -1, _("Memory in MiB the undo history may use before old states are moved into a temp file - 0 disables the limit"));
+	_undoSteps = core::Var::get(cfg::VoxEditUndoSteps, "4096", -1, _("The max amount of undo steps"));
+	_syncStream = core::Var::get(cfg::VoxEditSyncStream, "", -1, _("Append the scene changes of every frame to this file - e.g. a pipe for a tool that mirrors the scene"));
 
 	command::Command::registerCommand("resizetoselection", [&](const command::CmdArgs &args) {
 		const voxel::Region &region = modifier().selectionMgr().region();
@@ -2265,17 +2477,19 @@ void SceneManager::construct() {
 
 void SceneManager::nodeRemoveUnusedColors(int nodeId, bool updateVoxels) {
 	scenegraph::SceneGraphNode &node = _sceneGraph.node(nodeId);
-	node.removeUnusedColors(updateVoxels);
-	if (updateVoxels) {
+	voxel::Region dirtyRegion;
+	node.removeUnusedColors(updateVoxels, &dirtyRegion);
+	if (dirtyRegion.isValid()) {
 		memento::ScopedMementoGroup mementoGroup(_mementoHandler, "removeunusedcolors");
 		_mementoHandler.markPaletteChange(_sceneGraph, node);
-		modified(nodeId, _sceneGraph.resolveRegion(node));
+		modified(nodeId, dirtyRegion);
 	} else {
+		// no voxel got a new color index - the palette change is handled by the renderer without extracting again
 		_mementoHandler.markPaletteChange(_sceneGraph, node);
 	}
 }
 
-int SceneManager::addModelChild(const core::String& name, int width, int height, int depth, const core::String &uuid) {
+int SceneManager::addModelChild(const core::String& name, int width, int height, int depth, const core::UUID &uuid) {
 	const voxel::Region region(0, 0, 0, width - 1, height - 1, depth - 1);
 	if (!region.isValid()) {
 		Log::warn("Invalid size provided (%i:%i:%i)", width, height, depth);
@@ -2337,14 +2551,18 @@ bool SceneManager::init() {
 		Log::error("Failed to initialize the lua api");
 		return false;
 	}
+	// scripts that don't yield on their own are paused after this amount of millis to keep the ui responsive
+	_luaApi.setFrameBudget(10u);
 
 	_gridSize = core::Var::getSafe(cfg::VoxEditGridsize);
 	_lastAutoSave = _timeProvider->tickSeconds();
 
 	voxel::Region maxUndoRegion(0, _maxSuggestedVolumeSize->intVal() - 1);
 	_mementoHandler.setMaxUndoRegion(maxUndoRegion);
+	updateMementoBudget();
 
 	_modifierFacade.setLockedAxis(math::Axis::None, true);
+	_sceneGraph.registerListener(&_lazyVolumeListener);
 	return true;
 }
 
@@ -2352,6 +2570,10 @@ bool SceneManager::isScriptRunning() const {
 	return _luaApi.scriptStillRunning();
 }
 
+void SceneManager::cancelScript() {
+	_luaApi.cancel();
+}
+
 bool SceneManager::runScript(const core::String& luaCode, const core::DynamicArray<core::String>& args) {
 	if (luaCode.empty()) {
 		Log::warn("No script selected");
@@ -2359,6 +2581,7 @@ bool SceneManager::runScript(const core::String& luaCode, const core::DynamicArr
 	}
 	const int nodeId = _sceneGraph.activeNode();
 	const voxel::Region &region = _sceneGraph.resolveRegion(_sceneGraph.node(nodeId));
+	_scriptUndoPosition = _mementoHandler.statePosition();
 	_mementoHandler.beginGroup("lua script");
 	// TODO: MEMENTO: there are still no memento states for direct node modifications during the script run
 	//                we can e.g. set or modify the transforms, properties and so on of a node.
@@ -2426,6 +2649,10 @@ bool SceneManager::isLoading() const {
 	return _loadingFuture.valid();
 }
 
+bool SceneManager::isBusy() const {
+	return isLoading() || animateActive() || _luaApi.scriptStillRunning() || _sceneRenderer->isBusy();
+}
+
 bool SceneManager::update(double nowSeconds) {
 	updateDelta(nowSeconds);
 	bool loadedNewScene = false;
@@ -2447,6 +2674,12 @@ bool SceneManager::update(double nowSeconds) {
 		_mementoHandler.setMaxUndoRegion(maxUndoRegion);
 		_maxSuggestedVolumeSize->markClean();
 	}
+	if (_undoMemory->isDirty() || _undoSteps->isDirty()) {
+		updateMementoBudget();
+	}
+	if (_syncStream->isDirty()) {
+		updateSyncStream();
+	}
 
 	_movement.update(nowSeconds);
 	voxelgenerator::ScriptState state = _luaApi.update(nowSeconds);
@@ -2454,7 +2687,7 @@ bool SceneManager::update(double nowSeconds) {
 		_sceneGraph.unregisterListener(&_luaApiListener);
 		_mementoHandler.endGroup();
 		Log::error("Error in script: %s", _luaApi.error().c_str());
-	} else if (state == voxelgenerator::ScriptState::Finished) {
+	} else if (state == voxelgenerator::ScriptState::Finished || state == voxelgenerator::ScriptState::Cancelled) {
 		const voxel::Region dirtyRegion = _luaApi.dirtyRegion();
 		if (dirtyRegion.isValid()) {
 			modified(activeNode(), dirtyRegion, true);
@@ -2466,6 +2699,10 @@ bool SceneManager::update(double nowSeconds) {
 		}
 		_sceneGraph.unregisterListener(&_luaApiListener);
 		_mementoHandler.endGroup();
+		if (state == voxelgenerator::ScriptState::Cancelled && _mementoHandler.statePosition() != _scriptUndoPosition) {
+			// revert the modifications the cancelled script already did
+			undo();
+		}
 	}
 	video::Camera *camera = activeCamera();
 	if (camera != nullptr && camera->rotationType() == video::CameraRotationType::Eye) {
@@ -2509,6 +2746,8 @@ bool SceneManager::update(double nowSeconds) {
 
 	animate(nowSeconds);
 	autosave();
+	compressInactiveNodes(nowSeconds);
+	flushSyncStream();
 	return loadedNewScene;
 }
 
@@ -2521,6 +2760,9 @@ void SceneManager::shutdown() {
 	}
 
 	autosave();
+	if (_autosaveFuture.valid()) {
+		_autosaveFuture.wait();
+	}
 
 	_luaApi.shutdown();
 
@@ -2529,10 +2771,14 @@ void SceneManager::shutdown() {
 		Log::error("Lua api listener still registered");
 		_sceneGraph.unregisterListener(&_luaApiListener);
 	}
+	_sceneGraph.unregisterListener(&_lazyVolumeListener);
 	_sceneGraph.clear();
 
 	_movement.shutdown();
 	_modifierFacade.shutdown();
+	if (_mementoHandler.isRegistered(&_mementoStream)) {
+		_mementoHandler.unregisterListener(&_mementoStream);
+	}
 	_mementoHandler.shutdown();
 
 	command::Command::unregisterActionButton("zoom_in");
@@ -2659,19 +2905,16 @@ int SceneManager::traceScene() {
 	core_trace_scoped(EditorSceneOnProcessUpdateRay);
 	float intersectDist = _camera->farPlane();
 	const math::Ray& ray = _camera->mouseRay(_mouseCursor);
-	for (auto entry : _sceneGraph.nodes()) {
-		const scenegraph::SceneGraphNode& node = entry->second;
+	// only the nodes whose world bounds are hit by the ray are tested against their oriented bounding box
+	_sceneGraph.raycastNodes(ray, _currentFrameIdx, intersectDist, [&](const scenegraph::SceneGraphNode &node, float) {
 		if (previousNodeId == node.id()) {
-			continue;
-		}
-		if (!node.isAnyModelNode()) {
-			continue;
+			return intersectDist;
 		}
 		if (!node.visible()) {
-			continue;
+			return intersectDist;
 		}
 		if (!_sceneRenderer->isVisible(node.id(), false)) {
-			continue;
+			return intersectDist;
 		}
 		float distance = 0.0f;
 		const voxel::Region& region = _sceneGraph.resolveRegion(node);
@@ -2684,7 +2927,8 @@ int SceneManager::traceScene() {
 				nodeId = node.id();
 			}
 		}
-	}
+		return intersectDist;
+	});
 	Log::debug("Hovered node: %i", nodeId);
 	return nodeId;
 }
@@ -2758,7 +3002,16 @@ bool SceneManager::mouseRayTrace(bool force) {
 	const math::Axis lockedAxis = _modifierFacade.lockedAxis();
 	// TODO: we could optionally limit the raycast to the selection
 
-	voxelutil::raycastWithDirection(v, ray.origin, dirWithLength, [&] (voxel::RawVolume::Sampler& sampler) {
+	// only the voxels inside the volume and the first one after leaving it are of interest - don't walk all the voxels
+	// between the camera and the volume
+	glm::vec3 rayStart = ray.origin;
+	glm::vec3 rayEnd = ray.origin + dirWithLength;
+	if (!voxelutil::clipRayToRegion(v->region(), 2, rayStart, rayEnd)) {
+		updateCursor();
+		return true;
+	}
+
+	voxelutil::raycastWithEndpoints(v, rayStart, rayEnd, [&] (voxel::RawVolume::Sampler& sampler) {
 		if (!_result.firstValidPosition && sampler.currentPositionValid()) {
 			_result.firstPosition = sampler.position();
 			_result.firstValidPosition = true;
@@ -3338,15 +3591,17 @@ bool SceneManager::nodeRemoveColor(scenegraph::SceneGraphNode &node, uint8_t pal
 	const uint8_t replacement = palette.findReplacement(palIdx);
 	if (replacement != palIdx && palette.removeColor(palIdx)) {
 		palette.markSave();
-		const voxel::Voxel replacementVoxel = voxel::createVoxel(palette, replacement);
+		core::Array<uint8_t, palette::PaletteMaxColors> mapping;
+		for (int i = 0; i < palette::PaletteMaxColors; ++i) {
+			mapping[i] = (uint8_t)i;
+		}
+		mapping[palIdx] = replacement;
+		memento::ScopedMementoGroup mementoGroup(_mementoHandler, "removecolor");
 		_mementoHandler.markPaletteChange(_sceneGraph, node);
-		voxelutil::visitVolume(
-			*v,
-			[v, replacementVoxel](int x, int y, int z, const voxel::Voxel &voxel) {
-				v->setVoxel(x, y, z, replacementVoxel);
-				return true;
-			},
-			voxelutil::VisitColor(palIdx));
+		const voxel::Region dirtyRegion = voxelutil::remapColors(v, palette, mapping.data());
+		if (dirtyRegion.isValid()) {
+			modified(node.id(), dirtyRegion);
+		}
 		return true;
 	}
 	return false;
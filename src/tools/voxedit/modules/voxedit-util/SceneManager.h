@@ -6,6 +6,7 @@
 
 #include "ISceneRenderer.h"
 #include "memento/MementoHandler.h"
+#include "memento/MementoStream.h"
 #include "command/ActionButton.h"
 #include "core/DeltaFrameSeconds.h"
 #include "core/Enum.h"
@@ -29,6 +30,7 @@
 #include "voxelgenerator/TreeContext.h"
 #include "voxelutil/Picking.h"
 #include "LUAApiListener.h"
+#include "LazyVolumeListener.h"
 #include <functional>
 
 namespace voxedit {
@@ -62,14 +64,19 @@ class SceneManager : public core::DeltaFrameSeconds {
 protected:
 	scenegraph::SceneGraph _sceneGraph;
 	memento::MementoHandler _mementoHandler;
+	// serializes the memento states for the remote scene sync - see @c ve_syncstream
+	memento::MementoStream _mementoStream;
 	util::Movement _movement;
 	voxel::VoxelData _copy;
 	std::future<scenegraph::SceneGraph> _loadingFuture;
+	// the autosave that is written by a worker thread - see @c autosave()
+	std::future<bool> _autosaveFuture;
 	core::TimeProviderPtr _timeProvider;
 	SceneRendererPtr _sceneRenderer;
 	ModifierFacade _modifierFacade;
 	voxelgenerator::LUAApi _luaApi;
 	LUAApiListener _luaApiListener;
+	LazyVolumeListener _lazyVolumeListener;
 	io::FilesystemPtr _filesystem;
 
 	/**
@@ -78,12 +85,24 @@ protected:
 	video::Camera *_camera = nullptr;
 
 	core::VarPtr _autoSaveSecondsDelay;
+	core::VarPtr _compressInactiveSeconds;
 	core::VarPtr _gridSize;
 	core::VarPtr _movementSpeed;
 	core::VarPtr _transformUpdateChildren;
 	core::VarPtr _maxSuggestedVolumeSize;
+	core::VarPtr _systemClipboard;
+	core::VarPtr _undoMemory;
+	core::VarPtr _undoSteps;
+	core::VarPtr _syncStream;
+	// the temp file for the undo states that exceed the memory budget
+	core::String _undoSpillFile;
+	// the hash of the clipboard text that belongs to @c _copy
+	uint32_t _clipboardTextHash = 0u;
+	// the undo state position before the running lua script was started
+	int _scriptUndoPosition = 0;
 
 	bool _dirty = false;
+	double _lastCompressInactive = 0.0;
 	// this is basically the same as the dirty state, but we stop
 	// auto-saving once we saved a dirty state
 	bool _needAutoSave = false;
@@ -96,6 +115,23 @@ protected:
 	int _lastRaytraceX = -1;
 	int _lastRaytraceY = -1;
 
+	/**
+	 * @brief The modifications of a node that were collected while a modification batch is active
+	 * @sa beginModificationBatch()
+	 */
+	struct PendingModification {
+		int nodeId = InvalidNodeId;
+		/** the union of the given valid regions */
+		voxel::Region region = voxel::Region::InvalidRegion;
+		/** an undo state without a region was requested - the whole volume is recorded */
+		bool wholeVolume = false;
+		bool markUndo = false;
+		uint64_t renderRegionMillis = 0;
+	};
+	core::DynamicArray<PendingModification> _pendingModifications;
+	int _modificationBatch = 0;
+	void flushModifications();
+
 	static const uint32_t DirtyRendererLockedAxis = 1 << 0;
 	static const uint32_t DirtyRendererGridRenderer = 1 << 1;
 	uint32_t _dirtyRenderer = 0u;
@@ -141,7 +177,29 @@ protected:
 	 * @param[in] deleteMesh TODO: handle deleteMesh somehow
 	 */
 	bool setNewVolume(int nodeId, voxel::RawVolume *volume, bool deleteMesh = true);
+	/**
+	 * @brief Saves a snapshot of the scene graph on a worker thread if the scene was modified
+	 *
+	 * The snapshot shares the voxel data with the scene graph (copy on write) - so the editing can go on while the
+	 * autosave is written.
+	 */
 	void autosave();
+	/**
+	 * @brief Replace the volumes of nodes that were not touched for @c ve_compressinactiveseconds with a compressed copy
+	 */
+	void compressInactiveNodes(double nowSeconds);
+	/**
+	 * @brief Apply the @c ve_undomemory and @c ve_undosteps limits to the undo history
+	 */
+	void updateMementoBudget();
+	/**
+	 * @brief Starts or stops to write the scene changes into the file given by @c ve_syncstream
+	 */
+	void updateSyncStream();
+	/**
+	 * @brief Appends the scene changes of the current frame to the sync stream file
+	 */
+	void flushSyncStream();
 	void setReferencePosition(const glm::ivec3 &pos);
 	void updateDirtyRendererStates();
 	void zoom(video::Camera &camera, float level) const;
@@ -259,8 +317,22 @@ public:
 
 	const glm::ivec3 &referencePosition() const;
 
+	/**
+	 * @brief Records the undo state and schedules the mesh extraction for the modified region of the node
+	 * @note If a modification batch is active, the modifications are only collected and applied once the batch ends
+	 */
 	void modified(int nodeId, const voxel::Region &modifiedRegion, bool markUndo = true,
 				  uint64_t renderRegionMillis = 0);
+	/**
+	 * @brief Starts collecting the calls to modified() - the regions of a node are merged
+	 *
+	 * Once the outermost batch ends, every modified node gets one undo state and one extraction schedule for the
+	 * union of its regions. The undo states of all nodes end up in one undo group. This is meant for operations that
+	 * modify the same nodes many times in a row.
+	 * @sa ScopedModificationBatch
+	 */
+	void beginModificationBatch();
+	void endModificationBatch();
 	voxel::RawVolume *volume(int nodeId);
 	const voxel::RawVolume *volume(int nodeId) const;
 	palette::Palette &activePalette() const;
@@ -289,7 +361,7 @@ public:
 	/**
 	 * @brief Add a new model node as children to the current active node
 	 */
-	int addModelChild(const core::String &name, int width, int height, int depth, const core::String &uuid = "");
+	int addModelChild(const core::String &name, int width, int height, int depth, const core::UUID &uuid = core::UUID());
 
 	/**
 	 * @brief Merge two nodes and extend the smaller one
@@ -302,6 +374,16 @@ public:
 	 */
 	bool splitVolumes();
 
+	/**
+	 * @brief Puts the copied voxels as compressed payload into the system clipboard to allow pasting them into
+	 * another instance
+	 */
+	void copyToSystemClipboard();
+	/**
+	 * @brief Replaces the copied voxels with the payload of another instance - if the system clipboard contains one.
+	 * The payload is only decoded here - and not when it's copied.
+	 */
+	void pasteFromSystemClipboard();
 	bool copy();
 	bool paste(const glm::ivec3 &pos);
 	bool pasteAsNewNode();
@@ -348,6 +430,10 @@ public:
 	bool importDirectory(const core::String &directory, const io::FormatDescription *format = nullptr, int depth = 3);
 
 	bool isScriptRunning() const;
+	/**
+	 * @brief Aborts the running lua script and reverts the modifications it already did
+	 */
+	void cancelScript();
 	bool runScript(const core::String &luaCode, const core::DynamicArray<core::String> &args);
 
 	/**
@@ -372,6 +458,11 @@ public:
 	 * @note This is not about the animation scene mode, but the animation of the nodes
 	 */
 	bool animateActive() const;
+	/**
+	 * @return @c true if the scene changes without any user input - e.g. while loading a scene, running a script,
+	 * animating the nodes or extracting the meshes
+	 */
+	bool isBusy() const;
 
 	static const uint8_t RenderScene = 1u << 0u;
 	static const uint8_t RenderUI = 1u << 1u;
@@ -399,7 +490,7 @@ public:
 	scenegraph::SceneGraphNode *sceneGraphNode(int nodeId);
 	const scenegraph::SceneGraphNode *sceneGraphNode(int nodeId) const;
 	scenegraph::SceneGraphNode *sceneGraphModelNode(int nodeId);
-	scenegraph::SceneGraphNode *sceneGraphNodeByUUID(const core::String &uuid);
+	scenegraph::SceneGraphNode *sceneGraphNodeByUUID(const core::UUID &uuid);
 
 	const voxel::VoxelData& clipBoardData() const;
 
@@ -581,6 +672,19 @@ inline voxelgenerator::LUAApi &SceneManager::luaApi() {
 	return _luaApi;
 }
 
+class ScopedModificationBatch {
+private:
+	SceneManager &_sceneMgr;
+
+public:
+	ScopedModificationBatch(SceneManager &sceneMgr) : _sceneMgr(sceneMgr) {
+		_sceneMgr.beginModificationBatch();
+	}
+	~ScopedModificationBatch() {
+		_sceneMgr.endModificationBatch();
+	}
+};
+
 using SceneManagerPtr = core::SharedPtr<SceneManager>;
 
 } // namespace voxedit
@@ -41,6 +41,8 @@ bool SceneRenderer::init() {
 	_planeSize = core::Var::getSafe(cfg::VoxEditPlaneSize);
 	_showPlane = core::Var::getSafe(cfg::VoxEditShowPlane);
 
+	// large scenes render the distant chunks in lower resolutions - see cfg::VoxelMeshLOD
+	_meshState->setDownsampler(voxelrender::RawVolumeRenderer::downsample);
 	if (!_meshState->init()) {
 		Log::error("Failed to initialize the mesh state");
 		return false;
@@ -80,6 +82,17 @@ bool SceneRenderer::isSliceModeActive() const {
 	return _sceneGraphRenderer.isSliceModeActive();
 }
 
+bool SceneRenderer::isBusy() const {
+	if (!_extractRegions.empty() || _sceneGraphRenderer.pendingUploads() > 0) {
+		return true;
+	}
+	if (_meshState->pendingExtractions() > 0 || _meshState->runningExtractions() > 0) {
+		return true;
+	}
+	const core::TimeProviderPtr &timeProvider = app::App::getInstance()->timeProvider();
+	return _highlightRegion.isValid(timeProvider->tickNow());
+}
+
 void SceneRenderer::shutdown() {
 	_sceneGraphRenderer.shutdown();
 	// don't free the volumes here, they belong to the scene graph
@@ -84,6 +84,7 @@ public:
 	const voxel::Region &sliceRegion() const override;
 	void setSliceRegion(const voxel::Region &region) override;
 	bool isSliceModeActive() const override;
+	bool isBusy() const override;
 };
 
 } // namespace voxedit
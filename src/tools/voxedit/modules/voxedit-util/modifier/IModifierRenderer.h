@@ -34,7 +34,8 @@ public:
 	}
 	virtual void clear() {
 	}
-	virtual void updateBrushVolume(int idx, voxel::RawVolume *volume, palette::Palette *palette) {
+	virtual void updateBrushVolume(int idx, voxel::RawVolume *volume, palette::Palette *palette,
+								   const voxel::Region &dirtyRegion) {
 	}
 
 	virtual void render(const video::Camera &camera, const glm::mat4 &model) {
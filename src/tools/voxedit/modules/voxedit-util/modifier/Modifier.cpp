@@ -286,6 +286,8 @@ bool Modifier::execute(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGrap
 		return true;
 	}
 
+	// the brushes read and write the volume with different samplers - they must all operate on the same data
+	volume->detach();
 	preExecuteBrush(volume);
 	executeBrush(sceneGraph, node, _brushContext.modifierType, _brushContext.cursorVoxel, callback);
 	postExecuteBrush();
@@ -358,7 +360,7 @@ bool Modifier::executeBrush(scenegraph::SceneGraph &sceneGraph, scenegraph::Scen
 							ModifierType modifierType, const voxel::Voxel &voxel,
 							const ModifiedRegionCallback &callback) {
 	if (Brush *brush = currentBrush()) {
-		ModifierVolumeWrapper wrapper(node, modifierType, _selectionManager.selections());
+		ModifierVolumeWrapper wrapper(node, modifierType, &_selectionManager.selectionVolume());
 		voxel::Voxel prevVoxel = _brushContext.cursorVoxel;
 		glm::ivec3 prevCursorPos = _brushContext.cursorPosition;
 		if (brush->brushClamping()) {
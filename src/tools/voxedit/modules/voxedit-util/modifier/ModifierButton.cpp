@@ -77,7 +77,11 @@ void ModifierButton::execute(bool single) {
 			++nodes;
 		}
 	};
-	_sceneMgr->nodeForeachGroup(func);
+	{
+		// the undo states and mesh extractions of the nodes are applied once the brush was executed on all of them
+		ScopedModificationBatch modificationBatch(*_sceneMgr);
+		_sceneMgr->nodeForeachGroup(func);
+	}
 	if (_oldType != ModifierType::None) {
 		modifier.setModifierType(_oldType);
 		_sceneMgr->trace(false, true);
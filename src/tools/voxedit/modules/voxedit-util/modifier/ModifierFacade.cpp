@@ -38,11 +38,13 @@ void ModifierFacade::shutdown() {
 
 static void createOrClearPreviewVolume(voxel::RawVolume *existingVolume, core::ScopedPtr<voxel::RawVolume> &volume, voxel::Region region) {
 	if (existingVolume == nullptr) {
-		if (volume == nullptr || volume->region() != region) {
+		// moving a brush of the same size doesn't allocate a new preview volume
+		if (volume == nullptr || volume->region().getDimensionsInVoxels() != region.getDimensionsInVoxels()) {
 			volume = new voxel::RawVolume(region);
 			return;
 		}
 		volume->clear();
+		volume->translate(region.getLowerCorner() - volume->region().getLowerCorner());
 	} else {
 		region.grow(1);
 		volume = new voxel::RawVolume(*existingVolume, region);
@@ -93,18 +95,28 @@ void ModifierFacade::updateBrushVolumePreview(palette::Palette &activePalette) {
 		if (region.isValid()) {
 			glm::ivec3 minsMirror = region.getLowerCorner();
 			glm::ivec3 maxsMirror = region.getUpperCorner();
+			// only the parts of the preview volumes that the brush has written to are meshed
+			voxel::Region dirtyRegion = voxel::Region::InvalidRegion;
+			auto callback = [&dirtyRegion](const voxel::Region &modifiedRegion, ModifierType, bool) {
+				dirtyRegion = modifiedRegion;
+			};
 			if (brush->getMirrorAABB(minsMirror, maxsMirror)) {
 				createOrClearPreviewVolume(existingVolume, _mirrorVolume, voxel::Region(minsMirror, maxsMirror));
 				scenegraph::SceneGraphNode mirrorDummyNode(scenegraph::SceneGraphNodeType::Model);
 				mirrorDummyNode.setVolume(_mirrorVolume, false);
-				executeBrush(sceneGraph, mirrorDummyNode, modifierType, voxel);
-				_modifierRenderer->updateBrushVolume(1, _mirrorVolume, &activePalette);
+				executeBrush(sceneGraph, mirrorDummyNode, modifierType, voxel, callback);
+				if (dirtyRegion.isValid()) {
+					_modifierRenderer->updateBrushVolume(1, _mirrorVolume, &activePalette, dirtyRegion);
+				}
 			}
+			dirtyRegion = voxel::Region::InvalidRegion;
 			createOrClearPreviewVolume(existingVolume, _volume, region);
 			scenegraph::SceneGraphNode dummyNode(scenegraph::SceneGraphNodeType::Model);
 			dummyNode.setVolume(_volume, false);
-			executeBrush(sceneGraph, dummyNode, modifierType, voxel);
-			_modifierRenderer->updateBrushVolume(0, _volume, &activePalette);
+			executeBrush(sceneGraph, dummyNode, modifierType, voxel, callback);
+			if (dirtyRegion.isValid()) {
+				_modifierRenderer->updateBrushVolume(0, _volume, &activePalette, dirtyRegion);
+			}
 		}
 		postExecuteBrush();
 	}
@@ -57,6 +57,9 @@ void ModifierRenderer::shutdown() {
 	_selectionIndex = -1;
 	_voxelCursorMesh = -1;
 	_referencePointMesh = -1;
+	_selections.release();
+	_cursorFace = voxel::FaceNames::Max;
+	_mirrorAxis = math::Axis::None;
 	_shapeRenderer.shutdown();
 	_shapeBuilder.shutdown();
 	_volumeRendererCtx.shutdown();
@@ -67,6 +70,9 @@ void ModifierRenderer::shutdown() {
 }
 
 void ModifierRenderer::updateCursor(const voxel::Voxel& voxel, voxel::FaceNames face, bool flip) {
+	if (_voxelCursorMesh != -1 && _cursorFace == face && _cursorFlip == flip) {
+		return;
+	}
 	_shapeBuilder.clear();
 	video::ShapeBuilderCube flags = video::ShapeBuilderCube::All;
 	switch (face) {
@@ -118,9 +124,25 @@ void ModifierRenderer::updateCursor(const voxel::Voxel& voxel, voxel::FaceNames
 	_shapeBuilder.setColor(core::Color::alpha(core::Color::Red(), 0.6f));
 	_shapeBuilder.cube(glm::vec3(0.0f), glm::vec3(1.0f), flags);
 	_shapeRenderer.createOrUpdate(_voxelCursorMesh, _shapeBuilder);
+	_cursorFace = face;
+	_cursorFlip = flip;
 }
 
 void ModifierRenderer::updateSelectionBuffers(const Selections& selections) {
+	// this is called for every frame - but the selections rarely change
+	if (_selectionIndex != -1 && _selections.size() == selections.size()) {
+		bool changed = false;
+		for (size_t i = 0; i < selections.size(); ++i) {
+			if (_selections[i] != selections[i]) {
+				changed = true;
+				break;
+			}
+		}
+		if (!changed) {
+			return;
+		}
+	}
+	_selections = selections;
 	_shapeBuilder.clear();
 	_shapeBuilder.setColor(core::Color::Yellow());
 	for (const Selection &selection : selections) {
@@ -136,10 +158,11 @@ void ModifierRenderer::clear() {
 	_volumeRenderer.clear(_meshState);
 }
 
-void ModifierRenderer::updateBrushVolume(int idx, voxel::RawVolume *volume, palette::Palette *palette) {
+void ModifierRenderer::updateBrushVolume(int idx, voxel::RawVolume *volume, palette::Palette *palette,
+										 const voxel::Region &dirtyRegion) {
 	delete _volumeRenderer.setVolume(_meshState, idx, volume, palette, nullptr, true);
 	if (volume != nullptr) {
-		_volumeRenderer.scheduleRegionExtraction(_meshState, idx, volume->region());
+		_volumeRenderer.scheduleRegionExtraction(_meshState, idx, dirtyRegion);
 	}
 }
 
@@ -149,7 +172,7 @@ void ModifierRenderer::renderBrushVolume(const video::Camera &camera) {
 		_volumeRendererCtx.init(camera.size());
 	}
 	_meshState->extractAllPending();
-	_volumeRenderer.update(_meshState);
+	_volumeRenderer.update(_meshState, true);
 	_volumeRenderer.render(_meshState, _volumeRendererCtx, camera, false);
 }
 
@@ -176,12 +199,19 @@ void ModifierRenderer::updateMirrorPlane(math::Axis axis, const glm::ivec3& mirr
 			_shapeRenderer.deleteMesh(_mirrorMeshIndex);
 			_mirrorMeshIndex = -1;
 		}
+		_mirrorAxis = math::Axis::None;
+		return;
+	}
+	if (_mirrorMeshIndex != -1 && _mirrorAxis == axis && _mirrorPos == mirrorPos && _mirrorRegion == region) {
 		return;
 	}
 
 	const glm::vec4 color = core::Color::alpha(core::Color::LightGray(), 0.3f);
 	updateShapeBuilderForPlane(_shapeBuilder, region, true, mirrorPos, axis, color);
 	_shapeRenderer.createOrUpdate(_mirrorMeshIndex, _shapeBuilder);
+	_mirrorAxis = axis;
+	_mirrorPos = mirrorPos;
+	_mirrorRegion = region;
 }
 
 }
@@ -24,6 +24,14 @@ private:
 	int32_t _referencePointMesh = -1;
 	glm::mat4 _referencePointModelMatrix{1.0f};
 
+	// the parameters the shapes were built for - they are only rebuilt if they changed
+	Selections _selections;
+	voxel::FaceNames _cursorFace = voxel::FaceNames::Max;
+	bool _cursorFlip = false;
+	math::Axis _mirrorAxis = math::Axis::None;
+	glm::ivec3 _mirrorPos{0};
+	voxel::Region _mirrorRegion = voxel::Region::InvalidRegion;
+
 public:
 	ModifierRenderer();
 	ModifierRenderer(const voxel::MeshStatePtr &meshState);
@@ -38,8 +46,10 @@ public:
 	 * @note The given volume must still get freed by the caller - the renderer is not taking overship.
 	 *
 	 * But it is keeping a pointer to the volume!
+	 * @param dirtyRegion The region of the volume that contains the brush voxels - only this part is meshed
 	 */
-	void updateBrushVolume(int idx, voxel::RawVolume *volume, palette::Palette *palette) override;
+	void updateBrushVolume(int idx, voxel::RawVolume *volume, palette::Palette *palette,
+						   const voxel::Region &dirtyRegion) override;
 	void updateReferencePosition(const glm::ivec3 &pos) override;
 	void updateMirrorPlane(math::Axis axis, const glm::ivec3 &mirrorPos, const voxel::Region &sceneRegion) override;
 	void updateSelectionBuffers(const Selections &selections) override;
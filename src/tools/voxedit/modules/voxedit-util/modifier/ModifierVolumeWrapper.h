@@ -5,7 +5,7 @@
 #pragma once
 
 #include "ModifierType.h"
-#include "Selection.h"
+#include "SelectionVolume.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/RawVolumeWrapper.h"
 
@@ -15,13 +15,14 @@ namespace voxedit {
  * @brief A wrapper for a @c voxel::RawVolume that performs a sanity check for
  * the @c setVoxel() call and uses the @c ModifierType value to perform the
  * desired action for the @c setVoxel() call.
- * The sanity check also includes the @c Selections that are used to limit the
+ * The sanity check also includes the @c SelectionVolume that is used to limit the
  * area of the @c voxel::RawVolume that is affected by the @c setVoxel() call.
  */
 class ModifierVolumeWrapper : public voxel::RawVolumeWrapper {
 private:
 	using Super = voxel::RawVolumeWrapper;
-	const Selections _selections;
+	const SelectionVolume *_selection;
+	SelectionVolume::Sampler _selectionSampler;
 	const ModifierType _modifierType;
 	scenegraph::SceneGraphNode &_node;
 
@@ -30,28 +31,25 @@ private:
 	bool _paint;
 	bool _force;
 
-	static bool contains(const Selections &selections, int x, int y, int z) {
-		for (const Selection &sel : selections) {
-			if (sel.containsPoint(x, y, z)) {
-				return true;
-			}
-		}
-		return false;
-	}
-
-	bool skip(int x, int y, int z) const {
+	bool skip(int x, int y, int z) {
 		if (!_region.containsPoint(x, y, z)) {
 			return true;
 		}
-		if (_selections.empty()) {
+		if (_selection == nullptr || _selection->empty()) {
 			return false;
 		}
-		return !contains(_selections, x, y, z);
+		return !_selectionSampler.isSelected(x, y, z);
 	}
 
 public:
-	ModifierVolumeWrapper(scenegraph::SceneGraphNode &node, ModifierType modifierType, const Selections &selections = {})
-		: Super(node.volume()), _selections(selections), _modifierType(modifierType), _node(node) {
+	/**
+	 * @param selection The voxels that may be modified - @c nullptr or an empty selection doesn't limit the
+	 * modification. The selection must stay valid as long as the wrapper is used.
+	 */
+	ModifierVolumeWrapper(scenegraph::SceneGraphNode &node, ModifierType modifierType,
+						  const SelectionVolume *selection = nullptr)
+		: Super(node.volume()), _selection(selection), _selectionSampler(selection), _modifierType(modifierType),
+		  _node(node) {
 		_erase = _modifierType == ModifierType::Erase;
 		_override = _modifierType == ModifierType::Override;
 		_paint = _modifierType == ModifierType::Paint;
@@ -66,18 +64,10 @@ public:
 		return _modifierType;
 	}
 
-	void addDirtyRegion(const voxel::Region &region) {
-		if (!region.isValid()) {
-			return;
-		}
-		if (_dirtyRegion.isValid()) {
-			_dirtyRegion.accumulate(region);
-		} else {
-			_dirtyRegion = region;
-		}
-	}
-
 	bool setVoxel(int x, int y, int z, const voxel::Voxel &voxel) override {
+		if (skip(x, y, z)) {
+			return false;
+		}
 		if (!_force) {
 			const voxel::Voxel existingVoxel = this->voxel(x, y, z);
 			const bool empty = voxel::isAir(existingVoxel.getMaterial());
@@ -93,11 +83,67 @@ public:
 		if (_erase) {
 			placeVoxel = voxel::createVoxel(voxel::VoxelType::Air, 0);
 		}
-		if (skip(x, y, z)) {
-			return false;
-		}
 		return Super::setVoxel(x, y, z, placeVoxel);
 	}
+
+	/**
+	 * @brief Applies the modifier to a whole row - the selection is tested once per span of selected voxels and not
+	 * for every voxel
+	 * @return The amount of voxels that were accepted by the modifier
+	 */
+	int setRow(int x0, int x1, int y, int z, const voxel::Voxel &voxel) override {
+		if (!_region.containsPointInY(y) || !_region.containsPointInZ(z)) {
+			return 0;
+		}
+		x0 = core_max(x0, _region.getLowerX());
+		x1 = core_min(x1, _region.getUpperX());
+		if (x0 > x1) {
+			return 0;
+		}
+		voxel::Voxel placeVoxel = voxel;
+		if (_erase) {
+			placeVoxel = voxel::createVoxel(voxel::VoxelType::Air, 0);
+		}
+		const bool selection = _selection != nullptr && !_selection->empty();
+		if (_force && !selection) {
+			return Super::setRow(x0, x1, y, z, placeVoxel);
+		}
+		int placed = 0;
+		auto placeSpan = [&](int spanX0, int spanX1) {
+			if (_force) {
+				placed += Super::setRow(spanX0, spanX1, y, z, placeVoxel);
+				return;
+			}
+			// only the runs of solid voxels are painted - only the runs of air voxels are filled
+			const glm::ivec3 start(spanX0, y, z);
+			const voxel::Voxel *voxels = _volume->row(start);
+			int runStart = -1;
+			for (int x = spanX0; x <= spanX1; ++x) {
+				const bool empty = voxel::isAir(voxels[x - spanX0].getMaterial());
+				if (empty != _paint) {
+					if (runStart == -1) {
+						runStart = x;
+					}
+					continue;
+				}
+				if (runStart != -1) {
+					placed += Super::setRow(runStart, x - 1, y, z, placeVoxel);
+					// writing the run might have detached the voxel data
+					voxels = _volume->row(start);
+					runStart = -1;
+				}
+			}
+			if (runStart != -1) {
+				placed += Super::setRow(runStart, spanX1, y, z, placeVoxel);
+			}
+		};
+		if (selection) {
+			_selection->visitSelectedSpans(x0, x1, y, z, placeSpan);
+		} else {
+			placeSpan(x0, x1);
+		}
+		return placed;
+	}
 };
 
 } // namespace voxedit
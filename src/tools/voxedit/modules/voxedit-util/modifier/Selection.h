@@ -4,12 +4,13 @@
 
 #pragma once
 
-#include "core/collection/DynamicArray.h"
+#include "core/collection/SmallVector.h"
 #include "voxel/Region.h"
 
 namespace voxedit {
 
 using Selection = voxel::Region;
-using Selections = core::DynamicArray<Selection>;
+// usually there are only a few selections - keep them inline
+using Selections = core::SmallVector<Selection, 4>;
 
 } // namespace voxedit
@@ -4,7 +4,6 @@
 
 #include "SelectionManager.h"
 #include "voxel/RawVolume.h"
-#include "voxel/SparseVolume.h"
 
 namespace voxedit {
 
@@ -12,12 +11,53 @@ const Selections &SelectionManager::selections() const {
 	return _selections;
 }
 
+/**
+ * @brief Splits the parts of @c sel that are not covered by @c cut into up to six non overlapping regions
+ */
+static void subtract(const Selection &sel, const Selection &cut, Selections &out) {
+	if (!voxel::intersects(sel, cut)) {
+		out.push_back(sel);
+		return;
+	}
+	glm::ivec3 mins = sel.getLowerCorner();
+	glm::ivec3 maxs = sel.getUpperCorner();
+	const glm::ivec3 &cutMins = cut.getLowerCorner();
+	const glm::ivec3 &cutMaxs = cut.getUpperCorner();
+	for (int axis = 0; axis < 3; ++axis) {
+		if (mins[axis] < cutMins[axis]) {
+			glm::ivec3 upper = maxs;
+			upper[axis] = cutMins[axis] - 1;
+			out.push_back(Selection(mins, upper));
+			mins[axis] = cutMins[axis];
+		}
+		if (maxs[axis] > cutMaxs[axis]) {
+			glm::ivec3 lower = mins;
+			lower[axis] = cutMaxs[axis] + 1;
+			out.push_back(Selection(lower, maxs));
+			maxs[axis] = cutMaxs[axis];
+		}
+	}
+}
+
 void SelectionManager::invert(voxel::RawVolume &volume) {
 	if (!hasSelection()) {
 		select(volume, volume.region().getLowerCorner(), volume.region().getUpperCorner());
-	} else {
-		// TODO: SELECTION
+		return;
+	}
+	Selections inverted;
+	inverted.push_back(volume.region());
+	for (const Selection &selection : _selections) {
+		Selections remaining;
+		for (const Selection &sel : inverted) {
+			subtract(sel, selection, remaining);
+		}
+		inverted = core::move(remaining);
 	}
+	reset();
+	for (const Selection &sel : inverted) {
+		_selectionVolume.select(sel);
+	}
+	_selections = core::move(inverted);
 }
 
 void SelectionManager::unselect(voxel::RawVolume &volume) {
@@ -26,6 +66,7 @@ void SelectionManager::unselect(voxel::RawVolume &volume) {
 
 void SelectionManager::reset() {
 	_selections.clear();
+	_selectionVolume.clear();
 }
 
 voxel::Region SelectionManager::region() const {
@@ -55,14 +96,12 @@ bool SelectionManager::select(voxel::RawVolume &volume, const glm::ivec3 &mins,
 		Selection &s = _selections[i];
 		if (sel.containsRegion(s)) {
 			_selections.erase(i);
-		} else if (voxel::intersects(sel, s)) {
-			// TODO: SELECTION: slice
-			++i;
 		} else {
 			++i;
 		}
 	}
 	_selections.push_back(sel);
+	_selectionVolume.select(sel);
 	return true;
 }
 
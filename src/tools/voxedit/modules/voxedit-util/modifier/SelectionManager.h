@@ -5,6 +5,7 @@
 #pragma once
 
 #include "Selection.h"
+#include "SelectionVolume.h"
 
 namespace voxel {
 class RawVolume;
@@ -15,7 +16,10 @@ namespace voxedit {
 class SelectionManager {
 private:
 	Selections _selections;
-	// voxel::SparseVolume _selectionVolume;
+	/**
+	 * the selected voxels of the @c _selections - answers the per voxel queries without looping over all regions
+	 */
+	SelectionVolume _selectionVolume;
 
 public:
 	// TODO: SELECTION: reduce access to this as much as possible
@@ -28,10 +32,26 @@ public:
 		}
 	}
 
+	const SelectionVolume &selectionVolume() const;
+
+	/**
+	 * @brief Calls the given function for every selected voxel
+	 * @param f @c void(int x, int y, int z)
+	 * @sa SelectionVolume::visitSelectedVoxels()
+	 */
+	template<typename F>
+	void visitSelectedVoxels(F &&f) const {
+		_selectionVolume.visitSelectedVoxels(f);
+	}
+
 	voxel::Region region() const;
 	bool hasSelection() const;
+	bool isSelected(const glm::ivec3 &pos) const;
 
 	// TODO: SELECTION: the plan here is to move the selected voxels into the sparse volume to allow copy/cut/move operations
+	/**
+	 * @brief Selects everything in the volume region that is not yet selected
+	 */
 	void invert(voxel::RawVolume &volume);
 	bool select(voxel::RawVolume &volume, const glm::ivec3 &mins, const glm::ivec3 &maxs);
 	void unselect(voxel::RawVolume &volume);
@@ -43,4 +63,12 @@ inline bool SelectionManager::hasSelection() const {
 	return !_selections.empty();
 }
 
+inline bool SelectionManager::isSelected(const glm::ivec3 &pos) const {
+	return _selectionVolume.isSelected(pos);
+}
+
+inline const SelectionVolume &SelectionManager::selectionVolume() const {
+	return _selectionVolume;
+}
+
 } // namespace voxedit
@@ -0,0 +1,125 @@
+/**
+ * @file
+ */
+
+#include "SelectionVolume.h"
+#include "core/Trace.h"
+
+namespace voxedit {
+
+const SelectionVolume::Brick *SelectionVolume::brick(const glm::ivec3 &brickPos) const {
+	const int *brickIdx = _brickIndices.ptr(brickPos);
+	if (brickIdx == nullptr) {
+		return nullptr;
+	}
+	return &_bricks[*brickIdx];
+}
+
+void SelectionVolume::removeBrick(const glm::ivec3 &brickPos, int brickIdx) {
+	const int lastIdx = (int)_bricks.size() - 1;
+	if (brickIdx != lastIdx) {
+		// move the last brick into the free slot to keep the bricks packed
+		_bricks[brickIdx] = _bricks[lastIdx];
+		_brickIndices.put(_bricks[brickIdx].mins >> BrickShift, brickIdx);
+	}
+	_bricks.erase(lastIdx);
+	_brickIndices.remove(brickPos);
+}
+
+void SelectionVolume::modify(const voxel::Region &region, bool select) {
+	core_trace_scoped(SelectionVolumeModify);
+	if (!region.isValid()) {
+		return;
+	}
+	++_version;
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	const glm::ivec3 brickMins = mins >> BrickShift;
+	const glm::ivec3 brickMaxs = maxs >> BrickShift;
+	for (int bz = brickMins.z; bz <= brickMaxs.z; ++bz) {
+		for (int by = brickMins.y; by <= brickMaxs.y; ++by) {
+			for (int bx = brickMins.x; bx <= brickMaxs.x; ++bx) {
+				const glm::ivec3 brickPos(bx, by, bz);
+				int brickIdx;
+				if (!_brickIndices.get(brickPos, brickIdx)) {
+					if (!select) {
+						continue;
+					}
+					brickIdx = (int)_bricks.size();
+					Brick newBrick;
+					newBrick.mins = brickPos << BrickShift;
+					_bricks.push_back(newBrick);
+					_brickIndices.put(brickPos, brickIdx);
+				}
+				Brick &b = _bricks[brickIdx];
+				const glm::ivec3 lower = glm::max(mins, b.mins) - b.mins;
+				const glm::ivec3 upper = glm::min(maxs, b.mins + BrickMask) - b.mins;
+				const uint32_t mask = ((2u << upper.x) - 1u) & ~((1u << lower.x) - 1u);
+				int delta = 0;
+				for (int z = lower.z; z <= upper.z; ++z) {
+					uint16_t *rows = &b.rows[z * BrickSize];
+					for (int y = lower.y; y <= upper.y; ++y) {
+						const uint32_t old = rows[y];
+						const uint32_t row = select ? (old | mask) : (old & ~mask);
+						delta += core::popCount(row) - core::popCount(old);
+						rows[y] = (uint16_t)row;
+					}
+				}
+				b.count += delta;
+				_count += delta;
+				if (b.count == 0) {
+					removeBrick(brickPos, brickIdx);
+				}
+			}
+		}
+	}
+}
+
+void SelectionVolume::select(const voxel::Region &region) {
+	modify(region, true);
+}
+
+void SelectionVolume::unselect(const voxel::Region &region) {
+	modify(region, false);
+}
+
+void SelectionVolume::clear() {
+	_bricks.clear();
+	_brickIndices.clear();
+	_count = 0u;
+	++_version;
+}
+
+bool SelectionVolume::isSelected(int x, int y, int z) const {
+	const Brick *b = brick(glm::ivec3(x, y, z) >> BrickShift);
+	if (b == nullptr) {
+		return false;
+	}
+	const uint16_t row = b->rows[(y & BrickMask) + (z & BrickMask) * BrickSize];
+	return (row & (1u << (x & BrickMask))) != 0u;
+}
+
+voxel::Region SelectionVolume::calculateRegion() const {
+	if (empty()) {
+		return voxel::Region::InvalidRegion;
+	}
+	glm::ivec3 mins(INT32_MAX);
+	glm::ivec3 maxs(INT32_MIN);
+	for (const Brick &b : _bricks) {
+		for (int z = 0; z < BrickSize; ++z) {
+			for (int y = 0; y < BrickSize; ++y) {
+				const uint32_t row = b.rows[y + z * BrickSize];
+				if (row == 0u) {
+					continue;
+				}
+				const int lowX = core::countTrailingZeros(row);
+				const int highX = 63 - core::countLeadingZeros(row);
+				mins = glm::min(mins, b.mins + glm::ivec3(lowX, y, z));
+				maxs = glm::max(maxs, b.mins + glm::ivec3(highX, y, z));
+			}
+		}
+	}
+	return voxel::Region(mins, maxs);
+}
+
+} // namespace voxedit
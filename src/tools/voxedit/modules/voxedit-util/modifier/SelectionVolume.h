@@ -0,0 +1,198 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Bits.h"
+#include "core/Common.h"
+#include "core/GLM.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/FlatMap.h"
+#include "voxel/Region.h"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace voxedit {
+
+/**
+ * @brief One bit per selected voxel - stored in sparse bricks of 16x16x16 voxels
+ *
+ * Only the bricks that contain at least one selected voxel are allocated. A brick stores its rows along the x axis as
+ * 16 bit masks, so selecting or unselecting a region only touches one value per row and brick - no matter how many
+ * voxels are in the row. The voxels of the volume are not modified.
+ *
+ * @note The coordinates are in volume space - negative coordinates are allowed
+ */
+class SelectionVolume {
+public:
+	static constexpr int BrickShift = 4;
+	static constexpr int BrickSize = 1 << BrickShift;
+	static constexpr int BrickMask = BrickSize - 1;
+
+private:
+	struct Brick {
+		/** the lower corner of the brick in volume space */
+		glm::ivec3 mins{0};
+		/** the amount of selected voxels in this brick */
+		int count = 0;
+		/** bit @c x of @c rows[y + z * BrickSize] is set if the voxel is selected */
+		uint16_t rows[BrickSize * BrickSize]{};
+	};
+	core::DynamicArray<Brick> _bricks;
+	/** maps the brick coordinates to the index in @c _bricks */
+	core::FlatMap<glm::ivec3, int, glm::hash<glm::ivec3>> _brickIndices;
+	size_t _count = 0u;
+	/** changed on every modification - invalidates the cached brick of a @c Sampler */
+	uint32_t _version = 0u;
+
+	const Brick *brick(const glm::ivec3 &brickPos) const;
+	void removeBrick(const glm::ivec3 &brickPos, int brickIdx);
+	void modify(const voxel::Region &region, bool select);
+
+public:
+	/**
+	 * @brief Answers the per voxel selection queries of a brush execution
+	 *
+	 * The brick of the last query is cached - the brick map is only queried again if a voxel of another brick is
+	 * tested. Brushes usually place their voxels in coherent runs, so most queries are answered from the cache.
+	 *
+	 * @note The cache is dropped if the selection is modified
+	 */
+	class Sampler {
+	private:
+		const SelectionVolume *_volume;
+		const Brick *_brick = nullptr;
+		glm::ivec3 _brickPos{0};
+		uint32_t _version = 0u;
+		bool _cached = false;
+
+	public:
+		Sampler(const SelectionVolume *volume) : _volume(volume) {
+		}
+
+		bool isSelected(int x, int y, int z) {
+			const glm::ivec3 brickPos = glm::ivec3(x, y, z) >> BrickShift;
+			if (!_cached || brickPos != _brickPos || _version != _volume->_version) {
+				_brick = _volume->brick(brickPos);
+				_brickPos = brickPos;
+				_version = _volume->_version;
+				_cached = true;
+			}
+			if (_brick == nullptr) {
+				return false;
+			}
+			const uint16_t row = _brick->rows[(y & BrickMask) + (z & BrickMask) * BrickSize];
+			return (row & (1u << (x & BrickMask))) != 0u;
+		}
+	};
+
+	/**
+	 * @brief Marks all voxels in the given region as selected
+	 */
+	void select(const voxel::Region &region);
+	/**
+	 * @brief Removes all voxels in the given region from the selection - bricks that get empty are released
+	 */
+	void unselect(const voxel::Region &region);
+	void clear();
+
+	bool isSelected(int x, int y, int z) const;
+	inline bool isSelected(const glm::ivec3 &pos) const {
+		return isSelected(pos.x, pos.y, pos.z);
+	}
+
+	/**
+	 * @return The amount of selected voxels
+	 */
+	inline size_t count() const {
+		return _count;
+	}
+
+	inline bool empty() const {
+		return _count == 0u;
+	}
+
+	/**
+	 * @return The amount of allocated bricks
+	 */
+	inline size_t bricks() const {
+		return _bricks.size();
+	}
+
+	/**
+	 * @return The region that encloses all selected voxels or @c voxel::Region::InvalidRegion if nothing is selected
+	 */
+	voxel::Region calculateRegion() const;
+
+	/**
+	 * @brief Calls the given function for every run of selected voxels in the row along the x axis from @c x0 to
+	 * @c x1 (both inclusive)
+	 *
+	 * Only one brick lookup per 16 voxels is needed - the runs are extracted from the row masks of the bricks. Runs
+	 * that continue in the next brick are reported as one run.
+	 *
+	 * @param func @c void(int x0, int x1) with both values inclusive
+	 */
+	template<class FUNC>
+	void visitSelectedSpans(int x0, int x1, int y, int z, FUNC &&func) const {
+		int spanStart = 0;
+		int spanEnd = 0;
+		bool span = false;
+		const int rowIdx = (y & BrickMask) + (z & BrickMask) * BrickSize;
+		for (int bx = x0 >> BrickShift; bx <= x1 >> BrickShift; ++bx) {
+			const Brick *b = brick(glm::ivec3(bx, y >> BrickShift, z >> BrickShift));
+			if (b == nullptr) {
+				continue;
+			}
+			const int brickX = bx << BrickShift;
+			const int lower = core_max(x0 - brickX, 0);
+			const int upper = core_min(x1 - brickX, BrickMask);
+			uint32_t row = b->rows[rowIdx] & ((2u << upper) - 1u) & ~((1u << lower) - 1u);
+			while (row != 0u) {
+				const int start = core::countTrailingZeros(row);
+				const int end = start + core::countTrailingZeros(~(row >> start)) - 1;
+				row &= ~((2u << end) - 1u);
+				if (span && spanEnd + 1 == brickX + start) {
+					spanEnd = brickX + end;
+					continue;
+				}
+				if (span) {
+					func(spanStart, spanEnd);
+				}
+				span = true;
+				spanStart = brickX + start;
+				spanEnd = brickX + end;
+			}
+		}
+		if (span) {
+			func(spanStart, spanEnd);
+		}
+	}
+
+	/**
+	 * @brief Calls the given function for every selected voxel
+	 *
+	 * Only the allocated bricks are visited and rows without selected voxels are skipped.
+	 *
+	 * @param func @c void(int x, int y, int z)
+	 * @note The order of the voxels is not defined
+	 */
+	template<class FUNC>
+	void visitSelectedVoxels(FUNC &&func) const {
+		for (const Brick &b : _bricks) {
+			for (int z = 0; z < BrickSize; ++z) {
+				for (int y = 0; y < BrickSize; ++y) {
+					uint32_t row = b.rows[y + z * BrickSize];
+					while (row != 0u) {
+						const int x = core::countTrailingZeros(row);
+						row &= row - 1u;
+						func(b.mins.x + x, b.mins.y + y, b.mins.z + z);
+					}
+				}
+			}
+		}
+	}
+};
+
+} // namespace voxedit
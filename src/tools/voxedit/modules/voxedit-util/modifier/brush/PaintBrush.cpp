@@ -30,25 +30,40 @@ voxel::Voxel PaintBrush::VoxelColor::evaluate(const voxel::Voxel &old) {
 		brighten = rand() % 2 == 0;
 	}
 
-	const core::RGBA voxelColor = _palette.color(old.getColor());
+	const int index = lookupColor(old.getColor(), brighten);
+	if (index == Unchanged) {
+		return old;
+	}
+	return voxel::createVoxel(_palette, index, old.getFlags());
+}
+
+int PaintBrush::VoxelColor::lookupColor(uint8_t colorIndex, bool brighten) {
+	int16_t &cached = brighten ? _brighter[colorIndex] : _darker[colorIndex];
+	if (cached != NotComputed) {
+		return cached;
+	}
+	const core::RGBA voxelColor = _palette.color(colorIndex);
 	core::RGBA newColor;
 	if (brighten) {
 		newColor = core::Color::brighter(voxelColor, _factor);
 	} else {
 		newColor = core::Color::darker(voxelColor, _factor);
 	}
-	const int index = _palette.getClosestMatch(newColor, old.getColor());
+	const int index = _palette.getClosestMatch(newColor, colorIndex);
 	if (index == palette::PaletteColorNotFound) {
 		uint8_t newColorIndex = 0;
-		if (!_palette.tryAdd(newColor, false, &newColorIndex, false, old.getColor())) {
-			return old;
+		if (!_palette.tryAdd(newColor, false, &newColorIndex, false, colorIndex)) {
+			cached = Unchanged;
+			return cached;
 		}
 		_palette.markDirty();
 		_palette.markSave();
 		// TODO: no memento state handling here
-		return voxel::createVoxel(_palette, newColorIndex, old.getFlags());
+		cached = newColorIndex;
+		return cached;
 	}
-	return voxel::createVoxel(_palette, index, old.getFlags());
+	cached = (int16_t)index;
+	return cached;
 }
 
 static voxel::Voxel mix(ModifierVolumeWrapper &wrapper, const voxel::Voxel &from, const voxel::Voxel &to, float factor) {
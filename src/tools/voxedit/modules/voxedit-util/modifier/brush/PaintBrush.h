@@ -40,17 +40,32 @@ private:
 protected:
 	class VoxelColor {
 	private:
+		static constexpr int16_t NotComputed = -2;
+		static constexpr int16_t Unchanged = -1;
+
 		const voxel::Voxel _voxel;
 		palette::Palette &_palette;
 		const PaintMode _paintMode;
 		float _factor = 1.0f;
 		int _variationThreshold = 3;
+		/**
+		 * The brighter and darker color index for every palette color index - the closest match is only searched once
+		 * per color index and not for every painted voxel
+		 */
+		int16_t _brighter[256];
+		int16_t _darker[256];
+
+		int lookupColor(uint8_t colorIndex, bool brighten);
 
 	public:
 		VoxelColor(palette::Palette &palette, const voxel::Voxel &voxel, PaintMode paintMode, float factor,
 				   int variationThreshold)
 			: _voxel(voxel), _palette(palette), _paintMode(paintMode), _factor(factor),
 			  _variationThreshold(variationThreshold) {
+			for (int i = 0; i < lengthof(_brighter); ++i) {
+				_brighter[i] = NotComputed;
+				_darker[i] = NotComputed;
+			}
 		}
 		voxel::Voxel evaluate(const voxel::Voxel &old);
 	};
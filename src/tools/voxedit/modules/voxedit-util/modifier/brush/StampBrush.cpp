@@ -8,6 +8,7 @@
 #include "command/Command.h"
 #include "command/CommandHandler.h"
 #include "core/Log.h"
+#include "core/Trace.h"
 #include "io/FilesystemArchive.h"
 #include "io/FormatDescription.h"
 #include "scenegraph/SceneGraph.h"
@@ -47,6 +48,7 @@ void StampBrush::construct() {
 		const math::Axis axis = math::toAxis(args[0]);
 		_volume = voxelutil::rotateAxis(_volume, axis);
 		_volume->translate(-_volume->region().getLowerCorner());
+		invalidateSpans();
 		markDirty();
 	}).setHelp(_("Rotate stamp volume around the given axis"));
 
@@ -56,7 +58,7 @@ void StampBrush::construct() {
 			if (const scenegraph::SceneGraphNode *node =
 					_sceneMgr->sceneGraphModelNode(_sceneMgr->sceneGraph().activeNode())) {
 				const Selections &selections = modifier.selectionMgr().selections();
-				const voxel::RawVolume stampVolume(node->volume(), selections);
+				const voxel::RawVolume stampVolume(*node->volume(), selections.data(), selections.size());
 				setVolume(stampVolume, node->palette());
 				// we unselect here as it's not obvious for the user that the stamp also only operates in the selection
 				// this can sometimes lead to confusion if you e.g. created a stamp from a fully filled selected area
@@ -120,9 +122,63 @@ void StampBrush::generate(scenegraph::SceneGraph &sceneGraph, ModifierVolumeWrap
 	}
 
 	// TODO: context.lockedAxis support
-	voxelutil::visitVolume(*_volume, [&](int x, int y, int z, const voxel::Voxel &v) {
-		wrapper.setVoxel(offset.x + x, offset.y + y, offset.z + z, v);
-	});
+	core::DynamicArray<glm::ivec3> offsets;
+	offsets.push_back(offset);
+	placeStamps(wrapper, offsets);
+}
+
+void StampBrush::invalidateSpans() {
+	_spans.clear();
+	_spansVolume = nullptr;
+}
+
+void StampBrush::updateSpans() {
+	// the version also changes if the voxels of the stamp are modified in place
+	if (_spansVolume == _volume && _spansVersion == _volume->version()) {
+		return;
+	}
+	core_trace_scoped(StampBrushUpdateSpans);
+	_spans.clear();
+	const voxel::Region &region = _volume->region();
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const int width = region.getWidthInVoxels();
+	for (int z = mins.z; z <= region.getUpperZ(); ++z) {
+		for (int y = mins.y; y <= region.getUpperY(); ++y) {
+			const voxel::Voxel *voxels = _volume->row(glm::ivec3(mins.x, y, z));
+			int x = 0;
+			while (x < width) {
+				const voxel::Voxel &voxel = voxels[x];
+				if (voxel::isAir(voxel.getMaterial())) {
+					++x;
+					continue;
+				}
+				int end = x + 1;
+				while (end < width && voxels[end].isSame(voxel) && voxels[end].getFlags() == voxel.getFlags()) {
+					++end;
+				}
+				_spans.push_back({glm::ivec3(x, y - mins.y, z - mins.z), end - x, voxel});
+				x = end;
+			}
+		}
+	}
+	_spansVolume = _volume;
+	_spansVersion = _volume->version();
+}
+
+int StampBrush::placeStamps(ModifierVolumeWrapper &wrapper, const core::DynamicArray<glm::ivec3> &offsets) {
+	if (!_volume) {
+		return 0;
+	}
+	core_trace_scoped(StampBrushPlaceStamps);
+	updateSpans();
+	int placed = 0;
+	for (const glm::ivec3 &offset : offsets) {
+		for (const StampSpan &span : _spans) {
+			const glm::ivec3 pos = offset + span.pos;
+			placed += wrapper.setRow(pos.x, pos.x + span.length - 1, pos.y, pos.z, span.voxel);
+		}
+	}
+	return placed;
 }
 
 void StampBrush::reset() {
@@ -130,6 +186,7 @@ void StampBrush::reset() {
 	_center = true;
 	_continuous = false;
 	_volume = nullptr;
+	invalidateSpans();
 }
 
 void StampBrush::setSize(const glm::ivec3 &size) {
@@ -139,6 +196,7 @@ void StampBrush::setSize(const glm::ivec3 &size) {
 	if (_volume) {
 		_volume = voxelutil::resize(_volume, voxel::Region(glm::ivec3(0), size - 1));
 		_volume->translate(-_volume->region().getLowerCorner());
+		invalidateSpans();
 		markDirty();
 	}
 }
@@ -153,6 +211,7 @@ void StampBrush::setVolume(const voxel::RawVolume &volume, const palette::Palett
 		_volume->translate(-_volume->region().getLowerCorner());
 	}
 	_palette = palette;
+	invalidateSpans();
 	markDirty();
 }
 
@@ -175,6 +234,7 @@ void StampBrush::setVoxel(const voxel::Voxel &voxel, const palette::Palette &pal
 		_volume = new voxel::RawVolume(voxel::Region(glm::ivec3(0), glm::ivec3(0)));
 		_volume->setVoxel(0, 0, 0, voxel);
 		_palette = palette;
+		invalidateSpans();
 	}
 	markDirty();
 }
@@ -6,6 +6,7 @@
 
 #include "Brush.h"
 #include "core/ScopedPtr.h"
+#include "core/collection/DynamicArray.h"
 #include "palette/Palette.h"
 #include "voxel/RawVolume.h"
 
@@ -24,7 +25,24 @@ private:
 	using Super = Brush;
 
 protected:
+	/**
+	 * @brief A run of equal solid voxels along the x axis of the stamp volume
+	 */
+	struct StampSpan {
+		/** relative to the lower corner of the stamp volume */
+		glm::ivec3 pos;
+		int length;
+		voxel::Voxel voxel;
+	};
+
 	core::ScopedPtr<voxel::RawVolume> _volume;
+	/**
+	 * The stamp volume split into rows of equal voxels - this is rebuilt if the stamp volume changes and reused for
+	 * every placement of the stamp
+	 */
+	core::DynamicArray<StampSpan> _spans;
+	const voxel::RawVolume *_spansVolume = nullptr;
+	uint64_t _spansVersion = 0u;
 	palette::Palette _palette;
 	glm::ivec3 _lastCursorPosition{0};
 	bool _center = true;
@@ -33,6 +51,8 @@ protected:
 
 	void generate(scenegraph::SceneGraph &sceneGraph, ModifierVolumeWrapper &wrapper, const BrushContext &context,
 				  const voxel::Region &region) override;
+	void updateSpans();
+	void invalidateSpans();
 
 public:
 	static constexpr int MaxSize = 32;
@@ -62,6 +82,16 @@ public:
 
 	void setSize(const glm::ivec3 &size);
 
+	/**
+	 * @brief Places the stamp at all the given positions in one go
+	 *
+	 * All instances end up in the dirty region of the given wrapper - and thus in one undo state and one mesh
+	 * extraction - instead of one for each placement.
+	 * @param offsets The lower corners of the stamp instances
+	 * @return The amount of voxels of all instances that are inside the valid region of the wrapper
+	 */
+	int placeStamps(ModifierVolumeWrapper &wrapper, const core::DynamicArray<glm::ivec3> &offsets);
+
 	bool load(const core::String &filename);
 };
 
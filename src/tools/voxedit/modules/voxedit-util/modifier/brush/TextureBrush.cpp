@@ -7,6 +7,7 @@
 #include "command/Command.h"
 #include "image/Image.h"
 #include "palette/Palette.h"
+#include "palette/PaletteLookup.h"
 #include "voxedit-util/modifier/ModifierVolumeWrapper.h"
 #include "voxel/Face.h"
 #include "voxelutil/ImageUtils.h"
@@ -68,6 +69,8 @@ void TextureBrush::generate(scenegraph::SceneGraph &sceneGraph, ModifierVolumeWr
 	const int axisIdxUV1 = (axisIdx1 + 0) % 2;
 	const int axisIdxUV2 = (axisIdx1 + 1) % 2;
 	const palette::Palette &palette = wrapper.node().palette();
+	// textures usually consist of a few colors that are sampled many times - only search the closest match once
+	palette::PaletteLookup palLookup(palette);
 
 	auto visitor = [&](int x, int y, int z, const voxel::Voxel &voxel) {
 		const glm::ivec3 uvPos = getUVPosForFace(x, y, z, region, _aabbFace);
@@ -80,10 +83,7 @@ void TextureBrush::generate(scenegraph::SceneGraph &sceneGraph, ModifierVolumeWr
 		if (color.a == 0) {
 			return;
 		}
-		int palIdx = palette.getClosestMatch(color);
-		if (palIdx == palette::PaletteColorNotFound) {
-			palIdx = 0;
-		}
+		const uint8_t palIdx = palLookup.findClosestIndex(color);
 		const glm::ivec3 pos(x, y, z);
 		wrapper.setVoxel(pos.x, pos.y, pos.z, voxel::createVoxel(palette, palIdx));
 	};
@@ -0,0 +1,53 @@
+/**
+ * @file
+ */
+
+#include "../Clipboard.h"
+#include "app/tests/AbstractTest.h"
+#include "io/BufferedReadWriteStream.h"
+#include "palette/Palette.h"
+#include "voxel/RawVolume.h"
+
+namespace voxedit {
+
+class ClipboardTest : public app::AbstractTest {
+protected:
+	voxel::VoxelData createVoxelData() {
+		palette::Palette palette;
+		palette.nippon();
+		voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(-2, 1, 0, 5, 7, 3));
+		v->setVoxel(-2, 1, 0, voxel::createVoxel(palette, 1));
+		v->setVoxel(5, 7, 3, voxel::createVoxel(palette, 42));
+		return {v, palette, true};
+	}
+};
+
+TEST_F(ClipboardTest, testSerialize) {
+	const voxel::VoxelData &voxelData = createVoxelData();
+	io::BufferedReadWriteStream stream;
+	ASSERT_TRUE(tool::serialize(voxelData, stream));
+	// the empty voxels are compressed
+	EXPECT_LT(stream.size(), (int64_t)(voxelData.volume->region().voxels() * sizeof(voxel::Voxel)));
+	stream.seek(0);
+	const voxel::VoxelData &pasted = tool::deserialize(stream);
+	ASSERT_TRUE(pasted);
+	EXPECT_EQ(voxelData.volume->region(), pasted.volume->region());
+	EXPECT_EQ(voxelData.palette->colorCount(), pasted.palette->colorCount());
+	EXPECT_EQ(voxelData.palette->color(42), pasted.palette->color(42));
+	EXPECT_EQ(1, pasted.volume->voxel(-2, 1, 0).getColor());
+	EXPECT_EQ(42, pasted.volume->voxel(5, 7, 3).getColor());
+	EXPECT_TRUE(voxel::isAir(pasted.volume->voxel(0, 2, 1).getMaterial()));
+}
+
+TEST_F(ClipboardTest, testClipboardText) {
+	const voxel::VoxelData &voxelData = createVoxelData();
+	const core::String &text = tool::toClipboardText(voxelData);
+	ASSERT_TRUE(tool::isClipboardText(text));
+	EXPECT_FALSE(tool::isClipboardText("some other text"));
+	const voxel::VoxelData &pasted = tool::fromClipboardText(text);
+	ASSERT_TRUE(pasted);
+	EXPECT_EQ(42, pasted.volume->voxel(5, 7, 3).getColor());
+	EXPECT_FALSE(tool::fromClipboardText(text.substr(0, text.size() / 2)));
+}
+
+} // namespace voxedit
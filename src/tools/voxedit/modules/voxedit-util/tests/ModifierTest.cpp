@@ -3,6 +3,8 @@
  */
 
 #include "../modifier/Modifier.h"
+#include "../modifier/ModifierVolumeWrapper.h"
+#include "../modifier/SelectionVolume.h"
 #include "app/tests/AbstractTest.h"
 #include "scenegraph/SceneGraph.h"
 #include "voxedit-util/SceneManager.h"
@@ -103,6 +105,32 @@ TEST_F(ModifierTest, testModifierSelection) {
 	modifier.shutdown();
 }
 
+TEST_F(ModifierTest, testModifierVolumeWrapperRow) {
+	voxel::RawVolume volume({-10, 10});
+	volume.setVoxel(2, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(&volume, false);
+	SelectionVolume selection;
+	selection.select(voxel::Region(glm::ivec3(-3, 0, 0), glm::ivec3(3, 0, 0)));
+	selection.select(voxel::Region(glm::ivec3(8, 0, 0), glm::ivec3(20, 0, 0)));
+
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	ModifierVolumeWrapper place(node, ModifierType::Place, &selection);
+	// the existing voxel is kept and the row is clipped to the selection and the volume region
+	EXPECT_EQ(6 + 3, place.setRow(-20, 20, 0, 0, voxel));
+	EXPECT_EQ(voxel::Region(glm::ivec3(-3, 0, 0), glm::ivec3(10, 0, 0)), place.dirtyRegion());
+	EXPECT_EQ(2, volume.voxel(2, 0, 0).getColor());
+	EXPECT_EQ(1, volume.voxel(-3, 0, 0).getColor());
+	EXPECT_TRUE(voxel::isAir(volume.voxel(-4, 0, 0).getMaterial()));
+	EXPECT_TRUE(voxel::isAir(volume.voxel(4, 0, 0).getMaterial()));
+	EXPECT_EQ(0, place.setRow(-20, 20, 1, 0, voxel));
+
+	ModifierVolumeWrapper erase(node, ModifierType::Erase);
+	EXPECT_EQ(21, erase.setRow(-20, 20, 0, 0, voxel));
+	EXPECT_EQ(voxel::Region(glm::ivec3(-3, 0, 0), glm::ivec3(10, 0, 0)), erase.dirtyRegion());
+	EXPECT_TRUE(voxel::isAir(volume.voxel(2, 0, 0).getMaterial()));
+}
+
 TEST_F(ModifierTest, testClamp) {
 	scenegraph::SceneGraph sceneGraph;
 	SceneManager mgr(core::make_shared<core::TimeProvider>(), _testApp->filesystem(),
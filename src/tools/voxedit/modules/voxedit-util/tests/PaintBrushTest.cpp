@@ -4,6 +4,7 @@
 
 #include "voxedit-util/modifier/brush/PaintBrush.h"
 #include "app/tests/AbstractTest.h"
+#include "core/Color.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxedit-util/modifier/ModifierVolumeWrapper.h"
@@ -97,4 +98,39 @@ TEST_F(PaintBrushTest, testExecuteSingleRadius) {
 	brush.shutdown();
 }
 
+TEST_F(PaintBrushTest, testExecuteBrighten) {
+	PaintBrush brush;
+	ASSERT_TRUE(brush.init());
+	brush.setSingleMode();
+	brush.setRadius(1);
+	brush.setPaintMode(PaintBrush::PaintMode::Brighten);
+
+	scenegraph::SceneGraph sceneGraph;
+	const int nodeId = prepareSceneGraph(sceneGraph);
+	ASSERT_NE(nodeId, InvalidNodeId);
+	scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+	const core::RGBA expectedColor = core::Color::brighter(node.palette().color(existingVoxelColorIndex), 1.0f);
+	ModifierVolumeWrapper wrapper(node, brush.modifierType());
+
+	BrushContext brushContext;
+	prepareBrushContext(brushContext);
+	brushContext.cursorPosition = wrapper.region().getLowerCenter();
+
+	ASSERT_TRUE(brush.execute(sceneGraph, wrapper, brushContext));
+
+	// all voxels of the same color get the same brighter color
+	const voxel::Voxel voxel = wrapper.voxel(brushContext.cursorPosition);
+	EXPECT_NE((int)voxel.getColor(), (int)existingVoxelColorIndex) << "Voxel color was not changed by the paint brush";
+	EXPECT_EQ(node.palette().getClosestMatch(expectedColor, existingVoxelColorIndex), (int)voxel.getColor());
+	for (int x = -1; x <= 1; ++x) {
+		for (int z = -1; z <= 1; ++z) {
+			const voxel::Voxel painted = wrapper.voxel(brushContext.cursorPosition.x + x, brushContext.cursorPosition.y,
+													   brushContext.cursorPosition.z + z);
+			EXPECT_EQ((int)voxel.getColor(), (int)painted.getColor());
+		}
+	}
+
+	brush.shutdown();
+}
+
 } // namespace voxedit
@@ -211,10 +211,10 @@ TEST_F(SceneManagerTest, testNodeAddUndoRedo) {
 	for (int i = 0; i < 3; ++i) {
 		SCOPED_TRACE(i);
 		{
-			EXPECT_EQ(2u, mementoHandler.statePosition());
+			EXPECT_EQ(2, mementoHandler.statePosition());
 			ASSERT_TRUE(mementoHandler.canUndo());
 			EXPECT_TRUE(_sceneMgr->undo());
-			EXPECT_EQ(1u, mementoHandler.statePosition());
+			EXPECT_EQ(1, mementoHandler.statePosition());
 			ASSERT_TRUE(mementoHandler.canUndo());
 			ASSERT_TRUE(mementoHandler.canRedo());
 			EXPECT_EQ(2u, _sceneMgr->sceneGraph().size()) << _sceneMgr->sceneGraph();
@@ -240,6 +240,28 @@ TEST_F(SceneManagerTest, testNodeAddUndoRedo) {
 	}
 }
 
+TEST_F(SceneManagerTest, testModificationBatch) {
+	memento::MementoHandler &mementoHandler = _sceneMgr->mementoHandler();
+	EXPECT_EQ(1u, mementoHandler.stateSize());
+	{
+		ScopedModificationBatch batch(*_sceneMgr.get());
+		ASSERT_TRUE(testSetVoxel(testMins(), 1));
+		ASSERT_TRUE(testSetVoxel(testMaxs(), 2));
+		// the undo state is recorded once the batch ends
+		EXPECT_EQ(1u, mementoHandler.stateSize());
+	}
+	EXPECT_EQ(2u, mementoHandler.stateSize());
+	EXPECT_TRUE(_sceneMgr->dirty());
+
+	// both modifications are reverted with one undo step
+	EXPECT_TRUE(_sceneMgr->undo());
+	EXPECT_TRUE(voxel::isAir(testVolume()->voxel(testMins()).getMaterial()));
+	EXPECT_TRUE(voxel::isAir(testVolume()->voxel(testMaxs()).getMaterial()));
+	EXPECT_TRUE(_sceneMgr->redo());
+	EXPECT_EQ(1, testVolume()->voxel(testMins()).getColor());
+	EXPECT_EQ(2, testVolume()->voxel(testMaxs()).getColor());
+}
+
 TEST_F(SceneManagerTest, testUndoRedoModificationMultipleNodes) {
 	memento::MementoHandler &mementoHandler = _sceneMgr->mementoHandler();
 	EXPECT_EQ(1u, mementoHandler.stateSize());
@@ -260,7 +282,7 @@ TEST_F(SceneManagerTest, testUndoRedoModificationMultipleNodes) {
 	EXPECT_EQ(5u, mementoHandler.stateSize());
 
 	// last state is the active state
-	EXPECT_EQ(4u, mementoHandler.statePosition());
+	EXPECT_EQ(4, mementoHandler.statePosition());
 
 	for (int i = 0; i < 3; ++i) {
 		const int nodeId = _sceneMgr->sceneGraph().activeNode();
@@ -4,6 +4,7 @@
 
 #include "../modifier/SelectionManager.h"
 #include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
 
 namespace voxedit {
 
@@ -12,10 +13,58 @@ private:
 	using Super = app::AbstractTest;
 };
 
-TEST_F(SelectionManagerTest, test) {
+TEST_F(SelectionManagerTest, testSelect) {
 	SelectionManager mgr;
 	EXPECT_FALSE(mgr.hasSelection());
-	// TODO: SELECTION: implement test
+	voxel::RawVolume volume(voxel::Region(0, 7));
+	ASSERT_TRUE(mgr.select(volume, glm::ivec3(1), glm::ivec3(2)));
+	ASSERT_TRUE(mgr.select(volume, glm::ivec3(2), glm::ivec3(3)));
+	EXPECT_TRUE(mgr.hasSelection());
+	EXPECT_EQ(2u, mgr.selections().size());
+	EXPECT_EQ(voxel::Region(1, 3), mgr.region());
+	EXPECT_TRUE(mgr.isSelected(glm::ivec3(1)));
+	EXPECT_TRUE(mgr.isSelected(glm::ivec3(3)));
+	EXPECT_FALSE(mgr.isSelected(glm::ivec3(1, 1, 3)));
+	EXPECT_EQ(15u, mgr.selectionVolume().count());
+
+	// a selection that contains the others replaces them
+	ASSERT_TRUE(mgr.select(volume, glm::ivec3(0), glm::ivec3(4)));
+	EXPECT_EQ(1u, mgr.selections().size());
+	EXPECT_EQ(125u, mgr.selectionVolume().count());
+
+	mgr.unselect(volume);
+	EXPECT_FALSE(mgr.hasSelection());
+	EXPECT_FALSE(mgr.isSelected(glm::ivec3(1)));
+}
+
+TEST_F(SelectionManagerTest, testInvert) {
+	SelectionManager mgr;
+	voxel::RawVolume volume(voxel::Region(0, 7));
+	mgr.invert(volume);
+	EXPECT_EQ(512u, mgr.selectionVolume().count());
+
+	mgr.reset();
+	ASSERT_TRUE(mgr.select(volume, glm::ivec3(2), glm::ivec3(5)));
+	ASSERT_TRUE(mgr.select(volume, glm::ivec3(0), glm::ivec3(0)));
+	mgr.invert(volume);
+	EXPECT_TRUE(mgr.hasSelection());
+	EXPECT_EQ(512u - 64u - 1u, mgr.selectionVolume().count());
+	EXPECT_FALSE(mgr.isSelected(glm::ivec3(0)));
+	EXPECT_FALSE(mgr.isSelected(glm::ivec3(3)));
+	EXPECT_TRUE(mgr.isSelected(glm::ivec3(1)));
+	EXPECT_TRUE(mgr.isSelected(glm::ivec3(7)));
+	EXPECT_EQ(volume.region(), mgr.region());
+	int voxels = 0;
+	for (const Selection &sel : mgr.selections()) {
+		voxels += sel.voxels();
+	}
+	// the regions don't overlap
+	EXPECT_EQ(512 - 64 - 1, voxels);
+
+	mgr.invert(volume);
+	EXPECT_EQ(65u, mgr.selectionVolume().count());
+	EXPECT_TRUE(mgr.isSelected(glm::ivec3(0)));
+	EXPECT_TRUE(mgr.isSelected(glm::ivec3(3)));
 }
 
 } // namespace voxedit
@@ -0,0 +1,96 @@
+/**
+ * @file
+ */
+
+#include "../modifier/SelectionVolume.h"
+#include "app/tests/AbstractTest.h"
+
+namespace voxedit {
+
+class SelectionVolumeTest : public app::AbstractTest {};
+
+TEST_F(SelectionVolumeTest, testSelectUnselect) {
+	SelectionVolume volume;
+	EXPECT_TRUE(volume.empty());
+	const voxel::Region region(glm::ivec3(-3, 0, 5), glm::ivec3(20, 1, 5));
+	volume.select(region);
+	EXPECT_EQ((size_t)region.voxels(), volume.count());
+	// the region spans three bricks along the x axis
+	EXPECT_EQ(3u, volume.bricks());
+	EXPECT_TRUE(volume.isSelected(-3, 0, 5));
+	EXPECT_TRUE(volume.isSelected(20, 1, 5));
+	EXPECT_FALSE(volume.isSelected(-4, 0, 5));
+	EXPECT_FALSE(volume.isSelected(0, 0, 4));
+	EXPECT_EQ(region, volume.calculateRegion());
+
+	// selecting voxels twice doesn't change the count
+	volume.select(voxel::Region(glm::ivec3(0, 0, 5), glm::ivec3(3, 3, 5)));
+	EXPECT_EQ((size_t)region.voxels() + 16u - 8u, volume.count());
+
+	volume.unselect(voxel::Region(glm::ivec3(-16, 0, 0), glm::ivec3(-1, 3, 5)));
+	EXPECT_FALSE(volume.isSelected(-3, 0, 5));
+	EXPECT_EQ(2u, volume.bricks());
+	volume.unselect(voxel::Region(-100, 100));
+	EXPECT_TRUE(volume.empty());
+	EXPECT_EQ(0u, volume.bricks());
+	EXPECT_FALSE(volume.calculateRegion().isValid());
+}
+
+TEST_F(SelectionVolumeTest, testVisitSelectedVoxels) {
+	SelectionVolume volume;
+	volume.select(voxel::Region(glm::ivec3(14, 0, 0), glm::ivec3(17, 0, 0)));
+	volume.select(voxel::Region(glm::ivec3(100, 100, 100), glm::ivec3(100, 100, 100)));
+	int count = 0;
+	volume.visitSelectedVoxels([&](int x, int y, int z) {
+		EXPECT_TRUE(volume.isSelected(x, y, z));
+		++count;
+	});
+	EXPECT_EQ(5, count);
+}
+
+TEST_F(SelectionVolumeTest, testVisitSelectedSpans) {
+	SelectionVolume volume;
+	volume.select(voxel::Region(glm::ivec3(-3, 0, 5), glm::ivec3(20, 0, 5)));
+	volume.select(voxel::Region(glm::ivec3(30, 0, 5), glm::ivec3(31, 0, 5)));
+	volume.unselect(voxel::Region(glm::ivec3(5, 0, 5), glm::ivec3(6, 0, 5)));
+	core::DynamicArray<glm::ivec2> spans;
+	volume.visitSelectedSpans(-10, 40, 0, 5, [&](int x0, int x1) { spans.emplace_back(x0, x1); });
+	// the span from 7 to 20 crosses a brick border
+	ASSERT_EQ(3u, spans.size());
+	EXPECT_EQ(glm::ivec2(-3, 4), spans[0]);
+	EXPECT_EQ(glm::ivec2(7, 20), spans[1]);
+	EXPECT_EQ(glm::ivec2(30, 31), spans[2]);
+
+	spans.clear();
+	volume.visitSelectedSpans(0, 10, 0, 5, [&](int x0, int x1) { spans.emplace_back(x0, x1); });
+	ASSERT_EQ(2u, spans.size());
+	EXPECT_EQ(glm::ivec2(0, 4), spans[0]);
+	EXPECT_EQ(glm::ivec2(7, 10), spans[1]);
+
+	spans.clear();
+	volume.visitSelectedSpans(-10, 40, 1, 5, [&](int x0, int x1) { spans.emplace_back(x0, x1); });
+	EXPECT_TRUE(spans.empty());
+}
+
+TEST_F(SelectionVolumeTest, testSampler) {
+	SelectionVolume volume;
+	volume.select(voxel::Region(glm::ivec3(0, 0, 0), glm::ivec3(20, 3, 3)));
+	SelectionVolume::Sampler sampler(&volume);
+	EXPECT_TRUE(sampler.isSelected(0, 0, 0));
+	EXPECT_TRUE(sampler.isSelected(15, 3, 3));
+	EXPECT_FALSE(sampler.isSelected(15, 4, 3));
+	EXPECT_TRUE(sampler.isSelected(16, 0, 0));
+	EXPECT_FALSE(sampler.isSelected(21, 0, 0));
+	EXPECT_FALSE(sampler.isSelected(-1, 0, 0));
+
+	// the cached brick must not be used after the selection was modified
+	volume.unselect(voxel::Region(glm::ivec3(0, 0, 0), glm::ivec3(15, 3, 3)));
+	EXPECT_FALSE(sampler.isSelected(0, 0, 0));
+	volume.select(voxel::Region(glm::ivec3(-5, 0, 0), glm::ivec3(-1, 0, 0)));
+	EXPECT_TRUE(sampler.isSelected(-1, 0, 0));
+	volume.clear();
+	EXPECT_FALSE(sampler.isSelected(-1, 0, 0));
+	EXPECT_FALSE(sampler.isSelected(16, 0, 0));
+}
+
+} // namespace voxedit
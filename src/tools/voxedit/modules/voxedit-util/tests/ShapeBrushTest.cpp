@@ -41,7 +41,7 @@ protected:
 		scenegraph::SceneGraph sceneGraph;
 		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
 		node.setVolume(&volume, false);
-		ModifierVolumeWrapper wrapper(node, ModifierType::Place, {});
+		ModifierVolumeWrapper wrapper(node, ModifierType::Place);
 		brush.preExecute(brushContext, wrapper.volume());
 		brush.execute(sceneGraph, wrapper, brushContext);
 		brush.postExecute(brushContext);
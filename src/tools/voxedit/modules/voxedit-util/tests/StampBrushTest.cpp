@@ -46,4 +46,46 @@ TEST_F(StampBrushTest, testExecute) {
 	brush.shutdown();
 }
 
+TEST_F(StampBrushTest, testPlaceStamps) {
+	SceneManager mgr(core::make_shared<core::TimeProvider>(), _testApp->filesystem(),
+					 core::make_shared<ISceneRenderer>(), core::make_shared<IModifierRenderer>());
+	StampBrush brush(&mgr);
+	ASSERT_TRUE(brush.init());
+	voxel::RawVolume stamp(voxel::Region(0, 0, 0, 3, 1, 0));
+	stamp.setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	stamp.setVoxel(1, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	stamp.setVoxel(3, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	stamp.setVoxel(2, 1, 0, voxel::createVoxel(voxel::VoxelType::Generic, 3));
+	palette::Palette palette;
+	palette.nippon();
+	brush.setVolume(stamp, palette);
+
+	voxel::RawVolume volume(voxel::Region(0, 7));
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(&volume, false);
+	ModifierVolumeWrapper wrapper(node, ModifierType::Place);
+	core::DynamicArray<glm::ivec3> offsets;
+	offsets.push_back(glm::ivec3(0, 0, 0));
+	offsets.push_back(glm::ivec3(2, 4, 3));
+	offsets.push_back(glm::ivec3(6, 0, 7)); // partially outside
+	EXPECT_EQ(4 + 4 + 2, brush.placeStamps(wrapper, offsets));
+	for (const glm::ivec3 &offset : offsets) {
+		for (int y = 0; y <= 1; ++y) {
+			for (int x = 0; x <= 3; ++x) {
+				const glm::ivec3 pos = offset + glm::ivec3(x, y, 0);
+				if (!volume.region().containsPoint(pos)) {
+					continue;
+				}
+				const voxel::Voxel &expected = stamp.voxel(x, y, 0);
+				const voxel::Voxel &placed = volume.voxel(pos);
+				EXPECT_EQ(expected.getMaterial(), placed.getMaterial()) << "at " << pos.x << ":" << pos.y << ":" << pos.z;
+				EXPECT_EQ(expected.getColor(), placed.getColor()) << "at " << pos.x << ":" << pos.y << ":" << pos.z;
+			}
+		}
+	}
+	EXPECT_EQ(voxel::Region(0, 0, 0, 7, 5, 7), wrapper.dirtyRegion());
+
+	brush.shutdown();
+}
+
 } // namespace voxedit